@@ -96,6 +96,7 @@ set(OGRE_SET_DISABLE_ETC 0)
 set(OGRE_SET_DISABLE_JSON 0)
 set(OGRE_SET_DISABLE_STBI 0)
 set(OGRE_SET_DISABLE_ASTC 0)
+set(OGRE_SET_DISABLE_KTX2 0)
 set(OGRE_SET_DISABLE_ZIP 0)
 set(OGRE_SET_DISABLE_VIEWPORT_ORIENTATIONMODE 0)
 set(OGRE_SET_DISABLE_GLES2_GLSL_OPTIMISER 0)
@@ -105,6 +106,7 @@ set(OGRE_SET_DISABLE_GLES3_SUPPORT 0)
 set(OGRE_SET_DISABLE_TBB_SCHEDULER 0)
 set(OGRE_SET_DISABLE_FINE_LIGHT_MASK_GRANULARITY 0)
 set(OGRE_SET_ENABLE_LIGHT_OBB_RESTRAINT 0)
+set(OGRE_SET_COMPACT_OBJECT_HANDLES 0)
 set(RTSHADER_SYSTEM_BUILD_CORE_SHADERS 0)
 set(RTSHADER_SYSTEM_BUILD_EXT_SHADERS 0)
 set(OGRE_STATIC_LIB 0)
@@ -112,6 +114,7 @@ set(OGRE_SET_USE_BOOST 0)
 set(OGRE_SET_PROFILING 0)
 set(OGRE_SET_PROFILING_EXHAUSTIVE 0)
 set(OGRE_SET_USE_SIMD 0)
+set(OGRE_SET_USE_AVX2 0)
 set(OGRE_SET_RESTRICT_ALIASING 0)
 set(OGRE_SET_IDSTRING_ALWAYS_READABLE 0)
 set(OGRE_SET_DISABLE_AMD_AGS 0)
@@ -157,12 +160,18 @@ endif()
 if (NOT OGRE_CONFIG_ENABLE_ASTC)
   set(OGRE_SET_DISABLE_ASTC 1)
 endif()
+if (NOT OGRE_CONFIG_ENABLE_KTX2)
+  set(OGRE_SET_DISABLE_KTX2 1)
+endif()
 if (NOT OGRE_CONFIG_ENABLE_FINE_LIGHT_MASK_GRANULARITY)
   set(OGRE_SET_DISABLE_FINE_LIGHT_MASK_GRANULARITY 1)
 endif()
 if (OGRE_CONFIG_ENABLE_LIGHT_OBB_RESTRAINT)
   set(OGRE_SET_ENABLE_LIGHT_OBB_RESTRAINT 1)
 endif()
+if (OGRE_CONFIG_COMPACT_OBJECT_HANDLES)
+  set(OGRE_SET_COMPACT_OBJECT_HANDLES 1)
+endif()
 if (NOT OGRE_CONFIG_ENABLE_ZIP)
   set(OGRE_SET_DISABLE_ZIP 1)
 endif()
@@ -203,6 +212,9 @@ endif()
 if (OGRE_SIMD_SSE2 OR OGRE_SIMD_NEON)
   set(OGRE_SET_USE_SIMD 1)
 endif()
+if (OGRE_SIMD_AVX2)
+  set(OGRE_SET_USE_AVX2 1)
+endif()
 if (OGRE_RESTRICT_ALIASING)
   set(OGRE_SET_RESTRICT_ALIASING 1)
 endif()
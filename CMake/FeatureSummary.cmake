@@ -33,6 +33,9 @@ endif ()
 if (OGRE_BUILD_COMPONENT_TERRAIN)
 	set(_components "${_components}  + Terrain\n")
 endif ()
+if (OGRE_BUILD_COMPONENT_TERRA)
+	set(_components "${_components}  + Terra\n")
+endif ()
 if (OGRE_BUILD_COMPONENT_RTSHADERSYSTEM)
 	set(_components "${_components}  + RTShader System\n")
 
@@ -126,12 +129,18 @@ endif ()
 if (OGRE_CONFIG_ENABLE_ASTC)
 	set(_core "${_core}  + ASTC image codec\n")
 endif ()
+if (OGRE_CONFIG_ENABLE_KTX2)
+	set(_core "${_core}  + KTX2 image codec\n")
+endif ()
 if (OGRE_CONFIG_ENABLE_FINE_LIGHT_MASK_GRANULARITY)
 	set(_core "${_core}  + Fine light mask granularity\n")
 endif ()
 if (OGRE_CONFIG_ENABLE_LIGHT_OBB_RESTRAINT)
 	set(_core "${_core}  + Light OBB Restraint\n")
 endif ()
+if (OGRE_CONFIG_COMPACT_OBJECT_HANDLES)
+	set(_core "${_core}  + Compact 32-bit ObjectData handles\n")
+endif ()
 if (OGRE_CONFIG_ENABLE_ZIP)
 	set(_core "${_core}  + ZIP archives\n")
 endif ()
@@ -182,6 +191,8 @@ elseif (OGRE_CONFIG_ALLOCATOR EQUAL 3)
 	set(_allocator "user")
 elseif (OGRE_CONFIG_ALLOCATOR EQUAL 4)
     set(_allocator "nedmalloc (pooling)")
+elseif (OGRE_CONFIG_ALLOCATOR EQUAL 6)
+    set(_allocator "thread-local pools")
 else ()
     set(_allocator "debug allocator tracker")
 endif()
@@ -204,6 +215,7 @@ var_to_string(OGRE_LEGACY_ANIMATIONS _use_legacy_animations)
 var_to_string(OGRE_USE_BOOST _boost)
 var_to_string(OGRE_SIMD_SSE2 _simdsse2)
 var_to_string(OGRE_SIMD_NEON _simdneon)
+var_to_string(OGRE_SIMD_AVX2 _simdavx2)
 # threading settings
 if (OGRE_CONFIG_THREADS EQUAL 0)
 	set(_threads "none")
@@ -233,6 +245,7 @@ set(_features "${_features}Use 1_x legacy animations:       ${_use_legacy_animat
 set(_features "${_features}Use Boost:                       ${_boost}\n")
 set(_features "${_features}Use SIMD (SSE2):                 ${_simdsse2}\n")
 set(_features "${_features}Use SIMD (NEON):                 ${_simdneon}\n")
+set(_features "${_features}FMA code-gen (OgreMain, AVX2):   ${_simdavx2}\n")
 
 
 set(_features "${_features}\n----------------------------------------------------------------------------\n")
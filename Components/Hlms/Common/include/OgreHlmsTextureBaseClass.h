@@ -88,6 +88,25 @@ namespace Ogre
 
         uint8                   mTexLocationInDescSet[OGRE_HLMS_TEXTURE_BASE_MAX_TEX];
 
+        struct PendingTexture
+        {
+            uint8   texType;
+            /// TextureTypes::TextureTypes
+            uint8   textureType;
+            uint32  textureFlags;
+            uint32  filters;
+            String  name;
+            String  aliasName;
+            String  resourceGroup;
+        };
+        typedef vector<PendingTexture>::type PendingTextureVec;
+
+        /// Textures set via _setPendingTexture that haven't been created yet.
+        /// Null when there are none (the common case) to keep datablocks small.
+        PendingTextureVec       *mPendingTextures;
+
+        void removePendingTexture( uint8 texType );
+
         void scheduleConstBufferUpdate( bool updateTextures=false, bool updateSamplers=false );
         void updateDescriptorSets( bool textureSetDirty, bool samplerSetDirty );
 
@@ -109,6 +128,8 @@ namespace Ogre
                                    bool saveOitd, bool saveOriginal,
                                    HlmsTextureExportListener *listener );
 
+        virtual void _notifyProjectedSize( uint32 pixels );
+
         /** Sets a new texture for rendering. Calling this function may trigger an
             HlmsDatablock::flushRenderables if the texture or the samplerblock changes.
             Might not be called if old and new texture belong to the same TexturePool.
@@ -139,6 +160,30 @@ namespace Ogre
                           const HlmsSamplerblock *samplerblockPtr=0,
                           uint16 sliceIdx=std::numeric_limits<uint16>::max() );
 
+        /** Same as _setTexture, but the TextureGpu isn't created (see
+            TextureGpuManager::createOrRetrieveTexture) until the datablock is used for
+            the first time by a Renderable. See resolvePendingTextures.
+            Until then getTexture returns null for texType.
+        @remarks
+            Used when loading materials with HlmsManager::setLoadTexturesLazily, so that
+            a big material library doesn't create (nor schedule loads of) the textures
+            of materials that end up never being used.
+        @param textureType
+            TextureTypes::TextureTypes
+        @param samplerblockPtr
+            See _setTexture. Set immediately, rather than when the texture is created.
+        */
+        void _setPendingTexture( uint8 texType, const String &name, const String &aliasName,
+                                 const String &resourceGroup, uint32 textureFlags,
+                                 uint8 textureType, uint32 filters,
+                                 const HlmsSamplerblock *samplerblockPtr );
+
+        /// Creates the textures set via _setPendingTexture, if any. Called automatically
+        /// when a Renderable starts using this datablock. Loading them still needs
+        /// loadAllTextures; in the meantime the usual fallback is displayed.
+        void resolvePendingTextures(void);
+        bool hasPendingTextures(void) const             { return mPendingTextures != 0; }
+
         /** Sets a new sampler block to be associated with the texture
             (i.e. filtering mode, addressing modes, etc). If the samplerblock changes,
             this function will always trigger a HlmsDatablock::flushRenderables
@@ -23,7 +23,8 @@ namespace Ogre
             const HlmsBlendblock *blendblock, const HlmsParamVec &params ) :
         HlmsDatablock( name, creator, macroblock, blendblock, params ),
         mTexturesDescSet( 0 ),
-        mSamplersDescSet( 0 )
+        mSamplersDescSet( 0 ),
+        mPendingTextures( 0 )
     {
         memset( mTexIndices, 0, sizeof( mTexIndices ) );
         memset( mTextures, 0, sizeof( mTextures ) );
@@ -35,6 +36,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     OGRE_HLMS_TEXTURE_BASE_CLASS::~OGRE_HLMS_TEXTURE_BASE_CLASS()
     {
+        OGRE_DELETE_T( mPendingTextures, PendingTextureVec, MEMCATEGORY_RESOURCE );
+        mPendingTextures = 0;
+
         for( size_t i=0; i<OGRE_HLMS_TEXTURE_BASE_MAX_TEX; ++i )
         {
             if( mTextures[i] )
@@ -90,6 +94,12 @@ namespace Ogre
             }
         }
 
+        if( mPendingTextures )
+        {
+            datablockImpl->mPendingTextures = OGRE_NEW_T( PendingTextureVec,
+                                                          MEMCATEGORY_RESOURCE )( *mPendingTextures );
+        }
+
         if( mTexturesDescSet )
             datablockImpl->mTexturesDescSet = hlmsManager->getDescriptorSetTexture( *mTexturesDescSet );
         if( mSamplersDescSet )
@@ -103,6 +113,8 @@ namespace Ogre
                                                      bool saveOitd, bool saveOriginal,
                                                      HlmsTextureExportListener *listener )
     {
+        resolvePendingTextures();
+
         for( size_t i=0; i<OGRE_HLMS_TEXTURE_BASE_MAX_TEX; ++i )
         {
             TextureGpu *texture = mTextures[i];
@@ -191,8 +203,21 @@ namespace Ogre
                 //the order of OGRE_HLMS_TEXTURE_BASE_MAX_TEX
                 if( mTexLocationInDescSet[i] == OGRE_HLMS_TEXTURE_BASE_MAX_TEX )
                 {
+                    //Different datablocks using different slices of the same pool end up
+                    //binding the same array. Put the pool's master texture in the set so
+                    //they share the same DescriptorSetTexture (and texture hash). Thus the
+                    //RenderQueue sorts them together and no rebind splits their draws.
+                    //Only once ready, otherwise we'd show the uninitialized slice.
+                    const TextureGpu *textureToBind = mTextures[i];
+                    const TexturePool *texturePool = mTextures[i]->getTexturePool();
+                    if( texturePool && mTextures[i]->_isDataReadyImpl() &&
+                        texturePool->masterTexture->_isDataReadyImpl() )
+                    {
+                        textureToBind = texturePool->masterTexture;
+                    }
+
                     mTexLocationInDescSet[i] = baseSet.mTextures.size();
-                    baseSet.mTextures.push_back( mTextures[i] );
+                    baseSet.mTextures.push_back( textureToBind );
                     if( !hasSeparateSamplers )
                         baseSampler.mSamplers.push_back( mSamplerblocks[i] );
                 }
@@ -328,6 +353,9 @@ namespace Ogre
     {
         assert( texType < OGRE_HLMS_TEXTURE_BASE_MAX_TEX );
 
+        if( mPendingTextures )
+            removePendingTexture( texType );
+
         bool textureSetDirty = false;
         bool samplerSetDirty = false;
 
@@ -386,12 +414,95 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void OGRE_HLMS_TEXTURE_BASE_CLASS::removePendingTexture( uint8 texType )
+    {
+        PendingTextureVec::iterator itor = mPendingTextures->begin();
+        PendingTextureVec::iterator end  = mPendingTextures->end();
+
+        while( itor != end && itor->texType != texType )
+            ++itor;
+
+        if( itor != end )
+        {
+            efficientVectorRemove( *mPendingTextures, itor );
+            if( mPendingTextures->empty() )
+            {
+                OGRE_DELETE_T( mPendingTextures, PendingTextureVec, MEMCATEGORY_RESOURCE );
+                mPendingTextures = 0;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void OGRE_HLMS_TEXTURE_BASE_CLASS::_setPendingTexture( uint8 texType, const String &name,
+                                                           const String &aliasName,
+                                                           const String &resourceGroup,
+                                                           uint32 textureFlags,
+                                                           uint8 textureType, uint32 filters,
+                                                           const HlmsSamplerblock *samplerblockPtr )
+    {
+        assert( texType < OGRE_HLMS_TEXTURE_BASE_MAX_TEX );
+
+        //Also removes any previous pending texture in this unit
+        _setTexture( texType, 0, samplerblockPtr );
+
+        if( !mPendingTextures )
+            mPendingTextures = OGRE_NEW_T( PendingTextureVec, MEMCATEGORY_RESOURCE )();
+
+        PendingTexture pendingTexture;
+        pendingTexture.texType      = texType;
+        pendingTexture.textureType  = textureType;
+        pendingTexture.textureFlags = textureFlags;
+        pendingTexture.filters      = filters;
+        pendingTexture.name         = name;
+        pendingTexture.aliasName    = aliasName;
+        pendingTexture.resourceGroup= resourceGroup;
+        mPendingTextures->push_back( pendingTexture );
+    }
+    //-----------------------------------------------------------------------------------
+    void OGRE_HLMS_TEXTURE_BASE_CLASS::resolvePendingTextures(void)
+    {
+        if( !mPendingTextures )
+            return;
+
+        //setTexture would modify mPendingTextures while we iterate
+        PendingTextureVec pendingTextures;
+        pendingTextures.swap( *mPendingTextures );
+        OGRE_DELETE_T( mPendingTextures, PendingTextureVec, MEMCATEGORY_RESOURCE );
+        mPendingTextures = 0;
+
+        TextureGpuManager *textureManager = mCreator->getRenderSystem()->getTextureGpuManager();
+
+        PendingTextureVec::const_iterator itor = pendingTextures.begin();
+        PendingTextureVec::const_iterator end  = pendingTextures.end();
+
+        while( itor != end )
+        {
+            TextureGpu *texture = textureManager->createOrRetrieveTexture(
+                                      itor->name, itor->aliasName, GpuPageOutStrategy::Discard,
+                                      itor->textureFlags,
+                                      static_cast<TextureTypes::TextureTypes>( itor->textureType ),
+                                      itor->resourceGroup, itor->filters );
+            //Keeps the samplerblock set by _setPendingTexture
+            setTexture( itor->texType, texture );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     TextureGpu* OGRE_HLMS_TEXTURE_BASE_CLASS::getTexture( uint8 texType ) const
     {
         assert( texType < OGRE_HLMS_TEXTURE_BASE_MAX_TEX );
         return mTextures[texType];
     }
     //-----------------------------------------------------------------------------------
+    void OGRE_HLMS_TEXTURE_BASE_CLASS::_notifyProjectedSize( uint32 pixels )
+    {
+        for( size_t i=0; i<OGRE_HLMS_TEXTURE_BASE_MAX_TEX; ++i )
+        {
+            if( mTextures[i] )
+                mTextures[i]->_notifyRequiredResolution( pixels );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void OGRE_HLMS_TEXTURE_BASE_CLASS::setSamplerblock( uint8 texType, const HlmsSamplerblock &params )
     {
         HlmsManager *hlmsManager = mCreator->getHlmsManager();
@@ -489,6 +600,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void OGRE_HLMS_TEXTURE_BASE_CLASS::loadAllTextures(void)
     {
+        resolvePendingTextures();
+
         if( !mAllowTextureResidencyChange )
             return;
 
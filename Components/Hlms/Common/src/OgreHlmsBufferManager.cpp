@@ -37,6 +37,7 @@ THE SOFTWARE.
 
 #include "CommandBuffer/OgreCommandBuffer.h"
 #include "CommandBuffer/OgreCbShaderBuffer.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -86,6 +87,7 @@ namespace Ogre
         //mTexBuffers must hold at least one buffer to prevent out of bound exceptions.
         if( mTexBuffers.empty() )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             size_t bufferSize = std::min<size_t>( mTextureBufferDefaultSize,
                                                   mVaoManager->getTexBufferMaxSize() );
             TexBufferPacked *newBuffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT, bufferSize,
@@ -119,6 +121,7 @@ namespace Ogre
 
         if( mCurrentConstBuffer >= mConstBuffers.size() )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             size_t bufferSize = std::min<size_t>( 65536, mVaoManager->getConstBufferMaxSize() );
             ConstBufferPacked *newBuffer = mVaoManager->createConstBuffer( bufferSize,
                                                                            BT_DYNAMIC_PERSISTENT,
@@ -190,6 +193,7 @@ namespace Ogre
 
             if( mCurrentTexBuffer >= mTexBuffers.size() )
             {
+                GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
                 size_t bufferSize = std::min<size_t>( mTextureBufferDefaultSize,
                                                       mVaoManager->getTexBufferMaxSize() );
                 TexBufferPacked *newBuffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT, bufferSize,
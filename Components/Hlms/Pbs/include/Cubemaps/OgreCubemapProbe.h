@@ -77,6 +77,10 @@ namespace Ogre
         /// False if it should be updated every frame. True if only updated when dirty
         bool    mStatic;
 
+        /// Number of frames this probe has been dirty but was postponed
+        /// due to ParallaxCorrectedCubemapBase::setMaxProbeUpdatesPerFrame
+        uint32  mPostponedFrames;
+
     public:
         /// While disabled, this probe won't be updated (even if dirty) and won't be considered
         /// for blending (i.e. won't be used at all).
@@ -67,6 +67,20 @@ namespace Ogre
     {
         CubemapProbeVec mDirtyProbes;
 
+        struct PendingProbe
+        {
+            /// Lower values are updated first
+            Real            priority;
+            CubemapProbe    *probe;
+
+            bool operator < ( const PendingProbe &other ) const
+            {
+                return this->priority < other.priority;
+            }
+        };
+        /// Dirty static probes competing for the budget. @see setMaxProbeUpdatesPerFrame
+        FastArray<PendingProbe> mPendingProbes;
+
         /// This variable should be updated every frame and often represents the camera position,
         /// but it can also be used set to other things like the player's character position.
         public: Vector3                 mTrackedPosition;
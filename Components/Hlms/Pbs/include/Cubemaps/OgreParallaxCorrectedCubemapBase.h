@@ -65,6 +65,18 @@ namespace Ogre
         Pass            *mPccCompressorPass;
         CubemapProbe    *mProbeRenderInProgress;
 
+        /// @see setMaxProbeUpdatesPerFrame
+        uint32          mMaxProbeUpdatesPerFrame;
+        uint32          mNumProbeUpdatesThisFrame;
+
+        /** Call this before re-rendering a dirty static probe.
+        @return
+            True if the budget allows it; the update is then counted against this frame's
+            budget. False if the probe must wait (keeping its current contents) until
+            a later frame.
+        */
+        bool consumeProbeUpdateBudget(void);
+
     public:
         ParallaxCorrectedCubemapBase( IdType id, Root *root, SceneManager *sceneManager,
                                       const CompositorWorkspaceDef *probeWorkspaceDef,
@@ -91,6 +103,20 @@ namespace Ogre
 
         const CubemapProbeVec& getProbes(void) const        { return mProbes; }
 
+        /** Limits how many dirty static probes get re-rendered (all of their faces and their
+            mipmap / IBL filtering) in the same frame. The rest stay dirty and keep
+            their current contents until their turn comes in the following frames.
+        @remarks
+            Probes that are updated every frame (non-static) are not affected.
+            With ParallaxCorrectedCubemapAuto, waiting probes are prioritized by their
+            distance to mTrackedPosition, and by how many frames they have been waiting.
+            updateAllDirtyProbes ignores this limit.
+        @param maxUpdates
+            Maximum number of dirty static probes to update per frame. 0 for no limit (default).
+        */
+        void setMaxProbeUpdatesPerFrame( uint32 maxUpdates );
+        uint32 getMaxProbeUpdatesPerFrame(void) const   { return mMaxProbeUpdatesPerFrame; }
+
         bool getAutomaticMode(void) const               { return mAutomaticMode; }
         bool getUseDpm2DArray(void) const               { return mUseDpm2DArray; }
 
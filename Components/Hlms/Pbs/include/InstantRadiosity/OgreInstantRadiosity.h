@@ -52,6 +52,18 @@ namespace Ogre
 
     class _OgreHlmsPbsExport InstantRadiosity
     {
+        /// Node of a mesh's triangle BVH, in local space.
+        /// When numTris == 0 it's an inner node and its children are
+        /// at firstChildOrTri & firstChildOrTri + 1; otherwise it is a leaf and
+        /// its triangles are bvhTriangles[firstChildOrTri] onwards.
+        struct BvhNode
+        {
+            Vector3 aabbMin;
+            Vector3 aabbMax;
+            uint32  firstChildOrTri;
+            uint32  numTris;
+        };
+
         struct MeshData
         {
             float * RESTRICT_ALIAS vertexData;
@@ -66,7 +78,17 @@ namespace Ogre
             size_t  numIndices;
             bool    useIndices16bit;
 
+            /// Built right after downloading, so that rays don't need
+            /// to be tested against every triangle. bvhNodes[0] is the root.
+            BvhNode * RESTRICT_ALIAS bvhNodes;
+            /// Index of the first vertex (i.e. i in [0; numElements) step 3) of every
+            /// triangle, sorted so that the triangles in a leaf are contiguous.
+            uint32 * RESTRICT_ALIAS bvhTriangles;
+            size_t  numBvhNodes;
+
             float* getUvStart( uint8_t uvSet ) const;
+            void getTriangleIndices( uint32 triStart, uint32 outVertexIdx[3] ) const;
+            void getTriangle( uint32 triStart, Vector3 outTriVerts[3] ) const;
         };
 
         struct MaterialData
@@ -269,6 +291,13 @@ namespace Ogre
         size_t generateRayBounces( size_t raySrcStart, size_t raySrcCount,
                                    size_t raysToGenerate, RandomNumberGenerator &rng);
 
+        /// Builds meshData's triangle BVH. Must be called once after vertexData &
+        /// indexData have been downloaded. See freeMeshBvh
+        static void buildMeshBvh( MeshData &meshData );
+        static void buildMeshBvhNode( MeshData &meshData, const Vector3 *centroids,
+                                      uint32 nodeIdx, uint32 triStart, uint32 numTris );
+        static void freeMeshBvh( MeshData &meshData );
+
         const MeshData* downloadVao( VertexArrayObject *vao );
         const MeshData* downloadRenderOp( const v1::RenderOperation &renderOp );
         const Image2& downloadTexture( TextureGpu *texture );
@@ -149,6 +149,16 @@ namespace Ogre
             DebugVisualizationNone
         };
 
+        enum ProbeState
+        {
+            /// The probe needs to be (re)generated by update()
+            ProbeStateDirty,
+            /// The probe is up to date
+            ProbeStateUpdated,
+            /// The probe is skipped by update(). See setProbesInactive
+            ProbeStateInactive
+        };
+
     protected:
         struct IrradianceFieldGenParams
         {
@@ -181,9 +191,17 @@ namespace Ogre
         };
 
         IrradianceFieldSettings mSettings;
-        /// Number of probes processed so far.
+        /// First probe of the contiguous range being processed by update().
         /// We process the entire field across multiple frames.
-        uint32 mNumProbesProcessed;
+        uint32 mFirstProbeToProcess;
+        /// One ProbeState per probe
+        vector<uint8>::type mProbeStates;
+        /// Number of probes in mProbeStates which are ProbeStateDirty
+        uint32 mNumDirtyProbes;
+
+        /// See setUpdateFocus
+        Vector3 mUpdateFocus;
+        bool mUseUpdateFocus;
 
         Vector3 mFieldOrigin;
         Vector3 mFieldSize;
@@ -244,6 +262,9 @@ namespace Ogre
 
         void setTextureToDebugVisualizer( void );
 
+        /// Returns the first probe of the range of probesPerFrame probes update() will process
+        uint32 findFirstProbeToProcess( uint32 probesPerFrame ) const;
+
     public:
         IrradianceField( Root *root, SceneManager *sceneManager );
         ~IrradianceField();
@@ -270,6 +291,47 @@ namespace Ogre
         /// If major changes happens to VctLighting, then call initialize() again
         void reset();
 
+        /** Flags the probes whose center is inside the given AABB as dirty, so that update()
+            processes them again, but without touching the rest of the field like reset() does.
+            Useful when a dynamic light moves or turns on/off, or when geometry changes.
+        @param aabb
+            In world space
+        */
+        void addDirtyRegion( const Aabb &aabb );
+
+        /** Flags the probes whose center is inside the given AABB as inactive, i.e. update()
+            won't spend time on them. Useful for probes that are inside walls or other
+            solid geometry, where the results are useless.
+        @remarks
+            The contents of an inactive probe are left as is.
+            The raster path skips them entirely; the VCT path processes contiguous ranges of
+            probes, thus inactive probes are only saved from the work when the whole range is
+            inactive.
+        @param aabb
+            In world space
+        @param bInactive
+            False to reactivate them. Reactivated probes are flagged as dirty
+        */
+        void setProbesInactive( const Aabb &aabb, bool bInactive );
+
+        ProbeState getProbeState( size_t probeIdx ) const;
+
+        /// Returns the center of the probe in world space
+        Vector3 getProbeCenter( size_t probeIdx ) const;
+
+        /** By default update() processes the dirty probes in order (i.e. X first, then Y,
+            then Z). When a focus is set, the dirty probes closest to it are processed first;
+            so that the region the camera sees converges sooner.
+        @param focusPos
+            Usually the camera position, in world space. Call it every frame if it moves.
+        */
+        void setUpdateFocus( const Vector3 &focusPos );
+        /// Restores the default order. See setUpdateFocus
+        void clearUpdateFocus( void );
+
+        /// Returns true if there's nothing left for update() to do
+        bool isFullyUpdated( void ) const { return mNumDirtyProbes == 0u; }
+
         void update( uint32 probesPerFrame = 200u );
 
         size_t getConstBufferSize( void ) const;
@@ -83,8 +83,6 @@ namespace Ogre
 
         Camera *mCamera;
 
-        Vector3 getProbeCenter( size_t probeIdx ) const;
-
     public:
         IrradianceFieldRaster( IrradianceField *creator );
         virtual ~IrradianceFieldRaster();
@@ -120,8 +120,22 @@ namespace Ogre
             FastArray<float>    pixelShaderSharedBuffer;
 
             Matrix4 viewMatrix;
+            /// When true, the static path sends the previous frame's world matrix
+            /// in place of worldView. See CompositorPassSceneDef::mGenMotionVectors
+            bool sendPrevWorldMat;
         };
 
+        /// ViewProj matrices of each camera across frames, for motion vectors.
+        /// Always stored without texture flipping.
+        struct CameraMotionHistory
+        {
+            Camera const    *camera;
+            Matrix4         prevViewProj;
+            Matrix4         currentViewProj;
+            uint32          lastFrame;
+        };
+        typedef vector<CameraMotionHistory>::type CameraMotionHistoryVec;
+
         PassData                mPreparedPass;
         ConstBufferPackedVec    mPassBuffers;
         ConstBufferPackedVec    mLight0Buffers; // lights
@@ -136,6 +150,13 @@ namespace Ogre
         float                   mInvPccVctInvDistance;
 
         uint32                  mCurrentPassBuffer;     /// Resets to zero every new frame.
+        /// Index in mPassBuffers of the buffer holding the current pass' data. Usually
+        /// mCurrentPassBuffer - 1, unless deduplicated. @see setDeduplicatePassBuffers
+        uint32                  mBoundPassBuffer;
+        /// CPU copy of what was uploaded to each mPassBuffers this frame, and scratch memory
+        /// where the current pass is built. Only used when mDeduplicatePassBuffers is true.
+        vector< FastArray<float> >::type mPassBufferContents;
+        FastArray<float>        mPassBufferScratch;
 
         TexBufferPacked         *mGridBuffer;
         TexBufferPacked         *mGlobalLightListBuffer;
@@ -187,6 +208,28 @@ namespace Ogre
         bool mHasSeparateSamplers;
         DescriptorSetTexture const *mLastDescTexture;
         DescriptorSetSampler const *mLastDescSampler;
+
+        /// Last bone palette uploaded by fillBuffersForV2, so consecutive draws using
+        /// the same skeleton & bone mapping (e.g. SubItems of the same Item) can reuse it.
+        struct LastSkinning
+        {
+            SkeletonInstance const          *skeleton;
+            FastArray<unsigned short> const *indexMap;
+            float const                     *texBufferStart;
+            uint32                          texBufferIdx;
+            size_t                          distToWorldMatStart;
+
+            LastSkinning() :
+                skeleton( 0 ), indexMap( 0 ), texBufferStart( 0 ),
+                texBufferIdx( 0 ), distToWorldMatStart( 0 ) {}
+        };
+        LastSkinning mLastSkinning;
+
+        /// Bone matrices of the GpuSkeletonEvaluator bound to the vertex shader (hlms_skeleton_gpu)
+        TexBufferPacked const *mLastBoundGpuBoneMatrices;
+
+        CameraMotionHistoryVec mCameraMotionHistory;
+
         uint8 mReservedTexSlots;
 #if !OGRE_NO_FINE_LIGHT_MASK_GRANULARITY
         bool mFineLightMaskGranularity;
@@ -194,6 +237,7 @@ namespace Ogre
         bool mSetupWorldMatBuf;
         bool mDebugPssmSplits;
         bool mPerceptualRoughness;
+        bool mCompactInstanceData;
 
         bool mAutoSpecIblMaxMipmap;
         bool mVctFullConeCount;
@@ -204,6 +248,7 @@ namespace Ogre
 #endif
 
         bool mUseLightBuffers;
+        bool mDeduplicatePassBuffers;
 
         ShadowFilter    mShadowFilter;
         uint16          mEsmK; /// K parameter for ESM.
@@ -214,6 +259,8 @@ namespace Ogre
                                                          uint32 finalHash,
                                                          const QueuedRenderable &queuedRenderable );
 
+        virtual bool supportsPsoWarmUp(void) const                  { return true; }
+
         virtual HlmsDatablock* createDatablockImpl( IdString datablockName,
                                                     const HlmsMacroblock *macroblock,
                                                     const HlmsBlendblock *blendblock,
@@ -233,6 +280,12 @@ namespace Ogre
 
         static bool requiredPropertyByAlphaTest( IdString propertyName );
 
+        /** Returns the viewProj matrix the camera had last frame, and records the current one.
+        @param viewProj
+            Current viewProj matrix, without texture flipping.
+        */
+        const Matrix4& getPrevFrameViewProj( const Camera *camera, const Matrix4 &viewProj );
+
         virtual void destroyAllBuffers(void);
 
         FORCEINLINE uint32 fillBuffersFor( const HlmsCache *cache,
@@ -326,6 +379,18 @@ namespace Ogre
         void setPerceptualRoughness( bool bPerceptualRoughness );
         bool getPerceptualRoughness( void ) const;
 
+        /** When enabled, non-caster passes only send the world matrix per instance (16 floats
+            instead of 32). The shader goes to view space through the pass' view matrix
+            instead of a per-instance worldView matrix, halving the instance data bandwidth
+            of static (non-skeletal, non-pose) objects at the cost of a few extra ALU ops.
+        @remarks
+            Takes effect on the next pass. Custom pieces that read 'worldView' in the vertex
+            shader won't compile with this enabled; use worldMat and passBuf.view instead.
+            Default is false.
+        */
+        void setCompactInstanceData( bool compactInstanceData );
+        bool getCompactInstanceData(void) const             { return mCompactInstanceData; }
+
         void setShadowSettings( ShadowFilter filter );
         ShadowFilter getShadowFilter(void) const            { return mShadowFilter; }
 
@@ -430,6 +495,19 @@ namespace Ogre
         void setUseLightBuffers(bool b);
         bool getUseLightBuffers() { return mUseLightBuffers; }
 
+        /** When enabled, the pass buffer is built in CPU memory and, if it's byte-for-byte
+            identical to one already uploaded this frame (e.g. a depth prepass followed by
+            the opaque and transparent passes of the same camera, or shadow maps that
+            didn't change), the data isn't uploaded again and the existing buffer is bound.
+        @remarks
+            This trades a memcmp per previously uploaded pass for the redundant GPU writes
+            and the extra const buffer. It is ignored while setUseLightBuffers is enabled,
+            since the light data lives in separate buffers.
+            Default is false.
+        */
+        void setDeduplicatePassBuffers( bool deduplicate );
+        bool getDeduplicatePassBuffers(void) const  { return mDeduplicatePassBuffers; }
+
 #if !OGRE_NO_JSON
         /// @copydoc Hlms::_loadJson
         virtual void _loadJson( const rapidjson::Value &jsonValue, const HlmsJson::NamedBlocks &blocks,
@@ -456,6 +534,7 @@ namespace Ogre
         static const IdString LowerGpuOverhead;
         static const IdString DebugPssmSplits;
         static const IdString PerceptualRoughness;
+        static const IdString CompactInstanceData;
         static const IdString HasPlanarReflections;
 
         static const IdString NumTextures;
@@ -96,9 +96,13 @@ namespace Ogre
            we perform GPU -> GPU copies. We can't use the buffers directly because in many
            APIs we can't bind the index buffer as an UAV easily.
            This step is handled by VctVoxelizer::buildMeshBuffers.
-           Not implemented yet: when rebuilding the voxelized scene, this step can be skipped
-           if no meshes were added since the last change (and the buffers weren't freed
-           to save memory)
+           When rebuilding the voxelized scene, this step (and the calculation of the
+           local space AABBs of each mesh) is skipped if no meshes were added or removed
+           since the last build; i.e. if only Items moved or Items of meshes we already
+           had were added.
+           When it can't be skipped, VctVoxelizer::setMeshCacheEnabled avoids downloading
+           again the meshes that were already converted, and the cache can be persisted
+           to disk with VctVoxelizer::saveMeshCache.
 
         2. Iterate through every Item and convert the datablocks to the simplified version
            our compute shader uses. VctMaterial handles this; done in
@@ -175,10 +179,21 @@ namespace Ogre
         typedef map<MeshPtr, QueuedMesh>::type MeshPtrMap;
 #endif
         typedef FastArray<Item*> ItemArray;
+        /// Vertices of a mesh as written by convertMeshUncompressed, keyed by
+        /// VctVoxelizer::calculateMeshHash
+        typedef map<uint64, FastArray<float> >::type MeshVertexCacheMap;
 
         v1MeshPtrMap    mMeshesV1;
         MeshPtrMap      mMeshesV2;
 
+        MeshVertexCacheMap  mMeshVertexCache;
+        bool                mMeshCacheEnabled;
+        /// When false, the mesh buffers from the last build are still valid thus
+        /// buildMeshBuffers can be skipped
+        bool                mMeshBuffersDirty;
+        /// When false, mMeshAabb (local space AABBs of each partitioned submesh) is still valid
+        bool                mMeshAabbsDirty;
+
         ItemArray       mItems;
 
         /// HlmsComputeJob have internal caches, thus we could dynamically change properties
@@ -266,6 +281,13 @@ namespace Ogre
 
         FastArray<Octant> mOctants;
 
+        /// When true, VctVoxelizer::update will perform a full VctVoxelizer::build
+        bool                mFullRebuildNeeded;
+        /// Regions queued via VctVoxelizer::addDirtyRegion, in world space
+        FastArray<Aabb>     mDirtyRegions;
+        /// mDirtyRegions converted to voxel blocks aligned to the threadgroup size
+        FastArray<Octant>   mDirtyOctants;
+
         ResourceTransition mStartupTrans;
         ResourceTransition mAfterClearTrans;
         ResourceTransition mAfterAabbCalculatorTrans;
@@ -290,8 +312,22 @@ namespace Ogre
         void countBuffersSize( const MeshPtr &mesh, QueuedMesh &queuedMesh );
         void prepareAabbCalculatorMeshData(void);
         void destroyAabbCalculatorMeshData(void);
+        /**
+        @param cachedVertices
+            When not null, the vertices are copied from it (see mMeshVertexCache)
+            instead of being downloaded from the GPU and converted.
+        */
         void convertMeshUncompressed( const MeshPtr &mesh, QueuedMesh &queuedMesh,
-                                      MappedBuffers &mappedBuffers );
+                                      MappedBuffers &mappedBuffers,
+                                      const float *cachedVertices );
+        /// Same as convertMeshUncompressed, but goes through mMeshVertexCache
+        void convertMeshUncompressedCached( const MeshPtr &mesh, QueuedMesh &queuedMesh,
+                                            MappedBuffers &mappedBuffers );
+
+        /// Hash of the name, layout and bounds of the mesh. Used as key of mMeshVertexCache
+        static uint64 calculateMeshHash( const MeshPtr &mesh );
+        /// Number of vertices convertMeshUncompressed writes for the mesh
+        static size_t countMeshVertices( const MeshPtr &mesh );
 
         void freeBuffers( bool bForceFree );
 
@@ -302,9 +338,9 @@ namespace Ogre
 
         void placeItemsInBuckets(void);
         size_t countSubMeshPartitionsIn( Item *item ) const;
-        void createInstanceBuffers(void);
+        void createInstanceBuffers( size_t numOctants );
         void destroyInstanceBuffers(void);
-        void fillInstanceBuffers(void);
+        void fillInstanceBuffers( const FastArray<Octant> &octants );
 
         void computeMeshAabbs(void);
 
@@ -313,6 +349,22 @@ namespace Ogre
 
         void clearVoxels(void);
 
+        /** Converts mDirtyRegions into mDirtyOctants
+        @returns
+            False if none of the dirty regions overlaps the voxelized region
+        */
+        bool convertDirtyRegionsToOctants(void);
+
+        /** Culls the instances against each octant and dispatches the voxelizer for each of them
+        @param octants
+            Blocks of voxels to voxelize. Their offsets and sizes must be multiple of the
+            threadgroup size.
+        @param bClearOctants
+            When true, the previous contents of each octant are replaced.
+            When false, the whole voxel volume is cleared first.
+        */
+        void voxelizeOctants( const FastArray<Octant> &octants, bool bClearOctants );
+
     public:
         VctVoxelizer( IdType id, RenderSystem *renderSystem, HlmsManager *hlmsManager,
                       bool correctAreaLightShadows );
@@ -351,6 +403,34 @@ namespace Ogre
         /// Removes all items added via VctVoxelizer::addItem
         void removeAllItems(void);
 
+        /** When enabled, a CPU copy of each mesh converted to the format the voxelizer
+            uses is kept; thus a build that has to rebuild the mesh buffers (because meshes
+            were added or removed) doesn't download from the GPU again the meshes it
+            already converted.
+        @remarks
+            Costs 32 bytes of RAM per vertex. Disabled by default.
+            Disabling it clears the cache.
+        */
+        void setMeshCacheEnabled( bool bEnabled );
+        bool getMeshCacheEnabled(void) const                { return mMeshCacheEnabled; }
+
+        /** Forgets all the converted meshes and forces the next build to convert the meshes
+            again.
+        @remarks
+            The cache is keyed by a hash of the name, vertex & index counts, vertex layout and
+            bounds of each mesh. Call this function if a mesh's vertices were modified without
+            changing any of them.
+        */
+        void clearMeshCache(void);
+
+        /** Saves the meshes cached when setMeshCacheEnabled( true ) to disk so that later
+            runs can skip converting them. See loadMeshCache.
+        */
+        void saveMeshCache( DataStreamPtr &dataStream ) const;
+        /// Loads a cache saved with saveMeshCache, and enables the mesh cache.
+        /// Entries already in the cache are overwritten
+        void loadMeshCache( DataStreamPtr &dataStream );
+
         /** Call this function before VctVoxelizer::autoCalculateRegion
         @param autoRegion
             True to autocalculate region to cover all the added items
@@ -380,6 +460,27 @@ namespace Ogre
 
         void build( SceneManager *sceneManager );
 
+        /** Queues a region to be voxelized again in the next call to VctVoxelizer::update.
+            Use it when an Item that was added moved, or its material changed.
+        @remarks
+            When an Item moves, the region must cover both its old and new bounds.
+            The region gets expanded to the voxelizer's threadgroup size (4x4x4 voxels).
+        @param region
+            World space region.
+        */
+        void addDirtyRegion( const Aabb &region );
+
+        /** Voxelizes again only the regions queued via VctVoxelizer::addDirtyRegion,
+            which is much cheaper than VctVoxelizer::build when the dirty regions are small.
+        @remarks
+            Performs a full VctVoxelizer::build instead if something that affects the whole
+            volume changed since the last build (i.e. Items were added or removed, the
+            resolution, region or octants changed).
+
+            Like after VctVoxelizer::build, VctLighting::update must be called again afterwards.
+        */
+        void update( SceneManager *sceneManager );
+
         void setDebugVisualization( VctVoxelizer::DebugVisualizationMode mode,
                                     SceneManager *sceneManager );
         VctVoxelizer::DebugVisualizationMode getDebugVisualizationMode(void) const;
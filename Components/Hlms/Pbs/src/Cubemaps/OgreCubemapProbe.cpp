@@ -47,6 +47,7 @@ THE SOFTWARE.
 
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -68,6 +69,7 @@ namespace Ogre
         mNumDatablockUsers( 0 ),
         mPriority( 10u ),
         mStatic( true ),
+        mPostponedFrames( 0 ),
         mEnabled( true ),
         mDirty( true ),
         mNumIterations( 8 ),
@@ -293,6 +295,7 @@ namespace Ogre
     void CubemapProbe::setTextureParams( uint32 width, uint32 height, bool useManual,
                                          PixelFormatGpu pf, bool isStatic, SampleDescription sampleDesc )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         if( !mCreator->getAutomaticMode() )
         {
             float cameraNear = 0.5;
@@ -354,6 +357,7 @@ namespace Ogre
                                       const CompositorChannelVec &additionalChannels,
                                       uint8 executionMask )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         assert( (mTexture != 0 || mCreator->getAutomaticMode()) && "Call setTextureParams first!" );
 
         destroyWorkspace();
@@ -596,6 +600,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CubemapProbe::_addReference(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         OGRE_ASSERT_LOW( !mCreator->getAutomaticMode() );
 
         ++mNumDatablockUsers;
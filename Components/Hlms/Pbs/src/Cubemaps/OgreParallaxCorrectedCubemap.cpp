@@ -62,6 +62,7 @@ THE SOFTWARE.
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreStagingBuffer.h"
 #include "Vao/OgreVaoManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -266,6 +267,7 @@ namespace Ogre
     void ParallaxCorrectedCubemap::setEnabled( bool bEnabled, uint32 maxWidth,
                                                uint32 maxHeight, PixelFormatGpu pixelFormat )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         if( bEnabled == getEnabled() )
             return;
 
@@ -315,6 +317,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void ParallaxCorrectedCubemap::createProxyGeometry(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         //Create the mesh geometry
         const Vector3 c_vertices[8] =
         {
@@ -489,6 +492,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void ParallaxCorrectedCubemap::createCubemapBlendWorkspace(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         mBlendProxyCamera = mSceneManager->createCamera( "ParallaxCorrectedCubemap for blending " +
                                                          StringConverter::toString( getId() ),
                                                          false );
@@ -720,6 +724,7 @@ namespace Ogre
         const CubemapProbe *prevProbe = mCollectedProbes[0];
 
         mCurrentMip = 0;
+        mNumProbeUpdatesThisFrame = 0;
 
         for( size_t i=0; i<OGRE_MAX_CUBE_PROBES; ++i )
         {
@@ -894,7 +899,8 @@ namespace Ogre
         for( size_t i=0; i<mNumCollectedProbes; ++i )
         {
             if( (mCollectedProbes[i]->mDirty || !mCollectedProbes[i]->mStatic) &&
-                mCollectedProbes[i]->mNumIterations > iterationThreshold )
+                mCollectedProbes[i]->mNumIterations > iterationThreshold &&
+                (!mCollectedProbes[i]->mStatic || consumeProbeUpdateBudget()) )
             {
                 setFinalProbeTo( i );
 
@@ -929,7 +935,10 @@ namespace Ogre
 
         for( size_t i=0; i<mNumCollectedProbes; ++i )
         {
-            if( mCollectedProbes[i]->mDirty || !mCollectedProbes[i]->mStatic )
+            //Collected probes are sorted by weight, thus the most relevant
+            //ones get the budget first. The rest keep their old contents.
+            if( !mCollectedProbes[i]->mStatic ||
+                (mCollectedProbes[i]->mDirty && consumeProbeUpdateBudget()) )
             {
                 setFinalProbeTo( i );
 
@@ -994,6 +1003,10 @@ namespace Ogre
     {
         mSceneManager->updateSceneGraph();
 
+        //We're updating everything at once (i.e. loading time). Ignore the budget
+        const uint32 maxProbeUpdatesPerFrame = mMaxProbeUpdatesPerFrame;
+        mMaxProbeUpdatesPerFrame = 0u;
+
         const uint32 systemMask = mMask;
 
         CubemapProbeVec::const_iterator itor = mProbes.begin();
@@ -1014,6 +1027,8 @@ namespace Ogre
 
         mSceneManager->clearFrameData();
 
+        mMaxProbeUpdatesPerFrame = maxProbeUpdatesPerFrame;
+
         //Set to 0 so next time mBlendedProbeNeedsUpdate will be set to true correctly;
         mNumCollectedProbes = 0;
     }
@@ -1081,6 +1096,7 @@ namespace Ogre
     TextureGpu *ParallaxCorrectedCubemap::findRtt( const TextureGpu *baseParams, TempRttVec &container,
                                                    uint32 textureFlags, bool fullMipmaps )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         TextureGpu *retVal = 0;
 
         TempRttVec::iterator itor = container.begin();
@@ -63,6 +63,7 @@ THE SOFTWARE.
 
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreStagingBuffer.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -193,6 +194,7 @@ namespace Ogre
                                                    uint32 height, uint32 maxNumProbes,
                                                    PixelFormatGpu pixelFormat )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         if( bEnabled == getEnabled() )
             return;
 
@@ -341,6 +343,8 @@ namespace Ogre
     void ParallaxCorrectedCubemapAuto::updateSceneGraph(void)
     {
         mDirtyProbes.clear();
+        mPendingProbes.clear();
+        mNumProbeUpdatesThisFrame = 0;
 
         const uint32 systemMask = mMask;
 
@@ -353,11 +357,28 @@ namespace Ogre
 
             const Vector3 posLS = probe->mInvOrientation * (mTrackedPosition - probe->mArea.mCenter);
             const Aabb areaLS = probe->getAreaLS();
-            if( ((areaLS.contains( posLS ) && !probe->mStatic) || probe->mDirty) &&
+            const bool insideArea = areaLS.contains( posLS );
+            if( ((insideArea && !probe->mStatic) || probe->mDirty) &&
                 probe->mEnabled && probe->mTexture &&
                 (probe->mMask & systemMask) )
             {
-                mDirtyProbes.push_back( probe );
+                if( !probe->mStatic || mMaxProbeUpdatesPerFrame == 0u )
+                    mDirtyProbes.push_back( probe );
+                else
+                {
+                    //Distance to the probe's area (0 if inside), made smaller
+                    //the longer the probe has been waiting so it can't starve
+                    Vector3 distLS( Math::Abs( posLS.x ), Math::Abs( posLS.y ),
+                                    Math::Abs( posLS.z ) );
+                    distLS -= areaLS.mHalfSize;
+                    distLS.makeCeil( Vector3::ZERO );
+
+                    PendingProbe pendingProbe;
+                    pendingProbe.priority   = distLS.length() /
+                                              Real( 1u + probe->mPostponedFrames );
+                    pendingProbe.probe      = probe;
+                    mPendingProbes.push_back( pendingProbe );
+                }
             }
 
             if( probe->mInternalProbe )
@@ -369,6 +390,29 @@ namespace Ogre
             ++itor;
         }
 
+        if( !mPendingProbes.empty() )
+        {
+            std::sort( mPendingProbes.begin(), mPendingProbes.end() );
+
+            FastArray<PendingProbe>::const_iterator itPending = mPendingProbes.begin();
+            FastArray<PendingProbe>::const_iterator enPending = mPendingProbes.end();
+
+            while( itPending != enPending )
+            {
+                CubemapProbe *probe = itPending->probe;
+                if( consumeProbeUpdateBudget() )
+                {
+                    probe->mPostponedFrames = 0;
+                    mDirtyProbes.push_back( probe );
+                }
+                else
+                {
+                    ++probe->mPostponedFrames;
+                }
+                ++itPending;
+            }
+        }
+
         itor = mDirtyProbes.begin();
         end  = mDirtyProbes.end();
 
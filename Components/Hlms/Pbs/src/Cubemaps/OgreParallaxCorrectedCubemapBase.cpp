@@ -77,7 +77,9 @@ namespace Ogre
         mSceneManager( sceneManager ),
         mDefaultWorkspaceDef( probeWorkspcDef ),
         mPccCompressorPass( 0 ),
-        mProbeRenderInProgress( 0 )
+        mProbeRenderInProgress( 0 ),
+        mMaxProbeUpdatesPerFrame( 0 ),
+        mNumProbeUpdatesThisFrame( 0 )
     {
         HlmsManager *hlmsManager = mRoot->getHlmsManager();
         HlmsSamplerblock samplerblock;
@@ -103,6 +105,21 @@ namespace Ogre
         mSamplerblockTrilinear = 0;
     }
     //-----------------------------------------------------------------------------------
+    bool ParallaxCorrectedCubemapBase::consumeProbeUpdateBudget(void)
+    {
+        if( mMaxProbeUpdatesPerFrame != 0u &&
+            mNumProbeUpdatesThisFrame >= mMaxProbeUpdatesPerFrame )
+            return false;
+
+        ++mNumProbeUpdatesThisFrame;
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void ParallaxCorrectedCubemapBase::setMaxProbeUpdatesPerFrame( uint32 maxUpdates )
+    {
+        mMaxProbeUpdatesPerFrame = maxUpdates;
+    }
+    //-----------------------------------------------------------------------------------
     uint32 ParallaxCorrectedCubemapBase::getIblTargetTextureFlags( PixelFormatGpu pixelFormat ) const
     {
         const RenderSystemCapabilities *caps =
@@ -62,6 +62,25 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    /// Leaves with this many triangles (or less) aren't split any further.
+    static const uint32 c_maxTrisPerBvhLeaf = 4u;
+
+    /// Sorts the triangles (referenced by the index of their first vertex) by their
+    /// centroid along the given axis.
+    struct BvhCentroidCompare
+    {
+        Vector3 const *centroids;
+        size_t axis;
+
+        BvhCentroidCompare( const Vector3 *_centroids, size_t _axis ) :
+            centroids( _centroids ), axis( _axis ) {}
+
+        bool operator () ( uint32 _l, uint32 _r ) const
+        {
+            return centroids[_l / 3u][axis] < centroids[_r / 3u][axis];
+        }
+    };
+
     class RandomNumberGenerator
     {
 #if OGRE_PLATFORM == OGRE_PLATFORM_APPLE ||\
@@ -754,6 +773,105 @@ namespace Ogre
         return raysToGenerate - raysRemaining;
     }
     //-----------------------------------------------------------------------------------
+    void InstantRadiosity::buildMeshBvh( MeshData &meshData )
+    {
+        meshData.bvhNodes = 0;
+        meshData.bvhTriangles = 0;
+        meshData.numBvhNodes = 0;
+
+        const size_t numElements = meshData.indexData ? meshData.numIndices : meshData.numVertices;
+        const uint32 numTris = static_cast<uint32>( numElements / 3u );
+
+        if( !numTris )
+            return;
+
+        meshData.bvhTriangles = reinterpret_cast<uint32*>(
+                    OGRE_MALLOC_SIMD( sizeof(uint32) * numTris, MEMCATEGORY_GEOMETRY ) );
+        //A binary tree with up to numTris leaves can't have more than numTris * 2 - 1 nodes
+        meshData.bvhNodes = reinterpret_cast<BvhNode*>(
+                    OGRE_MALLOC_SIMD( sizeof(BvhNode) * (numTris * 2u - 1u),
+                                      MEMCATEGORY_GEOMETRY ) );
+
+        FastArray<Vector3> centroids;
+        centroids.resize( numTris );
+        for( uint32 i=0; i<numTris; ++i )
+        {
+            Vector3 triVerts[3];
+            meshData.getTriangle( i * 3u, triVerts );
+            centroids[i] = (triVerts[0] + triVerts[1] + triVerts[2]) / Real( 3.0 );
+            meshData.bvhTriangles[i] = i * 3u;
+        }
+
+        meshData.numBvhNodes = 1u;
+        buildMeshBvhNode( meshData, centroids.begin(), 0, 0, numTris );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::buildMeshBvhNode( MeshData &meshData, const Vector3 *centroids,
+                                             uint32 nodeIdx, uint32 triStart, uint32 numTris )
+    {
+        BvhNode &node = meshData.bvhNodes[nodeIdx];
+
+        node.aabbMin = Vector3( std::numeric_limits<Real>::max() );
+        node.aabbMax = -node.aabbMin;
+        Vector3 centroidMin = node.aabbMin;
+        Vector3 centroidMax = node.aabbMax;
+
+        for( uint32 i=triStart; i<triStart + numTris; ++i )
+        {
+            Vector3 triVerts[3];
+            meshData.getTriangle( meshData.bvhTriangles[i], triVerts );
+            for( size_t j=0; j<3u; ++j )
+            {
+                node.aabbMin.makeFloor( triVerts[j] );
+                node.aabbMax.makeCeil( triVerts[j] );
+            }
+
+            const Vector3 &centroid = centroids[meshData.bvhTriangles[i] / 3u];
+            centroidMin.makeFloor( centroid );
+            centroidMax.makeCeil( centroid );
+        }
+
+        const Vector3 centroidExtent = centroidMax - centroidMin;
+
+        size_t splitAxis = 0;
+        if( centroidExtent.y > centroidExtent[splitAxis] )
+            splitAxis = 1u;
+        if( centroidExtent.z > centroidExtent[splitAxis] )
+            splitAxis = 2u;
+
+        if( numTris <= c_maxTrisPerBvhLeaf || centroidExtent[splitAxis] <= Real( 0 ) )
+        {
+            node.firstChildOrTri = triStart;
+            node.numTris = numTris;
+            return;
+        }
+
+        //Split in half at the median centroid along the longest axis
+        const uint32 numLeftTris = numTris >> 1u;
+        uint32 *trisBegin = meshData.bvhTriangles + triStart;
+        std::nth_element( trisBegin, trisBegin + numLeftTris, trisBegin + numTris,
+                          BvhCentroidCompare( centroids, splitAxis ) );
+
+        const uint32 childIdx = static_cast<uint32>( meshData.numBvhNodes );
+        meshData.numBvhNodes += 2u;
+
+        node.firstChildOrTri = childIdx;
+        node.numTris = 0;
+
+        buildMeshBvhNode( meshData, centroids, childIdx, triStart, numLeftTris );
+        buildMeshBvhNode( meshData, centroids, childIdx + 1u, triStart + numLeftTris,
+                          numTris - numLeftTris );
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::freeMeshBvh( MeshData &meshData )
+    {
+        OGRE_FREE_SIMD( meshData.bvhNodes, MEMCATEGORY_GEOMETRY );
+        meshData.bvhNodes = 0;
+        OGRE_FREE_SIMD( meshData.bvhTriangles, MEMCATEGORY_GEOMETRY );
+        meshData.bvhTriangles = 0;
+        meshData.numBvhNodes = 0;
+    }
+    //-----------------------------------------------------------------------------------
     const InstantRadiosity::MeshData* InstantRadiosity::downloadVao( VertexArrayObject *vao )
     {
         MeshDataMapV2::const_iterator itor = mMeshDataMapV2.find( vao );
@@ -905,6 +1023,8 @@ namespace Ogre
             }
         }
 
+        buildMeshBvh( meshData );
+
         mMeshDataMapV2[vao] = meshData;
 
         return &mMeshDataMapV2[vao];
@@ -1034,6 +1154,8 @@ namespace Ogre
                     renderOp.indexData->indexBuffer->getIndexSize() );
         }
 
+        buildMeshBvh( meshData );
+
         mMeshDataMapV1[renderOp] = meshData;
 
         return &mMeshDataMapV1[renderOp];
@@ -1214,74 +1336,91 @@ namespace Ogre
                                                   Matrix4 worldMatrix, const MaterialData &material,
                                                   const FastArray<size_t> &raysThatHitObj )
     {
-        const size_t numElements = meshData.indexData ? meshData.numIndices : meshData.numVertices;
+        if( !meshData.numBvhNodes )
+            return;
+
+        //The BVH is in local space, so we bring the rays there instead of the triangles to
+        //world space. The direction is not normalized so that distances stay in world units.
+        const Matrix4 invWorldMatrix = worldMatrix.inverseAffine();
+        //Mirroring transforms flip the winding, and thus which side is the front one.
+        const bool bNegativeScale = worldMatrix.hasNegativeScale();
 
-        const uint16 * RESTRICT_ALIAS indexData16 = reinterpret_cast<const uint16 * RESTRICT_ALIAS>(
-                    meshData.indexData );
-        const uint32 * RESTRICT_ALIAS indexData32 = reinterpret_cast<const uint32 * RESTRICT_ALIAS>(
-                    meshData.indexData );
+        //Median splits keep the tree balanced, its depth is at most log2( numTris ) + 1
+        uint32 nodeStack[64];
 
-        for( size_t i=0; i<numElements; i += 3 )
+        FastArray<size_t>::const_iterator itRayIdx = raysThatHitObj.begin();
+        FastArray<size_t>::const_iterator enRayIdx = raysThatHitObj.end();
+        while( itRayIdx != enRayIdx )
         {
-            Vector3 triVerts[3];
+            RayHit &rayHit = mRayHits[*itRayIdx];
+
+            const Ray localRay( invWorldMatrix.transformAffine( rayHit.ray.getOrigin() ),
+                                invWorldMatrix.transformDirectionAffine(
+                                    rayHit.ray.getDirection() ) );
+            const Vector3 &rayOrigin = localRay.getOrigin();
+            const Vector3 &rayDir = localRay.getDirection();
+            const Vector3 invRayDir( Real( 1.0 ) / rayDir.x,
+                                     Real( 1.0 ) / rayDir.y,
+                                     Real( 1.0 ) / rayDir.z );
+
+            Real closestDistance = std::min( rayHit.distance, lightRange );
 
-            uint32 vertexIdx[3];
+            size_t stackSize = 1u;
+            nodeStack[0] = 0;
 
-            if( meshData.indexData )
+            while( stackSize )
             {
-                if( meshData.useIndices16bit )
+                const BvhNode &node = meshData.bvhNodes[nodeStack[--stackSize]];
+
+                //Slab test. Discard the node if it's farther than our closest hit.
+                const Vector3 t0 = (node.aabbMin - rayOrigin) * invRayDir;
+                const Vector3 t1 = (node.aabbMax - rayOrigin) * invRayDir;
+                const Real tNear = std::max( std::max( std::min( t0.x, t1.x ),
+                                                       std::min( t0.y, t1.y ) ),
+                                             std::max( std::min( t0.z, t1.z ), Real( 0 ) ) );
+                const Real tFar = std::min( std::min( std::max( t0.x, t1.x ),
+                                                      std::max( t0.y, t1.y ) ),
+                                            std::min( std::max( t0.z, t1.z ), closestDistance ) );
+                if( tNear > tFar )
+                    continue;
+
+                if( !node.numTris )
                 {
-                    vertexIdx[0] = indexData16[i+0];
-                    vertexIdx[1] = indexData16[i+1];
-                    vertexIdx[2] = indexData16[i+2];
+                    nodeStack[stackSize++] = node.firstChildOrTri;
+                    nodeStack[stackSize++] = node.firstChildOrTri + 1u;
+                    continue;
                 }
-                else
+
+                for( uint32 i=0; i<node.numTris; ++i )
                 {
-                    vertexIdx[0] = indexData32[i+0];
-                    vertexIdx[1] = indexData32[i+1];
-                    vertexIdx[2] = indexData32[i+2];
-                }
-            }
-            else
-            {
-                vertexIdx[0] = i+0;
-                vertexIdx[1] = i+1;
-                vertexIdx[2] = i+2;
-            }
+                    const uint32 triStart = meshData.bvhTriangles[node.firstChildOrTri + i];
 
-            triVerts[0].x = meshData.vertexData[vertexIdx[0] * 3u + 0];
-            triVerts[0].y = meshData.vertexData[vertexIdx[0] * 3u + 1];
-            triVerts[0].z = meshData.vertexData[vertexIdx[0] * 3u + 2];
-            triVerts[1].x = meshData.vertexData[vertexIdx[1] * 3u + 0];
-            triVerts[1].y = meshData.vertexData[vertexIdx[1] * 3u + 1];
-            triVerts[1].z = meshData.vertexData[vertexIdx[1] * 3u + 2];
-            triVerts[2].x = meshData.vertexData[vertexIdx[2] * 3u + 0];
-            triVerts[2].y = meshData.vertexData[vertexIdx[2] * 3u + 1];
-            triVerts[2].z = meshData.vertexData[vertexIdx[2] * 3u + 2];
-
-            triVerts[0] = worldMatrix * triVerts[0];
-            triVerts[1] = worldMatrix * triVerts[1];
-            triVerts[2] = worldMatrix * triVerts[2];
-
-            Vector3 triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
-                        triVerts[0], triVerts[1], triVerts[2] );
-            triNormal.normalise();
-
-            FastArray<size_t>::const_iterator itRayIdx = raysThatHitObj.begin();
-            FastArray<size_t>::const_iterator enRayIdx = raysThatHitObj.end();
-            while( itRayIdx != enRayIdx )
-            {
-                Ray ray = mRayHits[*itRayIdx].ray;
+                    Vector3 triVerts[3];
+                    meshData.getTriangle( triStart, triVerts );
 
-                const std::pair<bool, Real> inters = Math::intersects(
-                            ray, triVerts[0], triVerts[1], triVerts[2], triNormal, true, false );
+                    Vector3 triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
+                                triVerts[0], triVerts[1], triVerts[2] );
+                    triNormal.normalise();
 
-                if( inters.first )
-                {
-                    RayHit &rayHit = mRayHits[*itRayIdx];
-                    if( inters.second < rayHit.distance &&
-                        inters.second <= lightRange )
+                    const std::pair<bool, Real> inters = Math::intersects(
+                                localRay, triVerts[0], triVerts[1], triVerts[2], triNormal,
+                                !bNegativeScale, bNegativeScale );
+
+                    if( inters.first && inters.second < closestDistance )
                     {
+                        closestDistance = inters.second;
+
+                        uint32 vertexIdx[3];
+                        meshData.getTriangleIndices( triStart, vertexIdx );
+
+                        triVerts[0] = worldMatrix * triVerts[0];
+                        triVerts[1] = worldMatrix * triVerts[1];
+                        triVerts[2] = worldMatrix * triVerts[2];
+
+                        triNormal = Math::calculateBasicFaceNormalWithoutNormalize(
+                                    triVerts[0], triVerts[1], triVerts[2] );
+                        triNormal.normalise();
+
                         rayHit.distance = inters.second;
                         rayHit.material = material;
                         rayHit.triVerts[0] = triVerts[0];
@@ -1304,9 +1443,9 @@ namespace Ogre
                         }
                     }
                 }
-
-                ++itRayIdx;
             }
+
+            ++itRayIdx;
         }
     }
     //-----------------------------------------------------------------------------------
@@ -1462,7 +1601,8 @@ namespace Ogre
                     if( visibilityFlags[k] & VisibilityFlags::LAYER_VISIBILITY &&
                         visibilityFlags[k] & lightMask )
                     {
-                        Light *light = static_cast<Light*>( objData.mOwner[k] );
+                        MovableObject *owner = objData.mOwner[k];
+                        Light *light = static_cast<Light*>( owner );
                         if( light->getType() != Light::LT_VPL )
                         {
                             Node *lightNode = light->getParentNode();
@@ -1526,6 +1666,7 @@ namespace Ogre
             while( itor != end )
             {
                 MeshData &meshData = itor->second;
+                freeMeshBvh( meshData );
                 OGRE_FREE_SIMD( meshData.vertexData, MEMCATEGORY_GEOMETRY );
                 meshData.vertexData = 0;
                 if( meshData.indexData && !itor->first->getIndexBuffer()->getShadowCopy() )
@@ -1545,6 +1686,7 @@ namespace Ogre
             while( itor != end )
             {
                 MeshData &meshData = itor->second;
+                freeMeshBvh( meshData );
                 OGRE_FREE_SIMD( meshData.vertexData, MEMCATEGORY_GEOMETRY );
                 meshData.vertexData = 0;
                 if( meshData.indexData )
@@ -1933,4 +2075,47 @@ namespace Ogre
     {
         return vertexData + numVertices * 3u + uvSet * 2u;
     }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::MeshData::getTriangleIndices( uint32 triStart,
+                                                         uint32 outVertexIdx[3] ) const
+    {
+        if( indexData )
+        {
+            if( useIndices16bit )
+            {
+                const uint16 * RESTRICT_ALIAS indexData16 =
+                        reinterpret_cast<const uint16 * RESTRICT_ALIAS>( indexData );
+                outVertexIdx[0] = indexData16[triStart+0];
+                outVertexIdx[1] = indexData16[triStart+1];
+                outVertexIdx[2] = indexData16[triStart+2];
+            }
+            else
+            {
+                const uint32 * RESTRICT_ALIAS indexData32 =
+                        reinterpret_cast<const uint32 * RESTRICT_ALIAS>( indexData );
+                outVertexIdx[0] = indexData32[triStart+0];
+                outVertexIdx[1] = indexData32[triStart+1];
+                outVertexIdx[2] = indexData32[triStart+2];
+            }
+        }
+        else
+        {
+            outVertexIdx[0] = triStart+0;
+            outVertexIdx[1] = triStart+1;
+            outVertexIdx[2] = triStart+2;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void InstantRadiosity::MeshData::getTriangle( uint32 triStart, Vector3 outTriVerts[3] ) const
+    {
+        uint32 vertexIdx[3];
+        getTriangleIndices( triStart, vertexIdx );
+
+        for( size_t i=0; i<3u; ++i )
+        {
+            outTriVerts[i].x = vertexData[vertexIdx[i] * 3u + 0];
+            outTriVerts[i].y = vertexData[vertexIdx[i] * 3u + 1];
+            outTriVerts[i].z = vertexData[vertexIdx[i] * 3u + 2];
+        }
+    }
 }
@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include "OgreMaterialManager.h"
 #include "OgrePass.h"
 #include "OgreTechnique.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -75,6 +76,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void IfdProbeVisualizer::createBuffers( void )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         VaoManager *vaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
 
         VertexBufferPackedVec vertexBuffers;
@@ -153,6 +155,7 @@ namespace Ogre
         mObjectData.mWorldAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
         mObjectData.mWorldRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
     }
     //-----------------------------------------------------------------------------------
     const String &IfdProbeVisualizer::getMovableType( void ) const { return BLANKSTRING; }
@@ -46,6 +46,7 @@ THE SOFTWARE.
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreTexBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 #define TODO_handle_leftover
 
@@ -165,7 +166,10 @@ namespace Ogre
     //-------------------------------------------------------------------------
     IrradianceField::IrradianceField( Root *root, SceneManager *sceneManager ) :
         IdObject( Id::generateNewId<IrradianceField>() ),
-        mNumProbesProcessed( 0u ),
+        mFirstProbeToProcess( 0u ),
+        mNumDirtyProbes( 0u ),
+        mUpdateFocus( Vector3::ZERO ),
+        mUseUpdateFocus( false ),
         mFieldOrigin( Vector3::ZERO ),
         mFieldSize( Vector3::ZERO ),
         mDepthMaxIntegrationTapsPerPixel( 0u ),
@@ -193,6 +197,7 @@ namespace Ogre
         mSceneManager( sceneManager ),
         mAlreadyWarned( false )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
 #if OGRE_NO_JSON
         OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
                      "To use IrradianceField, Ogre must be build with JSON support "
@@ -296,6 +301,7 @@ namespace Ogre
                                                             ConstBufferPacked *ifGenParamsBuffer,
                                                             uint32 &outMaxIntegrationTapsPerPixel )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         const uint32 maxIntegrationTapsPerPixel = countNumIntegrationTaps( probeRes );
         const size_t bufferSize = probeRes * probeRes * maxIntegrationTapsPerPixel * sizeof( float2 );
         float2 *integrationTapsBuffer =
@@ -540,7 +546,10 @@ namespace Ogre
         mFieldSize += probeBlockSize * 2.0f;
 
         mAlreadyWarned = false;
-        mNumProbesProcessed = 0u;
+        mFirstProbeToProcess = 0u;
+        mProbeStates.clear();
+        mProbeStates.resize( mSettings.getTotalNumProbes(), ProbeStateDirty );
+        mNumDirtyProbes = mSettings.getTotalNumProbes();
         createTextures();
         setIrradianceFieldGenParams();
 
@@ -559,6 +568,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void IrradianceField::createTextures( void )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         destroyTextures();
 
         TextureGpuManager *textureManager = mRoot->getRenderSystem()->getTextureGpuManager();
@@ -688,18 +698,135 @@ namespace Ogre
         }
     }
     //-------------------------------------------------------------------------
-    void IrradianceField::reset() { mNumProbesProcessed = 0u; }
+    void IrradianceField::reset()
+    {
+        mNumDirtyProbes = 0u;
+        vector<uint8>::type::iterator itor = mProbeStates.begin();
+        vector<uint8>::type::iterator endt = mProbeStates.end();
+
+        while( itor != endt )
+        {
+            if( *itor != ProbeStateInactive )
+            {
+                *itor = ProbeStateDirty;
+                ++mNumDirtyProbes;
+            }
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void IrradianceField::addDirtyRegion( const Aabb &aabb )
+    {
+        const size_t numProbes = mProbeStates.size();
+        for( size_t i = 0u; i < numProbes; ++i )
+        {
+            if( mProbeStates[i] == ProbeStateUpdated && aabb.contains( getProbeCenter( i ) ) )
+            {
+                mProbeStates[i] = ProbeStateDirty;
+                ++mNumDirtyProbes;
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    void IrradianceField::setProbesInactive( const Aabb &aabb, bool bInactive )
+    {
+        const size_t numProbes = mProbeStates.size();
+        for( size_t i = 0u; i < numProbes; ++i )
+        {
+            if( ( mProbeStates[i] == ProbeStateInactive ) != bInactive &&
+                aabb.contains( getProbeCenter( i ) ) )
+            {
+                if( bInactive )
+                {
+                    if( mProbeStates[i] == ProbeStateDirty )
+                        --mNumDirtyProbes;
+                    mProbeStates[i] = ProbeStateInactive;
+                }
+                else
+                {
+                    mProbeStates[i] = ProbeStateDirty;
+                    ++mNumDirtyProbes;
+                }
+            }
+        }
+    }
+    //-------------------------------------------------------------------------
+    IrradianceField::ProbeState IrradianceField::getProbeState( size_t probeIdx ) const
+    {
+        OGRE_ASSERT_LOW( probeIdx < mProbeStates.size() );
+        return static_cast<ProbeState>( mProbeStates[probeIdx] );
+    }
+    //-------------------------------------------------------------------------
+    Vector3 IrradianceField::getProbeCenter( size_t probeIdx ) const
+    {
+        Vector3 pos;
+        pos.x = probeIdx % mSettings.mNumProbes[0];
+        pos.y = ( probeIdx % ( mSettings.mNumProbes[0] * mSettings.mNumProbes[1] ) ) /
+                mSettings.mNumProbes[0];
+        pos.z = probeIdx / ( mSettings.mNumProbes[0] * mSettings.mNumProbes[1] );
+        pos += 0.5f;
+
+        pos /= mSettings.getNumProbes3f();
+        pos *= mFieldSize;
+        pos += mFieldOrigin;
+
+        return pos;
+    }
+    //-------------------------------------------------------------------------
+    void IrradianceField::setUpdateFocus( const Vector3 &focusPos )
+    {
+        mUpdateFocus = focusPos;
+        mUseUpdateFocus = true;
+    }
+    //-------------------------------------------------------------------------
+    void IrradianceField::clearUpdateFocus( void ) { mUseUpdateFocus = false; }
+    //-------------------------------------------------------------------------
+    uint32 IrradianceField::findFirstProbeToProcess( uint32 probesPerFrame ) const
+    {
+        const uint32 totalNumProbes = static_cast<uint32>( mProbeStates.size() );
+
+        uint32 bestProbe = 0u;
+        Real bestDistance = std::numeric_limits<Real>::max();
+
+        for( uint32 i = 0u; i < totalNumProbes; ++i )
+        {
+            if( mProbeStates[i] == ProbeStateDirty )
+            {
+                if( !mUseUpdateFocus )
+                {
+                    bestProbe = i;
+                    break;
+                }
+
+                const Real distance = getProbeCenter( i ).squaredDistance( mUpdateFocus );
+                if( distance < bestDistance )
+                {
+                    bestDistance = distance;
+                    bestProbe = i;
+                }
+            }
+        }
+
+        // The GPU processes contiguous ranges of probes. When focusing, center the
+        // range around the best probe so that its neighbours along X get updated too
+        if( mUseUpdateFocus )
+            bestProbe -= std::min( bestProbe, probesPerFrame >> 1u );
+
+        return std::min( bestProbe, totalNumProbes - probesPerFrame );
+    }
     //-------------------------------------------------------------------------
     void IrradianceField::update( uint32 probesPerFrame )
     {
-        const uint32 totalNumProbes = mSettings.getTotalNumProbes();
-        if( mNumProbesProcessed >= totalNumProbes )
+        if( !mNumDirtyProbes )
             return;
 
+        const uint32 totalNumProbes = mSettings.getTotalNumProbes();
+
         IrradianceFieldGenParams *ifGenParams = reinterpret_cast<IrradianceFieldGenParams *>(
             mIfGenParamsBuffer->map( 0, mIfGenParamsBuffer->getNumElements() ) );
 
-        probesPerFrame = std::min( totalNumProbes - mNumProbesProcessed, probesPerFrame );
+        probesPerFrame = std::min( totalNumProbes, probesPerFrame );
+        mFirstProbeToProcess = findFirstProbeToProcess( probesPerFrame );
         // OGRE_ASSERT_LOW( ( ( probesPerFrame & 0x01u ) == 0u ) && "probesPerFrame must be even!" );
 
         const uint32 numRaysPerIrradiancePixel = mSettings.getNumRaysPerIrradiancePixel();
@@ -738,7 +865,7 @@ namespace Ogre
         mDepthIntegrationJob->setNumThreadGroups( numIntegrationTGroupsX, numIntegrationTGroupsY, 1u );
         mColourIntegrationJob->setNumThreadGroups( numIntegrationTGroupsX, numIntegrationTGroupsY, 1u );
 
-        mIfGenParams.numProcessedProbes = mNumProbesProcessed;
+        mIfGenParams.numProcessedProbes = mFirstProbeToProcess;
         mIfGenParams.numProbes_threadsPerRow.w = numThreadGroupsX * threadsPerGroup;
         mIfGenParams.probesPerRow = numIntegrationTGroupsX * 1u;  // There's one probe per group
         *ifGenParams = mIfGenParams;
@@ -756,7 +883,15 @@ namespace Ogre
             mIfRaster->renderProbes( probesPerFrame );
         }
 
-        mNumProbesProcessed += probesPerFrame;
+        const uint32 endProbe = mFirstProbeToProcess + probesPerFrame;
+        for( uint32 i = mFirstProbeToProcess; i < endProbe; ++i )
+        {
+            if( mProbeStates[i] == ProbeStateDirty )
+            {
+                mProbeStates[i] = ProbeStateUpdated;
+                --mNumDirtyProbes;
+            }
+        }
     }
     //-------------------------------------------------------------------------
     size_t IrradianceField::getConstBufferSize( void ) const
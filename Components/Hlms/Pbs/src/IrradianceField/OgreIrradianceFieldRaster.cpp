@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreTexBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 #define TODO_final_memoryBarrier
 
@@ -83,6 +84,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void IrradianceFieldRaster::createWorkspace( void )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         destroyWorkspace();
 
         const RasterParams &rasterParams = mCreator->mSettings.mRasterParams;
@@ -195,24 +197,6 @@ namespace Ogre
         mCamera = 0;
     }
     //-------------------------------------------------------------------------
-    Vector3 IrradianceFieldRaster::getProbeCenter( size_t probeIdx ) const
-    {
-        const IrradianceFieldSettings &settings = mCreator->mSettings;
-
-        Vector3 pos;
-        pos.x = probeIdx % settings.mNumProbes[0];
-        pos.y =
-            ( probeIdx % ( settings.mNumProbes[0] * settings.mNumProbes[1] ) ) / settings.mNumProbes[0];
-        pos.z = probeIdx / ( settings.mNumProbes[0] * settings.mNumProbes[1] );
-        pos += 0.5f;
-
-        pos /= settings.getNumProbes3f();
-        pos *= mCreator->mFieldSize;
-        pos += mCreator->mFieldOrigin;
-
-        return pos;
-    }
-    //-------------------------------------------------------------------------
     void IrradianceFieldRaster::renderProbes( uint32 probesPerFrame )
     {
         SceneManager *sceneManager = mCreator->mSceneManager;
@@ -231,8 +215,8 @@ namespace Ogre
 
         // numProbesToProcess has already been sanitized by caller
         const size_t numProbesToProcess = probesPerFrame;
-        const size_t numProbesProcessed = mCreator->mNumProbesProcessed;
-        const size_t maxProbeToProcess = numProbesProcessed + numProbesToProcess;
+        const size_t firstProbeToProcess = mCreator->mFirstProbeToProcess;
+        const size_t maxProbeToProcess = firstProbeToProcess + numProbesToProcess;
 
         bool oldDebugIfdVisibility = false;
         if( mCreator->mDebugIfdProbeVisualizer )
@@ -245,11 +229,13 @@ namespace Ogre
         mProjectionABParam->setManualValue( projectionAB );
         mNumProbesParam->setManualValue( mCreator->mSettings.getNumProbes3f() );
 
-        for( size_t i = numProbesProcessed; i < maxProbeToProcess; ++i )
+        size_t idx = 0u;
+        for( size_t i = firstProbeToProcess; i < maxProbeToProcess; ++i )
         {
-            const size_t idx = i - numProbesProcessed;
+            if( mCreator->mProbeStates[i] == IrradianceField::ProbeStateInactive )
+                continue;
 
-            Vector3 probeCenter = getProbeCenter( i );
+            Vector3 probeCenter = mCreator->getProbeCenter( i );
 
             mCamera->setPosition( probeCenter );
 
@@ -269,6 +255,8 @@ namespace Ogre
                 renderSystem->_update();
                 renderSystem->_endFrameOnce();
             }
+
+            ++idx;
         }
 
         mIfdIntegrationWorkspace->_beginUpdate( false );
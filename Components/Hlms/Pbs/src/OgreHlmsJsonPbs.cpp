@@ -178,6 +178,12 @@ namespace Ogre
         TextureGpu *texture = 0;
         HlmsSamplerblock const *samplerblock = 0;
 
+        bool isPending = false;
+        String pendingName, pendingAliasName;
+        uint32 pendingFlags = 0;
+        uint32 pendingFilters = 0;
+        TextureTypes::TextureTypes pendingTextureType = TextureTypes::Type2D;
+
         rapidjson::Value::ConstMemberIterator itor = json.FindMember( "texture" );
         if( itor != json.MemberEnd() &&
             (itor->value.IsString() || (itor->value.IsArray() && itor->value.Size() == 2u &&
@@ -220,11 +226,22 @@ namespace Ogre
             uint32 filters = TextureFilter::TypeGenerateDefaultMipmaps;
             filters |= datablock->suggestFiltersForType( textureType );
 
-            texture = mTextureManager->createOrRetrieveTexture( textureName + mAdditionalExtension,
-                                                                aliasName,
-                                                                GpuPageOutStrategy::Discard,
-                                                                textureFlags, internalTextureType,
-                                                                resourceGroup, filters );
+            if( mHlmsManager->getLoadTexturesLazily() )
+            {
+                isPending = true;
+                pendingName = textureName + mAdditionalExtension;
+                pendingAliasName = aliasName;
+                pendingFlags = textureFlags;
+                pendingFilters = filters;
+                pendingTextureType = internalTextureType;
+            }
+            else
+            {
+                texture = mTextureManager->createOrRetrieveTexture(
+                              textureName + mAdditionalExtension, aliasName,
+                              GpuPageOutStrategy::Discard, textureFlags, internalTextureType,
+                              resourceGroup, filters );
+            }
         }
 
         itor = json.FindMember( "sampler" );
@@ -245,6 +262,14 @@ namespace Ogre
                 samplerblock = mHlmsManager->getSamplerblock(HlmsSamplerblock());
             datablock->_setTexture(textureType, texture, samplerblock);
         }
+        else if( isPending )
+        {
+            if( !samplerblock )
+                samplerblock = mHlmsManager->getSamplerblock( HlmsSamplerblock() );
+            datablock->_setPendingTexture( textureType, pendingName, pendingAliasName, resourceGroup,
+                                           pendingFlags, static_cast<uint8>( pendingTextureType ),
+                                           pendingFilters, samplerblock );
+        }
         else if (samplerblock)
             datablock->_setSamplerblock(textureType, samplerblock);
 
@@ -737,6 +762,9 @@ namespace Ogre
         assert( dynamic_cast<const HlmsPbsDatablock*>(datablock) );
         const HlmsPbsDatablock *pbsDatablock = static_cast<const HlmsPbsDatablock*>(datablock);
 
+        //Lazily loaded textures would otherwise not be saved
+        const_cast<HlmsPbsDatablock*>( pbsDatablock )->resolvePendingTextures();
+
         outString += ",\n\t\t\t\"workflow\" : ";
         toQuotedStr( pbsDatablock->getWorkflow(), outString );
 
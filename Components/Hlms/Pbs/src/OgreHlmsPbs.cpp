@@ -61,6 +61,8 @@ THE SOFTWARE.
 #include "CommandBuffer/OgreCbShaderBuffer.h"
 
 #include "Animation/OgreSkeletonInstance.h"
+#include "Animation/OgreGpuSkeletonEvaluator.h"
+#include "Animation/OgreBakedSkeletonAnimation.h"
 
 #include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
 
@@ -75,6 +77,7 @@ THE SOFTWARE.
 #include "OgreStackVector.h"
 #include "OgreLogManager.h"
 #include "OgreProfiler.h"
+#include "OgreGpuMemoryTracker.h"
 
 #define TODO_irradianceField_samplerblock
 
@@ -88,6 +91,7 @@ namespace Ogre
     const IdString PbsProperty::LowerGpuOverhead  = IdString( "lower_gpu_overhead" );
     const IdString PbsProperty::DebugPssmSplits   = IdString( "debug_pssm_splits" );
     const IdString PbsProperty::PerceptualRoughness=IdString( "perceptual_roughness" );
+    const IdString PbsProperty::CompactInstanceData=IdString( "compact_instance_data" );
     const IdString PbsProperty::HasPlanarReflections=IdString( "has_planar_reflections" );
 
     const IdString PbsProperty::NumTextures     = IdString( "num_textures" );
@@ -263,6 +267,7 @@ namespace Ogre
         mPccVctMinDistance( 1.0f ),
         mInvPccVctInvDistance( 1.0f ),
         mCurrentPassBuffer( 0 ),
+        mBoundPassBuffer( 0 ),
         mGridBuffer( 0 ),
         mGlobalLightListBuffer( 0 ),
         mMaxSpecIblMipmap( 1.0f ),
@@ -294,6 +299,7 @@ namespace Ogre
         mHasSeparateSamplers( 0 ),
         mLastDescTexture( 0 ),
         mLastDescSampler( 0 ),
+        mLastBoundGpuBoneMatrices( 0 ),
         mReservedTexSlots( 1u ), //Vertex shader consumes 1 slot with its tbuffer.
 #if !OGRE_NO_FINE_LIGHT_MASK_GRANULARITY
         mFineLightMaskGranularity( true ),
@@ -301,6 +307,7 @@ namespace Ogre
         mSetupWorldMatBuf( true ),
         mDebugPssmSplits( false ),
         mPerceptualRoughness( true ),
+        mCompactInstanceData( false ),
         mAutoSpecIblMaxMipmap( true ),
         mVctFullConeCount( false ),
 #if OGRE_ENABLE_LIGHT_OBB_RESTRAINT
@@ -308,6 +315,7 @@ namespace Ogre
         mUseObbRestraintAreaLtc( false ),
 #endif
         mUseLightBuffers( false ),
+        mDeduplicatePassBuffers( false ),
         mShadowFilter( PCF_3x3 ),
         mEsmK( 600u ),
         mAmbientLightMode( AmbientAuto )
@@ -340,7 +348,16 @@ namespace Ogre
                     assert( dynamic_cast<HlmsPbsDatablock*>( itor->second.datablock ) );
                     HlmsPbsDatablock *datablock = static_cast<HlmsPbsDatablock*>(itor->second.datablock);
 
-                    requestSlot( datablock->mTextureHash, datablock, false );
+                    //Same pool hash the datablock itself uses (see HlmsPbsDatablock
+                    //constructor and calculateHash), otherwise datablocks that would share
+                    //a pool get scattered across one pool per texture combination.
+                    uint32 poolHash = 0;
+                    if( datablock->mCubemapProbe )
+                    {
+                        const TextureGpu *probeTex = datablock->mCubemapProbe->getInternalTexture();
+                        poolHash = IdString( probeTex->getName() ).mHash;
+                    }
+                    requestSlot( poolHash, datablock, false );
                     ++itor;
                 }
             }
@@ -468,8 +485,12 @@ namespace Ogre
         if( mSetupWorldMatBuf )
             vsParams->setNamedConstant( "worldMatBuf", 0 );
 
-        if( queuedRenderable.renderable->getNumPoses() > 0 )
+        if( getProperty( HlmsBaseProp::Pose ) > 0 )
             vsParams->setNamedConstant( "poseBuf", 4 );
+        if( getProperty( HlmsBaseProp::PoseSparse ) )
+            vsParams->setNamedConstant( "poseIndexBuf", 6 );
+        if( getProperty( HlmsBaseProp::SkeletonGpu ) )
+            vsParams->setNamedConstant( "gpuBoneMatBuf", 5 );
 
         mListener->shaderCacheEntryCreated( mShaderProfile, retVal, passCache,
                                             mSetProperties, queuedRenderable );
@@ -590,6 +611,10 @@ namespace Ogre
         assert( dynamic_cast<HlmsPbsDatablock*>( renderable->getDatablock() ) );
         HlmsPbsDatablock *datablock = static_cast<HlmsPbsDatablock*>( renderable->getDatablock() );
 
+        //First use of a lazily loaded material. Creating its textures
+        //dirties the descriptor sets, which delays the hash below
+        datablock->resolvePendingTextures();
+
         if( datablock->getDirtyFlags() & (DirtyTextures|DirtySamplers) )
         {
             //Delay hash generation for later, when we have the final (or temporary) descriptor sets.
@@ -888,9 +913,12 @@ namespace Ogre
                      itor->keyName != PbsProperty::UvDiffuse &&
                      itor->keyName != HlmsPsoProp::InputLayoutId &&
                      itor->keyName != HlmsBaseProp::Skeleton &&
+                     itor->keyName != HlmsBaseProp::SkeletonGpu &&
+                     itor->keyName != HlmsBaseProp::SkeletonBaked &&
                      itor->keyName != HlmsBaseProp::Pose &&
                      itor->keyName != HlmsBaseProp::PoseHalfPrecision &&
                      itor->keyName != HlmsBaseProp::PoseNormals &&
+                     itor->keyName != HlmsBaseProp::PoseSparse &&
                      itor->keyName != HlmsBaseProp::BonesPerVertex &&
                      itor->keyName != HlmsBaseProp::DualParaboloidMapping &&
                      itor->keyName != HlmsBaseProp::AlphaTest &&
@@ -1256,6 +1284,8 @@ namespace Ogre
         OgreProfileExhaustive( "HlmsPbs::preparePassHash" );
 
         mSetProperties.clear();
+        mLastSkinning = LastSkinning();
+        mLastBoundGpuBoneMatrices = 0;
 
         if( shadowNode && mShadowFilter == ExponentialShadowMaps )
             setProperty( PbsProperty::ExponentialShadowMaps, mEsmK );
@@ -1350,6 +1380,24 @@ namespace Ogre
         //Ignore alpha channel
         upperHemisphere.a = lowerHemisphere.a = 1.0;
 
+        if( !casterPass && sceneManager->_getActivePassForwardPlus() )
+        {
+            //Lights left out by Forward+ due to their low importance, approximated as ambient
+            ColourValue distantUpperHemi, distantLowerHemi;
+            const ForwardPlusBase *forwardPlus = sceneManager->_getActivePassForwardPlus();
+            const Camera *cullCamera = sceneManager->getCamerasInProgress().cullingCamera;
+            if( forwardPlus->getDistantLightsAmbient( cullCamera, distantUpperHemi,
+                                                      distantLowerHemi ) )
+            {
+                upperHemisphere.r += distantUpperHemi.r;
+                upperHemisphere.g += distantUpperHemi.g;
+                upperHemisphere.b += distantUpperHemi.b;
+                lowerHemisphere.r += distantLowerHemi.r;
+                lowerHemisphere.g += distantLowerHemi.g;
+                lowerHemisphere.b += distantLowerHemi.b;
+            }
+        }
+
         const CompositorPass *pass = sceneManager->getCurrentCompositorPass();
         CompositorPassSceneDef const *passSceneDef = 0;
 
@@ -1366,6 +1414,8 @@ namespace Ogre
         {
             if( mPerceptualRoughness )
                 setProperty( PbsProperty::PerceptualRoughness, 1 );
+            if( mCompactInstanceData )
+                setProperty( PbsProperty::CompactInstanceData, 1 );
             if( mLightProfilesTexture )
                 setProperty( PbsProperty::LightProfilesTexture, 1 );
             if( mLtcMatrixTexture )
@@ -1493,6 +1543,13 @@ namespace Ogre
         if( mUseLightBuffers )
             setProperty( PbsProperty::useLightBuffers, 1 );
 
+        //Motion vectors take the place of worldView with the previous world matrix,
+        //thus the shader must go to view space the same way as with mCompactInstanceData
+        const bool genMotionVectors = getProperty( HlmsBaseProp::GenMotionVectors ) != 0;
+        const bool temporalJitter = !casterPass && getProperty( HlmsBaseProp::TemporalJitter ) != 0;
+        if( genMotionVectors )
+            setProperty( PbsProperty::CompactInstanceData, 1 );
+
         const RenderSystemCapabilities *capabilities = mRenderSystem->getCapabilities();
         setProperty( PbsProperty::HwGammaRead, capabilities->hasCapability( RSC_HW_GAMMA ) );
 //        setProperty( PbsProperty::HwGammaWrite, capabilities->hasCapability( RSC_HW_GAMMA ) &&
@@ -1612,6 +1669,13 @@ namespace Ogre
             if( passSceneDef && passSceneDef->mUvBakingSet != 0xFF )
                 mapSize += 4u * 4u;
 
+            //mat4 prevViewProj
+            if( genMotionVectors )
+                mapSize += 16u * 4u;
+            //vec4 temporalJitter_velocityScale
+            if( genMotionVectors || temporalJitter )
+                mapSize += 4u * 4u;
+
             //vec3 ambientUpperHemi + float envMapScale
             if( ambientMode == AmbientFixed || ambientMode == AmbientHemisphere ||
                 envMapScale != 1.0f || vctNeedsAmbientHemi )
@@ -1723,6 +1787,7 @@ namespace Ogre
 
         if( mCurrentPassBuffer >= mPassBuffers.size() )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             mPassBuffers.push_back( mVaoManager->createConstBuffer( maxBufferSize, BT_DYNAMIC_PERSISTENT,
                                                                     0, false ) );
         }
@@ -1731,6 +1796,7 @@ namespace Ogre
         {
             while( mCurrentPassBuffer >= mLight0Buffers.size() )
             {
+                GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
                 mLight0Buffers.push_back( mVaoManager->createConstBuffer(
                     maxBufferSizeLight0, BT_DYNAMIC_PERSISTENT, 0, false ) );
                 mLight1Buffers.push_back( mVaoManager->createConstBuffer(
@@ -1741,7 +1807,19 @@ namespace Ogre
         }
 
         ConstBufferPacked *passBuffer = mPassBuffers[mCurrentPassBuffer++];
-        float *passBufferPtr = reinterpret_cast<float*>( passBuffer->map( 0, mapSize ) );
+        mBoundPassBuffer = mCurrentPassBuffer - 1u;
+
+        const bool deduplicatePassBuffer = mDeduplicatePassBuffers && !mUseLightBuffers;
+        float *passBufferPtr;
+        if( deduplicatePassBuffer )
+        {
+            mPassBufferScratch.resizePOD( mapSize >> 2u );
+            passBufferPtr = mPassBufferScratch.begin();
+        }
+        else
+        {
+            passBufferPtr = reinterpret_cast<float*>( passBuffer->map( 0, mapSize ) );
+        }
 
         ConstBufferPacked *light0Buffer = 0;
         ConstBufferPacked *light1Buffer = 0;
@@ -1856,6 +1934,7 @@ namespace Ogre
         }
 
         mPreparedPass.viewMatrix        = viewMatrix;
+        mPreparedPass.sendPrevWorldMat  = genMotionVectors;
 
         mPreparedPass.shadowMaps.clear();
 
@@ -1938,6 +2017,50 @@ namespace Ogre
                 *passBufferPtr++ = 0.0f;
                 *passBufferPtr++ = 0.0f;
             }
+
+            //mat4 prevViewProj
+            if( genMotionVectors )
+            {
+                //The history is kept without flipping, and flipped
+                //by negating the Y row, same as projectionMatrix
+                Matrix4 currViewProj = cameras.renderingCamera->getProjectionMatrixWithRSDepth() *
+                                       viewMatrix;
+                Matrix4 prevViewProj = getPrevFrameViewProj( cameras.renderingCamera, currViewProj );
+                if( renderPassDesc->requiresTextureFlipping() )
+                {
+                    for( size_t i=0u; i<4u; ++i )
+                        prevViewProj[1][i] = -prevViewProj[1][i];
+                }
+                for( size_t i=0u; i<16u; ++i )
+                    *passBufferPtr++ = (float)prevViewProj[0][i];
+            }
+
+            //vec4 temporalJitter_velocityScale
+            if( genMotionVectors || temporalJitter )
+            {
+                Vector2 jitter( Vector2::ZERO );
+                if( temporalJitter )
+                {
+                    //Halton(2, 3) sequence, cycled every 8 frames. Offsets are in pixels
+                    //from the centre, converted to clip space of the actual viewport size.
+                    const uint32 haltonIdx = (mVaoManager->getFrameCount() & 0x07u) + 1u;
+                    Real haltonX = 0, haltonY = 0;
+                    Real fraction = 0.5f;
+                    for( uint32 i=haltonIdx; i > 0u; i /= 2u, fraction *= 0.5f )
+                        haltonX += fraction * Real( i % 2u );
+                    fraction = Real( 1.0 / 3.0 );
+                    for( uint32 i=haltonIdx; i > 0u; i /= 3u, fraction *= Real( 1.0 / 3.0 ) )
+                        haltonY += fraction * Real( i % 3u );
+
+                    jitter.x = (haltonX - 0.5f) * 2.0f / Real( currViewports[0].getActualWidth() );
+                    jitter.y = (haltonY - 0.5f) * 2.0f / Real( currViewports[0].getActualHeight() );
+                }
+                *passBufferPtr++ = static_cast<float>( jitter.x );
+                *passBufferPtr++ = static_cast<float>( jitter.y );
+                //Converts a difference in NDC to a difference in UVs
+                *passBufferPtr++ = 0.5f;
+                *passBufferPtr++ = renderPassDesc->requiresTextureFlipping() ? 0.5f : -0.5f;
+            }
             //---------------------------------------------------------------------------
             //                          ---- PIXEL SHADER ----
             //---------------------------------------------------------------------------
@@ -2596,11 +2719,42 @@ namespace Ogre
                 light2Buffer->unmap( UO_KEEP_PERSISTENT );
         }
 
-        passBuffer->unmap( UO_KEEP_PERSISTENT );
+        if( deduplicatePassBuffer )
+        {
+            if( mPassBufferContents.size() < mPassBuffers.size() )
+                mPassBufferContents.resize( mPassBuffers.size() );
+
+            bool foundMatch = false;
+            for( uint32 i=0; i<mBoundPassBuffer && !foundMatch; ++i )
+            {
+                const FastArray<float> &contents = mPassBufferContents[i];
+                if( contents.size() == mPassBufferScratch.size() &&
+                    !memcmp( contents.begin(), mPassBufferScratch.begin(), mapSize ) )
+                {
+                    //Identical to a pass already uploaded this frame. Bind that one instead
+                    //and give back the buffer we reserved.
+                    mBoundPassBuffer = i;
+                    --mCurrentPassBuffer;
+                    foundMatch = true;
+                }
+            }
+
+            if( !foundMatch )
+            {
+                memcpy( passBuffer->map( 0, mapSize ), mPassBufferScratch.begin(), mapSize );
+                passBuffer->unmap( UO_KEEP_PERSISTENT );
+                mPassBufferContents[mBoundPassBuffer] = mPassBufferScratch;
+            }
+        }
+        else
+        {
+            passBuffer->unmap( UO_KEEP_PERSISTENT );
+        }
 
         //mTexBuffers must hold at least one buffer to prevent out of bound exceptions.
         if( mTexBuffers.empty() )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             size_t bufferSize = std::min<size_t>( mTextureBufferDefaultSize,
                                                   mVaoManager->getTexBufferMaxSize() );
             TexBufferPacked *newBuffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT, bufferSize,
@@ -2717,8 +2871,10 @@ namespace Ogre
 
         if( OGRE_EXTRACT_HLMS_TYPE_FROM_CACHE_HASH( lastCacheHash ) != mType )
         {
+            mLastBoundGpuBoneMatrices = 0;
+
             //layout(binding = 0) uniform PassBuffer {} pass
-            ConstBufferPacked *passBuffer = mPassBuffers[mCurrentPassBuffer-1];
+            ConstBufferPacked *passBuffer = mPassBuffers[mBoundPassBuffer];
             *commandBuffer->addCommand<CbShaderBuffer>() = CbShaderBuffer( VertexShader,
                                                                            0, passBuffer, 0,
                                                                            passBuffer->
@@ -2953,17 +3109,24 @@ namespace Ogre
         //                          ---- VERTEX SHADER ----
         //---------------------------------------------------------------------------
 
+        //Whether worldView follows worldMat. Caster passes don't need it, and
+        //with mCompactInstanceData the shader derives it from the pass' view matrix.
+        //When generating motion vectors, the previous world matrix takes its place.
+        const bool sendPrevWorldMat = mPreparedPass.sendPrevWorldMat && !casterPass;
+        const bool sendWorldView = !casterPass && !mCompactInstanceData && !sendPrevWorldMat;
+        const bool sendSecondMatrix = sendWorldView || sendPrevWorldMat;
+
         if( !hasSkeletonAnimation && numPoses == 0 )
         {
             //We need to correct currentMappedConstBuffer to point to the right texture buffer's
             //offset, which may not be in sync if the previous draw had skeletal and/or pose animation.
             const size_t currentConstOffset = (currentMappedTexBuffer - mStartMappedTexBuffer) >>
-                                                (2 + !casterPass);
+                                                (2 + sendSecondMatrix);
             currentMappedConstBuffer =  currentConstOffset + mStartMappedConstBuffer;
             bool exceedsConstBuffer = (size_t)((currentMappedConstBuffer - mStartMappedConstBuffer) + 4)
                                         > mCurrentConstBufferSize;
 
-            const size_t minimumTexBufferSize = 16 * (1 + !casterPass);
+            const size_t minimumTexBufferSize = 16 * (1 + sendSecondMatrix);
             bool exceedsTexBuffer = (currentMappedTexBuffer - mStartMappedTexBuffer) +
                                          minimumTexBufferSize >= mCurrentTexBufferSize;
 
@@ -2998,13 +3161,13 @@ namespace Ogre
 #endif
 
             //mat4 worldView
-            Matrix4 tmp = mPreparedPass.viewMatrix.concatenateAffine( worldMat );
+            if( sendWorldView )
+            {
+                Matrix4 tmp = mPreparedPass.viewMatrix.concatenateAffine( worldMat );
 #if !OGRE_DOUBLE_PRECISION
-            memcpy( currentMappedTexBuffer, &tmp, sizeof( Matrix4 ) * !casterPass );
-            currentMappedTexBuffer += 16 * !casterPass;
+                memcpy( currentMappedTexBuffer, &tmp, sizeof( Matrix4 ) );
+                currentMappedTexBuffer += 16;
 #else
-            if( !casterPass )
-            {
                 for( int y = 0; y < 4; ++y )
                 {
                     for( int x = 0; x < 4; ++x )
@@ -3012,8 +3175,27 @@ namespace Ogre
                         *currentMappedTexBuffer++ = tmp[ y ][ x ];
                     }
                 }
+#endif
             }
+            else if( sendPrevWorldMat )
+            {
+                //mat4x3 prevWorld
+                const Matrix4 &prevWorldMat = queuedRenderable.movableObject->
+                        _getPrevFrameParentNodeFullTransform( mVaoManager->getFrameCount() );
+#if !OGRE_DOUBLE_PRECISION
+                memcpy( currentMappedTexBuffer, &prevWorldMat, 4 * 3 * sizeof( float ) );
+                currentMappedTexBuffer += 16;
+#else
+                for( int y = 0; y < 3; ++y )
+                {
+                    for( int x = 0; x < 4; ++x )
+                    {
+                        *currentMappedTexBuffer++ = prevWorldMat[ y ][ x ];
+                    }
+                }
+                currentMappedTexBuffer += 4;
 #endif
+            }
         }
         else
         {
@@ -3083,12 +3265,65 @@ namespace Ogre
 
                     const RenderableAnimated::IndexMap *indexMap = renderableAnimated->getBlendIndexToBoneIndexMap();
 
+                    //Bone matrices were evaluated by a GpuSkeletonEvaluator (or baked by a
+                    //BakedSkeletonAnimation). We only send where they are, plus the blend
+                    //index -> bone index table (4 per float4). Baked matrices are in model
+                    //space, thus they also need the world matrix.
+                    const bool bakedSkeleton =
+                            queuedRenderable.renderable->hasBakedSkeletonAnimation();
+                    const bool gpuSkeleton = bakedSkeleton ||
+                            queuedRenderable.renderable->hasGpuSkeletonAnimation();
+                    const size_t numBoneIdxVec4 = ( indexMap->size() + 3u ) >> 2u;
+                    const size_t gpuSkeletonHeaderSize = bakedSkeleton ? 16u : 4u;
+
+                    if( gpuSkeleton )
+                    {
+                        TexBufferPacked *gpuBoneMatrices = 0;
+                        if( bakedSkeleton )
+                        {
+                            assert( skeleton->getBakedAnimationSet() &&
+                                    "Renderable flagged for baked skinning without a "
+                                    "BakedSkeletonAnimation" );
+                            gpuBoneMatrices = skeleton->getBakedAnimationSet()->getBoneMatrices();
+                        }
+                        else
+                        {
+                            assert( skeleton->getGpuEvaluator() &&
+                                    "Renderable flagged for GPU skinning without a "
+                                    "GpuSkeletonEvaluator" );
+                            gpuBoneMatrices = skeleton->getGpuEvaluator()->getBoneMatrices();
+                        }
+                        if( gpuBoneMatrices && gpuBoneMatrices != mLastBoundGpuBoneMatrices )
+                        {
+                            *commandBuffer->addCommand<CbShaderBuffer>() =
+                                    CbShaderBuffer( VertexShader, 5, gpuBoneMatrices, 0,
+                                                    gpuBoneMatrices->getTotalSizeBytes() );
+                            mLastBoundGpuBoneMatrices = gpuBoneMatrices;
+                        }
+                    }
+
+                    //Bone matrices are in world space, so if the previous skinned draw used the
+                    //same bones (i.e. another SubItem of the same Item) and the tex buffer
+                    //binding hasn't moved, point to the palette it already uploaded.
+                    const bool reuseBonePalette =
+                            numPoses == 0 && !exceedsConstBuffer &&
+                            mLastSkinning.skeleton == skeleton &&
+                            mLastSkinning.texBufferStart == mStartMappedTexBuffer &&
+                            mLastSkinning.texBufferIdx == mCurrentTexBuffer &&
+                            ( mLastSkinning.indexMap == indexMap ||
+                              ( mLastSkinning.indexMap->size() == indexMap->size() &&
+                                std::equal( indexMap->begin(), indexMap->end(),
+                                            mLastSkinning.indexMap->begin() ) ) );
+
                     const size_t poseDataSize = numPoses > 0u ? (4u + poseWeightsNumFloats) : 0u;
-                    const size_t minimumTexBufferSize = 12 * indexMap->size() + poseDataSize;
+                    const size_t skinningDataSize =
+                            gpuSkeleton ? gpuSkeletonHeaderSize + numBoneIdxVec4 * 4u :
+                                          12 * indexMap->size();
+                    const size_t minimumTexBufferSize = skinningDataSize + poseDataSize;
                     bool exceedsTexBuffer = (currentMappedTexBuffer - mStartMappedTexBuffer) +
                                                 minimumTexBufferSize >= mCurrentTexBufferSize;
 
-                    if( exceedsConstBuffer || exceedsTexBuffer )
+                    if( !reuseBonePalette && (exceedsConstBuffer || exceedsTexBuffer) )
                     {
                         currentMappedConstBuffer = mapNextConstBuffer( commandBuffer );
 
@@ -3103,12 +3338,57 @@ namespace Ogre
                     //uint worldMaterialIdx[]
                     size_t distToWorldMatStart = mCurrentMappedTexBuffer - mStartMappedTexBuffer;
                     distToWorldMatStart >>= 2;
+                    if( reuseBonePalette )
+                        distToWorldMatStart = mLastSkinning.distToWorldMatStart;
                     *currentMappedConstBuffer = (distToWorldMatStart << 9 ) |
                             (datablock->getAssignedSlot() & 0x1FF);
 
                     RenderableAnimated::IndexMap::const_iterator itBone = indexMap->begin();
                     RenderableAnimated::IndexMap::const_iterator enBone = indexMap->end();
 
+                    if( reuseBonePalette )
+                        itBone = enBone;
+
+                    if( gpuSkeleton && !reuseBonePalette )
+                    {
+                        //float4 header: bone offset, start of the pose data (relative)
+                        uint32 * RESTRICT_ALIAS skinningData =
+                                reinterpret_cast<uint32 * RESTRICT_ALIAS>( currentMappedTexBuffer );
+                        skinningData[0] = bakedSkeleton ?
+                                    skeleton->getBakedAnimationSet()->getFrameOffset(
+                                        skeleton->getBakedAnimationIdx(),
+                                        skeleton->getBakedAnimationTime() ) :
+                                    skeleton->_getGpuBoneOffset();
+                        skinningData[1] = static_cast<uint32>( ( gpuSkeletonHeaderSize >> 2u ) +
+                                                               numBoneIdxVec4 );
+                        skinningData[2] = 0;
+                        skinningData[3] = 0;
+                        skinningData += 4u;
+
+                        if( bakedSkeleton )
+                        {
+                            //Followed by the world matrix (3 float4)
+                            Matrix4 skelWorldMat = Matrix4::IDENTITY;
+                            if( skeleton->getParentNode() )
+                                skelWorldMat = skeleton->getParentNode()->_getFullTransform();
+                            float * RESTRICT_ALIAS worldMatDst =
+                                    reinterpret_cast<float * RESTRICT_ALIAS>( skinningData );
+                            for( size_t y=0; y<3u; ++y )
+                            {
+                                for( size_t x=0; x<4u; ++x )
+                                    *worldMatDst++ = static_cast<float>( skelWorldMat[y][x] );
+                            }
+                            skinningData += 12u;
+                        }
+
+                        while( itBone != enBone )
+                            *skinningData++ = *itBone++;
+                        for( size_t i=indexMap->size(); i<numBoneIdxVec4 * 4u; ++i )
+                            *skinningData++ = 0;
+
+                        currentMappedTexBuffer += gpuSkeletonHeaderSize + numBoneIdxVec4 * 4u;
+                    }
+
                     while( itBone != enBone )
                     {
                         const SimpleMatrixAf4x3 &mat4x3 = skeleton->_getBoneFullTransform( *itBone );
@@ -3117,6 +3397,19 @@ namespace Ogre
 
                         ++itBone;
                     }
+
+                    if( numPoses == 0 )
+                    {
+                        mLastSkinning.skeleton              = skeleton;
+                        mLastSkinning.indexMap              = indexMap;
+                        mLastSkinning.texBufferStart        = mStartMappedTexBuffer;
+                        mLastSkinning.texBufferIdx          = mCurrentTexBuffer;
+                        mLastSkinning.distToWorldMatStart   = distToWorldMatStart;
+                    }
+                    else
+                    {
+                        mLastSkinning = LastSkinning();
+                    }
                 }
             }
 
@@ -3163,6 +3456,9 @@ namespace Ogre
         #endif
                 memcpy( currentMappedTexBuffer, &baseVertex, sizeof( baseVertex ) );
                 size_t numVertices = vao->getBaseVertexBuffer()->getNumElements();
+                //Sparse poses only store the vertices that move
+                if( queuedRenderable.renderable->getPoseIndexTexBuffer() )
+                    numVertices = queuedRenderable.renderable->getNumPoseVertices();
                 memcpy( currentMappedTexBuffer + 1, &numVertices, sizeof( numVertices ) );
                 currentMappedTexBuffer += 4;
 
@@ -3210,6 +3506,14 @@ namespace Ogre
                                                                                4, poseBuf, 0,
                                                                                poseBuf->
                                                                                getTotalSizeBytes() );
+
+                TexBufferPacked *poseIndexBuf = queuedRenderable.renderable->getPoseIndexTexBuffer();
+                if( poseIndexBuf )
+                {
+                    *commandBuffer->addCommand<CbShaderBuffer>() =
+                            CbShaderBuffer( VertexShader, 6, poseIndexBuf, 0,
+                                            poseIndexBuf->getTotalSizeBytes() );
+                }
             }
 
             //If the next entity will not be skeletally animated, we'll need
@@ -3217,7 +3521,8 @@ namespace Ogre
             //Non-skeletally animated objects are far more common than skeletal ones,
             //so we do this here instead of doing it before rendering the non-skeletal ones.
             size_t currentConstOffset = (size_t)(currentMappedTexBuffer - mStartMappedTexBuffer);
-            currentConstOffset = alignToNextMultiple( currentConstOffset, 16 + 16 * !casterPass );
+            currentConstOffset = alignToNextMultiple( currentConstOffset,
+                                                      16 + 16 * sendSecondMatrix );
             currentConstOffset = std::min( currentConstOffset, mCurrentTexBufferSize );
             currentMappedTexBuffer = mStartMappedTexBuffer + currentConstOffset;
         }
@@ -3297,6 +3602,8 @@ namespace Ogre
         HlmsBufferManager::destroyAllBuffers();
 
         mCurrentPassBuffer  = 0;
+        mBoundPassBuffer    = 0;
+        mPassBufferContents.clear();
 
         {
             ConstBufferPackedVec::const_iterator itor = mPassBuffers.begin();
@@ -3359,6 +3666,50 @@ namespace Ogre
 
     }
     //-----------------------------------------------------------------------------------
+    const Matrix4& HlmsPbs::getPrevFrameViewProj( const Camera *camera, const Matrix4 &viewProj )
+    {
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+
+        CameraMotionHistoryVec::iterator itor = mCameraMotionHistory.begin();
+        CameraMotionHistoryVec::iterator endt = mCameraMotionHistory.end();
+
+        while( itor != endt && itor->camera != camera )
+        {
+            //Cameras not seen for a while may have been destroyed; forget them
+            //(their address could be reused by a new camera)
+            if( currentFrame - itor->lastFrame > 2u )
+            {
+                itor = efficientVectorRemove( mCameraMotionHistory, itor );
+                endt = mCameraMotionHistory.end();
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+
+        if( itor == endt )
+        {
+            CameraMotionHistory history;
+            history.camera          = camera;
+            history.prevViewProj    = viewProj;
+            history.currentViewProj = viewProj;
+            history.lastFrame       = currentFrame;
+            mCameraMotionHistory.push_back( history );
+            return mCameraMotionHistory.back().prevViewProj;
+        }
+
+        if( itor->lastFrame != currentFrame )
+        {
+            itor->prevViewProj = itor->lastFrame + 1u == currentFrame ? itor->currentViewProj :
+                                                                          viewProj;
+            itor->currentViewProj   = viewProj;
+            itor->lastFrame         = currentFrame;
+        }
+
+        return itor->prevViewProj;
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsPbs::postCommandBufferExecution( CommandBuffer *commandBuffer )
     {
         HlmsBufferManager::postCommandBufferExecution( commandBuffer );
@@ -3378,6 +3729,8 @@ namespace Ogre
     {
         HlmsBufferManager::frameEnded();
         mCurrentPassBuffer  = 0;
+        mLastSkinning = LastSkinning();
+        mLastBoundGpuBoneMatrices = 0;
     }
     //-----------------------------------------------------------------------------------
     void HlmsPbs::resetIblSpecMipmap( uint8 numMipmaps )
@@ -3505,6 +3858,11 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     bool HlmsPbs::getPerceptualRoughness( void ) const { return mPerceptualRoughness; }
     //-----------------------------------------------------------------------------------
+    void HlmsPbs::setCompactInstanceData( bool compactInstanceData )
+    {
+        mCompactInstanceData = compactInstanceData;
+    }
+    //-----------------------------------------------------------------------------------
     void HlmsPbs::setShadowSettings( ShadowFilter filter )
     {
         mShadowFilter = filter;
@@ -3563,6 +3921,11 @@ namespace Ogre
     {
         mUseLightBuffers = b;
     }
+    //-----------------------------------------------------------------------------------
+    void HlmsPbs::setDeduplicatePassBuffers( bool deduplicate )
+    {
+        mDeduplicatePassBuffers = deduplicate;
+    }
 #if !OGRE_NO_JSON
     //-----------------------------------------------------------------------------------
     void HlmsPbs::_loadJson( const rapidjson::Value &jsonValue, const HlmsJson::NamedBlocks &blocks,
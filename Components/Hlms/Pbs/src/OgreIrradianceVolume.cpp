@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "OgreStagingTexture.h"
 
 #include "OgreLwString.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -253,6 +254,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void IrradianceVolume::createIrradianceVolumeTexture( uint32 numBlocksX, uint32 numBlocksY, uint32 numBlocksZ )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Probes );
         destroyIrradianceVolumeTexture();
 
         mNumBlocksX = numBlocksX;
@@ -48,6 +48,7 @@ THE SOFTWARE.
 #include "Vao/OgreVaoManager.h"
 
 #include "OgreLwString.h"
+#include "OgreGpuMemoryTracker.h"
 
 
 namespace Ogre
@@ -101,6 +102,7 @@ namespace Ogre
         mMultiplier( 1.0f ),
         mDebugVoxelVisualizer( 0 )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         memset( mLightVoxel, 0, sizeof(mLightVoxel) );
         memset( mUpperHemisphere, 0, sizeof(mUpperHemisphere) );
         memset( mLowerHemisphere, 0, sizeof(mLowerHemisphere) );
@@ -322,6 +324,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void VctLighting::createTextures()
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         const bool allowsMultipleBounces = getAllowMultipleBounces();
         destroyTextures();
 
@@ -634,6 +637,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void VctLighting::setAllowMultipleBounces( bool bAllowMultipleBounces, bool bChangeBarriers )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         if( getAllowMultipleBounces() == bAllowMultipleBounces )
             return;
 
@@ -789,7 +793,8 @@ namespace Ogre
                     if( visibilityFlags[k] & VisibilityFlags::LAYER_VISIBILITY &&
                         visibilityFlags[k] & lightMask )
                     {
-                        Light *light = static_cast<Light*>( objData.mOwner[k] );
+                        MovableObject *owner = objData.mOwner[k];
+                        Light *light = static_cast<Light*>( owner );
                         if( light->getType() == Light::LT_DIRECTIONAL ||
                             light->getType() == Light::LT_POINT ||
                             light->getType() == Light::LT_SPOTLIGHT ||
@@ -49,6 +49,7 @@ THE SOFTWARE.
 #include "Compositor/OgreCompositorWorkspace.h"
 
 #include "OgreLogManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -213,6 +214,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void VctMaterial::resizeTexturePool(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         String texName = "VctMaterial" + StringConverter::toString( getId() ) + "/" +
                          StringConverter::toString( mNumUsedPoolSlices );
         TextureGpu *newPool = mTextureGpuManager->createTexture( texName, texName,
@@ -263,6 +265,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void VctMaterial::initTempResources( SceneManager *sceneManager )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         mDownsampleTex = mTextureGpuManager->createTexture( "VctMaterialDownsampleTex",
                                                             "VctMaterialDownsampleTex",
                                                             GpuPageOutStrategy::Discard,
@@ -304,6 +307,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     VctMaterial::DatablockConversionResult VctMaterial::addDatablock( HlmsDatablock *datablock )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         DatablockConversionResult retVal;
 
         DatablockConversionResultMap::const_iterator itResult =
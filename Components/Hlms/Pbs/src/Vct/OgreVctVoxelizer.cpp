@@ -64,12 +64,17 @@ THE SOFTWARE.
 #include "OgreStringConverter.h"
 
 #include "OgreProfiler.h"
+#include "OgreGpuMemoryTracker.h"
+#include "OgreLogManager.h"
+#include "Hash/MurmurHash3.h"
 
 #define TODO_deal_no_index_buffer
 
 namespace Ogre
 {
     static const size_t c_numVctProperties = 4u;
+    static const uint16 c_meshCacheVersion = 1u;
+    static const uint32 c_meshHashSeed = 0x5CE1E7A2u;
     static const size_t c_numAabCalcProperties = 2u;
 
     struct VctVoxelizerProp
@@ -98,6 +103,9 @@ namespace Ogre
     VctVoxelizer::VctVoxelizer( IdType id, RenderSystem *renderSystem, HlmsManager *hlmsManager,
                                 bool correctAreaLightShadows ) :
         IdObject( id ),
+        mMeshCacheEnabled( false ),
+        mMeshBuffersDirty( true ),
+        mMeshAabbsDirty( true ),
         mAabbWorldSpaceJob( 0 ),
         mTotalNumInstances( 0 ),
         mCpuInstanceBuffer( 0 ),
@@ -138,6 +146,7 @@ namespace Ogre
         mAutoRegion( true ),
         mRegionToVoxelize( Aabb::BOX_ZERO ),
         mMaxRegion( Aabb::BOX_INFINITE ),
+        mFullRebuildNeeded( true ),
         mDebugVisualizationMode( DebugVisualizationNone ),
         mDebugVoxelVisualizer( 0 )
     {
@@ -397,6 +406,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void VctVoxelizer::prepareAabbCalculatorMeshData(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         OgreProfile( "VctVoxelizer::prepareAabbCalculatorMeshData" );
 
         destroyAabbCalculatorMeshData();
@@ -512,7 +522,8 @@ namespace Ogre
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::convertMeshUncompressed( const MeshPtr &mesh, QueuedMesh &queuedMesh,
-                                                MappedBuffers &mappedBuffers )
+                                                MappedBuffers &mappedBuffers,
+                                                const float *cachedVertices )
     {
         OgreProfile( "VctVoxelizer::convertMeshUncompressed" );
 
@@ -553,6 +564,16 @@ namespace Ogre
                 numVertices = vao->getPrimitiveCount();
             }
 
+            if( cachedVertices )
+            {
+                //Already converted in a previous build (or a previous run)
+                memcpy( mappedBuffers.uncompressedVertexBuffer, cachedVertices,
+                        numVertices * sizeof(float) * 8u );
+                mappedBuffers.uncompressedVertexBuffer += numVertices * 8u;
+                cachedVertices += numVertices * 8u;
+                continue;
+            }
+
             float * RESTRICT_ALIAS uncVertexBuffer = mappedBuffers.uncompressedVertexBuffer;
 
 #ifdef STREAM_DOWNLOAD
@@ -625,6 +646,110 @@ namespace Ogre
         }
     }
     //-------------------------------------------------------------------------
+    void VctVoxelizer::convertMeshUncompressedCached( const MeshPtr &mesh, QueuedMesh &queuedMesh,
+                                                      MappedBuffers &mappedBuffers )
+    {
+        const uint64 hash = calculateMeshHash( mesh );
+        const size_t numFloats = countMeshVertices( mesh ) * 8u;
+
+        MeshVertexCacheMap::const_iterator itor = mMeshVertexCache.find( hash );
+        if( itor != mMeshVertexCache.end() && itor->second.size() == numFloats )
+        {
+            convertMeshUncompressed( mesh, queuedMesh, mappedBuffers, itor->second.begin() );
+        }
+        else
+        {
+            //Convert into the cache rather than reading back from the mapped staging buffer,
+            //which may be write combined memory
+            FastArray<float> &vertices = mMeshVertexCache[hash];
+            vertices.resizePOD( numFloats );
+
+            float *stagingVertexBuffer = mappedBuffers.uncompressedVertexBuffer;
+            mappedBuffers.uncompressedVertexBuffer = vertices.begin();
+            convertMeshUncompressed( mesh, queuedMesh, mappedBuffers, 0 );
+            OGRE_ASSERT_LOW( mappedBuffers.uncompressedVertexBuffer == vertices.end() );
+
+            memcpy( stagingVertexBuffer, vertices.begin(), numFloats * sizeof(float) );
+            mappedBuffers.uncompressedVertexBuffer = stagingVertexBuffer + numFloats;
+        }
+    }
+    //-------------------------------------------------------------------------
+    uint64 VctVoxelizer::calculateMeshHash( const MeshPtr &mesh )
+    {
+        FastArray<uint32> hashData;
+
+        const String &meshName = mesh->getName();
+        uint32 nameHash = 0;
+        MurmurHash3_x86_32( meshName.c_str(), static_cast<int>( meshName.size() ),
+                            c_meshHashSeed, &nameHash );
+        hashData.push_back( nameHash );
+
+        {
+            const Aabb &aabb = mesh->getAabb();
+            uint32 aabbBits[sizeof(Aabb) / sizeof(uint32)];
+            memcpy( aabbBits, &aabb, sizeof(Aabb) );
+            hashData.appendPOD( aabbBits, aabbBits + sizeof(Aabb) / sizeof(uint32) );
+        }
+
+        const uint16 numSubmeshes = mesh->getNumSubMeshes();
+        hashData.push_back( numSubmeshes );
+
+        for( uint16 subMeshIdx=0; subMeshIdx<numSubmeshes; ++subMeshIdx )
+        {
+            const VertexArrayObject *vao = mesh->getSubMesh( subMeshIdx )->mVao[VpNormal].front();
+
+            hashData.push_back( static_cast<uint32>( vao->getBaseVertexBuffer()->getNumElements() ) );
+            hashData.push_back( vao->getPrimitiveStart() );
+            hashData.push_back( vao->getPrimitiveCount() );
+
+            const IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+            hashData.push_back( indexBuffer ? static_cast<uint32>( indexBuffer->getIndexType() ) :
+                                              std::numeric_limits<uint32>::max() );
+
+            const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+            VertexBufferPackedVec::const_iterator itBuffer = vertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator enBuffer = vertexBuffers.end();
+
+            while( itBuffer != enBuffer )
+            {
+                const VertexElement2Vec &vertexElements = (*itBuffer)->getVertexElements();
+                VertexElement2Vec::const_iterator itElem = vertexElements.begin();
+                VertexElement2Vec::const_iterator enElem = vertexElements.end();
+
+                while( itElem != enElem )
+                {
+                    hashData.push_back( (static_cast<uint32>( itElem->mType ) << 16u) |
+                                        static_cast<uint32>( itElem->mSemantic ) );
+                    ++itElem;
+                }
+
+                ++itBuffer;
+            }
+        }
+
+        uint64 hash[2];
+        MurmurHash3_x64_128( hashData.begin(), static_cast<int>( hashData.size() * sizeof(uint32) ),
+                             c_meshHashSeed, hash );
+        return hash[0];
+    }
+    //-------------------------------------------------------------------------
+    size_t VctVoxelizer::countMeshVertices( const MeshPtr &mesh )
+    {
+        size_t numVertices = 0;
+
+        const uint16 numSubmeshes = mesh->getNumSubMeshes();
+        for( uint16 subMeshIdx=0; subMeshIdx<numSubmeshes; ++subMeshIdx )
+        {
+            const VertexArrayObject *vao = mesh->getSubMesh( subMeshIdx )->mVao[VpNormal].front();
+            if( vao->getIndexBuffer() )
+                numVertices += vao->getBaseVertexBuffer()->getNumElements();
+            else
+                numVertices += vao->getPrimitiveCount();
+        }
+
+        return numVertices;
+    }
+    //-------------------------------------------------------------------------
     void VctVoxelizer::addItem( Item *item, bool bCompressed, uint32 indexCountSplit )
     {
         const MeshPtr &mesh = item->getMesh();
@@ -651,6 +776,9 @@ namespace Ogre
                 queuedMesh.submeshes.resize( mesh->getNumSubMeshes() );
             }
 
+            if( isNewEntry || wasCompressed )
+                mMeshBuffersDirty = true;
+
             ++queuedMesh.numItems;
         }
         else
@@ -664,6 +792,7 @@ namespace Ogre
                 queuedMesh.indexCountSplit = indexCountSplit;
                 queuedMesh.submeshes.resize( mesh->getNumSubMeshes() );
                 mMeshesV2[mesh] = queuedMesh;
+                mMeshBuffersDirty = true;
             }
             else
             {
@@ -672,6 +801,7 @@ namespace Ogre
         }
 
         mItems.push_back( item );
+        mFullRebuildNeeded = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::removeItem( Item *item )
@@ -691,15 +821,95 @@ namespace Ogre
         }
         --itMesh->second.numItems;
         if( !itMesh->second.numItems )
+        {
             mMeshesV2.erase( mesh );
+            mMeshBuffersDirty = true;
+        }
 
         efficientVectorRemove( mItems, itor );
+        mFullRebuildNeeded = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::removeAllItems(void)
     {
         mItems.clear();
         mMeshesV2.clear();
+        mMeshBuffersDirty = true;
+        mFullRebuildNeeded = true;
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::setMeshCacheEnabled( bool bEnabled )
+    {
+        mMeshCacheEnabled = bEnabled;
+        if( !bEnabled )
+            mMeshVertexCache.clear();
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::clearMeshCache(void)
+    {
+        mMeshVertexCache.clear();
+        mMeshBuffersDirty = true;
+        mFullRebuildNeeded = true;
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::saveMeshCache( DataStreamPtr &dataStream ) const
+    {
+        LogManager::getSingleton().logMessage( "Saving VctVoxelizer mesh cache to " +
+                                               dataStream->getName() );
+
+        const uint32 numEntries = static_cast<uint32>( mMeshVertexCache.size() );
+        dataStream->write( &c_meshCacheVersion, sizeof(c_meshCacheVersion) );
+        dataStream->write( &numEntries, sizeof(numEntries) );
+
+        MeshVertexCacheMap::const_iterator itor = mMeshVertexCache.begin();
+        MeshVertexCacheMap::const_iterator end  = mMeshVertexCache.end();
+
+        while( itor != end )
+        {
+            const uint64 hash = itor->first;
+            const uint32 numFloats = static_cast<uint32>( itor->second.size() );
+            dataStream->write( &hash, sizeof(hash) );
+            dataStream->write( &numFloats, sizeof(numFloats) );
+            dataStream->write( itor->second.begin(), numFloats * sizeof(float) );
+            ++itor;
+        }
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::loadMeshCache( DataStreamPtr &dataStream )
+    {
+        LogManager::getSingleton().logMessage( "Loading VctVoxelizer mesh cache from " +
+                                               dataStream->getName() );
+
+        mMeshCacheEnabled = true;
+
+        uint16 version = 0;
+        dataStream->read( &version, sizeof(version) );
+        if( version != c_meshCacheVersion )
+        {
+            LogManager::getSingleton().logMessage( "VctVoxelizer: Mesh cache version mismatch. "
+                                                   "Not loading." );
+            return;
+        }
+
+        uint32 numEntries = 0;
+        dataStream->read( &numEntries, sizeof(numEntries) );
+
+        for( uint32 i=0; i<numEntries && !dataStream->eof(); ++i )
+        {
+            uint64 hash = 0;
+            uint32 numFloats = 0;
+            dataStream->read( &hash, sizeof(hash) );
+            dataStream->read( &numFloats, sizeof(numFloats) );
+
+            FastArray<float> &vertices = mMeshVertexCache[hash];
+            vertices.resizePOD( numFloats );
+            if( dataStream->read( vertices.begin(), numFloats * sizeof(float) ) !=
+                numFloats * sizeof(float) )
+            {
+                LogManager::getSingleton().logMessage( "VctVoxelizer: Mesh cache is truncated." );
+                mMeshVertexCache.erase( hash );
+            }
+        }
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::freeBuffers( bool bForceFree )
@@ -739,6 +949,7 @@ namespace Ogre
     //-------------------------------------------------------------------------
     void VctVoxelizer::buildMeshBuffers(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         OgreProfile( "VctVoxelizer::buildMeshBuffers" );
 
         mNumVerticesCompressed      = 0;
@@ -796,7 +1007,10 @@ namespace Ogre
 
             while( itor != end )
             {
-                convertMeshUncompressed( itor->first, itor->second, mappedBuffers );
+                if( mMeshCacheEnabled )
+                    convertMeshUncompressedCached( itor->first, itor->second, mappedBuffers );
+                else
+                    convertMeshUncompressed( itor->first, itor->second, mappedBuffers, 0 );
                 ++itor;
             }
         }
@@ -818,10 +1032,12 @@ namespace Ogre
         vbUncomprStagingBuffer->removeReferenceCount();
 
         prepareAabbCalculatorMeshData();
+        mMeshAabbsDirty = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::createVoxelTextures(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         if( mAlbedoVox &&
             mAlbedoVox->getWidth() == mWidth &&
             mAlbedoVox->getHeight() == mHeight &&
@@ -941,6 +1157,7 @@ namespace Ogre
         mAutoRegion = autoRegion;
         mRegionToVoxelize = regionToVoxelize;
         mMaxRegion = maxRegion;
+        mFullRebuildNeeded = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::autoCalculateRegion()
@@ -967,6 +1184,7 @@ namespace Ogre
         maxAabb.makeFloor( mMaxRegion.getMaximum() );
 
         mRegionToVoxelize.setExtents( minAabb, maxAabb );
+        mFullRebuildNeeded = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::placeItemsInBuckets()
@@ -1060,8 +1278,9 @@ namespace Ogre
         return numSubMeshPartitions;
     }
     //-------------------------------------------------------------------------
-    void VctVoxelizer::createInstanceBuffers(void)
+    void VctVoxelizer::createInstanceBuffers( size_t numOctants )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         size_t instanceCount = 0;
         ItemArray::const_iterator itor = mItems.begin();
         ItemArray::const_iterator end  = mItems.end();
@@ -1073,7 +1292,7 @@ namespace Ogre
         }
 
         const size_t structStride = sizeof(float) * 4u * 6u;
-        const size_t elementCount = alignToNextMultiple( instanceCount * mOctants.size(),
+        const size_t elementCount = alignToNextMultiple( instanceCount * numOctants,
                                                          mAabbWorldSpaceJob->getThreadsPerGroupX() );
 
         if( !mInstanceBuffer || elementCount > mInstanceBuffer->getNumElements() )
@@ -1102,18 +1321,18 @@ namespace Ogre
         clearComputeJobResources( false );
     }
     //-------------------------------------------------------------------------
-    void VctVoxelizer::fillInstanceBuffers(void)
+    void VctVoxelizer::fillInstanceBuffers( const FastArray<Octant> &octants )
     {
         OgreProfile( "VctVoxelizer::fillInstanceBuffers" );
 
-        createInstanceBuffers();
+        createInstanceBuffers( octants.size() );
 
 //        float * RESTRICT_ALIAS instanceBuffer =
 //                reinterpret_cast<float*>( mInstanceBuffer->map( 0, mInstanceBuffer->getNumElements() ) );
         float * RESTRICT_ALIAS instanceBuffer = reinterpret_cast<float*>( mCpuInstanceBuffer );
         const float *instanceBufferStart = instanceBuffer;
-        FastArray<Octant>::const_iterator itor = mOctants.begin();
-        FastArray<Octant>::const_iterator end  = mOctants.end();
+        FastArray<Octant>::const_iterator itor = octants.begin();
+        FastArray<Octant>::const_iterator end  = octants.end();
 
         while( itor != end )
         {
@@ -1214,9 +1433,13 @@ namespace Ogre
 
         uint32 meshStart = 0u;
 
+        //The local space AABBs only change when the meshes do (see buildMeshBuffers).
+        //Moving Items only needs the conversion to world space below.
+        const size_t numVariantsToCalculate = mMeshAabbsDirty ? numVariants : 0u;
+
         OgreProfileGpuBegin( "VCT Mesh AABB calculation" );
 
-        for( size_t i=0; i<numVariants; ++i )
+        for( size_t i=0; i<numVariantsToCalculate; ++i )
         {
             if( numMeshes[i] == 0u )
                 continue;
@@ -1249,7 +1472,9 @@ namespace Ogre
             meshStart += numMeshes[i];
         }
 
-        mRenderSystem->_executeResourceTransition( &mAfterAabbCalculatorTrans );
+        if( mMeshAabbsDirty )
+            mRenderSystem->_executeResourceTransition( &mAfterAabbCalculatorTrans );
+        mMeshAabbsDirty = false;
 
         OgreProfileGpuEnd( "VCT Mesh AABB calculation" );
 
@@ -1306,6 +1531,8 @@ namespace Ogre
                 }
             }
         }
+
+        mFullRebuildNeeded = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::createBarriers(void)
@@ -1388,6 +1615,7 @@ namespace Ogre
         mWidth  = width;
         mHeight = height;
         mDepth  = depth;
+        mFullRebuildNeeded = true;
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::build( SceneManager *sceneManager )
@@ -1406,12 +1634,18 @@ namespace Ogre
             clearVoxels();
             mRenderSystem->_executeResourceTransition( &mVoxelizerPrepareForSamplingTrans );
             destroyBarriers();
+            mFullRebuildNeeded = false;
+            mDirtyRegions.clear();
             return;
         }
 
         mRenderSystem->endRenderPassDescriptor();
 
-        buildMeshBuffers();
+        if( mMeshBuffersDirty )
+        {
+            buildMeshBuffers();
+            mMeshBuffersDirty = false;
+        }
 
         createVoxelTextures();
 
@@ -1419,7 +1653,19 @@ namespace Ogre
         placeItemsInBuckets();
         mVctMaterial->destroyTempResources();
 
-        fillInstanceBuffers();
+        voxelizeOctants( mOctants, false );
+
+        mFullRebuildNeeded = false;
+        mDirtyRegions.clear();
+
+        destroyBarriers();
+
+        OgreProfileGpuEnd( "VCT build" );
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::voxelizeOctants( const FastArray<Octant> &octants, bool bClearOctants )
+    {
+        fillInstanceBuffers( octants );
 
         computeMeshAabbs();
 
@@ -1470,7 +1716,8 @@ namespace Ogre
         }
 
         HlmsCompute *hlmsCompute = mHlmsManager->getComputeHlms();
-        clearVoxels();
+        if( !bClearOctants )
+            clearVoxels();
 
         const uint32 *threadsPerGroup = mComputeJobs[0]->getThreadsPerGroup();
 
@@ -1479,10 +1726,14 @@ namespace Ogre
         ShaderParams::Param paramInstanceRange;
         ShaderParams::Param paramVoxelOrigin;
         ShaderParams::Param paramVoxelCellSize;
+        ShaderParams::Param paramVoxelPixelOrigin;
+        ShaderParams::Param paramClearVoxels;
 
         paramInstanceRange.name	= "instanceStart_instanceEnd";
         paramVoxelOrigin.name	= "voxelOrigin";
         paramVoxelCellSize.name	= "voxelCellSize";
+        paramVoxelPixelOrigin.name	= "voxelPixelOrigin";
+        paramClearVoxels.name	= "clearVoxels";
 
         paramVoxelCellSize.setManualValue( getVoxelCellSize() );
 
@@ -1490,12 +1741,17 @@ namespace Ogre
 
         OgreProfileGpuBegin( "VCT Voxelization Jobs" );
 
-        FastArray<Octant>::const_iterator itor = mOctants.begin();
-        FastArray<Octant>::const_iterator end  = mOctants.end();
+        FastArray<Octant>::const_iterator itor = octants.begin();
+        FastArray<Octant>::const_iterator end  = octants.end();
 
         while( itor != end )
         {
             const Octant &octant = *itor;
+            const uint32 pixelOrigin[3] = { octant.x, octant.y, octant.z };
+            paramVoxelPixelOrigin.setManualValue( pixelOrigin, 3u );
+            //Only the first dispatch of the octant replaces its contents
+            uint32 clearVoxels = bClearOctants ? 1u : 0u;
+
             VoxelizerBucketMap::const_iterator itBucket = mBuckets.begin();
             VoxelizerBucketMap::const_iterator enBucket = mBuckets.end();
 
@@ -1526,13 +1782,17 @@ namespace Ogre
 
                 paramInstanceRange.setManualValue( instanceRange, 2u );
                 paramVoxelOrigin.setManualValue( voxelOrigin );
+                paramClearVoxels.setManualValue( clearVoxels );
 
                 ShaderParams &shaderParams = bucket.job->getShaderParams( "default" );
                 shaderParams.mParams.clear();
                 shaderParams.mParams.push_back( paramInstanceRange );
                 shaderParams.mParams.push_back( paramVoxelOrigin );
                 shaderParams.mParams.push_back( paramVoxelCellSize );
+                shaderParams.mParams.push_back( paramVoxelPixelOrigin );
+                shaderParams.mParams.push_back( paramClearVoxels );
                 shaderParams.setDirty();
+                clearVoxels = 0u;
 
                 hlmsCompute->dispatch( bucket.job, 0, 0 );
                 mRenderSystem->_executeResourceTransition( &mVoxelizerInterDispatchTrans );
@@ -1554,10 +1814,112 @@ namespace Ogre
 
         if( mNeedsAlbedoMipmaps )
             mAlbedoVox->_autogenerateMipmaps();
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::addDirtyRegion( const Aabb &region )
+    {
+        mDirtyRegions.push_back( region );
+    }
+    //-------------------------------------------------------------------------
+    bool VctVoxelizer::convertDirtyRegionsToOctants(void)
+    {
+        mDirtyOctants.clear();
+
+        const uint32 *threadsPerGroup = mComputeJobs[0]->getThreadsPerGroup();
+        const uint32 resolution[3] = { mWidth, mHeight, mDepth };
+
+        const Vector3 voxelOrigin = getVoxelOrigin();
+        const Vector3 voxelCellSize = getVoxelCellSize();
+
+        FastArray<Aabb>::const_iterator itor = mDirtyRegions.begin();
+        FastArray<Aabb>::const_iterator end  = mDirtyRegions.end();
+
+        while( itor != end )
+        {
+            const Vector3 minVoxel = (itor->getMinimum() - voxelOrigin) / voxelCellSize;
+            const Vector3 maxVoxel = (itor->getMaximum() - voxelOrigin) / voxelCellSize;
+
+            uint32 blockStart[3];
+            uint32 blockEnd[3];
+            bool isEmpty = false;
+            for( size_t i=0; i<3u; ++i )
+            {
+                const Real fStart = Math::Clamp<Real>( Math::Floor( minVoxel[i] ),
+                                                       0, Real( resolution[i] ) );
+                const Real fEnd = Math::Clamp<Real>( Math::Ceil( maxVoxel[i] ),
+                                                     0, Real( resolution[i] ) );
+                //Expand to the threadgroup size
+                blockStart[i] = static_cast<uint32>( fStart );
+                blockStart[i] -= blockStart[i] % threadsPerGroup[i];
+                blockEnd[i] = static_cast<uint32>( alignToNextMultiple(
+                                                       static_cast<uint32>( fEnd ),
+                                                       threadsPerGroup[i] ) );
+                blockEnd[i] = std::min( blockEnd[i], resolution[i] );
+                isEmpty |= blockStart[i] >= blockEnd[i];
+            }
+
+            if( !isEmpty )
+            {
+                Octant octant;
+                octant.x        = blockStart[0];
+                octant.y        = blockStart[1];
+                octant.z        = blockStart[2];
+                octant.width    = blockEnd[0] - blockStart[0];
+                octant.height   = blockEnd[1] - blockStart[1];
+                octant.depth    = blockEnd[2] - blockStart[2];
+
+                const Vector3 octantOrigin = voxelOrigin + voxelCellSize *
+                                             Vector3( octant.x, octant.y, octant.z );
+                octant.region.setExtents( octantOrigin, octantOrigin + voxelCellSize *
+                                          Vector3( octant.width, octant.height, octant.depth ) );
+                mDirtyOctants.push_back( octant );
+            }
+
+            ++itor;
+        }
+
+        mDirtyRegions.clear();
+
+        return !mDirtyOctants.empty();
+    }
+    //-------------------------------------------------------------------------
+    void VctVoxelizer::update( SceneManager *sceneManager )
+    {
+        if( mFullRebuildNeeded || !mAlbedoVox )
+        {
+            build( sceneManager );
+            return;
+        }
+
+        if( mItems.empty() )
+        {
+            //Nothing could have been voxelized in the dirty regions
+            mDirtyRegions.clear();
+            return;
+        }
+
+        if( !convertDirtyRegionsToOctants() )
+            return;
+
+        OgreProfile( "VctVoxelizer::update" );
+        OgreProfileGpuBegin( "VCT update" );
+
+        mRenderSystem->endRenderPassDescriptor();
+
+        createBarriers();
+
+        //The contents of mAccumValVox were discarded after the last build; but we only read
+        //what the first dispatch of each dirty octant writes, thus it doesn't matter.
+        mAccumValVox->scheduleTransitionTo( GpuResidency::Resident );
+        //The voxels were left ready for sampling
+        if( mRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+            mRenderSystem->_executeResourceTransition( &mStartupTrans );
+
+        voxelizeOctants( mDirtyOctants, true );
 
         destroyBarriers();
 
-        OgreProfileGpuEnd( "VCT build" );
+        OgreProfileGpuEnd( "VCT update" );
     }
     //-------------------------------------------------------------------------
     void VctVoxelizer::setDebugVisualization( VctVoxelizer::DebugVisualizationMode mode,
@@ -38,6 +38,7 @@ THE SOFTWARE.
 #include "OgreMaterialManager.h"
 #include "OgreTechnique.h"
 #include "OgrePass.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -77,6 +78,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void VoxelVisualizer::createBuffers(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Vct );
         VaoManager *vaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
 
         VertexBufferPackedVec vertexBuffers;
@@ -145,6 +147,7 @@ namespace Ogre
         mObjectData.mWorldAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
         mObjectData.mWorldRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
     }
     //-----------------------------------------------------------------------------------
     const String& VoxelVisualizer::getMovableType(void) const
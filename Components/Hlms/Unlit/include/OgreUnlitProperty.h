@@ -48,6 +48,12 @@ namespace Ogre
         static const IdString TextureMatrix;
         static const IdString ExponentialShadowMaps;
         static const IdString HasPlanarReflections;
+        /// Set when the Renderable provides Renderable::getBillboardInstanceBuffer
+        static const IdString BillboardInstanced;
+        /// Set when the Renderable provides Renderable::getBillboardChainBuffer
+        static const IdString BillboardChain;
+        /// Set when the Renderable provides Renderable::getImpostorInstanceBuffer
+        static const IdString ImpostorInstanced;
 
         static const IdString TexMatrixCount;
         static const IdString TexMatrixCount0;
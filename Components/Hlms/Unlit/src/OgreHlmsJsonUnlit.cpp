@@ -86,6 +86,10 @@ namespace Ogre
         TextureGpu *texture = 0;
         HlmsSamplerblock const *samplerblock = 0;
 
+        bool isPending = false;
+        String pendingName, pendingAliasName;
+        uint32 pendingFlags = 0;
+
 		rapidjson::Value::ConstMemberIterator itor = json.FindMember( "texture" );
         if( itor != json.MemberEnd() &&
             (itor->value.IsString() || (itor->value.IsArray() && itor->value.Size() == 2u &&
@@ -105,10 +109,21 @@ namespace Ogre
             }
             const uint32 textureFlags = TextureFlags::AutomaticBatching |
                                         TextureFlags::PrefersLoadingFromFileAsSRGB;
-            texture = mTextureManager->createOrRetrieveTexture( textureName, aliasName,
-                                                                GpuPageOutStrategy::Discard,
-                                                                textureFlags, TextureTypes::Type2D,
-                                                                resourceGroup );
+            if( mHlmsManager->getLoadTexturesLazily() )
+            {
+                isPending = true;
+                pendingName = textureName;
+                pendingAliasName = aliasName;
+                pendingFlags = textureFlags;
+            }
+            else
+            {
+                texture = mTextureManager->createOrRetrieveTexture( textureName, aliasName,
+                                                                    GpuPageOutStrategy::Discard,
+                                                                    textureFlags,
+                                                                    TextureTypes::Type2D,
+                                                                    resourceGroup );
+            }
 		}
 
 		itor = json.FindMember( "sampler" );
@@ -149,6 +164,13 @@ namespace Ogre
                 samplerblock = mHlmsManager->getSamplerblock(HlmsSamplerblock());
             datablock->_setTexture(textureType, texture, samplerblock);
         }
+        else if( isPending )
+        {
+            if( !samplerblock )
+                samplerblock = mHlmsManager->getSamplerblock( HlmsSamplerblock() );
+            datablock->_setPendingTexture( textureType, pendingName, pendingAliasName, resourceGroup,
+                                           pendingFlags, TextureTypes::Type2D, 0, samplerblock );
+        }
         else if (samplerblock)
             datablock->_setSamplerblock(textureType, samplerblock);
 	}
@@ -318,6 +340,9 @@ namespace Ogre
         assert( dynamic_cast<const HlmsUnlitDatablock*>(datablock) );
         const HlmsUnlitDatablock *unlitDatablock = static_cast<const HlmsUnlitDatablock*>(datablock);
 
+        //Lazily loaded textures would otherwise not be saved
+        const_cast<HlmsUnlitDatablock*>( unlitDatablock )->resolvePendingTextures();
+
 		ColourValue value = unlitDatablock->getColour();;
 		if (unlitDatablock->hasColour() && value != ColourValue::White)
 		{
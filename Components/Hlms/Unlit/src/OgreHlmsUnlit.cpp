@@ -65,6 +65,7 @@ THE SOFTWARE.
 
 
 #include "OgreProfiler.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -182,6 +183,12 @@ namespace Ogre
         vsParams->setNamedConstant( "worldMatBuf", 0 );
         if( getProperty( UnlitProperty::TextureMatrix ) )
             vsParams->setNamedConstant( "animationMatrixBuf", 1 );
+        if( getProperty( UnlitProperty::BillboardInstanced ) ||
+            getProperty( UnlitProperty::BillboardChain ) ||
+            getProperty( UnlitProperty::ImpostorInstanced ) )
+        {
+            vsParams->setNamedConstant( "billboardBuf", 1 );
+        }
 
         mListener->shaderCacheEntryCreated( mShaderProfile, retVal, passCache,
                                             mSetProperties, queuedRenderable );
@@ -243,6 +250,11 @@ namespace Ogre
     {
         assert( dynamic_cast<HlmsUnlitDatablock*>( renderable->getDatablock() ) );
         HlmsUnlitDatablock *datablock = static_cast<HlmsUnlitDatablock*>( renderable->getDatablock() );
+
+        //First use of a lazily loaded material. Creating its textures
+        //dirties the descriptor sets, which delays the hash below
+        datablock->resolvePendingTextures();
+
         if( datablock->getDirtyFlags() & (DirtyTextures|DirtySamplers) )
         {
             //Delay hash generation for later, when we have the final (or temporary) descriptor sets.
@@ -276,6 +288,18 @@ namespace Ogre
         setProperty( HlmsBaseProp::Tangent,     0 );
         setProperty( HlmsBaseProp::BonesPerVertex, 0 );
 
+        //Instanced billboards, billboard chains & impostors take the slot used by
+        //the animation matrices, thus texture animation is not available to them
+        const bool billboardInstanced = renderable->getBillboardInstanceBuffer() != 0;
+        setProperty( UnlitProperty::BillboardInstanced, billboardInstanced );
+        const bool billboardChain = renderable->getBillboardChainBuffer() != 0;
+        setProperty( UnlitProperty::BillboardChain, billboardChain );
+        const bool impostorInstanced = renderable->getImpostorInstanceBuffer() != 0;
+        setProperty( UnlitProperty::ImpostorInstanced, impostorInstanced );
+        //Impostors dither their cross fade with the fragment's screen position
+        if( impostorInstanced )
+            setProperty( HlmsBaseProp::VPos, 1 );
+
         if( datablock->mTexturesDescSet )
         {
             setProperty( UnlitProperty::NumTextures,
@@ -362,7 +386,7 @@ namespace Ogre
             {
                 const IdString &uvSourceSwizzleN = *UnlitProperty::DiffuseMapPtrs[i].uvSourceSwizzle;
 
-                if( datablock->mEnabledAnimationMatrices[i] )
+                if( datablock->mEnabledAnimationMatrices[i] && !billboardInstanced && !billboardChain )
                 {
                     //Animated outputs need their own entry
                     UvOutput uvOutput;
@@ -445,24 +469,39 @@ namespace Ogre
         setProperty( UnlitProperty::OutUvCount, static_cast<int32>( uvOutputs.size() ) );
         setProperty( UnlitProperty::OutUvHalfCount, static_cast<int32>( halfUvOutputs ) );
 
+        char tmpData[64];
+        LwString propName = LwString::FromEmptyPointer( tmpData, sizeof( tmpData ) );
+
         for( size_t i=0; i<halfUvOutputs; ++i )
         {
             //Decide whether to use vec4 or vec2 in VStoPS_block piece:
             // vec4 uv0; //--> When interpolant contains two uvs in one
             // vec2 uv0; //--> When interpolant contains the last UV (uvOutputs.size() is odd)
-            setProperty( "out_uv_half_count" + StringConverter::toString( i ),
-                         (i << 1u) == (uvOutputs.size() - 1u) ? 2 : 4 );
+            propName.clear();
+            propName.a( "out_uv_half_count", static_cast<uint32>( i ) );
+            setProperty( propName.c_str(), (i << 1u) == (uvOutputs.size() - 1u) ? 2 : 4 );
         }
 
         for( size_t i=0; i<uvOutputs.size(); ++i )
         {
-            String outPrefix = "out_uv" + StringConverter::toString( i );
-
-            setProperty( outPrefix + "_out_uv", i >> 1u );
-            setProperty( outPrefix + "_texture_matrix", uvOutputs[i].isAnimated );
-            setProperty( outPrefix + "_tex_unit", uvOutputs[i].texUnit );
-            setProperty( outPrefix + "_source_uv", uvOutputs[i].uvSource );
-            inOutPieces[VertexShader][outPrefix + "_swizzle"] = i % 2 ? "zw" : "xy";
+            propName.clear();
+            propName.a( "out_uv", static_cast<uint32>( i ) );
+            const size_t outUvPropSize = propName.size(); // out_uv0
+
+            propName.a( "_out_uv" );
+            setProperty( propName.c_str(), static_cast<int32>( i >> 1u ) );
+            propName.resize( outUvPropSize );
+            propName.a( "_texture_matrix" );
+            setProperty( propName.c_str(), uvOutputs[i].isAnimated );
+            propName.resize( outUvPropSize );
+            propName.a( "_tex_unit" );
+            setProperty( propName.c_str(), uvOutputs[i].texUnit );
+            propName.resize( outUvPropSize );
+            propName.a( "_source_uv" );
+            setProperty( propName.c_str(), uvOutputs[i].uvSource );
+            propName.resize( outUvPropSize );
+            propName.a( "_swizzle" );
+            inOutPieces[VertexShader][propName.c_str()] = i % 2 ? "zw" : "xy";
         }
 
         if( mFastShaderBuildHack )
@@ -705,6 +744,9 @@ namespace Ogre
             if( isShadowCastingPointLight )
                 mapSize += 4 * 4;
         }
+        //vec4 cameraPosWS (outside caster passes of point lights)
+        if( !isShadowCastingPointLight )
+            mapSize += 4 * 4;
         //vec4 clipPlane0
         if( isCameraReflected )
             mapSize += 4 * 4;
@@ -718,6 +760,7 @@ namespace Ogre
 
         if( mCurrentPassBuffer >= mPassBuffers.size() )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             mPassBuffers.push_back( mVaoManager->createConstBuffer( maxBufferSize,
                                                                     BT_DYNAMIC_PERSISTENT,
                                                                     0, false ) );
@@ -803,6 +846,16 @@ namespace Ogre
             }
         }
 
+        //vec4 cameraPosWS;
+        if( !isShadowCastingPointLight )
+        {
+            const Vector3 &camPos = cameras.renderingCamera->getDerivedPosition();
+            *passBufferPtr++ = (float)camPos.x;
+            *passBufferPtr++ = (float)camPos.y;
+            *passBufferPtr++ = (float)camPos.z;
+            *passBufferPtr++ = 1.0f;
+        }
+
         TextureGpu *renderTarget = mRenderSystem->getCurrentRenderViewports()[0].getCurrentTarget();
         //vec4 invWindowSize;
         *passBufferPtr++ = 1.0f / (float)renderTarget->getWidth();
@@ -820,6 +873,7 @@ namespace Ogre
         //mTexBuffers must hold at least one buffer to prevent out of bound exceptions.
         if( mTexBuffers.empty() )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             size_t bufferSize = std::min<size_t>( mTextureBufferDefaultSize,
                                                   mVaoManager->getTexBufferMaxSize() );
             TexBufferPacked *newBuffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT, bufferSize,
@@ -928,6 +982,22 @@ namespace Ogre
             mLastBoundPool = newPool;
         }
 
+        TexBufferPacked *billboardBuffer = queuedRenderable.renderable->getBillboardInstanceBuffer();
+        if( !billboardBuffer )
+            billboardBuffer = queuedRenderable.renderable->getBillboardChainBuffer();
+        if( !billboardBuffer )
+            billboardBuffer = queuedRenderable.renderable->getImpostorInstanceBuffer();
+        if( billboardBuffer )
+        {
+            //Uses the same slot as the pool's extraBuffer. Reset mLastBoundPool
+            //so that it gets bound again for the next Renderable.
+            *commandBuffer->addCommand<CbShaderBuffer>() = CbShaderBuffer( VertexShader, 1,
+                                                                           billboardBuffer, 0,
+                                                                           billboardBuffer->
+                                                                           getTotalSizeBytes() );
+            mLastBoundPool = 0;
+        }
+
         uint32 * RESTRICT_ALIAS currentMappedConstBuffer    = mCurrentMappedConstBuffer;
         float * RESTRICT_ALIAS currentMappedTexBuffer       = mCurrentMappedTexBuffer;
 
@@ -42,6 +42,9 @@ namespace Ogre
     const IdString UnlitProperty::TextureMatrix     = IdString( "texture_matrix" );
     const IdString UnlitProperty::ExponentialShadowMaps = IdString( "exponential_shadow_maps" );
     const IdString UnlitProperty::HasPlanarReflections  = IdString( "has_planar_reflections" );
+    const IdString UnlitProperty::BillboardInstanced    = IdString( "billboard_instanced" );
+    const IdString UnlitProperty::BillboardChain        = IdString( "billboard_chain" );
+    const IdString UnlitProperty::ImpostorInstanced     = IdString( "impostor_instanced" );
 
     const IdString UnlitProperty::TexMatrixCount        = IdString( "hlms_texture_matrix_count" );
     const IdString UnlitProperty::TexMatrixCount0       = IdString( "hlms_texture_matrix_count0" );
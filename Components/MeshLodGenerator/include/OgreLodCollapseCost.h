@@ -50,9 +50,21 @@ namespace Ogre
         virtual void computeVertexCollapseCost(LodData* data, LodData::Vertex* vertex, Real& collapseCost, LodData::Vertex*& collapseTo);
         /// Returns the collapse cost of the given edge.
         virtual Real computeEdgeCollapseCost(LodData* data, LodData::Vertex* src, LodData::Edge* dstEdge) = 0;
+        /// Whether computeVertexCollapseCost can be called concurrently on different vertices.
+        /// When true, initCollapseCosts spreads the work across LodData::mNumWorkerThreads threads.
+        virtual bool isThreadSafe() const { return false; }
+
+        /// Internal use. Computes the collapse cost of the vertices in [vertexStart; vertexEnd),
+        /// storing the cost in outCosts and the target in Vertex::collapseTo.
+        void _computeInitialCollapseCosts(LodData* data, size_t vertexStart, size_t vertexEnd, Real* outCosts);
     protected:
         // Helper functions:
         bool isBorderVertex(const LodData::Vertex* vertex) const;
+        /// Returns the number of threads initCollapseCosts should use for this data.
+        size_t getNumWorkerThreads(const LodData* data) const;
+        /// Spreads the initial collapse cost computation across threads, then fills
+        /// the collapse cost heap on the calling thread.
+        void initCollapseCostsThreaded(LodData* data, size_t numThreads);
     };
 
 }
@@ -42,6 +42,7 @@ namespace Ogre
     {
     public:
         virtual Real computeEdgeCollapseCost(LodData* data, LodData::Vertex* src, LodData::Edge* dstEdge);
+        virtual bool isThreadSafe() const { return true; }
     };
 
 }
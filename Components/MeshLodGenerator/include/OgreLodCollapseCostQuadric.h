@@ -45,6 +45,7 @@ namespace Ogre
         virtual void initCollapseCosts(LodData* data);
         virtual void updateVertexCollapseCost(LodData* data, LodData::Vertex* vertex);
         virtual Real computeEdgeCollapseCost(LodData* data, LodData::Vertex* src, LodData::Edge* dstEdge);
+        virtual bool isThreadSafe() const { return true; }
     protected:
 
         struct TriangleQuadricPlane
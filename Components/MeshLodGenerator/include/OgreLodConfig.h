@@ -162,6 +162,10 @@ namespace Ogre
             Ogre::Real outsideWalkAngle;
             /// If the algorithm makes errors, you can fix it, by adding the edge to the profile.
             LodProfile profile;
+            /// Number of threads used to compute the initial collapse costs of this mesh.
+            /// Only LodCollapseCost implementations which return true in isThreadSafe are
+            /// spread across threads. 0 means one thread per logical core. (1 by default)
+            uint32 numWorkerThreads;
             Advanced();
         } advanced;
     };
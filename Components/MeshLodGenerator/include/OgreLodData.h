@@ -169,6 +169,8 @@ namespace Ogre
 #endif
         Real mMeshBoundingSphereRadius;
         bool mUseVertexNormals;
+        /// Number of threads LodCollapseCost::initCollapseCosts may use. See LodConfig::Advanced.
+        uint32 mNumWorkerThreads;
 
         template<typename T, typename A>
         static size_t getVectorIDFromPointer(const std::vector<T, A>& vec, const T* pointer)
@@ -182,7 +184,8 @@ namespace Ogre
             mUniqueVertexSet((UniqueVertexSet::size_type) 0,
                              (const UniqueVertexSet::hasher&) VertexHash(this)),
             mMeshBoundingSphereRadius(0.0f),
-            mUseVertexNormals(true)
+            mUseVertexNormals(true),
+            mNumWorkerThreads(1u)
         {}
     };
 
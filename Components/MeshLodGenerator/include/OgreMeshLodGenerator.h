@@ -62,6 +62,27 @@ namespace Ogre
          */
         virtual void generateLodLevels(LodConfig& lodConfig, LodCollapseCostPtr cost = LodCollapseCostPtr(), LodDataPtr data = LodDataPtr(), LodInputProviderPtr input = LodInputProviderPtr(), LodOutputProviderPtr output = LodOutputProviderPtr(), LodCollapserPtr collapser = LodCollapserPtr());
 
+        typedef vector<LodConfig*>::type LodConfigPtrList;
+
+        /**
+         * @brief Generates the Lod levels for many meshes concurrently, one mesh per thread.
+         *
+         * Blocks until every mesh is done. Meshes are read and the results are injected on the
+         * calling thread; only the reduction itself runs on the worker threads, the same way
+         * LodConfig::Advanced::useBackgroundQueue works (which is ignored by this function).
+         *
+         * @param lodConfigs Specification of the requested Lod levels of each mesh.
+         * @param numThreads Max number of meshes processed at the same time.
+         * 0 means one per logical core.
+         * @param memoryBudget Max number of bytes all the meshes being processed at the same time
+         * are allowed to use (see estimateMemoryUsage). A mesh that doesn't fit the budget on its
+         * own is processed alone. 0 means unlimited.
+         */
+        void generateLodLevels(const LodConfigPtrList& lodConfigs, size_t numThreads = 0, size_t memoryBudget = 0);
+
+        /// Rough estimation of the bytes needed to generate the Lod levels of the given config.
+        static size_t estimateMemoryUsage(const LodConfig& lodConfig);
+
         /**
          * @brief Generates the Lod levels for a mesh without configuring it.
          *
@@ -89,6 +110,8 @@ namespace Ogre
     protected:
         void computeLods(LodConfig& lodConfig, LodData* data, LodCollapseCost* cost, LodOutputProvider* output, LodCollapser* collapser);
         void calcLodVertexCount(const LodLevel& lodLevel, size_t uniqueVertexCount, size_t& outVertexCountLimit, Real& outCollapseCostLimit);
+        /// Returns false if every Lod level is a manual Lod level and nobody needs LodData.
+        static bool needsLodData(const LodConfig& lodConfig);
 
         LodWorkQueueWorker* mWQWorker;
         LodWorkQueueInjector* mWQInjector;
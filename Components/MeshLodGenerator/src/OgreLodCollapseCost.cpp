@@ -29,14 +29,50 @@
 #include "OgreLodCollapseCost.h"
 
 #include "OgreLogManager.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
 
 #include <sstream>
 
 namespace Ogre
 {
+    /// Below this amount of vertices per thread, spawning threads costs more than it saves.
+    static const size_t c_minVerticesPerThread = 4096u;
+
+    namespace
+    {
+        struct InitialCostThreadParams
+        {
+            LodCollapseCost *cost;
+            LodData         *data;
+            Real            *costs;
+            size_t          numThreads;
+        };
+    }
+
+    unsigned long initialCollapseCostThread( ThreadHandle *threadHandle )
+    {
+        const InitialCostThreadParams *params =
+                reinterpret_cast<const InitialCostThreadParams*>( threadHandle->getUserParam() );
+        const size_t threadIdx = threadHandle->getThreadIdx();
+        const size_t numVertices = params->data->mVertexList.size();
+        params->cost->_computeInitialCollapseCosts( params->data,
+                                                    (numVertices * threadIdx) / params->numThreads,
+                                                    (numVertices * (threadIdx + 1u)) / params->numThreads,
+                                                    params->costs );
+        return 0;
+    }
+    THREAD_DECLARE( initialCollapseCostThread );
+
     void LodCollapseCost::initCollapseCosts( LodData* data )
     {
         data->mCollapseCostHeap.clear();
+        const size_t numThreads = getNumWorkerThreads(data);
+        if (numThreads > 1u)
+        {
+            initCollapseCostsThreaded(data, numThreads);
+            return;
+        }
         LodData::VertexList::iterator it = data->mVertexList.begin();
         LodData::VertexList::iterator itEnd = data->mVertexList.end();
         for (; it != itEnd; it++)
@@ -59,6 +95,78 @@ namespace Ogre
         }
     }
 
+    size_t LodCollapseCost::getNumWorkerThreads( const LodData* data ) const
+    {
+        if (!isThreadSafe())
+        {
+            return 1u;
+        }
+
+        size_t numThreads = data->mNumWorkerThreads;
+        if (numThreads == 0)
+        {
+            //getNumLogicalCores() may return 0 if couldn't detect
+            numThreads = std::max<size_t>( 1u, PlatformInformation::getNumLogicalCores() );
+        }
+        numThreads = std::min( numThreads, data->mVertexList.size() / c_minVerticesPerThread );
+        // WaitForMultipleObjects can't wait on more than 64 handles
+        numThreads = std::min<size_t>( numThreads, 65u );
+        return std::max<size_t>( numThreads, 1u );
+    }
+
+    void LodCollapseCost::_computeInitialCollapseCosts( LodData* data, size_t vertexStart,
+                                                        size_t vertexEnd, Real* outCosts )
+    {
+        for (size_t i = vertexStart; i < vertexEnd; ++i)
+        {
+            LodData::Vertex* vertex = &data->mVertexList[i];
+            if (!vertex->edges.empty())
+            {
+                Real collapseCost = LodData::UNINITIALIZED_COLLAPSE_COST;
+                LodData::Vertex* collapseTo = NULL;
+                computeVertexCollapseCost(data, vertex, collapseCost, collapseTo);
+                vertex->collapseTo = collapseTo;
+                outCosts[i] = collapseCost;
+            }
+        }
+    }
+
+    void LodCollapseCost::initCollapseCostsThreaded( LodData* data, size_t numThreads )
+    {
+        // computeVertexCollapseCost only writes to the vertex' own edges, so vertices can be
+        // processed concurrently. The heap is a multimap though, so it's filled afterwards,
+        // in the same order as the single threaded path to get the exact same results.
+        vector<Real>::type costs(data->mVertexList.size(), LodData::UNINITIALIZED_COLLAPSE_COST);
+
+        InitialCostThreadParams params;
+        params.cost = this;
+        params.data = data;
+        params.costs = &costs[0];
+        params.numThreads = numThreads;
+
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve(numThreads - 1u);
+        for (size_t i = 1u; i < numThreads; ++i)
+        {
+            threadHandles.push_back(Threads::CreateThread(THREAD_GET(initialCollapseCostThread),
+                                                          i, &params));
+        }
+        // The calling thread does its share too
+        _computeInitialCollapseCosts(data, 0, data->mVertexList.size() / numThreads, &costs[0]);
+        Threads::WaitForThreads(threadHandles);
+
+        const size_t numVertices = data->mVertexList.size();
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            LodData::Vertex* vertex = &data->mVertexList[i];
+            if (!vertex->edges.empty())
+            {
+                vertex->costHeapPosition = data->mCollapseCostHeap.insert(
+                            LodData::CollapseCostHeap::value_type(costs[i], vertex));
+            }
+        }
+    }
+
     void LodCollapseCost::computeVertexCollapseCost( LodData* data, LodData::Vertex* vertex, Real& collapseCost, LodData::Vertex*& collapseTo )
     {
         LodData::VEdges::iterator it = vertex->edges.begin();
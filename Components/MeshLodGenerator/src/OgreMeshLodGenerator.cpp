@@ -44,6 +44,10 @@
 #include "OgreLodCollapseCostOutside.h"
 #include "OgreLodData.h"
 #include "OgreLodCollapser.h"
+#include "OgreSubMesh.h"
+#include "OgreVertexIndexData.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
 
 
 namespace Ogre
@@ -217,6 +221,7 @@ namespace Ogre
     {
         input->initData(data);
         data->mUseVertexNormals = data->mUseVertexNormals && lodConfig.advanced.useVertexNormals;
+        data->mNumWorkerThreads = lodConfig.advanced.numWorkerThreads;
         cost->initCollapseCosts(data);
         output->prepare(data);
         computeLods(lodConfig, data, cost, output, collapser);
@@ -237,16 +242,7 @@ namespace Ogre
             LodCollapserPtr collapser)
     {
         // If we don't have generated Lod levels, we can use _generateManualLodLevels.
-        bool hasGeneratedLevels = false;
-        for(size_t i = 0; i < lodConfig.levels.size(); i++)
-        {
-            if(lodConfig.levels[i].manualMeshName.empty())
-            {
-                hasGeneratedLevels = true;
-                break;
-            }
-        }
-        if(hasGeneratedLevels || (LodWorkQueueInjector::getSingletonPtr() && LodWorkQueueInjector::getSingletonPtr()->getInjectorListener()))
+        if(needsLodData(lodConfig))
         {
             _resolveComponents(lodConfig, cost, data, input, output, collapser);
             if(lodConfig.advanced.useBackgroundQueue)
@@ -267,6 +263,155 @@ namespace Ogre
         lodConfig.mesh->prepareForShadowMapping( false );
     }
 
+    bool MeshLodGenerator::needsLodData(const LodConfig& lodConfig)
+    {
+        for(size_t i = 0; i < lodConfig.levels.size(); i++)
+        {
+            if(lodConfig.levels[i].manualMeshName.empty())
+            {
+                return true;
+            }
+        }
+        return LodWorkQueueInjector::getSingletonPtr() && LodWorkQueueInjector::getSingletonPtr()->getInjectorListener();
+    }
+
+    size_t MeshLodGenerator::estimateMemoryUsage(const LodConfig& lodConfig)
+    {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+        const v1::Mesh* mesh = lodConfig.mesh.get();
+        if(mesh->sharedVertexData[VpNormal])
+        {
+            vertexCount += mesh->sharedVertexData[VpNormal]->vertexCount;
+        }
+        const size_t submeshCount = mesh->getNumSubMeshes();
+        for(size_t i = 0; i < submeshCount; i++)
+        {
+            const v1::SubMesh* submesh = mesh->getSubMesh(i);
+            if(!submesh->useSharedVertices)
+            {
+                vertexCount += submesh->vertexData[VpNormal]->vertexCount;
+            }
+            indexCount += submesh->indexData[VpNormal]->indexCount;
+        }
+
+        // LodInputBuffer copy (positions & normals, 32-bit indices)
+        size_t bytes = vertexCount * 2u * sizeof(Vector3) + indexCount * sizeof(uint32);
+        // LodData (assuming ~6 edges per vertex) and its lookup tables
+        bytes += vertexCount * (sizeof(LodData::Vertex) + 6u * sizeof(LodData::Edge) + 6u * sizeof(void*));
+        bytes += (indexCount / 3u) * sizeof(LodData::Triangle);
+        // Generated index buffers. Each level has at most as many indices as the original
+        bytes += lodConfig.levels.size() * indexCount * sizeof(uint32);
+        return bytes;
+    }
+
+    namespace
+    {
+        struct LodBatchJob
+        {
+            LodConfig* config;
+            LodCollapseCostPtr cost;
+            LodDataPtr data;
+            LodInputProviderPtr input;
+            LodOutputProviderPtr output;
+            LodCollapserPtr collapser;
+            bool useBackgroundQueue;
+        };
+        typedef vector<LodBatchJob>::type LodBatchJobList;
+    }
+
+    unsigned long lodBatchWorkerThread( ThreadHandle *threadHandle )
+    {
+        LodBatchJob* job = reinterpret_cast<LodBatchJob*>( threadHandle->getUserParam() );
+        MeshLodGenerator::getSingleton()._process( *job->config, job->cost.get(), job->data.get(),
+                                                   job->input.get(), job->output.get(),
+                                                   job->collapser.get() );
+        return 0;
+    }
+    THREAD_DECLARE( lodBatchWorkerThread );
+
+    void MeshLodGenerator::generateLodLevels(const LodConfigPtrList& lodConfigs, size_t numThreads, size_t memoryBudget)
+    {
+        if(numThreads == 0)
+        {
+            //getNumLogicalCores() may return 0 if couldn't detect
+            numThreads = std::max<size_t>(1u, PlatformInformation::getNumLogicalCores());
+        }
+        // WaitForMultipleObjects can't wait on more than 64 handles
+        numThreads = std::min<size_t>(numThreads, 65u);
+
+        LodBatchJobList jobs;
+        jobs.reserve(numThreads);
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve(numThreads);
+
+        LodConfigPtrList::const_iterator itor = lodConfigs.begin();
+        LodConfigPtrList::const_iterator end  = lodConfigs.end();
+
+        while(itor != end)
+        {
+            // Gather as many meshes as the thread count and the memory budget allow.
+            // The input buffers are filled here, on the calling thread.
+            size_t usedMemory = 0;
+            while(itor != end && jobs.size() < numThreads)
+            {
+                LodConfig& lodConfig = **itor;
+                if(!needsLodData(lodConfig))
+                {
+                    _generateManualLodLevels(lodConfig);
+                    lodConfig.mesh->prepareForShadowMapping( false );
+                    ++itor;
+                    continue;
+                }
+
+                const size_t requiredMemory = estimateMemoryUsage(lodConfig);
+                if(memoryBudget != 0 && !jobs.empty() && usedMemory + requiredMemory > memoryBudget)
+                {
+                    break;
+                }
+                usedMemory += requiredMemory;
+
+                LodBatchJob job;
+                job.config = &lodConfig;
+                job.useBackgroundQueue = lodConfig.advanced.useBackgroundQueue;
+                // Selects the thread-safe buffer providers and makes _process skip injection
+                lodConfig.advanced.useBackgroundQueue = true;
+                _resolveComponents(lodConfig, job.cost, job.data, job.input, job.output, job.collapser);
+                jobs.push_back(job);
+                ++itor;
+            }
+
+            if(jobs.empty())
+            {
+                continue;
+            }
+
+            // The calling thread takes the first mesh
+            for(size_t i = 1u; i < jobs.size(); i++)
+            {
+                threadHandles.push_back(Threads::CreateThread(THREAD_GET(lodBatchWorkerThread), i, &jobs[i]));
+            }
+            _process(*jobs[0].config, jobs[0].cost.get(), jobs[0].data.get(), jobs[0].input.get(),
+                     jobs[0].output.get(), jobs[0].collapser.get());
+            Threads::WaitForThreads(threadHandles);
+            threadHandles.clear();
+
+            LodBatchJobList::iterator itJob = jobs.begin();
+            LodBatchJobList::iterator enJob = jobs.end();
+            for(; itJob != enJob; ++itJob)
+            {
+                LodConfig& lodConfig = *itJob->config;
+                lodConfig.advanced.useBackgroundQueue = itJob->useBackgroundQueue;
+                itJob->output->inject();
+                _configureMeshLodUsage(lodConfig);
+                lodConfig.mesh->prepareForShadowMapping( false );
+            }
+
+            // Releases the LodData before moving on to the next meshes
+            jobs.clear();
+        }
+    }
+
     void MeshLodGenerator::computeLods(LodConfig& lodConfig,
                                        LodData* data,
                                        LodCollapseCost* cost,
@@ -181,6 +181,12 @@ namespace v1 {
         /** @copydoc OverlayContainer::_updateRenderQueue */
         void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
 
+        /// The border and the center share a vertex buffer of their own, thus can't be batched
+        virtual bool _isBatchable(void) const { return false; }
+
+        /** @copydoc OverlayElement::_addToBatch */
+        virtual void _addToBatch(OverlayBatch* batch);
+
         /** @copydoc OverlayElement::setMetricsMode */
         void setMetricsMode(GuiMetricsMode gmm);
 
@@ -90,6 +90,8 @@ namespace v1 {
         mutable Matrix4 mTransform;
         mutable bool mTransformOutOfDate;
         bool mInitialised;
+        /// Non-null when batched. See setBatched
+        OverlayBatch *mBatch;
         String mOrigin;
         /** Internal lazy update method. */
         void updateTransform(void) const;
@@ -119,6 +121,23 @@ namespace v1 {
         /** Gets whether the overlay is initialised or not. */
         bool isInitialised(void) const { return mInitialised; }
 
+        /** Renders the elements of this overlay out of a single dynamic vertex buffer, merging
+            consecutive elements that use the same material into a single draw call.
+        @remarks
+            Panels and text areas are batched; other elements (like the border of a
+            BorderPanelOverlayElement) are still drawn on their own, in between batches.
+            Only the first set of texture coordinates is used by batched panels.
+        @par
+            Batches are Renderables in the overlay's render queue, which should be set to
+            RenderQueue::DisableSort or RenderQueue::StableSort to keep the elements' order.
+        @see OverlayBatch
+        */
+        void setBatched( bool batched );
+        bool isBatched(void) const { return mBatch != 0; }
+
+        /// Returns null if not batched
+        OverlayBatch* getBatch(void) const { return mBatch; }
+
         /** Shows the overlay if it was hidden. */
         void show(void);
 
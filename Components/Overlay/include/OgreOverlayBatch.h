@@ -0,0 +1,166 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __OverlayBatch_H__
+#define __OverlayBatch_H__
+
+#include "OgreOverlayPrerequisites.h"
+#include "OgreRenderable.h"
+#include "OgreRenderOperation.h"
+#include "OgreHardwareVertexBuffer.h"
+#include "OgreFastArray.h"
+
+namespace Ogre {
+namespace v1 {
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Overlays
+    *  @{
+    */
+
+    /// Layout of the vertices in the buffer shared by all the elements of a batched Overlay
+    struct OverlayBatchVertex
+    {
+        float   x, y, z;
+        float   u, v;
+        RGBA    colour;
+    };
+
+    typedef FastArray<OverlayBatchVertex> OverlayBatchVertexArray;
+
+    /** Renders all the elements of an Overlay out of a single dynamic vertex buffer.
+    @remarks
+        See Overlay::setBatched. Batchable elements (panels and text areas) write their
+        geometry to a CPU-side array instead of their own vertex buffers. Every frame the
+        elements are collected in the order they'd be rendered, and consecutive ones using
+        the same datablock (i.e. all the text in the same font, or panels sharing a
+        material) are drawn with a single draw call.
+        Elements that can't be batched (e.g. the border of a BorderPanel, or custom
+        elements) are rendered on their own, in between batches.
+    @par
+        When the elements, their order and their vertex counts are the same as last frame,
+        only the ranges of the elements whose geometry changed are written to the
+        buffer. Otherwise the whole buffer is rewritten.
+    @par
+        Batches are sorted by the RenderQueue like any other Renderable. Set the overlay's
+        render queue to RenderQueue::DisableSort (or StableSort) to preserve their order.
+    */
+    class _OgreOverlayExport OverlayBatch : public OverlayAlloc
+    {
+    public:
+        /// Range of the shared vertex buffer drawn with a single datablock
+        class _OgreOverlayExport Batch : public Renderable, public OverlayAlloc
+        {
+            OverlayBatch    *mParent;
+            RenderOperation mRenderOp;
+
+        public:
+            Batch( OverlayBatch *parent );
+            virtual ~Batch();
+
+            void _setVertexBuffer( const HardwareVertexBufferSharedPtr &vertexBuffer );
+            void _setRange( size_t vertexStart, size_t vertexCount );
+
+            virtual void getRenderOperation( RenderOperation &op, bool casterPass );
+            virtual void getWorldTransforms( Matrix4 *xform ) const;
+            virtual const LightList& getLights(void) const;
+        };
+
+        struct Stats
+        {
+            /// Renderables put in the queue (batches + unbatched elements)
+            size_t  mNumDraws;
+            size_t  mNumBatchedElements;
+            size_t  mNumUnbatchedElements;
+            /// Vertices written to the GPU buffer
+            size_t  mNumUploadedVertices;
+        };
+
+    protected:
+        struct Entry
+        {
+            /// Null if the entry isn't batched
+            OverlayElement  *element;
+            Renderable      *renderable;
+            HlmsDatablock   *datablock;
+            uint32          vertexStart;
+            uint32          numVertices;
+            uint32          geometryVersion;
+        };
+
+        typedef vector<Entry>::type EntryVec;
+        typedef vector<Batch*>::type BatchVec;
+
+        Overlay         *mOverlay;
+
+        EntryVec        mEntries;
+        /// Entries of the last frame, to figure out what needs to be uploaded
+        EntryVec        mLastEntries;
+
+        BatchVec        mBatches;
+        size_t          mNumUsedBatches;
+
+        HardwareVertexBufferSharedPtr mVertexBuffer;
+
+        Stats           mStats;
+
+        /// Writes the dirty (or all) vertices to mVertexBuffer, growing it if needed
+        void uploadGeometry( size_t totalVertices );
+        Batch* getNextBatch( HlmsDatablock *datablock, uint32 vertexStart, uint32 numVertices );
+
+    public:
+        OverlayBatch( Overlay *overlay );
+        ~OverlayBatch();
+
+        Overlay* getOverlay(void) const                 { return mOverlay; }
+
+        /// Clears the entries from the previous frame. Called by Overlay::_updateRenderQueue
+        void _beginFrame(void);
+
+        /// Adds a batchable element, in rendering order. See OverlayElement::_addToBatch
+        void addElement( OverlayElement *element );
+        /// Adds a renderable which will be drawn on its own, in rendering order.
+        void addRenderable( Renderable *renderable );
+
+        /// Uploads the geometry and puts the batches in the queue
+        void _updateRenderQueue( RenderQueue *queue );
+
+        /// Notifies that hardware resources were lost. The buffer is recreated on demand.
+        void _releaseManualHardwareResources(void);
+
+        /// Statistics of the last frame
+        const Stats& getStats(void) const               { return mStats; }
+    };
+    /** @} */
+    /** @} */
+}
+}
+
+#endif
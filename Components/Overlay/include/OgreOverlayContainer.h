@@ -115,6 +115,12 @@ namespace v1 {
         /** Overridden from OverlayElement. */
         virtual void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
 
+        /** Overridden from OverlayElement. */
+        virtual void _addToBatch(OverlayBatch* batch);
+
+        /** Overridden from OverlayElement. */
+        virtual void _notifyBatchingChanged(void);
+
         /** Overridden from OverlayElement. */
         inline bool isContainer() const
         { return true; }
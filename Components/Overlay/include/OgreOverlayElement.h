@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreStringInterface.h"
 #include "OgreOverlayElementCommands.h"
 #include "OgreColourValue.h"
+#include "OgreOverlayBatch.h"
 
 namespace Ogre {
 namespace v1 {
@@ -171,6 +172,15 @@ namespace v1 {
         /// Used to see if this element is created from a Template
         OverlayElement* mSourceTemplate ;
 
+        /// Geometry written for OverlayBatch instead of our own buffers. See Overlay::setBatched
+        OverlayBatchVertexArray mBatchVertices;
+        /// Changes every time mBatchVertices is written, so the batch knows what to upload
+        uint32 mBatchGeometryVersion;
+        static uint32 msNextBatchGeometryVersion;
+
+        /// Must be called after writing to mBatchVertices
+        void notifyBatchGeometryChanged(void)   { mBatchGeometryVersion = ++msNextBatchGeometryVersion; }
+
         /** Internal method which is triggered when the positions of the element get updated,
         meaning the element should be rebuilding it's mesh positions. Abstract since
         subclasses must implement this.
@@ -330,6 +340,25 @@ namespace v1 {
         /** Internal method to put the contents onto the render queue. */
         virtual void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
 
+        /** Whether this element can write its geometry to an OverlayBatch.
+            Elements which can't are rendered on their own when their Overlay is batched.
+        */
+        virtual bool _isBatchable(void) const { return false; }
+
+        /// True if this element is batchable and its Overlay is batched
+        bool _isBatched(void) const;
+
+        /** Internal method to add the contents to the batch of a batched Overlay,
+            in the same order as _updateRenderQueue would.
+        */
+        virtual void _addToBatch(OverlayBatch* batch);
+
+        /// Internal method to notify the element its Overlay was batched or unbatched.
+        virtual void _notifyBatchingChanged(void);
+
+        const OverlayBatchVertexArray& _getBatchVertices(void) const { return mBatchVertices; }
+        uint32 _getBatchGeometryVersion(void) const { return mBatchGeometryVersion; }
+
         /** Gets the type name of the element. All concrete subclasses must implement this. */
         virtual const String& getTypeName(void) const = 0;
 
@@ -39,6 +39,7 @@ namespace Ogre
     namespace v1
     {
         class Overlay;
+        class OverlayBatch;
         class OverlayContainer;
         class OverlayElement;
         class OverlayElementFactory;
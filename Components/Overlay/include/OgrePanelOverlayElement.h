@@ -108,6 +108,10 @@ namespace v1 {
         void setMaterialName(const String& matName);
         /** Overridden from OverlayContainer */
         void _updateRenderQueue(RenderQueue* queue, Camera *camera, const Camera *lodCamera);
+        /** Overridden from OverlayElement */
+        virtual bool _isBatchable(void) const { return true; }
+        /** Overridden from OverlayContainer */
+        virtual void _addToBatch(OverlayBatch* batch);
 
 
         /** Command object for specifying tiling (see ParamCommand).*/
@@ -129,6 +129,12 @@ namespace v1
         /** Overridden from OverlayElement */
         void _update(void);
 
+        /** Overridden from OverlayElement */
+        virtual bool _isBatchable(void) const { return true; }
+
+        /** Overridden from OverlayElement */
+        virtual void _notifyBatchingChanged(void);
+
         //-----------------------------------------------------------------------------------------
         /** Command object for setting the caption.
                 @see ParamCommand
@@ -635,6 +635,16 @@ namespace v1 {
         }
     }
     //-----------------------------------------------------------------------
+    void BorderPanelOverlayElement::_addToBatch(OverlayBatch* batch)
+    {
+        if (mVisible)
+        {
+            // Same order as _updateRenderQueue
+            batch->addRenderable(mBorderRenderable);
+            PanelOverlayElement::_addToBatch(batch);
+        }
+    }
+    //-----------------------------------------------------------------------
     void BorderPanelOverlayElement::setMetricsMode(GuiMetricsMode gmm)
     {
         PanelOverlayElement::setMetricsMode(gmm);
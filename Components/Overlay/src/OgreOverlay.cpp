@@ -28,6 +28,7 @@ THE SOFTWARE.
 
 #include "OgreOverlay.h"
 #include "OgreOverlayContainer.h"
+#include "OgreOverlayBatch.h"
 #include "OgreOverlayManager.h"
 #include "OgreVector3.h"
 #include "OgreSceneNode.h"
@@ -47,7 +48,8 @@ namespace v1 {
         mScaleX(1.0f), mScaleY(1.0f),
         mLastViewportWidth(0), mLastViewportHeight(0),
         mTransformOutOfDate(true),
-        mInitialised(false)
+        mInitialised(false),
+        mBatch(0)
 
     {
         this->setName( name );
@@ -61,6 +63,9 @@ namespace v1 {
         {
             (*i)->_notifyParent(0, 0);
         }
+
+        OGRE_DELETE mBatch;
+        mBatch = 0;
     }
     //---------------------------------------------------------------------
     const String& Overlay::getMovableType(void) const
@@ -230,14 +235,48 @@ namespace v1 {
 
             // Add 2D elements
             iend = m2DElements.end();
-            for (i = m2DElements.begin(); i != iend; ++i)
+            if( mBatch )
             {
-                (*i)->_update();
-                (*i)->_updateRenderQueue( queue, camera, lodCamera );
+                mBatch->_beginFrame();
+                for (i = m2DElements.begin(); i != iend; ++i)
+                {
+                    (*i)->_update();
+                    (*i)->_addToBatch( mBatch );
+                }
+                mBatch->_updateRenderQueue( queue );
+            }
+            else
+            {
+                for (i = m2DElements.begin(); i != iend; ++i)
+                {
+                    (*i)->_update();
+                    (*i)->_updateRenderQueue( queue, camera, lodCamera );
+                }
             }
         }
     }
     //---------------------------------------------------------------------
+    void Overlay::setBatched( bool batched )
+    {
+        if( batched == isBatched() )
+            return;
+
+        if( batched )
+        {
+            mBatch = OGRE_NEW OverlayBatch( this );
+        }
+        else
+        {
+            OGRE_DELETE mBatch;
+            mBatch = 0;
+        }
+
+        OverlayContainerList::iterator itor = m2DElements.begin();
+        OverlayContainerList::iterator end  = m2DElements.end();
+        while( itor != end )
+            (*itor++)->_notifyBatchingChanged();
+    }
+    //---------------------------------------------------------------------
     void Overlay::updateTransform(void) const
     {
         // Ordering:
@@ -0,0 +1,307 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreOverlayBatch.h"
+#include "OgreOverlay.h"
+#include "OgreOverlayElement.h"
+#include "OgreHardwareBufferManager.h"
+#include "OgreRenderQueue.h"
+
+namespace Ogre {
+namespace v1 {
+    //---------------------------------------------------------------------
+    OverlayBatch::Batch::Batch( OverlayBatch *parent ) :
+        mParent( parent )
+    {
+        mRenderOp.vertexData = OGRE_NEW VertexData();
+        VertexDeclaration *decl = mRenderOp.vertexData->vertexDeclaration;
+        size_t offset = 0;
+        decl->addElement( 0, offset, VET_FLOAT3, VES_POSITION );
+        offset += VertexElement::getTypeSize( VET_FLOAT3 );
+        decl->addElement( 0, offset, VET_FLOAT2, VES_TEXTURE_COORDINATES, 0 );
+        offset += VertexElement::getTypeSize( VET_FLOAT2 );
+        decl->addElement( 0, offset, VET_COLOUR, VES_DIFFUSE );
+
+        mRenderOp.vertexData->vertexStart = 0;
+        mRenderOp.vertexData->vertexCount = 0;
+        mRenderOp.operationType = OT_TRIANGLE_LIST;
+        mRenderOp.useIndexes = false;
+        mRenderOp.useGlobalInstancingVertexBufferIsAvailable = false;
+
+        mPolygonModeOverrideable = false;
+        mUseIdentityProjection = true;
+        mUseIdentityView = true;
+    }
+    //---------------------------------------------------------------------
+    OverlayBatch::Batch::~Batch()
+    {
+        OGRE_DELETE mRenderOp.vertexData;
+        mRenderOp.vertexData = 0;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::Batch::_setVertexBuffer( const HardwareVertexBufferSharedPtr &vertexBuffer )
+    {
+        if( vertexBuffer.isNull() )
+            mRenderOp.vertexData->vertexBufferBinding->unsetAllBindings();
+        else
+            mRenderOp.vertexData->vertexBufferBinding->setBinding( 0, vertexBuffer );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::Batch::_setRange( size_t vertexStart, size_t vertexCount )
+    {
+        mRenderOp.vertexData->vertexStart = vertexStart;
+        mRenderOp.vertexData->vertexCount = vertexCount;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::Batch::getRenderOperation( RenderOperation &op, bool casterPass )
+    {
+        op = mRenderOp;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::Batch::getWorldTransforms( Matrix4 *xform ) const
+    {
+        mParent->getOverlay()->_getWorldTransforms( xform );
+    }
+    //---------------------------------------------------------------------
+    const LightList& OverlayBatch::Batch::getLights(void) const
+    {
+        // Overlays are not lit by the scene, this will not get called
+        static LightList ll;
+        return ll;
+    }
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    //---------------------------------------------------------------------
+    OverlayBatch::OverlayBatch( Overlay *overlay ) :
+        mOverlay( overlay ),
+        mNumUsedBatches( 0 )
+    {
+        memset( &mStats, 0, sizeof( mStats ) );
+    }
+    //---------------------------------------------------------------------
+    OverlayBatch::~OverlayBatch()
+    {
+        BatchVec::const_iterator itor = mBatches.begin();
+        BatchVec::const_iterator end  = mBatches.end();
+
+        while( itor != end )
+            OGRE_DELETE *itor++;
+
+        mBatches.clear();
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::_beginFrame(void)
+    {
+        mLastEntries.swap( mEntries );
+        mEntries.clear();
+        mNumUsedBatches = 0;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::addElement( OverlayElement *element )
+    {
+        const OverlayBatchVertexArray &vertices = element->_getBatchVertices();
+        HlmsDatablock *datablock = element->getDatablock();
+
+        if( vertices.empty() || !datablock )
+            return;
+
+        Entry entry;
+        entry.element           = element;
+        entry.renderable        = element;
+        entry.datablock         = datablock;
+        entry.vertexStart       = 0;
+        entry.numVertices       = static_cast<uint32>( vertices.size() );
+        entry.geometryVersion   = element->_getBatchGeometryVersion();
+        mEntries.push_back( entry );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::addRenderable( Renderable *renderable )
+    {
+        Entry entry;
+        entry.element           = 0;
+        entry.renderable        = renderable;
+        entry.datablock         = 0;
+        entry.vertexStart       = 0;
+        entry.numVertices       = 0;
+        entry.geometryVersion   = 0;
+        mEntries.push_back( entry );
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::uploadGeometry( size_t totalVertices )
+    {
+        const size_t vertexSize = sizeof( OverlayBatchVertex );
+
+        bool sameLayout = mEntries.size() == mLastEntries.size();
+
+        if( mVertexBuffer.isNull() || mVertexBuffer->getNumVertices() < totalVertices )
+        {
+            size_t numVertices = mVertexBuffer.isNull() ? 0 : mVertexBuffer->getNumVertices();
+            numVertices = std::max( totalVertices, numVertices + (numVertices >> 1u) );
+
+            mVertexBuffer = HardwareBufferManager::getSingleton().createVertexBuffer(
+                                vertexSize, numVertices, HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY );
+
+            BatchVec::const_iterator itor = mBatches.begin();
+            BatchVec::const_iterator end  = mBatches.end();
+            while( itor != end )
+                (*itor++)->_setVertexBuffer( mVertexBuffer );
+
+            sameLayout = false;
+        }
+
+        EntryVec::const_iterator itor = mEntries.begin();
+        EntryVec::const_iterator end  = mEntries.end();
+        EntryVec::const_iterator itLast = mLastEntries.begin();
+
+        while( sameLayout && itor != end )
+        {
+            sameLayout = itor->element == itLast->element && itor->numVertices == itLast->numVertices;
+            ++itor;
+            ++itLast;
+        }
+
+        if( !sameLayout )
+        {
+            //Something was added, removed or resized. Rewrite everything.
+            HardwareBufferLockGuard vbufLock( mVertexBuffer, 0, totalVertices * vertexSize,
+                                              HardwareBuffer::HBL_DISCARD );
+            OverlayBatchVertex *dstVertex = static_cast<OverlayBatchVertex*>( vbufLock.pData );
+
+            for( itor = mEntries.begin(); itor != end; ++itor )
+            {
+                if( itor->element )
+                {
+                    const OverlayBatchVertexArray &vertices = itor->element->_getBatchVertices();
+                    memcpy( dstVertex + itor->vertexStart, vertices.begin(),
+                            itor->numVertices * vertexSize );
+                }
+            }
+
+            mStats.mNumUploadedVertices = totalVertices;
+        }
+        else
+        {
+            //Only update the elements whose geometry changed.
+            itLast = mLastEntries.begin();
+            for( itor = mEntries.begin(); itor != end; ++itor, ++itLast )
+            {
+                if( itor->element && itor->geometryVersion != itLast->geometryVersion )
+                {
+                    const OverlayBatchVertexArray &vertices = itor->element->_getBatchVertices();
+                    mVertexBuffer->writeData( itor->vertexStart * vertexSize,
+                                              itor->numVertices * vertexSize,
+                                              vertices.begin(), false );
+                    mStats.mNumUploadedVertices += itor->numVertices;
+                }
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    OverlayBatch::Batch* OverlayBatch::getNextBatch( HlmsDatablock *datablock,
+                                                     uint32 vertexStart, uint32 numVertices )
+    {
+        if( mNumUsedBatches >= mBatches.size() )
+        {
+            Batch *batch = OGRE_NEW Batch( this );
+            batch->_setVertexBuffer( mVertexBuffer );
+            mBatches.push_back( batch );
+        }
+
+        Batch *batch = mBatches[mNumUsedBatches++];
+        batch->_setRange( vertexStart, numVertices );
+        if( batch->getDatablock() != datablock )
+            batch->setDatablock( datablock );
+        return batch;
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::_updateRenderQueue( RenderQueue *queue )
+    {
+        memset( &mStats, 0, sizeof( mStats ) );
+
+        //Assign each element its range in the buffer
+        uint32 totalVertices = 0;
+        EntryVec::iterator itor = mEntries.begin();
+        EntryVec::iterator end  = mEntries.end();
+
+        while( itor != end )
+        {
+            itor->vertexStart = totalVertices;
+            totalVertices += itor->numVertices;
+            ++itor;
+        }
+
+        if( totalVertices )
+            uploadGeometry( totalVertices );
+
+        const uint8 rqId = mOverlay->getRenderQueueGroup();
+
+        itor = mEntries.begin();
+        while( itor != end )
+        {
+            if( !itor->element )
+            {
+                queue->addRenderableV1( rqId, false, itor->renderable, mOverlay );
+                ++mStats.mNumUnbatchedElements;
+                ++mStats.mNumDraws;
+                ++itor;
+            }
+            else
+            {
+                //Merge consecutive elements sharing the same datablock
+                HlmsDatablock *datablock = itor->datablock;
+                const uint32 vertexStart = itor->vertexStart;
+                uint32 numVertices = 0;
+
+                while( itor != end && itor->element && itor->datablock == datablock )
+                {
+                    numVertices += itor->numVertices;
+                    ++mStats.mNumBatchedElements;
+                    ++itor;
+                }
+
+                Batch *batch = getNextBatch( datablock, vertexStart, numVertices );
+                queue->addRenderableV1( rqId, false, batch, mOverlay );
+                ++mStats.mNumDraws;
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void OverlayBatch::_releaseManualHardwareResources(void)
+    {
+        mVertexBuffer.setNull();
+
+        BatchVec::const_iterator itor = mBatches.begin();
+        BatchVec::const_iterator end  = mBatches.end();
+        while( itor != end )
+            (*itor++)->_setVertexBuffer( mVertexBuffer );
+
+        //Forces a full upload once the buffer is recreated
+        mLastEntries.clear();
+    }
+}
+}
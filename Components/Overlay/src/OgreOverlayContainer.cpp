@@ -271,6 +271,28 @@ namespace v1 {
         }
 
     }
+    //---------------------------------------------------------------------
+    void OverlayContainer::_addToBatch(OverlayBatch* batch)
+    {
+        if (mVisible)
+        {
+            OverlayElement::_addToBatch(batch);
+
+            // Also add children
+            ChildIterator it = getChildIterator();
+            while (it.hasMoreElements())
+                it.getNext()->_addToBatch(batch);
+        }
+    }
+    //---------------------------------------------------------------------
+    void OverlayContainer::_notifyBatchingChanged(void)
+    {
+        OverlayElement::_notifyBatchingChanged();
+
+        ChildIterator it = getChildIterator();
+        while (it.hasMoreElements())
+            it.getNext()->_notifyBatchingChanged();
+    }
 
 
     OverlayElement* OverlayContainer::findElementAt(Real x, Real y)         // relative to parent
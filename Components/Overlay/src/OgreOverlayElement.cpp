@@ -54,6 +54,7 @@ namespace v1 {
     OverlayElementCommands::CmdHorizontalAlign OverlayElement::msHorizontalAlignCmd;
     OverlayElementCommands::CmdVerticalAlign OverlayElement::msVerticalAlignCmd;
     OverlayElementCommands::CmdVisible OverlayElement::msVisibleCmd;
+    uint32 OverlayElement::msNextBatchGeometryVersion = 0;
     //---------------------------------------------------------------------
     OverlayElement::OverlayElement(const String& name)
       : mName(name)
@@ -82,6 +83,7 @@ namespace v1 {
       , mEnabled(true)
       , mInitialised(false)
       , mSourceTemplate(0)
+      , mBatchGeometryVersion(0)
     {
         // default overlays to preserve their own detail level
         mPolygonModeOverrideable = false;
@@ -522,9 +524,14 @@ namespace v1 {
     //---------------------------------------------------------------------
     void OverlayElement::_notifyParent(OverlayContainer* parent, Overlay* overlay)
     {
+        const bool wasBatched = _isBatched();
+
         mParent = parent;
         mOverlay = overlay;
 
+        if (wasBatched != _isBatched())
+            _notifyBatchingChanged();
+
         if (mOverlay && mOverlay->isInitialised() && !mInitialised)
         {
             initialise();
@@ -625,6 +632,31 @@ namespace v1 {
         }
     }
     //-----------------------------------------------------------------------
+    bool OverlayElement::_isBatched(void) const
+    {
+        return mOverlay && mOverlay->isBatched() && _isBatchable();
+    }
+    //-----------------------------------------------------------------------
+    void OverlayElement::_addToBatch(OverlayBatch* batch)
+    {
+        if (mVisible)
+        {
+            if (_isBatchable())
+                batch->addElement(this);
+            else
+                batch->addRenderable(this);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void OverlayElement::_notifyBatchingChanged(void)
+    {
+        // Geometry goes to a different place now
+        mGeomPositionsOutOfDate = true;
+        mGeomUVsOutOfDate = true;
+        mBatchVertices.clear();
+        notifyBatchGeometryChanged();
+    }
+    //-----------------------------------------------------------------------
     void OverlayElement::addBaseParameters(void)    
     {
         ParamDictionary* dict = getParamDictionary();
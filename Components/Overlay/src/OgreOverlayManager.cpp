@@ -99,6 +99,12 @@ namespace v1
             for(ElementMap::iterator i = elementMap.begin(), i_end = elementMap.end(); i != i_end; ++i)
                 i->second->_releaseManualHardwareResources();
         }
+
+        for(OverlayMap::iterator i = mOverlayMap.begin(), i_end = mOverlayMap.end(); i != i_end; ++i)
+        {
+            if(i->second->getBatch())
+                i->second->getBatch()->_releaseManualHardwareResources();
+        }
     }
     //---------------------------------------------------------------------
     void OverlayManager::_restoreManualHardwareResources()
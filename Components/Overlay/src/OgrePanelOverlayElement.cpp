@@ -242,6 +242,22 @@ namespace v1 {
         }
     }
     //---------------------------------------------------------------------
+    void PanelOverlayElement::_addToBatch(OverlayBatch* batch)
+    {
+        if (mVisible)
+        {
+            if (!mTransparent && !mMaterialName.empty())
+            {
+                OverlayElement::_addToBatch(batch);
+            }
+
+            // Also add children
+            ChildIterator it = getChildIterator();
+            while (it.hasMoreElements())
+                it.getNext()->_addToBatch(batch);
+        }
+    }
+    //---------------------------------------------------------------------
     void PanelOverlayElement::updatePositionGeometry(void)
     {
         /*
@@ -265,14 +281,33 @@ namespace v1 {
         top = -((_getDerivedTop() * 2) - 1);
         bottom =  top -  (mHeight * 2);
 
+        // Use the furthest away depth value, since materials should have depth-check off
+        // This initialised the depth buffer for any 3D objects in front
+        Real zValue = Root::getSingleton().getRenderSystem()->getMaximumDepthInputValue();
+
+        if (_isBatched())
+        {
+            // Same quad, as a triangle list: 0 1 2, 2 1 3
+            const Real pos[4][2] = { { left, top }, { left, bottom },
+                                     { right, top }, { right, bottom } };
+            const size_t indices[6] = { 0, 1, 2, 2, 1, 3 };
+
+            mBatchVertices.resize(6);
+            for (size_t i = 0; i < 6; ++i)
+            {
+                mBatchVertices[i].x = static_cast<float>(pos[indices[i]][0]);
+                mBatchVertices[i].y = static_cast<float>(pos[indices[i]][1]);
+                mBatchVertices[i].z = static_cast<float>(zValue);
+            }
+            notifyBatchGeometryChanged();
+            return;
+        }
+
         HardwareVertexBufferSharedPtr vbuf =
             mRenderOp.vertexData->vertexBufferBinding->getBuffer(POSITION_BINDING);
         HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
         float* pPos = static_cast<float*>(vbufLock.pData);
 
-        // Use the furthest away depth value, since materials should have depth-check off
-        // This initialised the depth buffer for any 3D objects in front
-        Real zValue = Root::getSingleton().getRenderSystem()->getMaximumDepthInputValue();
         *pPos++ = left;
         *pPos++ = top;
         *pPos++ = zValue;
@@ -292,6 +327,26 @@ namespace v1 {
     //---------------------------------------------------------------------
     void PanelOverlayElement::updateTextureGeometry(void)
     {
+        if (_isBatched())
+        {
+            // Only the first layer, colour comes from the material
+            const Real upperX = mU2 * mTileX[0];
+            const Real upperY = mV2 * mTileY[0];
+            const Real uv[4][2] = { { mU1, mV1 }, { mU1, upperY },
+                                    { upperX, mV1 }, { upperX, upperY } };
+            const size_t indices[6] = { 0, 1, 2, 2, 1, 3 };
+
+            mBatchVertices.resize(6);
+            for (size_t i = 0; i < 6; ++i)
+            {
+                mBatchVertices[i].u = static_cast<float>(uv[indices[i]][0]);
+                mBatchVertices[i].v = static_cast<float>(uv[indices[i]][1]);
+                mBatchVertices[i].colour = 0xFFFFFFFF;
+            }
+            notifyBatchGeometryChanged();
+            return;
+        }
+
         // Generate for as many texture layers as there are in material
         if (!mMaterialName.empty() && mInitialised)
         {
@@ -183,14 +183,28 @@ namespace v1 {
         }
 
         size_t charlen = mCaption.size();
-        checkMemoryAllocation( charlen );
+
+        const bool batched = _isBatched();
+        // When batched we write to mBatchVertices, and skip the colour after each vertex
+        const size_t vertexPadding = batched ? 1u : 0u;
 
         mRenderOp.vertexData->vertexCount = charlen * 6;
-        // Get position / texcoord buffer
-        const HardwareVertexBufferSharedPtr& vbuf = 
-            mRenderOp.vertexData->vertexBufferBinding->getBuffer(POS_TEX_BINDING);
-        HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
-        pVert = static_cast<float*>(vbufLock.pData);
+        HardwareBufferLockGuard vbufLock;
+        if (batched)
+        {
+            mBatchVertices.resize(charlen * 6);
+            pVert = reinterpret_cast<float*>(mBatchVertices.begin());
+        }
+        else
+        {
+            checkMemoryAllocation( charlen );
+
+            // Get position / texcoord buffer
+            const HardwareVertexBufferSharedPtr& vbuf =
+                mRenderOp.vertexData->vertexBufferBinding->getBuffer(POS_TEX_BINDING);
+            vbufLock.lock(vbuf, HardwareBuffer::HBL_DISCARD);
+            pVert = static_cast<float*>(vbufLock.pData);
+        }
 
         float largestWidth = 0;
         float left = _getDerivedLeft() * 2.0f - 1.0f;
@@ -286,6 +300,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.left;
             *pVert++ = uvRect.top;
+            pVert += vertexPadding;
 
             top -= mCharHeight * 2.0f;
 
@@ -295,6 +310,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.left;
             *pVert++ = uvRect.bottom;
+            pVert += vertexPadding;
 
             top += mCharHeight * 2.0f;
             left += horiz_height * mCharHeight * 2.0f;
@@ -305,6 +321,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.right;
             *pVert++ = uvRect.top;
+            pVert += vertexPadding;
             //-------------------------------------------------------------------------------------
 
             //-------------------------------------------------------------------------------------
@@ -316,6 +333,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.right;
             *pVert++ = uvRect.top;
+            pVert += vertexPadding;
 
             top -= mCharHeight * 2.0f;
             left -= horiz_height  * mCharHeight * 2.0f;
@@ -326,6 +344,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.left;
             *pVert++ = uvRect.bottom;
+            pVert += vertexPadding;
 
             left += horiz_height  * mCharHeight * 2.0f;
 
@@ -335,6 +354,7 @@ namespace v1 {
             *pVert++ = -1.0;
             *pVert++ = uvRect.right;
             *pVert++ = uvRect.bottom;
+            pVert += vertexPadding;
             //-------------------------------------------------------------------------------------
 
             // Go back up with top
@@ -359,6 +379,14 @@ namespace v1 {
 
         if (getWidth() < largestWidth)
             setWidth(largestWidth);
+
+        if (batched)
+        {
+            mBatchVertices.resize(mRenderOp.vertexData->vertexCount);
+            notifyBatchGeometryChanged();
+            // New vertices have no colour yet
+            mColoursChanged = true;
+        }
     }
 
     void TextAreaOverlayElement::updateTextureGeometry()
@@ -554,6 +582,25 @@ namespace v1 {
         Root::getSingleton().convertColourValue(mColourTop, &topColour);
         Root::getSingleton().convertColourValue(mColourBottom, &bottomColour);
 
+        if (_isBatched())
+        {
+            OverlayBatchVertex *pVert = mBatchVertices.begin();
+            const size_t numChars = mBatchVertices.size() / 6u;
+            for (size_t i = 0; i < numChars; ++i)
+            {
+                // First tri (top, bottom, top)
+                pVert++->colour = topColour;
+                pVert++->colour = bottomColour;
+                pVert++->colour = topColour;
+                // Second tri (top, bottom, bottom)
+                pVert++->colour = topColour;
+                pVert++->colour = bottomColour;
+                pVert++->colour = bottomColour;
+            }
+            notifyBatchGeometryChanged();
+            return;
+        }
+
         HardwareVertexBufferSharedPtr vbuf = 
             mRenderOp.vertexData->vertexBufferBinding->getBuffer(COLOUR_BINDING);
 
@@ -654,6 +701,12 @@ namespace v1 {
         }
     }
     //---------------------------------------------------------------------------------------------
+    void TextAreaOverlayElement::_notifyBatchingChanged(void)
+    {
+        OverlayElement::_notifyBatchingChanged();
+        mColoursChanged = true;
+    }
+    //---------------------------------------------------------------------------------------------
     // Char height command object
     //
     String TextAreaOverlayElement::CmdCharHeight::doGet( const void* target ) const
@@ -51,6 +51,13 @@ namespace Ogre
         CompositorWorkspace *workspace;
         TextureGpu          *reflectionTexture;
         bool                isReserved;
+        /// Actor whose reflection was last rendered into reflectionTexture.
+        /// Only used to tell whether the slot's contents can still be reused.
+        PlanarReflectionActor const *lastActor;
+        /// Camera the reflection in reflectionTexture was last rendered for.
+        Camera const        *lastCamera;
+        /// Value of PlanarReflections' frame counter when reflectionTexture was last rendered.
+        uint32              lastUpdateFrame;
     };
 
     typedef FastArray<Renderable*> RenderableArray;
@@ -73,6 +80,12 @@ namespace Ogre
 
         Actors are culled against the camera, thus if they're no longer visible Ogre will
         stop updating those actors, improving performance.
+
+        Further work can be saved with:
+            * setClipOnActorPlane: the reflection cameras skip everything behind the mirror.
+            * setDistantUpdateParams: far away actors are refreshed every N frames.
+            * setShareCoplanarActors: actors lying on the same plane share a single slot
+              (i.e. many windows of the same facade, or tiled water patches).
     */
     class _OgrePlanarReflectionsExport PlanarReflections
     {
@@ -126,6 +139,9 @@ namespace Ogre
         Camera                      *mLastCamera;
         //Camera                      *mLockCamera;
         PlanarReflectionActorVec    mActiveActors;
+        /// Active actors that were coplanar to another active actor and thus
+        /// reuse its slot instead of rendering their own reflection.
+        PlanarReflectionActorVec    mSharingActors;
         ActiveActorDataVec          mActiveActorData;
         TrackedRenderableArray      mTrackedRenderables;
         bool                        mUpdatingRenderablesHlms;
@@ -135,6 +151,11 @@ namespace Ogre
         uint8               mMaxActiveActors;
         Real                mInvMaxDistance;
         Real                mMaxSqDistance;
+        bool                mClipOnActorPlane;
+        bool                mShareCoplanarActors;
+        uint32              mDistantUpdateInterval;
+        Real                mDistantUpdateSqDistance;
+        uint32              mFrameCount;
         SceneManager        *mSceneManager;
         CompositorManager2  *mCompositorManager;
 
@@ -142,6 +163,17 @@ namespace Ogre
 
         void updateFlushedRenderables(void);
 
+        /// Returns the already accepted actor in mActiveActors[0; numAccepted) which
+        /// lies on the same plane as the given one, null if there is none.
+        PlanarReflectionActor* findCoplanarActor( const PlanarReflectionActor *actor,
+                                                  size_t numAccepted ) const;
+
+        /// Returns true if the slot already contains a reflection of this actor
+        /// which is recent enough according to setDistantUpdateParams.
+        bool canSkipSlotUpdate( const ActiveActorData &actorData,
+                                const PlanarReflectionActor *actor,
+                                const Camera *camera ) const;
+
     public:
         /**
         @param sceneManager
@@ -156,6 +188,38 @@ namespace Ogre
 
         void setMaxDistance( Real maxDistance );
 
+        /** When true, the reflection cameras use the actor's plane as an oblique near
+            plane. Geometry behind the mirror is then both culled and clipped, instead of
+            being rendered and hidden by the surface itself.
+        @remarks
+            Default is false, as the oblique projection reduces depth precision.
+        */
+        void setClipOnActorPlane( bool bClip );
+        bool getClipOnActorPlane(void) const                { return mClipOnActorPlane; }
+
+        /** Actors whose plane matches (within a small tolerance) the plane of an actor that
+            was already activated reuse that actor's slot; thus a single reflection
+            is rendered for all of them.
+            Actors that share a slot don't count towards the max number of active actors.
+        @remarks
+            Actors with a reservation (see reserve) always get their own slot.
+            Default is true.
+        */
+        void setShareCoplanarActors( bool bShare );
+        bool getShareCoplanarActors(void) const             { return mShareCoplanarActors; }
+
+        /** Actors farther than 'distance' from the camera only refresh their reflection
+            every 'interval' frames, as long as they keep the same slot.
+            While waiting, the previous (slightly stale) reflection is shown.
+        @param distance
+            Distance from the camera to the actor (see
+            PlanarReflectionActor::getSquaredDistanceTo) after which updates get throttled.
+        @param interval
+            Number of frames (in beginFrame calls) between updates. 0 and 1 disable throttling.
+        */
+        void setDistantUpdateParams( Real distance, uint32 interval );
+        uint32 getDistantUpdateInterval(void) const         { return mDistantUpdateInterval; }
+
         /** Setups how many actors can be active at the same time.
             You may have many actors (i.e. 1000 actors), but for performance and memory
             reasons you may only want 1-5 actors at the same time. Actors are dynamically
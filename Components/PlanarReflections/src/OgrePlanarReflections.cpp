@@ -64,6 +64,11 @@ namespace Ogre
         mMaxActiveActors( 0u ),
         mInvMaxDistance( Real(1.0) / maxDistance ),
         mMaxSqDistance( maxDistance * maxDistance ),
+        mClipOnActorPlane( false ),
+        mShareCoplanarActors( true ),
+        mDistantUpdateInterval( 0u ),
+        mDistantUpdateSqDistance( std::numeric_limits<Real>::max() ),
+        mFrameCount( 0u ),
         mSceneManager( sceneManager ),
         mCompositorManager( compositorManager ),
         mDummyActor()
@@ -103,6 +108,34 @@ namespace Ogre
         mInvMaxDistance = Real(1.0) / maxDistance;
     }
     //-----------------------------------------------------------------------------------
+    void PlanarReflections::setClipOnActorPlane( bool bClip )
+    {
+        mClipOnActorPlane = bClip;
+
+        if( !bClip )
+        {
+            ActiveActorDataVec::const_iterator itor = mActiveActorData.begin();
+            ActiveActorDataVec::const_iterator end  = mActiveActorData.end();
+
+            while( itor != end )
+            {
+                itor->reflectionCamera->disableCustomNearClipPlane();
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void PlanarReflections::setShareCoplanarActors( bool bShare )
+    {
+        mShareCoplanarActors = bShare;
+    }
+    //-----------------------------------------------------------------------------------
+    void PlanarReflections::setDistantUpdateParams( Real distance, uint32 interval )
+    {
+        mDistantUpdateSqDistance = distance * distance;
+        mDistantUpdateInterval = interval;
+    }
+    //-----------------------------------------------------------------------------------
     void PlanarReflections::setMaxActiveActors( uint8 maxActiveActors, IdString workspaceName,
                                                 bool useAccurateLighting, uint32 width, uint32 height,
                                                 bool withMipmaps, PixelFormatGpu pixelFormat,
@@ -210,6 +243,9 @@ namespace Ogre
                                                                         actorData.reflectionCamera,
                                                                         workspaceName, false, 0 );
                 actorData.isReserved = false;
+                actorData.lastActor = 0;
+                actorData.lastCamera = 0;
+                actorData.lastUpdateFrame = 0;
                 mActiveActorData.push_back( actorData );
             }
         }
@@ -279,6 +315,16 @@ namespace Ogre
             mActiveActorData[actor->mCurrentBoundSlot].isReserved = false;
         }
 
+        //A new actor could be allocated at the same address
+        ActiveActorDataVec::iterator itData = mActiveActorData.begin();
+        ActiveActorDataVec::iterator enData = mActiveActorData.end();
+        while( itData != enData )
+        {
+            if( itData->lastActor == actor )
+                itData->lastActor = 0;
+            ++itData;
+        }
+
         delete actor;
 
         efficientVectorRemove( mActors, itor );
@@ -300,6 +346,7 @@ namespace Ogre
         while( itData != enData )
         {
             itData->isReserved = false;
+            itData->lastActor = 0;
             ++itData;
         }
     }
@@ -423,6 +470,38 @@ namespace Ogre
         mLastAspectRatio = 0;
 
         mActiveActors.clear();
+        mSharingActors.clear();
+        ++mFrameCount;
+    }
+    //-----------------------------------------------------------------------------------
+    PlanarReflectionActor* PlanarReflections::findCoplanarActor( const PlanarReflectionActor *actor,
+                                                                 size_t numAccepted ) const
+    {
+        const Real cosThreshold = Real( 0.9999f );
+        const Real distThreshold = Real( 1e-3f );
+
+        for( size_t i=0; i<numAccepted; ++i )
+        {
+            const PlanarReflectionActor *other = mActiveActors[i];
+            if( other->mPlane.normal.dotProduct( actor->mPlane.normal ) >= cosThreshold &&
+                Math::Abs( other->mPlane.d - actor->mPlane.d ) <= distThreshold )
+            {
+                return mActiveActors[i];
+            }
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------------------
+    bool PlanarReflections::canSkipSlotUpdate( const ActiveActorData &actorData,
+                                               const PlanarReflectionActor *actor,
+                                               const Camera *camera ) const
+    {
+        const Vector3 camPos( camera->getDerivedPosition() );
+        return mDistantUpdateInterval > 1u &&
+               actorData.lastActor == actor && actorData.lastCamera == camera &&
+               mFrameCount - actorData.lastUpdateFrame < mDistantUpdateInterval &&
+               actor->getSquaredDistanceTo( camPos ) >= mDistantUpdateSqDistance;
     }
     //-----------------------------------------------------------------------------------
     struct OrderPlanarReflectionActorsByDistanceToPoint
@@ -466,6 +545,7 @@ namespace Ogre
         }
 
         mActiveActors.clear();
+        mSharingActors.clear();
 
         mLastAspectRatio = camera->getAspectRatio();
         mLastCameraPos = camera->getDerivedPosition();
@@ -662,7 +742,8 @@ namespace Ogre
         std::sort( mActiveActors.begin(), mActiveActors.end(),
                    OrderPlanarReflectionActorsByDistanceToPoint( camPos ) );
 
-        mActiveActors.resize( std::min<size_t>( mActiveActors.size(), mMaxActiveActors ) );
+        if( !mShareCoplanarActors )
+            mActiveActors.resize( std::min<size_t>( mActiveActors.size(), mMaxActiveActors ) );
 
         const Quaternion camRot( camera->getDerivedOrientation() );
         Real nearPlane = camera->getNearClipDistance();
@@ -679,7 +760,29 @@ namespace Ogre
             {
                 PlanarReflectionActor *actor = *itor;
                 ActiveActorData *actorData = 0;
-                if( actor->hasReservation() )
+
+                const size_t numAccepted = static_cast<size_t>( itor - mActiveActors.begin() );
+
+                PlanarReflectionActor *coplanarActor = 0;
+                if( mShareCoplanarActors && !actor->hasReservation() )
+                    coplanarActor = findCoplanarActor( actor, numAccepted );
+
+                if( coplanarActor )
+                {
+                    //Reuse the reflection of the actor on the same plane. Move it out of
+                    //mActiveActors, which must only contain actors with a unique slot.
+                    actor->mCurrentBoundSlot = coplanarActor->mCurrentBoundSlot;
+                    mSharingActors.push_back( actor );
+                    itor = mActiveActors.erase( itor );
+                    end  = mActiveActors.end();
+                    continue;
+                }
+
+                //When sharing coplanar actors mActiveActors wasn't trimmed to
+                //mMaxActiveActors, thus the cap is enforced here instead.
+                const bool bCanActivate = numAccepted < mMaxActiveActors;
+
+                if( bCanActivate && actor->hasReservation() )
                 {
                     //Actor is bound to a specifc slot
                     const size_t idx = actor->mCurrentBoundSlot;
@@ -688,7 +791,7 @@ namespace Ogre
                             "Actor says he has a reservation on this slot, but the slot disagrees." );
                     actorData = &mActiveActorData[idx];
                 }
-                else
+                else if( bCanActivate )
                 {
                     while( nextFreeActorData < mActiveActorData.size() &&
                            mActiveActorData[nextFreeActorData].isReserved )
@@ -705,8 +808,16 @@ namespace Ogre
                     }
                 }
 
-                if( actorData )
+                if( actorData && canSkipSlotUpdate( *actorData, actor, camera ) )
                 {
+                    //Keep showing the reflection it already has
+                    ++itor;
+                }
+                else if( actorData )
+                {
+                    actorData->lastActor = actor;
+                    actorData->lastCamera = camera;
+                    actorData->lastUpdateFrame = mFrameCount;
                     actorData->workspace->setEnabled( true );
                     actorData->reflectionCamera->setPosition( camPos );
                     actorData->reflectionCamera->setOrientation( camRot );
@@ -716,6 +827,8 @@ namespace Ogre
                     actorData->reflectionCamera->setFocalLength( focalLength );
                     actorData->reflectionCamera->setFOVy( fov );
                     actorData->reflectionCamera->enableReflection( actor->mPlane );
+                    if( mClipOnActorPlane )
+                        actorData->reflectionCamera->enableCustomNearClipPlane( actor->mPlane );
 
                     if( camera->getFrustumExtentsManuallySet() )
                     {
@@ -763,9 +876,19 @@ namespace Ogre
 
                 PlanarReflectionActorVec::const_iterator itor = mActiveActors.begin();
                 PlanarReflectionActorVec::const_iterator end  = mActiveActors.end();
+                bool checkingSharingActors = false;
 
-                while( itor != end )
+                while( itor != end || (!checkingSharingActors && !mSharingActors.empty()) )
                 {
+                    if( itor == end )
+                    {
+                        //Coplanar actors may be closer to this Renderable than
+                        //the actor that owns the slot.
+                        checkingSharingActors = true;
+                        itor = mSharingActors.begin();
+                        end  = mSharingActors.end();
+                    }
+
                     PlanarReflectionActor *actor = *itor;
                     const Real cosAngle = actor->getNormal().dotProduct( reflNormal );
 
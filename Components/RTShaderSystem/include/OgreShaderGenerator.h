@@ -187,6 +187,8 @@ public:
     /** 
     Set the output shader cache path. Generated shader code will be written to this path.
     In case of empty cache path shaders will be generated directly from system memory.
+    When the path is valid, the compiled program microcodes are also cached there and
+    loaded back on the next run, so unchanged programs skip the compiler.
     @param cachePath The cache path of the shader.  
     The default is empty cache path.
     */
@@ -197,6 +199,13 @@ public:
     */
     const String& getShaderCachePath() const { return mShaderCachePath; }
 
+    /** 
+    Write the microcodes of the programs compiled so far into the shader cache path.
+    Called automatically when the shader generator is destroyed; does nothing if the cache
+    path is empty or no new program was compiled since the cache was loaded.
+    */
+    void saveMicrocodeCache();
+
     /** 
     Flush the shader cache. This operation will cause all active sachems to be invalidated and will
     destroy any CPU/GPU program that created by this shader generator.
@@ -1077,6 +1086,11 @@ protected:
     // A flag to indicate finalizing
     bool mIsFinalizing;
 private:
+    // Load the microcode cache stored in the shader cache path, if any.
+    void loadMicrocodeCache();
+    // Name of the microcode cache file inside the shader cache path.
+    static const char *msMicrocodeCacheFilename;
+
     friend class SGPass;
     friend class FFPRenderStateBuilder;
     friend class SGScriptTranslatorManager;
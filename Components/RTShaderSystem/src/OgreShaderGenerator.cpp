@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include "OgreShaderExTriplanarTexturing.h"
 #include "OgreRoot.h"
 #include "OgreException.h"
+#include "OgreLogManager.h"
 
 #include <fstream>
 
@@ -60,6 +61,7 @@ namespace RTShader {
 
 String ShaderGenerator::DEFAULT_SCHEME_NAME     = "ShaderGeneratorDefaultScheme";
 String GENERATED_SHADERS_GROUP_NAME             = "ShaderGeneratorResourceGroup";
+const char *ShaderGenerator::msMicrocodeCacheFilename = "RTShaderSystem.microcode";
 String ShaderGenerator::SGPass::UserKey         = "SGPass";
 String ShaderGenerator::SGTechnique::UserKey    = "SGTechnique";
 
@@ -248,6 +250,8 @@ void ShaderGenerator::_destroy()
 {
     OGRE_LOCK_AUTO_MUTEX;
     
+    saveMicrocodeCache();
+
     mIsFinalizing = true;
     
     // Delete technique entries.
@@ -1437,10 +1441,58 @@ void ShaderGenerator::setShaderCachePath( const String& cachePath )
             remove(outTestFileName.c_str());
 
             ResourceGroupManager::getSingleton().addResourceLocation(mShaderCachePath, "FileSystem", GENERATED_SHADERS_GROUP_NAME);                 
+
+            loadMicrocodeCache();
         }
     }
 }
 
+//-----------------------------------------------------------------------------
+void ShaderGenerator::loadMicrocodeCache()
+{
+    GpuProgramManager *gpuProgramManager = GpuProgramManager::getSingletonPtr();
+    if( !gpuProgramManager )
+        return;
+
+    gpuProgramManager->setSaveMicrocodesToCache( true );
+
+    // The whole file is read at once; entries whose driver signature don't match
+    // are discarded by the GpuProgramManager.
+    const String fullPath = mShaderCachePath + msMicrocodeCacheFilename;
+    std::ifstream *inFile = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )();
+    inFile->open( fullPath.c_str(), std::ios::in | std::ios::binary );
+    if( !*inFile )
+    {
+        OGRE_DELETE_T( inFile, basic_ifstream, MEMCATEGORY_GENERAL );
+        return;
+    }
+
+    DataStreamPtr stream( OGRE_NEW FileStreamDataStream( msMicrocodeCacheFilename, inFile, true ) );
+    gpuProgramManager->loadMicrocodeCache( stream );
+}
+
+//-----------------------------------------------------------------------------
+void ShaderGenerator::saveMicrocodeCache()
+{
+    GpuProgramManager *gpuProgramManager = GpuProgramManager::getSingletonPtr();
+    if( mShaderCachePath.empty() || !gpuProgramManager || !gpuProgramManager->isCacheDirty() )
+        return;
+
+    const String fullPath = mShaderCachePath + msMicrocodeCacheFilename;
+    std::fstream *outFile = OGRE_NEW_T( std::fstream, MEMCATEGORY_GENERAL )();
+    outFile->open( fullPath.c_str(), std::ios::out | std::ios::binary );
+    if( !*outFile )
+    {
+        OGRE_DELETE_T( outFile, basic_fstream, MEMCATEGORY_GENERAL );
+        LogManager::getSingleton().logMessage( "RTSS: could not write the microcode cache '" +
+                                               fullPath + "'" );
+        return;
+    }
+
+    DataStreamPtr stream( OGRE_NEW FileStreamDataStream( msMicrocodeCacheFilename, outFile, true ) );
+    gpuProgramManager->saveMicrocodeCache( stream );
+}
+
 //-----------------------------------------------------------------------------
 ShaderGenerator::SGMaterialIterator ShaderGenerator::findMaterialEntryIt(const String& materialName, const String& groupName)
 {
@@ -516,7 +516,10 @@ namespace Ogre
 
         tmpIt = movableObjectValue.FindMember( "local_radius" );
         if( tmpIt != movableObjectValue.MemberEnd() && isFloat( tmpIt->value ) )
+        {
             objData.mLocalRadius[objData.mIndex] = decodeFloat( tmpIt->value );
+            objData.invalidateBounds();
+        }
 
         tmpIt = movableObjectValue.FindMember( "rendering_distance" );
         if( tmpIt != movableObjectValue.MemberEnd() && isFloat( tmpIt->value ) )
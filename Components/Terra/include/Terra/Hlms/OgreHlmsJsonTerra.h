@@ -44,7 +44,7 @@ namespace Ogre
     *  @{
     */
 
-    class HlmsJsonTerra
+    class _OgreTerraExport HlmsJsonTerra
     {
         HlmsManager         *mHlmsManager;
         TextureGpuManager   *mTextureManager;
@@ -52,7 +52,7 @@ namespace Ogre
     /** Physically based shading implementation specfically designed for
         OpenGL 3+, D3D11 and other RenderSystems which support uniform buffers.
     */
-    class HlmsTerra : public HlmsPbs
+    class _OgreTerraExport HlmsTerra : public HlmsPbs
     {
         MovableObject const *mLastMovableObject;
         DescriptorSetSampler const *mTerraDescSetSampler;
@@ -33,7 +33,7 @@ THE SOFTWARE.
 #include "OgreConstBufferPool.h"
 #include "OgreVector4.h"
 
-#define _OgreHlmsTextureBaseClassExport
+#define _OgreHlmsTextureBaseClassExport _OgreTerraExport
 #define OGRE_HLMS_TEXTURE_BASE_CLASS HlmsTerraBaseTextureDatablock
 #define OGRE_HLMS_TEXTURE_BASE_MAX_TEX NUM_TERRA_TEXTURE_TYPES
 #define OGRE_HLMS_CREATOR_CLASS HlmsTerra
@@ -166,7 +166,7 @@ namespace Ogre
 
     /** Contains information needed by TERRA (Physically Based Shading) for OpenGL 3+ & D3D11+
     */
-    class HlmsTerraDatablock : public HlmsTerraBaseTextureDatablock
+    class _OgreTerraExport HlmsTerraDatablock : public HlmsTerraBaseTextureDatablock
     {
         friend class HlmsTerra;
 
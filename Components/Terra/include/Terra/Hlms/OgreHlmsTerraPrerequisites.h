@@ -28,6 +28,8 @@ THE SOFTWARE.
 #ifndef _OgreHlmsTerraPrerequisites_H_
 #define _OgreHlmsTerraPrerequisites_H_
 
+#include "Terra/TerraPrerequisites.h"
+
 namespace Ogre
 {
     enum TerraTextureTypes
@@ -29,6 +29,7 @@ THE SOFTWARE.
 #ifndef _OgreHlmsPbsTerraShadows_
 #define _OgreHlmsPbsTerraShadows_
 
+#include "Terra/TerraPrerequisites.h"
 #include "OgreGpuProgram.h"
 #include "OgreHlmsListener.h"
 
@@ -36,7 +37,7 @@ namespace Ogre
 {
     class Terra;
 
-    class HlmsPbsTerraShadows : public HlmsListener
+    class _OgreTerraExport HlmsPbsTerraShadows : public HlmsListener
     {
     protected:
         Terra                   *mTerra;
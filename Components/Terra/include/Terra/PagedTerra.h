@@ -0,0 +1,203 @@
+
+#ifndef _OgrePagedTerra_H_
+#define _OgrePagedTerra_H_
+
+#include "Terra/Terra.h"
+#include "ogrestd/map.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** Splits a terrain too big for a single heightmap into a grid of tiles, each one
+        rendered by its own Terra, which are streamed in & out around the camera.
+    @remarks
+        Tiles are loaded from files named getTileName( x, z ) through TextureGpuManager's
+        streaming thread (they're only brought to system RAM, never to the GPU), thus
+        loading doesn't stall the main thread. Only building a tile's Terra (heightmap
+        and normal map textures, shadow map) happens on the main thread;
+        see setMaxTileBuildsPerUpdate.
+    @par
+        Like a clipmap, tiles get coarser the farther they are from the camera: a tile
+        that is N tiles away (in Chebyshev distance) uses 1 / 2^floor( log2( N + 1 ) ) of
+        its heightmap's resolution, up to setMaxLodLevel. Terra still performs its own
+        per cell LOD within each tile.
+    @par
+        Every tile must have the same resolution and pixel format. For tiles to connect
+        seamlessly, the last row & column of a tile must be the same as the first row &
+        column of its neighbours. A resolution of 2^n + 1 allows halving it without
+        moving the shared edges.
+    @par
+        Each tile receives shadows from its own heightmap; use getTerraAt to decide which
+        Terra HlmsPbsTerraShadows should use (e.g. the one under the camera).
+    */
+    class _OgreTerraExport PagedTerra
+    {
+    protected:
+        enum TileState
+        {
+            /// Heightmap is being loaded by TextureGpuManager
+            TileStreaming,
+            /// Heightmap is in system RAM. Terra may or may not be built yet.
+            TileLoaded,
+            /// Heightmap couldn't be loaded or isn't a heightmap. Nothing is displayed.
+            TileInvalid
+        };
+
+        struct Tile
+        {
+            GridPoint   gridPos;
+            TileState   state;
+            TextureGpu  *streamingTex;
+            /// Full resolution heightmap, kept until the tile is unloaded
+            /// so that LOD changes don't have to go to disk.
+            Image2      *heightmap;
+            Terra       *terra;
+            /// LOD level terra was built with
+            uint32      lodLevel;
+            /// Chebyshev distance to the camera's tile, updated in update()
+            uint32      distance;
+        };
+
+        /// Our page table. Key is the result of getTileKey.
+        typedef map<uint64, Tile>::type TileMap;
+
+        TileMap             m_tiles;
+
+        SceneManager        *m_sceneManager;
+        CompositorManager2  *m_compositorManager;
+        Camera              *m_camera;
+        SceneNode           *m_sceneNode;
+        uint8               m_renderQueueId;
+
+        String              m_tileNamePrefix;
+        String              m_tileNameExtension;
+        String              m_resourceGroup;
+
+        /// Min corner of the whole terrain. y is the height of a heightmap value of 0.
+        Vector3             m_origin;
+        /// xz size of a single tile. y is the height of a heightmap value of 1.
+        Vector3             m_tileDimensions;
+        uint32              m_numTilesX;
+        uint32              m_numTilesZ;
+
+        uint32              m_loadRadius;
+        uint32              m_unloadRadius;
+        uint32              m_maxLodLevel;
+        uint32              m_maxTileBuildsPerUpdate;
+
+        HlmsDatablock       *m_datablock;
+        bool                m_castShadows;
+
+        /// Lives here to reuse memory. Tiles waiting for their Terra to be (re)built.
+        std::vector<Tile*>  m_pendingBuilds;
+
+        static uint64 getTileKey( int32 x, int32 z );
+
+        GridPoint worldToTile( const Vector3 &vPos ) const;
+
+        void requestTile( int32 x, int32 z );
+        void unloadTile( Tile &tile );
+
+        /// Moves the heightmap from streamingTex to tile.heightmap once it's loaded.
+        void retrieveHeightmap( Tile &tile );
+
+        /// Returns the LOD level a tile at the given distance should use, clamped to
+        /// what the heightmap's resolution allows.
+        uint32 calculateLodLevel( const Tile &tile ) const;
+
+        void buildTerra( Tile &tile, uint32 lodLevel );
+
+        /// Keeps every 2^lodLevel-th texel of src (including the last row & column),
+        /// so that edges shared with neighbouring tiles don't move.
+        static void decimateHeightmap( const Image2 &src, uint32 lodLevel, Image2 &outDst );
+
+    public:
+        /**
+        @param sceneManager
+        @param parentNode
+            Node the tiles' Terra will be attached to (through a child node we create).
+        @param renderQueueId
+            Render queue of each Terra.
+        @param compositorManager
+        @param camera
+            Camera used to decide which tiles are loaded and for Terra's culling & LOD.
+        @param tileNamePrefix
+        @param tileNameExtension
+            See getTileName.
+        @param resourceGroup
+            Resource group where the tiles will be looked for.
+        */
+        PagedTerra( SceneManager *sceneManager, SceneNode *parentNode, uint8 renderQueueId,
+                    CompositorManager2 *compositorManager, Camera *camera,
+                    const String &tileNamePrefix, const String &tileNameExtension,
+                    const String &resourceGroup );
+        virtual ~PagedTerra();
+
+        /** Sets how the tiles are laid out. Unloads all tiles.
+        @param origin
+            Min corner of tile (0, 0). y is the height of a heightmap value of 0.
+        @param tileDimensions
+            xz size of each tile. y is the height of a heightmap value of 1.
+        @param numTilesX
+        @param numTilesZ
+            Number of tiles in each direction. Tiles outside [0; numTiles) don't exist.
+        */
+        void setLayout( const Vector3 &origin, const Vector3 &tileDimensions,
+                        uint32 numTilesX, uint32 numTilesZ );
+
+        /** Tiles within loadRadius tiles of the camera's tile are loaded. Tiles farther
+            than unloadRadius are unloaded. Must be unloadRadius >= loadRadius; a bigger
+            unloadRadius avoids loading & unloading the same tiles over and over when the
+            camera moves along a tile's edge.
+        */
+        void setRadius( uint32 loadRadius, uint32 unloadRadius );
+        uint32 getLoadRadius(void) const                        { return m_loadRadius; }
+        uint32 getUnloadRadius(void) const                      { return m_unloadRadius; }
+
+        /// Coarsest LOD level. Tiles at LOD n use 1 / 2^n of the heightmap's resolution.
+        void setMaxLodLevel( uint32 maxLodLevel )               { m_maxLodLevel = maxLodLevel; }
+        uint32 getMaxLodLevel(void) const                       { return m_maxLodLevel; }
+
+        /// Max number of Terra (re)built per call to update. Building a Terra renders its
+        /// normal map & shadow map, so building many in the same frame causes stutter.
+        void setMaxTileBuildsPerUpdate( uint32 maxBuilds );
+        uint32 getMaxTileBuildsPerUpdate(void) const            { return m_maxTileBuildsPerUpdate; }
+
+        /// Sets the datablock of every tile, including those that are loaded later.
+        void setDatablock( HlmsDatablock *datablock );
+
+        /// Default is false, same as the tutorial does with a single Terra.
+        void setCastShadows( bool castShadows );
+
+        /** Must be called every frame. Streams tiles in & out around the camera,
+            (re)builds the tiles whose LOD changed, and calls Terra::update on every tile.
+        @param lightDir
+        @param lightEpsilon
+            See Terra::update.
+        */
+        void update( const Vector3 &lightDir, float lightEpsilon = 1e-6f );
+
+        /// Unloads every tile. They'll be loaded again on the next update.
+        void unloadAllTiles(void);
+
+        /// See Terra::getHeightAt. Returns false if the tile at that location isn't built.
+        bool getHeightAt( Vector3 &vPos ) const;
+
+        /// Returns the Terra at the given location. Null if not built (yet).
+        Terra* getTerraAt( const Vector3 &vPos ) const;
+
+        /// Name of the heightmap file of tile (x, z).
+        /// Default is tileNamePrefix_x_z.tileNameExtension, e.g. "Heightmap_3_12.png"
+        virtual String getTileName( int32 x, int32 z ) const;
+
+        size_t getNumTiles(void) const                          { return m_tiles.size(); }
+
+        Camera* getCamera(void) const                           { return m_camera; }
+        void setCamera( Camera *camera );
+    };
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -2,7 +2,7 @@
 #ifndef _OgreTerra_H_
 #define _OgreTerra_H_
 
-#include "OgrePrerequisites.h"
+#include "Terra/TerraPrerequisites.h"
 #include "OgreMovableObject.h"
 #include "OgreShaderParams.h"
 
@@ -22,9 +22,19 @@ namespace Ogre
         int z;
     };
 
+    /// One level of Terra's min/max height pyramid. See Terra::rayIntersects
+    struct TerraMinMaxLevel
+    {
+        uint32 width;
+        uint32 depth;
+        /// Interleaved min & max heights (relative to the terrain's origin) of each quad
+        /// in level 0, and of each 2x2 block of the level below in the rest.
+        std::vector<float> minMax;
+    };
+
     class ShadowMapper;
 
-    class Terra : public MovableObject
+    class _OgreTerraExport Terra : public MovableObject
     {
         friend class TerrainCell;
 
@@ -43,6 +53,8 @@ namespace Ogre
         Vector3     m_terrainOrigin;
         uint32      m_basePixelDimension;
 
+        std::vector<TerraMinMaxLevel>   m_heightPyramid;
+
         std::vector<TerrainCell>   m_terrainCells;
         std::vector<TerrainCell*>  m_collectedCells[2];
         size_t                     m_currentCell;
@@ -53,11 +65,19 @@ namespace Ogre
 
         Vector3             m_prevLightDir;
         ShadowMapper        *m_shadowMapper;
+        uint32              m_shadowIncrementalFrames;
+        float               m_shadowSmallChangeEpsilon;
 
         //Ogre stuff
         CompositorManager2      *m_compositorManager;
         Camera                  *m_camera;
 
+        /// Camera state the current cell selection was made for. If nothing changed,
+        /// update reuses the selection instead of recomputing the LOD rings.
+        Camera const            *m_prevCamera;
+        Matrix4                 m_prevViewMatrix;
+        Matrix4                 m_prevProjMatrix;
+
         void createDescriptorSet(void);
         void destroyDescriptorSet(void);
         void destroyHeightmapTexture(void);
@@ -72,6 +92,14 @@ namespace Ogre
         void createNormalTexture(void);
         void destroyNormalTexture(void);
 
+        /// Recalculates the min/max heights of the quads touching the given region of
+        /// m_heightMap (in texels). Builds the whole pyramid if it's empty.
+        void updateHeightPyramid( uint32 x, uint32 z, uint32 width, uint32 depth );
+
+        /// Tests up to ARRAY_PACKED_REALS rays at once. See rayIntersects
+        void rayIntersectsPacket( const Ray *rays, const Real *maxDistances, size_t numRays,
+                                  std::pair<bool, Real> *outResults ) const;
+
         ///	Automatically calculates the optimum skirt size (no gaps with
         /// lowest overdraw possible).
         ///	This is done by taking the heighest delta between two adjacent
@@ -110,6 +138,13 @@ namespace Ogre
             Use an epsilon of <= 0 to force recalculation every frame. This is
             useful to prevent heterogeneity between frames (reduce stutter) if
             you intend to update the light slightly every frame.
+        @par
+            The visible cells are only recomputed when the camera's view or projection
+            matrices changed. All cells share the same (bufferless) Vao, so the
+            RenderQueue already batches them into a single multi-draw-indirect call.
+        @par
+            With incremental shadow map updates (see setShadowMapIncrementalUpdates)
+            light changes are ignored until the update in progress finishes.
         */
         void update( const Vector3 &lightDir, float lightEpsilon=1e-6f );
 
@@ -127,6 +162,36 @@ namespace Ogre
         */
         bool getHeightAt( Vector3 &vPos ) const;
 
+        /** Tests a ray against the heightmap's CPU copy, at full resolution.
+        @remarks
+            The ray walks a min/max height quadtree, thus long rays only visit the
+            quads whose height range they actually cross.
+        @param ray
+        @param maxDistance
+            Hits further than this are ignored, in units of the ray's direction length.
+            Useful for line of sight tests.
+        @return
+            Whether there was a hit and if so, the distance to the closest one
+            (i.e. the hit is at ray.getPoint( distance )).
+        */
+        std::pair<bool, Real> rayIntersects(
+                const Ray &ray, Real maxDistance=std::numeric_limits<Real>::max() ) const;
+
+        /** Batched version of rayIntersects. Rays are tested ARRAY_PACKED_REALS at a time
+            using SIMD, sharing the traversal, so for best performance sort the rays so that
+            consecutive ones are close to each other (e.g. all line of sight tests from the
+            same agent).
+        @param rays
+            Array with numRays rays.
+        @param maxDistances
+            Array with numRays distances, see rayIntersects. Can be null, meaning no limit.
+        @param numRays
+        @param outResults [out]
+            Array with numRays results, see rayIntersects.
+        */
+        void rayIntersects( const Ray *rays, const Real *maxDistances, size_t numRays,
+                            std::pair<bool, Real> *outResults ) const;
+
         /// load must already have been called.
         void setDatablock( HlmsDatablock *datablock );
 
@@ -138,6 +203,9 @@ namespace Ogre
 
         const ShadowMapper* getShadowMapper(void) const { return m_shadowMapper; }
 
+        /// See ShadowMapper::setIncrementalUpdates. Can be called before load.
+        void setShadowMapIncrementalUpdates( uint32 numFrames, float smallChangeEpsilon=0.0f );
+
         const Ogre::DescriptorSetTexture* getDescriptorSetTexture(void) const { return m_descriptorSet; }
 
         Ogre::TextureGpu* getHeightMapTex(void) const   { return m_heightMapTex; }
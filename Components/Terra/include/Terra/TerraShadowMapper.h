@@ -2,7 +2,7 @@
 #ifndef _OgreTerraShadowMapper_H_
 #define _OgreTerraShadowMapper_H_
 
-#include "OgrePrerequisites.h"
+#include "Terra/TerraPrerequisites.h"
 #include "OgreMovableObject.h"
 #include "OgreShaderParams.h"
 
@@ -12,7 +12,7 @@ namespace Ogre
 {
     typedef TextureGpu* CompositorChannel;
 
-    class ShadowMapper
+    class _OgreTerraExport ShadowMapper
     {
         Ogre::TextureGpu    *m_heightMapTex;
 
@@ -25,6 +25,26 @@ namespace Ogre
         ShaderParams::Param *m_jobParamXYStep;
         ShaderParams::Param *m_jobParamIsStep;
         ShaderParams::Param *m_jobParamHeightDelta;
+        ShaderParams::Param *m_jobParamGroupOffset;
+
+        //Values of the job's params. We need to keep them because the job is shared
+        //with other Terra instances and an incremental update spans multiple frames.
+        Vector2             m_delta;
+        int32               m_xyStep[2];
+        int32               m_isSteep;
+        float               m_heightDelta;
+
+        //Incremental updates
+        uint32              m_incrementalFrames;
+        float               m_smallChangeEpsilon;
+        TextureGpu          *m_shadowMapTexBack;
+        CompositorWorkspace *m_bandWorkspace;
+        CompositorWorkspace *m_blurWorkspace;
+        CompositorWorkspace *m_copyWorkspace;
+        uint32              m_totalThreadGroups;
+        uint32              m_nextThreadGroup;
+        bool                m_skipBlur;
+        Vector3             m_lastBlurredLightDir;
 
         //Ogre stuff
         SceneManager            *m_sceneManager;
@@ -67,6 +87,14 @@ namespace Ogre
         static void setGaussianFilterParams( HlmsComputeJob *job, uint8 kernelRadius,
                                              float gaussianDeviationFactor=0.5f );
 
+        void createIncrementalResources(void);
+        void destroyIncrementalResources(void);
+
+        /// Sets the job's params & buffers and dispatches numThreadGroups
+        /// threadgroups starting from groupOffset, using the given workspace.
+        void dispatchShadowJob( CompositorWorkspace *workspace,
+                                uint32 groupOffset, uint32 numThreadGroups );
+
     public:
         ShadowMapper( SceneManager *sceneManager, CompositorManager2 *compositorManager );
         ~ShadowMapper();
@@ -81,8 +109,39 @@ namespace Ogre
 
         void createShadowMap( IdType id, TextureGpu *heightMapTex );
         void destroyShadowMap(void);
+        /** Recomputes the shadow map.
+            When incremental updates are enabled (see setIncrementalUpdates) this only
+            computes the first band; call continueShadowMapUpdate every frame while
+            isUpdatePending returns true.
+        */
         void updateShadowMap( const Vector3 &lightDir, const Vector2 &xzDimensions, float heightScale );
 
+        /** Spreads the shadow map computation across multiple frames, to avoid the
+            frame spike of recomputing the whole map (plus the gaussian blur) at once.
+        @remarks
+            The rows are split in numFrames bands, computed one band per frame into a
+            back buffer. Once the last band is done, the back buffer is blurred into
+            the shadow map being displayed, thus the previous results stay visible
+            (and consistent) until the new ones are complete.
+        @par
+            Needs an extra texture as big as the shadow map.
+        @param numFrames
+            Number of frames a full update takes. Use 1 to disable incremental updates,
+            in which case the whole map is recomputed immediately inside updateShadowMap.
+        @param smallChangeEpsilon
+            When the light changed less than this since the last blurred update (same
+            units as Terra::update's lightEpsilon), the gaussian blur is skipped and the
+            results are copied as is. The shadows will be sharper until the next big
+            change. Use 0 to always blur.
+        */
+        void setIncrementalUpdates( uint32 numFrames, float smallChangeEpsilon=0.0f );
+        uint32 getIncrementalFrames(void) const                 { return m_incrementalFrames; }
+        float getSmallChangeEpsilon(void) const                 { return m_smallChangeEpsilon; }
+
+        /// Computes the next band of an incremental update started by updateShadowMap.
+        void continueShadowMapUpdate(void);
+        bool isUpdatePending(void) const    { return m_nextThreadGroup < m_totalThreadGroups; }
+
         void fillUavDataForCompositorChannel( TextureGpu **outChannel,
                                               ResourceLayoutMap &outInitialLayouts,
                                               ResourceAccessMap &outInitialUavAccess ) const;
@@ -2,7 +2,7 @@
 #ifndef _OgreTerrainCell_H_
 #define _OgreTerrainCell_H_
 
-#include "OgrePrerequisites.h"
+#include "Terra/TerraPrerequisites.h"
 #include "OgreRenderable.h"
 
 namespace Ogre
@@ -10,7 +10,7 @@ namespace Ogre
     class Terra;
     struct GridPoint;
 
-    class TerrainCell : public Renderable
+    class _OgreTerraExport TerrainCell : public Renderable
     {
         int32  m_gridX;
         int32  m_gridZ;
@@ -36,7 +36,7 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreShaderPrimitives.h"
 
-#define _OgreHlmsTextureBaseClassExport
+#define _OgreHlmsTextureBaseClassExport _OgreTerraExport
 #define OGRE_HLMS_TEXTURE_BASE_CLASS HlmsTerraBaseTextureDatablock
 #define OGRE_HLMS_TEXTURE_BASE_MAX_TEX NUM_TERRA_TEXTURE_TYPES
 #define OGRE_HLMS_CREATOR_CLASS HlmsTerra
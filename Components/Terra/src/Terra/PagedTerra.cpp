@@ -0,0 +1,424 @@
+
+#include "Terra/PagedTerra.h"
+
+#include "OgreImage2.h"
+#include "OgreTextureBox.h"
+
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreTextureGpuManager.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreRenderSystem.h"
+#include "OgreStringConverter.h"
+#include "OgreLogManager.h"
+#include "OgreGpuMemoryTracker.h"
+
+namespace Ogre
+{
+    PagedTerra::PagedTerra( SceneManager *sceneManager, SceneNode *parentNode, uint8 renderQueueId,
+                            CompositorManager2 *compositorManager, Camera *camera,
+                            const String &tileNamePrefix, const String &tileNameExtension,
+                            const String &resourceGroup ) :
+        m_sceneManager( sceneManager ),
+        m_compositorManager( compositorManager ),
+        m_camera( camera ),
+        m_sceneNode( 0 ),
+        m_renderQueueId( renderQueueId ),
+        m_tileNamePrefix( tileNamePrefix ),
+        m_tileNameExtension( tileNameExtension ),
+        m_resourceGroup( resourceGroup ),
+        m_origin( Vector3::ZERO ),
+        m_tileDimensions( Vector3::UNIT_SCALE ),
+        m_numTilesX( 0u ),
+        m_numTilesZ( 0u ),
+        m_loadRadius( 2u ),
+        m_unloadRadius( 3u ),
+        m_maxLodLevel( 3u ),
+        m_maxTileBuildsPerUpdate( 1u ),
+        m_datablock( 0 ),
+        m_castShadows( false )
+    {
+        m_sceneNode = parentNode->createChildSceneNode( parentNode->isStatic() ? SCENE_STATIC :
+                                                                                 SCENE_DYNAMIC );
+    }
+    //-----------------------------------------------------------------------------------
+    PagedTerra::~PagedTerra()
+    {
+        unloadAllTiles();
+
+        if( m_sceneNode )
+        {
+            m_sceneNode->getParentSceneNode()->removeAndDestroyChild( m_sceneNode );
+            m_sceneNode = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 PagedTerra::getTileKey( int32 x, int32 z )
+    {
+        return (static_cast<uint64>( static_cast<uint32>( x ) ) << 32u) |
+                static_cast<uint64>( static_cast<uint32>( z ) );
+    }
+    //-----------------------------------------------------------------------------------
+    GridPoint PagedTerra::worldToTile( const Vector3 &vPos ) const
+    {
+        GridPoint retVal;
+        retVal.x = static_cast<int32>( floorf( (vPos.x - m_origin.x) / m_tileDimensions.x ) );
+        retVal.z = static_cast<int32>( floorf( (vPos.z - m_origin.z) / m_tileDimensions.z ) );
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    String PagedTerra::getTileName( int32 x, int32 z ) const
+    {
+        return m_tileNamePrefix + "_" + StringConverter::toString( x ) + "_" +
+               StringConverter::toString( z ) + "." + m_tileNameExtension;
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::requestTile( int32 x, int32 z )
+    {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Terrain );
+        Tile tile;
+        tile.gridPos.x      = x;
+        tile.gridPos.z      = z;
+        tile.state          = TileStreaming;
+        tile.heightmap      = 0;
+        tile.terra          = 0;
+        tile.lodLevel       = 0u;
+        tile.distance       = 0u;
+
+        //We only want the data in system RAM (Terra creates its own textures).
+        //No AutomaticBatching: heightmaps must not end up in a pool.
+        TextureGpuManager *textureManager =
+                m_sceneManager->getDestinationRenderSystem()->getTextureGpuManager();
+        tile.streamingTex = textureManager->createTexture( getTileName( x, z ),
+                                                           GpuPageOutStrategy::SaveToSystemRam,
+                                                           0, TextureTypes::Type2D,
+                                                           m_resourceGroup );
+        tile.streamingTex->scheduleTransitionTo( GpuResidency::OnSystemRam );
+
+        m_tiles[getTileKey( x, z )] = tile;
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::unloadTile( Tile &tile )
+    {
+        if( tile.streamingTex )
+        {
+            TextureGpuManager *textureManager =
+                    m_sceneManager->getDestinationRenderSystem()->getTextureGpuManager();
+            textureManager->destroyTexture( tile.streamingTex );
+            tile.streamingTex = 0;
+        }
+
+        delete tile.terra;
+        tile.terra = 0;
+
+        OGRE_DELETE tile.heightmap;
+        tile.heightmap = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::unloadAllTiles(void)
+    {
+        TileMap::iterator itor = m_tiles.begin();
+        TileMap::iterator end  = m_tiles.end();
+
+        while( itor != end )
+        {
+            unloadTile( itor->second );
+            ++itor;
+        }
+
+        m_tiles.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::retrieveHeightmap( Tile &tile )
+    {
+        TextureGpu *texture = tile.streamingTex;
+
+        if( texture->getResidencyStatus() != GpuResidency::OnSystemRam ||
+            texture->getPendingResidencyChanges() != 0u )
+        {
+            return;
+        }
+
+        const PixelFormatGpu pixelFormat = texture->getPixelFormat();
+        if( (pixelFormat != PFG_R8_UNORM && pixelFormat != PFG_R16_UNORM &&
+             pixelFormat != PFG_R32_FLOAT) || !texture->_getSysRamCopy( 0 ) )
+        {
+            //Could be a missing file (i.e. sparse datasets). Not worth aborting for.
+            LogManager::getSingleton().logMessage(
+                        "PagedTerra: tile " + texture->getNameStr() + " could not be loaded or "
+                        "is not greyscale 8 bpp, 16 bpp, or 32-bit Float. It will be empty.",
+                        LML_CRITICAL );
+            tile.state = TileInvalid;
+        }
+        else
+        {
+            //Copy mip 0. We can't keep pointing to the texture's system RAM copy
+            //since we're about to destroy it
+            tile.heightmap = OGRE_NEW Image2();
+            tile.heightmap->createEmptyImage( texture->getWidth(), texture->getHeight(), 1u,
+                                              TextureTypes::Type2D, pixelFormat, 1u );
+            TextureBox dstBox = tile.heightmap->getData( 0 );
+            dstBox.copyFrom( texture->_getSysRamCopyAsBox( 0 ) );
+            tile.state = TileLoaded;
+        }
+
+        TextureGpuManager *textureManager =
+                m_sceneManager->getDestinationRenderSystem()->getTextureGpuManager();
+        textureManager->destroyTexture( texture );
+        tile.streamingTex = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 PagedTerra::calculateLodLevel( const Tile &tile ) const
+    {
+        uint32 lodLevel = 0u;
+        while( (2u << lodLevel) <= tile.distance + 1u && lodLevel < m_maxLodLevel )
+            ++lodLevel;
+
+        //Don't decimate below Terra's cell size (64x64), and keep the edges in place
+        const uint32 width = tile.heightmap->getWidth();
+        const uint32 height = tile.heightmap->getHeight();
+        while( lodLevel > 0u &&
+               ( ((width - 1u) >> lodLevel) < 64u || ((height - 1u) >> lodLevel) < 64u ||
+                 ((width - 1u) & ((1u << lodLevel) - 1u)) != 0u ||
+                 ((height - 1u) & ((1u << lodLevel) - 1u)) != 0u ) )
+        {
+            --lodLevel;
+        }
+
+        return lodLevel;
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::decimateHeightmap( const Image2 &src, uint32 lodLevel, Image2 &outDst )
+    {
+        const uint32 step = 1u << lodLevel;
+        const uint32 dstWidth = (src.getWidth() - 1u) / step + 1u;
+        const uint32 dstHeight = (src.getHeight() - 1u) / step + 1u;
+
+        outDst.createEmptyImage( dstWidth, dstHeight, 1u, TextureTypes::Type2D,
+                                 src.getPixelFormat(), 1u );
+
+        const size_t bytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel( src.getPixelFormat() );
+
+        const TextureBox srcBox = src.getData( 0 );
+        TextureBox dstBox = outDst.getData( 0 );
+
+        for( uint32 y=0; y<dstHeight; ++y )
+        {
+            const uint8 *srcRow = reinterpret_cast<const uint8*>( srcBox.at( 0, y * step, 0 ) );
+            uint8 *dstRow = reinterpret_cast<uint8*>( dstBox.at( 0, y, 0 ) );
+            for( uint32 x=0; x<dstWidth; ++x )
+            {
+                memcpy( dstRow + x * bytesPerPixel, srcRow + x * step * bytesPerPixel,
+                        bytesPerPixel );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::buildTerra( Tile &tile, uint32 lodLevel )
+    {
+        //Build a new Terra rather than reloading the existing one, so the old LOD keeps
+        //being displayed until the new one is ready (and so texture names are never reused)
+        Terra *terra = new Terra( Id::generateNewId<MovableObject>(),
+                                  &m_sceneManager->_getEntityMemoryManager(
+                                      m_sceneNode->isStatic() ? SCENE_STATIC : SCENE_DYNAMIC ),
+                                  m_sceneManager, m_renderQueueId, m_compositorManager, m_camera );
+        terra->setCastShadows( m_castShadows );
+
+        const Vector3 center = m_origin +
+                               Vector3( (static_cast<Real>( tile.gridPos.x ) + 0.5f) *
+                                        m_tileDimensions.x,
+                                        m_tileDimensions.y * 0.5f,
+                                        (static_cast<Real>( tile.gridPos.z ) + 0.5f) *
+                                        m_tileDimensions.z );
+
+        const String tileName = getTileName( tile.gridPos.x, tile.gridPos.z );
+        if( lodLevel == 0u )
+            terra->load( *tile.heightmap, center, m_tileDimensions, tileName );
+        else
+        {
+            Image2 decimated;
+            decimateHeightmap( *tile.heightmap, lodLevel, decimated );
+            terra->load( decimated, center, m_tileDimensions, tileName );
+        }
+
+        m_sceneNode->attachObject( terra );
+        if( m_datablock )
+            terra->setDatablock( m_datablock );
+
+        delete tile.terra;
+        tile.terra = terra;
+        tile.lodLevel = lodLevel;
+    }
+    //-----------------------------------------------------------------------------------
+    struct OrderTileByDistance
+    {
+        template <typename T>
+        bool operator () ( const T *left, const T *right ) const
+        {
+            return left->distance < right->distance;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::update( const Vector3 &lightDir, float lightEpsilon )
+    {
+        if( !m_numTilesX || !m_numTilesZ )
+            return;
+
+        const GridPoint camTile = worldToTile( m_camera->getDerivedPosition() );
+
+        //Request the missing tiles around the camera
+        const int32 loadRadius = static_cast<int32>( m_loadRadius );
+        const int32 minX = std::max( camTile.x - loadRadius, 0 );
+        const int32 minZ = std::max( camTile.z - loadRadius, 0 );
+        const int32 maxX = std::min( camTile.x + loadRadius,
+                                     static_cast<int32>( m_numTilesX ) - 1 );
+        const int32 maxZ = std::min( camTile.z + loadRadius,
+                                     static_cast<int32>( m_numTilesZ ) - 1 );
+
+        for( int32 z=minZ; z<=maxZ; ++z )
+        {
+            for( int32 x=minX; x<=maxX; ++x )
+            {
+                if( m_tiles.find( getTileKey( x, z ) ) == m_tiles.end() )
+                    requestTile( x, z );
+            }
+        }
+
+        m_pendingBuilds.clear();
+
+        TileMap::iterator itor = m_tiles.begin();
+        TileMap::iterator end  = m_tiles.end();
+
+        while( itor != end )
+        {
+            Tile &tile = itor->second;
+            const int32 distX = std::abs( tile.gridPos.x - camTile.x );
+            const int32 distZ = std::abs( tile.gridPos.z - camTile.z );
+            tile.distance = static_cast<uint32>( std::max( distX, distZ ) );
+
+            if( tile.distance > m_unloadRadius )
+            {
+                unloadTile( tile );
+                TileMap::iterator toErase = itor++;
+                m_tiles.erase( toErase );
+                continue;
+            }
+
+            if( tile.state == TileStreaming )
+                retrieveHeightmap( tile );
+
+            if( tile.state == TileLoaded &&
+                (!tile.terra || tile.lodLevel != calculateLodLevel( tile )) )
+            {
+                m_pendingBuilds.push_back( &tile );
+            }
+
+            ++itor;
+        }
+
+        //Closest tiles first
+        std::sort( m_pendingBuilds.begin(), m_pendingBuilds.end(), OrderTileByDistance() );
+
+        const size_t numBuilds = std::min<size_t>( m_pendingBuilds.size(),
+                                                   m_maxTileBuildsPerUpdate );
+        for( size_t i=0; i<numBuilds; ++i )
+            buildTerra( *m_pendingBuilds[i], calculateLodLevel( *m_pendingBuilds[i] ) );
+
+        itor = m_tiles.begin();
+        end  = m_tiles.end();
+
+        while( itor != end )
+        {
+            if( itor->second.terra )
+                itor->second.terra->update( lightDir, lightEpsilon );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::setLayout( const Vector3 &origin, const Vector3 &tileDimensions,
+                                uint32 numTilesX, uint32 numTilesZ )
+    {
+        unloadAllTiles();
+        m_origin = origin;
+        m_tileDimensions = tileDimensions;
+        m_numTilesX = numTilesX;
+        m_numTilesZ = numTilesZ;
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::setRadius( uint32 loadRadius, uint32 unloadRadius )
+    {
+        if( unloadRadius < loadRadius )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "unloadRadius must be >= loadRadius",
+                         "PagedTerra::setRadius" );
+        }
+
+        m_loadRadius = loadRadius;
+        m_unloadRadius = unloadRadius;
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::setMaxTileBuildsPerUpdate( uint32 maxBuilds )
+    {
+        m_maxTileBuildsPerUpdate = std::max( maxBuilds, 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::setDatablock( HlmsDatablock *datablock )
+    {
+        m_datablock = datablock;
+
+        TileMap::const_iterator itor = m_tiles.begin();
+        TileMap::const_iterator end  = m_tiles.end();
+
+        while( itor != end )
+        {
+            if( itor->second.terra )
+                itor->second.terra->setDatablock( datablock );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::setCastShadows( bool castShadows )
+    {
+        m_castShadows = castShadows;
+
+        TileMap::const_iterator itor = m_tiles.begin();
+        TileMap::const_iterator end  = m_tiles.end();
+
+        while( itor != end )
+        {
+            if( itor->second.terra )
+                itor->second.terra->setCastShadows( castShadows );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void PagedTerra::setCamera( Camera *camera )
+    {
+        m_camera = camera;
+
+        TileMap::const_iterator itor = m_tiles.begin();
+        TileMap::const_iterator end  = m_tiles.end();
+
+        while( itor != end )
+        {
+            if( itor->second.terra )
+                itor->second.terra->setCamera( camera );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Terra* PagedTerra::getTerraAt( const Vector3 &vPos ) const
+    {
+        const GridPoint tilePos = worldToTile( vPos );
+        TileMap::const_iterator itor = m_tiles.find( getTileKey( tilePos.x, tilePos.z ) );
+        return itor != m_tiles.end() ? itor->second.terra : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    bool PagedTerra::getHeightAt( Vector3 &vPos ) const
+    {
+        const Terra *terra = getTerraAt( vPos );
+        return terra && terra->getHeightAt( vPos );
+    }
+}
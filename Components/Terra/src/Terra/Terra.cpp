@@ -17,6 +17,11 @@
 #include "OgreDescriptorSetTexture.h"
 #include "OgreHlmsManager.h"
 #include "OgreRoot.h"
+#include "OgreRay.h"
+
+#include "Math/Array/OgreArrayVector3.h"
+#include "Math/Array/OgreBooleanMask.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -42,8 +47,13 @@ namespace Ogre
         m_normalMapTex( 0 ),
         m_prevLightDir( Vector3::ZERO ),
         m_shadowMapper( 0 ),
+        m_shadowIncrementalFrames( 1u ),
+        m_shadowSmallChangeEpsilon( 0.0f ),
         m_compositorManager( compositorManager ),
-        m_camera( camera )
+        m_camera( camera ),
+        m_prevCamera( 0 ),
+        m_prevViewMatrix( Matrix4::IDENTITY ),
+        m_prevProjMatrix( Matrix4::IDENTITY )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -104,6 +114,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Terra::createHeightmapTexture( const Ogre::Image2 &image, const String &imageName )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Terrain );
         destroyHeightmapTexture();
 
         if( image.getPixelFormat() != PFG_R8_UNORM &&
@@ -201,12 +212,17 @@ namespace Ogre
         m_xzRelativeSize = m_xzDimensions / Vector2( static_cast<Real>(m_width),
                                                      static_cast<Real>(m_depth) );
 
+        m_heightPyramid.clear();
+        updateHeightPyramid( 0, 0, m_width, m_depth );
+
         createNormalTexture();
 
         m_prevLightDir = Vector3::ZERO;
 
         delete m_shadowMapper;
         m_shadowMapper = new ShadowMapper( mManager, m_compositorManager );
+        m_shadowMapper->setIncrementalUpdates( m_shadowIncrementalFrames,
+                                               m_shadowSmallChangeEpsilon );
         m_shadowMapper->createShadowMap( getId(), m_heightMapTex );
 
         createDescriptorSet();
@@ -216,6 +232,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Terra::createNormalTexture(void)
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Terrain );
         destroyNormalTexture();
 
         TextureGpuManager *textureManager =
@@ -439,7 +456,11 @@ namespace Ogre
     {
         const float lightCosAngleChange = Math::Clamp(
                     (float)m_prevLightDir.dotProduct( lightDir.normalisedCopy() ), -1.0f, 1.0f );
-        if( lightCosAngleChange <= (1.0f - lightEpsilon) )
+        if( m_shadowMapper->isUpdatePending() )
+        {
+            m_shadowMapper->continueShadowMapUpdate();
+        }
+        else if( lightCosAngleChange <= (1.0f - lightEpsilon) )
         {
             m_shadowMapper->updateShadowMap( lightDir, m_xzDimensions, m_height );
             m_prevLightDir = lightDir.normalisedCopy();
@@ -449,6 +470,18 @@ namespace Ogre
         //m_shadowMapper->updateShadowMap( Vector3(1,0,0.1), m_xzDimensions, m_height );
         //m_shadowMapper->updateShadowMap( Vector3::UNIT_Y, m_xzDimensions, m_height ); //Check! Does NAN
 
+        if( m_prevCamera == m_camera &&
+            m_prevViewMatrix == m_camera->getViewMatrix( true ) &&
+            m_prevProjMatrix == m_camera->getProjectionMatrix() )
+        {
+            //Same LODs & same visible cells as last time.
+            return;
+        }
+
+        m_prevCamera = m_camera;
+        m_prevViewMatrix = m_camera->getViewMatrix( true );
+        m_prevProjMatrix = m_camera->getProjectionMatrix();
+
         mRenderables.clear();
         m_currentCell = 0;
 
@@ -604,6 +637,7 @@ namespace Ogre
 
             m_terrainCells.clear();
             m_terrainCells.resize( numCells, TerrainCell( this ) );
+            m_prevCamera = 0;
         }
 
         VaoManager *vaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
@@ -666,6 +700,292 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    void Terra::updateHeightPyramid( uint32 x, uint32 z, uint32 width, uint32 depth )
+    {
+        if( m_width < 2u || m_depth < 2u )
+            return;
+
+        //Quads touching any of the texels in the region
+        uint32 left     = x > 0u ? x - 1u : 0u;
+        uint32 top      = z > 0u ? z - 1u : 0u;
+        uint32 right    = std::min( x + width, m_width - 1u );
+        uint32 bottom   = std::min( z + depth, m_depth - 1u );
+
+        if( m_heightPyramid.empty() )
+        {
+            TerraMinMaxLevel level;
+            level.width = m_width - 1u;
+            level.depth = m_depth - 1u;
+            while( true )
+            {
+                m_heightPyramid.push_back( level );
+                m_heightPyramid.back().minMax.resize( level.width * level.depth * 2u );
+                if( level.width == 1u && level.depth == 1u )
+                    break;
+                level.width = (level.width + 1u) >> 1u;
+                level.depth = (level.depth + 1u) >> 1u;
+            }
+
+            left = 0u;
+            top = 0u;
+            right = m_width - 1u;
+            bottom = m_depth - 1u;
+        }
+
+        if( left >= right || top >= bottom )
+            return;
+
+        {
+            TerraMinMaxLevel &quads = m_heightPyramid[0];
+            for( uint32 qz=top; qz<bottom; ++qz )
+            {
+                const float * RESTRICT_ALIAS row0 = &m_heightMap[qz * m_width];
+                const float * RESTRICT_ALIAS row1 = row0 + m_width;
+                for( uint32 qx=left; qx<right; ++qx )
+                {
+                    float *minMax = &quads.minMax[(qz * quads.width + qx) * 2u];
+                    minMax[0] = Ogre::min( Ogre::min( row0[qx], row0[qx + 1u] ),
+                                           Ogre::min( row1[qx], row1[qx + 1u] ) );
+                    minMax[1] = Ogre::max( Ogre::max( row0[qx], row0[qx + 1u] ),
+                                           Ogre::max( row1[qx], row1[qx + 1u] ) );
+                }
+            }
+        }
+
+        for( size_t i=1u; i<m_heightPyramid.size(); ++i )
+        {
+            const TerraMinMaxLevel &children = m_heightPyramid[i - 1u];
+            TerraMinMaxLevel &level = m_heightPyramid[i];
+
+            left    = left >> 1u;
+            top     = top >> 1u;
+            right   = (right + 1u) >> 1u;
+            bottom  = (bottom + 1u) >> 1u;
+
+            for( uint32 nz=top; nz<bottom; ++nz )
+            {
+                for( uint32 nx=left; nx<right; ++nx )
+                {
+                    float minHeight = std::numeric_limits<float>::max();
+                    float maxHeight = -std::numeric_limits<float>::max();
+
+                    const uint32 czEnd = std::min( nz * 2u + 2u, children.depth );
+                    const uint32 cxEnd = std::min( nx * 2u + 2u, children.width );
+                    for( uint32 cz=nz * 2u; cz<czEnd; ++cz )
+                    {
+                        for( uint32 cx=nx * 2u; cx<cxEnd; ++cx )
+                        {
+                            const float *child = &children.minMax[(cz * children.width + cx) * 2u];
+                            minHeight = Ogre::min( minHeight, child[0] );
+                            maxHeight = Ogre::max( maxHeight, child[1] );
+                        }
+                    }
+
+                    level.minMax[(nz * level.width + nx) * 2u + 0u] = minHeight;
+                    level.minMax[(nz * level.width + nx) * 2u + 1u] = maxHeight;
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    std::pair<bool, Real> Terra::rayIntersects( const Ray &ray, Real maxDistance ) const
+    {
+        std::pair<bool, Real> retVal;
+        rayIntersectsPacket( &ray, &maxDistance, 1u, &retVal );
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::rayIntersects( const Ray *rays, const Real *maxDistances, size_t numRays,
+                               std::pair<bool, Real> *outResults ) const
+    {
+        for( size_t i=0; i<numRays; i += ARRAY_PACKED_REALS )
+        {
+            rayIntersectsPacket( rays + i, maxDistances ? maxDistances + i : 0,
+                                 std::min<size_t>( numRays - i, ARRAY_PACKED_REALS ),
+                                 outResults + i );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    /// Möller-Trumbore. Updates closestDist of the rays that hit the triangle closer.
+    static inline void rayIntersectsTriangle( const ArrayVector3 &rayOrigin,
+                                              const ArrayVector3 &rayDir,
+                                              const Vector3 &v0, const Vector3 &v1,
+                                              const Vector3 &v2, ArrayReal &closestDist )
+    {
+        //Small tolerance so that rays through shared edges can't slip between triangles
+        const ArrayReal epsilon = Mathlib::SetAll( 1e-5f );
+
+        ArrayVector3 edge1, edge2, s;
+        edge1.setAll( v1 - v0 );
+        edge2.setAll( v2 - v0 );
+        s.setAll( v0 );
+        s = rayOrigin - s;
+
+        const ArrayVector3 p = rayDir.crossProduct( edge2 );
+        const ArrayReal invDet = Mathlib::SetAll( 1.0f ) / edge1.dotProduct( p );
+
+        const ArrayVector3 q = s.crossProduct( edge1 );
+        const ArrayReal u = s.dotProduct( p ) * invDet;
+        const ArrayReal v = rayDir.dotProduct( q ) * invDet;
+        const ArrayReal t = edge2.dotProduct( q ) * invDet;
+
+        //If the ray is parallel to the triangle these are NaN and the comparisons fail
+        ArrayMaskR mask = Mathlib::CompareGreaterEqual( u, -epsilon );
+        mask = Mathlib::And( mask, Mathlib::CompareGreaterEqual( v, -epsilon ) );
+        mask = Mathlib::And( mask, Mathlib::CompareLessEqual( u + v,
+                                                              Mathlib::SetAll( 1.0f ) + epsilon ) );
+        mask = Mathlib::And( mask, Mathlib::CompareGreaterEqual( t, ARRAY_REAL_ZERO ) );
+        mask = Mathlib::And( mask, Mathlib::CompareLess( t, closestDist ) );
+
+        closestDist = Mathlib::CmovRobust( t, closestDist, mask );
+    }
+    //-----------------------------------------------------------------------------------
+    void Terra::rayIntersectsPacket( const Ray *rays, const Real *maxDistances, size_t numRays,
+                                     std::pair<bool, Real> *outResults ) const
+    {
+        assert( numRays <= ARRAY_PACKED_REALS );
+
+        if( m_heightPyramid.empty() )
+        {
+            for( size_t i=0; i<numRays; ++i )
+                outResults[i] = std::pair<bool, Real>( false, 0 );
+            return;
+        }
+
+        //Work in grid space: one unit per texel in XZ, heights relative to the origin in Y.
+        //It's an affine transform, so distances along the rays are the same as in world space.
+        const Real gridScaleX = m_width * m_xzInvDimensions.x;
+        const Real gridScaleZ = m_depth * m_xzInvDimensions.y;
+
+        ArrayVector3 rayOrigin( ArrayVector3::ZERO );
+        ArrayVector3 rayDir( ArrayVector3::UNIT_Y );
+        ArrayVector3 rayInvDir( ArrayVector3::UNIT_Y );
+        //Unused lanes have a negative distance, so they never hit anything
+        ArrayReal closestDist = Mathlib::SetAll( -1.0f );
+
+        for( size_t i=0; i<numRays; ++i )
+        {
+            Vector3 origin = rays[i].getOrigin() - m_terrainOrigin;
+            Vector3 dir = rays[i].getDirection();
+            origin.x *= gridScaleX;
+            origin.z *= gridScaleZ;
+            dir.x *= gridScaleX;
+            dir.z *= gridScaleZ;
+
+            //Avoid infinities (and NaNs from 0 * inf) in the slab tests
+            Vector3 invDir;
+            for( size_t j=0; j<3u; ++j )
+            {
+                invDir[j] = dir[j] != 0 ? 1.0f / dir[j] : std::numeric_limits<Real>::max();
+            }
+
+            rayOrigin.setFromVector3( origin, i );
+            rayDir.setFromVector3( dir, i );
+            rayInvDir.setFromVector3( invDir, i );
+            Mathlib::Set( closestDist, maxDistances ? maxDistances[i] :
+                                                      std::numeric_limits<Real>::max(), i );
+        }
+
+        const ArrayReal initialDist = closestDist;
+
+        //The whole packet shares the traversal order; pick the one of the first ray
+        const uint32 nearX = rays[0].getDirection().x < 0 ? 1u : 0u;
+        const uint32 nearZ = rays[0].getDirection().z < 0 ? 1u : 0u;
+
+        struct Node
+        {
+            uint32 x;
+            uint32 z;
+            uint32 level;
+        };
+
+        //A node pushes up to 4 children, so the stack never grows beyond 3 per level
+        Node stack[100];
+        assert( m_heightPyramid.size() * 3u + 1u <= sizeof( stack ) / sizeof( stack[0] ) );
+
+        size_t stackSize = 1u;
+        stack[0].x = 0u;
+        stack[0].z = 0u;
+        stack[0].level = static_cast<uint32>( m_heightPyramid.size() - 1u );
+
+        const uint32 numQuadsX = m_width - 1u;
+        const uint32 numQuadsZ = m_depth - 1u;
+
+        while( stackSize )
+        {
+            const Node node = stack[--stackSize];
+
+            const TerraMinMaxLevel &level = m_heightPyramid[node.level];
+            const float *minMax = &level.minMax[(node.z * level.width + node.x) * 2u];
+
+            const uint32 x0 = node.x << node.level;
+            const uint32 z0 = node.z << node.level;
+            const uint32 x1 = std::min( (node.x + 1u) << node.level, numQuadsX );
+            const uint32 z1 = std::min( (node.z + 1u) << node.level, numQuadsZ );
+
+            //Slab test against the node's bounds
+            ArrayVector3 boxMin, boxMax;
+            boxMin.setAll( Vector3( Real( x0 ), minMax[0], Real( z0 ) ) );
+            boxMax.setAll( Vector3( Real( x1 ), minMax[1], Real( z1 ) ) );
+
+            const ArrayVector3 t0 = (boxMin - rayOrigin) * rayInvDir;
+            const ArrayVector3 t1 = (boxMax - rayOrigin) * rayInvDir;
+            ArrayVector3 tNear = t0;
+            tNear.makeFloor( t1 );
+            ArrayVector3 tFar = t0;
+            tFar.makeCeil( t1 );
+
+            const ArrayReal tEnter = Mathlib::Max( tNear.getMaxComponent(), ARRAY_REAL_ZERO );
+            const ArrayReal tExit = tFar.getMinComponent();
+
+            ArrayMaskR mask = Mathlib::CompareLessEqual( tEnter, tExit );
+            mask = Mathlib::And( mask, Mathlib::CompareLess( tEnter, closestDist ) );
+            if( BooleanMask4::getScalarMask( mask ) == 0 )
+                continue;
+
+            if( node.level == 0u )
+            {
+                //Same triangulation as getHeightAt
+                const float h00 = m_heightMap[z0 * m_width + x0];
+                const float h10 = m_heightMap[z0 * m_width + x0 + 1u];
+                const float h01 = m_heightMap[(z0 + 1u) * m_width + x0];
+                const float h11 = m_heightMap[(z0 + 1u) * m_width + x0 + 1u];
+
+                const Vector3 v00( Real( x0 ), h00, Real( z0 ) );
+                const Vector3 v10( Real( x0 + 1u ), h10, Real( z0 ) );
+                const Vector3 v01( Real( x0 ), h01, Real( z0 + 1u ) );
+                const Vector3 v11( Real( x0 + 1u ), h11, Real( z0 + 1u ) );
+
+                rayIntersectsTriangle( rayOrigin, rayDir, v00, v01, v11, closestDist );
+                rayIntersectsTriangle( rayOrigin, rayDir, v00, v11, v10, closestDist );
+                continue;
+            }
+
+            //Push the farthest child first, so the nearest is popped first
+            const TerraMinMaxLevel &children = m_heightPyramid[node.level - 1u];
+            for( int i=3; i>=0; --i )
+            {
+                const uint32 childX = node.x * 2u + ((uint32( i ) & 1u) ^ nearX);
+                const uint32 childZ = node.z * 2u + ((uint32( i ) >> 1u) ^ nearZ);
+                if( childX < children.width && childZ < children.depth )
+                {
+                    stack[stackSize].x = childX;
+                    stack[stackSize].z = childZ;
+                    stack[stackSize].level = node.level - 1u;
+                    ++stackSize;
+                }
+            }
+        }
+
+        const uint32 hitMask =
+                BooleanMask4::getScalarMask( Mathlib::CompareLess( closestDist, initialDist ) );
+        OGRE_ALIGNED_DECL( Real, scalarDist[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+        CastArrayToReal( scalarDist, closestDist );
+
+        for( size_t i=0; i<numRays; ++i )
+            outResults[i] = std::pair<bool, Real>( IS_BIT_SET( i, hitMask ), scalarDist[i] );
+    }
+    //-----------------------------------------------------------------------------------
     void Terra::setDatablock( HlmsDatablock *datablock )
     {
         std::vector<TerrainCell>::iterator itor = m_terrainCells.begin();
@@ -678,6 +998,14 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void Terra::setShadowMapIncrementalUpdates( uint32 numFrames, float smallChangeEpsilon )
+    {
+        m_shadowIncrementalFrames = numFrames;
+        m_shadowSmallChangeEpsilon = smallChangeEpsilon;
+        if( m_shadowMapper )
+            m_shadowMapper->setIncrementalUpdates( numFrames, smallChangeEpsilon );
+    }
+    //-----------------------------------------------------------------------------------
     Ogre::TextureGpu* Terra::_getShadowMapTex(void) const
     {
         return m_shadowMapper->getShadowMapTex();
@@ -14,8 +14,10 @@
 #include "Vao/OgreConstBufferPacked.h"
 #include "Vao/OgreVaoManager.h"
 #include "OgreRoot.h"
+#include "OgreException.h"
 
 #include "OgreLwString.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -29,9 +31,25 @@ namespace Ogre
         m_jobParamXYStep( 0 ),
         m_jobParamIsStep( 0 ),
         m_jobParamHeightDelta( 0 ),
+        m_jobParamGroupOffset( 0 ),
+        m_delta( Vector2::ZERO ),
+        m_isSteep( 0 ),
+        m_heightDelta( 0 ),
+        m_incrementalFrames( 1u ),
+        m_smallChangeEpsilon( 0 ),
+        m_shadowMapTexBack( 0 ),
+        m_bandWorkspace( 0 ),
+        m_blurWorkspace( 0 ),
+        m_copyWorkspace( 0 ),
+        m_totalThreadGroups( 0 ),
+        m_nextThreadGroup( 0 ),
+        m_skipBlur( false ),
+        m_lastBlurredLightDir( Vector3::ZERO ),
         m_sceneManager( sceneManager ),
         m_compositorManager( compositorManager )
     {
+        m_xyStep[0] = 1;
+        m_xyStep[1] = 1;
     }
     //-----------------------------------------------------------------------------------
     ShadowMapper::~ShadowMapper()
@@ -41,6 +59,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void ShadowMapper::createShadowMap( IdType id, TextureGpu *heightMapTex )
     {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Terrain );
         destroyShadowMap();
 
         m_heightMapTex = heightMapTex;
@@ -84,10 +103,77 @@ namespace Ogre
         m_jobParamXYStep = shaderParams.findParameter( "xyStep" );
         m_jobParamIsStep = shaderParams.findParameter( "isSteep" );
         m_jobParamHeightDelta = shaderParams.findParameter( "heightDelta" );
+        m_jobParamGroupOffset = shaderParams.findParameter( "groupOffset" );
+
+        m_totalThreadGroups = 0;
+        m_nextThreadGroup = 0;
+        m_lastBlurredLightDir = Vector3::ZERO;
+
+        if( m_incrementalFrames > 1u )
+            createIncrementalResources();
 
         setGaussianFilterParams( 8, 0.5f );
     }
     //-----------------------------------------------------------------------------------
+    void ShadowMapper::createIncrementalResources(void)
+    {
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Terrain );
+        OGRE_ASSERT_LOW( m_shadowMapTex && !m_shadowMapTexBack );
+
+        TextureGpuManager *textureManager =
+                m_sceneManager->getDestinationRenderSystem()->getTextureGpuManager();
+        m_shadowMapTexBack = textureManager->createTexture(
+                                 m_shadowMapTex->getNameStr() + "/Back",
+                                 GpuPageOutStrategy::Discard,
+                                 TextureFlags::Uav,
+                                 TextureTypes::Type2D );
+        m_shadowMapTexBack->setResolution( m_shadowMapTex->getWidth(),
+                                           m_shadowMapTex->getHeight() );
+        m_shadowMapTexBack->setPixelFormat( m_shadowMapTex->getPixelFormat() );
+        m_shadowMapTexBack->scheduleTransitionTo( GpuResidency::Resident );
+
+        CompositorChannelVec bandTarget( 1, CompositorChannel() );
+        bandTarget[0] = m_shadowMapTexBack;
+        m_bandWorkspace = m_compositorManager->addWorkspace(
+                              m_sceneManager, bandTarget, 0,
+                              "Terra/ShadowGeneratorBandWorkspace", false );
+
+        CompositorChannelVec resolveTargets( 2, CompositorChannel() );
+        resolveTargets[0] = m_shadowMapTex;
+        resolveTargets[1] = m_shadowMapTexBack;
+        m_blurWorkspace = m_compositorManager->addWorkspace(
+                              m_sceneManager, resolveTargets, 0,
+                              "Terra/ShadowResolveBlurWorkspace", false );
+        m_copyWorkspace = m_compositorManager->addWorkspace(
+                              m_sceneManager, resolveTargets, 0,
+                              "Terra/ShadowResolveCopyWorkspace", false );
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowMapper::destroyIncrementalResources(void)
+    {
+        CompositorWorkspace **workspaces[3] =
+        {
+            &m_bandWorkspace, &m_blurWorkspace, &m_copyWorkspace
+        };
+
+        for( size_t i=0; i<3u; ++i )
+        {
+            if( *workspaces[i] )
+            {
+                m_compositorManager->removeWorkspace( *workspaces[i] );
+                *workspaces[i] = 0;
+            }
+        }
+
+        if( m_shadowMapTexBack )
+        {
+            TextureGpuManager *textureManager =
+                    m_sceneManager->getDestinationRenderSystem()->getTextureGpuManager();
+            textureManager->destroyTexture( m_shadowMapTexBack );
+            m_shadowMapTexBack = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void ShadowMapper::destroyShadowMap(void)
     {
         m_heightMapTex = 0;
@@ -110,6 +196,11 @@ namespace Ogre
             m_shadowPerGroupData = 0;
         }
 
+        destroyIncrementalResources();
+
+        m_totalThreadGroups = 0;
+        m_nextThreadGroup = 0;
+
         if( m_shadowWorkspace )
         {
             m_compositorManager->removeWorkspace( m_shadowWorkspace );
@@ -218,7 +309,7 @@ namespace Ogre
             std::swap( x1, y1 );
         }
 
-        m_jobParamIsStep->setManualValue( (int32)steep );
+        m_isSteep = (int32)steep;
 
         float dx;
         float dy;
@@ -238,7 +329,7 @@ namespace Ogre
                 dy += 1.0f * fabsf( lightDir2d.y ) / fabsf( lightDir2d.x );
             else
                 dy += 1.0f * fabsf( lightDir2d.x ) / fabsf( lightDir2d.y );
-            m_jobParamDelta->setManualValue( Vector2( dx, dy ) );
+            m_delta = Vector2( dx, dy );
         }
 
         const int32 xyStep[2] =
@@ -246,13 +337,14 @@ namespace Ogre
             (x0 < x1) ? 1 : -1,
             (y0 < y1) ? 1 : -1
         };
-        m_jobParamXYStep->setManualValue( xyStep, 2u );
+        m_xyStep[0] = xyStep[0];
+        m_xyStep[1] = xyStep[1];
 
         heightDelta = ( -heightDelta * (xzDimensions.x / width) ) / heightScale;
         //Avoid sending +/- inf (which causes NaNs inside the shader).
         //Values greater than 1.0 (or less than -1.0) are pointless anyway.
         heightDelta = Ogre::max( -1.0f, Ogre::min( 1.0f, heightDelta ) );
-        m_jobParamHeightDelta->setManualValue( heightDelta );
+        m_heightDelta = heightDelta;
 
         //y0 is not needed anymore, and we need it to be either 0 or heightOrWidth for the
         //algorithm to work correctly (depending on the sign of xyStep[1]). So do this now.
@@ -322,6 +414,64 @@ namespace Ogre
         m_shadowPerGroupData->unmap( UO_KEEP_PERSISTENT );
         m_shadowStarts->unmap( UO_KEEP_PERSISTENT );
 
+        m_totalThreadGroups = totalThreadGroups;
+
+        if( !m_bandWorkspace )
+        {
+            dispatchShadowJob( m_shadowWorkspace, 0, totalThreadGroups );
+            m_nextThreadGroup = totalThreadGroups;
+        }
+        else
+        {
+            const Vector3 lightDirNorm = lightDir.normalisedCopy();
+            if( m_lastBlurredLightDir == Vector3::ZERO )
+            {
+                //Nothing valid is being displayed yet. Don't wait N frames.
+                m_skipBlur = false;
+                dispatchShadowJob( m_bandWorkspace, 0, totalThreadGroups );
+                m_nextThreadGroup = totalThreadGroups;
+                m_blurWorkspace->_update();
+            }
+            else
+            {
+                const float lightCosAngleChange = Math::Clamp(
+                            (float)m_lastBlurredLightDir.dotProduct( lightDirNorm ), -1.0f, 1.0f );
+                m_skipBlur = lightCosAngleChange > (1.0f - m_smallChangeEpsilon);
+                m_nextThreadGroup = 0;
+                continueShadowMapUpdate();
+            }
+
+            if( !m_skipBlur )
+                m_lastBlurredLightDir = lightDirNorm;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowMapper::continueShadowMapUpdate(void)
+    {
+        if( !isUpdatePending() )
+            return;
+
+        const uint32 groupsPerFrame = alignToNextMultiple( m_totalThreadGroups,
+                                                           m_incrementalFrames ) /
+                                      m_incrementalFrames;
+        const uint32 numThreadGroups = std::min( groupsPerFrame,
+                                                 m_totalThreadGroups - m_nextThreadGroup );
+
+        dispatchShadowJob( m_bandWorkspace, m_nextThreadGroup, numThreadGroups );
+        m_nextThreadGroup += numThreadGroups;
+
+        if( !isUpdatePending() )
+        {
+            if( m_skipBlur )
+                m_copyWorkspace->_update();
+            else
+                m_blurWorkspace->_update();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowMapper::dispatchShadowJob( CompositorWorkspace *workspace,
+                                          uint32 groupOffset, uint32 numThreadGroups )
+    {
         //Re-Set them every frame (they may have changed if we have multiple Terra instances)
         m_shadowJob->setConstBuffer( 0, m_shadowStarts );
         m_shadowJob->setConstBuffer( 1, m_shadowPerGroupData );
@@ -329,23 +479,65 @@ namespace Ogre
         texSlot.texture = m_heightMapTex;
         m_shadowJob->setTexture( 0, texSlot );
 
-        m_shadowJob->setNumThreadGroups( totalThreadGroups, 1u, 1u );
+        m_shadowJob->setNumThreadGroups( numThreadGroups, 1u, 1u );
+
+        m_jobParamDelta->setManualValue( m_delta );
+        m_jobParamXYStep->setManualValue( m_xyStep, 2u );
+        m_jobParamIsStep->setManualValue( m_isSteep );
+        m_jobParamHeightDelta->setManualValue( m_heightDelta );
+        m_jobParamGroupOffset->setManualValue( groupOffset );
 
         ShaderParams &shaderParams = m_shadowJob->getShaderParams( "default" );
         shaderParams.setDirty();
 
-        m_shadowWorkspace->_update();
+        workspace->_update();
+    }
+    //-----------------------------------------------------------------------------------
+    void ShadowMapper::setIncrementalUpdates( uint32 numFrames, float smallChangeEpsilon )
+    {
+        if( numFrames == 0u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "numFrames must be at least 1",
+                         "ShadowMapper::setIncrementalUpdates" );
+        }
+
+        if( numFrames == 1u && isUpdatePending() )
+        {
+            //Finish what we were doing, all at once
+            m_incrementalFrames = 1u;
+            continueShadowMapUpdate();
+        }
+
+        m_incrementalFrames = numFrames;
+        m_smallChangeEpsilon = smallChangeEpsilon;
+
+        if( m_shadowMapTex )
+        {
+            if( numFrames > 1u && !m_bandWorkspace )
+            {
+                createIncrementalResources();
+                //The back buffer has nothing. Force the next update to compute everything.
+                m_lastBlurredLightDir = Vector3::ZERO;
+            }
+            else if( numFrames == 1u && m_bandWorkspace )
+            {
+                destroyIncrementalResources();
+            }
+        }
     }
     //-----------------------------------------------------------------------------------
     void ShadowMapper::fillUavDataForCompositorChannel( TextureGpu **outChannel,
                                                         ResourceLayoutMap &outInitialLayouts,
                                                         ResourceAccessMap &outInitialUavAccess ) const
     {
+        //With incremental updates, the blur workspace is the one writing to m_shadowMapTex
+        const CompositorWorkspace *workspace = m_blurWorkspace ? m_blurWorkspace :
+                                                                 m_shadowWorkspace;
         *outChannel = m_shadowMapTex;
-        outInitialLayouts.insert( m_shadowWorkspace->getResourcesLayout().begin(),
-                                  m_shadowWorkspace->getResourcesLayout().end() );
-        outInitialUavAccess.insert( m_shadowWorkspace->getUavsAccess().begin(),
-                                    m_shadowWorkspace->getUavsAccess().end() );
+        outInitialLayouts.insert( workspace->getResourcesLayout().begin(),
+                                  workspace->getResourcesLayout().end() );
+        outInitialUavAccess.insert( workspace->getUavsAccess().begin(),
+                                    workspace->getUavsAccess().end() );
     }
     //-----------------------------------------------------------------------------------
     void ShadowMapper::setGaussianFilterParams( uint8 kernelRadius, float gaussianDeviationFactor )
@@ -0,0 +1,147 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreBakedSkeletonAnimation_H_
+#define _OgreBakedSkeletonAnimation_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreIdString.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Animation
+    *  @{
+    */
+
+    /** Bakes every animation of a SkeletonDef into a table of bone matrices (one set of
+        matrices per sampled frame), for background crowds that don't need blending.
+    @remarks
+        Items added via addItem no longer animate on the CPU nor upload bone matrices: each
+        frame HlmsPbs only sends which baked frame to use (from
+        SkeletonInstance::setBakedAnimation & co.) and the world matrix, and the vertex
+        shader reads the matrices straight from the baked table (hlms_skeleton_baked).
+        Thousands of crowd members thus cost about the same as unskinned Items.
+    @par
+        Baking happens on the CPU once, in the constructor. Memory cost is
+        numBones * 48 bytes per sampled frame, so keep the sample rate low for long
+        animations (linear interpolation between frames is not performed; the closest
+        sample is used).
+    @par
+        Limitations:
+            - One animation per instance, with weight 1 (no blending).
+            - Animations from other skeletons (SkeletonInstance::addAnimationsFromSkeleton)
+              and manual bones are ignored.
+            - Only HlmsPbs supports it.
+            - The Bones are not updated on the CPU, exactly like with GpuSkeletonEvaluator.
+              Use SkeletonInstance::setCpuEvaluation if you need them.
+    */
+    class _OgreExport BakedSkeletonAnimation : public UtilityAlloc
+    {
+    public:
+        struct BakedAnimation
+        {
+            IdString    name;
+            /// Offset in float4 to the first frame
+            uint32      firstFrame;
+            uint32      numSamples;
+            /// Length of the animation, in seconds
+            Real        duration;
+        };
+
+        typedef vector<BakedAnimation>::type BakedAnimationVec;
+
+    protected:
+        SkeletonDef const   *mSkeletonDef;
+        Real                mSampleRate;
+        BakedAnimationVec   mAnimations;
+
+        /// 3 float4 per bone, numBones per sample
+        TexBufferPacked     *mBoneMatrices;
+        VaoManager          *mVaoManager;
+
+        FastArray<SkeletonInstance*>    mInstances;
+        /// How many Items added with addItem share the SkeletonInstance at the same index
+        FastArray<uint32>               mRefCounts;
+
+        void bake(void);
+
+        void removeSkeletonInstance( SkeletonInstance *skeleton, bool bForce );
+
+    public:
+        /**
+        @param skeletonDef
+            Skeleton whose animations will be baked.
+        @param sampleRate
+            Samples per second. 0 to use the original frame rate of each animation.
+        */
+        BakedSkeletonAnimation( const SkeletonDef *skeletonDef, VaoManager *vaoManager,
+                                Real sampleRate=30 );
+        ~BakedSkeletonAnimation();
+
+        const SkeletonDef* getSkeletonDef(void) const       { return mSkeletonDef; }
+        const BakedAnimationVec& getAnimations(void) const  { return mAnimations; }
+        uint32 getNumAnimations(void) const { return static_cast<uint32>( mAnimations.size() ); }
+
+        /// Returns the index to use with SkeletonInstance::setBakedAnimation.
+        /// Throws if not found.
+        uint32 getAnimationIndex( IdString name ) const;
+
+        /** Plays the baked animations on the given Item from now on.
+        @remarks
+            The Item's skeleton must use the same SkeletonDef we were baked from.
+            The Item must not be evaluated by a GpuSkeletonEvaluator at the same time.
+            The Hlms hashes of the SubItems are recalculated.
+        */
+        void addItem( Item *item );
+
+        /// Restores CPU evaluation of an Item added via addItem.
+        void removeItem( Item *item );
+
+        /// Returns the buffer with all the baked bone matrices, to be bound by the Hlms.
+        TexBufferPacked* getBoneMatrices(void) const        { return mBoneMatrices; }
+
+        /// Returns the offset, in float4, to the bone matrices of animIdx at the given
+        /// time in seconds. Loops around at the end of the animation.
+        uint32 getFrameOffset( uint32 animIdx, Real time ) const;
+
+        /// Called by SkeletonInstance when destroyed while still using us
+        void _notifySkeletonInstanceDestroyed( SkeletonInstance *skeleton );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,168 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreGpuSkeletonEvaluator_H_
+#define _OgreGpuSkeletonEvaluator_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreResourceTransition.h"
+#include "Compositor/OgreCompositorWorkspaceListener.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Animation
+    *  @{
+    */
+
+    /** Evaluates skeletal animations with compute shaders, for scenes with massive amounts
+        of animated characters (crowds) where updating the bones on the CPU and uploading
+        every bone matrix each frame becomes the bottleneck.
+    @remarks
+        The keyframes, bind pose and hierarchy of each SkeletonDef are uploaded once into a
+        TexBuffer. Every frame only the time & weight of each active animation and the
+        world matrix of each SkeletonInstance are uploaded; a compute job then samples &
+        blends the animations, walks the hierarchy and writes the final bone matrices into
+        an UAV buffer which HlmsPbs reads directly from the vertex shader
+        (hlms_skeleton_gpu).
+    @par
+        The compute job lives in Samples/Media/2.0/scripts/materials/Common
+        (GpuSkeleton.material.json) and must be loaded as a resource.
+    @par
+        The evaluation happens in CompositorWorkspaceListener::allWorkspacesBeginUpdate, thus
+        this object is registered as a listener of CompositorManager2 while it's alive.
+    @par
+        Limitations:
+            - Up to MaxBones bones per SkeletonDef.
+            - Up to MaxActiveAnimations animations blended per instance. Extra ones are ignored.
+            - Per bone weights (SkeletonAnimation::setBoneWeight) and manual bones are
+              ignored. Only animations from the instance's own SkeletonDef are played
+              (i.e. not the ones added with SkeletonInstance::addAnimationsFromSkeleton).
+            - Only HlmsPbs supports it.
+            - The Bones are not updated on the CPU, which means nodes attached to bones
+              (i.e. TagPoints) won't follow the animation. Use
+              SkeletonInstance::setCpuEvaluation on the few instances that need it.
+    */
+    class _OgreExport GpuSkeletonEvaluator : public CompositorWorkspaceListener, public UtilityAlloc
+    {
+    public:
+        static const uint32 MaxBones;
+        static const uint32 MaxActiveAnimations;
+
+    protected:
+        struct SkeletonDefGroup
+        {
+            SkeletonDef const   *skeletonDef;
+            /// Bind pose, hierarchy & keyframes. See createSkeletonData for the layout
+            TexBufferPacked     *skeletonData;
+            /// Per instance animation state. Uploaded every frame
+            TexBufferPacked     *instanceData;
+            HlmsComputeJob      *job;
+
+            FastArray<SkeletonInstance*>    instances;
+            /// How many Items added with addItem share the SkeletonInstance at the same index
+            FastArray<uint32>               refCounts;
+        };
+
+        typedef vector<SkeletonDefGroup>::type SkeletonDefGroupVec;
+
+        SkeletonDefGroupVec mGroups;
+
+        /// Scratch memory where the instance data is built before uploading it
+        FastArray<float>    mInstanceScratch;
+
+        /// 3 float4 per bone, for every bone of every instance in mGroups
+        UavBufferPacked     *mBoneMatrices;
+        TexBufferPacked     *mBoneMatricesView;
+        bool                mBoneOffsetsDirty;
+
+        ResourceTransition  mToUavTransition;
+        ResourceTransition  mToTextureTransition;
+
+        HlmsCompute         *mHlmsCompute;
+        VaoManager          *mVaoManager;
+        RenderSystem        *mRenderSystem;
+        CompositorManager2  *mCompositorManager;
+
+        HlmsComputeJob* createJob(void);
+        void createSkeletonData( SkeletonDefGroup &group );
+        void destroyGroup( SkeletonDefGroup &group );
+
+        void addSkeletonInstance( SkeletonInstance *skeleton );
+        /// Decrements the reference count. Removes the instance altogether if it reaches 0
+        /// or if bForce is true. Returns true if it was removed.
+        bool removeSkeletonInstance( SkeletonInstance *skeleton, bool bForce );
+
+        /// Assigns SkeletonInstance::_getGpuBoneOffset and resizes mBoneMatrices
+        void updateBoneOffsets(void);
+
+        void fillInstanceData( const SkeletonDefGroup &group );
+
+    public:
+        GpuSkeletonEvaluator( HlmsManager *hlmsManager, VaoManager *vaoManager,
+                              CompositorManager2 *compositorManager );
+        virtual ~GpuSkeletonEvaluator();
+
+        /// Returns false if the RenderSystem can't run compute shaders
+        bool isSupported(void) const;
+
+        /** Evaluates the animations of the given Item on the GPU from now on.
+        @remarks
+            The Item must have a skeleton. Items sharing the same SkeletonInstance
+            (Item::useSkeletonInstanceFrom) must all be added.
+            The Hlms hashes of the SubItems are recalculated.
+        */
+        void addItem( Item *item );
+
+        /// Restores CPU evaluation of an Item added via addItem.
+        void removeItem( Item *item );
+
+        /// Returns the buffer with the final bone matrices, to be bound by the Hlms.
+        /// May be null if there's nothing to evaluate.
+        TexBufferPacked* getBoneMatrices(void) const                { return mBoneMatricesView; }
+
+        /// Runs the compute jobs. Called automatically from allWorkspacesBeginUpdate
+        void update(void);
+
+        /// Called by SkeletonInstance when destroyed while still being evaluated by us
+        void _notifySkeletonInstanceDestroyed( SkeletonInstance *skeleton );
+
+        virtual void allWorkspacesBeginUpdate(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -54,21 +54,23 @@ namespace Ogre
 
         /** MUST be sorted by location in its BoneMemoryManager's slot
             (in order to update in parallel without causing race conditions)
-            @See threadStarts
+            @See chunkStarts
         */
         FastArray<SkeletonInstance*>    skeletons;
 
-        /** One per thread (plus one), tells where we should start from in each
-            thread. It's not exactly skeletons.size() / mNumWorkerThreads because
-            we need to account that instances that share the same memory block.
+        /** Several per thread (plus one), tells where each chunk of skeletons that can be
+            processed by a single thread starts. It's not exactly skeletons.size() / numChunks
+            because we need to account that instances that share the same memory block must
+            belong to the same chunk.
+            Worker threads grab (and steal) these chunks; @see WorkStealingScheduler
         */
-        FastArray<size_t>               threadStarts;
+        FastArray<size_t>               chunkStarts;
 
         BySkeletonDef( const SkeletonDef *skeletonDef, size_t threadCount );
 
         void initializeMemoryManager(void);
 
-        void updateThreadStarts(void);
+        void updateChunkStarts(void);
         void _updateBoneStartTransforms(void);
 
         bool operator == ( IdString name ) const { return skeletonDefName == name; }
@@ -84,8 +86,8 @@ namespace Ogre
         same time than others).
     @par
         At the same time, for multithreading purposes we keep track of all pointers we
-        create and the variable "threadStarts" records where each thread should begin
-        processing.
+        create and the variable "chunkStarts" records where each chunk of work
+        (grabbed by worker threads) begins.
         Unlike nodes, we cannot just iterate through empty memory because each skeleton
         instance is too complex and somewhat heterogeneous. We also have to ensure
         that (e.g.) if skeletons[0] and skeletons[1] share the same memory block (which
@@ -248,7 +248,13 @@ namespace Ogre
         void setEnabled( bool bEnable );
         bool getEnabled(void) const                                 { return mEnabled; }
 
-        void _applyAnimation( const TransformArray &boneTransforms );
+        /**
+        @param boneBlockMask
+            When not null, only tracks whose bone block is in this sorted list are applied.
+            @see SkeletonDef::AnimationLod::boneBlockMask
+        */
+        void _applyAnimation( const TransformArray &boneTransforms,
+                              const vector<uint32>::type *boneBlockMask = 0 );
 
         void _swapBoneWeightsUniquePtr( RawSimdUniquePtr<ArrayReal, MEMCATEGORY_ANIMATION>
                                         &inOutBoneWeights );
@@ -44,6 +44,21 @@ namespace Ogre
     class _OgreExport SkeletonAnimationDef : public AnimationAlloc
     {
         friend class SkeletonAnimation;
+    public:
+        /// A named marker placed at a given frame (i.e. footsteps, "hit" moments)
+        struct EventMarker
+        {
+            Real        frame;
+            IdString    name;
+
+            EventMarker() : frame( 0 ) {}
+            EventMarker( Real _frame, IdString _name ) : frame( _frame ), name( _name ) {}
+
+            bool operator < ( const EventMarker &other ) const  { return frame < other.frame; }
+        };
+
+        typedef vector<EventMarker>::type EventMarkerVec;
+
     protected:
         SkeletonTrackVec    mTracks;
         /** Number of frames. May not equal the number of keyframes
@@ -61,6 +76,9 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mKfTransformMemoryManager;
 
+        /// Sorted by frame
+        EventMarkerVec      mEventMarkers;
+
         typedef vector<Real>::type TimestampVec;
         typedef map<size_t, TimestampVec>::type TimestampsPerBlock;
 
@@ -86,6 +104,15 @@ namespace Ogre
         void allocateCacheFriendlyKeyframes( const TimestampsPerBlock &timestampsByBlock,
                                              Real frameRate );
 
+        /// Samples a single slot of the given track. Doesn't touch any other track.
+        static void sampleTrackSlot( const SkeletonTrack &track, size_t slot, Real frame,
+                                     Vector3 &outPos, Quaternion &outRot, Vector3 &outScale );
+
+        /// Appends the markers in [fromFrame; toFrame) when fromFrame <= toFrame, or in
+        /// (toFrame; fromFrame] otherwise. bIncludeEnd also takes toFrame itself.
+        void collectEventMarkers( Real fromFrame, Real toFrame, bool bIncludeEnd,
+                                  EventMarkerVec &outMarkers ) const;
+
     public:
         SkeletonAnimationDef();
         ~SkeletonAnimationDef();
@@ -94,15 +121,79 @@ namespace Ogre
         const String& getNameStr(void) const                            { return mName; }
         void _setSkeletonDef( const SkeletonDef *skeletonDef )          { mSkeletonDef = skeletonDef; }
 
+        const SkeletonTrackVec& getTracks(void) const                   { return mTracks; }
+
         Real getNumFrames( void ) const { return mNumFrames; }
         Real getOriginalFrameRate( void ) const { return mOriginalFrameRate; }
 
         void build( const v1::Skeleton *skeleton, const v1::Animation *animation, Real frameRate );
 
+        /** Reduces the memory used by the keyframes: removes the keyframes that can be
+            reconstructed from their neighbours and, if requested, quantizes the rest.
+            Quantized keyframes are decoded on the fly while sampling the animation.
+        @remarks
+            Must be called right after build, before any SkeletonInstance using this
+            animation is created (@see SkeletonDef::compressAnimations and
+            SkeletonManager::setAnimationCompression).
+            Once quantized, the animation can't be compressed again.
+        */
+        void compress( const KeyFrameCompressionSettings &settings );
+
+        /// Bytes used by the keyframes of all tracks.
+        size_t getKeyFrameMemoryUsage(void) const;
+
         /// Dumps all the tracks in CSV format to the output string argument.
         /// Mostly for debugging purposes. (also easy example to show how to
         /// enumerate all the tracks and get the bones back from its block index)
         void _dumpCsvTracks( String &outText ) const;
+
+        /** Places a named marker at the given frame. Markers are data only; they're never
+            fired automatically. Query them with getEventMarkersInRange.
+        @remarks
+            Several markers may share the same frame. The order of insertion is kept.
+        */
+        void addEventMarker( Real frame, IdString name );
+        void removeAllEventMarkers(void);
+        const EventMarkerVec& getEventMarkers(void) const               { return mEventMarkers; }
+
+        /** Appends to outMarkers every marker crossed when advancing from fromFrame by
+            numFrames (i.e. what SkeletonAnimation::addFrame would've gone through).
+        @remarks
+            Doesn't evaluate any bone; it's cheap enough for headless (server side) logic.
+            The interval is half open, [fromFrame; fromFrame + numFrames), so consecutive
+            queries never report the same marker twice. Negative numFrames walk backwards.
+            When not looping, markers at the very end are reported once the end is reached.
+        @param bLoop
+            Same as SkeletonAnimation::setLoop. When true, the interval wraps around
+            (and may cover the animation several times).
+        */
+        void getEventMarkersInRange( Real fromFrame, Real numFrames, bool bLoop,
+                                     EventMarkerVec &outMarkers ) const;
+
+        /** Samples the animated transform of a single bone at the given frame, only reading
+            the track that contains it. The result is what the animation adds on top of the
+            bone's bind pose (as in SkeletonTrack::applyKeyFrameRigAt with weight 1).
+        @return
+            False if the bone isn't animated by this animation (outputs are left untouched).
+        */
+        bool getBoneTransformAt( IdString boneName, Real frame, Vector3 &outPos,
+                                 Quaternion &outRot, Vector3 &outScale ) const;
+
+        /** Extracts the root motion of the given bone when advancing from fromFrame by
+            numFrames, without evaluating the rest of the skeleton.
+        @remarks
+            When looping, the deltas of every cycle covered by the interval are accumulated,
+            so the motion keeps going forward across the loop point.
+            Both deltas are in the bone's parent space (i.e. skeleton space for the root).
+        @param outPosDelta
+            Translation done during the interval.
+        @param outRotDelta
+            Rotation done during the interval: rot( end ) = rot( start ) * outRotDelta.
+        @return
+            False if the bone isn't animated by this animation (outputs are left untouched).
+        */
+        bool extractRootMotion( IdString boneName, Real fromFrame, Real numFrames, bool bLoop,
+                                Vector3 &outPosDelta, Quaternion &outRotDelta ) const;
     };
 
     typedef vector<SkeletonAnimationDef>::type SkeletonAnimationDefVec;
@@ -84,6 +84,20 @@ namespace Ogre
         typedef map<uint32, uint32>::type IndexToIndexMap;
         typedef vector<uint32>::type BoneToSlotVec;
 
+        /// @see setAnimationLod
+        struct AnimationLod
+        {
+            /// Animations are evaluated once every updateInterval frames. 1 = every frame.
+            uint32                  updateInterval;
+            /// Sorted. Block indices (@see slotToBlockIdx) of the bones that get animated.
+            /// Empty means all bones.
+            vector<uint32>::type    boneBlockMask;
+
+            AnimationLod() : updateInterval( 1u ) {}
+        };
+
+        typedef vector<AnimationLod>::type AnimationLodVec;
+
     protected:
         typedef map<IdString, size_t>::type BoneNameMap;
 
@@ -132,6 +146,9 @@ namespace Ogre
 
         String                  mName;
 
+        AnimationLodVec         mAnimationLods;
+        uint32                  mOffscreenUpdateInterval;
+
     public:
         /** Constructs this Skeleton based on the old format's Skeleton. The frameRate parameter
             indicates at which framerate it was recorded (i.e. 15fps, 25fps) so that all keyframe
@@ -199,6 +216,56 @@ namespace Ogre
 
         /// @see mBoneToSlot
         const BoneToSlotVec& getBoneToSlot(void) const      { return mBoneToSlot; }
+
+        /** Animation LOD lowers the cost of animating many instances of this skeleton
+            that are far away or not visible.
+        @remarks
+            The LOD of each SkeletonInstance is the mesh LOD (@see MovableObject::getCurrentMeshLod)
+            of the most detailed object using it that passed frustum culling in the previous
+            frame (shadow caster passes included), which is calculated by
+            SceneManager::updateAllLods. Animations are only evaluated once every
+            updateInterval frames; in between the bones hold their last pose (although
+            they still follow their parent node).
+            When an instance becomes visible again it is evaluated right away to catch up.
+        @par
+            Animation time of each SkeletonAnimation keeps advancing normally, thus skipped
+            updates don't change the timing of the animations.
+        @par
+            Animation LOD is disabled (everything is evaluated every frame) until this
+            function is called at least once.
+        @param lodIdx
+            Mesh LOD index this setting applies to. Mesh LODs above the last set index
+            use the last one. Unset indices in between evaluate every frame.
+        @param updateInterval
+            Evaluate animations once every updateInterval frames. Must be >= 1.
+        @param animatedBones
+            When not null, only the tracks of these bones (and their parents) are evaluated;
+            the rest stay in binding pose (e.g. fingers or facial bones on distant crowds).
+            Bones are grouped in SIMD blocks, thus other bones in the same block as an
+            animated bone will be animated too.
+            Null to animate all bones.
+        */
+        void setAnimationLod( size_t lodIdx, uint32 updateInterval,
+                              const IdStringVec *animatedBones = 0 );
+        const AnimationLodVec& getAnimationLods(void) const { return mAnimationLods; }
+        /// Removes all LOD settings, disabling animation LOD.
+        void clearAnimationLods(void);
+
+        /** How often instances that weren't visible in the previous frame are evaluated
+            (when animation LOD is enabled; @see setAnimationLod).
+        @param updateInterval
+            Evaluate animations once every updateInterval frames.
+            0 to never evaluate until they become visible again.
+            Default is 0.
+        */
+        void setOffscreenUpdateInterval( uint32 updateInterval );
+        uint32 getOffscreenUpdateInterval(void) const       { return mOffscreenUpdateInterval; }
+
+        /** Compresses the keyframes of all animations. @see SkeletonAnimationDef::compress
+        @remarks
+            Must be called before any SkeletonInstance is created from this definition.
+        */
+        void compressAnimations( const KeyFrameCompressionSettings &settings );
     };
 }
 
@@ -35,6 +35,8 @@ THE SOFTWARE.
 namespace Ogre
 {
     class SkeletonDef;
+    class BakedSkeletonAnimation;
+    class GpuSkeletonEvaluator;
     typedef vector<SkeletonAnimation>::type SkeletonAnimationVec;
     typedef vector<SkeletonAnimation*>::type ActiveAnimationsVec;
 
@@ -45,6 +47,26 @@ namespace Ogre
     *  @{
     */
 
+    class SkeletonInstance;
+
+    /** Small table of the poses already sampled during a SceneManager::updateSkeletonChunk
+        call, so that SkeletonInstances with the same animation state copy it instead of
+        sampling again. @see SkeletonInstance::setPoseSharingTolerance
+    @remarks
+        It's local to each chunk, which keeps it lock free. Once full, newly found poses
+        are sampled normally but not remembered.
+    */
+    struct SkeletonPoseCache
+    {
+        enum { MaxEntries = 16 };
+
+        SkeletonInstance const  *leaders[MaxEntries];
+        uint64                  keys[MaxEntries];
+        size_t                  numEntries;
+
+        SkeletonPoseCache() : numEntries( 0 ) {}
+    };
+
     /** Instance of a Skeleton, main external interface for retrieving bone positions and applying
         animations.
     @remarks
@@ -107,13 +129,94 @@ namespace Ogre
 
         uint16 mRefCount;
 
+        /// Most detailed mesh LOD of the objects using us that passed frustum culling since
+        /// the last update. 255 if none did. @see SkeletonDef::setAnimationLod
+        uint8               mVisibleLod;
+        /// The LOD used by the last update. 255 if we weren't visible.
+        uint8               mAnimationLod;
+        bool                mWasVisible;
+        /// Counts calls to update. Starts at a different value for each
+        /// instance so that throttled instances don't all update in the same frame.
+        uint32              mAnimationLodFrame;
+
+        /// When not null, bone matrices are evaluated on the GPU. @see GpuSkeletonEvaluator
+        GpuSkeletonEvaluator *mGpuEvaluator;
+        /// Offset (in float4) to our first bone matrix in GpuSkeletonEvaluator's output buffer
+        uint32              mGpuBoneOffset;
+        /// @see setCpuEvaluation
+        bool                mCpuEvaluation;
+
+        /// When not null, bone matrices are read from a prebaked table.
+        /// @see BakedSkeletonAnimation
+        BakedSkeletonAnimation *mBakedAnimation;
+        uint32              mBakedAnimationIdx;
+        Real                mBakedAnimationTime;
+
+        /// @see setPoseSharingTolerance. 0 if disabled
+        Real                mPoseSharingTolerance;
+
+        /// Returns 0 if pose sharing is disabled, a hash of the animation state otherwise.
+        uint64 getPoseKey(void) const;
+        /// Returns true if the animation state matches exactly, with the time quantised.
+        bool hasSamePose( const SkeletonInstance *other ) const;
+        /// Copies the local (i.e. before applying the hierarchy) transform of every bone.
+        void copyPoseFrom( const SkeletonInstance *other );
+
     public:
         SkeletonInstance( const SkeletonDef *skeletonDef, BoneMemoryManager *boneMemoryManager );
         ~SkeletonInstance();
 
         const SkeletonDef* getDefinition(void) const                { return mDefinition; }
 
-        void update(void);
+        /** Evaluates all active animations.
+        @remarks
+            When the definition has animation LOD (@see SkeletonDef::setAnimationLod)
+            evaluation may be skipped this frame; bones then keep their last pose.
+        @param poseCache
+            Optional. When provided and pose sharing is enabled, the pose of an instance
+            with the same animation state that was already evaluated is reused.
+            @see setPoseSharingTolerance
+        */
+        void update( SkeletonPoseCache *poseCache = 0 );
+
+        /** Lets instances with identical animation state share a single evaluation
+            (i.e. crowds playing the same animation in lockstep).
+        @remarks
+            Two instances are considered identical when both enabled pose sharing with the
+            same tolerance, use the same animation LOD and have the same active animations
+            (same SkeletonAnimationDef, in the same order, with the same weight) whose
+            current frames fall in the same bucket of 'tolerance' frames.
+            The first one evaluated samples the animations; the rest copy its bones'
+            local transforms. The hierarchy is still updated per instance, so their
+            world transforms are unaffected.
+        @par
+            Sharing happens among instances updated in the same chunk of work
+            (@see SceneManager::setNumObjsPerChunk), thus it's most effective when
+            the instances that share a pose are created together.
+        @par
+            Do not enable it on instances with manual bones or per bone weights
+            (SkeletonAnimation::setBoneWeight): they would be ignored when copying.
+        @param tolerance
+            Size in frames of each time bucket. Larger values share more often but make
+            the animations look "stepped". 0 to disable (default).
+        */
+        void setPoseSharingTolerance( Real tolerance );
+        Real getPoseSharingTolerance(void) const                    { return mPoseSharingTolerance; }
+
+        /// Mesh LOD the last update used for animation LOD purposes.
+        /// 255 if no object using this skeleton was visible.
+        uint8 getAnimationLod(void) const                           { return mAnimationLod; }
+
+        /// Called during frustum culling when an object using this skeleton is visible.
+        /// May be called from multiple threads at the same time; the race is benign
+        /// (worst case, a less detailed LOD is used for one frame).
+        void _notifyVisible( uint8 meshLod )
+        {
+            if( meshLod < mVisibleLod )
+                mVisibleLod = meshLod;
+        }
+        /// @see mAnimationLodFrame
+        void _setAnimationLodPhase( uint32 phase )                  { mAnimationLodFrame = phase; }
 
         /// Resets the transform of all bones to the binding pose. Manual bones are not reset
         void resetToPose(void);
@@ -215,6 +318,49 @@ namespace Ogre
         const void* _getMemoryBlock(void) const;
         const void* _getMemoryUniqueOffset(void) const;
 
+        /** When evaluated on the GPU, our Bones are no longer updated on the CPU.
+            Set this to true if you still need them on the CPU (e.g. there's a TagPoint or
+            something attached to a bone, or you're querying bone positions) so that both
+            get evaluated for this instance.
+        @remarks
+            Has no effect if this instance isn't evaluated on the GPU.
+        */
+        void setCpuEvaluation( bool bCpuEvaluation )               { mCpuEvaluation = bCpuEvaluation; }
+        bool getCpuEvaluation(void) const                           { return mCpuEvaluation; }
+
+        /// Returns true if SceneManager must evaluate the animations of this instance on the CPU
+        bool _isEvaluatedOnCpu(void) const
+                            { return ( !mGpuEvaluator && !mBakedAnimation ) || mCpuEvaluation; }
+
+        /// The evaluator that animates us on the GPU. Null if evaluated on the CPU.
+        GpuSkeletonEvaluator* getGpuEvaluator(void) const           { return mGpuEvaluator; }
+
+        /// For internal use. @see GpuSkeletonEvaluator::addItem
+        void _setGpuEvaluator( GpuSkeletonEvaluator *evaluator )    { mGpuEvaluator = evaluator; }
+        void _setGpuBoneOffset( uint32 offset )                     { mGpuBoneOffset = offset; }
+        uint32 _getGpuBoneOffset(void) const                        { return mGpuBoneOffset; }
+
+        /** Selects which baked animation to play, and at which time.
+            Only used when animated by a BakedSkeletonAnimation. @see BakedSkeletonAnimation::addItem
+        @param animIdx
+            Index to the animation, @see BakedSkeletonAnimation::getAnimationIndex
+        @param time
+            Time in seconds.
+        */
+        void setBakedAnimation( uint32 animIdx, Real time=0 );
+        uint32 getBakedAnimationIdx(void) const                     { return mBakedAnimationIdx; }
+
+        /// Advances the time of the baked animation. Loops around at the end of the animation.
+        void addBakedAnimationTime( Real time )                     { mBakedAnimationTime += time; }
+        void setBakedAnimationTime( Real time )                     { mBakedAnimationTime = time; }
+        Real getBakedAnimationTime(void) const                      { return mBakedAnimationTime; }
+
+        /// The baked animation set that animates us. Null if not using baked animations.
+        BakedSkeletonAnimation* getBakedAnimationSet(void) const    { return mBakedAnimation; }
+
+        /// For internal use. @see BakedSkeletonAnimation::addItem
+        void _setBakedAnimationSet( BakedSkeletonAnimation *baked ) { mBakedAnimation = baked; }
+
         void _incrementRefCount(void);
         void _decrementRefCount(void);
         uint16 _getRefCount(void) const;
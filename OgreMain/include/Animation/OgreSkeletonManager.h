@@ -32,6 +32,7 @@ THE SOFTWARE.
 
 #include "OgreResourceManager.h"
 #include "OgreSingleton.h"
+#include "Animation/OgreSkeletonTrack.h"
 
 namespace Ogre {
 
@@ -52,6 +53,9 @@ namespace Ogre {
         typedef map<IdString, SkeletonDefPtr>::type SkeletonDefMap;
         SkeletonDefMap mSkeletonDefs;
 
+        bool                        mCompressAnimations;
+        KeyFrameCompressionSettings mAnimationCompression;
+
     public:
         /// Constructor
         SkeletonManager();
@@ -76,6 +80,19 @@ namespace Ogre {
         */
         void remove( const IdString &name );
 
+        /** When enabled, the keyframes of every SkeletonDef created from now on are
+            compressed as they get loaded from the v1 skeleton.
+            @see SkeletonAnimationDef::compress
+        @remarks
+            Skeletons that were already created are not affected.
+            Disabled by default.
+        */
+        void setAnimationCompression( bool bEnabled, const KeyFrameCompressionSettings &settings =
+                                                            KeyFrameCompressionSettings() );
+        bool getAnimationCompressionEnabled(void) const         { return mCompressAnimations; }
+        const KeyFrameCompressionSettings& getAnimationCompression(void) const
+                                                                { return mAnimationCompression; }
+
         /** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
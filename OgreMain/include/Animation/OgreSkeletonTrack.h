@@ -50,6 +50,32 @@ namespace Ogre
 
     typedef vector<KeyFrameRig>::type KeyFrameRigVec;
 
+    /// @see SkeletonAnimationDef::compress
+    struct KeyFrameCompressionSettings
+    {
+        /// Keyframes that can be reconstructed by interpolating their neighbours within
+        /// all these tolerances are removed. Set them to 0 to keep every keyframe.
+        /// In radians.
+        Real    maxRotationError;
+        /// In the bone's local space units.
+        Real    maxPositionError;
+        Real    maxScaleError;
+        /** When true, orientations are stored in 48 bits (smallest three: the largest
+            component is dropped & reconstructed) and positions & scales with 16 bits per
+            component, quantized to the range covered by each bone in the track.
+            The KfTransforms of the keyframes are released.
+        */
+        bool    quantize;
+
+        KeyFrameCompressionSettings() :
+            maxRotationError( 0.0005f ),
+            maxPositionError( 0.0001f ),
+            maxScaleError( 0.0001f ),
+            quantize( true )
+        {
+        }
+    };
+
     typedef FastArray<BoneTransform> TransformArray;
 
     class _OgreExport SkeletonTrack : public AnimationAlloc
@@ -80,6 +106,33 @@ namespace Ogre
 
         KfTransformArrayMemoryManager *mLocalMemoryManager;
 
+        /// Number of uint16 each keyframe takes in mQuantizedKeyFrames.
+        /// 0 if the track isn't quantized (the keyframes use KeyFrameRig::mBoneTransform)
+        uint32              mQuantizedStride;
+        bool                mQuantizedPosition;
+        bool                mQuantizedScale;
+        /** Dequantization parameters, per component per slot: value = min + quantized * step.
+            When a component doesn't change during the whole track its step is 0 and it
+            isn't stored per keyframe (i.e. mQuantizedPosition / mQuantizedScale are false)
+        */
+        Real                mPositionMin[3][ARRAY_PACKED_REALS];
+        Real                mPositionStep[3][ARRAY_PACKED_REALS];
+        Real                mScaleMin[3][ARRAY_PACKED_REALS];
+        Real                mScaleStep[3][ARRAY_PACKED_REALS];
+        /** Per keyframe:
+                uint16 orientation[ARRAY_PACKED_REALS][3];  smallest three
+                uint16 position[3][ARRAY_PACKED_REALS];     only if mQuantizedPosition
+                uint16 scale[3][ARRAY_PACKED_REALS];        only if mQuantizedScale
+        */
+        vector<uint16>::type mQuantizedKeyFrames;
+
+        /// Returns true if keyframe 'idx' can be interpolated from keyframes
+        /// 'prevIdx' & 'nextIdx' within the tolerances in settings.
+        bool isKeyFrameRedundant( size_t prevIdx, size_t idx, size_t nextIdx,
+                                  const KeyFrameCompressionSettings &settings ) const;
+
+        void dequantizeKeyFrame( size_t keyFrameIdx, KfTransform &outTransform ) const;
+
     public:
         SkeletonTrack( uint32 boneBlockIdx, KfTransformArrayMemoryManager *kfTransformMemoryManager );
         ~SkeletonTrack();
@@ -128,6 +181,27 @@ namespace Ogre
             mUsedSlots <= (ARRAY_PACKED_REALS >> 1). Otherwise it does nothing.
         */
         void _bakeUnusedSlots(void);
+
+        /** Removes the keyframes that can be reconstructed by interpolating the ones around it
+            within the given tolerances. The first and last keyframes are always kept.
+            The KfTransforms of the removed keyframes are not released, it's up to the
+            caller (@see SkeletonAnimationDef::compress)
+        @remarks
+            Must be called before any SkeletonAnimation referencing this track is created.
+        */
+        void _reduceKeyFrames( const KeyFrameCompressionSettings &settings );
+
+        /// Quantizes all keyframes @see KeyFrameCompressionSettings::quantize. After this call
+        /// KeyFrameRig::mBoneTransform is null and the memory can be released by the caller.
+        void _quantizeKeyFrames(void);
+
+        bool isQuantized(void) const                            { return mQuantizedStride != 0; }
+
+        /// Retrieves the transform of the given keyframe, regardless of it being quantized.
+        void getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const;
+
+        /// Bytes used by the keyframes of this track.
+        size_t getKeyFrameMemoryUsage(void) const;
     };
 
     typedef vector<SkeletonTrack>::type SkeletonTrackVec;
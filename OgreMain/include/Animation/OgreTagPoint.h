@@ -132,6 +132,20 @@ namespace Ogre {
         /// of another TagPoint, respecting non-uniform scaling.
         static void updateAllTransformsTagOnTag( const size_t numNodes, Transform t );
 
+        /** Same as updateAllTransformsTagOnTag, but instead of reading the derived transform
+            of the parents, it is rebuilt from the Bone of the root TagPoint and the local
+            transforms of every TagPoint in the chain.
+        @remarks
+            The derived transforms of the ancestors are not read, so all depth levels can
+            be updated at the same time (i.e. from different threads) without waiting for
+            the previous ones. Tag on tag chains are usually short, so the redundant math
+            costs less than the synchronization.
+        @param depth
+            Depth level of all the nodes in t. 0 is the same as updateAllTransformsBoneToTag.
+        */
+        static void updateAllTransformsFromBone( const size_t numNodes, Transform t,
+                                                 size_t depth );
+
         virtual TagPoint* createChildTagPoint( const Vector3& vPos = Vector3::ZERO,
                                                const Quaternion& qRot = Quaternion::IDENTITY );
     };
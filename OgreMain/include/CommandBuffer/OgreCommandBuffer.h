@@ -33,6 +33,39 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    /// Counters gathered by CommandBuffer::execute when redundant command
+    /// elimination is enabled. @see CommandBuffer::setRemoveRedundantCommands
+    struct CommandBufferStats
+    {
+        /// Commands actually sent to the RenderSystem, per category
+        size_t numPsoChanges;
+        size_t numShaderBufferBinds;
+        size_t numTextureBinds;
+        size_t numDrawCalls;
+        /// Sum of CbDrawCall::numDraws of the executed draw calls
+        size_t numDraws;
+        /// Binds that were skipped because they matched what was already bound
+        size_t numRemovedCommands;
+        /// Draw calls folded into the previous one (i.e. a single multi-draw)
+        size_t numMergedDrawCalls;
+
+        CommandBufferStats() :
+            numPsoChanges( 0 ), numShaderBufferBinds( 0 ), numTextureBinds( 0 ),
+            numDrawCalls( 0 ), numDraws( 0 ), numRemovedCommands( 0 ), numMergedDrawCalls( 0 ) {}
+
+        CommandBufferStats& operator += ( const CommandBufferStats &other )
+        {
+            numPsoChanges           += other.numPsoChanges;
+            numShaderBufferBinds    += other.numShaderBufferBinds;
+            numTextureBinds         += other.numTextureBinds;
+            numDrawCalls            += other.numDrawCalls;
+            numDraws                += other.numDraws;
+            numRemovedCommands      += other.numRemovedCommands;
+            numMergedDrawCalls      += other.numMergedDrawCalls;
+            return *this;
+        }
+    };
+
     /** Command Buffer implementation.
         This interface is very sensitive to performance. For this reason:
     @par
@@ -55,6 +88,40 @@ namespace Ogre
         RenderSystem    *mRenderSystem;
 
         FastArray<unsigned char>    mCommandBuffer;
+
+        bool                mRemoveRedundantCommands;
+        CommandBufferStats  mStats;
+
+        /// The range of the buffer a thread compacted in _removeRedundantCommands
+        struct CompactedRange
+        {
+            /// Byte offset where the surviving commands of the range end
+            size_t              end;
+            CommandBufferStats  stats;
+        };
+        typedef FastArray<CompactedRange> CompactedRangeVec;
+
+        /// One entry per thread, between _prepareParallelRemoveRedundantCommands & execute.
+        CompactedRangeVec   mCompactedRanges;
+        /// mCommandBuffer.size() when the ranges were split, to catch commands added later
+        size_t              mCompactedBufferSize;
+
+        /** Walks the commands in [cmdBase; cmdBaseEnd), compacting them in place.
+            Skips binds that match the state already set by a previous command in
+            the range, and merges draw calls whose indirect entries are contiguous.
+        @return
+            The new end of the range.
+        */
+        static unsigned char* removeRedundantCommands( unsigned char *cmdBase,
+                                                       unsigned char *cmdBaseEnd,
+                                                       CommandBufferStats &outStats );
+
+        /// Byte range [outBegin; outEnd) of mCommandBuffer processed by the given thread
+        void getThreadRange( size_t threadIdx, size_t numThreads,
+                             size_t &outBegin, size_t &outEnd ) const;
+        /// Moves the surviving commands of each range after the previous one's
+        void joinCompactedRanges(void);
+
     public:
         CommandBuffer();
 
@@ -101,6 +168,54 @@ namespace Ogre
         /// Executes all the commands in the command buffer. Clears the cmd buffer afterwards
         void execute(void);
 
+        /** When enabled, execute() first walks the whole buffer and drops the
+            commands that would not change the RenderSystem's state (same PSO,
+            same const/tex buffer range on the same stage & slot, same texture,
+            sampler or descriptor set on the same unit), then merges consecutive
+            draw calls that share the Vao & command type, and whose indirect
+            entries are contiguous, into a single multi-draw.
+        @remarks
+            Hlms implementations already avoid most redundant binds while recording,
+            but what they record can't see past a PSO change or a different Hlms.
+            The tracked state is reset on v1 legacy rendering and low level
+            materials, as those talk to the RenderSystem directly.
+        @par
+            A slot is assumed to be shared by all stages (as in GL3+), and tex buffers
+            to share their units with textures: a bind is only dropped if the last bind
+            to that slot, on any stage, was the exact same one.
+        @par
+            The pass assumes the RenderSystem keeps its bindings for the whole
+            execution. Disabled by default. It must run after
+            Hlms::preCommandBufferExecution has patched its commands, hence it
+            happens inside execute(), unless _removeRedundantCommands already ran.
+        */
+        void setRemoveRedundantCommands( bool bRemove )     { mRemoveRedundantCommands = bRemove; }
+        bool getRemoveRedundantCommands(void) const         { return mRemoveRedundantCommands; }
+
+        /// Statistics accumulated across execute() calls since the last resetStats.
+        /// Only gathered while setRemoveRedundantCommands is enabled.
+        const CommandBufferStats& getStats(void) const      { return mStats; }
+        void resetStats(void)                               { mStats = CommandBufferStats(); }
+
+        /** Splits the buffer so that the redundant command elimination runs on numThreads
+            threads at once, right before execute(). Main thread only.
+        @remarks
+            Each thread compacts its own contiguous range. A range knows nothing about
+            what the previous one left bound, so each one keeps its first binds and
+            can't merge its first draw into the previous range's last one. execute()
+            then moves the ranges together and only issues the commands.
+        @par
+            No commands may be added between this call and execute().
+        @return
+            False if there's nothing to gain (the elimination is disabled, or there are too
+            few commands); then don't call _removeRedundantCommands and execute() does it all.
+        */
+        bool _prepareParallelRemoveRedundantCommands( size_t numThreads );
+
+        /// Compacts the range of the buffer belonging to threadIdx.
+        /// @see _prepareParallelRemoveRedundantCommands. Called from each worker thread.
+        void _removeRedundantCommands( size_t threadIdx, size_t numThreads );
+
         /// Creates/Records a command already casted to the typename.
         /// May invalidate returned pointers from previous calls.
         template <typename T>
@@ -127,6 +242,16 @@ namespace Ogre
         /// Returns null if no such command at that offset (out of bounds).
         /// @see getCommandOffset.
         CbBase* getCommandFromOffset( size_t offset );
+
+        /// Size in bytes of every command in the stream
+        static size_t getCommandSize(void)                  { return COMMAND_FIXED_SIZE; }
+
+        /// Raw access to the recorded commands. Used by CompositorFrameCapture
+        const FastArray<unsigned char>& _getCommandStream(void) const  { return mCommandBuffer; }
+
+        /// Appends commands previously obtained from _getCommandStream.
+        /// sizeBytes must be a multiple of getCommandSize.
+        void _appendCommandStream( const unsigned char *commands, size_t sizeBytes );
     };
 }
 
@@ -0,0 +1,208 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreCompositorFrameCapture_H_
+#define _OgreCompositorFrameCapture_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreVector4.h"
+#include "OgreFastArray.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    struct QueuedRenderable;
+    class CompositorPass;
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    /** Records everything the compositor sends to the RenderSystem during one frame, so that
+        it can be replayed again (and again) without updating the scene.
+    @remarks
+        Call requestCapture; the next CompositorManager2::_update will be recorded:
+            * Every pass that begins a render pass (its RenderPassDescriptor & viewports).
+            * The sorted contents of the RenderQueue each pass rendered.
+            * The CommandBuffer commands, after the Hlms have patched them (i.e. what
+              CommandBuffer::execute receives).
+            * A copy of the indirect draw data; so replays draw exactly the same.
+    @par
+        Everything else (VAOs, PSOs, const/tex buffers & textures) is stored by reference. Their
+        contents at replay time will be used; and the capture must be cleared before destroying
+        them (or the workspaces that were captured).
+    @par
+        While replay is enabled, CompositorManager2::_update replays the capture instead of
+        updating the workspaces. This isolates the cost of submitting a frame's commands,
+        useful for A/B timing of RenderSystem settings (e.g. redundant command removal) or of
+        engine versions with the same scene.
+    @par
+        Not captured: passes that don't render through the RenderQueue's CommandBuffer
+        (i.e. compute, UAV, quad passes which use RenderQueue::renderSingleObject, and
+        RenderQueue::V1_LEGACY queues), and resource transitions (barriers).
+    */
+    class _OgreExport CompositorFrameCapture : public CompositorInstAlloc
+    {
+    public:
+        struct Pass
+        {
+            String                  workspaceName;
+            String                  nodeName;
+            /// See CompositorPassType
+            uint32                  passType;
+            /// CompositorPassDef::mIdentifier
+            uint32                  identifier;
+
+            RenderPassDescriptor    *renderPassDesc;
+            TextureGpu              *anyTargetTexture;
+            uint8                   anyMipLevel;
+            uint32                  numViewports;
+            Vector4                 vpSize[16];
+            Vector4                 scissors[16];
+            bool                    includeOverlays;
+
+            /// Range [start; end) in getRenderQueueEntries
+            size_t  rqEntryStart;
+            size_t  rqEntryEnd;
+            /// Range [start; end) of the captured commands, in bytes
+            size_t  cmdStart;
+            size_t  cmdEnd;
+        };
+
+        struct RenderQueueEntry
+        {
+            /// QueuedRenderable::hash, i.e. the sort key
+            uint64              hash;
+            Renderable          *renderable;
+            MovableObject const *movableObject;
+            /// 0 if it's a v1 object
+            uint32              vaoName;
+            uint8               renderQueueId;
+            bool                casterPass;
+        };
+
+        typedef vector<Pass>::type              PassVec;
+        typedef vector<RenderQueueEntry>::type  RenderQueueEntryVec;
+
+    protected:
+        struct IndirectSegment
+        {
+            /// The RenderQueue's buffer, which gets overwritten every frame
+            IndirectBufferPacked    *original;
+            size_t                  originalStart;
+            /// Holds a copy of the data
+            IndirectBufferPacked    *replayBuffer;
+        };
+
+        typedef vector<IndirectSegment>::type IndirectSegmentVec;
+
+        RenderSystem    *mRenderSystem;
+
+        bool    mCaptureRequested;
+        bool    mCapturing;
+        bool    mReplayEnabled;
+        bool    mReplayRemoveRedundantCommands;
+
+        PassVec                 mPasses;
+        RenderQueueEntryVec     mRenderQueueEntries;
+        FastArray<unsigned char> mCommands;
+        IndirectSegmentVec      mIndirectSegments;
+
+        CommandBuffer   *mReplayCommandBuffer;
+        uint64          mLastReplayTime;
+
+        void closeCurrentPass(void);
+
+    public:
+        CompositorFrameCapture( RenderSystem *renderSystem );
+        ~CompositorFrameCapture();
+
+        /// Discards the current capture (if any) and records the next frame.
+        void requestCapture(void);
+        bool isCapturing(void) const                            { return mCapturing; }
+        bool hasCapture(void) const             { return !mCapturing && !mPasses.empty(); }
+
+        /// Discards the capture. Must be called before destroying anything it references.
+        void clear(void);
+
+        /// When true, CompositorManager2 replays the capture every frame instead of
+        /// updating the workspaces. Ignored while there's no capture.
+        void setReplayEnabled( bool bEnabled )                  { mReplayEnabled = bEnabled; }
+        bool getReplayEnabled(void) const                       { return mReplayEnabled; }
+
+        /// Whether the replay removes redundant commands before executing them.
+        /// See CommandBuffer::setRemoveRedundantCommands. Commands are always captured
+        /// before removal, so the same capture can be timed with & without it.
+        void setReplayRemoveRedundantCommands( bool bRemove );
+        bool getReplayRemoveRedundantCommands(void) const { return mReplayRemoveRedundantCommands; }
+
+        /// CPU time in microseconds spent by the last replay
+        uint64 getLastReplayTime(void) const                    { return mLastReplayTime; }
+
+        const PassVec& getPasses(void) const                    { return mPasses; }
+        const RenderQueueEntryVec& getRenderQueueEntries(void) const { return mRenderQueueEntries; }
+        size_t getNumCommands(void) const;
+
+        /// Dumps the passes, their RenderQueue contents and commands (type & counts)
+        /// so that captures can be compared offline.
+        void dumpJson( String &outJson ) const;
+
+        /// Called by CompositorManager2
+        void _notifyFrameBegin(void);
+        void _notifyFrameEnd(void);
+        /// Called by CompositorPass when it begins its render pass
+        void _notifyPassBegin( const CompositorPass *pass, RenderPassDescriptor *renderPassDesc,
+                               TextureGpu *anyTargetTexture, uint8 anyMipLevel,
+                               const Vector4 *vpSize, const Vector4 *scissors,
+                               uint32 numViewports );
+        /// Called by RenderQueue, once sorted
+        void _addRenderQueueEntries( uint8 renderQueueId, const QueuedRenderable *begin,
+                                     const QueuedRenderable *end, bool casterPass );
+        /// Called by RenderQueue before unmapping its indirect buffer
+        void _addIndirectData( IndirectBufferPacked *indirectBuffer,
+                               const unsigned char *data, size_t sizeBytes );
+        /// Called by RenderQueue right before executing its CommandBuffer
+        void _addCommands( const CommandBuffer *commandBuffer );
+
+        /// Re-executes the captured passes & commands. Called by CompositorManager2
+        /// in place of updating the workspaces.
+        void _replay(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
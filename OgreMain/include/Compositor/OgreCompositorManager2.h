@@ -50,6 +50,7 @@ namespace Ogre
         class Rectangle2D;
     }
     class CompositorPassProvider;
+    class CompositorFrameCapture;
 
     typedef vector<TextureGpu*>::type TextureGpuVec;
     typedef vector<UavBufferPacked*>::type UavBufferPackedVec;
@@ -152,6 +153,8 @@ namespace Ogre
         /// For custom passes.
         CompositorPassProvider  *mCompositorPassProvider;
 
+        CompositorFrameCapture  *mFrameCapture;
+
         void addQueuedWorkspaces(void);
 
     public:
@@ -410,6 +413,10 @@ namespace Ogre
         void setCompositorPassProvider( CompositorPassProvider *passProvider );
         CompositorPassProvider* getCompositorPassProvider(void) const;
 
+        /// Records a frame's passes & render commands to replay them later.
+        /// See CompositorFrameCapture
+        CompositorFrameCapture* getFrameCapture(void) const     { return mFrameCapture; }
+
         void addListener( CompositorWorkspaceListener *listener );
         void removeListener( CompositorWorkspaceListener *listener );
 
@@ -108,6 +108,12 @@ namespace Ogre
         /// Contains pointers that are ither in mInTextures or mLocalTextures
         CompositorChannelVec    mOutTextures;
 
+        /// When the workspace aliases transient textures, mLocalTextures[i] may belong to
+        /// another node. mAliasedLocalTextures[i] then holds the texture we created (kept
+        /// OnStorage so it doesn't use GPU memory) until _removeTextureAliases.
+        /// Empty if none of our textures is aliased, null entries for those that aren't.
+        CompositorChannelVec    mAliasedLocalTextures;
+
         size_t                      mNumConnectedBufferInputs;
         CompositorNamedBufferVec    mBuffers;
 
@@ -126,6 +132,10 @@ namespace Ogre
         */
         void routeOutputs();
 
+        /// Puts back our own textures in mLocalTextures.
+        /// See mAliasedLocalTextures. Doesn't make them resident.
+        void restoreAliasedTextures(void);
+
         /** Disconnects this node's output from all nodes we send our textures to. We only
             disconnect local textures.
         @remarks
@@ -220,6 +230,8 @@ namespace Ogre
         bool areAllInputsConnected() const;
         const CompositorChannelVec& getInputChannel() const         { return mInTextures; }
         const CompositorChannelVec& getLocalTextures() const        { return mLocalTextures; }
+        /// Input and local buffers
+        const CompositorNamedBufferVec& getBuffers() const          { return mBuffers; }
 
         /** Returns the texture pointer of a texture based on it's name & mrt index.
         @remarks
@@ -320,6 +332,23 @@ namespace Ogre
         */
         void _notifyCleared(void);
 
+        /** Internal Use. Makes our local texture use sharedTexture, which belongs to an
+            earlier node and whose definition is identical. Our own texture stays OnStorage.
+            @see CompositorWorkspaceDef::setAliasTransientTextures
+        @remarks
+            Nodes that received the old texture through their inputs must be
+            updated with _replaceInputTexture.
+        */
+        void _aliasLocalTexture( size_t localTextureIdx, TextureGpu *sharedTexture );
+
+        /// Internal Use. Replaces oldTexture with newTexture in our input channels
+        /// (and outputs routed from them). @see _aliasLocalTexture
+        void _replaceInputTexture( TextureGpu *oldTexture, TextureGpu *newTexture );
+
+        /// Internal Use. Undoes all _aliasLocalTexture calls, making our textures resident again.
+        /// Called by _notifyCleared; all nodes must have their connections cleared too.
+        void _removeTextureAliases(void);
+
         /** Called by CompositorManager2 when (i.e.) the RenderWindow was resized, thus our
             RTs that depend on their resolution need to be recreated.
         @remarks
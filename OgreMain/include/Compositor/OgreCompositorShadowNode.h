@@ -111,6 +111,25 @@ namespace Ogre
             Real                    minDistance;
             Real                    maxDistance;
             Vector2                 scenePassesViewportSize[Light::NUM_LIGHT_TYPES];
+
+            /// Only used if there are passes with CompositorPassDef::mShadowMapCache
+            /// tied to this shadow map. Name of the texture they render to.
+            IdString                cacheTextureName;
+            bool                    hasCache;
+            /// When true the cache passes will be executed in the next update
+            bool                    cacheDirty;
+            /// State of the light & shadow camera when the cache was last rendered
+            Light const             *cachedLight;
+            Vector3                 cachedPosition;
+            Quaternion              cachedOrientation;
+            Vector4                 cachedProjParams;
+
+            /// State when the shadow map was last rendered. @see setDistantLightsUpdateInterval
+            Light const             *lastRenderedLight;
+            Camera const            *lastRenderedCamera;
+            size_t                  lastRenderedFrame;
+            /// When true the shadow map is skipped this frame, keeping its old contents
+            bool                    throttled;
         };
 
         typedef vector<ShadowMapCamera>::type ShadowMapCameraVec;
@@ -130,6 +149,8 @@ namespace Ogre
         /// the types the shadow map supports could be assigned at this slot)
         LightClosestArray       mShadowMapCastingLights;
         vector<size_t>::type    mTmpSortedIndexes;
+        /// Shadow mapping cameras to cull together. @see SceneManager::setBatchedShadowCulling
+        FastArray<Camera const*> mBatchedCullCameras;
 
         /** Cached value. Contains the aabb of all caster-only objects (filtered by
             camera's visibility flags) from the minimum RQ used by our shadow render
@@ -140,6 +161,12 @@ namespace Ogre
 
         LightsBitSet            mAffectedLights;
 
+        /// @see setSortLightsByScreenCoverage
+        bool                    mSortLightsByScreenCoverage;
+        /// @see setDistantLightsUpdateInterval
+        Real                    mDistantLightsMinDistance;
+        uint32                  mDistantLightsUpdateInterval;
+
         /// Changes with each call to setShadowMapsToPass
         LightList               mCurrentLightList;
 
@@ -177,6 +204,17 @@ namespace Ogre
                                                    size_t * RESTRICT_ALIAS inOutStartIdx,
                                                    size_t * RESTRICT_ALIAS outEntryToUse ) const;
 
+        /// Returns true if the shadow camera moved (or changed its projection) enough
+        /// since the cache was last rendered that the cached depth can no longer be used.
+        static bool isShadowMapCacheStale( const ShadowMapCamera &smCamera, const Light *light,
+                                           const Vector2 &vpRealSize );
+        static Vector4 getShadowMapCacheProjParams( const Camera *texCamera );
+
+        /// Returns true if the shadow map can skip this frame because its light is far
+        /// and it was rendered recently enough. @see setDistantLightsUpdateInterval
+        bool isShadowMapUpdateThrottled( const ShadowMapCamera &smCamera, const Light *light,
+                                         const Camera *camera ) const;
+
         void clearShadowCastingLights( const LightListInfo &globalLightList );
         void restoreStaticShadowCastingLights( const LightListInfo &globalLightList );
 
@@ -213,6 +251,10 @@ namespace Ogre
 
         bool _shouldUpdateShadowMapIdx( uint32 shadowMapIdx ) const;
 
+        /// Returns true if the passes that render the cache of the given shadow
+        /// map (see CompositorPassDef::mShadowMapCache) need to be executed.
+        bool _shouldUpdateShadowMapCache( uint32 shadowMapIdx ) const;
+
         /// Do not call this if isShadowMapIdxActive == false or isShadowMapIdxInValidRange == false
         uint8 getShadowMapLightTypeMask( uint32 shadowMapIdx ) const;
 
@@ -336,6 +378,51 @@ namespace Ogre
         /// to call it for every shadow map (otherwise you will trigger a O(N^2) behavior).
         void setStaticShadowMapDirty( size_t shadowMapIdx, bool includeLinked=true );
 
+        /** Tags the cache of a shadow map as dirty, causing Ogre to execute its cache passes
+            (see CompositorPassDef::mShadowMapCache) the next time this Shadow node gets executed.
+        @remarks
+            Ogre already invalidates the cache when the light assigned to the shadow map
+            changes, or when the shadow camera moves more than half a texel (e.g. when not
+            using stable PSSM splits, caching directional lights will be of little use).
+            However Ogre doesn't know what's in the cache, thus you must call this function
+            when a static caster is added, removed or moved.
+            Shadow maps sharing the same cache texture (i.e. UV atlas) are invalidated
+            together.
+        */
+        void setShadowMapCacheDirty( size_t shadowMapIdx );
+
+        /** By default point & spot lights get their shadow maps assigned by distance to the
+            camera (the closest light gets the first available shadow map). When true, lights
+            are sorted by their approximate screen coverage instead (bounding radius divided
+            by distance), so that a big light slightly farther away is preferred over a
+            small one that is closer.
+        @remarks
+            Combine it with shadow maps of decreasing resolution (assigned in the order they
+            were defined) so that the lights covering more of the screen get a bigger region
+            of the atlas, and small or distant lights get the smaller ones.
+        */
+        void setSortLightsByScreenCoverage( bool bSort );
+        bool getSortLightsByScreenCoverage(void) const  { return mSortLightsByScreenCoverage; }
+
+        /** Point & spot lights farther than minDistance from the camera (measured to the
+            edge of their range) only get their shadow maps updated every numFrames frames.
+            The rest of the frames the shadow map keeps its contents and shadow camera.
+        @remarks
+            Shadow maps are always updated immediately if a different light or camera gets
+            assigned to them. Static shadow maps (see setLightFixedToShadowMap) and
+            directional lights are not affected.
+        @par
+            Like static shadow maps, skipped shadow maps must not share a texture with
+            shadow maps that get cleared every frame; since clears affect the whole texture.
+        @param minDistance
+            Distance beyond which lights are considered distant.
+        @param numFrames
+            How often distant shadow maps get updated. Use 1 to update every frame (default).
+        */
+        void setDistantLightsUpdateInterval( Real minDistance, uint32 numFrames );
+        Real getDistantLightsMinDistance(void) const        { return mDistantLightsMinDistance; }
+        uint32 getDistantLightsUpdateInterval(void) const   { return mDistantLightsUpdateInterval; }
+
         /// @copydoc CompositorNode::finalTargetResized
         virtual void finalTargetResized01( const TextureGpu *finalTarget );
     };
@@ -89,6 +89,17 @@ namespace Ogre
         bool                    mValid;
         bool                    mEnabled;
         bool                    mAmalgamatedProfiling;
+        bool                    mCpuTiming;
+        /// Microseconds, @see setCpuTiming
+        uint64                  mLastUpdateCpuTime;
+
+        bool                    mDynamicResolution;
+        Real                    mDynamicResolutionScale;
+        Real                    mDynamicResolutionMinScale;
+        Real                    mTargetGpuFrameTime;
+        /// Sorted. Textures sized relative to the final target; passes rendering
+        /// to them use mDynamicResolutionScale when mDynamicResolution is on.
+        vector<TextureGpu*>::type mDynamicResolutionTextures;
 
         CompositorWorkspaceListenerVec mListeners;
 
@@ -117,6 +128,12 @@ namespace Ogre
         ResourceLayoutMap       mResourcesLayout;
         ResourceAccessMap       mUavsAccess;
 
+        /// Resources used by async compute passes no pass has waited for yet.
+        /// Only valid while analyzing hazards.
+        vector<GpuTrackedResource*>::type mPendingAsyncResources;
+        /// True if async compute work may still be running after the last pass
+        bool                    mWaitForAsyncComputeAtEnd;
+
         /// Creates all the node instances from our definition
         void createAllNodes(void);
 
@@ -133,6 +150,19 @@ namespace Ogre
         */
         void connectAllNodes(void);
 
+        /** Makes local textures whose lifetimes don't overlap share the same TextureGpu.
+            @see CompositorWorkspaceDef::setAliasTransientTextures
+        @remarks
+            Must be called after connecting the nodes in mNodeSequence
+            (which must be in execution order) and before creating their passes.
+        */
+        void aliasTransientTextures(void);
+
+        /// Rebuilds mDynamicResolutionTextures
+        void updateDynamicResolutionTextures(void);
+        /// Moves mDynamicResolutionScale towards meeting mTargetGpuFrameTime
+        void updateDynamicResolutionScale(void);
+
         void clearAllConnections(void);
 
         /** Setup ShadowNodes in every pass from every node so that we recalculate them as
@@ -145,6 +175,9 @@ namespace Ogre
 
         void analyzeHazardsAndPlaceBarriers(void);
 
+        /// Sets CompositorPass::getLastCpuTime of every pass to 0
+        void resetPassesCpuTime(void);
+
         CompositorNode* getLastEnabledNode(void);
 
     public:
@@ -175,12 +208,82 @@ namespace Ogre
             This is useful if you want to know how much (e.g.) frustum culling
             is taking overall (all passes combined) rather than knowing how
             much frustum culling is taking for each pass.
+        @par
+            It also affects the GpuProfiler (which doesn't need OGRE_PROFILING):
+            when true a single GPU sample covers the whole workspace
+            instead of one sample per pass.
         @param bEnabled
             True to collapse all per-pass info into a global one. Default is false.
         */
         void setAmalgamatedProfiling( bool bEnabled )       { mAmalgamatedProfiling = bEnabled; }
         bool getAmalgamatedProfiling(void) const            { return mAmalgamatedProfiling; }
 
+        /** When enabled, _update measures how much CPU time the whole workspace
+            and each of its passes takes (see getLastUpdateCpuTime and
+            CompositorPass::getLastCpuTime). Unlike OGRE_PROFILING, this is always
+            available and can be toggled at runtime.
+        @remarks
+            Pass times are inclusive: a scene pass includes the time spent updating
+            its shadow node.
+        @param bEnabled
+            True to measure. Default is false.
+        */
+        void setCpuTiming( bool bEnabled );
+        bool getCpuTiming(void) const                       { return mCpuTiming; }
+        /// CPU time spent in the last _update, in microseconds. 0 if setCpuTiming is off.
+        uint64 getLastUpdateCpuTime(void) const             { return mLastUpdateCpuTime; }
+
+        /** Writes the resolved frame graph of this workspace as JSON, meant for
+            offline analysis and for diffing compositor setups.
+        @remarks
+            The output contains every node (shadow nodes included) in execution order,
+            their local textures and buffers, and for each pass: its type, the textures
+            it renders to and reads from, the resources it writes, the barriers /
+            resource transitions that were placed before it, whether it runs on the
+            async compute queue, and its last CPU cost (if setCpuTiming is on) and
+            GPU cost (if the RenderSystem's GpuProfiler is enabled and
+            getAmalgamatedProfiling is off).
+        @par
+            GPU costs come from the most recent frame the GpuProfiler finished reading
+            back, thus they may lag a few frames behind the CPU costs.
+        @param outJson [out]
+            The JSON is appended to this string.
+        */
+        void dumpFrameGraph( String &outJson ) const;
+
+        /** Enables dynamic resolution. Textures sized relative to the final target (i.e.
+            target_width, target_height_scaled, etc) are still allocated at full size, but
+            passes rendering to them only draw into a sub-rectangle of
+            getDynamicResolutionScale() times their size. Changing the scale is free;
+            nothing gets reallocated.
+        @remarks
+            Quad passes reading from these textures get their UVs scaled to sample just the
+            valid area. Hence the quad pass that reads them while rendering to the final
+            target performs the upscale. Shaders sampling them by other means (e.g. compute
+            jobs, materials in scene passes) must account for the scale themselves.
+        @par
+            The scale is automatically adjusted every frame using the GPU frame time
+            reported by the GpuProfiler (which gets enabled if it wasn't).
+            Call setDynamicResolutionScale afterwards to start from a given value.
+        @param bEnabled
+            True to enable. When disabled everything renders at full resolution.
+        @param targetGpuFrameTimeMs
+            GPU time per frame, in milliseconds, to aim for.
+        @param minScale
+            The scale won't go below this value. In range (0; 1]
+        */
+        void setDynamicResolution( bool bEnabled, Real targetGpuFrameTimeMs=16.0f,
+                                   Real minScale=0.5f );
+        bool getDynamicResolution(void) const               { return mDynamicResolution; }
+
+        /// Sets the current scale. It will keep being adjusted if dynamic resolution is on.
+        void setDynamicResolutionScale( Real scale );
+        Real getDynamicResolutionScale(void) const          { return mDynamicResolutionScale; }
+
+        /// Returns the scale passes rendering to (or reading from) the
+        /// given texture must use. 1 when it's not affected by dynamic resolution.
+        Real _getDynamicResolutionScale( const TextureGpu *texture ) const;
+
         /// @deprecated use addListener and removeListener instead
         void setListener( CompositorWorkspaceListener *listener );
         /// @deprecated use getListeners instead
@@ -362,6 +465,16 @@ namespace Ogre
 
         void _notifyBarriersDirty(void)                     { mBarriersDirty = true; }
 
+        /** Called by CompositorNode after placing the barriers of each pass. Decides if the
+            pass goes to the async compute queue, and whether it must wait for previous
+            async compute passes because it uses their resources.
+        @remarks
+            Does nothing unless the RenderSystem supports RSC_ASYNC_COMPUTE.
+        */
+        void _trackAsyncCompute( CompositorPass *pass, const BoundUav boundUavs[64] );
+
+        const CompositorWorkspaceDef* getDefinition(void) const     { return mDefinition; }
+
         /// Gets the compositor manager (non const)
         CompositorManager2* getCompositorManager();
 
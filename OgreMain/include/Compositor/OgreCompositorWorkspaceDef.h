@@ -93,6 +93,8 @@ namespace Ogre
 
         CompositorManager2  *mCompositorManager;
 
+        bool                mAliasTransientTextures;
+
         /** Checks if nodeName is already aliased (whether explicitly or implicitly). If not,
             checks whether the name of the node corresponds to an actual Node definition.
             If so, creates the implicit alias; otherwise throws
@@ -131,6 +133,24 @@ namespace Ogre
         IdString getName(void) const                                { return mName; }
         String getNameStr(void) const                               { return mNameStr; }
 
+        /** When enabled, local textures of different nodes share the same TextureGpu if
+            their definitions are identical and their lifetimes don't overlap, reducing
+            memory consumption.
+        @remarks
+            Lifetimes are evaluated per node, in execution order: a local texture lives from
+            its node until the last node that receives it through an input channel.
+            The contents of an aliased texture are undefined when its node begins, hence
+            textures that must keep their contents across frames need
+            TextureDefinition::preserveContent (keep_content in scripts).
+            Code that fetches local textures by name (e.g. CompositorNode::getDefinedTexture)
+            may get a texture that is shared with other nodes.
+        @par
+            Takes effect the next time the workspace's nodes are connected (i.e. on creation).
+            Default is false.
+        */
+        void setAliasTransientTextures( bool bAlias )               { mAliasTransientTextures = bAlias; }
+        bool getAliasTransientTextures(void) const                  { return mAliasTransientTextures; }
+
         /** Connects outNode's output channel to inNode's input channel.
         @remarks
             This mapping will later be used to know how connections should be done when
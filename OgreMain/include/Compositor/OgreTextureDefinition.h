@@ -128,6 +128,12 @@ namespace Ogre
             bool            preferDepthTexture;
             PixelFormatGpu  depthBufferFormat;
 
+            /// When the workspace aliases transient textures
+            /// (see CompositorWorkspaceDef::setAliasTransientTextures), textures with this
+            /// set never share memory with others. Set it when the contents must survive
+            /// until the next frame (e.g. history buffers of temporal effects).
+            bool            preserveContent;
+
             /// Do not call directly. @see TextureDefinition::renameTexture instead.
             void _setName( IdString newName )   { name = newName; }
             IdString getName(void) const        { return name; }
@@ -137,7 +143,8 @@ namespace Ogre
                     widthFactor( 1.0f ), heightFactor( 1.0f ),
                     format( PFG_UNKNOWN ), fsaa( "1" ),
                     textureFlags( TextureFlags::RenderToTexture ),
-                    depthBufferId( 1u ), preferDepthTexture( false ), depthBufferFormat( PFG_UNKNOWN ) {}
+                    depthBufferId( 1u ), preferDepthTexture( false ), depthBufferFormat( PFG_UNKNOWN ),
+                    preserveContent( false ) {}
         };
         typedef vector<TextureDefinition>::type     TextureDefinitionVec;
 
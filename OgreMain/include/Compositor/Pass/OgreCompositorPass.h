@@ -73,6 +73,8 @@ namespace Ogre
         ResourceAccess::ResourceAccess  boundAccess;
     };
 
+    typedef vector<GpuTrackedResource*>::type GpuTrackedResourceVec;
+
     /** Abstract class for compositor passes. A pass can be a fullscreen quad, a scene
         rendering, a clear. etc.
         Derived classes are responsible for performing an actual job.
@@ -101,7 +103,9 @@ namespace Ogre
 
         CompositorTextureVec    mTextureDependencies;
 
+    public:
         typedef vector<ResourceTransition>::type ResourceTransitionVec;
+    protected:
         ResourceTransitionVec   mResourceTransitions;
         /// In OpenGL, only the first entry in mResourceTransitions contains a real
         /// memory barrier. The rest is just kept for debugging purposes. So
@@ -110,6 +114,26 @@ namespace Ogre
         /// mNumValidResourceTransitions = mResourceTransitions.size()
         uint32                  mNumValidResourceTransitions;
 
+        /// True if this pass is submitted to the async compute queue.
+        /// @see CompositorPassDef::mAsyncCompute
+        bool                    mAsyncCompute;
+        /// True if this pass uses resources from async compute passes
+        /// and must wait for them before executing.
+        bool                    mWaitForAsyncCompute;
+
+        /// Resources this pass writes to. @see _updateWrittenResources
+        GpuTrackedResourceVec   mWrittenResources;
+        bool                    mWritesToRenderWindow;
+        /// True if the output of the last execution can be reused (@see mCacheResult)
+        bool                    mResultCacheValid;
+        Real                    mCachedDynResScale;
+        /// Content versions of mTextureDependencies followed by mWrittenResources,
+        /// as they were right after the last execution
+        vector<uint32>::type    mCachedContentVersions;
+
+        /// Microseconds. @see CompositorWorkspace::setCpuTiming
+        uint64                  mLastCpuTime;
+
         /// MUST be called by derived class.
         void initialize( const RenderTargetViewDef *rtv, bool supportsNoRtv=false );
 
@@ -146,6 +170,9 @@ namespace Ogre
         /// See https://forums.ogre3d.org/viewtopic.php?p=548046#p548046
         void setViewportSizeToViewport( size_t vpIdx, Viewport *outVp );
         void setRenderPassDescToCurrent(void);
+        /// Same as setRenderPassDescToCurrent(void), but begins the given descriptor instead of
+        /// mRenderPassDesc. It must have been set up with the same targets' resolution.
+        void setRenderPassDescToCurrent( RenderPassDescriptor *renderPassDesc );
 
         void populateTextureDependenciesFromExposedTextures(void);
 
@@ -193,6 +220,51 @@ namespace Ogre
                                                            ResourceLayoutMap &resourcesLayout );
         void _removeAllBarriers(void);
 
+        /// Returns true if the pass can be submitted to the async compute queue
+        /// (i.e. it doesn't issue graphics commands)
+        virtual bool _canRunAsyncCompute(void) const                { return false; }
+
+        /** Adds to outResources every resource this pass is known to read or write:
+            its render targets, its texture dependencies and its UAVs.
+        @param boundUavs
+            The UAVs bound at this point of the execution.
+            @see _placeBarriersAndEmulateUavExecution
+        */
+        virtual void _getAccessedResources( const BoundUav boundUavs[64],
+                                            GpuTrackedResourceVec &outResources ) const;
+
+        /// Adds to outResources every resource this pass writes to.
+        virtual void _getWrittenResources( const BoundUav boundUavs[64],
+                                           GpuTrackedResourceVec &outResources ) const;
+        /// Called by CompositorNode while analyzing hazards. Fills mWrittenResources
+        void _updateWrittenResources( const BoundUav boundUavs[64] );
+        /// Resources this pass writes to, as of the last time barriers were placed.
+        const GpuTrackedResourceVec& getWrittenResources(void) const { return mWrittenResources; }
+
+        /// Returns true if the pass can be skipped because it has mCacheResult
+        /// and nothing it depends on changed since it last executed.
+        virtual bool _isResultCacheValid(void) const;
+        /// Must be called after executing the pass. Tags mWrittenResources
+        /// as modified and remembers the state the output depends on.
+        virtual void _notifyExecuted(void);
+        /// Forces the pass to execute next time, even if it has mCacheResult
+        void invalidateResultCache(void)                            { mResultCacheValid = false; }
+
+        /// CPU time the last execution took, in microseconds. 0 if the pass was skipped
+        /// during the last workspace update or CompositorWorkspace::setCpuTiming is off.
+        uint64 getLastCpuTime(void) const                           { return mLastCpuTime; }
+        void _setLastCpuTime( uint64 cpuTime )                      { mLastCpuTime = cpuTime; }
+
+        /// Transitions placed before this pass executes. @see mNumValidResourceTransitions
+        const ResourceTransitionVec& getResourceTransitions(void) const
+                                                                    { return mResourceTransitions; }
+        uint32 getNumValidResourceTransitions(void) const   { return mNumValidResourceTransitions; }
+
+        /// Called by CompositorWorkspace while analyzing hazards
+        void _setAsyncCompute( bool asyncCompute, bool waitForAsyncCompute );
+        bool isAsyncCompute(void) const                             { return mAsyncCompute; }
+        bool getWaitForAsyncCompute(void) const                     { return mWaitForAsyncCompute; }
+
         /// @See CompositorNode::notifyRecreated
         virtual bool notifyRecreated( const TextureGpu *channel );
         virtual void notifyRecreated( const UavBufferPacked *oldBuffer, UavBufferPacked *newBuffer );
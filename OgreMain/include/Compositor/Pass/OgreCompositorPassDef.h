@@ -174,6 +174,27 @@ namespace Ogre
         /// the GPU starts too late after sitting idle.
         bool                mFlushCommandBuffers;
 
+        /// When true, the pass is submitted to the async compute queue so it can overlap
+        /// with graphics work (e.g. shadow map rendering). Passes that depend on its results
+        /// wait for it automatically, based on the same analysis used to place barriers.
+        /// Only compute passes honour it, and only if the RenderSystem supports
+        /// RSC_ASYNC_COMPUTE. Otherwise the pass runs in order on the graphics queue.
+        bool                mAsyncCompute;
+
+        /** When true, the pass is skipped if nothing it depends on changed since it last
+            executed, keeping its previous output. It depends on the contents of its input
+            textures, whether its outputs were modified by someone else, the dynamic resolution
+            scale and, for scene passes, the camera and the static scene.
+        @remarks
+            Scene passes assume they only render static objects (SCENE_STATIC): changes
+            to dynamic objects, lights or materials aren't detected. Skipping a scene pass
+            also skips updating its shadow node.
+            Only supported by clear, quad and scene passes. Passes writing to a
+            RenderWindow are never skipped.
+            Call CompositorPass::invalidateResultCache to force an update.
+        */
+        bool                mCacheResult;
+
         uint8               mExecutionMask;
         uint8               mViewportModifierMask;
 
@@ -182,6 +203,18 @@ namespace Ogre
         /// and respect mVp* settings instead.
         bool                mShadowMapFullViewport;
 
+        /** Only used if mShadowMapIdx is valid (if pass is owned by Shadow Nodes). If true,
+            the pass belongs to the cache of that shadow map and is only executed when the
+            cache is invalid (e.g. clearing the cache and rendering the static casters into it).
+            Passes that aren't part of the cache are executed every frame (e.g. copying the
+            cache into the shadow map and rendering the dynamic casters on top).
+        @remarks
+            The cache must have the same layout as the shadow map's texture (atlas regions
+            are respected) and is invalidated when the light or shadow camera move more
+            than a fraction of a texel. @see CompositorShadowNode::setShadowMapCacheDirty
+        */
+        bool                mShadowMapCache;
+
         IdStringVec         mExposedTextures;
 
         struct UavDependency
@@ -224,9 +257,12 @@ namespace Ogre
             mReadOnlyStencil( false ),
             mIncludeOverlays( false ),
             mFlushCommandBuffers( false ),
+            mAsyncCompute( false ),
+            mCacheResult( false ),
             mExecutionMask( 0xFF ),
             mViewportModifierMask( 0xFF ),
-            mShadowMapFullViewport( false )
+            mShadowMapFullViewport( false ),
+            mShadowMapCache( false )
         {
             for( int i=0; i<OGRE_MAX_MULTIPLE_RENDER_TARGETS; ++i )
             {
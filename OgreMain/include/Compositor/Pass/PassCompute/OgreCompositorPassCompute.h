@@ -86,6 +86,8 @@ namespace Ogre
         Camera          *mCamera;
 
         void setResourcesToJob(void);
+        /// @see CompositorPassComputeDef::mForwardPlusLightsSlot
+        void setForwardPlusLightsToJob(void);
     public:
         CompositorPassCompute( const CompositorPassComputeDef *definition, Camera *defaultCamera,
                                CompositorNode *parentNode, const RenderTargetViewDef *rtv );
@@ -96,6 +98,12 @@ namespace Ogre
         virtual void _placeBarriersAndEmulateUavExecution( BoundUav boundUavs[64],
                                                            ResourceAccessMap &uavsAccess,
                                                            ResourceLayoutMap &resourcesLayout );
+
+        virtual bool _canRunAsyncCompute(void) const                { return true; }
+        virtual void _getAccessedResources( const BoundUav boundUavs[64],
+                                            GpuTrackedResourceVec &outResources ) const;
+        virtual void _getWrittenResources( const BoundUav boundUavs[64],
+                                           GpuTrackedResourceVec &outResources ) const;
     };
 
     /** @} */
@@ -112,10 +112,21 @@ namespace Ogre
         IdString mJobName;
         IdString mCameraName;
 
+        /** When not 0xFF, the Forward+ global light list collected for the camera (by an
+            earlier render_scene pass in the same frame) is bound as a tex buffer to this
+            texture slot, and the job's "numLights", "projectionParams" and "frustumExtents"
+            parameters (if present) are updated every execution with the light count,
+            Camera::getProjectionParamsAB and the camera's tan half angles (left, right,
+            top, bottom).
+            Used by deferred shading jobs to cull and shade Forward+ lights in compute.
+        */
+        uint8 mForwardPlusLightsSlot;
+
         CompositorPassComputeDef( CompositorNodeDef *parentNodeDef,
                                   CompositorTargetDef *parentTargetDef ) :
             CompositorPassDef( PASS_COMPUTE, parentTargetDef ),
-            mParentNodeDef( parentNodeDef )
+            mParentNodeDef( parentNodeDef ),
+            mForwardPlusLightsSlot( 0xFF )
         {
         }
 
@@ -69,6 +69,9 @@ namespace Ogre
         /// Compute
         vector<HlmsComputeJob *>::type mJobs;
 
+        /// Generates the input's mipmaps when it's UAV. Otherwise we use _autogenerateMipmaps
+        ComputeDownsampler *mDownsampler;
+
         void setupComputeShaders( void );
         void destroyComputeShaders( void );
 
@@ -85,6 +88,9 @@ namespace Ogre
 
         virtual bool notifyRecreated( const TextureGpu *channel );
 
+        virtual void _getWrittenResources( const BoundUav boundUavs[64],
+                                           GpuTrackedResourceVec &outResources ) const;
+
         virtual void resetNumPassesLeft(void);
 
     private:
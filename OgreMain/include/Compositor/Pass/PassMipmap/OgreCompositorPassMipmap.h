@@ -65,9 +65,13 @@ namespace Ogre
         TextureGpuVec                   mTmpTextures;
         vector<JobWithBarrier>::type    mJobs;
 
+        /// ComputeSinglePass. One per entry in mTextures with mipmaps
+        vector<ComputeDownsampler*>::type   mDownsamplers;
+
         bool mWarnedNoAutomipmapsAlready;
 
         void setupComputeShaders(void);
+        void setupDownsamplers(void);
         void destroyComputeShaders(void);
         void setGaussianFilterParams( HlmsComputeJob *job, uint8 kernelRadius,
                                       float gaussianDeviationFactor );
@@ -85,6 +89,9 @@ namespace Ogre
 
         virtual bool notifyRecreated( const TextureGpu *channel );
 
+        virtual void _getWrittenResources( const BoundUav boundUavs[64],
+                                           GpuTrackedResourceVec &outResources ) const;
+
     private:
         CompositorPassMipmapDef const *mDefinition;
     };
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "../OgreCompositorPassDef.h"
 #include "OgreCommon.h"
 #include "OgreColourValue.h"
+#include "Compute/OgreComputeDownsampler.h"
 
 namespace Ogre
 {
@@ -63,7 +64,13 @@ namespace Ogre
             */
             Compute,
             /// See Compute, but use a high quality gaussian filter.
-            ComputeHQ
+            ComputeHQ,
+            /** Use ComputeDownsampler: a 2x2 reduction that generates up to 6 mips
+                per dispatch. Much faster than Compute and ComputeHQ for long mip chains,
+                and the only method that supports mReduction.
+                Same requirements as Compute.
+            */
+            ComputeSinglePass
         };
 
         MipmapGenerationMethods mMipmapGenerationMethod;
@@ -73,12 +80,17 @@ namespace Ogre
         /// Used when mMipmapGenerationMethod == ComputeHQ
         uint8 mKernelRadius;
 
+        /// Used when mMipmapGenerationMethod == ComputeSinglePass
+        /// Min & Max are useful to build Hi-Z pyramids.
+        DownsampleReduction::DownsampleReduction mReduction;
+
     public:
         CompositorPassMipmapDef( CompositorTargetDef *parentTargetDef ) :
             CompositorPassDef( PASS_MIPMAP, parentTargetDef ),
             mMipmapGenerationMethod( ApiDefault ),
             mGaussianDeviationFactor( 0.5f ),
-            mKernelRadius( 8 )
+            mKernelRadius( 8 ),
+            mReduction( DownsampleReduction::Average )
         {
         }
     };
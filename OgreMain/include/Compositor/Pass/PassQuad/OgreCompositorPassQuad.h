@@ -96,6 +96,9 @@ namespace Ogre
         Real        mHorizonalTexelOffset;
         Real        mVerticalTexelOffset;
 
+        /// Sets reprojectionMatrix in the material. See CompositorPassQuadDef::mReprojection
+        void updateReprojection(void);
+
     public:
         CompositorPassQuad( const CompositorPassQuadDef *definition, Camera *defaultCamera,
                             CompositorNode *parentNode, const RenderTargetViewDef *rtv,
@@ -79,6 +79,17 @@ namespace Ogre
             CAMERA_DIRECTION
         };
 
+        enum Reprojection
+        {
+            /// Regular quad pass
+            ReprojectionOff,
+            /// Always warp the input to the latest camera orientation
+            ReprojectionAlways,
+            /// Only execute this pass when FramePacer::isFrameLate is true.
+            /// Skipped otherwise
+            ReprojectionWhenLate
+        };
+
         /** Whether to use a full screen quad or triangle. (default: false). Note that you may not
             always get the triangle (for example, if you ask for WORLD_SPACE_CORNERS)
         */
@@ -106,6 +117,18 @@ namespace Ogre
         FrustumCorners  mFrustumCorners;
         IdString        mCameraName;
 
+        /** When not ReprojectionOff, the input is assumed to be the last frame mCameraName
+            rendered, and the material must warp it to the camera's latest orientation
+            (e.g. Ogre/Reprojection/Rotation).
+            The "reprojectionMatrix" fragment program parameter is set every time
+            to transform from the current NDC to the NDC the frame was rendered with.
+        @remarks
+            The latest orientation is sampled again from the FramePacer's LateLatchListener
+            right before this pass executes. Only low level materials are supported.
+            The reprojection is rotational only: translation is not corrected.
+        */
+        Reprojection    mReprojection;
+
         CompositorPassQuadDef( CompositorNodeDef *parentNodeDef, CompositorTargetDef *parentTargetDef ) :
             CompositorPassDef( PASS_QUAD, parentTargetDef ),
             mParentNodeDef( parentNodeDef ),
@@ -113,7 +136,8 @@ namespace Ogre
             mIsResolve( false ),
             mCameraCubemapReorient( false ),
             mMaterialIsHlms( false ),
-            mFrustumCorners( NO_CORNERS )
+            mFrustumCorners( NO_CORNERS ),
+            mReprojection( ReprojectionOff )
         {
         }
 
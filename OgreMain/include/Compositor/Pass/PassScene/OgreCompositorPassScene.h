@@ -33,6 +33,7 @@ THE SOFTWARE.
 
 #include "Compositor/Pass/OgreCompositorPass.h"
 #include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
+#include "OgreMatrix4.h"
 
 namespace Ogre
 {
@@ -74,8 +75,29 @@ namespace Ogre
         TextureGpu      *mDepthTextureNoMsaa;
         TextureGpu      *mRefractionsTexture;
 
+        /// State of the camera & scene when the pass last executed. @see mCacheResult
+        Vector3         mCachedCameraPos;
+        Quaternion      mCachedCameraRot;
+        Matrix4         mCachedProjMatrix;
+        uint32          mCachedStaticSceneVersion;
+
+        /// See CompositorPassSceneDef::mAutoDepthPrePass. Depth-only copy of mRenderPassDesc
+        RenderPassDescriptor    *mAutoPrePassDesc;
+        /// Copy of mRenderPassDesc that loads the depth & stencil left by mAutoPrePassDesc
+        RenderPassDescriptor    *mAutoPrePassMainDesc;
+        /// Whether AutoDepthPrePass::Auto decided to render the prepass (with hysteresis)
+        bool                    mAutoPrePassEnabled;
+        Real                    mEstimatedOverdraw;
+
         void notifyPassSceneAfterShadowMapsListeners(void);
         void notifyPassSceneAfterFrustumCullingListeners(void);
+        /// Creates or updates the SceneManager's RadialDensityMask to match our definition
+        void setupRadialDensityMask( SceneManager *sceneManager );
+
+        /// Returns true if the automatic depth prepass should be rendered this time.
+        /// Creates or updates mAutoPrePassDesc & mAutoPrePassMainDesc if needed.
+        bool prepareAutoDepthPrePass( SceneManager *sceneManager );
+        void destroyAutoDepthPrePassDescs(void);
 
     public:
         /** Constructor
@@ -106,9 +128,18 @@ namespace Ogre
 
         bool getUpdateShadowNode(void) const                    { return mUpdateShadowNode; }
 
+        virtual bool notifyRecreated( const TextureGpu *channel );
+        virtual void notifyDestroyed( TextureGpu *channel );
         virtual void notifyCleared(void);
 
+        virtual bool _isResultCacheValid(void) const;
+        virtual void _notifyExecuted(void);
+
         const CompositorPassSceneDef* getDefinition() const     { return mDefinition; }
+
+        /// Overdraw estimated the last time this pass executed with
+        /// AutoDepthPrePass::Auto. See RenderQueue::getEstimatedOverdraw
+        Real getEstimatedOverdraw(void) const                   { return mEstimatedOverdraw; }
     };
 
     /** @} */
@@ -69,6 +69,45 @@ namespace Ogre
         SHADOW_NODE_CASTER_PASS     //Set automatically only when this pass is used by a ShadowNode
     };
 
+    namespace AutoDepthPrePass
+    {
+        enum AutoDepthPrePass
+        {
+            /// No automatic depth prepass
+            Off,
+            /// Always render the occluders in a depth-only prepass before the pass
+            Always,
+            /// Render the occluders in a depth-only prepass only while the estimated
+            /// overdraw (see RenderQueue::getEstimatedOverdraw) of the previous
+            /// frame is above CompositorPassSceneDef::mAutoPrePassOverdrawThreshold
+            Auto
+        };
+    }
+
+    namespace OitMode
+    {
+        enum OitMode
+        {
+            /// Transparent objects are alpha blended in the order the RenderQueue sorted them
+            Off,
+            /** Weighted blended order independent transparency (McGuire & Bavoil 2013).
+                The pass must render to 2 colour targets:
+                    0. Accumulation. PFG_RGBA16_FLOAT, cleared to 0 0 0 1
+                    1. Weights. PFG_R16_FLOAT, cleared to 0
+                Alpha blended objects output their premultiplied, depth-weighted colour and
+                get a blendblock that accumulates regardless of the order they're drawn.
+                Resolve them on top of the opaque objects with the Ogre/Oit/WeightedBlendedResolve
+                material.
+            @remarks
+                Only HlmsPbs & HlmsUnlit write the weights; the pass should only include
+                render queues with transparent objects. Depth writes are disabled for them.
+                See RenderQueue::setOrderIndependentTransparency to stop sorting those
+                queues back to front.
+            */
+            WeightedBlended
+        };
+    }
+
     class _OgreExport CompositorPassSceneDef : public CompositorPassDef
     {
     public:
@@ -103,6 +142,32 @@ namespace Ogre
         /// Generate Normals for a GBuffer in RTV output 1,
         /// This flag is ignored mPrePassMode if mPrePassMode != PrePassNone
         bool            mGenNormalsGBuf;
+        /** Generate a full GBuffer for deferred shading. Implies mGenNormalsGBuf. RTV outputs:
+                0. Colour: ambient, emissive, env. maps & non-Forward+ lights.
+                1. View space normals (same as mGenNormalsGBuf)
+                2. Diffuse (albedo) colour in RGB
+                3. F0 (already multiplied by the specular colour) in RGB & roughness in A
+            Forward+ lights are *not* evaluated by the pixel shader; they're expected to
+            be shaded afterwards by a compute pass using forward_plus_lights
+            (see CompositorPassComputeDef::mForwardPlusLightsSlot).
+            mEnableForwardPlus must be left on so the lights get collected.
+            This flag is ignored mPrePassMode if mPrePassMode != PrePassNone
+        */
+        bool            mGenGBuffer;
+        /** Output per-pixel motion vectors in the RTV output that follows all the others
+            (i.e. after the normals/GBuffer ones, if any). Values are in UV units: adding
+            them to a pixel's UV gives where that pixel was during the previous frame.
+            A PFG_RG16_FLOAT target is recommended.
+        @remarks
+            HlmsPbs keeps the previous world matrix of each object and the previous viewProj
+            matrix of each camera. Skeletally or pose animated objects only get the motion
+            caused by moving their node and the camera, not by the animation itself.
+            Ignored when mInstancedStereo is set.
+        */
+        bool            mGenMotionVectors;
+        /// Offsets the projection every frame by a subpixel amount following a Halton(2, 3)
+        /// sequence, for temporal antialiasing & upscaling. Motion vectors exclude the jitter.
+        bool            mTemporalJitter;
 
         /// First Render Queue ID to render. Inclusive
         uint8           mFirstRQ;
@@ -140,10 +205,53 @@ namespace Ogre
         /// at the same time
         bool            mInstancedStereo;
 
+        /** When true, the SceneManager's RadialDensityMask is created (or updated) with
+            mRdmRadius & mRdmQuality before rendering this pass, so the periphery of each eye
+            gets shaded at a lower rate. Only takes effect if mInstancedStereo is also set;
+            compositor scripts that set radial_density_mask without it report an error.
+            Reconstruct the result with a compute pass using VR/RadialDensityMaskReconstruct.
+        @remarks
+            For fixed foveation leave the eye centers at their default. For eye-tracked
+            foveation, call RadialDensityMask::setEyesCenter every frame.
+            See SceneManager::setRadialDensityMask
+        */
+        bool            mRadialDensityMask;
+        /// See SceneManager::setRadialDensityMask. Only used if mRadialDensityMask is true
+        float           mRdmRadius[3];
+        /// See RadialDensityMask::RdmQuality. Only used if mRadialDensityMask is true
+        uint8           mRdmQuality;
+
         /// When true, the frustum culling is skipped in this pass. To cull objects, data from
         /// the most recent frustum culling execution are used.
         bool            mReuseCullData;
 
+        /** Unlike mPrePassMode (which renders everything twice and must be set up manually
+            with two passes), the pass renders a subset of the opaque objects (the occluders)
+            into the depth buffer using a depth-only render pass before rendering all objects
+            normally with the depth buffer already filled. Hidden pixels with expensive
+            shaders (e.g. PBS with many lights) are then rejected by the early depth test.
+        @remarks
+            Occluders are opaque, not alpha tested v2 objects whose bounding sphere covers at
+            least mAutoPrePassMinOccluderSize of the viewport's height and whose current LOD
+            has at most mAutoPrePassMaxOccluderVertices vertices.
+            Depth-only render passes make the Hlms skip the pixel shader where possible.
+            Ignored for shadow casters, when mPrePassMode != PrePassNone,
+            when mReadOnlyDepth is set, or when there is no depth buffer.
+            See RenderQueue::setOccluderSelection
+        */
+        AutoDepthPrePass::AutoDepthPrePass  mAutoDepthPrePass;
+        /// When mAutoDepthPrePass == AutoDepthPrePass::Auto, the prepass is enabled
+        /// when the estimated overdraw goes above this value, and disabled
+        /// when it falls below 80% of it
+        Real            mAutoPrePassOverdrawThreshold;
+        /// See mAutoDepthPrePass. In range [0; 1], fraction of the viewport's height
+        Real            mAutoPrePassMinOccluderSize;
+        /// See mAutoDepthPrePass
+        uint32          mAutoPrePassMaxOccluderVertices;
+
+        /// See OitMode::OitMode
+        OitMode::OitMode    mOitMode;
+
         /// Same as CompositorPassDef::mFlushCommandBuffers, but executed after the shadow node
         /// Note you may end up flushing twice if the shadow node also has flushing of its own
         ///
@@ -195,6 +303,9 @@ namespace Ogre
             mShadowNodeRecalculation( SHADOW_NODE_FIRST_ONLY ),
             mPrePassMode( PrePassNone ),
             mGenNormalsGBuf( false ),
+            mGenGBuffer( false ),
+            mGenMotionVectors( false ),
+            mTemporalJitter( false ),
             mFirstRQ( 0 ),
             mLastRQ( (uint8)-1 ),
             mEnableForwardPlus( true ),
@@ -202,13 +313,24 @@ namespace Ogre
             mUpdateLodLists( true ),
             mLodBias( 1.0f ),
             mInstancedStereo( false ),
+            mRadialDensityMask( false ),
+            mRdmQuality( 2u ),
             mReuseCullData( false ),
+            mAutoDepthPrePass( AutoDepthPrePass::Off ),
+            mAutoPrePassOverdrawThreshold( 2.5f ),
+            mAutoPrePassMinOccluderSize( 0.1f ),
+            mAutoPrePassMaxOccluderVertices( 16384u ),
+            mOitMode( OitMode::Off ),
             mFlushCommandBuffersAfterShadowNode( false ),
             mUvBakingSet( 0xFF ),
             mBakeLightingOnly( false ),
             mUvBakingOffset( Vector2::ZERO ),
             mMaterialScheme(MaterialManager::DEFAULT_SCHEME_NAME)
         {
+            mRdmRadius[0] = 0.25f;
+            mRdmRadius[1] = 0.7f;
+            mRdmRadius[2] = 0.85f;
+
             //Change base defaults
             mIncludeOverlays = true;
             //retrieve the rendersystem default scheme name, which can be different from DEFAULT_SCHEME_NAME if RS doesn't have fixed function support.
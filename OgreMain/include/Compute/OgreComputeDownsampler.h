@@ -0,0 +1,123 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreComputeDownsampler_H_
+#define _OgreComputeDownsampler_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreResourceTransition.h"
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    namespace DownsampleReduction
+    {
+        enum DownsampleReduction
+        {
+            /// 2x2 box filter. Regular mipmaps
+            Average,
+            /// Keeps the minimum of each 2x2 block, per channel.
+            /// e.g. a Hi-Z pyramid of a reverse Z depth buffer
+            Min,
+            /// Keeps the maximum of each 2x2 block, per channel.
+            /// e.g. a Hi-Z pyramid of a regular depth buffer
+            Max
+        };
+    }
+
+    /** Generates the whole mip chain of a texture with few dispatches, in the spirit of
+        AMD's FidelityFX Single Pass Downsampler: each threadgroup reduces a 64x64 tile
+        into up to 6 mips through group shared memory, instead of dispatching (and placing
+        a barrier) once per mip.
+    @remarks
+        The original SPD writes all the mips in a single dispatch using a global atomic
+        counter, but that requires binding 12 UAVs at once which exceeds what D3D11 and
+        most GL drivers allow (8). Thus we dispatch once every MaxMipsPerDispatch mips,
+        e.g. a 4096x4096 texture takes 2 dispatches, whereas the gaussian compute path of
+        CompositorPassMipmap takes 24.
+    @par
+        The texture must be Type2D, Type2DArray or TypeCube, flagged as both Uav and Texture,
+        and be of a float, unorm or snorm format. sRGB textures are supported.
+    @par
+        Requires the compute job "Mipmap/SinglePassDownsample" bundled in
+        Samples/Media/2.0/scripts/materials/Common
+    */
+    class _OgreExport ComputeDownsampler : public UtilityAlloc
+    {
+    public:
+        static const uint8 MaxMipsPerDispatch;
+
+    protected:
+        HlmsCompute     *mHlmsCompute;
+        RenderSystem    *mRenderSystem;
+
+        TextureGpu      *mTexture;
+        FastArray<HlmsComputeJob*>  mJobs;
+
+        /// Makes the mips written by a dispatch visible to the next one
+        ResourceTransition  mResourceTransition;
+
+    public:
+        ComputeDownsampler( HlmsManager *hlmsManager );
+        ~ComputeDownsampler();
+
+        /// Returns true if the texture can be used with ComputeDownsampler::setup
+        static bool isTextureSupported( const TextureGpu *texture );
+
+        /** Prepares the jobs to generate all the mips of the given texture.
+            Must be called again if the texture is resized, reformatted or its
+            number of mipmaps changes.
+        @param texture
+            Texture whose mips 1 to N will be generated from mip 0.
+            See isTextureSupported. Can be null to release the jobs.
+        @param reduction
+            How each 2x2 block is reduced into a texel of the next mip
+        */
+        void setup( TextureGpu *texture,
+                    DownsampleReduction::DownsampleReduction reduction =
+                            DownsampleReduction::Average );
+
+        /// Destroys the jobs created by setup
+        void destroyJobs(void);
+
+        /** Dispatches the jobs. Ends the current render pass.
+        @param bFinalBarrier
+            When false, no barrier is placed after the last dispatch, as it's the caller's
+            (e.g. the compositor's) responsability to do it before the mips are sampled.
+        */
+        void execute( bool bFinalBarrier );
+
+        TextureGpu* getTexture(void) const              { return mTexture; }
+
+        /// Number of dispatches needed by execute. 0 if the texture has no mips to generate
+        size_t getNumDispatches(void) const             { return mJobs.size(); }
+    };
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
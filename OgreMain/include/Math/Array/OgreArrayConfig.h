@@ -80,10 +80,25 @@ THE SOFTWARE.
             typedef __m128i ArrayMaskI;
         }
 
-        ///r = (a * b) + c
-        #define _mm_madd_ps( a, b, c )      _mm_add_ps( c, _mm_mul_ps( a, b ) )
-        ///r = -(a * b) + c
-        #define _mm_nmsub_ps( a, b, c )     _mm_sub_ps( c, _mm_mul_ps( a, b ) )
+        #if OGRE_USE_AVX2 && defined( __AVX2__ ) && defined( __FMA__ )
+            //Same 4-wide layout as SSE2 (ARRAY_PACKED_REALS doesn't change), but the
+            //compiler emits VEX encoded instructions and we get fused multiply-add.
+            #include <immintrin.h>
+
+            ///r = (a * b) + c
+            #define _mm_madd_ps( a, b, c )      _mm_fmadd_ps( a, b, c )
+            ///r = -(a * b) + c
+            #define _mm_nmsub_ps( a, b, c )     _mm_fnmadd_ps( a, b, c )
+        #else
+            #if OGRE_USE_AVX2 && defined( OGRE_NONCLIENT_BUILD )
+                #error "OGRE_USE_AVX2 requires compiling OgreMain with AVX2 & FMA enabled (-mavx2 -mfma or /arch:AVX2)"
+            #endif
+            //Code outside OgreMain built without FMA (e.g. plugins) uses mul + add
+            ///r = (a * b) + c
+            #define _mm_madd_ps( a, b, c )      _mm_add_ps( c, _mm_mul_ps( a, b ) )
+            ///r = -(a * b) + c
+            #define _mm_nmsub_ps( a, b, c )     _mm_sub_ps( c, _mm_mul_ps( a, b ) )
+        #endif
 
         /// Does not convert, just cast ArrayReal to ArrayInt
         #define CastRealToInt( x )          _mm_castps_si128( x )
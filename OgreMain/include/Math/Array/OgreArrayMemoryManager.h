@@ -161,9 +161,57 @@ namespace Ogre
         /// belongs
         uint16              mLevel;
 
+        /// Shifts all slots in range [newEnd; mUsedMemory) back by numFreeSlots,
+        /// overwriting the free range [newEnd - numFreeSlots; newEnd)
+        void shiftSlotsBack( size_t newEnd, size_t numFreeSlots );
+
     public:
         static const size_t MAX_MEMORY_SLOTS;
 
+        /// Limits the amount of work done by defragmentIncremental.
+        struct DefragmentBudget
+        {
+            /// Max number of slots that may be shifted
+            size_t  maxSlotsToMove;
+            /// Slots shifted so far
+            size_t  slotsMoved;
+            /// When not null, defragmentation stops once
+            /// timer->getMicroseconds() >= deadlineMicroseconds
+            Timer   *timer;
+            uint64  deadlineMicroseconds;
+
+            DefragmentBudget( size_t _maxSlotsToMove, Timer *_timer=0,
+                              uint64 _deadlineMicroseconds=0 ) :
+                maxSlotsToMove( _maxSlotsToMove ), slotsMoved( 0 ),
+                timer( _timer ), deadlineMicroseconds( _deadlineMicroseconds ) {}
+
+            /// Returns true if shifting the given amount of slots stays within budget.
+            /// The first request always succeeds (unless out of time) to guarantee progress.
+            bool canAfford( size_t numSlots ) const;
+            bool isExhausted(void) const;
+        };
+
+        /// @see getFragmentationStats
+        struct FragmentationStats
+        {
+            /// Slots in use by live objects
+            size_t  numUsedSlots;
+            /// Released slots that still get iterated (holes)
+            size_t  numFragmentedSlots;
+            /// Slots reserved (used + holes + free)
+            size_t  numReservedSlots;
+
+            FragmentationStats() :
+                numUsedSlots( 0 ), numFragmentedSlots( 0 ), numReservedSlots( 0 ) {}
+
+            /// Ratio in range [0; 1] of the iterated slots that are holes
+            Real getFragmentationRatio(void) const
+            {
+                const size_t numIterated = numUsedSlots + numFragmentedSlots;
+                return numIterated ? Real( numFragmentedSlots ) / Real( numIterated ) : Real( 0 );
+            }
+        };
+
         /** Constructor. @See intialize. @See destroy.
             @param elementsMemSize
                 Array containing the size in bytes of each element type (i.e. NodeElementsMemSize)
@@ -235,6 +283,23 @@ namespace Ogre
         /// more slots and you need to reclaim memory.
         void shrinkToFit(void);
 
+        /** Same as defragment, but stops when the budget is exhausted, leaving the rest
+            of the holes for a later call. Meant to be called every frame.
+        @remarks
+            Holes are closed from the end of the pool, where shifting is cheapest. Each
+            contiguous range of holes is processed whole; a range is skipped (and the call
+            ends) if shifting its tail would exceed the remaining budget, unless nothing
+            was moved yet in which case it's always processed to guarantee progress.
+        @param inOutBudget
+            Budget to consume. Can be shared across multiple managers.
+        @return
+            True if at least one hole was closed (i.e. the RebaseListener was called)
+        */
+        bool defragmentIncremental( DefragmentBudget &inOutBudget );
+
+        /// Adds the state of this manager to the given stats
+        void addFragmentationStats( FragmentationStats &inOutStats ) const;
+
         /// Returns mUsedMemory. When ARRAY_PACKED_REALS = 4, and 4 objects have been
         /// created but the 2nd one has been deleted, getNumUsedSlotsIncludingFragmented
         /// will still return 4 until the 4th object is removed or a cleanup is performed
@@ -313,6 +378,7 @@ namespace Ogre
             WorldMat,
             InheritOrientation,
             InheritScale,
+            DirtyFlags,
             NumMemoryTypes
         };
 
@@ -388,6 +454,9 @@ namespace Ogre
             VisibilityFlags,
             QueryFlags,
             LightMask,
+            LodRangeMin,
+            LodRangeMax,
+            BoundsDirty,
             NumMemoryTypes
         };
 
@@ -0,0 +1,113 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __CompactObjectHandle_H__
+#define __CompactObjectHandle_H__
+
+#include "OgrePrerequisites.h"
+
+#if OGRE_COMPACT_OBJECT_HANDLES
+#include "Threading/OgreLightweightMutex.h"
+#include "ogrestd/vector.h"
+
+namespace Ogre
+{
+    /** Maps 32-bit handles to objects of one type (MovableObject or Node).
+        See OGRE_CONFIG_COMPACT_OBJECT_HANDLES and CompactObjectHandle.
+    @remarks
+        Entries are stored in fixed size blocks that never move once allocated, so they can
+        be read from any thread (i.e. during culling) while the main thread adds or removes
+        other objects. Adding and removing are themselves thread safe.
+        Handle 0 is reserved to mean null.
+    */
+    class _OgreExport CompactObjectHandleTable
+    {
+        enum
+        {
+            BlockBits   = 16u,
+            BlockSize   = 1u << BlockBits,
+            NumBlocks   = 1u << (32u - BlockBits)
+        };
+
+        void                **mBlocks[NumBlocks];
+        uint32              mNextHandle;
+        vector<uint32>::type mFreeHandles;
+        LightweightMutex    mMutex;
+
+    public:
+        CompactObjectHandleTable();
+        ~CompactObjectHandleTable();
+
+        /// Returns the handle of obj (never 0). obj must not be null.
+        uint32 add( void *obj );
+        /// Releases a handle returned by add, so it can be reused.
+        void remove( uint32 handle );
+
+        /// Returns the object the handle was created with; or null if handle is 0.
+        void* get( uint32 handle ) const
+        {
+            return mBlocks[handle >> BlockBits][handle & (BlockSize - 1u)];
+        }
+    };
+
+    /** 32-bit replacement for a T* in the SoA arrays of ObjectData
+        (see OGRE_CONFIG_COMPACT_OBJECT_HANDLES), halving the memory they take.
+        It converts to and from T*, so code written for raw pointers works as is.
+    @remarks
+        T must provide a CompactObjectHandleTable named msCompactHandles and a
+        _getCompactHandle() returning the handle it was registered with.
+    @par
+        This is POD on purpose: the arrays are raw memory copied around with memcpy.
+    */
+    template <typename T>
+    class CompactObjectHandle
+    {
+        uint32 mHandle;
+
+    public:
+        CompactObjectHandle& operator = ( T *obj )
+        {
+            mHandle = obj ? obj->_getCompactHandle() : 0u;
+            return *this;
+        }
+
+        operator T* () const
+        {
+            return static_cast<T*>( T::msCompactHandles.get( mHandle ) );
+        }
+
+        T* operator -> () const
+        {
+            return static_cast<T*>( T::msCompactHandles.get( mHandle ) );
+        }
+
+        uint32 getHandle(void) const        { return mHandle; }
+    };
+}
+#endif
+
+#endif
@@ -68,6 +68,9 @@ namespace Ogre
         SceneMemoryMgrTypes                     mMemoryManagerType;
         NodeMemoryManager                       *mTwinMemoryManager;
 
+        /// @see setDirtyTracking
+        bool                                    mDirtyTracking;
+
         /** Makes mMemoryManagers big enough to be able to fulfill mMemoryManagers[newDepth]
         @param newDepth
             Hierarchy level depth we wish to grow to.
@@ -87,6 +90,20 @@ namespace Ogre
         NodeMemoryManager* getTwin() const                          { return mTwinMemoryManager; }
         SceneMemoryMgrTypes getMemoryManagerType() const            { return mMemoryManagerType; }
 
+        /** When enabled, SceneManager::updateAllTransforms only recomputes the packs of
+            nodes whose local transform changed (or whose parent was recomputed) since the
+            last update, using Node::updateDirtyTransforms. Nodes that didn't move, and
+            their whole subtrees, are skipped.
+        @remarks
+            Worth when most of the nodes are idle. When most of the nodes move every frame,
+            the extra pass over the flags makes it slightly slower than the default.
+            @par
+            If you write directly to the Transform (bypassing Node's setters) you must
+            set Transform::DirtyLocal yourself.
+        */
+        void setDirtyTracking( bool bEnabled )                      { mDirtyTracking = bEnabled; }
+        bool getDirtyTracking(void) const                           { return mDirtyTracking; }
+
         /** Requests memory for the given transform for the first, initializing values.
         @param outTransform
             Transform with filled pointers
@@ -194,6 +211,12 @@ namespace Ogre
         /// @copydoc ArrayMemoryManager::shrinkToFit
         void shrinkToFit(void);
 
+        /// @copydoc ArrayMemoryManager::defragmentIncremental
+        bool defragmentIncremental( ArrayMemoryManager::DefragmentBudget &inOutBudget );
+
+        /// Fragmentation of all the depths, combined
+        ArrayMemoryManager::FragmentationStats getFragmentationStats(void) const;
+
         /** Retrieves the number of depth levels that have been created.
         @remarks
             The return value is equal or below mMemoryManagers.size(), you should cache
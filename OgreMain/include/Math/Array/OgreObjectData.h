@@ -31,20 +31,31 @@ THE SOFTWARE.
 //#include "OgreArrayMatrix4.h"
 #include "OgreArrayAabb.h"
 #include "OgreArrayMemoryManager.h"
+#include "OgreCompactObjectHandle.h"
 
 namespace Ogre
 {
     /** Represents the transform of a single object, arranged in SoA (Structure of Arrays) */
     struct ObjectData
     {
+#if OGRE_COMPACT_OBJECT_HANDLES
+        /// See OGRE_CONFIG_COMPACT_OBJECT_HANDLES. Converts to and from Node*
+        typedef CompactObjectHandle<Node>           NodeRef;
+        /// See OGRE_CONFIG_COMPACT_OBJECT_HANDLES. Converts to and from MovableObject*
+        typedef CompactObjectHandle<MovableObject>  MovableObjectRef;
+#else
+        typedef Node            *NodeRef;
+        typedef MovableObject   *MovableObjectRef;
+#endif
+
         /// Which of the packed values is ours. Value in range [0; 4) for SSE2
         unsigned char       mIndex;
 
         /// Holds the pointers to each parent. Ours is mParents[mIndex]
-        Node                **mParents;
+        NodeRef             *mParents;
 
         /// The movable object that owns this ObjectData. Ours is mOwner[mIndex]
-        MovableObject       **mOwner;
+        MovableObjectRef    *mOwner;
 
         /** Bounding box in local space. It's argueable whether it should be like this, or pointer
             to a shared aabb (i.e. mesh aabb) to save RAM at the cost of another level of indirection,
@@ -100,6 +111,22 @@ namespace Ogre
         */
         uint32      * RESTRICT_ALIAS    mLightMask;
 
+        /** Range of LOD values (mLodRangeMin; mLodRangeMax] in which the current mesh and
+            material LODs don't change. Ours is mLodRangeMin[mIndex]. @see LodStrategy::lodSet
+        @remarks
+            An empty range (i.e. min > max) forces the LODs to be evaluated again.
+        */
+        Real        * RESTRICT_ALIAS    mLodRangeMin;
+        Real        * RESTRICT_ALIAS    mLodRangeMax;
+
+        /** Non-zero when mLocalAabb or mLocalRadius changed (or the object was attached, moved
+            to another slot, etc) since MovableObject::updateDirtyBounds last computed the world
+            bounds. Ours is mBoundsDirty[mIndex]. @see SceneManager::setIncrementalBoundsUpdate
+        @remarks
+            Whoever writes to mLocalAabb or mLocalRadius directly must call invalidateBounds.
+        */
+        uint8       * RESTRICT_ALIAS    mBoundsDirty;
+
         ObjectData() :
             mIndex( 0 ),
             mParents( 0 ),
@@ -109,7 +136,10 @@ namespace Ogre
             mDistanceToCamera( 0 ),
             mVisibilityFlags( 0 ),
             mQueryFlags( 0 ),
-            mLightMask( 0 )
+            mLightMask( 0 ),
+            mLodRangeMin( 0 ),
+            mLodRangeMax( 0 ),
+            mBoundsDirty( 0 )
         {
             mUpperDistance[0] = 0;
             mUpperDistance[1] = 0;
@@ -136,6 +166,22 @@ namespace Ogre
             mVisibilityFlags[mIndex]    = inCopy.mVisibilityFlags[inCopy.mIndex];
             mQueryFlags[mIndex]         = inCopy.mQueryFlags[inCopy.mIndex];
             mLightMask[mIndex]          = inCopy.mLightMask[inCopy.mIndex];
+            mLodRangeMin[mIndex]        = inCopy.mLodRangeMin[inCopy.mIndex];
+            mLodRangeMax[mIndex]        = inCopy.mLodRangeMax[inCopy.mIndex];
+            mBoundsDirty[mIndex]        = 1u;
+        }
+
+        /// Forces the LODs of our object to be evaluated again in the next LOD update
+        void invalidateLodRange(void)
+        {
+            mLodRangeMin[mIndex]        = std::numeric_limits<Real>::max();
+            mLodRangeMax[mIndex]        = -std::numeric_limits<Real>::max();
+        }
+
+        /// Forces the world bounds of our object to be computed again in the next bounds update
+        void invalidateBounds(void)
+        {
+            mBoundsDirty[mIndex]        = 1u;
         }
 
         /** Advances all pointers to the next pack, i.e. if we're processing 4
@@ -155,6 +201,9 @@ namespace Ogre
             mVisibilityFlags    += ARRAY_PACKED_REALS;
             mQueryFlags         += ARRAY_PACKED_REALS;
             mLightMask          += ARRAY_PACKED_REALS;
+            mLodRangeMin        += ARRAY_PACKED_REALS;
+            mLodRangeMax        += ARRAY_PACKED_REALS;
+            mBoundsDirty        += ARRAY_PACKED_REALS;
         }
 
         void advancePack( size_t numAdvance )
@@ -171,6 +220,9 @@ namespace Ogre
             mVisibilityFlags    += ARRAY_PACKED_REALS * numAdvance;
             mQueryFlags         += ARRAY_PACKED_REALS * numAdvance;
             mLightMask          += ARRAY_PACKED_REALS * numAdvance;
+            mLodRangeMin        += ARRAY_PACKED_REALS * numAdvance;
+            mLodRangeMax        += ARRAY_PACKED_REALS * numAdvance;
+            mBoundsDirty        += ARRAY_PACKED_REALS * numAdvance;
         }
 
         /** Advances all pointers needed by MovableObject::updateAllBounds to the next pack,
@@ -186,6 +238,7 @@ namespace Ogre
             ++mWorldAabb;
             mLocalRadius        += ARRAY_PACKED_REALS;
             mWorldRadius        += ARRAY_PACKED_REALS;
+            mBoundsDirty        += ARRAY_PACKED_REALS;
         }
 
         /** Advances all pointers needed by MovableObject::cullFrustum to the next pack,
@@ -241,6 +294,8 @@ namespace Ogre
             mOwner              += ARRAY_PACKED_REALS;
             ++mWorldAabb;
             mWorldRadius        += ARRAY_PACKED_REALS;
+            mLodRangeMin        += ARRAY_PACKED_REALS;
+            mLodRangeMax        += ARRAY_PACKED_REALS;
         }
     };
 }
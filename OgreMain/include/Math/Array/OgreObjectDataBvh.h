@@ -0,0 +1,164 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreObjectDataBvh_H_
+#define _OgreObjectDataBvh_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "Math/Array/OgreArrayAabb.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    class ObjectMemoryManager;
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Memory
+    *  @{
+    */
+    /** Bounding volume hierarchy over the objects of one render queue of an
+        ObjectMemoryManager, used to cull static objects hierarchically.
+    @remarks
+        The leaves are packs of ARRAY_PACKED_REALS objects as laid out in memory (see
+        ObjectMemoryManager::getFirstObjectData), so the objects that survive the BVH
+        can be tested with the same SIMD code as always (MovableObject::cullFrustum).
+        Each node tests up to c_branching children at once using ArrayAabb.
+    @par
+        The hierarchy is split into independent subtrees of a bounded amount of packs so
+        that different threads can traverse different subtrees.
+    @par
+        The bounds are taken from the world AABBs at build time. The BVH must be rebuilt
+        whenever the objects move or the memory layout changes (@see getBuildGeneration).
+        Because packs are the leaves, how well it culls depends on objects sharing a pack
+        being close to each other; which is usually the case when static objects are
+        created in spatial order (i.e. while loading a level).
+    */
+    class _OgreExport ObjectDataBvh : public SceneMgtAlloc
+    {
+    public:
+        /// Number of children per node
+        static const size_t c_branching = ARRAY_PACKED_REALS >= 4u ? ARRAY_PACKED_REALS : 4u;
+
+    private:
+        static const size_t c_numArrayAabbsPerNode = c_branching / ARRAY_PACKED_REALS;
+        static const uint32 c_leafBit = 0x80000000u;
+
+        struct Node
+        {
+            ArrayAabb   childBounds[c_numArrayAabbsPerNode];
+            /// Index to mNodes, or pack index if c_leafBit is set
+            uint32      children[c_branching];
+            uint32      numChildren;
+        };
+
+        struct PackInfo
+        {
+            Aabb    bounds;
+            uint32  packIdx;
+        };
+
+        typedef FastArray<PackInfo> PackInfoArray;
+
+        /// Allocated with SIMD alignment
+        Node                *mNodes;
+        size_t              mNumNodes;
+        size_t              mNodeCapacity;
+        /// Root node (index to mNodes) of each subtree
+        FastArray<uint32>   mSubtreeRoots;
+        uint32              mBuildGeneration;
+
+        void reserveNodes( size_t numNodes );
+
+        /// Returns the index to the node created
+        uint32 buildNode( PackInfo *packs, size_t numPacks );
+
+        /// Splits the range into subtrees
+        void buildSubtrees( PackInfo *packs, size_t numPacks, size_t maxPacksPerSubtree );
+
+        /// Sorts packs along the longest axis of the bounds of their centers
+        static void sortAlongLongestAxis( PackInfo *packs, size_t numPacks );
+
+        /// Walks all subtrees, descending into children where test( childBounds ) is set
+        template <typename T>
+        void findPacksImpl( const T &test, FastArray<uint32> &outPacks ) const;
+
+    public:
+        ObjectDataBvh();
+        ~ObjectDataBvh();
+
+        /** Builds the BVH from the current world AABBs of all objects in the render queue.
+        @param memoryManager
+            Memory manager containing the objects.
+        @param renderQueue
+            Render queue ID to build the hierarchy from.
+        @param maxPacksPerSubtree
+            Maximum number of packs (of ARRAY_PACKED_REALS objects) per subtree.
+        @param generation
+            Value to return in getBuildGeneration.
+        */
+        void build( ObjectMemoryManager *memoryManager, size_t renderQueue,
+                    size_t maxPacksPerSubtree, uint32 generation );
+
+        /// Returns the value passed to build
+        uint32 getBuildGeneration(void) const           { return mBuildGeneration; }
+
+        size_t getNumSubtrees(void) const               { return mSubtreeRoots.size(); }
+
+        /** Finds the packs of a subtree that may intersect the frustum.
+        @param subtreeIdx
+            Subtree to traverse. Must be in range [0; getNumSubtrees)
+        @param frustum
+            Camera to cull against. Its frustum planes must be up to date.
+        @param outPacks [out]
+            Indices of the packs (relative to ObjectMemoryManager::getFirstObjectData)
+            are appended here, in ascending order.
+        */
+        void cullSubtree( size_t subtreeIdx, const Camera *frustum, FastArray<uint32> &outPacks ) const;
+
+        /** Finds the packs, across all subtrees, that may intersect the volume.
+        @param outPacks [out]
+            Indices of the packs are appended here, in ascending order.
+        */
+        void findPacks( const Aabb &volume, FastArray<uint32> &outPacks ) const;
+
+        /// Finds the packs, across all subtrees, that may be hit by the ray.
+        /// @see findPacks( const Aabb&, FastArray<uint32>& )
+        void findPacks( const Ray &ray, FastArray<uint32> &outPacks ) const;
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -61,6 +61,9 @@ namespace Ogre
 
         /// Tracks total number of objects in all render queues.
         size_t                                  mTotalObjects;
+        /// Incremented every time an object is created, destroyed, changes render queue
+        /// or the memory layout changes (i.e. defragmentation)
+        uint32                                  mGeneration;
 
         /// Dummy node where to point ObjectData::mParents[i] when they're unused slots.
         SceneNode                               *mDummyNode;
@@ -138,6 +141,12 @@ namespace Ogre
         /// @copydoc ArrayMemoryManager::shrinkToFit
         void shrinkToFit(void);
 
+        /// @copydoc ArrayMemoryManager::defragmentIncremental
+        bool defragmentIncremental( ArrayMemoryManager::DefragmentBudget &inOutBudget );
+
+        /// Fragmentation of all the render queues, combined
+        ArrayMemoryManager::FragmentationStats getFragmentationStats(void) const;
+
         /** Retrieves the number of render queues that have been created.
         @remarks
             The return value is equal or below mMemoryManagers.size(), you should cache
@@ -165,6 +174,12 @@ namespace Ogre
         */
         size_t getTotalNumObjects() const                   { return mTotalObjects; }
 
+        /** Returns a counter that changes every time an object is added, removed, moved
+            to another render queue, or objects' slots are relocated. Useful to know whether
+            cached pointers to the MovableObjects (or to their slots) are still valid.
+        */
+        uint32 getGeneration() const                        { return mGeneration; }
+
         /// This is the opposite of getTotalNumObjects. This function returns the sum
         /// of the return values of getFirstObjectData
         size_t calculateTotalNumObjectDataIncludingFragmentedSlots() const;
@@ -36,6 +36,16 @@ namespace Ogre
     /** Represents the transform of a single object, arranged in SoA (Structure of Arrays) */
     struct Transform
     {
+        /// Bits stored in mDirtyFlags. @see NodeMemoryManager::setDirtyTracking
+        enum DirtyFlags
+        {
+            /// Local position, orientation, scale, inheritance or parent changed
+            DirtyLocal      = 1u << 0u,
+            /// Derived transform was recomputed by the last Node::updateDirtyTransforms
+            /// call at this depth, hence our children must be recomputed too
+            DerivedChanged  = 1u << 1u
+        };
+
         /// Which of the packed values is ours. Value in range [0; 4) for SSE2
         unsigned char   mIndex;
 
@@ -74,6 +84,9 @@ namespace Ogre
         /// Ours is mInheritScale[mIndex]
         bool    * RESTRICT_ALIAS mInheritScale;
 
+        /// Combination of DirtyFlags. Ours is mDirtyFlags[mIndex]
+        uint8   * RESTRICT_ALIAS mDirtyFlags;
+
         Transform() :
             mIndex( 0 ),
             mParents( 0 ),
@@ -86,7 +99,8 @@ namespace Ogre
             mDerivedScale( 0 ),
             mDerivedTransform( 0 ),
             mInheritOrientation( 0 ),
-            mInheritScale( 0 )
+            mInheritScale( 0 ),
+            mDirtyFlags( 0 )
         {
         }
 
@@ -101,6 +115,8 @@ namespace Ogre
             explicit functions are much preferred. @See rebasePtrs
 
             Note that we do NOT copy the mIndex member.
+            The copy is always flagged as DirtyLocal since it usually means
+            the node changed depth or parent.
         */
         void copy( const Transform &inCopy )
         {
@@ -138,6 +154,8 @@ namespace Ogre
 
             mInheritOrientation[mIndex] = inCopy.mInheritOrientation[inCopy.mIndex];
             mInheritScale[mIndex]       = inCopy.mInheritScale[inCopy.mIndex];
+
+            mDirtyFlags[mIndex]         = DirtyLocal;
         }
 
         /** Rebases all the pointers from our SoA structs so that they point to a new location
@@ -174,6 +192,8 @@ namespace Ogre
                                     newBasePtrs[NodeArrayMemoryManager::InheritOrientation] + diff );
             mInheritScale       = reinterpret_cast<bool*>(
                                     newBasePtrs[NodeArrayMemoryManager::InheritScale] + diff );
+            mDirtyFlags         = reinterpret_cast<uint8*>(
+                                    newBasePtrs[NodeArrayMemoryManager::DirtyFlags] + diff );
         }
 
         /** Advances all pointers to the next pack, i.e. if we're processing 4 elements at a time, move to
@@ -192,6 +212,7 @@ namespace Ogre
             mDerivedTransform   += ARRAY_PACKED_REALS;
             mInheritOrientation += ARRAY_PACKED_REALS;
             mInheritScale       += ARRAY_PACKED_REALS;
+            mDirtyFlags         += ARRAY_PACKED_REALS;
         }
 
         void advancePack( size_t numAdvance )
@@ -207,6 +228,7 @@ namespace Ogre
             mDerivedTransform   += ARRAY_PACKED_REALS * numAdvance;
             mInheritOrientation += ARRAY_PACKED_REALS * numAdvance;
             mInheritScale       += ARRAY_PACKED_REALS * numAdvance;
+            mDirtyFlags         += ARRAY_PACKED_REALS * numAdvance;
         }
     };
 }
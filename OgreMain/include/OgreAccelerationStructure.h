@@ -0,0 +1,246 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreAccelerationStructure_H_
+#define _OgreAccelerationStructure_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMatrix4.h"
+#include "OgreRay.h"
+#include "OgreFastArray.h"
+#include "OgreMesh2.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /**
+    @class AccelerationStructure
+        Two level BVH built from Items for ray queries (e.g. ray traced shadows & reflections).
+
+        Each Mesh v2 gets a bottom level structure (BLAS): a BVH of LOD 0's triangles in
+        mesh space, shared by all Items using that Mesh. The Items themselves form the top
+        level structure (TLAS): a BVH of their world space bounds.
+
+        Call update once per frame after the scene graph has been updated (e.g. from a
+        CompositorWorkspaceListener or before renderOneFrame when transforms are already
+        known). Items that moved get their bounds recalculated and the TLAS is refitted
+        in place; adding or removing Items rebuilds the TLAS. BLAS are built once per Mesh.
+    @par
+        Ray queries can be performed on the CPU via raycast & isOccluded. When GPU buffers
+        are enabled (see setGpuBuffersEnabled) the structures are also uploaded as
+        PFG_RGBA32_FLOAT TexBuffers so compute jobs can traverse them (see setToComputeJob).
+        Their layout, one float4 per row:
+            TLAS nodes & BLAS nodes, 2 rows per node:
+                xyz = aabbMin, w = asuint: first child or first primitive
+                xyz = aabbMax, w = asuint: number of primitives. 0 for inner nodes,
+                whose children are at 'first child' & 'first child + 1'.
+                Primitives are instances for TLAS leaves and triangles for BLAS leaves.
+            Instances, 4 rows per instance:
+                3 rows = world to mesh space 3x4 matrix.
+                x = asuint: BLAS root node, y = asuint: visibility flags, zw unused.
+            Triangles, 3 rows per triangle:
+                xyz = vertex in mesh space, w = asuint: SubMesh index.
+    @remarks
+        No hardware ray tracing backend (DXR, Metal RT, Vulkan RT) exists in this tree, which
+        is why the structures are built on the CPU. The BLAS/TLAS split and the refit path
+        map to what those APIs need, should one be added.
+    @par
+        Skeletal & pose animation are not taken into account; Items use their bind pose.
+    */
+    class _OgreExport AccelerationStructure : public SceneMgtAlloc
+    {
+    public:
+        struct BvhNode
+        {
+            Vector3 aabbMin;
+            uint32  firstChildOrPrim;
+            Vector3 aabbMax;
+            /// 0 for inner nodes
+            uint32  numPrims;
+        };
+        typedef FastArray<BvhNode> BvhNodeArray;
+
+        struct RayHit
+        {
+            /// Distance along the ray (in world units if the ray's direction is normalised)
+            Real    distance;
+            Item    *item;
+            uint32  subMeshIdx;
+            /// Normalised, in world space, facing the side the ray hit.
+            Vector3 normal;
+        };
+
+    protected:
+        struct Blas
+        {
+            MeshPtr             mesh;
+            BvhNodeArray        nodes;
+            /// 3 vertices per triangle, in the order the BVH leaves reference them.
+            FastArray<Vector3>  triVerts;
+            FastArray<uint16>   triSubMesh;
+            size_t              refCount;
+            /// Offsets into the GPU buffers (in nodes & triangles)
+            uint32              gpuNodeStart;
+            uint32              gpuTriStart;
+        };
+
+        struct Instance
+        {
+            Item    *item;
+            uint32  blasIdx;
+            uint32  visibilityFlags;
+            Matrix4 worldMatrix;
+            Matrix4 invWorldMatrix;
+            Vector3 aabbMin;
+            Vector3 aabbMax;
+        };
+
+        typedef FastArray<Blas*> BlasArray;
+        typedef FastArray<Instance> InstanceArray;
+        typedef map<Mesh*, uint32>::type MeshToBlasMap;
+
+        BlasArray       mBlas;
+        MeshToBlasMap   mMeshToBlas;
+
+        InstanceArray   mInstances;
+        BvhNodeArray    mTlasNodes;
+        /// Instance indices, in the order the TLAS leaves reference them.
+        FastArray<uint32> mTlasInstances;
+
+        bool    mTlasNeedsRebuild;
+        bool    mBlasChanged;
+
+        VaoManager      *mVaoManager;
+        bool            mGpuBuffersEnabled;
+        TexBufferPacked *mTlasNodesBuffer;
+        TexBufferPacked *mInstancesBuffer;
+        TexBufferPacked *mBlasNodesBuffer;
+        TexBufferPacked *mTrianglesBuffer;
+
+        /// Builds a BVH over the given primitives, splitting at the median centroid.
+        /// inOutPrims gets sorted so that the primitives of each leaf are contiguous.
+        static void buildBvh( BvhNodeArray &outNodes, FastArray<uint32> &inOutPrims,
+                              const Vector3 *primMin, const Vector3 *primMax,
+                              const Vector3 *centroids, uint32 maxPrimsPerLeaf );
+        static void buildBvhNode( BvhNode *nodes, uint32 &inOutNumNodes, uint32 *prims,
+                                  const Vector3 *primMin, const Vector3 *primMax,
+                                  const Vector3 *centroids, uint32 nodeIdx,
+                                  uint32 primStart, uint32 numPrims, uint32 maxPrimsPerLeaf );
+
+        uint32 acquireBlas( const MeshPtr &mesh );
+        void releaseBlas( uint32 blasIdx );
+        static void buildBlas( Blas &blas );
+
+        /// Updates the instance's matrices & bounds. Returns true if it moved.
+        static bool updateInstance( Instance &instance, const Blas &blas );
+        void rebuildTlas(void);
+        void refitTlas(void);
+
+        /// Closest hit (or any hit when anyHit = true) against a BLAS, in mesh space.
+        static bool raycastBlas( const Blas &blas, const Ray &localRay, bool anyHit,
+                                 Real &inOutDistance, uint32 &outTriIdx );
+        bool raycastImpl( const Ray &ray, Real maxDistance, uint32 visibilityMask,
+                          bool anyHit, RayHit *outHit ) const;
+
+        void destroyGpuBuffers(void);
+        void uploadTexBuffer( TexBufferPacked *&buffer, FastArray<float> &data );
+        void uploadBlasToGpu(void);
+        void uploadTlasToGpu(void);
+
+    public:
+        AccelerationStructure( VaoManager *vaoManager );
+        ~AccelerationStructure();
+
+        /** Adds an Item. If it's already been added, nothing happens.
+        @remarks
+            The first time a Mesh is seen its BLAS is built, which reads back its
+            buffers (it stalls if they have no shadow copy).
+            The Item must be removed before it's destroyed.
+        */
+        void addItem( Item *item );
+        /// Removes an Item added with addItem. If its Mesh has no other Items, its BLAS is freed
+        void removeItem( Item *item );
+        void removeAllItems(void);
+
+        size_t getNumItems(void) const                  { return mInstances.size(); }
+
+        /** Refits the TLAS for Items that moved (or rebuilds it if Items were added/removed),
+            and uploads the changes to the GPU buffers if enabled.
+            Items must have their transforms up to date.
+        */
+        void update(void);
+
+        /** Finds the closest triangle hit by the ray.
+        @param maxDistance
+            Hits farther than this are ignored.
+        @param visibilityMask
+            Items whose visibility flags don't share a bit with this mask are ignored.
+        @return
+            True if something was hit. outHit is only modified when returning true.
+        */
+        bool raycast( const Ray &ray, Real maxDistance, RayHit &outHit,
+                      uint32 visibilityMask=0xFFFFFFFF ) const;
+
+        /** Returns true as soon as anything is found between the ray's origin and maxDistance.
+            Cheaper than raycast; meant for shadow rays.
+        */
+        bool isOccluded( const Ray &ray, Real maxDistance,
+                         uint32 visibilityMask=0xFFFFFFFF ) const;
+
+        /** When enabled, update will keep TexBuffers holding the structures for use by
+            compute jobs. Requires a VaoManager.
+        */
+        void setGpuBuffersEnabled( bool bEnabled );
+        bool getGpuBuffersEnabled(void) const           { return mGpuBuffersEnabled; }
+
+        TexBufferPacked* getTlasNodesBuffer(void) const { return mTlasNodesBuffer; }
+        TexBufferPacked* getInstancesBuffer(void) const { return mInstancesBuffer; }
+        TexBufferPacked* getBlasNodesBuffer(void) const { return mBlasNodesBuffer; }
+        TexBufferPacked* getTrianglesBuffer(void) const { return mTrianglesBuffer; }
+
+        /** Binds the GPU buffers to the job's tex buffer slots: TLAS nodes at firstTexSlot,
+            then instances, BLAS nodes & triangles. update must have been called first.
+        */
+        void setToComputeJob( HlmsComputeJob *job, uint8 firstTexSlot ) const;
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -264,6 +264,12 @@ namespace v1 {
         */
         void apply(Real timePos, Real weight = 1.0, Real scale = 1.0f);
 
+        /** Same as apply, but the node tracks are added to nodeEvaluator to be applied in
+            bulk later (@see NodeAnimationEvaluator::evaluate) instead of right away.
+        */
+        void apply(NodeAnimationEvaluator &nodeEvaluator, Real timePos, Real weight = 1.0,
+                   Real scale = 1.0f);
+
         /** Applies all node tracks given a specific time point and weight to the specified node.
         @remarks
             It does not consider the actual node tracks are attached to.
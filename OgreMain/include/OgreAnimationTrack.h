@@ -441,8 +441,81 @@ namespace v1
 		mutable bool mSplineBuildNeeded;
 		/// Defines if rotation is done using shortest path
 		mutable bool mUseShortestRotationPath;
+
+		friend class NodeAnimationEvaluator;
 	};
 
+    /** Applies many NodeAnimationTracks at once, for scenes that animate thousands of
+        SceneNodes (cameras, doors, machinery) through AnimationStates.
+    @remarks
+        Instead of resetting every node and then applying each track through the Node
+        interface, the tracks are gathered first (@see Animation::apply overload), then
+        sampled 4 at a time with SIMD (linear interpolation; spline interpolation and
+        tracks with a listener fall back to NodeAnimationTrack::getInterpolatedKeyFrame),
+        optionally from the SceneManager's worker threads; and finally each node is
+        written once with its blended transform.
+    @par
+        The results match calling resetNodeToInitialState on every track followed by
+        NodeAnimationTrack::apply in the same order (up to floating point rounding).
+    */
+    class _OgreExport NodeAnimationEvaluator : public AnimationAlloc
+    {
+    public:
+        struct Sample
+        {
+            NodeAnimationTrack  *track;
+            Node                *node;
+            TimeIndex           timeIndex;
+            Real                weight;
+            Real                scale;
+            /// False if the track only resets the node (no keyframes or zero weight)
+            bool                apply;
+            /// True if already sampled on the main thread (i.e. it has a listener)
+            bool                sampled;
+
+            /// Outputs. Same as applyToNode would've passed to Node::translate & co.
+            Vector3             outTranslate;
+            Quaternion          outRotate;
+            Vector3             outScale;
+
+            Sample( NodeAnimationTrack *_track, Node *_node, const TimeIndex &_timeIndex,
+                    Real _weight, Real _scale );
+        };
+
+        typedef vector<Sample>::type SampleVec;
+
+    protected:
+        SampleVec           mSamples;
+        /// Indices to mSamples sorted by node (stable)
+        FastArray<uint32>   mSortedSamples;
+
+        void sampleRange( size_t start, size_t end );
+        /// Applies weight & scale to the interpolated keyframe. Same as applyToNode
+        static void finishSample( Sample &sample, const Vector3 &kfTranslate,
+                                  const Quaternion &kfRotate, const Vector3 &kfScale );
+        void writeNodes(void);
+
+        friend class NodeAnimationSampleTask;
+
+    public:
+        /// Starts a new frame
+        void clear(void)                                { mSamples.clear(); }
+
+        /// Adds a track to evaluate. The node is reset to the track's initial state
+        /// even when weight is 0 (like SceneManager did with resetNodeToInitialState).
+        void addTrack( NodeAnimationTrack *track, const TimeIndex &timeIndex,
+                       Real weight, Real scale );
+
+        /** Samples all the tracks and writes the nodes.
+        @param sceneManager
+            Optional. When not null and there are many tracks, sampling is split
+            across its worker threads.
+        */
+        void evaluate( SceneManager *sceneManager = 0 );
+
+        const SampleVec& getSamples(void) const         { return mSamples; }
+    };
+
     /** Specialised AnimationTrack for dealing with node transforms.
     */
 	class _OgreExport OldNodeAnimationTrack : public AnimationTrack
@@ -688,11 +761,18 @@ namespace v1
         /// Mode to apply
         TargetMode mTargetMode;
 
+        /// Software poses gathered by applyPoseToVertexData, so that they're all
+        /// blended with a single lock. @see Mesh::softwareVertexPoseBlend
+        vector<const Pose*>::type   mPendingSoftwarePoses;
+        vector<Real>::type          mPendingSoftwarePoseWeights;
+
         /// @copydoc AnimationTrack::createKeyFrameImpl
         KeyFrame* createKeyFrameImpl(Real time);
 
-        /// Utility method for applying pose animation
+        /// Utility method for applying pose animation. Software poses
+        /// are deferred until flushSoftwarePoses is called.
         void applyPoseToVertexData(const Pose* pose, VertexData* data, Real influence);
+        void flushSoftwarePoses(VertexData* data);
 
 
     };
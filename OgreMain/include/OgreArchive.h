@@ -131,6 +131,11 @@ namespace Ogre {
         */
         virtual bool isReadOnly() const { return mReadOnly; }
 
+        /** Whether open (and reading the streams it returns) can be done from multiple
+            threads at the same time. See AsyncArchiveReader.
+        */
+        virtual bool isThreadSafe() const { return false; }
+
         /** Open a stream on a given file. 
         @note
             There is no equivalent 'close' method; the returned stream
@@ -0,0 +1,170 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreAsyncArchiveReader_H_
+#define _OgreAsyncArchiveReader_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreDataStream.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreWaitableEvent.h"
+#include "Threading/OgreThreads.h"
+#include "ogrestd/deque.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Reads whole files from Archives on a pool of I/O threads.
+    @remarks
+        A single thread reading one file after another can't keep a fast SSD busy.
+        Issuing several reads at the same time keeps multiple requests in flight,
+        which is what gets close to the device's bandwidth.
+    @par
+        Reads are either issued in batches (readBatch, which blocks until the whole batch
+        is done and helps with the work meanwhile) or one by one with a Listener
+        (queueRead, which returns immediately).
+    @par
+        Archives that aren't thread safe (see Archive::isThreadSafe) are read on the
+        thread that issues the read instead.
+    @par
+        Every read returns the whole file in memory (or mapped, see DataStream::getDataView),
+        thus the stream can be consumed without touching the Archive again.
+    */
+    class _OgreExport AsyncArchiveReader : public ArchiveAlloc
+    {
+    public:
+        struct ReadRequest
+        {
+            Archive         *archive;
+            String          filename;
+            /// [out] Contents of the file. Null if it couldn't be read
+            DataStreamPtr   data;
+            /// [out] Why it couldn't be read
+            String          errorDescription;
+
+            ReadRequest() : archive( 0 ) {}
+            ReadRequest( Archive *_archive, const String &_filename ) :
+                archive( _archive ), filename( _filename ) {}
+        };
+        typedef vector<ReadRequest>::type ReadRequestVec;
+
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+            /// Called from an I/O thread (or from the thread that called queueRead, see
+            /// Archive::isThreadSafe) once the read is done, successfully or not.
+            /// The request is destroyed after this call.
+            virtual void readCompleted( ReadRequest &request ) = 0;
+        };
+
+    protected:
+        struct Batch
+        {
+            LightweightMutex    mutex;
+            size_t              numPending;
+            WaitableEvent       finished;
+        };
+
+        struct Job
+        {
+            ReadRequest *request;
+            /// If not null, request is owned by the job and sent to the listener
+            Listener    *listener;
+            /// If not null, request belongs to a readBatch call
+            Batch       *batch;
+        };
+
+        typedef deque<Job>::type JobDeque;
+
+        struct IoThread
+        {
+            AsyncArchiveReader  *reader;
+            WaitableEvent       wakeUp;
+        };
+
+        LightweightMutex    mJobsMutex;
+        JobDeque            mJobs;
+        bool                mShuttingDown;
+
+        ThreadHandleVec     mThreads;
+        vector<IoThread*>::type mThreadData;
+
+        /// Pops one job and executes it. Returns false if there were none.
+        bool processNextJob(void);
+        void executeJob( Job &job );
+
+        void startThreads( uint32 numThreads );
+        void stopThreads(void);
+
+    public:
+        /**
+        @param numThreads
+            Number of I/O threads, thus roughly the number of reads in flight. 0 reads
+            everything on the thread issuing the reads (as if nothing was asynchronous).
+        */
+        AsyncArchiveReader( uint32 numThreads );
+        ~AsyncArchiveReader();
+
+        /// Changes the number of I/O threads. Must not be called while reads are pending.
+        void setNumThreads( uint32 numThreads );
+        uint32 getNumThreads(void) const    { return static_cast<uint32>( mThreads.size() ); }
+
+        /** Reads every request, using the I/O threads and the calling thread.
+            Returns once all of them are done; check ReadRequest::data.
+        */
+        void readBatch( ReadRequestVec &requests );
+
+        /** Queues a read and returns immediately.
+        @param listener
+            Called once it's done. Must outlive the read.
+        */
+        void queueRead( Archive *archive, const String &filename, Listener *listener );
+
+        /// Opens the file and makes sure the whole of it is in memory
+        static DataStreamPtr readWholeFile( Archive *archive, const String &filename );
+
+        /// Internal use
+        void _ioThread( ThreadHandle *threadHandle );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,200 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreAsyncTextureReadback_H_
+#define _OgreAsyncTextureReadback_H_
+
+#include "OgrePrerequisites.h"
+#include "OgrePixelFormatGpu.h"
+#include "OgreTextureBox.h"
+#include "OgreTextureGpu.h"
+#include "Threading/OgreLightweightMutex.h"
+
+#include "ogrestd/map.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    class _OgreExport AsyncTextureReadbackListener
+    {
+    public:
+        virtual ~AsyncTextureReadbackListener();
+
+        /** Called when a readback requested via AsyncTextureReadback::requestReadback is done.
+        @remarks
+            On APIs that can't map all slices at once (see
+            AsyncTextureTicket::canMapMoreThanOneSlice) this gets called once per slice,
+            in order.
+        @param box
+            The downloaded data. Only valid for the duration of the call.
+        @param pixelFormat
+            The format of the data (same as the texture's).
+        @param userData
+            The value passed to requestReadback.
+        */
+        virtual void readbackFinished( const TextureBox &box, PixelFormatGpu pixelFormat,
+                                       void *userData ) = 0;
+    };
+
+    /** Downloads textures from GPU to CPU asynchronously, without stalling.
+    @remarks
+        AsyncTextureTicket can already do this, but it leaves pooling the tickets, waiting
+        the right amount of frames and polling to the user. This class keeps free tickets
+        pooled per resolution & format (up to VaoManager::getDynamicBufferMultiplier + 1
+        of them, which is what continuous readbacks of the same size need) and delivers the
+        results through AsyncTextureReadbackListener once the GPU is done.
+    @par
+        update must be called once per frame from the render thread (e.g. after
+        Root::renderOneFrame). Results are delivered either from update, or queued and
+        delivered when any thread calls dispatchQueuedResults (in that case the data is
+        copied out of the ticket so it can be returned to the pool right away).
+    @par
+        MSAA textures must be resolved first.
+    */
+    class _OgreExport AsyncTextureReadback : public UtilityAlloc
+    {
+    public:
+        enum DeliveryThread
+        {
+            /// Listener is called from update()
+            DeliverFromUpdate,
+            /// Listener is called from dispatchQueuedResults(), which can be called
+            /// from any thread.
+            DeliverFromDispatch
+        };
+
+    protected:
+        struct TicketKey
+        {
+            uint32                      width;
+            uint32                      height;
+            uint32                      depthOrSlices;
+            TextureTypes::TextureTypes  textureType;
+            PixelFormatGpu              pixelFormatFamily;
+
+            bool operator < ( const TicketKey &other ) const;
+        };
+
+        typedef vector<AsyncTextureTicket*>::type AsyncTextureTicketVec;
+        typedef map<TicketKey, AsyncTextureTicketVec>::type TicketPoolMap;
+
+        struct PendingReadback
+        {
+            AsyncTextureTicket              *ticket;
+            TicketKey                       key;
+            PixelFormatGpu                  pixelFormat;
+            AsyncTextureReadbackListener    *listener;
+            void                            *userData;
+            uint32                          frameIssued;
+            DeliveryThread                  deliveryThread;
+        };
+        typedef vector<PendingReadback>::type PendingReadbackVec;
+
+        struct QueuedResult
+        {
+            /// box.data is owned by us
+            TextureBox                      box;
+            PixelFormatGpu                  pixelFormat;
+            AsyncTextureReadbackListener    *listener;
+            void                            *userData;
+        };
+        typedef vector<QueuedResult>::type QueuedResultVec;
+
+        TicketPoolMap       mFreeTickets;
+        PendingReadbackVec  mPending;
+
+        /// Protects mQueuedResults
+        LightweightMutex    mQueuedResultsMutex;
+        QueuedResultVec     mQueuedResults;
+
+        TextureGpuManager   *mTextureManager;
+        VaoManager          *mVaoManager;
+
+        AsyncTextureTicket* acquireTicket( const TicketKey &key );
+        void releaseTicket( const TicketKey &key, AsyncTextureTicket *ticket );
+        void deliver( PendingReadback &pending );
+
+    public:
+        AsyncTextureReadback( TextureGpuManager *textureManager, VaoManager *vaoManager );
+        ~AsyncTextureReadback();
+
+        /** Schedules a download of texture.
+        @param texture
+            Texture to download from. It must be Resident, or scheduled to become Resident.
+        @param mipLevel
+            Mip level to download.
+        @param listener
+            Gets notified when the data is available. Must stay alive until then,
+            or call cancelReadbacks.
+        @param userData
+            Passed to the listener as is.
+        @param deliveryThread
+            See DeliveryThread.
+        @param srcBox
+            Optional. Region to download. When null, the whole mip is downloaded.
+        */
+        void requestReadback( TextureGpu *texture, uint8 mipLevel,
+                              AsyncTextureReadbackListener *listener, void *userData = 0,
+                              DeliveryThread deliveryThread = DeliverFromUpdate,
+                              TextureBox *srcBox = 0 );
+
+        /// Listener won't be called anymore for pending requests issued with it.
+        /// Must be called from the render thread, and not concurrently with
+        /// dispatchQueuedResults.
+        void cancelReadbacks( AsyncTextureReadbackListener *listener );
+
+        /// Checks which downloads are done and delivers them (or queues them
+        /// for dispatchQueuedResults). Must be called from the render thread.
+        void update(void);
+
+        /// Delivers the results of requests issued with DeliverFromDispatch.
+        /// Can be called from any thread.
+        void dispatchQueuedResults(void);
+
+        /// Number of requests whose data hasn't arrived yet.
+        size_t getNumPendingReadbacks(void) const       { return mPending.size(); }
+
+        /// Destroys all pooled tickets that aren't being used.
+        void releaseFreeTickets(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,354 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreBillboardChain2_H_
+#define _OgreBillboardChain2_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreMovableObject.h"
+#include "OgreRenderable.h"
+#include "OgreColourValue.h"
+#include "Vao/OgreStagingBuffer.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    /** v2 version of v1::BillboardChain. Renders chains of connected billboards
+        (trails, beams, lightning effects, etc) with HlmsUnlit.
+    @remarks
+        The elements live in a GPU ring buffer with a fixed slot per element, so adding
+        an element to the head only uploads that element and its neighbour, instead of
+        regenerating the whole vertex buffer. The quads are expanded in the vertex shader
+        (which also makes them face the camera), thus the uploaded data doesn't depend
+        on the camera either.
+    @par
+        Changes are uploaded once per frame by the SceneManager, after the node listeners
+        have been fired (see SceneManager::_queueBillboardChainUpdate). The uploads of all
+        chains are batched into one StagingBuffer.
+    @par
+        Unlike v1::BillboardChain, element positions are in world space and the
+        node the chain is attached to is only used for culling. Each chain segment
+        is a separate Renderable drawing a range of the shared buffers.
+    @par
+        Only HlmsUnlit datablocks are supported. Vertex colours and texture
+        coordinates are always provided.
+    @par
+        Create it via SceneManager::createMovableObject with
+        BillboardChainFactory::FACTORY_TYPE_NAME; optional parameters are
+        "maxElements" and "numberOfChains".
+    */
+    class _OgreExport BillboardChain : public MovableObject
+    {
+    public:
+        /** Contains the data of an element of the BillboardChain.
+        */
+        class _OgreExport Element
+        {
+        public:
+            Element();
+
+            Element( const Vector3 &position, Real width, Real texCoord,
+                     const ColourValue &colour, const Quaternion &orientation );
+
+            Vector3 position;
+            Real width;
+            /// U or V texture coord depending on options
+            Real texCoord;
+            ColourValue colour;
+
+            /// Only used when mFaceCamera == false
+            Quaternion orientation;
+        };
+        typedef vector<Element>::type ElementList;
+
+        /** The direction in which texture coordinates from elements of the
+            chain are used.
+        */
+        enum TexCoordDirection
+        {
+            /// Tex coord in elements is treated as the 'u' texture coordinate
+            TCD_U,
+            /// Tex coord in elements is treated as the 'v' texture coordinate
+            TCD_V
+        };
+
+    protected:
+        static const size_t SEGMENT_EMPTY;
+
+        /// Renders one chain segment. They all share the same buffers.
+        class _OgreExport ChainRenderable : public Renderable
+        {
+            BillboardChain *mParent;
+
+        public:
+            ChainRenderable( BillboardChain *parent, VertexArrayObject *vao );
+
+            virtual const LightList& getLights(void) const;
+            virtual void getRenderOperation( v1::RenderOperation &op, bool casterPass );
+            virtual void getWorldTransforms( Matrix4 *xform ) const;
+            virtual bool getCastsShadows(void) const;
+            /// Positions are in world space
+            virtual bool getUseIdentityWorldMatrix(void) const          { return true; }
+            virtual TexBufferPacked* getBillboardChainBuffer(void) const;
+        };
+
+        typedef FastArray<ChainRenderable*> ChainRenderableArray;
+        friend class ChainRenderable;
+
+        /** Defines a chain segment by referencing a subset of the ring buffer
+            (which is mMaxElementsPerChain * mChainCount long). head and tail are
+            inclusive and relative to start; the head is the newest element.
+            When the chain is empty head and tail are SEGMENT_EMPTY.
+        */
+        struct ChainSegment
+        {
+            size_t      start;
+            size_t      head;
+            size_t      tail;
+            /// Subtracted from the element's colour per second after it stops being the head
+            ColourValue colourChange;
+            /// Subtracted from the element's width per second after it stops being the head
+            Real        widthChange;
+            /// The vertex shader trims the chain where the odometer (distance travelled along
+            /// the chain, see mElementOdometers) is below this value
+            Real        trimOdometer;
+        };
+        typedef vector<ChainSegment>::type ChainSegmentList;
+
+        /// Maximum length of each chain
+        size_t mMaxElementsPerChain;
+        /// Number of chains
+        size_t mChainCount;
+        /// Texture coord direction
+        TexCoordDirection mTexCoordDir;
+        /// Other texture coord range
+        Real mOtherTexCoordRange[2];
+        /// When true, the billboards always face the camera
+        bool mFaceCamera;
+        /// Used when mFaceCamera == false; determines the billboard's "normal". i.e.
+        /// when the orientation is identity, the billboard is perpendicular to this
+        /// vector
+        Vector3 mNormalBase;
+        /// The list holding the chain elements
+        ElementList mChainElementList;
+        ChainSegmentList mChainSegmentList;
+
+        /// Per element: mCurrentTime when it stopped being the head. Used for fading
+        FastArray<float> mElementTimes;
+        /// Per element: distance to the tail along the chain, as elements were added. Grows
+        /// towards the head; the vertex shader uses it for trimming. See rebaseOdometers
+        FastArray<float> mElementOdometers;
+        /// Per element: whether it's in mDirtyElements
+        FastArray<uint8> mElementDirty;
+        /// Elements (index in mChainElementList) to upload on the next update
+        FastArray<uint32> mDirtyElements;
+
+        /// Seconds elapsed. See advanceTime
+        float               mCurrentTime;
+
+        VaoManager          *mVaoManager;
+        VertexBufferPacked  *mVertexBuffer;
+        IndexBufferPacked   *mIndexBuffer;
+        /// See Renderable::getBillboardChainBuffer
+        TexBufferPacked     *mParamsBuffer;
+        ChainRenderableArray mChainRenderables;
+
+        bool                mParamsDirty;
+        bool                mBoundsDirty;
+        bool                mQueuedForUpdate;
+        uint32              mLastParamsFrame;
+
+        void createBuffers(void);
+        void destroyBuffers(void);
+        /// Sizes the containers for mMaxElementsPerChain & mChainCount, and recreates the buffers
+        void setupChainContainers(void);
+
+        /// Asks the SceneManager to call _updateGpuData this frame
+        void queueUpdate(void);
+        /// Marks the element at the given slot (relative to the segment's start) to be uploaded
+        void markElementDirty( const ChainSegment &seg, size_t slot );
+        /// Slot of the element next to the given one, towards the tail. Doesn't check the tail
+        size_t getOlderSlot( size_t slot ) const;
+        size_t getNewerSlot( size_t slot ) const;
+        /// Recalculates the odometers from the given slot to the head
+        void updateOdometers( size_t chainIndex, size_t slot );
+        /// Re-uploads every element, after a setting that affects them all changed
+        void markAllElementsDirty(void);
+
+        /// Advances mCurrentTime, which fades the elements that aren't the head
+        void advanceTime( Real timeSinceLast );
+        /// Subtracts mCurrentTime from every element's time, keeping floats precise
+        void rebaseTime(void);
+        /// Makes the odometers of a chain start again from 0 at the tail
+        void rebaseOdometers( size_t chainIndex );
+
+        /// Writes the two vertices of an element
+        void writeElement( size_t elementIdx, float * RESTRICT_ALIAS vertexData ) const;
+        void updateBounds(void);
+
+    public:
+        /**
+        @param maxElements
+            The maximum number of elements per chain
+        @param numberOfChains
+            The number of separate chain segments contained in this object
+        */
+        BillboardChain( IdType id, ObjectMemoryManager *objectMemoryManager, SceneManager *manager,
+                        size_t maxElements = 20, size_t numberOfChains = 1 );
+        virtual ~BillboardChain();
+
+        /// Set the maximum number of chain elements per chain. Clears the chains
+        virtual void setMaxChainElements( size_t maxElements );
+        size_t getMaxChainElements(void) const                  { return mMaxElementsPerChain; }
+
+        /// Set the number of chain segments. Clears the chains
+        virtual void setNumberOfChains( size_t numChains );
+        size_t getNumberOfChains(void) const                    { return mChainCount; }
+
+        /** Sets the direction in which texture coords specified on each element
+            are deemed to run along the length of the chain.
+        @param dir The direction, default is TCD_U.
+        */
+        void setTextureCoordDirection( TexCoordDirection dir );
+        TexCoordDirection getTextureCoordDirection(void) const  { return mTexCoordDir; }
+
+        /** Set the range of the texture coordinates generated across the width of
+            the chain elements.
+        @param start Start coordinate, default 0.0
+        @param end End coordinate, default 1.0
+        */
+        void setOtherTextureCoordRange( Real start, Real end );
+        const Real* getOtherTextureCoordRange(void) const       { return mOtherTexCoordRange; }
+
+        /** Add an element to the 'head' of a chain.
+        @remarks
+            If this causes the number of elements to exceed the maximum elements
+            per chain, the last element in the chain (the 'tail') will be removed
+            to allow the additional element to be added.
+        @param chainIndex The index of the chain
+        @param billboardChainElement The details to add
+        */
+        virtual void addChainElement( size_t chainIndex, const Element &billboardChainElement );
+
+        /** Remove an element from the 'tail' of a chain.
+        @param chainIndex The index of the chain
+        */
+        virtual void removeChainElement( size_t chainIndex );
+
+        /** Update the details of an existing chain element.
+        @remarks
+            Moving an element that isn't the head also uploads all the newer ones, since
+            their odometers change. Updating the head is cheap.
+        @param chainIndex The index of the chain
+        @param elementIndex The element index within the chain, measured from
+            the 'head' of the chain
+        @param billboardChainElement The details to set
+        */
+        virtual void updateChainElement( size_t chainIndex, size_t elementIndex,
+                                         const Element &billboardChainElement );
+
+        /** Get the detail of a chain element.
+        @param chainIndex The index of the chain
+        @param elementIndex The element index within the chain, measured from
+            the 'head' of the chain
+        */
+        const Element& getChainElement( size_t chainIndex, size_t elementIndex ) const;
+
+        /** Returns the number of chain elements. */
+        size_t getNumChainElements( size_t chainIndex ) const;
+
+        /** Remove all elements of a given chain (but leave the chain intact). */
+        virtual void clearChain( size_t chainIndex );
+
+        /** Remove all elements from all chains (but leave the chains themselves intact). */
+        virtual void clearAllChains(void);
+
+        /// @copydoc v1::BillboardChain::setFaceCamera
+        void setFaceCamera( bool faceCamera, const Vector3 &normalVector=Vector3::UNIT_X );
+
+        /// Sets the datablock of all chains. Must be an HlmsUnlit one.
+        void setDatablock( HlmsDatablock *datablock );
+        void setDatablock( IdString datablockName );
+        HlmsDatablock* getDatablock(void) const;
+
+        /// Number of bytes _writeDirtyElements will write
+        size_t _getDirtyElementsSize(void) const;
+
+        /** Writes the elements changed since the last update and adds the regions of
+            the vertex buffer they go to.
+        @param stagingData
+            Where to write. Must hold _getDirtyElementsSize bytes.
+        @param stagingOffset
+            Offset of stagingData from the start of the mapped staging buffer.
+        @param outDestinations [out]
+            Regions to copy once the staging buffer is unmapped.
+        */
+        void _writeDirtyElements( uint8 * RESTRICT_ALIAS stagingData, size_t stagingOffset,
+                                  StagingBuffer::DestinationVec &outDestinations );
+
+        /// Called by the SceneManager once per frame after the dirty elements have been
+        /// uploaded, to update the parameters, draw ranges & bounds.
+        void _updateGpuData(void);
+
+        // Overrides from MovableObject
+        virtual const String& getMovableType(void) const;
+    };
+
+    /** Factory object for creating BillboardChain instances */
+    class _OgreExport BillboardChainFactory : public MovableObjectFactory
+    {
+    protected:
+        virtual MovableObject* createInstanceImpl( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                                   SceneManager *manager,
+                                                   const NameValuePairList* params = 0 );
+    public:
+        BillboardChainFactory() {}
+        virtual ~BillboardChainFactory() {}
+
+        static String FACTORY_TYPE_NAME;
+
+        const String& getType(void) const;
+        void destroyInstance( MovableObject* obj );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -101,6 +101,13 @@ namespace v1 {
             String doGet(const void* target) const;
             void doSet(void* target, const String& val);
         };
+        /** Command object for instanced rendering (see ParamCommand).*/
+        class _OgrePrivate CmdInstancedRendering : public ParamCommand
+        {
+        public:
+            String doGet(const void* target) const;
+            void doSet(void* target, const String& val);
+        };
         /** Command object for accurate facing(see ParamCommand).*/
         class _OgrePrivate CmdAccurateFacing : public ParamCommand
         {
@@ -197,6 +204,12 @@ namespace v1 {
         /// @copydoc BillboardSet::isPointRenderingEnabled
         bool isPointRenderingEnabled(void) const;
 
+        /// @copydoc BillboardSet::setInstancedRenderingEnabled
+        void setInstancedRenderingEnabled( bool enabled );
+
+        /// @copydoc BillboardSet::isInstancedRenderingEnabled
+        bool isInstancedRenderingEnabled(void) const;
+
 
 
         /// @copydoc ParticleSystemRenderer::getType
@@ -240,6 +253,7 @@ namespace v1 {
         static CmdCommonDirection msCommonDirectionCmd;
         static CmdCommonUpVector msCommonUpVectorCmd;
         static CmdPointRendering msPointRenderingCmd;
+        static CmdInstancedRendering msInstancedRenderingCmd;
         static CmdAccurateFacing msAccurateFacingCmd;
 
 
@@ -287,6 +287,22 @@ namespace v1 {
         /// Use point rendering?
         bool mPointRendering;
 
+        /// Requested via setInstancedRenderingEnabled
+        bool mInstancedRendering;
+        /// The current buffers were created for instanced rendering (see canRenderInstanced)
+        bool mUsingInstancedRendering;
+        /// One per render in the same frame, like mMainBuffers. See getBillboardInstanceBuffer
+        FastArray<TexBufferPacked*> mInstanceBuffers;
+        TexBufferPacked *mCurrentInstanceBuffer;
+        /// Billboards using their own texcoord rect written so far while mapped
+        uint32 mNumCustomTexcoordRects;
+
+        /// Whether instanced rendering was requested and the current settings support it
+        bool canRenderInstanced( const HlmsDatablock *datablock ) const;
+        void createInstanceBuffer(void);
+        /// Writes the billboard's record while instanced rendering
+        void genInstance( const Billboard &bb );
+
 
 
     private:
@@ -804,6 +820,38 @@ namespace v1 {
         virtual bool isPointRenderingEnabled(void) const
         { return mPointRendering; }
 
+        /** Sets whether billboards are expanded into quads by the vertex shader.
+        @remarks
+            Instead of writing 4 vertices per billboard every frame, only one record per
+            billboard is uploaded (see getBillboardInstanceBuffer) and HlmsUnlit generates
+            the corners from it. The vertex buffer is static.
+        @par
+            The following restrictions apply; when they're not met the set silently goes
+            back to generating the vertices on the CPU:
+            \li The datablock must be an HlmsUnlit one (not a v1 material)
+            \li BBT_ORIENTED_SELF, BBT_PERPENDICULAR_SELF and accurate facing aren't supported
+            \li Point rendering must be disabled and auto update enabled
+            \li Texture animation matrices of the datablock are ignored
+        @par
+            BBR_VERTEX rotation assumes the billboard axes are perpendicular and of the
+            same length, which holds unless the set is under a non-uniformly scaled node.
+        */
+        void setInstancedRenderingEnabled( bool enabled );
+        bool isInstancedRenderingEnabled(void) const        { return mInstancedRendering; }
+
+        /** Buffer with the billboards while rendering instanced. Layout, in float4s:
+            [0] = camera X axis (in billboard space), left offset
+            [1] = camera Y axis, right offset
+            [2] = top offset, bottom offset, 1 if BBR_VERTEX 0 if BBR_TEXCOORD,
+                  index of the first texcoord rect
+            Then 2 float4 per billboard, starting at 3:
+            [0] = position, colour (RGBA8 packed as uint, stored in the float's bits)
+            [1] = width, height, rotation in radians, texcoord rect index
+            Then the texcoord rects (left, top, right, bottom): the ones from
+            setTextureCoords followed by the ones of billboards using their own.
+        */
+        virtual TexBufferPacked* getBillboardInstanceBuffer(void) const;
+
         /** Set the auto update state of this billboard set.
         @remarks
             This methods controls the updating policy of the vertex buffer.
@@ -437,6 +437,16 @@ namespace Ogre {
             return Ogre::max( v / 32767.0f, -1.0f );
         }
 
+        static inline uint16 floatToUnorm16( float v )
+        {
+            return static_cast<uint16>( Math::Clamp( v * 65535.0f + 0.5f, 0.0f, 65535.0f ) );
+        }
+
+        static inline float unorm16ToFloat( uint16 v )
+        {
+            return v / 65535.0f;
+        }
+
         static inline int8 floatToSnorm8( float v )
         {
             //According to D3D10 rules, the value "-1.0f" has two representations:
@@ -41,6 +41,7 @@ namespace Ogre {
 
     class Matrix4;
     class Ray;
+    class HiZBuffer;
 
     struct VrData
     {
@@ -192,6 +193,9 @@ namespace Ogre {
         
         bool mNeedsDepthClamp;
 
+        /// Optional occlusion data. Not owned by us
+        HiZBuffer *mHiZBuffer;
+
         /// Whether or not the minimum display size of objects should take effect for this camera
         bool mUseMinPixelSize;
         /// @see Camera::getPixelDisplayRatio
@@ -716,6 +720,15 @@ namespace Ogre {
         void _setNeedsDepthClamp( bool bNeedsDepthClamp );
         bool getNeedsDepthClamp( void ) const { return mNeedsDepthClamp; }
 
+        /** Sets a Hi-Z buffer to perform occlusion culling when this camera is used
+            to cull objects for a regular (non-shadow) pass. @see HiZBuffer
+        @param hiZBuffer
+            The buffer to use. Null to disable occlusion culling. The pointer
+            is not owned by the camera and must outlive it (or be unset first).
+        */
+        void setHiZBuffer( HiZBuffer *hiZBuffer )   { mHiZBuffer = hiZBuffer; }
+        HiZBuffer* getHiZBuffer(void) const         { return mHiZBuffer; }
+
         /** Returns an estimated ratio between a pixel and the display area it represents.
             For orthographic cameras this function returns the amount of meters covered by
             a single pixel along the vertical axis. For perspective cameras the value
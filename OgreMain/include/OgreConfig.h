@@ -94,6 +94,7 @@ THE SOFTWARE.
 #define OGRE_MEMORY_ALLOCATOR_USER 3
 #define OGRE_MEMORY_ALLOCATOR_NEDPOOLING 4
 #define OGRE_MEMORY_ALLOCATOR_TRACK 5
+#define OGRE_MEMORY_ALLOCATOR_THREADPOOL 6
 
 #ifndef OGRE_MEMORY_ALLOCATOR
 #  define OGRE_MEMORY_ALLOCATOR OGRE_MEMORY_ALLOCATOR_NEDPOOLING
@@ -300,8 +300,15 @@ namespace Ogre {
 
         /** Close the stream; this makes further operations invalid. */
         virtual void close(void) = 0;
-        
 
+        /** Returns a pointer to the beginning of the stream's contents (size() bytes)
+            if they are already addressable in memory, null otherwise.
+        @remarks
+            Use it to parse data in place instead of reading it into a separate buffer.
+            The pointer is valid until the stream is closed or destroyed. Note that it
+            points to the beginning of the data, not to the current position (see tell).
+        */
+        virtual const uchar* getDataView(void) const { return 0; }
     };
 
     /// List of DataStream items
@@ -473,6 +480,45 @@ namespace Ogre {
 
         /** Sets whether or not to free the encapsulated memory on close. */
         void setFreeOnClose(bool free) { mFreeOnClose = free; }
+
+        /** @copydoc DataStream::getDataView
+        */
+        const uchar* getDataView(void) const { return mData; }
+    };
+
+    /** Read-only stream over a file mapped into memory.
+    @remarks
+        Pages are read by the OS on demand, so nothing is copied until it's accessed,
+        and getDataView / getPtr give direct access to the whole file.
+        The file should not be modified while it is mapped.
+    */
+    class _OgreExport MappedFileDataStream : public MemoryDataStream
+    {
+    protected:
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        /// HANDLE returned by CreateFileMapping
+        void *mFileMapping;
+#endif
+
+        MappedFileDataStream( const String &name, void *pMem, size_t size );
+
+    public:
+        ~MappedFileDataStream();
+
+        /** Maps a file into memory.
+        @param name
+            The name to give the stream.
+        @param fullPath
+            Path to the file, in UTF-8.
+        @return
+            The stream, or null if the file could not be mapped
+            (e.g. it's empty or the platform doesn't support it).
+        */
+        static MappedFileDataStream* open( const String &name, const String &fullPath );
+
+        /** @copydoc DataStream::close
+        */
+        void close(void);
     };
 
     /** Common subclass of DataStream for handling data from 
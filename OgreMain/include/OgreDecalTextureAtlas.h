@@ -0,0 +1,218 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreDecalTextureAtlas_H_
+#define _OgreDecalTextureAtlas_H_
+
+#include "OgrePrerequisites.h"
+#include "OgrePixelFormatGpu.h"
+#include "ogrestd/map.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /**
+    @class DecalTextureAtlas
+        Manages the Type2DArray used by Decals (see SceneManager::setDecalsDiffuse & co.)
+        or by area light masks (see HlmsPbs::setAreaLightMasks), so that slices don't
+        have to be sized and assigned by hand.
+
+        All textures go into a single pool created via TextureGpuManager::reservePoolId.
+        When it runs out of slices, unreferenced textures are evicted (least recently
+        released first) and if there are none, the pool grows (see
+        TextureGpuManager::resizeReservedPool). Since growing changes the master
+        texture, you must set a Listener to rebind it.
+
+        Textures loaded from file are streamed through TextureGpuManager as usual.
+        Their resolution, pixel format and number of mipmaps must match those of the atlas.
+
+        Runtime generated textures (see acquireTexture overload with an Image2) are
+        compressed to the atlas' format when it's BC1, BC3, BC4 or BC5.
+    */
+    class _OgreExport DecalTextureAtlas : public ResourceAlloc
+    {
+    public:
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+
+            /// Called after the atlas' pool was replaced by a bigger one.
+            /// The old master texture has already been destroyed.
+            virtual void atlasTextureChanged( DecalTextureAtlas *atlas, TextureGpu *newMaster ) = 0;
+        };
+
+    protected:
+        struct Entry
+        {
+            uint32  refCount;
+            /// mFrameCount value when refCount went down to 0
+            uint32  lastUsedFrame;
+            /// Contents were provided via an Image2; they can't be reloaded once evicted
+            bool    fromImage;
+            /// Texture is Resident or going to be, thus holds a slice in the pool
+            bool    isLive;
+        };
+
+        typedef map<TextureGpu*, Entry>::type EntryMap;
+
+        TextureGpuManager   *mTextureGpuManager;
+        TextureGpu          *mMasterTexture;
+
+        uint32              mPoolId;
+        uint16              mMaxSlices;
+        float               mGrowthFactor;
+        uint32              mEvictionDelay;
+        uint32              mFrameCount;
+        uint32              mNumLiveEntries;
+
+        EntryMap            mEntries;
+        Listener            *mListener;
+
+        /// Makes sure there is a free slice for one more live texture,
+        /// evicting or growing as needed. Throws if the atlas is at mMaxSlices.
+        void reserveSlice(void);
+        bool evictLeastRecentlyUsed(void);
+        void evict( EntryMap::iterator itor );
+        void grow(void);
+        void makeLive( TextureGpu *texture, Entry &entry );
+
+        /// Converts (and compresses if needed) the image to the atlas' format, and generates
+        /// the mipmaps it lacks. Returns the image to upload, which is either 'image' or
+        /// a newly allocated one (in which case 'image' is deleted if autoDeleteImage is true)
+        Image2* prepareImage( Image2 *image, bool autoDeleteImage );
+
+    public:
+        /**
+        @param textureGpuManager
+        @param poolId
+            Pool ID used for reservePoolId. Must not be used by anything else.
+        @param width
+        @param height
+        @param numMipmaps
+        @param pixelFormat
+            Resolution and format of every texture in the atlas.
+        @param initialSlices
+            Number of slices the pool starts with.
+        @param maxSlices
+            The pool won't grow beyond this. Usually limited by the API's max array size.
+        */
+        DecalTextureAtlas( TextureGpuManager *textureGpuManager, uint32 poolId,
+                           uint32 width, uint32 height, uint8 numMipmaps,
+                           PixelFormatGpu pixelFormat, uint16 initialSlices,
+                           uint16 maxSlices = 2048u );
+        ~DecalTextureAtlas();
+
+        /** Loads a texture from file into the atlas, or adds a reference if it's already in.
+        @remarks
+            Decal::setDiffuseTexture & co. take care of making the texture Resident.
+            Call releaseTexture once the texture is no longer in use.
+        @param name
+            Name of the file to load.
+        @param resourceGroup
+        @param filters
+            See TextureFilter::FilterTypes.
+        */
+        TextureGpu* acquireTexture( const String &name, const String &resourceGroup,
+                                    uint32 filters = 0 );
+
+        /** Adds a runtime generated texture to the atlas, or adds a reference if a texture
+            with that name is already in (in which case the image is ignored).
+            See updateTexture to change its contents.
+        @remarks
+            Runtime generated textures are destroyed, rather than paged out, when evicted.
+        @param aliasName
+            Unique name of the texture.
+        @param image
+            Contents of the texture. Its resolution must match the atlas'.
+        @param autoDeleteImage
+            When true, we will delete the image once we're done with it.
+        */
+        TextureGpu* acquireTexture( const String &aliasName, Image2 *image, bool autoDeleteImage );
+
+        /** Replaces the contents of a runtime generated texture.
+            If the texture is ready, the slice is uploaded in place, without going through
+            OnStorage and back (which would reassign its slice and can cause flickering).
+        */
+        void updateTexture( TextureGpu *texture, Image2 *image, bool autoDeleteImage );
+
+        /// Removes a reference added by acquireTexture. Once there are no references,
+        /// the texture is evicted after getEvictionDelay frames (or sooner if space is needed)
+        void releaseTexture( TextureGpu *texture );
+
+        /// Evicts textures whose references were released long enough ago.
+        /// Call it once per frame.
+        void update(void);
+
+        /// Number of frames unreferenced textures are kept in the atlas, in case they're
+        /// acquired again. Use std::numeric_limits<uint32>::max() to evict only when full.
+        void setEvictionDelay( uint32 numFrames )       { mEvictionDelay = numFrames; }
+        uint32 getEvictionDelay(void) const             { return mEvictionDelay; }
+
+        /// How much bigger the pool gets every time it grows. Must be > 1.
+        void setGrowthFactor( float factor );
+        float getGrowthFactor(void) const               { return mGrowthFactor; }
+
+        void setListener( Listener *listener )          { mListener = listener; }
+        Listener* getListener(void) const               { return mListener; }
+
+        /// Texture to bind to SceneManager::setDecalsDiffuse & co. See Listener.
+        TextureGpu* getMasterTexture(void) const        { return mMasterTexture; }
+
+        /// Number of textures currently holding a slice
+        uint32 getNumLiveTextures(void) const           { return mNumLiveEntries; }
+        uint32 getCapacity(void) const;
+
+        /** Compresses each mip of src into dst using a fast, low quality, encoder.
+        @param src
+            Image to compress. Any uncompressed format supported by
+            PixelFormatGpuUtils::unpackColour.
+        @param dstFormat
+            One of PFG_BC1_UNORM, PFG_BC3_UNORM, PFG_BC4_UNORM, PFG_BC5_UNORM
+            (or their sRGB variants). The data is not gamma converted.
+        @param outDst [out]
+        */
+        static void compressImage( const Image2 &src, PixelFormatGpu dstFormat, Image2 &outDst );
+        static bool canCompressTo( PixelFormatGpu format );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -32,6 +32,7 @@ THE SOFTWARE.
 #include "OgreRenderOperation.h"
 #include "OgreVector3.h"
 #include "OgreVector4.h"
+#include "ogrestd/unordered_map.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -231,17 +232,40 @@ namespace v1 {
                 return a.indexSet < b.indexSet;
             }
         };
-        /** Comparator for unique vertex list */
-        struct vectorLess {
-            bool operator()(const Vector3& a, const Vector3& b) const
+        /** Hash for unique vertex list. Positions are welded by exact value, so hashing
+            the bit patterns is enough (once -0 has been turned into +0 to match operator==)
+        */
+        struct vectorHash {
+            size_t operator()(const Vector3& a) const
+            {
+                uint32 bits[3];
+                const float values[3] = { a.x + 0.0f, a.y + 0.0f, a.z + 0.0f };
+                memcpy( bits, values, sizeof( bits ) );
+                uint32 retVal = 2166136261u;
+                for( size_t i=0; i<3u; ++i )
+                    retVal = ( retVal ^ bits[i] ) * 16777619u;
+                return retVal;
+            }
+        };
+        /** Hash for edges keyed by their pair of shared vertices */
+        struct edgeHash {
+            size_t operator()(const std::pair<size_t, size_t>& a) const
             {
-                if (a.x < b.x) return true;
-                if (a.x > b.x) return false;
-                if (a.y < b.y) return true;
-                if (a.y > b.y) return false;
-                return a.z < b.z;
+                return a.first * 2654435761u ^ a.second;
             }
         };
+        /** An edge waiting for its opposite side. Edges on the same pair of shared
+            vertices are chained in creation order */
+        struct OpenEdge {
+            size_t vertexSet;
+            size_t edgeIndex;
+            size_t next;
+        };
+        /** First & last open edge of a chain */
+        struct OpenEdgeChain {
+            size_t first;
+            size_t last;
+        };
 
         typedef vector<const VertexData*>::type VertexDataList;
         typedef vector<Geometry>::type GeometryList;
@@ -252,13 +276,16 @@ namespace v1 {
         CommonVertexList mVertices;
         EdgeData* mEdgeData;
         /// Map for identifying common vertices
-        typedef map<Vector3, size_t, vectorLess>::type CommonVertexMap;
+        typedef unordered_map<Vector3, size_t, vectorHash>::type CommonVertexMap;
         CommonVertexMap mCommonVertexMap;
         /** Edge map, used to connect edges. Note we allow many triangles on an edge,
         after connected an existing edge, we will remove it and never used again.
+        Edges on the same shared vertices are connected in the order they were created.
         */
-        typedef multimap< std::pair<size_t, size_t>, std::pair<size_t, size_t> >::type EdgeMap;
+        typedef unordered_map<std::pair<size_t, size_t>, OpenEdgeChain, edgeHash>::type EdgeMap;
         EdgeMap mEdgeMap;
+        typedef vector<OpenEdge>::type OpenEdgeList;
+        OpenEdgeList mOpenEdges;
 
         void buildTrianglesEdges(const Geometry &geometry);
 
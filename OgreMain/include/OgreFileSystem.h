@@ -72,6 +72,9 @@ namespace Ogre {
         /// @copydoc Archive::isCaseSensitive
         bool isCaseSensitive(void) const;
 
+        /// Every stream uses its own file handle
+        bool isThreadSafe() const { return true; }
+
         /// @copydoc Archive::load
         void load();
         /// @copydoc Archive::unload
@@ -120,7 +123,27 @@ namespace Ogre {
             return msIgnoreHidden;
         }
 
+        /** Set whether read-only files are mapped into memory (see MappedFileDataStream)
+            instead of being read through an std::ifstream.
+        @remarks
+            Consumers that check DataStream::getDataView can then parse the file in place,
+            avoiding a copy of the whole file. Files must not be modified while they're
+            open. Falls back to std::ifstream if the file can't be mapped.
+            The default is false.
+        */
+        static void setUseMemoryMapping(bool useMapping)
+        {
+            msUseMemoryMapping = useMapping;
+        }
+
+        /// Get whether read-only files are mapped into memory.
+        static bool getUseMemoryMapping()
+        {
+            return msUseMemoryMapping;
+        }
+
         static bool msIgnoreHidden;
+        static bool msUseMemoryMapping;
     };
 
     /** Specialisation of ArchiveFactory for FileSystem files. */
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreForwardPlusBase.h"
 #include "OgreRawPtr.h"
+#include "OgreResourceTransition.h"
 #include "Threading/OgreUniformScalableTask.h"
 #include "OgreHeaderPrefix.h"
 
@@ -43,6 +44,8 @@ namespace Ogre
     *  @{
     */
 
+    class WorkStealingScheduler;
+
     /** Implementation of Clustered Forward Shading */
     class _OgreExport ForwardClustered : public ForwardPlusBase, public UniformScalableTask
     {
@@ -80,10 +83,23 @@ namespace Ogre
         ObjectMemoryManager     *mObjectMemoryManager;
         NodeMemoryManager       *mNodeMemoryManager;
         vector<Camera*>::type   mThreadCameras;
+        /// Distributes the slices among worker threads. Slices closer to the camera
+        /// tend to be much more expensive, so idle threads steal from busy ones.
+        WorkStealingScheduler   *mSliceScheduler;
 
         bool                    mDebugWireAabbFrozen;
         vector<WireAabb*>::type mDebugWireAabb;
 
+        bool                    mGpuLightAssignment;
+        bool                    mGpuUseDepthBounds;
+        /// True only while inside _collectLightsBeforePass, where dispatches are allowed
+        bool                    mGpuDispatchAllowed;
+        TextureGpu              *mGpuDepthTexture;
+        HlmsComputeJob          *mGpuJob;
+        RenderSystem            *mGpuRenderSystem;
+        ResourceTransition      mGpuToUavTransition;
+        ResourceTransition      mGpuToTextureTransition;
+
         inline size_t getDecalsOffsetStart() const;
         inline size_t getCubemapProbesOffsetStart() const;
 
@@ -106,6 +122,14 @@ namespace Ogre
 
         void collectObjs( const Camera *camera, size_t &outNumDecals, size_t &outNumCubemapProbes );
 
+        /// Returns true if the grid for this camera can be filled by the compute job
+        bool canAssignOnGpu( const Camera *camera ) const;
+        void createGpuJob(void);
+        void destroyGpuJob(void);
+        /// Bins the lights, decals & probes already in globalLightListBuffer on the GPU
+        void assignOnGpu( const Camera *camera, CachedGridBuffer &gridBuffers,
+                          size_t numLights, size_t numDecals, size_t numCubemapProbes );
+
     public:
         ForwardClustered( uint32 width, uint32 height, uint32 numSlices, uint32 lightsPerCell,
                           uint32 decalsPerCell, uint32 cubemapProbesPerCell,
@@ -125,6 +149,32 @@ namespace Ogre
 
         virtual void collectLights( Camera *camera );
 
+        virtual void _collectLightsBeforePass( Camera *camera, TextureGpu *prePassDepthTexture );
+
+        virtual void _changeRenderSystem( RenderSystem *newRs );
+
+        /** Bins the lights, decals & cubemap probes into the grid with a compute shader,
+            instead of using the worker threads and uploading the whole grid every frame.
+        @remarks
+            Requires compute shader support and the resources bundled at
+            Samples/Media/2.0/scripts/materials/Common (ForwardClustered/LightAssignment).
+            Falls back to the CPU path when unsupported, for orthographic or reflected
+            cameras, and when the lights are collected from within a render pass
+            (i.e. outside of CompositorPassScene).
+        @par
+            The GPU tests are conservative (light shapes vs. each cell's AABB), thus cells
+            may contain a few more lights than with the CPU path. The debug frustum
+            wire AABBs are not updated while this is enabled.
+        @param bEnable
+            True to fill the grid on the GPU.
+        @param bUseDepthBounds
+            When true and the pass has a depth prepass (non-MSAA), cells behind the farthest
+            depth of their tile are left empty.
+        */
+        void setGpuLightAssignment( bool bEnable, bool bUseDepthBounds=true );
+        bool getGpuLightAssignment(void) const                          { return mGpuLightAssignment; }
+        bool getGpuLightAssignmentUsesDepthBounds(void) const           { return mGpuUseDepthBounds; }
+
         uint32 getWidth(void) const                                     { return mWidth; }
         uint32 getHeight(void) const                                    { return mHeight; }
         uint32 getNumSlices(void) const                                 { return mNumSlices; }
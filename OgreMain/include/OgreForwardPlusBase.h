@@ -62,8 +62,16 @@ namespace Ogre
         struct CachedGridBuffer
         {
             TexBufferPacked *gridBuffer;
+            /// When the grid is filled on the GPU, gridBuffer is a view of this buffer
+            UavBufferPacked *gridUavBuffer;
             TexBufferPacked *globalLightListBuffer;
-            CachedGridBuffer() : gridBuffer( 0 ), globalLightListBuffer( 0 ) {}
+            /// Number of lights written to globalLightListBuffer (decals & probes not included)
+            uint32          numLights;
+            /// Depth buffer used to tighten the grid when filled on the GPU. Only compared against.
+            TextureGpu const *gpuDepthTexture;
+            CachedGridBuffer() :
+                gridBuffer( 0 ), gridUavBuffer( 0 ), globalLightListBuffer( 0 ), numLights( 0 ),
+                gpuDepthTexture( 0 ) {}
         };
 
         typedef vector<CachedGridBuffer>::type CachedGridBufferVec;
@@ -93,6 +101,10 @@ namespace Ogre
             CompositorShadowNode const *shadowNode;
             /// Last frame this cache was updated.
             uint32                  lastFrame;
+            /// Lights that were dropped by rankLightsByImportance, approximated as
+            /// hemisphere ambient. See setDistantLightsToAmbient
+            ColourValue             distantLightsUpperHemi;
+            ColourValue             distantLightsLowerHemi;
 
             uint32                  currentBufIdx;
             CachedGridBufferVec     gridBuffers;
@@ -123,6 +135,29 @@ namespace Ogre
 
         FastArray<LightCount>   mLightCountInCell;
 
+        struct LightImportance
+        {
+            Light   *light;
+            Real    importance;
+            /// Estimation of the screen area covered by the light, in range [0; 1]
+            Real    coverage;
+            LightImportance( Light *_light, Real _importance, Real _coverage ) :
+                light( _light ), importance( _importance ), coverage( _coverage ) {}
+            bool operator < ( const LightImportance &other ) const
+            {
+                //Cells expect the lights grouped by type. Most important go first.
+                if( light->getType() != other.light->getType() )
+                    return light->getType() < other.light->getType();
+                return importance > other.importance;
+            }
+        };
+
+        /// Lives here to reuse memory. See rankLightsByImportance
+        FastArray<LightImportance>  mLightImportance;
+        /// Same size as mCurrentLightList when light importance is enabled, otherwise empty.
+        /// Multiplies the colour of each light in fillGlobalLightListBuffer.
+        FastArray<float>        mLightFadeFactors;
+
         // Used to save and restore visibility of shadow casting lights. Lives here
         // to reuse memory, otherwise on stack it keeps constantly reallocating memory
         FastArray<bool>   mShadowCastingLightVisibility;
@@ -136,6 +171,11 @@ namespace Ogre
         bool    mEnableVpls;
         bool    mDecalsEnabled;
         bool    mCubemapProbesEnabled;
+        bool    mLightImportanceEnabled;
+        bool    mDistantLightsToAmbient;
+        Real    mMinLightImportance;
+        Real    mLightImportanceFadeRange;
+        Real    mDistantLightsAmbientScale;
 #if !OGRE_NO_FINE_LIGHT_MASK_GRANULARITY
         bool    mFineLightMaskGranularity;
 #endif
@@ -147,6 +187,15 @@ namespace Ogre
 
         void fillGlobalLightListBuffer( Camera *camera, TexBufferPacked *globalLightListBuffer );
 
+        /** Sorts mCurrentLightList by importance (within each light type, since cells
+            store them grouped by type), removes the lights below mMinLightImportance and
+            fills mLightFadeFactors. Must be called right after culling the lights.
+        @return
+            False if light importance is disabled, in which case nothing was done and
+            the caller must sort the lights by distance as usual.
+        */
+        bool rankLightsByImportance( Camera *camera, CachedGrid *cachedGrid );
+
         /** Finds a grid already cached in mCachedGrid that can be used for the given camera.
             If the cache does not exist, we create a new entry.
         @param camera
@@ -163,6 +212,9 @@ namespace Ogre
         /// output a null pointer instead (also returns false in that case).
         bool getCachedGridFor( const Camera *camera, const CachedGrid **outCachedGrid ) const;
 
+        /// Destroys gridBuffer (or gridUavBuffer, if the grid was filled on the GPU)
+        void destroyGridBuffer( CachedGridBuffer &gridBuffers );
+
         /// Check if some of the caches are really old and delete them
         void deleteOldGridBuffers(void);
 
@@ -172,10 +224,21 @@ namespace Ogre
 
         virtual ForwardPlusMethods getForwardPlusMethod(void) const = 0;
 
-        void _changeRenderSystem( RenderSystem *newRs );
+        virtual void _changeRenderSystem( RenderSystem *newRs );
 
         virtual void collectLights( Camera *camera ) = 0;
 
+        /** Called by CompositorPassScene before the render pass begins (i.e. outside of it).
+            Implementations that build their grid with compute shaders collect the lights
+            here, since dispatches can't be issued once the pass has started.
+            collectLights will still be called later, and will find the cache up to date.
+        @param camera
+            The camera that will be used for culling.
+        @param prePassDepthTexture
+            Depth buffer from a depth prepass (may be null). Can be used to tighten the grid.
+        */
+        virtual void _collectLightsBeforePass( Camera *camera, TextureGpu *prePassDepthTexture ) {}
+
         bool isCacheDirty( const Camera *camera ) const;
 
         /// Cache the return value as internally we perform an O(N) search
@@ -183,6 +246,18 @@ namespace Ogre
         /// Cache the return value as internally we perform an O(N) search
         TexBufferPacked* getGlobalLightListBuffer( const Camera *camera ) const;
 
+        /** Returns the global light list collected for the given camera during the current
+            frame, regardless of which shadow node was active when it was collected.
+            Useful for passes that run after the render_scene pass that collected the lights
+            (e.g. deferred shading compute jobs).
+        @param outNumLights [out]
+            Number of lights in the returned buffer. Decals and cubemap probes are not counted.
+        @return
+            Null if collectLights wasn't called for this camera in the current frame.
+            Cache the return value as internally we perform an O(N) search
+        */
+        TexBufferPacked* findGlobalLightListBuffer( const Camera *camera, uint32 &outNumLights ) const;
+
         /// Returns the amount of bytes that fillConstBufferData is going to fill.
         virtual size_t getConstBufferSize(void) const = 0;
 
@@ -223,6 +298,48 @@ namespace Ogre
 
         bool getDecalsEnabled(void) const                               { return mDecalsEnabled; }
 
+        /** Ranks lights by their estimated shading cost-effectiveness instead of their
+            distance to the camera.
+        @remarks
+            Importance = max( diffuse * powerScale ) * min( 1, (attenRange / distance)^2 )
+            where distance is the distance to the camera. i.e. its intensity times an
+            estimation of how much of the screen it covers.
+            Cells store lights in the order they're in the global list until they're full
+            (see ForwardClustered's lightsPerCell), thus when a cell overflows the least
+            important lights are the ones left out instead of the farthest ones.
+            Lights below minImportance are removed altogether and lights just above it
+            are faded in, to avoid popping. They can be kept as ambient lighting, see
+            setDistantLightsToAmbient.
+        @param minImportance
+            Lights whose importance is below this value are not sent to the GPU.
+        @param fadeRange
+            Lights with importance in range [minImportance; minImportance * (1 + fadeRange)]
+            are faded. Must be > 0.
+        */
+        void setLightImportance( bool enable, Real minImportance = 0.01f, Real fadeRange = 1.0f );
+        bool getLightImportanceEnabled(void) const              { return mLightImportanceEnabled; }
+        Real getMinLightImportance(void) const                  { return mMinLightImportance; }
+        Real getLightImportanceFadeRange(void) const    { return mLightImportanceFadeRange; }
+
+        /** When light importance is enabled, lights that were dropped (or faded) are
+            accumulated into an upper & lower hemisphere ambient term, which HlmsPbs adds
+            to the SceneManager's ambient light. Cheap approximation of many distant lights.
+        @param scale
+            Multiplies the accumulated ambient.
+        */
+        void setDistantLightsToAmbient( bool enable, Real scale = 1.0f );
+        bool getDistantLightsToAmbient(void) const              { return mDistantLightsToAmbient; }
+        Real getDistantLightsAmbientScale(void) const   { return mDistantLightsAmbientScale; }
+
+        /** Retrieves the ambient approximation of the dropped lights for the given camera
+            during the current frame.
+        @return
+            False if there is none (disabled, or collectLights wasn't called for the camera).
+            outUpperHemi & outLowerHemi are left untouched in that case.
+        */
+        bool getDistantLightsAmbient( const Camera *camera, ColourValue &outUpperHemi,
+                                      ColourValue &outLowerHemi ) const;
+
 #if !OGRE_NO_FINE_LIGHT_MASK_GRANULARITY
         /// Toggles whether light masks will be obeyed per object & per light by doing:
         /// if( movableObject->getLightMask() & light->getLightMask() )
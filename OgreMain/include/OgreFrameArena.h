@@ -0,0 +1,433 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreFrameArena_H_
+#define _OgreFrameArena_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreSingleton.h"
+#include "OgrePlatformInformation.h"
+#include "OgreFastArray.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Memory
+    *  @{
+    */
+
+    class FrameArenaManager;
+
+    /** Linear allocator for data that only lives until the end of the current frame.
+    @remarks
+        Allocating is just bumping a pointer, and there is no deallocation: all the memory
+        is reclaimed at once after Root::_fireFrameEnded. When a frame needs more memory
+        than what's reserved, a new chunk is allocated; on reset the chunks are merged into
+        a single one big enough for the whole frame, so after a few frames the arena no
+        longer touches the heap.
+    @par
+        A FrameArena is not thread safe. Each thread has its own one,
+        @see FrameArenaManager::getThreadArena
+    */
+    class _OgreExport FrameArena
+    {
+        struct Chunk
+        {
+            uint8   *data;
+            size_t  size;
+        };
+
+        FastArray<Chunk>    mChunks;
+        /// Offset into the last chunk
+        size_t              mCurrentOffset;
+        size_t              mBytesUsed;
+        size_t              mPeakBytesUsed;
+        size_t              mChunkSize;
+        /// Value of FrameArenaManager::getFrameGeneration when we were last reset
+        uint32              mFrameGeneration;
+        FrameArenaManager   *mCreator;
+
+        void addChunk( size_t minBytes );
+        void freeChunks(void);
+
+    public:
+        FrameArena( size_t chunkSize, FrameArenaManager *creator );
+        ~FrameArena();
+
+        /** Allocates memory that is valid until the end of the frame.
+        @param bytes
+            Size of the allocation.
+        @param alignment
+            Alignment in bytes. Must be a power of 2.
+        */
+        void* allocate( size_t bytes, size_t alignment = OGRE_SIMD_ALIGNMENT );
+
+        /// Reclaims all the memory allocated since the last reset.
+        void reset(void);
+
+        size_t getBytesUsed(void) const         { return mBytesUsed; }
+        /// Highest getBytesUsed seen before a reset.
+        size_t getPeakBytesUsed(void) const     { return mPeakBytesUsed; }
+        /// Sum of the sizes of all chunks.
+        size_t getBytesReserved(void) const;
+    };
+
+    /** Owns the FrameArena of each thread and resets them at the end of every frame.
+    @remarks
+        Resets are lazy: Root::_fireFrameEnded only bumps the frame generation, and each arena
+        resets itself on its next allocation from its own thread. Thus threads that are running
+        outside the frame (e.g. WorkQueue workers) never see their memory being pulled from
+        under them while allocating. However any memory obtained within a frame must not be
+        used after that frame ends.
+    */
+    class _OgreExport FrameArenaManager : public Singleton<FrameArenaManager>,
+                                          public GeneralAllocatedObject
+    {
+        typedef FastArray<FrameArena*> FrameArenaArray;
+
+        LightweightMutex    mMutex; //Protects mArenas
+        FrameArenaArray     mArenas;
+        TlsHandle           mTlsHandle;
+        size_t              mChunkSize;
+        uint32              mFrameGeneration;
+
+        FrameArena* createThreadArena(void);
+
+    public:
+        /**
+        @param chunkSize
+            Initial size of each thread's arena, also the minimum size of the
+            chunks added when it runs out of memory.
+        */
+        FrameArenaManager( size_t chunkSize = 256u * 1024u );
+        ~FrameArenaManager();
+
+        /// Returns the arena of the calling thread, creating it if necessary.
+        FrameArena& getArena(void);
+
+        /// Shortcut for FrameArenaManager::getSingleton().getArena()
+        static FrameArena& getThreadArena(void);
+
+        uint32 getFrameGeneration(void) const               { return mFrameGeneration; }
+
+        /// Marks all arenas to be reset on their next use. Called by Root at the end of the frame.
+        void _notifyFrameEnded(void);
+
+        /// Sum of FrameArena::getPeakBytesUsed of all threads.
+        size_t getPeakBytesUsed(void);
+
+        /// @copydoc Singleton::getSingleton()
+        static FrameArenaManager& getSingleton(void);
+        /// @copydoc Singleton::getSingleton()
+        static FrameArenaManager* getSingletonPtr(void);
+    };
+
+    /** FastArray-like container for per-frame temporaries whose memory comes from a FrameArena.
+    @remarks
+        Growing allocates a new block from the arena and leaves the old one until the arena
+        is reset. Just like FastArray, elements are relocated with memcpy.
+    @par
+        The contents become invalid at the end of the frame. Never keep a FrameArray
+        (or pointers to its elements) across frames, and prefer reserve() when the final
+        size is known to avoid wasting arena space.
+    */
+    template <typename T> class FrameArray
+    {
+        T           *mData;
+        size_t      mSize;
+        size_t      mCapacity;
+        FrameArena  *mArena;
+
+        void growToFit( size_t newElements )
+        {
+            if( mSize + newElements > mCapacity )
+            {
+                mCapacity = std::max<size_t>( mSize + newElements, mCapacity + (mCapacity >> 1u) + 1u );
+                T *data = reinterpret_cast<T*>( mArena->allocate( mCapacity * sizeof(T),
+                                                                  OGRE_SIMD_ALIGNMENT ) );
+                if( mData )
+                    memcpy( data, mData, mSize * sizeof(T) );
+                mData = data;
+            }
+        }
+
+        //Copies are not allowed; they would share the arena in non-obvious ways
+        FrameArray( const FrameArray<T> &copy );
+        void operator = ( const FrameArray<T> &copy );
+
+    public:
+        typedef T value_type;
+
+        typedef T* iterator;
+        typedef const T* const_iterator;
+
+        FrameArray() :
+            mData( 0 ),
+            mSize( 0 ),
+            mCapacity( 0 ),
+            mArena( &FrameArenaManager::getThreadArena() )
+        {
+        }
+
+        explicit FrameArray( FrameArena &arena ) :
+            mData( 0 ),
+            mSize( 0 ),
+            mCapacity( 0 ),
+            mArena( &arena )
+        {
+        }
+
+        ~FrameArray()
+        {
+            for( size_t i=0; i<mSize; ++i )
+                mData[i].~T();
+        }
+
+        size_t size() const                     { return mSize; }
+        size_t capacity() const                 { return mCapacity; }
+        T* data()                               { return mData; }
+        const T* data() const                   { return mData; }
+
+        void push_back( const T& val )
+        {
+            growToFit( 1 );
+            new (&mData[mSize]) T( val );
+            ++mSize;
+        }
+
+        void pop_back()
+        {
+            assert( mSize > 0 && "Can't pop a zero-sized array" );
+            --mSize;
+            mData[mSize].~T();
+        }
+
+        void clear()
+        {
+            for( size_t i=0; i<mSize; ++i )
+                mData[i].~T();
+            mSize = 0;
+        }
+
+        bool empty() const                      { return mSize == 0; }
+
+        void reserve( size_t reserveAmount )
+        {
+            if( reserveAmount > mCapacity )
+                growToFit( reserveAmount - mSize );
+        }
+
+        void resize( size_t newSize, const T &value=T() )
+        {
+            if( newSize > mSize )
+            {
+                growToFit( newSize - mSize );
+                for( size_t i=mSize; i<newSize; ++i )
+                    new (&mData[i]) T( value );
+            }
+            else
+            {
+                for( size_t i=newSize; i<mSize; ++i )
+                    mData[i].~T();
+            }
+
+            mSize = newSize;
+        }
+
+        T& operator [] ( size_t idx )
+        {
+            assert( idx < mSize && "Index out of bounds" );
+            return mData[idx];
+        }
+
+        const T& operator [] ( size_t idx ) const
+        {
+            assert( idx < mSize && "Index out of bounds" );
+            return mData[idx];
+        }
+
+        T& back()
+        {
+            assert( mSize > 0 && "Can't call back with no elements" );
+            return mData[mSize-1];
+        }
+
+        const T& back() const
+        {
+            assert( mSize > 0 && "Can't call back with no elements" );
+            return mData[mSize-1];
+        }
+
+        T& front()
+        {
+            assert( mSize > 0 && "Can't call front with no elements" );
+            return mData[0];
+        }
+
+        const T& front() const
+        {
+            assert( mSize > 0 && "Can't call front with no elements" );
+            return mData[0];
+        }
+
+        iterator begin()                        { return mData; }
+        const_iterator begin() const            { return mData; }
+        iterator end()                          { return mData + mSize; }
+        const_iterator end() const              { return mData + mSize; }
+    };
+
+    /** StackVector-like container that keeps up to Capacity elements inline, and spills
+        into a FrameArena instead of asserting when that isn't enough.
+    @remarks
+        Same lifetime rules as FrameArray once it has spilled. Elements are assigned
+        into and relocated with memcpy, so T should be a plain data type.
+    */
+    template <typename T, size_t Capacity> class FrameStackVector
+    {
+        T           mLocalData[Capacity];
+        T           *mData;
+        size_t      mSize;
+        size_t      mCapacity;
+
+        void growToFit( size_t newElements )
+        {
+            if( mSize + newElements > mCapacity )
+            {
+                mCapacity = std::max<size_t>( mSize + newElements, mCapacity + (mCapacity >> 1u) + 1u );
+                T *data = reinterpret_cast<T*>( FrameArenaManager::getThreadArena().allocate(
+                                                    mCapacity * sizeof(T), OGRE_SIMD_ALIGNMENT ) );
+                memcpy( data, mData, mSize * sizeof(T) );
+                mData = data;
+            }
+        }
+
+        FrameStackVector( const FrameStackVector &copy );
+        void operator = ( const FrameStackVector &copy );
+
+    public:
+        typedef T value_type;
+
+        typedef T* iterator;
+        typedef const T* const_iterator;
+
+        FrameStackVector() :
+            mData( mLocalData ),
+            mSize( 0 ),
+            mCapacity( Capacity )
+        {
+        }
+
+        size_t size() const                     { return mSize; }
+        size_t capacity() const                 { return mCapacity; }
+        T* data()                               { return mData; }
+        const T* data() const                   { return mData; }
+        bool empty() const                      { return mSize == 0; }
+        /// True if the contents no longer fit in the inline storage
+        bool hasSpilled() const                 { return mData != mLocalData; }
+
+        void push_back( const T& val )
+        {
+            growToFit( 1 );
+            mData[mSize] = val;
+            ++mSize;
+        }
+
+        void pop_back()
+        {
+            assert( mSize > 0 && "Can't pop a zero-sized array" );
+            --mSize;
+            mData[mSize] = T();
+        }
+
+        void clear()
+        {
+            for( size_t i=0; i<mSize; ++i )
+                mData[i] = T();
+            mSize = 0;
+        }
+
+        void resize( size_t newSize, const T &value=T() )
+        {
+            if( newSize > mSize )
+            {
+                growToFit( newSize - mSize );
+                for( size_t i=mSize; i<newSize; ++i )
+                    mData[i] = value;
+            }
+            else
+            {
+                for( size_t i=newSize; i<mSize; ++i )
+                    mData[i] = T();
+            }
+
+            mSize = newSize;
+        }
+
+        T& operator [] ( size_t idx )
+        {
+            assert( idx < mSize && "Index out of bounds" );
+            return mData[idx];
+        }
+
+        const T& operator [] ( size_t idx ) const
+        {
+            assert( idx < mSize && "Index out of bounds" );
+            return mData[idx];
+        }
+
+        T& back()
+        {
+            assert( mSize > 0 && "Can't call back with no elements" );
+            return mData[mSize-1];
+        }
+
+        const T& back() const
+        {
+            assert( mSize > 0 && "Can't call back with no elements" );
+            return mData[mSize-1];
+        }
+
+        iterator begin()                        { return mData; }
+        const_iterator begin() const            { return mData; }
+        iterator end()                          { return mData + mSize; }
+        const_iterator end() const              { return mData + mSize; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,175 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreFrameMetrics_H_
+#define _OgreFrameMetrics_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreAtomicScalar.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+
+#define OGRE_FRAME_METRICS_SAMPLES 64
+#define OGRE_FRAME_METRICS_MAX_RQ 256
+
+    namespace FrameMetric
+    {
+        enum FrameMetric
+        {
+            /// Time since the previous frame ended, in microseconds
+            FrameTime,
+            /// Draw calls issued by the RenderQueue (v1 & v2), including shadow maps
+            DrawCalls,
+            Instances,
+            PsoSwitches,
+            /// Bytes sent through BufferPacked::upload and BufferPacked::map
+            BufferBytesUploaded,
+            /// Textures whose data finished streaming (i.e. they became ready)
+            TexturesStreamed,
+            /// Upper bound of the bytes sent through staging textures by texture streaming
+            TextureBytesStreamed,
+            /// Shader cache misses, i.e. new PSOs that had to be created
+            HlmsCacheMisses,
+            /// Sum of all render queues and all cull passes (shadow maps included)
+            VisibleObjects,
+            /// Same as VisibleObjects, for the objects that were tested but didn't pass
+            CulledObjects,
+            /// Microseconds FramePacer waited for the GPU at the start of the frame
+            PacingWait,
+            /// Latest latencies measured by FramePacer during this frame, in microseconds.
+            /// They belong to an older frame, 0 if none was measured.
+            InputToGpuLatency,
+            InputToPresentLatency,
+            NumFrameMetrics
+        };
+    }
+
+    struct FrameMetricsSample
+    {
+        /// Root::getNextFrameNumber at the time the frame ended
+        uint64  frameNumber;
+        uint64  values[FrameMetric::NumFrameMetrics];
+        uint32  visibleObjectsPerRq[OGRE_FRAME_METRICS_MAX_RQ];
+        uint32  culledObjectsPerRq[OGRE_FRAME_METRICS_MAX_RQ];
+    };
+
+    /** Always-on counters of what happened on each frame, kept in a ring buffer
+        of the last OGRE_FRAME_METRICS_SAMPLES frames.
+    @remarks
+        Unlike the Profiler, this doesn't require a special build and is meant to be
+        left running in release builds (e.g. to send telemetry, or show an overlay).
+        The cost is an atomic add per event (most of them are batched, e.g. per render
+        queue) and copying one FrameMetricsSample per frame.
+    @par
+        Query the data with getSample, getAverage, getMaximum or getHistogram;
+        or use dumpJson to serve it to an external tool.
+    */
+    class _OgreExport FrameMetrics : public ProfilerAlloc
+    {
+        AtomicScalar<uint64>    mCurrent[FrameMetric::NumFrameMetrics];
+        /// Only modified from the main thread
+        uint32                  mCurrentVisibleObjectsPerRq[OGRE_FRAME_METRICS_MAX_RQ];
+        uint32                  mCurrentCulledObjectsPerRq[OGRE_FRAME_METRICS_MAX_RQ];
+
+        FrameMetricsSample      mSamples[OGRE_FRAME_METRICS_SAMPLES];
+        size_t                  mNextSample;
+        size_t                  mNumSamples;
+        uint64                  mLastTime;
+
+        void clearCurrent(void);
+
+    public:
+        FrameMetrics();
+
+        /// Adds the value to the metric of the current frame. Thread safe.
+        void add( FrameMetric::FrameMetric metric, uint64 value )   { mCurrent[metric] += value; }
+
+        /// Returns the value of the frame still in progress.
+        uint64 getCurrentValue( FrameMetric::FrameMetric metric ) const
+                                                                { return mCurrent[metric].get(); }
+
+        /// Must be called from the main thread.
+        void _addCullResults( uint8 renderQueueId, uint32 numVisible, uint32 numCulled );
+
+        /// Stores the current frame in the ring buffer and starts a new one.
+        /// Called by Root, with the current time in microseconds.
+        void _endFrame( uint64 timeUs, uint64 frameNumber );
+
+        /// Discards all samples. Called by Root.
+        void reset( uint64 timeUs );
+
+        /// Number of valid samples (at most OGRE_FRAME_METRICS_SAMPLES)
+        size_t getNumSamples(void) const                        { return mNumSamples; }
+
+        /** Returns a frame that already ended.
+        @param framesAgo
+            0 for the last frame, 1 for the one before it, etc.
+            Must be lower than getNumSamples().
+        */
+        const FrameMetricsSample& getSample( size_t framesAgo ) const;
+
+        /// Average over the last numFrames frames (clamped to getNumSamples). 0 if there's no sample.
+        uint64 getAverage( FrameMetric::FrameMetric metric, size_t numFrames ) const;
+
+        /// Maximum over the last numFrames frames (clamped to getNumSamples).
+        uint64 getMaximum( FrameMetric::FrameMetric metric, size_t numFrames ) const;
+
+        /** Counts how many of the last numFrames frames fall in each bucket.
+        @param outBuckets
+            Array of numBuckets. Bucket i covers the values in range
+            [minValue + i * bucketSize; minValue + (i + 1) * bucketSize)
+            where bucketSize = (maxValue - minValue) / numBuckets.
+            Values outside [minValue; maxValue) go to the first & last bucket.
+        */
+        void getHistogram( FrameMetric::FrameMetric metric, uint64 minValue, uint64 maxValue,
+                           uint32 *outBuckets, size_t numBuckets, size_t numFrames ) const;
+
+        /// Writes the last numFrames frames (oldest first) as a JSON array of objects,
+        /// one member per metric. Per render queue counts are only included for
+        /// render queues that had objects.
+        void dumpJson( String &outJson, size_t numFrames ) const;
+
+        static const char* getMetricName( FrameMetric::FrameMetric metric );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,220 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreFramePacer_H_
+#define _OgreFramePacer_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "OgreMatrix4.h"
+#include "OgreQuaternion.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+
+    class FrameMetrics;
+
+    class _OgreExport LateLatchListener
+    {
+    public:
+        virtual ~LateLatchListener() {}
+
+        /** Called once per frame for each Camera, right before the first PassScene that
+            renders with it is executed. That is after SceneManager::updateSceneGraph, but
+            before culling, shadow maps and the pass buffers use the Camera.
+        @remarks
+            Sample the latest pose (e.g. the HMD or mouse) and set it on the Camera itself
+            with Camera::setPosition & Camera::setOrientation. Don't modify SceneNodes here:
+            their derived transforms were already computed for this frame.
+        */
+        virtual void lateLatch( Camera *camera ) = 0;
+    };
+
+    /** Controls how many frames the CPU may run ahead of the GPU and measures the
+        resulting latency.
+    @remarks
+        By default the CPU can be up to VaoManager::getDynamicBufferMultiplier frames
+        ahead (usually 3), which maximises throughput but adds latency. With
+        setMaxFramesInFlight, Root::renderOneFrame waits for the GPU before firing
+        frameStarted, so that the input read by the application is as fresh as possible.
+    @par
+        Latency is measured from the moment the input was sampled (markInputSampled,
+        defaults to the start of the frame after the pacing wait) to:
+            * The moment the GPU finished the frame. This is an upper bound, as we only
+              learn about it when the fence is checked, at the start of each frame or
+              while waiting for it.
+            * The moment the frame was shown on screen, when the Window set with
+              setPresentWindow can report it (see Window::getPresentStats).
+        Both are also added to FrameMetrics (InputToGpuLatency & InputToPresentLatency)
+        on the frame the measurement became available.
+    */
+    class _OgreExport FramePacer : public RootAlloc
+    {
+        struct PendingFrame
+        {
+            /// VaoManager::getFrameCount when the frame started
+            uint32  frameCount;
+            /// Window::getPresentStats' submitted present when the frame ended
+            uint64  presentId;
+            uint64  inputTimeUs;
+            bool    gpuFinished;
+            bool    presentValid;
+        };
+
+        struct RenderedPose
+        {
+            Camera const    *camera;
+            Quaternion      orientation;
+            Matrix4         projMatrix;
+        };
+
+        Timer               *mTimer;
+        FrameMetrics        *mFrameMetrics;
+
+        uint8               mMaxFramesInFlight;
+        uint8               mMaxFrameLatency;
+        LateLatchListener   *mLateLatchListener;
+        Window              *mPresentWindow;
+
+        /// Cameras that were already late latched this frame
+        FastArray<Camera*>  mLatchedCameras;
+        FastArray<PendingFrame> mPendingFrames;
+        /// Pose each Camera had the last time a PassScene rendered with it
+        FastArray<RenderedPose> mRenderedPoses;
+
+        uint32  mCurrentFrameCount;
+        uint64  mInputTimeUs;
+
+        uint64  mLastPacingWait;
+        uint64  mLastInputToGpuLatency;
+        uint64  mLastInputToPresentLatency;
+
+        uint64  mFrameDeadline;
+        uint64  mLastFrameEndTime;
+        bool    mFrameLate;
+
+        void updatePendingFrames( VaoManager *vaoManager, uint64 timeUs );
+
+    public:
+        FramePacer( Timer *timer, FrameMetrics *frameMetrics );
+
+        /** Limits how many frames the CPU may record before the GPU finishes them.
+        @param maxFramesInFlight
+            0 to disable pacing (the VaoManager's dynamic buffer multiplier is the limit).
+            1 is the lowest latency, but the CPU and GPU no longer overlap.
+            Values above the dynamic buffer multiplier have no effect.
+        */
+        void setMaxFramesInFlight( uint8 maxFramesInFlight );
+        uint8 getMaxFramesInFlight(void) const              { return mMaxFramesInFlight; }
+
+        /** Window whose presents are tracked to measure input-to-present latency.
+            The present queue limit of setMaxFrameLatency is also applied to it.
+        @param window
+            Null to stop tracking.
+        */
+        void setPresentWindow( Window *window );
+        Window* getPresentWindow(void) const                { return mPresentWindow; }
+
+        /** Limits how many presents the API may queue on the present window,
+            where the API allows it (see Window::setMaxFrameLatency).
+        @param maxFrameLatency
+            0 to leave the API's default.
+        */
+        void setMaxFrameLatency( uint8 maxFrameLatency );
+        uint8 getMaxFrameLatency(void) const                { return mMaxFrameLatency; }
+
+        void setLateLatchListener( LateLatchListener *listener );
+        LateLatchListener* getLateLatchListener(void) const { return mLateLatchListener; }
+
+        /// Call this right after reading the input of this frame. Otherwise the time at
+        /// which frameStarted was fired is used.
+        void markInputSampled(void);
+
+        /// Microseconds Root::renderOneFrame waited for the GPU at the start of the last frame
+        uint64 getLastPacingWait(void) const                { return mLastPacingWait; }
+
+        /// Microseconds from sampling the input to the GPU finishing that frame,
+        /// for the most recent frame the GPU finished. 0 until known.
+        uint64 getLastInputToGpuLatency(void) const         { return mLastInputToGpuLatency; }
+
+        /// Microseconds from sampling the input to the frame being shown, for the most
+        /// recent frame shown. 0 if the present window can't report it.
+        uint64 getLastInputToPresentLatency(void) const     { return mLastInputToPresentLatency; }
+
+        /** Sets the time a frame is expected to take (e.g. 11111 for 90 Hz). Frames taking
+            longer are considered late: see isFrameLate.
+        @param deadlineUs
+            In microseconds. 0 to disable.
+        */
+        void setFrameDeadline( uint64 deadlineUs );
+        uint64 getFrameDeadline(void) const                 { return mFrameDeadline; }
+
+        /** True when the time between the end of the last two frames exceeded the deadline,
+            which means the current frame will likely be late as well.
+            Quad passes with CompositorPassQuadDef::ReprojectionWhenLate use it, and the
+            application can use it to skip expensive passes and only reproject.
+        */
+        bool isFrameLate(void) const                        { return mFrameLate; }
+
+        /** Retrieves the orientation & projection matrix (see Frustum::getProjectionMatrix)
+            the Camera had the last time a PassScene rendered with it.
+        @return
+            False if the Camera hasn't been rendered yet.
+        */
+        bool getRenderedPose( const Camera *camera, Quaternion &outOrientation,
+                              Matrix4 &outProjMatrix ) const;
+
+        /// Called by Root at the start of renderOneFrame, before frameStarted.
+        void _beginFrame( VaoManager *vaoManager );
+
+        /// Called by Root at the end of renderOneFrame, after the final targets were swapped.
+        void _endFrame( VaoManager *vaoManager );
+
+        /// Called by CompositorPassScene before using its Camera.
+        void _lateLatchCamera( Camera *camera );
+
+        /// Called by reprojecting passes to get the freshest pose, even if the Camera was
+        /// already late latched this frame. Does not change its rendered pose.
+        void _sampleLatestPose( Camera *camera );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,125 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreGpuBlockCompressor_H_
+#define _OgreGpuBlockCompressor_H_
+
+#include "OgrePrerequisites.h"
+#include "OgrePixelFormatGpu.h"
+#include "OgreResourceTransition.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Compresses textures that were generated at runtime (render targets, procedural
+        textures, baked lightmaps, etc) into BC1, BC3, BC4 or BC5 using compute shaders,
+        so that they can be sampled from a compressed texture afterwards.
+    @remarks
+        The compute jobs live in Samples/Media/2.0/scripts/materials/Common
+        (BlockCompress.material.json) and must be loaded as resources.
+    @par
+        Each 4x4 block is written into an intermediate PFG_RG32_UINT / PFG_RGBA32_UINT UAV
+        (one texel per block) which is then copied into the compressed texture via
+        TextureGpu::copyTo. The encoder is a fast range fit, of lower quality than
+        offline compressors.
+    @par
+        Metal does not allow copying between different pixel formats so this path
+        is not supported there yet.
+    */
+    class _OgreExport GpuBlockCompressor : public UtilityAlloc
+    {
+    public:
+        enum Format
+        {
+            BC1,
+            BC3,
+            BC4,
+            BC5,
+            NumFormats
+        };
+
+    protected:
+        /// [format][srgb]
+        HlmsComputeJob      *mJobs[NumFormats][2];
+        /// Intermediate UAVs, kept around since the same sizes tend to get compressed again
+        vector<TextureGpu*>::type mTmpTextures;
+
+        ResourceTransition  mResourceTransition;
+
+        HlmsCompute         *mHlmsCompute;
+        TextureGpuManager   *mTextureManager;
+        RenderSystem        *mRenderSystem;
+
+        HlmsComputeJob* getJob( Format format, bool srgb );
+        TextureGpu* getTmpUavTexture( uint32 width, uint32 height, PixelFormatGpu pixelFormat );
+
+    public:
+        GpuBlockCompressor( HlmsManager *hlmsManager, TextureGpuManager *textureManager );
+        ~GpuBlockCompressor();
+
+        /// Returns true if dstFormat is one of the formats we can encode to
+        static bool supportsFormat( PixelFormatGpu dstFormat );
+
+        /// Returns false if the RenderSystem can't run compute shaders
+        bool isSupported(void) const;
+
+        /** Compresses one mip of srcTexture into dstTexture
+        @remarks
+            Both textures must be Type2D and already resident. dstTexture at dstMipLevel must
+            have the same resolution as srcTexture at srcMipLevel.
+            If both src and dst are sRGB, the data is encoded in sRGB space.
+        @param srcTexture
+            Any texture that can be sampled (i.e. TextureFlags::NotTexture is not set)
+        @param dstTexture
+            A texture using a format where supportsFormat returns true
+        */
+        void compress( TextureGpu *srcTexture, TextureGpu *dstTexture,
+                       uint8 srcMipLevel, uint8 dstMipLevel );
+
+        /// Compresses all mips in dstTexture. srcTexture must have at least as many mips
+        void compress( TextureGpu *srcTexture, TextureGpu *dstTexture );
+
+        /// Destroys the intermediate UAV textures that are kept around for reuse.
+        void releaseTmpTextures(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,194 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreGpuMemoryTracker_H_
+#define _OgreGpuMemoryTracker_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "OgreStringVector.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup RenderSystem
+    *  @{
+    */
+
+#define OGRE_GPU_MEMORY_TRACKER_SAMPLES 64
+
+    namespace GpuMemoryTag
+    {
+        /// Built-in tags. More can be added with GpuMemoryTracker::registerTag
+        enum GpuMemoryTag
+        {
+            /// Anything not tagged explicitly (i.e. user meshes & textures)
+            Default,
+            /// Textures & buffers declared in compositor nodes and workspaces
+            Compositor,
+            ShadowMaps,
+            /// Pass, material & instance buffers of the Hlms implementations
+            Hlms,
+            /// Voxel Cone Tracing (voxels, lighting, mesh buffers)
+            Vct,
+            /// Cubemap probes, irradiance volumes & fields
+            Probes,
+            Terrain,
+            NumBuiltinTags
+        };
+    }
+
+    struct GpuMemoryTagStats
+    {
+        /// Bytes allocated for buffers, including padding & dynamic buffer copies
+        size_t  bufferBytes;
+        size_t  textureBytes;
+        /// Alignment padding of buffers, plus unused slices of texture pools owned by this tag.
+        /// Already included in bufferBytes & textureBytes.
+        size_t  wastedBytes;
+        /// Highest bufferBytes + textureBytes seen by GpuMemoryTracker::update
+        size_t  peakBytes;
+        uint32  numBuffers;
+        uint32  numTextures;
+
+        GpuMemoryTagStats() :
+            bufferBytes( 0 ), textureBytes( 0 ), wastedBytes( 0 ), peakBytes( 0 ),
+            numBuffers( 0 ), numTextures( 0 ) {}
+
+        size_t getTotalBytes(void) const    { return bufferBytes + textureBytes; }
+    };
+
+    typedef vector<GpuMemoryTagStats>::type GpuMemoryTagStatsVec;
+
+    /** Attributes the GPU memory used by BufferPacked and TextureGpu to the subsystem
+        that created them (compositor, shadow maps, Hlms, Vct, probes, terrain, the user...)
+    @remarks
+        Every buffer & texture is tagged when created with the current tag (see TagScope).
+        Tags don't cost anything until update is called, which walks all the live buffers
+        and textures; thus it is meant to be called periodically (e.g. once per second or
+        after loading a level), not every frame.
+    @par
+        Buffer pool slack (free space in VaoManager's pools) is shared by everyone and can't
+        be attributed to a tag; it's reported separately (see getBufferPoolFreeBytes).
+    */
+    class _OgreExport GpuMemoryTracker : public RenderSysAlloc
+    {
+    public:
+        /// Sets the current tag while in scope
+        class _OgreExport TagScope
+        {
+            GpuMemoryTracker    *mTracker;
+        public:
+            /**
+            @param tag
+                Tag to use for all the buffers & textures created in this scope
+            @param bOverride
+                When false, the tag is only used if the current one is GpuMemoryTag::Default.
+                Useful for generic subsystems (e.g. compositor) used by more specific ones
+                (e.g. probes creating their own workspaces)
+            */
+            TagScope( uint8 tag, bool bOverride=true );
+            ~TagScope();
+        };
+
+    protected:
+        StringVector            mTagNames;
+        FastArray<uint8>        mTagStack;
+
+        GpuMemoryTagStatsVec    mStats;
+        size_t                  mBufferPoolCapacity;
+        size_t                  mBufferPoolFreeBytes;
+
+        /// mHistory[i] has the total bytes of each tag at the time of the i-th update
+        FastArray<size_t>       mHistory[OGRE_GPU_MEMORY_TRACKER_SAMPLES];
+        uint64                  mHistoryFrame[OGRE_GPU_MEMORY_TRACKER_SAMPLES];
+        size_t                  mNextHistory;
+        size_t                  mNumHistory;
+
+    public:
+        GpuMemoryTracker();
+
+        /// Returns the tag already registered with that name, or registers a new one.
+        uint8 registerTag( const String &name );
+        const String& getTagName( uint8 tag ) const;
+        size_t getNumTags(void) const                   { return mTagNames.size(); }
+
+        void pushTag( uint8 tag );
+        void popTag(void);
+        uint8 getCurrentTag(void) const                 { return mTagStack.back(); }
+
+        /// Returns the current tag of Root's tracker; or GpuMemoryTag::Default if there is none.
+        /// Used by BufferPacked & TextureGpu to tag themselves on creation.
+        static uint8 getTagForNewResource(void);
+
+        /** Recalculates the stats of every tag by walking all the live buffers & textures.
+            Also updates the peaks and adds an entry to the history.
+        @param vaoManager
+            Can be null.
+        @param textureGpuManager
+            Can be null.
+        @param frameNumber
+            Stored along the history entry, for reference.
+        */
+        void update( VaoManager *vaoManager, TextureGpuManager *textureGpuManager,
+                     uint64 frameNumber );
+
+        /// Stats as of the last update, indexed by tag
+        const GpuMemoryTagStatsVec& getStats(void) const    { return mStats; }
+        size_t getBufferPoolCapacity(void) const            { return mBufferPoolCapacity; }
+        /// Free space in VaoManager's pools as of the last update
+        size_t getBufferPoolFreeBytes(void) const           { return mBufferPoolFreeBytes; }
+
+        /// Resets the peaks to the current values
+        void resetPeaks(void);
+
+        /// One line per tag with the stats of the last update.
+        void dumpCsv( String &outCsv ) const;
+        /// One line per update (oldest first), one column per tag with its total bytes.
+        void dumpHistoryCsv( String &outCsv ) const;
+        void dumpJson( String &outJson ) const;
+
+        /** Lists every live buffer & texture with the given tag. After unloading a level,
+            anything still listed under its tag is a leak (or a cache).
+        */
+        void generateLeakReport( String &outReport, uint8 tag, VaoManager *vaoManager,
+                                 TextureGpuManager *textureGpuManager ) const;
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
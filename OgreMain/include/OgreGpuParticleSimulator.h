@@ -0,0 +1,226 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreGpuParticleSimulator_H_
+#define _OgreGpuParticleSimulator_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreRenderable.h"
+#include "OgreResourceTransition.h"
+#include "Math/Simple/OgreAabb.h"
+#include "Compositor/OgreCompositorWorkspaceListener.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    /// Renderable of a ParticleSystem simulated by GpuParticleSimulator. Its vertex buffer
+    /// is written by the GPU every frame. Owned by the GpuParticleSimulator.
+    class _OgreExport GpuParticleRenderable : public Renderable, public UtilityAlloc
+    {
+        ParticleSystem  *mParticleSystem;
+
+    public:
+        GpuParticleRenderable( ParticleSystem *particleSystem, VertexArrayObject *vao );
+        virtual ~GpuParticleRenderable();
+
+        virtual const LightList& getLights(void) const;
+        virtual void getRenderOperation( v1::RenderOperation &op, bool casterPass );
+        virtual void getWorldTransforms( Matrix4 *xform ) const;
+        virtual bool getCastsShadows(void) const;
+    };
+
+    /** Simulates ParticleSystems with compute shaders, for effects with hundreds of thousands
+        of particles where updating every Particle on the CPU and rebuilding the billboards'
+        vertex buffer each frame becomes the bottleneck.
+    @remarks
+        A ParticleSystem opts in with ParticleSystem::setGpuSimulation, or from a .particle
+        script with "gpu_simulation true". The system keeps using its emitters and affectors
+        as the description of the effect: each frame their parameters are translated into a
+        small buffer, the CPU only decides how many particles each emitter emits, and two
+        compute jobs emit & simulate the particles (which live in UAV buffers) and expand
+        them into camera facing billboards.
+    @par
+        The compute jobs live in Samples/Media/2.0/scripts/materials/Common
+        (GpuParticles.material.json) and must be loaded as a resource.
+    @par
+        The simulation happens in CompositorWorkspaceListener::allWorkspacesBeginUpdate, thus
+        this object is registered as a listener of CompositorManager2 while it's alive.
+        Only one GpuParticleSimulator may exist at a time.
+    @par
+        Systems fall back to the CPU (with a message in the log) unless:
+            - They only use Point, Box, Ellipsoid, Cylinder, Ring & HollowEllipsoid emitters,
+              without emitted emitters.
+            - They only use LinearForce, ColourFader, Scaler, Rotator & DeflectorPlane affectors.
+            - They use the billboard renderer with 'point' billboards.
+            - There are at most MaxEmitters emitters and MaxAffectors affectors.
+    @par
+        Limitations:
+            - The Renderable is a v2 object thus the system is moved to getRenderQueueGroup
+              if its render queue isn't in FAST mode.
+            - Billboards face the camera given to setCamera (the one rendering the effect).
+            - Particles aren't accessible from the CPU (ParticleSystem::getNumParticles
+              returns 0) and aren't sorted. iteration_interval is ignored.
+            - The bounds are estimated from the emitters & affectors rather than from
+              the particles.
+            - A fixed pool of quota billboards is drawn; dead particles are collapsed into
+              degenerate triangles.
+    */
+    class _OgreExport GpuParticleSimulator : public CompositorWorkspaceListener, public UtilityAlloc
+    {
+    public:
+        static const uint32 MaxEmitters;
+        static const uint32 MaxAffectors;
+
+    protected:
+        struct SystemData
+        {
+            ParticleSystem          *system;
+            uint32                  quota;
+
+            /// 4 float4 per particle. See GpuParticleSimulator.cpp for the layout
+            UavBufferPacked         *particles;
+            /// [0] = number of dead particles followed by the indices of the dead particles
+            UavBufferPacked         *deadList;
+            /// Expanded billboards. Copied to the vertex buffer of the vao after simulating
+            UavBufferPacked         *vertices;
+            /// Emitters & affectors. Uploaded every frame
+            TexBufferPacked         *params;
+
+            VertexArrayObject       *vao;
+            GpuParticleRenderable   *renderable;
+
+            HlmsComputeJob          *emitJob;
+            HlmsComputeJob          *updateJob;
+
+            /// Accumulated by _notifyUpdate since the last simulation
+            Real                    pendingTime;
+            FastArray<uint32>       pendingEmissions;
+            bool                    needsReset;
+        };
+
+        typedef vector<SystemData>::type SystemDataVec;
+
+        SystemDataVec       mSystems;
+
+        /// Scratch memory where the params are built before uploading them
+        FastArray<float>    mParamsScratch;
+
+        Camera              *mCamera;
+        uint8               mRenderQueueGroup;
+        uint32              mFrameCount;
+
+        ResourceTransition  mUavToUavTransition;
+        ResourceTransition  mUavToCopyTransition;
+
+        HlmsCompute         *mHlmsCompute;
+        VaoManager          *mVaoManager;
+        RenderSystem        *mRenderSystem;
+        CompositorManager2  *mCompositorManager;
+
+        HlmsComputeJob* createJob( const char *jobName );
+        SystemData* findSystem( const ParticleSystem *system );
+
+        void createBuffers( SystemData &data );
+        void destroyBuffers( SystemData &data );
+        /// Uploads the initial contents of the particles & dead list (all particles dead)
+        void resetBuffers( SystemData &data );
+
+        /// Fills mParamsScratch. Returns the total number of particles to emit
+        uint32 fillParams( SystemData &data );
+
+    public:
+        /**
+        @param camera
+            See setCamera.
+        @param renderQueueGroup
+            See setRenderQueueGroup.
+        */
+        GpuParticleSimulator( HlmsManager *hlmsManager, VaoManager *vaoManager,
+                              CompositorManager2 *compositorManager, Camera *camera,
+                              uint8 renderQueueGroup = 200u );
+        virtual ~GpuParticleSimulator();
+
+        /// Returns false if the RenderSystem can't run compute shaders
+        bool isSupported(void) const;
+
+        /** Returns true if we can simulate the ParticleSystem in its current state.
+        @param outReason [out]
+            Optional. Why it can't.
+        */
+        bool canSimulate( const ParticleSystem *system, String *outReason = 0 ) const;
+
+        /// The billboards are oriented towards this camera.
+        void setCamera( Camera *camera )                    { mCamera = camera; }
+        Camera* getCamera(void) const                       { return mCamera; }
+
+        /// Render queue simulated ParticleSystems are moved to when theirs isn't in FAST mode.
+        /// Must be in FAST mode.
+        void setRenderQueueGroup( uint8 renderQueueGroup )  { mRenderQueueGroup = renderQueueGroup; }
+        uint8 getRenderQueueGroup(void) const               { return mRenderQueueGroup; }
+
+        /** Simulates the ParticleSystem on the GPU from now on. Called by ParticleSystem.
+        @return
+            False if it can't (see canSimulate). The reason is logged.
+        */
+        bool _addParticleSystem( ParticleSystem *system );
+        /// Gives the ParticleSystem back to the CPU. Called by ParticleSystem.
+        void _removeParticleSystem( ParticleSystem *system );
+
+        /// Called by ParticleSystem::_update instead of simulating on the CPU.
+        /// Asks the emitters how many particles they emit.
+        void _notifyUpdate( ParticleSystem *system, Real timeElapsed );
+        /// Called by ParticleSystem::clear. All particles die
+        void _notifyCleared( ParticleSystem *system );
+        void _notifyMaterialChanged( ParticleSystem *system );
+
+        /// Conservative bounds (in the local space of the node) estimated from the
+        /// emitters & affectors. Called by ParticleSystem while its bounds are auto updated
+        Aabb _calculateBounds( const ParticleSystem *system ) const;
+
+        /// Runs the compute jobs. Called automatically from allWorkspacesBeginUpdate
+        void update(void);
+
+        virtual void allWorkspacesBeginUpdate(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
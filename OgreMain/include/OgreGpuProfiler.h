@@ -0,0 +1,171 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreGpuProfiler_H_
+#define _OgreGpuProfiler_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup RenderSystem
+    *  @{
+    */
+
+    /** Measures how long the GPU spends on each compositor pass (or any other
+        user-defined region) using timestamp queries.
+    @par
+        Each frame gets its own set of queries. The results are read back a few frames
+        later (up to the number of frames given to setEnabled) without stalling; if
+        the GPU falls so far behind that the oldest frame isn't ready yet, that frame
+        is simply not recorded.
+    @par
+        CompositorPass automatically brackets each pass with beginSample/endSample
+        (or each workspace, when CompositorWorkspace::setAmalgamatedProfiling is on).
+        The RenderSystem calls _beginFrame and _endFrame.
+    @remarks
+        Only available if the RenderSystem supports timestamp queries
+        (see RenderSystem::_supportsGpuTimestamps). Otherwise setEnabled does nothing.
+    */
+    class _OgreExport GpuProfiler : public RenderSysAlloc
+    {
+    public:
+        struct Result
+        {
+            String  name;
+            /// Nesting level, 0 for the outermost samples
+            uint32  depth;
+            /// Offset in milliseconds since the beginning of the frame
+            Real    startMs;
+            Real    durationMs;
+        };
+
+        typedef vector<Result>::type ResultVec;
+
+    protected:
+        struct Sample
+        {
+            String  name;
+            uint32  depth;
+            uint32  beginQuery;
+            uint32  endQuery;
+        };
+
+        typedef vector<Sample>::type SampleVec;
+
+        struct Frame
+        {
+            SampleVec   samples;
+            uint32      numQueries;
+            bool        pending;
+        };
+
+        typedef vector<Frame>::type FrameVec;
+
+        RenderSystem    *mRenderSystem;
+
+        FrameVec        mFrames;
+        uint32          mMaxQueriesPerFrame;
+        /// Queries that will be needed to close the open samples and the frame
+        uint32          mNumReservedQueries;
+        /// Frame slot being recorded (or to be recorded next)
+        uint32          mCurrentFrame;
+        bool            mEnabled;
+        /// False if the current frame isn't being recorded
+        /// (i.e. between frames, or the GPU is too far behind)
+        bool            mRecording;
+
+        /// Indices to mFrames[mCurrentFrame].samples of the samples still open.
+        /// std::numeric_limits<uint32>::max() if the sample was dropped.
+        vector<uint32>::type    mOpenSamples;
+
+        ResultVec               mResults;
+        Real                    mFrameTimeMs;
+        uint32                  mNumDroppedSamples;
+
+        vector<uint64>::type    mTimestamps;
+
+        /// Reads back the results of the given frame slot, if they're ready.
+        /// Returns false if the GPU is not done with it yet.
+        bool collectResults( uint32 frameIdx );
+
+    public:
+        GpuProfiler( RenderSystem *renderSystem );
+        ~GpuProfiler();
+
+        /** Enables or disables GPU profiling.
+        @param bEnabled
+            True to enable.
+        @param numFrames
+            How many frames can be in flight before their results are read back.
+            Results arrive with at least 1 frame of latency and at most numFrames.
+        @param maxQueriesPerFrame
+            Each sample uses 2 queries, plus 2 per frame. Samples beyond
+            that budget are dropped (see getNumDroppedSamples).
+        */
+        void setEnabled( bool bEnabled, uint32 numFrames = 4u, uint32 maxQueriesPerFrame = 512u );
+        bool getEnabled(void) const                     { return mEnabled; }
+        uint32 getNumFrames(void) const                 { return static_cast<uint32>( mFrames.size() ); }
+        uint32 getMaxQueriesPerFrame(void) const        { return mMaxQueriesPerFrame; }
+
+        /// Starts a sample. Samples can be nested; they must be closed in reverse order.
+        void beginSample( const String &name );
+        /// Ends the last sample started with beginSample.
+        void endSample(void);
+
+        /// Results of the most recent frame whose queries have finished,
+        /// in the order the samples were started.
+        const ResultVec& getResults(void) const         { return mResults; }
+        /// GPU time of the whole frame the results belong to, in milliseconds.
+        Real getFrameTime(void) const                   { return mFrameTimeMs; }
+        /// Number of samples that didn't fit in maxQueriesPerFrame in the last recorded frame.
+        uint32 getNumDroppedSamples(void) const         { return mNumDroppedSamples; }
+
+        /// Writes getResults to the log.
+        void logResults(void) const;
+
+        /// Called by the RenderSystem at the beginning of the frame.
+        void _beginFrame(void);
+        /// Called by the RenderSystem once all workspaces have been updated.
+        void _endFrame(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -76,6 +76,8 @@ namespace Ogre {
         MicrocodeMap mMicrocodeCache;
         bool mSaveMicrocodesToCache;
         bool mCacheDirty;           // When this is true the cache is 'dirty' and should be resaved to disk.
+        /// Identifies the driver that produced the microcodes. @see setMicrocodeCacheSignature
+        String mMicrocodeCacheSignature;
 
         static Hash computeHashWithRenderSystemName( const String &source );
 
@@ -213,6 +215,16 @@ namespace Ogre {
         */
         bool isCacheDirty(void) const;
 
+        /** Sets a string identifying the driver (vendor, device, driver version, compiler
+            version...) the microcodes are being produced for. It is stored with the cache
+            and loadMicrocodeCache discards caches whose signature doesn't match.
+        @remarks
+            Render systems whose microcodes are driver-specific (e.g. GL program binaries)
+            set this on initialization. Users normally don't need to call it.
+        */
+        void setMicrocodeCacheSignature( const String &signature );
+        const String& getMicrocodeCacheSignature(void) const;
+
         bool canGetCompiledShaderBuffer();
         /** Check if a microcode is available for a program in the microcode cache.
         @param name The name of the program.
@@ -243,6 +255,11 @@ namespace Ogre {
         */
         virtual void saveMicrocodeCache( DataStreamPtr stream ) const;
         /** Loads the microcode cache from disk.
+        @remarks
+            If the cache was saved by a different driver or cache version (see
+            setMicrocodeCacheSignature), it is discarded and the microcode cache
+            is left empty; shaders will then be compiled from source and the
+            cache becomes dirty again.
         @param stream The source stream
         */
         virtual void loadMicrocodeCache( DataStreamPtr stream );
@@ -0,0 +1,140 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreHiZBuffer_H_
+#define _OgreHiZBuffer_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "OgreMatrix4.h"
+#include "OgrePixelFormatGpu.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    struct TextureBox;
+
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+    /** CPU-side hierarchical depth buffer (Hi-Z) used for occlusion culling.
+    @remarks
+        The buffer is built from a depth buffer of a previous frame (i.e. downloaded
+        via AsyncTextureTicket, ideally a few frames late and at a reduced resolution)
+        together with the view-projection matrix that was used to render it.
+        Each mip stores the farthest depth of the texels it covers, so the test
+        is conservative: an object is only considered occluded if its nearest
+        point is behind everything that was rendered in its screen rectangle.
+    @par
+        Assign it to a Camera via Camera::setHiZBuffer; SceneManager::cullFrustum will
+        then skip v2 and v1 objects that are occluded (only for non-shadow passes).
+    @par
+        Because the depth is from a previous frame, objects that suddenly become
+        visible (e.g. fast camera rotation, camera cuts) may pop in one frame
+        late. Call invalidate on camera cuts.
+    @par
+        To get the reduced resolution cheaply, copy the depth into an R32_FLOAT UAV
+        texture with mipmaps and reduce it on the GPU with ComputeDownsampler (Max, or
+        Min if reverseDepth) or a PASS_MIPMAP with mipmap_method compute_single_pass;
+        then download only the mip closest to maxResolution, which is conservative too.
+    */
+    class _OgreExport HiZBuffer : public SceneMgtAlloc
+    {
+        struct Mip
+        {
+            uint32  width;
+            uint32  height;
+            size_t  offset;
+        };
+
+        typedef FastArray<Mip> MipArray;
+
+        FastArray<float>    mDepth;
+        MipArray            mMips;
+        Matrix4             mViewProjMatrix;
+        Real                mDepthRange;
+        bool                mReverseDepth;
+        uint32              mMaxResolution;
+
+        /// Converts a depth value (as read from the GPU) to [0; 1] where 1 is the farthest
+        inline float toLinearFarness( float depth ) const;
+
+        void buildPyramid(void);
+
+    public:
+        /**
+        @param maxResolution
+            The depth buffer is downsampled (conservatively) until both its width
+            and height are equal or below this value.
+        */
+        HiZBuffer( uint32 maxResolution = 256u );
+        ~HiZBuffer();
+
+        /** Builds the Hi-Z pyramid from depth data.
+        @param depthBox
+            Depth data to read. Row 0 is the top of the screen.
+        @param pixelFormat
+            Format in depthBox. Supported: PFG_D32_FLOAT, PFG_R32_FLOAT,
+            PFG_D16_UNORM, PFG_R16_UNORM, PFG_D32_FLOAT_S8X24_UINT.
+        @param viewProjMatrix
+            View-projection matrix the depth was rendered with. Use
+            Camera::getProjectionMatrixWithRSDepth * Camera::getViewMatrix
+        @param depthRange
+            See RenderSystem::getRSDepthRange
+        @param reverseDepth
+            See RenderSystem::isReverseDepth
+        */
+        void update( const TextureBox &depthBox, PixelFormatGpu pixelFormat,
+                     const Matrix4 &viewProjMatrix, Real depthRange, bool reverseDepth );
+
+        /// Discards the current data. isVisible will return true for everything
+        void invalidate(void);
+
+        /// Returns true if update has been called since the last invalidate
+        bool isValid(void) const                        { return !mMips.empty(); }
+
+        /** Returns false if the box is fully occluded by the stored depth.
+            Thread safe, as long as update or invalidate isn't called at the same time.
+        */
+        bool isVisible( const Aabb &aabb ) const;
+
+        uint32 getMaxResolution(void) const             { return mMaxResolution; }
+        size_t getNumMipmaps(void) const                { return mMips.size(); }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -194,10 +194,61 @@ namespace Ogre
         };
 
         typedef vector<Library>::type LibraryVec;
+
+        /// See setShaderGenerationTiming. Times are in microseconds.
+        struct ShaderGenerationTimings
+        {
+            uint64  parseMath;
+            uint64  parseForEach;
+            uint64  parseProperties;
+            uint64  parseUndefPieces;
+            uint64  collectPieces;
+            uint64  insertPieces;
+            uint64  parseCounter;
+            /// Creating & compiling the shaders through the API (i.e. compileShaderCode)
+            uint64  compile;
+            /// Number of shader stages generated (i.e. after parsing the templates)
+            uint32  numShaders;
+        };
     protected:
+        /// Directive families a template or piece file uses. @see TemplateFile
+        enum TemplateDirectives
+        {
+            TemplateMath        = 1u << 0u, /// @pset, @padd, @psub, etc
+            TemplateForEach     = 1u << 1u,
+            TemplateProperty    = 1u << 2u,
+            TemplateUndefPiece  = 1u << 3u,
+            TemplatePiece       = 1u << 4u,
+            TemplateCounter     = 1u << 5u  /// @counter, @value, @set, @add, etc
+        };
+
+        /// A template or piece file, read once from its Archive. The directives
+        /// are scanned at load time so each permutation can skip the parsing passes
+        /// that would just copy the file unchanged.
+        struct TemplateFile
+        {
+            String  contents;
+            uint32  directives; /// Bitmask of TemplateDirectives present in the file
+        };
+
+        typedef map<String, TemplateFile>::type TemplateFileMap;
+        /// Key is the archive name + file name. Cleared on reloadFrom.
+        TemplateFileMap mTemplateFiles;
+
+        const TemplateFile& getTemplateFile( Archive *archive, const String &filename );
+        /// Whether the file is already in mTemplateFiles
+        bool hasTemplateFile( Archive *archive, const String &filename ) const;
+        /// Whether processPieces parses this piece file with the current RenderSystem
+        bool usesPieceFile( const String &filename ) const;
+        void loadPieceFiles( Archive *archive, const StringVector &pieceFiles );
+        static uint32 scanTemplateDirectives( const String &contents );
+
         LibraryVec      mLibrary;
         Archive         *mDataFolder;
         StringVector    mPieceFiles[NumShaderTypes];
+        /// Listing the data & library folders is deferred until the first
+        /// shader gets generated, to keep startup cheap. See enumeratePieceFiles
+        bool            mPieceFilesEnumerated;
         HlmsManager     *mHlmsManager;
 
         LightGatheringMode  mLightGatheringMode;
@@ -228,6 +279,39 @@ namespace Ogre
         bool            mHighQuality;
         bool            mFastShaderBuildHack;
 
+        /// See setShaderCompilationBudget. In microseconds, 0 = unlimited.
+        uint64          mShaderCompilationBudget;
+        /// Microseconds spent generating new shader variants during mShaderCompilationFrame
+        uint64          mShaderCompilationTime;
+        unsigned long   mShaderCompilationFrame;
+        /// Draws skipped since the last frame because their shaders weren't ready yet
+        uint32          mNumDeferredDraws;
+        /// Gives each shader variant a unique, friendly base-10 name. Reset by clearShaderCache
+        uint32          mNextShaderCodeId;
+
+        /// Null unless the templates are expanded in the background.
+        /// @see setAsyncShaderGeneration
+        struct AsyncShaderGenerator;
+        AsyncShaderGenerator *mAsyncShaderGenerator;
+        /// Non-null while HlmsDiskCache is warming up PSOs. Provides what
+        /// createShaderCacheEntry would otherwise take from the renderable.
+        HlmsPso const   *mWarmUpPso;
+
+        /// Frames ended since this Hlms was created. @see _evictStalePsos
+        uint32          mFrameCount;
+        /// Sum of HlmsCache::creationTime of every PSO created, including evicted ones.
+        uint64          mTotalPsoCreationTime;
+        uint32          mNumPsosCreated;
+        uint32          mNumPsosEvicted;
+
+        /// Null unless shader generation timing is enabled. @see setShaderGenerationTiming
+        Timer                   *mCpuTimer;
+        ShaderGenerationTimings mShaderGenerationTimings;
+
+        uint64 getCpuTime(void) const;
+        /// Adds the time elapsed since inOutTimestamp to accumulator, and resets inOutTimestamp
+        void accumCpuTime( uint64 &accumulator, uint64 &inOutTimestamp ) const;
+
         /// The default datablock occupies the name IdString(); which is not the same as IdString("")
         HlmsDatablock   *mDefaultDatablock;
 
@@ -247,8 +331,13 @@ namespace Ogre
                 piece_hs    - Hull Shader
                 piece_ds    - Domain Shader
             Case insensitive.
+        @remarks
+            Only validates mDataFolder contains at least one template. Listing the piece
+            files happens on demand via enumeratePieceFilesIfNeeded.
         */
         void enumeratePieceFiles(void);
+        /// Performs the listing deferred by enumeratePieceFiles, if not done yet.
+        void enumeratePieceFilesIfNeeded(void) const;
         /// Populates pieceFiles, returns true if found at least one piece file.
         static bool enumeratePieceFiles( Archive *dataFolder, StringVector *pieceFiles );
 
@@ -359,6 +448,55 @@ namespace Ogre
         */
         void applyStrongMacroblockRules( HlmsPso &pso );
 
+        /// The parsed shaders of all stages, as produced by expandShaderTemplates
+        struct ExpandedShaderCode
+        {
+            String  source[NumShaderTypes];
+            String  debugFilename[NumShaderTypes];
+            /// False if the stage has no template, or its template disabled it
+            bool    enabled[NumShaderTypes];
+        };
+
+        /** Runs the template parsers over the template of every stage, using the
+            properties & pieces from codeCache. Leaves the properties set by the
+            templates in mSetProperties.
+        @remarks
+            Doesn't touch the API nor the resource managers, only this Hlms' parser
+            state; so it can run on a background thread. @see setAsyncShaderGeneration
+        @param finalHash
+            Base-10 name of the variant, for the debug output.
+        */
+        void expandShaderTemplates( const ShaderCodeCache &codeCache, uint32 finalHash,
+                                    ExpandedShaderCode &outCode );
+
+        /// Creates & compiles the enabled stages of an expanded variant through the
+        /// API. Main thread only.
+        void compileShaderCode( ShaderCodeCache &codeCache, const ExpandedShaderCode &code,
+                                uint32 finalHash );
+
+        /// Loads every template & piece file expandShaderTemplates may need into
+        /// mTemplateFiles, so that a background thread never has to open them.
+        void loadTemplateFiles(void);
+
+        /// Merges the pass & renderable properties into outCodeCache (which must have
+        /// been created with the renderable's pieces), calling the listeners on the way.
+        void mergeShaderCodeProperties( const RenderableCache &renderableCache,
+                                        const HlmsCache &passCache,
+                                        const QueuedRenderable &queuedRenderable,
+                                        ShaderCodeCache &outCodeCache );
+
+        /** Checks whether the shaders for this renderable & pass have been generated.
+            If the templates are still being expanded in the background, returns false.
+            If they've finished, compiles them and returns true. Otherwise the
+            expansion is queued and false is returned.
+        */
+        bool isShaderCodeReady( uint32 renderableHash, const HlmsCache &passCache,
+                                const QueuedRenderable &queuedRenderable );
+
+        /// Waits for the background thread to finish its current variant and
+        /// discards the rest. Main thread only.
+        void flushAsyncShaderGeneration(void);
+
         HighLevelGpuProgramPtr compileShaderCode( const String &source,
                                                   const String &debugFilenameOutput,
                                                   uint32 finalHash, ShaderType shaderType );
@@ -390,6 +528,9 @@ namespace Ogre
             The renderable who owns the renderableHash. Not used by the base class, but
             derived implementations may overload this function and take advantage of
             some of the direct access it provides.
+            The renderable is null when warming up PSOs from an HlmsDiskCache
+            (only if supportsPsoWarmUp returns true). mWarmUpPso holds the
+            macroblock, blendblock & vertex format to use instead.
         @return
             The newly created shader.
         */
@@ -402,6 +543,11 @@ namespace Ogre
         /// the renderable properties have been merged with the pass properties.
         virtual void notifyPropertiesMergedPreGenerationStep(void);
 
+        /// Whether createShaderCacheEntry can be called without a renderable, so that
+        /// HlmsDiskCache::applyTo can create PSOs ahead of time. Implementations that
+        /// need the renderable (or its datablock) to build the PSO must return false.
+        virtual bool supportsPsoWarmUp(void) const                  { return false; }
+
         virtual HlmsDatablock* createDatablockImpl( IdString datablockName,
                                                     const HlmsMacroblock *macroblock,
                                                     const HlmsBlendblock *blendblock,
@@ -608,6 +754,22 @@ namespace Ogre
                                         const String &filename=BLANKSTRING,
                                         const String &resourceGroup=BLANKSTRING );
 
+        /** Same as the overload above, but with blocks already returned by HlmsManager.
+            Creating lots of datablocks that share the same blocks (i.e. when loading
+            a material library) this way avoids looking them up by value every time.
+        @param macroblock
+            Block returned by HlmsManager::getMacroblock. We add our own reference.
+        @param blendblock
+            Block returned by HlmsManager::getBlendblock. We add our own reference.
+        */
+        HlmsDatablock* createDatablock( IdString name, const String &refName,
+                                        const HlmsMacroblock *macroblock,
+                                        const HlmsBlendblock *blendblock,
+                                        const HlmsParamVec &paramVec,
+                                        bool visibleToManager=true,
+                                        const String &filename=BLANKSTRING,
+                                        const String &resourceGroup=BLANKSTRING );
+
         /** Finds an existing datablock based on its name (@see createDatablock)
         @return
             The datablock associated with that name. Null pointer if not found. Doesn't throw.
@@ -707,11 +869,29 @@ namespace Ogre
             should cast shadows)
         @param casterPass
             True if this pass is the shadow mapping caster pass, false otherwise
+        @param allowDeferral
+            When true and the shader compilation budget for this frame has been
+            exhausted, or the shaders are being generated in the background, null
+            is returned. The caller must then skip the draw.
+            @see setShaderCompilationBudget, setAsyncShaderGeneration
         @return
             Structure containing all necessary shaders
         */
         const HlmsCache* getMaterial( HlmsCache const *lastReturnedValue, const HlmsCache &passCache,
-                                      const QueuedRenderable &queuedRenderable, bool casterPass );
+                                      const QueuedRenderable &queuedRenderable, bool casterPass,
+                                      bool allowDeferral=false );
+
+        /** Looks up the HlmsCache getMaterial would return, but never creates it nor
+            updates its usage stats.
+        @remarks
+            Can be called from multiple threads at the same time, as long as no thread
+            is creating or destroying shader cache entries meanwhile.
+        @return
+            The cache, or null if the shaders for it haven't been created yet.
+        */
+        const HlmsCache* getExistingMaterial( const HlmsCache &passCache,
+                                              const QueuedRenderable &queuedRenderable,
+                                              bool casterPass ) const;
 
         /** Fills the constant buffers. Gets executed right before drawing the mesh.
         @param cache
@@ -749,6 +929,108 @@ namespace Ogre
         /// Called when the frame has fully ended (ALL passes have been executed to all RTTs)
         virtual void frameEnded(void) {}
 
+        /** Limits how much time per frame can be spent generating the shaders of new
+            material / mesh / pass permutations (template parsing + API compilation).
+            Once the budget is exhausted, the RenderQueue skips the draws needing
+            yet another new variant; they will be created in the upcoming frames.
+        @remarks
+            At least one new variant is generated every frame, so rendering always
+            makes progress. Objects with pending shaders pop in a few frames late,
+            which is usually preferred over a 100+ ms stall when streaming in content.
+        @par
+            Template parsing can be moved out of the main thread with
+            setAsyncShaderGeneration; the budget then covers the API compilation.
+            Use HlmsDiskCache to avoid the cost altogether on subsequent runs.
+        @param microseconds
+            Budget per frame, per Hlms. 0 to disable (default); shaders are always
+            generated when needed.
+        */
+        void setShaderCompilationBudget( uint64 microseconds );
+        uint64 getShaderCompilationBudget(void) const   { return mShaderCompilationBudget; }
+
+        /// Number of draws skipped because their shaders were deferred by the compilation
+        /// budget or still being generated, during the last frame that needed new shaders.
+        uint32 getNumDeferredDraws(void) const          { return mNumDeferredDraws; }
+
+        /** Expands the templates of new shader variants on a background thread. The
+            RenderQueue skips the draws whose shaders aren't ready yet; once the templates
+            are expanded, the shaders are compiled & the PSO created on the main thread,
+            the next time a draw needs them.
+        @remarks
+            Only affects the draws that can be deferred (@see getMaterial). Expansion is
+            usually the bulk of the cost of a new variant, but the API compilation still
+            runs on the main thread, since the GpuProgram creation goes through resource
+            managers (and, on GL, a context) that aren't thread safe.
+            Combine with setShaderCompilationBudget to spread the compilations too.
+        @par
+            Changing the settings that affect the templates (e.g. reloadFrom, setHighQuality)
+            waits for the variant being expanded and discards the queued ones.
+            The listener & notifyPropertiesMergedPreGenerationStep still run on the
+            main thread, each time a deferred draw is retried.
+        @param bAsync
+            False (default) to generate all shaders on the main thread, when needed.
+        */
+        void setAsyncShaderGeneration( bool bAsync );
+        bool getAsyncShaderGeneration(void) const       { return mAsyncShaderGenerator != 0; }
+
+        /// Shader variants queued or being expanded in the background.
+        size_t getNumPendingShaderVariants(void) const;
+
+        /// For internal use. Runs the background thread until setAsyncShaderGeneration( false )
+        void _asyncShaderGeneratorThread(void);
+
+        struct PsoStatistics
+        {
+            /// PSOs currently alive (i.e. mShaderCache.size())
+            size_t  numLivePsos;
+            /// Shader permutations currently cached (i.e. mShaderCodeCache.size())
+            size_t  numShaderVariants;
+            /// Sum of HlmsCache::numHits of the live PSOs
+            uint64  numHits;
+            /// PSOs created since startup, including the ones later evicted or cleared
+            uint32  numPsosCreated;
+            /// PSOs destroyed by _evictStalePsos since startup
+            uint32  numPsosEvicted;
+            /// Microseconds spent creating all those PSOs (and their shaders)
+            uint64  totalCreationTime;
+        };
+
+        /** Gathers usage statistics about the PSOs this Hlms generated.
+            Per-PSO statistics (hits, creation time, last use) live in each HlmsCache;
+            see getPsoCache.
+        */
+        PsoStatistics getPsoStatistics(void) const;
+
+        /** When enabled, the time spent in each stage of shader generation (the template
+            parsers and the API compilation) is accumulated. @see getShaderGenerationTimings
+        @remarks
+            Enabling it resets the timings. Disabled by default, since it adds a couple of
+            timer queries per parser pass.
+        */
+        void setShaderGenerationTiming( bool bEnable );
+        bool getShaderGenerationTiming(void) const      { return mCpuTimer != 0; }
+        const ShaderGenerationTimings& getShaderGenerationTimings(void) const
+                                                        { return mShaderGenerationTimings; }
+
+        /// Live PSOs, sorted by hash. Don't hold on to these pointers across
+        /// frames, they may get evicted. @see HlmsManager::setPsoEviction
+        const HlmsCacheVec& getPsoCache(void) const     { return mShaderCache; }
+
+        /// Number of frames ended. HlmsCache::lastUsedFrame is relative to this counter.
+        uint32 getFrameCount(void) const                { return mFrameCount; }
+
+        /** Destroys the PSOs that haven't been used in the last maxUnusedFrames frames.
+            Called by HlmsManager at the end of every frame. Advances getFrameCount.
+        @remarks
+            Only the PSOs are destroyed. The shaders they used stay in mShaderCodeCache,
+            so if an evicted PSO is needed again it's recreated without recompiling.
+        @param maxUnusedFrames
+            0 to never evict.
+        @param maxLivePsos
+            Nothing gets evicted while there aren't more than this many live PSOs.
+        */
+        void _evictStalePsos( uint32 maxUnusedFrames, size_t maxLivePsos );
+
         /** Call to output the automatically generated shaders (which are usually made from templates)
             on the given folder for inspection, analyzing, debugging, etc.
         @remarks
@@ -811,10 +1093,13 @@ namespace Ogre
     struct _OgreExport HlmsBaseProp
     {
         static const IdString Skeleton;
+        static const IdString SkeletonGpu;
+        static const IdString SkeletonBaked;
         static const IdString BonesPerVertex;
         static const IdString Pose;
         static const IdString PoseHalfPrecision;
         static const IdString PoseNormals;
+        static const IdString PoseSparse;
 
         static const IdString Normal;
         static const IdString QTangent;
@@ -870,6 +1155,10 @@ namespace Ogre
         static const IdString UvBaking;
         static const IdString BakeLightingOnly;
         static const IdString GenNormalsGBuf;
+        static const IdString GenGBuffer;
+        static const IdString GenMotionVectors;
+        static const IdString TemporalJitter;
+        static const IdString OitWeighted;
         static const IdString PrePass;
         static const IdString UsePrePass;
         static const IdString UsePrePassMsaa;
@@ -905,6 +1194,8 @@ namespace Ogre
         static const IdString AlphaTest;
         static const IdString AlphaTestShadowCasterOnly;
         static const IdString AlphaBlend;
+        /// Alpha blended with SBF_ONE as source factor, i.e. the colour is premultiplied
+        static const IdString AlphaBlendPremultiplied;
         // Per material. Related with SsRefractionsAvailable
         static const IdString ScreenSpaceRefractions;
 
@@ -198,9 +198,20 @@ namespace Ogre
 
         HlmsPso         pso;
 
-        HlmsCache() : hash( 0 ), type( HLMS_MAX ) {}
+        /// Usage statistics. Updated by Hlms::getMaterial, which only has a const pointer.
+        /// Number of draws that used this PSO.
+        mutable uint64  numHits;
+        /// Hlms::getFrameCount() value when this PSO was last used. @see HlmsManager::setPsoEviction
+        mutable uint32  lastUsedFrame;
+        /// Microseconds it took to create this entry (includes generating and
+        /// compiling the shaders if no other PSO shared them yet).
+        mutable uint64  creationTime;
+
+        HlmsCache() : hash( 0 ), type( HLMS_MAX ), numHits( 0 ), lastUsedFrame( 0 ),
+            creationTime( 0 ) {}
         HlmsCache( uint32 _hash, HlmsTypes _type, const HlmsPso &_pso ) :
-            hash( _hash ), type( _type ), pso( _pso ) {}
+            hash( _hash ), type( _type ), pso( _pso ), numHits( 0 ), lastUsedFrame( 0 ),
+            creationTime( 0 ) {}
     };
 
     #define OGRE_EXTRACT_HLMS_TYPE_FROM_CACHE_HASH( x ) (x >> 29)
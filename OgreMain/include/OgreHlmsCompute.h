@@ -114,6 +114,14 @@ namespace Ogre
         void processPieces( const StringVector &pieceFiles );
         HlmsComputePso compileShader( HlmsComputeJob *job, uint32 finalHash );
 
+        /** Dispatches a job.
+        @param prevJob
+            Job dispatched right before this one, whose bindings are still set in the
+            RenderSystem. Bindings shared with it are skipped. Can be null.
+        */
+        void dispatch( HlmsComputeJob *job, SceneManager *sceneManager, Camera *camera,
+                       const HlmsComputeJob *prevJob );
+
         virtual HlmsDatablock* createDatablockImpl( IdString datablockName,
                                                     const HlmsMacroblock *macroblock,
                                                     const HlmsBlendblock *blendblock,
@@ -171,6 +179,16 @@ namespace Ogre
         /// Main function for dispatching a compute job.
         void dispatch( HlmsComputeJob *job, SceneManager *sceneManager, Camera *camera );
 
+        /** Dispatches multiple jobs back to back, without any barrier in between.
+            Jobs sharing descriptor sets or const buffers with the previous job in
+            the list don't rebind them.
+        @remarks
+            The caller is responsible for ensuring the jobs are independent, i.e.
+            none of them reads or writes what another one in the list writes.
+        */
+        void dispatch( HlmsComputeJob * const *jobs, size_t numJobs,
+                       SceneManager *sceneManager, Camera *camera );
+
         virtual void _changeRenderSystem( RenderSystem *newRs );
 
         virtual HlmsDatablock* createDefaultDatablock(void);
@@ -454,6 +454,12 @@ namespace Ogre
         /// See HlmsDatablock::getDiffuseColour
         virtual TextureGpu* getEmissiveTexture(void) const;
 
+        /// Called by RenderQueue when mip streaming is enabled, with the approximate size
+        /// (in pixels) an object using this datablock covers on screen. Implementations
+        /// forward it to their textures via TextureGpu::_notifyRequiredResolution.
+        /// @see TextureGpuManager::setMipStreaming
+        virtual void _notifyProjectedSize( uint32 pixels ) {}
+
         /**
         @remarks
             It's possible to set both saveOitd & saveOriginal to true, but will likely double
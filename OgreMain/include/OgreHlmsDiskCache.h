@@ -166,11 +166,22 @@ namespace Ogre
         };
 
         bool        mTemplatesOutOfDate;
+        /// True if mCache changed since it was loaded. @see mergeFrom
+        bool        mDirty;
         Cache       mCache;
         HlmsManager *mHlmsManager;
         String      mShaderProfile;
         uint16      mDebugStrSize;
 
+        typedef vector<const HlmsMacroblock*>::type HlmsMacroblockVec;
+        typedef vector<const HlmsBlendblock*>::type HlmsBlendblockVec;
+        /// References held on behalf of the PSOs created by applyTo( hlms, true ),
+        /// so the blocks stay alive until the datablocks that use them get created.
+        HlmsMacroblockVec   mWarmUpMacroblocks;
+        HlmsBlendblockVec   mWarmUpBlendblocks;
+
+        void releaseWarmUpBlocks(void);
+
         void save( DataStreamPtr &dataStream, const IdString &hashedString );
         void save( DataStreamPtr &dataStream, const String &string );
         void save( DataStreamPtr &dataStream, const HlmsPropertyVec &properties );
@@ -181,6 +192,11 @@ namespace Ogre
         void load( DataStreamPtr &dataStream, HlmsPropertyVec &properties );
         void load( DataStreamPtr &dataStream, Hlms::RenderableCache &renderableCache );
 
+        /// Adds the shaders & PSOs of the Hlms to mCache. When skipExisting is true,
+        /// entries already present in mCache aren't added again.
+        /// Returns true if anything was added.
+        bool addEntriesFrom( Hlms *hlms, bool skipExisting );
+
     public:
         HlmsDiskCache( HlmsManager *hlmsManager );
         ~HlmsDiskCache();
@@ -188,7 +204,43 @@ namespace Ogre
         void clearCache(void);
 
         void copyFrom( Hlms *hlms );
-        void applyTo( Hlms *hlms );
+
+        /** Compiles all the cached shaders into the Hlms.
+        @param hlms
+            Hlms to apply the cache to. Must be of the same type the cache was created from.
+        @param createPsos
+            When true, the cached PSOs are created as well (i.e. the cache acts as a
+            manifest of every renderable & pass combination seen in previous runs). This
+            moves the cost of creating them (e.g. linking GL programs) out of the first
+            frame that needs them and into loading time.
+            Only applies if Hlms::supportsPsoWarmUp returns true.
+        @remarks
+            When createPsos is true, this HlmsDiskCache keeps a reference to the macroblocks
+            and blendblocks those PSOs use. Keep it alive until the materials have been loaded
+            (i.e. their datablocks reference these blocks too), otherwise the blocks may be
+            destroyed, and the PSO entries are only reused if the same blocks get the same slots.
+        */
+        void applyTo( Hlms *hlms, bool createPsos=false );
+
+        /** Like copyFrom, but keeps what's already in the cache (i.e. it was loaded with
+            loadFrom) and only appends the shaders & PSOs that aren't in it yet.
+        @remarks
+            This allows a cache file to accumulate the permutations seen by every run
+            (or every process sharing it) instead of only keeping those from the last one:
+            @code
+                diskCache.loadFrom( existingFile );
+                diskCache.mergeFrom( hlms );
+                if( diskCache.isDirty() )
+                    diskCache.saveTo( newFile );
+            @endcode
+            The loaded cache must have been built from the same templates, Hlms type
+            and shader profile. Otherwise its contents are stale and it behaves exactly
+            like copyFrom.
+        */
+        void mergeFrom( Hlms *hlms );
+
+        /// True if the cache has changed since loadFrom (or clearCache), i.e. it needs saving
+        bool isDirty(void) const                { return mDirty; }
 
         void saveTo( DataStreamPtr &dataStream );
         void loadFrom( DataStreamPtr &dataStream );
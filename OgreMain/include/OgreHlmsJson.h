@@ -152,6 +152,12 @@ namespace Ogre
                             const char *jsonString,
                             const String &additionalTextureExtension );
 
+        /// Same as the loadMaterials overload above, but with the JSON already parsed
+        /// (i.e. by a rapidjson::Document on another thread).
+        void loadMaterials( const String &filename, const String &resourceGroup,
+                            const rapidjson::Value &json,
+                            const String &additionalTextureExtension );
+
         /** Saves all the Datablocks defined in the given
             Hlms into a JSON formatted string.
         @param hlms
@@ -62,6 +62,9 @@ namespace Ogre
         OGRE_SIMD_ALIGNED_DECL( Matrix4, mTempXform[256] );
         AutoParamDataSource *mAutoParamDataSource;
         SceneManager    *mCurrentSceneManager;
+        /// Pass used by the previous executeCommand. Reset by preparePassHash.
+        /// @see executeCommand
+        Pass const      *mLastPass;
 
         virtual const HlmsCache* createShaderCacheEntry( uint32 renderableHash,
                                                          const HlmsCache &passCache,
@@ -120,6 +120,13 @@ namespace Ogre
 
         HlmsTypes           mDefaultHlmsType;
 
+        /// See setPsoEviction
+        uint32              mPsoEvictionMaxUnusedFrames;
+        size_t              mPsoEvictionMaxLivePsos;
+
+        /// See setLoadTexturesLazily
+        bool                mLoadTexturesLazily;
+
 #if !OGRE_NO_JSON
         StringVector mScriptPatterns;
 
@@ -344,7 +351,9 @@ namespace Ogre
         @param hlmsType
             Hlms type. The type must be registered, otherwise it may crash.
         @param filename
-            Valid file path.
+            Valid file path. If it ends in ".bin" (i.e. "Catalogue.material.bin") the
+            materials are saved in JsonBinary format, which is parsed as a script like
+            *.material.json but loads much faster.
         */
         void saveMaterials( HlmsTypes hlmsType,const String &filename,
                             HlmsJsonListener *listener,
@@ -354,7 +363,7 @@ namespace Ogre
         @param datablock
             Datablock/Material to save
         @param filename
-            Valid file path.
+            Valid file path. See saveMaterials regarding the ".bin" extension.
         */
         void saveMaterial( const HlmsDatablock *datablock, const String &filename,
                            HlmsJsonListener *listener,
@@ -362,6 +371,9 @@ namespace Ogre
 
         //ScriptLoader overloads
         virtual void parseScript(DataStreamPtr& stream, const String& groupName);
+        virtual PreparedScript* prepareScript(DataStreamPtr& stream, const String& groupName);
+        virtual void parsePreparedScript(PreparedScript *preparedScript, DataStreamPtr& stream,
+                                         const String& groupName);
         virtual const StringVector& getScriptPatterns(void) const       { return mScriptPatterns; }
         virtual Real getLoadingOrder(void) const;
 #endif
@@ -400,6 +412,39 @@ namespace Ogre
         /// to get how which indices are active. @see _getBlocks to retrieve
         /// all types of block in a generic way.
         const HlmsSamplerblock* _getSamplerblock( uint16 idx ) const;
+
+        /** Destroys the PSOs that haven't been used for a while, so long sessions
+            that cycle through many materials & meshes don't keep growing driver memory.
+        @remarks
+            Evicted PSOs are recreated on demand next time they're needed; their shaders
+            stay cached so this doesn't trigger recompilations.
+            @see Hlms::getPsoStatistics to monitor how many PSOs are alive.
+        @param maxUnusedFrames
+            PSOs not used in this many frames get destroyed. 0 to disable (default).
+            Must be larger than the number of frames the GPU can be behind the CPU.
+        @param maxLivePsos
+            Per Hlms. Nothing gets evicted from an Hlms until it holds more than this
+            many PSOs. Use it to keep a working set around.
+        */
+        void setPsoEviction( uint32 maxUnusedFrames, size_t maxLivePsos = 0 );
+        uint32 getPsoEvictionMaxUnusedFrames(void) const    { return mPsoEvictionMaxUnusedFrames; }
+        size_t getPsoEvictionMaxLivePsos(void) const        { return mPsoEvictionMaxLivePsos; }
+
+        /// Called by Root at the end of every frame. @see setPsoEviction
+        void _evictStalePsos(void);
+
+        /** When true, materials parsed from JSON don't create their textures right away.
+            Instead they're created the first time a Renderable using the datablock is
+            seen by its Hlms (i.e. when the datablock is assigned), so that libraries with
+            thousands of materials only pay for the ones that are actually used.
+        @remarks
+            Until then HlmsDatablock::getTexture returns null for those units.
+            Call resolvePendingTextures on the datablock to force it.
+            Saving a material resolves its textures first.
+            Default is false.
+        */
+        void setLoadTexturesLazily( bool loadLazily )   { mLoadTexturesLazily = loadLazily; }
+        bool getLoadTexturesLazily(void) const          { return mLoadTexturesLazily; }
     };
     /** @} */
     /** @} */
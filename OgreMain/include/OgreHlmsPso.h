@@ -142,6 +142,9 @@ namespace Ogre
             InvertVertexWinding         = 1u << 1u,
             NoDepthBuffer               = 1u << 2u,
             ForceDepthClamp             = 1u << 3u,
+            /// Alpha blended objects get a strong blendblock too.
+            /// See OitMode::WeightedBlended
+            WeightedBlendedOit          = 1u << 4u,
         };
     };
 
@@ -42,11 +42,29 @@ namespace Ogre
     class _OgreExport Id
     {
     public:
-        //This function assumes creation of new objects can't be made from multiple threads!!!
-        template <typename T> static IdType generateNewId()
+        //These functions assume creation of new objects can't be made from multiple threads!!!
+        template <typename T> static IdType& _getCurrentId()
         {
             static IdType g_currentId = 0;
-            return g_currentId++;
+            return g_currentId;
+        }
+
+        template <typename T> static IdType generateNewId()
+        {
+            return _getCurrentId<T>()++;
+        }
+
+        /** Reserves numIds consecutive Ids that generateNewId won't return.
+            The caller can later assign them from any thread.
+        @return
+            The first reserved Id. The range is [retVal; retVal + numIds)
+        */
+        template <typename T> static IdType reserveIds( IdType numIds )
+        {
+            IdType &currentId = _getCurrentId<T>();
+            const IdType retVal = currentId;
+            currentId += numIds;
+            return retVal;
         }
     };
 
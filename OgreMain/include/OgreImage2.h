@@ -344,6 +344,9 @@ namespace Ogre {
             /// This prevents certain artifacts for some images when using FILTER_GAUSSIAN,
             /// like biasing towards certain direction. Not supported by cubemaps.
             FILTER_GAUSSIAN_HIGH,
+            /// Lanczos with 3 lobes. Sharpest, most expensive filter. Only used by scale
+            /// and resize; generateMipmaps treats it as FILTER_BILINEAR.
+            FILTER_LANCZOS,
         };
 
         /** Scale a 1D, 2D or 3D image volume. 
@@ -351,10 +354,35 @@ namespace Ogre {
             @param  dst         PixelBox containing the destination pointer, dimensions and format
             @param  filter      Which filter to use
             @remarks    This function can do pixel format conversion in the process.
+            @remarks
+                FILTER_BOX, FILTER_TRIANGLE, FILTER_BICUBIC and FILTER_LANCZOS use a separable
+                resampler working in linear space (sRGB formats are decoded first), which
+                splits rows across worker threads for big images.
+                3D images whose depth changes fall back to FILTER_BILINEAR.
             @note   dst and src can point to the same PixelBox object without any problem
         */
         static void scale( const TextureBox &src, PixelFormatGpu srcFormat,
                            TextureBox &dst, PixelFormatGpu dstFormat, Filter filter = FILTER_BILINEAR );
+
+        /** Scales an image straight into memory mapped from a StagingTexture, avoiding an
+            intermediate copy when the result is going to be uploaded to the GPU.
+        @remarks
+            stagingTexture must be between startMapRegion and stopMapRegion.
+            Depth and number of slices are the same as src's.
+        @param dstWidth
+            Width of the resampled image.
+        @param dstHeight
+            Height of the resampled image.
+        @return
+            The mapped region with the resampled data, ready to be passed to
+            StagingTexture::upload. If TextureBox::data is null, the StagingTexture did not
+            have enough space and nothing was done.
+        */
+        static TextureBox scaleToStagingTexture( const TextureBox &src, PixelFormatGpu srcFormat,
+                                                 StagingTexture *stagingTexture,
+                                                 uint32 dstWidth, uint32 dstHeight,
+                                                 PixelFormatGpu dstFormat,
+                                                 Filter filter = FILTER_BILINEAR );
         
         /** Resize a 2D image, applying the appropriate filter. */
         void resize( uint32 width, uint32 height, Filter filter = FILTER_BILINEAR );
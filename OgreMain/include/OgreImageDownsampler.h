@@ -211,6 +211,21 @@ namespace Ogre
     ImageBlur2D separableBlur_sRGB_XA88;
     ImageBlur2D separableBlur_sRGB_AX88;
 
+    //-----------------------------------------------------------------------------------
+    //SIMD versions
+    //-----------------------------------------------------------------------------------
+
+    /** Same results as their scalar counterparts (e.g. downscale2x_SIMD_XXXA8888 returns exactly
+        what downscale2x_XXXA8888 would), but the linear (2x2) kernel, which is the default filter,
+        is done with SSE2 / NEON where available. Other kernels fall back to the scalar version.
+    @remarks
+        sRGB variants only have an SSE2 path.
+    */
+    ImageDownsampler2D downscale2x_SIMD_XXXA8888;
+    ImageDownsampler2D downscale2x_SIMD_XX88;
+    ImageDownsampler2D downscale2x_SIMD_X8;
+    ImageDownsampler2D downscale2x_SIMD_sRGB_XXXA8888;
+
     struct FilterKernel
     {
         uint8   kernel[5][5];
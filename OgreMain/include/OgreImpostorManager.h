@@ -0,0 +1,316 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreImpostorManager_H_
+#define _OgreImpostorManager_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreMovableObject.h"
+#include "OgreRenderable.h"
+#include "OgreColourValue.h"
+#include "Compositor/OgreCompositorWorkspaceListener.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    class ImpostorDefinition;
+
+    /** Draws all the impostors of an ImpostorDefinition in a single instanced draw.
+        Created and owned by ImpostorManager.
+    @remarks
+        Every instance is a quad the vertex shader orients like the baked frame closest
+        to the view direction. Positions are in world space; the batch is attached to
+        its own SceneNode, which is only used for culling.
+    */
+    class _OgreExport ImpostorBatch : public MovableObject, public Renderable
+    {
+        ImpostorDefinition  *mDefinition;
+
+        VaoManager          *mVaoManager;
+        VertexBufferPacked  *mVertexBuffer;
+        IndexBufferPacked   *mIndexBuffer;
+        TexBufferPacked     *mInstanceBuffer;
+        uint32              mCapacity;
+        uint32              mLastInstanceFrame;
+
+        void createBuffers( uint32 capacity );
+        void destroyBuffers(void);
+
+    public:
+        ImpostorBatch( IdType id, ObjectMemoryManager *objectMemoryManager,
+                       SceneManager *manager, uint8 renderQueueId,
+                       ImpostorDefinition *definition );
+        virtual ~ImpostorBatch();
+
+        /** Uploads the instances of the definition and updates the bounds.
+            Called by ImpostorManager once per frame.
+        @remarks
+            The instance buffer starts with 4 float4:
+                0. framesPerSide; 1 / framesPerSide; framesPerSide - 1; unused
+                1. xyz = direction towards the light
+                2. rgb = colour of the light
+                3. rgb = ambient colour
+            Followed by 2 float4 per instance:
+                0. xyz = world position of the mesh's centre; w = scaled radius
+                1. xyz = orientation (quaternion; w is positive and reconstructed);
+                   w = cross fade (0 = invisible, 1 = opaque)
+        @param lightDir
+            Direction towards the light, in world space.
+        */
+        void writeInstances( const Vector3 &lightDir, const ColourValue &lightColour,
+                             const ColourValue &ambient );
+
+        //Overrides from MovableObject
+        virtual const String& getMovableType(void) const;
+
+        //Overrides from Renderable
+        virtual const LightList& getLights(void) const;
+        virtual void getRenderOperation( v1::RenderOperation &op, bool casterPass );
+        virtual void getWorldTransforms( Matrix4 *xform ) const;
+        virtual bool getCastsShadows(void) const;
+        /// Positions are in world space
+        virtual bool getUseIdentityWorldMatrix(void) const          { return true; }
+        virtual TexBufferPacked* getImpostorInstanceBuffer(void) const;
+    };
+
+    /// The atlases & instances of a Mesh rendered as impostors. See ImpostorManager.
+    class _OgreExport ImpostorDefinition : public UtilityAlloc
+    {
+        friend class ImpostorManager;
+        friend class ImpostorBatch;
+
+        struct Instance
+        {
+            Item    *item;
+            /// 0 = the Item is rendered, 1 = the impostor is. Updated every frame
+            Real    fade;
+        };
+        typedef vector<Instance>::type InstanceVec;
+
+        MeshPtr         mMesh;
+        uint32          mFramesPerSide;
+        uint32          mFrameResolution;
+        /// Bounds of the mesh the frames are centred on
+        Vector3         mCentre;
+        Real            mRadius;
+
+        TextureGpu      *mAlbedoAtlas;
+        TextureGpu      *mNormalDepthAtlas;
+        HlmsDatablock   *mDatablock;
+        ImpostorBatch   *mBatch;
+
+        Real            mLodStart;
+        Real            mLodEnd;
+        bool            mBaked;
+
+        InstanceVec     mInstances;
+
+    public:
+        ImpostorDefinition( const MeshPtr &mesh, uint32 framesPerSide, uint32 frameResolution,
+                            Real lodStart, Real lodEnd );
+
+        const MeshPtr& getMesh(void) const              { return mMesh; }
+        uint32 getFramesPerSide(void) const             { return mFramesPerSide; }
+        uint32 getFrameResolution(void) const           { return mFrameResolution; }
+
+        /** Sets when Items switch to the impostor.
+        @param lodStart
+            LOD user value (i.e. a distance with the default strategy) at which the impostor
+            starts fading in.
+        @param lodEnd
+            LOD user value at which the impostor is fully opaque and the Item gets hidden.
+        */
+        void setLodValues( Real lodStart, Real lodEnd )  { mLodStart = lodStart; mLodEnd = lodEnd; }
+        Real getLodStart(void) const                    { return mLodStart; }
+        Real getLodEnd(void) const                      { return mLodEnd; }
+
+        /// Albedo (rgb) & coverage (a) of every frame. PFG_RGBA8_UNORM_SRGB
+        TextureGpu* getAlbedoAtlas(void) const          { return mAlbedoAtlas; }
+        /// Object space normal (rgb) & linear depth (a) of every frame. PFG_RGBA8_UNORM
+        TextureGpu* getNormalDepthAtlas(void) const     { return mNormalDepthAtlas; }
+        /// HlmsUnlit datablock sampling both atlases
+        HlmsDatablock* getDatablock(void) const         { return mDatablock; }
+
+        /// False until the atlases have been rendered. The Items aren't replaced until then.
+        bool isBaked(void) const                        { return mBaked; }
+
+        size_t getNumItems(void) const                  { return mInstances.size(); }
+    };
+
+    /** Replaces distant Items with octahedral impostors: cards textured with captures of
+        the mesh from many view directions. Forests and city skylines with thousands of
+        Items become one draw per mesh with 4 vertices per Item.
+    @remarks
+        createImpostor bakes two atlases with an N x N grid of orthographic frames each,
+        whose view directions are given by the octahedral encoding of the grid (Y up,
+        covering the whole sphere):
+            - Albedo (rgb) & coverage (a).
+            - Object space normals (rgb) & linear depth (a). The normals are reconstructed
+              from the depth buffer rather than captured, thus normal maps aren't baked.
+    @par
+        Baking happens through a manually updated compositor workspace (generated on
+        the fly, one scene pass per frame plus a pass packing the normals) rendering a
+        private SceneManager in CompositorWorkspaceListener::allWorkspacesBeginUpdate,
+        thus this object is registered as a listener of CompositorManager2 while it's
+        alive. Bakes are queued and at most one mesh is baked per frame to spread the cost.
+        The mesh is lit by a uniform white ambient light, thus the albedo atlas contains
+        the materials' diffuse colour (plus what the Hlms adds for ambient lighting).
+    @par
+        Every frame, the value of the default LodStrategy is evaluated for every Item added
+        via addItem against the definition's LOD values (see ImpostorDefinition::setLodValues)
+        using the camera given to setCamera. Between both values the impostor fades in with
+        screen space dithering on top of the Item; past the last value the Item is hidden
+        with MovableObject::setVisible (removeItem makes it visible again).
+    @par
+        The impostors are rendered with HlmsUnlit (see Renderable::getImpostorInstanceBuffer)
+        and lit in the pixel shader with one directional light (see setLight) plus ambient.
+    @par
+        Limitations:
+            - Items must be scaled uniformly (the largest scale is used).
+            - Datablocks set on the Item itself are ignored, the mesh's are baked.
+            - Skeletal animation is ignored, the bind pose is baked.
+            - Impostors don't cast shadows.
+            - GLSL ES is not supported.
+    */
+    class _OgreExport ImpostorManager : public CompositorWorkspaceListener, public UtilityAlloc
+    {
+    protected:
+        typedef vector<ImpostorDefinition*>::type ImpostorDefinitionVec;
+
+        ImpostorDefinitionVec   mDefinitions;
+        /// Definitions waiting to be baked, in order
+        ImpostorDefinitionVec   mPendingBakes;
+
+        SceneManager        *mSceneManager;
+        Camera              *mCamera;
+        Light               *mLight;
+        uint8               mRenderQueueGroup;
+        Real                mDefaultLodStart;
+        Real                mDefaultLodEnd;
+
+        /// The mesh being baked. It is created one frame and rendered the next one,
+        /// once its SceneManager has updated its bounds
+        ImpostorDefinition  *mCurrentBake;
+        Item                *mBakeItem;
+        SceneManager        *mBakeSceneManager;
+        Camera              *mBakeCamera;
+
+        VaoManager          *mVaoManager;
+        TextureGpuManager   *mTextureGpuManager;
+        CompositorManager2  *mCompositorManager;
+
+        /// Returns the name of the workspace definition baking framesPerSide^2 frames,
+        /// creating it if it doesn't exist yet
+        IdString getBakeWorkspaceDefinition( uint32 framesPerSide );
+
+        void createBakeSceneManager(void);
+        /// Creates the Item to bake the next pending definition
+        void prepareNextBake(void);
+        /// Renders the atlases of mCurrentBake
+        void bake(void);
+        void destroyBakeItem(void);
+
+        /// Updates the fade of every instance and hides/shows the Items accordingly
+        void updateInstances( ImpostorDefinition *definition );
+
+        void destroyBatch( ImpostorDefinition *definition );
+
+    public:
+        /**
+        @param sceneManager
+            SceneManager the Items (and thus the impostors) belong to.
+        @param camera
+            See setCamera.
+        @param renderQueueGroup
+            Render queue of the impostors. Must be in FAST mode.
+        */
+        ImpostorManager( SceneManager *sceneManager, Camera *camera,
+                         CompositorManager2 *compositorManager, uint8 renderQueueGroup = 10u );
+        virtual ~ImpostorManager();
+
+        /** Creates the atlases of the mesh and queues them for baking.
+        @param framesPerSide
+            The atlases hold framesPerSide x framesPerSide frames. Must be at least 2.
+            More frames means less popping when the view direction changes.
+        @param frameResolution
+            Resolution in pixels of each frame.
+        */
+        ImpostorDefinition* createImpostor( const MeshPtr &mesh, uint32 framesPerSide = 8u,
+                                            uint32 frameResolution = 128u );
+        /// Destroys the definition. Its Items are made visible again.
+        void destroyImpostor( ImpostorDefinition *definition );
+        void destroyAllImpostors(void);
+
+        /** Lets the Item be replaced by the impostor when far enough.
+        @remarks
+            The Item must use the definition's mesh and be attached to a SceneNode.
+            Call removeItem before destroying the Item.
+        */
+        void addItem( Item *item, ImpostorDefinition *definition );
+        /// Stops replacing the Item. It is made visible again.
+        void removeItem( Item *item, ImpostorDefinition *definition );
+
+        /// LOD values given to new definitions. See ImpostorDefinition::setLodValues.
+        void setDefaultLodValues( Real lodStart, Real lodEnd );
+
+        /// LOD is evaluated against this camera (actually against its LOD camera).
+        void setCamera( Camera *camera )                    { mCamera = camera; }
+        Camera* getCamera(void) const                       { return mCamera; }
+
+        /** Directional light lighting the impostors. When null (the default), they're only lit
+            by the upper hemisphere ambient colour of the SceneManager.
+        */
+        void setLight( Light *light )                       { mLight = light; }
+        Light* getLight(void) const                         { return mLight; }
+
+        /// Returns true while there are meshes waiting to be baked.
+        bool isBaking(void) const;
+
+        //CompositorWorkspaceListener overloads
+        virtual void passEarlyPreExecute( CompositorPass *pass );
+        virtual void passPreExecute( CompositorPass *pass );
+        virtual void allWorkspacesBeginUpdate(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -99,6 +99,9 @@ namespace Ogre {
         /** The Mesh that this Item is based on.
         */
         MeshPtr mMesh;
+        /// When a placeholder is in use (see setPlaceholderMesh), the mesh being loaded.
+        /// mMesh is the placeholder meanwhile.
+        MeshPtr mPendingMesh;
 
         /** List of SubEntities (point to SubMeshes).
         */
@@ -114,9 +117,17 @@ namespace Ogre {
         /// Has this Item been initialised yet?
         bool mInitialised;
 
+        /// See setSubItemCulling
+        bool mSubItemCulling;
+        /// Local Aabb of each SubItem. Only filled when mSubItemCulling is enabled.
+        FastArray<Aabb> mSubItemAabbs;
+
         /** Builds a list of SubItems based on the SubMeshes contained in the Mesh. */
         void buildSubItems( vector<String>::type* materialsList = 0 );
 
+        /// Fills mSubItemAabbs & mRenderableAabbs from the SubMeshes' Aabbs
+        void updateSubItemAabbs(void);
+
     public:
         /** Default destructor.
         */
@@ -128,9 +139,25 @@ namespace Ogre {
         void _restoreManualHardwareResources();
 
         /** Gets the Mesh that this Item is based on.
+            While a placeholder is in use, this returns the placeholder.
         */
         const MeshPtr& getMesh(void) const;
 
+        /** Shows another mesh while the Item's mesh is still being loaded in the background
+            (see MeshManager::loadAsync), instead of showing nothing.
+        @remarks
+            The real mesh is swapped in once it's loaded. SubItems are rebuilt at that point,
+            so datablocks set while the placeholder is in use are lost.
+            Does nothing if the Item's mesh is already loaded.
+        @param placeholder
+            Mesh to show meanwhile (i.e. a box, or a low detail version). Gets loaded
+            if it isn't.
+        */
+        void setPlaceholderMesh( const MeshPtr &placeholder );
+
+        /// True while a placeholder mesh is in use. See setPlaceholderMesh
+        bool isUsingPlaceholderMesh(void) const         { return !mPendingMesh.isNull(); }
+
         /** Gets a pointer to a SubItem, ie a part of an Item.
         */
         SubItem* getSubItem(size_t index);
@@ -140,6 +167,22 @@ namespace Ogre {
         */
         size_t getNumSubItems(void) const;
 
+        /** Enables culling each SubItem against the camera's frustum individually, after
+            the whole Item has passed frustum culling.
+        @remarks
+            Useful for large meshes made of many submeshes (e.g. a building where
+            each material is a submesh) where only a few of them are usually on screen.
+            SubMeshes without bounds (see SubMesh::hasAabb) get them calculated on the
+            fly, which requires reading back their buffers; prefer baking them with
+            OgreMeshTool -submeshbounds.
+        @par
+            Ignored for Items with a single SubItem and for skeletally animated Items,
+            since the SubMesh bounds are in bind pose. Only applies to the FAST render
+            queue path and isn't applied during shadow caster passes.
+        */
+        void setSubItemCulling( bool bEnable );
+        bool getSubItemCulling(void) const              { return mSubItemCulling; }
+
         /// Sets the given HLMS databloock to all SubEntities
         void setDatablock( HlmsDatablock *datablock );
 
@@ -259,6 +302,9 @@ namespace Ogre {
         void _deinitialise(void);
 
         virtual void _notifyParentNodeMemoryChanged(void);
+
+        /// Resource::Listener overload. Builds the Item once its background loaded mesh is ready.
+        virtual void loadingComplete( Resource *resource );
     };
 
     /** FItemy object for creating Item instances */
@@ -0,0 +1,146 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreItemPool_H_
+#define _OgreItemPool_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreVector3.h"
+#include "OgreQuaternion.h"
+#include "OgreCommon.h"
+#include "OgreSharedPtr.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** Recycles Items (each attached to its own SceneNode) of the same mesh, for objects that
+        are spawned & killed very often (projectiles, debris, effects).
+    @remarks
+        Releasing an Item hides it instead of destroying it. Its ObjectMemoryManager &
+        NodeMemoryManager slots, datablock (and thus its Hlms slots) and SkeletonInstance
+        are kept, so acquiring it again is O(1) and doesn't touch the heap, as long as the
+        pool doesn't need to grow (@see reserve).
+    @par
+        Each Item is attached to a child of the root SceneNode, which is owned by the pool.
+        Don't destroy, detach or reparent them; and don't attach anything else to the nodes.
+    @par
+        Released Items are culled cheaply through their visibility flags, but their nodes'
+        transforms are still updated every frame. Animations are left enabled as they were.
+        Keep the pool size close to the peak number of Items alive.
+    @par
+        SceneManager::clearScene & destroyAllItems destroy all the Items of the pool (and
+        their nodes); the pool itself can still be used afterwards.
+    */
+    class _OgreExport ItemPool : public SceneMgtAlloc
+    {
+        SceneManager        *mSceneManager;
+        MeshPtr             mMesh;
+        SceneMemoryMgrTypes mSceneType;
+        /// When null, the Items use the mesh's materials.
+        HlmsDatablock       *mDatablock;
+
+        /// All Items created by this pool, active or not.
+        FastArray<Item*>    mInstances;
+        /// Released Items. Used as a stack; its capacity is always >= mInstances.size()
+        /// so releasing never allocates.
+        FastArray<Item*>    mFreeInstances;
+
+        Item* createInstance(void);
+
+    public:
+        /// Don't call directly. @see SceneManager::createItemPool
+        ItemPool( SceneManager *sceneManager, const MeshPtr &mesh, SceneMemoryMgrTypes sceneType );
+        ~ItemPool();
+
+        /** Ensures the pool holds at least numInstances Items (active or not), creating the
+            missing ones hidden. Call it at load time to avoid allocations while playing.
+        */
+        void reserve( size_t numInstances );
+
+        /** Returns a hidden Item to the scene, or creates a new one if there are none left.
+        @remarks
+            The Item is exactly as it was left when released (except for its visibility),
+            the only exception being the transform of its SceneNode, which gets overwritten.
+        @return
+            The Item. Use Item::getParentSceneNode to move it around.
+        */
+        Item* acquire( const Vector3 &position = Vector3::ZERO,
+                       const Quaternion &orientation = Quaternion::IDENTITY,
+                       const Vector3 &scale = Vector3::UNIT_SCALE );
+
+        /** Hides the Item and puts it back in the pool.
+        @param item
+            Item returned by acquire from this pool. Releasing the same Item twice,
+            or an Item from another pool, is undefined.
+        */
+        void release( Item *item );
+
+        /// Releases all active Items.
+        void releaseAll(void);
+
+        /// Destroys the released Items & their nodes, hence freeing their slots.
+        /// Active Items are left untouched.
+        void shrinkToFit(void);
+
+        /** Sets the datablock used by all Items of the pool, present & future.
+        @param datablock
+            Null to go back to the mesh's materials (only affects future Items).
+        */
+        void setDatablock( HlmsDatablock *datablock );
+        HlmsDatablock* getDatablock(void) const                 { return mDatablock; }
+
+        const MeshPtr& getMesh(void) const                      { return mMesh; }
+        SceneMemoryMgrTypes getSceneMemoryMgrType(void) const   { return mSceneType; }
+
+        /// Number of Items created by this pool, active or not.
+        size_t getNumInstances(void) const      { return mInstances.size(); }
+        /// Number of Items currently acquired.
+        size_t getNumActive(void) const         { return mInstances.size() - mFreeInstances.size(); }
+        /// Number of Items waiting to be acquired.
+        size_t getNumFree(void) const           { return mFreeInstances.size(); }
+
+        /// Destroys all Items (active or not) & their nodes. The pool can still be used
+        /// afterwards. Called by SceneManager::clearScene & destroyAllItems. Main thread only.
+        void _destroyAllInstances(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,130 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreJsonBinary_H_
+#define _OgreJsonBinary_H_
+
+#include "OgrePrerequisites.h"
+
+#if !OGRE_NO_JSON
+
+#include "ogrestd/vector.h"
+#include "OgreHeaderPrefix.h"
+
+// Forward declaration for |Document|.
+namespace rapidjson
+{
+    class CrtAllocator;
+    template <typename> class MemoryPoolAllocator;
+    template <typename> struct UTF8;
+    template <typename, typename, typename> class GenericDocument;
+    typedef GenericDocument< UTF8<char>, MemoryPoolAllocator<CrtAllocator>, CrtAllocator > Document;
+
+    template <typename BaseAllocator> class MemoryPoolAllocator;
+    template <typename Encoding, typename>  class GenericValue;
+    typedef GenericValue<UTF8<char>, MemoryPoolAllocator<CrtAllocator> > Value;
+}
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Binary encoding of a JSON tree, used by the binary variant of the material format
+        (*.material.bin, see HlmsManager::saveMaterials).
+        It holds exactly the same tree so the consumers handle both the same way; but it can
+        be loaded without text parsing (or number conversion) and without copying strings.
+        Every distinct string (names of keys, textures, blocks...) is stored only once.
+
+        Layout (native endianness):
+        @code
+            char    magic[4];   // "OGJB"
+            uint32  version;    // FORMAT_VERSION
+            uint32  numStrings;
+            // numStrings times:
+            uint32  length;
+            char    str[length + 1];    // null terminated
+            // The document's root
+            value
+        @endcode
+        Where each value is a uint8 tag followed by:
+            * TagNull, TagFalse, TagTrue: nothing
+            * TagUint64: uint64
+            * TagInt64: int64
+            * TagDouble: double
+            * TagString: uint32 index into the string table
+            * TagArray: uint32 count, then count values
+            * TagObject: uint32 count, then count pairs of (uint32 key string index, value)
+    */
+    class _OgreExport JsonBinary
+    {
+    public:
+        enum Tag
+        {
+            TagNull,
+            TagFalse,
+            TagTrue,
+            TagUint64,
+            TagInt64,
+            TagDouble,
+            TagString,
+            TagArray,
+            TagObject
+        };
+
+        static const uint32 FORMAT_VERSION;
+
+        /// Returns true if the data starts with the magic number
+        static bool isBinaryJson( const void *data, size_t sizeBytes );
+
+        /// Appends the encoded document to outData
+        static void encode( const rapidjson::Value &root, vector<uint8>::type &outData );
+
+        /** Fills outDocument from data encoded with encode. Throws if the data is corrupt.
+        @remarks
+            Strings are not copied: outDocument references them, thus data must outlive it.
+        @param filename
+            Only used for error messages.
+        */
+        static void decode( const String &filename, const void *data, size_t sizeBytes,
+                            rapidjson::Document &outDocument );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
+
+#endif
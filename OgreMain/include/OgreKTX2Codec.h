@@ -0,0 +1,143 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __OgreKTX2Codec_H__
+#define __OgreKTX2Codec_H__
+
+#include "OgreImageCodec2.h"
+
+namespace Ogre {
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Image
+    *  @{
+    */
+
+    /** Interface to transcode supercompressed (Basis Universal ETC1S/UASTC) KTX2 payloads.
+    @remarks
+        Ogre does not ship a Basis Universal transcoder. Applications that want to load
+        Basis-compressed KTX2 files register their own (e.g. wrapping basist::ktx2_transcoder)
+        via KTX2Codec::setTranscoder.
+    @par
+        Decoding may happen from multiple threads at the same time (see
+        TextureGpuManager::setNumDecoderThreads), hence all functions must be thread safe.
+        Per-file state must live in the context returned by beginFile.
+    */
+    class _OgreExport KTX2Transcoder
+    {
+    public:
+        virtual ~KTX2Transcoder() {}
+
+        /** Called once per file, before any call to transcode.
+        @param fileData
+            The whole KTX2 file.
+        @return
+            Opaque context passed to transcode & endFile. Null if the file can't be transcoded.
+        */
+        virtual void* beginFile( const uint8 *fileData, size_t fileSize ) = 0;
+
+        /** Transcodes one surface.
+        @param dstFormat
+            Format to transcode to. See KTX2Codec::chooseTranscodeTarget.
+        @param dst
+            Where to write the surface. Rows are tightly packed for compressed formats and
+            aligned to 4 bytes for uncompressed ones (i.e. the Image2 layout).
+        @return
+            False on failure.
+        */
+        virtual bool transcode( void *context, uint32 level, uint32 layer, uint32 face,
+                                PixelFormatGpu dstFormat, void *dst, size_t dstBytes ) = 0;
+
+        virtual void endFile( void *context ) = 0;
+    };
+
+    /** Codec specialized in loading KTX2 (Khronos Texture 2.0) images.
+    @remarks
+        Files whose payload is already in a GPU format (vkFormat != VK_FORMAT_UNDEFINED)
+        are loaded as is, without supercompression.
+    @par
+        Basis Universal payloads (ETC1S or UASTC) are transcoded at load time to the best
+        format the current RenderSystem supports (see chooseTranscodeTarget), using the
+        transcoder registered via setTranscoder. Since decoding happens from the streaming
+        worker (and decoder) threads, so does transcoding.
+    */
+    class _OgreExport KTX2Codec : public ImageCodec2
+    {
+    protected:
+        String mType;
+
+        static void flipEndian( void *pData, size_t size, size_t count );
+
+        /// Single registered codec instance
+        static KTX2Codec *msInstance;
+        static KTX2Transcoder *msTranscoder;
+
+    public:
+        KTX2Codec();
+        virtual ~KTX2Codec() { }
+
+        /// @copydoc Codec::encode
+        DataStreamPtr encode(MemoryDataStreamPtr& input, CodecDataPtr& pData) const;
+        /// @copydoc Codec::encodeToFile
+        void encodeToFile(MemoryDataStreamPtr& input, const String& outFileName, CodecDataPtr& pData) const;
+        /// @copydoc Codec::decode
+        DecodeResult decode(DataStreamPtr& input) const;
+        /// @copydoc Codec::magicNumberToFileExt
+        String magicNumberToFileExt(const char *magicNumberPtr, size_t maxbytes) const;
+
+        virtual String getType() const;
+
+        /** Sets the transcoder used for Basis Universal payloads. Pointer must stay valid
+            until it's replaced or the codec is shut down. Can be null.
+            Do not call while textures are being streamed.
+        */
+        static void setTranscoder( KTX2Transcoder *transcoder );
+        static KTX2Transcoder* getTranscoder(void);
+
+        /** Chooses the format to transcode Basis Universal data to.
+        @remarks
+            In order of preference: ASTC 4x4, BC7, BC3 (BC1 if there's no alpha),
+            ETC2 RGBA8 (ETC2 RGB8 if there's no alpha), ETC1 (no alpha only)
+            and finally uncompressed RGBA8.
+        @param caps
+            Capabilities of the RenderSystem. Can be null, in which case RGBA8 is returned.
+        */
+        static PixelFormatGpu chooseTranscodeTarget( const RenderSystemCapabilities *caps,
+                                                     bool hasAlpha, bool isSrgb );
+
+        /// Static method to startup and register the KTX2 codec
+        static void startup(void);
+        /// Static method to shutdown and unregister the KTX2 codec
+        static void shutdown(void);
+    };
+    /** @} */
+    /** @} */
+
+} // namespace
+
+#endif
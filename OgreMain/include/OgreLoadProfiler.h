@@ -0,0 +1,174 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreLoadProfiler_H_
+#define _OgreLoadProfiler_H_
+
+#include "OgrePrerequisites.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup General
+    *  @{
+    */
+
+    namespace LoadEvent
+    {
+        enum LoadEvent
+        {
+            /// Reading a whole file from an Archive into memory
+            ArchiveRead,
+            /// Decoding an image (and generating its mipmaps in software, if requested)
+            TextureDecode,
+            /// Deserialising a v1 or v2 mesh
+            MeshLoad,
+            /// Generating & compiling the shaders of a new Hlms permutation
+            ShaderCompile,
+            /// Creating the PSO of a new Hlms permutation (after its shaders were compiled)
+            PsoCreation,
+            /// Main thread blocked waiting on texture streaming
+            StreamingWait,
+            NumLoadEvents
+        };
+    }
+
+    /** Records every resource load (archive reads, texture decodes, mesh deserialisation,
+        shader compiles, PSO creation and waits on texture streaming) so that it is
+        possible to tell where loading time went. Disabled by default.
+    @remarks
+        It doesn't depend on OGRE_PROFILING; the cost while disabled is a branch per
+        recorded event.
+    @par
+        Typical usage:
+        @code
+            LoadProfiler *loadProfiler = Root::getSingleton().getLoadProfiler();
+            loadProfiler->setEnabled( true );
+            //Load the level
+            String report;
+            loadProfiler->generateReport( report );
+            loadProfiler->setEnabled( false );
+        @endcode
+    */
+    class _OgreExport LoadProfiler : public ProfilerAlloc
+    {
+    public:
+        struct Event
+        {
+            LoadEvent::LoadEvent    type;
+            /// Whether it happened on the thread that created the LoadProfiler (i.e. Root's)
+            bool                    mainThread;
+            String                  name;
+            uint64                  bytes;
+            /// In microseconds, since the LoadProfiler was created
+            uint64                  usStart;
+            uint64                  usTaken;
+        };
+        typedef vector<Event>::type EventVec;
+
+        /// Records an event from construction until destruction, if the LoadProfiler
+        /// was enabled at construction time.
+        class _OgreExport Scope
+        {
+            LoadProfiler        *mLoadProfiler;
+            LoadEvent::LoadEvent mType;
+            String              mName;
+            uint64              mBytes;
+            uint64              mUsStart;
+
+        public:
+            Scope( LoadEvent::LoadEvent type, const String &name );
+            ~Scope();
+
+            /// Use it to avoid building expensive names that won't be used.
+            bool isRecording(void) const                { return mLoadProfiler != 0; }
+
+            void setName( const String &name )          { mName = name; }
+            void setBytes( uint64 bytes )               { mBytes = bytes; }
+        };
+
+    protected:
+        bool                mEnabled;
+        Timer               *mTimer;
+        TlsHandle           mTlsHandle;
+
+        LightweightMutex    mMutex;
+        EventVec            mEvents;
+
+    public:
+        LoadProfiler();
+        ~LoadProfiler();
+
+        /// Events are only recorded while enabled. Disabling doesn't discard
+        /// the events already recorded; see reset.
+        void setEnabled( bool bEnabled );
+        bool getEnabled(void) const                     { return mEnabled; }
+
+        /// Discards all recorded events.
+        void reset(void);
+
+        uint64 getMicroseconds(void) const;
+
+        /// Adds an event. Thread safe. Usually called by Scope.
+        void addEvent( LoadEvent::LoadEvent type, const String &name, uint64 bytes,
+                       uint64 usStart, uint64 usTaken );
+
+        /// Returns a copy of the recorded events. Thread safe.
+        void getEvents( EventVec &outEvents );
+
+        /** Writes a human-readable report with:
+            1. The totals per type of event (time, count, bytes) on the main and on the
+               other threads.
+            2. The worst offenders: the longest events, sorted by time.
+            3. The critical path: the top level events of the main thread in chronological
+               order; i.e. what the main thread was doing (or waiting for) while loading.
+        @param maxEntries
+            Maximum number of entries in the worst offenders & critical path sections.
+        */
+        void generateReport( String &outReport, size_t maxEntries = 20u );
+
+        /// generateReport, sent to the log.
+        void logReport( size_t maxEntries = 20u );
+
+        static const char* getEventName( LoadEvent::LoadEvent type );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
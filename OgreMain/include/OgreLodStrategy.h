@@ -56,6 +56,8 @@ namespace Ogre {
         /** Name of this strategy. */
         String mName;
 
+        static uint32 msLodValuesGeneration;
+
         /** Compute the LOD value for a given movable object relative to a given camera. */
         virtual Real getValueImpl(const MovableObject *movableObject, const Camera *camera) const = 0;
 
@@ -75,8 +77,18 @@ namespace Ogre {
         virtual void lodUpdateImpl( const size_t numNodes, ObjectData t,
                                     const Camera *camera, Real bias ) const = 0;
 
-        //Include OgreLodStrategyPrivate.inl in the CPP files that use this function.
-        inline static void lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        /** Sets the mesh & material LODs of the 4 objects in the pack according to lodValue.
+            Objects whose LOD value is still in ObjectData::mLodRangeMin/Max are skipped.
+            Include OgreLodStrategyPrivate.inl in the CPP files that use this function.
+        */
+        inline static void lodSet( ObjectData &t, ArrayReal lodValue );
+
+        /** Must be called when LOD values shared by many objects (i.e. Mesh or
+            Material LOD values) change, or a Renderable's material is changed.
+            Forces every object's LODs to be evaluated again. @see ObjectData::mLodRangeMin
+        */
+        static void _notifyLodValuesChanged(void)                   { ++msLodValuesGeneration; }
+        static uint32 _getLodValuesGeneration(void)                 { return msLodValuesGeneration; }
 
         /** Transform user supplied value to internal value.
         @remarks
@@ -26,21 +26,53 @@ THE SOFTWARE.
 -----------------------------------------------------------------------------
 */
 
+#include "Math/Array/OgreBooleanMask.h"
+
 namespace Ogre
 {
-    inline void LodStrategy::lodSet( ObjectData &objData, Real lodValues[ARRAY_PACKED_REALS] )
+    inline void LodStrategy::lodSet( ObjectData &objData, ArrayReal lodValue )
     {
+        ArrayReal * RESTRICT_ALIAS lodRangeMin = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                    (objData.mLodRangeMin);
+        ArrayReal * RESTRICT_ALIAS lodRangeMax = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                    (objData.mLodRangeMax);
+
+        //Objects whose LOD value didn't leave the range in which their LODs stay the same
+        //are skipped without touching them (nor their Renderables). Usually that's most of them.
+        const uint32 inRange = BooleanMask4::getScalarMask(
+                    Mathlib::And( Mathlib::CompareGreater( lodValue, *lodRangeMin ),
+                                  Mathlib::CompareLessEqual( lodValue, *lodRangeMax ) ) );
+
+        if( inRange == (1u << ARRAY_PACKED_REALS) - 1u )
+            return;
+
+        OGRE_ALIGNED_DECL( Real, lodValues[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+        CastArrayToReal( lodValues, lodValue );
+
         for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
         {
+            if( IS_BIT_SET( j, inRange ) )
+                continue;
+
             MovableObject *owner = objData.mOwner[j];
 
+            //Intersection of the ranges of all the LOD values we look up
+            Real rangeMin = -std::numeric_limits<Real>::infinity();
+            Real rangeMax = std::numeric_limits<Real>::infinity();
+
             //This may look like a lot of ugly indirections, but mLodMerged is a pointer that allows
             //sharing with many MovableObjects (it should perfectly fit even in small caches).
             {
-                FastArray<Real>::const_iterator it = std::lower_bound( owner->mLodMesh->begin(),
-                                                                        owner->mLodMesh->end(),
-                                                                        lodValues[j] );
-                owner->mCurrentMeshLod = std::max<int>( it - owner->mLodMesh->begin() - 1, 0 );
+                const FastArray<Real> *lodVec = owner->mLodMesh;
+                FastArray<Real>::const_iterator it = std::lower_bound( lodVec->begin(),
+                                                                       lodVec->end(),
+                                                                       lodValues[j] );
+                owner->mCurrentMeshLod = std::max<int>( it - lodVec->begin() - 1, 0 );
+
+                if( it != lodVec->begin() )
+                    rangeMin = std::max( rangeMin, *(it - 1) );
+                if( it != lodVec->end() )
+                    rangeMax = std::min( rangeMax, *it );
             }
 
             RenderableArray::iterator itor = owner->mRenderables.begin();
@@ -52,8 +84,16 @@ namespace Ogre
                 FastArray<Real>::const_iterator it = std::lower_bound( lodVec->begin(), lodVec->end(),
                                                                        lodValues[j] );
                 (*itor)->mCurrentMaterialLod = (uint8)std::max<int>( it - lodVec->begin() - 1, 0 );
+
+                if( it != lodVec->begin() )
+                    rangeMin = std::max( rangeMin, *(it - 1) );
+                if( it != lodVec->end() )
+                    rangeMax = std::min( rangeMax, *it );
                 ++itor;
             }
+
+            objData.mLodRangeMin[j] = rangeMin;
+            objData.mLodRangeMax[j] = rangeMax;
         }
     }
 }
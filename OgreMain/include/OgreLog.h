@@ -35,6 +35,7 @@ THE SOFTWARE.
 
 #include "ogrestd/vector.h"
 #include <iosfwd>
+#include <ctime>
 
 #include "OgreHeaderPrefix.h"
 
@@ -116,6 +117,16 @@ namespace Ogre {
 
         typedef vector<LogListener*>::type mtLogListener;
         mtLogListener mListeners;
+
+        struct AsyncWriter;
+        /// Null unless setAsync( true ) was called. Protected by mAsyncMutex
+        AsyncWriter     *mAsyncWriter;
+        /// Protects mAsyncWriter and its queue. Never held while writing
+        LightweightMutex mAsyncMutex;
+
+        /// Writes to debug output & file. mMutex must be held.
+        void writeMessage( const String &message, LogMessageLevel lml, bool maskDebug,
+                           time_t ctTime, bool flush );
     public:
 
         class Stream;
@@ -185,6 +196,30 @@ namespace Ogre {
         */
         void removeListener(LogListener* listener);
 
+        /** Enables or disables asynchronous logging.
+        @remarks
+            When enabled, logMessage only queues the message (which is a short lock and a
+            copy of the string) and a background thread calls the listeners, writes to the
+            debug output and to the file; flushing the file once per batch instead of once
+            per message. Thus listeners get called from the background thread.
+        @par
+            Disabling it (or destroying the Log) waits until all queued messages are written.
+        @par
+            Other threads may keep logging while this is called, but don't call it from
+            more than one thread at the same time. Not available on platforms without threads, where it is ignored.
+        @param bAsync
+        @param maxQueuedBytes
+            When the queued messages add up to more than this, new non-critical messages
+            are dropped until the writer catches up. The number of dropped messages gets
+            logged. LML_CRITICAL messages are never dropped.
+            0 for no limit.
+        */
+        void setAsync( bool bAsync, size_t maxQueuedBytes = 4u * 1024u * 1024u );
+        bool isAsync(void) const { return mAsyncWriter != 0; }
+
+        /// For internal use. Runs the background writer until setAsync( false ) is called
+        void _asyncWriterThread(void);
+
         /** Stream object which targets a log.
         @remarks
             A stream logger object makes it simpler to send various things to 
@@ -85,19 +85,67 @@ namespace Ogre
         virtual_l1 void begin(const String& datablockName,
                            OperationType opType = OT_TRIANGLE_LIST);
 
+        /** Start defining a part of the object, with a known vertex layout.
+        @remarks
+            Same as the other overload, but the vertex layout is given upfront instead of
+            being deduced from the calls made for the first vertex. This is required to
+            use vertices() or writeVertices() before any call to position().
+        @param datablockName The name of the datablock to render this part of the
+            object with.
+        @param vertexElements Layout of the vertices. Must contain a VES_POSITION
+            element of type VET_FLOAT3.
+        @param opType The type of operation to use to render.
+        */
+        virtual_l1 void begin(const String& datablockName, const VertexElement2Vec &vertexElements,
+                           OperationType opType = OT_TRIANGLE_LIST);
+
         /** Start the definition of an update to a part of the object.
         @remarks
             Using this method, you can update an existing section of the object
             efficiently. You do not have the option of changing the operation type
             obviously, since it must match the one that was used before. 
-        @note Changing size of the sections is not supported, you are expected to
-            supply the same amount of data with the same layout when updating.
-            If you want to change the data layout, call clear() and create
-            new sections with begin().
+        @note The layout can't be changed, you are expected to supply data with the
+            same layout when updating. Less data than the section was created with can
+            be supplied (only what was written gets drawn); to supply more see the
+            other overload. If you want to change the data layout, call clear() and
+            create new sections with begin().
         @param sectionIndex The index of the section you want to update. The first
             call to begin() would have created section 0, the second section 1, etc.
         */
         virtual_l1 void beginUpdate(size_t sectionIndex);
+
+        /** Start the definition of an update to a part of the object, which may change
+            its number of vertices and indices.
+        @remarks
+            The section's buffers are reused as long as they're big enough; otherwise
+            they're recreated (with some room to grow) before being written to.
+            Only the vertices and indices written before end() are drawn.
+        @par
+            The index buffer is only mapped once the first index is written. If no
+            indices are written, the ones from the last update (and their count) are kept.
+        @param sectionIndex The index of the section you want to update.
+        @param numVertices Maximum number of vertices that will be written.
+        @param numIndices Maximum number of indices that will be written.
+        */
+        virtual_l1 void beginUpdate(size_t sectionIndex, size_t numVertices, size_t numIndices);
+
+        /** Non-blocking version of beginUpdate.
+        @remarks
+            The section's buffers are dynamic, thus updating them waits for the GPU to be
+            done with the frame that last used the same region, which may stall when the
+            GPU falls behind. This version doesn't start the update if it would stall,
+            so that the section keeps rendering its previous contents instead.
+        @par
+            Buffers can only be updated once per frame.
+        @param numVertices Maximum number of vertices that will be written.
+            0 to keep the section's current size.
+        @param numIndices Maximum number of indices that will be written.
+            0 to keep the section's current size.
+        @return
+            True if the update started and end() must be called. False if it would stall.
+        */
+        virtual_l1 bool tryBeginUpdate(size_t sectionIndex, size_t numVertices = 0,
+                                    size_t numIndices = 0);
         /** Add a vertex position, starting a new vertex at the same time. 
         @remarks A vertex position is slightly special among the other vertex data
             methods like normal() and textureCoord(), since calling it indicates
@@ -209,6 +257,36 @@ namespace Ogre
         */
         virtual_l1 void quad(uint32 i1, uint32 i2, uint32 i3, uint32 i4);
 
+        /** Adds many vertices at once, copied from a prebuilt interleaved array.
+        @remarks
+            The layout of the data must match the section's: either the vertex elements
+            passed to begin(), or the one deduced from the first vertex.
+            The bounds are grown to contain the copied positions.
+        @param data Interleaved vertices.
+        @param numVertices Number of vertices in data.
+        */
+        virtual_l1 void vertices(const void *data, size_t numVertices);
+
+        /** Reserves space for many vertices at once and returns a pointer to write them.
+        @remarks
+            Same layout requirements as vertices(). The pointer is only valid until the
+            next call to this object. When updating a section it points directly to GPU
+            memory, which must be written sequentially and never read from.
+        @param numVertices Number of vertices that will be written.
+        @param bounds Bounds of the vertices that will be written. The positions
+            aren't read back to calculate them.
+        */
+        virtual_l1 void* writeVertices(size_t numVertices, const Aabb &bounds);
+
+        /** Adds many indices at once.
+        @note
+            Indices above 65535 in a section that was created with 16-bit indices
+            are not supported when updating.
+        */
+        virtual_l1 void indices(const uint32 *data, size_t numIndices);
+        /// @copydoc ManualObject::indices(const uint32*,size_t)
+        virtual_l1 void indices(const uint16 *data, size_t numIndices);
+
         /// Get the number of vertices in the section currently being defined (returns 0 if no section is in progress).
         virtual_l1 size_t getCurrentVertexCount() const;
 
@@ -300,6 +378,8 @@ namespace Ogre
             Ogre::String mDatablockName;
 
             void clear();
+            /// Creates mVao and its buffers. The previous ones must be destroyed with clear()
+            void createBuffers(size_t numVertices, size_t numIndices);
 
         public:
             friend class ManualObject;
@@ -338,6 +418,11 @@ namespace Ogre
 
         /// Are we updating?
         bool mCurrentUpdating;
+        /// Is the vertex layout already known? (i.e. updating, or given to begin())
+        bool mDeclarationFixed;
+        /// Capacity of the buffers being updated
+        size_t mMaxUpdateVertices;
+        size_t mMaxUpdateIndices;
         String mCurrentDatablockName;
 
         size_t mVertices;
@@ -368,6 +453,15 @@ namespace Ogre
         void resizeVertexBufferIfNeeded(size_t numVerts);
         /// Resize the temp index buffer?
         void resizeIndexBufferIfNeeded(size_t numInds);
+        /// Common part of both beginUpdate overloads & tryBeginUpdate.
+        bool beginUpdateImpl(size_t sectionIndex, size_t numVertices, size_t numIndices,
+                             bool nonBlocking, const char *funcName);
+        /// Maps the index buffer of the section being updated
+        void mapIndexBufferForUpdate(void);
+        /// Moves the vertex cursor numVertices ahead; returns where the vertices must be written
+        float* advanceVertexCursor(size_t numVertices, const char *funcName);
+        /// Moves the index cursor numIndices ahead; returns where the indices must be written
+        char* advanceIndexCursor(size_t numIndices, const char *funcName);
     };
 
 
@@ -253,6 +253,17 @@ namespace Ogre
     template <MemoryCategory Cat, size_t align = 0> class CategorisedAlignAllocPolicy : public TrackAlignedAllocPolicy<align>{};
 }
 
+#elif OGRE_MEMORY_ALLOCATOR == OGRE_MEMORY_ALLOCATOR_THREADPOOL
+
+#  include "OgreMemoryThreadPool.h"
+namespace Ogre
+{
+    // Each category gets its own statistics. Use OGRE_THREADPOOL_ALLOC_CATEGORIES
+    // to choose which categories are pooled.
+    template <MemoryCategory Cat> class CategorisedAllocPolicy : public ThreadPoolAllocPolicy<Cat>{};
+    template <MemoryCategory Cat, size_t align = 0> class CategorisedAlignAllocPolicy : public ThreadPoolAlignedAllocPolicy<Cat, align>{};
+}
+
 #else
     
 // your allocators here?
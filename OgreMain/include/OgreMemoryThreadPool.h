@@ -0,0 +1,202 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreMemoryThreadPool_H_
+#define _OgreMemoryThreadPool_H_
+
+#if OGRE_MEMORY_ALLOCATOR == OGRE_MEMORY_ALLOCATOR_THREADPOOL
+
+#include <limits>
+
+#include "OgreAlignedAllocator.h"
+#include "OgreHeaderPrefix.h"
+
+/** Bitmask of the MemoryCategory values (1u << MEMCATEGORY_xxx) served by the thread
+    pools. The remaining categories go straight to the system allocator and don't show
+    up in the statistics.
+*/
+#ifndef OGRE_THREADPOOL_ALLOC_CATEGORIES
+#   define OGRE_THREADPOOL_ALLOC_CATEGORIES 0xFFFFFFFFu
+#endif
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Memory
+    *  @{
+    */
+
+    struct ThreadPoolAllocStats
+    {
+        /// Bytes currently allocated (requests are rounded up to its size class)
+        size_t  liveBytes;
+        /// Total number of allocations since startup. Sample it once per frame and
+        /// take the difference to get the allocation rate.
+        uint64  numAllocations;
+        /// Total number of deallocations since startup
+        uint64  numDeallocations;
+        /// Total bytes allocated since startup
+        uint64  bytesAllocated;
+    };
+
+    /** Non-templated implementation of ThreadPoolAllocPolicy.
+    @remarks
+        Every thread owns a cache with one free list per size class, so allocating and
+        freeing from the same thread never takes a lock. Memory freed by a thread other
+        than the one that allocated it is pushed into the owner's cross-thread free list
+        (the only lock, which is per thread), and the owner claims it back once its local
+        free list runs dry. Requests bigger than the largest size class go to the system
+        allocator.
+    @par
+        Pools are never returned to the system. When a thread exits, its cache (along with
+        its pools) is handed over to the next thread that allocates, as long as the exiting
+        thread calls releaseThreadCache. Threads created with THREAD_DECLARE do it
+        automatically.
+    */
+    class _OgreExport ThreadPoolAllocImpl
+    {
+    public:
+        static DECL_MALLOC void* allocBytes( size_t count, MemoryCategory category );
+        static void deallocBytes( void *ptr );
+        static DECL_MALLOC void* allocBytesAligned( size_t align, size_t count,
+                                                    MemoryCategory category );
+        static void deallocBytesAligned( size_t align, void *ptr );
+
+        /** Gives the cache of the calling thread to the next thread that needs one.
+            Call it right before a thread exits, and don't allocate from it afterwards.
+            Otherwise the cache of a thread that exited is never reused.
+        @remarks
+            Allocating again from the same thread is safe, but takes over a cache again.
+        */
+        static void releaseThreadCache(void);
+
+        /** Retrieves the statistics of a category, added up from all threads.
+        @remarks
+            Reads the counters of other threads without synchronization. The values
+            are good enough for profiling, but may be off by the allocations that are
+            happening at the same time.
+        */
+        static void getStats( MemoryCategory category, ThreadPoolAllocStats &outStats );
+
+        /// Total memory reserved from the system for the pools of all threads.
+        static size_t getReservedBytes(void);
+    };
+
+    /** An allocation policy for use with AllocatedObject and STLAllocator that serves
+        each MemoryCategory from per-thread size class pools. @see ThreadPoolAllocImpl
+    @par
+        Categories not included in OGRE_THREADPOOL_ALLOC_CATEGORIES use the system allocator.
+    */
+    template <MemoryCategory Cat>
+    class ThreadPoolAllocPolicy
+    {
+    public:
+        static inline DECL_MALLOC void* allocateBytes( size_t count,
+                                                       const char* = 0, int = 0, const char* = 0 )
+        {
+            if( (OGRE_THREADPOOL_ALLOC_CATEGORIES >> Cat) & 1u )
+                return ThreadPoolAllocImpl::allocBytes( count, Cat );
+            else
+                return AlignedMemory::allocate( count );
+        }
+
+        static inline void deallocateBytes( void *ptr )
+        {
+            if( (OGRE_THREADPOOL_ALLOC_CATEGORIES >> Cat) & 1u )
+                ThreadPoolAllocImpl::deallocBytes( ptr );
+            else
+                AlignedMemory::deallocate( ptr );
+        }
+
+        /// Get the maximum size of a single allocation
+        static inline size_t getMaxAllocationSize()
+        {
+            return std::numeric_limits<size_t>::max();
+        }
+
+    private:
+        // No instantiation
+        ThreadPoolAllocPolicy()
+        { }
+    };
+
+    /** Aligned version of ThreadPoolAllocPolicy.
+    @note
+        template parameter Alignment equal to zero means use default
+        platform dependent alignment.
+    */
+    template <MemoryCategory Cat, size_t Alignment = 0>
+    class ThreadPoolAlignedAllocPolicy
+    {
+    public:
+        // compile-time check alignment is available.
+        typedef int IsValidAlignment
+            [Alignment <= 128 && ((Alignment & (Alignment-1)) == 0) ? +1 : -1];
+
+        static inline DECL_MALLOC void* allocateBytes( size_t count,
+                                                       const char* = 0, int = 0, const char* = 0 )
+        {
+            if( (OGRE_THREADPOOL_ALLOC_CATEGORIES >> Cat) & 1u )
+                return ThreadPoolAllocImpl::allocBytesAligned( Alignment, count, Cat );
+            else
+                return Alignment ? AlignedMemory::allocate( count, Alignment ) :
+                                   AlignedMemory::allocate( count );
+        }
+
+        static inline void deallocateBytes( void *ptr )
+        {
+            if( (OGRE_THREADPOOL_ALLOC_CATEGORIES >> Cat) & 1u )
+                ThreadPoolAllocImpl::deallocBytesAligned( Alignment, ptr );
+            else
+                AlignedMemory::deallocate( ptr );
+        }
+
+        /// Get the maximum size of a single allocation
+        static inline size_t getMaxAllocationSize()
+        {
+            return std::numeric_limits<size_t>::max();
+        }
+
+    private:
+        // No instantiation
+        ThreadPoolAlignedAllocPolicy()
+        { }
+    };
+
+    /** @} */
+    /** @} */
+
+}// namespace Ogre
+
+#include "OgreHeaderSuffix.h"
+
+#endif
+
+#endif
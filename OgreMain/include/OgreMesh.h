@@ -855,11 +855,15 @@ namespace v1 {
             as a hint for optimisation.
         @param blendNormals
             If @c true, normals are blended as well as positions.
+        @param sceneManager
+            Optional. When present and the vertex count is large enough, the vertices
+            are split across the SceneManager's worker threads.
+            Must be called from the main thread.
         */
         static void softwareVertexBlend(const VertexData* sourceVertexData, 
             const VertexData* targetVertexData,
             const Matrix4* const* blendMatrices, size_t numMatrices,
-            bool blendNormals);
+            bool blendNormals, SceneManager *sceneManager = 0);
 
         /** Performs a software vertex morph, of the kind used for
             morph animation although it can be used for other purposes. 
@@ -905,6 +909,16 @@ namespace v1 {
             const map<size_t, Vector3>::type& vertexOffsetMap,
             const map<size_t, Vector3>::type& normalsMap,
             VertexData* targetVertexData);
+
+        /** Same as the other overload, but applies several poses at once while locking
+            the destination buffer only once (rather than once per pose).
+        @param poses
+            Array of numPoses poses.
+        @param weights
+            Array of numPoses weights, one per pose. Poses with weight 0 are skipped.
+        */
+        static void softwareVertexPoseBlend(const Pose* const* poses, const Real *weights,
+            size_t numPoses, VertexData* targetVertexData);
         /** Gets a reference to the optional name assignments of the SubMeshes. */
         const SubMeshNameMap& getSubMeshNameMap(void) const { return mSubMeshNameMap; }
 
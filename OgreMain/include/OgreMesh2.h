@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreResource.h"
 #include "Math/Simple/OgreAabb.h"
 #include "Vao/OgreBufferPacked.h"
+#include "OgreSubMesh2.h"
 
 #include "OgreVertexBoneAssignment.h"
 #include "OgreDataStream.h"
@@ -332,6 +333,10 @@ namespace Ogre {
         */
         void _notifySkeleton( v1::SkeletonPtr& pSkel );
 
+        /// Internal use by MeshManager::loadAsync. Provides the file contents that
+        /// prepareImpl would otherwise read. Must be called while unloaded.
+        void _setFreshFromDisk( const DataStreamPtr &data )         { mFreshFromDisk = data; }
+
 
         void setLodStrategyName( const String &name )               { mLodStrategyName = name; }
 
@@ -435,19 +440,41 @@ namespace Ogre {
             True if you want the pose buffer to have pixel format PF_FLOAT16_RGBA
             which uses significantly less memory. Otherwise it is created with pixel
             format PF_FLOAT32_RGBA. Rarely the extra precision is needed.
+        @param arranged
+            Optional. Array of getNumSubMeshes() * NumVertexPass entries with the vertex
+            data already arranged. See SubMesh::importFromV1.
         */
-        void importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents, bool halfPose = true );
+        void importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                       bool halfPose = true, SubMesh::ArrangedVertexData *arranged = 0 );
+
+        /// Loads the v1 mesh and performs the modifications importV1 needs on it
+        /// (unsharing vertices, building tangents). Must be called from the main thread.
+        static void _prepareV1ForImport( v1::Mesh *mesh, bool qTangents );
 
         /// Converts this SubMesh to an efficient arrangement. @See Mesh::importV1 for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
-        /// to perform the opposite operation.
-        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
+        /// to perform the opposite operation. @see SubMesh::arrangeEfficient for unormTexCoords.
+        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                               bool unormTexCoords = false );
 
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
         /// which are more compatible for doing certain operations vertex operations in the CPU.
         void dearrangeToInefficient(void);
 
+        /// Reorders the triangles & vertices of every SubMesh for faster
+        /// rendering. @see SubMesh::optimise
+        void optimise( bool vertexCache = true, bool overdraw = true, bool vertexFetch = true );
+
+        /// Builds the meshlets of every SubMesh. @see SubMesh::buildMeshlets
+        void buildMeshlets( uint32 maxVertices = 64u, uint32 maxTriangles = 124u );
+
+        /// Calculates the bounds of every SubMesh. @see SubMesh::computeAabb
+        void computeSubMeshAabbs(void);
+
+        /// Returns true if every SubMesh has its bounds. @see SubMesh::computeAabb
+        bool hasSubMeshAabbs(void) const;
+
         /// When this bool is false, prepareForShadowMapping will use the same Vaos for
         /// both regular and shadow mapping rendering. When it's true, it will
         /// calculate an optimized version to speed up shadow map rendering (uses a bit
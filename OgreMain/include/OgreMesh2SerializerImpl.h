@@ -98,6 +98,10 @@ namespace Ogre {
             uint32                  numIndices;
             void                    *indexData;
             OperationType operationType;
+            /// vertexBuffers / indexData point into the stream's data view
+            /// (see mVertexDataView) and must not be freed
+            bool                    vertexDataInView;
+            bool                    indexDataInView;
 
             SubMeshLod();
         };
@@ -115,6 +119,8 @@ namespace Ogre {
         virtual void writeSkeletonLink(const String& skelName);
 
         virtual void writeBoundsInfo(const Mesh* pMesh);
+        virtual void writeSubMeshMeshlets(const SubMesh* s, uint16 subMeshIdx);
+        virtual void writeSubMeshBounds(const SubMesh* s, uint16 subMeshIdx);
         /*virtual void writeEdgeList(const Mesh* pMesh);
         virtual void writeAnimations(const Mesh* pMesh);
         virtual void writeAnimation(const Animation* anim);
@@ -146,6 +152,8 @@ namespace Ogre {
         virtual size_t calcPoseKeyframePoseRefSize(void);
         virtual size_t calcPoseVertexSize(const Pose* pose);*/
         virtual size_t calcBoundsInfoSize(const Mesh* pMesh);
+        virtual size_t calcSubMeshMeshletsSize(const SubMesh* s);
+        virtual size_t calcSubMeshBoundsSize(void);
 
         virtual void readTextureLayer(DataStreamPtr& stream, Mesh* pMesh, MaterialPtr& pMat);
         virtual void readSubMeshNameTable(DataStreamPtr& stream, Mesh* pMesh);
@@ -165,6 +173,8 @@ namespace Ogre {
 
         virtual void readSkeletonLink(DataStreamPtr& stream, Mesh* pMesh, MeshSerializerListener *listener);
         virtual void readBoundsInfo(DataStreamPtr& stream, Mesh* pMesh);
+        virtual void readSubMeshMeshlets(DataStreamPtr& stream, Mesh* pMesh);
+        virtual void readSubMeshBounds(DataStreamPtr& stream, Mesh* pMesh);
         /*virtual void readEdgeList(DataStreamPtr& stream, Mesh* pMesh);
         virtual void readEdgeListLodInfo(DataStreamPtr& stream, EdgeData* edgeData);
         virtual void readPoses(DataStreamPtr& stream, Mesh* pMesh);
@@ -191,11 +201,37 @@ namespace Ogre {
                          size_t vertexSize, size_t baseOffset,
                          const VertexElementType elementType );
         
+        /// Buffers in R3+ files are surrounded by padding so that their contents start at
+        /// an offset multiple of 16. Writes the padding before and returns its size.
+        uint8 writeBufferPaddingStart(void);
+        void writeBufferPaddingEnd( uint8 paddingStart );
+        uint8 readBufferPaddingStart( DataStreamPtr &stream );
+        void readBufferPaddingEnd( DataStreamPtr &stream, uint8 paddingStart );
+
+        /// Returns a pointer to the next sizeBytes of the stream, and skips them.
+        /// dataView must be mVertexDataView or mIndexDataView; returns null when it's null.
+        uint8* getBufferFromView( DataStreamPtr &stream, const uint8 *dataView, size_t sizeBytes );
+
         /// This function can be overloaded to disable validation in debug builds.
         virtual void enableValidation();
 
         ushort exportedLodCount; // Needed to limit exported Edge data, when exporting
         VaoManager *mVaoManager;
+
+        /// False for versions older than R3
+        bool mAlignedBuffers;
+        /// While importing, the stream's DataStream::getDataView when buffers can be
+        /// handed to the VaoManager straight from it (aligned, native endian and not
+        /// shadowed, since shadow copies are owned by the buffer). Null otherwise.
+        const uint8 *mVertexDataView;
+        const uint8 *mIndexDataView;
+    };
+
+    class _OgrePrivate MeshSerializerImpl_v2_1_R2 : public MeshSerializerImpl
+    {
+    public:
+        MeshSerializerImpl_v2_1_R2( VaoManager *vaoManager );
+        virtual ~MeshSerializerImpl_v2_1_R2();
     };
 
     class _OgrePrivate MeshSerializerImpl_v2_1_R1 : public MeshSerializerImpl
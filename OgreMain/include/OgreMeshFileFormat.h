@@ -80,9 +80,11 @@ namespace Ogre {
                     M_SUBMESH_INDEX_BUFFFER = 0x4320,
                         // unsigned int indexCount
                         // bool indexes32Bit (only if indexCount > 0)
+                        // [R3+] uint8 paddingBefore; paddingBefore bytes (only if indexCount > 0)
                         // unsigned int* faceVertexIndices (indexCount)
                         // OR
                         // unsigned short* faceVertexIndices (indexCount)
+                        // [R3+] 15 - paddingBefore bytes (only if indexCount > 0)
                     M_SUBMESH_M_GEOMETRY = 0x4330,
                         // unsigned int vertexCount
                         // uint8 numSources;    //Number of vertex buffers.
@@ -94,7 +96,10 @@ namespace Ogre {
                         M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER = 0x4332, // Repeating section
                             // uint8 bindIndex;    // Index to bind this buffer to
                             // uint8 vertexSize;   // Per-vertex size, must agree with declaration at this index
+                            // [R3+] uint8 paddingBefore; paddingBefore bytes
                             // raw buffer data
+                            // [R3+] 15 - paddingBefore bytes
+                            // (The padding puts raw data at a 16 byte aligned offset of the file)
                     M_SUBMESH_M_GEOMETRY_EXTERNAL_SOURCE = 0x4340,
                         // This section is mutually exclusive w/ M_SUBMESH_M_GEOMETRY
                         // uint8 lodSource; //Get this vertex buffer from a LOD different source.
@@ -335,6 +340,22 @@ namespace Ogre {
             // unsigned short submesh_index;
             // float extremes [n_extremes][3];
 
+            // Optional, one per SubMesh that has meshlets. Added in v2.1 R3
+            M_SUBMESH_MESHLETS = 0xF000,
+                // uint16 subMeshIndex
+                // uint32 numMeshlets
+                // Repeated numMeshlets times:
+                    // uint32 indexStart
+                    // uint32 indexCount
+                    // float centerX, centerY, centerZ, radius
+                    // float coneAxisX, coneAxisY, coneAxisZ, coneCutoff
+
+            // Optional, one per SubMesh that has bounds. Added in v2.1 R3
+            M_SUBMESH_BOUNDS = 0xF100,
+                // uint16 subMeshIndex
+                // float centerX, centerY, centerZ
+                // float halfSizeX, halfSizeY, halfSizeZ
+
     /* Version 1.2 of the .mesh format (deprecated)
     enum MeshChunkID {
         M_HEADER                = 0x1000,
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "OgreSingleton.h"
 #include "OgreVector3.h"
 #include "Vao/OgreBufferPacked.h"
+#include "OgreAsyncArchiveReader.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre
@@ -54,7 +55,45 @@ namespace Ogre
     class _OgreExport MeshManager: public ResourceManager, public Singleton<MeshManager>, 
         public ManualResourceLoader
     {
+    public:
+        /// See loadAsync
+        class _OgreExport AsyncLoadListener
+        {
+        public:
+            virtual ~AsyncLoadListener() {}
+            /// Called from the main thread (see _updateAsyncLoads) once the mesh is
+            /// loaded, or once it failed to load (in which case mesh->isLoaded() is false).
+            virtual void meshLoaded( const MeshPtr &mesh ) = 0;
+        };
+
     protected:
+        typedef vector<AsyncLoadListener*>::type AsyncLoadListenerVec;
+
+        struct AsyncLoad : public AsyncArchiveReader::Listener
+        {
+            MeshManager         *manager;
+            MeshPtr             mesh;
+            AsyncLoadListenerVec listeners;
+            /// Written by the I/O thread, protected by MeshManager::mAsyncLoadsMutex
+            DataStreamPtr       data;
+            bool                readFinished;
+
+            virtual void readCompleted( AsyncArchiveReader::ReadRequest &request );
+        };
+
+        typedef vector<AsyncLoad*>::type AsyncLoadVec;
+
+        /// Sorted in the order loadAsync was called. Only accessed by main thread
+        AsyncLoadVec        mAsyncLoads;
+        LightweightMutex    mAsyncLoadsMutex;
+        AsyncArchiveReader  *mAsyncArchiveReader;
+        uint32              mNumAsyncLoadThreads;
+        uint64              mAsyncLoadTimeBudget;
+
+        /// Parses the mesh and creates its buffers (on the main thread), then fires
+        /// the listeners. Removes it from mAsyncLoads.
+        void finishAsyncLoad( AsyncLoad *asyncLoad );
+
         /// @copydoc ResourceManager::createImpl
         Resource* createImpl(const String& name, ResourceHandle handle,
             const String& group, bool isManual, ManualResourceLoader* loader,
@@ -159,6 +198,45 @@ namespace Ogre
                       BufferType indexBufferType = BT_IMMUTABLE,
                       bool vertexBufferShadowed = true, bool indexBufferShadowed = true );
 
+        /** Same as load, but returns immediately. The file is read by a background
+            thread; parsing it and creating its buffers is done later by the main thread
+            in _updateAsyncLoads (called by Root every frame), within a time budget (see
+            setAsyncLoadTimeBudget) so that loading lots of meshes doesn't stall it.
+        @remarks
+            The mesh is marked as background loaded until then, which means Mesh::load
+            does nothing. Items created from it stay empty (see Item::setPlaceholderMesh)
+            and are built once the mesh is ready.
+        @par
+            If the mesh is already loaded, the listener is called immediately.
+        @param listener
+            Optional. Called once the mesh is ready. Must outlive the load.
+        */
+        MeshPtr loadAsync( const String& filename, const String& groupName,
+                           AsyncLoadListener *listener = 0,
+                           BufferType vertexBufferType = BT_IMMUTABLE,
+                           BufferType indexBufferType = BT_IMMUTABLE,
+                           bool vertexBufferShadowed = true, bool indexBufferShadowed = true );
+
+        /** Finishes the loads started by loadAsync whose files have been read, until
+            getAsyncLoadTimeBudget is exhausted. Called by Root at the end of every frame.
+        @param waitForAll
+            When true, blocks until every pending load is done, ignoring the time budget.
+        */
+        void _updateAsyncLoads( bool waitForAll = false );
+
+        /// Number of loads started by loadAsync that haven't finished yet
+        size_t getNumPendingAsyncLoads(void) const      { return mAsyncLoads.size(); }
+
+        /// Time per frame (in microseconds) the main thread may spend in _updateAsyncLoads.
+        /// At least one mesh is loaded per frame regardless. Default is 4000.
+        void setAsyncLoadTimeBudget( uint64 microseconds )  { mAsyncLoadTimeBudget = microseconds; }
+        uint64 getAsyncLoadTimeBudget(void) const           { return mAsyncLoadTimeBudget; }
+
+        /// Number of threads reading files for loadAsync. Default is 2.
+        /// Must not be called while there are pending loads.
+        void setNumAsyncLoadThreads( uint32 numThreads );
+        uint32 getNumAsyncLoadThreads(void) const           { return mNumAsyncLoadThreads; }
+
 
         /** Creates a new Mesh specifically for manual definition rather
             than loading from an object file. 
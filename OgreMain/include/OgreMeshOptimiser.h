@@ -0,0 +1,110 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreMeshOptimiser_H_
+#define _OgreMeshOptimiser_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreVector3.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+    /** Reorders triangle lists (and the vertices they reference) to render faster.
+        All functions work on raw 32-bit index arrays; see SubMesh::optimise for
+        the version that works directly on Vaos.
+    @remarks
+        The usual order is optimiseVertexCache, then optimiseOverdraw, then
+        optimiseVertexFetch; since each pass preserves most of the gains
+        of the previous one.
+    */
+    class _OgreExport MeshOptimiser
+    {
+    public:
+        /** Reorders the triangles to maximize post-transform vertex cache hits,
+            using Tipsify (Sander, Nehab & Barczak, "Fast Triangle Reordering for
+            Vertex Locality and Reduced Overdraw", SIGGRAPH 2007).
+        @param indices [in/out]
+            Triangle list. numIndices must be a multiple of 3.
+        @param numVertices
+            Number of vertices in the vertex buffer. All indices must be lower than this.
+        @param cacheSize
+            Size of the FIFO cache to optimise for. 16 is a good fit for most GPUs.
+        */
+        static void optimiseVertexCache( uint32 *indices, size_t numIndices, size_t numVertices,
+                                         uint32 cacheSize = 16u );
+
+        /** Reorders clusters of triangles so that those facing outwards from the
+            center of the mesh get drawn first, occluding the rest and reducing overdraw.
+            Should be run after optimiseVertexCache, since it only moves whole clusters
+            around to keep most of the cache efficiency.
+        @param positions
+            Array with the position of each vertex.
+        @param threshold
+            How much the ACMR (average cache miss ratio) is allowed to degrade, i.e.
+            1.05 allows it to get up to 5% worse in exchange for less overdraw.
+            1.0 only splits clusters where the cache is flushed anyway.
+        */
+        static void optimiseOverdraw( uint32 *indices, size_t numIndices,
+                                      const Vector3 *positions, size_t numVertices,
+                                      Real threshold = 1.05f, uint32 cacheSize = 16u );
+
+        /** Calculates the vertex order that makes vertices be fetched sequentially,
+            and updates the indices to that order. The vertex buffer must then be
+            reordered by the caller using outOldToNew.
+        @remarks
+            Vertices that aren't referenced by the indices are placed at the end,
+            preserving their relative order; so that other index buffers referencing
+            them (e.g. LODs) are still valid after being remapped with outOldToNew.
+        @param outOldToNew [out]
+            outOldToNew[oldVertexIdx] = newVertexIdx. Resized to numVertices.
+        */
+        static void optimiseVertexFetch( uint32 *indices, size_t numIndices, size_t numVertices,
+                                         FastArray<uint32> &outOldToNew );
+
+        /// Returns the average number of vertex cache misses per triangle of
+        /// the given triangle list, simulating a FIFO cache. Lower is better;
+        /// 0.5 is the theoretical optimum for a regular grid, 3.0 the worst.
+        static Real calculateAcmr( const uint32 *indices, size_t numIndices, size_t numVertices,
+                                   uint32 cacheSize = 16u );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -93,14 +93,14 @@ namespace Ogre {
         //One for each submesh/Renderable
         FastArray<Real> const               *mLodMesh;
         unsigned char                       mCurrentMeshLod;
+        /// Local space Aabb of each entry in mRenderables (same order), used to cull them
+        /// individually once the whole object passed frustum culling. Null when not used.
+        FastArray<Aabb> const               *mRenderableAabbs;
+        /// See PortalZoneManager. 0xFFFF if it doesn't belong to any zone.
+        uint16                              mPortalZone;
 
         /// Minimum pixel size to still render
         Real mMinPixelSize;
-        /// User objects binding.
-        UserObjectBindings mUserObjectBindings;
-
-        /// MovableObject listener - only one allowed (no list) for size & performance reasons.
-        Listener* mListener;
 
         /// List of lights for this object
         LightList mLightList;
@@ -118,6 +118,23 @@ namespace Ogre {
         mutable bool mCachedAabbOutOfDate;
 #endif
 
+        //Rarely accessed members go last, away from the ones used every frame.
+
+        /// MovableObject listener - only one allowed (no list) for size & performance reasons.
+        Listener* mListener;
+
+        /// See _getPrevFrameParentNodeFullTransform. Allocated on first use.
+        struct PrevFrameTransform
+        {
+            Matrix4 prevFrame;
+            Matrix4 currentFrame;
+            uint32  lastFrame;
+        };
+        mutable PrevFrameTransform *mPrevFrameTransform;
+
+        /// User objects binding.
+        UserObjectBindings mUserObjectBindings;
+
         /// Friendly name of this object, can be empty
         String mName;
 
@@ -129,6 +146,11 @@ namespace Ogre {
         /// Default light mask
         static uint32 msDefaultLightMask;
 
+#if OGRE_COMPACT_OBJECT_HANDLES
+        /// Our handle in msCompactHandles. See OGRE_CONFIG_COMPACT_OBJECT_HANDLES
+        uint32 mCompactHandle;
+#endif
+
     protected:
         Aabb updateSingleWorldAabb();
         float updateSingleWorldRadius();
@@ -144,6 +166,12 @@ namespace Ogre {
         /// @copydoc mGlobalIndex
         size_t mParentIndex;
 
+#if OGRE_COMPACT_OBJECT_HANDLES
+        /// Resolves the handles in ObjectData::mOwner. See OGRE_CONFIG_COMPACT_OBJECT_HANDLES
+        static CompactObjectHandleTable msCompactHandles;
+        uint32 _getCompactHandle(void) const    { return mCompactHandle; }
+#endif
+
         /** Constructor
         @remarks
             Valid render queue Id is between 0 & 254 inclusive
@@ -210,6 +238,14 @@ namespace Ogre {
 
         unsigned char getCurrentMeshLod(void) const                         { return mCurrentMeshLod; }
 
+        /** Sets the zone this object is in. Objects whose zone is not visible from the
+            camera are culled when portal zones are enabled (see PortalZoneManager).
+            Use PortalZoneManager::NoZone (default) for objects that must always be
+            considered, regardless of zones (i.e. outdoors, the sky).
+        */
+        void setPortalZone( uint16 zoneId )                                 { mPortalZone = zoneId; }
+        uint16 getPortalZone(void) const                                    { return mPortalZone; }
+
         /// Checks whether this MovableObject is static. @See setStatic
         bool isStatic() const;
 
@@ -248,6 +284,16 @@ namespace Ogre {
         */
         static void updateAllBounds( const size_t numNodes, ObjectData t );
 
+        /** Same as updateAllBounds, but skips the packs where no object is flagged in
+            ObjectData::mBoundsDirty and no parent node was recomputed by the last
+            Node::updateDirtyTransforms (i.e. Transform::DerivedChanged isn't set).
+            Contiguous dirty packs are processed as a single run.
+        @remarks
+            Clears ObjectData::mBoundsDirty of every object in range.
+            @See SceneManager::setIncrementalBoundsUpdate
+        */
+        static void updateDirtyBounds( const size_t numNodes, ObjectData t );
+
         /** @See SceneManager::cullFrustum
         @remarks
             We don't pass by reference on purpose (avoid implicit aliasing)
@@ -270,6 +316,55 @@ namespace Ogre {
                                  uint32 sceneVisibilityFlags, MovableObjectArray &outCulledObjects,
                                  const Camera *lodCamera );
 
+        /// An object that passed culling, with what cullFrustum would've
+        /// stored in its ObjectData and the render queue it belongs to
+        struct CullResultEntry
+        {
+            MovableObject   *movableObject;
+            RealAsUint      distanceToCamera;
+            uint8           renderQueueId;
+        };
+        typedef FastArray<CullResultEntry> CullResultEntryArray;
+
+        /// Max number of frustums cullFrustumBatch can process at once
+        static const size_t c_maxCullFrustumBatch = 8;
+
+        /// Snapshot of a camera's frustum for cullFrustumBatch. Allows culling the
+        /// same camera with different orientations at once (i.e. cubemap faces)
+        struct CullFrustumBatchFrustum
+        {
+            Plane           planes[6];
+            Vector3         cameraPos;
+            /// Camera's forward (-Z) direction
+            Vector3         cameraDir;
+        };
+
+        /** @See SceneManager::cullFrustumBatch
+            Same as cullFrustum, but culls every pack of objects against several frustums
+            while it's still in cache. The tests that don't depend on the frustum (visibility,
+            shadow casting, rendering distance to the LOD camera) are performed only once.
+        @remarks
+            We don't pass ObjectData by reference on purpose (avoid implicit aliasing)
+            The scene & viewport visibility masks are NOT tested, since they may differ
+            per frustum. The caller must test them when consuming the results.
+            The cached distance to camera is not written to ObjectData either, it is
+            stored in each CullResultEntry instead.
+        @param frustums
+            Array of numFrustums frustums to cull against. numFrustums <= c_maxCullFrustumBatch
+        @param casterPass
+            True to exclude non-shadow casters
+        @param renderQueueId
+            Render queue of all the objects in objData. Stored in the results.
+        @param outCulledObjects
+            Array of numFrustums lists. Objects that are inside frustums[i] are
+            appended to outCulledObjects[i]
+        */
+        static void cullFrustumBatch( const size_t numNodes, ObjectData t,
+                                      const CullFrustumBatchFrustum *frustums, size_t numFrustums,
+                                      bool casterPass, const Camera *lodCamera,
+                                      uint8 renderQueueId,
+                                      CullResultEntryArray *outCulledObjects );
+
         /// @See InstancingTheadedCullingMethod, @see InstanceBatch::instanceBatchCullFrustumThreaded
         virtual void instanceBatchCullFrustumThreaded( const Frustum *frustum, const Camera *lodCamera,
                                                         uint32 combinedVisibilityFlags ) {}
@@ -298,16 +393,21 @@ namespace Ogre {
         @param globalLightList
             List of lights already culled against all possible frustums and
             reorganized contiguously for SoA
+        @param dirtyLightSpheres
+            When not null, only the objects intersecting at least one of these spheres
+            get their light list rebuilt; the rest keep the one they already have.
+            @see SceneManager::setIncrementalLegacyLightList
         */
         static void buildLightList( const size_t numNodes, ObjectData t,
-                                    const LightListInfo &globalLightList );
+                                    const LightListInfo &globalLightList,
+                                    const FastArray<Sphere> *dirtyLightSpheres = 0 );
 
         static void calculateCastersBox( const size_t numNodes, ObjectData t,
                                          uint32 sceneVisibilityFlags, AxisAlignedBox *outBox );
 
         friend void LodStrategy::lodUpdateImpl( const size_t numNodes, ObjectData t,
                                                 const Camera *camera, Real bias ) const;
-        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        friend void LodStrategy::lodSet( ObjectData &t, ArrayReal lodValue );
 
         /** Tells this object whether to be visible or not, if it has a renderable component. 
         @note An alternative approach of making an object invisible is to detach it
@@ -412,6 +512,18 @@ namespace Ogre {
         /// Returns the full transformation of the parent sceneNode or the attachingPoint node
         const Matrix4& _getParentNodeFullTransform(void) const;
 
+        /** Returns the full transformation the parent node had during the previous frame.
+            Used for generating motion vectors.
+        @remarks
+            The history is only tracked from the moment this function starts being called.
+            If it wasn't called last frame (i.e. first time, or the object wasn't visible),
+            the current transform is returned, thus the object appears not to have moved.
+            Subsequent calls during the same frame return the same value.
+        @param frameCount
+            Current frame number, i.e. VaoManager::getFrameCount
+        */
+        const Matrix4& _getPrevFrameParentNodeFullTransform( uint32 frameCount ) const;
+
         /** Retrieves the local axis-aligned bounding box for this object.
             @remarks
                 This bounding box is in local coordinates.
@@ -495,6 +607,10 @@ namespace Ogre {
         /// Returns the distance to camera as calculated in @cullFrustum
         inline Real getCachedDistanceToCameraAsReal(void) const;
 
+        /// Overrides the value returned by getCachedDistanceToCamera. Used when
+        /// culling results are reused instead of calling @cullFrustum
+        inline void _setCachedDistanceToCamera( RealAsUint distance );
+
         /** Sets the visibility flags for this object.
         @remarks
             As well as a simple true/false value for visibility (as seen in setVisible), 
@@ -590,6 +706,10 @@ namespace Ogre {
 
         SkeletonInstance* getSkeletonInstance(void) const   { return mSkeletonInstance; }
 
+        /// Local space Aabbs of each Renderable in mRenderables. Null if the renderables
+        /// can't be culled individually. See Item::setSubItemCulling
+        const FastArray<Aabb>* _getRenderableAabbs(void) const  { return mRenderableAabbs; }
+
 #if OGRE_DEBUG_MODE
         void _setCachedAabbOutOfDate(void)                  { mCachedAabbOutOfDate = true; }
         bool isCachedAabbOutOfDate() const                  { return mCachedAabbOutOfDate; }
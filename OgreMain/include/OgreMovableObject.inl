@@ -50,6 +50,11 @@ namespace Ogre
         return (reinterpret_cast<Real*RESTRICT_ALIAS>(mObjectData.mDistanceToCamera))[mObjectData.mIndex];
     }
     //-----------------------------------------------------------------------------------
+    inline void MovableObject::_setCachedDistanceToCamera( RealAsUint distance )
+    {
+        mObjectData.mDistanceToCamera[mObjectData.mIndex] = distance;
+    }
+    //-----------------------------------------------------------------------------------
     inline void MovableObject::setVisibilityFlags( uint32 flags )
     {
         mObjectData.mVisibilityFlags[mObjectData.mIndex] =
@@ -104,6 +109,9 @@ namespace Ogre
     inline void MovableObject::setLightMask( uint32 lightMask )
     {
         mObjectData.mLightMask[mObjectData.mIndex] = lightMask;
+        //buildLightList skips objects with no light mask, it won't clear it for us
+        if( !lightMask )
+            mLightList.clear();
     }
     //-----------------------------------------------------------------------------------
     inline void MovableObject::setRenderingDistance( Real dist )
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreId.h"
 #include "OgreVector3.h"
 #include "Math/Array/OgreTransform.h"
+#include "Math/Array/OgreCompactObjectHandle.h"
 #include "OgreHeaderPrefix.h"
 
 namespace Ogre {
@@ -173,7 +174,18 @@ namespace Ogre {
         /// User objects binding.
         UserObjectBindings mUserObjectBindings;
 
+#if OGRE_COMPACT_OBJECT_HANDLES
+        /// Our handle in msCompactHandles. See OGRE_CONFIG_COMPACT_OBJECT_HANDLES
+        uint32 mCompactHandle;
+#endif
+
     public:
+#if OGRE_COMPACT_OBJECT_HANDLES
+        /// Resolves the handles in ObjectData::mParents. See OGRE_CONFIG_COMPACT_OBJECT_HANDLES
+        static CompactObjectHandleTable msCompactHandles;
+        uint32 _getCompactHandle(void) const                    { return mCompactHandle; }
+#endif
+
         /** Index in the vector holding this node reference (could be our parent node, or a global array
             tracking all created nodes to avoid memory leaks). Used for O(1) removals.
         @remarks
@@ -699,6 +711,16 @@ namespace Ogre {
         */
         static void updateAllTransforms( const size_t numNodes, Transform t );
 
+        /** Same as updateAllTransforms, but skips the packs where no node is flagged
+            as Transform::DirtyLocal and no parent was recomputed in the previous depth.
+            Contiguous dirty packs are processed as a single run to keep the SIMD loop dense.
+        @remarks
+            Updates Transform::mDirtyFlags of every node in range, hence all depths must be
+            processed in order and parents must have been processed by this function too.
+            @See NodeMemoryManager::setDirtyTracking
+        */
+        static void updateDirtyTransforms( const size_t numNodes, Transform t );
+
         /** Gets the local position, relative to this node, of the given world-space position */
         virtual_l2 Vector3 convertWorldToLocalPosition( const Vector3 &worldPos );
         Vector3 convertWorldToLocalPositionUpdated( const Vector3 &worldPos )
@@ -16,7 +16,9 @@ namespace Ogre
     /**
     @class OfflineProfiler
         Simple profiler that will produce a CSV file for offline
-        analysis once dumpProfileResults is called
+        analysis once dumpProfileResults is called.
+        It can also produce a timeline of every thread in the Trace Event format
+        (see dumpTraceEvents), which can be opened in chrome://tracing or Perfetto.
     @remarks
         Because this profiler collects sample undefinitely, it will cause
         memory consumption to grow over time.
@@ -45,6 +47,11 @@ namespace Ogre
             ProfileSample       *mRoot;
             ProfileSample       *mCurrentSample;
             Timer               *mTimer;
+            /// Microseconds between the OfflineProfiler's epoch and mTimer's, so that
+            /// the timestamps of all threads are comparable in the trace.
+            uint64              mTimeOffset;
+            uint32              mThreadIdx;
+            char                mThreadName[OGRE_OFFLINE_PROFILER_NAME_STR_LENGTH];
 
             uint64              mTotalAccumTime;
 
@@ -69,13 +76,18 @@ namespace Ogre
             void dumpSample( ProfileSample *sample, LwString &tmpStr,
                              String &outCsvString, StdMap<IdString, ProfileSample> &accumStats,
                              uint32 stackDepth );
+            void dumpTraceSample( const ProfileSample *sample, LwString &tmpStr,
+                                  String &outJson, uint64 usNow ) const;
 
             void reset(void);
 
         public:
-            PerThreadData( bool startPaused, size_t bytesPerPool );
+            PerThreadData( bool startPaused, size_t bytesPerPool,
+                           uint64 timeOffset, uint32 threadIdx );
             ~PerThreadData();
 
+            void setThreadName( const char *name );
+
             void setPauseRequest( bool bPause );
             void requestReset(void);
 
@@ -84,6 +96,9 @@ namespace Ogre
 
             void dumpProfileResultsStr( String &outCsvStringPerFrame, String &outCsvStringAccum );
             void dumpProfileResults( const String &fullPathPerFrame, const String &fullPathAccum );
+
+            /// Appends this thread's events (comma separated, with a leading comma)
+            void dumpTraceEvents( String &outJson );
         };
 
         typedef FastArray<PerThreadData*> PerThreadDataArray;
@@ -95,11 +110,16 @@ namespace Ogre
         PerThreadDataArray	mThreadData;
 
         size_t              mBytesPerPool;
+        /// Epoch of all trace timestamps. Only used (under mMutex) when a thread
+        /// starts profiling, to calculate its PerThreadData::mTimeOffset.
+        Timer               *mTimer;
 
         String              mOnShutdownPerFramePath;
         String              mOnShutdownAccumPath;
+        String              mOnShutdownTracePath;
 
         PerThreadData* allocatePerThreadData(void);
+        PerThreadData* getPerThreadData(void);
 
     public:
         OfflineProfiler();
@@ -135,6 +155,29 @@ namespace Ogre
         void profileBegin( const char *name, ProfileSampleFlags::ProfileSampleFlags flags );
         void profileEnd(void);
 
+        /** Names the calling thread in the trace (see dumpTraceEvents).
+            Threads that weren't named appear as "Thread N", where N is the order in which
+            they started profiling (the thread that did so first is usually the main one).
+        @remarks
+            Use the OgreProfileThreadName macro rather than calling this directly.
+        */
+        void setCurrentThreadName( const char *name );
+
+        /** Dumps the collected samples of all threads, with their start time and duration,
+            in the Trace Event JSON format (i.e. loadable in chrome://tracing or Perfetto).
+        @remarks
+            Unlike dumpProfileResults, the samples are not destroyed by this call.
+            Aggregated samples (see ProfileSampleFlags::Aggregate) appear as a single
+            event spanning from the first begin to the last end.
+        */
+        void dumpTraceEvents( String &outJson );
+        /// Same as dumpTraceEvents, but writes the JSON to the given file.
+        void dumpTraceEvents( const String &fullPath );
+
+        /// Ogre will call dumpTraceEvents on shutdown if the path isn't empty.
+        /// Note this happens before the CSVs (see setDumpPathsOnShutdown) are dumped.
+        void setTraceDumpPathOnShutdown( const String &fullPath );
+
         /** Dumps CSV data into two CSV files
         @param fullPathPerFrame
             Full path to csv without extension to generate where to dump the per-frame CSV data.
@@ -0,0 +1,279 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgrePackArchive_H_
+#define _OgrePackArchive_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreArchive.h"
+#include "OgreArchiveFactory.h"
+
+#include <fstream>
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Archive using Ogre's own pack format, meant for large, read-only, asset bundles.
+    @remarks
+        Unlike Zip archives:
+            * The index is sorted by the hash of each (lowercase) file name, thus looking
+              up a file is a binary search, and loading the archive only reads the index.
+            * Each entry is aligned (4096 bytes by default) and the whole pack is memory
+              mapped when possible, so uncompressed entries are returned as views of the
+              mapping (see DataStream::getDataView) with no copy at all.
+            * Compression is chosen per entry, and compressed entries are split in
+              independent blocks that get decompressed in parallel.
+            * There is no global mutex; open can be called from multiple threads.
+    @par
+        Use PackArchiveWriter (or the OgrePackTool command line tool) to build packs.
+    @par
+        File layout (little endian):
+            PackHeader
+            Entries' data, each aligned to PackHeader::alignment
+            PackEntry[numEntries], sorted by nameHash
+            String table with all the file names
+    @par
+        The data of a compressed entry starts with uint32 compressedSize[numBlocks],
+        followed by the blocks. Every block but the last one decompresses to
+        PackEntry::blockSize bytes.
+    */
+    class _OgreExport PackArchive : public Archive
+    {
+    public:
+        enum Compression
+        {
+            /// Stored as is. Can be memory mapped
+            PackCompressionNone,
+            /// zlib. Only available when Ogre is built with Zip support
+            PackCompressionDeflate,
+            PackCompressionCount
+        };
+
+        static const uint32 c_magic;
+        static const uint32 c_version;
+
+        struct PackHeader
+        {
+            uint32  magic;
+            uint32  version;
+            uint32  numEntries;
+            uint32  alignment;
+            uint64  indexOffset;
+            uint64  stringTableOffset;
+            uint64  stringTableSize;
+        };
+
+        struct PackEntry
+        {
+            /// See PackArchive::hashFilename
+            uint32  nameHash;
+            /// Offset into the string table
+            uint32  nameOffset;
+            uint32  nameLength;
+            /// See Compression
+            uint32  compression;
+            /// Where the data starts, from the beginning of the file. Multiple of alignment
+            uint64  dataOffset;
+            /// Size of the data in the file. Same as uncompressedSize if PackCompressionNone
+            uint64  dataSize;
+            uint64  uncompressedSize;
+            /// Uncompressed size of each block. 0 if PackCompressionNone
+            uint32  blockSize;
+            uint32  numBlocks;
+            int64   modifiedTime;
+        };
+
+    protected:
+        typedef vector<PackEntry>::type PackEntryVec;
+
+        PackEntryVec    mEntries;
+        String          mStringTable;
+        FileInfoList    mFileList;
+
+        /// The whole pack mapped into memory. Null if mapping wasn't possible,
+        /// in which case entries are read from a std::ifstream opened per call to open.
+        DataStreamPtr   mMappedFile;
+        const uchar     *mMappedData;
+
+        time_t          mPackModifiedTime;
+
+        static uint32 msNumDecompressionThreads;
+
+        /// Returns null if not found
+        const PackEntry* findEntry( const String &filename ) const;
+
+        /// Reads size bytes at the given offset into outData
+        void readData( uint64 offset, uint64 size, uchar *outData ) const;
+
+        DataStreamPtr decompressEntry( const String &filename, const PackEntry &entry,
+                                       const uchar *compressedData ) const;
+
+    public:
+        PackArchive( const String &name, const String &archType );
+        ~PackArchive();
+
+        /// @copydoc Archive::isCaseSensitive
+        bool isCaseSensitive(void) const { return false; }
+
+        /// @copydoc Archive::isThreadSafe
+        bool isThreadSafe() const { return true; }
+
+        /// @copydoc Archive::load
+        void load();
+        /// @copydoc Archive::unload
+        void unload();
+
+        /// @copydoc Archive::open
+        DataStreamPtr open( const String &filename, bool readOnly = true );
+
+        /// @copydoc Archive::create
+        DataStreamPtr create( const String &filename );
+
+        /// @copydoc Archive::remove
+        void remove( const String &filename );
+
+        /// @copydoc Archive::list
+        StringVectorPtr list( bool recursive = true, bool dirs = false );
+
+        /// @copydoc Archive::listFileInfo
+        FileInfoListPtr listFileInfo( bool recursive = true, bool dirs = false );
+
+        /// @copydoc Archive::find
+        StringVectorPtr find( const String &pattern, bool recursive = true, bool dirs = false );
+
+        /// @copydoc Archive::findFileInfo
+        FileInfoListPtr findFileInfo( const String &pattern, bool recursive = true,
+                                      bool dirs = false );
+
+        /// @copydoc Archive::exists
+        bool exists( const String &filename );
+
+        /// @copydoc Archive::getModifiedTime
+        time_t getModifiedTime( const String &filename );
+
+        /// Hash used by the index. Case insensitive, and '\\' is treated as '/'
+        static uint32 hashFilename( const String &filename );
+
+        /// Whether the given compression is available in this build
+        static bool isCompressionSupported( Compression compression );
+
+        /** Sets the number of threads used to decompress the blocks of an entry.
+            0 means one per logical core (default). 1 disables threading.
+        */
+        static void setNumDecompressionThreads( uint32 numThreads );
+        static uint32 getNumDecompressionThreads(void);
+    };
+
+    /** Builds archives that PackArchive can read.
+    @code
+        PackArchiveWriter writer( "assets.pack" );
+        writer.addFile( "textures/brick.dds", stream, PackArchive::PackCompressionNone );
+        writer.addFile( "scripts/brick.material", stream2, PackArchive::PackCompressionDeflate );
+        writer.finish();
+    @endcode
+    */
+    class _OgreExport PackArchiveWriter : public ArchiveAlloc
+    {
+    protected:
+        std::ofstream   mFile;
+        String          mFilename;
+        uint32          mAlignment;
+        uint32          mBlockSize;
+        uint64          mCurrentOffset;
+
+        vector<PackArchive::PackEntry>::type mEntries;
+        String          mStringTable;
+
+        void writeAligned( const void *data, size_t size );
+
+    public:
+        /**
+        @param filename
+            Path of the pack to create. It gets overwritten.
+        @param alignment
+            Every entry starts at a multiple of this. Must be a power of 2.
+        @param blockSize
+            Compressed entries are split in blocks of this size, which are
+            compressed independently so they can be decompressed in parallel.
+        */
+        PackArchiveWriter( const String &filename, uint32 alignment = 4096u,
+                           uint32 blockSize = 256u * 1024u );
+        ~PackArchiveWriter();
+
+        /** Adds a file to the pack.
+        @param name
+            Name of the file inside the pack; use '/' to separate folders.
+        @param stream
+            Contents of the file. Read from its current position to the end.
+        @param compression
+            Falls back to PackCompressionNone when compression doesn't save at
+            least 1/8th of the size (so that the entry can be mapped instead).
+        @param modifiedTime
+            Reported by PackArchive::getModifiedTime. 0 to use the pack's own time.
+        */
+        void addFile( const String &name, DataStreamPtr &stream,
+                      PackArchive::Compression compression, time_t modifiedTime = 0 );
+
+        /// Writes the index. Must be called once all files have been added.
+        void finish(void);
+    };
+
+    /** Specialisation of ArchiveFactory for PackArchive. Type is "Pack". */
+    class _OgreExport PackArchiveFactory : public ArchiveFactory
+    {
+    public:
+        virtual ~PackArchiveFactory() {}
+        /// @copydoc FactoryObj::getType
+        const String& getType(void) const;
+        /// @copydoc FactoryObj::createInstance
+        Archive *createInstance( const String& name, bool readOnly )
+        {
+            if( !readOnly )
+                return NULL;
+
+            return OGRE_NEW PackArchive( name, getType() );
+        }
+        /// @copydoc FactoryObj::destroyInstance
+        void destroyInstance( Archive* ptr ) { OGRE_DELETE ptr; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
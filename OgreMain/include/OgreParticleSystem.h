@@ -143,6 +143,13 @@ namespace Ogre {
             String doGet(const void* target) const;
             void doSet(void* target, const String& val);
         };
+        /** Command object for gpu simulation (see ParamCommand).*/
+        class CmdGpuSimulation : public ParamCommand
+        {
+        public:
+            String doGet(const void* target) const;
+            void doSet(void* target, const String& val);
+        };
 
         /** Creates a particle system with no emitters or affectors.
         @remarks
@@ -264,6 +271,8 @@ namespace Ogre {
             the number of emitters, their emission rates, the time-to-live (TTL) each particle is
             given on emission (and whether any affectors modify that TTL) and the maximum
             number of particles allowed in this system at once (particle quota).
+        @par
+            Always returns 0 while isSimulatedOnGpu, since the particles only live in the GPU.
         */
         size_t getNumParticles(void) const;
 
@@ -346,6 +355,20 @@ namespace Ogre {
         */
         void _update(Real timeElapsed);
 
+        /** Called by the controller every frame with the time elapsed. Updates the system
+            right away, or queues it in the SceneManager when it updates particle systems
+            in parallel (see SceneManager::setParallelParticleSystemUpdates).
+        */
+        void _notifyFrameTime(Real timeElapsed);
+
+        /// Called by SceneManager from the main thread before the queued systems are updated
+        /// in parallel. Does the work of _update that isn't safe to do from a worker thread.
+        void _prepareParallelUpdate(void);
+
+        /// Called by SceneManager from a worker thread. Updates the system with the time
+        /// accumulated since it was queued.
+        void _executeParallelUpdate(void);
+
         /** Returns an iterator for stepping through all particles in this system.
         @remarks
             This method is designed to be used by people providing new ParticleAffector subclasses,
@@ -610,6 +633,28 @@ namespace Ogre {
             It only returns the value of emitting flag.
         */
         bool getEmitting() const;
+
+        /** Requests this system to be simulated with compute shaders by the
+            GpuParticleSimulator (see ParticleSystemManager::getGpuParticleSimulator).
+        @remarks
+            Takes effect on the next update. If there is no simulator, or it can't simulate
+            this system (see GpuParticleSimulator::canSimulate) it keeps being simulated
+            on the CPU. The reason is logged once; call this function again after changing
+            the system to retry.
+        @par
+            While on the GPU, the particles can't be accessed, iteration_interval and
+            nonvisible_update_timeout are ignored, and the bounds are estimated rather than
+            calculated from the particles.
+        */
+        void setGpuSimulation( bool gpuSimulation );
+        bool getGpuSimulation(void) const               { return mGpuSimulation; }
+
+        /// True if the system is currently being simulated by a GpuParticleSimulator.
+        bool isSimulatedOnGpu(void) const               { return mGpuSimulator != 0; }
+
+        /// Called by GpuParticleSimulator when it takes or releases this system.
+        /// The renderable replaces the renderer's while on the GPU.
+        void _notifyGpuSimulator( GpuParticleSimulator *simulator, Renderable *renderable );
     protected:
 
         /// Command objects
@@ -624,6 +669,7 @@ namespace Ogre {
         static CmdLocalSpace msLocalSpaceCmd;
         static CmdIterationInterval msIterationIntervalCmd;
         static CmdNonvisibleTimeout msNonvisibleTimeoutCmd;
+        static CmdGpuSimulation msGpuSimulationCmd;
 
         bool mBoundsAutoUpdate;
         Real mBoundsUpdateTime;
@@ -665,6 +711,20 @@ namespace Ogre {
         bool mEmittedEmitterPoolInitialised;
         /// Used to control if the particle system should emit particles or not.
         bool mIsEmitting;
+        /// Requested via setGpuSimulation
+        bool mGpuSimulation;
+        /// The simulator refused this system. Don't ask again until setGpuSimulation
+        bool mGpuSimulationRejected;
+        /// Non-null while we're simulated on the GPU
+        GpuParticleSimulator *mGpuSimulator;
+
+        /// Time accumulated by _notifyFrameTime while waiting in SceneManager's queue
+        Real mPendingUpdateTime;
+        /// We're in SceneManager's queue of systems to update in parallel
+        bool mQueuedForParallelUpdate;
+        /// _update is running from a worker thread. Parent transforms are already up to date
+        /// (see _prepareParallelUpdate) and must not be updated again
+        bool mUpdatingInParallel;
 
         typedef list<Particle*>::type ActiveParticleList;
         typedef list<Particle*>::type FreeParticleList;
@@ -720,6 +780,14 @@ namespace Ogre {
         */
         ParticlePool mParticlePool;
 
+        /** Memory backing the particles in mParticlePool.
+        @remarks
+            Every increasePool allocates its particles as one contiguous array rather than
+            one by one, so that walking the active list (which starts in pool order) doesn't
+            jump all over the heap.
+        */
+        ParticlePool mParticleBlocks;
+
         typedef list<ParticleEmitter*>::type FreeEmittedEmitterList;
         typedef list<ParticleEmitter*>::type ActiveEmittedEmitterList;
         typedef vector<ParticleEmitter*>::type EmittedEmitterList;
@@ -799,6 +867,9 @@ namespace Ogre {
         /** Sort the particles in the system **/
         void _sortParticles(Camera* cam);
 
+        /// Parent node's full transform. Only updates it when not called from a worker thread.
+        const Matrix4& getParentFullTransform(void) const;
+
         /** Resize the internal pool of particles. */
         void increasePool(size_t size);
 
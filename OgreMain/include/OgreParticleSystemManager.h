@@ -105,6 +105,8 @@ namespace Ogre {
 
         ObjectMemoryManager mTemplatesObjectMemMgr;
 
+        GpuParticleSimulator *mGpuParticleSimulator;
+
         /** Internal script parsing method. */
         void parseNewEmitter(const String& type, DataStreamPtr& chunk, ParticleSystem* sys);
         /** Internal script parsing method. */
@@ -349,6 +351,13 @@ namespace Ogre {
                 mSystemTemplates.begin(), mSystemTemplates.end());
         } 
 
+        /// Called by GpuParticleSimulator on construction & destruction. Throws if
+        /// there's already a simulator.
+        void _setGpuParticleSimulator( GpuParticleSimulator *simulator );
+        /// Simulator used by ParticleSystems with gpu_simulation. Null if there is none,
+        /// in which case those systems are simulated on the CPU.
+        GpuParticleSimulator* getGpuParticleSimulator(void) const  { return mGpuParticleSimulator; }
+
         /** Get an instance of ParticleSystemFactory (internal use). */
         ParticleSystemFactory* _getFactory(void) { return mFactory; }
         
@@ -0,0 +1,194 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgrePortalZoneManager_H_
+#define _OgrePortalZoneManager_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMovableObject.h"
+#include "OgrePlane.h"
+#include "Math/Simple/OgreAabb.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /**
+    @class PortalZoneManager
+        Portal & zone visibility for v2 culling, in the spirit of the PCZSceneManager plugin.
+
+        The scene is split in zones (i.e. rooms) connected by portals (i.e. doors, windows).
+        Before culling each camera, the zones visible from it are found by walking through
+        the portals, narrowing the frustum at every portal crossed. SceneManager::cullFrustum
+        then rejects the objects that are in zones not visible.
+
+        Objects are assigned to zones via MovableObject::setPortalZone, or automatically
+        based on their bounds (see assignZone & addTrackedObject).
+        Objects without a zone are always considered.
+        When the camera is outside every zone, nothing is rejected.
+
+        Only regular render passes are affected: shadow caster passes and light culling
+        (i.e. Forward+) ignore zones, since light can come from zones that aren't visible.
+    @remarks
+        Create it via SceneManager::setPortalZonesEnabled.
+    */
+    class _OgreExport PortalZoneManager : public SceneMgtAlloc
+    {
+    public:
+        static const uint16 NoZone = 0xFFFF;
+
+    protected:
+        struct Zone
+        {
+            Aabb                aabb;
+            /// Index to mPortals
+            FastArray<uint32>   portals;
+        };
+
+        struct Portal
+        {
+            Vector3 corners[4];
+            Vector3 centre;
+            uint16  zones[2];
+            bool    enabled;
+            /// Whether we're already looking through this portal during the traversal
+            bool    inTraversal;
+        };
+
+        typedef vector<Zone>::type ZoneVec;
+        typedef vector<Portal>::type PortalVec;
+
+        ZoneVec         mZones;
+        PortalVec       mPortals;
+
+        /// Results of the last _updateVisibleZones. 1 if the zone is visible, 0 otherwise.
+        FastArray<uint8> mVisibleZones;
+        /// True if the last camera was outside every zone
+        bool            mAllVisible;
+        uint16          mCameraZone;
+        Camera const    *mLastCamera;
+
+        size_t          mMaxPortalDepth;
+
+        FastArray<Plane> mPlaneStack;
+
+        MovableObject::MovableObjectArray mTrackedObjects;
+
+        void traverse( uint16 zoneId, const Vector3 &eyePos, Real nearDist, size_t depth );
+
+    public:
+        PortalZoneManager();
+        ~PortalZoneManager();
+
+        /** Creates a zone.
+        @param aabb
+            World space bounds of the zone. Used to find the zone of the camera and
+            by assignZone. Zones may overlap; the smallest one containing a point wins.
+        @return
+            Id of the zone.
+        */
+        uint16 createZone( const Aabb &aabb );
+        void setZoneAabb( uint16 zoneId, const Aabb &aabb );
+        const Aabb& getZoneAabb( uint16 zoneId ) const;
+        size_t getNumZones(void) const                  { return mZones.size(); }
+
+        /** Creates a portal connecting two zones. You can see from one into the other
+            through it in both directions.
+        @param corners
+            World space corners of the portal. Must form a convex quad, in either winding.
+        @return
+            Id of the portal.
+        */
+        uint32 createPortal( uint16 zoneA, uint16 zoneB, const Vector3 corners[4] );
+        void setPortalCorners( uint32 portalId, const Vector3 corners[4] );
+        /// Disabled portals can't be seen through (i.e. closed doors)
+        void setPortalEnabled( uint32 portalId, bool bEnabled );
+        bool getPortalEnabled( uint32 portalId ) const;
+        size_t getNumPortals(void) const                { return mPortals.size(); }
+
+        /// Destroys all zones & portals. Objects keep their zone ids;
+        /// reset them with MovableObject::setPortalZone.
+        void destroyAll(void);
+
+        /// Returns the smallest zone containing the point, NoZone if none
+        uint16 findZone( const Vector3 &point ) const;
+
+        /// Sets the zone of the object from the centre of its world Aabb.
+        /// The object's bounds must be up to date.
+        void assignZone( MovableObject *movableObject ) const;
+
+        /** Tracked objects are automatically reassigned to the zone they're in, after
+            the scene graph is updated every frame. Use it for objects moving between zones.
+            Objects must be removed before being destroyed.
+        */
+        void addTrackedObject( MovableObject *movableObject );
+        void removeTrackedObject( MovableObject *movableObject );
+
+        /// Max number of portals the traversal goes through in a row. Default 16
+        void setMaxPortalDepth( size_t maxDepth )       { mMaxPortalDepth = maxDepth; }
+        size_t getMaxPortalDepth(void) const            { return mMaxPortalDepth; }
+
+        /// Zone the camera was in the last time _updateVisibleZones was called
+        uint16 getCameraZone(void) const                { return mCameraZone; }
+
+        /// Returns true if the zone was visible from the last camera
+        bool isZoneVisible( uint16 zoneId ) const
+        {
+            return mAllVisible || zoneId >= mVisibleZones.size() || mVisibleZones[zoneId] != 0;
+        }
+
+        bool isObjectVisible( const MovableObject *movableObject ) const
+        {
+            return isZoneVisible( movableObject->getPortalZone() );
+        }
+
+        /// Returns false if the last camera was outside every zone, thus there's nothing to reject
+        bool isRejectingObjects(void) const             { return !mAllVisible; }
+
+        /// Finds the zones visible from the camera. Called by the SceneManager before culling.
+        void _updateVisibleZones( const Camera *camera );
+        /// Camera used in the last _updateVisibleZones
+        const Camera* _getLastCamera(void) const        { return mLastCamera; }
+        /// Reassigns the zone to tracked objects. Called by the SceneManager.
+        void _updateTrackedObjects(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
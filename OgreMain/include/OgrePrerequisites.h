@@ -169,6 +169,7 @@ namespace Ogre {
     class AxisAlignedBox;
     class AxisAlignedBoxSceneQuery;
     class Barrier;
+    class BillboardChain;
     class Bone;
     class BoneMemoryManager;
     struct BoneTransform;
@@ -181,6 +182,7 @@ namespace Ogre {
     class Codec;
     class ColourValue;
     class CommandBuffer;
+    class ComputeDownsampler;
     class ComputeTools;
     class ConfigDialog;
     class ConstBufferPacked;
@@ -199,6 +201,7 @@ namespace Ogre {
     struct DescriptorSetTexture;
     struct DescriptorSetTexture2;
     struct DescriptorSetUav;
+    class DynamicMesh;
     class DynLib;
     class DynLibManager;
     class ErrorDialog;
@@ -208,10 +211,14 @@ namespace Ogre {
     class ForwardClustered;
     class ForwardPlusBase;
     struct FrameEvent;
+    class FrameArena;
+    class FrameArenaManager;
     class FrameListener;
     class Frustum;
     struct GpuLogicalBufferStruct;
     struct GpuNamedConstants;
+    class GpuParticleSimulator;
+    class GpuProfiler;
     class GpuProgramParameters;
     class GpuSharedParameters;
     class GpuProgram;
@@ -246,6 +253,7 @@ namespace Ogre {
     class IntersectionSceneQueryListener;
     class Image2;
     class Item;
+    class ItemPool;
     struct KfTransform;
     class Light;
     class Log;
@@ -285,6 +293,7 @@ namespace Ogre {
     class Plane;
     class PlaneBoundedVolume;
     class Plugin;
+    class PortalZoneManager;
     class Profile;
     class Profiler;
     class Quaternion;
@@ -307,7 +316,9 @@ namespace Ogre {
     class ResourceBackgroundQueue;
     class ResourceGroupManager;
     class ResourceManager;
+    class RibbonTrail;
     class Root;
+    class SceneCommandQueue;
     class SceneManager;
     class SceneManagerEnumerator;
     class SceneNode;
@@ -327,6 +338,7 @@ namespace Ogre {
     class SphereSceneQuery;
     class StagingBuffer;
     class StagingTexture;
+    class StaticGeometry;
     class StreamSerialiser;
     class StringConverter;
     class StringInterface;
@@ -347,6 +359,7 @@ namespace Ogre {
     class Timer;
     class UavBufferPacked;
     class UserObjectBindings;
+    class UploadScheduler;
     class VaoManager;
     class Vector2;
     class Vector3;
@@ -355,6 +368,7 @@ namespace Ogre {
     class VertexAnimationTrack;
     struct VertexArrayObject;
     class VertexBufferPacked;
+    class VideoFrameCapture;
     class Window;
     class WireAabb;
     class WireBoundingBox;
@@ -422,6 +436,7 @@ namespace Ogre {
         class ManualObject;
         class Mesh;
         class MeshManager;
+        class NodeAnimationEvaluator;
         class NumericAnimationTrack;
         class NumericKeyFrame;
         class OldBone;
@@ -82,6 +82,9 @@ Ogre-dependent is in the visualization/logging routines and the use of the Timer
 #   define OgreProfileGpuBeginDynamic( a )
 #   define OgreProfileGpuBeginDynamicHashed( a, hash )
 #   define OgreProfileGpuEnd( a )
+#   define OgreProfileThreadName( name )
+    //The internal profiler is not thread safe
+#   define OgreProfileWorker( a )
 #elif OGRE_PROFILING == OGRE_PROFILING_REMOTERY
 namespace Ogre
 {
@@ -127,6 +130,8 @@ namespace Ogre
 #   define OgreProfileGpuBeginDynamicHashed( a, hash )                              \
     Ogre::Profiler::getSingleton().beginGPUSample( a, hash )
 #   define OgreProfileGpuEnd( a ) Ogre::Profiler::getSingleton().endGPUSample(a)
+#   define OgreProfileThreadName( name ) rmt_SetCurrentThreadName( name )
+#   define OgreProfileWorker( a ) OgreProfile( a )
 //#   define OgreProfileGpu( g ) Ogre::Profiler::getSingleton().endGPUEvent(g)
 
 namespace Ogre
@@ -168,6 +173,9 @@ namespace Ogre
 #   define OgreProfileGpuBeginDynamic( a )
 #   define OgreProfileGpuBeginDynamicHashed( a, hash )
 #   define OgreProfileGpuEnd( a )
+#   define OgreProfileThreadName( name ) \
+        Ogre::Profiler::getSingleton().getOfflineProfiler().setCurrentThreadName( name )
+#   define OgreProfileWorker( a )               OgreProfile( a )
 #else
 #   define OgreProfilerUseStableMarkers true
 #   define OgreProfileExhaustive( a )
@@ -188,6 +196,8 @@ namespace Ogre
 #   define OgreProfileGpuBeginDynamic( a )
 #   define OgreProfileGpuBeginDynamicHashed( a, hash )
 #   define OgreProfileGpuEnd( a )
+#   define OgreProfileThreadName( name )
+#   define OgreProfileWorker( a )
 #endif
 
 #if OGRE_PROFILING && !OGRE_PROFILING_EXHAUSTIVE
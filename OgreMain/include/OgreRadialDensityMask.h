@@ -60,6 +60,7 @@ namespace Ogre
         Rectangle2D *mRectangle;
 
         float mRadius[3];
+        uint8 mQuality;
         Vector2 mLeftEyeCenter;
         Vector2 mRightEyeCenter;
 
@@ -97,6 +98,7 @@ namespace Ogre
         @param quality
         */
         void setQuality( RdmQuality quality );
+        RdmQuality getQuality( void ) const { return static_cast<RdmQuality>( mQuality ); }
 
         /** Sets the center of the eye. Each eye is relative to its own viewport. e.g.
             the default for both eyes is Vector2( 0, 0 ) and not Vector2( -0.5, 0 ) for the
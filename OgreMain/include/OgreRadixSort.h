@@ -29,6 +29,8 @@ THE SOFTWARE.
 #define __RadixSort_H__
 
 #include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre {
 
@@ -322,9 +324,70 @@ namespace Ogre {
 
     };
 
+    /** Stable LSD radix sort of (64-bit key, 32-bit index) pairs, whose passes can be
+        split across the SceneManager's worker threads.
+    @remarks
+        Unlike RadixSort it works on a flat array of keys it owns instead of a container,
+        and skips the bytes that are equal in all keys. It also offers an insertion sort
+        for keys that are expected to be nearly sorted already.
+        Used by RenderQueue::RadixSort & RenderQueue::TemporalCoherenceSort.
+    */
+    class _OgreExport RadixSort64 : public UniformScalableTask
+    {
+    public:
+        struct Key
+        {
+            uint64  hash;
+            uint32  idx;
+        };
+
+        typedef FastArray<Key> KeyArray;
+
+    protected:
+        /// The result always ends up in mKeys[0]
+        KeyArray            mKeys[2];
+        /// The array mKeys[mSrc] is being sorted by mShift into the other one
+        size_t              mSrc;
+        uint32              mShift;
+        bool                mScatterPass;
+        /// 256 counters per thread
+        FastArray<uint32>   mHistograms;
+
+        void histogram( size_t threadIdx, size_t numThreads );
+        void scatter( size_t threadIdx, size_t numThreads );
+
+    public:
+        RadixSort64();
+
+        /// The keys to sort. Fill it before calling sort or insertionSort,
+        /// read the result from it afterwards.
+        KeyArray& getKeys(void)                 { return mKeys[0]; }
+
+        /** Sorts getKeys() by Key::hash. Keys with the same hash keep their order.
+        @param numThreads
+            Number of contiguous slices the keys are split into during each pass.
+        @param sceneManager
+            When not null, each slice is processed by one of its worker threads, and
+            numThreads must be SceneManager::getNumWorkerThreads.
+            When null, the slices are processed one after another by the calling thread.
+            The result is the same either way.
+        */
+        void sort( size_t numThreads, SceneManager *sceneManager );
+
+        /** Sorts getKeys() by Key::hash with an insertion sort. Keys with the same hash
+            keep their order.
+        @return
+            False if it had to move keys more than maxShifts times (the keys are left
+            partially sorted); true if fully sorted.
+        */
+        bool insertionSort( size_t maxShifts );
+
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+    };
+
     /** @} */
     /** @} */
 
 }
 #endif
-
@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreRenderOperation.h"
 #include "OgreMovableObject.h"
 #include "OgreRenderable.h"
+#include "OgreVector2.h"
 
 namespace Ogre {
 namespace v1 {
@@ -58,10 +59,13 @@ namespace v1 {
         Vector3     mScale;
 
         bool        mQuad;
+        Vector2     mUvScale;
 
         RenderOperation mRenderOp;
 
         void initRectangle2D(void);
+        /// Fills the position & UV buffer
+        void fillPositionsAndUvs(void);
 
     public:
         Rectangle2D( bool bQuad, IdType id, ObjectMemoryManager *objectMemoryManager,
@@ -85,7 +89,15 @@ namespace v1 {
         void setNormals( const Ogre::Vector3 &topLeft, const Ogre::Vector3 &bottomLeft,
                         const Ogre::Vector3 &topRight, const Ogre::Vector3 &bottomRight );
 
-        Real getSquaredViewDepth(const Camera* cam) const   { (void)cam; return 0; }
+        /** Scales the UVs, which are in range [0; 1] by default. i.e. to sample
+            only the top-left region of a texture (used by dynamic resolution).
+        @remarks
+            Cheap if the scale doesn't change. Otherwise the vertex buffer is rewritten.
+        */
+        void setUvScale( const Vector2 &uvScale );
+        const Vector2& getUvScale(void) const               { return mUvScale; }
+
+                Real getSquaredViewDepth(const Camera* cam) const   { (void)cam; return 0; }
 
         virtual void getWorldTransforms( Matrix4* xform ) const;
         virtual void getRenderOperation( RenderOperation& op, bool casterPass );
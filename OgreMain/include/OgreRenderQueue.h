@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 #include "OgreSharedPtr.h"
 #include "OgreHlmsCommon.h"
+#include "Threading/OgreUniformScalableTask.h"
+#include "OgreRadixSort.h"
 #include "OgreHeaderPrefix.h"
 #include "OgreIteratorWrappers.h"
 
@@ -38,6 +40,7 @@ namespace Ogre {
 
     class Camera;
     class MovableObject;
+    class WorkStealingScheduler;
 
     /** \addtogroup Core
     *  @{
@@ -90,7 +93,7 @@ namespace Ogre {
             200-224: FAST \n
             225-255: V1_FAST
     */
-    class _OgreExport RenderQueue : public RenderQueueAlloc
+    class _OgreExport RenderQueue : public RenderQueueAlloc, public UniformScalableTask
     {
     public:
         enum Modes
@@ -123,6 +126,13 @@ namespace Ogre {
             DisableSort,
             NormalSort,
             StableSort,
+            /// Stable LSD radix sort on the 64-bit hash. Large queues are sorted
+            /// using the SceneManager's worker threads.
+            RadixSort,
+            /// Starts from the order of the previous sort of the same queue and runs
+            /// an insertion sort. If too many keys moved, it falls back to RadixSort.
+            /// Ideal for mostly static scenes where the order barely changes.
+            TemporalCoherenceSort
         };
 
     private:
@@ -144,12 +154,89 @@ namespace Ogre {
             RqSortMode              mSortMode;
             bool                    mSorted;
             Modes                   mMode;
-
-            RenderQueueGroup() : mSortMode( NormalSort ), mSorted( false ), mMode( FAST ) {}
+            /// TemporalCoherenceSort: order (as indices into the merged per-thread
+            /// queues) of the last time this group was sorted
+            FastArray<uint32>       mLastSortOrder;
+            /// @see setInstancingGrouping
+            bool                    mInstancingGrouping;
+            /// @see setOrderIndependentTransparency
+            bool                    mOrderIndependentTransparency;
+            /// Occluders picked by selectOccluders. Swapped with mQueuedRenderables while rendering
+            QueuedRenderableArray   mOccluders;
+
+            RenderQueueGroup() : mSortMode( NormalSort ), mSorted( false ), mMode( FAST ),
+                mInstancingGrouping( false ), mOrderIndependentTransparency( false ) {}
         };
 
         typedef vector<IndirectBufferPacked*>::type IndirectBufferPackedVec;
 
+        /// Per-renderable data gathered by the worker threads before the main thread
+        /// records FAST render queues. @see setParallelCommandPreparation
+        struct PreparedDraw
+        {
+            VertexArrayObject   *vao;
+            Hlms                *hlms;
+            /// Null if the shaders didn't exist yet. getMaterial creates them then
+            HlmsCache const     *hlmsCache;
+        };
+
+        typedef FastArray<PreparedDraw> PreparedDrawArray;
+
+        /// Maps a range of chunks to a FAST RenderQueueGroup, so that
+        /// worker threads can find which renderables a chunk refers to.
+        struct PreparedDrawSegment
+        {
+            size_t  renderQueueId;
+            /// First chunk index that belongs to this group
+            size_t  firstChunk;
+            /// Offset into mPreparedDraws where this group starts
+            size_t  firstDraw;
+
+            static bool OrderByFirstChunk( size_t chunkIdx, const PreparedDrawSegment &segment )
+            {
+                return chunkIdx < segment.firstChunk;
+            }
+        };
+
+        typedef FastArray<PreparedDrawSegment> PreparedDrawSegmentArray;
+
+        /// Used by groupForInstancing to gather the entries that can be drawn instanced.
+        struct InstancingKey
+        {
+            VertexArrayObject const *vao;
+            HlmsDatablock const     *datablock;
+            uint32                  hlmsHash;
+            /// Position of the first entry with the same key (i.e. where the group goes)
+            uint32                  firstIdx;
+            uint32                  idx;
+
+            static bool OrderByKey( const InstancingKey &a, const InstancingKey &b )
+            {
+                if( a.vao != b.vao )
+                    return a.vao < b.vao;
+                if( a.datablock != b.datablock )
+                    return a.datablock < b.datablock;
+                if( a.hlmsHash != b.hlmsHash )
+                    return a.hlmsHash < b.hlmsHash;
+                return a.idx < b.idx;
+            }
+
+            static bool OrderByGroup( const InstancingKey &a, const InstancingKey &b )
+            {
+                if( a.firstIdx != b.firstIdx )
+                    return a.firstIdx < b.firstIdx;
+                return a.idx < b.idx;
+            }
+        };
+
+        typedef FastArray<InstancingKey> InstancingKeyArray;
+
+        enum ParallelTask
+        {
+            ParallelTaskPrepareDraws,
+            ParallelTaskRemoveRedundantCommands
+        };
+
         RenderQueueGroup mRenderQueues[256];
 
         HlmsManager *mHlmsManager;
@@ -171,6 +258,21 @@ namespace Ogre {
 
         uint32 mRenderingStarted;
 
+        bool                        mParallelCommandPreparation;
+        bool                        mPreparingCasterPass;
+        PreparedDrawArray           mPreparedDraws;
+        /// While capturing a frame, indirect draws are written here first so
+        /// they can be read back (the real buffer is write-only).
+        /// See CompositorFrameCapture
+        FastArray<unsigned char>    mCapturedIndirectDraws;
+        PreparedDrawSegmentArray    mPreparedDrawSegments;
+        WorkStealingScheduler       *mPreparedDrawScheduler;
+
+        ParallelTask                mParallelTask;
+        /// Used by RadixSort & TemporalCoherenceSort
+        RadixSort64                 mKeySort;
+        QueuedRenderableArray       mTmpQueuedRenderables;
+
         /** Returns a new (or an existing) indirect buffer that can hold the requested number of draws.
         @param numDraws
             Number of draws the indirect buffer is expected to hold. It must be an upper limit.
@@ -184,6 +286,18 @@ namespace Ogre {
                                         Renderable* pRend, const MovableObject *pMovableObject,
                                         bool isV1 );
 
+        /// Merges the per-thread queues of the given group and sorts them (if not done yet)
+        void sortRenderQueueGroup( RenderQueueGroup &renderQueueGroup, bool casterPass );
+
+        /// Tells each queued renderable's datablock how big it appears on screen.
+        /// Needs the groups in range [firstRq; lastRq) to be sorted.
+        /// @see TextureGpuManager::setMipStreaming
+        void notifyProjectedSizes( uint8 firstRq, uint8 lastRq );
+
+        /// Fills mPreparedDraws for all FAST groups in range [firstRq; lastRq)
+        /// using the worker threads.
+        void prepareDrawsParallel( uint8 firstRq, uint8 lastRq, bool casterPass );
+
         void renderES2( RenderSystem *rs, bool casterPass, bool dualParaboloid,
                         HlmsCache passCache[], const RenderQueueGroup &renderQueueGroup );
 
@@ -192,10 +306,68 @@ namespace Ogre {
         unsigned char *renderGL3( RenderSystem *rs, bool casterPass, bool dualParaboloid,
                                   HlmsCache passCache[], const RenderQueueGroup &renderQueueGroup,
                                   IndirectBufferPacked *indirectBuffer, unsigned char *indirectDraw,
-                                  unsigned char *startIndirectDraw );
+                                  unsigned char *startIndirectDraw,
+                                  const PreparedDraw *preparedDraws );
         void renderGL3V1( RenderSystem *rs, bool casterPass, bool dualParaboloid, HlmsCache passCache[],
                           const RenderQueueGroup &renderQueueGroup );
 
+    public:
+        /// @see getInstancingStats
+        struct InstancingStats
+        {
+            /// Number of renderables in the queues that were grouped
+            size_t  mNumRenderables;
+            /// Number of (indirect) draws those renderables needed in their sorted order
+            size_t  mNumDrawsBeforeGrouping;
+            /// Number of (indirect) draws they need after grouping.
+            /// mNumRenderables / mNumDrawsAfterGrouping is the average number of instances per draw
+            size_t  mNumDrawsAfterGrouping;
+
+            InstancingStats() :
+                mNumRenderables( 0 ), mNumDrawsBeforeGrouping( 0 ), mNumDrawsAfterGrouping( 0 ) {}
+        };
+
+        /// @see setOccluderSelection
+        struct OccluderSelection
+        {
+            /// When true, render only draws the opaque, depth writing, non alpha tested
+            /// v2 renderables that pass the criteria below. v1 renderables are never drawn.
+            bool    mOccludersOnly;
+            /// When true, render estimates the overdraw of the opaque renderables in the
+            /// queues. See getEstimatedOverdraw
+            bool    mEstimateOverdraw;
+            /// Minimum on-screen diameter of an occluder's bounding sphere,
+            /// as a fraction of the viewport's height
+            Real    mMinScreenSize;
+            /// Maximum number of vertices of an occluder (in its current LOD) so that
+            /// it is cheap to rasterize
+            uint32  mMaxVertices;
+
+            OccluderSelection() :
+                mOccludersOnly( false ), mEstimateOverdraw( false ),
+                mMinScreenSize( 0.1f ), mMaxVertices( 16384u ) {}
+        };
+
+    private:
+        InstancingStats         mInstancingStats;
+        InstancingStats         mLastFrameInstancingStats;
+        InstancingKeyArray      mInstancingKeys;
+
+        OccluderSelection       mOccluderSelection;
+        bool                    mOccludersSwapped;
+        Real                    mEstimatedOverdraw;
+
+        /// Picks the occluders of the sorted groups in range [firstRq; lastRq) and swaps
+        /// them into mQueuedRenderables; and/or estimates the overdraw.
+        /// See setOccluderSelection
+        void selectOccluders( uint8 firstRq, uint8 lastRq );
+        /// Undoes the swap done by selectOccluders
+        void restoreOccluders( uint8 firstRq, uint8 lastRq );
+
+        /// Reorders the opaque entries of the group so that those sharing Vao, datablock
+        /// and Hlms hash are contiguous, ignoring the depth bits of the sort key.
+        void groupForInstancing( RenderQueueGroup &renderQueueGroup, bool casterPass );
+
     public:
         RenderQueue( HlmsManager *hlmsManager, SceneManager *sceneManager, VaoManager *vaoManager );
         ~RenderQueue();
@@ -237,6 +409,9 @@ namespace Ogre {
         void addRenderableV2( size_t threadIdx, uint8 renderQueueId, bool casterPass,
                               Renderable* pRend, const MovableObject *pMovableObject );
 
+        /// @copydoc UniformScalableTask::execute
+        virtual void execute( size_t threadId, size_t numThreads );
+
         /** If you need to call RenderQueue::render, then you must call this function.
             This function MUST be called (all listed functions are called in this order):
                 1. After RenderSystem::beginRenderPassDescriptor
@@ -292,6 +467,86 @@ namespace Ogre {
         */
         void setSortRenderQueue( uint8 rqId, RqSortMode sortMode );
         RqSortMode getSortRenderQueue( uint8 rqId ) const;
+
+        /** When enabled, after sorting a FAST render queue, opaque renderables that
+            only differ in the depth bits of their sort key are reordered so that those
+            sharing the same Vao, datablock and Hlms hash (thus PSO) end up next to each
+            other and get drawn with a single instanced draw.
+        @remarks
+            Objects are still roughly sorted front to back; the position of each group is
+            that of its closest member. Transparent renderables are never reordered,
+            unless the queue uses setOrderIndependentTransparency.
+        @par
+            Useful for scenes with lots of copies of a few meshes (i.e. forests) where
+            depth sorting interleaves them. Has no effect if the queue isn't sorted.
+            Disabled by default.
+        @param rqId
+            ID of the render queue
+        */
+        void setInstancingGrouping( uint8 rqId, bool bEnable );
+        bool getInstancingGrouping( uint8 rqId ) const;
+
+        /** When enabled, transparent renderables are sorted like opaque ones (by state, then
+            front to back) instead of back to front. Meant for queues rendered by passes
+            with CompositorPassSceneDef::mOitMode, whose result doesn't depend on the order.
+        @remarks
+            Sorting by state keeps the same meshes & materials next to each other, which
+            allows instancing them (see setInstancingGrouping); and the order of a mostly
+            static scene barely changes between frames (see TemporalCoherenceSort).
+            The sort key is built when the objects are added, so
+            changes apply from the next frame. Disabled by default.
+        @param rqId
+            ID of the render queue
+        */
+        void setOrderIndependentTransparency( uint8 rqId, bool bEnable );
+        bool getOrderIndependentTransparency( uint8 rqId ) const;
+
+        /// Stats of the queues with instancing grouping enabled, gathered during
+        /// the last frame (until frameEnded was called). @see setInstancingGrouping
+        const InstancingStats& getInstancingStats(void) const  { return mLastFrameInstancingStats; }
+
+        /** Restricts what render draws, i.e. to draw only good occluders in a depth
+            prepass. Stays in effect until it's set again.
+            Used by CompositorPassSceneDef::mAutoDepthPrePass.
+        @remarks
+            The queues keep all the renderables, thus after rendering the occluders
+            with mOccludersOnly, disabling it and rendering again (i.e. reusing the
+            cull data) draws everything.
+        */
+        void setOccluderSelection( const OccluderSelection &selection );
+        const OccluderSelection& getOccluderSelection(void) const { return mOccluderSelection; }
+
+        /** Overdraw estimated by the last render call with OccluderSelection::mEstimateOverdraw:
+            the sum of the on-screen areas of the opaque renderables' bounding spheres (each
+            clamped to the viewport) divided by the viewport's area. 1.0 means the opaque
+            objects would cover the viewport once.
+        @remarks
+            It's a coarse CPU side estimate which ignores occlusion between objects.
+            It's only meant for heuristics.
+        */
+        Real getEstimatedOverdraw(void) const                   { return mEstimatedOverdraw; }
+
+        /** When enabled, before recording the commands of FAST render queues, the
+            SceneManager's worker threads walk the sorted queues in chunks and gather
+            the per-renderable data the recording loop needs (Vao, Hlms and the
+            HlmsCache lookup of Hlms::getMaterial), so the main thread doesn't stall
+            on the cache misses of chasing those pointers nor on the cache searches.
+        @remarks
+            This is not parallel command recording: only those lookups run on the
+            workers. Creating missing shaders, Hlms::fillBuffersForV2, writing the
+            indirect buffer and the CommandBuffer recording all remain on the main
+            thread, in queue order, as each Hlms writes its const & tex buffers
+            sequentially and may insert commands while doing so.
+        @par
+            Only worth it with large amounts of Items (tens of thousands) and
+            more than one worker thread. Disabled by default.
+        */
+        void setParallelCommandPreparation( bool bEnable );
+        bool getParallelCommandPreparation(void) const  { return mParallelCommandPreparation; }
+
+        /// The CommandBuffer used to record & execute the draws of this queue.
+        /// i.e. to enable CommandBuffer::setRemoveRedundantCommands or read its stats.
+        CommandBuffer* getCommandBuffer(void) const     { return mCommandBuffer; }
     };
 
     #define OGRE_RQ_MAKE_MASK( x ) ( (1 << (x)) - 1 )
@@ -825,6 +825,19 @@ namespace Ogre
         virtual void _resourceTransitionDestroyed( ResourceTransition *resTransition )  {}
         virtual void _executeResourceTransition( ResourceTransition *resTransition )    {}
 
+        /** Only called when RSC_ASYNC_COMPUTE is set. Commands issued until _endAsyncCompute
+            go to the compute queue, after waiting for the graphics work submitted so far.
+        @remarks
+            Async work never overlaps other async work; passes sent to the compute queue
+            execute in the same relative order they would have on the graphics queue.
+        */
+        virtual void _beginAsyncCompute(void)                                           {}
+        /// Switches back to the graphics queue. The compute work is flushed and a
+        /// fence is recorded so that _waitForAsyncCompute can wait for it.
+        virtual void _endAsyncCompute(void)                                             {}
+        /// Makes the graphics queue wait until all async compute work issued so far is done.
+        virtual void _waitForAsyncCompute(void)                                         {}
+
         virtual void _hlmsPipelineStateObjectCreated( HlmsPso *newPso ) {}
         virtual void _hlmsPipelineStateObjectDestroyed( HlmsPso *pso ) {}
         virtual void _hlmsMacroblockCreated( HlmsMacroblock *newBlock ) {}
@@ -1347,6 +1360,34 @@ namespace Ogre
         virtual void beginGPUSampleProfile( const String &name, uint32 *hashCache ) = 0;
         virtual void endGPUSampleProfile( const String &name ) = 0;
 
+        /// Returns true if _writeGpuTimestamp & co. are implemented. @see GpuProfiler
+        virtual bool _supportsGpuTimestamps(void) const                     { return false; }
+        /// Creates numFrames * queriesPerFrame timestamp queries,
+        /// destroying the ones created by a previous call.
+        virtual void _createGpuTimestampQueries( uint32 numFrames, uint32 queriesPerFrame ) {}
+        virtual void _destroyGpuTimestampQueries(void) {}
+        /// Must be called before the first _writeGpuTimestamp of the given frame slot.
+        virtual void _beginGpuTimestampFrame( uint32 frameIdx ) {}
+        /// Must be called after the last _writeGpuTimestamp of the given frame slot.
+        virtual void _endGpuTimestampFrame( uint32 frameIdx ) {}
+        /// Records the GPU clock once all the commands issued before have finished.
+        virtual void _writeGpuTimestamp( uint32 frameIdx, uint32 queryIdx ) {}
+        /** Reads back the first numQueries timestamps of the given frame slot, without stalling.
+        @param outNanoseconds
+            Array of numQueries elements. Timestamps are in nanoseconds and only the
+            difference between two of them is meaningful. If the API reports the
+            results are unreliable (e.g. the GPU clock changed mid-frame) they're all 0.
+        @return
+            False if the GPU hasn't finished with them yet. outNanoseconds is left untouched.
+        */
+        virtual bool _getGpuTimestamps( uint32 frameIdx, uint32 numQueries, uint64 *outNanoseconds )
+        {
+            return false;
+        }
+
+        /// Returns the GpuProfiler, creating it on first use.
+        GpuProfiler* getGpuProfiler(void);
+
         /** Determines if the system has anisotropic mip map filter support
         */
         virtual bool hasAnisotropicMipMapFilter() const = 0;
@@ -1428,6 +1469,7 @@ namespace Ogre
 
         VaoManager          *mVaoManager;
         TextureGpuManager   *mTextureGpuManager;
+        GpuProfiler         *mGpuProfiler;
 
         bool mDebugShaders;
         bool mWBuffer;
@@ -229,6 +229,9 @@ namespace Ogre
         RSC_TEXTURE_COMPRESSION_ASTC = OGRE_CAPS_VALUE(CAPS_CATEGORY_COMMON_3, 11),
         RSC_STORE_AND_MULTISAMPLE_RESOLVE = OGRE_CAPS_VALUE(CAPS_CATEGORY_COMMON_3, 12),
         RSC_DEPTH_CLAMP = OGRE_CAPS_VALUE(CAPS_CATEGORY_COMMON_3, 13),
+        /// Compute work can be submitted to a queue that runs concurrently with the
+        /// graphics queue. See CompositorPassDef::mAsyncCompute
+        RSC_ASYNC_COMPUTE = OGRE_CAPS_VALUE(CAPS_CATEGORY_COMMON_3, 14),
 
         // ***** DirectX specific caps *****
         /// Is DirectX feature "per stage constants" supported
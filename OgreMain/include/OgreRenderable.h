@@ -144,6 +144,20 @@ namespace Ogre {
 
         bool hasSkeletonAnimation(void) const               { return mHasSkeletonAnimation; }
 
+        /// True if the bone matrices are evaluated on the GPU by a GpuSkeletonEvaluator,
+        /// rather than uploaded by the Hlms. @see GpuSkeletonEvaluator::addItem
+        bool hasGpuSkeletonAnimation(void) const            { return mHasGpuSkeletonAnimation; }
+
+        /// For internal use. The Hlms hash must be recalculated after changing this value.
+        void _setGpuSkeletonAnimation( bool bGpu )          { mHasGpuSkeletonAnimation = bGpu; }
+
+        /// True if the bone matrices are read from a BakedSkeletonAnimation.
+        /// @see BakedSkeletonAnimation::addItem
+        bool hasBakedSkeletonAnimation(void) const          { return mHasBakedSkeletonAnimation; }
+
+        /// For internal use. The Hlms hash must be recalculated after changing this value.
+        void _setBakedSkeletonAnimation( bool bBaked )      { mHasBakedSkeletonAnimation = bBaked; }
+
         unsigned short getNumPoses(void) const;
         bool getPoseHalfPrecision() const;
         bool getPoseNormals() const;
@@ -153,6 +167,9 @@ namespace Ogre {
         void addPoseWeight(size_t index, float w);
         
         TexBufferPacked* getPoseTexBuffer() const;
+        /// Maps each vertex to its entry in getPoseTexBuffer. Null unless the poses are sparse
+        TexBufferPacked* getPoseIndexTexBuffer() const;
+        uint32 getNumPoseVertices() const;
         
         /** Returns whether the world matrix is an identity matrix.
         @remarks
@@ -176,6 +193,31 @@ namespace Ogre {
         */
         virtual bool getUseIdentityViewProjMatrixIsDynamic(void) const  { return false; }
 
+        /** When not null, every 4 vertices are the corners of a quad the vertex shader
+            expands from the records in this buffer instead of taking them as they are.
+            See v1::BillboardSet::getBillboardInstanceBuffer for the layout.
+        @remarks
+            Only HlmsUnlit supports it. Whether it returns null must not change while
+            the renderable is assigned to a datablock.
+        */
+        virtual TexBufferPacked* getBillboardInstanceBuffer(void) const { return 0; }
+
+        /** When not null, the vertices are chain elements the vertex shader expands
+            (and fades) using the per chain parameters in this buffer.
+            See BillboardChain::writeElement for the layout.
+        @remarks
+            Only HlmsUnlit supports it. Same restrictions as getBillboardInstanceBuffer.
+        */
+        virtual TexBufferPacked* getBillboardChainBuffer(void) const    { return 0; }
+
+        /** When not null, every 4 vertices are the corners of an octahedral impostor card
+            the vertex shader orients towards the camera, picking the closest baked frame.
+            See ImpostorBatch::writeInstances for the layout.
+        @remarks
+            Only HlmsUnlit supports it. Same restrictions as getBillboardInstanceBuffer.
+        */
+        virtual TexBufferPacked* getImpostorInstanceBuffer(void) const  { return 0; }
+
         /** Sets whether or not to use an 'identity' projection.
         @remarks
             Usually Renderable objects will use a projection matrix as determined
@@ -412,7 +454,7 @@ namespace Ogre {
 
         uint8 getCurrentMaterialLod(void) const { return mCurrentMaterialLod; }
 
-        friend void LodStrategy::lodSet( ObjectData &t, Real lodValues[ARRAY_PACKED_REALS] );
+        friend void LodStrategy::lodSet( ObjectData &t, ArrayReal lodValue );
 
         /** Sets the render queue sub group.
         @remarks
@@ -432,7 +474,9 @@ namespace Ogre {
         uint8 getRenderQueueSubGroup(void) const        { return mRenderQueueSubGroup; }
 
     protected:
-        CustomParameterMap mCustomParameters;
+        //Members read every frame by RenderQueue::addRenderable and Hlms::fillBuffersFor
+        //go first, packed together, so they share as few cache lines as possible.
+
         /// VAO to render the submesh. One per LOD level. Each LOD may or
         /// may not share the vertex and index buffers the other levels
         /// [0] = Used for regular rendering
@@ -441,17 +485,20 @@ namespace Ogre {
         /// But if they're not exactly the same VertexArrayObject pointers,
         /// then they won't share any pointer.
         VertexArrayObjectArray  mVaoPerLod[NumVertexPass];
-        uint32              mHlmsHash;
-        uint32              mHlmsCasterHash;
-        HlmsDatablock       *mHlmsDatablock;
-        MaterialPtr         mMaterial; /// Only valid when using low level materials
-        public: uint8       mCustomParameter;
+        HlmsDatablock           *mHlmsDatablock;
+        uint32                  mHlmsHash;
+        uint32                  mHlmsCasterHash;
+        FastArray<Real> const   *mLodMaterial;
+        public: uint8           mCustomParameter;
     protected:
-        uint8               mRenderQueueSubGroup;
+        uint8                   mRenderQueueSubGroup;
         bool                    mHasSkeletonAnimation;
+        bool                    mHasGpuSkeletonAnimation;
+        bool                    mHasBakedSkeletonAnimation;
         uint8                   mCurrentMaterialLod;
-        FastArray<Real> const   *mLodMaterial;
-        
+
+        //Rarely accessed members go last.
+
         /** Index in the vector holding this Rendrable reference in the HLMS datablock.
             Used for O(1) removals.
         @remarks
@@ -462,6 +509,8 @@ namespace Ogre {
         bool mPolygonModeOverrideable;
         bool mUseIdentityProjection;
         bool mUseIdentityView;
+        MaterialPtr         mMaterial; /// Only valid when using low level materials
+        CustomParameterMap mCustomParameters;
         UserObjectBindings mUserObjectBindings;      /// User objects binding.
         
         struct PoseData
@@ -469,6 +518,10 @@ namespace Ogre {
             unsigned short   numPoses;
             float            weights[OGRE_MAX_POSES];
             TexBufferPacked* buffer;
+            /// Null unless the poses are sparse. @see SubMesh::createPoses
+            TexBufferPacked* indexBuffer;
+            /// Entries per pose in buffer
+            uint32           numPoseVertices;
             bool             halfPrecision;
             bool             hasNormals;
             
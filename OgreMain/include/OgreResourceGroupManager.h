@@ -326,6 +326,9 @@ namespace Ogre {
 
         ResourceLoadingListener *mLoadingListener;
 
+        /// See setNumScriptParsingThreads
+        size_t mNumScriptParsingThreads;
+
         /// Resource index entry, resourcename->location 
         typedef map<String, Archive*>::type ResourceLocationIndex;
 
@@ -388,6 +391,16 @@ namespace Ogre {
             Called as part of initialiseResourceGroup
         */
         void parseResourceGroupScripts(ResourceGroup* grp);
+        /// Returns, for each pattern, the files matching it in every location of the group.
+        /// With more than one thread each location is searched by a different thread.
+        void findScriptFiles(ResourceGroup* grp, const StringVector &patterns, size_t numThreads,
+                             vector<FileInfoListPtr>::type &outFileLists);
+        /// Parses the files in fileLists[i] with scriptLoaders[i], in order, preparing them on
+        /// worker threads first. See setNumScriptParsingThreads. Called by parseResourceGroupScripts
+        void parseResourceGroupScriptsThreaded(ResourceGroup* grp,
+                                               const vector<ScriptLoader*>::type &scriptLoaders,
+                                               const vector<FileInfoListPtr>::type &fileLists,
+                                               size_t numThreads);
         /** Create all the pre-declared resources.
         @remarks
             Called as part of initialiseResourceGroup
@@ -1098,6 +1111,24 @@ namespace Ogre {
         /// Returns the current loading listener
         ResourceLoadingListener *getLoadingListener();
 
+        /** Sets the number of threads used while initialising a resource group to look for
+            scripts in its locations and to prepare them (see ScriptLoader::prepareScript),
+            which for Ogre's own loaders means lexing and parsing them.
+        @remarks
+            Compiling the scripts and creating what they define is still done on the calling
+            thread, one script after another and in the same order as with a single thread.
+        @par
+            Every script is opened (and ResourceLoadingListener::resourceStreamOpened called)
+            before any of them is parsed, and kept in memory until it's parsed.
+        @par
+            Scripts with errors are parsed again on the calling thread so it can raise the
+            exception, but the first attempt will have been logged from a worker thread.
+        @param numThreads
+            0 to use one thread per logical core. 1 disables threading (default).
+        */
+        void setNumScriptParsingThreads( size_t numThreads )   { mNumScriptParsingThreads = numThreads; }
+        size_t getNumScriptParsingThreads(void) const           { return mNumScriptParsingThreads; }
+
         /** Override standard Singleton retrieval.
         @remarks
         Why do we do this? Well, it's because the Singleton
@@ -57,6 +57,8 @@ namespace Ogre
 
         NumResourceLayouts
     };
+
+    const char* toString( Layout value );
     }
 
     namespace WriteBarrier
@@ -117,10 +119,12 @@ namespace Ogre
 
     const char* toString( ResourceAccess value );
     }
-
     struct ResourceTransition
     {
-        //Resource *resource; //TODO: We'll get here when D3D12/Vulkan is finished
+        /// Resource being transitioned. Null for global barriers (e.g. the merged
+        /// barrier used on non-explicit APIs). For now it is only informative
+        /// (e.g. CompositorWorkspace::dumpFrameGraph); RenderSystems don't use it yet.
+        GpuTrackedResource          *resource;
         ResourceLayout::Layout      oldLayout;
         ResourceLayout::Layout      newLayout;
 
@@ -132,6 +136,21 @@ namespace Ogre
 
     struct GpuTrackedResource
     {
+    protected:
+        uint32  mContentVersion;
+
+    public:
+        GpuTrackedResource() : mContentVersion( 0 ) {}
+        virtual ~GpuTrackedResource() {}
+
+        /// True if this resource is a TextureGpu; otherwise it's a BufferPacked.
+        virtual bool isTextureGpu(void) const               { return false; }
+
+        /// Changes every time the contents of the resource may have been modified.
+        /// Used to detect if work that depends on it can be skipped
+        /// (@see CompositorPassDef::mCacheResult)
+        uint32 getContentVersion(void) const                { return mContentVersion; }
+        void _notifyContentChanged(void)                    { ++mContentVersion; }
     };
 
     typedef StdMap<GpuTrackedResource*, ResourceLayout::Layout> ResourceLayoutMap;
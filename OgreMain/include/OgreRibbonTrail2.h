@@ -0,0 +1,221 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreRibbonTrail2_H_
+#define _OgreRibbonTrail2_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreBillboardChain2.h"
+#include "OgreNode.h"
+#include "OgreControllerManager.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Effects
+    *  @{
+    */
+
+    /** v2 version of v1::RibbonTrail. Leaves a trail behind one or more Nodes.
+    @remarks
+        Works like v1::RibbonTrail, except for:
+        - Fading (see setColourChange & setWidthChange) is done in the vertex shader,
+          so elements aren't uploaded again every frame.
+        - Instead of shrinking the tail element on the CPU, the vertex shader trims the
+          trail to its length. Thus each element is getTrailLength / (maxElements - 2)
+          long; the 2 extra elements are the growing head and the trimmed tail.
+    @par
+        The trail is updated from Node::Listener::nodeUpdated, after which the
+        SceneManager uploads the changes.
+    */
+    class _OgreExport RibbonTrail : public BillboardChain, public Node::Listener
+    {
+    public:
+        /** Constructor (don't use directly, use factory)
+        @param maxElements The maximum number of elements per chain
+        @param numberOfChains The number of separate chain segments contained in this object,
+            ie the maximum number of nodes that can have trails attached
+        */
+        RibbonTrail( IdType id, ObjectMemoryManager *objectMemoryManager, SceneManager *manager,
+                     size_t maxElements = 20, size_t numberOfChains = 1 );
+        virtual ~RibbonTrail();
+
+        typedef vector<Node*>::type NodeList;
+        typedef ConstVectorIterator<NodeList> NodeIterator;
+
+        /** Add a node to be tracked.
+        @param n The node that will be tracked.
+        */
+        virtual void addNode( Node *n );
+        /** Remove tracking on a given node. */
+        virtual void removeNode( Node *n );
+        /** Get an iterator over the nodes which are being tracked. */
+        virtual NodeIterator getNodeIterator(void) const;
+        /** Get the chain index for a given Node being tracked. */
+        virtual size_t getChainIndexForNode( const Node *n );
+
+        /** Set the length of the trail, in world units. It also sets how far
+            apart each element will be, ie length / (max_elements - 2).
+        */
+        virtual void setTrailLength( Real len );
+        /** Get the length of the trail. */
+        virtual Real getTrailLength(void) const             { return mTrailLength; }
+
+        /** @copydoc BillboardChain::setMaxChainElements */
+        virtual void setMaxChainElements( size_t maxElements );
+        /** @copydoc BillboardChain::setNumberOfChains */
+        virtual void setNumberOfChains( size_t numChains );
+        /** @copydoc BillboardChain::clearChain */
+        virtual void clearChain( size_t chainIndex );
+
+        /** Set the starting ribbon colour for a given segment.
+        @param chainIndex The index of the chain
+        @param col The initial colour
+        */
+        virtual void setInitialColour( size_t chainIndex, const ColourValue &col );
+        /** Set the starting ribbon colour.
+        @param chainIndex The index of the chain
+        @param r,b,g,a The initial colour
+        */
+        virtual void setInitialColour( size_t chainIndex, Real r, Real g, Real b, Real a = 1.0 );
+        /** Get the starting ribbon colour. */
+        virtual const ColourValue& getInitialColour( size_t chainIndex ) const;
+
+        /** Enables / disables fading the trail using colour.
+        @param chainIndex The index of the chain
+        @param valuePerSecond The amount to subtract from colour each second
+        */
+        virtual void setColourChange( size_t chainIndex, const ColourValue &valuePerSecond );
+
+        /** Set the starting ribbon width in world units.
+        @param chainIndex The index of the chain
+        @param width The initial width of the ribbon
+        */
+        virtual void setInitialWidth( size_t chainIndex, Real width );
+        /** Get the starting ribbon width in world units. */
+        virtual Real getInitialWidth( size_t chainIndex ) const;
+
+        /** Set the change in ribbon width per second.
+        @param chainIndex The index of the chain
+        @param widthDeltaPerSecond The amount the width will reduce by per second
+        */
+        virtual void setWidthChange( size_t chainIndex, Real widthDeltaPerSecond );
+        /** Get the change in ribbon width per second. */
+        virtual Real getWidthChange( size_t chainIndex ) const;
+
+        /** Enables / disables fading the trail using colour.
+        @param chainIndex The index of the chain
+        @param r,g,b,a The amount to subtract from each colour channel per second
+        */
+        virtual void setColourChange( size_t chainIndex, Real r, Real g, Real b, Real a );
+        /** Get the per-second fading amount */
+        virtual const ColourValue& getColourChange( size_t chainIndex ) const;
+
+        /// @see Node::Listener::nodeUpdated
+        virtual void nodeUpdated( const Node *node );
+        /// @see Node::Listener::nodeDestroyed
+        virtual void nodeDestroyed( const Node *node );
+
+        /// Advances the time used for fading; internal method
+        virtual void _timeUpdate( Real time );
+
+        /** Overridden from MovableObject */
+        virtual const String& getMovableType(void) const;
+
+    protected:
+        /// List of nodes being trailed
+        NodeList mNodeList;
+        /// Mapping of nodes to chain segments
+        typedef vector<size_t>::type IndexVector;
+        /// Ordered like mNodeList, contains chain index
+        IndexVector mNodeToChainSegment;
+        // chains not in use
+        IndexVector mFreeChains;
+
+        // fast lookup node->chain index
+        typedef map<const Node*, size_t>::type NodeToChainSegmentMap;
+        NodeToChainSegmentMap mNodeToSegMap;
+
+        /// Total length of trail in world units
+        Real mTrailLength;
+        /// length of each element
+        Real mElemLength;
+        /// Squared length of each element
+        Real mSquaredElemLength;
+        typedef vector<ColourValue>::type ColourValueList;
+        typedef vector<Real>::type RealList;
+        /// Initial colour of the ribbon
+        ColourValueList mInitialColour;
+        /// Initial width of the ribbon
+        RealList mInitialWidth;
+
+        /// controller used to hook up frame time to fader
+        Controller<Real>* mFadeController;
+        /// controller value for hooking up frame time to fader
+        ControllerValueRealPtr mTimeControllerValue;
+
+        /// Manage updates to the time controller
+        virtual void manageController(void);
+        /// Node has changed position, update
+        virtual void updateTrail( size_t index, const Node *node );
+        /// Reset the tracked chain to initial state
+        virtual void resetTrail( size_t index, Node *node );
+        /// Reset all tracked chains to initial state
+        virtual void resetAllTrails(void);
+        void updateElemLength(void);
+    };
+
+    /** Factory object for creating RibbonTrail instances */
+    class _OgreExport RibbonTrailFactory : public MovableObjectFactory
+    {
+    protected:
+        virtual MovableObject* createInstanceImpl( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                                   SceneManager *manager,
+                                                   const NameValuePairList* params = 0 );
+    public:
+        RibbonTrailFactory() {}
+        virtual ~RibbonTrailFactory() {}
+
+        static String FACTORY_TYPE_NAME;
+
+        const String& getType(void) const;
+        void destroyInstance( MovableObject* obj );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -51,6 +51,11 @@ namespace Ogre
     */
 
     class FrameStats;
+    class FrameMetrics;
+    class FramePacer;
+    class Barrier;
+    class LoadProfiler;
+    class GpuMemoryTracker;
     typedef vector<RenderSystem*>::type RenderSystemList;
 
     /** The root class of the Ogre system.
@@ -98,6 +103,7 @@ namespace Ogre
         ArchiveFactory *mZipArchiveFactory;
         ArchiveFactory *mEmbeddedZipArchiveFactory;
         ArchiveFactory *mFileSystemArchiveFactory;
+        ArchiveFactory *mPackArchiveFactory;
         
 #if OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
         AndroidLogListener* mAndroidLogger;
@@ -110,6 +116,11 @@ namespace Ogre
         LodStrategyManager *mLodStrategyManager;
 
         FrameStats* mFrameStats;
+        FrameMetrics* mFrameMetrics;
+        FramePacer* mFramePacer;
+        LoadProfiler* mLoadProfiler;
+        GpuMemoryTracker* mGpuMemoryTracker;
+        FrameArenaManager* mFrameArenaManager;
         Timer* mTimer;
         Window* mAutoWindow;
         Profiler* mProfiler;
@@ -125,6 +136,19 @@ namespace Ogre
         Real mDefaultMinPixelSize;
         float mLightProfilesInvHeight;
 
+        /// See setSceneGraphUpdateThreads
+        Barrier                 *mSceneGraphUpdateBarrier;
+        ThreadHandleVec         mSceneGraphUpdateThreads;
+        /// SceneManagers being updated by _updateSceneGraphThread this frame
+        FastArray<SceneManager*> mSceneGraphUpdateList;
+        bool                    mSceneGraphUpdateStop;
+
+        /// Calls SceneManager::updateSceneGraph on every SceneManager,
+        /// concurrently if setSceneGraphUpdateThreads was used.
+        void updateAllSceneGraphs(void);
+        /// Runs _updateSceneGraphConcurrent on the SceneManagers that belong to threadIdx
+        void updateSceneGraphsConcurrent( size_t threadIdx );
+
     public:
         typedef vector<DynLib*>::type PluginLibList;
         typedef vector<Plugin*>::type PluginInstanceList;
@@ -144,6 +168,8 @@ namespace Ogre
         MovableObjectFactory* mItemFactory;
         MovableObjectFactory* mLightFactory;
         MovableObjectFactory* mRectangle2DFactory;
+        MovableObjectFactory* mBillboardChain2Factory;
+        MovableObjectFactory* mRibbonTrail2Factory;
         MovableObjectFactory* mBillboardSetFactory;
         MovableObjectFactory* mManualObjectFactory;
         MovableObjectFactory* mBillboardChainFactory;
@@ -513,6 +539,21 @@ namespace Ogre
 
         const FrameStats* getFrameStats(void) const             { return mFrameStats; }
 
+        /// Per-frame counters (draw calls, uploads, culling, etc) of the last frames.
+        /// They're always collected; see FrameMetrics.
+        FrameMetrics* getFrameMetrics(void) const               { return mFrameMetrics; }
+
+        /// Frames in flight limit, late latching of cameras & latency measurements.
+        /// See FramePacer.
+        FramePacer* getFramePacer(void) const                   { return mFramePacer; }
+
+        /// Records resource loads, shader compiles and streaming stalls when enabled.
+        /// See LoadProfiler.
+        LoadProfiler* getLoadProfiler(void) const               { return mLoadProfiler; }
+
+        /// Per-subsystem GPU memory accounting. See GpuMemoryTracker.
+        GpuMemoryTracker* getGpuMemoryTracker(void) const       { return mGpuMemoryTracker; }
+
         /** Starts / restarts the automatic rendering cycle.
             @remarks
                 This method begins the automatic rendering of the scene. It
@@ -951,6 +992,31 @@ namespace Ogre
             frame times (the default).
         */
         void setFrameSmoothingPeriod(Real period) { mFrameSmoothingTime = period; }
+
+        /** Updates the scene graphs of the different SceneManagers concurrently.
+        @remarks
+            Meant for processes rendering many independent scenes (e.g. one SceneManager
+            per session in a server). Each frame, the stages of
+            SceneManager::updateSceneGraph that only touch the SceneManager's own data
+            (transforms, animations, bounds, light lists; see
+            SceneManager::_updateSceneGraphConcurrent) run in parallel: one share of the
+            SceneManagers per extra thread, plus the main thread's.
+            Each SceneManager still uses its own worker threads for its share.
+        @par
+            Culling, render queue building and command submission still happen serially
+            inside the compositor passes, since they share the Hlms & RenderSystem state.
+        @par
+            Node and SceneManager listeners triggered during that stage may be called from
+            these threads, and the profiler isn't thread safe (don't build with
+            OGRE_PROFILING when this is enabled).
+        @param numThreads
+            Number of extra threads. 0 to update serially (default).
+        */
+        void setSceneGraphUpdateThreads( size_t numThreads );
+        size_t getSceneGraphUpdateThreads(void) const   { return mSceneGraphUpdateThreads.size(); }
+
+        /// @see setSceneGraphUpdateThreads
+        unsigned long _updateSceneGraphThread( ThreadHandle *threadHandle );
         /** Gets the period over which OGRE smooths out fluctuations in frame times. */
         Real getFrameSmoothingPeriod(void) const { return mFrameSmoothingTime; }
 
@@ -0,0 +1,222 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreSceneCommandQueue_H_
+#define _OgreSceneCommandQueue_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreId.h"
+#include "OgreVector3.h"
+#include "OgreQuaternion.h"
+#include "OgreCommon.h"
+#include "OgreResourceGroupManager.h"
+#include "Threading/OgreLightweightMutex.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** Records creation & destruction of SceneNodes and Items from any thread. The SceneManager
+        executes them in the main thread at a well defined sync point: the beginning of
+        SceneManager::updateSceneGraph.
+    @remarks
+        Each thread should record into its own queue (@see SceneManager::createSceneCommandQueue).
+        Recording only takes a per-queue lock which is only contended during the sync point,
+        so threads never wait on each other.
+    @par
+        The Ids of the objects to create are returned while recording. They come from
+        ranges the main thread reserves for each queue in advance, and are the Ids the
+        objects will have once created (i.e. SceneManager::getSceneNode(id)).
+        If a queue runs out of reserved Ids before the next sync point, recording throws.
+    @par
+        Commands from the same queue are executed in the order they were recorded. Queues
+        are executed in the order they were created. Pending objects (created but not yet
+        executed) can only be referenced from the queue that recorded them, and only until
+        they get destroyed, or until SceneManager::clearScene.
+    @par
+        If a command throws during execution, the exception is propagated and that command
+        is discarded, as well as the commands referring to the pending SceneNode it failed
+        to create (and their pending children). The rest stays queued for the next execution.
+    */
+    class _OgreExport SceneCommandQueue : public SceneMgtAlloc
+    {
+        enum CommandType
+        {
+            CmdCreateSceneNode,
+            CmdCreateItem,
+            CmdDestroySceneNode,
+            CmdDestroyItem
+        };
+
+        struct Command
+        {
+            CommandType         type;
+            SceneMemoryMgrTypes sceneType;
+            /// Id of the object to create
+            IdType              id;
+            /// Pending SceneNode to use as parent / attach to. Only used if usePendingNode
+            IdType              pendingNodeId;
+            bool                usePendingNode;
+            /// Existing SceneNode to use as parent / attach to, or to destroy.
+            /// A null parent means the root node of sceneType
+            SceneNode           *sceneNode;
+            /// Item to destroy
+            Item                *item;
+            Vector3             position;
+            Quaternion          orientation;
+            Vector3             scale;
+            String              meshName;
+            String              groupName;
+
+            Command( CommandType _type );
+        };
+
+        typedef vector<Command>::type CommandVec;
+
+        typedef map<IdType, SceneNode*>::type IdToSceneNodeMap;
+
+        SceneManager        *mSceneManager;
+
+        /// Protects everything recording touches
+        LightweightMutex    mMutex;
+        CommandVec          mCommands;
+        /// Ranges of reserved Ids [next; end)
+        IdType              mNextNodeId;
+        IdType              mNodeIdEnd;
+        IdType              mNextObjectId;
+        IdType              mObjectIdEnd;
+        IdType              mNumReservedIds;
+
+        /// Main thread only
+        CommandVec          mExecutingCommands;
+        FastArray<SceneNode*>   mCreatedSceneNodes;
+        FastArray<Item*>        mCreatedItems;
+        /// SceneNodes created by this queue that are still alive, so that commands recorded
+        /// after their creation was executed can keep referring to them by Id.
+        IdToSceneNodeMap        mExecutedNodes;
+
+        IdType reserveNodeId(void);
+        IdType reserveObjectId(void);
+
+        SceneNode* findPendingNode( IdType id );
+
+        void executeCommand( const Command &cmd );
+
+        /** Called when the command pointed by failedCmd threw during _execute. It's discarded
+            along with every command depending on it; the ones that haven't been executed yet
+            are put back in mCommands, so they run on the next execution.
+        */
+        void requeueAfterFailure( CommandVec::const_iterator failedCmd );
+
+    public:
+        /// Don't call directly. @see SceneManager::createSceneCommandQueue
+        SceneCommandQueue( SceneManager *sceneManager, IdType numReservedIds );
+        ~SceneCommandQueue();
+
+        /** Records the creation of a SceneNode as a child of an existing node.
+            Can be called from any thread.
+        @param parent
+            Parent of the new node. Must exist when this queue executes.
+            Null to use the root node of the given sceneType.
+        @return
+            The Id the new SceneNode will have.
+        */
+        IdType createSceneNode( SceneNode *parent,
+                                SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC,
+                                const Vector3 &position = Vector3::ZERO,
+                                const Quaternion &orientation = Quaternion::IDENTITY,
+                                const Vector3 &scale = Vector3::UNIT_SCALE );
+
+        /// Same as createSceneNode, but the parent is a SceneNode recorded in this queue
+        IdType createSceneNodeInPending( IdType pendingParentId,
+                                         SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC,
+                                         const Vector3 &position = Vector3::ZERO,
+                                         const Quaternion &orientation = Quaternion::IDENTITY,
+                                         const Vector3 &scale = Vector3::UNIT_SCALE );
+
+        /** Records the creation of an Item, attached to an existing node.
+            Can be called from any thread.
+        @remarks
+            The mesh is loaded during execution (in the main thread) if it wasn't already.
+        @return
+            The Id the new Item will have.
+        */
+        IdType createItem( SceneNode *attachTo, const String &meshName,
+                           const String &groupName =
+                                ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+                           SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC );
+
+        /// Same as createItem, but attached to a SceneNode recorded in this queue
+        IdType createItemInPending( IdType pendingNodeId, const String &meshName,
+                                    const String &groupName =
+                                        ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+                                    SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC );
+
+        /// Records the destruction of a SceneNode. Can be called from any thread.
+        void destroySceneNode( SceneNode *sceneNode );
+
+        /// Same as destroySceneNode, but the node is a SceneNode recorded in this queue
+        void destroySceneNodeInPending( IdType pendingNodeId );
+
+        /// Records the destruction of an Item. Can be called from any thread.
+        void destroyItem( Item *item );
+
+        /// Number of commands waiting for the next execution. Can be called from any thread.
+        size_t getNumPendingCommands(void);
+
+        /// SceneNodes created by the last execution, in recording order. Main thread only.
+        const FastArray<SceneNode*>& getCreatedSceneNodes(void) const   { return mCreatedSceneNodes; }
+        /// Items created by the last execution, in recording order. Main thread only.
+        const FastArray<Item*>& getCreatedItems(void) const             { return mCreatedItems; }
+
+        /// Refills the reserved Id ranges if they're running low. Main thread only.
+        void _reserveIds(void);
+
+        /// Executes all recorded commands. Main thread only.
+        void _execute(void);
+
+        /// The SceneManager is destroying the node. Main thread only.
+        void _notifySceneNodeDestroyed( SceneNode *sceneNode );
+        /// The SceneManager destroyed all nodes. Main thread only.
+        void _notifySceneCleared(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -81,6 +81,10 @@ namespace Ogre {
     struct EntityMaterialLodChangedEvent;
     class CompositorShadowNode;
     class UniformScalableTask;
+    class WorkStealingScheduler;
+    class FrameTask;
+    class FrameTaskGraph;
+    class ObjectDataBvh;
 
     class RadialDensityMask;
 
@@ -149,19 +153,39 @@ namespace Ogre {
     struct UpdateTransformRequest
     {
         Transform t;
-        /// Number of nodes to process for each thread. Must be multiple of ARRAY_PACKED_REALS
-        size_t numNodesPerThread;
+        /// Number of nodes to process in each chunk. Must be multiple of ARRAY_PACKED_REALS
+        size_t numNodesPerChunk;
         size_t numTotalNodes;
+        /// When true, uses Node::updateDirtyTransforms. @see NodeMemoryManager::setDirtyTracking
+        bool dirtyTracking;
 
         UpdateTransformRequest() :
-            numNodesPerThread( 0 ), numTotalNodes( 0 ) {}
+            numNodesPerChunk( 0 ), numTotalNodes( 0 ), dirtyTracking( false ) {}
 
-        UpdateTransformRequest( const Transform &_t, size_t _numNodesPerThread, size_t _numTotalNodes ) :
-            t( _t ), numNodesPerThread( _numNodesPerThread ), numTotalNodes( _numTotalNodes )
+        UpdateTransformRequest( const Transform &_t, size_t _numNodesPerChunk, size_t _numTotalNodes,
+                                bool _dirtyTracking=false ) :
+            t( _t ), numNodesPerChunk( _numNodesPerChunk ), numTotalNodes( _numTotalNodes ),
+            dirtyTracking( _dirtyTracking )
         {
         }
     };
 
+    /// Built-in stages of the scene graph update. @see SceneManager::setFrameTaskGraphEnabled
+    enum FrameStage
+    {
+        /// Node transforms. Processed depth by depth
+        FrameStageTransforms,
+        /// Skeletal animations and bone transforms. Depends on FrameStageTransforms
+        FrameStageSkeletalAnimations,
+        /// TagPoints. Depends on FrameStageSkeletalAnimations
+        FrameStageTagPoints,
+        /// World AABBs of Items, Entities, etc. Depends on FrameStageTagPoints
+        FrameStageObjectBounds,
+        /// World AABBs of Lights. Depends on FrameStageTransforms
+        FrameStageLightBounds,
+        NumFrameStages
+    };
+
     struct BuildLightListRequest
     {
         size_t startLightIdx;
@@ -405,6 +429,9 @@ namespace Ogre {
         */
         bool                    mStaticEntitiesDirty;
 
+        /// Incremented every time a static Node or MovableObject is marked as dirty
+        uint32                  mStaticSceneVersion;
+
         PrePassMode             mPrePassMode;
         TextureGpuVec   mPrePassTextures;
         TextureGpu      *mPrePassDepthTexture;
@@ -426,6 +453,38 @@ namespace Ogre {
         ForwardPlusBase *mForwardPlusImpl;
         bool mBuildLegacyLightList;
 
+        PortalZoneManager *mPortalZoneManager;
+
+        /// State of a light in the global light list, as seen by the last legacy light list build.
+        struct LegacyLightState
+        {
+            Light   *light;
+            uint32  visibilityMask;
+            Sphere  boundingSphere;
+
+            bool operator < ( const LegacyLightState &other ) const
+            {
+                return light < other.light;
+            }
+        };
+        typedef FastArray<LegacyLightState> LegacyLightStateArray;
+
+        /// @see setIncrementalLegacyLightList
+        bool                    mIncrementalLegacyLightList;
+        /// False when the cached light lists of static objects can't be trusted at all
+        bool                    mLegacyLightListCacheValid;
+        /// mStaticObjectsGeneration when the static objects' light lists were last built
+        uint32                  mLegacyLightListStaticGeneration;
+        /// Sorted by pointer. Previous & current frame's global light lists.
+        LegacyLightStateArray   mLegacyLightStatePrev;
+        LegacyLightStateArray   mLegacyLightStateCurr;
+        /// Old and new bounds of every light that changed since the previous frame
+        FastArray<Sphere>       mLegacyDirtyLightSpheres;
+        /// The entities' culled list without the static memory manager
+        ObjectMemoryManagerVec  mLegacyLightListDynamicList;
+        /// Read by the worker threads in BUILD_LIGHT_LIST02. Null to rebuild every object.
+        FastArray<Sphere> const *mLegacyLightListRequestDirtySpheres;
+
         TextureGpu *mDecalsDiffuseTex;
         TextureGpu *mDecalsNormalsTex;
         TextureGpu *mDecalsEmissiveTex;
@@ -624,6 +683,8 @@ namespace Ogre {
         AnimationList mAnimationsList;
         OGRE_MUTEX(mAnimationsListMutex);
         v1::AnimationStateSet mAnimationStates;
+        /// Applies the node tracks of mAnimationStates in bulk. @see _applySceneAnimations
+        v1::NodeAnimationEvaluator *mNodeAnimationEvaluator;
 
 
         /** Internal method used by _renderSingleObject to deal with renderables
@@ -764,6 +825,25 @@ namespace Ogre {
             RenderSystem::RenderSystemContext* rsContext;
         };
 
+        /// See setCpuTiming. All values are in microseconds.
+        struct CpuTimings
+        {
+            /// When the frame task graph is enabled, it includes the animations, tag points
+            /// and bounds as well, since they're interleaved.
+            uint64 updateAllTransforms;
+            uint64 updateAllAnimations;
+            /// Includes updateAllTagPoints
+            uint64 updateAllBounds;
+            uint64 buildLightList;
+            /// Accumulated across all scene passes (shadow passes included)
+            uint64 cullFrustum;
+            /// Accumulated across all scene passes. Sorting the render queue groups.
+            uint64 renderQueueSort;
+            /// Accumulated across all scene passes. RenderQueue::render as a whole,
+            /// renderQueueSort and the Hlms' fillBuffersFor are included.
+            uint64 renderQueueRender;
+        };
+
         /** Pause rendering of the frame. This has to be called when inside a renderScene call
             (Usually using a listener of some sort)
         */
@@ -795,15 +875,18 @@ namespace Ogre {
         enum RequestType
         {
             CULL_FRUSTUM,
+            CULL_FRUSTUM_BATCH,
             UPDATE_ALL_ANIMATIONS,
             UPDATE_ALL_TRANSFORMS,
-            UPDATE_ALL_BONE_TO_TAG_TRANSFORMS,
-            UPDATE_ALL_TAG_ON_TAG_TRANSFORMS,
+            UPDATE_ALL_TAG_POINTS,
             UPDATE_ALL_BOUNDS,
             UPDATE_ALL_LODS,
+            UPDATE_ALL_PARTICLE_SYSTEMS,
             BUILD_LIGHT_LIST01,
             BUILD_LIGHT_LIST02,
             USER_UNIFORM_SCALABLE_TASK,
+            EXECUTE_FRAME_TASK_GRAPH,
+            BATCHED_SCENE_QUERY,
             STOP_THREADS,
             NUM_REQUESTS
         };
@@ -820,6 +903,186 @@ namespace Ogre {
         Barrier             *mWorkerThreadsBarrier;
         ThreadHandleVec     mWorkerThreads;
 
+        /// Hands out chunks of work to the worker threads, letting idle threads
+        /// steal from the busy ones. @see WorkStealingScheduler
+        WorkStealingScheduler   *mWorkStealingScheduler;
+        /// Number of objects/nodes processed per chunk. Multiple of ARRAY_PACKED_REALS
+        size_t                  mNumObjsPerChunk;
+
+        /// A contiguous range of ObjectData (one memory manager, one render queue)
+        /// split into chunks of mNumObjsPerChunk. @see prepareObjectDataChunks
+        struct ObjectDataSegment
+        {
+            ObjectMemoryManager *memoryManager;
+            size_t              renderQueueId;
+            size_t              totalObjs;
+            size_t              firstChunk;
+            /// When not null, each chunk is a subtree of this BVH instead of
+            /// a range of mNumObjsPerChunk objects. Only used by cullFrustum.
+            ObjectDataBvh const *bvh;
+
+            static bool OrderByFirstChunk( size_t chunkIdx, const ObjectDataSegment &r )
+            {
+                return chunkIdx < r.firstChunk;
+            }
+        };
+        typedef FastArray<ObjectDataSegment> ObjectDataSegmentArray;
+        ObjectDataSegmentArray  mObjectDataSegments;
+
+        /// Same as ObjectDataSegment, for BySkeletonDef::chunkStarts
+        struct SkeletonSegment
+        {
+            BySkeletonDef   *bySkeletonDef;
+            size_t          firstChunk;
+
+            static bool OrderByFirstChunk( size_t chunkIdx, const SkeletonSegment &r )
+            {
+                return chunkIdx < r.firstChunk;
+            }
+        };
+        typedef FastArray<SkeletonSegment> SkeletonSegmentArray;
+        SkeletonSegmentArray    mSkeletonSegments;
+
+        /// Same as ObjectDataSegment, for a single depth level of a TagPoint memory manager.
+        /// All depth levels are updated in the same pass.
+        /// @see TagPoint::updateAllTransformsFromBone
+        struct TagPointSegment
+        {
+            Transform       t;
+            size_t          numNodes;
+            size_t          depth;
+            size_t          firstChunk;
+
+            static bool OrderByFirstChunk( size_t chunkIdx, const TagPointSegment &r )
+            {
+                return chunkIdx < r.firstChunk;
+            }
+        };
+        typedef FastArray<TagPointSegment> TagPointSegmentArray;
+        TagPointSegmentArray    mTagPointSegments;
+
+        /// Built-in stages of updateSceneGraph when running as a task graph.
+        class FrameStageTask;
+        friend class FrameStageTask;
+
+        FrameTaskGraph          *mFrameTaskGraph;
+        FrameStageTask          *mFrameStageTasks[NumFrameStages];
+        bool                    mFrameTaskGraphEnabled;
+        /// @see setIncrementalBoundsUpdate
+        bool                    mIncrementalBoundsUpdate;
+
+        /// Null unless CPU timing is enabled. See setCpuTiming
+        Timer                   *mCpuTimer;
+        CpuTimings              mCpuTimings;
+
+        /// @see setParallelParticleSystemUpdates
+        bool                    mParallelParticleSystemUpdates;
+        /// Systems queued by ParticleSystem::_notifyFrameTime, updated by updateAllParticleSystems
+        FastArray<ParticleSystem*> mParticleSystemsToUpdate;
+        /// v2 chains with changes to upload, see updateAllBillboardChains
+        FastArray<BillboardChain*> mBillboardChainsToUpdate;
+
+        /// A static object that passed culling, @see setStaticCullCacheEnabled
+        typedef MovableObject::CullResultEntry StaticCullCacheEntry;
+        typedef MovableObject::CullResultEntryArray StaticCullCacheEntryArray;
+        typedef FastArray<StaticCullCacheEntryArray> StaticCullCacheEntryArrayPerThread;
+
+        /// Results of culling the static objects with a given camera,
+        /// and the state they were culled with.
+        struct StaticCullCache
+        {
+            bool                valid;
+            uint32              generation;
+            Matrix4             viewMatrix;
+            Matrix4             projectionMatrix;
+            Camera const        *lodCamera;
+            Vector3             lodCameraPos;
+            uint32              visibilityMask;
+            uint8               firstRq;
+            uint8               lastRq;
+            bool                casterPass;
+            StaticCullCacheEntryArray entries;
+
+            StaticCullCache() :
+                valid( false ), generation( 0 ), lodCamera( 0 ), visibilityMask( 0 ),
+                firstRq( 0 ), lastRq( 0 ), casterPass( false ) {}
+        };
+        typedef map<Camera const*, StaticCullCache>::type StaticCullCacheMap;
+
+        bool                    mStaticCullCacheEnabled;
+        /// Incremented whenever static objects change for any reason
+        uint32                  mStaticObjectsGeneration;
+        StaticCullCacheMap      mStaticCullCaches;
+        /// Cache being used (or filled) by the current cullFrustum request. Null if none
+        StaticCullCache         *mCurrentStaticCullCache;
+        /// When true mCurrentStaticCullCache is being reused, else it's being filled
+        bool                    mReusingStaticCullCache;
+        StaticCullCacheEntryArrayPerThread  mStaticCullCacheCapture;
+        /// Same as the culled list, but without the static memory managers
+        ObjectMemoryManagerVec  mStaticCullCacheDynamicList;
+
+        /// Results of cullFrustumBatch for a camera, and the state it was culled with.
+        /// Consumed by the next cullFrustum request of that camera.
+        struct BatchedCullResult
+        {
+            bool                valid;
+            Matrix4             viewMatrix;
+            Matrix4             projectionMatrix;
+            Camera const        *lodCamera;
+            bool                casterPass;
+            MovableObject::CullResultEntryArray entries;
+
+            BatchedCullResult() : valid( false ), lodCamera( 0 ), casterPass( false ) {}
+        };
+        /// A camera may have several results (i.e. one per cubemap face)
+        typedef vector<BatchedCullResult>::type BatchedCullResultVec;
+        typedef map<Camera const*, BatchedCullResultVec>::type BatchedCullResultMap;
+
+        /// All variables are read-only for the worker threads. @see cullFrustumBatch
+        struct CullFrustumBatchRequest
+        {
+            MovableObject::CullFrustumBatchFrustum frustums[MovableObject::c_maxCullFrustumBatch];
+            size_t                  numFrustums;
+            Camera const            *lodCamera;
+            bool                    casterPass;
+        };
+
+        bool                    mBatchedShadowCulling;
+        bool                    mBatchedCubemapCulling;
+        BatchedCullResultMap    mBatchedCullResults;
+        /// Result being replayed by the current cullFrustum request. Null if none
+        BatchedCullResult const *mCurrentBatchedCullResult;
+        CullFrustumBatchRequest mCullFrustumBatchRequest;
+        /// c_maxCullFrustumBatch arrays per thread. @see cullFrustumBatchThread
+        FastArray<MovableObject::CullResultEntryArray> mCullFrustumBatchCapture;
+
+        typedef map<std::pair<ObjectMemoryManager const*, size_t>, ObjectDataBvh*>::type
+                ObjectDataBvhMap;
+
+        bool                    mStaticCullBvhEnabled;
+        /// One per static memory manager & render queue. @see setStaticCullBvhEnabled
+        ObjectDataBvhMap        mStaticCullBvhs;
+        /// Per thread, results of ObjectDataBvh::cullSubtree
+        FastArray< FastArray<uint32> > mCullBvhVisiblePacks;
+
+        /// @see setIncrementalDefragmentation
+        size_t                  mDefragmentMaxSlotsPerFrame;
+        uint64                  mDefragmentMaxMicrosecondsPerFrame;
+        /// Memory pool where the next incremental defragmentation starts (round robin)
+        size_t                  mDefragmentNextPool;
+
+        /// Last seen LodStrategy::_getLodValuesGeneration. @see invalidateLodRanges
+        uint32                  mLodValuesGeneration;
+
+        friend class SceneCommandQueue;
+        typedef FastArray<SceneCommandQueue*> SceneCommandQueueArray;
+        /// @see createSceneCommandQueue
+        SceneCommandQueueArray  mSceneCommandQueues;
+
+        typedef FastArray<ItemPool*> ItemPoolArray;
+        /// @see createItemPool
+        ItemPoolArray           mItemPools;
+
         /** Contains MovableObjects to be visited and rendered.
         @rermarks
             Declared here to avoid allocating and deallocating every frame. Declared as array of
@@ -894,7 +1157,65 @@ namespace Ogre {
             Must be unique for each worker thread
         */
         void updateAllAnimationsThread( size_t threadIdx );
-        void updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size_t threadIdx );
+        /// Updates the queued particle systems grabbed from mWorkStealingScheduler.
+        /// @see updateAllParticleSystems
+        void updateAllParticleSystemsThread( size_t threadIdx );
+        void updateAnimationTransforms( BySkeletonDef &bySkeletonDef,
+                                        size_t firstSkeleton, size_t lastSkeleton );
+
+        /// Builds the list of skeleton chunks to process. Returns the number of chunks
+        static size_t buildSkeletonSegments( const SkeletonAnimManagerVec &skeletonAnimManagers,
+                                             SkeletonSegmentArray &outSegments );
+        /// Updates the animations & bones of all skeletons in the given chunk.
+        void updateSkeletonChunk( const SkeletonSegmentArray &segments, size_t chunkIdx );
+
+        /// Builds the list of ObjectData chunks to process. Returns the number of chunks.
+        /// @see prepareObjectDataChunks
+        static size_t buildObjectDataSegments( const ObjectMemoryManagerVec &objectMemManager,
+                                               size_t firstRq, size_t lastRq,
+                                               size_t numObjsPerChunk,
+                                               ObjectDataSegmentArray &outSegments );
+        /// Retrieves the ObjectData of the given chunk. @see grabObjectDataChunk
+        static void getObjectDataChunk( const ObjectDataSegmentArray &segments, size_t chunkIdx,
+                                        size_t numObjsPerChunk, ObjectData &outObjData,
+                                        size_t &outNumObjs, size_t &outRenderQueueId,
+                                        ObjectMemoryManager **outMemoryManager=0 );
+
+        /** Splits all the ObjectData in the given render queue range into chunks and resets
+            mWorkStealingScheduler with them. Must be called from the main thread before
+            firing the worker threads; which then must use grabObjectDataChunk.
+        @param objectMemManager
+            Memory managers of the objects to process.
+        @param firstRq
+            First RenderQueue ID to process (inclusive)
+        @param lastRq
+            Last RenderQueue ID to process (exclusive)
+        */
+        void prepareObjectDataChunks( const ObjectMemoryManagerVec &objectMemManager,
+                                      size_t firstRq, size_t lastRq );
+
+        /** Retrieves the next chunk of ObjectData to process prepared by prepareObjectDataChunks
+        @param threadIdx
+            Index of the worker thread.
+        @param outObjData [out]
+            ObjectData already advanced to the start of the chunk.
+        @param outNumObjs [out]
+            Number of objects in the chunk.
+        @param outRenderQueueId [out]
+            Render Queue the chunk belongs to.
+        @return
+            False when there's no more work left.
+        */
+        bool grabObjectDataChunk( size_t threadIdx, ObjectData &outObjData,
+                                  size_t &outNumObjs, size_t &outRenderQueueId );
+
+        /// Calls SceneNode::Listener::nodeUpdated on all nodes with listeners
+        void fireNodeUpdatedListeners(void);
+
+        /// Resets mWorkStealingScheduler with enough chunks to cover numNodes, creates the
+        /// request and fires the worker threads. Used by updateAllTransforms & co.
+        void fireUpdateTransformThreads( const Transform &t, size_t numNodes,
+                                         bool dirtyTracking=false );
 
         /** Updates the Nodes from the given request inside a thread. @See updateAllTransforms
         @param request
@@ -905,13 +1226,15 @@ namespace Ogre {
         */
         void updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx );
 
-        /// @see TagPoint::updateAllTransformsBoneToTag
-        void updateAllTransformsBoneToTagThread( const UpdateTransformRequest &request,
-                                                 size_t threadIdx );
-
-        /// @see TagPoint::updateAllTransformsTagOnTag
-        void updateAllTransformsTagOnTagThread( const UpdateTransformRequest &request,
-                                                size_t threadIdx );
+        /// Builds the list of TagPoint chunks to process, covering every depth level of
+        /// every memory manager. Returns the number of chunks
+        static size_t buildTagPointSegments( const NodeMemoryManagerVec &nodeMemoryManagers,
+                                             size_t numNodesPerChunk,
+                                             TagPointSegmentArray &outSegments );
+        /// Updates the TagPoints in the given chunk. @see TagPoint::updateAllTransformsFromBone
+        static void updateTagPointChunk( const TagPointSegmentArray &segments, size_t chunkIdx,
+                                         size_t numNodesPerChunk );
+        void updateAllTagPointsThread( size_t threadIdx );
 
         /** Updates the world aabbs from the given request inside a thread. @See updateAllTransforms
         @param threadIdx
@@ -920,6 +1243,10 @@ namespace Ogre {
         */
         void updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx );
 
+        /// Updates the world aabbs of the objects in the given chunk, using
+        /// MovableObject::updateDirtyBounds when allowed. @see setIncrementalBoundsUpdate
+        void updateBoundsChunk( const ObjectDataSegmentArray &segments, size_t chunkIdx );
+
         /**
         @param threadIdx
             Thread index so we know at which point we should start at.
@@ -927,6 +1254,32 @@ namespace Ogre {
         */
         void updateAllLodsThread( const UpdateLodRequest &request, size_t threadIdx );
 
+        /// Forces the LODs of all objects to be evaluated in the next updateAllLods.
+        /// @see ObjectData::mLodRangeMin
+        void invalidateLodRanges(void);
+
+        /// Executes all the commands recorded in mSceneCommandQueues. Main thread only.
+        void executeSceneCommandQueues(void);
+
+        /** Creates a SceneNode with an Id previously reserved by a SceneCommandQueue.
+        @remarks
+            Bypasses createSceneNodeImpl, thus SceneManagers that specialize their SceneNodes
+            will get a regular SceneNode through this path.
+        @param parent
+            Null to use the root node of sceneType.
+        */
+        SceneNode* _createSceneNodeWithId( IdType id, SceneNode *parent,
+                                           SceneMemoryMgrTypes sceneType );
+
+        /// Creates an Item with an Id previously reserved by a SceneCommandQueue.
+        Item* _createItemWithId( IdType id, const String &meshName, const String &groupName,
+                                 SceneMemoryMgrTypes sceneType );
+
+        /// Implementation of createMovableObject once the Id is known.
+        MovableObject* createMovableObjectWithId( IdType id, const String &typeName,
+                                                  ObjectMemoryManager *objectMemMgr,
+                                                  const NameValuePairList *params );
+
         /** Low level culling, culls all objects against the given frustum active cameras. This
             includes checking visibility flags (both scene and viewport's)
             @See MovableObject::cullFrustum
@@ -938,6 +1291,41 @@ namespace Ogre {
         */
         void cullFrustum( const CullFrustumRequest &request, size_t threadIdx );
 
+        /** Adds the objects from previous culling results to the render queue
+            (or mVisibleObjects) as if cullFrustum had produced them.
+        @remarks
+            Each thread processes its share of entries. Entries outside the request's
+            render queue range or that fail the visibility mask are skipped.
+        */
+        void addCullResultEntries( const MovableObject::CullResultEntryArray &entries,
+                                   const CullFrustumRequest &request, uint32 visibilityMask,
+                                   size_t threadIdx );
+
+        /** Adds the renderables of a visible object to the render queue. Objects providing
+            per-renderable Aabbs (see MovableObject::_getRenderableAabbs) get each renderable
+            culled against the camera's frustum first (except in caster passes).
+        */
+        void addRenderablesV2( size_t threadIdx, uint8 rqId, bool casterPass,
+                               MovableObject *movableObject, const Camera *camera );
+
+        /// Returns the PortalZoneManager if objects must be rejected by zone for this request.
+        /// Null otherwise.
+        const PortalZoneManager* getPortalZonesForRequest( const CullFrustumRequest &request ) const;
+
+        /// Culls all objects against every camera in mCullFrustumBatchRequest.
+        /// @see cullFrustumBatch
+        void cullFrustumBatchThread( size_t threadIdx );
+
+        /// Fills mCullFrustumBatchRequest.frustums[frustumIdx] with the camera's current frustum,
+        /// and outResult with the state needed to validate it when it gets consumed.
+        void prepareBatchedCullFrustum( const Camera *camera, size_t frustumIdx,
+                                        const Camera *lodCamera, bool casterPass,
+                                        BatchedCullResult *outResult );
+        /// Culls the first numFrustums of mCullFrustumBatchRequest.frustums and
+        /// stores the culled objects in outResults[i]
+        void fireCullFrustumBatch( size_t numFrustums, const Camera *lodCamera, bool casterPass,
+                                   BatchedCullResult * const *outResults );
+
         /** Builds a list of all lights that are visible by all queued cameras (this should be fed by
             Compositor). Then calls MovableObject::buildLightList with that list so that each
             MovableObject gets it's own sorted list of the closest lights.
@@ -950,6 +1338,17 @@ namespace Ogre {
                                      size_t threadIdx );
         void buildLightListThread02( size_t threadIdx );
 
+        /** Compares mGlobalLightList against the previous frame's, and fills
+            mLegacyDirtyLightSpheres with the bounds of the lights that were added,
+            removed, moved or changed their visibility mask.
+        @return
+            True if at least one light changed.
+        */
+        bool collectDirtyLegacyLights(void);
+        /// Runs BUILD_LIGHT_LIST02 on the given memory managers. @see MovableObject::buildLightList
+        void fireBuildLegacyLightList( const ObjectMemoryManagerVec &memoryManagers,
+                                       const FastArray<Sphere> *dirtyLightSpheres );
+
     public:
         /** Constructor.
         */
@@ -1000,6 +1399,179 @@ namespace Ogre {
 
         size_t getNumWorkerThreads() const                          { return mNumWorkerThreads; }
 
+        /** Sets the number of objects (or nodes) each worker thread grabs at once when
+            processing transforms, bounds, culling, LODs and light lists.
+        @remarks
+            Smaller values balance the load better between threads (i.e. when a few objects
+            are much more expensive than the rest) at the cost of more synchronization.
+            Idle threads steal chunks from busy ones; @see WorkStealingScheduler
+        @param numObjsPerChunk
+            Will be rounded up to a multiple of ARRAY_PACKED_REALS. Default is 256.
+        */
+        void setNumObjsPerChunk( size_t numObjsPerChunk );
+        size_t getNumObjsPerChunk(void) const                       { return mNumObjsPerChunk; }
+
+        /** When enabled, the transform, animation, tag point & bounds updates performed
+            during updateSceneGraph are executed as a dependency graph instead of serial
+            phases separated by barriers; i.e. light bounds get updated while skeletal
+            animations are still being processed, and a worker thread that finished its
+            share of a stage can move on to any other stage whose dependencies are met.
+        @remarks
+            Applications can add their own FrameTasks to the graph (@see getFrameTaskGraph),
+            and make them depend on, or be a dependency of, the built-in stages
+            (@see getFrameStageTask). For example a physics sync task can be made a
+            dependency of FrameStageTransforms.
+        @par
+            SceneNode listeners are called once the graph finished, instead of right
+            after the transforms were updated.
+        */
+        void setFrameTaskGraphEnabled( bool bEnabled );
+        bool getFrameTaskGraphEnabled(void) const                   { return mFrameTaskGraphEnabled; }
+
+        /** When enabled, updateAllBounds only recomputes the world aabb & radius of dynamic
+            objects whose parent node was recomputed this frame, or whose local bounds changed
+            (@see ObjectData::mBoundsDirty). Objects that didn't move are skipped.
+        @remarks
+            Only takes effect while dirty tracking is enabled in the dynamic NodeMemoryManager
+            (@see NodeMemoryManager::setDirtyTracking), since that is what tells which nodes
+            moved. Otherwise, and for static objects, all bounds are updated as usual.
+            Static objects are already only updated when they are flagged as dirty.
+        */
+        void setIncrementalBoundsUpdate( bool bEnabled )            { mIncrementalBoundsUpdate = bEnabled; }
+        bool getIncrementalBoundsUpdate(void) const                 { return mIncrementalBoundsUpdate; }
+
+        /** When enabled, the CPU time spent in the main stages of the frame (transforms,
+            animations, light list, culling and render queue) is measured. See getCpuTimings.
+        @remarks
+            Timing is cheap, but not free (a couple of timer queries per stage and pass),
+            thus it's disabled by default.
+        */
+        void setCpuTiming( bool bEnable );
+        bool getCpuTiming(void) const                               { return mCpuTimer != 0; }
+
+        /** Returns the timings of the current frame, i.e. they're reset when the
+            scene graph is updated and accumulate while the passes are executed.
+            Read them after Root::renderOneFrame to get a full frame.
+            All zeroes if CPU timing is disabled.
+        */
+        const CpuTimings& getCpuTimings(void) const                 { return mCpuTimings; }
+
+        /// Current time in microseconds when CPU timing is enabled, 0 otherwise.
+        uint64 _getCpuTime(void) const;
+        CpuTimings& _getCpuTimings(void)                            { return mCpuTimings; }
+
+        /** When enabled, ParticleSystems are updated in parallel by the worker threads
+            (one system per chunk, with work stealing) right after the controllers, instead
+            of one after another from their controllers in the main thread.
+        @remarks
+            The emitters, affectors and renderers of those systems (including custom ones)
+            must be safe to use from different threads as long as they belong to different
+            systems. The same goes for Math's RandomValueProvider, if one is set.
+        @par
+            Systems requesting GPU simulation (see ParticleSystem::setGpuSimulation) are
+            always updated in the main thread.
+        */
+        void setParallelParticleSystemUpdates( bool bEnabled )
+                                                    { mParallelParticleSystemUpdates = bEnabled; }
+        bool getParallelParticleSystemUpdates(void) const { return mParallelParticleSystemUpdates; }
+
+        /// Queues a particle system for updateAllParticleSystems. Called by ParticleSystem.
+        void _queueParticleSystemUpdate( ParticleSystem *system );
+        /// Removes a system from the queue, i.e. because it's being destroyed.
+        void _removeParticleSystemUpdate( ParticleSystem *system );
+
+        /// Queues a (v2) BillboardChain for updateAllBillboardChains. Called by BillboardChain.
+        void _queueBillboardChainUpdate( BillboardChain *billboardChain );
+        /// Removes a chain from the queue, i.e. because it's being destroyed.
+        void _removeBillboardChainUpdate( BillboardChain *billboardChain );
+
+        /// Returns the graph used when task graph mode is enabled. @see setFrameTaskGraphEnabled
+        FrameTaskGraph* getFrameTaskGraph(void) const               { return mFrameTaskGraph; }
+
+        /// Returns the task of a built-in stage, so that it can be used
+        /// as a dependency in FrameTaskGraph::addDependency
+        FrameTask* getFrameStageTask( FrameStage stage ) const;
+
+        /** When enabled, the results of frustum culling static objects are cached per
+            camera (including shadow mapping cameras) and reused in the following frames
+            as long as the camera, its LOD camera, the visibility masks and the static
+            objects didn't change. Only dynamic objects are culled in that case.
+        @remarks
+            Any change to static objects (creating, destroying, moving nodes,
+            notifyStaticDirty) invalidates all caches.
+            Changes that static objects normally don't require to be notified about,
+            like making a hidden object visible or changing its rendering distance need
+            a call to invalidateStaticCullCache. Hiding objects is handled automatically.
+        @par
+            Cameras with a custom culling frustum or an active HiZBuffer don't use the cache.
+        */
+        void setStaticCullCacheEnabled( bool bEnabled );
+        bool getStaticCullCacheEnabled(void) const                  { return mStaticCullCacheEnabled; }
+
+        /// Discards all cached culling results. @see setStaticCullCacheEnabled
+        void invalidateStaticCullCache(void)                        { ++mStaticObjectsGeneration; }
+
+        /** When enabled, static objects are frustum culled hierarchically using a
+            BVH (one per render queue) that is rebuilt whenever static objects change.
+            Only the packs of objects whose bounds intersect the frustum go through the
+            regular SIMD culling. @see ObjectDataBvh
+        @remarks
+            Applies to every cullFrustum request (cameras and shadow mapping cameras).
+            Dynamic objects are still culled linearly.
+        */
+        void setStaticCullBvhEnabled( bool bEnabled );
+        bool getStaticCullBvhEnabled(void) const                    { return mStaticCullBvhEnabled; }
+
+        /** Culls all objects against several cameras in a single pass, reading the scene's
+            memory once instead of once per camera. Useful when many cameras are culled
+            back to back, i.e. the cascades of a PSSM shadow map.
+        @remarks
+            The results are consumed by the next cullFrustum of each camera (i.e. when its
+            pass scene gets executed), as long as the camera didn't move, nor its
+            projection changed, and it uses the same LOD camera & caster pass setting.
+            Otherwise, the camera is culled as usual. Results are only valid until the
+            next updateSceneGraph.
+        @param cameras
+            Array of cameras. Their frustum planes must be up to date.
+        @param lodCamera
+            LOD camera the cameras will be culled with. @see MovableObject::cullFrustum
+        @param casterPass
+            True when the cameras will render shadow maps
+        */
+        void cullFrustumBatch( Camera const * const *cameras, size_t numCameras,
+                               const Camera *lodCamera, bool casterPass );
+
+        /** Same as the other overload, but culls a single camera with several orientations
+            (i.e. the six faces of a cubemap). The camera is left with its current orientation.
+            Consecutive cullFrustum requests from that camera consume the result matching
+            their orientation.
+        @param orientations
+            Array of numOrientations orientations to cull the camera with.
+        */
+        void cullFrustumBatch( Camera *camera, const Quaternion *orientations,
+                               size_t numOrientations, const Camera *lodCamera, bool casterPass );
+
+        /// Returns true if cullFrustumBatch left results for the camera not consumed yet.
+        bool _hasBatchedCullResults( const Camera *camera ) const;
+
+        /** When enabled, shadow nodes cull all their shadow mapping cameras using
+            cullFrustumBatch before rendering their passes.
+            Point lights are not batched, since their camera is rotated for each face.
+            See setBatchedCubemapCulling for those.
+        */
+        void setBatchedShadowCulling( bool bEnabled )               { mBatchedShadowCulling = bEnabled; }
+        bool getBatchedShadowCulling(void) const                    { return mBatchedShadowCulling; }
+
+        /** When enabled, the first scene pass rendering a cubemap face (i.e. environment probes
+            and point light shadow maps, see CompositorPassSceneDef::mCameraCubemapReorient)
+            culls all six faces using cullFrustumBatch, and the passes of the remaining
+            faces reuse those results.
+        @remarks
+            Only worth it if the six faces get rendered in the same frame.
+        */
+        void setBatchedCubemapCulling( bool bEnabled )              { mBatchedCubemapCulling = bEnabled; }
+        bool getBatchedCubemapCulling(void) const                   { return mBatchedCubemapCulling; }
+
         /// Finds all the movable objects with the type and name passed as parameters.
         virtual MovableObjectVec findMovableObjects( const String& type, const String& name );
 
@@ -1132,6 +1704,22 @@ namespace Ogre {
         */
         virtual void destroySceneNode(SceneNode* sn);
 
+        /** Creates a queue where SceneNodes & Items creation and destruction can be
+            recorded from any thread. @see SceneCommandQueue
+        @remarks
+            Create one queue per thread that needs to record. The commands are executed
+            at the beginning of the next updateSceneGraph, in the order the queues were
+            created.
+        @param numReservedIds
+            Number of SceneNode and Item Ids reserved each time the queue runs low. This is
+            how many creations of each type can be recorded between two updateSceneGraph.
+        */
+        SceneCommandQueue* createSceneCommandQueue( IdType numReservedIds = 1024u );
+
+        /// Destroys a queue created by createSceneCommandQueue.
+        /// Commands still pending are discarded.
+        void destroySceneCommandQueue( SceneCommandQueue *queue );
+
         /** Sets a sky, to use a particular material based on SkyMethod
         @remarks
             You can control the order in which the sky appears (for best performance render
@@ -1269,10 +1857,33 @@ namespace Ogre {
             that need ligting.
         */
         void setBuildLegacyLightList( bool bEnable );
+        bool getBuildLegacyLightList(void) const            { return mBuildLegacyLightList; }
+
+        /** When enabled (and setBuildLegacyLightList is on), the light lists of static
+            objects are cached and only rebuilt for the objects touched by a light that was
+            added, removed, moved, resized, or that changed its visibility mask.
+            Dynamic objects are always rebuilt.
+        @remarks
+            Big static scenes lit by static lights will see the cost of building the
+            legacy light list drop to almost zero.
+            Changes to a static object are detected through the same means the static
+            culling caches use: changing the visibility flags or the light mask of a
+            static object requires calling notifyStaticAabbDirty (or
+            invalidateStaticCullCache) for its light list to be rebuilt.
+        */
+        void setIncrementalLegacyLightList( bool bEnable );
+        bool getIncrementalLegacyLightList(void) const      { return mIncrementalLegacyLightList; }
 
         ForwardPlusBase* getForwardPlus(void)                       { return mForwardPlusSystem; }
         ForwardPlusBase* _getActivePassForwardPlus(void)            { return mForwardPlusImpl; }
 
+        /** Enables portal & zone visibility. See PortalZoneManager.
+            Disabling it destroys the PortalZoneManager along with its zones & portals.
+        */
+        void setPortalZonesEnabled( bool bEnable );
+        /// Null if portal zones are disabled
+        PortalZoneManager* getPortalZoneManager(void) const         { return mPortalZoneManager; }
+
         /** Sets the decal texture for diffuse. Should be a RGBA8 or similar colour format.
         @remarks
             If the emissive texture (see SceneManager::setDecalsEmissive) is the same as
@@ -1340,6 +1951,25 @@ namespace Ogre {
         /// @copydoc ArrayMemoryManager::shrinkToFit
         void shrinkToFitMemoryPools(void);
 
+        /** Defragments the node & object memory pools a bit every frame (at the beginning of
+            updateSceneGraph) instead of all at once, so that long sessions with lots of
+            creation & destruction don't end up iterating through empty slots.
+            @See ArrayMemoryManager::defragmentIncremental
+        @remarks
+            The pools are visited in round robin so that a heavily fragmented one
+            can't starve the rest.
+            The automatic (all at once) defragmentation triggered by the cleanup threshold
+            of each pool still happens; this just makes it less likely to kick in.
+        @param maxSlotsPerFrame
+            Max number of slots to shift per frame. 0 to disable.
+        @param maxMicrosecondsPerFrame
+            Max time to spend per frame. 0 for no time limit.
+        */
+        void setIncrementalDefragmentation( size_t maxSlotsPerFrame,
+                                            uint64 maxMicrosecondsPerFrame=0 );
+        size_t getIncrementalDefragmentationMaxSlots(void) const
+                                                            { return mDefragmentMaxSlotsPerFrame; }
+
         /** Create an Item (instance of a discrete mesh).
             @param
                 meshName The name of the Mesh it is to be based on (e.g. 'knot.oof'). The
@@ -1362,6 +1992,28 @@ namespace Ogre {
         /// Removes & destroys all Items.
         virtual void destroyAllItems(void);
 
+        /** Creates a pool that recycles Items of the given mesh instead of creating &
+            destroying them, for objects that are spawned very often. @see ItemPool
+        @param numPreallocated
+            Number of Items to create (hidden) right away. @see ItemPool::reserve
+        */
+        ItemPool* createItemPool( const MeshPtr &mesh, size_t numPreallocated = 0u,
+                                  SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC );
+
+        /// @copydoc createItemPool. The mesh is loaded if it is not already.
+        ItemPool* createItemPool( const String &meshName,
+                                  const String &groupName =
+                                      ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME,
+                                  size_t numPreallocated = 0u,
+                                  SceneMemoryMgrTypes sceneType = SCENE_DYNAMIC );
+
+        /// Destroys a pool created by createItemPool, along with all its Items
+        /// (including the ones still acquired) and their SceneNodes.
+        void destroyItemPool( ItemPool *itemPool );
+
+        /// Destroys all pools created by createItemPool.
+        void destroyAllItemPools(void);
+
         /// Create an WireAabb
         virtual WireAabb* createWireAabb(void);
 
@@ -1861,6 +2513,10 @@ namespace Ogre {
         */
         void notifyStaticDirty( Node *node );
 
+        /// Changes every time notifyStaticDirty or notifyStaticAabbDirty gets called.
+        /// Used by compositor passes with mCacheResult to know if the static scene changed.
+        uint32 getStaticSceneVersion(void) const            { return mStaticSceneVersion; }
+
         /** Updates all skeletal animations in the scene. This is typically called once
             per frame during render, but the user might want to manually call this function.
         @remarks
@@ -1868,6 +2524,18 @@ namespace Ogre {
         */
         void updateAllAnimations();
 
+        /** Updates the particle systems queued since the last call, in parallel.
+            Called by updateSceneGraph right after the controllers.
+            @see setParallelParticleSystemUpdates
+        */
+        void updateAllParticleSystems(void);
+
+        /** Uploads the changes of the (v2) BillboardChains queued since the last call,
+            through a single StagingBuffer. Called by updateSceneGraph after the node
+            listeners (i.e. RibbonTrail) have been fired.
+        */
+        void updateAllBillboardChains(void);
+
         /** Updates the derived transforms of all nodes in the scene. This is typically called once
             per frame during render, but the user may want to manually call this function.
         @remarks
@@ -1902,9 +2570,28 @@ namespace Ogre {
         void updateAllLods( const Camera *lodCamera, Real lodBias, uint8 firstRq, uint8 lastRq );
 
         /** Updates the scene: Perform high level culling, Node transforms and entity animations.
+        @remarks
+            Same as calling _updateSceneGraphBegin, _updateSceneGraphConcurrent and
+            _updateSceneGraphEnd in that order.
         */
         void updateSceneGraph();
 
+        /** First stage of updateSceneGraph. Touches global state (controllers, particle
+            systems, GPU buffers), thus must be called from the main thread.
+        */
+        void _updateSceneGraphBegin(void);
+
+        /** Second stage of updateSceneGraph: transforms, animations, bounds & light lists.
+            It only touches this SceneManager's data (plus whatever the node listeners do)
+            and uses its own worker threads, so different SceneManagers may run it
+            concurrently from different threads.
+            @see Root::setSceneGraphUpdateThreads
+        */
+        void _updateSceneGraphConcurrent(void);
+
+        /// Last stage of updateSceneGraph. Must be called from the main thread.
+        void _updateSceneGraphEnd(void);
+
         /** Internal method for applying animations to scene nodes.
         @remarks
             Uses the internally stored AnimationState objects to apply animation to SceneNodes.
@@ -2267,6 +2954,114 @@ namespace Ogre {
         /** Destroys a scene query of any type. */
         virtual void destroyQuery(SceneQuery* query);
 
+        /// Result of executeBatchedRayQuery, one per ray
+        struct BatchedRayQueryResult
+        {
+            /// Closest object whose world Aabb was hit. Null if nothing was hit
+            MovableObject   *movableObject;
+            /// Distance along the ray to where it enters the Aabb. 0 if it starts inside.
+            /// In world units if the ray's direction is normalised.
+            Real            distance;
+        };
+
+        /** Casts many rays at once against the world Aabbs of the objects, finding the
+            closest one hit by each ray.
+        @remarks
+            Unlike RaySceneQuery, the rays are split across the worker threads and the
+            results go to the caller's array. Objects are tested ARRAY_PACKED_REALS at a
+            time, and static objects are tested via their BVH when one is up to date
+            (see setStaticCullBvhEnabled).
+        @par
+            Like the other queries, it must be performed after the bounds have been
+            updated (i.e. after updateSceneGraph) and only tests Aabbs, not triangles.
+            It must not be called while the worker threads are busy (e.g. from a
+            listener during rendering).
+        @param rays
+            Array of numRays rays.
+        @param outResults [out]
+            Array of numRays entries; outResults[i] is the result for rays[i].
+        @param queryMask
+            Objects whose query flags don't share a bit with this mask are skipped.
+        @param firstRq
+            First render queue to test (inclusive).
+        @param lastRq
+            Last render queue to test (exclusive).
+        */
+        void executeBatchedRayQuery( const Ray *rays, size_t numRays,
+                                     BatchedRayQueryResult *outResults,
+                                     uint32 queryMask = QUERY_ENTITY_DEFAULT_MASK,
+                                     uint8 firstRq = 0, uint8 lastRq = 255 );
+
+        /** Finds, for many spheres at once, the objects whose bounding sphere intersects them.
+            @see executeBatchedRayQuery for the threading & requirements.
+        @param outObjects [out]
+            Array of numSpheres * maxResultsPerQuery entries. The objects found for
+            spheres[i] are at [i * maxResultsPerQuery; i * maxResultsPerQuery + n).
+        @param maxResultsPerQuery
+            Maximum number of objects stored per sphere. The rest are counted but dropped.
+        @param outNumResults [out]
+            Array of numSpheres entries, with the number of objects found for each sphere.
+            May be greater than maxResultsPerQuery if results were dropped.
+        */
+        void executeBatchedSphereQuery( const Sphere *spheres, size_t numSpheres,
+                                        MovableObject **outObjects, size_t maxResultsPerQuery,
+                                        uint32 *outNumResults,
+                                        uint32 queryMask = QUERY_ENTITY_DEFAULT_MASK,
+                                        uint8 firstRq = 0, uint8 lastRq = 255 );
+
+        /** Same as executeBatchedSphereQuery, against the objects' world Aabbs.
+            @see executeBatchedSphereQuery
+        */
+        void executeBatchedAabbQuery( const Aabb *aabbs, size_t numAabbs,
+                                      MovableObject **outObjects, size_t maxResultsPerQuery,
+                                      uint32 *outNumResults,
+                                      uint32 queryMask = QUERY_ENTITY_DEFAULT_MASK,
+                                      uint8 firstRq = 0, uint8 lastRq = 255 );
+
+    protected:
+        /// All variables are read-only for the worker threads. @see executeBatchedRayQuery
+        struct BatchedSceneQueryRequest
+        {
+            enum QueryType
+            {
+                QueryRays,
+                QuerySpheres,
+                QueryAabbs
+            };
+
+            QueryType               type;
+            size_t                  numQueries;
+            Ray const               *rays;
+            Sphere const            *spheres;
+            Aabb const              *aabbs;
+            BatchedRayQueryResult   *outRayResults;
+            MovableObject           **outObjects;
+            size_t                  maxResultsPerQuery;
+            uint32                  *outNumResults;
+            uint32                  queryMask;
+            uint8                   firstRq;
+            uint8                   lastRq;
+
+            BatchedSceneQueryRequest() :
+                type( QueryRays ), numQueries( 0 ), rays( 0 ), spheres( 0 ), aabbs( 0 ),
+                outRayResults( 0 ), outObjects( 0 ), maxResultsPerQuery( 0 ),
+                outNumResults( 0 ), queryMask( 0 ), firstRq( 0 ), lastRq( 0 ) {}
+        };
+
+        BatchedSceneQueryRequest mBatchedSceneQueryRequest;
+
+        void fireBatchedSceneQuery(void);
+        /// Each thread processes its share of the queries in mBatchedSceneQueryRequest
+        void batchedSceneQueryThread( size_t threadIdx );
+        /// Tests a single query of mBatchedSceneQueryRequest against numObjs objects
+        void batchedSceneQuery( ObjectData objData, size_t numObjs, size_t queryIdx );
+        /// Returns the BVH of a static memory manager's render queue if it's up to date.
+        /// Null otherwise. @see assignStaticCullBvhs
+        ObjectDataBvh const* getValidStaticCullBvh( ObjectMemoryManager *memoryManager,
+                                                    size_t renderQueue ) const;
+
+    public:
+
         typedef VectorIterator<CameraList> CameraIterator;
         typedef MapIterator<AnimationList> AnimationIterator;
 
@@ -2722,6 +3517,34 @@ namespace Ogre {
             Will block until all threads are done.
         */
         void fireCullFrustumThreads( const CullFrustumRequest &request );
+
+        /** Decides whether the static objects of the request can reuse a StaticCullCache.
+            If so, removes static memory managers from the request; otherwise prepares
+            the cache to be filled by the worker threads.
+        */
+        void prepareStaticCullCache( CullFrustumRequest &inOutRequest );
+        /// Stores what the worker threads collected in prepareStaticCullCache (if anything)
+        void finishStaticCullCache(void);
+
+        /// Adds the visible & culled objects per render queue (from mVisibleObjects)
+        /// to the Root's FrameMetrics, after culling.
+        void collectCullMetrics( uint8 firstRq, uint8 lastRq );
+
+        /// Called every frame. @see setIncrementalDefragmentation
+        void defragmentMemoryPoolsIncremental(void);
+
+        /// Makes static segments in mObjectDataSegments use (and build if out of date)
+        /// their ObjectDataBvh, then resets mWorkStealingScheduler accordingly
+        void assignStaticCullBvhs(void);
+
+        /// Culls the objects in a subtree of segment.bvh
+        void cullFrustumBvh( const ObjectDataSegment &segment, size_t subtreeIdx,
+                             const Camera *camera, uint32 visibilityMask,
+                             MovableObject::MovableObjectArray &outVisibleObjects,
+                             const Camera *lodCamera, size_t threadIdx );
+
+        void destroyStaticCullBvhs(void);
+
         void startWorkerThreads();
         void stopWorkerThreads();
 
@@ -234,6 +234,12 @@ namespace Ogre
         bool compile(const String &str, const String &source, const String &group);
         /// Compiles resources from the given concrete node list
         bool compile(const ConcreteNodeListPtr &nodes, const String &group);
+        /** Compiles resources from the given concrete node list, which was parsed from
+            'source' whose text hashes to sourceHash (see _hashScriptSource).
+            The resulting AST is saved to the AST cache if enabled (see setAstCacheFolder).
+        */
+        bool compile(const ConcreteNodeListPtr &nodes, const String &source, uint32 sourceHash,
+                     const String &group);
         /// Generates the AST from the given string script
         AbstractNodeListPtr _generateAST(const String &str, const String &source, bool doImports = false, bool doObjects = false, bool doVariables = false);
         /// Compiles the given abstract syntax tree
@@ -246,6 +252,26 @@ namespace Ogre
         ScriptCompilerListener *getListener();
         /// Returns the resource group currently set for this compiler
         const String &getResourceGroup() const;
+
+        /** Sets the folder where the AST of compiled scripts is cached, so compiling the same
+            script again doesn't need to lex, parse nor resolve its imports, inheritance and
+            variables. Translation proceeds as usual. Empty string disables it (default).
+        @remarks
+            Each script gets its own file in the folder, keyed by its name. It's only used if
+            the hash of the script, the hash of every script it imports, and the Ogre version
+            all match those it was created with. Otherwise it gets overwritten.
+        @par
+            The cache is bypassed while a ScriptCompilerListener is set, as listeners can alter
+            the tree during conversion and imports.
+        */
+        void setAstCacheFolder(const String &folder);
+        const String& getAstCacheFolder() const;
+
+        /// Hash of the script's text the AST cache is keyed by.
+        static uint32 _hashScriptSource(const String &str);
+        /// Returns true if the folder has an AST cache for the given script contents.
+        /// Imported scripts aren't checked. Can be called from any thread.
+        static bool _hasAstCache(const String &folder, const String &source, uint32 sourceHash);
         /// Adds a name exclusion to the map
         /**
          * Name exclusions identify object types which cannot accept
@@ -289,6 +315,15 @@ namespace Ogre
         bool isNameExcluded(const String &cls, AbstractNode *parent);
         /// This function sets up the initial values in word id map
         void initWordMap();
+        /// Runs the translators on the processed AST
+        void translate(const AbstractNodeListPtr &ast);
+    private: // AST cache
+        bool isAstCacheEnabled() const;
+        static String getAstCacheFilename(const String &folder, const String &source);
+        /// Loads the AST of the given script if the cache is still valid for it
+        bool loadAstCache(const String &source, uint32 sourceHash, AbstractNodeListPtr &outNodes);
+        /// Saves the AST of the script set in mAstCacheSource
+        void saveAstCache(const AbstractNodeListPtr &nodes);
     private:
         // Resource group
         String mGroup;
@@ -315,6 +350,14 @@ namespace Ogre
 
         // The listener
         ScriptCompilerListener *mListener;
+
+        String mAstCacheFolder;
+        // Name and hash of the script being compiled, when its AST has to be cached
+        String mAstCacheSource;
+        uint32 mAstCacheSourceHash;
+        // Scripts imported by it, and their hash
+        typedef vector< std::pair<String, uint32> >::type AstCacheDependencyVec;
+        AstCacheDependencyVec mAstCacheDependencies;
     private: // Internal helper classes and processors
         class AbstractTreeBuilder
         {
@@ -413,6 +456,9 @@ namespace Ogre
         // A pointer to the listener used for compiling scripts
         ScriptCompilerListener *mListener;
 
+        // Folder used by compiler instances to cache ASTs
+        String mAstCacheFolder;
+
         // Stores a map from object types to the translators that handle them
         vector<ScriptTranslatorManager*>::type mManagers;
 
@@ -430,6 +476,10 @@ namespace Ogre
         /// Returns the currently set listener used for compiler instances
         ScriptCompilerListener *getListener();
 
+        /// Sets the AST cache folder used by compiler instances. See ScriptCompiler::setAstCacheFolder
+        void setAstCacheFolder(const String &folder);
+        const String& getAstCacheFolder() const;
+
         /// Adds the given translator manager to the list of managers
         void addTranslatorManager(ScriptTranslatorManager *man);
         /// Removes the given translator manager from the list of managers
@@ -458,6 +508,11 @@ namespace Ogre
         const StringVector& getScriptPatterns(void) const;
         /// @copydoc ScriptLoader::parseScript
         void parseScript(DataStreamPtr& stream, const String& groupName);
+        /// @copydoc ScriptLoader::prepareScript
+        virtual PreparedScript* prepareScript(DataStreamPtr& stream, const String& groupName);
+        /// @copydoc ScriptLoader::parsePreparedScript
+        virtual void parsePreparedScript(PreparedScript *preparedScript, DataStreamPtr& stream,
+                                         const String& groupName);
         /// @copydoc ScriptLoader::getLoadingOrder
         Real getLoadingOrder(void) const;
 
@@ -821,6 +876,7 @@ namespace Ogre
             ID_CONNECT_OUTPUT,
             ID_CONNECT_EXTERNAL,
             ID_CONNECT_BUFFER_EXTERNAL,
+            ID_ALIAS_TRANSIENT_TEXTURES,
         ID_COMPOSITOR_NODE,
             ID_IN,
             ID_OUT,
@@ -858,6 +914,7 @@ namespace Ogre
                 ID_MSAA_AUTO,
                 ID_EXPLICIT_RESOLVE,
                 ID_REINTERPRETABLE,
+                ID_KEEP_CONTENT,
                 ID_DEPTH_POOL,
                 ID_DEPTH_TEXTURE,
                 ID_DEPTH_FORMAT,
@@ -899,7 +956,10 @@ namespace Ogre
                     //ID_COLOUR_WRITE,
                     ID_EXPOSE,
                     ID_SHADOW_MAP_FULL_VIEWPORT,
+                    ID_SHADOW_MAP_CACHE,
                     ID_PROFILING_ID,
+                    ID_ASYNC,
+                    ID_CACHE_RESULT,
 
                     //Used by PASS_SCENE
                     ID_LOD_BIAS,
@@ -920,11 +980,17 @@ namespace Ogre
                     ID_IS_PREPASS,
                     ID_USE_PREPASS,
                     ID_GEN_NORMALS_GBUFFER,
+                    ID_GEN_GBUFFER,
+                    ID_GEN_MOTION_VECTORS,
+                    ID_TEMPORAL_JITTER,
                     ID_USE_REFRACTIONS,
                     ID_UV_BAKING,
                     ID_UV_BAKING_OFFSET,
                     ID_BAKE_LIGHTING_ONLY,
                     ID_INSTANCED_STEREO,
+                    ID_RADIAL_DENSITY_MASK,
+                    ID_AUTO_DEPTH_PREPASS,
+                    ID_OIT,
 
                     //Used by PASS_QUAD
                     ID_USE_QUAD,
@@ -935,6 +1001,7 @@ namespace Ogre
                         ID_CAMERA_FAR_CORNERS_WORLD_SPACE,
                         ID_CAMERA_FAR_CORNERS_WORLD_SPACE_CENTERED,
                         ID_CAMERA_DIRECTION,
+                    ID_REPROJECT,
                     ID_INPUT,
 
 
@@ -984,14 +1051,18 @@ namespace Ogre
 
                     //Used by PASS_COMPUTE
                     ID_JOB,
+                    ID_FORWARD_PLUS_LIGHTS,
 
                     //Used by PASS_MIPMAP
                     ID_MIPMAP_METHOD,
                         ID_API_DEFAULT,
                         //ID_COMPUTE,
                         ID_COMPUTE_HQ,
+                        ID_COMPUTE_SINGLE_PASS,
                     ID_KERNEL_RADIUS,
                     ID_GAUSS_DEVIATION,
+                    ID_MIPMAP_REDUCTION,
+                        ID_AVERAGE,
 
                     //Used by IBL_SPECULAR
                     ID_SAMPLES_PER_ITERATION,
@@ -77,6 +77,37 @@ namespace Ogre {
         */
         virtual void parseScript(DataStreamPtr& stream, const String& groupName) = 0;
 
+        /// Result of prepareScript. See parsePreparedScript.
+        class _OgreExport PreparedScript : public ResourceAlloc
+        {
+        public:
+            virtual ~PreparedScript() {}
+        };
+
+        /** Performs the part of parseScript that doesn't depend on anything but the script
+            itself (i.e. tokenizing), so it can run on a worker thread.
+        @remarks
+            Called by ResourceGroupManager when script parsing is threaded (see
+            ResourceGroupManager::setNumScriptParsingThreads). Implementations must not
+            access any shared state.
+        @param stream
+            Stream with the script. It's always a MemoryDataStream, only accessed by this thread.
+        @return
+            The prepared script, which parsePreparedScript will receive from the main thread,
+            in the same order the scripts would've been parsed. Null if preparing isn't
+            supported (the default) or failed, in which case parseScript gets called instead.
+        */
+        virtual PreparedScript* prepareScript( DataStreamPtr &stream, const String &groupName )
+                                                                                { return 0; }
+
+        /** Finishes what prepareScript started, i.e. creates whatever the script defines.
+            Called from the main thread.
+        @param preparedScript
+            The value returned by prepareScript. The caller deletes it afterwards.
+        */
+        virtual void parsePreparedScript( PreparedScript *preparedScript, DataStreamPtr &stream,
+                                          const String &groupName ) {}
+
         /** Gets the relative loading order of scripts of this type.
         @remarks
             There are dependencies between some kinds of scripts, and to enforce
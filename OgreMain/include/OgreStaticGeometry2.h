@@ -0,0 +1,320 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreStaticGeometry2_H_
+#define _OgreStaticGeometry2_H_
+
+#include "OgrePrerequisites.h"
+
+#include "OgreMovableObject.h"
+#include "OgreRenderable.h"
+#include "OgreMesh2.h"
+#include "Vao/OgreVertexBufferPacked.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Scene
+    *  @{
+    */
+
+    /** v2 version of v1::StaticGeometry. Merges many Items into a few big batches.
+    @remarks
+        The world is split in a grid of regions (see setRegionDimensions). Every region
+        is a MovableObject with its own Aabb (thus culled on its own) and LOD, and
+        contains one Batch per datablock + vertex format used by the Items in it.
+        A Batch holds the merged vertex buffers of all those SubMeshes, and one index
+        buffer per LOD level.
+    @par
+        Only indexed or non-indexed triangle lists without skeletons are supported.
+        The LOD levels of a region are the highest of each level among the meshes in
+        it (like v1::StaticGeometry); meshes with fewer levels use their last one.
+        The Items' shadow mapping VAOs are not used, batches render the same
+        geometry in shadow passes.
+    @par
+        The merged buffers are BT_IMMUTABLE, thus with GL3+ they go into the static mega
+        buffer when enabled (see "VaoManager::StaticMegaBufferSize"). Batches sharing
+        vertex format and buffer can then be rendered with a single indirect draw.
+    @par
+        Building has three steps: downloading the meshes from the GPU (once per SubMesh,
+        no matter how many times it was added), merging them on the CPU, and creating
+        the GPU buffers. buildAsync runs the merging in a background thread.
+    @par
+        Create it with OGRE_NEW (and destroy it with OGRE_DELETE before the SceneManager).
+        The source Items aren't needed once added; destroy or detach them.
+    */
+    class _OgreExport StaticGeometry : public BatchedGeometryAlloc
+    {
+    public:
+        class Region;
+
+        /// Merged geometry of all the SubMeshes in a Region that share datablock,
+        /// vertex format and operation type. There's one VAO per LOD level.
+        class _OgreExport Batch : public Renderable, public BatchedGeometryAlloc
+        {
+            Region *mParent;
+
+        public:
+            Batch( Region *parent, const VertexArrayObjectArray &vaos );
+
+            /// Destroys the VAOs and their buffers
+            void _destroyVaos( VaoManager *vaoManager );
+
+            virtual const LightList& getLights(void) const;
+            virtual void getRenderOperation( v1::RenderOperation &op, bool casterPass );
+            virtual void getWorldTransforms( Matrix4 *xform ) const;
+            virtual bool getCastsShadows(void) const;
+        };
+
+        typedef FastArray<Batch*> BatchArray;
+
+        /// A cell of the grid. Its node is at the cell's centre,
+        /// and its vertices are relative to it.
+        class _OgreExport Region : public MovableObject
+        {
+            friend class StaticGeometry;
+
+            uint32      mRegionId;
+            Vector3     mCentre;
+            SceneNode   *mNode;
+            BatchArray  mBatches;
+            FastArray<Real> mLodValues;
+
+        public:
+            Region( IdType id, ObjectMemoryManager *objectMemoryManager, SceneManager *manager,
+                    uint32 regionId, const Vector3 &centre );
+            virtual ~Region();
+
+            uint32 getRegionId(void) const                  { return mRegionId; }
+            const Vector3& getCentre(void) const            { return mCentre; }
+
+            size_t getNumBatches(void) const                { return mBatches.size(); }
+            Batch* getBatch( size_t idx ) const             { return mBatches[idx]; }
+
+            virtual const String& getMovableType(void) const;
+        };
+
+        typedef map<uint32, Region*>::type RegionMap;
+        typedef MapIterator<RegionMap> RegionIterator;
+
+    protected:
+        struct QueuedItem
+        {
+            MeshPtr     mesh;
+            /// Per SubMesh
+            FastArray<HlmsDatablock*> datablocks;
+            Vector3     position;
+            Quaternion  orientation;
+            Vector3     scale;
+            /// Centre of the world space Aabb, decides the region
+            Vector3     worldCentre;
+        };
+        typedef vector<QueuedItem>::type QueuedItemVec;
+
+        /// CPU copy of a SubMesh, downloaded once no matter how many times it was queued
+        struct SubMeshGeometry
+        {
+            /// Vertices of one or more LODs (LODs usually share the vertex buffers)
+            struct VertexSet
+            {
+                const VertexBufferPacked *source;
+                uint32 numVertices;
+                /// One per vertex buffer
+                vector< FastArray<uint8> >::type data;
+            };
+            struct Lod
+            {
+                uint32 vertexSet;
+                /// Relative to the start of the set
+                FastArray<uint32> indices;
+            };
+
+            VertexElement2VecVec        vertexElements;
+            OperationType               operationType;
+            vector<VertexSet>::type     vertexSets;
+            vector<Lod>::type           lods;
+        };
+        typedef vector<SubMeshGeometry>::type SubMeshGeometryVec;
+
+        /// Data of a Batch before it gets uploaded
+        struct BatchData
+        {
+            HlmsDatablock   *datablock;
+            uint32          firstGeometry;
+            /// Pairs of (index in mQueuedItems, index in mGeometries)
+            FastArray<uint32> entries;
+
+            /// Filled by mergeBatch
+            uint32          numVertices;
+            vector< FastArray<uint8> >::type    vertexData;
+            vector< FastArray<uint32> >::type   lodIndices;
+            /// Relative to the region's centre
+            Vector3         aabbMin;
+            Vector3         aabbMax;
+        };
+
+        struct RegionData
+        {
+            uint32                  regionId;
+            Vector3                 centre;
+            FastArray<Real>         lodValues;
+            vector<BatchData>::type batches;
+        };
+        typedef vector<RegionData>::type RegionDataVec;
+
+        String          mName;
+        SceneManager    *mSceneManager;
+        Vector3         mRegionDimensions;
+        Vector3         mHalfRegionDimensions;
+        Vector3         mOrigin;
+        Real            mUpperDistance;
+        bool            mCastShadows;
+        bool            mVisible;
+        uint8           mRenderQueueId;
+        uint32          mVisibilityFlags;
+
+        QueuedItemVec   mQueuedItems;
+
+        /// Temporary data used while building
+        SubMeshGeometryVec  mGeometries;
+        map<const SubMesh*, uint32>::type mGeometryLookup;
+        RegionDataVec       mRegionData;
+
+        RegionMap       mRegions;
+
+        ThreadHandlePtr mMergeThread;
+        LightweightMutex mMergeMutex;
+        /// Protected by mMergeMutex
+        bool            mMergeFinished;
+        bool            mBuilding;
+
+        uint32 getRegionId( const Vector3 &point ) const;
+        Vector3 getRegionCentre( uint32 regionId ) const;
+
+        /// Downloads the SubMesh from the GPU, if it wasn't already
+        uint32 getGeometry( const SubMesh *subMesh );
+        static void downloadSubMesh( const SubMesh *subMesh, SubMeshGeometry &outGeometry );
+        static void checkVertexFormat( const VertexElement2VecVec &vertexElements,
+                                       const String &meshName );
+
+        /// Sorts the queued Items into mRegionData (main thread)
+        void prepareRegionData(void);
+        /// Merges the geometry of every batch. Doesn't touch the GPU nor the SceneManager
+        void mergeAll(void);
+        void mergeBatch( const RegionData &region, BatchData &batch );
+        static void transformVertices( uint8 * RESTRICT_ALIAS vertexData, size_t numVertices,
+                                       const VertexElement2Vec &vertexElements,
+                                       const Matrix4 &transform, const Matrix3 &normalTransform,
+                                       const Quaternion &orientation, bool flipReflection,
+                                       Vector3 &inOutMin, Vector3 &inOutMax );
+        /// Creates the Regions from mRegionData, and frees it (main thread)
+        void createRegions(void);
+        Batch* createBatch( Region *region, const BatchData &batchData );
+
+    public:
+        StaticGeometry( const String &name, SceneManager *sceneManager );
+        virtual ~StaticGeometry();
+
+        const String& getName(void) const                   { return mName; }
+
+        /** Adds the meshes of an Item to the geometry, with the given transform.
+        @remarks
+            The Item's current datablocks are used, and its mesh is kept alive until
+            reset is called.
+        */
+        void addItem( Item *item, const Vector3 &position,
+                      const Quaternion &orientation = Quaternion::IDENTITY,
+                      const Vector3 &scale = Vector3::UNIT_SCALE );
+
+        /** Adds every Item attached to the node and its children,
+            with their derived transforms.
+        */
+        void addSceneNode( SceneNode *node );
+
+        /// Builds the regions of all the queued Items. Destroys the previous ones.
+        void build(void);
+
+        /** Downloads the queued meshes now, and merges them in a background thread.
+            Call updateAsyncBuild every frame until it returns true, or waitForAsyncBuild.
+            Nothing can be added or changed meanwhile.
+        */
+        void buildAsync(void);
+        /// Creates the regions if the background merge finished. Returns true if built
+        bool updateAsyncBuild(void);
+        void waitForAsyncBuild(void);
+        bool isBuilding(void) const                         { return mBuilding; }
+
+        /// Destroys the regions, keeping the queued Items so that build can be called again
+        void destroy(void);
+        /// Destroys the regions and clears the queue
+        void reset(void);
+
+        /** Sets the size of a single region, i.e. the granularity of the culling.
+            Takes effect on the next build. Regions are indexed with 10 bits per axis,
+            relative to the origin (see setOrigin).
+        */
+        void setRegionDimensions( const Vector3 &size );
+        const Vector3& getRegionDimensions(void) const      { return mRegionDimensions; }
+        void setOrigin( const Vector3 &origin );
+        const Vector3& getOrigin(void) const                { return mOrigin; }
+
+        /// @copydoc MovableObject::setRenderingDistance
+        void setRenderingDistance( Real dist );
+        Real getRenderingDistance(void) const               { return mUpperDistance; }
+
+        void setCastShadows( bool castShadows );
+        bool getCastShadows(void) const                     { return mCastShadows; }
+
+        void setVisible( bool visible );
+        bool isVisible(void) const                          { return mVisible; }
+
+        void setRenderQueueGroup( uint8 queueId );
+        uint8 getRenderQueueGroup(void) const               { return mRenderQueueId; }
+
+        void setVisibilityFlags( uint32 flags );
+        uint32 getVisibilityFlags(void) const               { return mVisibilityFlags; }
+
+        RegionIterator getRegionIterator(void);
+
+        /// Internal, run by the background thread
+        void _mergeThread(void);
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -31,6 +31,8 @@ THE SOFTWARE.
 #include "OgrePrerequisites.h"
 
 #include "OgreVertexBoneAssignment.h"
+#include "OgreVector3.h"
+#include "Math/Simple/OgreAabb.h"
 #include "Vao/OgreVertexArrayObject.h"
 #include "OgreHeaderPrefix.h"
 
@@ -65,6 +67,38 @@ namespace Ogre {
         typedef FastArray<unsigned short> IndexMap;
         typedef vector<VertexBoneAssignment>::type VertexBoneAssignmentVec;
 
+        /** A cluster of up to a few hundred triangles of LOD 0, with the bounds
+            needed to cull it as a whole (see buildMeshlets).
+        @remarks
+            A meshlet is a contiguous range of the index buffer, hence rendering
+            only the visible meshlets of a SubMesh doesn't require touching
+            its vertex or index buffers.
+        */
+        struct Meshlet
+        {
+            /// Range of LOD 0's index buffer, in indices (not triangles).
+            /// It's absolute, i.e. it already includes the Vao's primitive start.
+            uint32  indexStart;
+            uint32  indexCount;
+            /// Bounding sphere, in mesh space.
+            Vector3 center;
+            Real    radius;
+            /// Normal cone. coneCutoff is the sine of the cone's half angle; a value
+            /// of 1 means the cluster can't be backface culled.
+            Vector3 coneAxis;
+            Real    coneCutoff;
+
+            /// Returns true if every triangle in this cluster is facing away from
+            /// a camera located at cameraPos (in mesh space).
+            bool isBackfacing( const Vector3 &cameraPos ) const
+            {
+                const Vector3 viewDir = center - cameraPos;
+                return viewDir.dotProduct( coneAxis ) >= coneCutoff * viewDir.length() + radius;
+            }
+        };
+
+        typedef vector<Meshlet>::type MeshletVec;
+
         /// VAO to render the submesh. One per LOD level. Each LOD may or
         /// may not share the vertex and index buffers the other levels
         /// [0] = Used for regular rendering
@@ -114,6 +148,17 @@ namespace Ogre {
         bool mPoseNormals;
         std::map<Ogre::String, size_t> mPoseIndexMap;
         TexBufferPacked *mPoseTexBuffer;
+        /// When not null, poses are sparse: maps each vertex to its entry in mPoseTexBuffer
+        /// (PFG_R32_UINT). Entry 0 holds zeroes for the vertices that no pose moves.
+        TexBufferPacked *mPoseIndexTexBuffer;
+        /// Number of entries per pose in mPoseTexBuffer. Equals the number of
+        /// vertices unless the poses are sparse.
+        uint32 mNumPoseVertices;
+
+        MeshletVec mMeshlets;
+
+        /// Bounds of LOD 0 in mesh space. Aabb::BOX_NULL when unknown. @see computeAabb
+        Aabb mAabb;
 
     public:
         SubMesh();
@@ -187,13 +232,36 @@ namespace Ogre {
         void setMaterialName( const String &name )          { mMaterialName = name; }
         String getMaterialName(void) const                  { return mMaterialName; }
 
-        /// Imports a v1 SubMesh @See Mesh::importV1. Automatically performs what arrangeEfficient does.
-        void importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents, bool halfPose );
+        /// Vertex data of one pass of a v1 SubMesh already converted via _arrangeEfficient
+        /// (i.e. from a worker thread, see V1MeshConverter), so that importFromV1 only has
+        /// to create the GPU buffers.
+        struct ArrangedVertexData
+        {
+            /// Allocated with OGRE_MALLOC_SIMD. importFromV1 takes ownership and sets it to null.
+            char                *data;
+            VertexElement2Vec   vertexElements;
+
+            ArrangedVertexData() : data( 0 ) {}
+        };
+
+        /** Imports a v1 SubMesh @See Mesh::importV1. Automatically performs what arrangeEfficient does.
+        @param arranged
+            Optional. Array of NumVertexPass entries with the vertex data already arranged for
+            each pass. Entries with null data are arranged here. Entries that weren't needed
+            (i.e. the shadow pass when it's not independent) are left untouched and must be
+            freed by the caller.
+        */
+        void importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                           bool halfPose, ArrangedVertexData *arranged = 0 );
 
         /// Converts this SubMesh to an efficient arrangement. @See Mesh::importV1 for an
         /// explanation on the parameters. @see dearrangeEfficientToInefficient
         /// to perform the opposite operation.
-        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents );
+        /// When unormTexCoords is true, UV sets with 2 or 4 components whose values are all
+        /// in range [0; 1] are converted to 16-bit unorm, which takes precedence over
+        /// halfTexCoords. UVs outside that range (e.g. tiling) are left untouched.
+        void arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                               bool unormTexCoords = false );
 
         /// Reverts the effects from arrangeEfficient by converting all 16-bit half float back
         /// to 32-bit float; and QTangents to Normal, Tangent + Reflection representation,
@@ -201,6 +269,75 @@ namespace Ogre {
         void dearrangeToInefficient(void);
 
         void _prepareForShadowMapping( bool forceSameBuffers );
+
+        /** Splits LOD 0 into clusters of triangles (meshlets), each with a bounding
+            sphere and normal cone so that they can be frustum and backface culled
+            independently. Useful for very big meshes which are mostly off-screen
+            or facing away from the camera.
+        @remarks
+            Triangles are grouped in the order they appear in the index buffer, so
+            the index buffer is left untouched and the meshlets are as spatially
+            coherent as that order is. Run a vertex cache optimizer first for best
+            results.
+        @par
+            Only indexed triangle lists are supported. Other operation types or
+            non-indexed submeshes are left without meshlets.
+        @par
+            Meshlets are exported by the MeshSerializer, but they're not kept up
+            to date if the index buffer of LOD 0 is later replaced.
+        @param maxVertices
+            Max number of unique vertices referenced by each meshlet.
+        @param maxTriangles
+            Max number of triangles per meshlet.
+        */
+        void buildMeshlets( uint32 maxVertices = 64u, uint32 maxTriangles = 124u );
+
+        /** Reorders the triangles and vertices of every LOD to render faster.
+            See MeshOptimiser for the details of each pass.
+        @remarks
+            Only LODs with indexed triangle lists are touched. Vertices are only
+            reordered if all LODs share the same vertex buffers and the submesh has
+            no poses (the pose buffer is indexed by vertex).
+            Meshlets are cleared since they depend on the triangle order; call
+            buildMeshlets again afterwards if needed.
+            Shadow mapping Vaos are regenerated.
+        @param vertexCache
+            Reorders triangles for post-transform vertex cache efficiency.
+        @param overdraw
+            Reorders clusters of triangles to reduce overdraw. Run after vertexCache.
+        @param vertexFetch
+            Reorders vertices in the order they're first referenced by LOD 0.
+        */
+        void optimise( bool vertexCache = true, bool overdraw = true, bool vertexFetch = true );
+
+        void clearMeshlets(void)                            { mMeshlets.clear(); }
+        const MeshletVec& getMeshlets(void) const           { return mMeshlets; }
+        bool hasMeshlets(void) const                        { return !mMeshlets.empty(); }
+
+        /** Calculates the bounds of the vertices referenced by LOD 0, so that Items can
+            cull each of their SubItems individually (see Item::setSubItemCulling).
+        @remarks
+            Reads back the vertex and index buffers. The bounds are exported by the
+            MeshSerializer, so this is best done offline (i.e. OgreMeshTool -submeshbounds).
+            They're not kept up to date if the vertex buffers are later replaced.
+        */
+        void computeAabb(void);
+        void _setAabb( const Aabb &aabb )                   { mAabb = aabb; }
+        const Aabb& getAabb(void) const                     { return mAabb; }
+        bool hasAabb(void) const                            { return mAabb != Aabb::BOX_NULL; }
+
+        /** Reads back LOD 0 as a triangle list.
+        @remarks
+            Only triangle lists are supported; other operation types leave both outputs
+            empty. Reading back from GPU buffers without a shadow copy stalls.
+        @param outPositions
+            Vertex positions of LOD 0's vertex buffer, decompressed to Vector3.
+        @param outIndices
+            Three indices into outPositions per triangle. Non-indexed meshes get them
+            generated.
+        */
+        void readTriangleList( vector<Vector3>::type &outPositions,
+                               vector<uint32>::type &outIndices ) const;
         
         uint16 getNumPoses() { return mNumPoses; }
         
@@ -212,6 +349,11 @@ namespace Ogre {
         
         TexBufferPacked* getPoseTexBuffer() { return mPoseTexBuffer; }
 
+        /// Returns null unless the poses are stored sparsely. @see createPoses
+        TexBufferPacked* getPoseIndexTexBuffer() { return mPoseIndexTexBuffer; }
+
+        uint32 getNumPoseVertices() { return mNumPoseVertices; }
+
         /** Fills the pose animation buffer with the given poseData.
         @param positionData
             Array with a pointer to a block of data for each pose, and each pose
@@ -232,19 +374,34 @@ namespace Ogre {
             True if you want the pose buffer to have pixel format PF_FLOAT16_RGBA
             which uses significantly less memory. Otherwise it is created with pixel
             format PF_FLOAT32_RGBA. Rarely the extra precision is needed.
+        @remarks
+            When the poses only move a small part of the mesh (i.e. facial expressions on a
+            full body mesh) only the vertices moved by at least one pose are stored, plus an
+            index per vertex to find them. This is chosen automatically when it saves at least
+            a quarter of the memory; the vertex shader then performs one extra fetch.
          */
         void createPoses( const float** positionData, const float** normalData, size_t numPoses, size_t numVertices, 
                           const String* names = 0, bool halfPrecision = true );
 
     protected:
         void importBuffersFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords, bool qTangents,
-                                  bool halfPose, size_t vaoPassIdx);
+                                  bool halfPose, size_t vaoPassIdx, ArrangedVertexData *arranged );
 
         /// Converts a v1 IndexBuffer to a v2 format. Returns nullptr if indexData is also nullptr
         IndexBufferPacked* importFromV1( v1::IndexData *indexData );
 
         void importPosesFromV1( v1::SubMesh *subMesh, VertexBufferPacked *vertexBuffer, bool halfPrecision );
 
+        /** Creates mPoseTexBuffer (and mPoseIndexTexBuffer if sparse) out of the offsets.
+            mNumPoses & mPoseNormals must already be set.
+        @param positions
+            Dense array of (x,y,z) offsets, numVertices per pose.
+        @param normals
+            Same as positions, for the normals. Ignored if !mPoseNormals.
+        */
+        void createPoseTexBuffers( const float *positions, const float *normals,
+                                   size_t numVertices, bool halfPrecision );
+
         /** @see arrangeEfficient overload
         @param vao
             The Vao to convert to.
@@ -259,7 +416,7 @@ namespace Ogre {
             with the original vao.
         */
         static VertexArrayObject* arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
-                                                    VertexArrayObject *vao,
+                                                    bool unormTexCoords, VertexArrayObject *vao,
                                                     SharedVertexBufferMap &sharedBuffers,
                                                     VaoManager *vaoManager );
 
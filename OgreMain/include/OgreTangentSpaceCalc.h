@@ -212,6 +212,19 @@ namespace v1
         typedef vector<VertexInfo>::type VertexInfoArray;
         VertexInfoArray mVertexArray;
 
+        /// Per-face data that does not depend on the order faces get processed in,
+        /// hence can be calculated in parallel before accumulating into vertices.
+        struct FaceInfo
+        {
+            size_t  vertInd[3];
+            Vector3 tsU;
+            Vector3 tsV;
+            Vector3 tsN;
+            Real    angleWeight[3];
+        };
+        typedef vector<FaceInfo>::type FaceInfoArray;
+        FaceInfoArray mFaceArray;
+
         void extendBuffers(VertexSplits& splits);
         void insertTangents(Result& res,
             VertexElementSemantic targetSemantic, 
@@ -224,9 +237,18 @@ namespace v1
         Real calculateAngleWeight(size_t v0, size_t v1, size_t v2);
         int calculateParity(const Vector3& u, const Vector3& v, const Vector3& n);
         void addFaceTangentSpaceToVertices(size_t indexSet, size_t faceIndex, size_t *localVertInd, 
-            const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm, Result& result);
+            const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm,
+            const Real *angleWeights, Result& result);
+        /// Fills tangent space & angle weights of every entry in mFaceArray,
+        /// using worker threads when there's enough faces
+        void calculateFaceInfos(void);
         void normaliseVertices();
         void remapIndexes(Result& res);
+    public:
+        /// Fills tangent space & angle weights of mFaceArray[faceStart; faceEnd)
+        /// Do not call directly.
+        void _calculateFaceInfos(size_t faceStart, size_t faceEnd);
+    protected:
         template <typename T>
         void remapIndexes(T* ibuf, size_t indexSet, Result& res)
         {
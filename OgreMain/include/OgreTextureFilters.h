@@ -121,6 +121,20 @@ namespace TextureFilter
         /// See Image2::Filter
         static uint32 getFilter( const Image2 &image );
         virtual void _executeStreaming( Image2 &image, TextureGpu *texture );
+
+        /** Generates the mipmaps right after the image was decoded (i.e. from the decoder
+            threads, see TextureGpuManager::setNumDecoderThreads) instead of waiting for
+            _executeStreaming, which then has nothing left to do.
+        @remarks
+            Only done when the result is guaranteed to be the same, i.e. when SW mipmaps will
+            be generated and no other filter modifies the image before that.
+        @param isSRgb
+            True if the texture prefers loading as sRGB.
+        @return
+            True if mipmaps were generated.
+        */
+        static bool _generateAhead( uint32 filters, Image2 &image, bool isSRgb,
+                                    const TextureGpuManager *textureManager );
     };
     //-----------------------------------------------------------------------------------
     class _OgreExport GenerateHwMipmaps : public FilterBase
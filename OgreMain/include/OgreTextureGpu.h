@@ -231,6 +231,22 @@ namespace Ogre
         /// @see    TextureSourceType::TextureSourceType
         uint8 mSourceType;
 
+        /// Subsystem that owns this texture. Unlike mSourceType, it can be extended by the
+        /// user via GpuMemoryTracker::registerTag
+        uint8 mMemoryTag;
+
+        /// See setNumMipmapsToSkip
+        uint8 mNumMipmapsToSkip;
+
+        /// See _notifyRequiredResolution
+        uint32 mRequiredResolution;
+        /// TextureGpuManager::getFrameCount when _notifyRequiredResolution was last called.
+        /// 0 if never.
+        uint32 mLastUsedFrame;
+        /// True if TextureGpuManager's residency budget sent us to OnStorage / OnSystemRam,
+        /// and thus it should bring us back once we're used again.
+        bool mEvictedByBudget;
+
         /// This setting can only be altered if mResidencyStatus == OnStorage).
         TextureTypes::TextureTypes  mTextureType;
         PixelFormatGpu              mPixelFormat;
@@ -263,6 +279,8 @@ namespace Ogre
                     TextureGpuManager *textureManager );
         virtual ~TextureGpu();
 
+        virtual bool isTextureGpu(void) const               { return true; }
+
         void _resetTextureManager(void);
 
         /// Note: This returns the alias name of the texture.
@@ -322,6 +340,36 @@ namespace Ogre
         void setNumMipmaps( uint8 numMipmaps );
         uint8 getNumMipmaps(void) const;
 
+        /** Makes the texture drop its numMipmaps largest mips when loaded from file,
+            i.e. a 4096x4096 texture with numMipmaps = 2 gets loaded as 1024x1024,
+            consuming 16x less memory.
+        @remarks
+            Takes effect the next time the texture is loaded from storage (i.e. when
+            transitioning from OnStorage). If the file doesn't have enough mipmaps, the
+            image is downscaled instead (only possible with uncompressed 2D images).
+        @par
+            Use it to keep textures that would otherwise exceed the available
+            VRAM resident at a lower resolution.
+        */
+        void setNumMipmapsToSkip( uint8 numMipmaps );
+        uint8 getNumMipmapsToSkip(void) const                   { return mNumMipmapsToSkip; }
+
+        /** Tells the texture it was rendered at roughly the given size on screen, in pixels.
+            The largest value is kept until TextureGpuManager's mip streaming consumes it.
+            Called from main thread by the datablocks using this texture.
+            @see TextureGpuManager::setMipStreaming
+        */
+        void _notifyRequiredResolution( uint32 pixels );
+        uint32 _getRequiredResolution(void) const               { return mRequiredResolution; }
+        void _resetRequiredResolution(void)                     { mRequiredResolution = 0; }
+
+        /// Frame in which the texture was last rendered by a datablock, relative to
+        /// TextureGpuManager::getFrameCount. 0 if it's never been tracked.
+        /// @see TextureGpuManager::setResidencyBudget
+        uint32 getLastUsedFrame(void) const                     { return mLastUsedFrame; }
+        void _setEvictedByBudget( bool evicted )                { mEvictedByBudget = evicted; }
+        bool _isEvictedByBudget(void) const                     { return mEvictedByBudget; }
+
         uint32 getInternalSliceStart(void) const;
 
         virtual void setTextureType( TextureTypes::TextureTypes textureType );
@@ -332,6 +380,10 @@ namespace Ogre
         /// @copydoc TextureGpu::mSourceType
         uint8 getSourceType( void ) const;
 
+        /// @copydoc TextureGpu::mMemoryTag
+        void _setMemoryTag( uint8 tag );
+        uint8 getMemoryTag( void ) const;
+
         /** Sets the pixel format.
         @remarks
             If prefersLoadingFromFileAsSRGB() returns true, the format may not be fully honoured
@@ -414,6 +466,12 @@ namespace Ogre
         void _notifySysRamDownloadIsReady( uint8 *sysRamPtr, bool resyncOnly );
 
         /**
+        @remarks
+            When copying between an uncompressed format and a compressed format with
+            the same bytes per block (e.g. PFG_RG32_UINT -> PFG_BC1_UNORM) each texel of the
+            uncompressed texture maps to one block. srcBox & dstBox are expressed in texels
+            of their own texture, thus their sizes will be different.
+            Not all APIs support this (i.e. Metal doesn't)
         @param dst
         @param dstBox
         @param dstMipLevel
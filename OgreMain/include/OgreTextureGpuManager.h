@@ -33,6 +33,7 @@ THE SOFTWARE.
 #include "OgreTextureGpu.h"
 #include "OgreTextureGpuListener.h"
 #include "OgreImage2.h"
+#include "OgreGpuMemoryTracker.h"
 #include "Threading/OgreLightweightMutex.h"
 #include "Threading/OgreWaitableEvent.h"
 #include "Threading/OgreThreads.h"
@@ -53,6 +54,7 @@ namespace Ogre
     */
 
     typedef vector<TextureGpu*>::type TextureGpuVec;
+    class AsyncArchiveReader;
     class ObjCmdBuffer;
     class ResourceLoadingListener;
     class TextureGpuManagerListener;
@@ -74,6 +76,21 @@ namespace Ogre
 
         bool hasFreeSlot(void) const;
         bool empty(void) const;
+
+        uint16 getNumFreeSlots(void) const;
+        /// Bytes allocated by the master texture for slices that are not in use
+        size_t getWastedBytes(void) const;
+    };
+
+    struct _OgreExport TexturePoolStats
+    {
+        uint32  numPools;
+        uint32  numSlices;
+        uint32  usedSlices;
+        /// Bytes allocated by all pools
+        size_t  totalBytes;
+        /// Bytes allocated by all pools for slices that are not in use
+        size_t  wastedBytes;
     };
 
     typedef list<TexturePool>::type TexturePoolList;
@@ -498,12 +515,51 @@ namespace Ogre
         ThreadData          mThreadData[2];
         StreamingData       mStreamingData;
 
+        /// A LoadRequest whose file gets decoded by the decoder threads. @see setNumDecoderThreads
+        struct DecodeJob
+        {
+            size_t          loadRequestIdx;
+            DataStreamPtr   data;
+            Image2          *image;
+            /// LoadRequest::filters. SW mipmaps are generated by the decoders when possible
+            uint32          filters;
+            bool            prefersSRgb;
+        };
+        typedef vector<DecodeJob>::type DecodeJobVec;
+
+        /// Helper threads that decode images on behalf of the worker thread.
+        /// Woken up by the worker thread (while holding mMutex) through mDecoderThreadsBarrier.
+        ThreadHandleVec     mDecoderThreads;
+        Barrier             *mDecoderThreadsBarrier;
+        bool                mStopDecoderThreads;
+        DecodeJobVec        mDecodeJobs;
+
+        /// Reads the files of a batch of load requests concurrently. @see setNumIoThreads
+        AsyncArchiveReader  *mAsyncArchiveReader;
+
         TexturePoolList     mTexturePool;
         ResourceEntryMap    mEntries;
         /// Protects mEntries
         mutable LightweightMutex mEntriesMutex;
 
         size_t              mEntriesToProcessPerIteration;
+
+        /// See setMipStreaming
+        bool                mMipStreaming;
+        uint8               mMipStreamingMaxSkip;
+        uint32              mMipStreamingInterval;
+        uint32              mMipStreamingFrameCount;
+        size_t              mMipStreamingBudget;
+
+        /// See setTexturePoolDefragmentation
+        uint32              mPoolDefragSlicesPerFrame;
+
+        /// See setResidencyBudget
+        size_t              mResidencyBudget;
+        uint32              mResidencyMinUnusedFrames;
+        GpuResidency::GpuResidency mResidencyEvictTo;
+        /// Frames ended. Starts at 1 so 0 can mean "never"
+        uint32              mFrameCount;
         size_t              mMaxPreloadBytes;
         /// See BudgetEntry. Must be sorted by size in bytes (biggest entries first).
         BudgetEntryVec              mBudget;
@@ -589,6 +645,33 @@ namespace Ogre
         /// Must be called from worker thread.
         void mergeUsageStatsIntoPrevStats(void);
 
+        /// Spawns numThreads decoder threads. Assumes none are running.
+        void startDecoderThreads( uint32 numThreads );
+        /// Stops & joins all decoder threads.
+        /// Assumes the worker thread isn't inside _updateStreaming (i.e. we hold mMutex).
+        void stopDecoderThreads(void);
+        /// Decodes the jobs in mDecodeJobs assigned to the given thread, generating
+        /// their SW mipmaps too when possible (see GenerateSwMipmaps::_generateAhead).
+        /// threadIdx 0 is the worker thread; decoder threads start at 1.
+        void decodeImages( size_t threadIdx );
+        /// Whether the file (judging by its extension) is stored in a format the GPU consumes
+        /// as is (DDS, KTX, etc). Those are read straight into their Image2 by the codec, so
+        /// reading them into memory first for the decoder threads would only add a full copy.
+        static bool isGpuNativeFormat( const String &filename );
+
+        /** Opens the files of the first numRequests entries in loadRequests and decodes them
+            in parallel using the decoder threads. Successfully decoded entries get their
+            LoadRequest::image set (with autoDeleteImage = true), so processLoadRequest
+            sees them as if they had been loaded from RAM.
+        @remarks
+            Files are opened & read into memory serially by the calling thread, since
+            Archives (e.g. zip) aren't necessarily thread safe. Only decoding is parallel.
+            Failed entries are left untouched so processLoadRequest retries them and
+            handles the error as usual. GPU-native formats are skipped (see isGpuNativeFormat).
+            Must be called from worker thread.
+        */
+        void preDecodeLoadRequests( LoadRequestVec &loadRequests, size_t numRequests );
+
         /** Finds a StagingTexture that can map the given region defined by the box & pixelFormat.
             Searches in both used & available textures.
             If no staging texture supports this request, it will fill a RareRequest entry.
@@ -612,6 +695,10 @@ namespace Ogre
         static void addTransitionToLoadedCmd( ObjCmdBuffer *commandBuffer, TextureGpu *texture,
                                               void *sysRamCopy, bool toSysRam );
 
+        /// Drops the numMipmapsToSkip largest mips from the image, or downscales it if it
+        /// doesn't have that many. See TextureGpu::setNumMipmapsToSkip
+        static void skipMipmaps( Image2 &image, uint8 numMipmapsToSkip );
+
         /// Retrieves, in bytes, the memory consumed by StagingTextures in a container like
         /// mAvailableStagingTextures, which are textures waiting either to be reused, or to be destroyed.
         size_t getConsumedMemoryByStagingTextures( const StagingTextureVec &stagingTextures ) const;
@@ -664,7 +751,16 @@ namespace Ogre
         /// Must be called from main thread.
         void _releaseSlotFromTexture( TextureGpu *texture );
 
+    protected:
+        /// Removes texture from the pool's list of used slots, destroying the pool if it
+        /// became empty. Does not notify the texture.
+        void releaseSlot( TexturePool *texturePool, TextureGpu *texture );
+        /// Copies the texture's slice into dstPool & updates bookkeeping. See defragmentTexturePools
+        void migrateToPool( TextureGpu *texture, TexturePool &dstPool );
+    public:
+
         unsigned long _updateStreamingWorkerThread( ThreadHandle *threadHandle );
+        unsigned long _updateDecoderThread( ThreadHandle *threadHandle );
     protected:
         /// This function processes a load request coming from main thread. It basically
         /// gets called once per Image to load. Usually that means once per texture,
@@ -711,6 +807,72 @@ namespace Ogre
         bool hasPoolId( uint32 poolId, uint32 width, uint32 height,
                         uint8 numMipmaps, PixelFormatGpu pixelFormat ) const;
 
+        /** Replaces a pool created with reservePoolId with a new one holding numSlices,
+            moving all of its textures to the new pool (via GPU copies).
+        @remarks
+            Reserved pools can't be shared by automatically created pools, thus this is the
+            only way to make room in a pool that must stay a single Type2DArray (i.e.
+            the ones bound via SceneManager::setDecalsDiffuse & co).
+        @par
+            Textures are notified via TextureGpuListener::PoolTextureSlotChanged, as their
+            slice index may change.
+            If any texture in the pool is still loading, this function will stall until
+            streaming is done.
+        @param masterTexture
+            Texture returned by reservePoolId. It gets destroyed.
+        @param numSlices
+            Number of slices of the new pool. Must be >= the number of slices in use.
+        @return
+            The master texture of the new pool.
+        */
+        TextureGpu* resizeReservedPool( TextureGpu *masterTexture, uint32 numSlices );
+
+        const TexturePoolList& getTexturePools(void) const          { return mTexturePool; }
+
+        /// Returns how many pools exist that texture could be put into (full or not).
+        /// Useful for TextureGpuManagerListener::getNumSlicesFor implementations.
+        size_t getNumTexturePoolsFor( const TextureGpu *texture ) const;
+
+        /// Aggregates slice usage across all pools. See TexturePool::getWastedBytes
+        /// for the per-pool version.
+        void getTexturePoolStats( TexturePoolStats &outStats ) const;
+
+        /** Adds the size of every resident texture to the stats of its tag. See GpuMemoryTracker.
+        @remarks
+            Textures inside a pool count their slice. The free slices of a pool are counted as
+            waste of the tag of the pool (which is the tag of the texture that caused its creation).
+            outStats must be already sized to the number of tags.
+        */
+        void _collectMemoryTagStats( GpuMemoryTagStatsVec &outStats ) const;
+        /// Includes textures that are not resident
+        void _getTexturesWithMemoryTag( uint8 tag, TextureGpuVec &outTextures ) const;
+
+        /** Moves textures out of sparsely used pools into other compatible pools with free
+            slices (via GPU copies), so that the emptied pools get destroyed.
+        @remarks
+            Pools are never shrunk; after unloading textures, a pool with a single slice in use
+            keeps the whole Type2DArray alive. This function fixes that.
+        @par
+            A pool is only drained if the other compatible pools have enough free slices to hold
+            all of its textures, and only into pools that are more occupied than it. Textures
+            that are still loading, or are about to change residency, are left alone.
+        @par
+            Listeners (e.g. datablocks) are notified via TextureGpuListener::PoolTextureSlotChanged,
+            so descriptor sets and slice indices get updated.
+        @param maxSlicesToMove
+            Maximum number of textures to move in this call.
+        @return
+            True if there is still work to be done.
+        */
+        bool defragmentTexturePools( uint32 maxSlicesToMove = std::numeric_limits<uint32>::max() );
+
+        /** Calls defragmentTexturePools every frame, spreading the work over several frames.
+        @param maxSlicesPerFrame
+            0 to disable (default).
+        */
+        void setTexturePoolDefragmentation( uint32 maxSlicesPerFrame );
+        uint32 getTexturePoolDefragmentation(void) const    { return mPoolDefragSlicesPerFrame; }
+
         /**
         @param name
             Name of the resource. For example TreeWood.png
@@ -1009,6 +1171,114 @@ namespace Ogre
         */
         void setWorkerThreadMaxPreloadBytes( size_t maxPreloadBytes );
 
+        /** Sets how many additional threads help the streaming worker thread
+            decode image files (PNG, JPG, etc) into system RAM.
+        @remarks
+            There's still a single worker thread that talks to the main thread and fills
+            StagingTextures. But while it's processing a batch of load requests, it
+            hands out the decoding of those files to the decoder threads, and decodes its
+            own share. This helps when loading lots of compressed images at once, where
+            decoding dominates over disk I/O and uploading.
+        @par
+            Files are read beforehand by the I/O threads (see setNumIoThreads), and then
+            decoded from memory.
+        @par
+            Must be called from main thread. Blocks until the worker thread is idle.
+            Has no effect on platforms without threading (e.g. Emscripten).
+        @param numThreads
+            0 to disable (default).
+        */
+        void setNumDecoderThreads( uint32 numThreads );
+        uint32 getNumDecoderThreads(void) const;
+
+        /** Sets the number of threads used to read the files of a batch of load requests
+            at the same time, instead of one after another.
+        @remarks
+            Keeping several reads in flight is what gets close to an SSD's bandwidth.
+            Reads go through Archive::open, thus only Archives that declare themselves
+            thread safe (see Archive::isThreadSafe) are read on these threads. Files
+            provided by a ResourceLoadingListener are still read by the worker thread.
+        @par
+            Must be called from main thread. Blocks until the worker thread is idle.
+            Has no effect on platforms without threading (e.g. Emscripten).
+        @param numThreads
+            0 to read on the worker thread. Default is 4.
+        */
+        void setNumIoThreads( uint32 numThreads );
+        uint32 getNumIoThreads(void) const;
+
+        /** Enables choosing automatically how many mips of each texture get loaded, based
+            on how big they appear on screen (see TextureGpu::setNumMipmapsToSkip).
+        @remarks
+            While rendering, RenderQueue tells each datablock how many pixels its objects
+            cover (projected bounding sphere), and the datablock forwards that to its
+            textures. Every evaluationInterval frames, textures loaded from file that are
+            Resident and were seen are reloaded with fewer (or more) mips if that projected
+            size asks for it.
+            It assumes the texture spans the whole object once. Tiling detail maps will
+            thus be underestimated.
+        @par
+            Changing the number of mips means reloading the texture, i.e. it's briefly
+            unavailable for rendering. Keep evaluationInterval high enough to avoid
+            textures constantly going back and forth.
+        @par
+            This overrides TextureGpu::setNumMipmapsToSkip of every texture it reloads.
+        @param enabled
+            False to disable (default).
+        @param budgetBytes
+            When the textures being evaluated would consume more than this, all of them skip
+            additional mips until they fit (or maxNumMipmapsToSkip is reached).
+            0 for no budget.
+        @param evaluationInterval
+            Frames between evaluations. Also how long required sizes are accumulated.
+        @param maxNumMipmapsToSkip
+            Textures never skip more mips than this.
+        */
+        void setMipStreaming( bool enabled, size_t budgetBytes = 0u,
+                              uint32 evaluationInterval = 60u, uint8 maxNumMipmapsToSkip = 4u );
+        bool getMipStreaming(void) const                    { return mMipStreaming; }
+
+        /** Sets a memory budget for textures. When the Resident textures loaded from file
+            consume more than this, the ones that haven't been rendered in the longest time
+            are evicted until we're below budget. When an evicted texture gets rendered
+            again, it's brought back automatically.
+        @remarks
+            Usage is tracked per datablock by RenderQueue (see TextureGpu::getLastUsedFrame),
+            so only textures used by Hlms datablocks can be evicted. Textures that never were
+            tracked (e.g. only used by compositor passes) are never evicted, but do count
+            towards the budget.
+        @par
+            Use TextureGpuManagerListener::canEvict to pin textures.
+        @par
+            An evicted texture is unavailable for a few frames once it's needed again. Raise
+            minUnusedFrames if that happens too often.
+        @param budgetBytes
+            0 to disable (default).
+        @param minUnusedFrames
+            Textures used in the last minUnusedFrames frames are never evicted.
+        @param evictTo
+            GpuResidency::OnStorage to free all memory, or GpuResidency::OnSystemRam to keep
+            a copy in RAM so they're quicker to bring back.
+        */
+        void setResidencyBudget( size_t budgetBytes, uint32 minUnusedFrames = 300u,
+                                 GpuResidency::GpuResidency evictTo = GpuResidency::OnStorage );
+        size_t getResidencyBudget(void) const               { return mResidencyBudget; }
+
+        /// Frames ended so far. See TextureGpu::getLastUsedFrame
+        uint32 getFrameCount(void) const                    { return mFrameCount; }
+
+        /// Whether RenderQueue needs to tell datablocks how they're being used.
+        /// True if mip streaming or residency budget are enabled.
+        bool _isTrackingTextureUsage(void) const    { return mMipStreaming || mResidencyBudget != 0u; }
+
+        /// Called by Root once per frame. See setMipStreaming and setResidencyBudget
+        void _notifyFrameEnded(void);
+
+    protected:
+        void updateMipStreaming(void);
+        void updateResidencyBudget(void);
+    public:
+
         /** The worker thread tracks how many data it is loading so the Main thread can request
             additional StagingTextures if necessary.
 
@@ -68,6 +68,15 @@ namespace Ogre
             How many entries the pool should be able to hold.
         */
         virtual size_t getNumSlicesFor( TextureGpu *texture, TextureGpuManager *textureManager ) = 0;
+
+        /** Called when the residency budget wants to evict a texture that hasn't been used
+            in a while. Return false to pin it (i.e. keep it Resident).
+            @see TextureGpuManager::setResidencyBudget
+        */
+        virtual bool canEvict( TextureGpu *texture, TextureGpuManager *textureManager )
+        {
+            return true;
+        }
     };
 
     /** This is a Default implementation of TextureGpuManagerListener based on heuristics.
@@ -84,6 +93,14 @@ namespace Ogre
         /// If resolution > mMaxResolutionToApplyMinSlices[N]; then minSlicesPerPool = 1;
         uint32 mMaxResolutionToApplyMinSlices[4];
 
+        /// When > 1, each new pool for the same resolution & format is this many times larger
+        /// than the previous one (starting at mMinSlicesPerPool), up to mMaxSlicesPerPool.
+        /// Apps that keep streaming textures in get fewer pools; 1 (default) keeps all pools
+        /// the same size, which wastes less memory when there are few textures per format.
+        /// Textures for which mMinSlicesPerPool is 1 never grow.
+        float   mPoolGrowthFactor;
+        uint16  mMaxSlicesPerPool;
+
         /// Whether non-power-of-2 textures should also be pooled, or we should return 1.
         bool mPackNonPow2;
 
@@ -0,0 +1,218 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreV1MeshConverter_H_
+#define _OgreV1MeshConverter_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreMesh.h"
+#include "OgreMesh2.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWorkStealingScheduler.h"
+#include "ogrestd/deque.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /**
+    @class V1MeshConverter
+        Converts many v1 meshes to v2 (see MeshManager::createByImportingV1) without
+        stalling the main thread, for content libraries too big to convert at load time.
+
+        Every call to update processes a batch of queued meshes:
+            1. The main thread loads the v1 mesh, unshares its vertices and builds its
+               tangents, since those touch the GPU.
+            2. Worker threads interleave and pack the vertices of every SubMesh of every
+               mesh in the batch (SubMesh::_arrangeEfficient), in parallel.
+            3. On a later update, the main thread creates the v2 buffers and notifies
+               the Listener.
+        Step 2 only runs in the workers if the v1 vertex buffers have shadow buffers
+        (the default for v1::MeshManager::load), otherwise it's done in step 3.
+
+        When a cache folder is set, converted meshes are saved there as v2 .mesh files
+        and loaded from it directly the next time. The cache is never invalidated: clear
+        it when the source meshes change, and use a different folder per set of
+        conversion flags.
+    */
+    class _OgreExport V1MeshConverter : public ResourceAlloc
+    {
+    public:
+        class _OgreExport Listener
+        {
+        public:
+            virtual ~Listener() {}
+
+            /// Called from update, once the mesh is ready to be used by Items.
+            /// fromCache is true if it was loaded from the cache folder instead.
+            virtual void meshConverted( V1MeshConverter *converter, const MeshPtr &mesh,
+                                        bool fromCache ) = 0;
+
+            /// Called from update if the mesh could not be converted.
+            virtual void meshConversionFailed( V1MeshConverter *converter,
+                                               const String &v1MeshName,
+                                               const String &description ) {}
+        };
+
+        struct Request
+        {
+            String  v1Name;
+            String  v1Group;
+            String  v2Name;
+            String  v2Group;
+            bool    halfPos;
+            bool    halfTexCoords;
+            bool    qTangents;
+            bool    halfPose;
+        };
+
+        struct Stats
+        {
+            size_t  numPending;
+            size_t  numConverted;
+            size_t  numFromCache;
+            size_t  numFailed;
+        };
+
+    protected:
+        struct Job
+        {
+            Request         request;
+            v1::MeshPtr     v1Mesh;
+            /// True if we loaded the v1 mesh, thus we unload it when done
+            bool            unloadV1;
+            /// getNumSubMeshes() * NumVertexPass entries. Filled by the worker threads.
+            vector<SubMesh::ArrangedVertexData>::type arranged;
+        };
+
+        struct ArrangeTask
+        {
+            size_t  jobIdx;
+            size_t  subMeshIdx;
+            size_t  vaoPassIdx;
+            /// Written by the worker thread if _arrangeEfficient threw
+            String  error;
+        };
+
+        typedef deque<Request>::type RequestDeque;
+        typedef vector<Job>::type JobVec;
+        typedef vector<ArrangeTask>::type ArrangeTaskVec;
+
+        RequestDeque    mPendingRequests;
+        /// Jobs of the batch being processed by the worker threads
+        JobVec          mJobs;
+        ArrangeTaskVec  mTasks;
+
+        WorkStealingScheduler mScheduler;
+        ThreadHandleVec mThreads;
+        LightweightMutex mMutex;
+        /// Protected by mMutex
+        size_t          mNumThreadsFinished;
+        bool            mBatchInFlight;
+
+        size_t          mMaxMeshesPerBatch;
+        String          mCacheFolder;
+        Listener        *mListener;
+        Stats           mStats;
+
+        String getCachePath( const String &v2Name ) const;
+        /// Imports the mesh from the cache folder. Returns false if it's not there.
+        bool loadFromCache( const Request &request );
+
+        /// Main thread part of step 1. Returns false if the job can't be converted.
+        bool prepareJob( Job &job );
+        void startBatch(void);
+        void waitForWorkers(void);
+        void finishBatch(void);
+        void finishJob( Job &job, size_t firstTask, size_t lastTask );
+        void freeArrangedData( Job &job );
+
+        void notifyFailure( const Request &request, const String &description );
+
+    public:
+        /**
+        @param numThreads
+            Number of worker threads used to pack the vertices. Must be > 0.
+        @param maxMeshesPerBatch
+            Max number of meshes processed per batch. Smaller values reduce the time
+            spent per update in the main thread (steps 1 & 3), and increase the latency.
+        */
+        V1MeshConverter( size_t numThreads, size_t maxMeshesPerBatch = 32u );
+        ~V1MeshConverter();
+
+        /** Queues a v1 mesh for conversion. See MeshManager::createByImportingV1 for the
+            parameters. Unlike createByImportingV1, the resulting mesh is not reloadable
+            from the v1 one (which is unloaded once converted, if we loaded it).
+        @remarks
+            Nothing happens until update is called. The v1 mesh is loaded with shadow
+            buffers if it isn't loaded yet.
+        */
+        void queue( const String &v1Name, const String &v1Group,
+                    const String &v2Name, const String &v2Group,
+                    bool halfPos, bool halfTexCoords, bool qTangents, bool halfPose = true );
+
+        /** Advances the conversion. Call it once per frame from the main thread.
+            Listener callbacks are issued from here.
+        @return
+            True if there is nothing left to convert.
+        */
+        bool update(void);
+
+        /// Blocks until all queued meshes have been converted.
+        void waitForAll(void);
+
+        /** Folder where converted meshes are saved to and loaded from.
+            Empty to disable caching (default). The folder must exist.
+        */
+        void setCacheFolder( const String &folder )     { mCacheFolder = folder; }
+        const String& getCacheFolder(void) const        { return mCacheFolder; }
+
+        void setListener( Listener *listener )          { mListener = listener; }
+        Listener* getListener(void) const               { return mListener; }
+
+        const Stats& getStats(void) const               { return mStats; }
+
+        /// Internal use. Executed from the worker threads.
+        void _workerThread( size_t threadIdx );
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -0,0 +1,204 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef _OgreVideoFrameCapture_H_
+#define _OgreVideoFrameCapture_H_
+
+#include "OgrePrerequisites.h"
+#include "OgrePixelFormatGpu.h"
+#include "OgreResourceTransition.h"
+#include "ogrestd/vector.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** \addtogroup Core
+    *  @{
+    */
+    /** \addtogroup Resources
+    *  @{
+    */
+
+    /** Converts rendered frames into NV12 on the GPU so they can be handed to a hardware
+        video encoder (NVENC, AMF, QuickSync, VideoToolbox) without going through system RAM.
+    @remarks
+        The compute job lives in Samples/Media/2.0/scripts/materials/Common
+        (VideoFrameCapture.material.json) and must be loaded as a resource.
+    @par
+        No RenderSystem can write to a PFG_NV12 texture from a shader, thus each frame is
+        written into two textures: the full resolution luma plane (PFG_R8_UNORM) and the
+        half resolution interleaved CbCr plane (PFG_RG8_UNORM). The application registers
+        them with the encoder through the API's interop mechanism, using the native handle
+        from TextureGpu::getCustomAttribute( TextureGpu::msFinalTextureBuffer, ... )
+        (i.e. ID3D11Resource, GLuint, id<MTLTexture>), and copies the planes into the
+        encoder's input surface (or passes them directly, if the encoder accepts planes).
+    @par
+        Frames are ring buffered so the GPU can keep rendering while the encoder consumes
+        older frames:
+            1. capture() converts the frame into a free slot. If the encoder still holds
+               all the slots the frame is dropped.
+            2. acquireFrame() returns the oldest captured slot once the GPU has finished
+               writing it.
+            3. releaseFrame() gives the slot back once the encoder is done with it.
+    @par
+        capture() must be called while the source still holds the frame; for a Window
+        that means before it's swapped (e.g. from CompositorWorkspaceListener::
+        workspacePosUpdate). Sources that can't be sampled (TextureFlags::NotTexture,
+        which includes most Windows) are first copied into an intermediate texture on
+        the GPU. Rendering the workspace into a regular texture avoids that copy.
+    */
+    class _OgreExport VideoFrameCapture : public UtilityAlloc
+    {
+    public:
+        static const uint8 InvalidSlot;
+
+        enum ColourSpace
+        {
+            /// ITU-R BT.601 (SD video)
+            Bt601,
+            /// ITU-R BT.709 (HD video). Default
+            Bt709
+        };
+
+    protected:
+        enum SlotState
+        {
+            SlotFree,
+            /// Converted, waiting for the GPU to finish
+            SlotCaptured,
+            /// Held by the encoder
+            SlotAcquired
+        };
+
+        struct Slot
+        {
+            TextureGpu  *luma;
+            TextureGpu  *chroma;
+            SlotState   state;
+            uint32      frameCount;
+            uint64      captureIdx;
+        };
+
+        typedef vector<Slot>::type SlotVec;
+
+        SlotVec             mSlots;
+        uint32              mWidth;
+        uint32              mHeight;
+        uint64              mNextCaptureIdx;
+        size_t              mDroppedFrames;
+
+        ColourSpace         mColourSpace;
+        bool                mFullRange;
+
+        /// [srgb]
+        HlmsComputeJob      *mJobs[2];
+        /// See capture. Created on demand
+        TextureGpu          *mStagingTexture;
+
+        ResourceTransition  mResourceTransition;
+
+        HlmsCompute         *mHlmsCompute;
+        TextureGpuManager   *mTextureManager;
+        VaoManager          *mVaoManager;
+        RenderSystem        *mRenderSystem;
+
+        TextureGpu* createPlane( uint32 width, uint32 height, PixelFormatGpu pixelFormat );
+        void destroyJobs(void);
+        HlmsComputeJob* getJob( bool srgb );
+        TextureGpu* getSampleableSource( TextureGpu *source );
+
+    public:
+        /**
+        @param width
+            Resolution of the frames being captured.
+        @param height
+            Resolution of the frames being captured.
+        @param numSlots
+            Number of frames in the ring. At least 2; 3 gives the encoder a full frame of slack.
+        */
+        VideoFrameCapture( HlmsManager *hlmsManager, TextureGpuManager *textureManager,
+                           uint32 width, uint32 height, uint8 numSlots = 3u );
+        ~VideoFrameCapture();
+
+        /// Returns false if the RenderSystem can't run compute shaders
+        bool isSupported(void) const;
+
+        /** Sets the RGB -> YCbCr matrix and whether the output uses the full [0; 255] range
+            instead of the limited ("studio") range [16; 235]. Must match what the encoder
+            is told. Defaults to Bt709, limited range.
+        */
+        void setColourSpace( ColourSpace colourSpace, bool fullRange );
+        ColourSpace getColourSpace(void) const          { return mColourSpace; }
+        bool getFullRange(void) const                   { return mFullRange; }
+
+        /** Converts source into the next free slot.
+        @remarks
+            source must be Type2D, resident, and match the resolution given in the constructor.
+            sRGB sources are converted to gamma space first, since video is gamma encoded.
+        @return
+            The slot written to, or InvalidSlot if there was no free slot (the frame was
+            dropped, see getDroppedFrames).
+        */
+        uint8 capture( TextureGpu *source );
+        /// Captures the Window's texture. See capture( TextureGpu* )
+        uint8 capture( Window *window );
+
+        /** Returns the oldest captured frame whose conversion finished on the GPU and
+            transfers its ownership to the caller, who must call releaseFrame afterwards.
+        @param bWaitForGpu
+            When true, stalls until the GPU is done with the oldest frame instead of
+            returning InvalidSlot. Encoders sharing the device & queue (e.g. NVENC on the
+            same D3D11 device) are serialized by the driver and can pass true safely
+            without actually waiting in most cases.
+        @return
+            The slot or InvalidSlot if there are no frames ready.
+        */
+        uint8 acquireFrame( bool bWaitForGpu = false );
+        /// Gives back a slot returned by acquireFrame, so it can be captured into again.
+        void releaseFrame( uint8 slot );
+
+        /// Full resolution luma (Y) plane of the given slot. PFG_R8_UNORM
+        TextureGpu* getLumaTexture( uint8 slot ) const;
+        /// Half resolution interleaved CbCr plane of the given slot. PFG_RG8_UNORM
+        TextureGpu* getChromaTexture( uint8 slot ) const;
+
+        uint8 getNumSlots(void) const                   { return (uint8)mSlots.size(); }
+        uint32 getWidth(void) const                     { return mWidth; }
+        uint32 getHeight(void) const                    { return mHeight; }
+
+        /// Number of frames capture() dropped because the encoder held every slot
+        size_t getDroppedFrames(void) const             { return mDroppedFrames; }
+    };
+
+    /** @} */
+    /** @} */
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -228,6 +228,29 @@ namespace Ogre
         virtual void getCustomAttribute( IdString name, void* pData ) {}
 
         virtual void swapBuffers(void) = 0;
+
+        /** Limits how many presents the API may queue before swapBuffers blocks.
+            Lower values reduce latency at the risk of stalling the CPU. See FramePacer.
+        @return
+            False if the API doesn't allow changing it.
+        */
+        virtual bool setMaxFrameLatency( uint8 maxFrameLatency )        { return false; }
+
+        /** Present-time feedback, where the API reports it.
+        @param outLastSubmittedId
+            Increasing id of the last present issued by swapBuffers.
+        @param outLastShownId
+            Id of the last present that reached the screen.
+        @param outMicrosecondsSinceShown
+            How long ago outLastShownId reached the screen.
+        @return
+            False if it's not supported, or nothing was shown yet.
+        */
+        virtual bool getPresentStats( uint64 &outLastSubmittedId, uint64 &outLastShownId,
+                                      uint64 &outMicrosecondsSinceShown )
+        {
+            return false;
+        }
     };
 
     /** @} */
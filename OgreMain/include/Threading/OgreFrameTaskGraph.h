@@ -0,0 +1,174 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreFrameTaskGraph_H_
+#define _OgreFrameTaskGraph_H_
+
+#include "OgrePrerequisites.h"
+#include "OgreFastArray.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreWaitableEvent.h"
+
+#include "OgreHeaderPrefix.h"
+
+namespace Ogre
+{
+    /** A node in a FrameTaskGraph.
+    @par
+        A task is made of one or more sequential passes (e.g. one pass per hierarchy depth
+        level) and each pass is split into chunks that are processed in parallel by the
+        worker threads. The next pass won't start until all chunks of the previous one are
+        done, but chunks of other tasks whose dependencies are met may run in the meantime;
+        hence no thread sits idle at a barrier while there's work left somewhere.
+    */
+    class _OgreExport FrameTask
+    {
+    public:
+        virtual ~FrameTask();
+
+        /** Called once all of this task's dependencies have finished, and again every time
+            the previous pass finished, to know how much work the next pass has.
+        @remarks
+            Called from any thread while the graph's lock is held. Keep it cheap.
+        @param passIdx
+            Index of the pass about to start. 0 for the first one.
+        @param outNumChunks [out]
+            Number of chunks in this pass. Can be 0, in which case we move on to the next pass.
+        @return
+            False if there are no more passes (i.e. the task is done). True otherwise.
+        */
+        virtual bool beginPass( size_t passIdx, size_t &outNumChunks ) = 0;
+
+        /** Processes a single chunk of the given pass.
+            Called concurrently from multiple worker threads.
+        @param passIdx
+            Current pass, as given to beginPass.
+        @param chunkIdx
+            Chunk to process, in range [0; outNumChunks) as returned by beginPass.
+        @param threadIdx
+            Index of the worker thread, in range [0; numThreads)
+        */
+        virtual void execute( size_t passIdx, size_t chunkIdx, size_t threadIdx ) = 0;
+    };
+
+    /** Runs a set of FrameTasks on the worker threads, honouring their dependencies.
+        Tasks with no dependency on each other overlap in time.
+    @remarks
+        The graph does not own the tasks. Nodes are identified by their FrameTask pointer.
+        Adding or removing tasks and dependencies must not be done while the graph
+        is being executed.
+    */
+    class _OgreExport FrameTaskGraph : public SceneMgtAlloc
+    {
+        struct TaskNode
+        {
+            FrameTask           *task;
+            /// Indices of the tasks that depend on us
+            FastArray<size_t>   dependents;
+            size_t              numDependencies;
+
+            //Execution state
+            size_t              pendingDependencies;
+            size_t              passIdx;
+            /// numChunks of the current pass in the high 32 bits, next chunk to grab in the
+            /// low 32 bits. Workers grab chunks with a CAS on it, without taking mMutex.
+            volatile uint64     chunkState;
+            /// Chunks of the current pass that aren't done yet. Whoever brings it to 0
+            /// ends the pass.
+            volatile uint32     chunksLeft;
+        };
+
+        typedef FastArray<TaskNode> TaskNodeArray;
+
+        TaskNodeArray       mTasks;
+        size_t              mNumTasksDone;
+        bool                mGraphValidated;
+
+        /// Taken to start & end passes and to go to sleep; not to grab chunks.
+        LightweightMutex    mMutex;
+        /// One per worker thread, so that idle workers sleep instead of spinning.
+        FastArray<WaitableEvent*>   mWakeUpEvents;
+        /// Workers waiting on their mWakeUpEvents for a pass to finish. mMutex must be held.
+        FastArray<size_t>           mSleepingThreads;
+
+        size_t findTask( FrameTask *task ) const;
+
+        /// Throws if there are cyclic dependencies
+        void validateGraph(void);
+
+        /// Starts task's next pass; or marks it as done (and activates its dependents)
+        /// if there are no more passes. mMutex must be held.
+        void activateTask( size_t taskIdx );
+
+        /// Grabs a chunk from any task with a pass in progress. Returns false if every chunk
+        /// of the current passes was already grabbed. Lock-free.
+        bool grabChunk( size_t &outTaskIdx, size_t &outChunkIdx );
+
+        /// Whether grabChunk would find something. mMutex must be held for the answer
+        /// to stay valid (i.e. no new pass can start meanwhile).
+        bool hasChunksLeft(void) const;
+
+        /// Wakes up all sleeping workers. mMutex must be held.
+        void wakeUpSleepingThreads(void);
+
+    public:
+        FrameTaskGraph();
+        ~FrameTaskGraph();
+
+        /// Adds a task to the graph. Does nothing if already added.
+        void addTask( FrameTask *task );
+
+        /// Removes a task and all the dependencies related to it.
+        void removeTask( FrameTask *task );
+
+        /** Makes 'task' wait for 'dependsOn' to finish before it starts.
+            Both tasks must have already been added.
+        */
+        void addDependency( FrameTask *task, FrameTask *dependsOn );
+
+        /// Removes a dependency previously added via addDependency
+        void removeDependency( FrameTask *task, FrameTask *dependsOn );
+
+        size_t getNumTasks(void) const                  { return mTasks.size(); }
+        FrameTask* getTask( size_t idx ) const          { return mTasks[idx].task; }
+
+        /** Resets the execution state. Must be called from the main thread before
+            firing the worker threads that will call _executeWorker
+        @param numThreads
+            Number of worker threads that will call _executeWorker
+        */
+        void _prepareExecution( size_t numThreads );
+
+        /// Processes tasks until all of them are done. Called by each worker thread.
+        void _executeWorker( size_t threadIdx );
+    };
+}
+
+#include "OgreHeaderSuffix.h"
+
+#endif
@@ -43,6 +43,13 @@ THE SOFTWARE.
     #define OGRE_THREAD_CALL_CONVENTION
 #endif
 
+#if OGRE_MEMORY_ALLOCATOR == OGRE_MEMORY_ALLOCATOR_THREADPOOL
+    /// Lets the next thread reuse the thread pools of the one that is exiting
+    #define OGRE_THREAD_EXIT_ALLOCATOR() Ogre::ThreadPoolAllocImpl::releaseThreadCache()
+#else
+    #define OGRE_THREAD_EXIT_ALLOCATOR()
+#endif
+
 #if OGRE_PLATFORM == OGRE_PLATFORM_WIN32 || OGRE_PLATFORM == OGRE_PLATFORM_WINRT
     /// @See Threads::CreateThread for an example on how to use
     #define THREAD_DECLARE( threadFunction ) \
@@ -57,6 +64,7 @@ THE SOFTWARE.
         {\
         }\
         delete threadHandle;\
+        OGRE_THREAD_EXIT_ALLOCATOR();\
         return retVal;\
     }
 #else
@@ -73,6 +81,7 @@ THE SOFTWARE.
         {\
         }\
         delete threadHandle;\
+        OGRE_THREAD_EXIT_ALLOCATOR();\
         \
         return (void*)retVal;\
     }
@@ -134,6 +143,33 @@ namespace Ogre
 
     #define OGRE_TLS_INVALID_HANDLE 0xFFFFFFFF
 
+    namespace ThreadClass
+    {
+        /// Groups the threads spawned by Ogre so they can share a priority & core affinity.
+        /// See Threads::SetThreadClassSettings
+        enum ThreadClass
+        {
+            /// Threads the frame waits on, e.g. SceneManager worker threads
+            FrameCritical,
+            /// Texture streaming, image decoding and asynchronous file reads
+            Streaming,
+            /// Everything else: WorkQueue, async log writer, StaticGeometry merging, etc
+            Background,
+            NumThreadClasses
+        };
+    }
+
+    namespace ThreadPriority
+    {
+        enum ThreadPriority
+        {
+            Low,
+            Normal,
+            /// May require elevated privileges. Ignored if the OS refuses it
+            High
+        };
+    }
+
     class _OgreExport Threads
     {
     public:
@@ -190,6 +226,31 @@ namespace Ogre
         /// sleeping may vary widely depending on OS and other variables. Do not feed 0.
         static void Sleep( uint32 milliseconds );
 
+        /** Sets the priority & core affinity of all the threads of the given class.
+            Only threads started afterwards are affected, thus call this before creating
+            the Root (or the SceneManager, TextureGpuManager, etc).
+        @remarks
+            Use it to keep engine threads from oversubscribing the cores or competing with
+            each other, e.g. pin FrameCritical threads to the first N cores, leave the rest
+            to Streaming and lower the priority of Background threads.
+            Affinity is ignored on Apple platforms, which don't support it.
+        @param threadClass
+        @param priority
+        @param affinityMask
+            Bit N set means the thread may run on logical core N.
+            0 to let the OS decide (default).
+        */
+        static void SetThreadClassSettings( ThreadClass::ThreadClass threadClass,
+                                            ThreadPriority::ThreadPriority priority,
+                                            uint64 affinityMask );
+        static ThreadPriority::ThreadPriority GetThreadClassPriority(
+                ThreadClass::ThreadClass threadClass );
+        static uint64 GetThreadClassAffinity( ThreadClass::ThreadClass threadClass );
+
+        /// Applies the settings of the given class to the calling thread.
+        /// Ogre's threads call it at their start.
+        static void ApplyThreadClass( ThreadClass::ThreadClass threadClass );
+
         /** Allocates a Thread Local Storage handle to use
         @param outTls [out]
             Handle to TLS.
@@ -0,0 +1,102 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _OgreWorkStealingScheduler_H_
+#define _OgreWorkStealingScheduler_H_
+
+#include "OgrePrerequisites.h"
+#include "Threading/OgreLightweightMutex.h"
+
+namespace Ogre
+{
+    /** Distributes a range of N chunks [0; N) among a fixed number of threads.
+        Each thread starts with a contiguous, equally-sized range of chunks (its "deque")
+        and consumes it from the front. When a thread runs out of work it steals the back
+        half of whatever is left in another thread's range.
+    @par
+        This keeps the good cache locality of a static partition when the load is even,
+        while a thread that finished early (because it got cheap objects) helps the threads
+        that got the expensive ones instead of idling at the barrier.
+    @par
+        Usage:
+            1. From the main thread, call reset() with the number of chunks.
+            2. Fire the worker threads.
+            3. Each worker calls grabChunk() in a loop until it returns false.
+        Calling reset() while workers are still grabbing chunks is undefined.
+    */
+    class _OgreExport WorkStealingScheduler
+    {
+        struct ThreadRange
+        {
+            LightweightMutex    mutex;
+            /// Next chunk to process. Owner pops from here.
+            size_t              nextChunk;
+            /// One past the last chunk. Thieves steal from here.
+            size_t              endChunk;
+
+            /// Avoid false sharing with the ranges of other threads.
+            uint8               padding[64];
+
+            ThreadRange() : nextChunk( 0 ), endChunk( 0 ) {}
+        };
+
+        ThreadRange *mRanges;
+        size_t      mNumThreads;
+
+        /// Steals half of the remaining work from other threads into threadIdx's range.
+        /// Returns false if there was nothing left to steal.
+        bool steal( size_t threadIdx );
+
+    public:
+        WorkStealingScheduler( size_t numThreads );
+        ~WorkStealingScheduler();
+
+        /** Resets the scheduler with new work. Must be called from the main thread
+            (i.e. while the worker threads are not processing)
+        @param numChunks
+            Number of chunks to distribute. Each chunk is the minimum unit of work that
+            can be assigned to a single thread.
+        */
+        void reset( size_t numChunks );
+
+        /** Retrieves the next chunk to process. Multiple threads may call this function
+            concurrently, but each threadIdx must only be used by one thread at a time.
+        @param threadIdx
+            Index of the calling thread, in range [0; numThreads)
+        @param outChunkIdx [out]
+            Index of the chunk to process, in range [0; numChunks)
+        @return
+            False if there's no work left anywhere. True otherwise.
+        */
+        bool grabChunk( size_t threadIdx, size_t &outChunkIdx );
+
+        size_t getNumThreads(void) const                    { return mNumThreads; }
+    };
+}
+
+#endif
@@ -141,6 +141,7 @@ namespace Ogre
         friend class GLES2BufferInterface;
         friend class MetalBufferInterface;
         friend class NULLBufferInterface;
+        friend class UploadScheduler;
 
     protected:
         size_t mInternalBufferStart;  /// In elements
@@ -163,6 +164,9 @@ namespace Ogre
 
         void *mShadowCopy;
 
+        /// See GpuMemoryTracker
+        uint8 mMemoryTag;
+
 #if OGRE_DEBUG_MODE
         /// Used by Dynamic buffers only
         uint32 mLastFrameMapped;
@@ -316,6 +320,11 @@ namespace Ogre
         size_t _getInternalTotalSizeBytes(void) const   { return (mNumElements + mNumElementsPadding) *
                                                                  mBytesPerElement; }
         size_t _getInternalNumElements(void) const      { return mNumElements + mNumElementsPadding; }
+        size_t _getNumElementsPadding(void) const       { return mNumElementsPadding; }
+
+        /// Subsystem that owns this buffer. See GpuMemoryTracker
+        uint8 getMemoryTag(void) const                  { return mMemoryTag; }
+        void _setMemoryTag( uint8 tag )                 { mMemoryTag = tag; }
 
         const void* getShadowCopy(void) const   { return mShadowCopy; }
 
@@ -0,0 +1,167 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_DynamicMesh_H_
+#define _Ogre_DynamicMesh_H_
+
+#include "OgrePrerequisites.h"
+
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreVertexArrayObject.h"
+
+namespace Ogre
+{
+    /** Helper to own a mesh whose vertices and/or indices change every frame (cloth,
+        fluids, procedural geometry) without having to deal with the frame-safety
+        rules of dynamic buffers.
+    @par
+        The vertex and index buffers are BT_DYNAMIC_PERSISTENT, which means the GPU
+        memory is split in VaoManager::getDynamicBufferMultiplier regions; the CPU
+        writes to one while the GPU reads from the others. DynamicMesh keeps an
+        authoritative CPU copy of the data and remembers, per region, which blocks
+        changed since that region was last written. Every upload() call only copies
+        the blocks that are stale in the region about to be written, so partial updates
+        stay cheap and no region ever ends up with old data.
+    @par
+        Threading: getVertexData / getIndexData, writeVertices / writeIndices and
+        markVerticesDirty / markIndicesDirty take no locks and only touch the CPU copy,
+        therefore they can be called from worker threads, as long as each thread writes
+        to a different range and all of them are done before the main thread calls
+        upload(). Ranges that share a block are fine (marking a block dirty is
+        idempotent) but the vertices themselves must not overlap.
+        upload() and everything else must be called from the main thread.
+    @remarks
+        If nothing was marked dirty since the last upload(), upload() won't map
+        anything and the GPU keeps using the last region written, which is up to date.
+    */
+    class _OgreExport DynamicMesh : public RenderSysAlloc
+    {
+        /// Tracks a CPU copy of a dynamic buffer and its stale blocks in each region.
+        struct BufferTracker
+        {
+            BufferPacked    *buffer;
+            uint8           *cpuData;       /// Allocated with OGRE_MALLOC_SIMD
+            size_t          bytesPerElement;
+            size_t          numElements;
+            size_t          numBlocks;
+            /// One flag per block per region. mDirtyBlocks[region * numBlocks + block]
+            uint8           *dirtyBlocks;
+            /// Region that will be written by the next upload. It's our own counter and
+            /// not the buffer's, but both advance together since the buffer only
+            /// advances when we map it.
+            size_t          nextRegion;
+            /// True if anything was marked dirty since the last upload.
+            bool            pendingChanges;
+
+            BufferTracker();
+
+            void create( BufferPacked *_buffer, size_t numRegions );
+            void destroy(void);
+            void markDirty( size_t elementStart, size_t elementCount, size_t numRegions );
+            /// Returns the number of bytes copied to the GPU
+            size_t upload( size_t numRegions );
+        };
+
+        VaoManager          *mVaoManager;
+        VertexArrayObject   *mVao;
+        BufferTracker       mVertices;
+        BufferTracker       mIndices;
+        size_t              mNumRegions;
+
+        size_t              mLastUploadBytes;
+
+    public:
+        /// Number of elements (vertices or indices) covered by each dirty flag.
+        static const size_t ElementsPerBlock;
+
+        /**
+        @param vaoManager
+            VaoManager to create the buffers from.
+        @param vertexElements
+            Vertex declaration. All elements go to a single vertex buffer.
+        @param numVertices
+            Number of vertices. Fixed; use setDrawRange to draw fewer.
+        @param indexType
+            Index type. Ignored if numIndices is 0
+        @param numIndices
+            Number of indices. 0 for non-indexed geometry.
+        @param opType
+            Primitive type of the Vao.
+        */
+        DynamicMesh( VaoManager *vaoManager, const VertexElement2Vec &vertexElements,
+                     uint32 numVertices, IndexBufferPacked::IndexType indexType,
+                     uint32 numIndices, OperationType opType = OT_TRIANGLE_LIST );
+        ~DynamicMesh();
+
+        /// Returns the CPU copy of the vertices. After writing to it,
+        /// call markVerticesDirty with the range that changed. Thread safe.
+        void* getVertexData(void)                   { return mVertices.cpuData; }
+        /// Returns the CPU copy of the indices. @see getVertexData
+        void* getIndexData(void)                    { return mIndices.cpuData; }
+
+        /// Flags the given range of vertices as changed, to be sent to the GPU
+        /// in the next upload(). Thread safe, see class remarks.
+        void markVerticesDirty( uint32 vertexStart, uint32 vertexCount );
+        /// Flags the given range of indices as changed. @see markVerticesDirty
+        void markIndicesDirty( uint32 indexStart, uint32 indexCount );
+
+        /// Copies vertexCount vertices from data to the CPU copy and marks them dirty.
+        /// Thread safe, see class remarks.
+        void writeVertices( const void *data, uint32 vertexStart, uint32 vertexCount );
+        /// Copies indexCount indices from data to the CPU copy and marks them dirty.
+        /// Thread safe, see class remarks.
+        void writeIndices( const void *data, uint32 indexStart, uint32 indexCount );
+
+        /** Sends everything that changed to the GPU. Call it once per frame from the
+            main thread after all writers are done and before rendering.
+        @remarks
+            Calling it more than once in the same frame is harmless if nothing changed
+            in between, otherwise it would map the buffers twice in the same frame,
+            which is not allowed. @see BufferPacked::map
+        */
+        void upload(void);
+
+        /// Restricts the primitives being drawn. @see VertexArrayObject::setPrimitiveRange
+        void setDrawRange( uint32 primStart, uint32 primCount );
+
+        /// Bytes sent to the GPU by the last upload() (0 if it was a no-op).
+        size_t getLastUploadBytes(void) const       { return mLastUploadBytes; }
+
+        uint32 getNumVertices(void) const           { return static_cast<uint32>( mVertices.numElements ); }
+        uint32 getNumIndices(void) const            { return static_cast<uint32>( mIndices.numElements ); }
+
+        VertexBufferPacked* getVertexBuffer(void) const { return mVao->getBaseVertexBuffer(); }
+        /// May be null if the mesh is not indexed
+        IndexBufferPacked* getIndexBuffer(void) const   { return mVao->getIndexBuffer(); }
+
+        /// The Vao to use in a Renderable (i.e. push it to mVaoPerLod).
+        VertexArrayObject* getVao(void) const       { return mVao; }
+    };
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef _Ogre_UploadScheduler_H_
+#define _Ogre_UploadScheduler_H_
+
+#include "OgrePrerequisites.h"
+
+#include "ogrestd/vector.h"
+
+namespace Ogre
+{
+    /** Queues uploads to BT_DEFAULT buffers and spreads them across frames so that
+        large amounts of data (i.e. after loading a level) don't saturate the bus in a
+        single frame and cause a spike.
+    @par
+        Each frame (from VaoManager::_update) the queued requests are sorted by deadline,
+        then priority, then submission order and executed until the per-frame budget
+        (setMaxBytesPerFrame) is exhausted. Requests whose deadline has been reached are
+        always executed, regardless of the budget. At least one request is executed
+        every frame so that no request starves.
+    @par
+        All requests executed in the same frame share a single StagingBuffer map, and
+        requests that write contiguous regions of the same buffer are coalesced into
+        a single GPU copy.
+    @par
+        The VaoManager owns one instance (see VaoManager::getUploadScheduler). The
+        TextureGpuManager reports the bytes it streamed into textures every frame via
+        _notifyExternalUpload, so that texture streaming and buffer uploads share the
+        same budget. Textures go first, buffer uploads use whatever is left.
+    @remarks
+        A request that partially overlaps a pending request to the same buffer forces
+        the older one to be uploaded immediately, in order to preserve write order.
+        A request that fully covers a pending one simply replaces it.
+    */
+    class _OgreExport UploadScheduler : public RenderSysAlloc
+    {
+        struct Request
+        {
+            BufferPacked    *buffer;
+            size_t          dstOffset;  /// In bytes
+            size_t          sizeBytes;
+            uint8           *data;      /// Owned by us. Allocated with OGRE_MALLOC_SIMD
+            uint8           priority;
+            uint32          deadlineFrame;
+            uint32          sequence;
+        };
+
+        typedef vector<Request>::type RequestVec;
+
+        struct ExecutionOrder;
+        struct DestinationOrder;
+
+        VaoManager  *mVaoManager;
+        RequestVec  mRequests;
+        size_t      mQueuedBytes;
+        uint32      mNextSequence;
+
+        size_t      mMaxBytesPerFrame;
+        size_t      mExternalBytesThisFrame;
+
+        size_t      mLastFrameBytesUploaded;
+        size_t      mLastFrameRequests;
+        size_t      mLastFrameCopies;
+
+        /// Uploads mRequests[0; numRequests) using a single StagingBuffer,
+        /// removes them from mRequests and updates the stats.
+        void executeRequests( size_t numRequests );
+
+        static void freeRequest( Request &request );
+
+    public:
+        UploadScheduler( VaoManager *vaoManager );
+        ~UploadScheduler();
+
+        /** Queues an upload. @see BufferPacked::upload
+        @remarks
+            The data is copied, the caller can free it immediately.
+            The buffer's shadow copy (if it has one) is updated immediately.
+        @param buffer
+            Buffer to upload to. Must be BT_DEFAULT.
+        @param data
+            Data to upload. Must hold at least elementCount * buffer->getBytesPerElement() bytes.
+        @param elementStart
+            Offset, in elements, of the destination region.
+        @param elementCount
+            Size, in elements, of the data.
+        @param priority
+            Higher values get uploaded first.
+        @param maxFramesToWait
+            The request is guaranteed to be executed no later than maxFramesToWait frames
+            from now, even if that means going over the budget. 0 to execute it in the
+            next _update. Use std::numeric_limits<uint32>::max() for no deadline.
+        */
+        void queueUpload( BufferPacked *buffer, const void *data,
+                          size_t elementStart, size_t elementCount,
+                          uint8 priority = 128u, uint32 maxFramesToWait = 8u );
+
+        /// Discards all pending uploads for the given buffer.
+        void cancelUploads( BufferPacked *buffer );
+
+        /// Executes all pending uploads immediately, ignoring the budget.
+        void flush(void);
+
+        /** Maximum amount of bytes to upload per frame. 0 means no limit (default).
+        @remarks
+            On the first frame with a limit, everything queued before will be subject to it.
+        */
+        void setMaxBytesPerFrame( size_t maxBytesPerFrame );
+        size_t getMaxBytesPerFrame(void) const          { return mMaxBytesPerFrame; }
+
+        /// Number of pending requests
+        size_t getQueueDepth(void) const                { return mRequests.size(); }
+        /// Number of pending bytes
+        size_t getQueuedBytes(void) const               { return mQueuedBytes; }
+
+        /// Bytes uploaded by the last _update (or flush), not counting external uploads.
+        size_t getLastFrameBytesUploaded(void) const    { return mLastFrameBytesUploaded; }
+        /// Number of requests executed by the last _update (or flush)
+        size_t getLastFrameRequests(void) const         { return mLastFrameRequests; }
+        /// Number of GPU copies issued by the last _update (or flush), after coalescing
+        size_t getLastFrameCopies(void) const           { return mLastFrameCopies; }
+
+        /// Notifies that bytes were uploaded this frame by other means (i.e. texture
+        /// streaming) and should be subtracted from this frame's budget.
+        void _notifyExternalUpload( size_t bytes )      { mExternalBytesThisFrame += bytes; }
+
+        /// Called by the VaoManager when a buffer is destroyed. Discards its pending uploads.
+        void _notifyBufferDestroyed( BufferPacked *buffer );
+
+        /// Executes queued requests according to the budget. Called by VaoManager::_update.
+        void _update(void);
+    };
+}
+
+#endif
@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "Vao/OgreVertexBufferPacked.h"
 #include "Vao/OgreIndexBufferPacked.h"
 #include "OgreRenderOperation.h"
+#include "OgreGpuMemoryTracker.h"
 
 #include "ogrestd/unordered_set.h"
 
@@ -46,6 +47,7 @@ namespace Ogre
     {
     protected:
         Timer *mTimer;
+        UploadScheduler *mUploadScheduler;
 
         /// In millseconds. Note: Changing this value won't affect existing staging buffers.
         uint32 mDefaultStagingBufferUnfencedTime;
@@ -80,6 +82,9 @@ namespace Ogre
         typedef vector<DelayedBuffer>::type DelayedBufferVec;
         DelayedBufferVec    mDelayedDestroyBuffers;
 
+        /// See setPoolDefragmentation. 0 to disable.
+        size_t mPoolDefragBytesPerFrame;
+
         uint32 mConstBufferAlignment;
         uint32 mTexBufferAlignment;
         uint32 mUavBufferAlignment;
@@ -207,6 +212,41 @@ namespace Ogre
         /// Frees GPU memory if there are empty, unused pools
         virtual void cleanupEmptyPools(void) = 0;
 
+        /** Compacts the static (non-dynamic) buffer pools by moving live buffers out of
+            the least occupied pool and into free space in the other pools via GPU copies.
+            Once the pool is drained it gets released (see cleanupEmptyPools).
+        @remarks
+            cleanupEmptyPools can only release pools that are completely empty. After a lot
+            of content churn, pools tend to end up with a few live buffers scattered around,
+            which keeps the memory from ever being released.
+        @par
+            VertexArrayObjects referencing moved buffers are updated automatically. Their
+            mVaoName & mRenderQueueId may change (see VertexArrayObject).
+        @par
+            Not all RenderSystems implement this. The default implementation does nothing.
+        @param maxBytesToMove
+            Stop after moving this many bytes (at least one buffer is always moved,
+            if there is something to move). Use it to time-slice the work across frames.
+        @return
+            True if there is still work left to do. False if the pools are already as
+            compacted as they can be.
+        */
+        virtual bool defragmentPools( size_t maxBytesToMove );
+
+        /** When non-zero, defragmentPools( bytesPerFrame ) is called automatically every frame.
+            Useful for long running applications that constantly load and unload content.
+        @param bytesPerFrame
+            Maximum number of bytes to move per frame. 0 to disable (default).
+        */
+        void setPoolDefragmentation( size_t bytesPerFrame );
+
+        /// Adds the size of every live buffer to the stats of its tag. See GpuMemoryTracker.
+        /// Dynamic buffers count all of their mDynamicBufferMultiplier copies.
+        /// outStats must be already sized to the number of tags.
+        void _collectMemoryTagStats( GpuMemoryTagStatsVec &outStats ) const;
+        void _getBuffersWithMemoryTag( uint8 tag, BufferPackedVec &outBuffers ) const;
+        size_t getPoolDefragmentation(void) const       { return mPoolDefragBytesPerFrame; }
+
         /// Returns the size of a single vertex buffer source with the given declaration, in bytes
         static uint32 calculateVertexSize( const VertexElement2Vec &vertexElements );
 
@@ -480,6 +520,10 @@ namespace Ogre
         uint8 _getDynamicBufferCurrentFrameNoWait(void) const   { return mDynamicBufferCurrentFrame; }
         uint8 getDynamicBufferMultiplier(void) const            { return mDynamicBufferMultiplier; }
 
+        /// Spreads BT_DEFAULT buffer uploads across frames under a byte budget.
+        /// See UploadScheduler.
+        UploadScheduler* getUploadScheduler(void) const         { return mUploadScheduler; }
+
         /// Returns the current frame # (which wraps to 0 every mDynamicBufferMultiplier
         /// times). But first stalls until that mDynamicBufferMultiplier-1 frame behind
         /// is finished.
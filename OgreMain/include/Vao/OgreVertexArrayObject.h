@@ -51,7 +51,8 @@ namespace Ogre
         the vertex buffers or the index buffer) then despite the immutability
         of this class, the internal values of mVaoName & mRenderQueueId may
         be changed automatically by the VaoManager as it performs maintenance
-        and cleanups of these type of buffers (in practice only affects D3D11).
+        and cleanups of these type of buffers (D3D11, and GL3+ when
+        VaoManager::defragmentPools moves static buffers around).
         Don't rely on the contents of these two variables if the Vao contains
     */
     struct _OgreExport VertexArrayObject : public VertexArrayObjectAlloc
@@ -0,0 +1,463 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Animation/OgreBakedSkeletonAnimation.h"
+#include "Animation/OgreSkeletonDef.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "Animation/OgreSkeletonAnimationDef.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreTexBufferPacked.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreItem.h"
+#include "OgreSubItem.h"
+#include "OgreStringConverter.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Ogre
+{
+    namespace
+    {
+        struct BakeKeyFrame
+        {
+            Real        frame;
+            Vector3     position;
+            Quaternion  orientation;
+            Vector3     scale;
+        };
+
+        typedef vector<BakeKeyFrame>::type BakeKeyFrameVec;
+
+        /// See ArrayMatrixAf4x3::retain
+        Matrix4 retain( const Matrix4 &m, bool inheritOrientation, bool inheritScale )
+        {
+            Matrix4 retVal( m );
+            for( size_t i=0; i<3u; ++i )
+            {
+                Vector3 row( m[i][0], m[i][1], m[i][2] );
+                Real scale = row.length();
+                if( inheritOrientation )
+                {
+                    row = scale != Real( 0.0f ) ? row / scale : Vector3::ZERO;
+                }
+                else
+                {
+                    row = Vector3::ZERO;
+                    row[i] = Real( 1.0f );
+                }
+                if( !inheritScale )
+                    scale = Real( 1.0f );
+
+                row *= scale;
+                retVal[i][0] = row.x;
+                retVal[i][1] = row.y;
+                retVal[i][2] = row.z;
+            }
+            return retVal;
+        }
+
+        /// Same interpolation as SkeletonTrack::applyKeyFrameRigAt
+        void sampleKeyFrames( const BakeKeyFrameVec &keyFrames, Real frame, Vector3 &inOutPos,
+                              Quaternion &inOutRot, Vector3 &inOutScale )
+        {
+            BakeKeyFrameVec::const_iterator itNext = keyFrames.begin();
+            while( itNext != keyFrames.end() && itNext->frame <= frame )
+                ++itNext;
+
+            BakeKeyFrameVec::const_iterator itPrev = itNext;
+            if( itPrev != keyFrames.begin() )
+                --itPrev;
+            if( itNext == keyFrames.end() )
+                itNext = itPrev;
+
+            Real fTimeW = 0;
+            if( itNext->frame > itPrev->frame )
+            {
+                fTimeW = ( frame - itPrev->frame ) / ( itNext->frame - itPrev->frame );
+                fTimeW = Ogre::max( Real( 0.0f ), Ogre::min( fTimeW, Real( 1.0f ) ) );
+            }
+
+            inOutPos += Math::lerp( itPrev->position, itNext->position, fTimeW );
+            inOutRot = inOutRot * Quaternion::nlerp( fTimeW, itPrev->orientation,
+                                                     itNext->orientation, true );
+            inOutScale *= Math::lerp( itPrev->scale, itNext->scale, fTimeW );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    BakedSkeletonAnimation::BakedSkeletonAnimation( const SkeletonDef *skeletonDef,
+                                                    VaoManager *vaoManager, Real sampleRate ) :
+        mSkeletonDef( skeletonDef ),
+        mSampleRate( sampleRate ),
+        mBoneMatrices( 0 ),
+        mVaoManager( vaoManager )
+    {
+        bake();
+    }
+    //-----------------------------------------------------------------------------------
+    BakedSkeletonAnimation::~BakedSkeletonAnimation()
+    {
+        FastArray<SkeletonInstance*>::const_iterator itor = mInstances.begin();
+        FastArray<SkeletonInstance*>::const_iterator end  = mInstances.end();
+        while( itor != end )
+            (*itor++)->_setBakedAnimationSet( 0 );
+        mInstances.clear();
+        mRefCounts.clear();
+
+        if( mBoneMatrices )
+        {
+            mVaoManager->destroyTexBuffer( mBoneMatrices );
+            mBoneMatrices = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BakedSkeletonAnimation::bake(void)
+    {
+        const SkeletonDef::BoneDataVec &bones = mSkeletonDef->getBones();
+        const SkeletonDef::BoneToSlotVec &boneToSlot = mSkeletonDef->getBoneToSlot();
+        const SkeletonDef::IndexToIndexMap &slotToBone = mSkeletonDef->getSlotToBone();
+        const SkeletonAnimationDefVec &animationDefs = mSkeletonDef->getAnimationDefs();
+
+        const size_t numBones = bones.size();
+
+        //Parents must be evaluated before their children. Sorting by slot sorts by depth level
+        vector<uint32>::type updateOrder;
+        {
+            vector<std::pair<uint32, uint32> >::type slots;
+            slots.reserve( numBones );
+            for( size_t i=0; i<numBones; ++i )
+                slots.push_back( std::pair<uint32, uint32>( boneToSlot[i], static_cast<uint32>( i ) ) );
+            std::sort( slots.begin(), slots.end() );
+
+            updateOrder.reserve( numBones );
+            for( size_t i=0; i<numBones; ++i )
+                updateOrder.push_back( slots[i].second );
+        }
+
+        //Reverse bind pose is in SoA, in blocks per depth level
+        vector<Matrix4>::type reverseBindPose( numBones, Matrix4::IDENTITY );
+        {
+            ArrayMatrixAf4x3 const *reverseBind = mSkeletonDef->getReverseBindPose().get();
+            for( size_t i=0; i<numBones; ++i )
+            {
+                const size_t level  = boneToSlot[i] >> 24u;
+                const size_t offset = boneToSlot[i] & 0x00FFFFFF;
+
+                SimpleMatrixAf4x3 reverseBindAoS[ARRAY_PACKED_REALS];
+                reverseBind[mSkeletonDef->getNumberOfBoneBlocks( level ) +
+                            offset / ARRAY_PACKED_REALS].storeToAoS( reverseBindAoS );
+                OGRE_SIMD_ALIGNED_DECL( float, rows[12] );
+                reverseBindAoS[offset % ARRAY_PACKED_REALS].store4x3( rows );
+                for( size_t y=0; y<3u; ++y )
+                {
+                    for( size_t x=0; x<4u; ++x )
+                        reverseBindPose[i][y][x] = rows[y * 4u + x];
+                }
+            }
+        }
+
+        size_t totalSamples = 0;
+        mAnimations.reserve( animationDefs.size() );
+
+        SkeletonAnimationDefVec::const_iterator itAnim = animationDefs.begin();
+        SkeletonAnimationDefVec::const_iterator enAnim = animationDefs.end();
+        while( itAnim != enAnim )
+        {
+            const Real frameRate = itAnim->getOriginalFrameRate();
+            const Real sampleRate = mSampleRate > Real( 0.0f ) ? mSampleRate : frameRate;
+
+            BakedAnimation bakedAnim;
+            bakedAnim.name          = itAnim->getNameStr();
+            bakedAnim.firstFrame    = static_cast<uint32>( totalSamples * numBones * 3u );
+            bakedAnim.duration      = itAnim->getNumFrames() / frameRate;
+            bakedAnim.numSamples    = std::max( 1u, static_cast<uint32>(
+                                                    Math::Ceil( bakedAnim.duration * sampleRate ) ) );
+            mAnimations.push_back( bakedAnim );
+
+            totalSamples += bakedAnim.numSamples;
+            ++itAnim;
+        }
+
+        if( numBones * totalSamples * 3u > std::numeric_limits<uint32>::max() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Too many samples baking skeleton '" + mSkeletonDef->getNameStr() +
+                         "'. Lower the sample rate",
+                         "BakedSkeletonAnimation::bake" );
+        }
+
+        //Holds the 3x4 matrices of all bones, for all samples of all animations
+        FastArray<float> data;
+        data.resizePOD( std::max<size_t>( totalSamples, 1u ) * numBones * 12u );
+        float * RESTRICT_ALIAS dst = data.begin();
+
+        vector<BakeKeyFrameVec>::type boneKeyFrames( numBones );
+        vector<Matrix4>::type derived( numBones );
+
+        for( size_t animIdx=0; animIdx<animationDefs.size(); ++animIdx )
+        {
+            const SkeletonAnimationDef &animationDef = animationDefs[animIdx];
+
+            //Gather the keyframes of each bone in AoS
+            for( size_t i=0; i<numBones; ++i )
+                boneKeyFrames[i].clear();
+
+            const SkeletonTrackVec &tracks = animationDef.getTracks();
+            SkeletonTrackVec::const_iterator itTrack = tracks.begin();
+            SkeletonTrackVec::const_iterator enTrack = tracks.end();
+            while( itTrack != enTrack )
+            {
+                const KeyFrameRigVec &keyFrames = itTrack->getKeyFrames();
+                const uint32 slotStart = SkeletonDef::blockIdxToSlotStart( itTrack->getBoneBlockIdx() );
+
+                for( uint32 lane=0; lane<ARRAY_PACKED_REALS; ++lane )
+                {
+                    //Slots past the end of the level are repeated patterns. Skip them.
+                    SkeletonDef::IndexToIndexMap::const_iterator itSlotToBone =
+                            slotToBone.find( slotStart + lane );
+                    if( itSlotToBone == slotToBone.end() )
+                        continue;
+
+                    BakeKeyFrameVec &dstKeyFrames = boneKeyFrames[itSlotToBone->second];
+                    dstKeyFrames.resize( keyFrames.size() );
+
+                    KfTransform kfTransform;
+                    for( size_t k=0; k<keyFrames.size(); ++k )
+                    {
+                        itTrack->getKeyFrameTransform( k, kfTransform );
+                        dstKeyFrames[k].frame = keyFrames[k].mFrame;
+                        kfTransform.mPosition.getAsVector3( dstKeyFrames[k].position, lane );
+                        kfTransform.mOrientation.getAsQuaternion( dstKeyFrames[k].orientation, lane );
+                        kfTransform.mScale.getAsVector3( dstKeyFrames[k].scale, lane );
+                    }
+                }
+
+                ++itTrack;
+            }
+
+            const BakedAnimation &bakedAnim = mAnimations[animIdx];
+            const Real frameRate = animationDef.getOriginalFrameRate();
+            const Real sampleRate = mSampleRate > Real( 0.0f ) ? mSampleRate : frameRate;
+
+            for( uint32 sample=0; sample<bakedAnim.numSamples; ++sample )
+            {
+                const Real frame = std::min( ( Real( sample ) / sampleRate ) * frameRate,
+                                             animationDef.getNumFrames() );
+
+                vector<uint32>::type::const_iterator itBone = updateOrder.begin();
+                vector<uint32>::type::const_iterator enBone = updateOrder.end();
+                while( itBone != enBone )
+                {
+                    const uint32 boneIdx = *itBone;
+                    const SkeletonDef::BoneData &boneData = bones[boneIdx];
+
+                    Vector3 vPos = boneData.vPos;
+                    Quaternion qRot = boneData.qRot;
+                    Vector3 vScale = boneData.vScale;
+                    if( !boneKeyFrames[boneIdx].empty() )
+                        sampleKeyFrames( boneKeyFrames[boneIdx], frame, vPos, qRot, vScale );
+
+                    Matrix4 localMat;
+                    localMat.makeTransform( vPos, vScale, qRot );
+
+                    if( boneData.parent != std::numeric_limits<size_t>::max() )
+                    {
+                        derived[boneIdx] = retain( derived[boneData.parent],
+                                                   boneData.bInheritOrientation,
+                                                   boneData.bInheritScale ).
+                                                concatenateAffine( localMat );
+                    }
+                    else
+                    {
+                        derived[boneIdx] = localMat;
+                    }
+
+                    const Matrix4 finalMat = derived[boneIdx].concatenateAffine(
+                                                 reverseBindPose[boneIdx] );
+
+                    float * RESTRICT_ALIAS boneDst = dst + boneIdx * 12u;
+                    for( size_t y=0; y<3u; ++y )
+                    {
+                        for( size_t x=0; x<4u; ++x )
+                            *boneDst++ = static_cast<float>( finalMat[y][x] );
+                    }
+
+                    ++itBone;
+                }
+
+                dst += numBones * 12u;
+            }
+        }
+
+        mBoneMatrices = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT, data.size() * sizeof( float ),
+                                                      BT_IMMUTABLE, data.begin(), false );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 BakedSkeletonAnimation::getAnimationIndex( IdString name ) const
+    {
+        BakedAnimationVec::const_iterator itor = mAnimations.begin();
+        BakedAnimationVec::const_iterator end  = mAnimations.end();
+        while( itor != end && itor->name != name )
+            ++itor;
+
+        if( itor == end )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Animation '" + name.getFriendlyText() + "' not found in skeleton '" +
+                         mSkeletonDef->getNameStr() + "'",
+                         "BakedSkeletonAnimation::getAnimationIndex" );
+        }
+
+        return static_cast<uint32>( itor - mAnimations.begin() );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 BakedSkeletonAnimation::getFrameOffset( uint32 animIdx, Real time ) const
+    {
+        if( mAnimations.empty() )
+            return 0;
+
+        const BakedAnimation &bakedAnim = mAnimations[std::min<size_t>( animIdx,
+                                                                        mAnimations.size() - 1u )];
+        Real normalizedTime = 0;
+        if( bakedAnim.duration > Real( 0.0f ) )
+        {
+            normalizedTime = Math::Abs( fmod( time, bakedAnim.duration ) );
+            if( time < Real( 0.0f ) )
+                normalizedTime = bakedAnim.duration - normalizedTime;
+            normalizedTime /= bakedAnim.duration;
+        }
+
+        //Round to the closest sample. The last one wraps around to the first one
+        const uint32 sample = static_cast<uint32>( normalizedTime * Real( bakedAnim.numSamples ) +
+                                                   Real( 0.5f ) ) % bakedAnim.numSamples;
+        const uint32 numBones = static_cast<uint32>( mSkeletonDef->getBones().size() );
+
+        return bakedAnim.firstFrame + sample * numBones * 3u;
+    }
+    //-----------------------------------------------------------------------------------
+    void BakedSkeletonAnimation::addItem( Item *item )
+    {
+        SkeletonInstance *skeleton = item->getSkeletonInstance();
+        if( !skeleton || skeleton->getDefinition() != mSkeletonDef )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Item '" + item->getName() + "' doesn't use skeleton '" +
+                         mSkeletonDef->getNameStr() + "'",
+                         "BakedSkeletonAnimation::addItem" );
+        }
+
+        if( skeleton->getGpuEvaluator() ||
+            ( skeleton->getBakedAnimationSet() && skeleton->getBakedAnimationSet() != this ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Item '" + item->getName() + "' is already animated by a "
+                         "GpuSkeletonEvaluator or another BakedSkeletonAnimation",
+                         "BakedSkeletonAnimation::addItem" );
+        }
+
+        FastArray<SkeletonInstance*>::iterator itSkel = std::find( mInstances.begin(),
+                                                                   mInstances.end(), skeleton );
+        if( itSkel == mInstances.end() )
+        {
+            mInstances.push_back( skeleton );
+            mRefCounts.push_back( 1u );
+            skeleton->_setBakedAnimationSet( this );
+        }
+        else
+        {
+            ++mRefCounts[itSkel - mInstances.begin()];
+        }
+
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i=0; i<numSubItems; ++i )
+        {
+            SubItem *subItem = item->getSubItem( i );
+            if( !subItem->hasBakedSkeletonAnimation() )
+            {
+                subItem->_setBakedSkeletonAnimation( true );
+                HlmsDatablock *datablock = subItem->getDatablock();
+                if( datablock )
+                {
+                    //Force the Hlms hash to be recalculated
+                    subItem->_setNullDatablock();
+                    subItem->setDatablock( datablock );
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BakedSkeletonAnimation::removeItem( Item *item )
+    {
+        SkeletonInstance *skeleton = item->getSkeletonInstance();
+        if( !skeleton || skeleton->getBakedAnimationSet() != this )
+            return;
+
+        removeSkeletonInstance( skeleton, false );
+
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i=0; i<numSubItems; ++i )
+        {
+            SubItem *subItem = item->getSubItem( i );
+            if( subItem->hasBakedSkeletonAnimation() )
+            {
+                subItem->_setBakedSkeletonAnimation( false );
+                HlmsDatablock *datablock = subItem->getDatablock();
+                if( datablock )
+                {
+                    subItem->_setNullDatablock();
+                    subItem->setDatablock( datablock );
+                }
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BakedSkeletonAnimation::removeSkeletonInstance( SkeletonInstance *skeleton, bool bForce )
+    {
+        FastArray<SkeletonInstance*>::iterator itSkel = std::find( mInstances.begin(),
+                                                                   mInstances.end(), skeleton );
+        if( itSkel == mInstances.end() )
+            return;
+
+        const size_t idx = itSkel - mInstances.begin();
+        if( !bForce && --mRefCounts[idx] != 0u )
+            return;
+
+        FastArray<uint32>::iterator itRefCount = mRefCounts.begin() + idx;
+        efficientVectorRemove( mInstances, itSkel );
+        efficientVectorRemove( mRefCounts, itRefCount );
+        skeleton->_setBakedAnimationSet( 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void BakedSkeletonAnimation::_notifySkeletonInstanceDestroyed( SkeletonInstance *skeleton )
+    {
+        removeSkeletonInstance( skeleton, true );
+    }
+}
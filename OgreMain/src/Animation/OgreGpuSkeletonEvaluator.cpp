@@ -0,0 +1,711 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Animation/OgreGpuSkeletonEvaluator.h"
+#include "Animation/OgreSkeletonDef.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "Animation/OgreSkeletonAnimationDef.h"
+
+#include "Compositor/OgreCompositorManager2.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreHlmsDatablock.h"
+#include "OgreRenderSystem.h"
+#include "OgreItem.h"
+#include "OgreSubItem.h"
+#include "OgreStringConverter.h"
+#include "OgreId.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace Ogre
+{
+    const uint32 GpuSkeletonEvaluator::MaxBones = 256u;
+    const uint32 GpuSkeletonEvaluator::MaxActiveAnimations = 4u;
+
+    static const char *c_jobName = "GpuSkeleton/Evaluate";
+    /// float4 per instance in SkeletonDefGroup::instanceData:
+    ///     [0] = bone offset, num active animations
+    ///     [1..3] = world matrix of the parent node
+    ///     [4..7] = animation index, frame, weight (one per active animation)
+    static const size_t c_instanceDataStride = 4u + GpuSkeletonEvaluator::MaxActiveAnimations;
+    /// Max thread groups in X per dispatch (D3D11 limit). We go 2D when exceeded
+    static const uint32 c_maxThreadGroupsX = 65535u;
+
+    static inline float asFloat( uint32 value )
+    {
+        float retVal;
+        memcpy( &retVal, &value, sizeof( retVal ) );
+        return retVal;
+    }
+
+    static inline void pushFloat4( FastArray<float> &data, float x, float y, float z, float w )
+    {
+        data.push_back( x );
+        data.push_back( y );
+        data.push_back( z );
+        data.push_back( w );
+    }
+
+    /// Forces the Hlms hash to be recalculated (e.g. after _setGpuSkeletonAnimation)
+    static void recalculateHlmsHash( Renderable *renderable )
+    {
+        HlmsDatablock *datablock = renderable->getDatablock();
+        if( datablock )
+        {
+            renderable->_setNullDatablock();
+            renderable->setDatablock( datablock );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    GpuSkeletonEvaluator::GpuSkeletonEvaluator( HlmsManager *hlmsManager, VaoManager *vaoManager,
+                                                CompositorManager2 *compositorManager ) :
+        mBoneMatrices( 0 ),
+        mBoneMatricesView( 0 ),
+        mBoneOffsetsDirty( false ),
+        mHlmsCompute( hlmsManager->getComputeHlms() ),
+        mVaoManager( vaoManager ),
+        mRenderSystem( hlmsManager->getRenderSystem() ),
+        mCompositorManager( compositorManager )
+    {
+        if( mRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+        {
+            //The vertex shaders of the previous frame read the matrices as a texture buffer
+            mToUavTransition.oldLayout = ResourceLayout::Texture;
+            mToUavTransition.newLayout = ResourceLayout::Uav;
+            mToUavTransition.writeBarrierBits = 0;
+            mToUavTransition.readBarrierBits  = ReadBarrier::Uav;
+            mRenderSystem->_resourceTransitionCreated( &mToUavTransition );
+        }
+
+        //We wrote to mBoneMatrices, the vertex shaders will read mBoneMatricesView
+        mToTextureTransition.oldLayout = ResourceLayout::Uav;
+        mToTextureTransition.newLayout = ResourceLayout::Texture;
+        mToTextureTransition.writeBarrierBits = WriteBarrier::Uav;
+        mToTextureTransition.readBarrierBits  = ReadBarrier::Texture;
+        mRenderSystem->_resourceTransitionCreated( &mToTextureTransition );
+
+        mCompositorManager->addListener( this );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuSkeletonEvaluator::~GpuSkeletonEvaluator()
+    {
+        mCompositorManager->removeListener( this );
+
+        SkeletonDefGroupVec::iterator itor = mGroups.begin();
+        SkeletonDefGroupVec::iterator end  = mGroups.end();
+
+        while( itor != end )
+        {
+            FastArray<SkeletonInstance*>::const_iterator itSkel = itor->instances.begin();
+            FastArray<SkeletonInstance*>::const_iterator enSkel = itor->instances.end();
+            while( itSkel != enSkel )
+                (*itSkel++)->_setGpuEvaluator( 0 );
+
+            destroyGroup( *itor );
+            ++itor;
+        }
+        mGroups.clear();
+
+        if( mBoneMatrices )
+        {
+            mVaoManager->destroyUavBuffer( mBoneMatrices );
+            mBoneMatrices = 0;
+            mBoneMatricesView = 0;
+        }
+
+        if( mRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+            mRenderSystem->_resourceTransitionDestroyed( &mToUavTransition );
+        mRenderSystem->_resourceTransitionDestroyed( &mToTextureTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsComputeJob* GpuSkeletonEvaluator::createJob(void)
+    {
+    #if OGRE_NO_JSON
+        OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                     "GpuSkeletonEvaluator requires Ogre to be built with JSON support "
+                     "and you must include the resources bundled at "
+                     "Samples/Media/2.0/scripts/materials/Common",
+                     "GpuSkeletonEvaluator::createJob" );
+    #endif
+        HlmsComputeJob *baseJob = mHlmsCompute->findComputeJobNoThrow( c_jobName );
+
+        if( !baseJob )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "To use GpuSkeletonEvaluator, you must include the resources "
+                         "bundled at Samples/Media/2.0/scripts/materials/Common\n"
+                         "Could not find " + String( c_jobName ),
+                         "GpuSkeletonEvaluator::createJob" );
+        }
+
+        const String newId = StringConverter::toString( Id::generateNewId<GpuSkeletonEvaluator>() );
+        return baseJob->clone( String( c_jobName ) + " " + newId );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::createSkeletonData( SkeletonDefGroup &group )
+    {
+        /*  Layout of skeletonData, in float4 (uints are stored as their bits):
+                [0] = numBones, numDepthLevels, numAnimations, trackDescStart
+                Then the index of the first bone of each depth level (plus one extra
+                entry with numBones), 4 per float4.
+                Then 6 float4 per bone, sorted by depth level:
+                    bind position, parent bone (0xFFFFFFFF if root)
+                    bind orientation
+                    bind scale, flags (inheritOrientation | inheritScale << 1 | boneIdx << 2)
+                    reverse bind pose (3 rows)
+                Then at trackDescStart, numAnimations * numBones track descriptors:
+                    index to the first keyframe, num keyframes
+                Then the keyframes, 3 float4 each:
+                    position, frame
+                    orientation
+                    scale
+        */
+        const SkeletonDef *skeletonDef = group.skeletonDef;
+        const SkeletonDef::BoneDataVec &bones = skeletonDef->getBones();
+        const SkeletonDef::BoneToSlotVec &boneToSlot = skeletonDef->getBoneToSlot();
+        const SkeletonDef::IndexToIndexMap &slotToBone = skeletonDef->getSlotToBone();
+        const SkeletonDef::DepthLevelInfoVec &depthLevelInfo = skeletonDef->getDepthLevelInfo();
+        const SkeletonAnimationDefVec &animationDefs = skeletonDef->getAnimationDefs();
+
+        const uint32 numBones = static_cast<uint32>( bones.size() );
+        const uint32 numLevels = static_cast<uint32>( depthLevelInfo.size() );
+        const uint32 numAnimations = static_cast<uint32>( animationDefs.size() );
+
+        //Sorting by slot sorts by depth level, and within the level by SIMD slot
+        vector<uint32>::type gpuToBone( numBones );
+        vector<uint32>::type boneToGpu( numBones );
+        {
+            vector<std::pair<uint32, uint32> >::type slots;
+            slots.reserve( numBones );
+            for( uint32 i=0; i<numBones; ++i )
+                slots.push_back( std::pair<uint32, uint32>( boneToSlot[i], i ) );
+            std::sort( slots.begin(), slots.end() );
+
+            for( uint32 i=0; i<numBones; ++i )
+            {
+                gpuToBone[i] = slots[i].second;
+                boneToGpu[slots[i].second] = i;
+            }
+        }
+
+        const uint32 numLevelStartVec4 = ( numLevels + 1u + 3u ) / 4u;
+        const uint32 boneDataStart = 1u + numLevelStartVec4;
+        const uint32 trackDescStart = boneDataStart + numBones * 6u;
+        const uint32 keyFrameStart = trackDescStart + numAnimations * numBones;
+
+        FastArray<float> data;
+        data.reserve( keyFrameStart * 4u );
+
+        pushFloat4( data, asFloat( numBones ), asFloat( numLevels ),
+                    asFloat( numAnimations ), asFloat( trackDescStart ) );
+
+        {
+            uint32 levelStart = 0;
+            for( uint32 i=0; i<numLevelStartVec4 * 4u; ++i )
+            {
+                data.push_back( asFloat( levelStart ) );
+                if( i < numLevels )
+                    levelStart += static_cast<uint32>( depthLevelInfo[i].numBonesInLevel );
+            }
+        }
+
+        ArrayMatrixAf4x3 const *reverseBindPose = skeletonDef->getReverseBindPose().get();
+
+        for( uint32 i=0; i<numBones; ++i )
+        {
+            const SkeletonDef::BoneData &boneData = bones[gpuToBone[i]];
+
+            const uint32 parentIdx = boneData.parent != std::numeric_limits<size_t>::max() ?
+                                         boneToGpu[boneData.parent] : 0xFFFFFFFFu;
+            const uint32 flags = ( boneData.bInheritOrientation ? 1u : 0u ) |
+                                 ( boneData.bInheritScale ? 2u : 0u ) | ( gpuToBone[i] << 2u );
+
+            pushFloat4( data, static_cast<float>( boneData.vPos.x ),
+                        static_cast<float>( boneData.vPos.y ),
+                        static_cast<float>( boneData.vPos.z ), asFloat( parentIdx ) );
+            pushFloat4( data, static_cast<float>( boneData.qRot.x ),
+                        static_cast<float>( boneData.qRot.y ),
+                        static_cast<float>( boneData.qRot.z ),
+                        static_cast<float>( boneData.qRot.w ) );
+            pushFloat4( data, static_cast<float>( boneData.vScale.x ),
+                        static_cast<float>( boneData.vScale.y ),
+                        static_cast<float>( boneData.vScale.z ), asFloat( flags ) );
+
+            //Reverse bind pose is in SoA, in blocks per depth level
+            const uint32 slotIdx = boneToSlot[gpuToBone[i]];
+            const size_t level  = slotIdx >> 24u;
+            const size_t offset = slotIdx & 0x00FFFFFF;
+
+            SimpleMatrixAf4x3 reverseBindAoS[ARRAY_PACKED_REALS];
+            reverseBindPose[skeletonDef->getNumberOfBoneBlocks( level ) +
+                            offset / ARRAY_PACKED_REALS].storeToAoS( reverseBindAoS );
+            OGRE_SIMD_ALIGNED_DECL( float, rows[12] );
+            reverseBindAoS[offset % ARRAY_PACKED_REALS].store4x3( rows );
+            for( size_t j=0; j<12u; ++j )
+                data.push_back( rows[j] );
+        }
+
+        //Track descriptors get filled as we go through the keyframes
+        const size_t trackDescDataStart = data.size();
+        data.resize( data.size() + numAnimations * numBones * 4u, 0.0f );
+
+        uint32 nextKeyFrame = keyFrameStart;
+
+        for( uint32 animIdx=0; animIdx<numAnimations; ++animIdx )
+        {
+            const SkeletonTrackVec &tracks = animationDefs[animIdx].getTracks();
+            SkeletonTrackVec::const_iterator itor = tracks.begin();
+            SkeletonTrackVec::const_iterator end  = tracks.end();
+
+            while( itor != end )
+            {
+                const SkeletonTrack &track = *itor;
+                const KeyFrameRigVec &keyFrames = track.getKeyFrames();
+                const uint32 numKeyFrames = static_cast<uint32>( keyFrames.size() );
+                const uint32 slotStart = SkeletonDef::blockIdxToSlotStart( track.getBoneBlockIdx() );
+
+                for( uint32 lane=0; lane<ARRAY_PACKED_REALS; ++lane )
+                {
+                    //Slots past the end of the level are repeated patterns. Skip them.
+                    SkeletonDef::IndexToIndexMap::const_iterator itSlotToBone =
+                            slotToBone.find( slotStart + lane );
+                    if( itSlotToBone == slotToBone.end() )
+                        continue;
+
+                    const uint32 gpuBoneIdx = boneToGpu[itSlotToBone->second];
+                    float *trackDesc = data.begin() + trackDescDataStart +
+                                       ( animIdx * numBones + gpuBoneIdx ) * 4u;
+                    trackDesc[0] = asFloat( nextKeyFrame );
+                    trackDesc[1] = asFloat( numKeyFrames );
+
+                    KfTransform kfTransform;
+                    for( uint32 k=0; k<numKeyFrames; ++k )
+                    {
+                        track.getKeyFrameTransform( k, kfTransform );
+
+                        Vector3 vPos, vScale;
+                        Quaternion qRot;
+                        kfTransform.mPosition.getAsVector3( vPos, lane );
+                        kfTransform.mOrientation.getAsQuaternion( qRot, lane );
+                        kfTransform.mScale.getAsVector3( vScale, lane );
+
+                        pushFloat4( data, static_cast<float>( vPos.x ),
+                                    static_cast<float>( vPos.y ), static_cast<float>( vPos.z ),
+                                    static_cast<float>( keyFrames[k].mFrame ) );
+                        pushFloat4( data, static_cast<float>( qRot.x ),
+                                    static_cast<float>( qRot.y ), static_cast<float>( qRot.z ),
+                                    static_cast<float>( qRot.w ) );
+                        pushFloat4( data, static_cast<float>( vScale.x ),
+                                    static_cast<float>( vScale.y ),
+                                    static_cast<float>( vScale.z ), 0.0f );
+                    }
+
+                    nextKeyFrame += numKeyFrames * 3u;
+                }
+
+                ++itor;
+            }
+        }
+
+        group.skeletonData = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT,
+                                                           data.size() * sizeof( float ),
+                                                           BT_IMMUTABLE, data.begin(), false );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::destroyGroup( SkeletonDefGroup &group )
+    {
+        if( group.instanceData )
+        {
+            mVaoManager->destroyTexBuffer( group.instanceData );
+            group.instanceData = 0;
+        }
+        if( group.skeletonData )
+        {
+            mVaoManager->destroyTexBuffer( group.skeletonData );
+            group.skeletonData = 0;
+        }
+        if( group.job )
+        {
+            mHlmsCompute->destroyComputeJob( group.job->getName() );
+            group.job = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::addSkeletonInstance( SkeletonInstance *skeleton )
+    {
+        if( skeleton->getGpuEvaluator() && skeleton->getGpuEvaluator() != this )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "SkeletonInstance is already being evaluated by another "
+                         "GpuSkeletonEvaluator",
+                         "GpuSkeletonEvaluator::addSkeletonInstance" );
+        }
+        if( skeleton->getBakedAnimationSet() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "SkeletonInstance is already animated by a BakedSkeletonAnimation",
+                         "GpuSkeletonEvaluator::addSkeletonInstance" );
+        }
+
+        const SkeletonDef *skeletonDef = skeleton->getDefinition();
+
+        SkeletonDefGroupVec::iterator itGroup = mGroups.begin();
+        SkeletonDefGroupVec::iterator enGroup = mGroups.end();
+        while( itGroup != enGroup && itGroup->skeletonDef != skeletonDef )
+            ++itGroup;
+
+        if( itGroup == enGroup )
+        {
+            if( skeletonDef->getBones().size() > MaxBones )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Skeleton '" + skeletonDef->getNameStr() + "' has " +
+                             StringConverter::toString( skeletonDef->getBones().size() ) +
+                             " bones. Only up to " + StringConverter::toString( MaxBones ) +
+                             " are supported by GpuSkeletonEvaluator",
+                             "GpuSkeletonEvaluator::addSkeletonInstance" );
+            }
+
+            SkeletonDefGroup group;
+            group.skeletonDef   = skeletonDef;
+            group.skeletonData  = 0;
+            group.instanceData  = 0;
+            group.job           = 0;
+
+            try
+            {
+                group.job = createJob();
+                createSkeletonData( group );
+            }
+            catch( Exception & )
+            {
+                destroyGroup( group );
+                throw;
+            }
+
+            mGroups.push_back( group );
+            itGroup = mGroups.end() - 1u;
+        }
+
+        FastArray<SkeletonInstance*>::iterator itSkel = std::find( itGroup->instances.begin(),
+                                                                   itGroup->instances.end(),
+                                                                   skeleton );
+        if( itSkel == itGroup->instances.end() )
+        {
+            itGroup->instances.push_back( skeleton );
+            itGroup->refCounts.push_back( 1u );
+            skeleton->_setGpuEvaluator( this );
+            mBoneOffsetsDirty = true;
+        }
+        else
+        {
+            ++itGroup->refCounts[itSkel - itGroup->instances.begin()];
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuSkeletonEvaluator::removeSkeletonInstance( SkeletonInstance *skeleton, bool bForce )
+    {
+        SkeletonDefGroupVec::iterator itGroup = mGroups.begin();
+        SkeletonDefGroupVec::iterator enGroup = mGroups.end();
+        while( itGroup != enGroup && itGroup->skeletonDef != skeleton->getDefinition() )
+            ++itGroup;
+
+        if( itGroup == enGroup )
+            return false;
+
+        FastArray<SkeletonInstance*>::iterator itSkel = std::find( itGroup->instances.begin(),
+                                                                   itGroup->instances.end(),
+                                                                   skeleton );
+        if( itSkel == itGroup->instances.end() )
+            return false;
+
+        const size_t idx = itSkel - itGroup->instances.begin();
+        if( !bForce && --itGroup->refCounts[idx] != 0u )
+            return false;
+
+        FastArray<uint32>::iterator itRefCount = itGroup->refCounts.begin() + idx;
+        efficientVectorRemove( itGroup->instances, itSkel );
+        efficientVectorRemove( itGroup->refCounts, itRefCount );
+        skeleton->_setGpuEvaluator( 0 );
+        mBoneOffsetsDirty = true;
+
+        //Keep the group around even if empty; the same skeleton is likely to be used again
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::updateBoneOffsets(void)
+    {
+        uint32 numVec4 = 0;
+
+        SkeletonDefGroupVec::const_iterator itGroup = mGroups.begin();
+        SkeletonDefGroupVec::const_iterator enGroup = mGroups.end();
+
+        while( itGroup != enGroup )
+        {
+            const uint32 numBones = static_cast<uint32>( itGroup->skeletonDef->getBones().size() );
+
+            FastArray<SkeletonInstance*>::const_iterator itSkel = itGroup->instances.begin();
+            FastArray<SkeletonInstance*>::const_iterator enSkel = itGroup->instances.end();
+            while( itSkel != enSkel )
+            {
+                (*itSkel)->_setGpuBoneOffset( numVec4 );
+                numVec4 += numBones * 3u;
+                ++itSkel;
+            }
+
+            ++itGroup;
+        }
+
+        if( numVec4 && ( !mBoneMatrices || mBoneMatrices->getNumElements() < numVec4 ) )
+        {
+            if( mBoneMatrices )
+                mVaoManager->destroyUavBuffer( mBoneMatrices );
+
+            //Grow some more to avoid reallocating every time a few instances are added
+            mBoneMatrices = mVaoManager->createUavBuffer( numVec4 + ( numVec4 >> 1u ),
+                                                          sizeof( float ) * 4u,
+                                                          BB_FLAG_UAV|BB_FLAG_TEX, 0, false );
+            mBoneMatricesView = mBoneMatrices->getAsTexBufferView( PFG_RGBA32_FLOAT );
+        }
+
+        mBoneOffsetsDirty = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::fillInstanceData( const SkeletonDefGroup &group )
+    {
+        const SkeletonAnimationDefVec &animationDefs = group.skeletonDef->getAnimationDefs();
+
+        mInstanceScratch.resizePOD( group.instances.size() * c_instanceDataStride * 4u );
+        float * RESTRICT_ALIAS dst = mInstanceScratch.begin();
+
+        FastArray<SkeletonInstance*>::const_iterator itSkel = group.instances.begin();
+        FastArray<SkeletonInstance*>::const_iterator enSkel = group.instances.end();
+
+        while( itSkel != enSkel )
+        {
+            const SkeletonInstance *skeleton = *itSkel;
+            float * RESTRICT_ALIAS instanceStart = dst;
+
+            uint32 numActiveAnimations = 0;
+            float * RESTRICT_ALIAS animDst = instanceStart + 4u * 4u;
+
+            const ActiveAnimationsVec &activeAnimations = skeleton->getActiveAnimations();
+            ActiveAnimationsVec::const_iterator itAnim = activeAnimations.begin();
+            ActiveAnimationsVec::const_iterator enAnim = activeAnimations.end();
+
+            while( itAnim != enAnim && numActiveAnimations < MaxActiveAnimations )
+            {
+                const SkeletonAnimation *animation = *itAnim;
+                const SkeletonAnimationDef *animationDef = animation->getDefinition();
+
+                //Animations from other SkeletonDefs (addAnimationsFromSkeleton) aren't uploaded
+                size_t animIdx = animationDefs.size();
+                if( !animationDefs.empty() && animationDef >= &animationDefs.front() &&
+                    animationDef <= &animationDefs.back() )
+                {
+                    animIdx = static_cast<size_t>( animationDef - &animationDefs.front() );
+                }
+
+                if( animIdx < animationDefs.size() && animation->mWeight != Real( 0.0f ) )
+                {
+                    animDst[0] = asFloat( static_cast<uint32>( animIdx ) );
+                    animDst[1] = static_cast<float>( animation->getCurrentFrame() );
+                    animDst[2] = static_cast<float>( animation->mWeight );
+                    animDst[3] = 0.0f;
+                    animDst += 4u;
+                    ++numActiveAnimations;
+                }
+
+                ++itAnim;
+            }
+
+            instanceStart[0] = asFloat( skeleton->_getGpuBoneOffset() );
+            instanceStart[1] = asFloat( numActiveAnimations );
+            instanceStart[2] = 0.0f;
+            instanceStart[3] = 0.0f;
+
+            const Node *parentNode = skeleton->getParentNode();
+            const Matrix4 &nodeMat = parentNode ? parentNode->_getFullTransform() : Matrix4::IDENTITY;
+            for( size_t y=0; y<3u; ++y )
+            {
+                for( size_t x=0; x<4u; ++x )
+                    instanceStart[4u + y * 4u + x] = static_cast<float>( nodeMat[y][x] );
+            }
+
+            dst += c_instanceDataStride * 4u;
+            ++itSkel;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuSkeletonEvaluator::isSupported(void) const
+    {
+        return mRenderSystem->getCapabilities()->hasCapability( RSC_COMPUTE_PROGRAM );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::addItem( Item *item )
+    {
+        SkeletonInstance *skeleton = item->getSkeletonInstance();
+        if( !skeleton )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Item '" + item->getName() + "' has no skeleton",
+                         "GpuSkeletonEvaluator::addItem" );
+        }
+
+        addSkeletonInstance( skeleton );
+
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i=0; i<numSubItems; ++i )
+        {
+            SubItem *subItem = item->getSubItem( i );
+            if( !subItem->hasGpuSkeletonAnimation() )
+            {
+                subItem->_setGpuSkeletonAnimation( true );
+                recalculateHlmsHash( subItem );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::removeItem( Item *item )
+    {
+        SkeletonInstance *skeleton = item->getSkeletonInstance();
+        if( !skeleton || skeleton->getGpuEvaluator() != this )
+            return;
+
+        removeSkeletonInstance( skeleton, false );
+
+        const size_t numSubItems = item->getNumSubItems();
+        for( size_t i=0; i<numSubItems; ++i )
+        {
+            SubItem *subItem = item->getSubItem( i );
+            if( subItem->hasGpuSkeletonAnimation() )
+            {
+                subItem->_setGpuSkeletonAnimation( false );
+                recalculateHlmsHash( subItem );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::_notifySkeletonInstanceDestroyed( SkeletonInstance *skeleton )
+    {
+        removeSkeletonInstance( skeleton, true );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::update(void)
+    {
+        if( mBoneOffsetsDirty )
+            updateBoneOffsets();
+
+        if( !mBoneMatrices )
+            return;
+
+        bool bFirstDispatch = true;
+
+        SkeletonDefGroupVec::iterator itGroup = mGroups.begin();
+        SkeletonDefGroupVec::iterator enGroup = mGroups.end();
+
+        while( itGroup != enGroup )
+        {
+            SkeletonDefGroup &group = *itGroup;
+            const uint32 numInstances = static_cast<uint32>( group.instances.size() );
+
+            if( numInstances )
+            {
+                fillInstanceData( group );
+
+                const size_t bytesNeeded = mInstanceScratch.size() * sizeof( float );
+                if( !group.instanceData || group.instanceData->getTotalSizeBytes() < bytesNeeded )
+                {
+                    if( group.instanceData )
+                        mVaoManager->destroyTexBuffer( group.instanceData );
+                    group.instanceData = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT,
+                                                                       bytesNeeded + ( bytesNeeded >> 1u ),
+                                                                       BT_DEFAULT, 0, false );
+                }
+                group.instanceData->upload( mInstanceScratch.begin(), 0,
+                                            bytesNeeded / group.instanceData->getBytesPerElement() );
+
+                HlmsComputeJob *job = group.job;
+
+                DescriptorSetTexture2::BufferSlot texBufSlot(
+                            DescriptorSetTexture2::BufferSlot::makeEmpty() );
+                texBufSlot.buffer = group.skeletonData;
+                job->setTexBuffer( 0, texBufSlot );
+                texBufSlot.buffer = group.instanceData;
+                job->setTexBuffer( 1, texBufSlot );
+
+                DescriptorSetUav::BufferSlot bufferSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+                bufferSlot.buffer = mBoneMatrices;
+                bufferSlot.access = ResourceAccess::Write;
+                job->_setUavBuffer( 0, bufferSlot );
+
+                //One threadgroup per instance
+                const uint32 groupsX = std::min( numInstances, c_maxThreadGroupsX );
+                const uint32 groupsY = ( numInstances + groupsX - 1u ) / groupsX;
+                job->setNumThreadGroups( groupsX, groupsY, 1u );
+
+                ShaderParams &shaderParams = job->getShaderParams( "default" );
+                ShaderParams::Param *param = shaderParams.findParameter( "numInstances" );
+                if( param )
+                    param->setManualValue( numInstances );
+                param = shaderParams.findParameter( "groupsPerRow" );
+                if( param )
+                    param->setManualValue( groupsX );
+                shaderParams.setDirty();
+
+                if( bFirstDispatch )
+                {
+                    mRenderSystem->endRenderPassDescriptor();
+                    if( mRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+                        mRenderSystem->_executeResourceTransition( &mToUavTransition );
+                    bFirstDispatch = false;
+                }
+
+                mHlmsCompute->dispatch( job, 0, 0 );
+            }
+
+            ++itGroup;
+        }
+
+        if( !bFirstDispatch )
+            mRenderSystem->_executeResourceTransition( &mToTextureTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuSkeletonEvaluator::allWorkspacesBeginUpdate(void)
+    {
+        update();
+    }
+}
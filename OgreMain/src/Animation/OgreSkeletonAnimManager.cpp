@@ -40,7 +40,8 @@ namespace Ogre
         skeletonDef( _skeletonDef ),
         skeletonDefName( _skeletonDef->getNameStr() )
     {
-        threadStarts.resize( threadCount + 1, 0 );
+        //Several chunks per thread so that idle threads have something to steal.
+        chunkStarts.resize( threadCount * 8u + 1u, 0 );
     }
     //-----------------------------------------------------------------------
     void BySkeletonDef::initializeMemoryManager(void)
@@ -51,14 +52,14 @@ namespace Ogre
         boneMemoryManager.setBoneRebaseListener( this );
     }
     //-----------------------------------------------------------------------
-    void BySkeletonDef::updateThreadStarts(void)
+    void BySkeletonDef::updateChunkStarts(void)
     {
         size_t lastStart = 0;
         size_t increments = std::max<size_t>( ARRAY_PACKED_REALS,
-                                              skeletons.size() / (threadStarts.size() - 1) );
-        for( size_t i=0; i<threadStarts.size(); ++i )
+                                              skeletons.size() / (chunkStarts.size() - 1) );
+        for( size_t i=0; i<chunkStarts.size(); ++i )
         {
-            threadStarts[i] = lastStart;
+            chunkStarts[i] = lastStart;
             lastStart += increments;
             lastStart = std::min( lastStart, skeletons.size() );
 
@@ -70,8 +71,8 @@ namespace Ogre
             }
         }
 
-        assert( threadStarts.back() <= skeletons.size() );
-        threadStarts.back() = skeletons.size();
+        assert( chunkStarts.back() <= skeletons.size() );
+        chunkStarts.back() = skeletons.size();
     }
     //-----------------------------------------------------------------------
     void BySkeletonDef::_updateBoneStartTransforms(void)
@@ -104,6 +105,7 @@ namespace Ogre
         FastArray<SkeletonInstance*> &skeletonsArray = bySkelDef.skeletons;
         SkeletonInstance *newInstance = OGRE_NEW SkeletonInstance( skeletonDef,
                                                                     &bySkelDef.boneMemoryManager );
+        newInstance->_setAnimationLodPhase( static_cast<uint32>( skeletonsArray.size() ) );
         FastArray<SkeletonInstance*>::iterator it = std::lower_bound(
                                                             skeletonsArray.begin(), skeletonsArray.end(),
                                                             newInstance,
@@ -143,7 +145,7 @@ namespace Ogre
 #endif
 
         //Update the thread starts, they have changed.
-        bySkelDef.updateThreadStarts();
+        bySkelDef.updateChunkStarts();
 
         return newInstance;
     }
@@ -180,6 +182,6 @@ namespace Ogre
         skeletonsArray.erase( it );
 
         //Update the thread starts, they have changed.
-        bySkelDef.updateThreadStarts();
+        bySkelDef.updateChunkStarts();
     }
 }
@@ -269,7 +269,8 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms )
+    void SkeletonAnimation::_applyAnimation( const TransformArray &boneTransforms,
+                                             const vector<uint32>::type *boneBlockMask )
     {
         SkeletonTrackVec::const_iterator itor = mDefinition->mTracks.begin();
         SkeletonTrackVec::const_iterator end  = mDefinition->mTracks.end();
@@ -281,8 +282,12 @@ namespace Ogre
 
         while( itor != end )
         {
-            itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
-                                        boneWeights, boneTransforms );
+            if( !boneBlockMask || std::binary_search( boneBlockMask->begin(), boneBlockMask->end(),
+                                                      itor->getBoneBlockIdx() ) )
+            {
+                itor->applyKeyFrameRigAt( *itLastKnownKeyFrame, mCurrentFrame, simdWeight,
+                                          boneWeights, boneTransforms );
+            }
             ++itLastKnownKeyFrame;
             ++boneWeights;
             ++itor;
@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "OgreKeyFrame.h"
 #include "OgreSkeleton.h"
 #include "OgreStringConverter.h"
+#include "OgreException.h"
 
 namespace Ogre
 {
@@ -221,6 +222,99 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::compress( const KeyFrameCompressionSettings &settings )
+    {
+        if( !mKfTransformMemoryManager )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Animation '" + mName + "' has already been quantized",
+                         "SkeletonAnimationDef::compress" );
+        }
+
+        SkeletonTrackVec::iterator itTrack = mTracks.begin();
+        SkeletonTrackVec::iterator enTrack = mTracks.end();
+
+        while( itTrack != enTrack )
+        {
+            itTrack->_reduceKeyFrames( settings );
+            ++itTrack;
+        }
+
+        if( settings.quantize )
+        {
+            itTrack = mTracks.begin();
+            while( itTrack != enTrack )
+            {
+                itTrack->_quantizeKeyFrames();
+                ++itTrack;
+            }
+
+            mKfTransformMemoryManager->destroy();
+            delete mKfTransformMemoryManager;
+            mKfTransformMemoryManager = 0;
+        }
+        else
+        {
+            //Reallocate only the keyframes that survived, keeping them cache friendly.
+            TimestampsPerBlock timestampsByBlock;
+
+            itTrack = mTracks.begin();
+            while( itTrack != enTrack )
+            {
+                TimestampVec &timestamps = timestampsByBlock[itTrack->getBoneBlockIdx()];
+                const KeyFrameRigVec &keyFrames = itTrack->getKeyFrames();
+                timestamps.reserve( keyFrames.size() );
+                KeyFrameRigVec::const_iterator itKeys = keyFrames.begin();
+                KeyFrameRigVec::const_iterator enKeys = keyFrames.end();
+                while( itKeys != enKeys )
+                {
+                    timestamps.push_back( itKeys->mFrame / mOriginalFrameRate );
+                    ++itKeys;
+                }
+                ++itTrack;
+            }
+
+            KfTransformArrayMemoryManager *oldMemoryManager = mKfTransformMemoryManager;
+            mKfTransformMemoryManager = 0;
+            SkeletonTrackVec oldTracks;
+            oldTracks.swap( mTracks );
+
+            allocateCacheFriendlyKeyframes( timestampsByBlock, mOriginalFrameRate );
+
+            //mTracks is created sorted by block, in the same order as oldTracks,
+            //thus mBoneToWeights remains valid.
+            for( size_t i=0; i<mTracks.size(); ++i )
+            {
+                const KeyFrameRigVec &oldKeyFrames = oldTracks[i].getKeyFrames();
+                KeyFrameRigVec &keyFrames = mTracks[i]._getKeyFrames();
+                for( size_t j=0; j<keyFrames.size(); ++j )
+                    *keyFrames[j].mBoneTransform = *oldKeyFrames[j].mBoneTransform;
+                const size_t usedSlots = oldTracks[i].getUsedSlots();
+                if( usedSlots )
+                    mTracks[i]._setMaxUsedSlot( static_cast<uint32>( usedSlots - 1u ) );
+            }
+
+            oldTracks.clear();
+            oldMemoryManager->destroy();
+            delete oldMemoryManager;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonAnimationDef::getKeyFrameMemoryUsage(void) const
+    {
+        size_t retVal = 0;
+        SkeletonTrackVec::const_iterator itor = mTracks.begin();
+        SkeletonTrackVec::const_iterator end  = mTracks.end();
+
+        while( itor != end )
+        {
+            retVal += itor->getKeyFrameMemoryUsage();
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonAnimationDef::getInterpolatedUnnormalizedKeyFrame( v1::OldNodeAnimationTrack *oldTrack,
                                                                     const v1::TimeIndex& timeIndex,
                                                                     v1::TransformKeyFrame* kf )
@@ -415,12 +509,15 @@ namespace Ogre
                     KeyFrameRigVec::const_iterator itKeyFrames = keyFrames.begin();
                     KeyFrameRigVec::const_iterator enKeyFrames = keyFrames.end();
 
+                    KfTransform kfTransform;
+                    const KfTransform * RESTRICT_ALIAS boneTransform = &kfTransform;
+
                     while( itKeyFrames != enKeyFrames )
                     {
                         outText += StringConverter::toString( itKeyFrames->mFrame );
                         outText += ",";
 
-                        const KfTransform * RESTRICT_ALIAS boneTransform = itKeyFrames->mBoneTransform;
+                        track.getKeyFrameTransform( itKeyFrames - keyFrames.begin(), kfTransform );
 
                         Vector3 vPos, vScale;
                         Quaternion qRot;
@@ -449,4 +546,227 @@ namespace Ogre
             ++itor;
         }
     }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::addEventMarker( Real frame, IdString name )
+    {
+        const EventMarker marker( frame, name );
+        //upper_bound keeps the insertion order of markers sharing the same frame
+        EventMarkerVec::iterator itor = std::upper_bound( mEventMarkers.begin(),
+                                                          mEventMarkers.end(), marker );
+        mEventMarkers.insert( itor, marker );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::removeAllEventMarkers(void)
+    {
+        mEventMarkers.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::collectEventMarkers( Real fromFrame, Real toFrame, bool bIncludeEnd,
+                                                    EventMarkerVec &outMarkers ) const
+    {
+        const EventMarker fromKey( fromFrame, IdString() );
+        const EventMarker toKey( toFrame, IdString() );
+
+        if( fromFrame <= toFrame )
+        {
+            EventMarkerVec::const_iterator itor = std::lower_bound( mEventMarkers.begin(),
+                                                                    mEventMarkers.end(), fromKey );
+            EventMarkerVec::const_iterator endt = bIncludeEnd ?
+                        std::upper_bound( itor, mEventMarkers.end(), toKey ) :
+                        std::lower_bound( itor, mEventMarkers.end(), toKey );
+            outMarkers.insert( outMarkers.end(), itor, endt );
+        }
+        else
+        {
+            //Walking backwards: report them in the order they're crossed
+            EventMarkerVec::const_iterator begin = bIncludeEnd ?
+                        std::lower_bound( mEventMarkers.begin(), mEventMarkers.end(), toKey ) :
+                        std::upper_bound( mEventMarkers.begin(), mEventMarkers.end(), toKey );
+            EventMarkerVec::const_iterator itor = std::upper_bound( begin, mEventMarkers.end(),
+                                                                    fromKey );
+            while( itor != begin )
+                outMarkers.push_back( *--itor );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::getEventMarkersInRange( Real fromFrame, Real numFrames, bool bLoop,
+                                                       EventMarkerVec &outMarkers ) const
+    {
+        if( mEventMarkers.empty() || numFrames == 0 )
+            return;
+
+        const Real maxFrame = mNumFrames;
+
+        if( !bLoop || maxFrame <= 0 )
+        {
+            fromFrame = Ogre::min( Ogre::max( fromFrame, 0 ), maxFrame );
+            const Real toFrame = Ogre::min( Ogre::max( fromFrame + numFrames, 0 ), maxFrame );
+            const bool bReachedEnd = numFrames > 0 ? toFrame >= maxFrame : toFrame <= 0;
+            collectEventMarkers( fromFrame, toFrame, bReachedEnd, outMarkers );
+            return;
+        }
+
+        Real currentFrame = fmod( fromFrame, maxFrame );
+        if( currentFrame < 0 )
+            currentFrame += maxFrame;
+
+        if( numFrames > 0 )
+        {
+            while( numFrames > 0 )
+            {
+                const Real segmentEnd = Ogre::min( currentFrame + numFrames, maxFrame );
+                collectEventMarkers( currentFrame, segmentEnd, false, outMarkers );
+                numFrames -= segmentEnd - currentFrame;
+                currentFrame = segmentEnd >= maxFrame ? 0 : segmentEnd;
+            }
+        }
+        else
+        {
+            if( currentFrame <= 0 )
+                currentFrame = maxFrame;
+
+            while( numFrames < 0 )
+            {
+                const Real segmentEnd = Ogre::max( currentFrame + numFrames, 0 );
+                collectEventMarkers( currentFrame, segmentEnd, false, outMarkers );
+                numFrames -= segmentEnd - currentFrame;
+                currentFrame = segmentEnd <= 0 ? maxFrame : segmentEnd;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonAnimationDef::sampleTrackSlot( const SkeletonTrack &track, size_t slot, Real frame,
+                                                Vector3 &outPos, Quaternion &outRot,
+                                                Vector3 &outScale )
+    {
+        const KeyFrameRigVec &keyFrames = track.getKeyFrames();
+        assert( !keyFrames.empty() );
+
+        //Binary search instead of SkeletonTrack::getKeyFrameRigAt's hint: queries
+        //are random access and we have no SkeletonAnimation to hold the hint.
+        KeyFrameRigVec::const_iterator nextFrame = keyFrames.begin() + 1;
+        KeyFrameRigVec::const_iterator endFrame  = keyFrames.end();
+        size_t count = keyFrames.size() > 1u ? keyFrames.size() - 1u : 0u;
+        while( count > 0 )
+        {
+            const size_t step = count >> 1u;
+            KeyFrameRigVec::const_iterator mid = nextFrame + step;
+            if( mid->mFrame <= frame )
+            {
+                nextFrame = mid + 1;
+                count -= step + 1u;
+            }
+            else
+            {
+                count = step;
+            }
+        }
+
+        if( nextFrame >= endFrame )
+            nextFrame = endFrame - 1;
+        KeyFrameRigVec::const_iterator prevFrame = nextFrame == keyFrames.begin() ?
+                                                       nextFrame : nextFrame - 1;
+
+        Real fTimeW = 0;
+        if( prevFrame != nextFrame )
+        {
+            fTimeW = (frame - prevFrame->mFrame) * prevFrame->mInvNextFrameDistance;
+            fTimeW = Ogre::min( Ogre::max( fTimeW, 0 ), 1.0f );
+        }
+
+        KfTransform kfTransforms[2];
+        track.getKeyFrameTransform( prevFrame - keyFrames.begin(), kfTransforms[0] );
+        track.getKeyFrameTransform( nextFrame - keyFrames.begin(), kfTransforms[1] );
+
+        Vector3 prevPos, nextPos, prevScale, nextScale;
+        Quaternion prevRot, nextRot;
+        kfTransforms[0].mPosition.getAsVector3( prevPos, slot );
+        kfTransforms[1].mPosition.getAsVector3( nextPos, slot );
+        kfTransforms[0].mOrientation.getAsQuaternion( prevRot, slot );
+        kfTransforms[1].mOrientation.getAsQuaternion( nextRot, slot );
+        kfTransforms[0].mScale.getAsVector3( prevScale, slot );
+        kfTransforms[1].mScale.getAsVector3( nextScale, slot );
+
+        //Same interpolation as SkeletonTrack::applyKeyFrameRigAt
+        outPos      = prevPos + (nextPos - prevPos) * fTimeW;
+        outRot      = Quaternion::nlerp( fTimeW, prevRot, nextRot, true );
+        outScale    = prevScale + (nextScale - prevScale) * fTimeW;
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonAnimationDef::getBoneTransformAt( IdString boneName, Real frame, Vector3 &outPos,
+                                                   Quaternion &outRot, Vector3 &outScale ) const
+    {
+        map<IdString, size_t>::type::const_iterator itor = mBoneToWeights.find( boneName );
+        if( itor == mBoneToWeights.end() )
+            return false;
+
+        //See build: the lower bits are trackIdx * ARRAY_PACKED_REALS + slot
+        const size_t offset = itor->second & 0x00FFFFFF;
+        sampleTrackSlot( mTracks[offset / ARRAY_PACKED_REALS], offset % ARRAY_PACKED_REALS,
+                         frame, outPos, outRot, outScale );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonAnimationDef::extractRootMotion( IdString boneName, Real fromFrame, Real numFrames,
+                                                  bool bLoop, Vector3 &outPosDelta,
+                                                  Quaternion &outRotDelta ) const
+    {
+        map<IdString, size_t>::type::const_iterator itor = mBoneToWeights.find( boneName );
+        if( itor == mBoneToWeights.end() )
+            return false;
+
+        const size_t offset = itor->second & 0x00FFFFFF;
+        const SkeletonTrack &track = mTracks[offset / ARRAY_PACKED_REALS];
+        const size_t slot = offset % ARRAY_PACKED_REALS;
+
+        const Real maxFrame = mNumFrames;
+
+        Vector3 posDelta( Vector3::ZERO );
+        Quaternion rotDelta( Quaternion::IDENTITY );
+
+        Vector3 startPos, endPos, scale;
+        Quaternion startRot, endRot;
+
+        if( !bLoop || maxFrame <= 0 )
+        {
+            fromFrame = Ogre::min( Ogre::max( fromFrame, 0 ), maxFrame );
+            const Real toFrame = Ogre::min( Ogre::max( fromFrame + numFrames, 0 ), maxFrame );
+            sampleTrackSlot( track, slot, fromFrame, startPos, startRot, scale );
+            sampleTrackSlot( track, slot, toFrame, endPos, endRot, scale );
+            posDelta = endPos - startPos;
+            rotDelta = startRot.UnitInverse() * endRot;
+        }
+        else
+        {
+            Real currentFrame = fmod( fromFrame, maxFrame );
+            if( currentFrame < 0 )
+                currentFrame += maxFrame;
+            if( numFrames < 0 && currentFrame <= 0 )
+                currentFrame = maxFrame;
+
+            //Each iteration covers up to the loop point, then continues from the other end.
+            const bool bForward = numFrames > 0;
+            while( bForward ? numFrames > 0 : numFrames < 0 )
+            {
+                const Real segmentEnd = bForward ?
+                                            Ogre::min( currentFrame + numFrames, maxFrame ) :
+                                            Ogre::max( currentFrame + numFrames, 0 );
+
+                sampleTrackSlot( track, slot, currentFrame, startPos, startRot, scale );
+                sampleTrackSlot( track, slot, segmentEnd, endPos, endRot, scale );
+                posDelta += endPos - startPos;
+                rotDelta = rotDelta * (startRot.UnitInverse() * endRot);
+
+                numFrames -= segmentEnd - currentFrame;
+                if( bForward )
+                    currentFrame = segmentEnd >= maxFrame ? 0 : segmentEnd;
+                else
+                    currentFrame = segmentEnd <= 0 ? maxFrame : segmentEnd;
+            }
+        }
+
+        outPosDelta = posDelta;
+        outRotDelta = rotDelta;
+        return true;
+    }
 }
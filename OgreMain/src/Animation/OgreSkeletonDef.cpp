@@ -43,7 +43,8 @@ namespace Ogre
 {
     SkeletonDef::SkeletonDef( const v1::Skeleton *originalSkeleton, Real frameRate ) :
         mNumUnusedSlots( 0 ),
-        mName( originalSkeleton->getName() )
+        mName( originalSkeleton->getName() ),
+        mOffscreenUpdateInterval( 0 )
     {
         mBones.reserve( originalSkeleton->getNumBones() );
 
@@ -340,4 +341,76 @@ namespace Ogre
 
         return numBlocks;
     }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::setAnimationLod( size_t lodIdx, uint32 updateInterval,
+                                       const IdStringVec *animatedBones )
+    {
+        if( updateInterval == 0u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "updateInterval must be >= 1. Skeleton: " + mName,
+                         "SkeletonDef::setAnimationLod" );
+        }
+
+        if( lodIdx >= mAnimationLods.size() )
+            mAnimationLods.resize( lodIdx + 1u );
+
+        AnimationLod &animationLod = mAnimationLods[lodIdx];
+        animationLod.updateInterval = updateInterval;
+        animationLod.boneBlockMask.clear();
+
+        if( animatedBones )
+        {
+            IdStringVec::const_iterator itor = animatedBones->begin();
+            IdStringVec::const_iterator end  = animatedBones->end();
+
+            while( itor != end )
+            {
+                BoneNameMap::const_iterator itBone = mBoneIndexByName.find( *itor );
+                if( itBone == mBoneIndexByName.end() )
+                {
+                    OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                                 "Bone '" + itor->getFriendlyText() + "' not found in " + mName,
+                                 "SkeletonDef::setAnimationLod" );
+                }
+
+                //Animating a bone is meaningless if its parents stay in binding pose
+                size_t boneIdx = itBone->second;
+                while( boneIdx != std::numeric_limits<size_t>::max() )
+                {
+                    animationLod.boneBlockMask.push_back( slotToBlockIdx( mBoneToSlot[boneIdx] ) );
+                    boneIdx = mBones[boneIdx].parent;
+                }
+
+                ++itor;
+            }
+
+            std::sort( animationLod.boneBlockMask.begin(), animationLod.boneBlockMask.end() );
+            animationLod.boneBlockMask.erase( std::unique( animationLod.boneBlockMask.begin(),
+                                                           animationLod.boneBlockMask.end() ),
+                                              animationLod.boneBlockMask.end() );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::clearAnimationLods(void)
+    {
+        mAnimationLods.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::setOffscreenUpdateInterval( uint32 updateInterval )
+    {
+        mOffscreenUpdateInterval = updateInterval;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonDef::compressAnimations( const KeyFrameCompressionSettings &settings )
+    {
+        SkeletonAnimationDefVec::iterator itor = mAnimationDefs.begin();
+        SkeletonAnimationDefVec::iterator end  = mAnimationDefs.end();
+
+        while( itor != end )
+        {
+            itor->compress( settings );
+            ++itor;
+        }
+    }
 }
@@ -32,6 +32,8 @@ THE SOFTWARE.
 #include "Animation/OgreSkeletonDef.h"
 #include "Animation/OgreSkeletonAnimationDef.h"
 #include "Animation/OgreSkeletonManager.h"
+#include "Animation/OgreGpuSkeletonEvaluator.h"
+#include "Animation/OgreBakedSkeletonAnimation.h"
 
 #include "OgreId.h"
 
@@ -45,7 +47,18 @@ namespace Ogre
                                         BoneMemoryManager *boneMemoryManager ) :
             mDefinition( skeletonDef ),
             mParentNode( 0 ),
-            mRefCount( 1 )
+            mRefCount( 1 ),
+            mVisibleLod( std::numeric_limits<uint8>::max() ),
+            mAnimationLod( std::numeric_limits<uint8>::max() ),
+            mWasVisible( false ),
+            mAnimationLodFrame( 0 ),
+            mGpuEvaluator( 0 ),
+            mGpuBoneOffset( 0 ),
+            mCpuEvaluation( false ),
+            mBakedAnimation( 0 ),
+            mBakedAnimationIdx( 0 ),
+            mBakedAnimationTime( 0 ),
+            mPoseSharingTolerance( 0 )
     {
         mBones.resize( mDefinition->getBones().size(), Bone() );
 
@@ -188,6 +201,11 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     SkeletonInstance::~SkeletonInstance()
     {
+        if( mGpuEvaluator )
+            mGpuEvaluator->_notifySkeletonInstanceDestroyed( this );
+        if( mBakedAnimation )
+            mBakedAnimation->_notifySkeletonInstanceDestroyed( this );
+
         {
             SceneNodeBonePairVec::iterator itor = mCustomParentSceneNodes.begin();
             SceneNodeBonePairVec::iterator end  = mCustomParentSceneNodes.end();
@@ -232,8 +250,58 @@ namespace Ogre
         mBones.clear();
     }
     //-----------------------------------------------------------------------------------
-    void SkeletonInstance::update(void)
+    void SkeletonInstance::update( SkeletonPoseCache *poseCache )
     {
+        const vector<uint32>::type *boneBlockMask = 0;
+
+        const SkeletonDef::AnimationLodVec &animationLods = mDefinition->getAnimationLods();
+        if( !animationLods.empty() )
+        {
+            const uint8 visibleLod = mVisibleLod;
+            mVisibleLod = std::numeric_limits<uint8>::max();
+
+            const bool bVisible = visibleLod != std::numeric_limits<uint8>::max();
+            //Just became visible. Don't show a stale pose
+            const bool bCatchUp = bVisible && !mWasVisible;
+            mWasVisible = bVisible;
+            mAnimationLod = visibleLod;
+
+            uint32 updateInterval;
+            const SkeletonDef::AnimationLod *animationLod;
+            if( bVisible )
+            {
+                const size_t lodIdx = std::min<size_t>( visibleLod, animationLods.size() - 1u );
+                animationLod = &animationLods[lodIdx];
+                updateInterval = animationLod->updateInterval;
+            }
+            else
+            {
+                animationLod = &animationLods.back();
+                updateInterval = mDefinition->getOffscreenUpdateInterval();
+            }
+
+            if( !animationLod->boneBlockMask.empty() )
+                boneBlockMask = &animationLod->boneBlockMask;
+
+            const uint32 frame = mAnimationLodFrame++;
+            if( !bCatchUp && (updateInterval == 0u || (frame % updateInterval) != 0u) )
+                return;
+        }
+
+        uint64 poseKey = 0;
+        if( poseCache && mPoseSharingTolerance > 0 && !mActiveAnimations.empty() )
+        {
+            poseKey = getPoseKey();
+            for( size_t i=0; i<poseCache->numEntries; ++i )
+            {
+                if( poseCache->keys[i] == poseKey && hasSamePose( poseCache->leaders[i] ) )
+                {
+                    copyPoseFrom( poseCache->leaders[i] );
+                    return;
+                }
+            }
+        }
+
         if( !mActiveAnimations.empty() )
             resetToPose();
 
@@ -242,9 +310,108 @@ namespace Ogre
 
         while( itor != end )
         {
-            (*itor)->_applyAnimation( mBoneStartTransforms );
+            (*itor)->_applyAnimation( mBoneStartTransforms, boneBlockMask );
+            ++itor;
+        }
+
+        if( poseKey && poseCache->numEntries < SkeletonPoseCache::MaxEntries )
+        {
+            poseCache->leaders[poseCache->numEntries] = this;
+            poseCache->keys[poseCache->numEntries] = poseKey;
+            ++poseCache->numEntries;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setPoseSharingTolerance( Real tolerance )
+    {
+        mPoseSharingTolerance = std::max<Real>( tolerance, 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 SkeletonInstance::getPoseKey(void) const
+    {
+        //FNV-1a. It only has to tell buckets apart, hasSamePose does the exact check
+        uint64 hash = 14695981039346656037ULL;
+        hash = (hash ^ mAnimationLod) * 1099511628211ULL;
+
+        ActiveAnimationsVec::const_iterator itor = mActiveAnimations.begin();
+        ActiveAnimationsVec::const_iterator end  = mActiveAnimations.end();
+
+        while( itor != end )
+        {
+            const SkeletonAnimation *animation = *itor;
+            const int64 bucket = static_cast<int64>(
+                        Math::Floor( animation->getCurrentFrame() / mPoseSharingTolerance ) );
+            hash = (hash ^ reinterpret_cast<uintptr_t>( animation->getDefinition() )) *
+                    1099511628211ULL;
+            hash = (hash ^ static_cast<uint64>( bucket )) * 1099511628211ULL;
+            hash = (hash ^ static_cast<uint64>( animation->mWeight * 65536.0f )) *
+                    1099511628211ULL;
             ++itor;
         }
+
+        //0 is reserved for "don't share"
+        return hash ? hash : 1u;
+    }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonInstance::hasSamePose( const SkeletonInstance *other ) const
+    {
+        if( mDefinition != other->mDefinition ||
+            mPoseSharingTolerance != other->mPoseSharingTolerance ||
+            mAnimationLod != other->mAnimationLod ||
+            mActiveAnimations.size() != other->mActiveAnimations.size() )
+        {
+            return false;
+        }
+
+        for( size_t i=0; i<mActiveAnimations.size(); ++i )
+        {
+            const SkeletonAnimation *a = mActiveAnimations[i];
+            const SkeletonAnimation *b = other->mActiveAnimations[i];
+
+            if( a->getDefinition() != b->getDefinition() || a->mWeight != b->mWeight ||
+                Math::Floor( a->getCurrentFrame() / mPoseSharingTolerance ) !=
+                Math::Floor( b->getCurrentFrame() / mPoseSharingTolerance ) )
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonInstance::copyPoseFrom( const SkeletonInstance *other )
+    {
+        //Both use the same SkeletonDef, but each depth level may start at
+        //a different slot within its SIMD block
+        SkeletonDef::DepthLevelInfoVec::const_iterator itDepthLevelInfo =
+                                                mDefinition->getDepthLevelInfo().begin();
+
+        for( size_t level=0; level<mBoneStartTransforms.size(); ++level )
+        {
+            const BoneTransform &dst = mBoneStartTransforms[level];
+            const BoneTransform &src = other->mBoneStartTransforms[level];
+
+            for( size_t i=0; i<itDepthLevelInfo->numBonesInLevel; ++i )
+            {
+                const size_t srcSlot = src.mIndex + i;
+                const size_t dstSlot = dst.mIndex + i;
+                const size_t srcBlock = srcSlot / ARRAY_PACKED_REALS;
+                const size_t dstBlock = dstSlot / ARRAY_PACKED_REALS;
+                const size_t srcLane = srcSlot % ARRAY_PACKED_REALS;
+                const size_t dstLane = dstSlot % ARRAY_PACKED_REALS;
+
+                Vector3 tmpVec;
+                Quaternion tmpQ;
+                src.mPosition[srcBlock].getAsVector3( tmpVec, srcLane );
+                dst.mPosition[dstBlock].setFromVector3( tmpVec, dstLane );
+                src.mOrientation[srcBlock].getAsQuaternion( tmpQ, srcLane );
+                dst.mOrientation[dstBlock].setFromQuaternion( tmpQ, dstLane );
+                src.mScale[srcBlock].getAsVector3( tmpVec, srcLane );
+                dst.mScale[dstBlock].setFromVector3( tmpVec, dstLane );
+            }
+
+            ++itDepthLevelInfo;
+        }
     }
     //-----------------------------------------------------------------------------------
     void SkeletonInstance::resetToPose(void)
@@ -527,6 +694,14 @@ namespace Ogre
                         mBoneStartTransforms[0].mOwner + mBoneStartTransforms[0].mIndex );
     }
     //-----------------------------------------------------------------------------------
+    void SkeletonInstance::setBakedAnimation( uint32 animIdx, Real time )
+    {
+        assert( ( !mBakedAnimation || animIdx < mBakedAnimation->getNumAnimations() ) &&
+                "Baked animation index out of bounds" );
+        mBakedAnimationIdx  = animIdx;
+        mBakedAnimationTime = time;
+    }
+    //-----------------------------------------------------------------------------------
     void SkeletonInstance::_incrementRefCount(void) 
     {
         mRefCount++;
@@ -45,7 +45,8 @@ namespace Ogre
         assert( msSingleton );  return ( *msSingleton );  
     }
     //-----------------------------------------------------------------------
-    SkeletonManager::SkeletonManager()
+    SkeletonManager::SkeletonManager() :
+        mCompressAnimations( false )
     {
     }
     //-----------------------------------------------------------------------
@@ -62,6 +63,8 @@ namespace Ogre
         {
             oldSkeletonBase->load();
             retVal = SkeletonDefPtr( new SkeletonDef( oldSkeletonBase, 1.0f ) );
+            if( mCompressAnimations )
+                retVal->compressAnimations( mAnimationCompression );
             mSkeletonDefs[idName] = retVal;
         }
         else
@@ -95,6 +98,8 @@ namespace Ogre
             if( oldSkeleton->isLoaded() )
             {
                 retVal = SkeletonDefPtr( new SkeletonDef( oldSkeleton.get(), 1.0f ) );
+                if( mCompressAnimations )
+                    retVal->compressAnimations( mAnimationCompression );
                 if( wasUnloaded )
                     oldSkeleton->unload();
                 if( wasNonExistent )
@@ -124,6 +129,13 @@ namespace Ogre
         mSkeletonDefs[idName] = skeletonDef;
     }
     //-----------------------------------------------------------------------
+    void SkeletonManager::setAnimationCompression( bool bEnabled,
+                                                   const KeyFrameCompressionSettings &settings )
+    {
+        mCompressAnimations = bEnabled;
+        mAnimationCompression = settings;
+    }
+    //-----------------------------------------------------------------------
     void SkeletonManager::remove( const IdString &name )
     {
         SkeletonDefMap::iterator itor = mSkeletonDefs.find( name );
@@ -38,14 +38,85 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    static const Real c_smallestThreeRange = 0.70710678118654752440f; // 1 / sqrt( 2 )
+
+    /// Encodes a quaternion in 48 bits: the largest component is dropped (its sign is
+    /// made positive since q == -q) and the remaining three, which are in range
+    /// [-1/sqrt(2); 1/sqrt(2)], get 15, 15 & 16 bits. The index of the dropped
+    /// component goes in the low bit of the first two words.
+    static void encodeSmallestThree( Quaternion q, uint16 * RESTRICT_ALIAS outData )
+    {
+        q.normalise();
+        const Real v[4] = { q.w, q.x, q.y, q.z };
+
+        uint32 largestIdx = 0;
+        for( uint32 i=1u; i<4u; ++i )
+        {
+            if( Math::Abs( v[i] ) > Math::Abs( v[largestIdx] ) )
+                largestIdx = i;
+        }
+
+        const Real sign = v[largestIdx] < 0 ? -1.0f : 1.0f;
+        const Real maxValues[3] = { 32767.0f, 32767.0f, 65535.0f };
+
+        uint32 quantized[3];
+        for( uint32 i=0u, j=0u; i<4u; ++i )
+        {
+            if( i != largestIdx )
+            {
+                Real fUnorm = Math::Clamp( v[i] * sign / c_smallestThreeRange, Real( -1.0f ),
+                                           Real( 1.0f ) ) * 0.5f + 0.5f;
+                quantized[j] = static_cast<uint32>( fUnorm * maxValues[j] + 0.5f );
+                ++j;
+            }
+        }
+
+        outData[0] = static_cast<uint16>( (quantized[0] << 1u) | (largestIdx & 0x01u) );
+        outData[1] = static_cast<uint16>( (quantized[1] << 1u) | (largestIdx >> 1u) );
+        outData[2] = static_cast<uint16>( quantized[2] );
+    }
+    //-----------------------------------------------------------------------------------
+    static inline Quaternion decodeSmallestThree( const uint16 * RESTRICT_ALIAS data )
+    {
+        const uint32 largestIdx = (data[0] & 0x01u) | ((data[1] & 0x01u) << 1u);
+
+        const Real smallest[3] =
+        {
+            ((data[0] >> 1u) * (2.0f / 32767.0f) - 1.0f) * c_smallestThreeRange,
+            ((data[1] >> 1u) * (2.0f / 32767.0f) - 1.0f) * c_smallestThreeRange,
+            (data[2] * (2.0f / 65535.0f) - 1.0f) * c_smallestThreeRange
+        };
+
+        Real v[4];
+        Real sqSum = 0;
+        for( uint32 i=0u, j=0u; i<4u; ++i )
+        {
+            if( i != largestIdx )
+            {
+                v[i] = smallest[j++];
+                sqSum += v[i] * v[i];
+            }
+        }
+        v[largestIdx] = Math::Sqrt( std::max( Real( 1.0f ) - sqSum, Real( 0.0f ) ) );
+
+        return Quaternion( v[0], v[1], v[2], v[3] );
+    }
+    //-----------------------------------------------------------------------------------
     SkeletonTrack::SkeletonTrack( uint32 boneBlockIdx,
                                     KfTransformArrayMemoryManager *kfTransformMemoryManager ) :
         mKeyFrameRigs( 0 ),
         mNumFrames( 0 ),
         mBoneBlockIdx( boneBlockIdx ),
         mUsedSlots( 0 ),
-        mLocalMemoryManager( kfTransformMemoryManager )
+        mLocalMemoryManager( kfTransformMemoryManager ),
+        mQuantizedStride( 0 ),
+        mQuantizedPosition( false ),
+        mQuantizedScale( false )
     {
+        memset( mPositionMin, 0, sizeof( mPositionMin ) );
+        memset( mPositionStep, 0, sizeof( mPositionStep ) );
+        memset( mScaleMin, 0, sizeof( mScaleMin ) );
+        memset( mScaleStep, 0, sizeof( mScaleStep ) );
     }
     //-----------------------------------------------------------------------------------
     SkeletonTrack::~SkeletonTrack()
@@ -137,8 +208,18 @@ namespace Ogre
         ArrayVector3 * RESTRICT_ALIAS finalScale    = boneTransforms[level].mScale + offset;
         ArrayQuaternion * RESTRICT_ALIAS finalRot   = boneTransforms[level].mOrientation + offset;
 
-        KfTransform * RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
-        KfTransform * RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+        KfTransform const * RESTRICT_ALIAS prevTransf = prevFrame->mBoneTransform;
+        KfTransform const * RESTRICT_ALIAS nextTransf = nextFrame->mBoneTransform;
+
+        KfTransform dequantized[2];
+        if( mQuantizedStride )
+        {
+            //Decode straight into SoA form so the interpolation below stays the same
+            dequantizeKeyFrame( prevFrame - mKeyFrameRigs.begin(), dequantized[0] );
+            dequantizeKeyFrame( nextFrame - mKeyFrameRigs.begin(), dequantized[1] );
+            prevTransf = &dequantized[0];
+            nextTransf = &dequantized[1];
+        }
 
         ArrayVector3 interpPos, interpScale;
         ArrayQuaternion interpRot;
@@ -191,4 +272,250 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    bool SkeletonTrack::isKeyFrameRedundant( size_t prevIdx, size_t idx, size_t nextIdx,
+                                             const KeyFrameCompressionSettings &settings ) const
+    {
+        const KeyFrameRig &prevFrame = mKeyFrameRigs[prevIdx];
+        const KeyFrameRig &frame = mKeyFrameRigs[idx];
+        const KeyFrameRig &nextFrame = mKeyFrameRigs[nextIdx];
+
+        const Real fTimeW = (frame.mFrame - prevFrame.mFrame) /
+                            (nextFrame.mFrame - prevFrame.mFrame);
+
+        bool isRedundant = true;
+        for( size_t i=0; i<mUsedSlots && isRedundant; ++i )
+        {
+            Vector3 vPrev, vNext, vOriginal;
+            Quaternion qPrev, qNext, qOriginal;
+
+            //Same interpolation as in applyKeyFrameRigAt
+            prevFrame.mBoneTransform->mPosition.getAsVector3( vPrev, i );
+            nextFrame.mBoneTransform->mPosition.getAsVector3( vNext, i );
+            frame.mBoneTransform->mPosition.getAsVector3( vOriginal, i );
+            isRedundant &= Math::lerp( vPrev, vNext, fTimeW ).
+                    positionEquals( vOriginal, settings.maxPositionError );
+
+            prevFrame.mBoneTransform->mScale.getAsVector3( vPrev, i );
+            nextFrame.mBoneTransform->mScale.getAsVector3( vNext, i );
+            frame.mBoneTransform->mScale.getAsVector3( vOriginal, i );
+            isRedundant &= Math::lerp( vPrev, vNext, fTimeW ).
+                    positionEquals( vOriginal, settings.maxScaleError );
+
+            prevFrame.mBoneTransform->mOrientation.getAsQuaternion( qPrev, i );
+            nextFrame.mBoneTransform->mOrientation.getAsQuaternion( qNext, i );
+            frame.mBoneTransform->mOrientation.getAsQuaternion( qOriginal, i );
+            qOriginal.normalise();
+            const Quaternion qInterp = Quaternion::nlerp( fTimeW, qPrev, qNext, true );
+            const Real fCos = std::min( Math::Abs( qInterp.Dot( qOriginal ) ), Real( 1.0f ) );
+            isRedundant &= 2.0f * Math::ACos( fCos ).valueRadians() <= settings.maxRotationError;
+        }
+
+        return isRedundant;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::_reduceKeyFrames( const KeyFrameCompressionSettings &settings )
+    {
+        assert( !mQuantizedStride && "Reduce keyframes before quantizing them!" );
+
+        const size_t numKeyFrames = mKeyFrameRigs.size();
+        if( numKeyFrames <= 2u )
+            return;
+
+        //Greedy: extend the segment that starts at the last kept keyframe for as long as
+        //every keyframe skipped so far can still be reconstructed from its end points.
+        KeyFrameRigVec reducedKeyFrames;
+        reducedKeyFrames.reserve( numKeyFrames );
+        reducedKeyFrames.push_back( mKeyFrameRigs[0] );
+
+        size_t lastKept = 0;
+        for( size_t i=1u; i<numKeyFrames - 1u; ++i )
+        {
+            bool canSkip = true;
+            for( size_t j=lastKept + 1u; j<=i && canSkip; ++j )
+                canSkip = isKeyFrameRedundant( lastKept, j, i + 1u, settings );
+
+            if( !canSkip )
+            {
+                reducedKeyFrames.push_back( mKeyFrameRigs[i] );
+                lastKept = i;
+            }
+        }
+
+        reducedKeyFrames.push_back( mKeyFrameRigs.back() );
+
+        for( size_t i=0; i<reducedKeyFrames.size() - 1u; ++i )
+        {
+            reducedKeyFrames[i].mInvNextFrameDistance =
+                    1.0f / (reducedKeyFrames[i+1u].mFrame - reducedKeyFrames[i].mFrame);
+        }
+        reducedKeyFrames.back().mInvNextFrameDistance = 1.0f;
+
+        mKeyFrameRigs.swap( reducedKeyFrames );
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::_quantizeKeyFrames(void)
+    {
+        assert( !mQuantizedStride && "Track already quantized!" );
+
+        if( mKeyFrameRigs.empty() )
+            return;
+
+        Vector3 posMin[ARRAY_PACKED_REALS], posMax[ARRAY_PACKED_REALS];
+        Vector3 scaleMin[ARRAY_PACKED_REALS], scaleMax[ARRAY_PACKED_REALS];
+
+        for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+        {
+            mKeyFrameRigs[0].mBoneTransform->mPosition.getAsVector3( posMin[i], i );
+            mKeyFrameRigs[0].mBoneTransform->mScale.getAsVector3( scaleMin[i], i );
+            posMax[i] = posMin[i];
+            scaleMax[i] = scaleMin[i];
+        }
+
+        KeyFrameRigVec::const_iterator itor = mKeyFrameRigs.begin();
+        KeyFrameRigVec::const_iterator end  = mKeyFrameRigs.end();
+
+        while( itor != end )
+        {
+            for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+            {
+                Vector3 vTmp;
+                itor->mBoneTransform->mPosition.getAsVector3( vTmp, i );
+                posMin[i].makeFloor( vTmp );
+                posMax[i].makeCeil( vTmp );
+                itor->mBoneTransform->mScale.getAsVector3( vTmp, i );
+                scaleMin[i].makeFloor( vTmp );
+                scaleMax[i].makeCeil( vTmp );
+            }
+            ++itor;
+        }
+
+        mQuantizedPosition = false;
+        mQuantizedScale = false;
+
+        for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+        {
+            for( size_t j=0; j<3u; ++j )
+            {
+                mPositionMin[j][i]  = posMin[i][j];
+                mPositionStep[j][i] = (posMax[i][j] - posMin[i][j]) / 65535.0f;
+                mScaleMin[j][i]     = scaleMin[i][j];
+                mScaleStep[j][i]    = (scaleMax[i][j] - scaleMin[i][j]) / 65535.0f;
+
+                mQuantizedPosition  |= mPositionStep[j][i] != 0;
+                mQuantizedScale     |= mScaleStep[j][i] != 0;
+            }
+        }
+
+        mQuantizedStride = 3u * ARRAY_PACKED_REALS;
+        if( mQuantizedPosition )
+            mQuantizedStride += 3u * ARRAY_PACKED_REALS;
+        if( mQuantizedScale )
+            mQuantizedStride += 3u * ARRAY_PACKED_REALS;
+
+        mQuantizedKeyFrames.resize( mKeyFrameRigs.size() * mQuantizedStride );
+
+        uint16 * RESTRICT_ALIAS dstData = &mQuantizedKeyFrames[0];
+
+        KeyFrameRigVec::iterator itKeys = mKeyFrameRigs.begin();
+        KeyFrameRigVec::iterator enKeys = mKeyFrameRigs.end();
+
+        while( itKeys != enKeys )
+        {
+            for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+            {
+                Quaternion qRot;
+                itKeys->mBoneTransform->mOrientation.getAsQuaternion( qRot, i );
+                encodeSmallestThree( qRot, dstData + i * 3u );
+            }
+            dstData += 3u * ARRAY_PACKED_REALS;
+
+            for( size_t k=0; k<2u; ++k )
+            {
+                const bool isPosition = k == 0;
+                if( (isPosition && !mQuantizedPosition) || (!isPosition && !mQuantizedScale) )
+                    continue;
+
+                const ArrayVector3 &value = isPosition ? itKeys->mBoneTransform->mPosition :
+                                                         itKeys->mBoneTransform->mScale;
+                const Real (&minValue)[3][ARRAY_PACKED_REALS] = isPosition ? mPositionMin :
+                                                                             mScaleMin;
+                const Real (&step)[3][ARRAY_PACKED_REALS] = isPosition ? mPositionStep :
+                                                                         mScaleStep;
+
+                for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+                {
+                    Vector3 vTmp;
+                    value.getAsVector3( vTmp, i );
+                    for( size_t j=0; j<3u; ++j )
+                    {
+                        Real fQuantized = 0;
+                        if( step[j][i] != 0 )
+                            fQuantized = (vTmp[j] - minValue[j][i]) / step[j][i] + 0.5f;
+                        dstData[j * ARRAY_PACKED_REALS + i] = static_cast<uint16>(
+                                    Math::Clamp( fQuantized, Real( 0.0f ), Real( 65535.0f ) ) );
+                    }
+                }
+                dstData += 3u * ARRAY_PACKED_REALS;
+            }
+
+            itKeys->mBoneTransform = 0;
+            ++itKeys;
+        }
+
+        mLocalMemoryManager = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::dequantizeKeyFrame( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        const uint16 * RESTRICT_ALIAS srcData = &mQuantizedKeyFrames[keyFrameIdx * mQuantizedStride];
+
+        for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+            outTransform.mOrientation.setFromQuaternion( decodeSmallestThree( srcData + i * 3u ), i );
+        srcData += 3u * ARRAY_PACKED_REALS;
+
+        for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+        {
+            Vector3 vPos( mPositionMin[0][i], mPositionMin[1][i], mPositionMin[2][i] );
+            if( mQuantizedPosition )
+            {
+                vPos.x += srcData[i] * mPositionStep[0][i];
+                vPos.y += srcData[ARRAY_PACKED_REALS + i] * mPositionStep[1][i];
+                vPos.z += srcData[ARRAY_PACKED_REALS * 2u + i] * mPositionStep[2][i];
+            }
+            outTransform.mPosition.setFromVector3( vPos, i );
+        }
+        if( mQuantizedPosition )
+            srcData += 3u * ARRAY_PACKED_REALS;
+
+        for( size_t i=0; i<ARRAY_PACKED_REALS; ++i )
+        {
+            Vector3 vScale( mScaleMin[0][i], mScaleMin[1][i], mScaleMin[2][i] );
+            if( mQuantizedScale )
+            {
+                vScale.x += srcData[i] * mScaleStep[0][i];
+                vScale.y += srcData[ARRAY_PACKED_REALS + i] * mScaleStep[1][i];
+                vScale.z += srcData[ARRAY_PACKED_REALS * 2u + i] * mScaleStep[2][i];
+            }
+            outTransform.mScale.setFromVector3( vScale, i );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SkeletonTrack::getKeyFrameTransform( size_t keyFrameIdx, KfTransform &outTransform ) const
+    {
+        if( mQuantizedStride )
+            dequantizeKeyFrame( keyFrameIdx, outTransform );
+        else
+            outTransform = *mKeyFrameRigs[keyFrameIdx].mBoneTransform;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SkeletonTrack::getKeyFrameMemoryUsage(void) const
+    {
+        size_t retVal = mKeyFrameRigs.size() * sizeof( KeyFrameRig );
+        if( mQuantizedStride )
+            retVal += mQuantizedKeyFrames.size() * sizeof( uint16 );
+        else
+            retVal += mKeyFrameRigs.size() * sizeof( KfTransform );
+        return retVal;
+    }
 }
@@ -212,6 +212,125 @@ namespace Ogre {
                                          *t.mDerivedScale,
                                          *t.mDerivedOrientation );
 
+#if OGRE_DEBUG_MODE
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                if( t.mOwner[j] )
+                    t.mOwner[j]->mCachedTransformOutOfDate = false;
+            }
+#endif
+
+            t.advancePack();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void TagPoint::updateAllTransformsFromBone( const size_t numNodes, Transform t, size_t depth )
+    {
+        //Bones move TagPoints without going through their setters, thus always
+        //report them as changed. @see MovableObject::updateDirtyBounds
+        memset( t.mDirtyFlags, Transform::DerivedChanged,
+                ( (numNodes + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS ) * ARRAY_PACKED_REALS );
+
+        if( depth == 0 )
+        {
+            updateAllTransformsBoneToTag( numNodes, t );
+            return;
+        }
+
+        //ancestors[k * ARRAY_PACKED_REALS + j] is the ancestor of slot j at depth level k
+        FastArray<Node*> ancestors;
+        ancestors.resize( depth * ARRAY_PACKED_REALS, 0 );
+
+        SimpleMatrixAf4x3 const * RESTRICT_ALIAS parentBoneParentNodeTransform[ARRAY_PACKED_REALS];
+        SimpleMatrixAf4x3 const * RESTRICT_ALIAS parentBoneTransform[ARRAY_PACKED_REALS];
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                parentBoneParentNodeTransform[j]    = &SimpleMatrixAf4x3::IDENTITY;
+                parentBoneTransform[j]              = &SimpleMatrixAf4x3::IDENTITY;
+
+                Node *ancestor = t.mOwner[j];
+                for( size_t k=depth; k--; )
+                {
+                    ancestor = ancestor ? ancestor->getParent() : 0;
+                    ancestors[k * ARRAY_PACKED_REALS + j] = ancestor;
+                }
+
+                if( ancestor )
+                {
+                    Bone *parentBonePtr = static_cast<TagPoint*>( ancestor )->mParentBone;
+                    const BoneTransform &boneTransform = parentBonePtr->_getTransform();
+                    parentBoneParentNodeTransform[j] =
+                            boneTransform.mParentNodeTransform[boneTransform.mIndex];
+                    parentBoneTransform[j] = &boneTransform.mDerivedTransform[boneTransform.mIndex];
+                }
+            }
+
+            ArrayMatrixAf4x3 finalMat;
+            ArrayMatrixAf4x3 parentBone;
+            finalMat.loadFromAoS( parentBoneParentNodeTransform );
+            parentBone.loadFromAoS( parentBoneTransform );
+            finalMat *= parentBone; //finalMat = parentBoneParentNodeTransform * parentBone;
+
+            //Walk down the chain. Same math as updateAllTransformsBoneToTag &
+            //updateAllTransformsTagOnTag, but gathering each ancestor's local transform
+            for( size_t k=0; k<depth; ++k )
+            {
+                ArrayVector3 position( ArrayVector3::ZERO );
+                ArrayVector3 scale( ArrayVector3::UNIT_SCALE );
+                ArrayQuaternion orientation( ArrayQuaternion::IDENTITY );
+                bool inheritOrientation[ARRAY_PACKED_REALS];
+                bool inheritScale[ARRAY_PACKED_REALS];
+
+                for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                {
+                    inheritOrientation[j]   = true;
+                    inheritScale[j]         = true;
+
+                    Node *ancestor = ancestors[k * ARRAY_PACKED_REALS + j];
+                    if( ancestor )
+                    {
+                        const Transform &at = ancestor->_getTransform();
+                        position.setFromVector3( at.mPosition->getAsVector3( at.mIndex ), j );
+                        scale.setFromVector3( at.mScale->getAsVector3( at.mIndex ), j );
+                        orientation.setFromQuaternion(
+                                    at.mOrientation->getAsQuaternion( at.mIndex ), j );
+                        inheritOrientation[j]   = at.mInheritOrientation[at.mIndex];
+                        inheritScale[j]         = at.mInheritScale[at.mIndex];
+                    }
+                }
+
+                if( !BooleanMask4::allBitsSet( inheritOrientation, inheritScale ) )
+                {
+                    finalMat.retain( BooleanMask4::getMask( inheritOrientation ),
+                                     BooleanMask4::getMask( inheritScale ) );
+                }
+
+                ArrayMatrixAf4x3 baseTransform;
+                baseTransform.makeTransform( position, scale, orientation );
+                finalMat *= baseTransform;
+            }
+
+            if( !BooleanMask4::allBitsSet( t.mInheritOrientation, t.mInheritScale ) )
+            {
+                ArrayMaskR inheritOrientation   = BooleanMask4::getMask( t.mInheritOrientation );
+                ArrayMaskR inheritScale         = BooleanMask4::getMask( t.mInheritScale );
+                finalMat.retain( inheritOrientation, inheritScale );
+            }
+
+            ArrayMatrixAf4x3 baseTransform;
+            baseTransform.makeTransform( *t.mPosition, *t.mScale, *t.mOrientation );
+
+            finalMat *= baseTransform; //finalMat = parentMat * baseTransform;
+
+            finalMat.streamToAoS( t.mDerivedTransform );
+
+            finalMat.decomposition( *t.mDerivedPosition,
+                                         *t.mDerivedScale,
+                                         *t.mDerivedOrientation );
+
 #if OGRE_DEBUG_MODE
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
             {
@@ -29,6 +29,14 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 
 #include "CommandBuffer/OgreCommandBuffer.h"
+#include "CommandBuffer/OgreCbDrawCall.h"
+#include "CommandBuffer/OgreCbPipelineStateObject.h"
+#include "CommandBuffer/OgreCbShaderBuffer.h"
+#include "CommandBuffer/OgreCbTexture.h"
+
+#include "Vao/OgreVertexArrayObject.h"
+#include "OgreDescriptorSetTexture.h"
+#include "OgreDescriptorSetSampler.h"
 
 #include "OgreException.h"
 
@@ -75,7 +83,128 @@ namespace Ogre
         &CommandBuffer::execute_invalidCommand
     };
     //-----------------------------------------------------------------------------------
-    CommandBuffer::CommandBuffer() : mRenderSystem( 0 )
+    namespace
+    {
+        /// Slots & texture units past these limits are never considered redundant
+        const size_t c_maxTrackedBufferSlots    = 16u;
+        const size_t c_maxTrackedTexUnits       = 32u;
+
+        /// Below this many commands per thread, waking up the worker threads
+        /// costs more than the elimination pass itself.
+        const size_t c_minCommandsPerThread     = 4096u;
+
+        /// What removeRedundantCommands believes is bound in the RenderSystem
+        struct CbBoundState
+        {
+            struct BufferRange
+            {
+                BufferPacked    *buffer;
+                uint32          offset;
+                uint32          sizeBytes;
+            };
+
+            HlmsPso const   *pso;
+
+            /// [0; NumShaderTypes) are const buffers, [NumShaderTypes; NumShaderTypes*2)
+            /// are tex buffers. Bits in bufferValid tell which slots are known.
+            BufferRange     buffers[NumShaderTypes * 2u][c_maxTrackedBufferSlots];
+            uint32          bufferValid[NumShaderTypes * 2u];
+
+            /// A TextureGpu (CbTexture) or a DescriptorSetTexture (CbTextures)
+            void const      *textures[c_maxTrackedTexUnits];
+            uint16          hazardousTexIdx[c_maxTrackedTexUnits];
+            uint32          textureValid;
+
+            /// A HlmsSamplerblock (CbTexture) or a DescriptorSetSampler (CbSamplers)
+            void const      *samplers[c_maxTrackedTexUnits];
+            uint32          samplerValid;
+
+            CbBoundState()  { reset(); }
+
+            void reset(void)
+            {
+                pso = 0;
+                memset( bufferValid, 0, sizeof( bufferValid ) );
+                textureValid = 0;
+                samplerValid = 0;
+            }
+
+            static uint32 unitMask( size_t first, size_t count )
+            {
+                const uint32 mask = count >= 32u ? 0xFFFFFFFFu : ( (1u << count) - 1u );
+                return mask << first;
+            }
+
+            /// Returns true if the units [first; first+count) are all known to be bound to key.
+            static bool isBound( void const * const *bindings, uint32 validMask,
+                                 size_t first, size_t count, const void *key )
+            {
+                if( first + count > c_maxTrackedTexUnits || !count )
+                    return false;
+
+                const uint32 mask = unitMask( first, count );
+                if( (validMask & mask) != mask )
+                    return false;
+
+                for( size_t i=first; i<first + count; ++i )
+                {
+                    if( bindings[i] != key )
+                        return false;
+                }
+
+                return true;
+            }
+
+            /** Some RenderSystems share the binding points between stages (e.g. GL3+ binds
+                const buffers to GL_UNIFORM_BUFFER slot, and tex buffers to GL_TEXTURE0 + slot,
+                whatever the stage), and tex buffers with textures. Forgets what is bound on
+                the given slot on every stage, so a bind is only redundant if the last bind
+                to that binding point was the same one, on the same stage.
+            @param firstIdx
+                0 for const buffers, NumShaderTypes for tex buffers.
+            */
+            void invalidateBufferSlots( size_t firstIdx, size_t first, size_t count )
+            {
+                if( first >= c_maxTrackedBufferSlots || !count )
+                    return;
+
+                const uint32 mask = unitMask( first, std::min( count,
+                                                               c_maxTrackedBufferSlots - first ) );
+                for( size_t i=0; i<NumShaderTypes; ++i )
+                    bufferValid[firstIdx + i] &= ~mask;
+            }
+
+            /// Forgets the textures bound on the given unit (see invalidateBufferSlots)
+            void invalidateTexUnit( size_t unit )
+            {
+                if( unit < c_maxTrackedTexUnits )
+                    textureValid &= ~(1u << unit);
+            }
+
+            static void setBound( void const **bindings, uint32 &validMask,
+                                  size_t first, size_t count, const void *key )
+            {
+                if( first >= c_maxTrackedTexUnits )
+                    return;
+
+                if( first + count > c_maxTrackedTexUnits )
+                {
+                    //Can't track it. Forget what we knew about the affected units.
+                    validMask &= ~unitMask( first, c_maxTrackedTexUnits - first );
+                    return;
+                }
+
+                for( size_t i=first; i<first + count; ++i )
+                    bindings[i] = key;
+                validMask |= unitMask( first, count );
+            }
+        };
+    }
+    //-----------------------------------------------------------------------------------
+    CommandBuffer::CommandBuffer() :
+        mRenderSystem( 0 ),
+        mRemoveRedundantCommands( false ),
+        mCompactedBufferSize( 0 )
     {
     }
     //-----------------------------------------------------------------------------------
@@ -92,8 +221,280 @@ namespace Ogre
                      "CommandBuffer::execute_setInvalidCommand" );
     }
     //-----------------------------------------------------------------------------------
+    unsigned char* CommandBuffer::removeRedundantCommands( unsigned char *cmdBase,
+                                                           unsigned char *cmdBaseEnd,
+                                                           CommandBufferStats &outStats )
+    {
+        CbBoundState state;
+
+        unsigned char * RESTRICT_ALIAS cmdDst = cmdBase;
+
+        //The last surviving command, if it is a draw call. Null otherwise.
+        CbDrawCall *lastDrawCall = 0;
+
+        while( cmdBase != cmdBaseEnd )
+        {
+            const CbBase *cmd = reinterpret_cast<const CbBase*>( cmdBase );
+            bool isRedundant = false;
+            bool isMerged = false;
+            bool isDrawCall = false;
+
+            switch( cmd->commandType )
+            {
+            case CB_SET_PSO:
+            {
+                const CbPipelineStateObject *psoCmd = static_cast<const CbPipelineStateObject*>( cmd );
+                isRedundant = state.pso && state.pso == psoCmd->pso;
+                state.pso = psoCmd->pso;
+                if( !isRedundant )
+                    ++outStats.numPsoChanges;
+                break;
+            }
+            case CB_SET_CONSTANT_BUFFER_VS:
+            case CB_SET_CONSTANT_BUFFER_PS:
+            case CB_SET_CONSTANT_BUFFER_GS:
+            case CB_SET_CONSTANT_BUFFER_HS:
+            case CB_SET_CONSTANT_BUFFER_DS:
+            case CB_SET_CONSTANT_BUFFER_CS:
+            case CB_SET_TEXTURE_BUFFER_VS:
+            case CB_SET_TEXTURE_BUFFER_PS:
+            case CB_SET_TEXTURE_BUFFER_GS:
+            case CB_SET_TEXTURE_BUFFER_HS:
+            case CB_SET_TEXTURE_BUFFER_DS:
+            case CB_SET_TEXTURE_BUFFER_CS:
+            {
+                const CbShaderBuffer *bufferCmd = static_cast<const CbShaderBuffer*>( cmd );
+                const bool isTexBuffer = cmd->commandType >= CB_SET_TEXTURE_BUFFER_VS;
+                const size_t firstIdx = isTexBuffer ? NumShaderTypes : 0u;
+                const size_t idx = isTexBuffer ?
+                            (NumShaderTypes + cmd->commandType - CB_SET_TEXTURE_BUFFER_VS) :
+                            (cmd->commandType - CB_SET_CONSTANT_BUFFER_VS);
+
+                if( isTexBuffer )
+                    state.invalidateTexUnit( bufferCmd->slot );
+
+                if( bufferCmd->slot < c_maxTrackedBufferSlots )
+                {
+                    CbBoundState::BufferRange &bound = state.buffers[idx][bufferCmd->slot];
+                    const uint32 slotMask = 1u << bufferCmd->slot;
+
+                    isRedundant = (state.bufferValid[idx] & slotMask) &&
+                                  bound.buffer == bufferCmd->bufferPacked &&
+                                  bound.offset == bufferCmd->bindOffset &&
+                                  bound.sizeBytes == bufferCmd->bindSizeBytes;
+
+                    state.invalidateBufferSlots( firstIdx, bufferCmd->slot, 1u );
+                    bound.buffer    = bufferCmd->bufferPacked;
+                    bound.offset    = bufferCmd->bindOffset;
+                    bound.sizeBytes = bufferCmd->bindSizeBytes;
+                    state.bufferValid[idx] |= slotMask;
+                }
+
+                if( !isRedundant )
+                    ++outStats.numShaderBufferBinds;
+                break;
+            }
+            case CB_SET_TEXTURE:
+            {
+                const CbTexture *texCmd = static_cast<const CbTexture*>( cmd );
+                isRedundant = CbBoundState::isBound( state.textures, state.textureValid,
+                                                     texCmd->texUnit, 1u, texCmd->texture );
+                if( texCmd->samplerBlock )
+                {
+                    isRedundant &= CbBoundState::isBound( state.samplers, state.samplerValid,
+                                                          texCmd->texUnit, 1u,
+                                                          texCmd->samplerBlock );
+                    CbBoundState::setBound( state.samplers, state.samplerValid,
+                                            texCmd->texUnit, 1u, texCmd->samplerBlock );
+                }
+                CbBoundState::setBound( state.textures, state.textureValid,
+                                        texCmd->texUnit, 1u, texCmd->texture );
+                state.invalidateBufferSlots( NumShaderTypes, texCmd->texUnit, 1u );
+
+                if( !isRedundant )
+                    ++outStats.numTextureBinds;
+                break;
+            }
+            case CB_SET_TEXTURES:
+            {
+                const CbTextures *texCmd = static_cast<const CbTextures*>( cmd );
+                const size_t numTextures = texCmd->descSet->mTextures.size();
+                isRedundant = CbBoundState::isBound( state.textures, state.textureValid,
+                                                     texCmd->texUnit, numTextures, texCmd->descSet );
+                if( isRedundant )
+                {
+                    for( size_t i=0; i<numTextures; ++i )
+                    {
+                        isRedundant &= state.hazardousTexIdx[texCmd->texUnit + i] ==
+                                       texCmd->hazardousTexIdx;
+                    }
+                }
+                CbBoundState::setBound( state.textures, state.textureValid,
+                                        texCmd->texUnit, numTextures, texCmd->descSet );
+                state.invalidateBufferSlots( NumShaderTypes, texCmd->texUnit, numTextures );
+                if( texCmd->texUnit + numTextures <= c_maxTrackedTexUnits )
+                {
+                    for( size_t i=0; i<numTextures; ++i )
+                        state.hazardousTexIdx[texCmd->texUnit + i] = texCmd->hazardousTexIdx;
+                }
+
+                if( !isRedundant )
+                    ++outStats.numTextureBinds;
+                break;
+            }
+            case CB_SET_SAMPLERS:
+            {
+                const CbSamplers *samplerCmd = static_cast<const CbSamplers*>( cmd );
+                const size_t numSamplers = samplerCmd->descSet->mSamplers.size();
+                isRedundant = CbBoundState::isBound( state.samplers, state.samplerValid,
+                                                     samplerCmd->texUnit, numSamplers,
+                                                     samplerCmd->descSet );
+                CbBoundState::setBound( state.samplers, state.samplerValid,
+                                        samplerCmd->texUnit, numSamplers, samplerCmd->descSet );
+
+                if( !isRedundant )
+                    ++outStats.numTextureBinds;
+                break;
+            }
+            case CB_DRAW_CALL_INDEXED_EMULATED_NO_BASE_INSTANCE:
+            case CB_DRAW_CALL_INDEXED_EMULATED:
+            case CB_DRAW_CALL_INDEXED:
+            case CB_DRAW_CALL_STRIP_EMULATED_NO_BASE_INSTANCE:
+            case CB_DRAW_CALL_STRIP_EMULATED:
+            case CB_DRAW_CALL_STRIP:
+            {
+                const CbDrawCall *drawCmd = static_cast<const CbDrawCall*>( cmd );
+                const size_t entrySize = cmd->commandType >= CB_DRAW_CALL_STRIP_EMULATED_NO_BASE_INSTANCE ?
+                            sizeof( CbDrawStrip ) : sizeof( CbDrawIndexed );
+
+                isDrawCall = true;
+                outStats.numDraws += drawCmd->numDraws;
+
+                if( lastDrawCall &&
+                    lastDrawCall->commandType == cmd->commandType &&
+                    lastDrawCall->vao->getVaoName() == drawCmd->vao->getVaoName() &&
+                    lastDrawCall->vao->getOperationType() == drawCmd->vao->getOperationType() &&
+                    reinterpret_cast<size_t>( lastDrawCall->indirectBufferOffset ) +
+                    lastDrawCall->numDraws * entrySize ==
+                    reinterpret_cast<size_t>( drawCmd->indirectBufferOffset ) )
+                {
+                    lastDrawCall->numDraws += drawCmd->numDraws;
+                    isMerged = true;
+                    ++outStats.numMergedDrawCalls;
+                }
+                else
+                {
+                    ++outStats.numDrawCalls;
+                }
+                break;
+            }
+            case CB_START_V1_LEGACY_RENDERING:
+            case CB_LOW_LEVEL_MATERIAL:
+                //These talk to the RenderSystem directly. We can't know what's bound after them.
+                state.reset();
+                break;
+            default:
+                break;
+            }
+
+            if( isRedundant )
+                ++outStats.numRemovedCommands;
+
+            if( !isRedundant && !isMerged )
+            {
+                if( cmdDst != cmdBase )
+                    memcpy( cmdDst, cmdBase, COMMAND_FIXED_SIZE );
+
+                lastDrawCall = isDrawCall ? reinterpret_cast<CbDrawCall*>( cmdDst ) : 0;
+                cmdDst += COMMAND_FIXED_SIZE;
+            }
+
+            cmdBase += COMMAND_FIXED_SIZE;
+        }
+
+        return cmdDst;
+    }
+    //-----------------------------------------------------------------------------------
+    void CommandBuffer::getThreadRange( size_t threadIdx, size_t numThreads,
+                                        size_t &outBegin, size_t &outEnd ) const
+    {
+        const size_t numCommands = mCompactedBufferSize / COMMAND_FIXED_SIZE;
+        const size_t commandsPerThread = (numCommands + numThreads - 1u) / numThreads;
+
+        outBegin    = std::min( threadIdx * commandsPerThread, numCommands ) * COMMAND_FIXED_SIZE;
+        outEnd      = std::min( (threadIdx + 1u) * commandsPerThread,
+                                numCommands ) * COMMAND_FIXED_SIZE;
+    }
+    //-----------------------------------------------------------------------------------
+    bool CommandBuffer::_prepareParallelRemoveRedundantCommands( size_t numThreads )
+    {
+        assert( mCompactedRanges.empty() );
+
+        const size_t numCommands = mCommandBuffer.size() / COMMAND_FIXED_SIZE;
+        if( !mRemoveRedundantCommands || numThreads < 2u ||
+            numCommands < numThreads * c_minCommandsPerThread )
+        {
+            return false;
+        }
+
+        mCompactedBufferSize = mCommandBuffer.size();
+        mCompactedRanges.resize( numThreads );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void CommandBuffer::_removeRedundantCommands( size_t threadIdx, size_t numThreads )
+    {
+        assert( numThreads == mCompactedRanges.size() &&
+                "Call _prepareParallelRemoveRedundantCommands first!" );
+
+        size_t begin, end;
+        getThreadRange( threadIdx, numThreads, begin, end );
+
+        CompactedRange &range = mCompactedRanges[threadIdx];
+        unsigned char *cmdBase = mCommandBuffer.begin();
+        range.stats = CommandBufferStats();
+        range.end = static_cast<size_t>( removeRedundantCommands( cmdBase + begin, cmdBase + end,
+                                                                  range.stats ) - cmdBase );
+    }
+    //-----------------------------------------------------------------------------------
+    void CommandBuffer::joinCompactedRanges(void)
+    {
+        assert( mCommandBuffer.size() == mCompactedBufferSize &&
+                "Commands were added after _prepareParallelRemoveRedundantCommands!" );
+
+        unsigned char *cmdBase = mCommandBuffer.begin();
+        unsigned char *cmdDst = cmdBase;
+
+        const size_t numThreads = mCompactedRanges.size();
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            size_t begin, end;
+            getThreadRange( i, numThreads, begin, end );
+
+            const CompactedRange &range = mCompactedRanges[i];
+            const size_t numBytes = range.end - begin;
+            if( cmdDst != cmdBase + begin )
+                memmove( cmdDst, cmdBase + begin, numBytes );
+            cmdDst += numBytes;
+
+            mStats += range.stats;
+        }
+
+        mCommandBuffer.resize( static_cast<size_t>( cmdDst - cmdBase ) );
+        mCompactedRanges.clear();
+    }
+    //-----------------------------------------------------------------------------------
     void CommandBuffer::execute(void)
     {
+        if( !mCompactedRanges.empty() )
+            joinCompactedRanges();
+        else if( mRemoveRedundantCommands )
+        {
+            unsigned char *cmdEnd = removeRedundantCommands( mCommandBuffer.begin(),
+                                                             mCommandBuffer.end(), mStats );
+            mCommandBuffer.resize( static_cast<size_t>( cmdEnd - mCommandBuffer.begin() ) );
+        }
+
         unsigned char const * RESTRICT_ALIAS cmdBase = mCommandBuffer.begin();
 
         size_t cmdBufferCount = mCommandBuffer.size() / CommandBuffer::COMMAND_FIXED_SIZE;
@@ -129,4 +530,10 @@ namespace Ogre
 
         return retVal;
     }
+    //-----------------------------------------------------------------------------------
+    void CommandBuffer::_appendCommandStream( const unsigned char *commands, size_t sizeBytes )
+    {
+        assert( !(sizeBytes % COMMAND_FIXED_SIZE) );
+        mCommandBuffer.appendPOD( commands, commands + sizeBytes );
+    }
 }
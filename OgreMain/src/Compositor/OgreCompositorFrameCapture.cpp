@@ -0,0 +1,418 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Compositor/OgreCompositorFrameCapture.h"
+#include "Compositor/OgreCompositorNode.h"
+#include "Compositor/OgreCompositorNodeDef.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "Compositor/OgreCompositorWorkspaceDef.h"
+#include "Compositor/Pass/OgreCompositorPass.h"
+#include "Compositor/Pass/OgreCompositorPassDef.h"
+#include "CommandBuffer/OgreCommandBuffer.h"
+#include "CommandBuffer/OgreCbDrawCall.h"
+#include "CommandBuffer/OgreCbShaderBuffer.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreIndirectBufferPacked.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "OgreRenderQueue.h"
+#include "OgreRenderSystem.h"
+#include "OgreMovableObject.h"
+#include "OgreRenderable.h"
+#include "OgreLwString.h"
+#include "OgreTimer.h"
+
+namespace Ogre
+{
+    static const char *c_commandNames[MAX_COMMAND_BUFFER] =
+    {
+        "Invalid",
+        "SetVao",
+        "SetIndirectBuffer",
+        "DrawCallIndexedEmulatedNoBaseInstance",
+        "DrawCallIndexedEmulated",
+        "DrawCallIndexed",
+        "DrawCallStripEmulatedNoBaseInstance",
+        "DrawCallStripEmulated",
+        "DrawCallStrip",
+        "SetConstantBufferVS",
+        "SetConstantBufferPS",
+        "SetConstantBufferGS",
+        "SetConstantBufferHS",
+        "SetConstantBufferDS",
+        "SetConstantBufferCS",
+        "SetConstantBufferInvalid",
+        "SetTextureBufferVS",
+        "SetTextureBufferPS",
+        "SetTextureBufferGS",
+        "SetTextureBufferHS",
+        "SetTextureBufferDS",
+        "SetTextureBufferCS",
+        "SetTextureBufferInvalid",
+        "SetPso",
+        "SetTexture",
+        "SetTextures",
+        "SetSamplers",
+        "StartV1LegacyRendering",
+        "SetV1RenderOp",
+        "DrawV1IndexedNoBaseInstance",
+        "DrawV1Indexed",
+        "DrawV1StripNoBaseInstance",
+        "DrawV1Strip",
+        "LowLevelMaterial"
+    };
+    //-----------------------------------------------------------------------------------
+    CompositorFrameCapture::CompositorFrameCapture( RenderSystem *renderSystem ) :
+        mRenderSystem( renderSystem ),
+        mCaptureRequested( false ),
+        mCapturing( false ),
+        mReplayEnabled( false ),
+        mReplayRemoveRedundantCommands( false ),
+        mReplayCommandBuffer( 0 ),
+        mLastReplayTime( 0 )
+    {
+        mReplayCommandBuffer = new CommandBuffer();
+    }
+    //-----------------------------------------------------------------------------------
+    CompositorFrameCapture::~CompositorFrameCapture()
+    {
+        clear();
+        delete mReplayCommandBuffer;
+        mReplayCommandBuffer = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::requestCapture(void)
+    {
+        mCaptureRequested = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::clear(void)
+    {
+        VaoManager *vaoManager = mRenderSystem->getVaoManager();
+
+        IndirectSegmentVec::const_iterator itor = mIndirectSegments.begin();
+        IndirectSegmentVec::const_iterator end  = mIndirectSegments.end();
+
+        while( itor != end )
+        {
+            vaoManager->destroyIndirectBuffer( itor->replayBuffer );
+            ++itor;
+        }
+
+        mIndirectSegments.clear();
+        mPasses.clear();
+        mRenderQueueEntries.clear();
+        mCommands.clear();
+        mCapturing = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::setReplayRemoveRedundantCommands( bool bRemove )
+    {
+        mReplayRemoveRedundantCommands = bRemove;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t CompositorFrameCapture::getNumCommands(void) const
+    {
+        return mCommands.size() / CommandBuffer::getCommandSize();
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::closeCurrentPass(void)
+    {
+        if( !mPasses.empty() )
+        {
+            Pass &pass = mPasses.back();
+            pass.rqEntryEnd = mRenderQueueEntries.size();
+            pass.cmdEnd = mCommands.size();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_notifyFrameBegin(void)
+    {
+        if( mCaptureRequested )
+        {
+            clear();
+            mCaptureRequested = false;
+            mCapturing = true;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_notifyFrameEnd(void)
+    {
+        if( mCapturing )
+        {
+            closeCurrentPass();
+            mCapturing = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_notifyPassBegin( const CompositorPass *pass,
+                                                   RenderPassDescriptor *renderPassDesc,
+                                                   TextureGpu *anyTargetTexture, uint8 anyMipLevel,
+                                                   const Vector4 *vpSize, const Vector4 *scissors,
+                                                   uint32 numViewports )
+    {
+        assert( mCapturing );
+        assert( numViewports <= 16u );
+
+        closeCurrentPass();
+
+        const CompositorNode *parentNode = pass->getParentNode();
+
+        Pass newPass;
+        newPass.workspaceName   = parentNode->getWorkspace()->getDefinition()->getNameStr();
+        newPass.nodeName        = parentNode->getDefinition()->getNameStr();
+        newPass.passType        = pass->getType();
+        newPass.identifier      = pass->getDefinition()->mIdentifier;
+        newPass.renderPassDesc  = renderPassDesc;
+        newPass.anyTargetTexture= anyTargetTexture;
+        newPass.anyMipLevel     = anyMipLevel;
+        newPass.numViewports    = numViewports;
+        for( size_t i=0; i<numViewports; ++i )
+        {
+            newPass.vpSize[i]   = vpSize[i];
+            newPass.scissors[i] = scissors[i];
+        }
+        newPass.includeOverlays = pass->getDefinition()->mIncludeOverlays;
+        newPass.rqEntryStart    = mRenderQueueEntries.size();
+        newPass.rqEntryEnd      = newPass.rqEntryStart;
+        newPass.cmdStart        = mCommands.size();
+        newPass.cmdEnd          = newPass.cmdStart;
+
+        mPasses.push_back( newPass );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_addRenderQueueEntries( uint8 renderQueueId,
+                                                         const QueuedRenderable *begin,
+                                                         const QueuedRenderable *end,
+                                                         bool casterPass )
+    {
+        assert( mCapturing );
+
+        if( mPasses.empty() )
+            return;
+
+        mRenderQueueEntries.reserve( mRenderQueueEntries.size() + size_t( end - begin ) );
+
+        const QueuedRenderable *itor = begin;
+        while( itor != end )
+        {
+            RenderQueueEntry entry;
+            entry.hash          = itor->hash;
+            entry.renderable    = itor->renderable;
+            entry.movableObject = itor->movableObject;
+            entry.vaoName       = 0;
+            entry.renderQueueId = renderQueueId;
+            entry.casterPass    = casterPass;
+
+            const VertexArrayObjectArray &vaos =
+                    itor->renderable->getVaos( static_cast<VertexPass>( casterPass ) );
+            if( !vaos.empty() )
+                entry.vaoName = vaos[itor->movableObject->getCurrentMeshLod()]->getVaoName();
+
+            mRenderQueueEntries.push_back( entry );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_addIndirectData( IndirectBufferPacked *indirectBuffer,
+                                                   const unsigned char *data, size_t sizeBytes )
+    {
+        assert( mCapturing );
+
+        if( mPasses.empty() || !sizeBytes )
+            return;
+
+        VaoManager *vaoManager = mRenderSystem->getVaoManager();
+
+        IndirectSegment segment;
+        segment.original        = indirectBuffer;
+        segment.originalStart   = indirectBuffer->_getFinalBufferStart();
+        segment.replayBuffer    = vaoManager->createIndirectBuffer(
+                                      sizeBytes, BT_DEFAULT,
+                                      const_cast<unsigned char*>( data ), false );
+        mIndirectSegments.push_back( segment );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_addCommands( const CommandBuffer *commandBuffer )
+    {
+        assert( mCapturing );
+
+        if( mPasses.empty() )
+            return;
+
+        const FastArray<unsigned char> &commands = commandBuffer->_getCommandStream();
+        const size_t prevSize = mCommands.size();
+        mCommands.appendPOD( commands.begin(), commands.end() );
+
+        //The RenderQueue's indirect buffers will be overwritten in the next frames.
+        //Point the commands to our copy instead.
+        const IndirectSegment *segment = 0;
+
+        const size_t cmdSize = CommandBuffer::getCommandSize();
+        unsigned char *cmdBase = mCommands.begin() + prevSize;
+        unsigned char *cmdEnd  = mCommands.end();
+
+        while( cmdBase != cmdEnd )
+        {
+            CbBase *cmd = reinterpret_cast<CbBase*>( cmdBase );
+
+            if( cmd->commandType == CB_SET_INDIRECT_BUFFER )
+            {
+                CbIndirectBuffer *indirectCmd = static_cast<CbIndirectBuffer*>( cmd );
+
+                segment = 0;
+                IndirectSegmentVec::const_reverse_iterator itor = mIndirectSegments.rbegin();
+                IndirectSegmentVec::const_reverse_iterator end  = mIndirectSegments.rend();
+                while( itor != end && !segment )
+                {
+                    if( itor->original == indirectCmd->indirectBuffer )
+                        segment = &(*itor);
+                    ++itor;
+                }
+
+                if( segment )
+                    indirectCmd->indirectBuffer = segment->replayBuffer;
+            }
+            else if( segment &&
+                     cmd->commandType >= CB_DRAW_CALL_INDEXED_EMULATED_NO_BASE_INSTANCE &&
+                     cmd->commandType <= CB_DRAW_CALL_STRIP )
+            {
+                CbDrawCall *drawCmd = static_cast<CbDrawCall*>( cmd );
+                const size_t offset = reinterpret_cast<size_t>( drawCmd->indirectBufferOffset ) -
+                                      segment->originalStart +
+                                      segment->replayBuffer->_getFinalBufferStart();
+                drawCmd->indirectBufferOffset = reinterpret_cast<void*>( offset );
+            }
+
+            cmdBase += cmdSize;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::_replay(void)
+    {
+        Timer timer;
+        const uint64 startTime = timer.getMicroseconds();
+
+        mReplayCommandBuffer->setCurrentRenderSystem( mRenderSystem );
+        mReplayCommandBuffer->setRemoveRedundantCommands( mReplayRemoveRedundantCommands );
+        mRenderSystem->setCurrentPassIterationCount( 1 );
+
+        PassVec::const_iterator itor = mPasses.begin();
+        PassVec::const_iterator end  = mPasses.end();
+
+        while( itor != end )
+        {
+            const Pass &pass = *itor;
+            mRenderSystem->beginRenderPassDescriptor( pass.renderPassDesc, pass.anyTargetTexture,
+                                                      pass.anyMipLevel, pass.vpSize, pass.scissors,
+                                                      pass.numViewports, pass.includeOverlays,
+                                                      false );
+            mRenderSystem->executeRenderPassDescriptorDelayedActions();
+
+            if( pass.cmdEnd > pass.cmdStart )
+            {
+                mReplayCommandBuffer->_appendCommandStream( mCommands.begin() + pass.cmdStart,
+                                                            pass.cmdEnd - pass.cmdStart );
+                mReplayCommandBuffer->execute();
+            }
+
+            ++itor;
+        }
+
+        mLastReplayTime = timer.getMicroseconds() - startTime;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorFrameCapture::dumpJson( String &outJson ) const
+    {
+        char tmpBuffer[512];
+        LwString text( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+
+        text.a( "{\n\t\"num_commands\" : ", (uint64)getNumCommands(),
+                ",\n\t\"num_render_queue_entries\" : ", (uint64)mRenderQueueEntries.size(),
+                ",\n\t\"passes\" :\n\t[" );
+        outJson += text.c_str();
+
+        const size_t cmdSize = CommandBuffer::getCommandSize();
+
+        for( size_t i=0; i<mPasses.size(); ++i )
+        {
+            const Pass &pass = mPasses[i];
+
+            outJson += i == 0u ? "\n\t\t{" : ",\n\t\t{";
+            outJson += "\n\t\t\t\"workspace\" : \"" + pass.workspaceName + "\",";
+            outJson += "\n\t\t\t\"node\" : \"" + pass.nodeName + "\",";
+            text.clear();
+            text.a( "\n\t\t\t\"type\" : \"", CompositorPassTypeEnumNames[pass.passType],
+                    "\",\n\t\t\t\"identifier\" : ", pass.identifier );
+            text.a( ",\n\t\t\t\"num_viewports\" : ", pass.numViewports, "," );
+            outJson += text.c_str();
+
+            uint32 commandCounts[MAX_COMMAND_BUFFER];
+            memset( commandCounts, 0, sizeof( commandCounts ) );
+            for( size_t j=pass.cmdStart; j<pass.cmdEnd; j += cmdSize )
+            {
+                const CbBase *cmd = reinterpret_cast<const CbBase*>( mCommands.begin() + j );
+                if( cmd->commandType < MAX_COMMAND_BUFFER )
+                    ++commandCounts[cmd->commandType];
+            }
+
+            outJson += "\n\t\t\t\"commands\" : {";
+            bool firstCommand = true;
+            for( size_t j=0; j<MAX_COMMAND_BUFFER; ++j )
+            {
+                if( commandCounts[j] )
+                {
+                    text.clear();
+                    text.a( firstCommand ? " \"" : ", \"", c_commandNames[j], "\" : ",
+                            commandCounts[j] );
+                    outJson += text.c_str();
+                    firstCommand = false;
+                }
+            }
+            outJson += " },\n\t\t\t\"render_queue\" :\n\t\t\t[";
+
+            for( size_t j=pass.rqEntryStart; j<pass.rqEntryEnd; ++j )
+            {
+                const RenderQueueEntry &entry = mRenderQueueEntries[j];
+                text.clear();
+                text.a( j == pass.rqEntryStart ? "\n" : ",\n", "\t\t\t\t{ \"rq\" : ",
+                        (uint32)entry.renderQueueId, ", \"hash\" : ", entry.hash );
+                text.a( ", \"vao\" : ", entry.vaoName, ", \"caster\" : ",
+                        entry.casterPass ? "true" : "false", ", \"object\" : \"" );
+                outJson += text.c_str();
+                outJson += entry.movableObject->getName();
+                outJson += "\" }";
+            }
+
+            outJson += "\n\t\t\t]\n\t\t}";
+        }
+
+        outJson += "\n\t]\n}\n";
+    }
+}
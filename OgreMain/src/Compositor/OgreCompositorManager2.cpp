@@ -49,6 +49,7 @@ THE SOFTWARE.
 #include "OgreSceneManagerEnumerator.h"
 #include "OgreHlmsManager.h"
 #include "OgreHlms.h"
+#include "Compositor/OgreCompositorFrameCapture.h"
 
 namespace Ogre
 {
@@ -82,9 +83,11 @@ namespace Ogre
         mSharedTriangleFS( 0 ),
         mSharedQuadFS( 0 ),
         mDummyObjectMemoryManager( 0 ),
-        mCompositorPassProvider( 0 )
+        mCompositorPassProvider( 0 ),
+        mFrameCapture( 0 )
     {
         mDummyObjectMemoryManager = new ObjectMemoryManager();
+        mFrameCapture = OGRE_NEW CompositorFrameCapture( renderSystem );
         mSharedTriangleFS   = OGRE_NEW v1::Rectangle2D( false, 0, mDummyObjectMemoryManager, 0 );
         mSharedQuadFS       = OGRE_NEW v1::Rectangle2D( true, 0, mDummyObjectMemoryManager, 0 );
 
@@ -191,6 +194,10 @@ namespace Ogre
             textureManager->destroyTexture( *i );
         mNullTextureList.clear();
 
+        //The capture references the workspaces' descriptors & textures
+        OGRE_DELETE mFrameCapture;
+        mFrameCapture = 0;
+
         removeAllWorkspaces();
 
         removeAllWorkspaceDefinitions();
@@ -681,6 +688,8 @@ namespace Ogre
 
         mRenderSystem->_beginFrameOnce();
 
+        mFrameCapture->_notifyFrameBegin();
+
         itor = mWorkspaces.begin();
 
         while( itor != end )
@@ -715,14 +724,21 @@ namespace Ogre
         }
 
         //The actual update
-        itor = mWorkspaces.begin();
-
-        while( itor != end )
+        if( mFrameCapture->getReplayEnabled() && mFrameCapture->hasCapture() )
         {
-            CompositorWorkspace *workspace = (*itor);
-            if( workspace->getEnabled() && workspace->isValid() )
-                    workspace->_update();
-            ++itor;
+            mFrameCapture->_replay();
+        }
+        else
+        {
+            itor = mWorkspaces.begin();
+
+            while( itor != end )
+            {
+                CompositorWorkspace *workspace = (*itor);
+                if( workspace->getEnabled() && workspace->isValid() )
+                        workspace->_update();
+                ++itor;
+            }
         }
 
         itor = mWorkspaces.begin();
@@ -735,6 +751,8 @@ namespace Ogre
             ++itor;
         }
 
+        mFrameCapture->_notifyFrameEnd();
+
         mRenderSystem->_update();
 
         mRenderSystem->endRenderPassDescriptor();
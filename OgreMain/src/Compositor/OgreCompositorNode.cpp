@@ -57,6 +57,9 @@ THE SOFTWARE.
 #include "OgreTextureGpu.h"
 
 #include "OgreLogManager.h"
+#include "OgreRoot.h"
+#include "OgreTimer.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -75,6 +78,8 @@ namespace Ogre
         mInTextures.resize( mDefinition->getNumInputChannels(), CompositorChannel() );
         mOutTextures.resize( mDefinition->mOutChannelMapping.size() );
 
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Compositor, false );
+
         //Create local textures
         TextureDefinitionBase::createTextures( definition->mLocalTextureDefs, mLocalTextures,
                                                 id, finalTarget, mRenderSystem );
@@ -97,6 +102,9 @@ namespace Ogre
         //passes may hold listener references to these TextureGpus
         assert( mPasses.empty() && "CompositorNode::destroyAllPasses not called!" );
 
+        //Textures borrowed from other nodes are not ours to destroy
+        restoreAliasedTextures();
+
         //Don't leave dangling pointers
         disconnectOutput();
 
@@ -430,6 +438,9 @@ namespace Ogre
 
         mNumConnectedBufferInputs = 0;
 
+        //The new connections may change the lifetimes
+        _removeTextureAliases();
+
         //This call will clear only our outputs that come from input channels.
         routeOutputs();
 
@@ -442,6 +453,86 @@ namespace Ogre
         mConnectedNodes.clear();
     }
     //-----------------------------------------------------------------------------------
+    void CompositorNode::restoreAliasedTextures(void)
+    {
+        CompositorChannelVec::const_iterator itor = mAliasedLocalTextures.begin();
+        CompositorChannelVec::const_iterator end  = mAliasedLocalTextures.end();
+
+        while( itor != end )
+        {
+            if( *itor )
+                mLocalTextures[itor - mAliasedLocalTextures.begin()] = *itor;
+            ++itor;
+        }
+
+        mAliasedLocalTextures.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorNode::_aliasLocalTexture( size_t localTextureIdx, TextureGpu *sharedTexture )
+    {
+        assert( localTextureIdx < mLocalTextures.size() );
+
+        if( mAliasedLocalTextures.empty() )
+            mAliasedLocalTextures.resize( mLocalTextures.size(), CompositorChannel() );
+
+        assert( !mAliasedLocalTextures[localTextureIdx] && "Texture is already aliased!" );
+
+        TextureGpu *ownTexture = mLocalTextures[localTextureIdx];
+        mAliasedLocalTextures[localTextureIdx] = ownTexture;
+        mLocalTextures[localTextureIdx] = sharedTexture;
+
+        //Release the GPU memory
+        ownTexture->_transitionTo( GpuResidency::OnStorage, (uint8*)0 );
+
+        routeOutputs();
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorNode::_replaceInputTexture( TextureGpu *oldTexture, TextureGpu *newTexture )
+    {
+        bool bReplaced = false;
+
+        CompositorChannelVec::iterator itor = mInTextures.begin();
+        CompositorChannelVec::iterator end  = mInTextures.end();
+
+        while( itor != end )
+        {
+            if( *itor == oldTexture )
+            {
+                *itor = newTexture;
+                bReplaced = true;
+            }
+            ++itor;
+        }
+
+        if( bReplaced )
+            routeOutputs();
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorNode::_removeTextureAliases(void)
+    {
+        if( mAliasedLocalTextures.empty() )
+            return;
+
+        const TextureGpu *finalTarget = mWorkspace->getFinalTarget();
+
+        CompositorChannelVec::const_iterator itor = mAliasedLocalTextures.begin();
+        CompositorChannelVec::const_iterator end  = mAliasedLocalTextures.end();
+
+        while( itor != end )
+        {
+            if( *itor )
+            {
+                //The final target may have been resized while it was aliased.
+                const size_t idx = static_cast<size_t>( itor - mAliasedLocalTextures.begin() );
+                TextureDefinitionBase::setupTexture( *itor, mDefinition->mLocalTextureDefs[idx],
+                                                     finalTarget );
+            }
+            ++itor;
+        }
+
+        restoreAliasedTextures();
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorNode::setEnabled( bool bEnabled )
     {
         if( mEnabled != bEnabled )
@@ -819,6 +910,8 @@ namespace Ogre
         {
             CompositorPass *pass = *itPasses;
             pass->_placeBarriersAndEmulateUavExecution( boundUavs, uavsAccess, resourcesLayout );
+            pass->_updateWrittenResources( boundUavs );
+            mWorkspace->_trackAsyncCompute( pass, boundUavs );
 
             ++itPasses;
         }
@@ -873,9 +966,16 @@ namespace Ogre
 
             const CompositorTargetDef *targetDef = passDef->getParentTargetDef();
 
+            //Wait even if the pass ends up being skipped, since
+            //following passes rely on this wait having happened.
+            if( pass->getWaitForAsyncCompute() )
+                mRenderSystem->_waitForAsyncCompute();
+
             if( executionMask & passDef->mExecutionMask &&
                 (!shadowNode || (!shadowNode->isShadowMapIdxInValidRange( passDef->mShadowMapIdx )
                 || (shadowNode->_shouldUpdateShadowMapIdx( passDef->mShadowMapIdx )
+                && (!passDef->mShadowMapCache ||
+                    shadowNode->_shouldUpdateShadowMapCache( passDef->mShadowMapIdx ))
                 && (shadowNode->getShadowMapLightTypeMask( passDef->mShadowMapIdx ) &
                     targetDef->getShadowMapSupportedLightTypes())))) )
             {
@@ -891,8 +991,24 @@ namespace Ogre
                     ++itExposed;
                 }
 
-                //Execute pass
-                pass->execute( lodCamera );
+                //Execute pass, unless its last output can be reused
+                if( !pass->_isResultCacheValid() )
+                {
+                    if( mWorkspace->getCpuTiming() )
+                    {
+                        //Accumulate, shadow nodes may execute more than once per update
+                        Timer *timer = Root::getSingleton().getTimer();
+                        const uint64 startTime = timer->getMicroseconds();
+                        pass->execute( lodCamera );
+                        pass->_setLastCpuTime( pass->getLastCpuTime() +
+                                               timer->getMicroseconds() - startTime );
+                    }
+                    else
+                    {
+                        pass->execute( lodCamera );
+                    }
+                    pass->_notifyExecuted();
+                }
 
                 //Remove our textures
                 sceneManager->_removeCompositorTextures( oldNumTextures );
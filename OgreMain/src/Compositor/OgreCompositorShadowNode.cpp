@@ -51,6 +51,7 @@ THE SOFTWARE.
 #include "OgreShadowCameraSetupPSSM.h"
 
 #include "OgreLogManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 #if OGRE_COMPILER == OGRE_COMPILER_MSVC
     #include <intrin.h>
@@ -86,7 +87,10 @@ namespace Ogre
             mDefinition( definition ),
             mLastCamera( 0 ),
             mLastFrame( -1 ),
-            mNumActiveShadowMapCastingLights( 0 )
+            mNumActiveShadowMapCastingLights( 0 ),
+            mSortLightsByScreenCoverage( false ),
+            mDistantLightsMinDistance( 0 ),
+            mDistantLightsUpdateInterval( 1u )
     {
         mShadowMapCameras.reserve( definition->mShadowMapTexDefinitions.size() );
         mLocalTextures.reserve( mLocalTextures.size() + definition->mShadowMapTexDefinitions.size() );
@@ -99,7 +103,10 @@ namespace Ogre
             {
                 TextureGpu *refTex = *tempIt;
                 if( refTex )
+                {
                     refTex->_setSourceType( TextureSourceType::Shadow );
+                    refTex->_setMemoryTag( GpuMemoryTag::ShadowMaps );
+                }
                 ++tempIt;
             }
         }
@@ -132,6 +139,16 @@ namespace Ogre
             shadowMapCamera.maxDistance = 100000.0f;
             for( size_t i=0; i<Light::NUM_LIGHT_TYPES; ++i )
                 shadowMapCamera.scenePassesViewportSize[i] = -Vector2::UNIT_SCALE;
+            shadowMapCamera.hasCache = false;
+            shadowMapCamera.cacheDirty = true;
+            shadowMapCamera.cachedLight = 0;
+            shadowMapCamera.cachedPosition = Vector3::ZERO;
+            shadowMapCamera.cachedOrientation = Quaternion::IDENTITY;
+            shadowMapCamera.cachedProjParams = Vector4::ZERO;
+            shadowMapCamera.lastRenderedLight = 0;
+            shadowMapCamera.lastRenderedCamera = 0;
+            shadowMapCamera.lastRenderedFrame = 0;
+            shadowMapCamera.throttled = false;
 
             {
                 //Find out the index to our texture in both mLocalTextures & mContiguousShadowMapTex
@@ -211,6 +228,33 @@ namespace Ogre
             ++itor;
         }
 
+        //Find out which shadow maps are cached, and where
+        {
+            CompositorTargetDefVec::const_iterator itTarget = mDefinition->mTargetPasses.begin();
+            CompositorTargetDefVec::const_iterator enTarget = mDefinition->mTargetPasses.end();
+
+            while( itTarget != enTarget )
+            {
+                const CompositorPassDefVec &passDefs = itTarget->getCompositorPasses();
+                CompositorPassDefVec::const_iterator itPass = passDefs.begin();
+                CompositorPassDefVec::const_iterator enPass = passDefs.end();
+
+                while( itPass != enPass )
+                {
+                    if( (*itPass)->mShadowMapCache &&
+                        (*itPass)->mShadowMapIdx < mShadowMapCameras.size() )
+                    {
+                        ShadowMapCamera &smCamera = mShadowMapCameras[(*itPass)->mShadowMapIdx];
+                        smCamera.hasCache = true;
+                        smCamera.cacheTextureName = itTarget->getRenderTargetName();
+                    }
+                    ++itPass;
+                }
+
+                ++itTarget;
+            }
+        }
+
         // Shadow Nodes don't have input; and global textures should be ready by
         // the time we get created. Therefore, we can safely initialize now as our
         // output may be used in regular nodes and we're created on-demand (as soon
@@ -271,11 +315,13 @@ namespace Ogre
         LightListInfo const *mLightList;
         uint32              mCombinedVisibilityFlags;
         Vector3             mCameraPos;
+        bool                mSortByScreenCoverage;
 
     public:
         ShadowMappingLightCmp( LightListInfo const *lightList, uint32 combinedVisibilityFlags,
-                               const Vector3 &cameraPos ) :
-            mLightList( lightList ), mCombinedVisibilityFlags( combinedVisibilityFlags ), mCameraPos( cameraPos )
+                               const Vector3 &cameraPos, bool sortByScreenCoverage ) :
+            mLightList( lightList ), mCombinedVisibilityFlags( combinedVisibilityFlags ),
+            mCameraPos( cameraPos ), mSortByScreenCoverage( sortByScreenCoverage )
         {
         }
 
@@ -309,6 +355,18 @@ namespace Ogre
                           mLightList->boundingSphere[_l].getRadius();
             Real fDistR = mCameraPos.distance( mLightList->boundingSphere[_r].getCenter() ) -
                           mLightList->boundingSphere[_r].getRadius();
+
+            if( mSortByScreenCoverage && fDistL > Real( 0.0f ) && fDistR > Real( 0.0f ) )
+            {
+                //The projected size is proportional to radius / distance. Compare
+                //radiusL / distL > radiusR / distR without dividing.
+                //If the camera is inside a light's sphere, that light covers the whole screen.
+                const Real fCoverageL = mLightList->boundingSphere[_l].getRadius() * fDistR;
+                const Real fCoverageR = mLightList->boundingSphere[_r].getRadius() * fDistL;
+                if( fCoverageL != fCoverageR )
+                    return fCoverageL > fCoverageR;
+            }
+
             return fDistL < fDistR;
         }
     };
@@ -397,10 +455,12 @@ namespace Ogre
         std::partial_sort_copy( MemoryLessInputIterator( startIndex ),
                             MemoryLessInputIterator( globalLightList.lights.size() ),
                             mTmpSortedIndexes.begin(), mTmpSortedIndexes.end(),
-                            ShadowMappingLightCmp( &globalLightList, combinedVisibilityFlags, camPos ) );
+                            ShadowMappingLightCmp( &globalLightList, combinedVisibilityFlags, camPos,
+                                                   mSortLightsByScreenCoverage ) );
 
-        std::sort( mTmpSortedIndexes.begin(), mTmpSortedIndexes.end(),
-                   SortByLightTypeCmp( &globalLightList ) );
+        //Stable, so that the most important lights of each type get the first shadow maps
+        std::stable_sort( mTmpSortedIndexes.begin(), mTmpSortedIndexes.end(),
+                          SortByLightTypeCmp( &globalLightList ) );
 
         vector<size_t>::type::const_iterator itor = mTmpSortedIndexes.begin();
         vector<size_t>::type::const_iterator end  = mTmpSortedIndexes.end();
@@ -533,6 +593,80 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::isShadowMapUpdateThrottled( const ShadowMapCamera &smCamera,
+                                                           const Light *light,
+                                                           const Camera *camera ) const
+    {
+        if( mDistantLightsUpdateInterval <= 1u || light->getType() == Light::LT_DIRECTIONAL )
+            return false;
+
+        //Something changed since the last time it was rendered, the old one is of no use.
+        if( smCamera.lastRenderedLight != light || smCamera.lastRenderedCamera != camera )
+            return false;
+
+        const size_t currentFrame = mWorkspace->getFrameCount();
+        if( currentFrame - smCamera.lastRenderedFrame >= mDistantLightsUpdateInterval )
+            return false;
+
+        const Real distance = camera->getDerivedPosition().distance(
+                                  light->getParentNode()->_getDerivedPosition() ) -
+                              light->getAttenuationRange();
+        return distance > mDistantLightsMinDistance;
+    }
+    //-----------------------------------------------------------------------------------
+    Vector4 CompositorShadowNode::getShadowMapCacheProjParams( const Camera *texCamera )
+    {
+        if( texCamera->getProjectionType() == PT_ORTHOGRAPHIC )
+        {
+            return Vector4( texCamera->getOrthoWindowWidth(), texCamera->getOrthoWindowHeight(),
+                            texCamera->getNearClipDistance(), texCamera->getFarClipDistance() );
+        }
+        else
+        {
+            return Vector4( -texCamera->getFOVy().valueRadians(), texCamera->getAspectRatio(),
+                            texCamera->getNearClipDistance(), texCamera->getFarClipDistance() );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::isShadowMapCacheStale( const ShadowMapCamera &smCamera,
+                                                      const Light *light,
+                                                      const Vector2 &vpRealSize )
+    {
+        if( smCamera.cachedLight != light )
+            return true;
+
+        const Camera *texCamera = smCamera.camera;
+
+        const Vector4 projParams = getShadowMapCacheProjParams( texCamera );
+        const Vector4 projDiff = projParams - smCamera.cachedProjParams;
+        const Real projTolerance = Real( 1e-4f ) * std::max( Real( 1.0f ), projParams.w );
+        if( Math::Abs( projDiff.x ) > Real( 1e-5f ) * std::max( Real( 1.0f ), projParams.x ) ||
+            Math::Abs( projDiff.y ) > Real( 1e-5f ) * std::max( Real( 1.0f ), projParams.y ) ||
+            Math::Abs( projDiff.z ) > projTolerance || Math::Abs( projDiff.w ) > projTolerance )
+        {
+            return true;
+        }
+
+        if( !texCamera->getOrientation().equals( smCamera.cachedOrientation, Radian( 1e-4f ) ) )
+            return true;
+
+        //Measure the displacement in the shadow camera's space. Ortho cameras that snap
+        //to texels (i.e. stable PSSM splits) move in whole texels, thus anything below
+        //half a texel is just floating point noise.
+        const Vector3 localDiff = smCamera.cachedOrientation.Inverse() *
+                                  (texCamera->getPosition() - smCamera.cachedPosition);
+        Vector2 tolerance( projTolerance, projTolerance );
+        if( texCamera->getProjectionType() == PT_ORTHOGRAPHIC &&
+            vpRealSize.x > Real( 0.0f ) && vpRealSize.y > Real( 0.0f ) )
+        {
+            tolerance.x = Real( 0.5f ) * projParams.x / vpRealSize.x;
+            tolerance.y = Real( 0.5f ) * projParams.y / vpRealSize.y;
+        }
+
+        return Math::Abs( localDiff.x ) > tolerance.x || Math::Abs( localDiff.y ) > tolerance.y ||
+               Math::Abs( localDiff.z ) > projTolerance;
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorShadowNode::_update( Camera* camera, const Camera *lodCamera,
                                         SceneManager *sceneManager )
     {
@@ -540,6 +674,8 @@ namespace Ogre
 
         buildClosestLightList( camera, lodCamera );
 
+        mBatchedCullCameras.clear();
+
         //Setup all the cameras
         CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itor =
                                                             mDefinition->mShadowMapTexDefinitions.begin();
@@ -550,7 +686,12 @@ namespace Ogre
         {
             Light const *light = mShadowMapCastingLights[itor->light].light;
 
-            if( light )
+            //Throttled shadow maps keep the shadow camera they were last rendered with
+            itShadowCamera->throttled =
+                    light && !mShadowMapCastingLights[itor->light].isStatic &&
+                    isShadowMapUpdateThrottled( *itShadowCamera, light, camera );
+
+            if( light && !itShadowCamera->throttled )
             {
                 Camera *texCamera = itShadowCamera->camera;
 
@@ -604,6 +745,12 @@ namespace Ogre
                                                                     texCamera, itor->split,
                                                                     vpRealSize );
 
+                if( itShadowCamera->hasCache &&
+                    isShadowMapCacheStale( *itShadowCamera, light, vpRealSize ) )
+                {
+                    itShadowCamera->cacheDirty = true;
+                }
+
                 itShadowCamera->minDistance = itShadowCamera->shadowCameraSetup->getMinDistance();
                 itShadowCamera->maxDistance = itShadowCamera->shadowCameraSetup->getMaxDistance();
 
@@ -623,6 +770,10 @@ namespace Ogre
                 const RenderSystemCapabilities *caps = mRenderSystem->getCapabilities();
                 texCamera->_setNeedsDepthClamp( light->getType() == Light::LT_DIRECTIONAL &&
                                                 caps->hasCapability( RSC_DEPTH_CLAMP ) );
+
+                //Point light cameras get rotated for every face, they can't be culled in advance
+                if( light->getType() != Light::LT_POINT )
+                    mBatchedCullCameras.push_back( texCamera );
             }
             //Else... this shadow map shouldn't be rendered and when used, return a blank one.
             //The Nth closest lights don't cast shadows
@@ -631,6 +782,34 @@ namespace Ogre
             ++itor;
         }
 
+        //Shadow maps sharing the same cache (i.e. UV atlas) must be rendered together,
+        //as the cache passes may clear the whole texture.
+        itShadowCamera = mShadowMapCameras.begin();
+        while( itShadowCamera != mShadowMapCameras.end() )
+        {
+            if( itShadowCamera->hasCache && itShadowCamera->cacheDirty )
+            {
+                ShadowMapCameraVec::iterator itLinked = mShadowMapCameras.begin();
+                ShadowMapCameraVec::iterator enLinked = mShadowMapCameras.end();
+                while( itLinked != enLinked )
+                {
+                    if( itLinked->hasCache &&
+                        itLinked->cacheTextureName == itShadowCamera->cacheTextureName )
+                    {
+                        itLinked->cacheDirty = true;
+                    }
+                    ++itLinked;
+                }
+            }
+            ++itShadowCamera;
+        }
+
+        if( sceneManager->getBatchedShadowCulling() && !mBatchedCullCameras.empty() )
+        {
+            sceneManager->cullFrustumBatch( mBatchedCullCameras.begin(), mBatchedCullCameras.size(),
+                                            lodCamera, true );
+        }
+
         SceneManager::IlluminationRenderStage previous = sceneManager->_getCurrentRenderStage();
         sceneManager->_setCurrentRenderStage( SceneManager::IRS_RENDER_TO_TEXTURE );
 
@@ -639,6 +818,34 @@ namespace Ogre
 
         sceneManager->_setCurrentRenderStage( previous );
 
+        //Remember the state the shadow maps & caches were rendered with. Must be done before
+        //resetting isDirty, as _shouldUpdateShadowMapIdx depends on it.
+        itShadowCamera = mShadowMapCameras.begin();
+        itor = mDefinition->mShadowMapTexDefinitions.begin();
+        while( itor != end )
+        {
+            const uint32 shadowMapIdx =
+                    static_cast<uint32>( itor - mDefinition->mShadowMapTexDefinitions.begin() );
+            if( _shouldUpdateShadowMapIdx( shadowMapIdx ) )
+            {
+                itShadowCamera->lastRenderedLight   = mShadowMapCastingLights[itor->light].light;
+                itShadowCamera->lastRenderedCamera  = camera;
+                itShadowCamera->lastRenderedFrame   = mWorkspace->getFrameCount();
+
+                if( itShadowCamera->hasCache && itShadowCamera->cacheDirty )
+                {
+                    const Camera *texCamera = itShadowCamera->camera;
+                    itShadowCamera->cachedLight         = itShadowCamera->lastRenderedLight;
+                    itShadowCamera->cachedPosition      = texCamera->getPosition();
+                    itShadowCamera->cachedOrientation   = texCamera->getOrientation();
+                    itShadowCamera->cachedProjParams    = getShadowMapCacheProjParams( texCamera );
+                    itShadowCamera->cacheDirty = false;
+                }
+            }
+            ++itShadowCamera;
+            ++itor;
+        }
+
         {
             LightClosestArray::iterator it = mShadowMapCastingLights.begin();
             LightClosestArray::iterator en = mShadowMapCastingLights.end();
@@ -828,7 +1035,8 @@ namespace Ogre
 
             if( !mShadowMapCastingLights[shadowTexDef.light].light ||
                 (mShadowMapCastingLights[shadowTexDef.light].isStatic &&
-                !mShadowMapCastingLights[shadowTexDef.light].isDirty ) )
+                !mShadowMapCastingLights[shadowTexDef.light].isDirty ) ||
+                mShadowMapCameras[shadowMapIdx].throttled )
             {
                 retVal = false;
             }
@@ -837,6 +1045,11 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    bool CompositorShadowNode::_shouldUpdateShadowMapCache( uint32 shadowMapIdx ) const
+    {
+        return shadowMapIdx >= mShadowMapCameras.size() || mShadowMapCameras[shadowMapIdx].cacheDirty;
+    }
+    //-----------------------------------------------------------------------------------
     uint8 CompositorShadowNode::getShadowMapLightTypeMask( uint32 shadowMapIdx ) const
     {
         const ShadowTextureDefinition &shadowTexDef =
@@ -1046,10 +1259,42 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::setSortLightsByScreenCoverage( bool bSort )
+    {
+        mSortLightsByScreenCoverage = bSort;
+        //Force buildClosestLightList to run again
+        mLastCamera = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::setDistantLightsUpdateInterval( Real minDistance, uint32 numFrames )
+    {
+        mDistantLightsMinDistance = minDistance;
+        mDistantLightsUpdateInterval = std::max( numFrames, 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorShadowNode::setShadowMapCacheDirty( size_t shadowMapIdx )
+    {
+        assert( shadowMapIdx < mShadowMapCameras.size() );
+        assert( mShadowMapCameras[shadowMapIdx].hasCache &&
+                "Shadow Map has no cache! Did you forget to add passes with shadow_map_cache?" );
+
+        //Linked shadow maps get tagged as well during _update
+        mShadowMapCameras[shadowMapIdx].cacheDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorShadowNode::finalTargetResized01( const TextureGpu *finalTarget )
     {
         CompositorNode::finalTargetResized01( finalTarget );
 
+        //Textures may have been recreated, caches must be rendered again
+        ShadowMapCameraVec::iterator itCamera = mShadowMapCameras.begin();
+        ShadowMapCameraVec::iterator enCamera = mShadowMapCameras.end();
+        while( itCamera != enCamera )
+        {
+            itCamera->cacheDirty = true;
+            ++itCamera;
+        }
+
         mContiguousShadowMapTex.clear();
 
         CompositorShadowNodeDef::ShadowMapTexDefVec::const_iterator itDef =
@@ -145,15 +145,24 @@ namespace Ogre
 
                 pass->mIncludeOverlays = false;
 
+                if( pass->mShadowMapCache && pass->mShadowMapIdx >= mShadowMapTexDefinitions.size() )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                 "Pass in shadow node " + mNameStr + " is part of the cache of "
+                                 "shadow map " + StringConverter::toString( pass->mShadowMapIdx ) +
+                                 " but there is no such shadow map.",
+                                 "CompositorShadowNodeDef::_validateAndFinish" );
+                }
+
                 if( pass->mShadowMapIdx < mShadowMapTexDefinitions.size() )
                 {
                     const ShadowTextureDefinition &texDef = mShadowMapTexDefinitions[pass->mShadowMapIdx];
 
-                    if( itor->getRenderTargetName() == texDef.getTextureName() &&
-                        !pass->mShadowMapFullViewport )
+                    if( (itor->getRenderTargetName() == texDef.getTextureName() ||
+                         pass->mShadowMapCache) && !pass->mShadowMapFullViewport )
                     {
                         //Only force the viewport settings to the passes
-                        //that directly rendering into the atlas
+                        //that directly rendering into the atlas (or its cache)
                         pass->mVpRect[0].mVpLeft   = static_cast<float>( texDef.uvOffset.x );
                         pass->mVpRect[0].mVpTop    = static_cast<float>( texDef.uvOffset.y );
                         pass->mVpRect[0].mVpWidth  = static_cast<float>( texDef.uvLength.x );
@@ -170,6 +179,13 @@ namespace Ogre
                         //PSSM only supports directional lights. This is for sure.
                         itor->setShadowMapSupportedLightTypes( 1u << Light::LT_DIRECTIONAL );
                     }
+                    else if( itor->getShadowMapSupportedLightTypes() == 0 && pass->mShadowMapCache )
+                    {
+                        //Caches live in regular targets. Point lights render to a
+                        //cubemap first, thus they can't be cached this way.
+                        itor->setShadowMapSupportedLightTypes( (1u << Light::LT_DIRECTIONAL) |
+                                                               (1u << Light::LT_SPOTLIGHT) );
+                    }
                     else if( itor->getShadowMapSupportedLightTypes() == 0 )
                     {
                         OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
@@ -181,8 +197,12 @@ namespace Ogre
 
                     //Accumulate the types of lights this shadow map supports
                     //based on the passes that claim to be compatible with it.
-                    const size_t lightIdx = mShadowMapTexDefinitions[pass->mShadowMapIdx].light;
-                    mLightTypesMask[lightIdx] |= itor->getShadowMapSupportedLightTypes();
+                    //Cache passes don't define what the shadow map supports.
+                    if( !pass->mShadowMapCache )
+                    {
+                        const size_t lightIdx = mShadowMapTexDefinitions[pass->mShadowMapIdx].light;
+                        mLightTypesMask[lightIdx] |= itor->getShadowMapSupportedLightTypes();
+                    }
                 }
 
                 if( pass->getType() == PASS_SCENE )
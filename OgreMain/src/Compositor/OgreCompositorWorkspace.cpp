@@ -42,6 +42,16 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 
 #include "OgreProfiler.h"
+#include "OgreGpuProfiler.h"
+#include "OgreRenderSystem.h"
+#include "OgreRenderPassDescriptor.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreStringConverter.h"
+#include "OgreTextureGpu.h"
+#include "OgreRoot.h"
+#include "OgreTimer.h"
+#include "OgreGpuMemoryTracker.h"
+#include "Vao/OgreUavBufferPacked.h"
 
 namespace Ogre
 {
@@ -59,6 +69,12 @@ namespace Ogre
             mValid( false ),
             mEnabled( bEnabled ),
             mAmalgamatedProfiling( false ),
+            mCpuTiming( false ),
+            mLastUpdateCpuTime( 0 ),
+            mDynamicResolution( false ),
+            mDynamicResolutionScale( 1.0f ),
+            mDynamicResolutionMinScale( 0.5f ),
+            mTargetGpuFrameTime( 16.0f ),
             mDefaultCamera( defaultCam ),
             mSceneManager( sceneManager ),
             mRenderSys( renderSys ),
@@ -66,7 +82,8 @@ namespace Ogre
             mExecutionMask( executionMask ),
             mViewportModifierMask( viewportModifierMask ),
             mViewportModifier( vpOffsetScale ),
-            mBarriersDirty( true )
+            mBarriersDirty( true ),
+            mWaitForAsyncComputeAtEnd( false )
     {
         assert( (!defaultCam || (defaultCam->getSceneManager() == sceneManager)) &&
                 "Camera was created with a different SceneManager than supplied" );
@@ -88,6 +105,9 @@ namespace Ogre
         if( finalTarget )
             mRenderSys->_setCurrentDeviceFromTexture( finalTarget );
 
+        //Don't override the tag if we're being created by e.g. a cubemap probe
+        GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Compositor, false );
+
         //Create global textures
         TextureDefinitionBase::createTextures( definition->mLocalTextureDefs, mGlobalTextures,
                                                 id, finalTarget, mRenderSys );
@@ -336,6 +356,11 @@ namespace Ogre
             mNodeSequence.clear();
             mNodeSequence.insert( mNodeSequence.end(), processedList.begin(), processedList.end() );
 
+            if( mDefinition->mAliasTransientTextures )
+                aliasTransientTextures();
+
+            updateDynamicResolutionTextures();
+
             CompositorNodeVec::iterator itor = mNodeSequence.begin();
             CompositorNodeVec::iterator end  = mNodeSequence.end();
 
@@ -362,6 +387,120 @@ namespace Ogre
 #endif
     }
     //-----------------------------------------------------------------------------------
+    /// Returns true if textures created from both definitions are
+    /// (and will remain, even after resizing) identical
+    static bool areTextureDefinitionsAliasable( const TextureDefinitionBase::TextureDefinition &a,
+                                                const TextureDefinitionBase::TextureDefinition &b )
+    {
+        return a.textureType == b.textureType &&
+               a.width == b.width && a.height == b.height &&
+               a.depthOrSlices == b.depthOrSlices &&
+               a.numMipmaps == b.numMipmaps &&
+               (a.width != 0 || a.widthFactor == b.widthFactor) &&
+               (a.height != 0 || a.heightFactor == b.heightFactor) &&
+               a.format == b.format && a.fsaa == b.fsaa &&
+               a.textureFlags == b.textureFlags &&
+               a.depthBufferId == b.depthBufferId &&
+               a.preferDepthTexture == b.preferDepthTexture &&
+               a.depthBufferFormat == b.depthBufferFormat;
+    }
+    //-----------------------------------------------------------------------------------
+    struct TransientTextureSlot
+    {
+        TextureGpu                                      *texture;
+        const TextureDefinitionBase::TextureDefinition  *definition;
+        /// Index in mNodeSequence of the last node using the texture
+        size_t                                          lastUse;
+    };
+    typedef vector<TransientTextureSlot>::type TransientTextureSlotVec;
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::aliasTransientTextures(void)
+    {
+        //A local texture lives from its node until the last node that gets it as input.
+        typedef map<TextureGpu*, size_t>::type TextureLastUseMap;
+        TextureLastUseMap lastUses;
+
+        const size_t numNodes = mNodeSequence.size();
+        for( size_t i=0; i<numNodes; ++i )
+        {
+            const CompositorChannelVec &inputs = mNodeSequence[i]->getInputChannel();
+            CompositorChannelVec::const_iterator itor = inputs.begin();
+            CompositorChannelVec::const_iterator end  = inputs.end();
+            while( itor != end )
+            {
+                if( *itor )
+                    lastUses[*itor] = i;
+                ++itor;
+            }
+        }
+
+        //Greedy interval allocation. Nodes are in execution order, so intervals are
+        //sorted by their start. A slot can be reused once the node using it is done.
+        TransientTextureSlotVec slots;
+        size_t numAliased = 0;
+        size_t bytesSaved = 0;
+
+        for( size_t i=0; i<numNodes; ++i )
+        {
+            CompositorNode *node = mNodeSequence[i];
+            const TextureDefinitionBase::TextureDefinitionVec &textureDefs =
+                    node->getDefinition()->getLocalTextureDefinitions();
+            //Copy, _aliasLocalTexture modifies it
+            const CompositorChannelVec localTextures = node->getLocalTextures();
+
+            for( size_t j=0; j<textureDefs.size(); ++j )
+            {
+                const TextureDefinitionBase::TextureDefinition &textureDef = textureDefs[j];
+                if( textureDef.preserveContent )
+                    continue;
+
+                TextureGpu *texture = localTextures[j];
+
+                size_t lastUse = i;
+                TextureLastUseMap::const_iterator itLastUse = lastUses.find( texture );
+                if( itLastUse != lastUses.end() )
+                    lastUse = std::max( lastUse, itLastUse->second );
+
+                TransientTextureSlotVec::iterator itSlot = slots.begin();
+                TransientTextureSlotVec::iterator enSlot = slots.end();
+                while( itSlot != enSlot &&
+                       (itSlot->lastUse >= i ||
+                        !areTextureDefinitionsAliasable( *itSlot->definition, textureDef )) )
+                {
+                    ++itSlot;
+                }
+
+                if( itSlot != enSlot )
+                {
+                    bytesSaved += texture->getSizeBytes();
+                    ++numAliased;
+
+                    for( size_t k=i + 1u; k<numNodes; ++k )
+                        mNodeSequence[k]->_replaceInputTexture( texture, itSlot->texture );
+                    node->_aliasLocalTexture( j, itSlot->texture );
+
+                    itSlot->lastUse = lastUse;
+                }
+                else
+                {
+                    TransientTextureSlot slot;
+                    slot.texture    = texture;
+                    slot.definition = &textureDef;
+                    slot.lastUse    = lastUse;
+                    slots.push_back( slot );
+                }
+            }
+        }
+
+        if( numAliased )
+        {
+            LogManager::getSingleton().logMessage(
+                        "Workspace '" + mDefinition->mNameStr + "': " +
+                        StringConverter::toString( numAliased ) + " transient textures aliased, " +
+                        StringConverter::toString( bytesSaved / (1024u * 1024u) ) + " MB saved" );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorWorkspace::clearAllConnections(void)
     {
         {
@@ -481,6 +620,102 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    static void addTargetRelativeTextures(
+            const TextureDefinitionBase::TextureDefinitionVec &textureDefs,
+            const CompositorChannelVec &textures, vector<TextureGpu*>::type &outTextures )
+    {
+        const size_t numTextures = std::min( textureDefs.size(), textures.size() );
+        for( size_t i=0; i<numTextures; ++i )
+        {
+            if( textureDefs[i].width == 0 && textureDefs[i].height == 0 )
+                outTextures.push_back( textures[i] );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::updateDynamicResolutionTextures(void)
+    {
+        mDynamicResolutionTextures.clear();
+
+        addTargetRelativeTextures( mDefinition->getLocalTextureDefinitions(), mGlobalTextures,
+                                   mDynamicResolutionTextures );
+
+        CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
+        CompositorNodeVec::const_iterator end  = mNodeSequence.end();
+
+        while( itor != end )
+        {
+            addTargetRelativeTextures( (*itor)->getDefinition()->getLocalTextureDefinitions(),
+                                       (*itor)->getLocalTextures(), mDynamicResolutionTextures );
+            ++itor;
+        }
+
+        //Aliased textures may appear more than once
+        std::sort( mDynamicResolutionTextures.begin(), mDynamicResolutionTextures.end() );
+        mDynamicResolutionTextures.erase( std::unique( mDynamicResolutionTextures.begin(),
+                                                       mDynamicResolutionTextures.end() ),
+                                          mDynamicResolutionTextures.end() );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::updateDynamicResolutionScale(void)
+    {
+        GpuProfiler *gpuProfiler = mRenderSys->getGpuProfiler();
+        const Real frameTime = gpuProfiler->getFrameTime();
+
+        if( frameTime <= 0 )
+            return;
+
+        //Leave some headroom, and don't react to small variations to avoid oscillating
+        if( frameTime > mTargetGpuFrameTime * 0.95f || frameTime < mTargetGpuFrameTime * 0.8f )
+        {
+            //Cost is roughly proportional to the number of pixels (i.e. scale squared).
+            //Results arrive a few frames late, so only move part of the way each frame.
+            const Real desiredScale = mDynamicResolutionScale *
+                                      Math::Sqrt( mTargetGpuFrameTime * 0.9f / frameTime );
+            const Real newScale = Math::lerp( mDynamicResolutionScale, desiredScale, Real( 0.1f ) );
+            mDynamicResolutionScale = Math::Clamp( newScale, mDynamicResolutionMinScale, Real( 1.0f ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::setDynamicResolution( bool bEnabled, Real targetGpuFrameTimeMs,
+                                                    Real minScale )
+    {
+        assert( minScale > 0 && minScale <= 1.0f );
+        assert( targetGpuFrameTimeMs > 0 );
+
+        mDynamicResolution          = bEnabled;
+        mTargetGpuFrameTime         = targetGpuFrameTimeMs;
+        mDynamicResolutionMinScale  = minScale;
+
+        if( !bEnabled )
+            mDynamicResolutionScale = 1.0f;
+        else
+        {
+            mDynamicResolutionScale = Math::Clamp( mDynamicResolutionScale, minScale, Real( 1.0f ) );
+
+            GpuProfiler *gpuProfiler = mRenderSys->getGpuProfiler();
+            if( !gpuProfiler->getEnabled() )
+                gpuProfiler->setEnabled( true );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::setDynamicResolutionScale( Real scale )
+    {
+        mDynamicResolutionScale = Math::Clamp( scale, mDynamicResolutionMinScale, Real( 1.0f ) );
+    }
+    //-----------------------------------------------------------------------------------
+    Real CompositorWorkspace::_getDynamicResolutionScale( const TextureGpu *texture ) const
+    {
+        if( !mDynamicResolution || !texture ||
+            !std::binary_search( mDynamicResolutionTextures.begin(),
+                                 mDynamicResolutionTextures.end(),
+                                 const_cast<TextureGpu*>( texture ) ) )
+        {
+            return 1.0f;
+        }
+
+        return mDynamicResolutionScale;
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorWorkspace::analyzeHazardsAndPlaceBarriers(void)
     {
         mResourcesLayout    = mInitialResourcesLayout;
@@ -492,6 +727,8 @@ namespace Ogre
         BoundUav boundUavs[64];
         memset( boundUavs, 0, sizeof(boundUavs) );
 
+        mPendingAsyncResources.clear();
+
         //Initialize to undefined state
         CompositorNode::initResourcesLayout( mResourcesLayout, mExternalRenderTargets,
                                              ResourceLayout::Undefined );
@@ -545,9 +782,54 @@ namespace Ogre
             }
         }
 
+        //Async work still running at the end must be done before the next frame touches it
+        mWaitForAsyncComputeAtEnd = !mPendingAsyncResources.empty();
+        mPendingAsyncResources.clear();
+
         mBarriersDirty = false;
     }
     //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::_trackAsyncCompute( CompositorPass *pass, const BoundUav boundUavs[64] )
+    {
+        const RenderSystemCapabilities *caps = mRenderSys->getCapabilities();
+        if( !caps->hasCapability( RSC_ASYNC_COMPUTE ) )
+            return;
+
+        const bool asyncCompute = pass->getDefinition()->mAsyncCompute &&
+                                  pass->_canRunAsyncCompute();
+
+        GpuTrackedResourceVec accessedResources;
+        pass->_getAccessedResources( boundUavs, accessedResources );
+
+        bool waitForAsyncCompute = false;
+
+        if( asyncCompute )
+        {
+            //Async passes run in order among themselves; they don't need to wait for each other
+            mPendingAsyncResources.insert( mPendingAsyncResources.end(),
+                                           accessedResources.begin(), accessedResources.end() );
+        }
+        else
+        {
+            GpuTrackedResourceVec::const_iterator itor = accessedResources.begin();
+            GpuTrackedResourceVec::const_iterator end  = accessedResources.end();
+
+            while( itor != end && !waitForAsyncCompute )
+            {
+                waitForAsyncCompute = std::find( mPendingAsyncResources.begin(),
+                                                 mPendingAsyncResources.end(),
+                                                 *itor ) != mPendingAsyncResources.end();
+                ++itor;
+            }
+
+            //Waiting covers all async work issued so far
+            if( waitForAsyncCompute )
+                mPendingAsyncResources.clear();
+        }
+
+        pass->_setAsyncCompute( asyncCompute, waitForAsyncCompute );
+    }
+    //-----------------------------------------------------------------------------------
     CompositorNode* CompositorWorkspace::getLastEnabledNode(void)
     {
         CompositorNode *retVal = 0;
@@ -684,6 +966,42 @@ namespace Ogre
         return finalTarget;
     }
     //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::resetPassesCpuTime(void)
+    {
+        CompositorNodeVec allNodes;
+        allNodes.reserve( mNodeSequence.size() + mShadowNodes.size() );
+        allNodes.insert( allNodes.end(), mNodeSequence.begin(), mNodeSequence.end() );
+        allNodes.insert( allNodes.end(), mShadowNodes.begin(), mShadowNodes.end() );
+
+        CompositorNodeVec::const_iterator itor = allNodes.begin();
+        CompositorNodeVec::const_iterator end  = allNodes.end();
+
+        while( itor != end )
+        {
+            const CompositorPassVec &passes = (*itor)->_getPasses();
+            CompositorPassVec::const_iterator itPass = passes.begin();
+            CompositorPassVec::const_iterator enPass = passes.end();
+
+            while( itPass != enPass )
+            {
+                (*itPass)->_setLastCpuTime( 0 );
+                ++itPass;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::setCpuTiming( bool bEnabled )
+    {
+        mCpuTiming = bEnabled;
+        if( !bEnabled )
+        {
+            mLastUpdateCpuTime = 0;
+            resetPassesCpuTime();
+        }
+    }
+    //-----------------------------------------------------------------------------------
     CompositorManager2* CompositorWorkspace::getCompositorManager()
     {
         return mDefinition->mCompositorManager;
@@ -733,6 +1051,15 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorWorkspace::_update(void)
     {
+        Timer *timer = 0;
+        uint64 startTime = 0;
+        if( mCpuTiming )
+        {
+            timer = Root::getSingleton().getTimer();
+            startTime = timer->getMicroseconds();
+            resetPassesCpuTime();
+        }
+
         if( mBarriersDirty )
         {
             CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
@@ -823,6 +1150,15 @@ namespace Ogre
                                                              mRenderSys, allNodes, 0 );
         }
 
+        if( mDynamicResolution )
+            updateDynamicResolutionScale();
+
+        //When amalgamated, passes don't profile themselves; measure the whole workspace instead.
+        GpuProfiler *gpuProfiler = mRenderSys->getGpuProfiler();
+        const bool bGpuProfile = mAmalgamatedProfiling && gpuProfiler->getEnabled();
+        if( bGpuProfile )
+            gpuProfiler->beginSample( mDefinition->getNameStr() );
+
         CompositorNodeVec::const_iterator itor = mNodeSequence.begin();
         CompositorNodeVec::const_iterator end  = mNodeSequence.end();
 
@@ -848,6 +1184,12 @@ namespace Ogre
             ++itor;
         }
 
+        if( mWaitForAsyncComputeAtEnd )
+            mRenderSys->_waitForAsyncCompute();
+
+        if( bGpuProfile )
+            gpuProfiler->endSample();
+
         {
             CompositorWorkspaceListenerVec::const_iterator itor = mListeners.begin();
             CompositorWorkspaceListenerVec::const_iterator end  = mListeners.end();
@@ -858,6 +1200,9 @@ namespace Ogre
                 ++itor;
             }
         }
+
+        if( mCpuTiming )
+            mLastUpdateCpuTime = timer->getMicroseconds() - startTime;
     }
     //-----------------------------------------------------------------------------------
     void CompositorWorkspace::_swapFinalTarget( vector<TextureGpu*>::type &swappedTargets )
@@ -925,4 +1270,380 @@ namespace Ogre
 
         return retVal;
     }
+    //-----------------------------------------------------------------------------------
+    static const char *c_loadActionNames[] =
+    {
+        "DontCare",
+        "Clear",
+        "ClearOnTilers",
+        "Load"
+    };
+    static const char *c_storeActionNames[] =
+    {
+        "DontCare",
+        "Store",
+        "MultisampleResolve",
+        "StoreAndMultisampleResolve",
+        "StoreOrResolve"
+    };
+    typedef map<String, Real>::type GpuTimeMap;
+    //-----------------------------------------------------------------------------------
+    static void appendJsonString( String &outJson, const String &value )
+    {
+        outJson += '"';
+        String::const_iterator itor = value.begin();
+        String::const_iterator end  = value.end();
+        while( itor != end )
+        {
+            const char c = *itor;
+            if( c == '"' || c == '\\' )
+            {
+                outJson += '\\';
+                outJson += c;
+            }
+            else if( static_cast<unsigned char>( c ) < 0x20u )
+            {
+                outJson += ' ';
+            }
+            else
+            {
+                outJson += c;
+            }
+            ++itor;
+        }
+        outJson += '"';
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendJsonTexture( String &outJson, const TextureGpu *texture )
+    {
+        outJson += "{ \"name\" : ";
+        appendJsonString( outJson, texture->getNameStr() );
+        outJson += ", \"width\" : " + StringConverter::toString( texture->getWidth() );
+        outJson += ", \"height\" : " + StringConverter::toString( texture->getHeight() );
+        outJson += ", \"depth_or_slices\" : " +
+                   StringConverter::toString( texture->getDepthOrSlices() );
+        outJson += ", \"mipmaps\" : " +
+                   StringConverter::toString( static_cast<uint32>( texture->getNumMipmaps() ) );
+        outJson += ", \"format\" : ";
+        appendJsonString( outJson, PixelFormatGpuUtils::toString( texture->getPixelFormat() ) );
+        outJson += ", \"msaa\" : " + StringConverter::toString(
+                       static_cast<uint32>( texture->getSampleDescription().getColourSamples() ) );
+        outJson += ", \"bytes\" : " + StringConverter::toString( texture->getSizeBytes() );
+        outJson += " }";
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendJsonBuffers( String &outJson, const CompositorNamedBufferVec &buffers )
+    {
+        outJson += "[";
+        CompositorNamedBufferVec::const_iterator itor = buffers.begin();
+        CompositorNamedBufferVec::const_iterator end  = buffers.end();
+        while( itor != end )
+        {
+            if( itor != buffers.begin() )
+                outJson += ",";
+            outJson += "\n\t\t\t\t{ \"name\" : ";
+            appendJsonString( outJson, itor->name.getFriendlyText() );
+            outJson += ", \"bytes\" : " + StringConverter::toString(
+                           itor->buffer->getNumElements() * itor->buffer->getBytesPerElement() );
+            outJson += " }";
+            ++itor;
+        }
+        outJson += " ]";
+    }
+    //-----------------------------------------------------------------------------------
+    /// Writes the name of the texture, or of the buffer if it can be found
+    static void appendJsonResourceName( String &outJson, const GpuTrackedResource *resource,
+                                        const CompositorNode *node,
+                                        const CompositorNamedBufferVec &globalBuffers )
+    {
+        if( !resource )
+        {
+            outJson += "null";
+        }
+        else if( resource->isTextureGpu() )
+        {
+            appendJsonString( outJson,
+                              static_cast<const TextureGpu*>( resource )->getNameStr() );
+        }
+        else
+        {
+            const CompositorNamedBufferVec &nodeBuffers = node->getBuffers();
+            const CompositorNamedBuffer *namedBuffer = 0;
+            for( size_t i=0; i<nodeBuffers.size() && !namedBuffer; ++i )
+            {
+                if( nodeBuffers[i].buffer == resource )
+                    namedBuffer = &nodeBuffers[i];
+            }
+            for( size_t i=0; i<globalBuffers.size() && !namedBuffer; ++i )
+            {
+                if( globalBuffers[i].buffer == resource )
+                    namedBuffer = &globalBuffers[i];
+            }
+
+            if( namedBuffer )
+                appendJsonString( outJson, namedBuffer->name.getFriendlyText() );
+            else
+                outJson += "\"[unnamed buffer]\"";
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendJsonRenderTarget( String &outJson, const RenderPassTargetBase &target )
+    {
+        outJson += "{ \"texture\" : ";
+        appendJsonString( outJson, target.texture->getNameStr() );
+        outJson += ", \"mip\" : " + StringConverter::toString(
+                                        static_cast<uint32>( target.mipLevel ) );
+        outJson += ", \"slice\" : " + StringConverter::toString(
+                                          static_cast<uint32>( target.slice ) );
+        outJson += ", \"load\" : \"";
+        outJson += c_loadActionNames[target.loadAction];
+        outJson += "\", \"store\" : \"";
+        outJson += c_storeActionNames[target.storeAction];
+        outJson += "\"";
+        if( target.resolveTexture )
+        {
+            outJson += ", \"resolve\" : ";
+            appendJsonString( outJson, target.resolveTexture->getNameStr() );
+        }
+        outJson += " }";
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendJsonPass( String &outJson, const CompositorPass *pass,
+                                const CompositorNode *node,
+                                const CompositorNamedBufferVec &globalBuffers,
+                                const GpuTimeMap &gpuTimes )
+    {
+        const CompositorPassDef *passDef = pass->getDefinition();
+
+        outJson += "\n\t\t\t\t{";
+        outJson += "\n\t\t\t\t\t\"type\" : \"";
+        outJson += CompositorPassTypeEnumNames[passDef->getType()];
+        outJson += "\",\n\t\t\t\t\t\"profiling_id\" : ";
+        appendJsonString( outJson, passDef->mProfilingId );
+        outJson += ",\n\t\t\t\t\t\"identifier\" : " +
+                   StringConverter::toString( passDef->mIdentifier );
+        outJson += ",\n\t\t\t\t\t\"execution_mask\" : " +
+                   StringConverter::toString( static_cast<uint32>( passDef->mExecutionMask ) );
+        outJson += ",\n\t\t\t\t\t\"async_compute\" : ";
+        outJson += pass->isAsyncCompute() ? "true" : "false";
+        outJson += ",\n\t\t\t\t\t\"wait_for_async_compute\" : ";
+        outJson += pass->getWaitForAsyncCompute() ? "true" : "false";
+
+        const RenderPassDescriptor *renderPassDesc = pass->getRenderPassDesc();
+        outJson += ",\n\t\t\t\t\t\"colour\" : [";
+        if( renderPassDesc )
+        {
+            const size_t numColourEntries = renderPassDesc->getNumColourEntries();
+            for( size_t i=0; i<numColourEntries; ++i )
+            {
+                outJson += i == 0u ? " " : ", ";
+                appendJsonRenderTarget( outJson, renderPassDesc->mColour[i] );
+            }
+        }
+        outJson += " ]";
+        outJson += ",\n\t\t\t\t\t\"depth\" : ";
+        if( renderPassDesc && renderPassDesc->mDepth.texture )
+            appendJsonRenderTarget( outJson, renderPassDesc->mDepth );
+        else
+            outJson += "null";
+        outJson += ",\n\t\t\t\t\t\"stencil\" : ";
+        if( renderPassDesc && renderPassDesc->mStencil.texture )
+            appendJsonRenderTarget( outJson, renderPassDesc->mStencil );
+        else
+            outJson += "null";
+
+        outJson += ",\n\t\t\t\t\t\"reads\" : [";
+        const CompositorTextureVec &textureDeps = pass->getTextureDependencies();
+        CompositorTextureVec::const_iterator itDep = textureDeps.begin();
+        CompositorTextureVec::const_iterator enDep = textureDeps.end();
+        while( itDep != enDep )
+        {
+            outJson += itDep == textureDeps.begin() ? " " : ", ";
+            appendJsonString( outJson, itDep->texture ? itDep->texture->getNameStr() :
+                                                        itDep->name.getFriendlyText() );
+            ++itDep;
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\t\t\t\t\"writes\" : [";
+        const GpuTrackedResourceVec &writtenResources = pass->getWrittenResources();
+        GpuTrackedResourceVec::const_iterator itWrite = writtenResources.begin();
+        GpuTrackedResourceVec::const_iterator enWrite = writtenResources.end();
+        while( itWrite != enWrite )
+        {
+            outJson += itWrite == writtenResources.begin() ? " " : ", ";
+            appendJsonResourceName( outJson, *itWrite, node, globalBuffers );
+            ++itWrite;
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\t\t\t\t\"num_valid_barriers\" : " +
+                   StringConverter::toString( pass->getNumValidResourceTransitions() );
+        outJson += ",\n\t\t\t\t\t\"barriers\" : [";
+        const CompositorPass::ResourceTransitionVec &transitions =
+                pass->getResourceTransitions();
+        CompositorPass::ResourceTransitionVec::const_iterator itTrans = transitions.begin();
+        CompositorPass::ResourceTransitionVec::const_iterator enTrans = transitions.end();
+        while( itTrans != enTrans )
+        {
+            if( itTrans != transitions.begin() )
+                outJson += ",";
+            outJson += "\n\t\t\t\t\t\t{ \"resource\" : ";
+            appendJsonResourceName( outJson, itTrans->resource, node, globalBuffers );
+            outJson += ", \"old_layout\" : \"";
+            outJson += ResourceLayout::toString( itTrans->oldLayout );
+            outJson += "\", \"new_layout\" : \"";
+            outJson += ResourceLayout::toString( itTrans->newLayout );
+            outJson += "\", \"write_barrier_bits\" : " +
+                       StringConverter::toString( itTrans->writeBarrierBits );
+            outJson += ", \"read_barrier_bits\" : " +
+                       StringConverter::toString( itTrans->readBarrierBits );
+            outJson += " }";
+            ++itTrans;
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\t\t\t\t\"cpu_time_us\" : " +
+                   StringConverter::toString( static_cast<size_t>( pass->getLastCpuTime() ) );
+        outJson += ",\n\t\t\t\t\t\"gpu_time_ms\" : ";
+        GpuTimeMap::const_iterator itGpu = gpuTimes.find( passDef->mProfilingId );
+        if( itGpu != gpuTimes.end() )
+            outJson += StringConverter::toString( itGpu->second );
+        else
+            outJson += "null";
+
+        outJson += "\n\t\t\t\t}";
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendJsonNode( String &outJson, const CompositorNode *node,
+                                const CompositorNamedBufferVec &globalBuffers,
+                                const GpuTimeMap &gpuTimes )
+    {
+        outJson += "\n\t\t{";
+        outJson += "\n\t\t\t\"name\" : ";
+        appendJsonString( outJson, node->getName().getFriendlyText() );
+        outJson += ",\n\t\t\t\"definition\" : ";
+        appendJsonString( outJson, node->getDefinition()->getNameStr() );
+        outJson += ",\n\t\t\t\"enabled\" : ";
+        outJson += node->getEnabled() ? "true" : "false";
+
+        outJson += ",\n\t\t\t\"inputs\" : [";
+        const CompositorChannelVec &inputs = node->getInputChannel();
+        for( size_t i=0; i<inputs.size(); ++i )
+        {
+            outJson += i == 0u ? " " : ", ";
+            if( inputs[i] )
+                appendJsonString( outJson, inputs[i]->getNameStr() );
+            else
+                outJson += "null";
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\t\t\"local_textures\" : [";
+        const CompositorChannelVec &localTextures = node->getLocalTextures();
+        for( size_t i=0; i<localTextures.size(); ++i )
+        {
+            if( i != 0u )
+                outJson += ",";
+            outJson += "\n\t\t\t\t";
+            appendJsonTexture( outJson, localTextures[i] );
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\t\t\"buffers\" : ";
+        appendJsonBuffers( outJson, node->getBuffers() );
+
+        outJson += ",\n\t\t\t\"passes\" : [";
+        const CompositorPassVec &passes = node->_getPasses();
+        CompositorPassVec::const_iterator itor = passes.begin();
+        CompositorPassVec::const_iterator end  = passes.end();
+        while( itor != end )
+        {
+            if( itor != passes.begin() )
+                outJson += ",";
+            appendJsonPass( outJson, *itor, node, globalBuffers, gpuTimes );
+            ++itor;
+        }
+        outJson += "\n\t\t\t]";
+        outJson += "\n\t\t}";
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorWorkspace::dumpFrameGraph( String &outJson ) const
+    {
+        //Sum the samples with the same name. A pass can execute several times per
+        //frame (e.g. a shadow node used by more than one scene pass).
+        GpuTimeMap gpuTimes;
+        GpuProfiler *gpuProfiler = mRenderSys->getGpuProfiler();
+        if( gpuProfiler->getEnabled() )
+        {
+            const GpuProfiler::ResultVec &results = gpuProfiler->getResults();
+            GpuProfiler::ResultVec::const_iterator itor = results.begin();
+            GpuProfiler::ResultVec::const_iterator end  = results.end();
+            while( itor != end )
+            {
+                gpuTimes[itor->name] += itor->durationMs;
+                ++itor;
+            }
+        }
+
+        outJson += "{";
+        outJson += "\n\t\"workspace\" : ";
+        appendJsonString( outJson, mDefinition->getNameStr() );
+        outJson += ",\n\t\"frame\" : " + StringConverter::toString( getFrameCount() );
+        outJson += ",\n\t\"valid\" : ";
+        outJson += mValid ? "true" : "false";
+        outJson += ",\n\t\"enabled\" : ";
+        outJson += mEnabled ? "true" : "false";
+        outJson += ",\n\t\"dynamic_resolution_scale\" : " +
+                   StringConverter::toString( mDynamicResolution ? mDynamicResolutionScale : 1.0f );
+        outJson += ",\n\t\"cpu_time_us\" : " + StringConverter::toString(
+                                                       static_cast<size_t>( mLastUpdateCpuTime ) );
+        outJson += ",\n\t\"gpu_frame_time_ms\" : ";
+        if( gpuProfiler->getEnabled() )
+            outJson += StringConverter::toString( gpuProfiler->getFrameTime() );
+        else
+            outJson += "null";
+
+        outJson += ",\n\t\"external_targets\" : [";
+        for( size_t i=0; i<mExternalRenderTargets.size(); ++i )
+        {
+            if( i != 0u )
+                outJson += ",";
+            outJson += "\n\t\t";
+            appendJsonTexture( outJson, mExternalRenderTargets[i] );
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\"global_textures\" : [";
+        for( size_t i=0; i<mGlobalTextures.size(); ++i )
+        {
+            if( i != 0u )
+                outJson += ",";
+            outJson += "\n\t\t";
+            appendJsonTexture( outJson, mGlobalTextures[i] );
+        }
+        outJson += " ]";
+
+        outJson += ",\n\t\"global_buffers\" : ";
+        appendJsonBuffers( outJson, mGlobalBuffers );
+
+        outJson += ",\n\t\"nodes\" : [";
+        for( size_t i=0; i<mNodeSequence.size(); ++i )
+        {
+            if( i != 0u )
+                outJson += ",";
+            appendJsonNode( outJson, mNodeSequence[i], mGlobalBuffers, gpuTimes );
+        }
+        outJson += "\n\t]";
+
+        outJson += ",\n\t\"shadow_nodes\" : [";
+        for( size_t i=0; i<mShadowNodes.size(); ++i )
+        {
+            if( i != 0u )
+                outJson += ",";
+            appendJsonNode( outJson, mShadowNodes[i], mGlobalBuffers, gpuTimes );
+        }
+        outJson += "\n\t]";
+        outJson += "\n}\n";
+    }
 }
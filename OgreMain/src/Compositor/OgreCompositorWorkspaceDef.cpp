@@ -41,7 +41,8 @@ namespace Ogre
             TextureDefinitionBase( TEXTURE_GLOBAL ),
             mName( name ),
             mNameStr( name ),
-            mCompositorManager( compositorManager )
+            mCompositorManager( compositorManager ),
+            mAliasTransientTextures( false )
     {
     }
     //-----------------------------------------------------------------------------------
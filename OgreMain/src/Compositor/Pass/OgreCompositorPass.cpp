@@ -37,9 +37,13 @@ THE SOFTWARE.
 
 #include "OgrePixelFormatGpuUtils.h"
 #include "OgreViewport.h"
+#include "Vao/OgreUavBufferPacked.h"
 
 #include "OgreRenderSystem.h"
 #include "OgreProfiler.h"
+#include "OgreGpuProfiler.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorFrameCapture.h"
 
 #include "OgreStringConverter.h"
 
@@ -74,7 +78,13 @@ namespace Ogre
             mAnyMipLevel( 0u ),
             mNumPassesLeft( definition->mNumInitialPasses ),
             mParentNode( parentNode ),
-            mNumValidResourceTransitions( 0 )
+            mNumValidResourceTransitions( 0 ),
+            mAsyncCompute( false ),
+            mWaitForAsyncCompute( false ),
+            mWritesToRenderWindow( false ),
+            mResultCacheValid( false ),
+            mCachedDynResScale( 1.0f ),
+            mLastCpuTime( 0 )
     {
         assert( definition->mNumInitialPasses && "Definition is broken, pass will never execute!" );
     }
@@ -144,13 +154,20 @@ namespace Ogre
         const Real scWidth = mDefinition->mVpRect[vpIdx].mVpScissorWidth * vpModifier.z;
         const Real scHeight = mDefinition->mVpRect[vpIdx].mVpScissorHeight * vpModifier.w;
 
-        vpSize = Vector4( left, top, width, height );
-        scissors = Vector4( scLeft, scTop, scWidth, scHeight );
+        const Real dynResScale = workspace->_getDynamicResolutionScale( mAnyTargetTexture );
+
+        vpSize = Vector4( left, top, width, height ) * dynResScale;
+        scissors = Vector4( scLeft, scTop, scWidth, scHeight ) * dynResScale;
 
         outVp->setDimensions( mAnyTargetTexture, vpSize, scissors, mAnyMipLevel );
     }
     //-----------------------------------------------------------------------------------
     void CompositorPass::setRenderPassDescToCurrent(void)
+    {
+        setRenderPassDescToCurrent( mRenderPassDesc );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPass::setRenderPassDescToCurrent( RenderPassDescriptor *renderPassDesc )
     {
         CompositorWorkspace *workspace = mParentNode->getWorkspace();
         uint8 workspaceVpMask = workspace->getViewportModifierMask();
@@ -158,6 +175,9 @@ namespace Ogre
         bool applyModifier = (workspaceVpMask & mDefinition->mViewportModifierMask) != 0;
         Vector4 vpModifier = applyModifier ? workspace->getViewportModifier() : Vector4( 0, 0, 1, 1 );
 
+        //Dynamic resolution renders into the top-left corner
+        const Real dynResScale = workspace->_getDynamicResolutionScale( mAnyTargetTexture );
+
         const uint32 numViewports = mDefinition->mNumViewports;
         Vector4 vpSize[16];
         Vector4 scissors[16];
@@ -174,15 +194,22 @@ namespace Ogre
             Real scWidth  = mDefinition->mVpRect[i].mVpScissorWidth    * vpModifier.z;
             Real scHeight = mDefinition->mVpRect[i].mVpScissorHeight   * vpModifier.w;
 
-            vpSize[i] = Vector4( left, top, width, height );
-            scissors[i] = Vector4( scLeft, scTop, scWidth, scHeight );
+            vpSize[i] = Vector4( left, top, width, height ) * dynResScale;
+            scissors[i] = Vector4( scLeft, scTop, scWidth, scHeight ) * dynResScale;
         }
 
         RenderSystem *renderSystem = mParentNode->getRenderSystem();
-        renderSystem->beginRenderPassDescriptor( mRenderPassDesc, mAnyTargetTexture, mAnyMipLevel,
+        renderSystem->beginRenderPassDescriptor( renderPassDesc, mAnyTargetTexture, mAnyMipLevel,
                                                  vpSize, scissors, numViewports,
                                                  mDefinition->mIncludeOverlays,
                                                  mDefinition->mWarnIfRtvWasFlushed );
+
+        CompositorFrameCapture *frameCapture = workspace->getCompositorManager()->getFrameCapture();
+        if( frameCapture->isCapturing() )
+        {
+            frameCapture->_notifyPassBegin( this, renderPassDesc, mAnyTargetTexture, mAnyMipLevel,
+                                            vpSize, scissors, numViewports );
+        }
     }
     //-----------------------------------------------------------------------------------
     CompositorPass::~CompositorPass()
@@ -458,6 +485,12 @@ namespace Ogre
             OgreProfileGpuBeginDynamic( mDefinition->mProfilingId );
         }
 #endif
+        if( !mParentNode->getWorkspace()->getAmalgamatedProfiling() )
+        {
+            GpuProfiler *gpuProfiler = mParentNode->getRenderSystem()->getGpuProfiler();
+            if( gpuProfiler->getEnabled() )
+                gpuProfiler->beginSample( mDefinition->mProfilingId );
+        }
     }
     //-----------------------------------------------------------------------------------
     void CompositorPass::profilingEnd(void)
@@ -474,6 +507,12 @@ namespace Ogre
             OgreProfileGpuEnd( mDefinition->mProfilingId );
         }
 #endif
+        if( !mParentNode->getWorkspace()->getAmalgamatedProfiling() )
+        {
+            GpuProfiler *gpuProfiler = mParentNode->getRenderSystem()->getGpuProfiler();
+            if( gpuProfiler->getEnabled() )
+                gpuProfiler->endSample();
+        }
     }
     //-----------------------------------------------------------------------------------
     void CompositorPass::populateTextureDependenciesFromExposedTextures(void)
@@ -569,7 +608,7 @@ namespace Ogre
                                                 uint32 readBarrierBits )
     {
         ResourceTransition transition;
-        //transition.resource = ; TODO
+        transition.resource = currentLayout->first;
         transition.oldLayout = currentLayout->second;
         transition.newLayout = newLayout;
         transition.writeBarrierBits = transitionWriteBarrierBits( transition.oldLayout );
@@ -585,6 +624,7 @@ namespace Ogre
             if( mResourceTransitions.empty() )
             {
                 ResourceTransition globalBarrier;
+                globalBarrier.resource  = 0;
                 globalBarrier.oldLayout = ResourceLayout::Undefined;
                 globalBarrier.newLayout = ResourceLayout::Undefined;
                 globalBarrier.writeBarrierBits  = transition.writeBarrierBits;
@@ -788,6 +828,175 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorPass::_getAccessedResources( const BoundUav boundUavs[64],
+                                                GpuTrackedResourceVec &outResources ) const
+    {
+        if( mRenderPassDesc )
+        {
+            for( int i=0; i<mRenderPassDesc->getNumColourEntries(); ++i )
+            {
+                outResources.push_back( mRenderPassDesc->mColour[i].texture );
+                if( mRenderPassDesc->mColour[i].resolveTexture )
+                    outResources.push_back( mRenderPassDesc->mColour[i].resolveTexture );
+            }
+            if( mRenderPassDesc->mDepth.texture )
+                outResources.push_back( mRenderPassDesc->mDepth.texture );
+            if( mRenderPassDesc->mStencil.texture )
+                outResources.push_back( mRenderPassDesc->mStencil.texture );
+        }
+
+        CompositorTextureVec::const_iterator itDep = mTextureDependencies.begin();
+        CompositorTextureVec::const_iterator enDep = mTextureDependencies.end();
+
+        while( itDep != enDep )
+        {
+            outResources.push_back( itDep->texture );
+            ++itDep;
+        }
+
+        CompositorPassDef::UavDependencyVec::const_iterator itor = mDefinition->mUavDependencies.begin();
+        CompositorPassDef::UavDependencyVec::const_iterator end  = mDefinition->mUavDependencies.end();
+
+        while( itor != end )
+        {
+            if( boundUavs[itor->uavSlot].rttOrBuffer )
+                outResources.push_back( boundUavs[itor->uavSlot].rttOrBuffer );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPass::_getWrittenResources( const BoundUav boundUavs[64],
+                                               GpuTrackedResourceVec &outResources ) const
+    {
+        if( mRenderPassDesc )
+        {
+            for( int i=0; i<mRenderPassDesc->getNumColourEntries(); ++i )
+            {
+                outResources.push_back( mRenderPassDesc->mColour[i].texture );
+                if( mRenderPassDesc->mColour[i].resolveTexture )
+                    outResources.push_back( mRenderPassDesc->mColour[i].resolveTexture );
+            }
+            if( mRenderPassDesc->mDepth.texture && !mRenderPassDesc->mDepth.readOnly )
+                outResources.push_back( mRenderPassDesc->mDepth.texture );
+            if( mRenderPassDesc->mStencil.texture && !mRenderPassDesc->mStencil.readOnly )
+                outResources.push_back( mRenderPassDesc->mStencil.texture );
+        }
+
+        CompositorPassDef::UavDependencyVec::const_iterator itor = mDefinition->mUavDependencies.begin();
+        CompositorPassDef::UavDependencyVec::const_iterator end  = mDefinition->mUavDependencies.end();
+
+        while( itor != end )
+        {
+            if( (itor->access & ResourceAccess::Write) && boundUavs[itor->uavSlot].rttOrBuffer )
+                outResources.push_back( boundUavs[itor->uavSlot].rttOrBuffer );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPass::_updateWrittenResources( const BoundUav boundUavs[64] )
+    {
+        mWrittenResources.clear();
+        _getWrittenResources( boundUavs, mWrittenResources );
+
+        mWritesToRenderWindow = false;
+        if( mRenderPassDesc )
+        {
+            for( int i=0; i<mRenderPassDesc->getNumColourEntries(); ++i )
+            {
+                if( mRenderPassDesc->mColour[i].texture->isRenderWindowSpecific() )
+                    mWritesToRenderWindow = true;
+            }
+            if( mRenderPassDesc->mDepth.texture &&
+                mRenderPassDesc->mDepth.texture->isRenderWindowSpecific() )
+            {
+                mWritesToRenderWindow = true;
+            }
+        }
+
+        mResultCacheValid = false;
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorPass::_isResultCacheValid(void) const
+    {
+        if( !mResultCacheValid )
+            return false;
+
+        const CompositorWorkspace *workspace = mParentNode->getWorkspace();
+        const Real dynResScale = workspace->getDynamicResolution() ?
+                                     workspace->getDynamicResolutionScale() : Real( 1.0f );
+        if( dynResScale != mCachedDynResScale )
+            return false;
+
+        vector<uint32>::type::const_iterator itVersion = mCachedContentVersions.begin();
+
+        CompositorTextureVec::const_iterator itDep = mTextureDependencies.begin();
+        CompositorTextureVec::const_iterator enDep = mTextureDependencies.end();
+        while( itDep != enDep )
+        {
+            if( itDep->texture->getContentVersion() != *itVersion++ )
+                return false;
+            ++itDep;
+        }
+
+        GpuTrackedResourceVec::const_iterator itor = mWrittenResources.begin();
+        GpuTrackedResourceVec::const_iterator end  = mWrittenResources.end();
+        while( itor != end )
+        {
+            if( (*itor)->getContentVersion() != *itVersion++ )
+                return false;
+            ++itor;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPass::_notifyExecuted(void)
+    {
+        GpuTrackedResourceVec::const_iterator itor = mWrittenResources.begin();
+        GpuTrackedResourceVec::const_iterator end  = mWrittenResources.end();
+        while( itor != end )
+        {
+            (*itor)->_notifyContentChanged();
+            ++itor;
+        }
+
+        if( mDefinition->mCacheResult && !mWritesToRenderWindow )
+        {
+            const CompositorWorkspace *workspace = mParentNode->getWorkspace();
+            mCachedDynResScale = workspace->getDynamicResolution() ?
+                                     workspace->getDynamicResolutionScale() : Real( 1.0f );
+
+            mCachedContentVersions.clear();
+            mCachedContentVersions.reserve( mTextureDependencies.size() +
+                                            mWrittenResources.size() );
+
+            CompositorTextureVec::const_iterator itDep = mTextureDependencies.begin();
+            CompositorTextureVec::const_iterator enDep = mTextureDependencies.end();
+            while( itDep != enDep )
+            {
+                mCachedContentVersions.push_back( itDep->texture->getContentVersion() );
+                ++itDep;
+            }
+
+            itor = mWrittenResources.begin();
+            while( itor != end )
+            {
+                mCachedContentVersions.push_back( (*itor)->getContentVersion() );
+                ++itor;
+            }
+
+            mResultCacheValid = true;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPass::_setAsyncCompute( bool asyncCompute, bool waitForAsyncCompute )
+    {
+        assert( (!asyncCompute || _canRunAsyncCompute()) &&
+                "This pass can't be submitted to the async compute queue" );
+        mAsyncCompute = asyncCompute;
+        mWaitForAsyncCompute = waitForAsyncCompute;
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPass::_removeAllBarriers(void)
     {
         assert( mNumValidResourceTransitions <= mResourceTransitions.size() );
@@ -803,10 +1012,16 @@ namespace Ogre
 
         mNumValidResourceTransitions = 0;
         mResourceTransitions.clear();
+        mAsyncCompute = false;
+        mWaitForAsyncCompute = false;
+        mWrittenResources.clear();
+        mResultCacheValid = false;
     }
     //-----------------------------------------------------------------------------------
     bool CompositorPass::notifyRecreated( const TextureGpu *channel )
     {
+        mResultCacheValid = false;
+
         if( !mRenderPassDesc )
             return false;
 
@@ -868,10 +1083,19 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorPass::notifyRecreated( const UavBufferPacked *oldBuffer, UavBufferPacked *newBuffer )
     {
+        GpuTrackedResource *oldResource = const_cast<UavBufferPacked*>( oldBuffer );
+        std::replace( mWrittenResources.begin(), mWrittenResources.end(),
+                      oldResource, static_cast<GpuTrackedResource*>( newBuffer ) );
+        mResultCacheValid = false;
     }
     //-----------------------------------------------------------------------------------
     void CompositorPass::notifyDestroyed( TextureGpu *channel )
     {
+        mWrittenResources.erase( std::remove( mWrittenResources.begin(), mWrittenResources.end(),
+                                              static_cast<GpuTrackedResource*>( channel ) ),
+                                 mWrittenResources.end() );
+        mResultCacheValid = false;
+
         if( !mRenderPassDesc )
             return;
 
@@ -901,10 +1125,18 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void CompositorPass::notifyDestroyed( const UavBufferPacked *buffer )
     {
+        GpuTrackedResource *resource = const_cast<UavBufferPacked*>( buffer );
+        mWrittenResources.erase( std::remove( mWrittenResources.begin(), mWrittenResources.end(),
+                                              resource ),
+                                 mWrittenResources.end() );
+        mResultCacheValid = false;
     }
     //-----------------------------------------------------------------------------------
     void CompositorPass::notifyCleared(void)
     {
+        mWrittenResources.clear();
+        mResultCacheValid = false;
+
         if( mRenderPassDesc )
         {
             RenderSystem *renderSystem = mParentNode->getRenderSystem();
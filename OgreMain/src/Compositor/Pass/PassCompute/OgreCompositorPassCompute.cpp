@@ -42,6 +42,8 @@ THE SOFTWARE.
 #include "OgreHlmsComputeJob.h"
 
 #include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreForwardPlusBase.h"
 
 #include "Vao/OgreUavBufferPacked.h"
 
@@ -259,6 +261,55 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassCompute::setForwardPlusLightsToJob(void)
+    {
+        uint32 numLights = 0;
+        TexBufferPacked *lightList = 0;
+
+        if( mCamera )
+        {
+            const ForwardPlusBase *forwardPlus = mCamera->getSceneManager()->getForwardPlus();
+            if( forwardPlus )
+                lightList = forwardPlus->findGlobalLightListBuffer( mCamera, numLights );
+        }
+
+        if( lightList )
+        {
+            DescriptorSetTexture2::BufferSlot bufferSlot(
+                        DescriptorSetTexture2::BufferSlot::makeEmpty() );
+            bufferSlot.buffer = lightList;
+            mComputeJob->setTexBuffer( mDefinition->mForwardPlusLightsSlot, bufferSlot );
+        }
+        else
+        {
+            //Nothing to bind. The job must not read the buffer.
+            numLights = 0;
+        }
+
+        ShaderParams &shaderParams = mComputeJob->getShaderParams( "default" );
+
+        ShaderParams::Param *param = shaderParams.findParameter( "numLights" );
+        if( param )
+            param->setManualValue( numLights );
+
+        if( mCamera )
+        {
+            param = shaderParams.findParameter( "projectionParams" );
+            if( param )
+                param->setManualValue( mCamera->getProjectionParamsAB() );
+
+            param = shaderParams.findParameter( "frustumExtents" );
+            if( param )
+            {
+                Real left, right, top, bottom;
+                mCamera->getFrustumExtents( left, right, top, bottom, FET_TAN_HALF_ANGLES );
+                param->setManualValue( Vector4( left, right, top, bottom ) );
+            }
+        }
+
+        shaderParams.setDirty();
+    }
     //-----------------------------------------------------------------------------------
 	void CompositorPassCompute::execute( const Camera *lodCamera )
     {
@@ -277,11 +328,17 @@ namespace Ogre
         RenderSystem *renderSystem = mParentNode->getRenderSystem();
         renderSystem->endRenderPassDescriptor();
 
+        if( mAsyncCompute )
+            renderSystem->_beginAsyncCompute();
+
         executeResourceTransitions();
 
         //Set textures/uavs every frame
         setResourcesToJob();
 
+        if( mDefinition->mForwardPlusLightsSlot != 0xFF )
+            setForwardPlusLightsToJob();
+
         //Fire the listener in case it wants to change anything
         notifyPassPreExecuteListeners();
 
@@ -294,6 +351,9 @@ namespace Ogre
         HlmsCompute *hlmsCompute = static_cast<HlmsCompute*>( mComputeJob->getCreator() );
         hlmsCompute->dispatch( mComputeJob, sceneManager, mCamera );
 
+        if( mAsyncCompute )
+            renderSystem->_endAsyncCompute();
+
         notifyPassPosExecuteListeners();
 
         profilingEnd();
@@ -387,4 +447,60 @@ namespace Ogre
             }
         }
     }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassCompute::_getAccessedResources( const BoundUav boundUavs[64],
+                                                       GpuTrackedResourceVec &outResources ) const
+    {
+        CompositorPass::_getAccessedResources( boundUavs, outResources );
+
+        const CompositorPassComputeDef::TextureSources &uavSources = mDefinition->getUavSources();
+        CompositorPassComputeDef::TextureSources::const_iterator itor = uavSources.begin();
+        CompositorPassComputeDef::TextureSources::const_iterator end  = uavSources.end();
+
+        while( itor != end )
+        {
+            outResources.push_back( mParentNode->getDefinedTexture( itor->textureName ) );
+            ++itor;
+        }
+
+        const CompositorPassComputeDef::BufferSourceVec &bufferSources =
+                mDefinition->getBufferSources();
+        CompositorPassComputeDef::BufferSourceVec::const_iterator itBuf = bufferSources.begin();
+        CompositorPassComputeDef::BufferSourceVec::const_iterator enBuf = bufferSources.end();
+
+        while( itBuf != enBuf )
+        {
+            outResources.push_back( mParentNode->getDefinedBuffer( itBuf->bufferName ) );
+            ++itBuf;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassCompute::_getWrittenResources( const BoundUav boundUavs[64],
+                                                      GpuTrackedResourceVec &outResources ) const
+    {
+        CompositorPass::_getWrittenResources( boundUavs, outResources );
+
+        const CompositorPassComputeDef::TextureSources &uavSources = mDefinition->getUavSources();
+        CompositorPassComputeDef::TextureSources::const_iterator itor = uavSources.begin();
+        CompositorPassComputeDef::TextureSources::const_iterator end  = uavSources.end();
+
+        while( itor != end )
+        {
+            if( itor->access & ResourceAccess::Write )
+                outResources.push_back( mParentNode->getDefinedTexture( itor->textureName ) );
+            ++itor;
+        }
+
+        const CompositorPassComputeDef::BufferSourceVec &bufferSources =
+                mDefinition->getBufferSources();
+        CompositorPassComputeDef::BufferSourceVec::const_iterator itBuf = bufferSources.begin();
+        CompositorPassComputeDef::BufferSourceVec::const_iterator enBuf = bufferSources.end();
+
+        while( itBuf != enBuf )
+        {
+            if( itBuf->access & ResourceAccess::Write )
+                outResources.push_back( mParentNode->getDefinedBuffer( itBuf->bufferName ) );
+            ++itBuf;
+        }
+    }
 }
@@ -47,6 +47,7 @@ THE SOFTWARE.
 #include "OgreHlmsCompute.h"
 #include "OgreHlmsComputeJob.h"
 #include "OgreLogManager.h"
+#include "Compute/OgreComputeDownsampler.h"
 
 namespace Ogre
 {
@@ -79,6 +80,7 @@ namespace Ogre
         CompositorPass( definition, parentNode ),
         mInputTexture( 0 ),
         mOutputTexture( 0 ),
+        mDownsampler( 0 ),
         mDefinition( definition )
     {
         initialize( rtv );
@@ -178,6 +180,9 @@ namespace Ogre
 
             mJobs.clear();
         }
+
+        OGRE_DELETE mDownsampler;
+        mDownsampler = 0;
     }
     //-----------------------------------------------------------------------------------
     void CompositorPassIblSpecular::setupComputeShaders( void )
@@ -295,6 +300,16 @@ namespace Ogre
             mJobs.push_back( job );
         }
 
+        // The downsampler needs far fewer dispatches than the API's mipmap generation (which on
+        // some APIs is also implemented with one compute/raster pass per mip). Optional: the user
+        // may not have included its compute job
+        if( ComputeDownsampler::isTextureSupported( mInputTexture ) &&
+            hlmsCompute->findComputeJobNoThrow( "Mipmap/SinglePassDownsample" ) )
+        {
+            mDownsampler = OGRE_NEW ComputeDownsampler( hlmsManager );
+            mDownsampler->setup( mInputTexture );
+        }
+
         if( !hasTypedUavLoads && mNumPassesLeft != std::numeric_limits<uint32>::max() )
             mNumPassesLeft = 1u;
     }
@@ -360,20 +375,15 @@ namespace Ogre
             RenderSystem *renderSystem = mParentNode->getRenderSystem();
             renderSystem->endRenderPassDescriptor();
 
-            mInputTexture->_autogenerateMipmaps();
+            // The integration jobs sample the input's mips, thus we need the final barrier
+            if( mDownsampler )
+                mDownsampler->execute( true );
+            else
+                mInputTexture->_autogenerateMipmaps();
 
-            vector<HlmsComputeJob *>::type::iterator itor = mJobs.begin();
-            vector<HlmsComputeJob *>::type::iterator endt = mJobs.end();
-
-            while( itor != endt )
-            {
-                hlmsCompute->dispatch( *itor, 0, 0 );
-
-                // Don't issue a barrier for the last one. The compositor will take care of that one.
-                /*if( itor != endt - 1u )
-                    renderSystem->_executeResourceTransition( &itor->resourceTransition );*/
-                ++itor;
-            }
+            // Each job writes to its own mip and they all read from the input, thus they're
+            // independent and can go back to back. The compositor takes care of the final barrier.
+            hlmsCompute->dispatch( &mJobs[0], mJobs.size(), 0, 0 );
         }
 
         notifyPassPosExecuteListeners();
@@ -391,11 +401,13 @@ namespace Ogre
         const bool usesCompute = !mJobs.empty();
 
         // Check <anything> -> RT for mInputTexture (we need to generate mipmaps).
-        ResourceLayoutMap::iterator currentLayout = resourcesLayout.find( mOutputTexture );
-        if( currentLayout->second != ResourceLayout::RenderTarget )
-        {
-            addResourceTransition( currentLayout, ResourceLayout::RenderTarget, ReadBarrier::Texture );
-        }
+        // When the downsampler generates them, the input is sampled and written as UAV
+        // several times, so we set it to Texture (see CompositorPassMipmap)
+        const ResourceLayout::Layout inputLayout =
+            mDownsampler ? ResourceLayout::Texture : ResourceLayout::RenderTarget;
+        ResourceLayoutMap::iterator currentLayout = resourcesLayout.find( mInputTexture );
+        if( currentLayout != resourcesLayout.end() && currentLayout->second != inputLayout )
+            addResourceTransition( currentLayout, inputLayout, ReadBarrier::Texture );
 
         // Check <anything> -> UAV for mOutputTexture (we need to write to it).
         currentLayout = resourcesLayout.find( mOutputTexture );
@@ -447,4 +459,14 @@ namespace Ogre
         if( !hasTypedUavLoads && mNumPassesLeft != std::numeric_limits<uint32>::max() )
             mNumPassesLeft = 1u;
     }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassIblSpecular::_getWrittenResources( const BoundUav boundUavs[64],
+                                                          GpuTrackedResourceVec &outResources ) const
+    {
+        CompositorPass::_getWrittenResources( boundUavs, outResources );
+        if( mOutputTexture )
+            outResources.push_back( mOutputTexture );
+        if( mDownsampler )
+            outResources.push_back( mInputTexture );
+    }
 }  // namespace Ogre
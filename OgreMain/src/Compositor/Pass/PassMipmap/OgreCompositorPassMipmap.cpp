@@ -44,6 +44,7 @@ THE SOFTWARE.
 #include "OgreHlmsCompute.h"
 #include "OgreHlmsComputeJob.h"
 #include "OgreLogManager.h"
+#include "Compute/OgreComputeDownsampler.h"
 
 namespace Ogre
 {
@@ -84,7 +85,8 @@ namespace Ogre
         }
 
         if( mDefinition->mMipmapGenerationMethod == CompositorPassMipmapDef::Compute ||
-            mDefinition->mMipmapGenerationMethod == CompositorPassMipmapDef::ComputeHQ )
+            mDefinition->mMipmapGenerationMethod == CompositorPassMipmapDef::ComputeHQ ||
+            mDefinition->mMipmapGenerationMethod == CompositorPassMipmapDef::ComputeSinglePass )
         {
             setupComputeShaders();
         }
@@ -117,6 +119,14 @@ namespace Ogre
             mJobs.clear();
         }
 
+        vector<ComputeDownsampler*>::type::const_iterator itDown = mDownsamplers.begin();
+        vector<ComputeDownsampler*>::type::const_iterator enDown = mDownsamplers.end();
+
+        while( itDown != enDown )
+            OGRE_DELETE *itDown++;
+
+        mDownsamplers.clear();
+
         TextureGpuManager *textureManager = renderSystem->getTextureGpuManager();
         TextureGpuVec::iterator itor = mTmpTextures.begin();
         TextureGpuVec::iterator end  = mTmpTextures.end();
@@ -131,6 +141,12 @@ namespace Ogre
     {
         destroyComputeShaders();
 
+        if( mDefinition->mMipmapGenerationMethod == CompositorPassMipmapDef::ComputeSinglePass )
+        {
+            setupDownsamplers();
+            return;
+        }
+
         HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
         HlmsCompute *hlmsCompute = hlmsManager->getComputeHlms();
 
@@ -305,6 +321,47 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorPassMipmap::setupDownsamplers(void)
+    {
+        RenderSystem *renderSystem = mParentNode->getRenderSystem();
+        const RenderSystemCapabilities *caps = renderSystem->getCapabilities();
+
+        if( !caps->hasCapability( RSC_COMPUTE_PROGRAM ) )
+        {
+            LogManager::getSingleton().logMessage(
+                        "[INFO] Compute Shaders not supported. Using fallback mipmap generation." );
+            return;
+        }
+
+        HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
+
+        TextureGpuVec::const_iterator itor = mTextures.begin();
+        TextureGpuVec::const_iterator end  = mTextures.end();
+
+        while( itor != end )
+        {
+            TextureGpu *texture = *itor;
+
+            if( texture->getNumMipmaps() > 1u )
+            {
+                if( !ComputeDownsampler::isTextureSupported( texture ) )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Texture '" + texture->getNameStr() +
+                                 "' must be a 2D, 2D array or cubemap flagged as UAV and Texture, "
+                                 "and of a float, unorm or snorm format in order to be able to "
+                                 "generate mipmaps using mipmap_method compute_single_pass",
+                                 "CompositorPassMipmap::setupDownsamplers" );
+                }
+
+                ComputeDownsampler *downsampler = OGRE_NEW ComputeDownsampler( hlmsManager );
+                mDownsamplers.push_back( downsampler );
+                downsampler->setup( texture, mDefinition->mReduction );
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassMipmap::setGaussianFilterParams( HlmsComputeJob *job, uint8 kernelRadius,
                                                         float gaussianDeviationFactor )
     {
@@ -406,7 +463,7 @@ namespace Ogre
         //Fire the listener in case it wants to change anything
         notifyPassPreExecuteListeners();
 
-        const bool usesCompute = !mJobs.empty();
+        const bool usesCompute = !mJobs.empty() || !mDownsamplers.empty();
 
         if( !usesCompute )
         {
@@ -432,6 +489,16 @@ namespace Ogre
                 ++itor;
             }
         }
+        else if( !mDownsamplers.empty() )
+        {
+            //Each texture is independent of the others, and the compositor
+            //takes care of the barrier after the last dispatch.
+            vector<ComputeDownsampler*>::type::const_iterator itor = mDownsamplers.begin();
+            vector<ComputeDownsampler*>::type::const_iterator end  = mDownsamplers.end();
+
+            while( itor != end )
+                (*itor++)->execute( false );
+        }
         else
         {
             assert( dynamic_cast<HlmsCompute*>( mJobs[0].job->getCreator() ) );
@@ -467,7 +534,7 @@ namespace Ogre
         const RenderSystemCapabilities *caps = renderSystem->getCapabilities();
         const bool explicitApi = caps->hasCapability( RSC_EXPLICIT_API );
 
-        const bool usesCompute = !mJobs.empty();
+        const bool usesCompute = !mJobs.empty() || !mDownsamplers.empty();
 
         //Check <anything> -> RT for every RTT in the textures we'll be generating mipmaps.
         TextureGpuVec::const_iterator itTex = mTextures.begin();
@@ -518,4 +585,11 @@ namespace Ogre
 
         return usedByUs;
     }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassMipmap::_getWrittenResources( const BoundUav boundUavs[64],
+                                                     GpuTrackedResourceVec &outResources ) const
+    {
+        CompositorPass::_getWrittenResources( boundUavs, outResources );
+        outResources.insert( outResources.end(), mTextures.begin(), mTextures.end() );
+    }
 }
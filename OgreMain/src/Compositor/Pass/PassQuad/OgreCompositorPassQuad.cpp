@@ -41,6 +41,8 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "OgreTechnique.h"
 #include "OgreCamera.h"
+#include "OgreFramePacer.h"
+#include "OgreRoot.h"
 
 namespace Ogre
 {
@@ -113,6 +115,13 @@ namespace Ogre
             mFsRect->setMaterial( mMaterial );
         }
 
+        if( mDefinition->mReprojection != CompositorPassQuadDef::ReprojectionOff && !mPass )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Reprojection requires a low level material. Material '" +
+                         mDefinition->mMaterialName + "'", "CompositorPassQuad::CompositorPassQuad" );
+        }
+
         mDatablock = mFsRect->getDatablock();
 
         if( mDefinition->mCameraName != IdString() )
@@ -139,8 +148,37 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorPassQuad::updateReprojection(void)
+    {
+        FramePacer *framePacer = Root::getSingleton().getFramePacer();
+
+        Matrix4 reprojectionMatrix = Matrix4::IDENTITY;
+
+        Quaternion renderedOrientation;
+        Matrix4 renderedProjMatrix;
+        if( framePacer->getRenderedPose( mCamera, renderedOrientation, renderedProjMatrix ) )
+        {
+            framePacer->_sampleLatestPose( mCamera );
+
+            //current NDC -> current view -> world -> rendered view -> rendered NDC
+            const Quaternion deltaRotation =
+                    renderedOrientation.Inverse() * mCamera->getDerivedOrientation();
+            reprojectionMatrix = renderedProjMatrix * Matrix4( deltaRotation ) *
+                                 mCamera->getProjectionMatrix().inverse();
+        }
+
+        GpuProgramParametersSharedPtr psParams = mPass->getFragmentProgramParameters();
+        psParams->setNamedConstant( "reprojectionMatrix", reprojectionMatrix );
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassQuad::execute( const Camera *lodCamera )
     {
+        if( mDefinition->mReprojection == CompositorPassQuadDef::ReprojectionWhenLate &&
+            !Root::getSingleton().getFramePacer()->isFrameLate() )
+        {
+            return;
+        }
+
         //Execute a limited number of times?
         if( mNumPassesLeft != std::numeric_limits<uint32>::max() )
         {
@@ -190,6 +228,24 @@ namespace Ogre
             mFsRect->setCorners( 0.0f + hOffset, 0.0f - vOffset, 1.0f, 1.0f );
         }
 
+        {
+            //With dynamic resolution only the top-left area of our inputs is valid.
+            //The rectangle is shared, set the UVs each time
+            const CompositorWorkspace *workspace = mParentNode->getWorkspace();
+            Real uvScale = 1.0f;
+            CompositorTextureVec::const_iterator itDep = mTextureDependencies.begin();
+            CompositorTextureVec::const_iterator enDep = mTextureDependencies.end();
+            while( itDep != enDep && uvScale == 1.0f )
+            {
+                uvScale = workspace->_getDynamicResolutionScale( itDep->texture );
+                ++itDep;
+            }
+            mFsRect->setUvScale( Vector2( uvScale, uvScale ) );
+        }
+
+        if( mDefinition->mReprojection != CompositorPassQuadDef::ReprojectionOff )
+            updateReprojection();
+
         const Quaternion oldCameraOrientation( mCamera->getOrientation() );
 
         if( mDefinition->mCameraCubemapReorient )
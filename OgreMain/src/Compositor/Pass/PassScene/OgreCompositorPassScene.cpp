@@ -36,6 +36,12 @@ THE SOFTWARE.
 #include "OgreCamera.h"
 #include "OgreViewport.h"
 #include "OgreSceneManager.h"
+#include "OgreForwardPlusBase.h"
+#include "OgreRoot.h"
+#include "OgreFramePacer.h"
+#include "OgreRadialDensityMask.h"
+#include "OgreRenderQueue.h"
+#include "OgreRenderPassDescriptor.h"
 
 namespace Ogre
 {
@@ -53,7 +59,12 @@ namespace Ogre
                 mPrePassDepthTexture( 0 ),
                 mSsrTexture( 0 ),
                 mDepthTextureNoMsaa( 0 ),
-                mRefractionsTexture( 0 )
+                mRefractionsTexture( 0 ),
+                mCachedStaticSceneVersion( 0 ),
+                mAutoPrePassDesc( 0 ),
+                mAutoPrePassMainDesc( 0 ),
+                mAutoPrePassEnabled( false ),
+                mEstimatedOverdraw( 0 )
     {
         initialize( rtv );
 
@@ -94,6 +105,15 @@ namespace Ogre
                          "CompositorPassScene::CompositorPassScene" );
         }
 
+        if( mDefinition->mPrePassMode == PrePassNone && mDefinition->mGenGBuffer &&
+            rtv->colourAttachments.size() < 4u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Requesting mGenGBuffer (generate a deferred shading GBuffer) but "
+                         "there is less than 4 colour render textures to render to!",
+                         "CompositorPassScene::CompositorPassScene" );
+        }
+
         if( mDefinition->mPrePassMode == PrePassUse && !mDefinition->mPrePassTexture.empty() )
         {
             {
@@ -137,6 +157,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     CompositorPassScene::~CompositorPassScene()
     {
+        destroyAutoDepthPrePassDescs();
     }
     //-----------------------------------------------------------------------------------
     void CompositorPassScene::notifyPassSceneAfterShadowMapsListeners(void)
@@ -167,6 +188,90 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void CompositorPassScene::setupRadialDensityMask( SceneManager *sceneManager )
+    {
+        RadialDensityMask *rdm = sceneManager->getRadialDensityMask();
+        if( !rdm || memcmp( rdm->getRadius(), mDefinition->mRdmRadius,
+                            sizeof( mDefinition->mRdmRadius ) ) != 0 )
+        {
+            //Avoid touching it every frame, as changing the radiuses dirties its parameters
+            sceneManager->setRadialDensityMask( true, mDefinition->mRdmRadius );
+            rdm = sceneManager->getRadialDensityMask();
+        }
+
+        const RadialDensityMask::RdmQuality quality =
+                static_cast<RadialDensityMask::RdmQuality>( mDefinition->mRdmQuality );
+        if( rdm->getQuality() != quality )
+            rdm->setQuality( quality );
+    }
+    //-----------------------------------------------------------------------------------
+    bool CompositorPassScene::prepareAutoDepthPrePass( SceneManager *sceneManager )
+    {
+        if( mDefinition->mAutoDepthPrePass == AutoDepthPrePass::Off ||
+            mDefinition->mPrePassMode != PrePassNone || mDefinition->mReadOnlyDepth ||
+            mDefinition->mUvBakingSet != 0xFF ||
+            mDefinition->mShadowNodeRecalculation == SHADOW_NODE_CASTER_PASS ||
+            sceneManager->_getCurrentRenderStage() == SceneManager::IRS_RENDER_TO_TEXTURE ||
+            !mRenderPassDesc || !mRenderPassDesc->mDepth.texture ||
+            mRenderPassDesc->mDepth.readOnly )
+        {
+            return false;
+        }
+
+        if( mDefinition->mAutoDepthPrePass == AutoDepthPrePass::Auto && !mAutoPrePassEnabled )
+            return false;
+
+        RenderSystem *renderSystem = mParentNode->getRenderSystem();
+
+        if( !mAutoPrePassMainDesc || !mAutoPrePassMainDesc->hasSameAttachments( mRenderPassDesc ) )
+        {
+            if( !mAutoPrePassDesc )
+            {
+                mAutoPrePassDesc = renderSystem->createRenderPassDescriptor();
+                mAutoPrePassMainDesc = renderSystem->createRenderPassDescriptor();
+            }
+
+            //The prepass only writes depth. Without colour, the Hlms
+            //sets hlms_render_depth_only and can skip the pixel shader
+            mAutoPrePassDesc->mDepth = mRenderPassDesc->mDepth;
+            mAutoPrePassDesc->mDepth.storeAction = StoreAction::Store;
+            mAutoPrePassDesc->mStencil = mRenderPassDesc->mStencil;
+            if( mAutoPrePassDesc->mStencil.texture )
+                mAutoPrePassDesc->mStencil.storeAction = StoreAction::Store;
+            mAutoPrePassDesc->entriesModified( RenderPassDescriptor::All );
+
+            //The main pass renders everything on top of the prepass' depth
+            const size_t numColourEntries = mRenderPassDesc->getNumColourEntries();
+            for( size_t i=0; i<numColourEntries; ++i )
+                mAutoPrePassMainDesc->mColour[i] = mRenderPassDesc->mColour[i];
+            for( size_t i=numColourEntries; i<OGRE_MAX_MULTIPLE_RENDER_TARGETS; ++i )
+                mAutoPrePassMainDesc->mColour[i] = RenderPassColourTarget();
+            mAutoPrePassMainDesc->mDepth = mRenderPassDesc->mDepth;
+            mAutoPrePassMainDesc->mDepth.loadAction = LoadAction::Load;
+            mAutoPrePassMainDesc->mStencil = mRenderPassDesc->mStencil;
+            if( mAutoPrePassMainDesc->mStencil.texture )
+                mAutoPrePassMainDesc->mStencil.loadAction = LoadAction::Load;
+            mAutoPrePassMainDesc->entriesModified( RenderPassDescriptor::All );
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassScene::destroyAutoDepthPrePassDescs(void)
+    {
+        RenderSystem *renderSystem = mParentNode->getRenderSystem();
+        if( mAutoPrePassDesc )
+        {
+            renderSystem->destroyRenderPassDescriptor( mAutoPrePassDesc );
+            mAutoPrePassDesc = 0;
+        }
+        if( mAutoPrePassMainDesc )
+        {
+            renderSystem->destroyRenderPassDescriptor( mAutoPrePassMainDesc );
+            mAutoPrePassMainDesc = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassScene::execute( const Camera *lodCamera )
     {
         //Execute a limited number of times?
@@ -181,8 +286,15 @@ namespace Ogre
 
         notifyPassEarlyPreExecuteListeners();
 
+        //Give the app a chance to update the camera with the freshest pose
+        //before it's used for culling, shadow maps and filling the pass buffers
+        Root::getSingleton().getFramePacer()->_lateLatchCamera( mCamera );
+
         SceneManager *sceneManager = mCamera->getSceneManager();
 
+        if( mDefinition->mRadialDensityMask && mDefinition->mInstancedStereo )
+            setupRadialDensityMask( sceneManager );
+
         Camera const *usedLodCamera = mLodCamera;
         if( lodCamera && mDefinition->mLodCameraName == IdString() )
             usedLodCamera = lodCamera;
@@ -265,7 +377,31 @@ namespace Ogre
         notifyPassSceneAfterShadowMapsListeners();
 
         executeResourceTransitions();
-        setRenderPassDescToCurrent();
+
+        ForwardPlusBase *forwardPlus = sceneManager->getForwardPlus();
+        if( forwardPlus && mDefinition->mEnableForwardPlus &&
+            mDefinition->mShadowNodeRecalculation != SHADOW_NODE_CASTER_PASS &&
+            sceneManager->_getCurrentRenderStage() != SceneManager::IRS_RENDER_TO_TEXTURE )
+        {
+            //Forward+ implementations filling their grid with compute shaders must do it
+            //before the render pass starts. Use the same aspect ratio
+            //Viewport::_updateCullPhase01 will use, so the cache stays valid.
+            Viewport localVp = *viewport;
+            setViewportSizeToViewport( 0u, &localVp );
+            const Real aspectRatio = (Real)localVp.getActualWidth() /
+                                     (Real)std::max( 1, localVp.getActualHeight() );
+            if( mCullCamera->getAutoAspectRatio() && mCullCamera->getAspectRatio() != aspectRatio )
+                mCullCamera->setAspectRatio( aspectRatio );
+            mCullCamera->_notifyViewport( viewport );
+            forwardPlus->_collectLightsBeforePass( mCullCamera, mPrePassDepthTexture );
+        }
+
+        const bool autoDepthPrePass = prepareAutoDepthPrePass( sceneManager );
+
+        if( autoDepthPrePass )
+            setRenderPassDescToCurrent( mAutoPrePassDesc );
+        else
+            setRenderPassDescToCurrent();
 
         sceneManager->_setForwardPlusEnabledInPass( mDefinition->mEnableForwardPlus );
         sceneManager->_setPrePassMode( mDefinition->mPrePassMode, mPrePassTextures,
@@ -273,6 +409,19 @@ namespace Ogre
         sceneManager->_setRefractions( mDepthTextureNoMsaa, mRefractionsTexture );
         sceneManager->_setCurrentCompositorPass( this );
 
+        if( mDefinition->mCameraCubemapReorient && mCullCamera == mCamera &&
+            !mDefinition->mReuseCullData && sceneManager->getBatchedCubemapCulling() &&
+            !sceneManager->_hasBatchedCullResults( mCamera ) )
+        {
+            //Cull all the faces at once. The passes rendering the other faces consume the rest.
+            Quaternion faceOrientations[6];
+            for( size_t i=0; i<6u; ++i )
+                faceOrientations[i] = oldCameraOrientation * CubemapRotations[i];
+            sceneManager->cullFrustumBatch( mCamera, faceOrientations, 6u, usedLodCamera,
+                                            sceneManager->_getCurrentRenderStage() ==
+                                            SceneManager::IRS_RENDER_TO_TEXTURE );
+        }
+
         viewport->_updateCullPhase01( mCamera, mCullCamera, usedLodCamera,
                                       mDefinition->mFirstRQ, mDefinition->mLastRQ,
                                       mDefinition->mReuseCullData );
@@ -282,9 +431,53 @@ namespace Ogre
 #if TODO_OGRE_2_2
         mTarget->setFsaaResolveDirty();
 #endif
+        RenderQueue *renderQueue = sceneManager->getRenderQueue();
+        RenderQueue::OccluderSelection occluderSelection;
+        occluderSelection.mMinScreenSize = mDefinition->mAutoPrePassMinOccluderSize;
+        occluderSelection.mMaxVertices = mDefinition->mAutoPrePassMaxOccluderVertices;
+
+        if( autoDepthPrePass )
+        {
+            //Render the occluders into the depth buffer only
+            occluderSelection.mOccludersOnly = true;
+            renderQueue->setOccluderSelection( occluderSelection );
+            viewport->_updateRenderPhase02( mCamera, usedLodCamera,
+                                            mDefinition->mFirstRQ, mDefinition->mLastRQ );
+            occluderSelection.mOccludersOnly = false;
+
+            //Then everything else with the depth buffer already filled. The render queue
+            //still holds everything; reusing the cull data updates the pass' Hlms state
+            setRenderPassDescToCurrent( mAutoPrePassMainDesc );
+            viewport->_updateCullPhase01( mCamera, mCullCamera, usedLodCamera,
+                                          mDefinition->mFirstRQ, mDefinition->mLastRQ, true );
+        }
+
+        const bool estimateOverdraw = mDefinition->mAutoDepthPrePass == AutoDepthPrePass::Auto &&
+                                      mDefinition->mShadowNodeRecalculation !=
+                                      SHADOW_NODE_CASTER_PASS;
+        if( estimateOverdraw )
+        {
+            occluderSelection.mEstimateOverdraw = true;
+            renderQueue->setOccluderSelection( occluderSelection );
+        }
+
         viewport->_updateRenderPhase02( mCamera, usedLodCamera,
                                         mDefinition->mFirstRQ, mDefinition->mLastRQ );
 
+        if( estimateOverdraw )
+        {
+            mEstimatedOverdraw = renderQueue->getEstimatedOverdraw();
+            //Hysteresis avoids toggling every frame when near the threshold
+            const Real threshold = mDefinition->mAutoPrePassOverdrawThreshold;
+            if( mAutoPrePassEnabled )
+                mAutoPrePassEnabled = mEstimatedOverdraw >= threshold * 0.8f;
+            else
+                mAutoPrePassEnabled = mEstimatedOverdraw > threshold;
+        }
+
+        if( autoDepthPrePass || estimateOverdraw )
+            renderQueue->setOccluderSelection( RenderQueue::OccluderSelection() );
+
         if( mDefinition->mCameraCubemapReorient )
         {
             //Restore orientation
@@ -418,9 +611,45 @@ namespace Ogre
         CompositorPass::_placeBarriersAndEmulateUavExecution( boundUavs, uavsAccess, resourcesLayout );
     }
     //-----------------------------------------------------------------------------------
+    bool CompositorPassScene::notifyRecreated( const TextureGpu *channel )
+    {
+        //They get recreated from mRenderPassDesc on the next execution
+        if( mAutoPrePassMainDesc && mAutoPrePassMainDesc->hasAttachment( channel ) )
+            destroyAutoDepthPrePassDescs();
+        return CompositorPass::notifyRecreated( channel );
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassScene::notifyDestroyed( TextureGpu *channel )
+    {
+        if( mAutoPrePassMainDesc && mAutoPrePassMainDesc->hasAttachment( channel ) )
+            destroyAutoDepthPrePassDescs();
+        CompositorPass::notifyDestroyed( channel );
+    }
+    //-----------------------------------------------------------------------------------
     void CompositorPassScene::notifyCleared(void)
     {
         mShadowNode = 0; //Allow changes to our shadow nodes too.
         CompositorPass::notifyCleared();
     }
+    //-----------------------------------------------------------------------------------
+    bool CompositorPassScene::_isResultCacheValid(void) const
+    {
+        if( !CompositorPass::_isResultCacheValid() )
+            return false;
+
+        return mCamera->getDerivedPosition() == mCachedCameraPos &&
+               mCamera->getDerivedOrientation() == mCachedCameraRot &&
+               mCamera->getProjectionMatrix() == mCachedProjMatrix &&
+               mCamera->getSceneManager()->getStaticSceneVersion() == mCachedStaticSceneVersion;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompositorPassScene::_notifyExecuted(void)
+    {
+        CompositorPass::_notifyExecuted();
+
+        mCachedCameraPos            = mCamera->getDerivedPosition();
+        mCachedCameraRot            = mCamera->getDerivedOrientation();
+        mCachedProjMatrix           = mCamera->getProjectionMatrix();
+        mCachedStaticSceneVersion   = mCamera->getSceneManager()->getStaticSceneVersion();
+    }
 }
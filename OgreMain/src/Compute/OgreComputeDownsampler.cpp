@@ -0,0 +1,222 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-present Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Compute/OgreComputeDownsampler.h"
+
+#include "OgreHlmsManager.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreRenderSystem.h"
+#include "OgreTextureGpu.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreShaderParams.h"
+#include "OgreStringConverter.h"
+#include "OgreId.h"
+
+namespace Ogre
+{
+    static const char *c_downsampleJobName = "Mipmap/SinglePassDownsample";
+
+    const uint8 ComputeDownsampler::MaxMipsPerDispatch = 6u;
+    //-----------------------------------------------------------------------------------
+    ComputeDownsampler::ComputeDownsampler( HlmsManager *hlmsManager ) :
+        mHlmsCompute( hlmsManager->getComputeHlms() ),
+        mRenderSystem( hlmsManager->getRenderSystem() ),
+        mTexture( 0 )
+    {
+        //TODO: The system does not support bits like Vulkan & D3D12 do.
+        //We need generic read layouts.
+        mResourceTransition.oldLayout = ResourceLayout::Undefined;
+        mResourceTransition.newLayout = ResourceLayout::Undefined;
+        mResourceTransition.writeBarrierBits = 0;
+        mResourceTransition.readBarrierBits = ReadBarrier::Texture;
+        mRenderSystem->_resourceTransitionCreated( &mResourceTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    ComputeDownsampler::~ComputeDownsampler()
+    {
+        destroyJobs();
+        mRenderSystem->_resourceTransitionDestroyed( &mResourceTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    bool ComputeDownsampler::isTextureSupported( const TextureGpu *texture )
+    {
+        const TextureTypes::TextureTypes textureType = texture->getTextureType();
+        if( textureType != TextureTypes::Type2D && textureType != TextureTypes::Type2DArray &&
+            textureType != TextureTypes::TypeCube )
+        {
+            return false;
+        }
+
+        if( !texture->isUav() || !texture->isTexture() || texture->isMultisample() )
+            return false;
+
+        const PixelFormatGpu pixelFormat = texture->getPixelFormat();
+        return !PixelFormatGpuUtils::isInteger( pixelFormat ) &&
+               !PixelFormatGpuUtils::isDepth( pixelFormat ) &&
+               !PixelFormatGpuUtils::isCompressed( pixelFormat );
+    }
+    //-----------------------------------------------------------------------------------
+    void ComputeDownsampler::destroyJobs(void)
+    {
+        FastArray<HlmsComputeJob*>::const_iterator itor = mJobs.begin();
+        FastArray<HlmsComputeJob*>::const_iterator end  = mJobs.end();
+
+        while( itor != end )
+        {
+            mHlmsCompute->destroyComputeJob( (*itor)->getName() );
+            ++itor;
+        }
+
+        mJobs.clear();
+        mTexture = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void ComputeDownsampler::setup( TextureGpu *texture,
+                                    DownsampleReduction::DownsampleReduction reduction )
+    {
+        destroyJobs();
+
+        if( !texture )
+            return;
+
+        if( !isTextureSupported( texture ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + texture->getNameStr() + "' must be a 2D, 2D array or "
+                         "cubemap texture of a float, unorm or snorm format flagged as UAV "
+                         "and Texture in order to be used with ComputeDownsampler",
+                         "ComputeDownsampler::setup" );
+        }
+
+    #if OGRE_NO_JSON
+        OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                     "ComputeDownsampler requires Ogre to be built with JSON support "
+                     "and you must include the resources bundled at "
+                     "Samples/Media/2.0/scripts/materials/Common",
+                     "ComputeDownsampler::setup" );
+    #endif
+        HlmsComputeJob *baseJob = mHlmsCompute->findComputeJobNoThrow( c_downsampleJobName );
+
+        if( !baseJob )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "To use ComputeDownsampler, you must include the resources "
+                         "bundled at Samples/Media/2.0/scripts/materials/Common\n"
+                         "Could not find " + String( c_downsampleJobName ),
+                         "ComputeDownsampler::setup" );
+        }
+
+        mTexture = texture;
+
+        const uint8 numMips = texture->getNumMipmaps();
+        const bool isArray = texture->getTextureType() != TextureTypes::Type2D;
+        const bool isCube = texture->getTextureType() == TextureTypes::TypeCube;
+        const PixelFormatGpu pixelFormat = texture->getPixelFormat();
+        const bool isSRgb = PixelFormatGpuUtils::isSRgb( pixelFormat );
+
+        const String newId = StringConverter::toString( Id::generateNewId<ComputeDownsampler>() );
+
+        DescriptorSetTexture2::TextureSlot texSlot(
+            DescriptorSetTexture2::TextureSlot::makeEmpty() );
+        texSlot.texture             = texture;
+        texSlot.cubemapsAs2DArrays  = true;
+        texSlot.numMipmaps          = 1u;
+
+        DescriptorSetUav::TextureSlot uavSlot( DescriptorSetUav::TextureSlot::makeEmpty() );
+        uavSlot.texture             = texture;
+        uavSlot.access              = ResourceAccess::Write;
+        uavSlot.textureArrayIndex   = 0;
+        uavSlot.pixelFormat         = pixelFormat;
+        if( isSRgb )
+            uavSlot.pixelFormat = PixelFormatGpuUtils::getEquivalentLinear( pixelFormat );
+
+        for( uint8 srcMip=0; srcMip + 1u < numMips; srcMip += MaxMipsPerDispatch )
+        {
+            const uint8 numDstMips =
+                    std::min<uint8>( MaxMipsPerDispatch, uint8( numMips - srcMip - 1u ) );
+
+            HlmsComputeJob *job = baseJob->clone( String( c_downsampleJobName ) + " " + newId +
+                                                  " mip " + StringConverter::toString( srcMip ) );
+            //The GLSL params list all the possible UAVs
+            ShaderParams *glslParams = job->_getShaderParams( "glsl" );
+            if( glslParams )
+                glslParams->mSilenceMissingParameterWarnings = true;
+
+            job->setProperty( "num_dst_mips", numDstMips );
+            if( isArray )
+                job->setProperty( "texture_is_array", 1 );
+            if( isCube )
+                job->setProperty( "uav_is_cube", 1 );
+            if( isSRgb )
+                job->setProperty( "srgb", 1 );
+            if( reduction == DownsampleReduction::Min )
+                job->setProperty( "downsample_min", 1 );
+            else if( reduction == DownsampleReduction::Max )
+                job->setProperty( "downsample_max", 1 );
+
+            texSlot.mipmapLevel = srcMip;
+            job->setTexture( 0, texSlot );
+
+            job->setNumUavUnits( numDstMips );
+            for( uint8 i=0; i<numDstMips; ++i )
+            {
+                uavSlot.mipmapLevel = srcMip + i + 1u;
+                job->_setUavTexture( i, uavSlot );
+            }
+
+            //Each threadgroup reduces a 64x64 tile of the source mip
+            const uint32 srcWidth   = std::max( texture->getWidth() >> srcMip, 1u );
+            const uint32 srcHeight  = std::max( texture->getHeight() >> srcMip, 1u );
+            job->setNumThreadGroups( (srcWidth + 63u) / 64u, (srcHeight + 63u) / 64u,
+                                     isArray ? texture->getNumSlices() : 1u );
+
+            mJobs.push_back( job );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ComputeDownsampler::execute( bool bFinalBarrier )
+    {
+        if( mJobs.empty() )
+            return;
+
+        mRenderSystem->endRenderPassDescriptor();
+
+        const size_t numJobs = mJobs.size();
+        for( size_t i=0; i<numJobs; ++i )
+        {
+            mHlmsCompute->dispatch( mJobs[i], 0, 0 );
+
+            //The next dispatch samples the last mip we wrote
+            if( i + 1u != numJobs || bFinalBarrier )
+                mRenderSystem->_executeResourceTransition( &mResourceTransition );
+        }
+    }
+}
@@ -39,6 +39,7 @@ THE SOFTWARE.
 #include "OgreMatrix4.h"
 
 #include "OgreException.h"
+#include "OgreTimer.h"
 
 namespace Ogre
 {
@@ -252,6 +253,34 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::shiftSlotsBack( size_t newEnd, size_t numFreeSlots )
+    {
+        size_t i=0;
+        MemoryPoolVec::iterator itPools = mMemoryPools.begin();
+        MemoryPoolVec::iterator enPools = mMemoryPools.end();
+
+        //Shift everything N slots (N = numFreeSlots)
+        while( itPools != enPools )
+        {
+            char *dstPtr    = *itPools + ( newEnd - numFreeSlots ) * mElementsMemSizes[i];
+            size_t indexDst = ( newEnd - numFreeSlots ) % ARRAY_PACKED_REALS;
+            char *srcPtr    = *itPools + newEnd * mElementsMemSizes[i];
+            size_t indexSrc = newEnd % ARRAY_PACKED_REALS;
+            size_t numSlots = ( mUsedMemory - newEnd );
+            mCleanupRoutines[i]( dstPtr, indexDst, srcPtr, indexSrc,
+                                 numSlots, numFreeSlots, mElementsMemSizes[i] );
+            ++i;
+            ++itPools;
+        }
+
+        mUsedMemory -= numFreeSlots;
+        initializeEmptySlots( mUsedMemory );
+
+        mRebaseListener->performCleanup( mLevel, mMemoryPools,
+                                         mElementsMemSizes, (newEnd - numFreeSlots),
+                                         numFreeSlots );
+    }
+    //-----------------------------------------------------------------------------------
     void ArrayMemoryManager::defragment(void)
     {
         //Sort, last values first. This may improve performance in some
@@ -271,37 +300,74 @@ namespace Ogre
                 ++it;
             }
 
-            size_t i=0;
-            const size_t newEnd = *itor + 1;
-            MemoryPoolVec::iterator itPools = mMemoryPools.begin();
-            MemoryPoolVec::iterator enPools = mMemoryPools.end();
+            shiftSlotsBack( *itor + 1, lastRange );
 
-            //Shift everything N slots (N = lastRange)
-            while( itPools != enPools )
+            itor += lastRange;
+        }
+
+        mAvailableSlots.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    bool ArrayMemoryManager::defragmentIncremental( DefragmentBudget &inOutBudget )
+    {
+        if( mAvailableSlots.empty() || inOutBudget.isExhausted() )
+            return false;
+
+        //Last values first; they're the cheapest to close (the least data to shift).
+        //Closing them doesn't alter the lower slots, hence the remaining entries stay valid.
+        std::sort( mAvailableSlots.begin(), mAvailableSlots.end(), std::greater<size_t>() );
+        SlotsVec::iterator itor = mAvailableSlots.begin();
+        SlotsVec::iterator end  = mAvailableSlots.end();
+
+        while( itor != end )
+        {
+            size_t lastRange = 1;
+            SlotsVec::const_iterator it = itor + 1;
+            while( it != end && (*itor - lastRange) == *it )
             {
-                char *dstPtr    = *itPools + ( newEnd - lastRange ) * mElementsMemSizes[i];
-                size_t indexDst = ( newEnd - lastRange ) % ARRAY_PACKED_REALS;
-                char *srcPtr    = *itPools + newEnd * mElementsMemSizes[i];
-                size_t indexSrc = newEnd % ARRAY_PACKED_REALS;
-                size_t numSlots = ( mUsedMemory - newEnd );
-                size_t numFreeSlots = lastRange;
-                mCleanupRoutines[i]( dstPtr, indexDst, srcPtr, indexSrc,
-                                     numSlots, numFreeSlots, mElementsMemSizes[i] );
-                ++i;
-                ++itPools;
+                ++lastRange;
+                ++it;
             }
 
-            mUsedMemory -= lastRange;
-            initializeEmptySlots( mUsedMemory );
+            const size_t newEnd = *itor + 1;
+            const size_t numSlotsToShift = mUsedMemory - newEnd;
+
+            if( !inOutBudget.canAfford( numSlotsToShift ) )
+                break;
 
-            mRebaseListener->performCleanup( mLevel, mMemoryPools,
-                                             mElementsMemSizes, (newEnd - lastRange),
-                                             lastRange );
+            shiftSlotsBack( newEnd, lastRange );
+            inOutBudget.slotsMoved += numSlotsToShift;
 
             itor += lastRange;
         }
 
-        mAvailableSlots.clear();
+        const bool closedHoles = itor != mAvailableSlots.begin();
+        mAvailableSlots.erase( mAvailableSlots.begin(), itor );
+
+        return closedHoles;
+    }
+    //-----------------------------------------------------------------------------------
+    void ArrayMemoryManager::addFragmentationStats( FragmentationStats &inOutStats ) const
+    {
+        inOutStats.numUsedSlots         += mUsedMemory - mAvailableSlots.size();
+        inOutStats.numFragmentedSlots   += mAvailableSlots.size();
+        inOutStats.numReservedSlots     += mMaxMemory - OGRE_PREFETCH_SLOT_DISTANCE;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ArrayMemoryManager::DefragmentBudget::canAfford( size_t numSlots ) const
+    {
+        if( isExhausted() )
+            return false;
+
+        return !slotsMoved || slotsMoved + numSlots <= maxSlotsToMove;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ArrayMemoryManager::DefragmentBudget::isExhausted(void) const
+    {
+        if( slotsMoved && slotsMoved >= maxSlotsToMove )
+            return true;
+
+        return timer && timer->getMicroseconds() >= deadlineMicroseconds;
     }
     //-----------------------------------------------------------------------------------
     void ArrayMemoryManager::shrinkToFit(void)
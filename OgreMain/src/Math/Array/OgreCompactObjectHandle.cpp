@@ -0,0 +1,105 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Math/Array/OgreCompactObjectHandle.h"
+
+#if OGRE_COMPACT_OBJECT_HANDLES
+#include "OgreException.h"
+
+namespace Ogre
+{
+    CompactObjectHandleTable::CompactObjectHandleTable() :
+        mNextHandle( 1u )
+    {
+        memset( mBlocks, 0, sizeof( mBlocks ) );
+        //Block 0 always exists so that handle 0 can be looked up (as null)
+        mBlocks[0] = reinterpret_cast<void**>( OGRE_MALLOC( BlockSize * sizeof( void* ),
+                                                            MEMCATEGORY_SCENE_OBJECTS ) );
+        memset( mBlocks[0], 0, BlockSize * sizeof( void* ) );
+    }
+    //-----------------------------------------------------------------------------------
+    CompactObjectHandleTable::~CompactObjectHandleTable()
+    {
+        for( size_t i=0; i<NumBlocks; ++i )
+        {
+            if( mBlocks[i] )
+                OGRE_FREE( mBlocks[i], MEMCATEGORY_SCENE_OBJECTS );
+            mBlocks[i] = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 CompactObjectHandleTable::add( void *obj )
+    {
+        assert( obj );
+
+        ScopedLock lock( mMutex );
+
+        uint32 handle;
+        if( !mFreeHandles.empty() )
+        {
+            handle = mFreeHandles.back();
+            mFreeHandles.pop_back();
+        }
+        else
+        {
+            if( mNextHandle == 0 )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                             "Ran out of 32-bit object handles",
+                             "CompactObjectHandleTable::add" );
+            }
+
+            handle = mNextHandle++;
+
+            const uint32 blockIdx = handle >> BlockBits;
+            if( !mBlocks[blockIdx] )
+            {
+                void **block = reinterpret_cast<void**>(
+                                   OGRE_MALLOC( BlockSize * sizeof( void* ),
+                                                MEMCATEGORY_SCENE_OBJECTS ) );
+                memset( block, 0, BlockSize * sizeof( void* ) );
+                mBlocks[blockIdx] = block;
+            }
+        }
+
+        mBlocks[handle >> BlockBits][handle & (BlockSize - 1u)] = obj;
+        return handle;
+    }
+    //-----------------------------------------------------------------------------------
+    void CompactObjectHandleTable::remove( uint32 handle )
+    {
+        assert( handle && handle < mNextHandle );
+
+        ScopedLock lock( mMutex );
+        mBlocks[handle >> BlockBits][handle & (BlockSize - 1u)] = 0;
+        mFreeHandles.push_back( handle );
+    }
+}
+#endif
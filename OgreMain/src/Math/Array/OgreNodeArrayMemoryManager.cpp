@@ -48,7 +48,8 @@ namespace Ogre
         3 * sizeof( Ogre::Real ),       //ArrayMemoryManager::DerivedScale
         16 * sizeof( Ogre::Real ),      //ArrayMemoryManager::WorldMat
         sizeof( bool ),                 //ArrayMemoryManager::InheritOrientation
-        sizeof( bool )                  //ArrayMemoryManager::InheritScale
+        sizeof( bool ),                 //ArrayMemoryManager::InheritScale
+        sizeof( uint8 )                 //ArrayMemoryManager::DirtyFlags
     };
     const CleanupRoutines NodeArrayMemoryManager::NodeInitRoutines[NumMemoryTypes] =
     {
@@ -62,7 +63,8 @@ namespace Ogre
         cleanerArrayVector3Unit,    //ArrayMemoryManager::DerivedScale
         0,                          //ArrayMemoryManager::WorldMat
         0,                          //ArrayMemoryManager::InheritOrientation
-        0                           //ArrayMemoryManager::InheritScale
+        0,                          //ArrayMemoryManager::InheritScale
+        0                           //ArrayMemoryManager::DirtyFlags
     };
     const CleanupRoutines NodeArrayMemoryManager::NodeCleanupRoutines[NumMemoryTypes] =
     {
@@ -76,7 +78,8 @@ namespace Ogre
         cleanerArrayVector3Unit,        //ArrayMemoryManager::DerivedScale
         cleanerFlat,                    //ArrayMemoryManager::WorldMat
         cleanerFlat,                    //ArrayMemoryManager::InheritOrientation
-        cleanerFlat                     //ArrayMemoryManager::InheritScale
+        cleanerFlat,                    //ArrayMemoryManager::InheritScale
+        cleanerFlat                     //ArrayMemoryManager::DirtyFlags
     };
     //-----------------------------------------------------------------------------------
     NodeArrayMemoryManager::NodeArrayMemoryManager( uint16 depthLevel, size_t hintMaxNodes,
@@ -132,6 +135,8 @@ namespace Ogre
                                                 nextSlotBase * mElementsMemSizes[InheritOrientation] );
         outTransform.mInheritScale      = reinterpret_cast<bool*>( mMemoryPools[InheritScale] +
                                                 nextSlotBase * mElementsMemSizes[InheritScale] );
+        outTransform.mDirtyFlags        = reinterpret_cast<uint8*>( mMemoryPools[DirtyFlags] +
+                                                nextSlotBase * mElementsMemSizes[DirtyFlags] );
 
         //Set default values
         outTransform.mParents[nextSlotIdx] = mDummyNode;
@@ -145,6 +150,7 @@ namespace Ogre
         outTransform.mDerivedTransform[nextSlotIdx] = Matrix4::IDENTITY;
         outTransform.mInheritOrientation[nextSlotIdx]   = true;
         outTransform.mInheritScale[nextSlotIdx]         = true;
+        outTransform.mDirtyFlags[nextSlotIdx]           = Transform::DirtyLocal;
     }
     //-----------------------------------------------------------------------------------
     void NodeArrayMemoryManager::destroyNode( Transform &inOutTransform )
@@ -175,6 +181,7 @@ namespace Ogre
         outTransform.mDerivedTransform  = reinterpret_cast<Matrix4*>( mMemoryPools[WorldMat] );
         outTransform.mInheritOrientation= reinterpret_cast<bool*>( mMemoryPools[InheritOrientation] );
         outTransform.mInheritScale      = reinterpret_cast<bool*>( mMemoryPools[InheritScale] );
+        outTransform.mDirtyFlags        = reinterpret_cast<uint8*>( mMemoryPools[DirtyFlags] );
 
         return mUsedMemory;
     }
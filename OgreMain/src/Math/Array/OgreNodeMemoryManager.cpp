@@ -37,7 +37,8 @@ namespace Ogre
     NodeMemoryManager::NodeMemoryManager() :
             mDummyNode( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
-            mTwinMemoryManager( 0 )
+            mTwinMemoryManager( 0 ),
+            mDirtyTracking( false )
     {
         //Manually allocate the memory for the dummy scene nodes (since we can't pass ourselves
         //or yet another object) We only allocate what's needed to prevent access violations.
@@ -57,6 +58,9 @@ namespace Ogre
         mDummyTransformPtrs.mDerivedTransform   = reinterpret_cast<Matrix4*>( OGRE_MALLOC_SIMD(
                                                 sizeof( Matrix4 ) * ARRAY_PACKED_REALS,
                                                 MEMCATEGORY_SCENE_OBJECTS ) );
+        mDummyTransformPtrs.mDirtyFlags         = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD(
+                                                sizeof( uint8 ) * ARRAY_PACKED_REALS,
+                                                MEMCATEGORY_SCENE_OBJECTS ) );
 
         /*mDummyTransformPtrs.mDerivedTransform = reinterpret_cast<ArrayMatrix4*>( OGRE_MALLOC_SIMD(
                                                 sizeof( ArrayMatrix4 ), MEMCATEGORY_SCENE_OBJECTS ) );
@@ -69,7 +73,11 @@ namespace Ogre
         *mDummyTransformPtrs.mDerivedOrientation    = ArrayQuaternion::IDENTITY;
         *mDummyTransformPtrs.mDerivedScale          = ArrayVector3::UNIT_SCALE;
         for( int i=0; i<ARRAY_PACKED_REALS; ++i )
+        {
             mDummyTransformPtrs.mDerivedTransform[i] = Matrix4::IDENTITY;
+            //The dummy never changes, so root nodes only depend on their own flags
+            mDummyTransformPtrs.mDirtyFlags[i] = 0;
+        }
 
         mDummyNode = new SceneNode( mDummyTransformPtrs );
     }
@@ -99,6 +107,7 @@ namespace Ogre
         OGRE_FREE_SIMD( mDummyTransformPtrs.mDerivedScale, MEMCATEGORY_SCENE_OBJECTS );
 
         OGRE_FREE_SIMD( mDummyTransformPtrs.mDerivedTransform, MEMCATEGORY_SCENE_OBJECTS );
+        OGRE_FREE_SIMD( mDummyTransformPtrs.mDirtyFlags, MEMCATEGORY_SCENE_OBJECTS );
         /*OGRE_FREE_SIMD( mDummyTransformPtrs.mInheritOrientation, MEMCATEGORY_SCENE_OBJECTS );
         OGRE_FREE_SIMD( mDummyTransformPtrs.mInheritScale, MEMCATEGORY_SCENE_OBJECTS );*/
         mDummyTransformPtrs = Transform();
@@ -196,6 +205,39 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    bool NodeMemoryManager::defragmentIncremental(
+            ArrayMemoryManager::DefragmentBudget &inOutBudget )
+    {
+        bool closedHoles = false;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end && !inOutBudget.isExhausted() )
+        {
+            closedHoles |= itor->defragmentIncremental( inOutBudget );
+            ++itor;
+        }
+
+        return closedHoles;
+    }
+    //-----------------------------------------------------------------------------------
+    ArrayMemoryManager::FragmentationStats NodeMemoryManager::getFragmentationStats(void) const
+    {
+        ArrayMemoryManager::FragmentationStats retVal;
+
+        ArrayMemoryManagerVec::const_iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::const_iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->addFragmentationStats( retVal );
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     void NodeMemoryManager::migrateTo( Transform &inOutTransform, size_t depth,
                                         NodeMemoryManager *dstNodeMemoryManager )
     {
@@ -39,8 +39,8 @@ namespace Ogre
     const size_t ObjectDataArrayMemoryManager::ElementsMemSize
                             [ObjectDataArrayMemoryManager::NumMemoryTypes] =
     {
-        sizeof( Node** ),               //ArrayMemoryManager::Parent
-        sizeof( MovableObject** ),      //ArrayMemoryManager::Owner
+        sizeof( ObjectData::NodeRef ),  //ArrayMemoryManager::Parent
+        sizeof( ObjectData::MovableObjectRef ), //ArrayMemoryManager::Owner
         6 * sizeof( Ogre::Real ),       //ArrayMemoryManager::LocalAabb
         6 * sizeof( Ogre::Real ),       //ArrayMemoryManager::WorldAabb
         1 * sizeof( Ogre::Real ),       //ArrayMemoryManager::LocalRadius
@@ -51,6 +51,9 @@ namespace Ogre
         1 * sizeof( Ogre::uint32 ),     //ArrayMemoryManager::VisibilityFlags
         1 * sizeof( Ogre::uint32 ),     //ArrayMemoryManager::QueryFlags
         1 * sizeof( Ogre::uint32 ),     //ArrayMemoryManager::LightMask
+        1 * sizeof( Ogre::Real ),       //ArrayMemoryManager::LodRangeMin
+        1 * sizeof( Ogre::Real ),       //ArrayMemoryManager::LodRangeMax
+        1 * sizeof( Ogre::uint8 ),      //ArrayMemoryManager::BoundsDirty
     };
     const CleanupRoutines ObjectDataArrayMemoryManager::ObjCleanupRoutines[NumMemoryTypes] =
     {
@@ -66,6 +69,9 @@ namespace Ogre
         cleanerFlat,                    //ArrayMemoryManager::VisibilityFlags
         cleanerFlat,                    //ArrayMemoryManager::QueryFlags
         cleanerFlat,                    //ArrayMemoryManager::LightMask
+        cleanerFlat,                    //ArrayMemoryManager::LodRangeMin
+        cleanerFlat,                    //ArrayMemoryManager::LodRangeMax
+        cleanerFlat,                    //ArrayMemoryManager::BoundsDirty
     };
     //-----------------------------------------------------------------------------------
     ObjectDataArrayMemoryManager::ObjectDataArrayMemoryManager( uint16 depthLevel, size_t hintMaxNodes,
@@ -84,8 +90,10 @@ namespace Ogre
     {
         ArrayMemoryManager::initializeEmptySlots( prevNumSlots );
 
-        Node **nodesPtr = reinterpret_cast<Node**>( mMemoryPools[Parent] ) + prevNumSlots;
-        MovableObject **ownersPtr = reinterpret_cast<MovableObject**>(mMemoryPools[Owner])+prevNumSlots;
+        ObjectData::NodeRef *nodesPtr =
+                reinterpret_cast<ObjectData::NodeRef*>( mMemoryPools[Parent] ) + prevNumSlots;
+        ObjectData::MovableObjectRef *ownersPtr =
+                reinterpret_cast<ObjectData::MovableObjectRef*>( mMemoryPools[Owner] ) + prevNumSlots;
         for( size_t i=prevNumSlots; i<mMaxMemory; ++i )
         {
             *nodesPtr++ = mDummyNode;
@@ -101,9 +109,11 @@ namespace Ogre
 
         //Set memory ptrs
         outData.mIndex = nextSlotIdx;
-        outData.mParents            = reinterpret_cast<Node**>( mMemoryPools[Parent] +
+        outData.mParents            = reinterpret_cast<ObjectData::NodeRef*>(
+                                                mMemoryPools[Parent] +
                                                 nextSlotBase * mElementsMemSizes[Parent] );
-        outData.mOwner              = reinterpret_cast<MovableObject**>( mMemoryPools[Owner] +
+        outData.mOwner              = reinterpret_cast<ObjectData::MovableObjectRef*>(
+                                                mMemoryPools[Owner] +
                                                 nextSlotBase * mElementsMemSizes[Owner] );
         outData.mLocalAabb          = reinterpret_cast<ArrayAabb*>( mMemoryPools[LocalAabb] +
                                                 nextSlotBase * mElementsMemSizes[LocalAabb] );
@@ -125,6 +135,12 @@ namespace Ogre
                                                 nextSlotBase * mElementsMemSizes[QueryFlags] );
         outData.mLightMask          = reinterpret_cast<uint32*>( mMemoryPools[LightMask] +
                                                 nextSlotBase * mElementsMemSizes[LightMask] );
+        outData.mLodRangeMin        = reinterpret_cast<Real*>( mMemoryPools[LodRangeMin] +
+                                                nextSlotBase * mElementsMemSizes[LodRangeMin] );
+        outData.mLodRangeMax        = reinterpret_cast<Real*>( mMemoryPools[LodRangeMax] +
+                                                nextSlotBase * mElementsMemSizes[LodRangeMax] );
+        outData.mBoundsDirty        = reinterpret_cast<uint8*>( mMemoryPools[BoundsDirty] +
+                                                nextSlotBase * mElementsMemSizes[BoundsDirty] );
 
         //Set default values
         outData.mParents[nextSlotIdx]   = mDummyNode;
@@ -139,6 +155,8 @@ namespace Ogre
         outData.mVisibilityFlags[nextSlotIdx]       = MovableObject::getDefaultVisibilityFlags();
         outData.mQueryFlags[nextSlotIdx]            = MovableObject::getDefaultQueryFlags();
         outData.mLightMask[nextSlotIdx]             = MovableObject::getDefaultLightMask();
+        outData.invalidateLodRange();
+        outData.invalidateBounds();
     }
     //-----------------------------------------------------------------------------------
     void ObjectDataArrayMemoryManager::destroyNode( ObjectData &inOutData )
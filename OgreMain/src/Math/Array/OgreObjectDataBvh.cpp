@@ -0,0 +1,397 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Math/Array/OgreObjectDataBvh.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+#include "Math/Array/OgreBooleanMask.h"
+#include "Math/Array/OgreArrayRay.h"
+#include "OgreRay.h"
+#include "OgreCamera.h"
+
+namespace Ogre
+{
+    struct PackInfoCenterLess
+    {
+        int axis;
+        PackInfoCenterLess( int _axis ) : axis( _axis ) {}
+
+        template <typename T>
+        bool operator () ( const T &a, const T &b ) const
+        {
+            return a.bounds.mCenter[axis] < b.bounds.mCenter[axis];
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    ObjectDataBvh::ObjectDataBvh() :
+        mNodes( 0 ),
+        mNumNodes( 0 ),
+        mNodeCapacity( 0 ),
+        mBuildGeneration( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    ObjectDataBvh::~ObjectDataBvh()
+    {
+        if( mNodes )
+        {
+            OGRE_FREE_SIMD( mNodes, MEMCATEGORY_SCENE_CONTROL );
+            mNodes = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::reserveNodes( size_t numNodes )
+    {
+        if( numNodes > mNodeCapacity )
+        {
+            if( mNodes )
+                OGRE_FREE_SIMD( mNodes, MEMCATEGORY_SCENE_CONTROL );
+            mNodes = reinterpret_cast<Node*>( OGRE_MALLOC_SIMD( numNodes * sizeof(Node),
+                                                                MEMCATEGORY_SCENE_CONTROL ) );
+            mNodeCapacity = numNodes;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::sortAlongLongestAxis( PackInfo *packs, size_t numPacks )
+    {
+        Vector3 minCenter( packs[0].bounds.mCenter );
+        Vector3 maxCenter( packs[0].bounds.mCenter );
+        for( size_t i=1; i<numPacks; ++i )
+        {
+            minCenter.makeFloor( packs[i].bounds.mCenter );
+            maxCenter.makeCeil( packs[i].bounds.mCenter );
+        }
+
+        const Vector3 extents = maxCenter - minCenter;
+        int axis = 0;
+        if( extents.y > extents[axis] )
+            axis = 1;
+        if( extents.z > extents[axis] )
+            axis = 2;
+
+        std::sort( packs, packs + numPacks, PackInfoCenterLess( axis ) );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 ObjectDataBvh::buildNode( PackInfo *packs, size_t numPacks )
+    {
+        assert( mNumNodes < mNodeCapacity );
+
+        const uint32 nodeIdx = static_cast<uint32>( mNumNodes++ );
+
+        uint32 children[c_branching];
+        Aabb childBounds[c_branching];
+        size_t numChildren = 0;
+
+        if( numPacks <= c_branching )
+        {
+            for( size_t i=0; i<numPacks; ++i )
+            {
+                children[i]     = packs[i].packIdx | c_leafBit;
+                childBounds[i]  = packs[i].bounds;
+            }
+            numChildren = numPacks;
+        }
+        else
+        {
+            //Split in c_branching groups of (nearly) equal size
+            sortAlongLongestAxis( packs, numPacks );
+
+            size_t start = 0;
+            for( size_t i=0; i<c_branching; ++i )
+            {
+                const size_t end = ((i + 1u) * numPacks) / c_branching;
+                const size_t numInGroup = end - start;
+
+                if( numInGroup == 1u )
+                {
+                    children[numChildren]       = packs[start].packIdx | c_leafBit;
+                    childBounds[numChildren]    = packs[start].bounds;
+                    ++numChildren;
+                }
+                else if( numInGroup > 1u )
+                {
+                    Aabb bounds = packs[start].bounds;
+                    for( size_t j=start + 1u; j<end; ++j )
+                        bounds.merge( packs[j].bounds );
+
+                    children[numChildren]       = buildNode( packs + start, numInGroup );
+                    childBounds[numChildren]    = bounds;
+                    ++numChildren;
+                }
+
+                start = end;
+            }
+        }
+
+        //mNodes may not be reallocated during the build (we reserved in advance)
+        Node &node = mNodes[nodeIdx];
+        node.numChildren = static_cast<uint32>( numChildren );
+        for( size_t i=0; i<c_branching; ++i )
+        {
+            const bool bUsed = i < numChildren;
+            node.children[i] = bUsed ? children[i] : 0;
+            node.childBounds[i / ARRAY_PACKED_REALS].setFromAabb( bUsed ? childBounds[i] :
+                                                                          Aabb::BOX_ZERO,
+                                                                  i % ARRAY_PACKED_REALS );
+        }
+
+        return nodeIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::buildSubtrees( PackInfo *packs, size_t numPacks, size_t maxPacksPerSubtree )
+    {
+        if( numPacks <= maxPacksPerSubtree )
+        {
+            mSubtreeRoots.push_back( buildNode( packs, numPacks ) );
+        }
+        else
+        {
+            sortAlongLongestAxis( packs, numPacks );
+            const size_t half = numPacks >> 1u;
+            buildSubtrees( packs, half, maxPacksPerSubtree );
+            buildSubtrees( packs + half, numPacks - half, maxPacksPerSubtree );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::build( ObjectMemoryManager *memoryManager, size_t renderQueue,
+                               size_t maxPacksPerSubtree, uint32 generation )
+    {
+        mBuildGeneration = generation;
+        mNumNodes = 0;
+        mSubtreeRoots.clear();
+
+        ObjectData objData;
+        const size_t numObjs = memoryManager->getFirstObjectData( objData, renderQueue );
+        const size_t numPacks = (numObjs + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS;
+
+        PackInfoArray packs;
+        packs.reserve( numPacks );
+
+        for( size_t i=0; i<numPacks; ++i )
+        {
+            PackInfo packInfo;
+            packInfo.packIdx = static_cast<uint32>( i );
+            bool bEmpty = true;
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                //Removed slots have their visibility flags set to 0
+                if( !objData.mOwner[j] || !objData.mVisibilityFlags[j] )
+                    continue;
+
+                const Aabb aabb = objData.mWorldAabb->getAsAabb( j );
+                if( bEmpty )
+                    packInfo.bounds = aabb;
+                else
+                    packInfo.bounds.merge( aabb );
+                bEmpty = false;
+            }
+
+            //Empty packs can't contain anything visible
+            if( !bEmpty )
+                packs.push_back( packInfo );
+
+            objData.advancePack();
+        }
+
+        if( packs.empty() )
+            return;
+
+        //A tree where every node has at least 2 children has less nodes than leaves
+        reserveNodes( packs.size() );
+        buildSubtrees( packs.begin(), packs.size(), std::max<size_t>( maxPacksPerSubtree, 1u ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::cullSubtree( size_t subtreeIdx, const Camera *frustum,
+                                     FastArray<uint32> &outPacks ) const
+    {
+        //Same test as in MovableObject::cullFrustum
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+
+        ArrayPlane planes[6];
+        const Plane *frustumPlanes = frustum->_getCachedFrustumPlanes();
+
+        for( size_t i=0; i<6; ++i )
+        {
+            planes[i].planeNormal.setAll( frustumPlanes[i].normal );
+            planes[i].signFlip.setAll( frustumPlanes[i].normal );
+            planes[i].signFlip.setToSign();
+            planes[i].planeNegD = Mathlib::SetAll( -frustumPlanes[i].d );
+        }
+
+        const size_t firstPack = outPacks.size();
+
+        uint32 stack[64];
+        size_t stackSize = 0;
+        stack[stackSize++] = mSubtreeRoots[subtreeIdx];
+
+        while( stackSize > 0 )
+        {
+            const Node &node = mNodes[stack[--stackSize]];
+
+            for( size_t i=0; i<c_numArrayAabbsPerNode; ++i )
+            {
+                const ArrayAabb &bounds = node.childBounds[i];
+
+                ArrayMaskR mask = BooleanMask4::getAllSetMask();
+                for( size_t j=0; j<6; ++j )
+                {
+                    ArrayVector3 centerPlusFlippedHS = bounds.mCenter + bounds.mHalfSize *
+                                                                        planes[j].signFlip;
+                    ArrayReal dotResult = planes[j].planeNormal.dotProduct( centerPlusFlippedHS );
+                    mask = Mathlib::And( mask, Mathlib::CompareGreater( dotResult,
+                                                                        planes[j].planeNegD ) );
+                }
+
+                //Always pass the test if any of the components were
+                //Infinity (dot product above could've caused nans)
+                ArrayMaskR infMask = Mathlib::Or(
+                                Mathlib::isInfinity( bounds.mHalfSize.mChunkBase[0] ),
+                                Mathlib::isInfinity( bounds.mHalfSize.mChunkBase[1] ) );
+                infMask = Mathlib::Or( Mathlib::isInfinity( bounds.mHalfSize.mChunkBase[2] ),
+                                       infMask );
+                mask = Mathlib::Or( mask, infMask );
+
+                const uint32 scalarMask = BooleanMask4::getScalarMask( mask );
+
+                for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                {
+                    const size_t childIdx = i * ARRAY_PACKED_REALS + j;
+                    if( childIdx < node.numChildren && IS_BIT_SET( j, scalarMask ) )
+                    {
+                        const uint32 child = node.children[childIdx];
+                        if( child & c_leafBit )
+                        {
+                            outPacks.push_back( child & ~c_leafBit );
+                        }
+                        else
+                        {
+                            assert( stackSize < 64u && "BVH too deep" );
+                            stack[stackSize++] = child;
+                        }
+                    }
+                }
+            }
+        }
+
+        std::sort( outPacks.begin() + firstPack, outPacks.end() );
+    }
+    //-----------------------------------------------------------------------------------
+    struct BvhAabbTest
+    {
+        ArrayAabb volume;
+
+        BvhAabbTest( const Aabb &_volume ) : volume( ArrayVector3::ZERO, ArrayVector3::ZERO )
+        {
+            volume.setAll( _volume );
+        }
+
+        ArrayMaskR operator () ( const ArrayAabb &bounds ) const
+        {
+            return volume.intersects( bounds );
+        }
+    };
+
+    struct BvhRayTest
+    {
+        ArrayRay ray;
+
+        BvhRayTest( const Ray &_ray )
+        {
+            ray.mOrigin.setAll( _ray.getOrigin() );
+            ray.mDirection.setAll( _ray.getDirection() );
+        }
+
+        ArrayMaskR operator () ( const ArrayAabb &bounds ) const
+        {
+            return ray.intersects( bounds );
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    template <typename T>
+    void ObjectDataBvh::findPacksImpl( const T &test, FastArray<uint32> &outPacks ) const
+    {
+        const size_t firstPack = outPacks.size();
+
+        uint32 stack[64];
+
+        const size_t numSubtrees = mSubtreeRoots.size();
+        for( size_t subtreeIdx=0; subtreeIdx<numSubtrees; ++subtreeIdx )
+        {
+            size_t stackSize = 0;
+            stack[stackSize++] = mSubtreeRoots[subtreeIdx];
+
+            while( stackSize > 0 )
+            {
+                const Node &node = mNodes[stack[--stackSize]];
+
+                for( size_t i=0; i<c_numArrayAabbsPerNode; ++i )
+                {
+                    const uint32 scalarMask =
+                            BooleanMask4::getScalarMask( test( node.childBounds[i] ) );
+
+                    for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                    {
+                        const size_t childIdx = i * ARRAY_PACKED_REALS + j;
+                        if( childIdx < node.numChildren && IS_BIT_SET( j, scalarMask ) )
+                        {
+                            const uint32 child = node.children[childIdx];
+                            if( child & c_leafBit )
+                            {
+                                outPacks.push_back( child & ~c_leafBit );
+                            }
+                            else
+                            {
+                                assert( stackSize < 64u && "BVH too deep" );
+                                stack[stackSize++] = child;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        std::sort( outPacks.begin() + firstPack, outPacks.end() );
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::findPacks( const Aabb &volume, FastArray<uint32> &outPacks ) const
+    {
+        findPacksImpl( BvhAabbTest( volume ), outPacks );
+    }
+    //-----------------------------------------------------------------------------------
+    void ObjectDataBvh::findPacks( const Ray &ray, FastArray<uint32> &outPacks ) const
+    {
+        findPacksImpl( BvhRayTest( ray ), outPacks );
+    }
+}
@@ -36,6 +36,7 @@ namespace Ogre
 {
     ObjectMemoryManager::ObjectMemoryManager() :
             mTotalObjects( 0 ),
+            mGeneration( 0 ),
             mDummyNode( 0 ),
             mDummyObject( 0 ),
             mMemoryManagerType( SCENE_DYNAMIC ),
@@ -135,6 +136,7 @@ namespace Ogre
         mgr.createNewNode( outObjectData );
 
         ++mTotalObjects;
+        ++mGeneration;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::objectMoved( ObjectData &inOutObjectData, size_t oldRenderQueue,
@@ -151,6 +153,7 @@ namespace Ogre
         mgr.destroyNode( inOutObjectData );
 
         inOutObjectData = tmp;
+        ++mGeneration;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::objectDestroyed( ObjectData &outObjectData, size_t renderQueue )
@@ -159,6 +162,7 @@ namespace Ogre
         mgr.destroyNode( outObjectData );
 
         --mTotalObjects;
+        ++mGeneration;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::migrateTo( ObjectData &inOutObjectData, size_t renderQueue,
@@ -181,6 +185,8 @@ namespace Ogre
             itor->defragment();
             ++itor;
         }
+
+        ++mGeneration;
     }
     //-----------------------------------------------------------------------------------
     void ObjectMemoryManager::shrinkToFit(void)
@@ -193,6 +199,41 @@ namespace Ogre
             itor->shrinkToFit();
             ++itor;
         }
+
+        ++mGeneration;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ObjectMemoryManager::defragmentIncremental(
+            ArrayMemoryManager::DefragmentBudget &inOutBudget )
+    {
+        bool closedHoles = false;
+
+        ArrayMemoryManagerVec::iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::iterator end  = mMemoryManagers.end();
+
+        while( itor != end && !inOutBudget.isExhausted() )
+        {
+            closedHoles |= itor->defragmentIncremental( inOutBudget );
+            ++itor;
+        }
+
+        return closedHoles;
+    }
+    //-----------------------------------------------------------------------------------
+    ArrayMemoryManager::FragmentationStats ObjectMemoryManager::getFragmentationStats(void) const
+    {
+        ArrayMemoryManager::FragmentationStats retVal;
+
+        ArrayMemoryManagerVec::const_iterator itor = mMemoryManagers.begin();
+        ArrayMemoryManagerVec::const_iterator end  = mMemoryManagers.end();
+
+        while( itor != end )
+        {
+            itor->addFragmentationStats( retVal );
+            ++itor;
+        }
+
+        return retVal;
     }
     //-----------------------------------------------------------------------------------
     size_t ObjectMemoryManager::getNumRenderQueues() const
@@ -258,6 +299,8 @@ namespace Ogre
     void ObjectMemoryManager::applyRebase( uint16 level, const MemoryPoolVec &newBasePtrs,
                                            const ArrayMemoryManager::PtrdiffVec &diffsList )
     {
+        ++mGeneration;
+
         ObjectData objectData;
         const size_t numObjs = this->getFirstObjectData( objectData, level );
 
@@ -280,6 +323,8 @@ namespace Ogre
                                               size_t const *elementsMemSizes,
                                               size_t startInstance, size_t diffInstances )
     {
+        ++mGeneration;
+
         ObjectData objectData;
         const size_t numObjs = this->getFirstObjectData( objectData, level );
 
@@ -0,0 +1,791 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreAccelerationStructure.h"
+
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreSubMesh2.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreException.h"
+
+#include "Math/Simple/OgreAabb.h"
+
+#include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    static const uint32 c_maxTrisPerBlasLeaf = 4u;
+    static const uint32 c_maxInstancesPerTlasLeaf = 1u;
+    /// Median splits keep the trees balanced, their depth is at most log2( numPrims ) + 1
+    static const size_t c_maxBvhDepth = 64u;
+
+    struct BvhCentroidCompare
+    {
+        const Vector3 *centroids;
+        size_t axis;
+
+        BvhCentroidCompare( const Vector3 *_centroids, size_t _axis ) :
+            centroids( _centroids ), axis( _axis ) {}
+
+        bool operator () ( uint32 _l, uint32 _r ) const
+        {
+            return centroids[_l][axis] < centroids[_r][axis];
+        }
+    };
+
+    static inline bool slabTest( const AccelerationStructure::BvhNode &node,
+                                 const Vector3 &rayOrigin, const Vector3 &invRayDir,
+                                 Real maxDistance )
+    {
+        const Vector3 t0 = (node.aabbMin - rayOrigin) * invRayDir;
+        const Vector3 t1 = (node.aabbMax - rayOrigin) * invRayDir;
+        const Real tNear = std::max( std::max( std::min( t0.x, t1.x ), std::min( t0.y, t1.y ) ),
+                                     std::max( std::min( t0.z, t1.z ), Real( 0 ) ) );
+        const Real tFar = std::min( std::min( std::max( t0.x, t1.x ), std::max( t0.y, t1.y ) ),
+                                    std::min( std::max( t0.z, t1.z ), maxDistance ) );
+        return tNear <= tFar;
+    }
+
+    static inline void pushGpuRow( FastArray<float> &outData, const Vector3 &xyz, uint32 w )
+    {
+        float wAsFloat;
+        memcpy( &wAsFloat, &w, sizeof(float) );
+        outData.push_back( static_cast<float>( xyz.x ) );
+        outData.push_back( static_cast<float>( xyz.y ) );
+        outData.push_back( static_cast<float>( xyz.z ) );
+        outData.push_back( wAsFloat );
+    }
+
+    static void pushGpuNodes( FastArray<float> &outData,
+                              const AccelerationStructure::BvhNodeArray &nodes,
+                              uint32 nodeOffset, uint32 primOffset )
+    {
+        AccelerationStructure::BvhNodeArray::const_iterator itor = nodes.begin();
+        AccelerationStructure::BvhNodeArray::const_iterator end  = nodes.end();
+        while( itor != end )
+        {
+            const uint32 firstChildOrPrim = itor->firstChildOrPrim +
+                                            (itor->numPrims ? primOffset : nodeOffset);
+            pushGpuRow( outData, itor->aabbMin, firstChildOrPrim );
+            pushGpuRow( outData, itor->aabbMax, itor->numPrims );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    AccelerationStructure::AccelerationStructure( VaoManager *vaoManager ) :
+        mTlasNeedsRebuild( false ),
+        mBlasChanged( false ),
+        mVaoManager( vaoManager ),
+        mGpuBuffersEnabled( false ),
+        mTlasNodesBuffer( 0 ),
+        mInstancesBuffer( 0 ),
+        mBlasNodesBuffer( 0 ),
+        mTrianglesBuffer( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    AccelerationStructure::~AccelerationStructure()
+    {
+        removeAllItems();
+        destroyGpuBuffers();
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::buildBvh( BvhNodeArray &outNodes, FastArray<uint32> &inOutPrims,
+                                          const Vector3 *primMin, const Vector3 *primMax,
+                                          const Vector3 *centroids, uint32 maxPrimsPerLeaf )
+    {
+        outNodes.clear();
+
+        const uint32 numPrims = static_cast<uint32>( inOutPrims.size() );
+        if( !numPrims )
+            return;
+
+        //A binary tree with up to numPrims leaves can't have more than numPrims * 2 - 1 nodes
+        outNodes.resize( numPrims * 2u - 1u );
+        uint32 numNodes = 1u;
+        buildBvhNode( outNodes.begin(), numNodes, inOutPrims.begin(), primMin, primMax,
+                      centroids, 0, 0, numPrims, maxPrimsPerLeaf );
+        outNodes.resize( numNodes );
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::buildBvhNode( BvhNode *nodes, uint32 &inOutNumNodes,
+                                              uint32 *prims, const Vector3 *primMin,
+                                              const Vector3 *primMax, const Vector3 *centroids,
+                                              uint32 nodeIdx, uint32 primStart, uint32 numPrims,
+                                              uint32 maxPrimsPerLeaf )
+    {
+        BvhNode &node = nodes[nodeIdx];
+
+        node.aabbMin = Vector3( std::numeric_limits<Real>::max() );
+        node.aabbMax = -node.aabbMin;
+        Vector3 centroidMin = node.aabbMin;
+        Vector3 centroidMax = node.aabbMax;
+
+        for( uint32 i=primStart; i<primStart + numPrims; ++i )
+        {
+            node.aabbMin.makeFloor( primMin[prims[i]] );
+            node.aabbMax.makeCeil( primMax[prims[i]] );
+            centroidMin.makeFloor( centroids[prims[i]] );
+            centroidMax.makeCeil( centroids[prims[i]] );
+        }
+
+        const Vector3 centroidExtent = centroidMax - centroidMin;
+
+        size_t splitAxis = 0;
+        if( centroidExtent.y > centroidExtent[splitAxis] )
+            splitAxis = 1u;
+        if( centroidExtent.z > centroidExtent[splitAxis] )
+            splitAxis = 2u;
+
+        if( numPrims <= maxPrimsPerLeaf || centroidExtent[splitAxis] <= Real( 0 ) )
+        {
+            node.firstChildOrPrim = primStart;
+            node.numPrims = numPrims;
+            return;
+        }
+
+        //Split in half at the median centroid along the longest axis
+        const uint32 numLeftPrims = numPrims >> 1u;
+        uint32 *primsBegin = prims + primStart;
+        std::nth_element( primsBegin, primsBegin + numLeftPrims, primsBegin + numPrims,
+                          BvhCentroidCompare( centroids, splitAxis ) );
+
+        //Children always come after their parent. refitTlas relies on it.
+        const uint32 childIdx = inOutNumNodes;
+        inOutNumNodes += 2u;
+
+        node.firstChildOrPrim = childIdx;
+        node.numPrims = 0;
+
+        buildBvhNode( nodes, inOutNumNodes, prims, primMin, primMax, centroids, childIdx,
+                      primStart, numLeftPrims, maxPrimsPerLeaf );
+        buildBvhNode( nodes, inOutNumNodes, prims, primMin, primMax, centroids, childIdx + 1u,
+                      primStart + numLeftPrims, numPrims - numLeftPrims, maxPrimsPerLeaf );
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::buildBlas( Blas &blas )
+    {
+        FastArray<Vector3> triVerts;
+        FastArray<uint16> triSubMesh;
+
+        vector<Vector3>::type positions;
+        vector<uint32>::type indices;
+
+        const uint16 numSubMeshes = blas.mesh->getNumSubMeshes();
+        for( uint16 subMeshIdx=0; subMeshIdx<numSubMeshes; ++subMeshIdx )
+        {
+            blas.mesh->getSubMesh( subMeshIdx )->readTriangleList( positions, indices );
+
+            const size_t numIndices = indices.size();
+            for( size_t i=0; i<numIndices; i += 3u )
+            {
+                triVerts.push_back( positions[indices[i + 0u]] );
+                triVerts.push_back( positions[indices[i + 1u]] );
+                triVerts.push_back( positions[indices[i + 2u]] );
+                triSubMesh.push_back( subMeshIdx );
+            }
+        }
+
+        const uint32 numTris = static_cast<uint32>( triSubMesh.size() );
+
+        FastArray<Vector3> triMin;
+        FastArray<Vector3> triMax;
+        FastArray<Vector3> centroids;
+        FastArray<uint32> prims;
+        triMin.resize( numTris );
+        triMax.resize( numTris );
+        centroids.resize( numTris );
+        prims.resize( numTris );
+
+        for( uint32 i=0; i<numTris; ++i )
+        {
+            const Vector3 *v = &triVerts[i * 3u];
+            triMin[i] = v[0];
+            triMin[i].makeFloor( v[1] );
+            triMin[i].makeFloor( v[2] );
+            triMax[i] = v[0];
+            triMax[i].makeCeil( v[1] );
+            triMax[i].makeCeil( v[2] );
+            centroids[i] = (v[0] + v[1] + v[2]) / Real( 3.0 );
+            prims[i] = i;
+        }
+
+        buildBvh( blas.nodes, prims, triMin.begin(), triMax.begin(), centroids.begin(),
+                  c_maxTrisPerBlasLeaf );
+
+        //Store the triangles in the order the leaves reference them
+        blas.triVerts.resize( numTris * 3u );
+        blas.triSubMesh.resize( numTris );
+        for( uint32 i=0; i<numTris; ++i )
+        {
+            blas.triVerts[i * 3u + 0u] = triVerts[prims[i] * 3u + 0u];
+            blas.triVerts[i * 3u + 1u] = triVerts[prims[i] * 3u + 1u];
+            blas.triVerts[i * 3u + 2u] = triVerts[prims[i] * 3u + 2u];
+            blas.triSubMesh[i] = triSubMesh[prims[i]];
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 AccelerationStructure::acquireBlas( const MeshPtr &mesh )
+    {
+        MeshToBlasMap::const_iterator itor = mMeshToBlas.find( mesh.get() );
+        if( itor != mMeshToBlas.end() )
+        {
+            ++mBlas[itor->second]->refCount;
+            return itor->second;
+        }
+
+        Blas *blas = OGRE_NEW_T( Blas, MEMCATEGORY_SCENE_OBJECTS )();
+        blas->mesh = mesh;
+        blas->refCount = 1u;
+        blas->gpuNodeStart = 0;
+        blas->gpuTriStart = 0;
+        buildBlas( *blas );
+
+        //Reuse slots from BLAS that were released
+        BlasArray::iterator itSlot = std::find( mBlas.begin(), mBlas.end(),
+                                                static_cast<Blas*>( 0 ) );
+        uint32 blasIdx = static_cast<uint32>( itSlot - mBlas.begin() );
+        if( itSlot == mBlas.end() )
+            mBlas.push_back( blas );
+        else
+            *itSlot = blas;
+
+        mMeshToBlas[mesh.get()] = blasIdx;
+        mBlasChanged = true;
+
+        return blasIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::releaseBlas( uint32 blasIdx )
+    {
+        Blas *blas = mBlas[blasIdx];
+        assert( blas->refCount > 0u );
+        if( --blas->refCount == 0u )
+        {
+            mMeshToBlas.erase( blas->mesh.get() );
+            OGRE_DELETE_T( blas, Blas, MEMCATEGORY_SCENE_OBJECTS );
+            mBlas[blasIdx] = 0;
+            mBlasChanged = true;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::addItem( Item *item )
+    {
+        InstanceArray::const_iterator itor = mInstances.begin();
+        InstanceArray::const_iterator end  = mInstances.end();
+        while( itor != end && itor->item != item )
+            ++itor;
+
+        if( itor != end )
+            return;
+
+        Instance instance;
+        instance.item               = item;
+        instance.blasIdx            = acquireBlas( item->getMesh() );
+        instance.visibilityFlags    = item->getVisibilityFlags();
+        instance.worldMatrix        = Matrix4::ZERO;
+        instance.invWorldMatrix     = Matrix4::ZERO;
+        //Empty bounds until the first update
+        instance.aabbMin            = Vector3( std::numeric_limits<Real>::max() );
+        instance.aabbMax            = -instance.aabbMin;
+        mInstances.push_back( instance );
+
+        mTlasNeedsRebuild = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::removeItem( Item *item )
+    {
+        InstanceArray::iterator itor = mInstances.begin();
+        InstanceArray::iterator end  = mInstances.end();
+        while( itor != end && itor->item != item )
+            ++itor;
+
+        if( itor == end )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Item '" + item->getName() + "' was never added",
+                         "AccelerationStructure::removeItem" );
+        }
+
+        releaseBlas( itor->blasIdx );
+        efficientVectorRemove( mInstances, itor );
+        mTlasNeedsRebuild = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::removeAllItems(void)
+    {
+        BlasArray::const_iterator itor = mBlas.begin();
+        BlasArray::const_iterator end  = mBlas.end();
+        while( itor != end )
+        {
+            if( *itor )
+                OGRE_DELETE_T( *itor, Blas, MEMCATEGORY_SCENE_OBJECTS );
+            ++itor;
+        }
+
+        mBlas.clear();
+        mMeshToBlas.clear();
+        mInstances.clear();
+        mTlasNodes.clear();
+        mTlasInstances.clear();
+
+        mTlasNeedsRebuild = false;
+        mBlasChanged = true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool AccelerationStructure::updateInstance( Instance &instance, const Blas &blas )
+    {
+        instance.visibilityFlags = instance.item->getVisibilityFlags();
+
+        const Node *parentNode = instance.item->getParentNode();
+        const bool wasEmpty = instance.aabbMin.x > instance.aabbMax.x;
+
+        if( !parentNode || blas.nodes.empty() )
+        {
+            //Detached Items (or meshes without triangles) can't be hit
+            instance.aabbMin = Vector3( std::numeric_limits<Real>::max() );
+            instance.aabbMax = -instance.aabbMin;
+            return !wasEmpty;
+        }
+
+        const Matrix4 &worldMatrix = parentNode->_getFullTransform();
+        if( !wasEmpty && worldMatrix == instance.worldMatrix )
+            return false;
+
+        instance.worldMatrix    = worldMatrix;
+        instance.invWorldMatrix = worldMatrix.inverseAffine();
+
+        Aabb aabb = Aabb::newFromExtents( blas.nodes[0].aabbMin, blas.nodes[0].aabbMax );
+        aabb.transformAffine( worldMatrix );
+        instance.aabbMin = aabb.getMinimum();
+        instance.aabbMax = aabb.getMaximum();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::rebuildTlas(void)
+    {
+        const size_t numInstances = mInstances.size();
+
+        FastArray<Vector3> centroids;
+        centroids.resize( numInstances );
+
+        //Instances with empty bounds are left out. Once they get bounds, the TLAS is rebuilt.
+        mTlasInstances.clear();
+        for( size_t i=0; i<numInstances; ++i )
+        {
+            const Instance &instance = mInstances[i];
+            if( instance.aabbMin.x <= instance.aabbMax.x )
+            {
+                centroids[i] = (instance.aabbMin + instance.aabbMax) * Real( 0.5 );
+                mTlasInstances.push_back( static_cast<uint32>( i ) );
+            }
+        }
+
+        FastArray<Vector3> instMin;
+        FastArray<Vector3> instMax;
+        instMin.resize( numInstances );
+        instMax.resize( numInstances );
+        for( size_t i=0; i<numInstances; ++i )
+        {
+            instMin[i] = mInstances[i].aabbMin;
+            instMax[i] = mInstances[i].aabbMax;
+        }
+
+        buildBvh( mTlasNodes, mTlasInstances, instMin.begin(), instMax.begin(),
+                  centroids.begin(), c_maxInstancesPerTlasLeaf );
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::refitTlas(void)
+    {
+        //Children are always after their parents, so walking backwards
+        //guarantees children are refitted before their parents.
+        BvhNodeArray::iterator begin = mTlasNodes.begin();
+        BvhNodeArray::iterator itor  = mTlasNodes.end();
+        while( itor != begin )
+        {
+            --itor;
+            BvhNode &node = *itor;
+            if( node.numPrims )
+            {
+                node.aabbMin = Vector3( std::numeric_limits<Real>::max() );
+                node.aabbMax = -node.aabbMin;
+                for( uint32 i=0; i<node.numPrims; ++i )
+                {
+                    const Instance &instance =
+                            mInstances[mTlasInstances[node.firstChildOrPrim + i]];
+                    node.aabbMin.makeFloor( instance.aabbMin );
+                    node.aabbMax.makeCeil( instance.aabbMax );
+                }
+            }
+            else
+            {
+                const BvhNode &left  = mTlasNodes[node.firstChildOrPrim];
+                const BvhNode &right = mTlasNodes[node.firstChildOrPrim + 1u];
+                node.aabbMin = left.aabbMin;
+                node.aabbMin.makeFloor( right.aabbMin );
+                node.aabbMax = left.aabbMax;
+                node.aabbMax.makeCeil( right.aabbMax );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::update(void)
+    {
+        bool anyMoved = false;
+
+        InstanceArray::iterator itor = mInstances.begin();
+        InstanceArray::iterator end  = mInstances.end();
+        while( itor != end )
+        {
+            const bool wasEmpty = itor->aabbMin.x > itor->aabbMax.x;
+            if( updateInstance( *itor, *mBlas[itor->blasIdx] ) )
+            {
+                anyMoved = true;
+                //Instances entering or leaving the TLAS need a rebuild, refitting isn't enough
+                if( wasEmpty != (itor->aabbMin.x > itor->aabbMax.x) )
+                    mTlasNeedsRebuild = true;
+            }
+            ++itor;
+        }
+
+        if( mTlasNeedsRebuild )
+            rebuildTlas();
+        else if( anyMoved )
+            refitTlas();
+
+        if( mGpuBuffersEnabled )
+        {
+            //Visibility flags may have changed too, so the TLAS is always re-uploaded.
+            //BLAS are only uploaded when Meshes are added or removed.
+            if( mBlasChanged )
+                uploadBlasToGpu();
+            uploadTlasToGpu();
+        }
+
+        mTlasNeedsRebuild = false;
+        mBlasChanged = false;
+    }
+    //-----------------------------------------------------------------------------------
+    bool AccelerationStructure::raycastBlas( const Blas &blas, const Ray &localRay, bool anyHit,
+                                             Real &inOutDistance, uint32 &outTriIdx )
+    {
+        const Vector3 &rayOrigin = localRay.getOrigin();
+        const Vector3 &rayDir = localRay.getDirection();
+        const Vector3 invRayDir( Real( 1.0 ) / rayDir.x,
+                                 Real( 1.0 ) / rayDir.y,
+                                 Real( 1.0 ) / rayDir.z );
+
+        bool hit = false;
+
+        uint32 nodeStack[c_maxBvhDepth];
+        size_t stackSize = 1u;
+        nodeStack[0] = 0;
+
+        while( stackSize )
+        {
+            const BvhNode &node = blas.nodes[nodeStack[--stackSize]];
+
+            if( !slabTest( node, rayOrigin, invRayDir, inOutDistance ) )
+                continue;
+
+            if( node.numPrims )
+            {
+                for( uint32 i=0; i<node.numPrims; ++i )
+                {
+                    const uint32 triIdx = node.firstChildOrPrim + i;
+                    const Vector3 *v = &blas.triVerts[triIdx * 3u];
+
+                    const std::pair<bool, Real> inters = Math::intersects( localRay, v[0], v[1],
+                                                                           v[2], true, true );
+                    if( inters.first && inters.second < inOutDistance )
+                    {
+                        inOutDistance = inters.second;
+                        outTriIdx = triIdx;
+                        hit = true;
+                        if( anyHit )
+                            return true;
+                    }
+                }
+            }
+            else
+            {
+                assert( stackSize + 2u <= c_maxBvhDepth );
+                nodeStack[stackSize++] = node.firstChildOrPrim;
+                nodeStack[stackSize++] = node.firstChildOrPrim + 1u;
+            }
+        }
+
+        return hit;
+    }
+    //-----------------------------------------------------------------------------------
+    bool AccelerationStructure::raycastImpl( const Ray &ray, Real maxDistance,
+                                             uint32 visibilityMask, bool anyHit,
+                                             RayHit *outHit ) const
+    {
+        if( mTlasNodes.empty() )
+            return false;
+
+        const Vector3 &rayOrigin = ray.getOrigin();
+        const Vector3 &rayDir = ray.getDirection();
+        const Vector3 invRayDir( Real( 1.0 ) / rayDir.x,
+                                 Real( 1.0 ) / rayDir.y,
+                                 Real( 1.0 ) / rayDir.z );
+
+        Real closestDistance = maxDistance;
+        const Instance *closestInstance = 0;
+        uint32 closestTri = 0;
+
+        uint32 nodeStack[c_maxBvhDepth];
+        size_t stackSize = 1u;
+        nodeStack[0] = 0;
+
+        while( stackSize )
+        {
+            const BvhNode &node = mTlasNodes[nodeStack[--stackSize]];
+
+            if( !slabTest( node, rayOrigin, invRayDir, closestDistance ) )
+                continue;
+
+            if( node.numPrims )
+            {
+                for( uint32 i=0; i<node.numPrims; ++i )
+                {
+                    const Instance &instance =
+                            mInstances[mTlasInstances[node.firstChildOrPrim + i]];
+                    if( !(instance.visibilityFlags & visibilityMask) )
+                        continue;
+
+                    //The BLAS is in mesh space, so we bring the ray there. The direction
+                    //is not normalised so that distances stay in world units.
+                    const Ray localRay(
+                                instance.invWorldMatrix.transformAffine( rayOrigin ),
+                                instance.invWorldMatrix.transformDirectionAffine( rayDir ) );
+
+                    uint32 triIdx = 0;
+                    if( raycastBlas( *mBlas[instance.blasIdx], localRay, anyHit,
+                                     closestDistance, triIdx ) )
+                    {
+                        if( anyHit )
+                            return true;
+                        closestInstance = &instance;
+                        closestTri = triIdx;
+                    }
+                }
+            }
+            else
+            {
+                assert( stackSize + 2u <= c_maxBvhDepth );
+                nodeStack[stackSize++] = node.firstChildOrPrim;
+                nodeStack[stackSize++] = node.firstChildOrPrim + 1u;
+            }
+        }
+
+        if( !closestInstance )
+            return false;
+
+        if( outHit )
+        {
+            const Blas &blas = *mBlas[closestInstance->blasIdx];
+            const Vector3 *v = &blas.triVerts[closestTri * 3u];
+
+            //Normals go to world space with the inverse transpose
+            Matrix3 invWorld3x3;
+            closestInstance->invWorldMatrix.extract3x3Matrix( invWorld3x3 );
+            Vector3 normal = invWorld3x3.Transpose() *
+                             Math::calculateBasicFaceNormalWithoutNormalize( v[0], v[1], v[2] );
+            normal.normalise();
+            if( normal.dotProduct( rayDir ) > Real( 0 ) )
+                normal = -normal;
+
+            outHit->distance    = closestDistance;
+            outHit->item        = closestInstance->item;
+            outHit->subMeshIdx  = blas.triSubMesh[closestTri];
+            outHit->normal      = normal;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool AccelerationStructure::raycast( const Ray &ray, Real maxDistance, RayHit &outHit,
+                                         uint32 visibilityMask ) const
+    {
+        return raycastImpl( ray, maxDistance, visibilityMask, false, &outHit );
+    }
+    //-----------------------------------------------------------------------------------
+    bool AccelerationStructure::isOccluded( const Ray &ray, Real maxDistance,
+                                            uint32 visibilityMask ) const
+    {
+        return raycastImpl( ray, maxDistance, visibilityMask, true, 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::setGpuBuffersEnabled( bool bEnabled )
+    {
+        if( bEnabled && !mVaoManager )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "GPU buffers need a VaoManager",
+                         "AccelerationStructure::setGpuBuffersEnabled" );
+        }
+
+        if( mGpuBuffersEnabled == bEnabled )
+            return;
+
+        mGpuBuffersEnabled = bEnabled;
+        if( bEnabled )
+            mBlasChanged = true; //Upload everything on next update
+        else
+            destroyGpuBuffers();
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::destroyGpuBuffers(void)
+    {
+        TexBufferPacked **buffers[4] =
+        {
+            &mTlasNodesBuffer, &mInstancesBuffer, &mBlasNodesBuffer, &mTrianglesBuffer
+        };
+
+        for( size_t i=0; i<4u; ++i )
+        {
+            if( *buffers[i] )
+            {
+                mVaoManager->destroyTexBuffer( *buffers[i] );
+                *buffers[i] = 0;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::uploadTexBuffer( TexBufferPacked *&buffer,
+                                                 FastArray<float> &data )
+    {
+        //Never leave a buffer empty, so that jobs always have something bound
+        if( data.empty() )
+            pushGpuRow( data, Vector3::ZERO, 0u );
+
+        const size_t sizeBytes = data.size() * sizeof(float);
+
+        if( buffer && buffer->getTotalSizeBytes() == sizeBytes )
+        {
+            buffer->upload( data.begin(), 0, buffer->getNumElements() );
+        }
+        else
+        {
+            if( buffer )
+                mVaoManager->destroyTexBuffer( buffer );
+            buffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT, sizeBytes, BT_DEFAULT,
+                                                   data.begin(), false );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::uploadBlasToGpu(void)
+    {
+        FastArray<float> nodeData;
+        FastArray<float> triData;
+
+        uint32 nodeStart = 0;
+        uint32 triStart = 0;
+
+        BlasArray::const_iterator itor = mBlas.begin();
+        BlasArray::const_iterator end  = mBlas.end();
+        while( itor != end )
+        {
+            Blas *blas = *itor;
+            if( blas )
+            {
+                blas->gpuNodeStart = nodeStart;
+                blas->gpuTriStart = triStart;
+
+                pushGpuNodes( nodeData, blas->nodes, nodeStart, triStart );
+
+                const size_t numTris = blas->triSubMesh.size();
+                for( size_t i=0; i<numTris * 3u; ++i )
+                    pushGpuRow( triData, blas->triVerts[i], blas->triSubMesh[i / 3u] );
+
+                nodeStart += static_cast<uint32>( blas->nodes.size() );
+                triStart += static_cast<uint32>( numTris );
+            }
+            ++itor;
+        }
+
+        uploadTexBuffer( mBlasNodesBuffer, nodeData );
+        uploadTexBuffer( mTrianglesBuffer, triData );
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::uploadTlasToGpu(void)
+    {
+        FastArray<float> nodeData;
+        FastArray<float> instanceData;
+
+        //TLAS leaves index mTlasInstances, so the instances are uploaded in that order.
+        pushGpuNodes( nodeData, mTlasNodes, 0u, 0u );
+
+        FastArray<uint32>::const_iterator itor = mTlasInstances.begin();
+        FastArray<uint32>::const_iterator end  = mTlasInstances.end();
+        while( itor != end )
+        {
+            const Instance &instance = mInstances[*itor];
+            const Matrix4 &m = instance.invWorldMatrix;
+            for( size_t i=0; i<3u; ++i )
+            {
+                instanceData.push_back( static_cast<float>( m[i][0] ) );
+                instanceData.push_back( static_cast<float>( m[i][1] ) );
+                instanceData.push_back( static_cast<float>( m[i][2] ) );
+                instanceData.push_back( static_cast<float>( m[i][3] ) );
+            }
+
+            const Blas *blas = mBlas[instance.blasIdx];
+            float rootAndFlags[4] = { 0, 0, 0, 0 };
+            memcpy( &rootAndFlags[0], &blas->gpuNodeStart, sizeof(uint32) );
+            memcpy( &rootAndFlags[1], &instance.visibilityFlags, sizeof(uint32) );
+            instanceData.appendPOD( rootAndFlags, rootAndFlags + 4u );
+            ++itor;
+        }
+
+        uploadTexBuffer( mTlasNodesBuffer, nodeData );
+        uploadTexBuffer( mInstancesBuffer, instanceData );
+    }
+    //-----------------------------------------------------------------------------------
+    void AccelerationStructure::setToComputeJob( HlmsComputeJob *job, uint8 firstTexSlot ) const
+    {
+        TexBufferPacked *buffers[4] =
+        {
+            mTlasNodesBuffer, mInstancesBuffer, mBlasNodesBuffer, mTrianglesBuffer
+        };
+
+        DescriptorSetTexture2::BufferSlot texBufSlot(DescriptorSetTexture2::BufferSlot::makeEmpty());
+        for( uint8 i=0; i<4u; ++i )
+        {
+            texBufSlot.buffer = buffers[i];
+            job->setTexBuffer( firstTexSlot + i, texBufSlot );
+        }
+    }
+}
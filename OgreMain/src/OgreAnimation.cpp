@@ -401,6 +401,38 @@ namespace v1 {
 
     }
     //---------------------------------------------------------------------
+    void Animation::apply(NodeAnimationEvaluator &nodeEvaluator, Real timePos, Real weight,
+                          Real scale)
+    {
+        _applyBaseKeyFrame();
+
+        TimeIndex timeIndex = _getTimeIndex(timePos);
+
+        NodeTrackList::const_iterator itNode = mNodeTrackList.begin();
+        NodeTrackList::const_iterator enNode = mNodeTrackList.end();
+        while( itNode != enNode )
+        {
+            nodeEvaluator.addTrack( *itNode, timeIndex, weight, scale );
+            ++itNode;
+        }
+
+        OldNodeTrackList::iterator i;
+        for (i = mOldNodeTrackList.begin(); i != mOldNodeTrackList.end(); ++i)
+        {
+            i->second->apply(timeIndex, weight, scale);
+        }
+        NumericTrackList::iterator j;
+        for (j = mNumericTrackList.begin(); j != mNumericTrackList.end(); ++j)
+        {
+            j->second->apply(timeIndex, weight, scale);
+        }
+        VertexTrackList::iterator k;
+        for (k = mVertexTrackList.begin(); k != mVertexTrackList.end(); ++k)
+        {
+            k->second->apply(timeIndex, weight, scale);
+        }
+    }
+    //---------------------------------------------------------------------
     void Animation::applyToNode(OldNode* node, Real timePos, Real weight, Real scale)
     {
         _applyBaseKeyFrame();
@@ -35,6 +35,11 @@ THE SOFTWARE.
 #include "OgreNode.h"
 #include "OgreVertexIndexData.h"
 #include "OgreException.h"
+#include "OgreSceneManager.h"
+#include "Math/Array/OgreArrayVector3.h"
+#include "Math/Array/OgreArrayQuaternion.h"
+#include "Math/Array/OgreMathlib.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 namespace Ogre {
 namespace v1 {
@@ -544,6 +549,273 @@ namespace v1 {
 
 	}
 	//---------------------------------------------------------------------
+    NodeAnimationEvaluator::Sample::Sample( NodeAnimationTrack *_track, Node *_node,
+                                            const TimeIndex &_timeIndex,
+                                            Real _weight, Real _scale ) :
+        track( _track ),
+        node( _node ),
+        timeIndex( _timeIndex ),
+        weight( _weight ),
+        scale( _scale ),
+        apply( false ),
+        sampled( false ),
+        outTranslate( Vector3::ZERO ),
+        outRotate( Quaternion::IDENTITY ),
+        outScale( Vector3::UNIT_SCALE )
+    {
+    }
+    //---------------------------------------------------------------------
+    /// Splits NodeAnimationEvaluator::sampleRange across worker threads
+    class NodeAnimationSampleTask : public UniformScalableTask
+    {
+        NodeAnimationEvaluator *mEvaluator;
+
+    public:
+        NodeAnimationSampleTask( NodeAnimationEvaluator *evaluator ) : mEvaluator( evaluator ) {}
+
+        virtual void execute( size_t threadId, size_t numThreads )
+        {
+            //Keep ranges multiple of ARRAY_PACKED_REALS
+            const size_t numSamples = mEvaluator->mSamples.size();
+            const size_t numPacks = (numSamples + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS;
+            const size_t packsPerThread = (numPacks + numThreads - 1u) / numThreads;
+            const size_t start = std::min( threadId * packsPerThread * ARRAY_PACKED_REALS,
+                                           numSamples );
+            const size_t end = std::min( start + packsPerThread * ARRAY_PACKED_REALS, numSamples );
+            mEvaluator->sampleRange( start, end );
+        }
+    };
+    //---------------------------------------------------------------------
+    void NodeAnimationEvaluator::addTrack( NodeAnimationTrack *track, const TimeIndex &timeIndex,
+                                           Real weight, Real scale )
+    {
+        Node *node = track->getAssociatedNode();
+        if( !node )
+            return;
+
+        mSamples.push_back( Sample( track, node, timeIndex, weight, scale ) );
+        Sample &sample = mSamples.back();
+        sample.apply = !track->mKeyFrames.empty() && weight != Real( 0 );
+
+        if( sample.apply )
+        {
+            if( track->mListener )
+            {
+                //Listeners may not be thread safe
+                TransformKeyFrame kf( 0, timeIndex.getTimePos() );
+                track->getInterpolatedKeyFrame( timeIndex, &kf );
+                finishSample( sample, kf.getTranslate(), kf.getRotation(), kf.getScale() );
+                sample.sampled = true;
+            }
+            else if( track->mParent->getInterpolationMode() == Animation::IM_SPLINE &&
+                     track->mSplineBuildNeeded )
+            {
+                //The splines are built lazily, which isn't thread safe
+                track->buildInterpolationSplines();
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    void NodeAnimationEvaluator::finishSample( Sample &sample, const Vector3 &kfTranslate,
+                                               const Quaternion &kfRotate,
+                                               const Vector3 &kfScale )
+    {
+        const NodeAnimationTrack *track = sample.track;
+        const Real weight = sample.weight;
+        const Real scl = sample.scale;
+
+        sample.outTranslate = kfTranslate * weight * scl;
+
+        if( track->mParent->getRotationInterpolationMode() == Animation::RIM_LINEAR )
+        {
+            sample.outRotate = Quaternion::nlerp( weight, Quaternion::IDENTITY, kfRotate,
+                                                  track->mUseShortestRotationPath );
+        }
+        else
+        {
+            sample.outRotate = Quaternion::Slerp( weight, Quaternion::IDENTITY, kfRotate,
+                                                  track->mUseShortestRotationPath );
+        }
+
+        Vector3 scale = kfScale;
+        if( scale != Vector3::UNIT_SCALE )
+        {
+            if( scl != 1.0f )
+                scale = Vector3::UNIT_SCALE + (scale - Vector3::UNIT_SCALE) * scl;
+            else if( weight != 1.0f )
+                scale = Vector3::UNIT_SCALE + (scale - Vector3::UNIT_SCALE) * weight;
+        }
+        sample.outScale = scale;
+    }
+    //---------------------------------------------------------------------
+    void NodeAnimationEvaluator::sampleRange( size_t start, size_t end )
+    {
+        for( size_t i=start; i<end; i += ARRAY_PACKED_REALS )
+        {
+            const size_t numLanes = std::min<size_t>( ARRAY_PACKED_REALS, end - i );
+
+            //Gather the keyframe pairs of the tracks that are linearly interpolated.
+            //The rest are sampled right away with the regular code.
+            ArrayVector3 pos1( ArrayVector3::ZERO ), pos2( ArrayVector3::ZERO );
+            ArrayVector3 scale1( ArrayVector3::UNIT_SCALE ), scale2( ArrayVector3::UNIT_SCALE );
+            ArrayQuaternion rot1( ArrayQuaternion::IDENTITY ), rot2( ArrayQuaternion::IDENTITY );
+            ArrayVector3 interpTime( ArrayVector3::ZERO ); //Only x is used
+            bool simdLane[ARRAY_PACKED_REALS];
+            bool anySpherical = false;
+
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                simdLane[j] = false;
+                if( j >= numLanes )
+                    continue;
+
+                Sample &sample = mSamples[i + j];
+                if( !sample.apply || sample.sampled )
+                    continue;
+
+                const NodeAnimationTrack *track = sample.track;
+                const Animation *anim = track->mParent;
+                const bool bSpherical =
+                        anim->getRotationInterpolationMode() == Animation::RIM_SPHERICAL;
+
+                //ArrayQuaternion::Slerp always takes the shortest path
+                if( anim->getInterpolationMode() != Animation::IM_LINEAR ||
+                    (bSpherical && !track->mUseShortestRotationPath) )
+                {
+                    TransformKeyFrame kf( 0, sample.timeIndex.getTimePos() );
+                    track->getInterpolatedKeyFrame( sample.timeIndex, &kf );
+                    finishSample( sample, kf.getTranslate(), kf.getRotation(), kf.getScale() );
+                    continue;
+                }
+
+                KeyFrame *kBase1, *kBase2;
+                const Real t = track->getKeyFramesAtTime( sample.timeIndex, &kBase1, &kBase2 );
+                const TransformKeyFrame *k1 = static_cast<const TransformKeyFrame*>( kBase1 );
+                const TransformKeyFrame *k2 = static_cast<const TransformKeyFrame*>( kBase2 );
+
+                Quaternion q2 = k2->getRotation();
+                if( track->mUseShortestRotationPath && k1->getRotation().Dot( q2 ) < 0 )
+                    q2 = -q2;
+
+                pos1.setFromVector3( k1->getTranslate(), j );
+                pos2.setFromVector3( k2->getTranslate(), j );
+                scale1.setFromVector3( k1->getScale(), j );
+                scale2.setFromVector3( k2->getScale(), j );
+                rot1.setFromQuaternion( k1->getRotation(), j );
+                rot2.setFromQuaternion( q2, j );
+                interpTime.setFromVector3( Vector3( t, 0, 0 ), j );
+
+                simdLane[j] = true;
+                anySpherical |= bSpherical;
+            }
+
+            const ArrayReal fT = interpTime.mChunkBase[0];
+            const ArrayVector3 interpPos = Math::lerp( pos1, pos2, fT );
+            const ArrayVector3 interpScale = Math::lerp( scale1, scale2, fT );
+            const ArrayQuaternion interpRotLinear = ArrayQuaternion::nlerp( fT, rot1, rot2 );
+            ArrayQuaternion interpRotSpherical( ArrayQuaternion::IDENTITY );
+            if( anySpherical )
+                interpRotSpherical = ArrayQuaternion::Slerp( fT, rot1, rot2 );
+
+            for( size_t j=0; j<numLanes; ++j )
+            {
+                if( !simdLane[j] )
+                    continue;
+
+                Sample &sample = mSamples[i + j];
+                const bool bSpherical = sample.track->mParent->getRotationInterpolationMode() ==
+                                        Animation::RIM_SPHERICAL;
+                Quaternion kfRotate;
+                if( bSpherical )
+                    interpRotSpherical.getAsQuaternion( kfRotate, j );
+                else
+                    interpRotLinear.getAsQuaternion( kfRotate, j );
+
+                finishSample( sample, interpPos.getAsVector3( j ), kfRotate,
+                              interpScale.getAsVector3( j ) );
+            }
+        }
+    }
+    //---------------------------------------------------------------------
+    struct NodeAnimationSampleOrderByNode
+    {
+        const NodeAnimationEvaluator::SampleVec &samples;
+        NodeAnimationSampleOrderByNode( const NodeAnimationEvaluator::SampleVec &_samples ) :
+            samples( _samples ) {}
+
+        bool operator () ( uint32 a, uint32 b ) const
+        {
+            return samples[a].node < samples[b].node;
+        }
+    };
+    //---------------------------------------------------------------------
+    void NodeAnimationEvaluator::writeNodes(void)
+    {
+        mSortedSamples.resize( mSamples.size() );
+        for( size_t i=0; i<mSamples.size(); ++i )
+            mSortedSamples[i] = static_cast<uint32>( i );
+
+        //Stable, as blending multiple tracks on the same node (i.e. rotations) depends on order
+        std::stable_sort( mSortedSamples.begin(), mSortedSamples.end(),
+                          NodeAnimationSampleOrderByNode( mSamples ) );
+
+        size_t i = 0;
+        while( i < mSortedSamples.size() )
+        {
+            Node *node = mSamples[mSortedSamples[i]].node;
+            size_t groupEnd = i + 1u;
+            while( groupEnd < mSortedSamples.size() &&
+                   mSamples[mSortedSamples[groupEnd]].node == node )
+            {
+                ++groupEnd;
+            }
+
+            //All tracks reset the node before any is applied, so the last one wins
+            Vector3 position, scale;
+            Quaternion orientation;
+            mSamples[mSortedSamples[groupEnd - 1u]].track->getInitialState( &position,
+                                                                           &orientation, &scale );
+
+            for( size_t j=i; j<groupEnd; ++j )
+            {
+                const Sample &sample = mSamples[mSortedSamples[j]];
+                if( sample.apply )
+                {
+                    //Same as Node::translate, Node::rotate & Node::scale with default spaces
+                    position += sample.outTranslate;
+                    orientation = orientation * sample.outRotate;
+                    orientation.normalise();
+                    scale *= sample.outScale;
+                }
+            }
+
+            node->setPosition( position );
+            node->setOrientation( orientation );
+            node->setScale( scale );
+
+            i = groupEnd;
+        }
+    }
+    //---------------------------------------------------------------------
+    void NodeAnimationEvaluator::evaluate( SceneManager *sceneManager )
+    {
+        //Below this, threading costs more than it saves
+        const size_t c_minSamplesForThreading = 512u;
+
+        if( sceneManager && sceneManager->getNumWorkerThreads() > 1u &&
+            mSamples.size() >= c_minSamplesForThreading )
+        {
+            NodeAnimationSampleTask task( this );
+            sceneManager->executeUserScalableTask( &task, true );
+        }
+        else
+        {
+            sampleRange( 0, mSamples.size() );
+        }
+
+        writeNodes();
+    }
+	//---------------------------------------------------------------------
 	void NodeAnimationTrack::buildInterpolationSplines(void) const
 	{
 		// Allocate splines if not exists
@@ -1313,9 +1585,22 @@ namespace v1 {
                     applyPoseToVertexData(pose, data, influence);
                 }
             } // key 2 iteration
+
+            flushSoftwarePoses(data);
         } // morph or pose animation
     }
     //-----------------------------------------------------------------------------
+    void VertexAnimationTrack::flushSoftwarePoses(VertexData* data)
+    {
+        if (!mPendingSoftwarePoses.empty())
+        {
+            Mesh::softwareVertexPoseBlend(&mPendingSoftwarePoses[0],
+                &mPendingSoftwarePoseWeights[0], mPendingSoftwarePoses.size(), data);
+            mPendingSoftwarePoses.clear();
+            mPendingSoftwarePoseWeights.clear();
+        }
+    }
+    //-----------------------------------------------------------------------------
     void VertexAnimationTrack::applyPoseToVertexData(const Pose* pose,
         VertexData* data, Real influence)
     {
@@ -1344,8 +1629,9 @@ namespace v1 {
         }
         else
         {
-            // Software
-            Mesh::softwareVertexPoseBlend(influence, pose->getVertexOffsets(), pose->getNormals(), data);
+            // Software. Applied by flushSoftwarePoses
+            mPendingSoftwarePoses.push_back(pose);
+            mPendingSoftwarePoseWeights.push_back(influence);
         }
 
     }
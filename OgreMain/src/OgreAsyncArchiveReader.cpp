@@ -0,0 +1,305 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreAsyncArchiveReader.h"
+#include "OgreArchive.h"
+#include "OgreException.h"
+#include "OgreLoadProfiler.h"
+
+namespace Ogre
+{
+    unsigned long asyncArchiveReaderThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( asyncArchiveReaderThread );
+
+    //-----------------------------------------------------------------------------------
+    AsyncArchiveReader::AsyncArchiveReader( uint32 numThreads ) :
+        mShuttingDown( false )
+    {
+        startThreads( numThreads );
+    }
+    //-----------------------------------------------------------------------------------
+    AsyncArchiveReader::~AsyncArchiveReader()
+    {
+        stopThreads();
+        //Nothing can be pending, readBatch doesn't return until its jobs are
+        //done, and Listeners must outlive their reads; but be safe.
+        while( processNextJob() ) {}
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::startThreads( uint32 numThreads )
+    {
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+        numThreads = 0;
+#endif
+        mShuttingDown = false;
+        //WaitForMultipleObjects can't wait on more than 64 handles
+        numThreads = std::min( numThreads, 64u );
+
+        //Fill mThreadData first, the threads start reading it right away
+        mThreadData.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            IoThread *ioThread = OGRE_NEW_T( IoThread, MEMCATEGORY_GENERAL )();
+            ioThread->reader = this;
+            mThreadData.push_back( ioThread );
+        }
+
+        mThreads.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            mThreads.push_back( Threads::CreateThread( THREAD_GET( asyncArchiveReaderThread ),
+                                                       i, this ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::stopThreads(void)
+    {
+        if( mThreads.empty() )
+            return;
+
+        mJobsMutex.lock();
+        mShuttingDown = true;
+        mJobsMutex.unlock();
+
+        vector<IoThread*>::type::const_iterator itor = mThreadData.begin();
+        vector<IoThread*>::type::const_iterator end  = mThreadData.end();
+        while( itor != end )
+        {
+            (*itor)->wakeUp.wake();
+            ++itor;
+        }
+
+        Threads::WaitForThreads( mThreads );
+        mThreads.clear();
+
+        itor = mThreadData.begin();
+        while( itor != end )
+        {
+            OGRE_DELETE_T( *itor, IoThread, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+        mThreadData.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::setNumThreads( uint32 numThreads )
+    {
+        if( numThreads == mThreads.size() )
+            return;
+
+        stopThreads();
+        startThreads( numThreads );
+    }
+    //-----------------------------------------------------------------------------------
+    DataStreamPtr AsyncArchiveReader::readWholeFile( Archive *archive, const String &filename )
+    {
+        LoadProfiler::Scope loadScope( LoadEvent::ArchiveRead, filename );
+
+        DataStreamPtr stream = archive->open( filename );
+        if( stream.isNull() || stream->getDataView() )
+            return stream;
+
+        //Read it all now; nobody has to touch the Archive afterwards
+        DataStreamPtr retVal( OGRE_NEW MemoryDataStream( filename, stream ) );
+        loadScope.setBytes( retVal->size() );
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::executeJob( Job &job )
+    {
+        ReadRequest *request = job.request;
+        try
+        {
+            request->data = readWholeFile( request->archive, request->filename );
+            if( request->data.isNull() )
+                request->errorDescription = "Could not open " + request->filename;
+        }
+        catch( Exception &e )
+        {
+            request->data.setNull();
+            request->errorDescription = e.getFullDescription();
+        }
+
+        if( job.listener )
+        {
+            job.listener->readCompleted( *request );
+            OGRE_DELETE_T( request, ReadRequest, MEMCATEGORY_GENERAL );
+        }
+
+        if( job.batch )
+        {
+            Batch *batch = job.batch;
+            batch->mutex.lock();
+            const bool finished = --batch->numPending == 0u;
+            batch->mutex.unlock();
+            if( finished )
+                batch->finished.wake();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool AsyncArchiveReader::processNextJob(void)
+    {
+        mJobsMutex.lock();
+        if( mJobs.empty() )
+        {
+            mJobsMutex.unlock();
+            return false;
+        }
+        Job job = mJobs.front();
+        mJobs.pop_front();
+        mJobsMutex.unlock();
+
+        executeJob( job );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::readBatch( ReadRequestVec &requests )
+    {
+        if( requests.empty() )
+            return;
+
+        Batch batch;
+        batch.numPending = 0;
+
+        //Jobs are queued first and executed later, so that the I/O threads
+        //get to start while we deal with the non-thread safe Archives.
+        vector<Job>::type localJobs;
+        mJobsMutex.lock();
+        ReadRequestVec::iterator itor = requests.begin();
+        ReadRequestVec::iterator end  = requests.end();
+        while( itor != end )
+        {
+            Job job;
+            job.request = &(*itor);
+            job.listener = 0;
+            job.batch = 0;
+
+            if( mThreads.empty() || !itor->archive->isThreadSafe() )
+                localJobs.push_back( job );
+            else
+            {
+                job.batch = &batch;
+                ++batch.numPending;
+                mJobs.push_back( job );
+            }
+            ++itor;
+        }
+        const bool hasPendingJobs = batch.numPending != 0u;
+        mJobsMutex.unlock();
+
+        if( hasPendingJobs )
+        {
+            const size_t numThreadsToWake = std::min( batch.numPending, mThreadData.size() );
+            for( size_t i=0; i<numThreadsToWake; ++i )
+                mThreadData[i]->wakeUp.wake();
+        }
+
+        vector<Job>::type::iterator itJob = localJobs.begin();
+        vector<Job>::type::iterator enJob = localJobs.end();
+        while( itJob != enJob )
+        {
+            executeJob( *itJob );
+            ++itJob;
+        }
+
+        if( hasPendingJobs )
+        {
+            //Help out rather than just wait. The jobs we pick may not be ours,
+            //but every job executed brings ours closer to the front.
+            while( processNextJob() ) {}
+
+            bool finished = false;
+            while( !finished )
+            {
+                batch.mutex.lock();
+                finished = batch.numPending == 0u;
+                batch.mutex.unlock();
+                if( !finished )
+                    batch.finished.wait();
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::queueRead( Archive *archive, const String &filename,
+                                        Listener *listener )
+    {
+        Job job;
+        job.request = OGRE_NEW_T( ReadRequest, MEMCATEGORY_GENERAL )( archive, filename );
+        job.listener = listener;
+        job.batch = 0;
+
+        if( mThreads.empty() || !archive->isThreadSafe() )
+        {
+            executeJob( job );
+            return;
+        }
+
+        mJobsMutex.lock();
+        mJobs.push_back( job );
+        mJobsMutex.unlock();
+
+        //Waking them all is cheap; idle ones will go back to sleep
+        vector<IoThread*>::type::const_iterator itor = mThreadData.begin();
+        vector<IoThread*>::type::const_iterator end  = mThreadData.end();
+        while( itor != end )
+        {
+            (*itor)->wakeUp.wake();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncArchiveReader::_ioThread( ThreadHandle *threadHandle )
+    {
+        IoThread *ioThread = mThreadData[threadHandle->getThreadIdx()];
+
+        bool shuttingDown = false;
+        while( !shuttingDown )
+        {
+            while( processNextJob() ) {}
+
+            mJobsMutex.lock();
+            shuttingDown = mShuttingDown;
+            mJobsMutex.unlock();
+
+            //If a job was queued after we looked, wake() was
+            //already called and wait() returns immediately
+            if( !shuttingDown )
+                ioThread->wakeUp.wait();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    unsigned long asyncArchiveReaderThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::Streaming );
+        AsyncArchiveReader *reader =
+                reinterpret_cast<AsyncArchiveReader*>( threadHandle->getUserParam() );
+        reader->_ioThread( threadHandle );
+        return 0;
+    }
+}
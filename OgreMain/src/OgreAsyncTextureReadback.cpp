@@ -0,0 +1,297 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreAsyncTextureReadback.h"
+
+#include "OgreAsyncTextureTicket.h"
+#include "OgreTextureGpuManager.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    AsyncTextureReadbackListener::~AsyncTextureReadbackListener() {}
+    //-----------------------------------------------------------------------------------
+    bool AsyncTextureReadback::TicketKey::operator < ( const TicketKey &other ) const
+    {
+        if( this->width != other.width )
+            return this->width < other.width;
+        if( this->height != other.height )
+            return this->height < other.height;
+        if( this->depthOrSlices != other.depthOrSlices )
+            return this->depthOrSlices < other.depthOrSlices;
+        if( this->textureType != other.textureType )
+            return this->textureType < other.textureType;
+        return this->pixelFormatFamily < other.pixelFormatFamily;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    AsyncTextureReadback::AsyncTextureReadback( TextureGpuManager *textureManager,
+                                                VaoManager *vaoManager ) :
+        mTextureManager( textureManager ),
+        mVaoManager( vaoManager )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    AsyncTextureReadback::~AsyncTextureReadback()
+    {
+        PendingReadbackVec::const_iterator itor = mPending.begin();
+        PendingReadbackVec::const_iterator end  = mPending.end();
+
+        while( itor != end )
+        {
+            mTextureManager->destroyAsyncTextureTicket( itor->ticket );
+            ++itor;
+        }
+        mPending.clear();
+
+        releaseFreeTickets();
+
+        mQueuedResultsMutex.lock();
+        QueuedResultVec::const_iterator itResult = mQueuedResults.begin();
+        QueuedResultVec::const_iterator enResult = mQueuedResults.end();
+        while( itResult != enResult )
+        {
+            OGRE_FREE_SIMD( itResult->box.data, MEMCATEGORY_RESOURCE );
+            ++itResult;
+        }
+        mQueuedResults.clear();
+        mQueuedResultsMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    AsyncTextureTicket* AsyncTextureReadback::acquireTicket( const TicketKey &key )
+    {
+        TicketPoolMap::iterator itor = mFreeTickets.find( key );
+        if( itor != mFreeTickets.end() && !itor->second.empty() )
+        {
+            AsyncTextureTicket *ticket = itor->second.back();
+            itor->second.pop_back();
+            return ticket;
+        }
+
+        return mTextureManager->createAsyncTextureTicket( key.width, key.height, key.depthOrSlices,
+                                                          key.textureType, key.pixelFormatFamily );
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::releaseTicket( const TicketKey &key, AsyncTextureTicket *ticket )
+    {
+        AsyncTextureTicketVec &freeTickets = mFreeTickets[key];
+
+        //Continuous readbacks of the same size need one ticket per frame in flight.
+        //Anything above that was a burst and isn't worth keeping.
+        const size_t maxPooled = mVaoManager->getDynamicBufferMultiplier() + 1u;
+        if( freeTickets.size() < maxPooled )
+            freeTickets.push_back( ticket );
+        else
+            mTextureManager->destroyAsyncTextureTicket( ticket );
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::deliver( PendingReadback &pending )
+    {
+        AsyncTextureTicket *ticket = pending.ticket;
+
+        if( pending.listener )
+        {
+            const uint32 numSlices = ticket->getNumSlices();
+            const bool bMapAllSlices = ticket->canMapMoreThanOneSlice();
+
+            uint32 slice = 0;
+            while( slice < numSlices )
+            {
+                const TextureBox box = ticket->map( slice );
+
+                if( pending.deliveryThread == DeliverFromUpdate )
+                {
+                    pending.listener->readbackFinished( box, pending.pixelFormat, pending.userData );
+                }
+                else
+                {
+                    QueuedResult result;
+                    result.box          = box;
+                    result.pixelFormat  = pending.pixelFormat;
+                    result.listener     = pending.listener;
+                    result.userData     = pending.userData;
+
+                    const size_t sizeBytes = box.getSizeBytes();
+                    result.box.data = OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_RESOURCE );
+                    memcpy( result.box.data, box.data, sizeBytes );
+
+                    mQueuedResultsMutex.lock();
+                    mQueuedResults.push_back( result );
+                    mQueuedResultsMutex.unlock();
+                }
+
+                ticket->unmap();
+                slice += bMapAllSlices ? numSlices : 1u;
+            }
+        }
+
+        releaseTicket( pending.key, ticket );
+        pending.ticket = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::requestReadback( TextureGpu *texture, uint8 mipLevel,
+                                                AsyncTextureReadbackListener *listener,
+                                                void *userData, DeliveryThread deliveryThread,
+                                                TextureBox *srcBox )
+    {
+        OGRE_ASSERT_LOW( listener );
+
+        if( texture->isMultisample() && !texture->hasMsaaExplicitResolves() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + texture->getNameStr() + "' must be resolved before "
+                         "being downloaded",
+                         "AsyncTextureReadback::requestReadback" );
+        }
+
+        TicketKey key;
+        if( srcBox )
+        {
+            key.width           = srcBox->width;
+            key.height          = srcBox->height;
+            key.depthOrSlices   = srcBox->getDepthOrSlices();
+        }
+        else
+        {
+            key.width   = std::max( 1u, texture->getWidth() >> mipLevel );
+            key.height  = std::max( 1u, texture->getHeight() >> mipLevel );
+            const uint32 depth = std::max( 1u, texture->getDepth() >> mipLevel );
+            key.depthOrSlices = std::max( depth, texture->getNumSlices() );
+        }
+        key.textureType         = texture->getTextureType();
+        key.pixelFormatFamily   = PixelFormatGpuUtils::getFamily( texture->getPixelFormat() );
+
+        PendingReadback pending;
+        pending.ticket          = acquireTicket( key );
+        pending.key             = key;
+        pending.pixelFormat     = texture->getPixelFormat();
+        pending.listener        = listener;
+        pending.userData        = userData;
+        pending.frameIssued     = mVaoManager->getFrameCount();
+        pending.deliveryThread  = deliveryThread;
+
+        pending.ticket->download( texture, mipLevel, false, srcBox );
+
+        mPending.push_back( pending );
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::cancelReadbacks( AsyncTextureReadbackListener *listener )
+    {
+        PendingReadbackVec::iterator itor = mPending.begin();
+        PendingReadbackVec::iterator end  = mPending.end();
+
+        while( itor != end )
+        {
+            if( itor->listener == listener )
+                itor->listener = 0;
+            ++itor;
+        }
+
+        mQueuedResultsMutex.lock();
+        QueuedResultVec::iterator itResult = mQueuedResults.begin();
+        QueuedResultVec::iterator enResult = mQueuedResults.end();
+        while( itResult != enResult )
+        {
+            if( itResult->listener == listener )
+                itResult->listener = 0;
+            ++itResult;
+        }
+        mQueuedResultsMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::update(void)
+    {
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+
+        //Listeners may issue new requests while we iterate
+        PendingReadbackVec pending;
+        pending.swap( mPending );
+
+        PendingReadbackVec::iterator itor = pending.begin();
+        PendingReadbackVec::iterator end  = pending.end();
+        PendingReadbackVec::iterator itKeep = pending.begin();
+
+        while( itor != end )
+        {
+            //Don't query in the same frame it was issued. With inaccurate tracking
+            //it's never done yet, and querying too often triggers accurate tracking.
+            if( itor->frameIssued != currentFrame && itor->ticket->queryIsTransferDone() )
+                deliver( *itor );
+            else
+                *itKeep++ = *itor;
+            ++itor;
+        }
+
+        //Keep the ones that aren't done yet (before the new ones, to preserve order)
+        pending.erase( itKeep, end );
+        pending.insert( pending.end(), mPending.begin(), mPending.end() );
+        mPending.swap( pending );
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::dispatchQueuedResults(void)
+    {
+        QueuedResultVec results;
+        mQueuedResultsMutex.lock();
+        results.swap( mQueuedResults );
+        mQueuedResultsMutex.unlock();
+
+        QueuedResultVec::const_iterator itor = results.begin();
+        QueuedResultVec::const_iterator end  = results.end();
+
+        while( itor != end )
+        {
+            if( itor->listener )
+                itor->listener->readbackFinished( itor->box, itor->pixelFormat, itor->userData );
+            OGRE_FREE_SIMD( itor->box.data, MEMCATEGORY_RESOURCE );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void AsyncTextureReadback::releaseFreeTickets(void)
+    {
+        TicketPoolMap::const_iterator itor = mFreeTickets.begin();
+        TicketPoolMap::const_iterator end  = mFreeTickets.end();
+
+        while( itor != end )
+        {
+            AsyncTextureTicketVec::const_iterator itTicket = itor->second.begin();
+            AsyncTextureTicketVec::const_iterator enTicket = itor->second.end();
+
+            while( itTicket != enTicket )
+                mTextureManager->destroyAsyncTextureTicket( *itTicket++ );
+
+            ++itor;
+        }
+
+        mFreeTickets.clear();
+    }
+}
@@ -0,0 +1,948 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreBillboardChain2.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreTexBufferPacked.h"
+
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+
+#include "OgreHlms.h"
+#include "OgreHlmsManager.h"
+#include "OgreRoot.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    /// 2 vertices per element, see BillboardChain::writeElement
+    static const size_t c_floatsPerVertex = 4u + 1u + 2u + 4u + 4u + 4u;
+    /// Written as the birth time of heads, so that they don't fade
+    static const float c_headTime = 1e30f;
+    /// Odometers & time get rebased beyond this, before they lose too much precision
+    static const float c_rebaseThreshold = 65536.0f;
+
+    const size_t BillboardChain::SEGMENT_EMPTY = std::numeric_limits<size_t>::max();
+    //-----------------------------------------------------------------------------------
+    BillboardChain::Element::Element() :
+        position( Vector3::ZERO ),
+        width( 0 ),
+        texCoord( 0 ),
+        colour( ColourValue::White ),
+        orientation( Quaternion::IDENTITY )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    BillboardChain::Element::Element( const Vector3 &_position, Real _width, Real _texCoord,
+                                      const ColourValue &_colour,
+                                      const Quaternion &_orientation ) :
+        position( _position ),
+        width( _width ),
+        texCoord( _texCoord ),
+        colour( _colour ),
+        orientation( _orientation )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    BillboardChain::ChainRenderable::ChainRenderable( BillboardChain *parent,
+                                                      VertexArrayObject *vao ) :
+        mParent( parent )
+    {
+        mVaoPerLod[VpNormal].push_back( vao );
+        mVaoPerLod[VpShadow].push_back( vao );
+    }
+    //-----------------------------------------------------------------------------------
+    const LightList& BillboardChain::ChainRenderable::getLights(void) const
+    {
+        return mParent->queryLights();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::ChainRenderable::getRenderOperation( v1::RenderOperation &op,
+                                                              bool casterPass )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "BillboardChain do not implement getRenderOperation."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "BillboardChain::ChainRenderable::getRenderOperation" );
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::ChainRenderable::getWorldTransforms( Matrix4 *xform ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "BillboardChain do not implement getWorldTransforms."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "BillboardChain::ChainRenderable::getWorldTransforms" );
+    }
+    //-----------------------------------------------------------------------------------
+    bool BillboardChain::ChainRenderable::getCastsShadows(void) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "BillboardChain do not implement getCastsShadows."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "BillboardChain::ChainRenderable::getCastsShadows" );
+    }
+    //-----------------------------------------------------------------------------------
+    TexBufferPacked* BillboardChain::ChainRenderable::getBillboardChainBuffer(void) const
+    {
+        return mParent->mParamsBuffer;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    BillboardChain::BillboardChain( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                    SceneManager *manager, size_t maxElements,
+                                    size_t numberOfChains ) :
+        MovableObject( id, objectMemoryManager, manager, 10u ),
+        mMaxElementsPerChain( maxElements ),
+        mChainCount( numberOfChains ),
+        mTexCoordDir( TCD_U ),
+        mFaceCamera( true ),
+        mNormalBase( Vector3::UNIT_X ),
+        mCurrentTime( 0 ),
+        mVaoManager( manager->getDestinationRenderSystem()->getVaoManager() ),
+        mVertexBuffer( 0 ),
+        mIndexBuffer( 0 ),
+        mParamsBuffer( 0 ),
+        mParamsDirty( true ),
+        mBoundsDirty( true ),
+        mQueuedForUpdate( false ),
+        mLastParamsFrame( std::numeric_limits<uint32>::max() )
+    {
+        mOtherTexCoordRange[0] = 0.0f;
+        mOtherTexCoordRange[1] = 1.0f;
+
+        setupChainContainers();
+
+        setCastShadows( false );
+    }
+    //-----------------------------------------------------------------------------------
+    BillboardChain::~BillboardChain()
+    {
+        if( mQueuedForUpdate )
+            mManager->_removeBillboardChainUpdate( this );
+        destroyBuffers();
+    }
+    //-----------------------------------------------------------------------------------
+    template <typename T>
+    void fillBillboardChainIndices( T * RESTRICT_ALIAS indices, size_t maxElements,
+                                    size_t numChains )
+    {
+        //Every chain has 2 * maxElements - 1 segments, so that the segments between
+        //head and tail are always a contiguous range even after the ring buffer wraps.
+        const size_t numSegments = maxElements * 2u - 1u;
+        for( size_t c=0; c<numChains; ++c )
+        {
+            const size_t baseVertex = c * maxElements * 2u;
+            for( size_t s=0; s<numSegments; ++s )
+            {
+                const T newer = static_cast<T>( baseVertex + (s % maxElements) * 2u );
+                const T older = static_cast<T>( baseVertex + ((s + 1u) % maxElements) * 2u );
+                *indices++ = newer;
+                *indices++ = newer + 1u;
+                *indices++ = older;
+                *indices++ = newer + 1u;
+                *indices++ = older + 1u;
+                *indices++ = older;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::createBuffers(void)
+    {
+        const size_t numElements = mMaxElementsPerChain * mChainCount;
+        if( !numElements )
+            return;
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_UBYTE4_NORM, VES_DIFFUSE ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TEXTURE_COORDINATES ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TEXTURE_COORDINATES ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TEXTURE_COORDINATES ) );
+
+        //Contents are uploaded via _writeDirtyElements
+        mVertexBuffer = mVaoManager->createVertexBuffer( vertexElements, numElements * 2u,
+                                                         BT_DEFAULT, 0, false );
+
+        const size_t numIndices = (mMaxElementsPerChain * 2u - 1u) * 6u * mChainCount;
+        const bool useIndices32 = numElements * 2u > 0xFFFF;
+        const size_t bytesPerIndex = useIndices32 ? sizeof(uint32) : sizeof(uint16);
+
+        void *indices = OGRE_MALLOC_SIMD( numIndices * bytesPerIndex, MEMCATEGORY_GEOMETRY );
+        FreeOnDestructor indicesPtr( indices );
+        if( useIndices32 )
+        {
+            fillBillboardChainIndices( reinterpret_cast<uint32*>( indices ),
+                                       mMaxElementsPerChain, mChainCount );
+        }
+        else
+        {
+            fillBillboardChainIndices( reinterpret_cast<uint16*>( indices ),
+                                       mMaxElementsPerChain, mChainCount );
+        }
+
+        try
+        {
+            mIndexBuffer = mVaoManager->createIndexBuffer( useIndices32 ? IndexBufferPacked::IT_32BIT :
+                                                                          IndexBufferPacked::IT_16BIT,
+                                                           numIndices, BT_IMMUTABLE, indices, false );
+        }
+        catch( Exception & )
+        {
+            mVaoManager->destroyVertexBuffer( mVertexBuffer );
+            mVertexBuffer = 0;
+            throw;
+        }
+
+        mParamsBuffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT,
+                                                      (1u + 2u * mChainCount) * 4u * sizeof(float),
+                                                      BT_DYNAMIC_PERSISTENT, 0, false );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( mVertexBuffer );
+
+        mChainRenderables.reserve( mChainCount );
+        for( size_t i=0; i<mChainCount; ++i )
+        {
+            VertexArrayObject *vao = mVaoManager->createVertexArrayObject( vertexBuffers,
+                                                                           mIndexBuffer,
+                                                                           OT_TRIANGLE_LIST );
+            mChainRenderables.push_back( OGRE_NEW ChainRenderable( this, vao ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::destroyBuffers(void)
+    {
+        mRenderables.clear();
+
+        ChainRenderableArray::const_iterator itor = mChainRenderables.begin();
+        ChainRenderableArray::const_iterator endt = mChainRenderables.end();
+        while( itor != endt )
+        {
+            mVaoManager->destroyVertexArrayObject( (*itor)->getVaos( VpNormal ).back() );
+            OGRE_DELETE *itor;
+            ++itor;
+        }
+        mChainRenderables.clear();
+
+        if( mParamsBuffer )
+        {
+            if( mParamsBuffer->getMappingState() != MS_UNMAPPED )
+                mParamsBuffer->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyTexBuffer( mParamsBuffer );
+            mParamsBuffer = 0;
+        }
+        if( mIndexBuffer )
+        {
+            mVaoManager->destroyIndexBuffer( mIndexBuffer );
+            mIndexBuffer = 0;
+        }
+        if( mVertexBuffer )
+        {
+            mVaoManager->destroyVertexBuffer( mVertexBuffer );
+            mVertexBuffer = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setupChainContainers(void)
+    {
+        HlmsDatablock *datablock = getDatablock();
+        destroyBuffers();
+
+        const size_t numElements = mMaxElementsPerChain * mChainCount;
+        mChainElementList.resize( numElements );
+        mElementTimes.resizePOD( numElements, 0.0f );
+        mElementOdometers.resizePOD( numElements, 0.0f );
+        mElementDirty.resizePOD( numElements, 0u );
+        memset( mElementDirty.begin(), 0, numElements * sizeof(uint8) );
+        mDirtyElements.clear();
+
+        //Chains that already existed keep their fading settings
+        const size_t oldChainCount = mChainSegmentList.size();
+        mChainSegmentList.resize( mChainCount );
+        for( size_t i=0; i<mChainCount; ++i )
+        {
+            ChainSegment &seg = mChainSegmentList[i];
+            seg.start = i * mMaxElementsPerChain;
+            seg.tail = seg.head = SEGMENT_EMPTY;
+            seg.trimOdometer = -std::numeric_limits<Real>::max();
+            if( i >= oldChainCount )
+            {
+                seg.colourChange = ColourValue::ZERO;
+                seg.widthChange = 0;
+            }
+        }
+
+        createBuffers();
+
+        if( !datablock )
+        {
+            Hlms *hlms = Root::getSingleton().getHlmsManager()->getHlms( HLMS_UNLIT );
+            datablock = hlms->getDefaultDatablock();
+        }
+        setDatablock( datablock );
+
+        mParamsDirty = true;
+        mBoundsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::queueUpdate(void)
+    {
+        if( !mQueuedForUpdate )
+        {
+            mQueuedForUpdate = true;
+            mManager->_queueBillboardChainUpdate( this );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::markElementDirty( const ChainSegment &seg, size_t slot )
+    {
+        const size_t idx = seg.start + slot;
+        if( !mElementDirty[idx] )
+        {
+            mElementDirty[idx] = 1u;
+            mDirtyElements.push_back( static_cast<uint32>( idx ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t BillboardChain::getOlderSlot( size_t slot ) const
+    {
+        return slot + 1u == mMaxElementsPerChain ? 0 : slot + 1u;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t BillboardChain::getNewerSlot( size_t slot ) const
+    {
+        return slot == 0 ? mMaxElementsPerChain - 1u : slot - 1u;
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::updateOdometers( size_t chainIndex, size_t slot )
+    {
+        const ChainSegment &seg = mChainSegmentList[chainIndex];
+
+        size_t s = slot;
+        while( true )
+        {
+            if( s != seg.tail )
+            {
+                const size_t older = getOlderSlot( s );
+                const Vector3 &pos = mChainElementList[seg.start + s].position;
+                const Vector3 &olderPos = mChainElementList[seg.start + older].position;
+                mElementOdometers[seg.start + s] = mElementOdometers[seg.start + older] +
+                                                   pos.distance( olderPos );
+            }
+            markElementDirty( seg, s );
+
+            if( s == seg.head )
+                break;
+            s = getNewerSlot( s );
+        }
+
+        if( mElementOdometers[seg.start + seg.head] > c_rebaseThreshold )
+            rebaseOdometers( chainIndex );
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::markAllElementsDirty(void)
+    {
+        for( size_t i=0; i<mChainCount; ++i )
+        {
+            const ChainSegment &seg = mChainSegmentList[i];
+            if( seg.head != SEGMENT_EMPTY )
+            {
+                size_t s = seg.head;
+                while( true )
+                {
+                    markElementDirty( seg, s );
+                    if( s == seg.tail )
+                        break;
+                    s = getOlderSlot( s );
+                }
+            }
+        }
+
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::advanceTime( Real timeSinceLast )
+    {
+        mCurrentTime += timeSinceLast;
+        if( mCurrentTime > c_rebaseThreshold )
+            rebaseTime();
+        mParamsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::rebaseTime(void)
+    {
+        const float currentTime = mCurrentTime;
+        FastArray<float>::iterator itor = mElementTimes.begin();
+        FastArray<float>::iterator endt = mElementTimes.end();
+        while( itor != endt )
+            *itor++ -= currentTime;
+        mCurrentTime = 0;
+
+        markAllElementsDirty();
+        mParamsDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::rebaseOdometers( size_t chainIndex )
+    {
+        ChainSegment &seg = mChainSegmentList[chainIndex];
+        if( seg.head == SEGMENT_EMPTY )
+            return;
+
+        const float base = mElementOdometers[seg.start + seg.tail];
+
+        size_t s = seg.head;
+        while( true )
+        {
+            mElementOdometers[seg.start + s] -= base;
+            markElementDirty( seg, s );
+            if( s == seg.tail )
+                break;
+            s = getOlderSlot( s );
+        }
+
+        seg.trimOdometer -= base;
+        mParamsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setMaxChainElements( size_t maxElements )
+    {
+        mMaxElementsPerChain = maxElements;
+        setupChainContainers();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setNumberOfChains( size_t numChains )
+    {
+        mChainCount = numChains;
+        setupChainContainers();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setTextureCoordDirection( TexCoordDirection dir )
+    {
+        mTexCoordDir = dir;
+        markAllElementsDirty();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setOtherTextureCoordRange( Real start, Real end )
+    {
+        mOtherTexCoordRange[0] = start;
+        mOtherTexCoordRange[1] = end;
+        markAllElementsDirty();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setFaceCamera( bool faceCamera, const Vector3 &normalVector )
+    {
+        mFaceCamera = faceCamera;
+        mNormalBase = normalVector.normalisedCopy();
+        mParamsDirty = true;
+        markAllElementsDirty();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::addChainElement( size_t chainIndex,
+                                          const BillboardChain::Element &dtls )
+    {
+        if( chainIndex >= mChainCount )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "chainIndex out of bounds",
+                         "BillboardChain::addChainElement" );
+        }
+        ChainSegment &seg = mChainSegmentList[chainIndex];
+
+        bool tailDropped = false;
+        if( seg.head == SEGMENT_EMPTY )
+        {
+            //Tail starts at end, head grows backwards
+            seg.tail = mMaxElementsPerChain - 1u;
+            seg.head = seg.tail;
+        }
+        else
+        {
+            seg.head = getNewerSlot( seg.head );
+            //Run out of elements?
+            if( seg.head == seg.tail )
+            {
+                //Move tail backwards too, losing the end of the segment
+                seg.tail = getNewerSlot( seg.tail );
+                tailDropped = true;
+            }
+        }
+
+        mChainElementList[seg.start + seg.head] = dtls;
+
+        if( seg.head != seg.tail )
+        {
+            const size_t older = getOlderSlot( seg.head );
+            mElementOdometers[seg.start + seg.head] =
+                    mElementOdometers[seg.start + older] +
+                    dtls.position.distance( mChainElementList[seg.start + older].position );
+
+            //The previous head starts fading now, and its tangent changed
+            mElementTimes[seg.start + older] = mCurrentTime;
+            markElementDirty( seg, older );
+            if( tailDropped )
+                markElementDirty( seg, seg.tail );
+        }
+        else
+        {
+            mElementOdometers[seg.start + seg.head] = 0;
+        }
+        mElementTimes[seg.start + seg.head] = mCurrentTime;
+        markElementDirty( seg, seg.head );
+
+        if( mElementOdometers[seg.start + seg.head] > c_rebaseThreshold )
+            rebaseOdometers( chainIndex );
+
+        mBoundsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::removeChainElement( size_t chainIndex )
+    {
+        if( chainIndex >= mChainCount )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "chainIndex out of bounds",
+                         "BillboardChain::removeChainElement" );
+        }
+        ChainSegment &seg = mChainSegmentList[chainIndex];
+        if( seg.head == SEGMENT_EMPTY )
+            return; //Nothing to remove
+
+        if( seg.tail == seg.head )
+        {
+            //Last item
+            seg.head = seg.tail = SEGMENT_EMPTY;
+        }
+        else
+        {
+            seg.tail = getNewerSlot( seg.tail );
+            //The new tail's tangent changed
+            markElementDirty( seg, seg.tail );
+        }
+
+        mBoundsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::clearChain( size_t chainIndex )
+    {
+        if( chainIndex >= mChainCount )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "chainIndex out of bounds",
+                         "BillboardChain::clearChain" );
+        }
+        ChainSegment &seg = mChainSegmentList[chainIndex];
+
+        //Just reset head & tail
+        seg.tail = seg.head = SEGMENT_EMPTY;
+
+        mBoundsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::clearAllChains(void)
+    {
+        for( size_t i=0; i<mChainCount; ++i )
+            clearChain( i );
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::updateChainElement( size_t chainIndex, size_t elementIndex,
+                                             const BillboardChain::Element &dtls )
+    {
+        if( chainIndex >= mChainCount )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "chainIndex out of bounds",
+                         "BillboardChain::updateChainElement" );
+        }
+        const ChainSegment &seg = mChainSegmentList[chainIndex];
+        if( seg.head == SEGMENT_EMPTY )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Chain segment is empty",
+                         "BillboardChain::updateChainElement" );
+        }
+
+        const size_t slot = (seg.head + elementIndex) % mMaxElementsPerChain;
+        mChainElementList[seg.start + slot] = dtls;
+
+        //The older neighbour's tangent & vector to its newer neighbour changed.
+        //The newer ones are marked by updateOdometers
+        if( slot != seg.tail )
+            markElementDirty( seg, getOlderSlot( slot ) );
+        updateOdometers( chainIndex, slot );
+
+        mBoundsDirty = true;
+        queueUpdate();
+    }
+    //-----------------------------------------------------------------------------------
+    const BillboardChain::Element& BillboardChain::getChainElement( size_t chainIndex,
+                                                                    size_t elementIndex ) const
+    {
+        if( chainIndex >= mChainCount )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "chainIndex out of bounds",
+                         "BillboardChain::getChainElement" );
+        }
+        const ChainSegment &seg = mChainSegmentList[chainIndex];
+
+        const size_t idx = (seg.head + elementIndex) % mMaxElementsPerChain;
+        return mChainElementList[seg.start + idx];
+    }
+    //-----------------------------------------------------------------------------------
+    size_t BillboardChain::getNumChainElements( size_t chainIndex ) const
+    {
+        if( chainIndex >= mChainCount )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "chainIndex out of bounds",
+                         "BillboardChain::getNumChainElements" );
+        }
+        const ChainSegment &seg = mChainSegmentList[chainIndex];
+
+        if( seg.head == SEGMENT_EMPTY )
+            return 0;
+        else if( seg.tail < seg.head )
+            return seg.tail - seg.head + mMaxElementsPerChain + 1u;
+        else
+            return seg.tail - seg.head + 1u;
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setDatablock( HlmsDatablock *datablock )
+    {
+        if( datablock->getCreator()->getType() != HLMS_UNLIT )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "BillboardChain only supports HlmsUnlit datablocks",
+                         "BillboardChain::setDatablock" );
+        }
+
+        ChainRenderableArray::const_iterator itor = mChainRenderables.begin();
+        ChainRenderableArray::const_iterator endt = mChainRenderables.end();
+        while( itor != endt )
+            (*itor++)->setDatablock( datablock );
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::setDatablock( IdString datablockName )
+    {
+        HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
+        setDatablock( hlmsManager->getDatablock( datablockName ) );
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsDatablock* BillboardChain::getDatablock(void) const
+    {
+        return mChainRenderables.empty() ? 0 : mChainRenderables[0]->getDatablock();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::writeElement( size_t elementIdx, float * RESTRICT_ALIAS vertexData ) const
+    {
+        const size_t chainIdx = elementIdx / mMaxElementsPerChain;
+        const ChainSegment &seg = mChainSegmentList[chainIdx];
+        const size_t slot = elementIdx - seg.start;
+        const Element &elem = mChainElementList[elementIdx];
+
+        const Vector3 &olderPos = mChainElementList[seg.start + getOlderSlot( slot )].position;
+        const Vector3 &newerPos = mChainElementList[seg.start + getNewerSlot( slot )].position;
+
+        //Same tangents as v1::BillboardChain::updateVertexBuffer
+        Vector3 tangent;
+        if( slot == seg.head && slot == seg.tail )
+            tangent = Vector3::ZERO;
+        else if( slot == seg.head )
+            tangent = olderPos - elem.position;
+        else if( slot == seg.tail )
+            tangent = elem.position - newerPos;
+        else
+            tangent = olderPos - newerPos;
+
+        const Vector3 toNewer = slot == seg.head ? Vector3::ZERO : newerPos - elem.position;
+        const Vector3 normal = elem.orientation * mNormalBase;
+        const float birthTime = slot == seg.head ? c_headTime : mElementTimes[elementIdx];
+        const float odometer = mElementOdometers[elementIdx];
+        const ABGR colour = elem.colour.getAsABGR();
+
+        for( size_t i=0; i<2u; ++i )
+        {
+            //The sign tells the side, the magnitude the chain (params) index
+            const float sideAndChain = (i == 0 ? -1.0f : 1.0f) * static_cast<float>( chainIdx + 1u );
+
+            *vertexData++ = elem.position.x;
+            *vertexData++ = elem.position.y;
+            *vertexData++ = elem.position.z;
+            *vertexData++ = sideAndChain;
+
+            memcpy( vertexData, &colour, sizeof(ABGR) );
+            ++vertexData;
+
+            if( mTexCoordDir == TCD_U )
+            {
+                *vertexData++ = elem.texCoord;
+                *vertexData++ = mOtherTexCoordRange[i];
+            }
+            else
+            {
+                *vertexData++ = mOtherTexCoordRange[i];
+                *vertexData++ = elem.texCoord;
+            }
+
+            *vertexData++ = tangent.x;
+            *vertexData++ = tangent.y;
+            *vertexData++ = tangent.z;
+            *vertexData++ = elem.width;
+
+            *vertexData++ = toNewer.x;
+            *vertexData++ = toNewer.y;
+            *vertexData++ = toNewer.z;
+            *vertexData++ = odometer;
+
+            *vertexData++ = normal.x;
+            *vertexData++ = normal.y;
+            *vertexData++ = normal.z;
+            *vertexData++ = birthTime;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    size_t BillboardChain::_getDirtyElementsSize(void) const
+    {
+        return mDirtyElements.size() * 2u * c_floatsPerVertex * sizeof(float);
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::_writeDirtyElements( uint8 * RESTRICT_ALIAS stagingData,
+                                              size_t stagingOffset,
+                                              StagingBuffer::DestinationVec &outDestinations )
+    {
+        const size_t bytesPerElement = 2u * c_floatsPerVertex * sizeof(float);
+
+        //Sorting lets us merge neighbouring slots into a single copy
+        std::sort( mDirtyElements.begin(), mDirtyElements.end() );
+
+        size_t lastIdx = std::numeric_limits<size_t>::max();
+        FastArray<uint32>::const_iterator itor = mDirtyElements.begin();
+        FastArray<uint32>::const_iterator endt = mDirtyElements.end();
+        while( itor != endt )
+        {
+            const size_t idx = *itor;
+            writeElement( idx, reinterpret_cast<float*>( stagingData ) );
+            mElementDirty[idx] = 0u;
+
+            if( idx == lastIdx + 1u )
+            {
+                outDestinations.back().length += bytesPerElement;
+            }
+            else
+            {
+                outDestinations.push_back( StagingBuffer::Destination( mVertexBuffer,
+                                                                       idx * bytesPerElement,
+                                                                       stagingOffset,
+                                                                       bytesPerElement ) );
+            }
+
+            lastIdx = idx;
+            stagingData += bytesPerElement;
+            stagingOffset += bytesPerElement;
+            ++itor;
+        }
+
+        mDirtyElements.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::updateBounds(void)
+    {
+        Aabb aabb( Aabb::BOX_ZERO );
+        Real maxWidth = 0;
+        bool isEmpty = true;
+
+        for( size_t i=0; i<mChainCount; ++i )
+        {
+            const ChainSegment &seg = mChainSegmentList[i];
+            if( seg.head == SEGMENT_EMPTY )
+                continue;
+
+            size_t s = seg.head;
+            while( true )
+            {
+                const Element &elem = mChainElementList[seg.start + s];
+                if( isEmpty )
+                {
+                    aabb.mCenter = elem.position;
+                    isEmpty = false;
+                }
+                else
+                {
+                    aabb.merge( elem.position );
+                }
+                maxWidth = std::max( maxWidth, elem.width );
+
+                if( s == seg.tail )
+                    break;
+                s = getOlderSlot( s );
+            }
+        }
+
+        aabb.mHalfSize += Vector3( maxWidth * 0.5f );
+
+        //Positions are in world space, but the bounds must be in local space
+        if( mParentNode )
+            aabb.transformAffine( mParentNode->_getFullTransform().inverseAffine() );
+
+        mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
+        mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
+
+        if( mParentNode )
+        {
+            getWorldAabbUpdated();
+            getWorldRadiusUpdated();
+        }
+
+        mBoundsDirty = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChain::_updateGpuData(void)
+    {
+        mQueuedForUpdate = false;
+
+        mRenderables.clear();
+        const size_t indicesPerChain = (mMaxElementsPerChain * 2u - 1u) * 6u;
+        for( size_t i=0; i<mChainRenderables.size(); ++i )
+        {
+            const size_t numElements = getNumChainElements( i );
+            if( numElements >= 2u )
+            {
+                const ChainSegment &seg = mChainSegmentList[i];
+                VertexArrayObject *vao = mChainRenderables[i]->getVaos( VpNormal ).back();
+                vao->setPrimitiveRange( static_cast<uint32>( i * indicesPerChain + seg.head * 6u ),
+                                        static_cast<uint32>( (numElements - 1u) * 6u ) );
+                mRenderables.push_back( mChainRenderables[i] );
+            }
+        }
+
+        if( mParamsDirty && mParamsBuffer )
+        {
+            //Persistent buffers can only be mapped once per frame
+            if( mLastParamsFrame != mVaoManager->getFrameCount() )
+            {
+                float * RESTRICT_ALIAS params = reinterpret_cast<float*>(
+                            mParamsBuffer->map( 0, mParamsBuffer->getNumElements() ) );
+
+                *params++ = mFaceCamera ? 1.0f : 0.0f;
+                *params++ = mCurrentTime;
+                *params++ = 0;
+                *params++ = 0;
+
+                ChainSegmentList::const_iterator itor = mChainSegmentList.begin();
+                ChainSegmentList::const_iterator endt = mChainSegmentList.end();
+                while( itor != endt )
+                {
+                    *params++ = itor->colourChange.r;
+                    *params++ = itor->colourChange.g;
+                    *params++ = itor->colourChange.b;
+                    *params++ = itor->colourChange.a;
+
+                    *params++ = itor->widthChange;
+                    *params++ = itor->trimOdometer;
+                    *params++ = 0;
+                    *params++ = 0;
+                    ++itor;
+                }
+
+                mParamsBuffer->unmap( UO_KEEP_PERSISTENT );
+                mLastParamsFrame = mVaoManager->getFrameCount();
+                mParamsDirty = false;
+            }
+            else
+            {
+                //Try again next frame
+                queueUpdate();
+            }
+        }
+
+        if( mBoundsDirty )
+            updateBounds();
+    }
+    //-----------------------------------------------------------------------------------
+    const String& BillboardChain::getMovableType(void) const
+    {
+        return BillboardChainFactory::FACTORY_TYPE_NAME;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    String BillboardChainFactory::FACTORY_TYPE_NAME = "BillboardChainv2";
+    //-----------------------------------------------------------------------------------
+    const String& BillboardChainFactory::getType(void) const
+    {
+        return FACTORY_TYPE_NAME;
+    }
+    //-----------------------------------------------------------------------------------
+    MovableObject* BillboardChainFactory::createInstanceImpl( IdType id,
+                                                              ObjectMemoryManager *objectMemoryManager,
+                                                              SceneManager *manager,
+                                                              const NameValuePairList* params )
+    {
+        size_t maxElements = 20;
+        size_t numberOfChains = 1;
+
+        //Optional params
+        if( params )
+        {
+            NameValuePairList::const_iterator ni = params->find( "maxElements" );
+            if( ni != params->end() )
+                maxElements = StringConverter::parseSizeT( ni->second );
+
+            ni = params->find( "numberOfChains" );
+            if( ni != params->end() )
+                numberOfChains = StringConverter::parseSizeT( ni->second );
+        }
+
+        return OGRE_NEW BillboardChain( id, objectMemoryManager, manager,
+                                        maxElements, numberOfChains );
+    }
+    //-----------------------------------------------------------------------------------
+    void BillboardChainFactory::destroyInstance( MovableObject *obj )
+    {
+        OGRE_DELETE obj;
+    }
+}
@@ -46,6 +46,7 @@ namespace v1 {
     BillboardParticleRenderer::CmdCommonDirection BillboardParticleRenderer::msCommonDirectionCmd;
     BillboardParticleRenderer::CmdCommonUpVector BillboardParticleRenderer::msCommonUpVectorCmd;
     BillboardParticleRenderer::CmdPointRendering BillboardParticleRenderer::msPointRenderingCmd;
+    BillboardParticleRenderer::CmdInstancedRendering BillboardParticleRenderer::msInstancedRenderingCmd;
     BillboardParticleRenderer::CmdAccurateFacing BillboardParticleRenderer::msAccurateFacingCmd;
     //-----------------------------------------------------------------------
     BillboardParticleRenderer::BillboardParticleRenderer( IdType id,
@@ -101,6 +102,14 @@ namespace v1 {
                 "Possible values are 'true' or 'false'.",
                 PT_BOOL),
                 &msPointRenderingCmd);
+            dict->addParameter(ParameterDef("instanced_rendering",
+                "Set whether or not particles will be expanded into quads by the "
+                "vertex shader, uploading a small record per particle instead of "
+                "4 vertices. Only used with HlmsUnlit materials and camera facing "
+                "or common direction billboard types; otherwise it silently falls "
+                "back to regular rendering. Possible values are 'true' or 'false'.",
+                PT_BOOL),
+                &msInstancedRenderingCmd);
             dict->addParameter(ParameterDef("accurate_facing",
                 "Set whether or not particles will be oriented to the camera "
                 "based on the relative position to the camera rather than just "
@@ -294,6 +303,16 @@ namespace v1 {
         return mBillboardSet->isPointRenderingEnabled();
     }
     //-----------------------------------------------------------------------
+    void BillboardParticleRenderer::setInstancedRenderingEnabled( bool enabled )
+    {
+        mBillboardSet->setInstancedRenderingEnabled( enabled );
+    }
+    //-----------------------------------------------------------------------
+    bool BillboardParticleRenderer::isInstancedRenderingEnabled(void) const
+    {
+        return mBillboardSet->isInstancedRenderingEnabled();
+    }
+    //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     BillboardParticleRendererFactory::BillboardParticleRendererFactory()
@@ -502,6 +521,17 @@ namespace v1 {
             StringConverter::parseBool(val));
     }
     //-----------------------------------------------------------------------
+    String BillboardParticleRenderer::CmdInstancedRendering::doGet(const void* target) const
+    {
+        return StringConverter::toString(
+            static_cast<const BillboardParticleRenderer*>(target)->isInstancedRenderingEnabled() );
+    }
+    void BillboardParticleRenderer::CmdInstancedRendering::doSet(void* target, const String& val)
+    {
+        static_cast<BillboardParticleRenderer*>(target)->setInstancedRenderingEnabled(
+            StringConverter::parseBool(val));
+    }
+    //-----------------------------------------------------------------------
     String BillboardParticleRenderer::CmdAccurateFacing::doGet(const void* target) const
     {
         return StringConverter::toString(
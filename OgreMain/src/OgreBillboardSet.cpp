@@ -45,6 +45,7 @@ THE SOFTWARE.
 #include <algorithm>
 
 #include "Vao/OgreVaoManager.h"
+#include "Vao/OgreTexBufferPacked.h"
 
 namespace Ogre {
 namespace v1 {
@@ -73,6 +74,10 @@ namespace v1 {
         mCommonUpVector(Vector3::UNIT_Y),
         mVaoManager(0),
         mPointRendering(false),
+        mInstancedRendering(false),
+        mUsingInstancedRendering(false),
+        mCurrentInstanceBuffer(0),
+        mNumCustomTexcoordRects(0),
         mBuffersCreated(false),
         mPoolSize(poolSize),
         mExternalData(externalData),
@@ -145,6 +150,7 @@ namespace v1 {
         aabb.merge(newMax);
         mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
 
         return newBill;
     }
@@ -375,7 +381,70 @@ namespace v1 {
 
         // create vertex and index buffers if they haven't already been
         if(!mBuffersCreated)
+        {
+            _createBuffers();
+        }
+        else if( mUsingInstancedRendering != canRenderInstanced( mHlmsDatablock ) )
+        {
+            // The billboard type or the datablock changed, and now we need the other layout
+            _destroyBuffers();
             _createBuffers();
+        }
+
+        if( mUsingInstancedRendering )
+        {
+            // Same as with mMainBuffers: a dynamic buffer can only be mapped once per frame
+            if( mLastLockedFrame == mVaoManager->getFrameCount() )
+            {
+                ++mLastLockedBuffer;
+                if( mLastLockedBuffer >= mInstanceBuffers.size() )
+                    createInstanceBuffer();
+            }
+            else
+            {
+                mLastLockedBuffer = 0;
+                mLastLockedFrame  = mVaoManager->getFrameCount();
+            }
+
+            mCurrentInstanceBuffer = mInstanceBuffers[mLastLockedBuffer];
+
+            getParametricOffsets( mLeftOff, mRightOff, mTopOff, mBottomOff );
+            genBillboardAxes( &mCamX, &mCamY );
+
+            mNumVisibleBillboards   = 0;
+            mNumCustomTexcoordRects = 0;
+
+            const size_t texcoordStart = 3u + mPoolSize * 2u;
+
+            mLockPtr = reinterpret_cast<float*>(
+                           mCurrentInstanceBuffer->map( 0, mCurrentInstanceBuffer->getNumElements() ) );
+            float * RESTRICT_ALIAS header = mLockPtr;
+            *header++ = static_cast<float>( mCamX.x );
+            *header++ = static_cast<float>( mCamX.y );
+            *header++ = static_cast<float>( mCamX.z );
+            *header++ = static_cast<float>( mLeftOff );
+            *header++ = static_cast<float>( mCamY.x );
+            *header++ = static_cast<float>( mCamY.y );
+            *header++ = static_cast<float>( mCamY.z );
+            *header++ = static_cast<float>( mRightOff );
+            *header++ = static_cast<float>( mTopOff );
+            *header++ = static_cast<float>( mBottomOff );
+            *header++ = mRotationType == BBR_VERTEX ? 1.0f : 0.0f;
+            *header++ = static_cast<float>( texcoordStart );
+
+            float * RESTRICT_ALIAS texcoords = mLockPtr + texcoordStart * 4u;
+            TextureCoordSets::const_iterator itor = mTextureCoords.begin();
+            TextureCoordSets::const_iterator end  = mTextureCoords.end();
+            while( itor != end )
+            {
+                *texcoords++ = itor->left;
+                *texcoords++ = itor->top;
+                *texcoords++ = itor->right;
+                *texcoords++ = itor->bottom;
+                ++itor;
+            }
+            return;
+        }
 
         if( mLastLockedFrame == mVaoManager->getFrameCount() )
         {
@@ -459,6 +528,13 @@ namespace v1 {
         // Skip if not visible (NB always true if not bounds checking individual billboards)
         if (!billboardVisible(camera, bb)) return;
 
+        if( mUsingInstancedRendering )
+        {
+            genInstance( bb );
+            mNumVisibleBillboards++;
+            return;
+        }
+
         if (!mPointRendering &&
             (mBillboardType == BBT_ORIENTED_SELF ||
             mBillboardType == BBT_PERPENDICULAR_SELF ||
@@ -512,17 +588,67 @@ namespace v1 {
     //-----------------------------------------------------------------------
     void BillboardSet::endBillboards(void)
     {
-        mMainBuf->unlock();
+        if( mUsingInstancedRendering )
+        {
+            const size_t texcoordStart = 3u + mPoolSize * 2u;
+            const size_t bytesWritten = (texcoordStart + mTextureCoords.size() +
+                                         mNumCustomTexcoordRects) * 4u * sizeof(float);
+            mCurrentInstanceBuffer->unmap( UO_KEEP_PERSISTENT, 0, bytesWritten );
+            mLockPtr = 0;
+        }
+        else
+        {
+            mMainBuf->unlock();
+        }
+    }
+    //-----------------------------------------------------------------------
+    void BillboardSet::genInstance( const Billboard &bb )
+    {
+        uint32 texcoordIdx = static_cast<uint32>( bb.mTexcoordIndex );
+        if( bb.mUseTexcoordRect )
+        {
+            // Own rects go after the shared ones
+            texcoordIdx = static_cast<uint32>( mTextureCoords.size() ) + mNumCustomTexcoordRects;
+            float * RESTRICT_ALIAS texcoords = mLockPtr + (3u + mPoolSize * 2u + texcoordIdx) * 4u;
+            *texcoords++ = bb.mTexcoordRect.left;
+            *texcoords++ = bb.mTexcoordRect.top;
+            *texcoords++ = bb.mTexcoordRect.right;
+            *texcoords++ = bb.mTexcoordRect.bottom;
+            ++mNumCustomTexcoordRects;
+        }
+        assert( bb.mUseTexcoordRect || bb.mTexcoordIndex < mTextureCoords.size() );
+
+        const ColourValue &c = bb.mColour;
+        const uint32 colour =
+                (static_cast<uint32>( Math::saturate( c.r ) * 255.0f + 0.5f )) |
+                (static_cast<uint32>( Math::saturate( c.g ) * 255.0f + 0.5f ) << 8u) |
+                (static_cast<uint32>( Math::saturate( c.b ) * 255.0f + 0.5f ) << 16u) |
+                (static_cast<uint32>( Math::saturate( c.a ) * 255.0f + 0.5f ) << 24u);
+
+        const bool ownDimensions = !mAllDefaultSize && bb.mOwnDimensions;
+
+        float * RESTRICT_ALIAS record = mLockPtr + (3u + mNumVisibleBillboards * 2u) * 4u;
+        *record++ = static_cast<float>( bb.mPosition.x );
+        *record++ = static_cast<float>( bb.mPosition.y );
+        *record++ = static_cast<float>( bb.mPosition.z );
+        memcpy( record++, &colour, sizeof(uint32) );
+        *record++ = static_cast<float>( ownDimensions ? bb.mWidth : mDefaultWidth );
+        *record++ = static_cast<float>( ownDimensions ? bb.mHeight : mDefaultHeight );
+        *record++ = mAllDefaultRotation ? 0.0f : static_cast<float>( bb.mRotation.valueRadians() );
+        *record++ = static_cast<float>( texcoordIdx );
     }
     //-----------------------------------------------------------------------
     void BillboardSet::setBounds(const Aabb& aabb, Real radius)
     {
         mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = radius;
+        mObjectData.invalidateBounds();
     }
     //-----------------------------------------------------------------------
     void BillboardSet::_updateBounds(void)
     {
+        mObjectData.invalidateBounds();
+
         if (mActiveBillboards.empty())
         {
             // No billboards, null bbox
@@ -693,7 +819,7 @@ namespace v1 {
         if( !mPointRendering )
             vertexCount = mPoolSize * 4;
 
-        if( mAutoUpdate )
+        if( mAutoUpdate && !mUsingInstancedRendering )
         {
             const size_t dynamicBufferMultiplier = mVaoManager->getDynamicBufferMultiplier();
 
@@ -723,10 +849,44 @@ namespace v1 {
         }
     }
     //-----------------------------------------------------------------------
+    void BillboardSet::createInstanceBuffer(void)
+    {
+        //Header, 2 float4 per billboard, shared texcoord rects, and one own rect per billboard
+        const size_t numFloat4 = 3u + mPoolSize * 2u + mTextureCoords.size() + mPoolSize;
+        mInstanceBuffers.push_back( mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT,
+                                                                  numFloat4 * 4u * sizeof(float),
+                                                                  BT_DYNAMIC_PERSISTENT, 0, false ) );
+    }
+    //-----------------------------------------------------------------------
+    bool BillboardSet::canRenderInstanced( const HlmsDatablock *datablock ) const
+    {
+        if( !mInstancedRendering || mPointRendering || !mAutoUpdate )
+            return false;
+
+        //These need per billboard axes, which would make the records as big as the vertices
+        if( mBillboardType == BBT_ORIENTED_SELF || mBillboardType == BBT_PERPENDICULAR_SELF )
+            return false;
+        if( mAccurateFacing && mBillboardType != BBT_PERPENDICULAR_COMMON )
+            return false;
+
+        //Only HlmsUnlit knows how to expand the records
+        return datablock && datablock->mType == HLMS_UNLIT;
+    }
+    //-----------------------------------------------------------------------
     void BillboardSet::_createBuffers(void)
     {
         mVaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
 
+        {
+            HlmsDatablock *datablock = 0;
+            if( !mMaterialName.empty() && mMaterialGroup.empty() )
+            {
+                HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
+                datablock = hlmsManager->getDatablockNoDefault( mMaterialName );
+            }
+            mUsingInstancedRendering = canRenderInstanced( datablock );
+        }
+
         /* Allocate / reallocate vertex data
            Note that we allocate enough space for ALL the billboards in the pool, but only issue
            rendering operations for the sections relating to the active billboards
@@ -779,6 +939,33 @@ namespace v1 {
         mLastLockedFrame    = mVaoManager->getFrameCount() - 1;
         mMainBuf = mMainBuffers[0][0];
 
+        if( mUsingInstancedRendering )
+        {
+            /* The vertices never change: position holds the corner (-1 = left/top,
+               1 = right/bottom) and the billboard index. The vertex shader takes the
+               rest from the instance buffer (see getBillboardInstanceBuffer)
+            */
+            HardwareBufferLockGuard vertexLock( mMainBuf, HardwareBuffer::HBL_DISCARD );
+            float *pVert = static_cast<float*>( vertexLock.pData );
+            const RGBA white = 0xFFFFFFFF;
+
+            for( size_t bboard=0; bboard<mPoolSize; ++bboard )
+            {
+                for( size_t corner=0; corner<4u; ++corner )
+                {
+                    *pVert++ = (corner & 0x01) ? 1.0f : -1.0f;
+                    *pVert++ = (corner & 0x02) ? 1.0f : -1.0f;
+                    *pVert++ = static_cast<float>( bboard );
+                    memcpy( pVert++, &white, sizeof(RGBA) );
+                    *pVert++ = static_cast<float>( corner & 0x01 );
+                    *pVert++ = static_cast<float>( corner >> 1u );
+                }
+            }
+
+            createInstanceBuffer();
+            mCurrentInstanceBuffer = mInstanceBuffers[0];
+        }
+
         // bind position and diffuses
         binding->setBinding(0, mMainBuffers[0][0]);
 
@@ -877,6 +1064,19 @@ namespace v1 {
         mMainBuf.setNull();
         mMainBuffers.clear();
 
+        FastArray<TexBufferPacked*>::const_iterator itor = mInstanceBuffers.begin();
+        FastArray<TexBufferPacked*>::const_iterator end  = mInstanceBuffers.end();
+        while( itor != end )
+        {
+            if( (*itor)->getMappingState() != MS_UNMAPPED )
+                (*itor)->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyTexBuffer( *itor );
+            ++itor;
+        }
+        mInstanceBuffers.clear();
+        mCurrentInstanceBuffer = 0;
+        mUsingInstancedRendering = false;
+
         if( mHlmsDatablock && getMaterial().isNull() )
         {
             mHlmsDatablock->_unlinkRenderable( this );
@@ -1509,6 +1709,20 @@ namespace v1 {
         }
     }
 
+    //-----------------------------------------------------------------------
+    void BillboardSet::setInstancedRenderingEnabled( bool enabled )
+    {
+        if( enabled != mInstancedRendering )
+        {
+            mInstancedRendering = enabled;
+            _destroyBuffers();
+        }
+    }
+    //-----------------------------------------------------------------------
+    TexBufferPacked* BillboardSet::getBillboardInstanceBuffer(void) const
+    {
+        return mUsingInstancedRendering ? mCurrentInstanceBuffer : 0;
+    }
     //-----------------------------------------------------------------------
     void BillboardSet::setAutoUpdate(bool autoUpdate)
     {
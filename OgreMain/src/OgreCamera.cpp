@@ -57,6 +57,7 @@ namespace Ogre {
         mUseRenderingDistance(true),
         mLodCamera(0),
         mNeedsDepthClamp(false),
+        mHiZBuffer(0),
         mUseMinPixelSize(false),
         mPixelDisplayRatio(0),
         mConstantBiasScale(1.0f)
@@ -36,6 +36,7 @@ THE SOFTWARE.
 #include "Vao/OgreTexBufferPacked.h"
 #include "OgreRenderSystem.h"
 #include "OgreProfiler.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -207,10 +208,10 @@ namespace Ogre
                 {
                     StagingBuffer::Destination &lastElement = extraDestinations.back();
 
-                    if( lastElement.destination == dst.destination &&
-                        (lastElement.dstOffset + lastElement.length == dst.dstOffset) )
+                    if( lastElement.destination == extraDst.destination &&
+                        (lastElement.dstOffset + lastElement.length == extraDst.dstOffset) )
                     {
-                        lastElement.length += dst.length;
+                        lastElement.length += extraDst.length;
                     }
                     else
                     {
@@ -261,6 +262,7 @@ namespace Ogre
 
         if( itor == end )
         {
+            GpuMemoryTracker::TagScope memoryTagScope( GpuMemoryTag::Hlms );
             ConstBufferPacked *materialBuffer = _mVaoManager->createConstBuffer( mBufferSize, BT_DEFAULT,
                                                                                  0, false );
             BufferPacked *extraBuffer = 0;
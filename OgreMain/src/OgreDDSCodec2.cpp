@@ -1011,7 +1011,12 @@ namespace Ogre {
                 }
                 else
                 {
-                    if( header.pixelFormat.rgbBits != 24u )
+                    if( header.pixelFormat.rgbBits != 24u && srcBytesPerRow == dstBytesPerRow )
+                    {
+                        //No row padding. Read the whole mip at once
+                        stream->read( destPtr, srcBytesPerRow * height * depth );
+                    }
+                    else if( header.pixelFormat.rgbBits != 24u )
                     {
                         for( size_t z=0; z<depth; ++z )
                         {
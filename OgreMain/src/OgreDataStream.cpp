@@ -33,6 +33,24 @@ THE SOFTWARE.
 
 #include <fstream>
 
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#  define WIN32_LEAN_AND_MEAN
+#  if !defined(NOMINMAX) && defined(_MSC_VER)
+#   define NOMINMAX // required to stop windows.h messing up std::min
+#  endif
+#  include <windows.h>
+#elif OGRE_PLATFORM == OGRE_PLATFORM_LINUX || \
+    OGRE_PLATFORM == OGRE_PLATFORM_APPLE || \
+    OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS || \
+    OGRE_PLATFORM == OGRE_PLATFORM_ANDROID || \
+    OGRE_PLATFORM == OGRE_PLATFORM_FREEBSD
+#   define OGRE_MAPPED_FILE_POSIX
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
 namespace Ogre {
 
     //-----------------------------------------------------------------------
@@ -473,6 +491,104 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
+    MappedFileDataStream::MappedFileDataStream( const String &name, void *pMem, size_t inSize ) :
+        MemoryDataStream( name, pMem, inSize, false, true )
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+      , mFileMapping( 0 )
+#endif
+    {
+    }
+    //-----------------------------------------------------------------------
+    MappedFileDataStream::~MappedFileDataStream()
+    {
+        // Must be done here, ~MemoryDataStream only calls MemoryDataStream::close
+        close();
+    }
+    //-----------------------------------------------------------------------
+    MappedFileDataStream* MappedFileDataStream::open( const String &name, const String &fullPath )
+    {
+        MappedFileDataStream *retVal = 0;
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        const int wideLength = MultiByteToWideChar( CP_UTF8, 0, fullPath.c_str(), -1, 0, 0 );
+        if( wideLength <= 0 )
+            return 0;
+        std::wstring widePath( static_cast<size_t>( wideLength ), L'\0' );
+        MultiByteToWideChar( CP_UTF8, 0, fullPath.c_str(), -1, &widePath[0], wideLength );
+
+        HANDLE fileHandle = CreateFileW( widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, 0,
+                                         OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0 );
+        if( fileHandle == INVALID_HANDLE_VALUE )
+            return 0;
+
+        LARGE_INTEGER fileSize;
+        if( !GetFileSizeEx( fileHandle, &fileSize ) || fileSize.QuadPart <= 0 ||
+            static_cast<uint64>( fileSize.QuadPart ) > std::numeric_limits<size_t>::max() )
+        {
+            CloseHandle( fileHandle );
+            return 0;
+        }
+
+        // The mapping keeps the file open, the handle is no longer needed
+        HANDLE fileMapping = CreateFileMappingW( fileHandle, 0, PAGE_READONLY, 0, 0, 0 );
+        CloseHandle( fileHandle );
+        if( !fileMapping )
+            return 0;
+
+        void *data = MapViewOfFile( fileMapping, FILE_MAP_READ, 0, 0, 0 );
+        if( !data )
+        {
+            CloseHandle( fileMapping );
+            return 0;
+        }
+
+        retVal = OGRE_NEW MappedFileDataStream( name, data,
+                                                static_cast<size_t>( fileSize.QuadPart ) );
+        retVal->mFileMapping = fileMapping;
+#elif defined( OGRE_MAPPED_FILE_POSIX )
+        const int fd = ::open( fullPath.c_str(), O_RDONLY );
+        if( fd < 0 )
+            return 0;
+
+        struct stat fileStat;
+        if( fstat( fd, &fileStat ) != 0 || fileStat.st_size <= 0 )
+        {
+            ::close( fd );
+            return 0;
+        }
+
+        // The mapping keeps the file open, the descriptor is no longer needed
+        void *data = mmap( 0, static_cast<size_t>( fileStat.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+        ::close( fd );
+        if( data == MAP_FAILED )
+            return 0;
+
+        retVal = OGRE_NEW MappedFileDataStream( name, data, static_cast<size_t>( fileStat.st_size ) );
+#else
+        (void)name;
+        (void)fullPath;
+#endif
+        return retVal;
+    }
+    //-----------------------------------------------------------------------
+    void MappedFileDataStream::close(void)
+    {
+        mAccess = 0;
+        if( mData )
+        {
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+            UnmapViewOfFile( mData );
+            CloseHandle( mFileMapping );
+            mFileMapping = 0;
+#elif defined( OGRE_MAPPED_FILE_POSIX )
+            munmap( mData, mSize );
+#endif
+            mData = 0;
+            mPos = 0;
+            mEnd = 0;
+        }
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
     FileStreamDataStream::FileStreamDataStream(std::ifstream* s, bool freeOnClose)
         : DataStream(), mInStream(s), mFStreamRO(s), mFStream(0), mFreeOnClose(freeOnClose)
     {
@@ -0,0 +1,615 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreDecalTextureAtlas.h"
+
+#include "OgreTextureGpuManager.h"
+#include "OgreTextureGpu.h"
+#include "OgreImage2.h"
+#include "OgreTextureBox.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    DecalTextureAtlas::DecalTextureAtlas( TextureGpuManager *textureGpuManager, uint32 poolId,
+                                          uint32 width, uint32 height, uint8 numMipmaps,
+                                          PixelFormatGpu pixelFormat, uint16 initialSlices,
+                                          uint16 maxSlices ) :
+        mTextureGpuManager( textureGpuManager ),
+        mMasterTexture( 0 ),
+        mPoolId( poolId ),
+        mMaxSlices( std::max( maxSlices, initialSlices ) ),
+        mGrowthFactor( 2.0f ),
+        mEvictionDelay( 300u ),
+        mFrameCount( 0u ),
+        mNumLiveEntries( 0u ),
+        mListener( 0 )
+    {
+        mMasterTexture = mTextureGpuManager->reservePoolId( poolId, width, height,
+                                                            std::max<uint16>( initialSlices, 1u ),
+                                                            numMipmaps, pixelFormat );
+    }
+    //-----------------------------------------------------------------------------------
+    DecalTextureAtlas::~DecalTextureAtlas()
+    {
+        //Destruction of textures that are still loading gets delayed, and the pool
+        //can't be destroyed until it's empty
+        bool anyPending = false;
+        EntryMap::const_iterator itor = mEntries.begin();
+        EntryMap::const_iterator end  = mEntries.end();
+        while( itor != end && !anyPending )
+        {
+            anyPending = itor->first->getPendingResidencyChanges() != 0u;
+            ++itor;
+        }
+
+        if( anyPending )
+            mTextureGpuManager->waitForStreamingCompletion();
+
+        itor = mEntries.begin();
+        while( itor != end )
+        {
+            mTextureGpuManager->destroyTexture( itor->first );
+            ++itor;
+        }
+        mEntries.clear();
+
+        mTextureGpuManager->destroyTexture( mMasterTexture );
+        mMasterTexture = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::setGrowthFactor( float factor )
+    {
+        mGrowthFactor = std::max( factor, 1.0f );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 DecalTextureAtlas::getCapacity(void) const
+    {
+        return mMasterTexture->getNumSlices();
+    }
+    //-----------------------------------------------------------------------------------
+    static bool canEvictTexture( TextureGpu *texture )
+    {
+        //Anything else would free its slice later than we assume
+        return texture->getPendingResidencyChanges() == 0u && texture->isDataReady();
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::evict( EntryMap::iterator itor )
+    {
+        TextureGpu *texture = itor->first;
+        Entry &entry = itor->second;
+
+        OGRE_ASSERT_LOW( entry.isLive && entry.refCount == 0u );
+
+        entry.isLive = false;
+        --mNumLiveEntries;
+
+        if( entry.fromImage )
+        {
+            mTextureGpuManager->destroyTexture( texture );
+            mEntries.erase( itor );
+        }
+        else
+        {
+            texture->scheduleTransitionTo( GpuResidency::OnStorage );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool DecalTextureAtlas::evictLeastRecentlyUsed(void)
+    {
+        EntryMap::iterator bestCandidate = mEntries.end();
+
+        EntryMap::iterator itor = mEntries.begin();
+        EntryMap::iterator end  = mEntries.end();
+
+        while( itor != end )
+        {
+            const Entry &entry = itor->second;
+            if( entry.isLive && entry.refCount == 0u && canEvictTexture( itor->first ) &&
+                ( bestCandidate == end ||
+                  entry.lastUsedFrame < bestCandidate->second.lastUsedFrame ) )
+            {
+                bestCandidate = itor;
+            }
+            ++itor;
+        }
+
+        if( bestCandidate == end )
+            return false;
+
+        evict( bestCandidate );
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::grow(void)
+    {
+        const uint32 currentSlices = mMasterTexture->getNumSlices();
+        if( currentSlices >= mMaxSlices )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "DecalTextureAtlas with pool ID " + StringConverter::toString( mPoolId ) +
+                         " is full and all of its textures are in use. Increase maxSlices or "
+                         "release textures",
+                         "DecalTextureAtlas::grow" );
+        }
+
+        uint32 numSlices = static_cast<uint32>( Math::Ceil( currentSlices * mGrowthFactor ) );
+        numSlices = Math::Clamp<uint32>( numSlices, currentSlices + 1u, mMaxSlices );
+
+        mMasterTexture = mTextureGpuManager->resizeReservedPool( mMasterTexture, numSlices );
+
+        if( mListener )
+            mListener->atlasTextureChanged( this, mMasterTexture );
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::reserveSlice(void)
+    {
+        if( mNumLiveEntries < mMasterTexture->getNumSlices() )
+            return;
+
+        if( !evictLeastRecentlyUsed() )
+            grow();
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::makeLive( TextureGpu *texture, Entry &entry )
+    {
+        if( texture->getNextResidencyStatus() != GpuResidency::Resident )
+        {
+            reserveSlice();
+            texture->scheduleTransitionTo( GpuResidency::Resident );
+        }
+
+        entry.isLive = true;
+        ++mNumLiveEntries;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* DecalTextureAtlas::acquireTexture( const String &name, const String &resourceGroup,
+                                                   uint32 filters )
+    {
+        TextureGpu *texture =
+                mTextureGpuManager->createOrRetrieveTexture( name, GpuPageOutStrategy::Discard,
+                                                             TextureFlags::AutomaticBatching,
+                                                             TextureTypes::Type2D, resourceGroup,
+                                                             filters, mPoolId );
+
+        EntryMap::iterator itor = mEntries.find( texture );
+        if( itor == mEntries.end() )
+        {
+            Entry entry;
+            entry.refCount = 0u;
+            entry.lastUsedFrame = mFrameCount;
+            entry.fromImage = false;
+            entry.isLive = false;
+            itor = mEntries.insert( EntryMap::value_type( texture, entry ) ).first;
+        }
+
+        Entry &entry = itor->second;
+        ++entry.refCount;
+        if( !entry.isLive )
+            makeLive( texture, entry );
+
+        return texture;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* DecalTextureAtlas::acquireTexture( const String &aliasName, Image2 *image,
+                                                   bool autoDeleteImage )
+    {
+        TextureGpu *texture = mTextureGpuManager->findTextureNoThrow( aliasName );
+        if( texture )
+        {
+            EntryMap::iterator itor = mEntries.find( texture );
+            if( itor == mEntries.end() )
+            {
+                OGRE_EXCEPT( Exception::ERR_DUPLICATE_ITEM,
+                             "Texture '" + aliasName + "' already exists and does not belong "
+                             "to this DecalTextureAtlas",
+                             "DecalTextureAtlas::acquireTexture" );
+            }
+
+            if( autoDeleteImage )
+                OGRE_DELETE image;
+
+            ++itor->second.refCount;
+            return texture;
+        }
+
+        Image2 *finalImage = prepareImage( image, autoDeleteImage );
+        const bool ownsFinalImage = finalImage != image || autoDeleteImage;
+
+        texture = mTextureGpuManager->createOrRetrieveTexture( aliasName,
+                                                               GpuPageOutStrategy::Discard,
+                                                               TextureFlags::AutomaticBatching,
+                                                               TextureTypes::Type2D, BLANKSTRING,
+                                                               0u, mPoolId );
+
+        Entry entry;
+        entry.refCount = 1u;
+        entry.lastUsedFrame = mFrameCount;
+        entry.fromImage = true;
+        entry.isLive = true;
+        mEntries.insert( EntryMap::value_type( texture, entry ) );
+
+        reserveSlice();
+        ++mNumLiveEntries;
+        texture->scheduleTransitionTo( GpuResidency::Resident, finalImage, ownsFinalImage );
+
+        return texture;
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::updateTexture( TextureGpu *texture, Image2 *image, bool autoDeleteImage )
+    {
+        EntryMap::const_iterator itor = mEntries.find( texture );
+        if( itor == mEntries.end() || !itor->second.fromImage )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + texture->getNameStr() + "' is not a runtime generated "
+                         "texture of this DecalTextureAtlas",
+                         "DecalTextureAtlas::updateTexture" );
+        }
+
+        Image2 *finalImage = prepareImage( image, autoDeleteImage );
+        const bool ownsFinalImage = finalImage != image || autoDeleteImage;
+
+        if( texture->getResidencyStatus() == GpuResidency::Resident &&
+            canEvictTexture( texture ) )
+        {
+            finalImage->uploadTo( texture, 0, texture->getNumMipmaps() - 1u );
+            if( ownsFinalImage )
+                OGRE_DELETE finalImage;
+        }
+        else
+        {
+            //Still loading. Queue the new contents after the current ones
+            texture->scheduleTransitionTo( GpuResidency::OnStorage );
+            texture->scheduleTransitionTo( GpuResidency::Resident, finalImage, ownsFinalImage );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::releaseTexture( TextureGpu *texture )
+    {
+        EntryMap::iterator itor = mEntries.find( texture );
+        if( itor == mEntries.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Texture '" + texture->getNameStr() + "' does not belong to this "
+                         "DecalTextureAtlas",
+                         "DecalTextureAtlas::releaseTexture" );
+        }
+
+        Entry &entry = itor->second;
+        OGRE_ASSERT_LOW( entry.refCount > 0u && "Texture released more times than acquired" );
+        --entry.refCount;
+        if( entry.refCount == 0u )
+            entry.lastUsedFrame = mFrameCount;
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::update(void)
+    {
+        ++mFrameCount;
+
+        if( mEvictionDelay == std::numeric_limits<uint32>::max() )
+            return;
+
+        EntryMap::iterator itor = mEntries.begin();
+        EntryMap::iterator end  = mEntries.end();
+
+        while( itor != end )
+        {
+            EntryMap::iterator current = itor++;
+            const Entry &entry = current->second;
+            if( entry.isLive && entry.refCount == 0u &&
+                mFrameCount - entry.lastUsedFrame >= mEvictionDelay &&
+                canEvictTexture( current->first ) )
+            {
+                evict( current );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Image2* DecalTextureAtlas::prepareImage( Image2 *image, bool autoDeleteImage )
+    {
+        const uint32 width = mMasterTexture->getWidth();
+        const uint32 height = mMasterTexture->getHeight();
+        const uint8 numMipmaps = mMasterTexture->getNumMipmaps();
+        const PixelFormatGpu atlasFormat = mMasterTexture->getPixelFormat();
+
+        if( image->getWidth() != width || image->getHeight() != height ||
+            image->getNumSlices() != 1u )
+        {
+            if( autoDeleteImage )
+                OGRE_DELETE image;
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Image resolution must match that of the DecalTextureAtlas",
+                         "DecalTextureAtlas::prepareImage" );
+        }
+
+        if( image->getPixelFormat() == atlasFormat && image->getNumMipmaps() == numMipmaps )
+            return image;
+
+        Image2 *srcImage = image;
+        bool ownsSrcImage = autoDeleteImage;
+
+        if( srcImage->getNumMipmaps() < numMipmaps )
+        {
+            if( PixelFormatGpuUtils::isCompressed( srcImage->getPixelFormat() ) )
+            {
+                if( ownsSrcImage )
+                    OGRE_DELETE srcImage;
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Compressed images must have as many mipmaps as the atlas",
+                             "DecalTextureAtlas::prepareImage" );
+            }
+
+            if( !ownsSrcImage )
+            {
+                srcImage = OGRE_NEW Image2( *image );
+                ownsSrcImage = true;
+            }
+            srcImage->generateMipmaps( PixelFormatGpuUtils::isSRgb( atlasFormat ) );
+        }
+
+        const PixelFormatGpu srcFormat = srcImage->getPixelFormat();
+        const bool needsCompression = srcFormat != atlasFormat &&
+                                      !PixelFormatGpuUtils::isCompressed( srcFormat ) &&
+                                      PixelFormatGpuUtils::isCompressed( atlasFormat );
+
+        if( needsCompression && !canCompressTo( atlasFormat ) )
+        {
+            if( ownsSrcImage )
+                OGRE_DELETE srcImage;
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Can't compress images to " +
+                         String( PixelFormatGpuUtils::toString( atlasFormat ) ),
+                         "DecalTextureAtlas::prepareImage" );
+        }
+
+        Image2 *dstImage = OGRE_NEW Image2();
+        if( needsCompression )
+        {
+            compressImage( *srcImage, atlasFormat, *dstImage );
+        }
+        else
+        {
+            dstImage->createEmptyImage( width, height, 1u, TextureTypes::Type2D,
+                                        atlasFormat, numMipmaps );
+            for( uint8 mip=0; mip<numMipmaps; ++mip )
+            {
+                TextureBox srcBox = srcImage->getData( mip );
+                TextureBox dstBox = dstImage->getData( mip );
+                if( srcFormat == atlasFormat )
+                    dstBox.copyFrom( srcBox );
+                else
+                {
+                    PixelFormatGpuUtils::bulkPixelConversion( srcBox, srcFormat,
+                                                              dstBox, atlasFormat );
+                }
+            }
+        }
+
+        if( ownsSrcImage )
+            OGRE_DELETE srcImage;
+
+        return dstImage;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    /// Bounding box "range fit" encoder (see J.M.P. van Waveren, Real-Time DXT Compression).
+    /// Fast and good enough for decals & masks; not meant to compete with offline compressors.
+    static uint16 packRgb565( const float *rgb )
+    {
+        const uint32 r = static_cast<uint32>( Math::saturate( rgb[0] ) * 31.0f + 0.5f );
+        const uint32 g = static_cast<uint32>( Math::saturate( rgb[1] ) * 63.0f + 0.5f );
+        const uint32 b = static_cast<uint32>( Math::saturate( rgb[2] ) * 31.0f + 0.5f );
+        return static_cast<uint16>( (r << 11u) | (g << 5u) | b );
+    }
+    //-----------------------------------------------------------------------------------
+    static void unpackRgb565( uint16 colour, float *outRgb )
+    {
+        outRgb[0] = static_cast<float>( (colour >> 11u) & 0x1Fu ) / 31.0f;
+        outRgb[1] = static_cast<float>( (colour >> 5u) & 0x3Fu ) / 63.0f;
+        outRgb[2] = static_cast<float>( colour & 0x1Fu ) / 31.0f;
+    }
+    //-----------------------------------------------------------------------------------
+    static void encodeBc1Block( const float texels[16][4], uint8 *dst )
+    {
+        float minRgb[3] = { 1.0f, 1.0f, 1.0f };
+        float maxRgb[3] = { 0.0f, 0.0f, 0.0f };
+        for( size_t i=0; i<16u; ++i )
+        {
+            for( size_t c=0; c<3u; ++c )
+            {
+                minRgb[c] = std::min( minRgb[c], texels[i][c] );
+                maxRgb[c] = std::max( maxRgb[c], texels[i][c] );
+            }
+        }
+
+        //Inset the box slightly, reduces the error on the interpolated colours
+        for( size_t c=0; c<3u; ++c )
+        {
+            const float inset = (maxRgb[c] - minRgb[c]) / 16.0f;
+            minRgb[c] += inset;
+            maxRgb[c] -= inset;
+        }
+
+        uint16 c0 = packRgb565( maxRgb );
+        uint16 c1 = packRgb565( minRgb );
+        if( c0 < c1 )
+            std::swap( c0, c1 );
+
+        uint32 indices = 0;
+        if( c0 != c1 )
+        {
+            //c0 > c1 selects the 4 colour (opaque) mode
+            float palette[4][3];
+            unpackRgb565( c0, palette[0] );
+            unpackRgb565( c1, palette[1] );
+            for( size_t c=0; c<3u; ++c )
+            {
+                palette[2][c] = (2.0f * palette[0][c] + palette[1][c]) / 3.0f;
+                palette[3][c] = (palette[0][c] + 2.0f * palette[1][c]) / 3.0f;
+            }
+
+            for( size_t i=0; i<16u; ++i )
+            {
+                uint32 bestIdx = 0;
+                float bestDist = std::numeric_limits<float>::max();
+                for( uint32 j=0; j<4u; ++j )
+                {
+                    float dist = 0;
+                    for( size_t c=0; c<3u; ++c )
+                    {
+                        const float diff = texels[i][c] - palette[j][c];
+                        dist += diff * diff;
+                    }
+                    if( dist < bestDist )
+                    {
+                        bestDist = dist;
+                        bestIdx = j;
+                    }
+                }
+                indices |= bestIdx << (i * 2u);
+            }
+        }
+
+        dst[0] = static_cast<uint8>( c0 & 0xFFu );
+        dst[1] = static_cast<uint8>( c0 >> 8u );
+        dst[2] = static_cast<uint8>( c1 & 0xFFu );
+        dst[3] = static_cast<uint8>( c1 >> 8u );
+        for( size_t i=0; i<4u; ++i )
+            dst[4u + i] = static_cast<uint8>( (indices >> (i * 8u)) & 0xFFu );
+    }
+    //-----------------------------------------------------------------------------------
+    static void encodeBc4Block( const float texels[16][4], size_t channel, uint8 *dst )
+    {
+        float minVal = 1.0f;
+        float maxVal = 0.0f;
+        for( size_t i=0; i<16u; ++i )
+        {
+            minVal = std::min( minVal, texels[i][channel] );
+            maxVal = std::max( maxVal, texels[i][channel] );
+        }
+
+        const uint32 e0 = static_cast<uint32>( Math::saturate( maxVal ) * 255.0f + 0.5f );
+        const uint32 e1 = static_cast<uint32>( Math::saturate( minVal ) * 255.0f + 0.5f );
+
+        uint64 indices = 0;
+        if( e0 != e1 )
+        {
+            //e0 > e1 selects the 8 values mode. Palette order along the ramp from e0 to e1
+            //is 0, 2, 3, 4, 5, 6, 7, 1
+            const float fe0 = static_cast<float>( e0 ) / 255.0f;
+            const float fe1 = static_cast<float>( e1 ) / 255.0f;
+            const float invRange = 7.0f / (fe0 - fe1);
+            for( size_t i=0; i<16u; ++i )
+            {
+                const float t = (fe0 - Math::saturate( texels[i][channel] )) * invRange;
+                const uint32 step = static_cast<uint32>( Math::Clamp( t + 0.5f, 0.0f, 7.0f ) );
+                const uint64 idx = step == 0u ? 0u : (step == 7u ? 1u : step + 1u);
+                indices |= idx << (i * 3u);
+            }
+        }
+
+        dst[0] = static_cast<uint8>( e0 );
+        dst[1] = static_cast<uint8>( e1 );
+        for( size_t i=0; i<6u; ++i )
+            dst[2u + i] = static_cast<uint8>( (indices >> (i * 8u)) & 0xFFu );
+    }
+    //-----------------------------------------------------------------------------------
+    bool DecalTextureAtlas::canCompressTo( PixelFormatGpu format )
+    {
+        const PixelFormatGpu linearFormat = PixelFormatGpuUtils::getEquivalentLinear( format );
+        return linearFormat == PFG_BC1_UNORM || linearFormat == PFG_BC3_UNORM ||
+               linearFormat == PFG_BC4_UNORM || linearFormat == PFG_BC5_UNORM;
+    }
+    //-----------------------------------------------------------------------------------
+    void DecalTextureAtlas::compressImage( const Image2 &src, PixelFormatGpu dstFormat,
+                                           Image2 &outDst )
+    {
+        OGRE_ASSERT_LOW( canCompressTo( dstFormat ) );
+        OGRE_ASSERT_LOW( !PixelFormatGpuUtils::isCompressed( src.getPixelFormat() ) );
+
+        const PixelFormatGpu linearDstFormat = PixelFormatGpuUtils::getEquivalentLinear( dstFormat );
+        //Raw values; we don't want any gamma conversion
+        const PixelFormatGpu srcFormat =
+                PixelFormatGpuUtils::getEquivalentLinear( src.getPixelFormat() );
+
+        outDst.createEmptyImage( src.getWidth(), src.getHeight(), 1u, TextureTypes::Type2D,
+                                 dstFormat, src.getNumMipmaps() );
+
+        for( uint8 mip=0; mip<src.getNumMipmaps(); ++mip )
+        {
+            const TextureBox srcBox = src.getData( mip );
+            const TextureBox dstBox = outDst.getData( mip );
+
+            for( size_t by=0; by<srcBox.height; by += 4u )
+            {
+                for( size_t bx=0; bx<srcBox.width; bx += 4u )
+                {
+                    //Blocks that go past the edge (i.e. small mips) repeat the last texel
+                    float texels[16][4];
+                    for( size_t y=0; y<4u; ++y )
+                    {
+                        const size_t py = std::min<size_t>( by + y, srcBox.height - 1u );
+                        for( size_t x=0; x<4u; ++x )
+                        {
+                            const size_t px = std::min<size_t>( bx + x, srcBox.width - 1u );
+                            PixelFormatGpuUtils::unpackColour( texels[y * 4u + x], srcFormat,
+                                                               srcBox.at( px, py, 0 ) );
+                        }
+                    }
+
+                    uint8 *dstBlock = reinterpret_cast<uint8*>( dstBox.at( bx, by, 0 ) );
+                    switch( linearDstFormat )
+                    {
+                    case PFG_BC1_UNORM:
+                        encodeBc1Block( texels, dstBlock );
+                        break;
+                    case PFG_BC3_UNORM:
+                        encodeBc4Block( texels, 3u, dstBlock );
+                        encodeBc1Block( texels, dstBlock + 8u );
+                        break;
+                    case PFG_BC4_UNORM:
+                        encodeBc4Block( texels, 0u, dstBlock );
+                        break;
+                    case PFG_BC5_UNORM:
+                        encodeBc4Block( texels, 0u, dstBlock );
+                        encodeBc4Block( texels, 1u, dstBlock + 8u );
+                        break;
+                    default:
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -84,7 +84,6 @@ namespace Ogre {
         cameraPos.setAll( camera->_getCachedDerivedPosition() );
 
         ArrayReal lodInvBias( Mathlib::SetAll( camera->_getLodBiasInverse() * bias ) );
-        OGRE_ALIGNED_DECL( Real, lodValues[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
 
         for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
         {
@@ -92,9 +91,8 @@ namespace Ogre {
                                                                         (objData.mWorldRadius);
             ArrayReal arrayLodValue = objData.mWorldAabb->mCenter.distance( cameraPos ) - (*worldRadius);
             arrayLodValue = arrayLodValue * lodInvBias;
-            CastArrayToReal( lodValues, arrayLodValue );
 
-            lodSet( objData, lodValues );
+            lodSet( objData, arrayLodValue );
 
             objData.advanceLodPack();
         }
@@ -199,7 +199,8 @@ namespace Ogre {
             if (PKM_MAGIC == fileType)
                 return String("pkm");
         
-            if (KTX_MAGIC == fileType)
+            // Leave KTX 2.0 ("KTX 20") files to KTX2Codec
+            if (KTX_MAGIC == fileType && (maxbytes < 6u || magicNumberPtr[5] != '2'))
                 return String("ktx");
         }
 
@@ -177,6 +177,14 @@ namespace v1 {
         // Sort the geometries in the order of vertex set, so we can grouping
         // triangles by vertex set easy.
         std::sort(mGeometryList.begin(), mGeometryList.end(), geometryLess());
+
+        // Pre-size the hash tables for less rehashing on big meshes
+        size_t totalIndexCount = 0;
+        for (GeometryList::const_iterator it = mGeometryList.begin(); it != mGeometryList.end(); ++it)
+            totalIndexCount += it->indexData->indexCount;
+        mCommonVertexMap.rehash(totalIndexCount / 2u);
+        mEdgeMap.rehash(totalIndexCount / 2u);
+        mOpenEdges.reserve(totalIndexCount / 2u);
         // Initialize edge data
         mEdgeData = OGRE_NEW EdgeData();
         // resize the edge group list to equal the number of vertex sets
@@ -357,21 +365,41 @@ namespace v1 {
         EdgeMap::iterator emi = mEdgeMap.find(std::pair<size_t, size_t>(sharedVertIndex1, sharedVertIndex0));
         if (emi != mEdgeMap.end())
         {
-            // The edge already exist, connect it
-            EdgeData::Edge& e = mEdgeData->edgeGroups[emi->second.first].edges[emi->second.second];
+            // The edge already exist, connect it (oldest one first)
+            const OpenEdge &openEdge = mOpenEdges[emi->second.first];
+            EdgeData::Edge& e = mEdgeData->edgeGroups[openEdge.vertexSet].edges[openEdge.edgeIndex];
             // update with second side
             e.triIndex[1] = triangleIndex;
             e.degenerate = false;
 
             // Remove from the edge map, so we never supplied to connect edge again
-            mEdgeMap.erase(emi);
+            if (openEdge.next == static_cast<size_t>(~0))
+                mEdgeMap.erase(emi);
+            else
+                emi->second.first = openEdge.next;
         }
         else
         {
             // Not found, create new edge
-            mEdgeMap.insert(EdgeMap::value_type(
-                std::pair<size_t, size_t>(sharedVertIndex0, sharedVertIndex1),
-                std::pair<size_t, size_t>(vertexSet, mEdgeData->edgeGroups[vertexSet].edges.size())));
+            OpenEdge openEdge;
+            openEdge.vertexSet = vertexSet;
+            openEdge.edgeIndex = mEdgeData->edgeGroups[vertexSet].edges.size();
+            openEdge.next = static_cast<size_t>(~0);
+            const size_t openEdgeIdx = mOpenEdges.size();
+            mOpenEdges.push_back(openEdge);
+
+            OpenEdgeChain newChain;
+            newChain.first = openEdgeIdx;
+            newChain.last = openEdgeIdx;
+            std::pair<EdgeMap::iterator, bool> inserted = mEdgeMap.insert(EdgeMap::value_type(
+                std::pair<size_t, size_t>(sharedVertIndex0, sharedVertIndex1), newChain));
+            if (!inserted.second)
+            {
+                // There are already open edges on these vertices. Append ours
+                mOpenEdges[inserted.first->second.last].next = openEdgeIdx;
+                inserted.first->second.last = openEdgeIdx;
+            }
+
             EdgeData::Edge e;
             e.degenerate = true; // initialise as degenerate
 
@@ -166,6 +166,7 @@ namespace v1 {
         }
 
         mLodMesh = mMesh->_getLodValueArray();
+        mObjectData.invalidateLodRange();
 
         // Build main subentity list
         buildSubEntityList(mMesh, &mSubEntityList, prevMaterialsList.empty() ? 0 : &prevMaterialsList);
@@ -249,6 +250,7 @@ namespace v1 {
         mObjectData.mWorldAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
         mObjectData.mWorldRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
 
         mInitialised = true;
         mMeshStateCount = mMesh->getStateCount();
@@ -742,7 +744,7 @@ namespace v1 {
                                 mSoftwareVertexAnimVertexData : mMesh->sharedVertexData[VpNormal],
                             mSkelAnimVertexData,
                             blendMatrices, mMesh->sharedBlendIndexToBoneIndexMap.size(),
-                            blendNormals);
+                            blendNormals, mManager);
                     }
                     SubEntityList::iterator i, iend;
                     iend = mSubEntityList.end();
@@ -764,7 +766,7 @@ namespace v1 {
                                     se.mSoftwareVertexAnimVertexData : se.mSubMesh->vertexData[VpNormal],
                                 se.mSkelAnimVertexData,
                                 blendMatrices, se.mSubMesh->blendIndexToBoneIndexMap.size(),
-                                blendNormals);
+                                blendNormals, mManager);
                         }
 
                     }
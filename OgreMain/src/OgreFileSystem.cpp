@@ -60,6 +60,7 @@ THE SOFTWARE.
 namespace Ogre {
 
     bool FileSystemArchive::msIgnoreHidden = true;
+    bool FileSystemArchive::msUseMemoryMapping = false;
 
     //-----------------------------------------------------------------------
     FileSystemArchive::FileSystemArchive(const String& name, const String& archType, bool readOnly )
@@ -285,6 +286,13 @@ namespace Ogre {
         assert(ret == 0 && "Problem getting file size" );
         (void)ret;  // Silence warning
 
+        if (readOnly && msUseMemoryMapping && tagStat.st_size > 0)
+        {
+            MappedFileDataStream *mappedStream = MappedFileDataStream::open(filename, full_path);
+            if (mappedStream)
+                return DataStreamPtr(mappedStream);
+        }
+
         // Always open in binary mode
         // Also, always include reading
         std::ios::openmode mode = std::ios::in | std::ios::binary;
@@ -188,10 +188,16 @@ namespace Ogre
                                        Light::MAX_FORWARD_PLUS_LIGHTS, mCurrentLightList );
         }
 
+        const bool bRankedByImportance = rankLightsByImportance( camera, cachedGrid );
+
         const size_t numLights = mCurrentLightList.size();
 
         //Sort by distance to camera
-        std::sort( mCurrentLightList.begin(), mCurrentLightList.end(), OrderLightByDistanceToCamera3D );
+        if( !bRankedByImportance )
+        {
+            std::sort( mCurrentLightList.begin(), mCurrentLightList.end(),
+                       OrderLightByDistanceToCamera3D );
+        }
 
         //Allocate the buffers if not already.
         CachedGridBuffer &gridBuffers = cachedGrid->gridBuffers[cachedGrid->currentBufIdx];
@@ -224,6 +230,7 @@ namespace Ogre
 
         //Fill the first buffer with the light. The other buffer contains indexes into this list.
         fillGlobalLightListBuffer( camera, gridBuffers.globalLightListBuffer );
+        gridBuffers.numLights = static_cast<uint32>( numLights );
 
         //Fill the indexes buffer
         uint16 * RESTRICT_ALIAS gridBuffer = reinterpret_cast<uint16 * RESTRICT_ALIAS>(
@@ -41,20 +41,33 @@ THE SOFTWARE.
 
 #include "Vao/OgreVaoManager.h"
 #include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
 
 #include "Math/Array/OgreObjectMemoryManager.h"
 
 #include "OgreHlms.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreHlmsManager.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+#include "OgreTextureGpu.h"
+#include "OgreStringConverter.h"
+#include "OgreId.h"
 #include "OgreWireAabb.h"
 
 #include "OgreProfiler.h"
 
+#include "Threading/OgreWorkStealingScheduler.h"
+
 namespace Ogre
 {
     static const size_t c_reservedLightSlotsPerCell     = 3u;
     static const size_t c_reservedDecalsSlotsPerCell    = 1u;
     static const size_t c_reservedCubemapProbeSlotsPerCell  = 1u;
 
+    static const char *c_lightAssignmentJobName = "ForwardClustered/LightAssignment";
+
     ForwardClustered::ForwardClustered( uint32 width, uint32 height,
                                         uint32 numSlices, uint32 lightsPerCell,
                                         uint32 decalsPerCell, uint32 cubemapProbesPerCell,
@@ -69,7 +82,10 @@ namespace Ogre
         mNumSlices( 2 ),*/
         mReservedSlotsPerCell( ((lightsPerCell > 0u) ? 3u : 0u) + ((decalsPerCell > 0u) ? 1u : 0u) +
                                ((cubemapProbesPerCell > 0u) ? 1u : 0u) ),
-        mObjsPerCell( lightsPerCell + decalsPerCell + cubemapProbesPerCell + mReservedSlotsPerCell ),
+        //Always even, so the compute path can write the uint16 entries of
+        //a cell in pairs without touching its neighbours
+        mObjsPerCell( alignToNextMultiple( lightsPerCell + decalsPerCell + cubemapProbesPerCell +
+                                           mReservedSlotsPerCell, 2u ) ),
         mLightsPerCell( lightsPerCell ),
         mDecalsPerCell( decalsPerCell ),
         mCubemapProbesPerCell( cubemapProbesPerCell ),
@@ -79,7 +95,14 @@ namespace Ogre
         mMaxDistance( maxDistance ),
         mObjectMemoryManager( 0 ),
         mNodeMemoryManager( 0 ),
-        mDebugWireAabbFrozen( false )
+        mSliceScheduler( 0 ),
+        mDebugWireAabbFrozen( false ),
+        mGpuLightAssignment( false ),
+        mGpuUseDepthBounds( true ),
+        mGpuDispatchAllowed( false ),
+        mGpuDepthTexture( 0 ),
+        mGpuJob( 0 ),
+        mGpuRenderSystem( 0 )
     {
         //SIMD optimization restriction.
         assert( (width % ARRAY_PACKED_REALS) == 0 && "Width must be multiple of ARRAY_PACKED_REALS!" );
@@ -104,11 +127,14 @@ namespace Ogre
             sceneNode->attachObject( newCamera );
             mThreadCameras.push_back( newCamera );
         }
+
+        mSliceScheduler = new WorkStealingScheduler( mSceneManager->getNumWorkerThreads() );
     }
     //-----------------------------------------------------------------------------------
     ForwardClustered::~ForwardClustered()
     {
         setDebugFrustum( false );
+        destroyGpuJob();
 
         for( size_t i=mThreadCameras.size(); i--; )
         {
@@ -119,6 +145,9 @@ namespace Ogre
         }
         mThreadCameras.clear();
 
+        delete mSliceScheduler;
+        mSliceScheduler = 0;
+
         delete mObjectMemoryManager;
         delete mNodeMemoryManager;
 
@@ -139,14 +168,9 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void ForwardClustered::execute( size_t threadId, size_t numThreads )
     {
-        const size_t slicesPerThread = mNumSlices / numThreads;
-
-        for( size_t i=0; i<slicesPerThread; ++i )
-            collectLightForSlice( i + threadId * slicesPerThread, threadId );
-
-        const size_t slicesRemainder = mNumSlices % numThreads;
-        if( slicesRemainder > threadId )
-            collectLightForSlice( threadId + numThreads * slicesPerThread, threadId );
+        size_t slice;
+        while( mSliceScheduler->grabChunk( threadId, slice ) )
+            collectLightForSlice( slice, threadId );
     }
     //-----------------------------------------------------------------------------------
     inline size_t ForwardClustered::getDecalsOffsetStart() const
@@ -755,6 +779,170 @@ namespace Ogre
         outNumCubemapProbes = numCubemapProbes;
     }
     //-----------------------------------------------------------------------------------
+    bool ForwardClustered::canAssignOnGpu( const Camera *camera ) const
+    {
+        return mGpuLightAssignment && mGpuDispatchAllowed &&
+               camera->getProjectionType() == PT_PERSPECTIVE && !camera->isReflected() &&
+               mSceneManager->getDestinationRenderSystem()->getCapabilities()->hasCapability(
+                   RSC_COMPUTE_PROGRAM );
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardClustered::createGpuJob(void)
+    {
+    #if OGRE_NO_JSON
+        OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                     "ForwardClustered::setGpuLightAssignment requires Ogre to be built with JSON "
+                     "support and you must include the resources bundled at "
+                     "Samples/Media/2.0/scripts/materials/Common",
+                     "ForwardClustered::createGpuJob" );
+    #endif
+        HlmsCompute *hlmsCompute = Root::getSingleton().getHlmsManager()->getComputeHlms();
+        HlmsComputeJob *baseJob = hlmsCompute->findComputeJobNoThrow( c_lightAssignmentJobName );
+
+        if( !baseJob )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "To use ForwardClustered::setGpuLightAssignment, you must include the "
+                         "resources bundled at Samples/Media/2.0/scripts/materials/Common\n"
+                         "Could not find " + String( c_lightAssignmentJobName ),
+                         "ForwardClustered::createGpuJob" );
+        }
+
+        const String newId = StringConverter::toString( Id::generateNewId<ForwardClustered>() );
+        mGpuJob = baseJob->clone( String( c_lightAssignmentJobName ) + " " + newId );
+
+        //The grid's layout never changes
+        mGpuJob->setProperty( "grid_width", static_cast<int32>( mWidth ) );
+        mGpuJob->setProperty( "grid_height", static_cast<int32>( mHeight ) );
+        mGpuJob->setProperty( "num_slices", static_cast<int32>( mNumSlices ) );
+        mGpuJob->setProperty( "objs_per_cell", static_cast<int32>( mObjsPerCell ) );
+        mGpuJob->setProperty( "lights_per_cell", static_cast<int32>( mLightsPerCell ) );
+        mGpuJob->setProperty( "decals_per_cell", static_cast<int32>( mDecalsPerCell ) );
+        mGpuJob->setProperty( "decals_offset", static_cast<int32>( getDecalsOffsetStart() ) );
+        mGpuJob->setProperty( "cubemap_probes_per_cell",
+                              static_cast<int32>( mCubemapProbesPerCell ) );
+        mGpuJob->setProperty( "cubemap_probes_offset",
+                              static_cast<int32>( getCubemapProbesOffsetStart() ) );
+        mGpuJob->setNumTexUnits( 1u );
+
+        //One threadgroup per tile
+        mGpuJob->setNumThreadGroups( mWidth, mHeight, 1u );
+
+        mGpuRenderSystem = mSceneManager->getDestinationRenderSystem();
+
+        if( mGpuRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+        {
+            //The pixel shaders of the previous frame read the grid as a texture buffer
+            mGpuToUavTransition.oldLayout = ResourceLayout::Texture;
+            mGpuToUavTransition.newLayout = ResourceLayout::Uav;
+            mGpuToUavTransition.writeBarrierBits = 0;
+            mGpuToUavTransition.readBarrierBits  = ReadBarrier::Uav;
+            mGpuRenderSystem->_resourceTransitionCreated( &mGpuToUavTransition );
+        }
+
+        mGpuToTextureTransition.oldLayout = ResourceLayout::Uav;
+        mGpuToTextureTransition.newLayout = ResourceLayout::Texture;
+        mGpuToTextureTransition.writeBarrierBits = WriteBarrier::Uav;
+        mGpuToTextureTransition.readBarrierBits  = ReadBarrier::Texture;
+        mGpuRenderSystem->_resourceTransitionCreated( &mGpuToTextureTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardClustered::destroyGpuJob(void)
+    {
+        if( !mGpuJob )
+            return;
+
+        HlmsCompute *hlmsCompute = static_cast<HlmsCompute*>( mGpuJob->getCreator() );
+        hlmsCompute->destroyComputeJob( mGpuJob->getName() );
+        mGpuJob = 0;
+
+        if( mGpuRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+            mGpuRenderSystem->_resourceTransitionDestroyed( &mGpuToUavTransition );
+        mGpuRenderSystem->_resourceTransitionDestroyed( &mGpuToTextureTransition );
+        mGpuRenderSystem = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardClustered::assignOnGpu( const Camera *camera, CachedGridBuffer &gridBuffers,
+                                        size_t numLights, size_t numDecals,
+                                        size_t numCubemapProbes )
+    {
+        OgreProfile( "Forward Clustered GPU Light Assignment" );
+
+        if( !mGpuJob )
+            createGpuJob();
+
+        const int32 useDepthBounds = mGpuDepthTexture ? 1 : 0;
+        if( mGpuJob->getProperty( "depth_bounds" ) != useDepthBounds )
+        {
+            mGpuJob->setProperty( "depth_bounds", useDepthBounds );
+            mGpuJob->setNumTexUnits( useDepthBounds ? 2u : 1u );
+        }
+
+        DescriptorSetTexture2::BufferSlot texBufSlot(
+                    DescriptorSetTexture2::BufferSlot::makeEmpty() );
+        texBufSlot.buffer = gridBuffers.globalLightListBuffer;
+        mGpuJob->setTexBuffer( 0, texBufSlot );
+
+        if( mGpuDepthTexture )
+        {
+            DescriptorSetTexture2::TextureSlot texSlot(
+                        DescriptorSetTexture2::TextureSlot::makeEmpty() );
+            texSlot.texture = mGpuDepthTexture;
+            mGpuJob->setTexture( 1, texSlot );
+        }
+        gridBuffers.gpuDepthTexture = mGpuDepthTexture;
+
+        DescriptorSetUav::BufferSlot bufferSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+        bufferSlot.buffer = gridBuffers.gridUavBuffer;
+        bufferSlot.access = ResourceAccess::ReadWrite;
+        mGpuJob->_setUavBuffer( 0, bufferSlot );
+
+        //Same slice bounds as collectLightForSlice
+        const Real lastSliceFar = Ogre::max( camera->getFarClipDistance(),
+                                             -getDepthAtSlice( mNumSlices ) );
+        Real left, right, top, bottom;
+        camera->getFrustumExtents( left, right, top, bottom, FET_TAN_HALF_ANGLES );
+
+        ShaderParams &shaderParams = mGpuJob->getShaderParams( "default" );
+        ShaderParams::Param *param = shaderParams.findParameter( "numLights" );
+        if( param )
+            param->setManualValue( static_cast<uint32>( numLights ) );
+        param = shaderParams.findParameter( "numDecals" );
+        if( param )
+            param->setManualValue( static_cast<uint32>( numDecals ) );
+        param = shaderParams.findParameter( "numCubemapProbes" );
+        if( param )
+            param->setManualValue( static_cast<uint32>( numCubemapProbes ) );
+        param = shaderParams.findParameter( "decalFloat4Offset" );
+        if( param )
+            param->setManualValue( static_cast<uint32>( mDecalFloat4Offset ) );
+        param = shaderParams.findParameter( "cubemapProbeFloat4Offset" );
+        if( param )
+            param->setManualValue( static_cast<uint32>( mCubemapProbeFloat4Offset ) );
+        param = shaderParams.findParameter( "sliceParams" );
+        if( param )
+        {
+            param->setManualValue( Vector4( mMinDistance, mExponentK,
+                                            camera->getNearClipDistance(), lastSliceFar ) );
+        }
+        param = shaderParams.findParameter( "frustumExtents" );
+        if( param )
+            param->setManualValue( Vector4( left, right, top, bottom ) );
+        param = shaderParams.findParameter( "projectionParams" );
+        if( param )
+            param->setManualValue( camera->getProjectionParamsAB() );
+        shaderParams.setDirty();
+
+        mGpuRenderSystem->endRenderPassDescriptor();
+        if( mGpuRenderSystem->getCapabilities()->hasCapability( RSC_EXPLICIT_API ) )
+            mGpuRenderSystem->_executeResourceTransition( &mGpuToUavTransition );
+
+        HlmsCompute *hlmsCompute = static_cast<HlmsCompute*>( mGpuJob->getCreator() );
+        hlmsCompute->dispatch( mGpuJob, 0, 0 );
+
+        mGpuRenderSystem->_executeResourceTransition( &mGpuToTextureTransition );
+    }
+    //-----------------------------------------------------------------------------------
     inline bool OrderLightByDistanceToCamera( const Light *left, const Light *right )
     {
         if( left->getType() != right->getType() )
@@ -766,7 +954,22 @@ namespace Ogre
     {
         CachedGrid *cachedGrid = 0;
         if( getCachedGridFor( camera, &cachedGrid ) )
-            return; //Up to date.
+        {
+            //Up to date. Unless it was filled on the GPU before the depth prepass
+            //was available (i.e. by the pass creating it) and now we can tighten it.
+            const CachedGridBuffer &gridBuffers =
+                    cachedGrid->gridBuffers[cachedGrid->currentBufIdx];
+            if( !mGpuDepthTexture || !gridBuffers.gridUavBuffer ||
+                gridBuffers.gpuDepthTexture == mGpuDepthTexture || !canAssignOnGpu( camera ) )
+            {
+                return;
+            }
+
+            //We can't map the same buffers twice in the same frame
+            ++cachedGrid->currentBufIdx;
+            if( cachedGrid->currentBufIdx >= cachedGrid->gridBuffers.size() )
+                cachedGrid->gridBuffers.push_back( CachedGridBuffer() );
+        }
 
         OgreProfile( "Forward Clustered Light Collect" );
 
@@ -823,19 +1026,40 @@ namespace Ogre
         size_t numDecals, numCubemapProbes;
         collectObjs( camera, numDecals, numCubemapProbes );
 
+        const bool bRankedByImportance = rankLightsByImportance( camera, cachedGrid );
+
         const size_t numLights = mCurrentLightList.size();
 
         //Sort by distance to camera
-        std::sort( mCurrentLightList.begin(), mCurrentLightList.end(), OrderLightByDistanceToCamera );
+        if( !bRankedByImportance )
+        {
+            std::sort( mCurrentLightList.begin(), mCurrentLightList.end(),
+                       OrderLightByDistanceToCamera );
+        }
 
         //Allocate the buffers if not already.
         CachedGridBuffer &gridBuffers = cachedGrid->gridBuffers[cachedGrid->currentBufIdx];
+        const bool bAssignOnGpu = canAssignOnGpu( camera );
+        if( gridBuffers.gridBuffer && (gridBuffers.gridUavBuffer != 0) != bAssignOnGpu )
+            destroyGridBuffer( gridBuffers ); //Switched between the CPU & GPU paths
         if( !gridBuffers.gridBuffer )
         {
-            gridBuffers.gridBuffer = mVaoManager->createTexBuffer( PFG_R16_UINT,
-                                                                   mWidth * mHeight * mNumSlices *
-                                                                   mObjsPerCell * sizeof(uint16),
-                                                                   BT_DYNAMIC_PERSISTENT, 0, false );
+            const size_t gridBytes = mWidth * mHeight * mNumSlices * mObjsPerCell * sizeof(uint16);
+            if( bAssignOnGpu )
+            {
+                gridBuffers.gridUavBuffer = mVaoManager->createUavBuffer( gridBytes / sizeof(uint32),
+                                                                          sizeof(uint32),
+                                                                          BB_FLAG_UAV|BB_FLAG_TEX,
+                                                                          0, false );
+                gridBuffers.gridBuffer =
+                        gridBuffers.gridUavBuffer->getAsTexBufferView( PFG_R16_UINT );
+            }
+            else
+            {
+                gridBuffers.gridBuffer = mVaoManager->createTexBuffer( PFG_R16_UINT, gridBytes,
+                                                                       BT_DYNAMIC_PERSISTENT,
+                                                                       0, false );
+            }
         }
 
         const size_t bufferBytesNeeded = calculateBytesNeeded( std::max<size_t>( numLights, 96u ),
@@ -859,6 +1083,14 @@ namespace Ogre
 
         //Fill the first buffer with the light. The other buffer contains indexes into this list.
         fillGlobalLightListBuffer( camera, gridBuffers.globalLightListBuffer );
+        gridBuffers.numLights = static_cast<uint32>( numLights );
+
+        if( bAssignOnGpu )
+        {
+            assignOnGpu( camera, gridBuffers, numLights, numDecals, numCubemapProbes );
+            deleteOldGridBuffers();
+            return;
+        }
 
         //Fill the indexes buffer
         mGridBuffer = reinterpret_cast<uint16 * RESTRICT_ALIAS>(
@@ -871,6 +1103,7 @@ namespace Ogre
         mCurrentCamera->getDerivedPosition();
         mCurrentCamera->getWorldSpaceCorners();
 
+        mSliceScheduler->reset( mNumSlices );
         mSceneManager->executeUserScalableTask( this, true );
 
         if( !mDebugWireAabb.empty() && !mDebugWireAabbFrozen )
@@ -986,6 +1219,35 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void ForwardClustered::_collectLightsBeforePass( Camera *camera, TextureGpu *prePassDepthTexture )
+    {
+        if( !mGpuLightAssignment )
+            return;
+
+        mGpuDispatchAllowed = true;
+        if( mGpuUseDepthBounds && prePassDepthTexture && !prePassDepthTexture->isMultisample() )
+            mGpuDepthTexture = prePassDepthTexture;
+
+        collectLights( camera );
+
+        mGpuDispatchAllowed = false;
+        mGpuDepthTexture = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardClustered::_changeRenderSystem( RenderSystem *newRs )
+    {
+        destroyGpuJob();
+        ForwardPlusBase::_changeRenderSystem( newRs );
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardClustered::setGpuLightAssignment( bool bEnable, bool bUseDepthBounds )
+    {
+        mGpuLightAssignment = bEnable;
+        mGpuUseDepthBounds = bUseDepthBounds;
+        if( !bEnable )
+            destroyGpuJob();
+    }
+    //-----------------------------------------------------------------------------------
     void ForwardClustered::setDebugFrustum( bool bEnableDebugFrustumWireAabb )
     {
         if( bEnableDebugFrustumWireAabb )
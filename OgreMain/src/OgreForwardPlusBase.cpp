@@ -35,6 +35,7 @@ THE SOFTWARE.
 
 #include "Vao/OgreVaoManager.h"
 #include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
 
 #include "OgreHlms.h"
 
@@ -64,6 +65,11 @@ namespace Ogre
         mEnableVpls( false ),
         mDecalsEnabled( decalsEnabled ),
         mCubemapProbesEnabled( cubemapProbesEnabled ),
+        mLightImportanceEnabled( false ),
+        mDistantLightsToAmbient( false ),
+        mMinLightImportance( 0.01f ),
+        mLightImportanceFadeRange( 1.0f ),
+        mDistantLightsAmbientScale( 1.0f ),
   #if !OGRE_NO_FINE_LIGHT_MASK_GRANULARITY
         mFineLightMaskGranularity( true ),
   #endif
@@ -84,13 +90,7 @@ namespace Ogre
 
             while( itBuf != enBuf )
             {
-                if( itBuf->gridBuffer )
-                {
-                    if( itBuf->gridBuffer->getMappingState() != MS_UNMAPPED )
-                        itBuf->gridBuffer->unmap( UO_UNMAP_ALL );
-                    mVaoManager->destroyTexBuffer( itBuf->gridBuffer );
-                    itBuf->gridBuffer = 0;
-                }
+                destroyGridBuffer( *itBuf );
 
                 if( itBuf->globalLightListBuffer )
                 {
@@ -119,13 +119,7 @@ namespace Ogre
 
             while( itBuf != enBuf )
             {
-                if( itBuf->gridBuffer )
-                {
-                    if( itBuf->gridBuffer->getMappingState() != MS_UNMAPPED )
-                        itBuf->gridBuffer->unmap( UO_UNMAP_ALL );
-                    mVaoManager->destroyTexBuffer( itBuf->gridBuffer );
-                    itBuf->gridBuffer = 0;
-                }
+                destroyGridBuffer( *itBuf );
 
                 if( itBuf->globalLightListBuffer )
                 {
@@ -172,6 +166,7 @@ namespace Ogre
     {
         //const LightListInfo &globalLightList = mSceneManager->getGlobalLightList();
         const size_t numLights = mCurrentLightList.size();
+        OGRE_ASSERT_LOW( mLightFadeFactors.empty() || mLightFadeFactors.size() == numLights );
 
         size_t numDecals = 0;
         size_t numCubemapProbes = 0;
@@ -217,10 +212,12 @@ namespace Ogre
                                                                          numCubemapProbes ) ) );
         LightArray::const_iterator itLights = mCurrentLightList.begin();
         LightArray::const_iterator enLights = mCurrentLightList.end();
+        FastArray<float>::const_iterator itFade = mLightFadeFactors.begin();
 
         while( itLights != enLights )
         {
             const Light *light = *itLights;
+            const Real fade = mLightFadeFactors.empty() ? 1.0f : *itFade++;
 
             Vector3 lightPos = light->getParentNode()->_getDerivedPosition();
             lightPos = viewMatrix * lightPos;
@@ -233,7 +230,7 @@ namespace Ogre
 
             //vec3 lights[numLights].diffuse
             ColourValue colour = light->getDiffuseColour() *
-                                 light->getPowerScale();
+                                 (light->getPowerScale() * fade);
             *lightData++ = colour.r;
             *lightData++ = colour.g;
             *lightData++ = colour.b;
@@ -243,7 +240,7 @@ namespace Ogre
             ++lightData;
 
             //vec3 lights[numLights].specular
-            colour = light->getSpecularColour() * light->getPowerScale();
+            colour = light->getSpecularColour() * (light->getPowerScale() * fade);
             *lightData++ = colour.r;
             *lightData++ = colour.g;
             *lightData++ = colour.b;
@@ -471,6 +468,8 @@ namespace Ogre
         cachedGrid.visibilityMask = visibilityMask;
         cachedGrid.shadowNode  = mSceneManager->getCurrentShadowNode();
         cachedGrid.lastFrame   = mVaoManager->getFrameCount();
+        cachedGrid.distantLightsUpperHemi = ColourValue::Black;
+        cachedGrid.distantLightsLowerHemi = ColourValue::Black;
         cachedGrid.currentBufIdx = 0;
         cachedGrid.gridBuffers.resize( 1 );
 
@@ -512,6 +511,137 @@ namespace Ogre
         return false;
     }
     //-----------------------------------------------------------------------------------
+    bool ForwardPlusBase::rankLightsByImportance( Camera *camera, CachedGrid *cachedGrid )
+    {
+        mLightFadeFactors.clear();
+        cachedGrid->distantLightsUpperHemi = ColourValue::Black;
+        cachedGrid->distantLightsLowerHemi = ColourValue::Black;
+
+        if( !mLightImportanceEnabled )
+            return false;
+
+        mLightImportance.clear();
+        mLightImportance.reserve( mCurrentLightList.size() );
+
+        LightArray::const_iterator itor = mCurrentLightList.begin();
+        LightArray::const_iterator end  = mCurrentLightList.end();
+
+        while( itor != end )
+        {
+            Light *light = *itor;
+            const ColourValue colour = light->getDiffuseColour();
+            const Real intensity = std::max( std::max( colour.r, colour.g ), colour.b ) *
+                                   light->getPowerScale();
+            const Real distance = std::max( light->getCachedDistanceToCameraAsReal(), 1e-3f );
+            Real coverage = std::min( light->getAttenuationRange() / distance, Real( 1.0f ) );
+            coverage *= coverage;
+            mLightImportance.push_back( LightImportance( light, intensity * coverage, coverage ) );
+            ++itor;
+        }
+
+        std::sort( mLightImportance.begin(), mLightImportance.end() );
+
+        const Vector3 &camPos = camera->getDerivedPosition();
+        const Vector3 &hemisphereDir = mSceneManager->getAmbientLightHemisphereDir();
+        const Real invFadeRange = 1.0f / (mMinLightImportance * mLightImportanceFadeRange);
+
+        ColourValue upperHemi( ColourValue::Black );
+        ColourValue lowerHemi( ColourValue::Black );
+
+        mCurrentLightList.clear();
+        mLightFadeFactors.reserve( mLightImportance.size() );
+
+        FastArray<LightImportance>::const_iterator itImp = mLightImportance.begin();
+        FastArray<LightImportance>::const_iterator enImp = mLightImportance.end();
+
+        while( itImp != enImp )
+        {
+            const Real fade = Math::saturate( (itImp->importance - mMinLightImportance) *
+                                              invFadeRange );
+            if( fade > 0.0f )
+            {
+                mCurrentLightList.push_back( itImp->light );
+                mLightFadeFactors.push_back( static_cast<float>( fade ) );
+            }
+
+            if( mDistantLightsToAmbient && fade < 1.0f )
+            {
+                //Whatever we don't shade per pixel goes to the ambient lighting. Lights
+                //above the camera (relative to the hemisphere dir) light from above.
+                const Light *light = itImp->light;
+                Vector3 lightDir = light->getParentNode()->_getDerivedPosition() - camPos;
+                lightDir.normalise();
+                const Real upperWeight = lightDir.dotProduct( hemisphereDir ) * 0.5f + 0.5f;
+                const ColourValue colour = light->getDiffuseColour() *
+                                           (light->getPowerScale() * itImp->coverage *
+                                            (1.0f - fade));
+                upperHemi += colour * upperWeight;
+                lowerHemi += colour * (1.0f - upperWeight);
+            }
+
+            ++itImp;
+        }
+
+        cachedGrid->distantLightsUpperHemi = upperHemi * mDistantLightsAmbientScale;
+        cachedGrid->distantLightsLowerHemi = lowerHemi * mDistantLightsAmbientScale;
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardPlusBase::setLightImportance( bool enable, Real minImportance, Real fadeRange )
+    {
+        if( fadeRange <= 0.0f || minImportance <= 0.0f )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "minImportance and fadeRange must be greater than 0",
+                         "ForwardPlusBase::setLightImportance" );
+        }
+
+        mLightImportanceEnabled = enable;
+        mMinLightImportance = minImportance;
+        mLightImportanceFadeRange = fadeRange;
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardPlusBase::setDistantLightsToAmbient( bool enable, Real scale )
+    {
+        mDistantLightsToAmbient = enable;
+        mDistantLightsAmbientScale = scale;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ForwardPlusBase::getDistantLightsAmbient( const Camera *camera, ColourValue &outUpperHemi,
+                                                   ColourValue &outLowerHemi ) const
+    {
+        if( !mLightImportanceEnabled || !mDistantLightsToAmbient )
+            return false;
+
+        CachedGrid const *cachedGrid = 0;
+        getCachedGridFor( camera, &cachedGrid );
+        if( !cachedGrid || cachedGrid->lastFrame != mVaoManager->getFrameCount() )
+            return false;
+
+        outUpperHemi = cachedGrid->distantLightsUpperHemi;
+        outLowerHemi = cachedGrid->distantLightsLowerHemi;
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void ForwardPlusBase::destroyGridBuffer( CachedGridBuffer &gridBuffers )
+    {
+        if( gridBuffers.gridUavBuffer )
+        {
+            //gridBuffer is a view owned by the UAV
+            mVaoManager->destroyUavBuffer( gridBuffers.gridUavBuffer );
+            gridBuffers.gridUavBuffer = 0;
+            gridBuffers.gridBuffer = 0;
+        }
+        else if( gridBuffers.gridBuffer )
+        {
+            if( gridBuffers.gridBuffer->getMappingState() != MS_UNMAPPED )
+                gridBuffers.gridBuffer->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyTexBuffer( gridBuffers.gridBuffer );
+            gridBuffers.gridBuffer = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void ForwardPlusBase::deleteOldGridBuffers(void)
     {
         //Check if some of the caches are really old and delete them
@@ -529,13 +659,7 @@ namespace Ogre
 
                 while( itBuf != enBuf )
                 {
-                    if( itBuf->gridBuffer )
-                    {
-                        if( itBuf->gridBuffer->getMappingState() != MS_UNMAPPED )
-                            itBuf->gridBuffer->unmap( UO_UNMAP_ALL );
-                        mVaoManager->destroyTexBuffer( itBuf->gridBuffer );
-                        itBuf->gridBuffer = 0;
-                    }
+                    destroyGridBuffer( *itBuf );
 
                     if( itBuf->globalLightListBuffer )
                     {
@@ -592,6 +716,31 @@ namespace Ogre
         return cachedGrid->gridBuffers[cachedGrid->currentBufIdx].globalLightListBuffer;
     }
     //-----------------------------------------------------------------------------------
+    TexBufferPacked* ForwardPlusBase::findGlobalLightListBuffer( const Camera *camera,
+                                                                 uint32 &outNumLights ) const
+    {
+        outNumLights = 0;
+
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+
+        CachedGridVec::const_iterator itor = mCachedGrid.begin();
+        CachedGridVec::const_iterator end  = mCachedGrid.end();
+
+        while( itor != end )
+        {
+            if( itor->camera == camera && itor->lastFrame == currentFrame )
+            {
+                const CachedGridBuffer &gridBuffers = itor->gridBuffers[itor->currentBufIdx];
+                outNumLights = gridBuffers.numLights;
+                return gridBuffers.globalLightListBuffer;
+            }
+
+            ++itor;
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------------------
     void ForwardPlusBase::setHlmsPassProperties( Hlms *hlms )
     {
         //ForwardPlus should be overriden by derived class to set the method in use.
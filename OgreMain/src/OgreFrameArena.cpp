@@ -0,0 +1,219 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreFrameArena.h"
+
+namespace Ogre
+{
+    FrameArena::FrameArena( size_t chunkSize, FrameArenaManager *creator ) :
+        mCurrentOffset( 0 ),
+        mBytesUsed( 0 ),
+        mPeakBytesUsed( 0 ),
+        mChunkSize( chunkSize ),
+        mFrameGeneration( creator->getFrameGeneration() ),
+        mCreator( creator )
+    {
+        addChunk( mChunkSize );
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArena::~FrameArena()
+    {
+        freeChunks();
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameArena::addChunk( size_t minBytes )
+    {
+        Chunk chunk;
+        chunk.size = std::max( minBytes, mChunkSize );
+        chunk.data = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD( chunk.size, MEMCATEGORY_GENERAL ) );
+        mChunks.push_back( chunk );
+        mCurrentOffset = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameArena::freeChunks(void)
+    {
+        FastArray<Chunk>::const_iterator itor = mChunks.begin();
+        FastArray<Chunk>::const_iterator end  = mChunks.end();
+
+        while( itor != end )
+        {
+            OGRE_FREE_SIMD( itor->data, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+
+        mChunks.clear();
+        mCurrentOffset = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void* FrameArena::allocate( size_t bytes, size_t alignment )
+    {
+        assert( !(alignment & (alignment - 1u)) && "Alignment must be a power of 2" );
+
+        if( mFrameGeneration != mCreator->getFrameGeneration() )
+            reset();
+
+        //Chunks are allocated with OGRE_SIMD_ALIGNMENT, but alignment may be bigger
+        const Chunk *chunk = &mChunks.back();
+        uintptr_t address = reinterpret_cast<uintptr_t>( chunk->data ) + mCurrentOffset;
+        address = (address + alignment - 1u) & ~static_cast<uintptr_t>( alignment - 1u );
+
+        if( address + bytes > reinterpret_cast<uintptr_t>( chunk->data ) + chunk->size )
+        {
+            addChunk( bytes + alignment );
+            chunk = &mChunks.back();
+            address = reinterpret_cast<uintptr_t>( chunk->data );
+            address = (address + alignment - 1u) & ~static_cast<uintptr_t>( alignment - 1u );
+        }
+
+        const size_t newOffset = address + bytes - reinterpret_cast<uintptr_t>( chunk->data );
+        mBytesUsed += newOffset - mCurrentOffset;
+        mCurrentOffset = newOffset;
+
+        return reinterpret_cast<void*>( address );
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameArena::reset(void)
+    {
+        mPeakBytesUsed = std::max( mPeakBytesUsed, mBytesUsed );
+
+        if( mChunks.size() > 1u )
+        {
+            //Merge everything into a single chunk so next frame fits without overflowing
+            const size_t totalBytes = getBytesReserved();
+            freeChunks();
+            addChunk( totalBytes );
+        }
+
+        mCurrentOffset      = 0;
+        mBytesUsed          = 0;
+        mFrameGeneration    = mCreator->getFrameGeneration();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t FrameArena::getBytesReserved(void) const
+    {
+        size_t retVal = 0;
+        FastArray<Chunk>::const_iterator itor = mChunks.begin();
+        FastArray<Chunk>::const_iterator end  = mChunks.end();
+
+        while( itor != end )
+        {
+            retVal += itor->size;
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    template<> FrameArenaManager* Singleton<FrameArenaManager>::msSingleton = 0;
+    FrameArenaManager* FrameArenaManager::getSingletonPtr(void)
+    {
+        return msSingleton;
+    }
+    FrameArenaManager& FrameArenaManager::getSingleton(void)
+    {
+        assert( msSingleton );  return ( *msSingleton );
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArenaManager::FrameArenaManager( size_t chunkSize ) :
+        mTlsHandle( OGRE_TLS_INVALID_HANDLE ),
+        mChunkSize( chunkSize ),
+        mFrameGeneration( 0 )
+    {
+        Threads::CreateTls( &mTlsHandle );
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArenaManager::~FrameArenaManager()
+    {
+        mMutex.lock();
+        FrameArenaArray::const_iterator itor = mArenas.begin();
+        FrameArenaArray::const_iterator end  = mArenas.end();
+
+        while( itor != end )
+            delete *itor++;
+        mArenas.clear();
+        mMutex.unlock();
+
+        Threads::DestroyTls( mTlsHandle );
+        mTlsHandle = OGRE_TLS_INVALID_HANDLE;
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArena* FrameArenaManager::createThreadArena(void)
+    {
+        FrameArena *arena = new FrameArena( mChunkSize, this );
+
+        mMutex.lock();
+        mArenas.push_back( arena );
+        mMutex.unlock();
+
+        Threads::SetTls( mTlsHandle, arena );
+
+        return arena;
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArena& FrameArenaManager::getArena(void)
+    {
+        FrameArena *arena = reinterpret_cast<FrameArena*>( Threads::GetTls( mTlsHandle ) );
+
+        if( !arena )
+            arena = createThreadArena();
+
+        return *arena;
+    }
+    //-----------------------------------------------------------------------------------
+    FrameArena& FrameArenaManager::getThreadArena(void)
+    {
+        return getSingleton().getArena();
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameArenaManager::_notifyFrameEnded(void)
+    {
+        ++mFrameGeneration;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t FrameArenaManager::getPeakBytesUsed(void)
+    {
+        size_t retVal = 0;
+
+        mMutex.lock();
+        FrameArenaArray::const_iterator itor = mArenas.begin();
+        FrameArenaArray::const_iterator end  = mArenas.end();
+
+        while( itor != end )
+        {
+            retVal += (*itor)->getPeakBytesUsed();
+            ++itor;
+        }
+        mMutex.unlock();
+
+        return retVal;
+    }
+}
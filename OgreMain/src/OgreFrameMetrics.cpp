@@ -0,0 +1,208 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreFrameMetrics.h"
+#include "OgreLwString.h"
+
+namespace Ogre
+{
+    static const char *c_frameMetricNames[FrameMetric::NumFrameMetrics] =
+    {
+        "FrameTime",
+        "DrawCalls",
+        "Instances",
+        "PsoSwitches",
+        "BufferBytesUploaded",
+        "TexturesStreamed",
+        "TextureBytesStreamed",
+        "HlmsCacheMisses",
+        "VisibleObjects",
+        "CulledObjects",
+        "PacingWait",
+        "InputToGpuLatency",
+        "InputToPresentLatency"
+    };
+    //-----------------------------------------------------------------------------------
+    FrameMetrics::FrameMetrics() :
+        mNextSample( 0 ),
+        mNumSamples( 0 ),
+        mLastTime( 0 )
+    {
+        clearCurrent();
+        memset( mSamples, 0, sizeof( mSamples ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameMetrics::clearCurrent(void)
+    {
+        for( size_t i=0; i<FrameMetric::NumFrameMetrics; ++i )
+            mCurrent[i].set( 0 );
+        memset( mCurrentVisibleObjectsPerRq, 0, sizeof( mCurrentVisibleObjectsPerRq ) );
+        memset( mCurrentCulledObjectsPerRq, 0, sizeof( mCurrentCulledObjectsPerRq ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameMetrics::_addCullResults( uint8 renderQueueId, uint32 numVisible, uint32 numCulled )
+    {
+        mCurrentVisibleObjectsPerRq[renderQueueId] += numVisible;
+        mCurrentCulledObjectsPerRq[renderQueueId] += numCulled;
+        mCurrent[FrameMetric::VisibleObjects] += numVisible;
+        mCurrent[FrameMetric::CulledObjects] += numCulled;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameMetrics::_endFrame( uint64 timeUs, uint64 frameNumber )
+    {
+        mCurrent[FrameMetric::FrameTime].set( timeUs - mLastTime );
+        mLastTime = timeUs;
+
+        FrameMetricsSample &sample = mSamples[mNextSample];
+        sample.frameNumber = frameNumber;
+        for( size_t i=0; i<FrameMetric::NumFrameMetrics; ++i )
+            sample.values[i] = mCurrent[i].get();
+        memcpy( sample.visibleObjectsPerRq, mCurrentVisibleObjectsPerRq,
+                sizeof( mCurrentVisibleObjectsPerRq ) );
+        memcpy( sample.culledObjectsPerRq, mCurrentCulledObjectsPerRq,
+                sizeof( mCurrentCulledObjectsPerRq ) );
+
+        mNextSample = (mNextSample + 1u) % OGRE_FRAME_METRICS_SAMPLES;
+        mNumSamples = std::min<size_t>( mNumSamples + 1u, OGRE_FRAME_METRICS_SAMPLES );
+
+        clearCurrent();
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameMetrics::reset( uint64 timeUs )
+    {
+        clearCurrent();
+        mNextSample = 0;
+        mNumSamples = 0;
+        mLastTime   = timeUs;
+    }
+    //-----------------------------------------------------------------------------------
+    const FrameMetricsSample& FrameMetrics::getSample( size_t framesAgo ) const
+    {
+        assert( framesAgo < mNumSamples );
+        return mSamples[(mNextSample + OGRE_FRAME_METRICS_SAMPLES - 1u - framesAgo) %
+                        OGRE_FRAME_METRICS_SAMPLES];
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 FrameMetrics::getAverage( FrameMetric::FrameMetric metric, size_t numFrames ) const
+    {
+        numFrames = std::min( numFrames, mNumSamples );
+
+        uint64 accum = 0;
+        for( size_t i=0; i<numFrames; ++i )
+            accum += getSample( i ).values[metric];
+
+        return numFrames ? (accum / numFrames) : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 FrameMetrics::getMaximum( FrameMetric::FrameMetric metric, size_t numFrames ) const
+    {
+        numFrames = std::min( numFrames, mNumSamples );
+
+        uint64 maxValue = 0;
+        for( size_t i=0; i<numFrames; ++i )
+            maxValue = std::max( maxValue, getSample( i ).values[metric] );
+
+        return maxValue;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameMetrics::getHistogram( FrameMetric::FrameMetric metric, uint64 minValue,
+                                     uint64 maxValue, uint32 *outBuckets, size_t numBuckets,
+                                     size_t numFrames ) const
+    {
+        assert( numBuckets > 0u && maxValue > minValue );
+
+        memset( outBuckets, 0, sizeof( uint32 ) * numBuckets );
+
+        const uint64 range = maxValue - minValue;
+        numFrames = std::min( numFrames, mNumSamples );
+
+        for( size_t i=0; i<numFrames; ++i )
+        {
+            const uint64 value = getSample( i ).values[metric];
+
+            size_t bucketIdx = 0;
+            if( value >= maxValue )
+                bucketIdx = numBuckets - 1u;
+            else if( value > minValue )
+                bucketIdx = static_cast<size_t>( ((value - minValue) * numBuckets) / range );
+
+            ++outBuckets[bucketIdx];
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameMetrics::dumpJson( String &outJson, size_t numFrames ) const
+    {
+        char tmpBuffer[128];
+        LwString tmpStr( LwString::FromEmptyPointer( tmpBuffer, sizeof( tmpBuffer ) ) );
+
+        numFrames = std::min( numFrames, mNumSamples );
+
+        outJson += "[";
+
+        for( size_t i=numFrames; i--; )
+        {
+            const FrameMetricsSample &sample = getSample( i );
+
+            tmpStr.clear();
+            tmpStr.a( i != numFrames - 1u ? ",\n{" : "\n{", "\"Frame\":", sample.frameNumber );
+            outJson += tmpStr.c_str();
+
+            for( size_t j=0; j<FrameMetric::NumFrameMetrics; ++j )
+            {
+                tmpStr.clear();
+                tmpStr.a( ",\"", c_frameMetricNames[j], "\":", sample.values[j] );
+                outJson += tmpStr.c_str();
+            }
+
+            outJson += ",\"RenderQueues\":[";
+            bool firstRq = true;
+            for( uint32 rqId=0; rqId<OGRE_FRAME_METRICS_MAX_RQ; ++rqId )
+            {
+                if( sample.visibleObjectsPerRq[rqId] || sample.culledObjectsPerRq[rqId] )
+                {
+                    tmpStr.clear();
+                    tmpStr.a( firstRq ? "{\"Id\":" : ",{\"Id\":", rqId,
+                              ",\"Visible\":", sample.visibleObjectsPerRq[rqId],
+                              ",\"Culled\":", sample.culledObjectsPerRq[rqId], "}" );
+                    outJson += tmpStr.c_str();
+                    firstRq = false;
+                }
+            }
+            outJson += "]}";
+        }
+
+        outJson += "\n]\n";
+    }
+    //-----------------------------------------------------------------------------------
+    const char* FrameMetrics::getMetricName( FrameMetric::FrameMetric metric )
+    {
+        return c_frameMetricNames[metric];
+    }
+}
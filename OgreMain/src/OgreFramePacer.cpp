@@ -0,0 +1,280 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreFramePacer.h"
+#include "OgreCamera.h"
+#include "OgreFrameMetrics.h"
+#include "OgreProfiler.h"
+#include "OgreTimer.h"
+#include "OgreWindow.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    /// Frames whose GPU completion or present never gets reported (e.g. the
+    /// present window changed) are dropped after this many frames
+    static const size_t c_maxPendingFrames = 16u;
+
+    FramePacer::FramePacer( Timer *timer, FrameMetrics *frameMetrics ) :
+        mTimer( timer ),
+        mFrameMetrics( frameMetrics ),
+        mMaxFramesInFlight( 0 ),
+        mMaxFrameLatency( 0 ),
+        mLateLatchListener( 0 ),
+        mPresentWindow( 0 ),
+        mCurrentFrameCount( 0 ),
+        mInputTimeUs( 0 ),
+        mLastPacingWait( 0 ),
+        mLastInputToGpuLatency( 0 ),
+        mLastInputToPresentLatency( 0 ),
+        mFrameDeadline( 0 ),
+        mLastFrameEndTime( 0 ),
+        mFrameLate( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::setMaxFramesInFlight( uint8 maxFramesInFlight )
+    {
+        mMaxFramesInFlight = maxFramesInFlight;
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::setPresentWindow( Window *window )
+    {
+        mPresentWindow = window;
+        mPendingFrames.clear();
+        if( mPresentWindow && mMaxFrameLatency )
+            mPresentWindow->setMaxFrameLatency( mMaxFrameLatency );
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::setMaxFrameLatency( uint8 maxFrameLatency )
+    {
+        mMaxFrameLatency = maxFrameLatency;
+        if( mPresentWindow && mMaxFrameLatency )
+            mPresentWindow->setMaxFrameLatency( mMaxFrameLatency );
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::setLateLatchListener( LateLatchListener *listener )
+    {
+        mLateLatchListener = listener;
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::setFrameDeadline( uint64 deadlineUs )
+    {
+        mFrameDeadline = deadlineUs;
+        if( !mFrameDeadline )
+            mFrameLate = false;
+    }
+    //-----------------------------------------------------------------------------------
+    bool FramePacer::getRenderedPose( const Camera *camera, Quaternion &outOrientation,
+                                      Matrix4 &outProjMatrix ) const
+    {
+        FastArray<RenderedPose>::const_iterator itor = mRenderedPoses.begin();
+        FastArray<RenderedPose>::const_iterator end  = mRenderedPoses.end();
+        while( itor != end && itor->camera != camera )
+            ++itor;
+
+        if( itor == end )
+            return false;
+
+        outOrientation = itor->orientation;
+        outProjMatrix = itor->projMatrix;
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::markInputSampled(void)
+    {
+        mInputTimeUs = mTimer->getMicroseconds();
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::updatePendingFrames( VaoManager *vaoManager, uint64 timeUs )
+    {
+        bool gpuLatencyUpdated = false;
+
+        FastArray<PendingFrame>::iterator itor = mPendingFrames.begin();
+        FastArray<PendingFrame>::iterator end  = mPendingFrames.end();
+        while( itor != end )
+        {
+            if( !itor->gpuFinished && vaoManager->isFrameFinished( itor->frameCount ) )
+            {
+                //Frames finish in order, the last one we find is the newest
+                itor->gpuFinished = true;
+                mLastInputToGpuLatency = timeUs > itor->inputTimeUs ?
+                                             timeUs - itor->inputTimeUs : 0;
+                gpuLatencyUpdated = true;
+            }
+            ++itor;
+        }
+
+        if( gpuLatencyUpdated )
+            mFrameMetrics->add( FrameMetric::InputToGpuLatency, mLastInputToGpuLatency );
+
+        uint64 lastSubmittedId, lastShownId, microsecondsSinceShown;
+        if( mPresentWindow &&
+            mPresentWindow->getPresentStats( lastSubmittedId, lastShownId,
+                                             microsecondsSinceShown ) )
+        {
+            const uint64 now = mTimer->getMicroseconds();
+            const uint64 shownTimeUs = now > microsecondsSinceShown ?
+                                           now - microsecondsSinceShown : 0;
+
+            itor = mPendingFrames.begin();
+            end  = mPendingFrames.end();
+            while( itor != end )
+            {
+                if( itor->presentValid && itor->presentId <= lastShownId )
+                {
+                    //We only know when lastShownId was shown, not the ones before it
+                    if( itor->presentId == lastShownId )
+                    {
+                        mLastInputToPresentLatency = shownTimeUs > itor->inputTimeUs ?
+                                                         shownTimeUs - itor->inputTimeUs : 0;
+                        mFrameMetrics->add( FrameMetric::InputToPresentLatency,
+                                            mLastInputToPresentLatency );
+                    }
+                    itor->presentValid = false;
+                }
+                ++itor;
+            }
+        }
+
+        //Remove the frames we're fully done with
+        itor = mPendingFrames.begin();
+        while( itor != mPendingFrames.end() )
+        {
+            if( itor->gpuFinished && !itor->presentValid )
+                itor = mPendingFrames.erase( itor );
+            else
+                ++itor;
+        }
+
+        if( mPendingFrames.size() > c_maxPendingFrames )
+        {
+            mPendingFrames.erase( mPendingFrames.begin(),
+                                  mPendingFrames.begin() +
+                                  static_cast<ptrdiff_t>( mPendingFrames.size() -
+                                                          c_maxPendingFrames ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::_beginFrame( VaoManager *vaoManager )
+    {
+        mLatchedCameras.clear();
+        mLastPacingWait = 0;
+
+        if( vaoManager )
+        {
+            mCurrentFrameCount = vaoManager->getFrameCount();
+
+            const uint64 startTime = mTimer->getMicroseconds();
+            uint64 timeUs = startTime;
+
+            if( mMaxFramesInFlight &&
+                mMaxFramesInFlight < vaoManager->getDynamicBufferMultiplier() &&
+                mCurrentFrameCount >= mMaxFramesInFlight )
+            {
+                const uint32 frameToWait = mCurrentFrameCount - mMaxFramesInFlight;
+                if( !vaoManager->isFrameFinished( frameToWait ) )
+                {
+                    OgreProfileExhaustive( "FramePacer::waitForSpecificFrameToFinish" );
+                    vaoManager->waitForSpecificFrameToFinish( frameToWait );
+                    timeUs = mTimer->getMicroseconds();
+                    mLastPacingWait = timeUs - startTime;
+                    mFrameMetrics->add( FrameMetric::PacingWait, mLastPacingWait );
+                }
+            }
+
+            updatePendingFrames( vaoManager, timeUs );
+        }
+
+        mInputTimeUs = mTimer->getMicroseconds();
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::_endFrame( VaoManager *vaoManager )
+    {
+        if( !vaoManager )
+            return;
+
+        const uint64 endTime = mTimer->getMicroseconds();
+        mFrameLate = mFrameDeadline && mLastFrameEndTime &&
+                     endTime - mLastFrameEndTime > mFrameDeadline;
+        mLastFrameEndTime = endTime;
+
+        PendingFrame pendingFrame;
+        pendingFrame.frameCount     = mCurrentFrameCount;
+        pendingFrame.presentId      = 0;
+        pendingFrame.inputTimeUs    = mInputTimeUs;
+        pendingFrame.gpuFinished    = false;
+        pendingFrame.presentValid   = false;
+
+        uint64 lastShownId, microsecondsSinceShown;
+        if( mPresentWindow &&
+            mPresentWindow->getPresentStats( pendingFrame.presentId, lastShownId,
+                                             microsecondsSinceShown ) )
+        {
+            pendingFrame.presentValid = true;
+        }
+
+        mPendingFrames.push_back( pendingFrame );
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::_lateLatchCamera( Camera *camera )
+    {
+        if( std::find( mLatchedCameras.begin(), mLatchedCameras.end(), camera ) !=
+            mLatchedCameras.end() )
+        {
+            return;
+        }
+
+        mLatchedCameras.push_back( camera );
+        if( mLateLatchListener )
+            mLateLatchListener->lateLatch( camera );
+
+        FastArray<RenderedPose>::iterator itor = mRenderedPoses.begin();
+        FastArray<RenderedPose>::iterator end  = mRenderedPoses.end();
+        while( itor != end && itor->camera != camera )
+            ++itor;
+
+        if( itor == end )
+        {
+            mRenderedPoses.push_back( RenderedPose() );
+            itor = mRenderedPoses.end() - 1u;
+            itor->camera = camera;
+        }
+
+        itor->orientation = camera->getDerivedOrientation();
+        itor->projMatrix = camera->getProjectionMatrix();
+    }
+    //-----------------------------------------------------------------------------------
+    void FramePacer::_sampleLatestPose( Camera *camera )
+    {
+        if( mLateLatchListener )
+            mLateLatchListener->lateLatch( camera );
+    }
+}
@@ -461,11 +461,25 @@ namespace Ogre {
     //---------------------------------------------------------------------
     Codec::DecodeResult FreeImageCodec2::decode( DataStreamPtr& input ) const
     {
-        // Buffer stream into memory (TODO: override IO functions instead?)
-        MemoryDataStream memStream(input, true);
+        // Parse in place if the data is addressable, otherwise buffer stream into memory
+        // (TODO: override IO functions instead?)
+        MemoryDataStreamPtr memStream;
+        const uchar *srcData = input->getDataView();
+        size_t srcSize = input->size() - input->tell();
+        if( srcData )
+        {
+            srcData += input->tell();
+        }
+        else
+        {
+            memStream.bind( OGRE_NEW MemoryDataStream( input, true ) );
+            srcData = memStream->getPtr();
+            srcSize = memStream->size();
+        }
 
-        FIMEMORY* fiMem = FreeImage_OpenMemory( memStream.getPtr(),
-                                                static_cast<DWORD>( memStream.size() ) );
+        // FreeImage doesn't write to memory opened for reading
+        FIMEMORY* fiMem = FreeImage_OpenMemory( const_cast<uchar*>( srcData ),
+                                                static_cast<DWORD>( srcSize ) );
         FIBITMAP* fiBitmap = FreeImage_LoadFromMemory( (FREE_IMAGE_FORMAT)mFreeImageType, fiMem );
         if( !fiBitmap )
         {
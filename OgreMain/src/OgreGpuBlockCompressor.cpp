@@ -0,0 +1,293 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreGpuBlockCompressor.h"
+
+#include "OgreHlmsManager.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreRenderSystem.h"
+#include "OgreTextureGpuManager.h"
+#include "OgreTextureBox.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreStringConverter.h"
+#include "OgreId.h"
+
+namespace Ogre
+{
+    static const char *c_jobNames[GpuBlockCompressor::NumFormats] =
+    {
+        "BlockCompress/BC1",
+        "BlockCompress/BC3",
+        "BlockCompress/BC4",
+        "BlockCompress/BC5"
+    };
+
+    static GpuBlockCompressor::Format toCompressorFormat( PixelFormatGpu pixelFormat )
+    {
+        switch( pixelFormat )
+        {
+        case PFG_BC1_UNORM: case PFG_BC1_UNORM_SRGB:
+            return GpuBlockCompressor::BC1;
+        case PFG_BC3_UNORM: case PFG_BC3_UNORM_SRGB:
+            return GpuBlockCompressor::BC3;
+        case PFG_BC4_UNORM:
+            return GpuBlockCompressor::BC4;
+        case PFG_BC5_UNORM:
+            return GpuBlockCompressor::BC5;
+        default:
+            return GpuBlockCompressor::NumFormats;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    GpuBlockCompressor::GpuBlockCompressor( HlmsManager *hlmsManager,
+                                            TextureGpuManager *textureManager ) :
+        mHlmsCompute( hlmsManager->getComputeHlms() ),
+        mTextureManager( textureManager ),
+        mRenderSystem( hlmsManager->getRenderSystem() )
+    {
+        memset( mJobs, 0, sizeof( mJobs ) );
+
+        //TODO: The system does not support bits like Vulkan & D3D12 do.
+        //We need generic read layouts.
+        mResourceTransition.oldLayout = ResourceLayout::Undefined;
+        mResourceTransition.newLayout = ResourceLayout::Undefined;
+        //UAV writes must be visible to the copy that follows
+        mResourceTransition.writeBarrierBits = 0;
+        mResourceTransition.readBarrierBits = ReadBarrier::Texture | ReadBarrier::CpuRead;
+        mRenderSystem->_resourceTransitionCreated( &mResourceTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuBlockCompressor::~GpuBlockCompressor()
+    {
+        releaseTmpTextures();
+
+        for( size_t i=0; i<NumFormats; ++i )
+        {
+            for( size_t j=0; j<2u; ++j )
+            {
+                if( mJobs[i][j] )
+                {
+                    mHlmsCompute->destroyComputeJob( mJobs[i][j]->getName() );
+                    mJobs[i][j] = 0;
+                }
+            }
+        }
+
+        mRenderSystem->_resourceTransitionDestroyed( &mResourceTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsComputeJob* GpuBlockCompressor::getJob( Format format, bool srgb )
+    {
+        HlmsComputeJob *job = mJobs[format][srgb];
+        if( !job )
+        {
+    #if OGRE_NO_JSON
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "GpuBlockCompressor requires Ogre to be built with JSON support "
+                         "and you must include the resources bundled at "
+                         "Samples/Media/2.0/scripts/materials/Common",
+                         "GpuBlockCompressor::getJob" );
+    #endif
+            HlmsComputeJob *baseJob = mHlmsCompute->findComputeJobNoThrow( c_jobNames[format] );
+
+            if( !baseJob )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "To use GpuBlockCompressor, you must include the resources "
+                             "bundled at Samples/Media/2.0/scripts/materials/Common\n"
+                             "Could not find " + String( c_jobNames[format] ),
+                             "GpuBlockCompressor::getJob" );
+            }
+
+            const String newId = StringConverter::toString( Id::generateNewId<GpuBlockCompressor>() );
+            job = baseJob->clone( String( c_jobNames[format] ) + " " + newId );
+            if( srgb )
+                job->setProperty( "srgb", 1 );
+            mJobs[format][srgb] = job;
+        }
+
+        return job;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* GpuBlockCompressor::getTmpUavTexture( uint32 width, uint32 height,
+                                                      PixelFormatGpu pixelFormat )
+    {
+        vector<TextureGpu*>::type::const_iterator itor = mTmpTextures.begin();
+        vector<TextureGpu*>::type::const_iterator end  = mTmpTextures.end();
+
+        while( itor != end )
+        {
+            TextureGpu *texture = *itor;
+            if( texture->getWidth() == width && texture->getHeight() == height &&
+                texture->getPixelFormat() == pixelFormat )
+            {
+                return texture;
+            }
+            ++itor;
+        }
+
+        const String newId = StringConverter::toString( Id::generateNewId<GpuBlockCompressor>() );
+        TextureGpu *texture = mTextureManager->createTexture( "GpuBlockCompressor Tmp " + newId,
+                                                               GpuPageOutStrategy::Discard,
+                                                               TextureFlags::Uav|
+                                                               TextureFlags::NotTexture,
+                                                               TextureTypes::Type2D );
+        texture->setResolution( width, height );
+        texture->setPixelFormat( pixelFormat );
+        texture->setNumMipmaps( 1u );
+        texture->_transitionTo( GpuResidency::Resident, (uint8*)0 );
+        texture->_setNextResidencyStatus( GpuResidency::Resident );
+        mTmpTextures.push_back( texture );
+
+        return texture;
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuBlockCompressor::supportsFormat( PixelFormatGpu dstFormat )
+    {
+        return toCompressorFormat( dstFormat ) != NumFormats;
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuBlockCompressor::isSupported(void) const
+    {
+        const RenderSystemCapabilities *caps = mRenderSystem->getCapabilities();
+        return caps->hasCapability( RSC_COMPUTE_PROGRAM ) &&
+               caps->hasCapability( RSC_TEXTURE_COMPRESSION_DXT );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBlockCompressor::compress( TextureGpu *srcTexture, TextureGpu *dstTexture,
+                                       uint8 srcMipLevel, uint8 dstMipLevel )
+    {
+        const Format format = toCompressorFormat( dstTexture->getPixelFormat() );
+
+        if( format == NumFormats )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + dstTexture->getNameStr() + "' uses format " +
+                         PixelFormatGpuUtils::toString( dstTexture->getPixelFormat() ) +
+                         " which can't be encoded. Only BC1, BC3, BC4 and BC5 are supported",
+                         "GpuBlockCompressor::compress" );
+        }
+
+        if( srcTexture->getTextureType() != TextureTypes::Type2D ||
+            dstTexture->getTextureType() != TextureTypes::Type2D )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Only Type2D textures can be compressed. Src: '" +
+                         srcTexture->getNameStr() + "' Dst: '" + dstTexture->getNameStr() + "'",
+                         "GpuBlockCompressor::compress" );
+        }
+
+        if( !srcTexture->isTexture() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + srcTexture->getNameStr() + "' must not have "
+                         "TextureFlags::NotTexture to be compressed",
+                         "GpuBlockCompressor::compress" );
+        }
+
+        TextureBox dstBox = dstTexture->getEmptyBox( dstMipLevel );
+        const TextureBox srcTexBox = srcTexture->getEmptyBox( srcMipLevel );
+
+        if( !dstBox.equalSize( srcTexBox ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Resolution of '" + srcTexture->getNameStr() + "' at mip " +
+                         StringConverter::toString( srcMipLevel ) + " doesn't match '" +
+                         dstTexture->getNameStr() + "' at mip " +
+                         StringConverter::toString( dstMipLevel ),
+                         "GpuBlockCompressor::compress" );
+        }
+
+        const bool srgb = PixelFormatGpuUtils::isSRgb( srcTexture->getPixelFormat() ) &&
+                          PixelFormatGpuUtils::isSRgb( dstTexture->getPixelFormat() );
+        HlmsComputeJob *job = getJob( format, srgb );
+
+        const uint32 blocksX = ( dstBox.width + 3u ) / 4u;
+        const uint32 blocksY = ( dstBox.height + 3u ) / 4u;
+        const PixelFormatGpu uavFormat = ( format == BC1 || format == BC4 ) ? PFG_RG32_UINT :
+                                                                              PFG_RGBA32_UINT;
+        TextureGpu *uavTexture = getTmpUavTexture( blocksX, blocksY, uavFormat );
+
+        DescriptorSetTexture2::TextureSlot texSlot( DescriptorSetTexture2::TextureSlot::makeEmpty() );
+        texSlot.texture = srcTexture;
+        job->setTexture( 0, texSlot );
+
+        DescriptorSetUav::TextureSlot uavSlot( DescriptorSetUav::TextureSlot::makeEmpty() );
+        uavSlot.texture             = uavTexture;
+        uavSlot.access              = ResourceAccess::Write;
+        uavSlot.mipmapLevel         = 0;
+        uavSlot.textureArrayIndex   = 0;
+        uavSlot.pixelFormat         = uavFormat;
+        job->_setUavTexture( 0, uavSlot );
+
+        ShaderParams &shaderParams = job->getShaderParams( "default" );
+        ShaderParams::Param *param = shaderParams.findParameter( "srcLodIdx" );
+        if( param )
+        {
+            param->setManualValue( (int32)srcMipLevel );
+            shaderParams.setDirty();
+        }
+
+        mRenderSystem->endRenderPassDescriptor();
+        mHlmsCompute->dispatch( job, 0, 0 );
+        mRenderSystem->_executeResourceTransition( &mResourceTransition );
+
+        //The UAV has one texel per block, its box is in blocks while dstBox is in texels
+        uavTexture->copyTo( dstTexture, dstBox, dstMipLevel, uavTexture->getEmptyBox( 0 ), 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBlockCompressor::compress( TextureGpu *srcTexture, TextureGpu *dstTexture )
+    {
+        const uint8 numMips = dstTexture->getNumMipmaps();
+
+        if( srcTexture->getNumMipmaps() < numMips )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + srcTexture->getNameStr() + "' has fewer mipmaps than '" +
+                         dstTexture->getNameStr() + "'",
+                         "GpuBlockCompressor::compress" );
+        }
+
+        for( uint8 mip=0; mip<numMips; ++mip )
+            compress( srcTexture, dstTexture, mip, mip );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuBlockCompressor::releaseTmpTextures(void)
+    {
+        vector<TextureGpu*>::type::const_iterator itor = mTmpTextures.begin();
+        vector<TextureGpu*>::type::const_iterator end  = mTmpTextures.end();
+
+        while( itor != end )
+            mTextureManager->destroyTexture( *itor++ );
+
+        mTmpTextures.clear();
+    }
+}
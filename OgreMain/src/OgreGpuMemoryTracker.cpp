@@ -0,0 +1,360 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreGpuMemoryTracker.h"
+#include "OgreRoot.h"
+#include "OgreLwString.h"
+#include "OgreException.h"
+#include "OgreTextureGpu.h"
+#include "OgreTextureGpuManager.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreBufferPacked.h"
+
+namespace Ogre
+{
+    static const char *c_builtinTagNames[GpuMemoryTag::NumBuiltinTags] =
+    {
+        "Default",
+        "Compositor",
+        "ShadowMaps",
+        "Hlms",
+        "Vct",
+        "Probes",
+        "Terrain"
+    };
+    //-----------------------------------------------------------------------------------
+    GpuMemoryTracker::TagScope::TagScope( uint8 tag, bool bOverride ) :
+        mTracker( 0 )
+    {
+        Root *root = Root::getSingletonPtr();
+        if( root )
+            mTracker = root->getGpuMemoryTracker();
+        if( mTracker )
+        {
+            if( !bOverride && mTracker->getCurrentTag() != GpuMemoryTag::Default )
+                tag = mTracker->getCurrentTag();
+            mTracker->pushTag( tag );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    GpuMemoryTracker::TagScope::~TagScope()
+    {
+        if( mTracker )
+            mTracker->popTag();
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    GpuMemoryTracker::GpuMemoryTracker() :
+        mBufferPoolCapacity( 0 ),
+        mBufferPoolFreeBytes( 0 ),
+        mNextHistory( 0 ),
+        mNumHistory( 0 )
+    {
+        mTagNames.reserve( GpuMemoryTag::NumBuiltinTags );
+        for( size_t i=0; i<GpuMemoryTag::NumBuiltinTags; ++i )
+            mTagNames.push_back( c_builtinTagNames[i] );
+        mStats.resize( mTagNames.size() );
+        mTagStack.push_back( GpuMemoryTag::Default );
+        memset( mHistoryFrame, 0, sizeof( mHistoryFrame ) );
+    }
+    //-----------------------------------------------------------------------------------
+    uint8 GpuMemoryTracker::registerTag( const String &name )
+    {
+        StringVector::const_iterator itor = std::find( mTagNames.begin(), mTagNames.end(), name );
+        if( itor != mTagNames.end() )
+            return static_cast<uint8>( itor - mTagNames.begin() );
+
+        if( mTagNames.size() >= 256u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Can't register more than 256 GPU memory tags. Tried to register: " + name,
+                         "GpuMemoryTracker::registerTag" );
+        }
+
+        mTagNames.push_back( name );
+        mStats.resize( mTagNames.size() );
+        return static_cast<uint8>( mTagNames.size() - 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    const String& GpuMemoryTracker::getTagName( uint8 tag ) const
+    {
+        assert( tag < mTagNames.size() );
+        return mTagNames[tag];
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::pushTag( uint8 tag )
+    {
+        assert( tag < mTagNames.size() );
+        mTagStack.push_back( tag );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::popTag(void)
+    {
+        assert( mTagStack.size() > 1u && "popTag called more times than pushTag!" );
+        if( mTagStack.size() > 1u )
+            mTagStack.pop_back();
+    }
+    //-----------------------------------------------------------------------------------
+    uint8 GpuMemoryTracker::getTagForNewResource(void)
+    {
+        Root *root = Root::getSingletonPtr();
+        if( root && root->getGpuMemoryTracker() )
+            return root->getGpuMemoryTracker()->getCurrentTag();
+        return GpuMemoryTag::Default;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::update( VaoManager *vaoManager, TextureGpuManager *textureGpuManager,
+                                   uint64 frameNumber )
+    {
+        GpuMemoryTagStatsVec newStats( mTagNames.size() );
+
+        mBufferPoolCapacity = 0;
+        mBufferPoolFreeBytes = 0;
+
+        if( vaoManager )
+        {
+            vaoManager->_collectMemoryTagStats( newStats );
+
+            VaoManager::MemoryStatsEntryVec memStats;
+            size_t freeBytes = 0;
+            vaoManager->getMemoryStats( memStats, mBufferPoolCapacity, freeBytes, 0 );
+            mBufferPoolFreeBytes = freeBytes;
+        }
+
+        if( textureGpuManager )
+            textureGpuManager->_collectMemoryTagStats( newStats );
+
+        FastArray<size_t> &history = mHistory[mNextHistory];
+        history.resizePOD( newStats.size() );
+        for( size_t i=0; i<newStats.size(); ++i )
+        {
+            const size_t prevPeak = mStats[i].peakBytes;
+            newStats[i].peakBytes = std::max( prevPeak, newStats[i].getTotalBytes() );
+            history[i] = newStats[i].getTotalBytes();
+        }
+        mHistoryFrame[mNextHistory] = frameNumber;
+
+        mNextHistory = (mNextHistory + 1u) % OGRE_GPU_MEMORY_TRACKER_SAMPLES;
+        mNumHistory = std::min<size_t>( mNumHistory + 1u, OGRE_GPU_MEMORY_TRACKER_SAMPLES );
+
+        mStats.swap( newStats );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::resetPeaks(void)
+    {
+        GpuMemoryTagStatsVec::iterator itor = mStats.begin();
+        GpuMemoryTagStatsVec::iterator end  = mStats.end();
+
+        while( itor != end )
+        {
+            itor->peakBytes = itor->getTotalBytes();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::dumpCsv( String &outCsv ) const
+    {
+        char tmpBuffer[512];
+        LwString text( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+
+        outCsv += "Tag,Buffer Bytes,Texture Bytes,Total Bytes,Wasted Bytes,Peak Bytes,"
+                  "Num Buffers,Num Textures\n";
+
+        for( size_t i=0; i<mStats.size(); ++i )
+        {
+            const GpuMemoryTagStats &stats = mStats[i];
+            text.clear();
+            text.a( mTagNames[i].c_str(), ",", (uint64)stats.bufferBytes, "," );
+            text.a( (uint64)stats.textureBytes, ",", (uint64)stats.getTotalBytes(), "," );
+            text.a( (uint64)stats.wastedBytes, ",", (uint64)stats.peakBytes, "," );
+            text.a( stats.numBuffers, ",", stats.numTextures, "\n" );
+            outCsv += text.c_str();
+        }
+
+        text.clear();
+        text.a( "BufferPoolFree,0,0,", (uint64)mBufferPoolFreeBytes, ",",
+                (uint64)mBufferPoolFreeBytes, ",0,0,0\n" );
+        outCsv += text.c_str();
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::dumpHistoryCsv( String &outCsv ) const
+    {
+        char tmpBuffer[128];
+        LwString text( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+
+        outCsv += "Frame";
+        for( size_t i=0; i<mTagNames.size(); ++i )
+        {
+            outCsv += ",";
+            outCsv += mTagNames[i];
+        }
+        outCsv += "\n";
+
+        const size_t firstIdx = (mNextHistory + OGRE_GPU_MEMORY_TRACKER_SAMPLES - mNumHistory) %
+                                OGRE_GPU_MEMORY_TRACKER_SAMPLES;
+        for( size_t i=0; i<mNumHistory; ++i )
+        {
+            const size_t idx = (firstIdx + i) % OGRE_GPU_MEMORY_TRACKER_SAMPLES;
+            const FastArray<size_t> &history = mHistory[idx];
+
+            text.clear();
+            text.a( mHistoryFrame[idx] );
+            outCsv += text.c_str();
+
+            for( size_t j=0; j<mTagNames.size(); ++j )
+            {
+                text.clear();
+                //Tags registered after this entry was recorded didn't exist back then
+                text.a( ",", (uint64)(j < history.size() ? history[j] : 0u) );
+                outCsv += text.c_str();
+            }
+            outCsv += "\n";
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::dumpJson( String &outJson ) const
+    {
+        char tmpBuffer[512];
+        LwString text( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+
+        text.a( "{\n\t\"buffer_pool_capacity\" : ", (uint64)mBufferPoolCapacity,
+                ",\n\t\"buffer_pool_free\" : ", (uint64)mBufferPoolFreeBytes,
+                ",\n\t\"tags\" :\n\t[" );
+        outJson += text.c_str();
+
+        for( size_t i=0; i<mStats.size(); ++i )
+        {
+            const GpuMemoryTagStats &stats = mStats[i];
+            text.clear();
+            text.a( i == 0u ? "\n" : ",\n", "\t\t{ \"name\" : \"", mTagNames[i].c_str(),
+                    "\", \"buffer_bytes\" : ", (uint64)stats.bufferBytes );
+            text.a( ", \"texture_bytes\" : ", (uint64)stats.textureBytes,
+                    ", \"wasted_bytes\" : ", (uint64)stats.wastedBytes );
+            text.a( ", \"peak_bytes\" : ", (uint64)stats.peakBytes,
+                    ", \"num_buffers\" : ", stats.numBuffers );
+            text.a( ", \"num_textures\" : ", stats.numTextures, " }" );
+            outJson += text.c_str();
+        }
+
+        outJson += "\n\t],\n\t\"history\" :\n\t[";
+
+        const size_t firstIdx = (mNextHistory + OGRE_GPU_MEMORY_TRACKER_SAMPLES - mNumHistory) %
+                                OGRE_GPU_MEMORY_TRACKER_SAMPLES;
+        for( size_t i=0; i<mNumHistory; ++i )
+        {
+            const size_t idx = (firstIdx + i) % OGRE_GPU_MEMORY_TRACKER_SAMPLES;
+            const FastArray<size_t> &history = mHistory[idx];
+
+            text.clear();
+            text.a( i == 0u ? "\n" : ",\n", "\t\t{ \"frame\" : ", mHistoryFrame[idx],
+                    ", \"total_bytes\" : [" );
+            outJson += text.c_str();
+
+            for( size_t j=0; j<history.size(); ++j )
+            {
+                text.clear();
+                text.a( j == 0u ? " " : ", ", (uint64)history[j] );
+                outJson += text.c_str();
+            }
+            outJson += " ] }";
+        }
+
+        outJson += "\n\t]\n}\n";
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuMemoryTracker::generateLeakReport( String &outReport, uint8 tag, VaoManager *vaoManager,
+                                               TextureGpuManager *textureGpuManager ) const
+    {
+        char tmpBuffer[1024];
+        LwString text( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+
+        outReport += "Live GPU allocations tagged '" + getTagName( tag ) + "'\n";
+
+        size_t totalBytes = 0;
+
+        if( vaoManager )
+        {
+            BufferPackedVec buffers;
+            vaoManager->_getBuffersWithMemoryTag( tag, buffers );
+
+            text.clear();
+            text.a( "Buffers: ", (uint32)buffers.size(), "\n" );
+            outReport += text.c_str();
+
+            BufferPackedVec::const_iterator itor = buffers.begin();
+            BufferPackedVec::const_iterator end  = buffers.end();
+
+            while( itor != end )
+            {
+                const BufferPacked *buffer = *itor;
+                text.clear();
+                text.a( "\tType ", (uint32)buffer->getBufferPackedType(),
+                        " BufferType ", (uint32)buffer->getBufferType(),
+                        " Bytes ", (uint64)buffer->_getInternalTotalSizeBytes(), "\n" );
+                outReport += text.c_str();
+                totalBytes += buffer->_getInternalTotalSizeBytes();
+                ++itor;
+            }
+        }
+
+        if( textureGpuManager )
+        {
+            TextureGpuVec textures;
+            textureGpuManager->_getTexturesWithMemoryTag( tag, textures );
+
+            text.clear();
+            text.a( "Textures: ", (uint32)textures.size(), "\n" );
+            outReport += text.c_str();
+
+            TextureGpuVec::const_iterator itor = textures.begin();
+            TextureGpuVec::const_iterator end  = textures.end();
+
+            while( itor != end )
+            {
+                const TextureGpu *texture = *itor;
+                const size_t sizeBytes = texture->getResidencyStatus() == GpuResidency::Resident ?
+                                             texture->getSizeBytes() : 0u;
+                text.clear();
+                text.a( "\t", texture->getNameStr().c_str(), " " );
+                text.a( texture->getWidth(), "x", texture->getHeight(), "x",
+                        texture->getDepthOrSlices() );
+                text.a( " Bytes ", (uint64)sizeBytes, "\n" );
+                outReport += text.c_str();
+                totalBytes += sizeBytes;
+                ++itor;
+            }
+        }
+
+        text.clear();
+        text.a( "Total bytes: ", (uint64)totalBytes, "\n" );
+        outReport += text.c_str();
+    }
+}
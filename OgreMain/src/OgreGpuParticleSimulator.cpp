@@ -0,0 +1,939 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreGpuParticleSimulator.h"
+#include "OgreParticleSystem.h"
+#include "OgreParticleSystemManager.h"
+#include "OgreParticleSystemRenderer.h"
+#include "OgreParticleEmitter.h"
+#include "OgreParticleAffector.h"
+
+#include "Compositor/OgreCompositorManager2.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreTexBufferPacked.h"
+#include "Vao/OgreUavBufferPacked.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreRenderSystem.h"
+#include "OgreRenderQueue.h"
+#include "OgreSceneManager.h"
+#include "OgreCamera.h"
+#include "OgreStringConverter.h"
+#include "OgreLogManager.h"
+#include "OgreId.h"
+
+namespace Ogre
+{
+    const uint32 GpuParticleSimulator::MaxEmitters = 16u;
+    const uint32 GpuParticleSimulator::MaxAffectors = 16u;
+
+    static const char *c_emitJobName    = "GpuParticles/Emit";
+    static const char *c_updateJobName  = "GpuParticles/Update";
+
+    static const uint32 c_threadsPerGroup = 64u;
+    /// Max thread groups in X per dispatch (D3D11 limit)
+    static const uint32 c_maxThreadGroupsX = 65535u;
+
+    /*  Layout of the params, in float4 (uints are stored as their bits):
+            [0] = numEmitters, numAffectors, quota, seed
+            [1] = timeElapsed, totalEmit, rotate vertices (1) or texcoords (0), 0
+            [2..4] = emitter space -> simulation space (3 rows). The node's full transform
+                     when particles live in world space, identity otherwise
+            [5..7] = simulation space -> node space (3 rows). The inverse of the above
+            [8] = camera right (simulation space), default width
+            [9] = camera up (simulation space), default height
+        Then MaxEmitters emitters, c_emitterFloat4 each:
+            [0] = type | useDirPositionRef << 8, count, emitStart, angle (radians)
+            [1] = position, min velocity
+            [2] = direction, max velocity
+            [3] = up, min TTL
+            [4] = x range (left * width / 2), max TTL
+            [5] = y range (up * height / 2), inner width
+            [6] = z range (direction * depth / 2), inner height
+            [7] = dir position reference, inner depth
+            [8] = colour range start
+            [9] = colour range end
+        Then MaxAffectors affectors, c_affectorFloat4 each:
+            [0] = type, mode, 0, 0
+            [1..2] = depends on the type (see fillParams)
+
+        Particles are 4 float4 each:
+            [0] = position, time to live (< 0 when dead)
+            [1] = direction, total time to live (stored as -totalTTL - 1 the frame it's born)
+            [2] = colour
+            [3] = width, height, rotation, rotation speed
+    */
+    static const uint32 c_headerFloat4      = 10u;
+    static const uint32 c_emitterFloat4     = 10u;
+    static const uint32 c_affectorFloat4    = 3u;
+    static const uint32 c_particleFloat4    = 4u;
+    /// Position (3), colour (4) and uv (2)
+    static const uint32 c_floatsPerVertex   = 9u;
+
+    /// Must match the order in the compute shaders
+    static const char *c_emitterTypes[] =
+    {
+        "Point", "Box", "Ellipsoid", "Cylinder", "Ring", "HollowEllipsoid"
+    };
+    static const char *c_affectorTypes[] =
+    {
+        "LinearForce", "ColourFader", "Scaler", "Rotator", "DeflectorPlane"
+    };
+
+    enum GpuEmitterTypes
+    {
+        GpuEmitterPoint,
+        GpuEmitterBox,
+        GpuEmitterEllipsoid,
+        GpuEmitterCylinder,
+        GpuEmitterRing,
+        GpuEmitterHollowEllipsoid,
+        NumGpuEmitterTypes
+    };
+    enum GpuAffectorTypes
+    {
+        GpuAffectorLinearForce,
+        GpuAffectorColourFader,
+        GpuAffectorScaler,
+        GpuAffectorRotator,
+        GpuAffectorDeflectorPlane,
+        NumGpuAffectorTypes
+    };
+
+    static inline float asFloat( uint32 value )
+    {
+        float retVal;
+        memcpy( &retVal, &value, sizeof( retVal ) );
+        return retVal;
+    }
+
+    static inline void storeFloat4( float * RESTRICT_ALIAS dst, float x, float y, float z, float w )
+    {
+        dst[0] = x;
+        dst[1] = y;
+        dst[2] = z;
+        dst[3] = w;
+    }
+
+    static inline void storeFloat4( float * RESTRICT_ALIAS dst, const Vector3 &xyz, float w )
+    {
+        storeFloat4( dst, static_cast<float>( xyz.x ), static_cast<float>( xyz.y ),
+                     static_cast<float>( xyz.z ), w );
+    }
+
+    static inline void storeRows( float * RESTRICT_ALIAS dst, const Matrix4 &mat )
+    {
+        for( size_t y=0; y<3u; ++y )
+        {
+            for( size_t x=0; x<4u; ++x )
+                dst[y * 4u + x] = static_cast<float>( mat[y][x] );
+        }
+    }
+
+    /// Returns NumGpuEmitterTypes if the emitter isn't supported
+    static uint32 getGpuEmitterType( const ParticleEmitter *emitter )
+    {
+        uint32 type = 0;
+        while( type < NumGpuEmitterTypes && emitter->getType() != c_emitterTypes[type] )
+            ++type;
+        return type;
+    }
+
+    /// Returns NumGpuAffectorTypes if the affector isn't supported
+    static uint32 getGpuAffectorType( const ParticleAffector *affector )
+    {
+        uint32 type = 0;
+        while( type < NumGpuAffectorTypes && affector->getType() != c_affectorTypes[type] )
+            ++type;
+        return type;
+    }
+
+    /// Same as AreaEmitter::genAreaAxes. Point emitters have no area
+    static void getAreaRanges( const ParticleEmitter *emitter, uint32 type,
+                               Vector3 &outX, Vector3 &outY, Vector3 &outZ )
+    {
+        if( type == GpuEmitterPoint )
+        {
+            outX = outY = outZ = Vector3::ZERO;
+            return;
+        }
+
+        const Vector3 left = emitter->getUp().crossProduct( emitter->getDirection() );
+        outX = left * ( StringConverter::parseReal( emitter->getParameter( "width" ) ) * 0.5f );
+        outY = emitter->getUp() * ( StringConverter::parseReal( emitter->getParameter( "height" ) ) * 0.5f );
+        outZ = emitter->getDirection() * ( StringConverter::parseReal( emitter->getParameter( "depth" ) ) * 0.5f );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuParticleRenderable::GpuParticleRenderable( ParticleSystem *particleSystem,
+                                                  VertexArrayObject *vao ) :
+        mParticleSystem( particleSystem )
+    {
+        mVaoPerLod[VpNormal].push_back( vao );
+        mVaoPerLod[VpShadow].push_back( vao );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuParticleRenderable::~GpuParticleRenderable()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    const LightList& GpuParticleRenderable::getLights(void) const
+    {
+        return mParticleSystem->queryLights();
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleRenderable::getRenderOperation( v1::RenderOperation &op, bool casterPass )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "GpuParticleRenderable does not implement getRenderOperation."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "GpuParticleRenderable::getRenderOperation" );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleRenderable::getWorldTransforms( Matrix4 *xform ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "GpuParticleRenderable does not implement getWorldTransforms."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "GpuParticleRenderable::getWorldTransforms" );
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuParticleRenderable::getCastsShadows(void) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "GpuParticleRenderable does not implement getCastsShadows."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "GpuParticleRenderable::getCastsShadows" );
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    GpuParticleSimulator::GpuParticleSimulator( HlmsManager *hlmsManager, VaoManager *vaoManager,
+                                                CompositorManager2 *compositorManager,
+                                                Camera *camera, uint8 renderQueueGroup ) :
+        mCamera( camera ),
+        mRenderQueueGroup( renderQueueGroup ),
+        mFrameCount( 0 ),
+        mHlmsCompute( hlmsManager->getComputeHlms() ),
+        mVaoManager( vaoManager ),
+        mRenderSystem( hlmsManager->getRenderSystem() ),
+        mCompositorManager( compositorManager )
+    {
+        ParticleSystemManager::getSingleton()._setGpuParticleSimulator( this );
+
+        //The update job reads what the emit job wrote
+        mUavToUavTransition.oldLayout = ResourceLayout::Uav;
+        mUavToUavTransition.newLayout = ResourceLayout::Uav;
+        mUavToUavTransition.writeBarrierBits = WriteBarrier::Uav;
+        mUavToUavTransition.readBarrierBits  = ReadBarrier::Uav;
+        mRenderSystem->_resourceTransitionCreated( &mUavToUavTransition );
+
+        //The vertices get copied to the vertex buffers. CpuRead covers buffer to buffer copies
+        mUavToCopyTransition.oldLayout = ResourceLayout::Uav;
+        mUavToCopyTransition.newLayout = ResourceLayout::CopySrc;
+        mUavToCopyTransition.writeBarrierBits = WriteBarrier::Uav;
+        mUavToCopyTransition.readBarrierBits  = ReadBarrier::CpuRead | ReadBarrier::VertexBuffer;
+        mRenderSystem->_resourceTransitionCreated( &mUavToCopyTransition );
+
+        mParamsScratch.resizePOD( ( c_headerFloat4 + MaxEmitters * c_emitterFloat4 +
+                                    MaxAffectors * c_affectorFloat4 ) * 4u, 0.0f );
+
+        mCompositorManager->addListener( this );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuParticleSimulator::~GpuParticleSimulator()
+    {
+        mCompositorManager->removeListener( this );
+
+        //Give the systems back to the CPU. Keep requesting GPU simulation, should
+        //another simulator be created.
+        while( !mSystems.empty() )
+            _removeParticleSystem( mSystems.back().system );
+
+        mRenderSystem->_resourceTransitionDestroyed( &mUavToUavTransition );
+        mRenderSystem->_resourceTransitionDestroyed( &mUavToCopyTransition );
+
+        ParticleSystemManager::getSingleton()._setGpuParticleSimulator( 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsComputeJob* GpuParticleSimulator::createJob( const char *jobName )
+    {
+    #if OGRE_NO_JSON
+        OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                     "GpuParticleSimulator requires Ogre to be built with JSON support "
+                     "and you must include the resources bundled at "
+                     "Samples/Media/2.0/scripts/materials/Common",
+                     "GpuParticleSimulator::createJob" );
+    #endif
+        HlmsComputeJob *baseJob = mHlmsCompute->findComputeJobNoThrow( jobName );
+
+        if( !baseJob )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "To use GpuParticleSimulator, you must include the resources "
+                         "bundled at Samples/Media/2.0/scripts/materials/Common\n"
+                         "Could not find " + String( jobName ),
+                         "GpuParticleSimulator::createJob" );
+        }
+
+        const String newId = StringConverter::toString( Id::generateNewId<GpuParticleSimulator>() );
+        return baseJob->clone( String( jobName ) + " " + newId );
+    }
+    //-----------------------------------------------------------------------------------
+    GpuParticleSimulator::SystemData* GpuParticleSimulator::findSystem( const ParticleSystem *system )
+    {
+        SystemDataVec::iterator itor = mSystems.begin();
+        SystemDataVec::iterator end  = mSystems.end();
+        while( itor != end && itor->system != system )
+            ++itor;
+
+        return itor != end ? &(*itor) : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::createBuffers( SystemData &data )
+    {
+        const uint32 quota = data.quota;
+
+        data.particles = mVaoManager->createUavBuffer( quota * c_particleFloat4,
+                                                       sizeof( float ) * 4u,
+                                                       BB_FLAG_UAV, 0, false );
+        data.deadList = mVaoManager->createUavBuffer( quota + 1u, sizeof( uint32 ),
+                                                      BB_FLAG_UAV, 0, false );
+        data.vertices = mVaoManager->createUavBuffer( quota * 4u * c_floatsPerVertex,
+                                                      sizeof( float ), BB_FLAG_UAV, 0, false );
+        data.params = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT,
+                                                    mParamsScratch.size() * sizeof( float ),
+                                                    BT_DEFAULT, 0, false );
+        resetBuffers( data );
+
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_DIFFUSE ) );
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        VertexBufferPacked *vertexBuffer = mVaoManager->createVertexBuffer( vertexElements,
+                                                                            quota * 4u, BT_DEFAULT,
+                                                                            0, false );
+
+        //Every particle is a quad. Dead particles are collapsed by the update job
+        uint32 *indices = reinterpret_cast<uint32*>(
+                              OGRE_MALLOC_SIMD( sizeof( uint32 ) * quota * 6u,
+                                                MEMCATEGORY_GEOMETRY ) );
+        FreeOnDestructor indicesPtr( indices );
+        for( uint32 i=0; i<quota; ++i )
+        {
+            const uint32 firstVertex = i * 4u;
+            indices[i * 6u + 0u] = firstVertex + 0u;
+            indices[i * 6u + 1u] = firstVertex + 2u;
+            indices[i * 6u + 2u] = firstVertex + 1u;
+            indices[i * 6u + 3u] = firstVertex + 1u;
+            indices[i * 6u + 4u] = firstVertex + 2u;
+            indices[i * 6u + 5u] = firstVertex + 3u;
+        }
+
+        IndexBufferPacked *indexBuffer = 0;
+        try
+        {
+            indexBuffer = mVaoManager->createIndexBuffer( IndexBufferPacked::IT_32BIT, quota * 6u,
+                                                          BT_IMMUTABLE, indices, false );
+        }
+        catch( Exception & )
+        {
+            mVaoManager->destroyVertexBuffer( vertexBuffer );
+            throw;
+        }
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( vertexBuffer );
+        data.vao = mVaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                         OT_TRIANGLE_LIST );
+        data.renderable = OGRE_NEW GpuParticleRenderable( data.system, data.vao );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::destroyBuffers( SystemData &data )
+    {
+        if( data.renderable )
+        {
+            OGRE_DELETE data.renderable;
+            data.renderable = 0;
+        }
+        if( data.vao )
+        {
+            const VertexBufferPackedVec &vertexBuffers = data.vao->getVertexBuffers();
+            VertexBufferPackedVec::const_iterator itor = vertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator end  = vertexBuffers.end();
+            while( itor != end )
+                mVaoManager->destroyVertexBuffer( *itor++ );
+
+            if( data.vao->getIndexBuffer() )
+                mVaoManager->destroyIndexBuffer( data.vao->getIndexBuffer() );
+            mVaoManager->destroyVertexArrayObject( data.vao );
+            data.vao = 0;
+        }
+        if( data.params )
+        {
+            mVaoManager->destroyTexBuffer( data.params );
+            data.params = 0;
+        }
+        if( data.vertices )
+        {
+            mVaoManager->destroyUavBuffer( data.vertices );
+            data.vertices = 0;
+        }
+        if( data.deadList )
+        {
+            mVaoManager->destroyUavBuffer( data.deadList );
+            data.deadList = 0;
+        }
+        if( data.particles )
+        {
+            mVaoManager->destroyUavBuffer( data.particles );
+            data.particles = 0;
+        }
+        if( data.updateJob )
+        {
+            mHlmsCompute->destroyComputeJob( data.updateJob->getName() );
+            data.updateJob = 0;
+        }
+        if( data.emitJob )
+        {
+            mHlmsCompute->destroyComputeJob( data.emitJob->getName() );
+            data.emitJob = 0;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::resetBuffers( SystemData &data )
+    {
+        const uint32 quota = data.quota;
+
+        {
+            FastArray<float> particles;
+            particles.resizePOD( quota * c_particleFloat4 * 4u, 0.0f );
+            for( uint32 i=0; i<quota; ++i )
+                particles[i * c_particleFloat4 * 4u + 3u] = -1.0f;
+            data.particles->upload( particles.begin(), 0, quota * c_particleFloat4 );
+        }
+
+        {
+            FastArray<uint32> deadList;
+            deadList.resizePOD( quota + 1u, 0u );
+            deadList[0] = quota;
+            for( uint32 i=0; i<quota; ++i )
+                deadList[i + 1u] = i;
+            data.deadList->upload( deadList.begin(), 0, quota + 1u );
+        }
+
+        data.pendingTime = 0;
+        data.pendingEmissions.clear();
+        data.needsReset = false;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 GpuParticleSimulator::fillParams( SystemData &data )
+    {
+        const ParticleSystem *system = data.system;
+        const Node *parentNode = system->getParentNode();
+        const bool localSpace = system->getKeepParticlesInLocalSpace();
+
+        const Matrix4 &nodeMat = parentNode->_getFullTransform();
+        const Matrix4 invNodeMat = nodeMat.inverseAffine();
+
+        //Same as ParticleSystem::_triggerEmitters: scale down the requests not to exceed the quota
+        const uint32 numEmitters = std::min<uint32>( system->getNumEmitters(),
+                                                     static_cast<uint32>( data.pendingEmissions.size() ) );
+        uint32 totalRequested = 0;
+        for( uint32 i=0; i<numEmitters; ++i )
+            totalRequested += data.pendingEmissions[i];
+
+        const Real ratio = totalRequested > data.quota ?
+                               Real( data.quota ) / Real( totalRequested ) : Real( 1.0f );
+
+        float * RESTRICT_ALIAS header = mParamsScratch.begin();
+        float * RESTRICT_ALIAS emitterData = header + c_headerFloat4 * 4u;
+        float * RESTRICT_ALIAS affectorData = emitterData + MaxEmitters * c_emitterFloat4 * 4u;
+
+        uint32 totalEmit = 0;
+        for( uint32 i=0; i<numEmitters; ++i )
+        {
+            const ParticleEmitter *emitter = system->getEmitter( static_cast<unsigned short>( i ) );
+            const uint32 type = getGpuEmitterType( emitter );
+            const uint32 count = static_cast<uint32>( data.pendingEmissions[i] * ratio );
+
+            Vector3 xRange, yRange, zRange;
+            getAreaRanges( emitter, type, xRange, yRange, zRange );
+
+            Vector3 innerSize( Vector3::ZERO );
+            if( type == GpuEmitterRing || type == GpuEmitterHollowEllipsoid )
+            {
+                innerSize.x = StringConverter::parseReal( emitter->getParameter( "inner_width" ) );
+                innerSize.y = StringConverter::parseReal( emitter->getParameter( "inner_height" ) );
+                if( type == GpuEmitterHollowEllipsoid )
+                {
+                    innerSize.z =
+                        StringConverter::parseReal( emitter->getParameter( "inner_depth" ) );
+                }
+            }
+
+            const uint32 typeAndFlags = type | ( emitter->getDirPositionReferenceEnabled() ? 256u : 0u );
+            const ColourValue &colourStart = emitter->getColourRangeStart();
+            const ColourValue &colourEnd = emitter->getColourRangeEnd();
+
+            float * RESTRICT_ALIAS dst = emitterData + i * c_emitterFloat4 * 4u;
+            storeFloat4( dst, asFloat( typeAndFlags ), asFloat( count ), asFloat( totalEmit ),
+                         static_cast<float>( emitter->getAngle().valueRadians() ) );
+            storeFloat4( dst + 4u, emitter->getPosition(),
+                         static_cast<float>( emitter->getMinParticleVelocity() ) );
+            storeFloat4( dst + 8u, emitter->getDirection(),
+                         static_cast<float>( emitter->getMaxParticleVelocity() ) );
+            storeFloat4( dst + 12u, emitter->getUp(),
+                         static_cast<float>( emitter->getMinTimeToLive() ) );
+            storeFloat4( dst + 16u, xRange, static_cast<float>( emitter->getMaxTimeToLive() ) );
+            storeFloat4( dst + 20u, yRange, static_cast<float>( innerSize.x ) );
+            storeFloat4( dst + 24u, zRange, static_cast<float>( innerSize.y ) );
+            storeFloat4( dst + 28u, emitter->getDirPositionReference(),
+                         static_cast<float>( innerSize.z ) );
+            storeFloat4( dst + 32u, colourStart.r, colourStart.g, colourStart.b, colourStart.a );
+            storeFloat4( dst + 36u, colourEnd.r, colourEnd.g, colourEnd.b, colourEnd.a );
+
+            totalEmit += count;
+        }
+
+        const uint32 numAffectors = std::min<uint32>( system->getNumAffectors(), MaxAffectors );
+        for( uint32 i=0; i<numAffectors; ++i )
+        {
+            const ParticleAffector *affector = system->getAffector( static_cast<unsigned short>( i ) );
+            const uint32 type = getGpuAffectorType( affector );
+
+            float * RESTRICT_ALIAS dst = affectorData + i * c_affectorFloat4 * 4u;
+            memset( dst, 0, c_affectorFloat4 * 4u * sizeof( float ) );
+            dst[0] = asFloat( type );
+
+            switch( type )
+            {
+            case GpuAffectorLinearForce:
+                //[1] = force vector
+                dst[1] = asFloat( affector->getParameter( "force_application" ) == "average" ? 1u : 0u );
+                storeFloat4( dst + 4u, StringConverter::parseVector3(
+                                 affector->getParameter( "force_vector" ) ), 0.0f );
+                break;
+            case GpuAffectorColourFader:
+                //[1] = colour adjustment per second
+                storeFloat4( dst + 4u,
+                             StringConverter::parseReal( affector->getParameter( "red" ) ),
+                             StringConverter::parseReal( affector->getParameter( "green" ) ),
+                             StringConverter::parseReal( affector->getParameter( "blue" ) ),
+                             StringConverter::parseReal( affector->getParameter( "alpha" ) ) );
+                break;
+            case GpuAffectorScaler:
+                //[1].x = scale adjustment per second
+                dst[4] = StringConverter::parseReal( affector->getParameter( "rate" ) );
+                break;
+            case GpuAffectorRotator:
+                //[1] = rotation speed range start & end, rotation range start & end
+                storeFloat4( dst + 4u,
+                             StringConverter::parseAngle( affector->getParameter(
+                                 "rotation_speed_range_start" ) ).valueRadians(),
+                             StringConverter::parseAngle( affector->getParameter(
+                                 "rotation_speed_range_end" ) ).valueRadians(),
+                             StringConverter::parseAngle( affector->getParameter(
+                                 "rotation_range_start" ) ).valueRadians(),
+                             StringConverter::parseAngle( affector->getParameter(
+                                 "rotation_range_end" ) ).valueRadians() );
+                break;
+            case GpuAffectorDeflectorPlane:
+            {
+                //[1] = plane normal, plane distance. [2].x = bounce
+                const Vector3 planePoint =
+                        StringConverter::parseVector3( affector->getParameter( "plane_point" ) );
+                const Vector3 planeNormal =
+                        StringConverter::parseVector3( affector->getParameter( "plane_normal" ) );
+                const Real planeDistance = -planeNormal.dotProduct( planePoint ) /
+                                           Math::Sqrt( planeNormal.dotProduct( planeNormal ) );
+                storeFloat4( dst + 4u, planeNormal, static_cast<float>( planeDistance ) );
+                dst[8] = StringConverter::parseReal( affector->getParameter( "bounce" ) );
+                break;
+            }
+            }
+        }
+
+        storeFloat4( header, asFloat( numEmitters ), asFloat( numAffectors ),
+                     asFloat( data.quota ), asFloat( mFrameCount * 0x9E3779B9u ) );
+        const bool rotateVertices =
+                system->getRenderer()->getParameter( "billboard_rotation_type" ) == "vertex";
+        storeFloat4( header + 4u, static_cast<float>( data.pendingTime ), asFloat( totalEmit ),
+                     asFloat( rotateVertices ? 1u : 0u ), 0.0f );
+        storeRows( header + 8u, localSpace ? Matrix4::IDENTITY : nodeMat );
+        storeRows( header + 20u, localSpace ? Matrix4::IDENTITY : invNodeMat );
+
+        //Billboards face the camera, like BBT_POINT
+        Vector3 cameraRight( Vector3::UNIT_X );
+        Vector3 cameraUp( Vector3::UNIT_Y );
+        if( mCamera )
+        {
+            const Quaternion &camOrientation = mCamera->getDerivedOrientation();
+            cameraRight = camOrientation * Vector3::UNIT_X;
+            cameraUp    = camOrientation * Vector3::UNIT_Y;
+        }
+        if( localSpace )
+        {
+            cameraRight = invNodeMat.transformDirectionAffine( cameraRight );
+            cameraUp    = invNodeMat.transformDirectionAffine( cameraUp );
+        }
+        storeFloat4( header + 32u, cameraRight, static_cast<float>( system->getDefaultWidth() ) );
+        storeFloat4( header + 36u, cameraUp, static_cast<float>( system->getDefaultHeight() ) );
+
+        return totalEmit;
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuParticleSimulator::isSupported(void) const
+    {
+        return mRenderSystem->getCapabilities()->hasCapability( RSC_COMPUTE_PROGRAM );
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuParticleSimulator::canSimulate( const ParticleSystem *system, String *outReason ) const
+    {
+        String reason;
+
+        if( !isSupported() )
+            reason = "the RenderSystem does not support compute shaders";
+        else if( system->getNumEmitters() > MaxEmitters )
+            reason = "it has more than " + StringConverter::toString( MaxEmitters ) + " emitters";
+        else if( system->getNumAffectors() > MaxAffectors )
+            reason = "it has more than " + StringConverter::toString( MaxAffectors ) + " affectors";
+        else if( system->getParticleQuota() == 0 ||
+                 system->getParticleQuota() > c_maxThreadGroupsX * c_threadsPerGroup )
+        {
+            reason = "its quota must be between 1 and " +
+                     StringConverter::toString( c_maxThreadGroupsX * c_threadsPerGroup );
+        }
+        else if( !system->getRenderer() || system->getRendererName() != "billboard" ||
+                 system->getRenderer()->getParameter( "billboard_type" ) != "point" ||
+                 system->getRenderer()->getParameter( "billboard_origin" ) != "center" )
+        {
+            reason = "only the billboard renderer with point billboards centered "
+                     "on the particle is supported";
+        }
+
+        const unsigned short numEmitters = system->getNumEmitters();
+        for( unsigned short i=0; i<numEmitters && reason.empty(); ++i )
+        {
+            const ParticleEmitter *emitter = system->getEmitter( i );
+            if( getGpuEmitterType( emitter ) == NumGpuEmitterTypes )
+                reason = "emitter type '" + emitter->getType() + "' is not supported";
+            else if( !emitter->getEmittedEmitter().empty() || emitter->isEmitted() )
+                reason = "emitted emitters are not supported";
+        }
+
+        const unsigned short numAffectors = system->getNumAffectors();
+        for( unsigned short i=0; i<numAffectors && reason.empty(); ++i )
+        {
+            const ParticleAffector *affector = system->getAffector( i );
+            if( getGpuAffectorType( affector ) == NumGpuAffectorTypes )
+                reason = "affector type '" + affector->getType() + "' is not supported";
+        }
+
+        if( outReason )
+            *outReason = reason;
+
+        return reason.empty();
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuParticleSimulator::_addParticleSystem( ParticleSystem *system )
+    {
+        if( findSystem( system ) )
+            return true;
+
+        String reason;
+        if( !canSimulate( system, &reason ) )
+        {
+            LogManager::getSingleton().logMessage(
+                        "GpuParticleSimulator: ParticleSystem '" + system->getName() +
+                        "' will be simulated on the CPU because " + reason );
+            return false;
+        }
+
+        SystemData data;
+        data.system         = system;
+        data.quota          = static_cast<uint32>( system->getParticleQuota() );
+        data.particles      = 0;
+        data.deadList       = 0;
+        data.vertices       = 0;
+        data.params         = 0;
+        data.vao            = 0;
+        data.renderable     = 0;
+        data.emitJob        = 0;
+        data.updateJob      = 0;
+        data.pendingTime    = 0;
+        data.needsReset     = false;
+
+        try
+        {
+            data.emitJob = createJob( c_emitJobName );
+            data.updateJob = createJob( c_updateJobName );
+            createBuffers( data );
+        }
+        catch( Exception & )
+        {
+            destroyBuffers( data );
+            throw;
+        }
+
+        //Our Renderable is a v2 object
+        RenderQueue *renderQueue = system->_getManager()->getRenderQueue();
+        if( renderQueue->getRenderQueueMode( system->getRenderQueueGroup() ) != RenderQueue::FAST )
+            system->setRenderQueueGroup( mRenderQueueGroup );
+
+        mSystems.push_back( data );
+        system->_notifyGpuSimulator( this, data.renderable );
+        _notifyMaterialChanged( system );
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::_removeParticleSystem( ParticleSystem *system )
+    {
+        SystemData *data = findSystem( system );
+        if( !data )
+            return;
+
+        system->_notifyGpuSimulator( 0, 0 );
+        destroyBuffers( *data );
+        SystemDataVec::iterator itor = mSystems.begin() + ( data - &mSystems.front() );
+        efficientVectorRemove( mSystems, itor );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::_notifyUpdate( ParticleSystem *system, Real timeElapsed )
+    {
+        SystemData *data = findSystem( system );
+        if( !data )
+            return;
+
+        String reason;
+        if( !canSimulate( system, &reason ) )
+        {
+            //The system changed. Give it back to the CPU (the reason gets logged when
+            //the system tries to come back)
+            _removeParticleSystem( system );
+            return;
+        }
+
+        const size_t numEmitters = system->getNumEmitters();
+        data->pendingEmissions.resizePOD( numEmitters, 0u );
+
+        if( system->getEmitting() )
+        {
+            for( size_t i=0; i<numEmitters; ++i )
+            {
+                ParticleEmitter *emitter = system->getEmitter( static_cast<unsigned short>( i ) );
+                data->pendingEmissions[i] += emitter->_getEmissionCount( timeElapsed );
+            }
+        }
+
+        data->pendingTime += timeElapsed;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::_notifyCleared( ParticleSystem *system )
+    {
+        SystemData *data = findSystem( system );
+        if( data )
+            data->needsReset = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::_notifyMaterialChanged( ParticleSystem *system )
+    {
+        SystemData *data = findSystem( system );
+        if( data )
+        {
+            data->renderable->setDatablockOrMaterialName( system->getMaterialName(),
+                                                          system->getResourceGroupName() );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Aabb GpuParticleSimulator::_calculateBounds( const ParticleSystem *system ) const
+    {
+        Aabb emissionAabb( Aabb::BOX_NULL );
+        Real maxTtl = 0;
+        Real maxSpeed = 0;
+
+        const unsigned short numEmitters = system->getNumEmitters();
+        for( unsigned short i=0; i<numEmitters; ++i )
+        {
+            const ParticleEmitter *emitter = system->getEmitter( i );
+
+            Vector3 xRange, yRange, zRange;
+            getAreaRanges( emitter, getGpuEmitterType( emitter ), xRange, yRange, zRange );
+            const Vector3 halfSize = Vector3( Math::Abs( xRange.x ) + Math::Abs( yRange.x ) + Math::Abs( zRange.x ),
+                                              Math::Abs( xRange.y ) + Math::Abs( yRange.y ) + Math::Abs( zRange.y ),
+                                              Math::Abs( xRange.z ) + Math::Abs( yRange.z ) + Math::Abs( zRange.z ) );
+            emissionAabb.merge( Aabb( emitter->getPosition(), halfSize ) );
+
+            maxTtl = std::max( maxTtl, emitter->getMaxTimeToLive() );
+            maxSpeed = std::max( maxSpeed, emitter->getMaxParticleVelocity() );
+        }
+
+        if( emissionAabb.mHalfSize.x < 0 )
+            return Aabb::BOX_NULL;
+
+        Real addedForce = 0;
+        Real maxSize = std::max( system->getDefaultWidth(), system->getDefaultHeight() );
+
+        const unsigned short numAffectors = system->getNumAffectors();
+        for( unsigned short i=0; i<numAffectors; ++i )
+        {
+            const ParticleAffector *affector = system->getAffector( i );
+            const uint32 type = getGpuAffectorType( affector );
+
+            if( type == GpuAffectorLinearForce )
+            {
+                const Real force = StringConverter::parseVector3(
+                                       affector->getParameter( "force_vector" ) ).length();
+                //Averaging moves the direction towards the force; it never exceeds either
+                if( affector->getParameter( "force_application" ) == "average" )
+                    maxSpeed = std::max( maxSpeed, force );
+                else
+                    addedForce += force;
+            }
+            else if( type == GpuAffectorScaler )
+            {
+                const Real rate = StringConverter::parseReal( affector->getParameter( "rate" ) );
+                if( rate > 0 )
+                    maxSize += rate * maxTtl;
+            }
+        }
+
+        //Worst case distance travelled, plus the diagonal of the biggest (rotated) billboard
+        const Real padding = maxSpeed * maxTtl + addedForce * maxTtl * maxTtl * 0.5f +
+                             maxSize * 0.5f * Math::Sqrt( 2.0f );
+        emissionAabb.mHalfSize += Vector3( padding );
+
+        return emissionAabb;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::update(void)
+    {
+        ++mFrameCount;
+
+        bool bFirstDispatch = true;
+
+        SystemDataVec::iterator itor = mSystems.begin();
+        SystemDataVec::iterator end  = mSystems.end();
+
+        while( itor != end )
+        {
+            SystemData &data = *itor;
+
+            if( !data.system->getParentNode() )
+            {
+                ++itor;
+                continue;
+            }
+
+            if( data.needsReset )
+                resetBuffers( data );
+
+            const uint32 totalEmit = fillParams( data );
+            data.params->upload( mParamsScratch.begin(), 0,
+                                 mParamsScratch.size() * sizeof( float ) /
+                                 data.params->getBytesPerElement() );
+
+            DescriptorSetTexture2::BufferSlot texBufSlot(
+                        DescriptorSetTexture2::BufferSlot::makeEmpty() );
+            texBufSlot.buffer = data.params;
+
+            DescriptorSetUav::BufferSlot bufferSlot( DescriptorSetUav::BufferSlot::makeEmpty() );
+            bufferSlot.access = ResourceAccess::ReadWrite;
+
+            if( bFirstDispatch )
+            {
+                mRenderSystem->endRenderPassDescriptor();
+                bFirstDispatch = false;
+            }
+
+            if( totalEmit )
+            {
+                HlmsComputeJob *job = data.emitJob;
+                job->setTexBuffer( 0, texBufSlot );
+                bufferSlot.buffer = data.particles;
+                job->_setUavBuffer( 0, bufferSlot );
+                bufferSlot.buffer = data.deadList;
+                job->_setUavBuffer( 1, bufferSlot );
+                job->setNumThreadGroups( std::min( ( totalEmit + c_threadsPerGroup - 1u ) /
+                                                   c_threadsPerGroup, c_maxThreadGroupsX ), 1u, 1u );
+                mHlmsCompute->dispatch( job, 0, 0 );
+
+                mRenderSystem->_executeResourceTransition( &mUavToUavTransition );
+            }
+
+            {
+                //Always run: even without time passing the billboards must face the camera
+                HlmsComputeJob *job = data.updateJob;
+                job->setTexBuffer( 0, texBufSlot );
+                bufferSlot.buffer = data.particles;
+                job->_setUavBuffer( 0, bufferSlot );
+                bufferSlot.buffer = data.deadList;
+                job->_setUavBuffer( 1, bufferSlot );
+                bufferSlot.buffer = data.vertices;
+                bufferSlot.access = ResourceAccess::Write;
+                job->_setUavBuffer( 2, bufferSlot );
+                job->setNumThreadGroups( ( data.quota + c_threadsPerGroup - 1u ) / c_threadsPerGroup,
+                                         1u, 1u );
+                mHlmsCompute->dispatch( job, 0, 0 );
+            }
+
+            data.pendingTime = 0;
+            std::fill( data.pendingEmissions.begin(), data.pendingEmissions.end(), 0u );
+
+            ++itor;
+        }
+
+        if( bFirstDispatch )
+            return;
+
+        mRenderSystem->_executeResourceTransition( &mUavToCopyTransition );
+
+        itor = mSystems.begin();
+        while( itor != end )
+        {
+            if( itor->system->getParentNode() )
+                itor->vertices->copyTo( itor->vao->getVertexBuffers()[0] );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuParticleSimulator::allWorkspacesBeginUpdate(void)
+    {
+        update();
+    }
+}
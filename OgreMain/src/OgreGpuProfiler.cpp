@@ -0,0 +1,253 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreGpuProfiler.h"
+#include "OgreRenderSystem.h"
+#include "OgreLogManager.h"
+#include "OgreStringConverter.h"
+
+#include <limits>
+
+namespace Ogre
+{
+    GpuProfiler::GpuProfiler( RenderSystem *renderSystem ) :
+        mRenderSystem( renderSystem ),
+        mMaxQueriesPerFrame( 0 ),
+        mNumReservedQueries( 0 ),
+        mCurrentFrame( 0 ),
+        mEnabled( false ),
+        mRecording( false ),
+        mFrameTimeMs( 0 ),
+        mNumDroppedSamples( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    GpuProfiler::~GpuProfiler()
+    {
+        setEnabled( false );
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuProfiler::setEnabled( bool bEnabled, uint32 numFrames, uint32 maxQueriesPerFrame )
+    {
+        if( bEnabled && !mRenderSystem->_supportsGpuTimestamps() )
+        {
+            LogManager::getSingleton().logMessage(
+                "GpuProfiler: timestamp queries not supported by " + mRenderSystem->getName() );
+            bEnabled = false;
+        }
+
+        if( mEnabled )
+        {
+            mRenderSystem->_destroyGpuTimestampQueries();
+            mFrames.clear();
+            mOpenSamples.clear();
+            mResults.clear();
+            mFrameTimeMs = 0;
+            mRecording = false;
+            mEnabled = false;
+        }
+
+        if( bEnabled )
+        {
+            //Frame begin & end consume 2 queries
+            numFrames = std::max( numFrames, 2u );
+            maxQueriesPerFrame = std::max( maxQueriesPerFrame, 2u );
+
+            mRenderSystem->_createGpuTimestampQueries( numFrames, maxQueriesPerFrame );
+
+            Frame frame;
+            frame.numQueries = 0;
+            frame.pending = false;
+            mFrames.resize( numFrames, frame );
+            mMaxQueriesPerFrame = maxQueriesPerFrame;
+            mCurrentFrame = 0;
+            mTimestamps.resize( maxQueriesPerFrame );
+            mEnabled = true;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuProfiler::beginSample( const String &name )
+    {
+        if( !mRecording )
+            return;
+
+        Frame &frame = mFrames[mCurrentFrame];
+
+        //This sample needs 2 queries. The end of each open sample and
+        //the end of the frame need their queries too.
+        if( frame.numQueries + mNumReservedQueries + 2u > mMaxQueriesPerFrame )
+        {
+            ++mNumDroppedSamples;
+            mOpenSamples.push_back( std::numeric_limits<uint32>::max() );
+            return;
+        }
+
+        Sample sample;
+        sample.name         = name;
+        sample.depth        = static_cast<uint32>( mOpenSamples.size() );
+        sample.beginQuery   = frame.numQueries;
+        sample.endQuery     = std::numeric_limits<uint32>::max();
+
+        mRenderSystem->_writeGpuTimestamp( mCurrentFrame, frame.numQueries++ );
+
+        mOpenSamples.push_back( static_cast<uint32>( frame.samples.size() ) );
+        frame.samples.push_back( sample );
+        ++mNumReservedQueries;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuProfiler::endSample(void)
+    {
+        if( !mRecording || mOpenSamples.empty() )
+            return;
+
+        const uint32 sampleIdx = mOpenSamples.back();
+        mOpenSamples.pop_back();
+
+        if( sampleIdx == std::numeric_limits<uint32>::max() )
+            return;
+
+        --mNumReservedQueries;
+
+        Frame &frame = mFrames[mCurrentFrame];
+        frame.samples[sampleIdx].endQuery = frame.numQueries;
+        mRenderSystem->_writeGpuTimestamp( mCurrentFrame, frame.numQueries++ );
+    }
+    //-----------------------------------------------------------------------------------
+    bool GpuProfiler::collectResults( uint32 frameIdx )
+    {
+        Frame &frame = mFrames[frameIdx];
+
+        if( !mRenderSystem->_getGpuTimestamps( frameIdx, frame.numQueries, &mTimestamps[0] ) )
+            return false;
+
+        frame.pending = false;
+
+        const uint64 frameStart = mTimestamps[0];
+
+        if( !frameStart )
+        {
+            //Unreliable results. Keep the last ones
+            frame.samples.clear();
+            return true;
+        }
+
+        mFrameTimeMs = Real( double( mTimestamps[frame.numQueries - 1u] - frameStart ) * 1e-6 );
+
+        mResults.clear();
+        mResults.reserve( frame.samples.size() );
+
+        SampleVec::const_iterator itor = frame.samples.begin();
+        SampleVec::const_iterator end  = frame.samples.end();
+
+        while( itor != end )
+        {
+            Result result;
+            result.name         = itor->name;
+            result.depth        = itor->depth;
+            result.startMs      = Real( double( mTimestamps[itor->beginQuery] - frameStart ) * 1e-6 );
+            result.durationMs   = Real( double( mTimestamps[itor->endQuery] -
+                                                mTimestamps[itor->beginQuery] ) * 1e-6 );
+            mResults.push_back( result );
+            ++itor;
+        }
+
+        frame.samples.clear();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuProfiler::_beginFrame(void)
+    {
+        if( !mEnabled )
+            return;
+
+        //Read back every finished frame, oldest first. mCurrentFrame is the oldest one.
+        //Queries finish in order, so we can stop at the first one that isn't ready.
+        const uint32 numFrames = static_cast<uint32>( mFrames.size() );
+        for( uint32 i=0; i<numFrames; ++i )
+        {
+            const uint32 frameIdx = (mCurrentFrame + i) % numFrames;
+            if( mFrames[frameIdx].pending && !collectResults( frameIdx ) )
+                break;
+        }
+
+        Frame &frame = mFrames[mCurrentFrame];
+
+        //If the GPU is still working on this slot it is more than numFrames behind.
+        //Don't stall, just skip this frame.
+        mRecording = !frame.pending;
+
+        if( mRecording )
+        {
+            frame.numQueries = 0;
+            mNumReservedQueries = 1u; //The end of the frame
+            mNumDroppedSamples = 0;
+            mRenderSystem->_beginGpuTimestampFrame( mCurrentFrame );
+            mRenderSystem->_writeGpuTimestamp( mCurrentFrame, frame.numQueries++ );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuProfiler::_endFrame(void)
+    {
+        if( !mRecording )
+            return;
+
+        //Close samples left open by mistake so the results are usable
+        while( !mOpenSamples.empty() )
+            endSample();
+
+        Frame &frame = mFrames[mCurrentFrame];
+        mRenderSystem->_writeGpuTimestamp( mCurrentFrame, frame.numQueries++ );
+        mRenderSystem->_endGpuTimestampFrame( mCurrentFrame );
+        frame.pending = true;
+
+        mCurrentFrame = (mCurrentFrame + 1u) % static_cast<uint32>( mFrames.size() );
+        mRecording = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void GpuProfiler::logResults(void) const
+    {
+        LogManager &logManager = LogManager::getSingleton();
+
+        logManager.logMessage( "GPU frame time: " + StringConverter::toString( mFrameTimeMs ) +
+                               " ms" );
+
+        ResultVec::const_iterator itor = mResults.begin();
+        ResultVec::const_iterator end  = mResults.end();
+
+        while( itor != end )
+        {
+            logManager.logMessage( String( (itor->depth + 1u) * 2u, ' ' ) + itor->name + ": " +
+                                   StringConverter::toString( itor->durationMs ) + " ms (at " +
+                                   StringConverter::toString( itor->startMs ) + " ms)" );
+            ++itor;
+        }
+    }
+}
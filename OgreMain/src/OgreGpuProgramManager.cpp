@@ -30,6 +30,7 @@ THE SOFTWARE.
 #include "OgreHighLevelGpuProgramManager.h"
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h"
+#include "OgreLogManager.h"
 
 #include "Hash/MurmurHash3.h"
 
@@ -56,6 +57,9 @@ namespace Ogre {
         return getResourceByName(name, preferHighLevelPrograms).staticCast<GpuProgram>();
     }
     //---------------------------------------------------------------------------
+    static const uint32 c_microcodeCacheMagic   = 0x43434D4F;  // 'OMCC'
+    static const uint32 c_microcodeCacheVersion = 1u;
+    //---------------------------------------------------------------------
     GpuProgramManager::GpuProgramManager()
     {
         // Loading order
@@ -242,6 +246,16 @@ namespace Ogre {
         return mCacheDirty;     
     }
     //---------------------------------------------------------------------
+    void GpuProgramManager::setMicrocodeCacheSignature( const String &signature )
+    {
+        mMicrocodeCacheSignature = signature;
+    }
+    //---------------------------------------------------------------------
+    const String& GpuProgramManager::getMicrocodeCacheSignature(void) const
+    {
+        return mMicrocodeCacheSignature;
+    }
+    //---------------------------------------------------------------------
     GpuProgramManager::Hash GpuProgramManager::computeHashWithRenderSystemName( const String &source )
     {
         // Use the current render system
@@ -313,6 +327,15 @@ namespace Ogre {
                 "GpuProgramManager::saveMicrocodeCache");
         }
         
+        // write the header
+        stream->write( &c_microcodeCacheMagic, sizeof(uint32) );
+        stream->write( &c_microcodeCacheVersion, sizeof(uint32) );
+        {
+            uint32 signatureLength = static_cast<uint32>( mMicrocodeCacheSignature.size() );
+            stream->write( &signatureLength, sizeof(uint32) );
+            stream->write( mMicrocodeCacheSignature.c_str(), signatureLength );
+        }
+
         // write the size of the array
         uint32 sizeOfArray = static_cast<uint32>(mMicrocodeCache.size());
         stream->write(&sizeOfArray, sizeof(uint32));
@@ -340,6 +363,35 @@ namespace Ogre {
     void GpuProgramManager::loadMicrocodeCache( DataStreamPtr stream )
     {
         mMicrocodeCache.clear();
+        mCacheDirty = false;
+
+        // validate the header
+        {
+            uint32 magic = 0;
+            uint32 version = 0;
+            uint32 signatureLength = 0;
+            stream->read( &magic, sizeof(uint32) );
+            stream->read( &version, sizeof(uint32) );
+            stream->read( &signatureLength, sizeof(uint32) );
+
+            String signature;
+            if( magic == c_microcodeCacheMagic && version == c_microcodeCacheVersion &&
+                signatureLength == mMicrocodeCacheSignature.size() )
+            {
+                signature.resize( signatureLength );
+                if( signatureLength )
+                    stream->read( &signature[0], signatureLength );
+            }
+
+            if( magic != c_microcodeCacheMagic || version != c_microcodeCacheVersion ||
+                signature != mMicrocodeCacheSignature )
+            {
+                LogManager::getSingleton().logMessage(
+                            "Microcode cache " + stream->getName() + " was created by a different "
+                            "driver or Ogre version. Discarding it." );
+                return;
+            }
+        }
 
         // write the size of the array
         uint32 sizeOfArray = 0;
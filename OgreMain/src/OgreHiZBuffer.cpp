@@ -0,0 +1,249 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreHiZBuffer.h"
+#include "OgreTextureBox.h"
+#include "OgreException.h"
+#include "Math/Simple/OgreAabb.h"
+
+namespace Ogre
+{
+    HiZBuffer::HiZBuffer( uint32 maxResolution ) :
+        mViewProjMatrix( Matrix4::IDENTITY ),
+        mDepthRange( 1.0f ),
+        mReverseDepth( false ),
+        mMaxResolution( std::max( maxResolution, 1u ) )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    HiZBuffer::~HiZBuffer()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    inline float HiZBuffer::toLinearFarness( float depth ) const
+    {
+        return mReverseDepth ? (1.0f - depth) : depth;
+    }
+    //-----------------------------------------------------------------------------------
+    void HiZBuffer::update( const TextureBox &depthBox, PixelFormatGpu pixelFormat,
+                            const Matrix4 &viewProjMatrix, Real depthRange, bool reverseDepth )
+    {
+        if( pixelFormat != PFG_D32_FLOAT && pixelFormat != PFG_R32_FLOAT &&
+            pixelFormat != PFG_D16_UNORM && pixelFormat != PFG_R16_UNORM &&
+            pixelFormat != PFG_D32_FLOAT_S8X24_UINT )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Unsupported pixel format " +
+                         String( PixelFormatGpuUtils::toString( pixelFormat ) ),
+                         "HiZBuffer::update" );
+        }
+
+        mViewProjMatrix = viewProjMatrix;
+        mDepthRange     = depthRange;
+        mReverseDepth   = reverseDepth;
+
+        //Find the size of mip 0 (the source is halved until it fits in mMaxResolution)
+        uint32 width    = std::max( depthBox.width, 1u );
+        uint32 height   = std::max( depthBox.height, 1u );
+        while( width > mMaxResolution || height > mMaxResolution )
+        {
+            width   = std::max( (width + 1u) >> 1u, 1u );
+            height  = std::max( (height + 1u) >> 1u, 1u );
+        }
+
+        mMips.clear();
+        Mip mip;
+        mip.width   = width;
+        mip.height  = height;
+        mip.offset  = 0;
+        mMips.push_back( mip );
+
+        mDepth.resizePOD( width * height );
+
+        //Conservative downsample: keep the farthest depth of each block of source texels.
+        const bool is16bit = pixelFormat == PFG_D16_UNORM || pixelFormat == PFG_R16_UNORM;
+
+        for( uint32 y=0; y<height; ++y )
+        {
+            const uint32 srcYStart  = (y * depthBox.height) / height;
+            const uint32 srcYEnd    = std::max( ((y + 1u) * depthBox.height) / height,
+                                                srcYStart + 1u );
+
+            for( uint32 x=0; x<width; ++x )
+            {
+                const uint32 srcXStart  = (x * depthBox.width) / width;
+                const uint32 srcXEnd    = std::max( ((x + 1u) * depthBox.width) / width,
+                                                    srcXStart + 1u );
+
+                float farthest = 0.0f;
+                for( uint32 srcY=srcYStart; srcY<srcYEnd; ++srcY )
+                {
+                    for( uint32 srcX=srcXStart; srcX<srcXEnd; ++srcX )
+                    {
+                        const void *texel = depthBox.at( srcX, srcY, 0 );
+                        float depth;
+                        if( is16bit )
+                            depth = *reinterpret_cast<const uint16*>( texel ) / 65535.0f;
+                        else
+                            depth = *reinterpret_cast<const float*>( texel );
+
+                        farthest = std::max( farthest, toLinearFarness( depth ) );
+                    }
+                }
+
+                mDepth[y * width + x] = farthest;
+            }
+        }
+
+        buildPyramid();
+    }
+    //-----------------------------------------------------------------------------------
+    void HiZBuffer::buildPyramid(void)
+    {
+        Mip mip = mMips.back();
+
+        while( mip.width > 1u || mip.height > 1u )
+        {
+            Mip nextMip;
+            nextMip.width   = std::max( (mip.width + 1u) >> 1u, 1u );
+            nextMip.height  = std::max( (mip.height + 1u) >> 1u, 1u );
+            nextMip.offset  = mDepth.size();
+
+            mDepth.resizePOD( mDepth.size() + nextMip.width * nextMip.height );
+
+            const float * RESTRICT_ALIAS src = mDepth.begin() + mip.offset;
+            float * RESTRICT_ALIAS dst = mDepth.begin() + nextMip.offset;
+
+            for( uint32 y=0; y<nextMip.height; ++y )
+            {
+                const uint32 y0 = y << 1u;
+                const uint32 y1 = std::min( y0 + 1u, mip.height - 1u );
+
+                for( uint32 x=0; x<nextMip.width; ++x )
+                {
+                    const uint32 x0 = x << 1u;
+                    const uint32 x1 = std::min( x0 + 1u, mip.width - 1u );
+
+                    dst[y * nextMip.width + x] =
+                            std::max( std::max( src[y0 * mip.width + x0], src[y0 * mip.width + x1] ),
+                                      std::max( src[y1 * mip.width + x0], src[y1 * mip.width + x1] ) );
+                }
+            }
+
+            mMips.push_back( nextMip );
+            mip = nextMip;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HiZBuffer::invalidate(void)
+    {
+        mMips.clear();
+        mDepth.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    bool HiZBuffer::isVisible( const Aabb &aabb ) const
+    {
+        if( mMips.empty() || aabb.mHalfSize.x == std::numeric_limits<Real>::infinity() )
+            return true;
+
+        Real minX = std::numeric_limits<Real>::max();
+        Real minY = std::numeric_limits<Real>::max();
+        Real maxX = -std::numeric_limits<Real>::max();
+        Real maxY = -std::numeric_limits<Real>::max();
+        Real nearest = std::numeric_limits<Real>::max();
+
+        for( int i=0; i<8; ++i )
+        {
+            const Vector3 corner( aabb.mCenter.x + ((i & 1) ? aabb.mHalfSize.x : -aabb.mHalfSize.x),
+                                  aabb.mCenter.y + ((i & 2) ? aabb.mHalfSize.y : -aabb.mHalfSize.y),
+                                  aabb.mCenter.z + ((i & 4) ? aabb.mHalfSize.z : -aabb.mHalfSize.z) );
+            const Vector4 clipPos = mViewProjMatrix * Vector4( corner.x, corner.y, corner.z, 1.0f );
+
+            //Crosses the near plane (or is behind the camera). We can't tell.
+            if( clipPos.w <= 1e-6f )
+                return true;
+
+            const Real invW = 1.0f / clipPos.w;
+            const Real ndcX = clipPos.x * invW;
+            const Real ndcY = clipPos.y * invW;
+            Real depth = clipPos.z * invW;
+            if( mDepthRange != 1.0f )
+                depth = depth * 0.5f + 0.5f;
+
+            minX = std::min( minX, ndcX );
+            minY = std::min( minY, ndcY );
+            maxX = std::max( maxX, ndcX );
+            maxY = std::max( maxY, ndcY );
+            nearest = std::min( nearest, static_cast<Real>( toLinearFarness( static_cast<float>( depth ) ) ) );
+        }
+
+        //Outside the screen. Frustum culling deals with these.
+        if( maxX < -1.0f || minX > 1.0f || maxY < -1.0f || minY > 1.0f )
+            return true;
+
+        const Mip &mip0 = mMips[0];
+
+        //NDC to texels. Row 0 is the top of the screen.
+        const Real fWidth   = static_cast<Real>( mip0.width );
+        const Real fHeight  = static_cast<Real>( mip0.height );
+        const Real texMinX  = Math::Clamp<Real>( (minX * 0.5f + 0.5f) * fWidth, 0, fWidth - 1.0f );
+        const Real texMaxX  = Math::Clamp<Real>( (maxX * 0.5f + 0.5f) * fWidth, 0, fWidth - 1.0f );
+        const Real texMinY  = Math::Clamp<Real>( (0.5f - maxY * 0.5f) * fHeight, 0, fHeight - 1.0f );
+        const Real texMaxY  = Math::Clamp<Real>( (0.5f - minY * 0.5f) * fHeight, 0, fHeight - 1.0f );
+
+        uint32 x0 = static_cast<uint32>( texMinX );
+        uint32 x1 = static_cast<uint32>( texMaxX );
+        uint32 y0 = static_cast<uint32>( texMinY );
+        uint32 y1 = static_cast<uint32>( texMaxY );
+
+        //Pick the mip where the rectangle covers at most 2x2 texels.
+        size_t mipLevel = 0;
+        while( mipLevel + 1u < mMips.size() && ((x1 - x0) > 1u || (y1 - y0) > 1u) )
+        {
+            x0 >>= 1u;
+            x1 >>= 1u;
+            y0 >>= 1u;
+            y1 >>= 1u;
+            ++mipLevel;
+        }
+
+        const Mip &mip = mMips[mipLevel];
+        const float *depth = mDepth.begin() + mip.offset;
+
+        float farthest = 0.0f;
+        for( uint32 y=y0; y<=y1; ++y )
+        {
+            for( uint32 x=x0; x<=x1; ++x )
+                farthest = std::max( farthest, depth[y * mip.width + x] );
+        }
+
+        return nearest <= farthest;
+    }
+}
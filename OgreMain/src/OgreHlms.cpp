@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreHighLevelGpuProgram.h"
 
 #include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreVaoManager.h"
 
 #include "Compositor/OgreCompositorShadowNode.h"
 #include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
@@ -56,6 +57,12 @@ THE SOFTWARE.
 #include "OgreBitset.h"
 
 #include "OgreProfiler.h"
+#include "OgreRoot.h"
+#include "OgreFrameMetrics.h"
+#include "OgreLoadProfiler.h"
+#include "OgreTimer.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWaitableEvent.h"
 
 #if OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS
     #include "iOS/macUtils.h"
@@ -88,10 +95,13 @@ namespace Ogre
 
     //Change per mesh (hash can be cached on the renderable)
     const IdString HlmsBaseProp::Skeleton           = IdString( "hlms_skeleton" );
+    const IdString HlmsBaseProp::SkeletonGpu        = IdString( "hlms_skeleton_gpu" );
+    const IdString HlmsBaseProp::SkeletonBaked      = IdString( "hlms_skeleton_baked" );
     const IdString HlmsBaseProp::BonesPerVertex     = IdString( "hlms_bones_per_vertex" );
     const IdString HlmsBaseProp::Pose               = IdString( "hlms_pose" );
     const IdString HlmsBaseProp::PoseHalfPrecision  = IdString( "hlms_pose_half" );
     const IdString HlmsBaseProp::PoseNormals        = IdString( "hlms_pose_normals" );
+    const IdString HlmsBaseProp::PoseSparse         = IdString( "hlms_pose_sparse" );
 
     const IdString HlmsBaseProp::Normal             = IdString( "hlms_normal" );
     const IdString HlmsBaseProp::QTangent           = IdString( "hlms_qtangent" );
@@ -146,6 +156,10 @@ namespace Ogre
     const IdString HlmsBaseProp::UvBaking           = IdString( "hlms_uv_baking" );
     const IdString HlmsBaseProp::BakeLightingOnly   = IdString( "hlms_bake_lighting_only" );
     const IdString HlmsBaseProp::GenNormalsGBuf     = IdString( "hlms_gen_normals_gbuffer" );
+    const IdString HlmsBaseProp::GenGBuffer         = IdString( "hlms_gen_gbuffer" );
+    const IdString HlmsBaseProp::GenMotionVectors   = IdString( "hlms_gen_motion_vectors" );
+    const IdString HlmsBaseProp::TemporalJitter     = IdString( "hlms_temporal_jitter" );
+    const IdString HlmsBaseProp::OitWeighted        = IdString( "hlms_oit_weighted" );
     const IdString HlmsBaseProp::PrePass            = IdString( "hlms_prepass" );
     const IdString HlmsBaseProp::UsePrePass         = IdString( "hlms_use_prepass" );
     const IdString HlmsBaseProp::UsePrePassMsaa     = IdString( "hlms_use_prepass_msaa" );
@@ -182,6 +196,8 @@ namespace Ogre
     const IdString HlmsBaseProp::AlphaTest                 = IdString( "alpha_test" );
     const IdString HlmsBaseProp::AlphaTestShadowCasterOnly = IdString( "alpha_test_shadow_caster_only" );
     const IdString HlmsBaseProp::AlphaBlend     = IdString( "hlms_alphablend" );
+    const IdString HlmsBaseProp::AlphaBlendPremultiplied =
+            IdString( "hlms_alphablend_premultiplied" );
     const IdString HlmsBaseProp::ScreenSpaceRefractions    = IdString( "hlms_screen_space_refractions" );
 
     const IdString HlmsBaseProp::NoReverseDepth = IdString( "hlms_no_reverse_depth" );
@@ -249,9 +265,112 @@ namespace Ogre
 
     HlmsListener c_defaultListener;
 
+    /// Runs the template parsers for another Hlms, on its background thread.
+    /// Only the parser state is ever used; it doesn't create datablocks nor shaders.
+    class HlmsTemplateExpander : public Hlms
+    {
+    public:
+        HlmsTemplateExpander() : Hlms( HLMS_MAX, "TemplateExpander", 0, 0 ) {}
+
+        virtual HlmsDatablock* createDatablockImpl( IdString datablockName,
+                                                    const HlmsMacroblock *macroblock,
+                                                    const HlmsBlendblock *blendblock,
+                                                    const HlmsParamVec &paramVec )
+                                                                    { return 0; }
+        virtual uint32 fillBuffersFor( const HlmsCache *cache,
+                                       const QueuedRenderable &queuedRenderable,
+                                       bool casterPass, uint32 lastCacheHash,
+                                       uint32 lastTextureHash )     { return 0; }
+        virtual uint32 fillBuffersForV1( const HlmsCache *cache,
+                                         const QueuedRenderable &queuedRenderable,
+                                         bool casterPass, uint32 lastCacheHash,
+                                         CommandBuffer *commandBuffer )
+                                                                    { return 0; }
+        virtual uint32 fillBuffersForV2( const HlmsCache *cache,
+                                         const QueuedRenderable &queuedRenderable,
+                                         bool casterPass, uint32 lastCacheHash,
+                                         CommandBuffer *commandBuffer )
+                                                                    { return 0; }
+    };
+
+    struct Hlms::AsyncShaderGenerator
+    {
+        struct Job
+        {
+            ShaderCodeCache         codeCache;
+            uint32                  finalHash;
+
+            //Written by the background thread, read once expanded is set
+            ExpandedShaderCode      code;
+            HlmsPropertyVec         properties;
+            ShaderGenerationTimings timings;
+            /// The expansion threw. The main thread runs it again to raise the exception.
+            bool                    failed;
+
+            //Protected by AsyncShaderGenerator::mutex
+            bool                    expanded;
+
+            Job( const ShaderCodeCache &_codeCache, uint32 _finalHash ) :
+                codeCache( _codeCache ), finalHash( _finalHash ), failed( false ),
+                expanded( false )
+            {
+            }
+        };
+        typedef vector<Job*>::type JobVec;
+        typedef deque<Job*>::type JobDeque;
+
+        //Protected by mutex
+        JobDeque            queue;
+        /// Job being expanded by the background thread
+        Job                 *current;
+        bool                stop;
+
+        //Main thread only
+        /// Jobs queued, being expanded, or expanded but not compiled yet. Owns them.
+        JobVec              pending;
+        /// The settings of the expander are out of date. @see isShaderCodeReady
+        bool                expanderDirty;
+
+        /// Only used by the background thread (or while it's idle)
+        Hlms                *expander;
+
+        LightweightMutex    mutex;
+        WaitableEvent       workerEvent;
+        WaitableEvent       idleEvent;
+        ThreadHandlePtr     thread;
+
+        AsyncShaderGenerator() :
+            current( 0 ), stop( false ), expanderDirty( true ),
+            expander( OGRE_NEW HlmsTemplateExpander() )
+        {
+        }
+
+        ~AsyncShaderGenerator()
+        {
+            JobVec::const_iterator itor = pending.begin();
+            JobVec::const_iterator end  = pending.end();
+            while( itor != end )
+                delete *itor++;
+            pending.clear();
+
+            OGRE_DELETE expander;
+            expander = 0;
+        }
+    };
+
+    unsigned long hlmsAsyncShaderGeneratorThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::Background );
+        Hlms *hlms = reinterpret_cast<Hlms*>( threadHandle->getUserParam() );
+        hlms->_asyncShaderGeneratorThread();
+        return 0;
+    }
+    THREAD_DECLARE( hlmsAsyncShaderGeneratorThread );
+    //-----------------------------------------------------------------------------------
     Hlms::Hlms( HlmsTypes type, const String &typeName, Archive *dataFolder,
                 ArchiveVec *libraryFolders ) :
         mDataFolder( dataFolder ),
+        mPieceFilesEnumerated( false ),
         mHlmsManager( 0 ),
         mLightGatheringMode( LightGatherForward ),
         mNumLightsLimit( 0u ),
@@ -278,12 +397,25 @@ namespace Ogre
     #endif
         mHighQuality( false ),
         mFastShaderBuildHack( false ),
+        mShaderCompilationBudget( 0 ),
+        mShaderCompilationTime( 0 ),
+        mShaderCompilationFrame( 0 ),
+        mNumDeferredDraws( 0 ),
+        mNextShaderCodeId( 0 ),
+        mAsyncShaderGenerator( 0 ),
+        mWarmUpPso( 0 ),
+        mFrameCount( 0 ),
+        mTotalPsoCreationTime( 0 ),
+        mNumPsosCreated( 0 ),
+        mNumPsosEvicted( 0 ),
+        mCpuTimer( 0 ),
         mDefaultDatablock( 0 ),
         mType( type ),
         mTypeName( typeName ),
         mTypeNameStr( typeName )
     {
         memset( mShaderTargets, 0, sizeof(mShaderTargets) );
+        memset( &mShaderGenerationTimings, 0, sizeof( mShaderGenerationTimings ) );
 
         if( libraryFolders )
         {
@@ -308,6 +440,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     Hlms::~Hlms()
     {
+        setAsyncShaderGeneration( false );
         clearShaderCache();
 
         _destroyAllDatablocks();
@@ -355,6 +488,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Hlms::getTemplateChecksum( uint64 outHash[2] ) const
     {
+        enumeratePieceFilesIfNeeded();
+
         FastArray<uint8> fileContents;
         fileContents.resize( sizeof(uint64) * 2u, 0 );
 
@@ -416,10 +551,13 @@ namespace Ogre
         setProperty( HlmsBaseProp::Pose, 0 );
         setProperty( HlmsBaseProp::PoseHalfPrecision, 0 );
         setProperty( HlmsBaseProp::PoseNormals, 0 );
+        setProperty( HlmsBaseProp::PoseSparse, 0 );
     }
     //-----------------------------------------------------------------------------------
     void Hlms::enumeratePieceFiles(void)
     {
+        mPieceFilesEnumerated = false;
+
         if( !mDataFolder )
             return; //Some Hlms implementations may not use template files at all
 
@@ -444,11 +582,21 @@ namespace Ogre
                          "right read pemissions. Folder: " + mDataFolder->getName(),
                          "Hlms::Hlms" );
         }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::enumeratePieceFilesIfNeeded(void) const
+    {
+        if( mPieceFilesEnumerated || !mDataFolder )
+            return;
 
-        enumeratePieceFiles( mDataFolder, mPieceFiles );
+        //The piece file lists are a lazily built cache of the folders' contents
+        Hlms *thisNonConst = const_cast<Hlms*>( this );
+        thisNonConst->mPieceFilesEnumerated = true;
 
-        LibraryVec::iterator itor = mLibrary.begin();
-        LibraryVec::iterator end  = mLibrary.end();
+        enumeratePieceFiles( mDataFolder, thisNonConst->mPieceFiles );
+
+        LibraryVec::iterator itor = thisNonConst->mLibrary.begin();
+        LibraryVec::iterator end  = thisNonConst->mLibrary.end();
 
         while( itor != end )
         {
@@ -1734,6 +1882,8 @@ namespace Ogre
         for( size_t i=0; i<NumShaderTypes; ++i )
             mPieceFiles[i].clear();
 
+        mTemplateFiles.clear();
+
         mDataFolder = newDataFolder;
         enumeratePieceFiles();
     }
@@ -1780,6 +1930,34 @@ namespace Ogre
         return retVal;
     }
     //-----------------------------------------------------------------------------------
+    HlmsDatablock* Hlms::createDatablock( IdString name, const String &refName,
+                                          const HlmsMacroblock *macroblock,
+                                          const HlmsBlendblock *blendblock,
+                                          const HlmsParamVec &paramVec, bool visibleToManager,
+                                          const String &filename, const String &resourceGroup )
+    {
+        if( mDatablocks.find( name ) != mDatablocks.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_DUPLICATE_ITEM, "A material datablock with name '" +
+                         name.getFriendlyText() + "' already exists.", "Hlms::createDatablock" );
+        }
+
+        //HlmsDatablock's constructor takes ownership of one reference
+        mHlmsManager->addReference( macroblock );
+        mHlmsManager->addReference( blendblock );
+
+        HlmsDatablock *retVal = createDatablockImpl( name, macroblock, blendblock, paramVec );
+
+        mDatablocks[name] = DatablockEntry( retVal, visibleToManager, refName, filename, resourceGroup );
+
+        retVal->calculateHash();
+
+        if( visibleToManager )
+            mHlmsManager->_datablockAdded( retVal );
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
     HlmsDatablock* Hlms::getDatablock( IdString name ) const
     {
         HlmsDatablock *retVal = 0;
@@ -1887,7 +2065,9 @@ namespace Ogre
                 "Can't add the same shader to the cache twice! (or a hash collision happened)" );
 
         HlmsCache *retVal = new HlmsCache( cache );
+        retVal->lastUsedFrame = mFrameCount;
         mShaderCache.insert( it, retVal );
+        ++mNumPsosCreated;
 
         return retVal;
     }
@@ -1906,6 +2086,8 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void Hlms::clearShaderCache(void)
     {
+        flushAsyncShaderGeneration();
+
         mPassCache.clear();
 
         //Empty mShaderCache so that mHlmsManager->destroyMacroblock would
@@ -1920,6 +2102,8 @@ namespace Ogre
             mRenderSystem->_hlmsPipelineStateObjectDestroyed( &(*itor)->pso );
             if( (*itor)->pso.pass.hasStrongMacroblock() )
                 mHlmsManager->destroyMacroblock( (*itor)->pso.macroblock );
+            if( (*itor)->pso.pass.strongMacroblockBits & HlmsPassPso::WeightedBlendedOit )
+                mHlmsManager->destroyBlendblock( (*itor)->pso.blendblock );
 
             delete *itor;
             ++itor;
@@ -1928,6 +2112,188 @@ namespace Ogre
         shaderCache.clear();
 
         mShaderCodeCache.clear();
+        mNextShaderCodeId = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    Hlms::PsoStatistics Hlms::getPsoStatistics(void) const
+    {
+        PsoStatistics retVal;
+        retVal.numLivePsos          = mShaderCache.size();
+        retVal.numShaderVariants    = mShaderCodeCache.size();
+        retVal.numHits              = 0;
+        retVal.numPsosCreated       = mNumPsosCreated;
+        retVal.numPsosEvicted       = mNumPsosEvicted;
+        retVal.totalCreationTime    = mTotalPsoCreationTime;
+
+        HlmsCacheVec::const_iterator itor = mShaderCache.begin();
+        HlmsCacheVec::const_iterator end  = mShaderCache.end();
+
+        while( itor != end )
+        {
+            retVal.numHits += (*itor)->numHits;
+            ++itor;
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::_evictStalePsos( uint32 maxUnusedFrames, size_t maxLivePsos )
+    {
+        ++mFrameCount;
+
+        if( !maxUnusedFrames || mShaderCache.size() <= maxLivePsos )
+            return;
+
+        //Compact in place; mShaderCache stays sorted by hash
+        HlmsCacheVec::iterator itor = mShaderCache.begin();
+        HlmsCacheVec::iterator end  = mShaderCache.end();
+        HlmsCacheVec::iterator dst  = itor;
+
+        while( itor != end )
+        {
+            HlmsCache *cache = *itor;
+            if( mFrameCount - cache->lastUsedFrame > maxUnusedFrames )
+            {
+                mRenderSystem->_hlmsPipelineStateObjectDestroyed( &cache->pso );
+                if( cache->pso.pass.hasStrongMacroblock() )
+                    mHlmsManager->destroyMacroblock( cache->pso.macroblock );
+                if( cache->pso.pass.strongMacroblockBits & HlmsPassPso::WeightedBlendedOit )
+                    mHlmsManager->destroyBlendblock( cache->pso.blendblock );
+                delete cache;
+                ++mNumPsosEvicted;
+            }
+            else
+            {
+                *dst++ = cache;
+            }
+            ++itor;
+        }
+
+        mShaderCache.erase( dst, end );
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 Hlms::scanTemplateDirectives( const String &contents )
+    {
+        const char *c_mathKeywords[] =
+        { "pset", "padd", "psub", "pmul", "pdiv", "pmod", "pmin", "pmax" };
+        const char *c_counterKeywords[] =
+        { "counter", "value", "set", "add", "sub", "mul", "div", "mod", "min", "max" };
+
+        uint32 directives = 0;
+
+        size_t pos = contents.find( '@' );
+        while( pos != String::npos )
+        {
+            size_t keywordEnd = pos + 1u;
+            while( keywordEnd < contents.size() &&
+                   (isalnum( static_cast<unsigned char>( contents[keywordEnd] ) ) ||
+                    contents[keywordEnd] == '_') )
+            {
+                ++keywordEnd;
+            }
+
+            const String keyword = contents.substr( pos + 1u, keywordEnd - pos - 1u );
+
+            //These passes look for the keyword as a substring, so match them as prefixes
+            if( !keyword.compare( 0, sizeof( "foreach" ) - 1u, "foreach" ) )
+                directives |= TemplateForEach;
+            else if( !keyword.compare( 0, sizeof( "property" ) - 1u, "property" ) )
+                directives |= TemplateProperty;
+            else if( !keyword.compare( 0, sizeof( "undefpiece" ) - 1u, "undefpiece" ) )
+                directives |= TemplateUndefPiece;
+            else if( !keyword.compare( 0, sizeof( "piece" ) - 1u, "piece" ) )
+                directives |= TemplatePiece;
+            else
+            {
+                for( size_t i=0; i<sizeof(c_mathKeywords) / sizeof(c_mathKeywords[0]); ++i )
+                {
+                    if( keyword == c_mathKeywords[i] )
+                        directives |= TemplateMath;
+                }
+                for( size_t i=0; i<sizeof(c_counterKeywords) / sizeof(c_counterKeywords[0]); ++i )
+                {
+                    if( keyword == c_counterKeywords[i] )
+                        directives |= TemplateCounter;
+                }
+            }
+
+            pos = contents.find( '@', keywordEnd );
+        }
+
+        return directives;
+    }
+    //-----------------------------------------------------------------------------------
+    const Hlms::TemplateFile& Hlms::getTemplateFile( Archive *archive, const String &filename )
+    {
+        const String key = archive->getName() + "/" + filename;
+
+        TemplateFileMap::iterator itor = mTemplateFiles.find( key );
+        if( itor == mTemplateFiles.end() )
+        {
+            DataStreamPtr inFile = archive->open( filename );
+
+            TemplateFile templateFile;
+            templateFile.contents.resize( inFile->size() );
+            if( !templateFile.contents.empty() )
+                inFile->read( &templateFile.contents[0], inFile->size() );
+            templateFile.directives = scanTemplateDirectives( templateFile.contents );
+
+            itor = mTemplateFiles.insert( std::pair<String, TemplateFile>( key, templateFile ) ).first;
+        }
+
+        return itor->second;
+    }
+    //-----------------------------------------------------------------------------------
+    bool Hlms::hasTemplateFile( Archive *archive, const String &filename ) const
+    {
+        return mTemplateFiles.find( archive->getName() + "/" + filename ) != mTemplateFiles.end();
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::loadTemplateFiles(void)
+    {
+        enumeratePieceFilesIfNeeded();
+
+        for( size_t i=0; i<NumShaderTypes; ++i )
+        {
+            const String filename = ShaderFiles[i] + mShaderFileExt;
+            if( !hasTemplateFile( mDataFolder, filename ) && mDataFolder->exists( filename ) )
+            {
+                getTemplateFile( mDataFolder, filename );
+
+                LibraryVec::const_iterator itor = mLibrary.begin();
+                LibraryVec::const_iterator end  = mLibrary.end();
+
+                while( itor != end )
+                {
+                    loadPieceFiles( itor->dataFolder, itor->pieceFiles[i] );
+                    ++itor;
+                }
+
+                loadPieceFiles( mDataFolder, mPieceFiles[i] );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::loadPieceFiles( Archive *archive, const StringVector &pieceFiles )
+    {
+        StringVector::const_iterator itor = pieceFiles.begin();
+        StringVector::const_iterator end  = pieceFiles.end();
+
+        while( itor != end )
+        {
+            if( usesPieceFile( *itor ) )
+                getTemplateFile( archive, *itor );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool Hlms::usesPieceFile( const String &filename ) const
+    {
+        //Only open piece files with current render system extension
+        const String::size_type extPos0 = filename.find( mShaderFileExt );
+        const String::size_type extPos1 = filename.find( ".any" );
+        return extPos0 == filename.size() - mShaderFileExt.size() ||
+               extPos1 == filename.size() - 4u;
     }
     //-----------------------------------------------------------------------------------
     void Hlms::processPieces( Archive *archive, const StringVector &pieceFiles )
@@ -1937,30 +2303,57 @@ namespace Ogre
 
         while( itor != end )
         {
-            //Only open piece files with current render system extension
-            const String::size_type extPos0 = itor->find( mShaderFileExt );
-            const String::size_type extPos1 = itor->find( ".any" );
-            if( extPos0 == itor->size() - mShaderFileExt.size() ||
-                extPos1 == itor->size() - 4u )
+            if( usesPieceFile( *itor ) )
             {
-                DataStreamPtr inFile = archive->open(*itor);
+                const TemplateFile &templateFile = getTemplateFile( archive, *itor );
+                const uint32 directives = templateFile.directives;
 
-                String inString;
+                //Passes whose directives aren't in the file would copy it unchanged.
+                //The result of each pass ends up in inString.
+                String inString( templateFile.contents );
                 String outString;
 
-                inString.resize(inFile->size());
-                inFile->read(&inString[0], inFile->size());
+                ShaderGenerationTimings &timings = mShaderGenerationTimings;
+                uint64 timestamp = getCpuTime();
 
-                this->parseMath(inString, outString);
-                while( outString.find( "@foreach" ) != String::npos )
+                if( directives & TemplateMath )
+                {
+                    this->parseMath( inString, outString );
+                    inString.swap( outString );
+                    accumCpuTime( timings.parseMath, timestamp );
+                }
+                if( directives & TemplateForEach )
+                {
+                    while( inString.find( "@foreach" ) != String::npos )
+                    {
+                        this->parseForEach( inString, outString );
+                        inString.swap( outString );
+                    }
+                    accumCpuTime( timings.parseForEach, timestamp );
+                }
+                if( directives & TemplateProperty )
                 {
-                    this->parseForEach(outString, inString);
+                    this->parseProperties( inString, outString );
                     inString.swap( outString );
+                    accumCpuTime( timings.parseProperties, timestamp );
+                }
+                if( directives & TemplateUndefPiece )
+                {
+                    this->parseUndefPieces( inString, outString );
+                    inString.swap( outString );
+                    accumCpuTime( timings.parseUndefPieces, timestamp );
+                }
+                if( directives & TemplatePiece )
+                {
+                    this->collectPieces( inString, outString );
+                    inString.swap( outString );
+                    accumCpuTime( timings.collectPieces, timestamp );
+                }
+                if( directives & TemplateCounter )
+                {
+                    this->parseCounter( inString, outString );
+                    accumCpuTime( timings.parseCounter, timestamp );
                 }
-                this->parseProperties(outString, inString);
-                this->parseUndefPieces(inString, outString);
-                this->collectPieces(outString, inString);
-                this->parseCounter(inString, outString);
             }
             ++itor;
         }
@@ -2036,6 +2429,11 @@ namespace Ogre
             //Macroblock already enabled depth clamp, we don't need to hold a strong reference.
             pso.pass.strongMacroblockBits &= ~HlmsPassPso::ForceDepthClamp;
         }
+        if( !pso.blendblock || !pso.blendblock->isAutoTransparent() )
+        {
+            //Only alpha blended objects are accumulated with order independent transparency.
+            pso.pass.strongMacroblockBits &= ~HlmsPassPso::WeightedBlendedOit;
+        }
 
         if( pso.pass.hasStrongMacroblock() )
         {
@@ -2056,9 +2454,30 @@ namespace Ogre
             //Force depth clamp. Probably a directional shadow caster pass
             if( pso.pass.strongMacroblockBits & HlmsPassPso::ForceDepthClamp )
                 prepassMacroblock.mDepthClamp = true;
+            //Weighted blended OIT: the transparent objects must not occlude each other
+            if( pso.pass.strongMacroblockBits & HlmsPassPso::WeightedBlendedOit )
+                prepassMacroblock.mDepthWrite = false;
 
             pso.macroblock = mHlmsManager->getMacroblock( prepassMacroblock );
         }
+
+        if( pso.pass.strongMacroblockBits & HlmsPassPso::WeightedBlendedOit )
+        {
+            //RT0.rgb += colour * alpha * weight; RT0.a *= 1 - alpha
+            //RT1.r   += alpha * weight
+            //Both targets use the same blend state. See OitMode::WeightedBlended
+            HlmsBlendblock oitBlendblock = *pso.blendblock;
+            oitBlendblock.mSeparateBlend            = true;
+            oitBlendblock.mSourceBlendFactor        = SBF_ONE;
+            oitBlendblock.mDestBlendFactor          = SBF_ONE;
+            oitBlendblock.mSourceBlendFactorAlpha   = SBF_ZERO;
+            oitBlendblock.mDestBlendFactorAlpha     = SBF_ONE_MINUS_SOURCE_ALPHA;
+            oitBlendblock.mBlendOperation           = SBO_ADD;
+            oitBlendblock.mBlendOperationAlpha      = SBO_ADD;
+            oitBlendblock.mBlendChannelMask         = HlmsBlendblock::BlendChannelAll;
+            oitBlendblock.mAlphaToCoverageEnabled   = false;
+            pso.blendblock = mHlmsManager->getBlendblock( oitBlendblock );
+        }
     }
     //-----------------------------------------------------------------------------------
     HighLevelGpuProgramPtr Hlms::compileShaderCode( const String &source,
@@ -2100,8 +2519,7 @@ namespace Ogre
     {
         OgreProfileExhaustive( "Hlms::_compileShaderFromPreprocessedSource" );
 
-        const uint32 finalHash = mType * 100000000u +
-                                 static_cast<uint32>( mShaderCodeCache.size() );
+        const uint32 finalHash = mType * 100000000u + mNextShaderCodeId++;
 
         ShaderCodeCache codeCache( mergedCache.pieces );
         codeCache.mergedCache.setProperties = mergedCache.setProperties;
@@ -2140,8 +2558,22 @@ namespace Ogre
         OgreProfileExhaustive( "Hlms::compileShaderCode" );
 
         //Give the shaders friendly base-10 names
-        const uint32 finalHash = mType * 100000000u + static_cast<uint32>( mShaderCodeCache.size() );
+        const uint32 finalHash = mType * 100000000u + mNextShaderCodeId++;
+
+        LoadProfiler::Scope loadScope( LoadEvent::ShaderCompile, BLANKSTRING );
+        if( loadScope.isRecording() )
+            loadScope.setName( mTypeNameStr + " " + StringConverter::toString( finalHash ) );
 
+        loadTemplateFiles();
+
+        ExpandedShaderCode code;
+        expandShaderTemplates( codeCache, finalHash, code );
+        compileShaderCode( codeCache, code, finalHash );
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::expandShaderTemplates( const ShaderCodeCache &codeCache, uint32 finalHash,
+                                      ExpandedShaderCode &outCode )
+    {
         mSetProperties = codeCache.mergedCache.setProperties;
 
         {
@@ -2156,11 +2588,15 @@ namespace Ogre
         //Generate the shaders
         for( size_t i=0; i<NumShaderTypes; ++i )
         {
+            outCode.source[i].clear();
+            outCode.debugFilename[i].clear();
+            outCode.enabled[i] = false;
+
             //Collect pieces
             mPieces = codeCache.mergedCache.pieces[i];
 
             const String filename = ShaderFiles[i] + mShaderFileExt;
-            if( mDataFolder->exists( filename ) )
+            if( hasTemplateFile( mDataFolder, filename ) )
             {
                 if( mShaderProfile == "glsl" ) //TODO: String comparision
                 {
@@ -2190,7 +2626,7 @@ namespace Ogre
                 if( mFastShaderBuildHack )
                     setProperty( HlmsBaseProp::FastShaderBuildHack, 1 );
 
-                String debugFilenameOutput;
+                String &debugFilenameOutput = outCode.debugFilename[i];
                 std::ofstream debugDumpFile;
                 if( mDebugOutput )
                 {
@@ -2220,33 +2656,61 @@ namespace Ogre
                 processPieces( mDataFolder, mPieceFiles[i] );
 
                 //Generate the shader file.
-                DataStreamPtr inFile = mDataFolder->open( filename );
+                const TemplateFile &templateFile = getTemplateFile( mDataFolder, filename );
+                const uint32 directives = templateFile.directives;
 
-                String inString;
+                String inString( templateFile.contents );
                 String outString;
 
-                inString.resize( inFile->size() );
-                inFile->read( &inString[0], inFile->size() );
-
                 bool syntaxError = false;
 
-                syntaxError |= this->parseMath( inString, outString );
-                while( !syntaxError && outString.find( "@foreach" ) != String::npos )
+                ShaderGenerationTimings &timings = mShaderGenerationTimings;
+                uint64 timestamp = getCpuTime();
+
+                //Skip the passes whose directives aren't in the file (they'd copy it unchanged).
+                //Pieces inserted later have already been through them in processPieces.
+                if( directives & TemplateMath )
                 {
-                    syntaxError |= this->parseForEach( outString, inString );
+                    syntaxError |= this->parseMath( inString, outString );
                     inString.swap( outString );
+                    accumCpuTime( timings.parseMath, timestamp );
+                }
+                if( directives & TemplateForEach )
+                {
+                    while( !syntaxError && inString.find( "@foreach" ) != String::npos )
+                    {
+                        syntaxError |= this->parseForEach( inString, outString );
+                        inString.swap( outString );
+                    }
+                    accumCpuTime( timings.parseForEach, timestamp );
                 }
-                syntaxError |= this->parseProperties( outString, inString );
-                syntaxError |= this->parseUndefPieces( inString, outString );
+                if( directives & TemplateProperty )
+                {
+                    syntaxError |= this->parseProperties( inString, outString );
+                    inString.swap( outString );
+                    accumCpuTime( timings.parseProperties, timestamp );
+                }
+                if( directives & TemplateUndefPiece )
+                {
+                    syntaxError |= this->parseUndefPieces( inString, outString );
+                    accumCpuTime( timings.parseUndefPieces, timestamp );
+                }
+                else
+                    outString.swap( inString );
                 while( !syntaxError  && (outString.find( "@piece" ) != String::npos ||
                                          outString.find( "@insertpiece" ) != String::npos) )
                 {
                     syntaxError |= this->collectPieces( outString, inString );
+                    accumCpuTime( timings.collectPieces, timestamp );
                     syntaxError |= this->insertPieces( inString, outString );
+                    accumCpuTime( timings.insertPieces, timestamp );
                 }
                 syntaxError |= this->parseCounter( outString, inString );
+                accumCpuTime( timings.parseCounter, timestamp );
+                ++timings.numShaders;
 
                 outString.swap( inString );
+                outCode.source[i].swap( outString );
 
                 if( syntaxError )
                 {
@@ -2258,34 +2722,43 @@ namespace Ogre
 
                 //Now dump the processed file.
                 if( mDebugOutput )
-                    debugDumpFile.write( &outString[0], outString.size() );
+                    debugDumpFile.write( outCode.source[i].c_str(), outCode.source[i].size() );
 
                 //Don't create and compile if template requested not to
-                if( !getProperty( HlmsBaseProp::DisableStage ) )
-                {
-                    codeCache.shaders[i] = compileShaderCode( outString, debugFilenameOutput,
-                                                              finalHash, static_cast<ShaderType>( i ) );
-                }
+                outCode.enabled[i] = getProperty( HlmsBaseProp::DisableStage ) == 0;
 
                 //Reset the disable flag.
                 setProperty( HlmsBaseProp::DisableStage, 0 );
             }
         }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::compileShaderCode( ShaderCodeCache &codeCache, const ExpandedShaderCode &code,
+                                  uint32 finalHash )
+    {
+        ShaderGenerationTimings &timings = mShaderGenerationTimings;
+
+        for( size_t i=0; i<NumShaderTypes; ++i )
+        {
+            if( code.enabled[i] )
+            {
+                uint64 timestamp = getCpuTime();
+                codeCache.shaders[i] = compileShaderCode( code.source[i], code.debugFilename[i],
+                                                          finalHash, static_cast<ShaderType>( i ) );
+                accumCpuTime( timings.compile, timestamp );
+            }
+        }
 
         mShaderCodeCache.push_back( codeCache );
     }
     //-----------------------------------------------------------------------------------
-    const HlmsCache* Hlms::createShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
-                                                   uint32 finalHash,
-                                                   const QueuedRenderable &queuedRenderable )
+    void Hlms::mergeShaderCodeProperties( const RenderableCache &renderableCache,
+                                          const HlmsCache &passCache,
+                                          const QueuedRenderable &queuedRenderable,
+                                          ShaderCodeCache &outCodeCache )
     {
-        OgreProfileExhaustive( "Hlms::createShaderCacheEntry" );
-
         //Set the properties by merging the cache from the pass, with the cache from renderable
         mSetProperties.clear();
-        //If retVal is null, we did something wrong earlier
-        //(the cache should've been generated by now)
-        const RenderableCache &renderableCache = getRenderableCache( renderableHash );
         mSetProperties.reserve( passCache.setProperties.size() + renderableCache.setProperties.size() );
         //Copy the properties from the renderable
         mSetProperties.insert( mSetProperties.end(), renderableCache.setProperties.begin(),
@@ -2312,12 +2785,25 @@ namespace Ogre
                                                       renderableCache.pieces,
                                                       mSetProperties, queuedRenderable );
 
-        //Retrieve the shader code from the code cache
-        ShaderCodeCache codeCache( renderableCache.pieces );
         unsetProperty( HlmsPsoProp::Macroblock );
         unsetProperty( HlmsPsoProp::Blendblock );
         unsetProperty( HlmsPsoProp::InputLayoutId );
-        codeCache.mergedCache.setProperties.swap( mSetProperties );
+        outCodeCache.mergedCache.setProperties.swap( mSetProperties );
+    }
+    //-----------------------------------------------------------------------------------
+    const HlmsCache* Hlms::createShaderCacheEntry( uint32 renderableHash, const HlmsCache &passCache,
+                                                   uint32 finalHash,
+                                                   const QueuedRenderable &queuedRenderable )
+    {
+        OgreProfileExhaustive( "Hlms::createShaderCacheEntry" );
+
+        //If retVal is null, we did something wrong earlier
+        //(the cache should've been generated by now)
+        const RenderableCache &renderableCache = getRenderableCache( renderableHash );
+
+        //Retrieve the shader code from the code cache
+        ShaderCodeCache codeCache( renderableCache.pieces );
+        mergeShaderCodeProperties( renderableCache, passCache, queuedRenderable, codeCache );
         {
             ShaderCodeCacheVec::iterator itCodeCache = std::find( mShaderCodeCache.begin(),
                                                                   mShaderCodeCache.end(), codeCache );
@@ -2341,9 +2827,21 @@ namespace Ogre
 
         bool casterPass = getProperty( HlmsBaseProp::ShadowCaster ) != 0;
 
-        const HlmsDatablock *datablock = queuedRenderable.renderable->getDatablock();
-        pso.macroblock = datablock->getMacroblock( casterPass );
-        pso.blendblock = datablock->getBlendblock( casterPass );
+        if( queuedRenderable.renderable )
+        {
+            const HlmsDatablock *datablock = queuedRenderable.renderable->getDatablock();
+            pso.macroblock = datablock->getMacroblock( casterPass );
+            pso.blendblock = datablock->getBlendblock( casterPass );
+        }
+        else
+        {
+            assert( mWarmUpPso && "A renderable is needed unless warming up PSOs" );
+            pso.macroblock      = mWarmUpPso->macroblock;
+            pso.blendblock      = mWarmUpPso->blendblock;
+            pso.operationType   = mWarmUpPso->operationType;
+            pso.vertexElements  = mWarmUpPso->vertexElements;
+            pso.enablePrimitiveRestart = true;
+        }
         pso.pass = passCache.pso.pass;
 
         applyStrongMacroblockRules( pso );
@@ -2377,7 +2875,12 @@ namespace Ogre
             pso.enablePrimitiveRestart = true;
         }
 
-        mRenderSystem->_hlmsPipelineStateObjectCreated( &pso );
+        {
+            LoadProfiler::Scope loadScope( LoadEvent::PsoCreation, BLANKSTRING );
+            if( loadScope.isRecording() )
+                loadScope.setName( mTypeNameStr + " " + StringConverter::toString( finalHash ) );
+            mRenderSystem->_hlmsPipelineStateObjectCreated( &pso );
+        }
 
         const HlmsCache* retVal = addShaderCache( finalHash, pso );
 
@@ -2494,10 +2997,17 @@ namespace Ogre
         mSetProperties.clear();
 
         setProperty( HlmsBaseProp::Skeleton, renderable->hasSkeletonAnimation() );
+        //Baked animations read the bone matrices the same way GPU evaluated ones do
+        setProperty( HlmsBaseProp::SkeletonGpu, renderable->hasSkeletonAnimation() &&
+                                                ( renderable->hasGpuSkeletonAnimation() ||
+                                                  renderable->hasBakedSkeletonAnimation() ) );
+        setProperty( HlmsBaseProp::SkeletonBaked, renderable->hasSkeletonAnimation() &&
+                                                  renderable->hasBakedSkeletonAnimation() );
 
         setProperty( HlmsBaseProp::Pose, renderable->getNumPoses() );
         setProperty( HlmsBaseProp::PoseHalfPrecision, renderable->getPoseHalfPrecision() );
         setProperty( HlmsBaseProp::PoseNormals, renderable->getPoseNormals() );
+        setProperty( HlmsBaseProp::PoseSparse, renderable->getPoseIndexTexBuffer() != 0 );
 
         uint16 numTexCoords = 0;
         if( renderable->getVaos( VpNormal ).empty() )
@@ -2512,6 +3022,9 @@ namespace Ogre
         setProperty( HlmsBaseProp::AlphaTest, datablock->getAlphaTest() != CMPF_ALWAYS_PASS );
         setProperty( HlmsBaseProp::AlphaTestShadowCasterOnly, datablock->getAlphaTestShadowCasterOnly() );
         setProperty( HlmsBaseProp::AlphaBlend, datablock->getBlendblock(false)->isAutoTransparent() );
+        setProperty( HlmsBaseProp::AlphaBlendPremultiplied,
+                     datablock->getBlendblock(false)->isAutoTransparent() &&
+                     datablock->getBlendblock(false)->mSourceBlendFactor == SBF_ONE );
 
         if( renderable->getUseIdentityWorldMatrix() )
             setProperty( HlmsBaseProp::IdentityWorld, 1 );
@@ -2779,6 +3292,20 @@ namespace Ogre
 
                 if( passSceneDef->mGenNormalsGBuf )
                     setProperty( HlmsBaseProp::GenNormalsGBuf, 1 );
+                if( passSceneDef->mGenGBuffer && passSceneDef->mPrePassMode == PrePassNone )
+                {
+                    setProperty( HlmsBaseProp::GenNormalsGBuf, 1 );
+                    setProperty( HlmsBaseProp::GenGBuffer, 1 );
+                }
+                if( passSceneDef->mGenMotionVectors && !passSceneDef->mInstancedStereo )
+                    setProperty( HlmsBaseProp::GenMotionVectors, 1 );
+                if( passSceneDef->mTemporalJitter )
+                    setProperty( HlmsBaseProp::TemporalJitter, 1 );
+                if( passSceneDef->mOitMode == OitMode::WeightedBlended )
+                {
+                    setProperty( HlmsBaseProp::OitWeighted, 1 );
+                    setProperty( HlmsBaseProp::VPos, 1 );
+                }
             }
 
             ForwardPlusBase *forwardPlus = sceneManager->_getActivePassForwardPlus();
@@ -3141,6 +3668,14 @@ namespace Ogre
         if( sceneManager->getCamerasInProgress().renderingCamera->getNeedsDepthClamp() )
             passPso.strongMacroblockBits |= HlmsPassPso::ForceDepthClamp;
 
+        const CompositorPass *pass = sceneManager->getCurrentCompositorPass();
+        if( pass && pass->getType() == PASS_SCENE &&
+            static_cast<const CompositorPassSceneDef*>( pass->getDefinition() )->mOitMode ==
+            OitMode::WeightedBlended )
+        {
+            passPso.strongMacroblockBits |= HlmsPassPso::WeightedBlendedOit;
+        }
+
         const bool invertVertexWinding = mRenderSystem->getInvertVertexWinding();
 
         if( (renderPassDesc->requiresTextureFlipping() && !invertVertexWinding) ||
@@ -3200,7 +3735,7 @@ namespace Ogre
     const HlmsCache* Hlms::getMaterial( HlmsCache const *lastReturnedValue,
                                         const HlmsCache &passCache,
                                         const QueuedRenderable &queuedRenderable,
-                                        bool casterPass )
+                                        bool casterPass, bool allowDeferral )
     {
         uint32 finalHash;
         uint32 hash[2];
@@ -3224,19 +3759,351 @@ namespace Ogre
 
             if( !lastReturnedValue )
             {
+                Root *root = Root::getSingletonPtr();
+
+                if( mShaderCompilationBudget || mAsyncShaderGenerator )
+                {
+                    const unsigned long currentFrame = root->getNextFrameNumber();
+                    if( mShaderCompilationFrame != currentFrame )
+                    {
+                        mShaderCompilationFrame = currentFrame;
+                        mShaderCompilationTime  = 0;
+                        mNumDeferredDraws       = 0;
+                    }
+
+                    if( allowDeferral && mShaderCompilationBudget &&
+                        mShaderCompilationTime >= mShaderCompilationBudget )
+                    {
+                        ++mNumDeferredDraws;
+                        return 0;
+                    }
+                }
+
+                Timer *timer = root->getTimer();
+                const uint64 startTime = timer->getMicroseconds();
+
+                if( allowDeferral && mAsyncShaderGenerator &&
+                    !isShaderCodeReady( hash[0], passCache, queuedRenderable ) )
+                {
+                    mShaderCompilationTime += timer->getMicroseconds() - startTime;
+                    ++mNumDeferredDraws;
+                    return 0;
+                }
+
                 lastReturnedValue = createShaderCacheEntry( hash[0], passCache, finalHash,
                                                             queuedRenderable );
+                const uint64 creationTime = timer->getMicroseconds() - startTime;
+                mShaderCompilationTime += creationTime;
+                mTotalPsoCreationTime += creationTime;
+                lastReturnedValue->creationTime = creationTime;
+                root->getFrameMetrics()->add( FrameMetric::HlmsCacheMisses, 1u );
             }
         }
 
+        ++lastReturnedValue->numHits;
+        lastReturnedValue->lastUsedFrame = mFrameCount;
+
         return lastReturnedValue;
     }
     //-----------------------------------------------------------------------------------
+    const HlmsCache* Hlms::getExistingMaterial( const HlmsCache &passCache,
+                                                const QueuedRenderable &queuedRenderable,
+                                                bool casterPass ) const
+    {
+        const uint32 renderableHash = casterPass ? queuedRenderable.renderable->getHlmsCasterHash() :
+                                                   queuedRenderable.renderable->getHlmsHash();
+        return getShaderCache( renderableHash | passCache.hash );
+    }
+    //-----------------------------------------------------------------------------------
+    bool Hlms::isShaderCodeReady( uint32 renderableHash, const HlmsCache &passCache,
+                                  const QueuedRenderable &queuedRenderable )
+    {
+        OgreProfileExhaustive( "Hlms::isShaderCodeReady" );
+
+        if( !mDataFolder )
+            return true; //No templates (e.g. HlmsLowLevel), nothing to expand
+
+        AsyncShaderGenerator *generator = mAsyncShaderGenerator;
+
+        const RenderableCache &renderableCache = getRenderableCache( renderableHash );
+        ShaderCodeCache codeCache( renderableCache.pieces );
+        mergeShaderCodeProperties( renderableCache, passCache, queuedRenderable, codeCache );
+
+        if( std::find( mShaderCodeCache.begin(), mShaderCodeCache.end(), codeCache ) !=
+            mShaderCodeCache.end() )
+        {
+            return true;
+        }
+
+        AsyncShaderGenerator::JobVec::iterator itJob = generator->pending.begin();
+        AsyncShaderGenerator::JobVec::iterator enJob = generator->pending.end();
+        while( itJob != enJob && !((*itJob)->codeCache == codeCache) )
+            ++itJob;
+
+        if( itJob != enJob )
+        {
+            AsyncShaderGenerator::Job *job = *itJob;
+            {
+                ScopedLock lock( generator->mutex );
+                if( !job->expanded )
+                    return false;
+            }
+
+            efficientVectorRemove( generator->pending, itJob );
+
+            const uint32 finalHash = job->finalHash;
+            const bool failed = job->failed;
+            ExpandedShaderCode code;
+            for( size_t i=0; i<NumShaderTypes; ++i )
+            {
+                code.source[i].swap( job->code.source[i] );
+                code.debugFilename[i].swap( job->code.debugFilename[i] );
+                code.enabled[i] = job->code.enabled[i];
+            }
+            //The compilation needs the properties the templates set
+            mSetProperties.swap( job->properties );
+
+            if( mCpuTimer )
+            {
+                ShaderGenerationTimings &timings = mShaderGenerationTimings;
+                timings.parseMath           += job->timings.parseMath;
+                timings.parseForEach        += job->timings.parseForEach;
+                timings.parseProperties     += job->timings.parseProperties;
+                timings.parseUndefPieces    += job->timings.parseUndefPieces;
+                timings.collectPieces       += job->timings.collectPieces;
+                timings.insertPieces        += job->timings.insertPieces;
+                timings.parseCounter        += job->timings.parseCounter;
+                timings.numShaders          += job->timings.numShaders;
+            }
+
+            delete job;
+
+            if( failed )
+            {
+                //Expand it again here, so that the exception is raised on the caller.
+                compileShaderCode( codeCache );
+            }
+            else
+            {
+                LoadProfiler::Scope loadScope( LoadEvent::ShaderCompile, BLANKSTRING );
+                if( loadScope.isRecording() )
+                {
+                    loadScope.setName( mTypeNameStr + " " +
+                                       StringConverter::toString( finalHash ) );
+                }
+
+                compileShaderCode( codeCache, code, finalHash );
+            }
+
+            return true;
+        }
+
+        if( generator->expanderDirty )
+        {
+            {
+                //The expander can't be touched while it's in use.
+                //Queued jobs keep using the old settings until it's idle.
+                ScopedLock lock( generator->mutex );
+                if( generator->current || !generator->queue.empty() )
+                    return false;
+            }
+
+            loadTemplateFiles();
+
+            Hlms *expander = generator->expander;
+            expander->mTemplateFiles        = mTemplateFiles;
+            expander->mLibrary              = mLibrary;
+            expander->mDataFolder           = mDataFolder;
+            for( size_t i=0; i<NumShaderTypes; ++i )
+                expander->mPieceFiles[i]    = mPieceFiles[i];
+            expander->mPieceFilesEnumerated = true;
+            expander->mRenderSystem         = mRenderSystem;
+            expander->mShaderProfile        = mShaderProfile;
+            expander->mShaderSyntax         = mShaderSyntax;
+            expander->mRsSpecificExtensions = mRsSpecificExtensions;
+            expander->mShaderFileExt        = mShaderFileExt;
+            expander->mOutputPath           = mOutputPath;
+            expander->mDebugOutput          = mDebugOutput;
+            expander->mDebugOutputProperties= mDebugOutputProperties;
+            expander->mHighQuality          = mHighQuality;
+            expander->mFastShaderBuildHack  = mFastShaderBuildHack;
+            expander->mCpuTimer             = mCpuTimer;
+            generator->expanderDirty = false;
+        }
+        else
+        {
+            //The expander only has what was loaded when it was last set up. A new
+            //template (e.g. a stage no previous variant had) means it's out of date.
+            const size_t numTemplateFiles = mTemplateFiles.size();
+            loadTemplateFiles();
+            if( numTemplateFiles != mTemplateFiles.size() )
+            {
+                generator->expanderDirty = true;
+                return false;
+            }
+        }
+
+        const uint32 finalHash = mType * 100000000u + mNextShaderCodeId++;
+        AsyncShaderGenerator::Job *job = new AsyncShaderGenerator::Job( codeCache, finalHash );
+        generator->pending.push_back( job );
+        {
+            ScopedLock lock( generator->mutex );
+            generator->queue.push_back( job );
+        }
+        generator->workerEvent.wake();
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::flushAsyncShaderGeneration(void)
+    {
+        AsyncShaderGenerator *generator = mAsyncShaderGenerator;
+        if( !generator )
+            return;
+
+        bool busy;
+        {
+            ScopedLock lock( generator->mutex );
+            generator->queue.clear();
+            busy = generator->current != 0;
+        }
+
+        while( busy )
+        {
+            generator->idleEvent.wait();
+            ScopedLock lock( generator->mutex );
+            busy = generator->current != 0;
+        }
+
+        AsyncShaderGenerator::JobVec::const_iterator itor = generator->pending.begin();
+        AsyncShaderGenerator::JobVec::const_iterator end  = generator->pending.end();
+        while( itor != end )
+            delete *itor++;
+        generator->pending.clear();
+
+        generator->expanderDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::setAsyncShaderGeneration( bool bAsync )
+    {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( bAsync && !mAsyncShaderGenerator )
+        {
+            mAsyncShaderGenerator = new AsyncShaderGenerator();
+            mAsyncShaderGenerator->thread =
+                    Threads::CreateThread( THREAD_GET( hlmsAsyncShaderGeneratorThread ), 0, this );
+        }
+        else if( !bAsync && mAsyncShaderGenerator )
+        {
+            flushAsyncShaderGeneration();
+
+            {
+                ScopedLock lock( mAsyncShaderGenerator->mutex );
+                mAsyncShaderGenerator->stop = true;
+            }
+            mAsyncShaderGenerator->workerEvent.wake();
+            Threads::WaitForThreads( 1u, &mAsyncShaderGenerator->thread );
+
+            delete mAsyncShaderGenerator;
+            mAsyncShaderGenerator = 0;
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    size_t Hlms::getNumPendingShaderVariants(void) const
+    {
+        if( !mAsyncShaderGenerator )
+            return 0;
+
+        ScopedLock lock( mAsyncShaderGenerator->mutex );
+        return mAsyncShaderGenerator->queue.size() + (mAsyncShaderGenerator->current ? 1u : 0u);
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::_asyncShaderGeneratorThread(void)
+    {
+        AsyncShaderGenerator *generator = mAsyncShaderGenerator;
+        Hlms *expander = generator->expander;
+
+        while( true )
+        {
+            AsyncShaderGenerator::Job *job = 0;
+            {
+                ScopedLock lock( generator->mutex );
+                if( generator->stop )
+                    break;
+                if( !generator->queue.empty() )
+                {
+                    job = generator->queue.front();
+                    generator->queue.pop_front();
+                }
+                generator->current = job;
+            }
+
+            if( !job )
+            {
+                generator->idleEvent.wake();
+                generator->workerEvent.wait();
+                continue;
+            }
+
+            memset( &expander->mShaderGenerationTimings, 0,
+                    sizeof( expander->mShaderGenerationTimings ) );
+            try
+            {
+                expander->expandShaderTemplates( job->codeCache, job->finalHash, job->code );
+                job->properties.swap( expander->mSetProperties );
+            }
+            catch( Exception & )
+            {
+                job->failed = true;
+            }
+            job->timings = expander->mShaderGenerationTimings;
+
+            {
+                ScopedLock lock( generator->mutex );
+                job->expanded = true;
+                generator->current = 0;
+            }
+            generator->idleEvent.wake();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::setShaderCompilationBudget( uint64 microseconds )
+    {
+        mShaderCompilationBudget = microseconds;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::setShaderGenerationTiming( bool bEnable )
+    {
+        mCpuTimer = bEnable ? Root::getSingleton().getTimer() : 0;
+        if( mAsyncShaderGenerator )
+            mAsyncShaderGenerator->expanderDirty = true;
+        memset( &mShaderGenerationTimings, 0, sizeof( mShaderGenerationTimings ) );
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 Hlms::getCpuTime(void) const
+    {
+        return mCpuTimer ? mCpuTimer->getMicroseconds() : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void Hlms::accumCpuTime( uint64 &accumulator, uint64 &inOutTimestamp ) const
+    {
+        if( mCpuTimer )
+        {
+            const uint64 now = mCpuTimer->getMicroseconds();
+            accumulator += now - inOutTimestamp;
+            inOutTimestamp = now;
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void Hlms::setDebugOutputPath( bool enableDebugOutput, bool outputProperties, const String &path )
     {
         mDebugOutput            = enableDebugOutput;
         mDebugOutputProperties  = outputProperties;
         mOutputPath             = path;
+
+        if( mAsyncShaderGenerator )
+            mAsyncShaderGenerator->expanderDirty = true;
     }
     //-----------------------------------------------------------------------------------
     void Hlms::setListener( HlmsListener *listener )
@@ -3335,6 +4202,14 @@ namespace Ogre
                         mRsSpecificExtensions.push_back( extensions[i].extName );
                     }
                 }
+
+                //GLES exposes base instance via GL_EXT_base_instance. The shaders only
+                //care that the drawId can be sourced from an instanced attribute.
+                if( mShaderProfile == "glsles" &&
+                    mRenderSystem->getVaoManager()->supportsBaseInstance() )
+                {
+                    mRsSpecificExtensions.push_back( "GL_EXT_base_instance" );
+                }
             }
 
             if( !mDefaultDatablock )
@@ -395,6 +395,23 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------------------
     void HlmsCompute::dispatch( HlmsComputeJob *job, SceneManager *sceneManager, Camera *camera )
+    {
+        dispatch( job, sceneManager, camera, (const HlmsComputeJob*)0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsCompute::dispatch( HlmsComputeJob * const *jobs, size_t numJobs,
+                                SceneManager *sceneManager, Camera *camera )
+    {
+        const HlmsComputeJob *prevJob = 0;
+        for( size_t i=0; i<numJobs; ++i )
+        {
+            dispatch( jobs[i], sceneManager, camera, prevJob );
+            prevJob = jobs[i];
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsCompute::dispatch( HlmsComputeJob *job, SceneManager *sceneManager, Camera *camera,
+                                const HlmsComputeJob *prevJob )
     {
         job->_calculateNumThreadGroupsBasedOnSetting();
 
@@ -472,15 +489,34 @@ namespace Ogre
 
         while( itConst != enConst )
         {
-            itConst->buffer->bindBufferCS( itConst->slotIdx );
+            //Both lists are sorted by slot. Skip if the previous job left the same buffer bound.
+            bool alreadyBound = false;
+            if( prevJob )
+            {
+                HlmsComputeJob::ConstBufferSlotVec::const_iterator itPrev =
+                        std::lower_bound( prevJob->mConstBuffers.begin(),
+                                          prevJob->mConstBuffers.end(),
+                                          itConst->slotIdx, HlmsComputeJob::ConstBufferSlot() );
+                alreadyBound = itPrev != prevJob->mConstBuffers.end() &&
+                               itPrev->slotIdx == itConst->slotIdx &&
+                               itPrev->buffer == itConst->buffer;
+            }
+
+            if( !alreadyBound )
+                itConst->buffer->bindBufferCS( itConst->slotIdx );
             ++itConst;
         }
 
-        if( job->mTexturesDescSet )
+        //Descriptor sets are shared through the HlmsManager,
+        //thus equal pointers mean equal contents.
+        if( job->mTexturesDescSet &&
+            (!prevJob || prevJob->mTexturesDescSet != job->mTexturesDescSet) )
             mRenderSystem->_setTexturesCS( 0, job->mTexturesDescSet );
-        if( job->mSamplersDescSet )
+        if( job->mSamplersDescSet &&
+            (!prevJob || prevJob->mSamplersDescSet != job->mSamplersDescSet) )
             mRenderSystem->_setSamplersCS( 0, job->mSamplersDescSet );
-        if( job->mUavsDescSet )
+        if( job->mUavsDescSet &&
+            (!prevJob || prevJob->mUavsDescSet != job->mUavsDescSet) )
             mRenderSystem->_setUavCS( 0u, job->mUavsDescSet );
 
         mAutoParamDataSource->setCurrentJob( job );
@@ -30,6 +30,7 @@ THE SOFTWARE.
 
 #include "OgreHlmsDiskCache.h"
 #include "OgreHlmsManager.h"
+#include "OgreRenderQueue.h"
 #include "OgreLogManager.h"
 #include "OgreStringConverter.h"
 #include "OgreProfiler.h"
@@ -44,6 +45,7 @@ namespace Ogre
 
     HlmsDiskCache::HlmsDiskCache( HlmsManager *hlmsManager ) :
         mTemplatesOutOfDate( false ),
+        mDirty( false ),
         mHlmsManager( hlmsManager )
     {
     }
@@ -51,11 +53,28 @@ namespace Ogre
     HlmsDiskCache::~HlmsDiskCache()
     {
         clearCache();
+        releaseWarmUpBlocks();
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsDiskCache::releaseWarmUpBlocks(void)
+    {
+        HlmsMacroblockVec::const_iterator itMacro = mWarmUpMacroblocks.begin();
+        HlmsMacroblockVec::const_iterator enMacro = mWarmUpMacroblocks.end();
+        while( itMacro != enMacro )
+            mHlmsManager->destroyMacroblock( *itMacro++ );
+        mWarmUpMacroblocks.clear();
+
+        HlmsBlendblockVec::const_iterator itBlend = mWarmUpBlendblocks.begin();
+        HlmsBlendblockVec::const_iterator enBlend = mWarmUpBlendblocks.end();
+        while( itBlend != enBlend )
+            mHlmsManager->destroyBlendblock( *itBlend++ );
+        mWarmUpBlendblocks.clear();
     }
     //-----------------------------------------------------------------------------------
     void HlmsDiskCache::clearCache(void)
     {
         mTemplatesOutOfDate = false;
+        mDirty = false;
         memset( mCache.templateHash, 0, sizeof( mCache.templateHash ) );
         mCache.type = 255;
         mCache.sourceCode.clear();
@@ -97,31 +116,39 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
-    void HlmsDiskCache::copyFrom( Hlms *hlms )
+    bool HlmsDiskCache::addEntriesFrom( Hlms *hlms, bool skipExisting )
     {
-        clearCache();
-
-        mCache.type = hlms->getType();
-        mShaderProfile = hlms->getShaderProfile();
-        hlms->getTemplateChecksum( mCache.templateHash );
+        bool entriesAdded = false;
 
         {
             //Copy shaders
-            mCache.sourceCode.reserve( hlms->mShaderCodeCache.size() );
+            mCache.sourceCode.reserve( mCache.sourceCode.size() + hlms->mShaderCodeCache.size() );
+            const size_t numExistingEntries = mCache.sourceCode.size();
+
             Hlms::ShaderCodeCacheVec::const_iterator itor = hlms->mShaderCodeCache.begin();
             Hlms::ShaderCodeCacheVec::const_iterator end  = hlms->mShaderCodeCache.end();
 
             while( itor != end )
             {
-                SourceCode sourceCode( *itor );
-                mCache.sourceCode.push_back( sourceCode );
+                bool alreadyPresent = false;
+                for( size_t i=0; i<numExistingEntries && skipExisting && !alreadyPresent; ++i )
+                    alreadyPresent = mCache.sourceCode[i].mergedCache == itor->mergedCache;
+
+                if( !alreadyPresent )
+                {
+                    SourceCode sourceCode( *itor );
+                    mCache.sourceCode.push_back( sourceCode );
+                    entriesAdded = true;
+                }
                 ++itor;
             }
         }
 
         {
             //Copy PSOs
-            mCache.pso.reserve( hlms->mShaderCache.size() );
+            mCache.pso.reserve( mCache.pso.size() + hlms->mShaderCache.size() );
+            const size_t numExistingEntries = mCache.pso.size();
+
             HlmsCacheVec::const_iterator itor = hlms->mShaderCache.begin();
             HlmsCacheVec::const_iterator end  = hlms->mShaderCache.end();
 
@@ -136,13 +163,62 @@ namespace Ogre
 //                const uint32 inputLayout    = (finalHash >> HlmsBits::InputLayoutShift) &
 //                                              (uint32)HlmsBits::InputLayoutMask;
                 Pso pso( hlms->mRenderableCache[renderableIdx], hlms->mPassCache[passIdx], *itor );
-                mCache.pso.push_back( pso );
+
+                bool alreadyPresent = false;
+                for( size_t i=0; i<numExistingEntries && skipExisting && !alreadyPresent; ++i )
+                {
+                    const Pso &other = mCache.pso[i];
+                    alreadyPresent = other.renderableCache == pso.renderableCache &&
+                                     other.passProperties == pso.passProperties &&
+                                     other.pso.pass == pso.pso.pass &&
+                                     other.pso.operationType == pso.pso.operationType &&
+                                     other.pso.vertexElements == pso.pso.vertexElements &&
+                                     other.macroblock == pso.macroblock &&
+                                     other.blendblock == pso.blendblock;
+                }
+
+                if( !alreadyPresent )
+                {
+                    mCache.pso.push_back( pso );
+                    entriesAdded = true;
+                }
                 ++itor;
             }
         }
+
+        return entriesAdded;
     }
     //-----------------------------------------------------------------------------------
-    void HlmsDiskCache::applyTo( Hlms *hlms )
+    void HlmsDiskCache::copyFrom( Hlms *hlms )
+    {
+        clearCache();
+
+        mCache.type = hlms->getType();
+        mShaderProfile = hlms->getShaderProfile();
+        hlms->getTemplateChecksum( mCache.templateHash );
+
+        addEntriesFrom( hlms, false );
+        mDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsDiskCache::mergeFrom( Hlms *hlms )
+    {
+        uint64 currentHash[2];
+        hlms->getTemplateChecksum( currentHash );
+
+        if( mCache.type != hlms->getType() || mShaderProfile != hlms->getShaderProfile() ||
+            mCache.templateHash[0] != currentHash[0] || mCache.templateHash[1] != currentHash[1] )
+        {
+            //Empty or stale. Nothing worth keeping
+            copyFrom( hlms );
+            return;
+        }
+
+        if( addEntriesFrom( hlms, true ) )
+            mDirty = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsDiskCache::applyTo( Hlms *hlms, bool createPsos )
     {
         LogManager::getSingleton().logMessage( "Applying HlmsDiskCache " +
                                                StringConverter::toString( hlms->getType() ) );
@@ -213,11 +289,32 @@ namespace Ogre
             PsoVec::const_iterator itor = mCache.pso.begin();
             PsoVec::const_iterator end  = mCache.pso.end();
 
+            createPsos = createPsos && hlms->supportsPsoWarmUp();
+
             while( itor != end )
             {
+                HlmsPso warmUpPso;
+                HlmsPropertyVec renderableProperties = itor->renderableCache.setProperties;
+
+                if( createPsos )
+                {
+                    //Hold a reference so the lifetime IDs in the renderable
+                    //properties match the ones the datablocks will get.
+                    warmUpPso = itor->pso;
+                    warmUpPso.macroblock = mHlmsManager->getMacroblock( itor->macroblock );
+                    warmUpPso.blendblock = mHlmsManager->getBlendblock( itor->blendblock );
+                    mWarmUpMacroblocks.push_back( warmUpPso.macroblock );
+                    mWarmUpBlendblocks.push_back( warmUpPso.blendblock );
+
+                    Hlms::setProperty( renderableProperties, HlmsPsoProp::Macroblock,
+                                       warmUpPso.macroblock->mLifetimeId );
+                    Hlms::setProperty( renderableProperties, HlmsPsoProp::Blendblock,
+                                       warmUpPso.blendblock->mLifetimeId );
+                }
+
                 uint32 renderableHash =
                         static_cast<uint32 >(
-                            hlms->addRenderableCache( itor->renderableCache.setProperties,
+                            hlms->addRenderableCache( renderableProperties,
                                                       itor->renderableCache.pieces ) );
 
                 uint32 passHash = 0;
@@ -241,8 +338,27 @@ namespace Ogre
                     passHash = (uint32)(it - hlms->mPassCache.begin()) << (uint32)HlmsBits::PassShift;
                 }
 
-                //const uint32 finalHash = renderableHash | passHash;
-                //hlms->createShaderCacheEntry( renderableHash, passHash, finalHash, );
+                const uint32 finalHash = renderableHash | passHash;
+                if( createPsos && !hlms->getShaderCache( finalHash ) )
+                {
+                    HlmsCache passCache( passHash, hlms->getType(), HlmsPso() );
+                    passCache.setProperties = itor->passProperties;
+                    passCache.pso.pass      = itor->pso.pass;
+
+                    hlms->mWarmUpPso = &warmUpPso;
+                    try
+                    {
+                        hlms->createShaderCacheEntry( renderableHash, passCache, finalHash,
+                                                      QueuedRenderable() );
+                    }
+                    catch( Exception &e )
+                    {
+                        LogManager::getSingleton().logMessage(
+                                    "WARNING: HlmsDiskCache could not create cached PSO: " +
+                                    e.getFullDescription() );
+                    }
+                    hlms->mWarmUpPso = 0;
+                }
 
                 ++itor;
             }
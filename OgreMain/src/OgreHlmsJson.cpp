@@ -492,6 +492,10 @@ namespace Ogre
                                    const String &filename, const String &resourceGroup,
                                    const String &additionalTextureExtension )
     {
+        //Look the default blocks up once, rather than once per datablock
+        const HlmsMacroblock *defaultMacroblock = mHlmsManager->getMacroblock( HlmsMacroblock() );
+        const HlmsBlendblock *defaultBlendblock = mHlmsManager->getBlendblock( HlmsBlendblock() );
+
         rapidjson::Value::ConstMemberIterator itor = json.MemberBegin();
         rapidjson::Value::ConstMemberIterator end  = json.MemberEnd();
 
@@ -503,7 +507,8 @@ namespace Ogre
                 try
                 {
                     HlmsDatablock *datablock = hlms->createDatablock( datablockName, datablockName,
-                                                                      HlmsMacroblock(), HlmsBlendblock(),
+                                                                      defaultMacroblock,
+                                                                      defaultBlendblock,
                                                                       HlmsParamVec(), true,
                                                                       filename, resourceGroup );
                     loadDatablockCommon( itor->value, blocks, datablock );
@@ -523,6 +528,9 @@ namespace Ogre
 
             ++itor;
         }
+
+        mHlmsManager->destroyMacroblock( defaultMacroblock );
+        mHlmsManager->destroyBlendblock( defaultBlendblock );
     }
     //-----------------------------------------------------------------------------------
     void HlmsJson::loadMaterials( const String &filename, const String &resourceGroup,
@@ -541,11 +549,18 @@ namespace Ogre
                          rapidjson::GetParseError_En( d.GetParseError() ) );
         }
 
+        loadMaterials( filename, resourceGroup, d, additionalTextureExtension );
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsJson::loadMaterials( const String &filename, const String &resourceGroup,
+                                  const rapidjson::Value &json,
+                                  const String &additionalTextureExtension )
+    {
         NamedBlocks blocks;
 
         //Load samplerblocks
-        rapidjson::Value::ConstMemberIterator itor = d.FindMember("samplers");
-        if( itor != d.MemberEnd() && itor->value.IsObject() )
+        rapidjson::Value::ConstMemberIterator itor = json.FindMember("samplers");
+        if( itor != json.MemberEnd() && itor->value.IsObject() )
         {
             const rapidjson::Value &samplers = itor->value;
 
@@ -567,8 +582,8 @@ namespace Ogre
         }
 
         //Load macroblocks
-        itor = d.FindMember("macroblocks");
-        if( itor != d.MemberEnd() && itor->value.IsObject() )
+        itor = json.FindMember("macroblocks");
+        if( itor != json.MemberEnd() && itor->value.IsObject() )
         {
             const rapidjson::Value &macroblocksJson = itor->value;
 
@@ -590,8 +605,8 @@ namespace Ogre
         }
 
         //Load blendblocks
-        itor = d.FindMember("blendblocks");
-        if( itor != d.MemberEnd() && itor->value.IsObject() )
+        itor = json.FindMember("blendblocks");
+        if( itor != json.MemberEnd() && itor->value.IsObject() )
         {
             const rapidjson::Value &blendblocksJson = itor->value;
 
@@ -612,8 +627,8 @@ namespace Ogre
             }
         }
 
-        rapidjson::Value::ConstMemberIterator itDatablock = d.MemberBegin();
-        rapidjson::Value::ConstMemberIterator enDatablock = d.MemberEnd();
+        rapidjson::Value::ConstMemberIterator itDatablock = json.MemberBegin();
+        rapidjson::Value::ConstMemberIterator enDatablock = json.MemberEnd();
 
         while( itDatablock != enDatablock )
         {
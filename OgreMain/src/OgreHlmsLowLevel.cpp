@@ -56,7 +56,8 @@ namespace Ogre
     HlmsLowLevel::HlmsLowLevel() :
         Hlms( HLMS_LOW_LEVEL, "", 0, 0 ),
         mAutoParamDataSource( 0 ),
-        mCurrentSceneManager( 0 )
+        mCurrentSceneManager( 0 ),
+        mLastPass( 0 )
     {
         mAutoParamDataSource = OGRE_NEW AutoParamDataSource();
     }
@@ -128,6 +129,9 @@ namespace Ogre
             pso.enablePrimitiveRestart = true;
         }
 
+        //Low level materials don't output the weights needed by order independent transparency
+        pso.pass.strongMacroblockBits &= ~HlmsPassPso::WeightedBlendedOit;
+
         applyStrongMacroblockRules( pso );
 
         mRenderSystem->_hlmsPipelineStateObjectCreated( &pso );
@@ -187,6 +191,8 @@ namespace Ogre
                                              bool dualParaboloid, SceneManager *sceneManager )
     {
         mCurrentSceneManager = sceneManager;
+        //Camera, viewport, shadow node, etc may have changed. Global params must be refreshed.
+        mLastPass = 0;
 
         HlmsCache retVal = Hlms::preparePassHash( shadowNode, casterPass, dualParaboloid, sceneManager );
 
@@ -345,34 +351,45 @@ namespace Ogre
         // Disable remaining texture units
         //mRenderSystem->_disableTextureUnitsFrom( pass->getNumTextureUnitStates() );
 
-        pass->_updateAutoParams( mAutoParamDataSource, GPV_ALL );
+        //Global params (camera, fog, pass colours, custom params...) only depend on the
+        //pass and the data set in preparePassHash. When drawing consecutive objects
+        //with the same pass, only per-object data needs to be updated and uploaded.
+        const uint16 variabilityMask = pass == mLastPass ?
+                    static_cast<uint16>( GPV_PER_OBJECT | GPV_LIGHTS | GPV_PASS_ITERATION_NUMBER ) :
+                    static_cast<uint16>( GPV_ALL );
+        mLastPass = pass;
+
+        pass->_updateAutoParams( mAutoParamDataSource, variabilityMask );
 
         if( pass->hasVertexProgram() )
         {
             mRenderSystem->bindGpuProgramParameters( GPT_VERTEX_PROGRAM,
-                                                     pass->getVertexProgramParameters(), GPV_ALL );
+                                                     pass->getVertexProgramParameters(),
+                                                     variabilityMask );
         }
         if( pass->hasGeometryProgram() )
         {
             mRenderSystem->bindGpuProgramParameters( GPT_GEOMETRY_PROGRAM,
-                                                     pass->getGeometryProgramParameters(), GPV_ALL );
+                                                     pass->getGeometryProgramParameters(),
+                                                     variabilityMask );
         }
         if( pass->hasTessellationHullProgram() )
         {
             mRenderSystem->bindGpuProgramParameters( GPT_HULL_PROGRAM,
                                                      pass->getTessellationHullProgramParameters(),
-                                                     GPV_ALL );
+                                                     variabilityMask );
         }
         if( pass->hasTessellationDomainProgram() )
         {
             mRenderSystem->bindGpuProgramParameters( GPT_DOMAIN_PROGRAM,
                                                      pass->getTessellationDomainProgramParameters(),
-                                                     GPV_ALL );
+                                                     variabilityMask );
         }
         if( pass->hasFragmentProgram() )
         {
             mRenderSystem->bindGpuProgramParameters( GPT_FRAGMENT_PROGRAM,
-                                                     pass->getFragmentProgramParameters(), GPV_ALL );
+                                                     pass->getFragmentProgramParameters(),
+                                                     variabilityMask );
         }
     }
     //-----------------------------------------------------------------------------------
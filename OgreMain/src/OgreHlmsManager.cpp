@@ -35,6 +35,11 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #if !OGRE_NO_JSON
     #include "OgreResourceGroupManager.h"
+    #include "OgreJsonBinary.h"
+    #include "OgreStringConverter.h"
+    #include "OgreString.h"
+    #include "rapidjson/document.h"
+    #include "rapidjson/error/en.h"
 #endif
 
 #include <fstream>
@@ -44,7 +49,10 @@ namespace Ogre
     HlmsManager::HlmsManager() :
         mComputeHlms( 0 ),
         mRenderSystem( 0 ),
-        mDefaultHlmsType( HLMS_PBS )
+        mDefaultHlmsType( HLMS_PBS ),
+        mPsoEvictionMaxUnusedFrames( 0 ),
+        mPsoEvictionMaxLivePsos( 0 ),
+        mLoadTexturesLazily( false )
   #if !OGRE_NO_JSON
     ,   mJsonListener( 0 )
   #endif
@@ -78,6 +86,7 @@ namespace Ogre
 
 #if !OGRE_NO_JSON
         mScriptPatterns.push_back( "*.material.json" );
+        mScriptPatterns.push_back( "*.material.bin" );
         ResourceGroupManager::getSingleton()._registerScriptLoader(this);
 #endif
     }
@@ -808,6 +817,58 @@ namespace Ogre
         }
     }
 #if !OGRE_NO_JSON
+    //-----------------------------------------------------------------------------------
+    /// fileData must be null terminated. Handles both JSON text and JsonBinary.
+    static void loadMaterialsFromFileData( HlmsJson &hlmsJson, const String &filename,
+                                           const String &groupName,
+                                           const vector<char>::type &fileData,
+                                           const String &additionalTextureExtension )
+    {
+        if( JsonBinary::isBinaryJson( &fileData[0], fileData.size() - 1u ) )
+        {
+            rapidjson::Document d;
+            JsonBinary::decode( filename, &fileData[0], fileData.size() - 1u, d );
+            hlmsJson.loadMaterials( filename, groupName, d, additionalTextureExtension );
+        }
+        else
+        {
+            hlmsJson.loadMaterials( filename, groupName, &fileData[0],
+                                    additionalTextureExtension );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    /// Writes jsonString as is, or as JsonBinary if filename ends in ".bin"
+    static void writeMaterialFile( const String &filename, const String &jsonString )
+    {
+        std::ofstream file( filename.c_str(), std::ios::binary | std::ios::out );
+        if( !StringUtil::endsWith( filename, ".bin" ) )
+        {
+            if( file.is_open() )
+                file.write( jsonString.c_str(), jsonString.size() );
+        }
+        else
+        {
+            rapidjson::Document d;
+            d.Parse( jsonString.c_str() );
+            if( d.HasParseError() )
+            {
+                OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
+                             "Generated invalid JSON for " + filename + " at offset " +
+                             StringConverter::toString( d.GetErrorOffset() ) + " Reason: " +
+                             rapidjson::GetParseError_En( d.GetParseError() ),
+                             "HlmsManager::saveMaterials" );
+            }
+
+            vector<uint8>::type binaryData;
+            JsonBinary::encode( d, binaryData );
+            if( file.is_open() && !binaryData.empty() )
+            {
+                file.write( reinterpret_cast<const char*>( &binaryData[0] ),
+                            static_cast<std::streamsize>( binaryData.size() ) );
+            }
+        }
+        file.close();
+    }
     //-----------------------------------------------------------------------------------
     void HlmsManager::loadMaterials( const String &filename, const String &groupName,
                                      HlmsJsonListener *listener,
@@ -824,8 +885,8 @@ namespace Ogre
             //Add null terminator just in case (to prevent bad input)
             fileData.back() = '\0';
             HlmsJson hlmsJson( this, listener );
-            hlmsJson.loadMaterials( stream->getName(), groupName, &fileData[0],
-                                    additionalTextureExtension );
+            loadMaterialsFromFileData( hlmsJson, stream->getName(), groupName, fileData,
+                                       additionalTextureExtension );
         }
     }
     //-----------------------------------------------------------------------------------
@@ -840,10 +901,7 @@ namespace Ogre
         HlmsJson hlmsJson( this, listener );
         hlmsJson.saveMaterials( mRegisteredHlms[hlmsType], jsonString, additionalTextureExtension );
 
-        std::ofstream file( filename.c_str(), std::ios::binary | std::ios::out );
-        if( file.is_open() )
-            file.write( jsonString.c_str(), jsonString.size() );
-        file.close();
+        writeMaterialFile( filename, jsonString );
     }
     //-----------------------------------------------------------------------------------
     void HlmsManager::saveMaterial( const HlmsDatablock *datablock, const String &filename,
@@ -854,10 +912,7 @@ namespace Ogre
         HlmsJson hlmsJson( this, listener );
         hlmsJson.saveMaterial( datablock, jsonString, additionalTextureExtension );
 
-        std::ofstream file( filename.c_str(), std::ios::binary | std::ios::out );
-        if( file.is_open() )
-            file.write( jsonString.c_str(), jsonString.size() );
-        file.close();
+        writeMaterialFile( filename, jsonString );
     }
     //-----------------------------------------------------------------------------------
     void HlmsManager::parseScript(DataStreamPtr& stream, const String& groupName)
@@ -878,11 +933,79 @@ namespace Ogre
             //Add null terminator just in case (to prevent bad input)
             fileData.back() = '\0';
             HlmsJson hlmsJson( this, mJsonListener );
-            hlmsJson.loadMaterials( stream->getName(), groupName, &fileData[0],
-                                    additionalTextureExtension );
+            loadMaterialsFromFileData( hlmsJson, stream->getName(), groupName, fileData,
+                                       additionalTextureExtension );
         }
     }
     //-----------------------------------------------------------------------------------
+    namespace
+    {
+        class PreparedJsonScript : public ScriptLoader::PreparedScript
+        {
+        public:
+            /// JsonBinary documents reference their strings from here
+            vector<char>::type  fileData;
+            rapidjson::Document document;
+        };
+    }
+    //-----------------------------------------------------------------------------------
+    ScriptLoader::PreparedScript* HlmsManager::prepareScript( DataStreamPtr& stream,
+                                                              const String& groupName )
+    {
+        vector<char>::type fileData;
+        fileData.resize( stream->size() + 1 );
+        stream->read( &fileData[0], stream->size() );
+        fileData.back() = '\0';
+
+        PreparedJsonScript *preparedScript = OGRE_NEW PreparedJsonScript();
+
+        if( JsonBinary::isBinaryJson( &fileData[0], fileData.size() - 1u ) )
+        {
+            preparedScript->fileData.swap( fileData );
+            try
+            {
+                JsonBinary::decode( stream->getName(), &preparedScript->fileData[0],
+                                    preparedScript->fileData.size() - 1u,
+                                    preparedScript->document );
+            }
+            catch( Exception & )
+            {
+                //Let parseScript report the error from the main thread
+                OGRE_DELETE preparedScript;
+                preparedScript = 0;
+            }
+        }
+        else
+        {
+            preparedScript->document.Parse( &fileData[0] );
+
+            if( preparedScript->document.HasParseError() )
+            {
+                //Let parseScript report the error from the main thread
+                OGRE_DELETE preparedScript;
+                preparedScript = 0;
+            }
+        }
+
+        return preparedScript;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsManager::parsePreparedScript( PreparedScript *preparedScript, DataStreamPtr& stream,
+                                           const String& groupName )
+    {
+        String additionalTextureExtension;
+        ResourceToTexExtensionMap::const_iterator itExt =
+                mAdditionalTextureExtensionsPerGroup.find( groupName );
+
+        if( itExt != mAdditionalTextureExtensionsPerGroup.end() )
+            additionalTextureExtension = itExt->second;
+
+        const PreparedJsonScript *preparedJson = static_cast<const PreparedJsonScript*>( preparedScript );
+        HlmsJson hlmsJson( this, mJsonListener );
+        hlmsJson.loadMaterials( stream->getName(), groupName, preparedJson->document,
+                                additionalTextureExtension );
+    }
+    //-----------------------------------------------------------------------------------
     Real HlmsManager::getLoadingOrder(void) const
     {
         return 100;
@@ -917,4 +1040,22 @@ namespace Ogre
         assert( idx < OGRE_HLMS_NUM_SAMPLERBLOCKS );
         return &mSamplerblocks[idx];
     }
+    //-----------------------------------------------------------------------------------
+    void HlmsManager::setPsoEviction( uint32 maxUnusedFrames, size_t maxLivePsos )
+    {
+        mPsoEvictionMaxUnusedFrames = maxUnusedFrames;
+        mPsoEvictionMaxLivePsos     = maxLivePsos;
+    }
+    //-----------------------------------------------------------------------------------
+    void HlmsManager::_evictStalePsos(void)
+    {
+        for( size_t i=0; i<HLMS_MAX; ++i )
+        {
+            if( mRegisteredHlms[i] )
+            {
+                mRegisteredHlms[i]->_evictStalePsos( mPsoEvictionMaxUnusedFrames,
+                                                     mPsoEvictionMaxLivePsos );
+            }
+        }
+    }
 }
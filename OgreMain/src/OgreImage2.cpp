@@ -32,6 +32,9 @@ THE SOFTWARE.
 #include "OgrePixelFormatGpuUtils.h"
 #include "OgreColourValue.h"
 #include "OgreMath.h"
+#include "OgreDataStream.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
 #include "OgreImageResampler.h"
 #include "OgreImageDownsampler.h"
 #include "OgreTextureGpuManager.h"
@@ -928,7 +931,7 @@ namespace Ogre {
         case PFG_R8_UINT:
             if( !gammaCorrected )
             {
-                downsampler2DFunc   = downscale2x_X8;
+                downsampler2DFunc   = downscale2x_SIMD_X8;
                 downsamplerCubeFunc = downscale2x_X8_cube;
                 separableBlur2DFunc = separableBlur_X8;
             }
@@ -957,7 +960,7 @@ namespace Ogre {
         case PFG_RG8_UINT:
             if( !gammaCorrected )
             {
-                downsampler2DFunc   = downscale2x_XX88;
+                downsampler2DFunc   = downscale2x_SIMD_XX88;
                 downsamplerCubeFunc = downscale2x_XX88_cube;
                 separableBlur2DFunc = separableBlur_X8;
             }
@@ -975,13 +978,13 @@ namespace Ogre {
         case PFG_BGRA8_UNORM_SRGB:
             if( !gammaCorrected )
             {
-                downsampler2DFunc   = downscale2x_XXXA8888;
+                downsampler2DFunc   = downscale2x_SIMD_XXXA8888;
                 downsamplerCubeFunc = downscale2x_XXXA8888_cube;
                 separableBlur2DFunc = separableBlur_XXXA8888;
             }
             else
             {
-                downsampler2DFunc   = downscale2x_sRGB_XXXA8888;
+                downsampler2DFunc   = downscale2x_SIMD_sRGB_XXXA8888;
                 downsamplerCubeFunc = downscale2x_sRGB_XXXA8888_cube;
                 separableBlur2DFunc = separableBlur_sRGB_XXXA8888;
             }
@@ -1228,7 +1231,7 @@ namespace Ogre {
             srcSlice.numSlices = dstSlice.numSlices = 1;
             for( uint32 sliceIdx = 0; sliceIdx < src.numSlices; ++sliceIdx )
             {
-                scale( srcSlice, srcFormat, dstSlice, dstFormat );
+                scale( srcSlice, srcFormat, dstSlice, dstFormat, filter );
                 ++srcSlice.sliceStart;
                 ++dstSlice.sliceStart;
             }
@@ -1237,8 +1240,32 @@ namespace Ogre {
 
         MemoryDataStreamPtr buf; // For auto-delete
         TextureBox temp;
+
+        if( ( filter == FILTER_BOX || filter == FILTER_TRIANGLE || filter == FILTER_BICUBIC ||
+              filter == FILTER_LANCZOS ) && src.depth != dst.depth )
+        {
+            filter = FILTER_BILINEAR;
+        }
+
         switch( filter )
         {
+        case FILTER_BOX:
+            SeparableResampler::scale( src, srcFormat, dst, dstFormat,
+                                       SeparableResampler::KernelBox );
+            break;
+        case FILTER_TRIANGLE:
+            SeparableResampler::scale( src, srcFormat, dst, dstFormat,
+                                       SeparableResampler::KernelTriangle );
+            break;
+        case FILTER_BICUBIC:
+            SeparableResampler::scale( src, srcFormat, dst, dstFormat,
+                                       SeparableResampler::KernelBicubic );
+            break;
+        case FILTER_LANCZOS:
+            SeparableResampler::scale( src, srcFormat, dst, dstFormat,
+                                       SeparableResampler::KernelLanczos3 );
+            break;
+
         default:
         case FILTER_NEAREST:
             if( srcFormat == dstFormat )
@@ -1342,6 +1369,18 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------------------
+    TextureBox Image2::scaleToStagingTexture( const TextureBox &src, PixelFormatGpu srcFormat,
+                                              StagingTexture *stagingTexture,
+                                              uint32 dstWidth, uint32 dstHeight,
+                                              PixelFormatGpu dstFormat, Filter filter )
+    {
+        TextureBox dstBox = stagingTexture->mapRegion( dstWidth, dstHeight, src.depth,
+                                                       src.numSlices, dstFormat );
+        if( dstBox.data )
+            scale( src, srcFormat, dstBox, dstFormat, filter );
+        return dstBox;
+    }
+    //-----------------------------------------------------------------------------------
     void Image2::_setAutoDelete( bool autoDelete )
     {
         mAutoDelete = autoDelete;
@@ -435,3 +435,374 @@ namespace Ogre
 
 #undef OGRE_GAM_TO_LIN
 #undef OGRE_LIN_TO_GAM
+
+//-----------------------------------------------------------------------------------
+//SIMD versions
+//-----------------------------------------------------------------------------------
+
+#if __OGRE_HAVE_SSE && OGRE_CPU == OGRE_CPU_X86
+    #define OGRE_DOWNSAMPLER_SSE2 1
+#elif __OGRE_HAVE_NEON
+    #include <arm_neon.h>
+    #define OGRE_DOWNSAMPLER_NEON 1
+#endif
+
+namespace Ogre
+{
+    /// Returns true if the kernel is the linear one, i.e. a 2x2 box filter
+    static bool isLinearKernel( const uint8 kernel[5][5],
+                                const int8 kernelStartX, const int8 kernelEndX,
+                                const int8 kernelStartY, const int8 kernelEndY )
+    {
+        return kernelStartX == 0 && kernelEndX == 1 && kernelStartY == 0 && kernelEndY == 1 &&
+               kernel[2][2] == kernel[2][3] && kernel[2][2] == kernel[3][2] &&
+               kernel[2][2] == kernel[3][3] && kernel[2][2] != 0;
+    }
+
+    /** Scalar path of the linear kernel for a single pixel. Mimics the scalar downsamplers,
+        which clamp the kernel on the last column and row (hasRight / hasBottom = false).
+    @remarks
+        Pass alphaIdx = -1 if the format has no alpha.
+    */
+    template <size_t bpp, int alphaIdx, bool sRGB>
+    static inline void downscaleLinearPixel( uint8 *dstPtr, const uint8 *srcPtr,
+                                             int32 srcBytesPerRow, bool hasRight, bool hasBottom )
+    {
+        const uint32 divisor = (hasRight ? 2u : 1u) * (hasBottom ? 2u : 1u);
+        const float invDivisor = 1.0f / divisor;
+
+        for( size_t c=0; c<bpp; ++c )
+        {
+            uint32 v[4];
+            v[0] = srcPtr[c];
+            v[1] = hasRight ? srcPtr[bpp + c] : 0u;
+            v[2] = hasBottom ? srcPtr[srcBytesPerRow + c] : 0u;
+            v[3] = (hasRight && hasBottom) ? srcPtr[srcBytesPerRow + bpp + c] : 0u;
+
+            if( static_cast<int>( c ) == alphaIdx )
+            {
+                const uint32 accum = v[0] + v[1] + v[2] + v[3];
+                dstPtr[c] = static_cast<uint8>( (accum + divisor - 1u) / divisor );
+            }
+            else if( sRGB )
+            {
+                const uint32 accum = v[0] * v[0] + v[1] * v[1] + v[2] * v[2] + v[3] * v[3];
+                dstPtr[c] = static_cast<uint8>( sqrtf( accum * invDivisor ) + 0.5f );
+            }
+            else
+            {
+                const uint32 accum = v[0] + v[1] + v[2] + v[3];
+                dstPtr[c] = static_cast<uint8>( accum * invDivisor + 0.5f );
+            }
+        }
+    }
+
+    /** Downsamples the first numPixels of a row using SIMD, with the full 2x2 kernel.
+    @return
+        Number of pixels processed. The rest must be done by the caller.
+    */
+    template <size_t bpp, int alphaIdx, bool sRGB>
+    struct LinearRowSIMD
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            return 0;
+        }
+    };
+
+#if OGRE_DOWNSAMPLER_SSE2
+    /// 2 RGBA8 destination pixels from 4 source pixels of each row, not yet divided
+    static inline __m128i sumLinear4x8888( const uint8 *srcRow0, const uint8 *srcRow1 )
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i row0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcRow0 ) );
+        const __m128i row1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>( srcRow1 ) );
+        const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( row0, zero ),
+                                          _mm_unpacklo_epi8( row1, zero ) );
+        const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( row0, zero ),
+                                          _mm_unpackhi_epi8( row1, zero ) );
+        return _mm_add_epi16( _mm_unpacklo_epi64( lo, hi ), _mm_unpackhi_epi64( lo, hi ) );
+    }
+
+    template <>
+    struct LinearRowSIMD<4u, 3, false>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            //Colour rounds to nearest, alpha rounds up
+            const __m128i bias = _mm_set_epi16( 3, 2, 2, 2, 3, 2, 2, 2 );
+
+            int32 x = 0;
+            for( ; x + 4 <= numPixels; x += 4 )
+            {
+                __m128i a = sumLinear4x8888( srcRow0 + x * 8, srcRow1 + x * 8 );
+                __m128i b = sumLinear4x8888( srcRow0 + x * 8 + 16, srcRow1 + x * 8 + 16 );
+                a = _mm_srli_epi16( _mm_add_epi16( a, bias ), 2 );
+                b = _mm_srli_epi16( _mm_add_epi16( b, bias ), 2 );
+                _mm_storeu_si128( reinterpret_cast<__m128i*>( dstPtr + x * 4 ),
+                                  _mm_packus_epi16( a, b ) );
+            }
+
+            return x;
+        }
+    };
+
+    template <>
+    struct LinearRowSIMD<2u, -1, false>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi16( 2 );
+
+            int32 x = 0;
+            for( ; x + 4 <= numPixels; x += 4 )
+            {
+                const __m128i row0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(
+                                                          srcRow0 + x * 4 ) );
+                const __m128i row1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(
+                                                          srcRow1 + x * 4 ) );
+                const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( row0, zero ),
+                                                  _mm_unpacklo_epi8( row1, zero ) );
+                const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( row0, zero ),
+                                                  _mm_unpackhi_epi8( row1, zero ) );
+                //Each 32-bit lane is an RG pixel. Add even & odd pixels together
+                const __m128i sumLo = _mm_add_epi16( _mm_shuffle_epi32( lo, _MM_SHUFFLE( 2, 0, 2, 0 ) ),
+                                                     _mm_shuffle_epi32( lo, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+                const __m128i sumHi = _mm_add_epi16( _mm_shuffle_epi32( hi, _MM_SHUFFLE( 2, 0, 2, 0 ) ),
+                                                     _mm_shuffle_epi32( hi, _MM_SHUFFLE( 3, 1, 3, 1 ) ) );
+                __m128i sum = _mm_unpacklo_epi64( sumLo, sumHi );
+                sum = _mm_srli_epi16( _mm_add_epi16( sum, bias ), 2 );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( dstPtr + x * 2 ),
+                                  _mm_packus_epi16( sum, sum ) );
+            }
+
+            return x;
+        }
+    };
+
+    template <>
+    struct LinearRowSIMD<1u, -1, false>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i bias = _mm_set1_epi16( 2 );
+            const __m128i lowMask = _mm_set1_epi32( 0x0000FFFF );
+
+            int32 x = 0;
+            for( ; x + 8 <= numPixels; x += 8 )
+            {
+                const __m128i row0 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(
+                                                          srcRow0 + x * 2 ) );
+                const __m128i row1 = _mm_loadu_si128( reinterpret_cast<const __m128i*>(
+                                                          srcRow1 + x * 2 ) );
+                const __m128i lo = _mm_add_epi16( _mm_unpacklo_epi8( row0, zero ),
+                                                  _mm_unpacklo_epi8( row1, zero ) );
+                const __m128i hi = _mm_add_epi16( _mm_unpackhi_epi8( row0, zero ),
+                                                  _mm_unpackhi_epi8( row1, zero ) );
+                //Add adjacent 16-bit lanes into 32-bit lanes. Values fit in 16 bits
+                const __m128i sumLo = _mm_add_epi32( _mm_and_si128( lo, lowMask ),
+                                                     _mm_srli_epi32( lo, 16 ) );
+                const __m128i sumHi = _mm_add_epi32( _mm_and_si128( hi, lowMask ),
+                                                     _mm_srli_epi32( hi, 16 ) );
+                __m128i sum = _mm_packs_epi32( sumLo, sumHi );
+                sum = _mm_srli_epi16( _mm_add_epi16( sum, bias ), 2 );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( dstPtr + x ),
+                                  _mm_packus_epi16( sum, sum ) );
+            }
+
+            return x;
+        }
+    };
+
+    template <>
+    struct LinearRowSIMD<4u, 3, true>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i alphaMask = _mm_set_epi32( -1, 0, 0, 0 );
+            const __m128i alphaBias = _mm_set1_epi32( 3 );
+            const __m128 quarter = _mm_set1_ps( 0.25f );
+            const __m128 half = _mm_set1_ps( 0.5f );
+
+            int32 x = 0;
+            for( ; x < numPixels; ++x )
+            {
+                const __m128i row0 = _mm_unpacklo_epi8(
+                                         _mm_loadl_epi64( reinterpret_cast<const __m128i*>(
+                                                              srcRow0 + x * 8 ) ), zero );
+                const __m128i row1 = _mm_unpacklo_epi8(
+                                         _mm_loadl_epi64( reinterpret_cast<const __m128i*>(
+                                                              srcRow1 + x * 8 ) ), zero );
+                const __m128i p00 = _mm_unpacklo_epi16( row0, zero );
+                const __m128i p01 = _mm_unpackhi_epi16( row0, zero );
+                const __m128i p10 = _mm_unpacklo_epi16( row1, zero );
+                const __m128i p11 = _mm_unpackhi_epi16( row1, zero );
+
+                //Colour: sqrt( average of squares ). All values are exact in float
+                const __m128 f00 = _mm_cvtepi32_ps( p00 );
+                const __m128 f01 = _mm_cvtepi32_ps( p01 );
+                const __m128 f10 = _mm_cvtepi32_ps( p10 );
+                const __m128 f11 = _mm_cvtepi32_ps( p11 );
+                __m128 accum = _mm_add_ps( _mm_add_ps( _mm_mul_ps( f00, f00 ),
+                                                       _mm_mul_ps( f01, f01 ) ),
+                                           _mm_add_ps( _mm_mul_ps( f10, f10 ),
+                                                       _mm_mul_ps( f11, f11 ) ) );
+                accum = _mm_add_ps( _mm_sqrt_ps( _mm_mul_ps( accum, quarter ) ), half );
+                const __m128i colour = _mm_cvttps_epi32( accum );
+
+                //Alpha: rounded up average
+                __m128i alpha = _mm_add_epi32( _mm_add_epi32( p00, p01 ), _mm_add_epi32( p10, p11 ) );
+                alpha = _mm_srli_epi32( _mm_add_epi32( alpha, alphaBias ), 2 );
+
+                __m128i result = _mm_or_si128( _mm_and_si128( alphaMask, alpha ),
+                                               _mm_andnot_si128( alphaMask, colour ) );
+                result = _mm_packs_epi32( result, result );
+                result = _mm_packus_epi16( result, result );
+                const int32 rgba = _mm_cvtsi128_si32( result );
+                memcpy( dstPtr + x * 4, &rgba, sizeof( rgba ) );
+            }
+
+            return x;
+        }
+    };
+#elif OGRE_DOWNSAMPLER_NEON
+    template <>
+    struct LinearRowSIMD<4u, 3, false>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            const uint16x8_t alphaBias = vdupq_n_u16( 3u );
+
+            int32 x = 0;
+            for( ; x + 8 <= numPixels; x += 8 )
+            {
+                const uint8x16x4_t row0 = vld4q_u8( srcRow0 + x * 8 );
+                const uint8x16x4_t row1 = vld4q_u8( srcRow1 + x * 8 );
+                uint8x8x4_t result;
+                for( size_t c=0; c<3u; ++c )
+                {
+                    const uint16x8_t sum = vaddq_u16( vpaddlq_u8( row0.val[c] ),
+                                                      vpaddlq_u8( row1.val[c] ) );
+                    result.val[c] = vrshrn_n_u16( sum, 2 );
+                }
+                const uint16x8_t sumA = vaddq_u16( vpaddlq_u8( row0.val[3] ),
+                                                   vpaddlq_u8( row1.val[3] ) );
+                result.val[3] = vshrn_n_u16( vaddq_u16( sumA, alphaBias ), 2 );
+                vst4_u8( dstPtr + x * 4, result );
+            }
+
+            return x;
+        }
+    };
+
+    template <>
+    struct LinearRowSIMD<2u, -1, false>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            int32 x = 0;
+            for( ; x + 8 <= numPixels; x += 8 )
+            {
+                const uint8x16x2_t row0 = vld2q_u8( srcRow0 + x * 4 );
+                const uint8x16x2_t row1 = vld2q_u8( srcRow1 + x * 4 );
+                uint8x8x2_t result;
+                for( size_t c=0; c<2u; ++c )
+                {
+                    const uint16x8_t sum = vaddq_u16( vpaddlq_u8( row0.val[c] ),
+                                                      vpaddlq_u8( row1.val[c] ) );
+                    result.val[c] = vrshrn_n_u16( sum, 2 );
+                }
+                vst2_u8( dstPtr + x * 2, result );
+            }
+
+            return x;
+        }
+    };
+
+    template <>
+    struct LinearRowSIMD<1u, -1, false>
+    {
+        static int32 run( uint8 *dstPtr, const uint8 *srcRow0, const uint8 *srcRow1,
+                          int32 numPixels )
+        {
+            int32 x = 0;
+            for( ; x + 8 <= numPixels; x += 8 )
+            {
+                const uint16x8_t sum = vaddq_u16( vpaddlq_u8( vld1q_u8( srcRow0 + x * 2 ) ),
+                                                  vpaddlq_u8( vld1q_u8( srcRow1 + x * 2 ) ) );
+                vst1_u8( dstPtr + x, vrshrn_n_u16( sum, 2 ) );
+            }
+
+            return x;
+        }
+    };
+#endif
+
+    template <size_t bpp, int alphaIdx, bool sRGB>
+    static void downscale2xLinear( uint8 *dstPtr, uint8 const *srcPtr,
+                                   int32 dstWidth, int32 dstHeight, int32 dstBytesPerRow,
+                                   int32 srcBytesPerRow )
+    {
+        for( int32 y=0; y<dstHeight; ++y )
+        {
+            uint8 *dstRow = dstPtr + y * dstBytesPerRow;
+            const uint8 *srcRow0 = srcPtr + 2 * y * srcBytesPerRow;
+            const bool hasBottom = y < dstHeight - 1;
+
+            //The last column & row clamp the kernel. Leave them to the scalar path
+            int32 x = 0;
+            if( hasBottom )
+            {
+                x = LinearRowSIMD<bpp, alphaIdx, sRGB>::run( dstRow, srcRow0,
+                                                             srcRow0 + srcBytesPerRow,
+                                                             dstWidth - 1 );
+            }
+
+            for( ; x<dstWidth; ++x )
+            {
+                downscaleLinearPixel<bpp, alphaIdx, sRGB>( dstRow + x * bpp,
+                                                           srcRow0 + x * 2 * bpp,
+                                                           srcBytesPerRow,
+                                                           x < dstWidth - 1, hasBottom );
+            }
+        }
+    }
+
+#define OGRE_DOWNSAMPLE_SIMD_IMPL( simdName, scalarName, bpp, alphaIdx, sRGB ) \
+    void simdName( uint8 *dstPtr, uint8 const *srcPtr, \
+                   int32 dstWidth, int32 dstHeight, int32 dstBytesPerRow, \
+                   int32 srcWidth, int32 srcBytesPerRow, \
+                   const uint8 kernel[5][5], \
+                   const int8 kernelStartX, const int8 kernelEndX, \
+                   const int8 kernelStartY, const int8 kernelEndY ) \
+    { \
+        if( isLinearKernel( kernel, kernelStartX, kernelEndX, kernelStartY, kernelEndY ) ) \
+        { \
+            downscale2xLinear<bpp, alphaIdx, sRGB>( dstPtr, srcPtr, dstWidth, dstHeight, \
+                                                    dstBytesPerRow, srcBytesPerRow ); \
+        } \
+        else \
+        { \
+            scalarName( dstPtr, srcPtr, dstWidth, dstHeight, dstBytesPerRow, \
+                        srcWidth, srcBytesPerRow, kernel, \
+                        kernelStartX, kernelEndX, kernelStartY, kernelEndY ); \
+        } \
+    }
+
+    OGRE_DOWNSAMPLE_SIMD_IMPL( downscale2x_SIMD_XXXA8888, downscale2x_XXXA8888, 4u, 3, false )
+    OGRE_DOWNSAMPLE_SIMD_IMPL( downscale2x_SIMD_XX88, downscale2x_XX88, 2u, -1, false )
+    OGRE_DOWNSAMPLE_SIMD_IMPL( downscale2x_SIMD_X8, downscale2x_X8, 1u, -1, false )
+    OGRE_DOWNSAMPLE_SIMD_IMPL( downscale2x_SIMD_sRGB_XXXA8888, downscale2x_sRGB_XXXA8888, 4u, 3, true )
+
+#undef OGRE_DOWNSAMPLE_SIMD_IMPL
+}
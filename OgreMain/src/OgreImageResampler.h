@@ -376,6 +376,314 @@ struct LinearResampler_Byte
         }
     }
 };
+
+// separable resampler (box, triangle, bicubic, lanczos), converts any accessible format.
+// Works in linear RGBA32_FLOAT: one horizontal pass followed by one vertical pass, each
+// split by rows across worker threads for big images. The inner loops operate on 4
+// contiguous floats so they're easy for the compiler to vectorize.
+struct SeparableResampler
+{
+    enum Kernel
+    {
+        KernelBox,
+        KernelTriangle,
+        KernelBicubic,
+        KernelLanczos3
+    };
+
+    /// Weights for every output pixel along one axis
+    struct Contributions
+    {
+        FastArray<uint32>   start;
+        FastArray<uint32>   count;
+        /// maxTaps weights per output pixel
+        FastArray<float>    weights;
+        uint32              maxTaps;
+    };
+
+    /// A range of rows of one of the passes
+    struct Job
+    {
+        float const         *srcData;
+        float               *dstData;
+        size_t              srcFloatsPerRow;
+        size_t              dstFloatsPerRow;
+        size_t              dstWidth;
+        Contributions const *contributions;
+        bool                horizontal;
+        size_t              rowStart;
+        size_t              rowEnd;
+    };
+
+    static float getSupport( Kernel kernel )
+    {
+        switch( kernel )
+        {
+        case KernelBox:         return 0.5f;
+        case KernelTriangle:    return 1.0f;
+        case KernelBicubic:     return 2.0f;
+        case KernelLanczos3:    return 3.0f;
+        }
+        return 1.0f;
+    }
+
+    static float sinc( float x )
+    {
+        if( fabsf( x ) < 1e-6f )
+            return 1.0f;
+        x *= Math::PI;
+        return sinf( x ) / x;
+    }
+
+    static float evaluate( Kernel kernel, float x )
+    {
+        x = fabsf( x );
+        switch( kernel )
+        {
+        case KernelBox:
+            return x <= 0.5f ? 1.0f : 0.0f;
+        case KernelTriangle:
+            return x < 1.0f ? 1.0f - x : 0.0f;
+        case KernelBicubic:
+            // Keys cubic with a = -0.5 (Catmull-Rom)
+            if( x < 1.0f )
+                return ( 1.5f * x - 2.5f ) * x * x + 1.0f;
+            if( x < 2.0f )
+                return ( ( -0.5f * x + 2.5f ) * x - 4.0f ) * x + 2.0f;
+            return 0.0f;
+        case KernelLanczos3:
+            return x < 3.0f ? sinc( x ) * sinc( x / 3.0f ) : 0.0f;
+        }
+        return 0.0f;
+    }
+
+    static void computeContributions( Kernel kernel, uint32 srcSize, uint32 dstSize,
+                                      Contributions &outContributions )
+    {
+        const float scale = static_cast<float>( srcSize ) / static_cast<float>( dstSize );
+        // When minifying, stretch the kernel to cover all the source pixels
+        const float filterScale = std::max( scale, 1.0f );
+        const float support = getSupport( kernel ) * filterScale;
+
+        outContributions.maxTaps =
+                std::min( static_cast<uint32>( ceilf( support ) ) * 2u + 1u, srcSize );
+        outContributions.start.resize( dstSize );
+        outContributions.count.resize( dstSize );
+        outContributions.weights.resize( dstSize * outContributions.maxTaps, 0.0f );
+
+        for( uint32 i=0; i<dstSize; ++i )
+        {
+            const float center = ( static_cast<float>( i ) + 0.5f ) * scale;
+            int32 left  = static_cast<int32>( floorf( center - support ) );
+            int32 right = static_cast<int32>( ceilf( center + support ) );
+            left    = std::max( left, 0 );
+            right   = std::min( right, static_cast<int32>( srcSize ) );
+            right   = std::min( right, left + static_cast<int32>( outContributions.maxTaps ) );
+
+            float *weights = &outContributions.weights[i * outContributions.maxTaps];
+            float totalWeight = 0.0f;
+            for( int32 j=left; j<right; ++j )
+            {
+                const float w = evaluate( kernel, ( static_cast<float>( j ) + 0.5f - center ) /
+                                                  filterScale );
+                weights[j - left] = w;
+                totalWeight += w;
+            }
+
+            if( totalWeight != 0.0f )
+            {
+                // Renormalize to account for the taps clipped at the borders
+                const float invTotalWeight = 1.0f / totalWeight;
+                for( int32 j=left; j<right; ++j )
+                    weights[j - left] *= invTotalWeight;
+            }
+            else
+            {
+                // Degenerate case. Fallback to point sampling
+                left = std::min( static_cast<int32>( center ), static_cast<int32>( srcSize ) - 1 );
+                right = left + 1;
+                weights[0] = 1.0f;
+            }
+
+            outContributions.start[i] = static_cast<uint32>( left );
+            outContributions.count[i] = static_cast<uint32>( right - left );
+        }
+    }
+
+    static void execute( const Job &job )
+    {
+        const Contributions &contributions = *job.contributions;
+        const size_t maxTaps = contributions.maxTaps;
+
+        for( size_t row=job.rowStart; row<job.rowEnd; ++row )
+        {
+            float *dstRow = job.dstData + row * job.dstFloatsPerRow;
+
+            if( job.horizontal )
+            {
+                const float *srcRow = job.srcData + row * job.srcFloatsPerRow;
+                for( size_t x=0; x<job.dstWidth; ++x )
+                {
+                    const float *weights = &contributions.weights[x * maxTaps];
+                    const float *srcPixel = srcRow + contributions.start[x] * 4u;
+                    const size_t numTaps = contributions.count[x];
+
+                    float accum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                    for( size_t i=0; i<numTaps; ++i )
+                    {
+                        for( size_t c=0; c<4u; ++c )
+                            accum[c] += srcPixel[c] * weights[i];
+                        srcPixel += 4u;
+                    }
+                    for( size_t c=0; c<4u; ++c )
+                        dstRow[x * 4u + c] = accum[c];
+                }
+            }
+            else
+            {
+                const float *weights = &contributions.weights[row * maxTaps];
+                const size_t numTaps = contributions.count[row];
+                const float *srcRow = job.srcData + contributions.start[row] * job.srcFloatsPerRow;
+                const size_t numFloats = job.dstWidth * 4u;
+
+                for( size_t x=0; x<numFloats; ++x )
+                    dstRow[x] = 0.0f;
+
+                for( size_t i=0; i<numTaps; ++i )
+                {
+                    const float w = weights[i];
+                    for( size_t x=0; x<numFloats; ++x )
+                        dstRow[x] += srcRow[x] * w;
+                    srcRow += job.srcFloatsPerRow;
+                }
+            }
+        }
+    }
+
+    /// Runs job over rows [0; numRows), splitting the work when it's big enough
+    static void run( Job job, size_t numRows, size_t workPerRow );
+
+    static void scale( const TextureBox &src, PixelFormatGpu srcFormat,
+                       const TextureBox &dst, PixelFormatGpu dstFormat, Kernel kernel )
+    {
+        assert( src.depth == dst.depth && src.numSlices == dst.numSlices );
+
+        Contributions horizContributions, vertContributions;
+        computeContributions( kernel, src.width, dst.width, horizContributions );
+        computeContributions( kernel, src.height, dst.height, vertContributions );
+
+        const size_t srcFloatsPerRow = src.width * 4u;
+        const size_t dstFloatsPerRow = dst.width * 4u;
+
+        MemoryDataStreamPtr srcBuf( OGRE_NEW MemoryDataStream( srcFloatsPerRow * src.height *
+                                                               sizeof( float ) ) );
+        MemoryDataStreamPtr tmpBuf( OGRE_NEW MemoryDataStream( dstFloatsPerRow * src.height *
+                                                               sizeof( float ) ) );
+        MemoryDataStreamPtr dstBuf( OGRE_NEW MemoryDataStream( dstFloatsPerRow * dst.height *
+                                                               sizeof( float ) ) );
+
+        const uint32 srcBytesPerRow = static_cast<uint32>( srcFloatsPerRow * sizeof( float ) );
+        const uint32 dstBytesPerRow = static_cast<uint32>( dstFloatsPerRow * sizeof( float ) );
+        TextureBox srcFloat( src.width, src.height, 1u, 1u, sizeof( float ) * 4u,
+                             srcBytesPerRow, srcBytesPerRow * src.height );
+        srcFloat.data = srcBuf->getPtr();
+        TextureBox dstFloat( dst.width, dst.height, 1u, 1u, sizeof( float ) * 4u,
+                             dstBytesPerRow, dstBytesPerRow * dst.height );
+        dstFloat.data = dstBuf->getPtr();
+
+        const uint32 depthOrSlices = src.getDepthOrSlices();
+        for( uint32 z=0; z<depthOrSlices; ++z )
+        {
+            TextureBox srcSlice = src;
+            TextureBox dstSlice = dst;
+            if( src.numSlices > 1u )
+            {
+                srcSlice.sliceStart += z;
+                dstSlice.sliceStart += z;
+                srcSlice.numSlices = dstSlice.numSlices = 1u;
+            }
+            else
+            {
+                srcSlice.z += z;
+                dstSlice.z += z;
+                srcSlice.depth = dstSlice.depth = 1u;
+            }
+
+            PixelFormatGpuUtils::bulkPixelConversion( srcSlice, srcFormat,
+                                                      srcFloat, PFG_RGBA32_FLOAT );
+
+            Job job;
+            job.srcData         = reinterpret_cast<const float*>( srcBuf->getPtr() );
+            job.dstData         = reinterpret_cast<float*>( tmpBuf->getPtr() );
+            job.srcFloatsPerRow = srcFloatsPerRow;
+            job.dstFloatsPerRow = dstFloatsPerRow;
+            job.dstWidth        = dst.width;
+            job.contributions   = &horizContributions;
+            job.horizontal      = true;
+            job.rowStart        = 0;
+            job.rowEnd          = 0;
+            run( job, src.height, dst.width * horizContributions.maxTaps );
+
+            job.srcData         = reinterpret_cast<const float*>( tmpBuf->getPtr() );
+            job.dstData         = reinterpret_cast<float*>( dstBuf->getPtr() );
+            job.srcFloatsPerRow = dstFloatsPerRow;
+            job.contributions   = &vertContributions;
+            job.horizontal      = false;
+            run( job, dst.height, dst.width * vertContributions.maxTaps );
+
+            PixelFormatGpuUtils::bulkPixelConversion( dstFloat, PFG_RGBA32_FLOAT,
+                                                      dstSlice, dstFormat );
+        }
+    }
+};
+
+inline unsigned long separableResamplerThread( ThreadHandle *threadHandle )
+{
+    SeparableResampler::execute(
+        *reinterpret_cast<const SeparableResampler::Job*>( threadHandle->getUserParam() ) );
+    return 0;
+}
+THREAD_DECLARE( separableResamplerThread );
+
+inline void SeparableResampler::run( Job job, size_t numRows, size_t workPerRow )
+{
+    size_t numThreads = 1u;
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+    // Not worth spawning threads for thumbnails
+    if( numRows * workPerRow >= 1024u * 1024u )
+    {
+        //getNumLogicalCores() may return 0 if couldn't detect
+        numThreads = std::max<size_t>( 1u, PlatformInformation::getNumLogicalCores() );
+        numThreads = std::min( std::min<size_t>( numThreads, 8u ), numRows );
+    }
+#endif
+
+    if( numThreads <= 1u )
+    {
+        job.rowStart = 0;
+        job.rowEnd = numRows;
+        execute( job );
+        return;
+    }
+
+    Job jobs[8];
+    ThreadHandleVec threadHandles;
+    threadHandles.reserve( numThreads - 1u );
+    for( size_t i=0; i<numThreads; ++i )
+    {
+        jobs[i] = job;
+        jobs[i].rowStart = ( numRows * i ) / numThreads;
+        jobs[i].rowEnd = ( numRows * ( i + 1u ) ) / numThreads;
+        if( i != 0u )
+        {
+            threadHandles.push_back( Threads::CreateThread(
+                THREAD_GET( separableResamplerThread ), i, &jobs[i] ) );
+        }
+    }
+
+    execute( jobs[0] );
+    Threads::WaitForThreads( threadHandles );
+}
 /** @} */
 /** @} */
 
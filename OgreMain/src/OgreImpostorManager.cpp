@@ -0,0 +1,883 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreImpostorManager.h"
+
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreTexBufferPacked.h"
+
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorNodeDef.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "Compositor/OgreCompositorWorkspaceDef.h"
+#include "Compositor/Pass/PassClear/OgreCompositorPassClearDef.h"
+#include "Compositor/Pass/PassMipmap/OgreCompositorPassMipmapDef.h"
+#include "Compositor/Pass/PassQuad/OgreCompositorPassQuad.h"
+#include "Compositor/Pass/PassQuad/OgreCompositorPassQuadDef.h"
+#include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
+
+#include "OgreCamera.h"
+#include "OgreHlms.h"
+#include "OgreHlmsManager.h"
+#include "OgreItem.h"
+#include "OgreLight.h"
+#include "OgreLodStrategy.h"
+#include "OgreLodStrategyManager.h"
+#include "OgreLwString.h"
+#include "OgreMesh2.h"
+#include "OgrePass.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreRoot.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreTextureGpuManager.h"
+
+namespace Ogre
+{
+    /// float4 at the start of the instance buffer, see ImpostorBatch::writeInstances
+    static const uint32 c_instanceHeaderSize = 4u;
+    static const uint32 c_minBatchCapacity = 64u;
+    /// Identifier of the first scene pass of the bake workspace. Frame i uses c_framePassId + i
+    static const uint32 c_framePassId = 1u;
+    static const uint32 c_packPassId = 0xFFFFFFFFu;
+    /// Frames must be at least this big in the smallest mip
+    static const uint32 c_minMipResolution = 4u;
+
+    /** Returns the direction (from the centre towards the camera) frame (x, y) of the grid
+        was captured from. Same as the decoding in the shaders.
+    */
+    static Vector3 getImpostorFrameDirection( uint32 x, uint32 y, uint32 framesPerSide )
+    {
+        const Real scale = Real( 2.0 ) / Real( framesPerSide - 1u );
+        const Real fx = Real( x ) * scale - Real( 1.0 );
+        const Real fy = Real( y ) * scale - Real( 1.0 );
+        Vector3 dir( fx, Real( 1.0 ) - Math::Abs( fx ) - Math::Abs( fy ), fy );
+        const Real t = Math::saturate( -dir.y );
+        dir.x += dir.x >= 0 ? -t : t;
+        dir.z += dir.z >= 0 ? -t : t;
+        return dir.normalisedCopy();
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    ImpostorBatch::ImpostorBatch( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                  SceneManager *manager, uint8 renderQueueId,
+                                  ImpostorDefinition *definition ) :
+        MovableObject( id, objectMemoryManager, manager, renderQueueId ),
+        Renderable(),
+        mDefinition( definition ),
+        mVaoManager( manager->getDestinationRenderSystem()->getVaoManager() ),
+        mVertexBuffer( 0 ),
+        mIndexBuffer( 0 ),
+        mInstanceBuffer( 0 ),
+        mCapacity( 0 ),
+        mLastInstanceFrame( std::numeric_limits<uint32>::max() )
+    {
+        //The buffers must exist before setting the datablock (see getImpostorInstanceBuffer)
+        createBuffers( c_minBatchCapacity );
+        setCastShadows( false );
+        Renderable::setDatablock( definition->mDatablock );
+    }
+    //-----------------------------------------------------------------------------------
+    ImpostorBatch::~ImpostorBatch()
+    {
+        destroyBuffers();
+    }
+    //-----------------------------------------------------------------------------------
+    template <typename T>
+    void fillImpostorIndices( T * RESTRICT_ALIAS indices, uint32 numInstances )
+    {
+        for( uint32 i=0; i<numInstances; ++i )
+        {
+            const T baseVertex = static_cast<T>( i * 4u );
+            *indices++ = baseVertex;
+            *indices++ = baseVertex + 2u;
+            *indices++ = baseVertex + 1u;
+            *indices++ = baseVertex + 1u;
+            *indices++ = baseVertex + 2u;
+            *indices++ = baseVertex + 3u;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorBatch::createBuffers( uint32 capacity )
+    {
+        VertexElement2Vec vertexElements;
+        vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_POSITION ) );
+        //The Hlms needs an UV set to output one. The vertex shader overrides it
+        vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+
+        const uint32 numVertices = capacity * 4u;
+        float *vertices = reinterpret_cast<float*>(
+                              OGRE_MALLOC_SIMD( numVertices * 6u * sizeof(float),
+                                                MEMCATEGORY_GEOMETRY ) );
+        FreeOnDestructor verticesPtr( vertices );
+        {
+            float * RESTRICT_ALIAS vertex = vertices;
+            for( uint32 i=0; i<capacity; ++i )
+            {
+                for( uint32 j=0; j<4u; ++j )
+                {
+                    //Corners in xy (-1 = left/bottom; 1 = right/top), instance in z
+                    const float x = (j & 0x01u) ? 1.0f : -1.0f;
+                    const float y = (j & 0x02u) ? -1.0f : 1.0f;
+                    *vertex++ = x;
+                    *vertex++ = y;
+                    *vertex++ = static_cast<float>( i );
+                    *vertex++ = 0.0f;
+                    *vertex++ = x * 0.5f + 0.5f;
+                    *vertex++ = 0.5f - y * 0.5f;
+                }
+            }
+        }
+
+        mVertexBuffer = mVaoManager->createVertexBuffer( vertexElements, numVertices,
+                                                         BT_IMMUTABLE, vertices, false );
+
+        const uint32 numIndices = capacity * 6u;
+        const bool useIndices32 = numVertices > 0xFFFF;
+        const size_t bytesPerIndex = useIndices32 ? sizeof(uint32) : sizeof(uint16);
+
+        void *indices = OGRE_MALLOC_SIMD( numIndices * bytesPerIndex, MEMCATEGORY_GEOMETRY );
+        FreeOnDestructor indicesPtr( indices );
+        if( useIndices32 )
+            fillImpostorIndices( reinterpret_cast<uint32*>( indices ), capacity );
+        else
+            fillImpostorIndices( reinterpret_cast<uint16*>( indices ), capacity );
+
+        try
+        {
+            mIndexBuffer = mVaoManager->createIndexBuffer( useIndices32 ? IndexBufferPacked::IT_32BIT :
+                                                                          IndexBufferPacked::IT_16BIT,
+                                                           numIndices, BT_IMMUTABLE, indices, false );
+        }
+        catch( Exception & )
+        {
+            mVaoManager->destroyVertexBuffer( mVertexBuffer );
+            mVertexBuffer = 0;
+            throw;
+        }
+
+        mInstanceBuffer = mVaoManager->createTexBuffer( PFG_RGBA32_FLOAT,
+                                                        (c_instanceHeaderSize + 2u * capacity) *
+                                                        4u * sizeof(float),
+                                                        BT_DYNAMIC_PERSISTENT, 0, false );
+
+        VertexBufferPackedVec vertexBuffers;
+        vertexBuffers.push_back( mVertexBuffer );
+        VertexArrayObject *vao = mVaoManager->createVertexArrayObject( vertexBuffers, mIndexBuffer,
+                                                                       OT_TRIANGLE_LIST );
+        mVaoPerLod[VpNormal].push_back( vao );
+        mVaoPerLod[VpShadow].push_back( vao );
+
+        mCapacity = capacity;
+        mLastInstanceFrame = std::numeric_limits<uint32>::max();
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorBatch::destroyBuffers(void)
+    {
+        if( !mVaoPerLod[VpNormal].empty() )
+        {
+            mVaoManager->destroyVertexArrayObject( mVaoPerLod[VpNormal].back() );
+            mVaoPerLod[VpNormal].clear();
+            mVaoPerLod[VpShadow].clear();
+        }
+
+        if( mInstanceBuffer )
+        {
+            if( mInstanceBuffer->getMappingState() != MS_UNMAPPED )
+                mInstanceBuffer->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyTexBuffer( mInstanceBuffer );
+            mInstanceBuffer = 0;
+        }
+        if( mIndexBuffer )
+        {
+            mVaoManager->destroyIndexBuffer( mIndexBuffer );
+            mIndexBuffer = 0;
+        }
+        if( mVertexBuffer )
+        {
+            mVaoManager->destroyVertexBuffer( mVertexBuffer );
+            mVertexBuffer = 0;
+        }
+
+        mCapacity = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorBatch::writeInstances( const Vector3 &lightDir, const ColourValue &lightColour,
+                                        const ColourValue &ambient )
+    {
+        //Persistent buffers can only be mapped once per frame
+        if( mLastInstanceFrame == mVaoManager->getFrameCount() )
+            return;
+
+        mRenderables.clear();
+
+        const ImpostorDefinition::InstanceVec &instances = mDefinition->mInstances;
+
+        uint32 numVisible = 0;
+        ImpostorDefinition::InstanceVec::const_iterator itor = instances.begin();
+        ImpostorDefinition::InstanceVec::const_iterator endt = instances.end();
+        while( itor != endt )
+        {
+            if( itor->fade > 0 )
+                ++numVisible;
+            ++itor;
+        }
+
+        if( !numVisible )
+            return;
+
+        if( numVisible > mCapacity )
+        {
+            destroyBuffers();
+            uint32 capacity = c_minBatchCapacity;
+            while( capacity < numVisible )
+                capacity <<= 1u;
+            createBuffers( capacity );
+        }
+
+        const uint32 framesPerSide = mDefinition->mFramesPerSide;
+
+        float * RESTRICT_ALIAS params = reinterpret_cast<float*>(
+                    mInstanceBuffer->map( 0, mInstanceBuffer->getNumElements() ) );
+
+        *params++ = static_cast<float>( framesPerSide );
+        *params++ = 1.0f / static_cast<float>( framesPerSide );
+        *params++ = static_cast<float>( framesPerSide - 1u );
+        *params++ = 0;
+
+        *params++ = static_cast<float>( lightDir.x );
+        *params++ = static_cast<float>( lightDir.y );
+        *params++ = static_cast<float>( lightDir.z );
+        *params++ = 0;
+
+        *params++ = lightColour.r;
+        *params++ = lightColour.g;
+        *params++ = lightColour.b;
+        *params++ = 0;
+
+        *params++ = ambient.r;
+        *params++ = ambient.g;
+        *params++ = ambient.b;
+        *params++ = 0;
+
+        Aabb aabb( Aabb::BOX_NULL );
+
+        itor = instances.begin();
+        while( itor != endt )
+        {
+            if( itor->fade > 0 )
+            {
+                const Node *node = itor->item->getParentNode();
+                const Vector3 derivedScale = node->_getDerivedScale();
+                const Real scale = std::max( std::max( Math::Abs( derivedScale.x ),
+                                                       Math::Abs( derivedScale.y ) ),
+                                             Math::Abs( derivedScale.z ) );
+                Quaternion orientation = node->_getDerivedOrientation();
+                if( orientation.w < 0 )
+                    orientation = -orientation;
+                const Vector3 centre = node->_getDerivedPosition() +
+                                       orientation * (derivedScale * mDefinition->mCentre);
+                const Real radius = mDefinition->mRadius * scale;
+
+                *params++ = static_cast<float>( centre.x );
+                *params++ = static_cast<float>( centre.y );
+                *params++ = static_cast<float>( centre.z );
+                *params++ = static_cast<float>( radius );
+
+                *params++ = static_cast<float>( orientation.x );
+                *params++ = static_cast<float>( orientation.y );
+                *params++ = static_cast<float>( orientation.z );
+                *params++ = static_cast<float>( itor->fade );
+
+                aabb.merge( Aabb( centre, Vector3( radius ) ) );
+            }
+            ++itor;
+        }
+
+        mInstanceBuffer->unmap( UO_KEEP_PERSISTENT );
+        mLastInstanceFrame = mVaoManager->getFrameCount();
+
+        mVaoPerLod[VpNormal].back()->setPrimitiveRange( 0, numVisible * 6u );
+        mRenderables.push_back( this );
+
+        //Positions are in world space. The node is never moved thus local = world
+        mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
+        mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
+
+        if( mParentNode )
+        {
+            getWorldAabbUpdated();
+            getWorldRadiusUpdated();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    const String& ImpostorBatch::getMovableType(void) const
+    {
+        static const String movType = "ImpostorBatch";
+        return movType;
+    }
+    //-----------------------------------------------------------------------------------
+    const LightList& ImpostorBatch::getLights(void) const
+    {
+        return queryLights();
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorBatch::getRenderOperation( v1::RenderOperation &op, bool casterPass )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "ImpostorBatch do not implement getRenderOperation."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "ImpostorBatch::getRenderOperation" );
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorBatch::getWorldTransforms( Matrix4 *xform ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "ImpostorBatch do not implement getWorldTransforms."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "ImpostorBatch::getWorldTransforms" );
+    }
+    //-----------------------------------------------------------------------------------
+    bool ImpostorBatch::getCastsShadows(void) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "ImpostorBatch do not implement getCastsShadows."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "ImpostorBatch::getCastsShadows" );
+    }
+    //-----------------------------------------------------------------------------------
+    TexBufferPacked* ImpostorBatch::getImpostorInstanceBuffer(void) const
+    {
+        return mInstanceBuffer;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    ImpostorDefinition::ImpostorDefinition( const MeshPtr &mesh, uint32 framesPerSide,
+                                            uint32 frameResolution, Real lodStart,
+                                            Real lodEnd ) :
+        mMesh( mesh ),
+        mFramesPerSide( framesPerSide ),
+        mFrameResolution( frameResolution ),
+        mCentre( mesh->getAabb().mCenter ),
+        mRadius( mesh->getAabb().getRadius() ),
+        mAlbedoAtlas( 0 ),
+        mNormalDepthAtlas( 0 ),
+        mDatablock( 0 ),
+        mBatch( 0 ),
+        mLodStart( lodStart ),
+        mLodEnd( lodEnd ),
+        mBaked( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    ImpostorManager::ImpostorManager( SceneManager *sceneManager, Camera *camera,
+                                      CompositorManager2 *compositorManager,
+                                      uint8 renderQueueGroup ) :
+        mSceneManager( sceneManager ),
+        mCamera( camera ),
+        mLight( 0 ),
+        mRenderQueueGroup( renderQueueGroup ),
+        mDefaultLodStart( 500 ),
+        mDefaultLodEnd( 550 ),
+        mCurrentBake( 0 ),
+        mBakeItem( 0 ),
+        mBakeSceneManager( 0 ),
+        mBakeCamera( 0 ),
+        mVaoManager( sceneManager->getDestinationRenderSystem()->getVaoManager() ),
+        mTextureGpuManager( sceneManager->getDestinationRenderSystem()->getTextureGpuManager() ),
+        mCompositorManager( compositorManager )
+    {
+        mCompositorManager->addListener( this );
+    }
+    //-----------------------------------------------------------------------------------
+    ImpostorManager::~ImpostorManager()
+    {
+        destroyAllImpostors();
+
+        if( mBakeSceneManager )
+        {
+            Root::getSingleton().destroySceneManager( mBakeSceneManager );
+            mBakeSceneManager = 0;
+            mBakeCamera = 0;
+        }
+
+        mCompositorManager->removeListener( this );
+    }
+    //-----------------------------------------------------------------------------------
+    IdString ImpostorManager::getBakeWorkspaceDefinition( uint32 framesPerSide )
+    {
+        const String suffix = StringConverter::toString( framesPerSide );
+        const String workspaceName = "AutoGen_Impostor_Workspace_" + suffix;
+
+        if( mCompositorManager->getWorkspaceDefinitionNoThrow( workspaceName ) )
+            return workspaceName;
+
+        const uint32 numFrames = framesPerSide * framesPerSide;
+
+        CompositorNodeDef *nodeDef =
+                mCompositorManager->addNodeDefinition( "AutoGen_Impostor_Node_" + suffix );
+        //Input textures
+        nodeDef->addTextureSourceName( "ImpostorAlbedo", 0, TextureDefinitionBase::TEXTURE_INPUT );
+        nodeDef->addTextureSourceName( "ImpostorNormalDepth", 1,
+                                       TextureDefinitionBase::TEXTURE_INPUT );
+
+        //Depth buffer of the whole atlas, read back by the pack pass
+        nodeDef->setNumLocalTextureDefinitions( 1u );
+        {
+            TextureDefinitionBase::TextureDefinition *texDef =
+                    nodeDef->addTextureDefinition( "ImpostorDepth" );
+            texDef->format = PFG_D32_FLOAT;
+        }
+
+        {
+            RenderTargetViewDef *rtv = nodeDef->addRenderTextureView( "ImpostorFrames" );
+            RenderTargetViewEntry attachment;
+            attachment.textureName = "ImpostorAlbedo";
+            rtv->colourAttachments.push_back( attachment );
+            rtv->depthAttachment.textureName = "ImpostorDepth";
+        }
+
+        nodeDef->setNumTargetPass( 3u );
+
+        {
+            CompositorTargetDef *targetDef = nodeDef->addTargetPass( "ImpostorFrames" );
+            targetDef->setNumPasses( 1u + numFrames );
+            {
+                CompositorPassClearDef *passClear = static_cast<CompositorPassClearDef*>
+                                                        ( targetDef->addPass( PASS_CLEAR ) );
+                passClear->mClearColour[0] = ColourValue( 0.0f, 0.0f, 0.0f, 0.0f );
+            }
+
+            const float frameSize = 1.0f / static_cast<float>( framesPerSide );
+            for( uint32 i=0; i<numFrames; ++i )
+            {
+                CompositorPassSceneDef *passScene = static_cast<CompositorPassSceneDef*>
+                                                        ( targetDef->addPass( PASS_SCENE ) );
+                //The camera is placed by passEarlyPreExecute
+                passScene->mIdentifier          = c_framePassId + i;
+                passScene->mEnableForwardPlus   = false;
+                passScene->mIncludeOverlays     = false;
+                passScene->mUpdateLodLists      = false;
+
+                CompositorPassDef::ViewportRect &vpRect = passScene->mVpRect[0];
+                vpRect.mVpLeft  = static_cast<float>( i % framesPerSide ) * frameSize;
+                vpRect.mVpTop   = static_cast<float>( i / framesPerSide ) * frameSize;
+                vpRect.mVpWidth = frameSize;
+                vpRect.mVpHeight= frameSize;
+                vpRect.mVpScissorLeft   = vpRect.mVpLeft;
+                vpRect.mVpScissorTop    = vpRect.mVpTop;
+                vpRect.mVpScissorWidth  = frameSize;
+                vpRect.mVpScissorHeight = frameSize;
+            }
+        }
+
+        {
+            CompositorTargetDef *targetDef = nodeDef->addTargetPass( "ImpostorNormalDepth" );
+            targetDef->setNumPasses( 2u );
+            {
+                CompositorPassQuadDef *passQuad = static_cast<CompositorPassQuadDef*>
+                                                        ( targetDef->addPass( PASS_QUAD ) );
+                passQuad->mIdentifier   = c_packPassId;
+                passQuad->mMaterialName = "Ogre/Impostor/PackNormalDepth";
+                passQuad->addQuadTextureSource( 0, "ImpostorDepth" );
+            }
+            targetDef->addPass( PASS_MIPMAP );
+        }
+
+        {
+            CompositorTargetDef *targetDef = nodeDef->addTargetPass( "ImpostorAlbedo" );
+            targetDef->setNumPasses( 1u );
+            targetDef->addPass( PASS_MIPMAP );
+        }
+
+        CompositorWorkspaceDef *workDef = mCompositorManager->addWorkspaceDefinition( workspaceName );
+        workDef->connectExternal( 0, nodeDef->getName(), 0 );
+        workDef->connectExternal( 1, nodeDef->getName(), 1 );
+
+        return workspaceName;
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::createBakeSceneManager(void)
+    {
+        char tmpBuffer[64];
+        LwString smName( LwString::FromEmptyPointer( tmpBuffer, sizeof(tmpBuffer) ) );
+        smName.a( "ImpostorManager_Bake_", Id::generateNewId<ImpostorManager>() );
+
+        mBakeSceneManager = Root::getSingleton().createSceneManager( ST_GENERIC, 1u,
+                                                                     smName.c_str() );
+        //Without lights, only the diffuse colour of the materials remains
+        mBakeSceneManager->setAmbientLight( ColourValue::White, ColourValue::White,
+                                            Vector3::UNIT_Y, 0.0f );
+
+        mBakeCamera = mBakeSceneManager->createCamera( "ImpostorManager_Bake" );
+        mBakeCamera->setProjectionType( PT_ORTHOGRAPHIC );
+        mBakeCamera->setFixedYawAxis( false );
+        mBakeCamera->setAutoAspectRatio( false );
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::prepareNextBake(void)
+    {
+        if( mPendingBakes.empty() )
+            return;
+
+        if( !mBakeSceneManager )
+            createBakeSceneManager();
+
+        mCurrentBake = mPendingBakes.front();
+        mPendingBakes.erase( mPendingBakes.begin() );
+
+        mBakeItem = mBakeSceneManager->createItem( mCurrentBake->mMesh, SCENE_DYNAMIC );
+        SceneNode *sceneNode = mBakeSceneManager->getRootSceneNode( SCENE_DYNAMIC )->
+                createChildSceneNode( SCENE_DYNAMIC );
+        sceneNode->attachObject( mBakeItem );
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::bake(void)
+    {
+        const Real radius = mCurrentBake->mRadius;
+        mBakeCamera->setOrthoWindow( radius * 2.0f, radius * 2.0f );
+        mBakeCamera->setNearClipDistance( radius );
+        mBakeCamera->setFarClipDistance( radius * 3.0f );
+
+        CompositorChannelVec channels;
+        channels.reserve( 2u );
+        channels.push_back( mCurrentBake->mAlbedoAtlas );
+        channels.push_back( mCurrentBake->mNormalDepthAtlas );
+
+        CompositorWorkspace *workspace =
+                mCompositorManager->addWorkspace( mBakeSceneManager, channels, mBakeCamera,
+                                                  getBakeWorkspaceDefinition(
+                                                      mCurrentBake->mFramesPerSide ),
+                                                  false );
+        workspace->addListener( this );
+        workspace->_update();
+        workspace->removeListener( this );
+        mCompositorManager->removeWorkspace( workspace );
+
+        mCurrentBake->mBaked = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::destroyBakeItem(void)
+    {
+        SceneNode *sceneNode = mBakeItem->getParentSceneNode();
+        sceneNode->detachObject( mBakeItem );
+        mBakeSceneManager->destroySceneNode( sceneNode );
+        mBakeSceneManager->destroyItem( mBakeItem );
+        mBakeItem = 0;
+        mCurrentBake = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::updateInstances( ImpostorDefinition *definition )
+    {
+        LodStrategy *lodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
+        const Real startValue = lodStrategy->transformUserValue( definition->mLodStart );
+        const Real endValue = lodStrategy->transformUserValue( definition->mLodEnd );
+        //Strategies like pixel count decrease with distance. When both values are equal
+        //use the base value (the value of the closest possible object) to tell which side
+        //is farther
+        const Real farSign = startValue >= lodStrategy->getBaseValue() ? 1.0f : -1.0f;
+
+        const bool canFade = definition->mBaked && mCamera;
+
+        ImpostorDefinition::InstanceVec::iterator itor = definition->mInstances.begin();
+        ImpostorDefinition::InstanceVec::iterator endt = definition->mInstances.end();
+        while( itor != endt )
+        {
+            Real fade = 0;
+            if( canFade && itor->item->getParentNode() )
+            {
+                const Real value = lodStrategy->getValue( itor->item, mCamera );
+                if( endValue != startValue )
+                    fade = Math::saturate( (value - startValue) / (endValue - startValue) );
+                else
+                    fade = (value - startValue) * farSign >= 0 ? 1.0f : 0.0f;
+            }
+
+            if( (fade >= 1.0f) != (itor->fade >= 1.0f) )
+                itor->item->setVisible( fade < 1.0f );
+            itor->fade = fade;
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::destroyBatch( ImpostorDefinition *definition )
+    {
+        ImpostorBatch *batch = definition->mBatch;
+        SceneNode *sceneNode = batch->getParentSceneNode();
+        sceneNode->detachObject( batch );
+        mSceneManager->destroySceneNode( sceneNode );
+        OGRE_DELETE batch;
+        definition->mBatch = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    ImpostorDefinition* ImpostorManager::createImpostor( const MeshPtr &mesh, uint32 framesPerSide,
+                                                         uint32 frameResolution )
+    {
+        if( framesPerSide < 2u || !frameResolution )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "framesPerSide must be at least 2 and frameResolution can't be 0",
+                         "ImpostorManager::createImpostor" );
+        }
+
+        ImpostorDefinition *definition = OGRE_NEW ImpostorDefinition( mesh, framesPerSide,
+                                                                      frameResolution,
+                                                                      mDefaultLodStart,
+                                                                      mDefaultLodEnd );
+
+        const uint32 resolution = framesPerSide * frameResolution;
+        const uint8 numMipmaps = static_cast<uint8>(
+                                     std::max<int>( PixelFormatGpuUtils::getMaxMipmapCount(
+                                                        frameResolution / c_minMipResolution ),
+                                                    1 ) );
+
+        const IdType id = Id::generateNewId<ImpostorDefinition>();
+        const String suffix = StringConverter::toString( id );
+
+        TextureGpu *textures[2];
+        const char *textureNames[2] = { "ImpostorAlbedo_", "ImpostorNormalDepth_" };
+        const PixelFormatGpu textureFormats[2] = { PFG_RGBA8_UNORM_SRGB, PFG_RGBA8_UNORM };
+        for( size_t i=0; i<2u; ++i )
+        {
+            textures[i] = mTextureGpuManager->createTexture( textureNames[i] + suffix,
+                                                             GpuPageOutStrategy::Discard,
+                                                             TextureFlags::RenderToTexture |
+                                                             TextureFlags::AllowAutomipmaps,
+                                                             TextureTypes::Type2D );
+            textures[i]->setResolution( resolution, resolution );
+            textures[i]->setPixelFormat( textureFormats[i] );
+            textures[i]->setNumMipmaps( numMipmaps );
+            textures[i]->_transitionTo( GpuResidency::Resident, (uint8*)0 );
+            textures[i]->_setNextResidencyStatus( GpuResidency::Resident );
+        }
+        definition->mAlbedoAtlas = textures[0];
+        definition->mNormalDepthAtlas = textures[1];
+
+        //HlmsUnlit picks the textures by name
+        HlmsParamVec params;
+        params.push_back( std::pair<IdString, String>( "diffuse_map",
+                                                       textures[0]->getNameStr() ) );
+        params.push_back( std::pair<IdString, String>( "diffuse_map1",
+                                                       textures[1]->getNameStr() ) );
+        std::sort( params.begin(), params.end(), OrderParamVecByKey );
+
+        const String datablockName = "Impostor_" + suffix;
+        Hlms *hlms = Root::getSingleton().getHlmsManager()->getHlms( HLMS_UNLIT );
+        definition->mDatablock = hlms->createDatablock( datablockName, datablockName,
+                                                        HlmsMacroblock(), HlmsBlendblock(),
+                                                        params );
+
+        definition->mBatch = OGRE_NEW ImpostorBatch( Id::generateNewId<MovableObject>(),
+                                                     &mSceneManager->_getEntityMemoryManager(
+                                                         SCENE_DYNAMIC ),
+                                                     mSceneManager, mRenderQueueGroup,
+                                                     definition );
+        //The batch is never moved, its instances are in world space
+        SceneNode *sceneNode = mSceneManager->getRootSceneNode( SCENE_DYNAMIC )->
+                createChildSceneNode( SCENE_DYNAMIC );
+        sceneNode->attachObject( definition->mBatch );
+
+        mDefinitions.push_back( definition );
+        mPendingBakes.push_back( definition );
+
+        return definition;
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::destroyImpostor( ImpostorDefinition *definition )
+    {
+        ImpostorDefinitionVec::iterator itor = std::find( mDefinitions.begin(), mDefinitions.end(),
+                                                          definition );
+        if( itor == mDefinitions.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "ImpostorDefinition was not created by this ImpostorManager",
+                         "ImpostorManager::destroyImpostor" );
+        }
+        mDefinitions.erase( itor );
+
+        itor = std::find( mPendingBakes.begin(), mPendingBakes.end(), definition );
+        if( itor != mPendingBakes.end() )
+            mPendingBakes.erase( itor );
+
+        if( mCurrentBake == definition )
+            destroyBakeItem();
+
+        ImpostorDefinition::InstanceVec::const_iterator itInst = definition->mInstances.begin();
+        ImpostorDefinition::InstanceVec::const_iterator enInst = definition->mInstances.end();
+        while( itInst != enInst )
+        {
+            if( itInst->fade >= 1.0f )
+                itInst->item->setVisible( true );
+            ++itInst;
+        }
+
+        destroyBatch( definition );
+
+        Hlms *hlms = definition->mDatablock->getCreator();
+        hlms->destroyDatablock( definition->mDatablock->getName() );
+
+        mTextureGpuManager->destroyTexture( definition->mAlbedoAtlas );
+        mTextureGpuManager->destroyTexture( definition->mNormalDepthAtlas );
+
+        OGRE_DELETE definition;
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::destroyAllImpostors(void)
+    {
+        while( !mDefinitions.empty() )
+            destroyImpostor( mDefinitions.back() );
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::addItem( Item *item, ImpostorDefinition *definition )
+    {
+        if( item->getMesh() != definition->mMesh )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Item '" + item->getName() + "' doesn't use the mesh of the impostor",
+                         "ImpostorManager::addItem" );
+        }
+
+        ImpostorDefinition::Instance instance;
+        instance.item   = item;
+        instance.fade   = 0;
+        definition->mInstances.push_back( instance );
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::removeItem( Item *item, ImpostorDefinition *definition )
+    {
+        ImpostorDefinition::InstanceVec &instances = definition->mInstances;
+        ImpostorDefinition::InstanceVec::iterator itor = instances.begin();
+        ImpostorDefinition::InstanceVec::iterator endt = instances.end();
+        while( itor != endt && itor->item != item )
+            ++itor;
+
+        if( itor == endt )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Item '" + item->getName() + "' was not added to the impostor",
+                         "ImpostorManager::removeItem" );
+        }
+
+        if( itor->fade >= 1.0f )
+            item->setVisible( true );
+
+        efficientVectorRemove( instances, itor );
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::setDefaultLodValues( Real lodStart, Real lodEnd )
+    {
+        mDefaultLodStart = lodStart;
+        mDefaultLodEnd = lodEnd;
+    }
+    //-----------------------------------------------------------------------------------
+    bool ImpostorManager::isBaking(void) const
+    {
+        return mCurrentBake || !mPendingBakes.empty();
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::passEarlyPreExecute( CompositorPass *pass )
+    {
+        const uint32 passId = pass->getDefinition()->mIdentifier;
+        const uint32 framesPerSide = mCurrentBake ? mCurrentBake->mFramesPerSide : 0u;
+
+        if( passId >= c_framePassId && passId < c_framePassId + framesPerSide * framesPerSide )
+        {
+            const uint32 frameIdx = passId - c_framePassId;
+            const Vector3 dir = getImpostorFrameDirection( frameIdx % framesPerSide,
+                                                           frameIdx / framesPerSide,
+                                                           framesPerSide );
+            //Same basis as the shaders
+            Vector3 up = Math::Abs( dir.y ) > 0.999f ? Vector3::UNIT_Z : Vector3::UNIT_Y;
+            const Vector3 right = up.crossProduct( dir ).normalisedCopy();
+            up = dir.crossProduct( right );
+
+            mBakeCamera->setPosition( mCurrentBake->mCentre + dir * (mCurrentBake->mRadius * 2.0f) );
+            mBakeCamera->setOrientation( Quaternion( right, up, dir ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::passPreExecute( CompositorPass *pass )
+    {
+        if( pass->getDefinition()->mIdentifier == c_packPassId && mCurrentBake &&
+            pass->getType() == PASS_QUAD )
+        {
+            //Linear depth from the depth buffer. Ortho projections store it as is
+            const bool reverseDepth = mSceneManager->getDestinationRenderSystem()->isReverseDepth();
+
+            Pass *matPass = static_cast<CompositorPassQuad*>( pass )->getPass();
+            GpuProgramParametersSharedPtr psParams = matPass->getFragmentProgramParameters();
+            psParams->setNamedConstant( "packParams",
+                                        Vector4( Real( mCurrentBake->mFramesPerSide ),
+                                                 Real( mCurrentBake->mFrameResolution ),
+                                                 reverseDepth ? -1.0f : 1.0f,
+                                                 reverseDepth ? 1.0f : 0.0f ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ImpostorManager::allWorkspacesBeginUpdate(void)
+    {
+        if( mCurrentBake )
+        {
+            //The Item was created last frame; its bounds are up to date now
+            bake();
+            destroyBakeItem();
+        }
+        prepareNextBake();
+
+        Vector3 lightDir( Vector3::UNIT_Y );
+        ColourValue lightColour( ColourValue::Black );
+        if( mLight )
+        {
+            lightDir = -mLight->getDerivedDirectionUpdated();
+            lightColour = mLight->getDiffuseColour() * mLight->getPowerScale();
+        }
+        const ColourValue &ambient = mSceneManager->getAmbientLightUpperHemisphere();
+
+        ImpostorDefinitionVec::const_iterator itor = mDefinitions.begin();
+        ImpostorDefinitionVec::const_iterator endt = mDefinitions.end();
+        while( itor != endt )
+        {
+            updateInstances( *itor );
+            (*itor)->mBatch->writeInstances( lightDir, lightColour, ambient );
+            ++itor;
+        }
+    }
+}
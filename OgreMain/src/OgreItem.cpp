@@ -47,7 +47,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     Item::Item( IdType id, ObjectMemoryManager *objectMemoryManager, SceneManager *manager )
         : MovableObject( id, objectMemoryManager, manager, 10u ),
-          mInitialised( false )
+          mInitialised( false ),
+          mSubItemCulling( false )
     {
         mObjectData.mQueryFlags[mObjectData.mIndex] = SceneManager::QUERY_ENTITY_DEFAULT_MASK;
     }
@@ -56,7 +57,8 @@ namespace Ogre {
                 const MeshPtr& mesh ) :
         MovableObject( id, objectMemoryManager, manager, 10u ),
         mMesh( mesh ),
-        mInitialised( false )
+        mInitialised( false ),
+        mSubItemCulling( false )
     {
         _initialise();
         mObjectData.mQueryFlags[mObjectData.mIndex] = SceneManager::QUERY_ENTITY_DEFAULT_MASK;
@@ -102,6 +104,7 @@ namespace Ogre {
         }
 
         mLodMesh = mMesh->_getLodValueArray();
+        mObjectData.invalidateLodRange();
 
         // Build main subItem list
         buildSubItems( prevMaterialsList.empty() ? 0 : &prevMaterialsList );
@@ -119,11 +122,14 @@ namespace Ogre {
             }
         }
 
+        updateSubItemAabbs();
+
         Aabb aabb( mMesh->getAabb() );
         mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mWorldAabb->setFromAabb( aabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
         mObjectData.mWorldRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
 
         mInitialised = true;
     }
@@ -136,6 +142,8 @@ namespace Ogre {
         // Delete submeshes
         mSubItems.clear();
         mRenderables.clear();
+        mSubItemAabbs.clear();
+        mRenderableAabbs = 0;
 
         // If mesh is skeletally animated: destroy instance
         assert( mManager || !mSkeletonInstance );
@@ -156,6 +164,8 @@ namespace Ogre {
         _deinitialise();
         // Unregister our listener
         mMesh->removeListener(this);
+        if( !mPendingMesh.isNull() )
+            mPendingMesh->removeListener( this );
     }
     //-----------------------------------------------------------------------
     void Item::_releaseManualHardwareResources()
@@ -173,6 +183,43 @@ namespace Ogre {
         return mMesh;
     }
     //-----------------------------------------------------------------------
+    void Item::setPlaceholderMesh( const MeshPtr &placeholder )
+    {
+        if( mPendingMesh.isNull() )
+        {
+            if( mInitialised || mMesh->isLoaded() )
+                return;
+
+            //We're already registered as listener of mMesh (see _initialise)
+            mPendingMesh = mMesh;
+        }
+        else
+        {
+            _deinitialise();
+            mMesh->removeListener( this );
+        }
+
+        mMesh = placeholder;
+        _initialise();
+    }
+    //-----------------------------------------------------------------------
+    void Item::loadingComplete( Resource *resource )
+    {
+        if( !mPendingMesh.isNull() && resource == mPendingMesh.get() )
+        {
+            _deinitialise();
+            //Can't removeListener from mPendingMesh here, it's iterating its listeners
+            mMesh->removeListener( this );
+            mMesh = mPendingMesh;
+            mPendingMesh.setNull();
+            _initialise();
+        }
+        else if( resource == mMesh.get() )
+        {
+            _initialise();
+        }
+    }
+    //-----------------------------------------------------------------------
     SubItem* Item::getSubItem(size_t index)
     {
         if (index >= mSubItems.size())
@@ -291,6 +338,43 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Item::updateSubItemAabbs(void)
+    {
+        mSubItemAabbs.clear();
+        mRenderableAabbs = 0;
+
+        if( !mSubItemCulling || mSubItems.size() <= 1u || mSkeletonInstance )
+            return;
+
+        if( !mMesh->hasSubMeshAabbs() )
+            mMesh->computeSubMeshAabbs();
+
+        const Aabb meshAabb( mMesh->getAabb() );
+
+        mSubItemAabbs.reserve( mSubItems.size() );
+        SubItemVec::const_iterator itor = mSubItems.begin();
+        SubItemVec::const_iterator end  = mSubItems.end();
+        while( itor != end )
+        {
+            const SubMesh *subMesh = itor->getSubMesh();
+            //SubMeshes we couldn't get bounds for fall back to the whole mesh's.
+            mSubItemAabbs.push_back( subMesh->hasAabb() ? subMesh->getAabb() : meshAabb );
+            ++itor;
+        }
+
+        mRenderableAabbs = &mSubItemAabbs;
+    }
+    //-----------------------------------------------------------------------
+    void Item::setSubItemCulling( bool bEnable )
+    {
+        if( mSubItemCulling != bEnable )
+        {
+            mSubItemCulling = bEnable;
+            if( mInitialised )
+                updateSubItemAabbs();
+        }
+    }
+    //-----------------------------------------------------------------------
     void Item::useSkeletonInstanceFrom(Item* master)
     {
         if( mMesh->getSkeletonName() != master->mMesh->getSkeletonName() )
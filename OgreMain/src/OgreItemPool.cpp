@@ -0,0 +1,202 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreItemPool.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+
+namespace Ogre
+{
+    ItemPool::ItemPool( SceneManager *sceneManager, const MeshPtr &mesh,
+                        SceneMemoryMgrTypes sceneType ) :
+        mSceneManager( sceneManager ),
+        mMesh( mesh ),
+        mSceneType( sceneType ),
+        mDatablock( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    ItemPool::~ItemPool()
+    {
+        _destroyAllInstances();
+    }
+    //-----------------------------------------------------------------------------------
+    Item* ItemPool::createInstance(void)
+    {
+        SceneNode *sceneNode = mSceneManager->getRootSceneNode( mSceneType )->
+                createChildSceneNode( mSceneType );
+        Item *item = mSceneManager->createItem( mMesh, mSceneType );
+        if( mDatablock )
+            item->setDatablock( mDatablock );
+        sceneNode->attachObject( item );
+
+        mInstances.push_back( item );
+        if( mFreeInstances.capacity() < mInstances.size() )
+            mFreeInstances.reserve( mInstances.capacity() );
+
+        return item;
+    }
+    //-----------------------------------------------------------------------------------
+    void ItemPool::reserve( size_t numInstances )
+    {
+        if( numInstances <= mInstances.size() )
+            return;
+
+        mInstances.reserve( numInstances );
+        mFreeInstances.reserve( numInstances );
+
+        while( mInstances.size() < numInstances )
+        {
+            Item *item = createInstance();
+            item->setVisible( false );
+            mFreeInstances.push_back( item );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Item* ItemPool::acquire( const Vector3 &position, const Quaternion &orientation,
+                             const Vector3 &scale )
+    {
+        Item *item;
+        if( mFreeInstances.empty() )
+        {
+            item = createInstance();
+        }
+        else
+        {
+            item = mFreeInstances.back();
+            mFreeInstances.pop_back();
+            item->setVisible( true );
+        }
+
+        SceneNode *sceneNode = item->getParentSceneNode();
+        sceneNode->setPosition( position );
+        sceneNode->setOrientation( orientation );
+        sceneNode->setScale( scale );
+
+        if( mSceneType == SCENE_STATIC )
+            mSceneManager->notifyStaticDirty( sceneNode );
+
+        return item;
+    }
+    //-----------------------------------------------------------------------------------
+    void ItemPool::release( Item *item )
+    {
+        assert( mFreeInstances.size() < mInstances.size() &&
+                "Releasing more Items than were acquired!" );
+        assert( item->getParentSceneNode() &&
+                item->getParentSceneNode()->getParentSceneNode() ==
+                mSceneManager->getRootSceneNode( mSceneType ) &&
+                "Item doesn't belong to this ItemPool or was detached!" );
+
+        item->setVisible( false );
+        //Never allocates, capacity was reserved in createInstance
+        mFreeInstances.push_back( item );
+
+        if( mSceneType == SCENE_STATIC )
+            mSceneManager->notifyStaticDirty( item->getParentSceneNode() );
+    }
+    //-----------------------------------------------------------------------------------
+    void ItemPool::releaseAll(void)
+    {
+        mFreeInstances.clear();
+
+        FastArray<Item*>::const_iterator itor = mInstances.begin();
+        FastArray<Item*>::const_iterator end  = mInstances.end();
+
+        while( itor != end )
+        {
+            (*itor)->setVisible( false );
+            mFreeInstances.push_back( *itor );
+            ++itor;
+        }
+
+        if( mSceneType == SCENE_STATIC && !mInstances.empty() )
+            mSceneManager->notifyStaticDirty( mSceneManager->getRootSceneNode( mSceneType ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void ItemPool::shrinkToFit(void)
+    {
+        FastArray<Item*>::const_iterator itor = mFreeInstances.begin();
+        FastArray<Item*>::const_iterator end  = mFreeInstances.end();
+
+        while( itor != end )
+        {
+            FastArray<Item*>::iterator itInstance = std::find( mInstances.begin(),
+                                                               mInstances.end(), *itor );
+            assert( itInstance != mInstances.end() );
+            //Order doesn't matter, swap with the last one
+            *itInstance = mInstances.back();
+            mInstances.pop_back();
+
+            SceneNode *sceneNode = (*itor)->getParentSceneNode();
+            mSceneManager->destroyItem( *itor );
+            mSceneManager->destroySceneNode( sceneNode );
+            ++itor;
+        }
+
+        mFreeInstances.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void ItemPool::setDatablock( HlmsDatablock *datablock )
+    {
+        mDatablock = datablock;
+
+        if( datablock )
+        {
+            FastArray<Item*>::const_iterator itor = mInstances.begin();
+            FastArray<Item*>::const_iterator end  = mInstances.end();
+
+            while( itor != end )
+            {
+                (*itor)->setDatablock( datablock );
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ItemPool::_destroyAllInstances(void)
+    {
+        FastArray<Item*>::const_iterator itor = mInstances.begin();
+        FastArray<Item*>::const_iterator end  = mInstances.end();
+
+        while( itor != end )
+        {
+            SceneNode *sceneNode = (*itor)->getParentSceneNode();
+            mSceneManager->destroyItem( *itor );
+            mSceneManager->destroySceneNode( sceneNode );
+            ++itor;
+        }
+
+        mInstances.clear();
+        mFreeInstances.clear();
+    }
+}
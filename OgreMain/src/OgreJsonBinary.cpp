@@ -0,0 +1,354 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#if !OGRE_NO_JSON
+
+#include "OgreJsonBinary.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+#include "ogrestd/map.h"
+
+#include "rapidjson/document.h"
+
+namespace Ogre
+{
+    const uint32 JsonBinary::FORMAT_VERSION = 1u;
+    static const char c_jsonBinaryMagic[4] = { 'O', 'G', 'J', 'B' };
+    /// Arrays & objects are decoded recursively. Corrupt data could otherwise nest deep
+    /// enough to overflow the stack.
+    static const uint32 c_jsonBinaryMaxDepth = 512u;
+
+    namespace
+    {
+        class JsonBinaryWriter
+        {
+            typedef map<String, uint32>::type StringIndexMap;
+
+            vector<uint8>::type mValues;
+            StringIndexMap      mStringIndices;
+            StringVector        mStrings;
+
+            template <typename T>
+            static void writeScalar( vector<uint8>::type &outData, T value )
+            {
+                const size_t offset = outData.size();
+                outData.resize( offset + sizeof(T) );
+                memcpy( &outData[offset], &value, sizeof(T) );
+            }
+
+            void writeString( const rapidjson::Value &value )
+            {
+                const String str( value.GetString(), value.GetStringLength() );
+                StringIndexMap::const_iterator itor = mStringIndices.find( str );
+                if( itor == mStringIndices.end() )
+                {
+                    const uint32 idx = static_cast<uint32>( mStrings.size() );
+                    itor = mStringIndices.insert( std::pair<String, uint32>( str, idx ) ).first;
+                    mStrings.push_back( str );
+                }
+                writeScalar<uint32>( mValues, itor->second );
+            }
+
+        public:
+            void writeValue( const rapidjson::Value &value )
+            {
+                if( value.IsNull() )
+                    mValues.push_back( JsonBinary::TagNull );
+                else if( value.IsFalse() )
+                    mValues.push_back( JsonBinary::TagFalse );
+                else if( value.IsTrue() )
+                    mValues.push_back( JsonBinary::TagTrue );
+                else if( value.IsUint64() )
+                {
+                    mValues.push_back( JsonBinary::TagUint64 );
+                    writeScalar<uint64>( mValues, value.GetUint64() );
+                }
+                else if( value.IsInt64() )
+                {
+                    mValues.push_back( JsonBinary::TagInt64 );
+                    writeScalar<int64>( mValues, value.GetInt64() );
+                }
+                else if( value.IsNumber() )
+                {
+                    mValues.push_back( JsonBinary::TagDouble );
+                    writeScalar<double>( mValues, value.GetDouble() );
+                }
+                else if( value.IsString() )
+                {
+                    mValues.push_back( JsonBinary::TagString );
+                    writeString( value );
+                }
+                else if( value.IsArray() )
+                {
+                    mValues.push_back( JsonBinary::TagArray );
+                    writeScalar<uint32>( mValues, value.Size() );
+
+                    rapidjson::Value::ConstValueIterator itor = value.Begin();
+                    rapidjson::Value::ConstValueIterator end  = value.End();
+
+                    while( itor != end )
+                    {
+                        writeValue( *itor );
+                        ++itor;
+                    }
+                }
+                else
+                {
+                    mValues.push_back( JsonBinary::TagObject );
+                    writeScalar<uint32>( mValues, value.MemberCount() );
+
+                    rapidjson::Value::ConstMemberIterator itor = value.MemberBegin();
+                    rapidjson::Value::ConstMemberIterator end  = value.MemberEnd();
+
+                    while( itor != end )
+                    {
+                        writeString( itor->name );
+                        writeValue( itor->value );
+                        ++itor;
+                    }
+                }
+            }
+
+            void flush( vector<uint8>::type &outData )
+            {
+                outData.insert( outData.end(), c_jsonBinaryMagic,
+                                c_jsonBinaryMagic + sizeof(c_jsonBinaryMagic) );
+                writeScalar<uint32>( outData, JsonBinary::FORMAT_VERSION );
+                writeScalar<uint32>( outData, static_cast<uint32>( mStrings.size() ) );
+
+                StringVector::const_iterator itor = mStrings.begin();
+                StringVector::const_iterator end  = mStrings.end();
+
+                while( itor != end )
+                {
+                    writeScalar<uint32>( outData, static_cast<uint32>( itor->size() ) );
+                    //c_str() includes the null terminator
+                    outData.insert( outData.end(), itor->c_str(),
+                                    itor->c_str() + itor->size() + 1u );
+                    ++itor;
+                }
+
+                outData.insert( outData.end(), mValues.begin(), mValues.end() );
+            }
+        };
+        //-------------------------------------------------------------------------------
+        class JsonBinaryReader
+        {
+            struct StringEntry
+            {
+                const char  *str;
+                uint32      length;
+            };
+            typedef vector<StringEntry>::type StringEntryVec;
+
+            const String                        &mFilename;
+            const uint8                         *mData;
+            size_t                              mSizeBytes;
+            size_t                              mOffset;
+            StringEntryVec                      mStrings;
+            rapidjson::Document::AllocatorType  &mAllocator;
+
+            void throwCorrupt(void)
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Binary JSON " + mFilename + " is truncated or corrupt at byte " +
+                             StringConverter::toString( mOffset ),
+                             "JsonBinary::decode" );
+            }
+
+            rapidjson::Value::StringRefType readStringIdx(void)
+            {
+                const uint32 idx = readScalar<uint32>();
+                if( idx >= mStrings.size() )
+                    throwCorrupt();
+                return rapidjson::Value::StringRefType( mStrings[idx].str, mStrings[idx].length );
+            }
+
+        public:
+            JsonBinaryReader( const String &filename, const uint8 *data, size_t sizeBytes,
+                              rapidjson::Document::AllocatorType &allocator ) :
+                mFilename( filename ),
+                mData( data ),
+                mSizeBytes( sizeBytes ),
+                mOffset( 0 ),
+                mAllocator( allocator )
+            {
+            }
+
+            template <typename T>
+            T readScalar(void)
+            {
+                if( mSizeBytes - mOffset < sizeof(T) )
+                    throwCorrupt();
+                T retVal;
+                memcpy( &retVal, mData + mOffset, sizeof(T) );
+                mOffset += sizeof(T);
+                return retVal;
+            }
+
+            void readStringTable(void)
+            {
+                const uint32 numStrings = readScalar<uint32>();
+                //Every string takes at least 5 bytes. Don't trust numStrings before reserving
+                if( numStrings > (mSizeBytes - mOffset) / 5u )
+                    throwCorrupt();
+                mStrings.reserve( numStrings );
+                for( uint32 i=0; i<numStrings; ++i )
+                {
+                    const uint32 length = readScalar<uint32>();
+                    if( mSizeBytes - mOffset <= length || mData[mOffset + length] != '\0' )
+                        throwCorrupt();
+                    StringEntry entry;
+                    entry.str = reinterpret_cast<const char*>( mData + mOffset );
+                    entry.length = length;
+                    mStrings.push_back( entry );
+                    mOffset += length + 1u;
+                }
+            }
+
+            void readValue( rapidjson::Value &outValue, uint32 depth )
+            {
+                const uint8 tag = readScalar<uint8>();
+                switch( tag )
+                {
+                case JsonBinary::TagNull:
+                    outValue.SetNull();
+                    break;
+                case JsonBinary::TagFalse:
+                    outValue.SetBool( false );
+                    break;
+                case JsonBinary::TagTrue:
+                    outValue.SetBool( true );
+                    break;
+                case JsonBinary::TagUint64:
+                    outValue.SetUint64( readScalar<uint64>() );
+                    break;
+                case JsonBinary::TagInt64:
+                    outValue.SetInt64( readScalar<int64>() );
+                    break;
+                case JsonBinary::TagDouble:
+                    outValue.SetDouble( readScalar<double>() );
+                    break;
+                case JsonBinary::TagString:
+                    outValue.SetString( readStringIdx() );
+                    break;
+                case JsonBinary::TagArray:
+                {
+                    if( depth >= c_jsonBinaryMaxDepth )
+                        throwCorrupt();
+                    const uint32 count = readScalar<uint32>();
+                    //Every value takes at least one byte. Don't trust count before reserving
+                    if( count > mSizeBytes - mOffset )
+                        throwCorrupt();
+                    outValue.SetArray();
+                    outValue.Reserve( count, mAllocator );
+                    for( uint32 i=0; i<count; ++i )
+                    {
+                        rapidjson::Value element;
+                        readValue( element, depth + 1u );
+                        outValue.PushBack( element, mAllocator );
+                    }
+                    break;
+                }
+                case JsonBinary::TagObject:
+                {
+                    if( depth >= c_jsonBinaryMaxDepth )
+                        throwCorrupt();
+                    const uint32 count = readScalar<uint32>();
+                    outValue.SetObject();
+                    for( uint32 i=0; i<count; ++i )
+                    {
+                        rapidjson::Value name( readStringIdx() );
+                        rapidjson::Value member;
+                        readValue( member, depth + 1u );
+                        outValue.AddMember( name, member, mAllocator );
+                    }
+                    break;
+                }
+                default:
+                    throwCorrupt();
+                }
+            }
+
+            bool isAtEnd(void) const    { return mOffset == mSizeBytes; }
+        };
+    }
+    //-----------------------------------------------------------------------------------
+    bool JsonBinary::isBinaryJson( const void *data, size_t sizeBytes )
+    {
+        return sizeBytes >= sizeof(c_jsonBinaryMagic) &&
+               memcmp( data, c_jsonBinaryMagic, sizeof(c_jsonBinaryMagic) ) == 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void JsonBinary::encode( const rapidjson::Value &root, vector<uint8>::type &outData )
+    {
+        JsonBinaryWriter writer;
+        writer.writeValue( root );
+        writer.flush( outData );
+    }
+    //-----------------------------------------------------------------------------------
+    void JsonBinary::decode( const String &filename, const void *data, size_t sizeBytes,
+                             rapidjson::Document &outDocument )
+    {
+        if( !isBinaryJson( data, sizeBytes ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         filename + " is not binary JSON",
+                         "JsonBinary::decode" );
+        }
+
+        const uint8 *dataStart = reinterpret_cast<const uint8*>( data ) + sizeof(c_jsonBinaryMagic);
+        sizeBytes -= sizeof(c_jsonBinaryMagic);
+
+        JsonBinaryReader reader( filename, dataStart, sizeBytes, outDocument.GetAllocator() );
+
+        const uint32 version = reader.readScalar<uint32>();
+        if( version != FORMAT_VERSION )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Binary JSON " + filename + " has format version " +
+                         StringConverter::toString( version ) + ", expected " +
+                         StringConverter::toString( FORMAT_VERSION ),
+                         "JsonBinary::decode" );
+        }
+
+        reader.readStringTable();
+        reader.readValue( outDocument, 0u );
+
+        if( !reader.isAtEnd() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Binary JSON " + filename + " has trailing data",
+                         "JsonBinary::decode" );
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,532 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "OgreStableHeaders.h"
+
+#include "OgreKTX2Codec.h"
+#include "OgreImage2.h"
+#include "OgreException.h"
+#include "OgreDataStream.h"
+#include "OgreRoot.h"
+#include "OgreRenderSystem.h"
+#include "OgreRenderSystemCapabilities.h"
+
+#include "OgreLogManager.h"
+#include "OgreBitwise.h"
+
+// Values from the KTX 2.0 specification & Khronos Data Format (khr_df.h)
+#define KTX2_SUPERCOMPRESSION_NONE      0u
+#define KTX2_SUPERCOMPRESSION_BASISLZ   1u
+#define KHR_DF_MODEL_ETC1S              163u
+#define KHR_DF_MODEL_UASTC              166u
+#define KHR_DF_TRANSFER_SRGB            2u
+#define KHR_DF_CHANNEL_ETC1S_AAA        15u
+#define KHR_DF_CHANNEL_UASTC_RGBA       3u
+#define KHR_DF_CHANNEL_UASTC_RRRG       5u
+
+namespace Ogre {
+
+    const uint8 KTX2FileIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                           0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    typedef struct {
+        uint8     identifier[12];
+        uint32    vkFormat;
+        uint32    typeSize;
+        uint32    pixelWidth;
+        uint32    pixelHeight;
+        uint32    pixelDepth;
+        uint32    layerCount;
+        uint32    faceCount;
+        uint32    levelCount;
+        uint32    supercompressionScheme;
+        uint32    dfdByteOffset;
+        uint32    dfdByteLength;
+        uint32    kvdByteOffset;
+        uint32    kvdByteLength;
+        uint64    sgdByteOffset;
+        uint64    sgdByteLength;
+    } KTX2Header;
+
+    typedef struct {
+        uint64    byteOffset;
+        uint64    byteLength;
+        uint64    uncompressedByteLength;
+    } KTX2LevelIndex;
+
+    //---------------------------------------------------------------------
+    static PixelFormatGpu vkFormatToPixelFormatGpu( uint32 vkFormat )
+    {
+        switch( vkFormat )
+        {
+        case 9:     return PFG_R8_UNORM;
+        case 10:    return PFG_R8_SNORM;
+        case 13:    return PFG_R8_UINT;
+        case 14:    return PFG_R8_SINT;
+        case 16:    return PFG_RG8_UNORM;
+        case 17:    return PFG_RG8_SNORM;
+        case 20:    return PFG_RG8_UINT;
+        case 21:    return PFG_RG8_SINT;
+        case 37:    return PFG_RGBA8_UNORM;
+        case 38:    return PFG_RGBA8_SNORM;
+        case 41:    return PFG_RGBA8_UINT;
+        case 42:    return PFG_RGBA8_SINT;
+        case 43:    return PFG_RGBA8_UNORM_SRGB;
+        case 44:    return PFG_BGRA8_UNORM;
+        case 50:    return PFG_BGRA8_UNORM_SRGB;
+        case 64:    return PFG_R10G10B10A2_UNORM;
+        case 68:    return PFG_R10G10B10A2_UINT;
+        case 70:    return PFG_R16_UNORM;
+        case 71:    return PFG_R16_SNORM;
+        case 74:    return PFG_R16_UINT;
+        case 75:    return PFG_R16_SINT;
+        case 76:    return PFG_R16_FLOAT;
+        case 77:    return PFG_RG16_UNORM;
+        case 78:    return PFG_RG16_SNORM;
+        case 81:    return PFG_RG16_UINT;
+        case 82:    return PFG_RG16_SINT;
+        case 83:    return PFG_RG16_FLOAT;
+        case 91:    return PFG_RGBA16_UNORM;
+        case 92:    return PFG_RGBA16_SNORM;
+        case 95:    return PFG_RGBA16_UINT;
+        case 96:    return PFG_RGBA16_SINT;
+        case 97:    return PFG_RGBA16_FLOAT;
+        case 98:    return PFG_R32_UINT;
+        case 99:    return PFG_R32_SINT;
+        case 100:   return PFG_R32_FLOAT;
+        case 101:   return PFG_RG32_UINT;
+        case 102:   return PFG_RG32_SINT;
+        case 103:   return PFG_RG32_FLOAT;
+        case 104:   return PFG_RGB32_UINT;
+        case 105:   return PFG_RGB32_SINT;
+        case 106:   return PFG_RGB32_FLOAT;
+        case 107:   return PFG_RGBA32_UINT;
+        case 108:   return PFG_RGBA32_SINT;
+        case 109:   return PFG_RGBA32_FLOAT;
+        case 122:   return PFG_R11G11B10_FLOAT;
+        case 123:   return PFG_R9G9B9E5_SHAREDEXP;
+        case 131:   // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+        case 133:   return PFG_BC1_UNORM;
+        case 132:   // VK_FORMAT_BC1_RGB_SRGB_BLOCK
+        case 134:   return PFG_BC1_UNORM_SRGB;
+        case 135:   return PFG_BC2_UNORM;
+        case 136:   return PFG_BC2_UNORM_SRGB;
+        case 137:   return PFG_BC3_UNORM;
+        case 138:   return PFG_BC3_UNORM_SRGB;
+        case 139:   return PFG_BC4_UNORM;
+        case 140:   return PFG_BC4_SNORM;
+        case 141:   return PFG_BC5_UNORM;
+        case 142:   return PFG_BC5_SNORM;
+        case 143:   return PFG_BC6H_UF16;
+        case 144:   return PFG_BC6H_SF16;
+        case 145:   return PFG_BC7_UNORM;
+        case 146:   return PFG_BC7_UNORM_SRGB;
+        case 147:   return PFG_ETC2_RGB8_UNORM;
+        case 148:   return PFG_ETC2_RGB8_UNORM_SRGB;
+        case 149:   return PFG_ETC2_RGB8A1_UNORM;
+        case 150:   return PFG_ETC2_RGB8A1_UNORM_SRGB;
+        case 151:   return PFG_ETC2_RGBA8_UNORM;
+        case 152:   return PFG_ETC2_RGBA8_UNORM_SRGB;
+        case 153:   return PFG_EAC_R11_UNORM;
+        case 154:   return PFG_EAC_R11_SNORM;
+        case 155:   return PFG_EAC_R11G11_UNORM;
+        case 156:   return PFG_EAC_R11G11_SNORM;
+        default:
+            // VK_FORMAT_ASTC_4x4_UNORM_BLOCK to VK_FORMAT_ASTC_12x12_SRGB_BLOCK,
+            // interleaved UNORM / SRGB in the same block size order as Ogre's
+            if( vkFormat >= 157u && vkFormat <= 184u )
+            {
+                const uint32 blockIdx = (vkFormat - 157u) >> 1u;
+                const bool isSrgb = ((vkFormat - 157u) & 0x01u) != 0u;
+                return static_cast<PixelFormatGpu>(
+                            (isSrgb ? PFG_ASTC_RGBA_UNORM_4X4_sRGB : PFG_ASTC_RGBA_UNORM_4X4_LDR) +
+                            blockIdx );
+            }
+            return PFG_UNKNOWN;
+        }
+    }
+    //---------------------------------------------------------------------
+    KTX2Codec* KTX2Codec::msInstance = 0;
+    KTX2Transcoder* KTX2Codec::msTranscoder = 0;
+    //---------------------------------------------------------------------
+    void KTX2Codec::startup(void)
+    {
+        if( !msInstance )
+        {
+            msInstance = OGRE_NEW KTX2Codec();
+            Codec::registerCodec( msInstance );
+        }
+
+        LogManager::getSingleton().logMessage( LML_NORMAL, "KTX2 codec registering" );
+    }
+    //---------------------------------------------------------------------
+    void KTX2Codec::shutdown(void)
+    {
+        if( msInstance )
+        {
+            Codec::unregisterCodec( msInstance );
+            OGRE_DELETE msInstance;
+            msInstance = 0;
+        }
+
+        msTranscoder = 0;
+    }
+    //---------------------------------------------------------------------
+    KTX2Codec::KTX2Codec() :
+        mType( "ktx2" )
+    {
+    }
+    //---------------------------------------------------------------------
+    void KTX2Codec::setTranscoder( KTX2Transcoder *transcoder )
+    {
+        msTranscoder = transcoder;
+    }
+    //---------------------------------------------------------------------
+    KTX2Transcoder* KTX2Codec::getTranscoder(void)
+    {
+        return msTranscoder;
+    }
+    //---------------------------------------------------------------------
+    PixelFormatGpu KTX2Codec::chooseTranscodeTarget( const RenderSystemCapabilities *caps,
+                                                     bool hasAlpha, bool isSrgb )
+    {
+        PixelFormatGpu retVal = PFG_RGBA8_UNORM;
+
+        if( caps )
+        {
+            if( caps->hasCapability( RSC_TEXTURE_COMPRESSION_ASTC ) )
+                retVal = PFG_ASTC_RGBA_UNORM_4X4_LDR;
+            else if( caps->hasCapability( RSC_TEXTURE_COMPRESSION_BC6H_BC7 ) )
+                retVal = PFG_BC7_UNORM;
+            else if( caps->hasCapability( RSC_TEXTURE_COMPRESSION_DXT ) )
+                retVal = hasAlpha ? PFG_BC3_UNORM : PFG_BC1_UNORM;
+            else if( caps->hasCapability( RSC_TEXTURE_COMPRESSION_ETC2 ) )
+                retVal = hasAlpha ? PFG_ETC2_RGBA8_UNORM : PFG_ETC2_RGB8_UNORM;
+            else if( caps->hasCapability( RSC_TEXTURE_COMPRESSION_ETC1 ) && !hasAlpha )
+                retVal = PFG_ETC1_RGB8_UNORM;
+        }
+
+        if( isSrgb )
+            retVal = PixelFormatGpuUtils::getEquivalentSRGB( retVal );
+
+        return retVal;
+    }
+    //---------------------------------------------------------------------
+    DataStreamPtr KTX2Codec::encode( MemoryDataStreamPtr& input, Codec::CodecDataPtr& pData ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "KTX2 encoding not supported",
+                     "KTX2Codec::encode" );
+    }
+    //---------------------------------------------------------------------
+    void KTX2Codec::encodeToFile( MemoryDataStreamPtr& input,
+                                  const String& outFileName, Codec::CodecDataPtr& pData ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "KTX2 encoding not supported",
+                     "KTX2Codec::encodeToFile" );
+    }
+    //---------------------------------------------------------------------
+    Codec::DecodeResult KTX2Codec::decode( DataStreamPtr& stream ) const
+    {
+        KTX2Header header;
+        stream->read( &header, sizeof(KTX2Header) );
+
+        if( memcmp( KTX2FileIdentifier, &header.identifier, sizeof(KTX2FileIdentifier) ) != 0 )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "This is not a KTX2 file!", "KTX2Codec::decode" );
+        }
+
+        //KTX2 is always little endian
+        flipEndian( &header.vkFormat, sizeof(uint32), 13u );
+        flipEndian( &header.sgdByteOffset, sizeof(uint64), 2u );
+
+        const bool isBasis = header.vkFormat == 0u;
+
+        if( (!isBasis && header.supercompressionScheme != KTX2_SUPERCOMPRESSION_NONE) ||
+            (isBasis && header.supercompressionScheme > KTX2_SUPERCOMPRESSION_BASISLZ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                         "KTX2 Zstd and ZLIB supercompression are not supported",
+                         "KTX2Codec::decode" );
+        }
+
+        if( header.pixelDepth > 1u && (header.faceCount > 1u || header.layerCount >= 1u) )
+        {
+            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                         "Unsupported KTX2 format. 3D cubemaps and 3D arrays are not "
+                         "supported by Ogre",
+                         "KTX2Codec::decode" );
+        }
+
+        const uint32 numLevels = std::max( header.levelCount, 1u );
+        const uint32 numLayers = std::max( header.layerCount, 1u );
+        const uint32 numFaces = header.faceCount == 6u ? 6u : 1u;
+
+        ImageData2 *imgData = OGRE_NEW ImageData2();
+        imgData->box.width      = header.pixelWidth;
+        imgData->box.height     = std::max( header.pixelHeight, 1u );
+        imgData->box.depth      = std::max( header.pixelDepth, 1u );
+        imgData->box.numSlices  = numFaces * numLayers;
+        imgData->numMipmaps     = static_cast<uint8>( numLevels );
+
+        if( header.pixelDepth > 1u )
+            imgData->textureType = TextureTypes::Type3D;
+        else if( numFaces == 6u )
+        {
+            if( header.layerCount >= 1u )
+                imgData->textureType = TextureTypes::TypeCubeArray;
+            else
+                imgData->textureType = TextureTypes::TypeCube;
+        }
+        else if( header.layerCount >= 1u )
+            imgData->textureType = TextureTypes::Type2DArray;
+        else if( header.pixelHeight == 0u )
+            imgData->textureType = TextureTypes::Type1D;
+        else
+            imgData->textureType = TextureTypes::Type2D;
+
+        KTX2LevelIndex levelIndex[16];
+        if( numLevels > 16u )
+        {
+            OGRE_DELETE imgData;
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Invalid KTX2 file: too many mipmaps", "KTX2Codec::decode" );
+        }
+        stream->read( levelIndex, sizeof(KTX2LevelIndex) * numLevels );
+        flipEndian( levelIndex, sizeof(uint64), 3u * numLevels );
+
+        //Basis data is sent to the transcoder as a whole, so we need the whole file in memory
+        MemoryDataStreamPtr fileData;
+        const uint8 *fileDataPtr = 0;
+        size_t fileDataSize = 0;
+        bool hasAlpha = false;
+        bool isSrgb = false;
+        if( isBasis )
+        {
+            if( !msTranscoder )
+            {
+                OGRE_DELETE imgData;
+                OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                             "KTX2 file contains Basis Universal data but no transcoder has "
+                             "been set. See KTX2Codec::setTranscoder",
+                             "KTX2Codec::decode" );
+            }
+
+            //Avoid the copy if the file is already in memory (e.g. memory mapped)
+            fileDataPtr = stream->getDataView();
+            fileDataSize = stream->size();
+            if( !fileDataPtr )
+            {
+                stream->seek( 0 );
+                fileData.bind( OGRE_NEW MemoryDataStream( stream ) );
+                fileDataPtr = fileData->getPtr();
+                fileDataSize = fileData->size();
+            }
+
+            const uint8 *dfd = fileDataPtr + header.dfdByteOffset;
+            //dfdTotalSize (4 bytes) + basic descriptor block header (24 bytes) + 1 sample
+            if( header.dfdByteLength < 44u ||
+                header.dfdByteOffset + header.dfdByteLength > fileDataSize )
+            {
+                OGRE_DELETE imgData;
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Invalid KTX2 file: bad Data Format Descriptor", "KTX2Codec::decode" );
+            }
+
+            const uint8 colourModel     = dfd[12];
+            const uint8 transferFunc    = dfd[14];
+            const size_t descBlockSize  = static_cast<size_t>( dfd[10] | (dfd[11] << 8u) );
+            const size_t numSamples     = descBlockSize >= 24u ? (descBlockSize - 24u) >> 4u : 0u;
+
+            isSrgb = transferFunc == KHR_DF_TRANSFER_SRGB;
+            for( size_t i=0; i<numSamples && 28u + (i << 4u) + 3u < header.dfdByteLength; ++i )
+            {
+                const uint8 channelId = dfd[28u + (i << 4u) + 3u] & 0x0Fu;
+                if( colourModel == KHR_DF_MODEL_ETC1S )
+                    hasAlpha |= channelId == KHR_DF_CHANNEL_ETC1S_AAA;
+                else if( colourModel == KHR_DF_MODEL_UASTC )
+                {
+                    hasAlpha |= channelId == KHR_DF_CHANNEL_UASTC_RGBA ||
+                                channelId == KHR_DF_CHANNEL_UASTC_RRRG;
+                }
+            }
+
+            const RenderSystem *renderSystem = Root::getSingletonPtr() ?
+                                                   Root::getSingleton().getRenderSystem() : 0;
+            imgData->format = chooseTranscodeTarget( renderSystem ?
+                                                         renderSystem->getCapabilities() : 0,
+                                                     hasAlpha, isSrgb );
+        }
+        else
+        {
+            imgData->format = vkFormatToPixelFormatGpu( header.vkFormat );
+            if( imgData->format == PFG_UNKNOWN )
+            {
+                OGRE_DELETE imgData;
+                OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                             "Unsupported KTX2 vkFormat " +
+                             StringConverter::toString( header.vkFormat ),
+                             "KTX2Codec::decode" );
+            }
+        }
+
+        if( PixelFormatGpuUtils::isCompressed( imgData->format ) )
+            imgData->box.setCompressedPixelFormat( imgData->format );
+
+        const uint32 rowAlignment = 4u;
+        imgData->box.bytesPerPixel  = PixelFormatGpuUtils::getBytesPerPixel( imgData->format );
+        imgData->box.bytesPerRow    = PixelFormatGpuUtils::getSizeBytes( imgData->box.width,
+                                                                         1u, 1u, 1u,
+                                                                         imgData->format,
+                                                                         rowAlignment );
+        imgData->box.bytesPerImage  = PixelFormatGpuUtils::getSizeBytes( imgData->box.width,
+                                                                         imgData->box.height,
+                                                                         1u, 1u,
+                                                                         imgData->format,
+                                                                         rowAlignment );
+        const size_t requiredBytes = PixelFormatGpuUtils::calculateSizeBytes( imgData->box.width,
+                                                                              imgData->box.height,
+                                                                              imgData->box.depth,
+                                                                              imgData->box.numSlices,
+                                                                              imgData->format,
+                                                                              imgData->numMipmaps,
+                                                                              rowAlignment );
+        // Bind output buffer
+        imgData->box.data = OGRE_MALLOC_SIMD( requiredBytes, MEMCATEGORY_RESOURCE );
+
+        Image2 image;
+        image.loadDynamicImage( imgData->box.data, imgData->box.width, imgData->box.height,
+                                imgData->box.getDepthOrSlices(), imgData->textureType, imgData->format,
+                                false, imgData->numMipmaps );
+
+        if( isBasis )
+        {
+            void *context = msTranscoder->beginFile( fileDataPtr, fileDataSize );
+            bool success = context != 0;
+
+            for( uint32 level=0; level<numLevels && success; ++level )
+            {
+                TextureBox dstBox = image.getData( static_cast<uint8>( level ) );
+                for( uint32 layer=0; layer<numLayers && success; ++layer )
+                {
+                    for( uint32 face=0; face<numFaces && success; ++face )
+                    {
+                        success = msTranscoder->transcode( context, level, layer, face,
+                                                           imgData->format,
+                                                           dstBox.at( 0, 0, layer * numFaces + face ),
+                                                           dstBox.bytesPerImage );
+                    }
+                }
+            }
+
+            if( context )
+                msTranscoder->endFile( context );
+
+            if( !success )
+            {
+                OGRE_FREE_SIMD( imgData->box.data, MEMCATEGORY_RESOURCE );
+                imgData->box.data = 0;
+                OGRE_DELETE imgData;
+                OGRE_EXCEPT( Exception::ERR_RENDERINGAPI_ERROR,
+                             "Failed to transcode KTX2 Basis Universal data",
+                             "KTX2Codec::decode" );
+            }
+        }
+        else
+        {
+            for( uint32 level=0; level<numLevels; ++level )
+            {
+                TextureBox dstBox = image.getData( static_cast<uint8>( level ) );
+                //KTX2 rows are tightly packed
+                const size_t srcBytesPerRow = PixelFormatGpuUtils::getSizeBytes(
+                                                  dstBox.width, 1u, 1u, 1u, imgData->format, 1u );
+                const size_t srcBytes = PixelFormatGpuUtils::getSizeBytes(
+                                            dstBox.width, dstBox.height, dstBox.depth,
+                                            dstBox.numSlices, imgData->format, 1u );
+
+                if( levelIndex[level].byteLength < srcBytes )
+                {
+                    OGRE_FREE_SIMD( imgData->box.data, MEMCATEGORY_RESOURCE );
+                    imgData->box.data = 0;
+                    OGRE_DELETE imgData;
+                    OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                                 "Invalid KTX2 file: mipmap level is too small",
+                                 "KTX2Codec::decode" );
+                }
+
+                stream->seek( static_cast<size_t>( levelIndex[level].byteOffset ) );
+
+                if( PixelFormatGpuUtils::isCompressed( imgData->format ) ||
+                    srcBytesPerRow == dstBox.bytesPerRow )
+                {
+                    stream->read( dstBox.data, srcBytes );
+                }
+                else
+                {
+                    uint8 *dstPtr = reinterpret_cast<uint8*>( dstBox.data );
+                    const size_t numRows = dstBox.height * dstBox.getDepthOrSlices();
+                    for( size_t y=0; y<numRows; ++y )
+                    {
+                        stream->read( dstPtr, srcBytesPerRow );
+                        dstPtr += dstBox.bytesPerRow;
+                    }
+                }
+            }
+        }
+
+        DecodeResult ret;
+        ret.first.reset();
+        ret.second = CodecDataPtr( imgData );
+
+        return ret;
+    }
+    //---------------------------------------------------------------------
+    String KTX2Codec::getType() const
+    {
+        return mType;
+    }
+    //---------------------------------------------------------------------
+    void KTX2Codec::flipEndian( void *pData, size_t size, size_t count )
+    {
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+        Bitwise::bswapChunks( pData, size, count );
+#endif
+    }
+    //---------------------------------------------------------------------
+    String KTX2Codec::magicNumberToFileExt( const char *magicNumberPtr, size_t maxbytes ) const
+    {
+        if( maxbytes >= sizeof(KTX2FileIdentifier) &&
+            memcmp( KTX2FileIdentifier, magicNumberPtr, sizeof(KTX2FileIdentifier) ) == 0 )
+        {
+            return String( "ktx2" );
+        }
+
+        return BLANKSTRING;
+    }
+}
@@ -93,6 +93,7 @@ namespace Ogre {
         case LT_DIRECTIONAL:
             mObjectData.mLocalAabb->setFromAabb( Aabb::BOX_INFINITE, mObjectData.mIndex );
             mObjectData.mLocalRadius[mObjectData.mIndex] = std::numeric_limits<Real>::infinity();
+            mObjectData.invalidateBounds();
             if( mAffectParentNode )
                 mParentNode->setScale( Vector3::UNIT_SCALE );
             break;
@@ -229,6 +230,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void Light::resetAabb()
     {
+        mObjectData.invalidateBounds();
         mObjectData.mLocalRadius[mObjectData.mIndex] = 1.0f;
         if( mLightType == LT_POINT || mLightType == LT_VPL )
         {
@@ -260,6 +262,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void Light::updateLightBounds(void)
     {
+        mObjectData.invalidateBounds();
         if( mLightType == LT_POINT || mLightType == LT_VPL )
         {
             if( !mAffectParentNode )
@@ -0,0 +1,319 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreLoadProfiler.h"
+#include "OgreTimer.h"
+#include "OgreLwString.h"
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+
+namespace Ogre
+{
+    static const char *c_loadEventNames[LoadEvent::NumLoadEvents] =
+    {
+        "ArchiveRead",
+        "TextureDecode",
+        "MeshLoad",
+        "ShaderCompile",
+        "PsoCreation",
+        "StreamingWait"
+    };
+
+    struct OrderEventByTimeTakenDesc
+    {
+        const LoadProfiler::EventVec &events;
+        OrderEventByTimeTakenDesc( const LoadProfiler::EventVec &_events ) : events( _events ) {}
+
+        bool operator () ( size_t a, size_t b ) const
+        {
+            return events[a].usTaken > events[b].usTaken;
+        }
+    };
+    struct OrderEventByStart
+    {
+        const LoadProfiler::EventVec &events;
+        OrderEventByStart( const LoadProfiler::EventVec &_events ) : events( _events ) {}
+
+        bool operator () ( size_t a, size_t b ) const
+        {
+            //Parents start before (or with) their children; and end after them
+            if( events[a].usStart != events[b].usStart )
+                return events[a].usStart < events[b].usStart;
+            return events[a].usTaken > events[b].usTaken;
+        }
+    };
+
+    static float toMs( uint64 us )
+    {
+        return static_cast<float>( us ) * 0.001f;
+    }
+    //-----------------------------------------------------------------------------------
+    static void appendEvent( String &outReport, LwString &tmpStr,
+                             const LoadProfiler::Event &event )
+    {
+        tmpStr.clear();
+        tmpStr.a( "  ", LwString::Float( toMs( event.usTaken ), 2, 10 ), " ms  ",
+                  LoadProfiler::getEventName( event.type ) );
+        tmpStr.a( event.mainThread ? " [main] " : " [worker] " );
+        outReport += tmpStr.c_str();
+        outReport += event.name;
+        if( event.bytes )
+        {
+            tmpStr.clear();
+            tmpStr.a( " (", LwString::Float( static_cast<float>( event.bytes ) /
+                                             (1024.0f * 1024.0f), 2 ), " MiB)" );
+            outReport += tmpStr.c_str();
+        }
+        outReport += "\n";
+    }
+    //-----------------------------------------------------------------------------------
+    LoadProfiler::LoadProfiler() :
+        mEnabled( false ),
+        mTimer( OGRE_NEW Timer() ),
+        mTlsHandle( OGRE_TLS_INVALID_HANDLE )
+    {
+        //Mark the thread creating us as the main one
+        if( Threads::CreateTls( &mTlsHandle ) )
+            Threads::SetTls( mTlsHandle, this );
+    }
+    //-----------------------------------------------------------------------------------
+    LoadProfiler::~LoadProfiler()
+    {
+        if( mTlsHandle != OGRE_TLS_INVALID_HANDLE )
+        {
+            Threads::DestroyTls( mTlsHandle );
+            mTlsHandle = OGRE_TLS_INVALID_HANDLE;
+        }
+
+        OGRE_DELETE mTimer;
+        mTimer = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void LoadProfiler::setEnabled( bool bEnabled )
+    {
+        mEnabled = bEnabled;
+    }
+    //-----------------------------------------------------------------------------------
+    void LoadProfiler::reset(void)
+    {
+        mMutex.lock();
+        mEvents.clear();
+        mMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 LoadProfiler::getMicroseconds(void) const
+    {
+        return mTimer->getMicroseconds();
+    }
+    //-----------------------------------------------------------------------------------
+    void LoadProfiler::addEvent( LoadEvent::LoadEvent type, const String &name, uint64 bytes,
+                                 uint64 usStart, uint64 usTaken )
+    {
+        Event event;
+        event.type      = type;
+        event.mainThread= mTlsHandle != OGRE_TLS_INVALID_HANDLE &&
+                          Threads::GetTls( mTlsHandle ) == this;
+        event.name      = name;
+        event.bytes     = bytes;
+        event.usStart   = usStart;
+        event.usTaken   = usTaken;
+
+        mMutex.lock();
+        mEvents.push_back( event );
+        mMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    void LoadProfiler::getEvents( EventVec &outEvents )
+    {
+        mMutex.lock();
+        outEvents = mEvents;
+        mMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    void LoadProfiler::generateReport( String &outReport, size_t maxEntries )
+    {
+        EventVec events;
+        getEvents( events );
+
+        char tmpBuffer[256];
+        LwString tmpStr( LwString::FromEmptyPointer( tmpBuffer, sizeof( tmpBuffer ) ) );
+
+        uint64 usFirstStart = std::numeric_limits<uint64>::max();
+        uint64 usLastEnd = 0;
+
+        uint64 totalTime[LoadEvent::NumLoadEvents][2];
+        uint64 totalBytes[LoadEvent::NumLoadEvents][2];
+        size_t numEvents[LoadEvent::NumLoadEvents][2];
+        memset( totalTime, 0, sizeof( totalTime ) );
+        memset( totalBytes, 0, sizeof( totalBytes ) );
+        memset( numEvents, 0, sizeof( numEvents ) );
+
+        vector<size_t>::type sortedEvents;
+        sortedEvents.reserve( events.size() );
+
+        for( size_t i=0; i<events.size(); ++i )
+        {
+            const Event &event = events[i];
+            const size_t threadType = event.mainThread ? 0u : 1u;
+            totalTime[event.type][threadType]   += event.usTaken;
+            totalBytes[event.type][threadType]  += event.bytes;
+            ++numEvents[event.type][threadType];
+
+            usFirstStart = std::min( usFirstStart, event.usStart );
+            usLastEnd = std::max( usLastEnd, event.usStart + event.usTaken );
+            sortedEvents.push_back( i );
+        }
+
+        const uint64 usWallTime = events.empty() ? 0 : (usLastEnd - usFirstStart);
+
+        tmpStr.clear();
+        tmpStr.a( "Load profile: ", static_cast<uint32>( events.size() ), " events over ",
+                  LwString::Float( toMs( usWallTime ), 2 ), " ms\n\n" );
+        outReport += tmpStr.c_str();
+
+        outReport += "Totals (main thread | other threads):\n";
+        for( size_t i=0; i<LoadEvent::NumLoadEvents; ++i )
+        {
+            if( !numEvents[i][0] && !numEvents[i][1] )
+                continue;
+
+            tmpStr.clear();
+            tmpStr.a( "  ", c_loadEventNames[i], ": " );
+            tmpStr.a( LwString::Float( toMs( totalTime[i][0] ), 2 ), " ms in ",
+                      static_cast<uint32>( numEvents[i][0] ), " events, ",
+                      static_cast<uint32>( totalBytes[i][0] / 1024u ), " KiB | " );
+            tmpStr.a( LwString::Float( toMs( totalTime[i][1] ), 2 ), " ms in ",
+                      static_cast<uint32>( numEvents[i][1] ), " events, ",
+                      static_cast<uint32>( totalBytes[i][1] / 1024u ), " KiB\n" );
+            outReport += tmpStr.c_str();
+        }
+
+        std::sort( sortedEvents.begin(), sortedEvents.end(), OrderEventByTimeTakenDesc( events ) );
+
+        outReport += "\nWorst offenders:\n";
+        for( size_t i=0; i<std::min( maxEntries, sortedEvents.size() ); ++i )
+            appendEvent( outReport, tmpStr, events[sortedEvents[i]] );
+
+        //Critical path. Events from the same thread are either disjoint or nested
+        //(they come from scopes); the top level ones are what the main thread was doing.
+        std::sort( sortedEvents.begin(), sortedEvents.end(), OrderEventByStart( events ) );
+
+        vector<size_t>::type criticalPath;
+        uint64 usCriticalPathTime = 0;
+        uint64 usCurrentEnd = 0;
+        uint64 criticalPathTime[LoadEvent::NumLoadEvents];
+        memset( criticalPathTime, 0, sizeof( criticalPathTime ) );
+
+        for( size_t i=0; i<sortedEvents.size(); ++i )
+        {
+            const Event &event = events[sortedEvents[i]];
+            if( event.mainThread && event.usStart >= usCurrentEnd )
+            {
+                criticalPath.push_back( sortedEvents[i] );
+                usCriticalPathTime += event.usTaken;
+                criticalPathTime[event.type] += event.usTaken;
+                usCurrentEnd = event.usStart + event.usTaken;
+            }
+        }
+
+        tmpStr.clear();
+        tmpStr.a( "\nCritical path (main thread): ", LwString::Float( toMs( usCriticalPathTime ), 2 ),
+                  " ms of ", LwString::Float( toMs( usWallTime ), 2 ),
+                  " ms were spent in recorded events\n" );
+        outReport += tmpStr.c_str();
+        for( size_t i=0; i<LoadEvent::NumLoadEvents; ++i )
+        {
+            if( criticalPathTime[i] )
+            {
+                tmpStr.clear();
+                tmpStr.a( "  ", c_loadEventNames[i], ": ",
+                          LwString::Float( toMs( criticalPathTime[i] ), 2 ), " ms\n" );
+                outReport += tmpStr.c_str();
+            }
+        }
+
+        //Show the longest steps of the critical path, but in chronological order
+        if( criticalPath.size() > maxEntries )
+        {
+            std::sort( criticalPath.begin(), criticalPath.end(), OrderEventByTimeTakenDesc( events ) );
+            criticalPath.resize( maxEntries );
+            std::sort( criticalPath.begin(), criticalPath.end(), OrderEventByStart( events ) );
+        }
+
+        outReport += "Longest steps, in order:\n";
+        for( size_t i=0; i<criticalPath.size(); ++i )
+        {
+            const Event &event = events[criticalPath[i]];
+            tmpStr.clear();
+            tmpStr.a( "  @", LwString::Float( toMs( event.usStart - usFirstStart ), 2 ), " ms" );
+            outReport += tmpStr.c_str();
+            appendEvent( outReport, tmpStr, event );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void LoadProfiler::logReport( size_t maxEntries )
+    {
+        String report;
+        generateReport( report, maxEntries );
+        LogManager::getSingleton().logMessage( report, LML_CRITICAL );
+    }
+    //-----------------------------------------------------------------------------------
+    const char* LoadProfiler::getEventName( LoadEvent::LoadEvent type )
+    {
+        return c_loadEventNames[type];
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    LoadProfiler::Scope::Scope( LoadEvent::LoadEvent type, const String &name ) :
+        mLoadProfiler( 0 ),
+        mType( type ),
+        mBytes( 0 ),
+        mUsStart( 0 )
+    {
+        Root *root = Root::getSingletonPtr();
+        LoadProfiler *loadProfiler = root ? root->getLoadProfiler() : 0;
+        if( loadProfiler && loadProfiler->getEnabled() )
+        {
+            mLoadProfiler = loadProfiler;
+            mName = name;
+            mUsStart = mLoadProfiler->getMicroseconds();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    LoadProfiler::Scope::~Scope()
+    {
+        if( mLoadProfiler )
+        {
+            mLoadProfiler->addEvent( mType, mName, mBytes, mUsStart,
+                                     mLoadProfiler->getMicroseconds() - mUsStart );
+        }
+    }
+}
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreCamera.h"
 
 namespace Ogre {
+    uint32 LodStrategy::msLodValuesGeneration = 0;
     //-----------------------------------------------------------------------
     LodStrategy::LodStrategy(const String& name)
         : mName(name)
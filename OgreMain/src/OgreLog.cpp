@@ -28,6 +28,9 @@ THE SOFTWARE.
 #include "OgreStableHeaders.h"
 
 #include "OgreLog.h"
+#include "OgreStringConverter.h"
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreWaitableEvent.h"
 #include <iomanip>
 #include <iostream>
 
@@ -48,11 +51,47 @@ namespace Ogre
 #if OGRE_PLATFORM == OGRE_PLATFORM_NACL
     pp::Instance* Log::mInstance = NULL;    
 #endif
+
+    struct Log::AsyncWriter
+    {
+        struct Message
+        {
+            String          message;
+            time_t          ctTime;
+            LogMessageLevel lml;
+            bool            maskDebug;
+        };
+        typedef vector<Message>::type MessageVec;
+
+        //Protected by Log::mAsyncMutex, which is never held while writing
+        MessageVec          queue;
+        size_t              queuedBytes;
+        size_t              maxQueuedBytes;
+        uint32              numDropped;
+        bool                stop;
+
+        WaitableEvent       event;
+        ThreadHandlePtr     thread;
+
+        AsyncWriter( size_t _maxQueuedBytes ) :
+            queuedBytes( 0 ), maxQueuedBytes( _maxQueuedBytes ), numDropped( 0 ), stop( false )
+        {
+        }
+    };
+
+    unsigned long logAsyncWriterThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::Background );
+        Log *log = reinterpret_cast<Log*>( threadHandle->getUserParam() );
+        log->_asyncWriterThread();
+        return 0;
+    }
+    THREAD_DECLARE( logAsyncWriterThread );
     
     //-----------------------------------------------------------------------
     Log::Log( const String& name, bool debuggerOuput, bool suppressFile ) : 
         mLogLevel(LL_NORMAL), mDebugOut(debuggerOuput),
-        mSuppressFile(suppressFile), mTimeStamp(true), mLogName(name)
+        mSuppressFile(suppressFile), mTimeStamp(true), mLogName(name), mAsyncWriter(0)
     {
         if (!mSuppressFile)
         {
@@ -63,6 +102,8 @@ namespace Ogre
     //-----------------------------------------------------------------------
     Log::~Log()
     {
+        setAsync( false );
+
         ScopedLock scopedLock( mMutex );
         if (!mSuppressFile)
         {
@@ -73,7 +114,41 @@ namespace Ogre
     //-----------------------------------------------------------------------
     void Log::logMessage( const String& message, LogMessageLevel lml, bool maskDebug )
     {
+        {
+            ScopedLock asyncLock( mAsyncMutex );
+            //Once stopping, messages (e.g. from listeners during the last batch)
+            //are written synchronously; the writer won't pick them up anymore.
+            if( mAsyncWriter && !mAsyncWriter->stop )
+            {
+                if( (mLogLevel + lml) < OGRE_LOG_THRESHOLD )
+                    return;
+
+                if( mAsyncWriter->maxQueuedBytes && lml != LML_CRITICAL &&
+                    mAsyncWriter->queuedBytes + message.size() > mAsyncWriter->maxQueuedBytes )
+                {
+                    ++mAsyncWriter->numDropped;
+                    return;
+                }
+
+                mAsyncWriter->queue.push_back( AsyncWriter::Message() );
+                AsyncWriter::Message &queuedMsg = mAsyncWriter->queue.back();
+                queuedMsg.message   = message;
+                queuedMsg.ctTime    = time( 0 );
+                queuedMsg.lml       = lml;
+                queuedMsg.maskDebug = maskDebug;
+                mAsyncWriter->queuedBytes += message.size();
+                mAsyncWriter->event.wake();
+                return;
+            }
+        }
+
         ScopedLock scopedLock( mMutex );
+        writeMessage( message, lml, maskDebug, time( 0 ), true );
+    }
+    //-----------------------------------------------------------------------
+    void Log::writeMessage( const String &message, LogMessageLevel lml, bool maskDebug,
+                            time_t ctTime, bool flush )
+    {
         if ((mLogLevel + lml) >= OGRE_LOG_THRESHOLD)
         {
             bool skipThisMessage = false;
@@ -114,22 +189,104 @@ namespace Ogre
                     if (mTimeStamp)
                     {
                         struct tm *pTime;
-                        time_t ctTime; time(&ctTime);
                         pTime = localtime( &ctTime );
                         *mLog << std::setw(2) << std::setfill('0') << pTime->tm_hour
                             << ":" << std::setw(2) << std::setfill('0') << pTime->tm_min
                             << ":" << std::setw(2) << std::setfill('0') << pTime->tm_sec
                             << ": ";
                     }
-                    *mLog << message << std::endl;
+                    *mLog << message << '\n';
 
                     // Flush stcmdream to ensure it is written (incase of a crash, we need log to be up to date)
-                    mLog->flush();
+                    if( flush )
+                        mLog->flush();
                 }
             }
         }
     }
-    
+    //-----------------------------------------------------------------------
+    void Log::setAsync( bool bAsync, size_t maxQueuedBytes )
+    {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( bAsync )
+        {
+            ScopedLock asyncLock( mAsyncMutex );
+            if( !mAsyncWriter )
+            {
+                mAsyncWriter = new AsyncWriter( maxQueuedBytes );
+                mAsyncWriter->thread =
+                        Threads::CreateThread( THREAD_GET( logAsyncWriterThread ), 0, this );
+            }
+            else
+            {
+                mAsyncWriter->maxQueuedBytes = maxQueuedBytes;
+            }
+        }
+        else
+        {
+            AsyncWriter *asyncWriter;
+            {
+                ScopedLock asyncLock( mAsyncMutex );
+                asyncWriter = mAsyncWriter;
+                if( !asyncWriter )
+                    return;
+                asyncWriter->stop = true;
+            }
+            asyncWriter->event.wake();
+            Threads::WaitForThreads( 1u, &asyncWriter->thread );
+
+            {
+                //Other threads may be checking mAsyncWriter->stop in logMessage
+                ScopedLock asyncLock( mAsyncMutex );
+                mAsyncWriter = 0;
+            }
+            delete asyncWriter;
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------
+    void Log::_asyncWriterThread(void)
+    {
+        AsyncWriter::MessageVec batch;
+        bool stop = false;
+
+        while( !stop )
+        {
+            mAsyncWriter->event.wait();
+
+            uint32 numDropped;
+            {
+                ScopedLock asyncLock( mAsyncMutex );
+                batch.swap( mAsyncWriter->queue );
+                numDropped = mAsyncWriter->numDropped;
+                mAsyncWriter->queuedBytes = 0;
+                mAsyncWriter->numDropped = 0;
+                stop = mAsyncWriter->stop;
+            }
+
+            ScopedLock scopedLock( mMutex );
+
+            AsyncWriter::MessageVec::const_iterator itor = batch.begin();
+            AsyncWriter::MessageVec::const_iterator end  = batch.end();
+            while( itor != end )
+            {
+                writeMessage( itor->message, itor->lml, itor->maskDebug, itor->ctTime, false );
+                ++itor;
+            }
+
+            if( numDropped )
+            {
+                writeMessage( "WARNING: Log queue full. " + StringConverter::toString( numDropped ) +
+                              " message(s) were dropped", LML_CRITICAL, false, time( 0 ), false );
+            }
+
+            if( !mSuppressFile && ( !batch.empty() || numDropped ) )
+                mLog->flush();
+
+            batch.clear();
+        }
+    }
+
     //-----------------------------------------------------------------------
     void Log::setTimeStampEnabled(bool timeStamp)
     {
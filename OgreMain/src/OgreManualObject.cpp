@@ -78,6 +78,7 @@ namespace v1 {
         mObjectData.mLocalRadius[mObjectData.mIndex] = 0.0f;
 
         mObjectData.mLocalAabb->setFromAabb( Aabb::BOX_NULL, mObjectData.mIndex );
+        mObjectData.invalidateBounds();
 
         OGRE_DELETE mEdgeList;
         mEdgeList = 0;
@@ -281,6 +282,7 @@ namespace v1 {
         mObjectData.mLocalRadius[mObjectData.mIndex] = Ogre::max(
                                                             mObjectData.mLocalRadius[mObjectData.mIndex],
                                                             mTempVertex.position.length());
+        mObjectData.invalidateBounds();
 
         // reset current texture coord
         mTexCoordIndex = 0;
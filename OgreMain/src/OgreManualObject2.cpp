@@ -50,6 +50,8 @@ namespace Ogre {
         : MovableObject( id, objectMemoryManager, manager, 10u ),
           mCurrentSection(0),
           mCurrentUpdating(false),
+          mDeclarationFixed(false),
+          mMaxUpdateVertices(0), mMaxUpdateIndices(0),
           mVertices(0), mIndices(0),
           mEstimatedVertices(0), mEstimatedIndices(0),
           mTempVertexBuffer(0), mTempVertexBufferSize(TEMP_INITIAL_VERTEX_SIZE),
@@ -79,6 +81,7 @@ namespace Ogre {
 
         mObjectData.mLocalRadius[mObjectData.mIndex] = 0.0f;
         mObjectData.mLocalAabb->setFromAabb( Aabb::BOX_NULL, mObjectData.mIndex );
+        mObjectData.invalidateBounds();
 
         mRenderables.clear();
 
@@ -102,7 +105,7 @@ namespace Ogre {
         // Calculate byte size
         // Use decl if we know it by now, otherwise default size to pos/norm/texcoord*2
         size_t newSize;
-        if (mVertices > 0)
+        if (mVertices > 0 || mDeclarationFixed)
         {
             newSize = mDeclSize * numVerts;
         }
@@ -194,6 +197,7 @@ namespace Ogre {
         mCurrentSection->mVaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
 
         mCurrentUpdating = false;
+        mDeclarationFixed = false;
 
         mSectionList.push_back(mCurrentSection);
 
@@ -212,36 +216,216 @@ namespace Ogre {
         mIndexBuffer = mIndexBufferCursor = mTempIndexBuffer;
     }
     //-----------------------------------------------------------------------------
+    void ManualObject::begin(const String & datablockName, const VertexElement2Vec &vertexElements,
+                             OperationType opType)
+    {
+        VertexElement2Vec::const_iterator itor = vertexElements.begin();
+        VertexElement2Vec::const_iterator end  = vertexElements.end();
+
+        while (itor != end && itor->mSemantic != VES_POSITION)
+            ++itor;
+
+        if (itor == end || itor->mType != VET_FLOAT3)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "The vertex elements must have a VES_POSITION of type VET_FLOAT3",
+                "ManualObject::begin");
+        }
+
+        begin(datablockName, opType);
+
+        mCurrentSection->mVertexElements = vertexElements;
+        mDeclSize = VaoManager::calculateVertexSize(vertexElements);
+        mDeclarationFixed = true;
+
+        // Now that we know the real vertex size
+        resizeVertexBufferIfNeeded(mEstimatedVertices);
+    }
+    //-----------------------------------------------------------------------------
     void ManualObject::beginUpdate(size_t sectionIndex)
+    {
+        beginUpdateImpl(sectionIndex, 0, 0, false, "ManualObject::beginUpdate");
+    }
+    //-----------------------------------------------------------------------------
+    void ManualObject::beginUpdate(size_t sectionIndex, size_t numVertices, size_t numIndices)
+    {
+        beginUpdateImpl(sectionIndex, numVertices, numIndices, false, "ManualObject::beginUpdate");
+    }
+    //-----------------------------------------------------------------------------
+    bool ManualObject::tryBeginUpdate(size_t sectionIndex, size_t numVertices, size_t numIndices)
+    {
+        return beginUpdateImpl(sectionIndex, numVertices, numIndices, true,
+                               "ManualObject::tryBeginUpdate");
+    }
+    //-----------------------------------------------------------------------------
+    bool ManualObject::beginUpdateImpl(size_t sectionIndex, size_t numVertices, size_t numIndices,
+                                       bool nonBlocking, const char *funcName)
     {
         if (mCurrentSection)
         {
             OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
                 "You cannot call begin() again until after you call end()",
-                "ManualObject::beginUpdate");
+                funcName);
         }
 
         if (sectionIndex >= mSectionList.size())
         {
             OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
                 "Invalid section index - out of range.",
-                "ManualObject::beginUpdate");
+                funcName);
+        }
+
+        ManualObjectSection *section = mSectionList[sectionIndex];
+
+        if (!section->mVao)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+                "Can't update a section that was defined without geometry",
+                funcName);
         }
 
-        mCurrentSection = mSectionList[sectionIndex];
+        VaoManager *vaoManager = section->mVaoManager;
+
+        // Mapping a dynamic buffer waits for the GPU to be done with the oldest frame
+        if (nonBlocking &&
+            !vaoManager->isFrameFinished(vaoManager->getFrameCount() -
+                                         vaoManager->getDynamicBufferMultiplier()))
+        {
+            return false;
+        }
+
+        VertexBufferPacked * vertexBuffer = section->mVao->getVertexBuffers()[0];
+        IndexBufferPacked * indexBuffer = section->mVao->getIndexBuffer();
+
+        bool buffersRecreated = false;
+        if (numVertices > vertexBuffer->getNumElements() ||
+            numIndices > indexBuffer->getNumElements())
+        {
+            // Doesn't fit. Recreate the buffers, with some room to grow
+            numVertices = std::max(numVertices, vertexBuffer->getNumElements());
+            numIndices = std::max(numIndices, indexBuffer->getNumElements());
+            numVertices += numVertices >> 1u;
+            numIndices += numIndices >> 1u;
+
+            section->clear();
+            if (numVertices > 65536u)
+                section->m32BitIndices = true;
+            section->createBuffers(numVertices, numIndices);
+
+            vertexBuffer = section->mVao->getVertexBuffers()[0];
+            indexBuffer = section->mVao->getIndexBuffer();
+            buffersRecreated = true;
+        }
+
+        mCurrentSection = section;
 
         mCurrentUpdating = true;
+        mDeclarationFixed = true;
+        mDeclSize = VaoManager::calculateVertexSize(section->mVertexElements);
 
         mVertices = 0;
         mIndices = 0;
+        mMaxUpdateVertices = vertexBuffer->getNumElements();
+        mMaxUpdateIndices = indexBuffer->getNumElements();
 
-        VertexBufferPacked * vertexBuffer = mCurrentSection->mVao->getVertexBuffers()[0];
-        IndexBufferPacked * indexBuffer = mCurrentSection->mVao->getIndexBuffer();
+        // Bounds are recalculated from what gets written
+        section->mAabb = Aabb::BOX_NULL;
 
         mVertexBuffer = mVertexBufferCursor = static_cast<float *>(vertexBuffer->map(0, vertexBuffer->getNumElements()));
+        mIndexBuffer = mIndexBufferCursor = 0;
+
+        // Fresh buffers have no indices worth keeping
+        if (buffersRecreated)
+            mapIndexBufferForUpdate();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------
+    void ManualObject::mapIndexBufferForUpdate(void)
+    {
+        IndexBufferPacked * indexBuffer = mCurrentSection->mVao->getIndexBuffer();
         mIndexBuffer = mIndexBufferCursor = static_cast<char *>(indexBuffer->map(0, indexBuffer->getNumElements()));
     }
     //-----------------------------------------------------------------------------
+    float* ManualObject::advanceVertexCursor(size_t numVertices, const char *funcName)
+    {
+        if (!mCurrentSection)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "You must call begin() before this method",
+                funcName);
+        }
+
+        if (!mDeclarationFixed && !mVertices)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
+                "The vertex layout isn't known yet. Pass the vertex elements to begin(), "
+                "or define the first vertex with position() & co.",
+                funcName);
+        }
+
+        if (mCurrentUpdating)
+        {
+            if (mVertices + numVertices > mMaxUpdateVertices)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                    "Writing more vertices than the section can hold. "
+                    "Use beginUpdate( sectionIndex, numVertices, numIndices )",
+                    funcName);
+            }
+        }
+        else
+        {
+            resizeVertexBufferIfNeeded(mVertices + numVertices);
+        }
+
+        float *retVal = mVertexBufferCursor;
+        mVertexBufferCursor = reinterpret_cast<float*>(
+                    reinterpret_cast<char*>(mVertexBufferCursor) + numVertices * mDeclSize);
+        mVertices += numVertices;
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------
+    char* ManualObject::advanceIndexCursor(size_t numIndices, const char *funcName)
+    {
+        if (!mCurrentSection)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "You must call begin() before this method",
+                funcName);
+        }
+
+        size_t indexSize = sizeof(uint32);
+
+        if (mCurrentUpdating)
+        {
+            if (!mIndexBuffer)
+                mapIndexBufferForUpdate();
+
+            if (mIndices + numIndices > mMaxUpdateIndices)
+            {
+                OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                    "Writing more indices than the section can hold. "
+                    "Use beginUpdate( sectionIndex, numVertices, numIndices )",
+                    funcName);
+            }
+
+            if (!mCurrentSection->m32BitIndices)
+                indexSize = sizeof(uint16);
+        }
+        else
+        {
+            resizeIndexBufferIfNeeded(mIndices + numIndices);
+        }
+
+        char *retVal = mIndexBufferCursor;
+        mIndexBufferCursor += numIndices * indexSize;
+        mIndices += numIndices;
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------
     void ManualObject::position(const Vector3& pos)
     {
         position(pos.x, pos.y, pos.z);
@@ -260,7 +444,7 @@ namespace Ogre {
         // If updating section, no need to declare elements or resize buffers
         if (!mCurrentUpdating)
         {
-            if (mVertices == 0)
+            if (mVertices == 0 && !mDeclarationFixed)
             {
                 // defining declaration
                 VertexElement2 positionElement(VET_FLOAT3, VES_POSITION);
@@ -274,6 +458,13 @@ namespace Ogre {
                 resizeVertexBufferIfNeeded(mVertices + 1);
             }
         }
+        else if (mVertices >= mMaxUpdateVertices)
+        {
+            OGRE_EXCEPT(Exception::ERR_INVALIDPARAMS,
+                "Writing more vertices than the section can hold. "
+                "Use beginUpdate( sectionIndex, numVertices, numIndices )",
+                "ManualObject::position");
+        }
 
         *mVertexBufferCursor++ = x;
         *mVertexBufferCursor++ = y;
@@ -300,7 +491,7 @@ namespace Ogre {
 
         // First time a normal is being added
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 normalElement(VET_FLOAT3, VES_NORMAL);
@@ -330,7 +521,7 @@ namespace Ogre {
 
         // First time a tangent is being added
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 tangentElement(VET_FLOAT3, VES_TANGENT);
@@ -354,7 +545,7 @@ namespace Ogre {
         }
 
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 texCoordElement(VET_FLOAT1, VES_TEXTURE_COORDINATES);
@@ -376,7 +567,7 @@ namespace Ogre {
         }
 
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 texCoordElement(VET_FLOAT2, VES_TEXTURE_COORDINATES);
@@ -399,7 +590,7 @@ namespace Ogre {
         }
 
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 texCoordElement(VET_FLOAT3, VES_TEXTURE_COORDINATES);
@@ -423,7 +614,7 @@ namespace Ogre {
         }
 
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 texCoordElement(VET_FLOAT4, VES_TEXTURE_COORDINATES);
@@ -468,7 +659,7 @@ namespace Ogre {
         }
 
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 colorElement(VET_FLOAT4, VES_DIFFUSE);
@@ -499,7 +690,7 @@ namespace Ogre {
         }
 
         if (mVertices == 1 &&
-            !mCurrentUpdating)
+            !mDeclarationFixed)
         {
             // defining declaration
             VertexElement2 colorElement(VET_COLOUR, VES_SPECULAR);
@@ -523,28 +714,23 @@ namespace Ogre {
                 "ManualObject::index");
         }
 
+        char *dst = advanceIndexCursor(1u, "ManualObject::index");
+
         if (!mCurrentUpdating)
         {
             if (idx >= 65536)
                 mCurrentSection->m32BitIndices = true;
 
-            resizeIndexBufferIfNeeded(mIndices + 1);
-
-            *((uint32 *)mIndexBufferCursor) = idx;
-            mIndexBufferCursor += sizeof(uint32);
+            *((uint32 *)dst) = idx;
         }
         else if (mCurrentSection->m32BitIndices)
         {
-            *((uint32 *)mIndexBufferCursor) = idx;
-            mIndexBufferCursor += sizeof(uint32);
+            *((uint32 *)dst) = idx;
         }
         else
         {
-            *((uint16 *)mIndexBufferCursor) = idx;
-            mIndexBufferCursor += sizeof(uint16);
+            *((uint16 *)dst) = idx;
         }
-
-        mIndices++;
     }
     //-----------------------------------------------------------------------------
     void ManualObject::line(uint32 i1, uint32 i2)
@@ -596,6 +782,91 @@ namespace Ogre {
         triangle(i3, i4, i1);
     }
     //-----------------------------------------------------------------------------
+    void ManualObject::vertices(const void *data, size_t numVertices)
+    {
+        float *dst = advanceVertexCursor(numVertices, "ManualObject::vertices");
+
+        if (!numVertices)
+            return;
+
+        memcpy(dst, data, numVertices * mDeclSize);
+
+        size_t positionOffset = 0;
+        VertexElement2Vec::const_iterator itor = mCurrentSection->mVertexElements.begin();
+        while (itor->mSemantic != VES_POSITION)
+        {
+            positionOffset += v1::VertexElement::getTypeSize(itor->mType);
+            ++itor;
+        }
+
+        // Read the positions back from the source, since dst may be GPU memory
+        const char *srcPos = static_cast<const char*>(data) + positionOffset;
+        Vector3 vMin(std::numeric_limits<Real>::max());
+        Vector3 vMax(-std::numeric_limits<Real>::max());
+        for (size_t i = 0; i < numVertices; ++i)
+        {
+            const float *pos = reinterpret_cast<const float*>(srcPos);
+            const Vector3 vPos(pos[0], pos[1], pos[2]);
+            vMin.makeFloor(vPos);
+            vMax.makeCeil(vPos);
+            srcPos += mDeclSize;
+        }
+
+        mCurrentSection->mAabb.merge(Aabb::newFromExtents(vMin, vMax));
+    }
+    //-----------------------------------------------------------------------------
+    void* ManualObject::writeVertices(size_t numVertices, const Aabb &bounds)
+    {
+        float *retVal = advanceVertexCursor(numVertices, "ManualObject::writeVertices");
+        mCurrentSection->mAabb.merge(bounds);
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------
+    void ManualObject::indices(const uint32 *data, size_t numIndices)
+    {
+        char *dst = advanceIndexCursor(numIndices, "ManualObject::indices");
+
+        if (!mCurrentUpdating)
+        {
+            memcpy(dst, data, numIndices * sizeof(uint32));
+
+            for (size_t i = 0; i < numIndices && !mCurrentSection->m32BitIndices; ++i)
+            {
+                if (data[i] >= 65536)
+                    mCurrentSection->m32BitIndices = true;
+            }
+        }
+        else if (mCurrentSection->m32BitIndices)
+        {
+            memcpy(dst, data, numIndices * sizeof(uint32));
+        }
+        else
+        {
+            uint16 *dst16 = reinterpret_cast<uint16*>(dst);
+            for (size_t i = 0; i < numIndices; ++i)
+            {
+                assert(data[i] < 65536u && "The section uses 16-bit indices");
+                dst16[i] = static_cast<uint16>(data[i]);
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------
+    void ManualObject::indices(const uint16 *data, size_t numIndices)
+    {
+        char *dst = advanceIndexCursor(numIndices, "ManualObject::indices");
+
+        if (mCurrentUpdating && !mCurrentSection->m32BitIndices)
+        {
+            memcpy(dst, data, numIndices * sizeof(uint16));
+        }
+        else
+        {
+            uint32 *dst32 = reinterpret_cast<uint32*>(dst);
+            for (size_t i = 0; i < numIndices; ++i)
+                dst32[i] = data[i];
+        }
+    }
+    //-----------------------------------------------------------------------------
     size_t ManualObject::getCurrentVertexCount() const
     {
         if (!mCurrentSection)
@@ -625,13 +896,13 @@ namespace Ogre {
         ManualObjectSection * result = mCurrentSection;
 
         // Support calling begin() and end() without defining any geometry
-        if (! mVertices)
+        if (! mVertices && !mCurrentUpdating)
         {
             mCurrentSection = 0;
             return result;
         }
 
-        if (! mIndices)
+        if (! mIndices && !mCurrentUpdating)
         {
             OGRE_EXCEPT(Exception::ERR_INVALID_STATE,
                 "No indices have been defined in ManualObject. This is not supported.",
@@ -645,16 +916,9 @@ namespace Ogre {
                 mCurrentSection->clear();
             }
 
-            VaoManager *vaoManager = mCurrentSection->mVaoManager;
-            VertexBufferPackedVec vertexBuffers;
-
-            //Create the vertex buffer
-            VertexBufferPacked * vertexBuffer = vaoManager->createVertexBuffer(mCurrentSection->mVertexElements,
-                                                                               mVertices,
-                                                                               BT_DYNAMIC_PERSISTENT_COHERENT,
-                                                                               NULL, false);
-            vertexBuffers.push_back(vertexBuffer);
+            mCurrentSection->createBuffers(mVertices, mIndices);
 
+            VertexBufferPacked * vertexBuffer = mCurrentSection->mVao->getVertexBuffers()[0];
             char * vertexData = static_cast<char *>(vertexBuffer->map(0, vertexBuffer->getNumElements()));
 
             assert(vertexData);
@@ -663,13 +927,7 @@ namespace Ogre {
 
             vertexBuffer->unmap(UO_KEEP_PERSISTENT);
 
-            IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(mCurrentSection->m32BitIndices ? IndexBufferPacked::IT_32BIT :
-                                                                                                            IndexBufferPacked::IT_16BIT,
-                                                                           mIndices,
-                                                                           BT_DYNAMIC_PERSISTENT_COHERENT,
-                                                                           NULL,
-                                                                           false);
-
+            IndexBufferPacked *indexBuffer = mCurrentSection->mVao->getIndexBuffer();
             char * indexData = static_cast<char *>(indexBuffer->map(0, indexBuffer->getNumElements()));
 
             assert(indexData);
@@ -691,10 +949,6 @@ namespace Ogre {
 
             indexBuffer->unmap(UO_KEEP_PERSISTENT);
 
-            mCurrentSection->mVao = vaoManager->createVertexArrayObject(vertexBuffers, indexBuffer, mCurrentSection->mOperationType);
-
-            mCurrentSection->mVaoPerLod[0].push_back(mCurrentSection->mVao);
-            mCurrentSection->mVaoPerLod[1].push_back(mCurrentSection->mVao);
             mCurrentSection->setDatablock(mCurrentDatablockName);
 
             mRenderables.push_back(mCurrentSection);
@@ -716,8 +970,13 @@ namespace Ogre {
                 itBuffers++;
             }
 
-            IndexBufferPacked * indexBuffer = mCurrentSection->mVao->getIndexBuffer();
-            indexBuffer->unmap(UO_KEEP_PERSISTENT);
+            // If no indices were written, the ones from the last update are kept
+            if (mIndexBuffer)
+            {
+                IndexBufferPacked * indexBuffer = mCurrentSection->mVao->getIndexBuffer();
+                indexBuffer->unmap(UO_KEEP_PERSISTENT);
+                mCurrentSection->mVao->setPrimitiveRange(0, static_cast<uint32>(mIndices));
+            }
 
             mVertexBuffer = mVertexBufferCursor = 0;
             mIndexBuffer = mIndexBufferCursor = 0;
@@ -725,10 +984,21 @@ namespace Ogre {
 
         // update bounds
         Aabb aabb;
-        mObjectData.mLocalAabb->getAsAabb(aabb, mObjectData.mIndex);
-        aabb.merge(mCurrentSection->mAabb);
+        if (!mCurrentUpdating)
+        {
+            mObjectData.mLocalAabb->getAsAabb(aabb, mObjectData.mIndex);
+            aabb.merge(mCurrentSection->mAabb);
+        }
+        else
+        {
+            // The section may have shrunk
+            aabb = Aabb::BOX_NULL;
+            for (SectionList::const_iterator i = mSectionList.begin(); i != mSectionList.end(); ++i)
+                aabb.merge((*i)->mAabb);
+        }
         mObjectData.mLocalAabb->setFromAabb(aabb, mObjectData.mIndex);
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
 
         mCurrentSection = 0;
 
@@ -872,6 +1142,7 @@ namespace Ogre {
 
         mObjectData.mLocalAabb->setFromAabb(aabb, mObjectData.mIndex);
         mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+        mObjectData.invalidateBounds();
     }
     //-----------------------------------------------------------------------------
     size_t ManualObject::currentIndexCount()
@@ -937,6 +1208,30 @@ namespace Ogre {
         mVaoPerLod[1].clear();
     }
     //-----------------------------------------------------------------------------
+    void ManualObject::ManualObjectSection::createBuffers(size_t numVertices, size_t numIndices)
+    {
+        VertexBufferPackedVec vertexBuffers;
+
+        //Create the vertex buffer
+        VertexBufferPacked * vertexBuffer = mVaoManager->createVertexBuffer(mVertexElements,
+                                                                            numVertices,
+                                                                            BT_DYNAMIC_PERSISTENT_COHERENT,
+                                                                            NULL, false);
+        vertexBuffers.push_back(vertexBuffer);
+
+        IndexBufferPacked *indexBuffer = mVaoManager->createIndexBuffer(m32BitIndices ? IndexBufferPacked::IT_32BIT :
+                                                                                        IndexBufferPacked::IT_16BIT,
+                                                                        numIndices,
+                                                                        BT_DYNAMIC_PERSISTENT_COHERENT,
+                                                                        NULL,
+                                                                        false);
+
+        mVao = mVaoManager->createVertexArrayObject(vertexBuffers, indexBuffer, mOperationType);
+
+        mVaoPerLod[0].push_back(mVao);
+        mVaoPerLod[1].push_back(mVao);
+    }
+    //-----------------------------------------------------------------------------
     ManualObject::ManualObjectSection::ManualObjectSection(ManualObject* parent,
         const String& datablockName, OperationType opType)
         : mParent(parent), mVao(0), mOperationType(opType), m32BitIndices(false), mDatablockName(datablockName)
@@ -108,6 +108,7 @@ namespace Ogre {
         // Also copy LOD information
         mUserLodValues = rhs.mUserLodValues;
         mLodValues = rhs.mLodValues;
+        LodStrategy::_notifyLodValuesChanged();
         mCompilationRequired = rhs.mCompilationRequired;
         // illumination passes are not compiled right away so
         // mIsLoaded state should still be the same as the original material
@@ -685,7 +686,9 @@ namespace Ogre {
             mUserLodValues.push_back(*i);
             mLodValues.push_back(lodStrategy->transformUserValue(*i));
         }
-        
+
+        LodStrategy::_notifyLodValuesChanged();
+
     }
     // --------------------------------------------------------------------
     Material::LodValueIterator Material::getLodValueIterator(void) const
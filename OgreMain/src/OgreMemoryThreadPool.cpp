@@ -0,0 +1,402 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+#include "OgrePrerequisites.h"
+
+#if OGRE_MEMORY_ALLOCATOR == OGRE_MEMORY_ALLOCATOR_THREADPOOL
+
+#include "OgreMemoryThreadPool.h"
+#include "Threading/OgreLightweightMutex.h"
+#include "Threading/OgreThreads.h"
+
+namespace Ogre
+{
+    namespace _ThreadPoolIntern
+    {
+        /// Payloads are multiples of 16 so that every block stays 16-byte aligned
+        const size_t c_sizeClasses[] = { 16u, 32u, 48u, 64u, 96u, 128u, 192u, 256u,
+                                         384u, 512u, 768u, 1024u };
+        const size_t c_numSizeClasses = sizeof( c_sizeClasses ) / sizeof( c_sizeClasses[0] );
+        const size_t c_slabSize = 64u * 1024u;
+        const size_t c_headerSize = 16u;
+
+        struct ThreadCache;
+
+        /// Precedes every allocation
+        struct BlockHeader
+        {
+            union
+            {
+                /// Cache the block belongs to. Only when sizeClass < c_numSizeClasses
+                ThreadCache *owner;
+                /// Size of the request. Only when sizeClass == c_numSizeClasses
+                size_t      largeBytes;
+            };
+            uint32  sizeClass;
+            uint32  category;
+#if OGRE_ARCH_TYPE == OGRE_ARCHITECTURE_32
+            uint32  padding;
+#endif
+        };
+
+        /// Overlaps the payload of blocks sitting in a free list
+        struct FreeBlock
+        {
+            FreeBlock *next;
+        };
+
+        struct ThreadCache
+        {
+            FreeBlock           *freeList[c_numSizeClasses];
+
+            /// Protects remoteFreeList
+            LightweightMutex    remoteMutex;
+            FreeBlock           *remoteFreeList[c_numSizeClasses];
+            /// Read without locking as a hint; the lock is only taken if set
+            volatile bool       hasRemoteFrees;
+
+            //These are only written by the owner thread
+            size_t              liveBytes[MEMCATEGORY_COUNT];
+            uint64              numAllocations[MEMCATEGORY_COUNT];
+            uint64              numDeallocations[MEMCATEGORY_COUNT];
+            uint64              bytesAllocated[MEMCATEGORY_COUNT];
+            size_t              reservedBytes;
+
+            ThreadCache         *nextCache;
+            /// Its thread exited (@see ThreadPoolAllocImpl::releaseThreadCache), the
+            /// next thread that needs a cache takes it over. Protected by GlobalState::mutex
+            bool                orphaned;
+
+            ThreadCache() :
+                hasRemoteFrees( false ),
+                reservedBytes( 0 ),
+                nextCache( 0 ),
+                orphaned( false )
+            {
+                memset( freeList, 0, sizeof( freeList ) );
+                memset( remoteFreeList, 0, sizeof( remoteFreeList ) );
+                memset( liveBytes, 0, sizeof( liveBytes ) );
+                memset( numAllocations, 0, sizeof( numAllocations ) );
+                memset( numDeallocations, 0, sizeof( numDeallocations ) );
+                memset( bytesAllocated, 0, sizeof( bytesAllocated ) );
+            }
+        };
+
+        struct GlobalState
+        {
+            /// Protects firstCache
+            LightweightMutex    mutex;
+            ThreadCache         *firstCache;
+            TlsHandle           tlsHandle;
+
+            GlobalState() :
+                firstCache( 0 ),
+                tlsHandle( OGRE_TLS_INVALID_HANDLE )
+            {
+                Threads::CreateTls( &tlsHandle );
+            }
+        };
+
+        GlobalState& getGlobalState(void)
+        {
+            //Constructed on first use, since allocations happen during static initialization
+            static GlobalState globalState;
+            return globalState;
+        }
+
+        ThreadCache* getThreadCache(void)
+        {
+            GlobalState &globalState = getGlobalState();
+            ThreadCache *cache = reinterpret_cast<ThreadCache*>(
+                                     Threads::GetTls( globalState.tlsHandle ) );
+
+            if( !cache )
+            {
+                globalState.mutex.lock();
+
+                //Reuse the cache (and its free lists) of a thread that exited, if any
+                cache = globalState.firstCache;
+                while( cache && !cache->orphaned )
+                    cache = cache->nextCache;
+
+                if( cache )
+                {
+                    cache->orphaned = false;
+                }
+                else
+                {
+                    //Can't use our own allocator here
+                    cache = new (AlignedMemory::allocate( sizeof(ThreadCache) )) ThreadCache();
+                    cache->nextCache = globalState.firstCache;
+                    globalState.firstCache = cache;
+                }
+
+                globalState.mutex.unlock();
+
+                Threads::SetTls( globalState.tlsHandle, cache );
+            }
+
+            return cache;
+        }
+
+        size_t sizeClassFromSize( size_t bytes )
+        {
+            size_t sizeClass = 0;
+            while( sizeClass < c_numSizeClasses && c_sizeClasses[sizeClass] < bytes )
+                ++sizeClass;
+            return sizeClass;
+        }
+
+        /// Carves a new slab into blocks of the given size class
+        void refill( ThreadCache *cache, size_t sizeClass )
+        {
+            const size_t blockSize = c_headerSize + c_sizeClasses[sizeClass];
+            const size_t numBlocks = c_slabSize / blockSize;
+
+            uint8 *slab = reinterpret_cast<uint8*>( AlignedMemory::allocate( c_slabSize, 16u ) );
+            cache->reservedBytes += c_slabSize;
+
+            FreeBlock *first = 0;
+            for( size_t i=numBlocks; i--; )
+            {
+                BlockHeader *header = reinterpret_cast<BlockHeader*>( slab + i * blockSize );
+                header->owner       = cache;
+                header->sizeClass   = static_cast<uint32>( sizeClass );
+                header->category    = 0;
+
+                FreeBlock *block = reinterpret_cast<FreeBlock*>( slab + i * blockSize +
+                                                                 c_headerSize );
+                block->next = first;
+                first = block;
+            }
+
+            cache->freeList[sizeClass] = first;
+        }
+
+        /// Moves the blocks other threads gave back into our local free lists
+        void claimRemoteFrees( ThreadCache *cache )
+        {
+            cache->remoteMutex.lock();
+            for( size_t i=0; i<c_numSizeClasses; ++i )
+            {
+                FreeBlock *remote = cache->remoteFreeList[i];
+                if( remote )
+                {
+                    FreeBlock *last = remote;
+                    while( last->next )
+                        last = last->next;
+                    last->next = cache->freeList[i];
+                    cache->freeList[i] = remote;
+                    cache->remoteFreeList[i] = 0;
+                }
+            }
+            cache->hasRemoteFrees = false;
+            cache->remoteMutex.unlock();
+        }
+    }
+
+    using namespace _ThreadPoolIntern;
+
+    //-----------------------------------------------------------------------------------
+    DECL_MALLOC void* ThreadPoolAllocImpl::allocBytes( size_t count, MemoryCategory category )
+    {
+        ThreadCache *cache = getThreadCache();
+        const size_t sizeClass = sizeClassFromSize( count );
+
+        BlockHeader *header;
+        size_t bytes;
+
+        if( sizeClass == c_numSizeClasses )
+        {
+            header = reinterpret_cast<BlockHeader*>(
+                         AlignedMemory::allocate( c_headerSize + count, 16u ) );
+            header->largeBytes  = count;
+            header->sizeClass   = static_cast<uint32>( c_numSizeClasses );
+            bytes = count;
+        }
+        else
+        {
+            if( !cache->freeList[sizeClass] )
+            {
+                if( cache->hasRemoteFrees )
+                    claimRemoteFrees( cache );
+                if( !cache->freeList[sizeClass] )
+                    refill( cache, sizeClass );
+            }
+
+            FreeBlock *block = cache->freeList[sizeClass];
+            cache->freeList[sizeClass] = block->next;
+
+            header = reinterpret_cast<BlockHeader*>( reinterpret_cast<uint8*>( block ) -
+                                                     c_headerSize );
+            bytes = c_sizeClasses[sizeClass];
+        }
+
+        header->category = static_cast<uint32>( category );
+
+        cache->liveBytes[category]      += bytes;
+        cache->bytesAllocated[category] += bytes;
+        ++cache->numAllocations[category];
+
+        return reinterpret_cast<uint8*>( header ) + c_headerSize;
+    }
+    //-----------------------------------------------------------------------------------
+    void ThreadPoolAllocImpl::deallocBytes( void *ptr )
+    {
+        if( !ptr )
+            return;
+
+        BlockHeader *header = reinterpret_cast<BlockHeader*>( reinterpret_cast<uint8*>( ptr ) -
+                                                              c_headerSize );
+        ThreadCache *cache = getThreadCache();
+
+        const uint32 category = header->category;
+        ++cache->numDeallocations[category];
+
+        if( header->sizeClass == c_numSizeClasses )
+        {
+            //Counters are per thread; the sum across threads is what matters
+            cache->liveBytes[category] -= header->largeBytes;
+            AlignedMemory::deallocate( header );
+            return;
+        }
+
+        const size_t sizeClass = header->sizeClass;
+        cache->liveBytes[category] -= c_sizeClasses[sizeClass];
+
+        FreeBlock *block = reinterpret_cast<FreeBlock*>( ptr );
+        ThreadCache *owner = header->owner;
+
+        if( owner == cache )
+        {
+            block->next = cache->freeList[sizeClass];
+            cache->freeList[sizeClass] = block;
+        }
+        else
+        {
+            owner->remoteMutex.lock();
+            block->next = owner->remoteFreeList[sizeClass];
+            owner->remoteFreeList[sizeClass] = block;
+            owner->hasRemoteFrees = true;
+            owner->remoteMutex.unlock();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    DECL_MALLOC void* ThreadPoolAllocImpl::allocBytesAligned( size_t align, size_t count,
+                                                              MemoryCategory category )
+    {
+        assert( (align & (align - 1u)) == 0 && "Alignment must be a power of two!" );
+
+        //Blocks are already 16-byte aligned
+        if( align <= 16u )
+            return allocBytes( count, category );
+
+        uint8 *tmp = reinterpret_cast<uint8*>( allocBytes( count + align, category ) );
+
+        //tmp is 16-byte aligned, so we always move forward between 16 and align bytes,
+        //which leaves room to store the offset (it doesn't fit in a byte when align >= 256)
+        uint8 *memBlock = reinterpret_cast<uint8*>(
+                              reinterpret_cast<uintptr_t>( tmp + align ) &
+                              ~static_cast<uintptr_t>( align - 1u ) );
+        reinterpret_cast<size_t*>( memBlock )[-1] = static_cast<size_t>( memBlock - tmp );
+
+        return memBlock;
+    }
+    //-----------------------------------------------------------------------------------
+    void ThreadPoolAllocImpl::deallocBytesAligned( size_t align, void *ptr )
+    {
+        if( align <= 16u || !ptr )
+        {
+            deallocBytes( ptr );
+            return;
+        }
+
+        uint8 *memBlock = reinterpret_cast<uint8*>( ptr );
+        deallocBytes( memBlock - reinterpret_cast<size_t*>( memBlock )[-1] );
+    }
+    //-----------------------------------------------------------------------------------
+    void ThreadPoolAllocImpl::releaseThreadCache(void)
+    {
+        GlobalState &globalState = getGlobalState();
+        ThreadCache *cache = reinterpret_cast<ThreadCache*>(
+                                 Threads::GetTls( globalState.tlsHandle ) );
+
+        if( cache )
+        {
+            Threads::SetTls( globalState.tlsHandle, 0 );
+
+            //Blocks still in use keep pointing to it, so it can't be freed. Other
+            //threads keep pushing their frees to it, and the new owner claims them.
+            globalState.mutex.lock();
+            cache->orphaned = true;
+            globalState.mutex.unlock();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void ThreadPoolAllocImpl::getStats( MemoryCategory category, ThreadPoolAllocStats &outStats )
+    {
+        memset( &outStats, 0, sizeof( outStats ) );
+
+        GlobalState &globalState = getGlobalState();
+        globalState.mutex.lock();
+
+        const ThreadCache *cache = globalState.firstCache;
+        while( cache )
+        {
+            outStats.liveBytes          += cache->liveBytes[category];
+            outStats.numAllocations     += cache->numAllocations[category];
+            outStats.numDeallocations   += cache->numDeallocations[category];
+            outStats.bytesAllocated     += cache->bytesAllocated[category];
+            cache = cache->nextCache;
+        }
+
+        globalState.mutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t ThreadPoolAllocImpl::getReservedBytes(void)
+    {
+        size_t retVal = 0;
+
+        GlobalState &globalState = getGlobalState();
+        globalState.mutex.lock();
+
+        const ThreadCache *cache = globalState.firstCache;
+        while( cache )
+        {
+            retVal += cache->reservedBytes;
+            cache = cache->nextCache;
+        }
+
+        globalState.mutex.unlock();
+
+        return retVal;
+    }
+}
+
+#endif
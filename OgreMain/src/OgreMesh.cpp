@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreHardwareBufferManager.h"
 #include "OgreIteratorWrappers.h"
 #include "OgreException.h"
+#include "OgreLoadProfiler.h"
 #include "OgreMeshManager.h"
 #include "OgreEdgeListBuilder.h"
 #include "OgreAnimation.h"
@@ -48,6 +49,9 @@ THE SOFTWARE.
 #include "OgrePixelCountLodStrategy.h"
 #include "OgreVertexShadowMapHelper.h"
 #include "OgreStringConverter.h"
+#include "OgrePose.h"
+#include "OgreSceneManager.h"
+#include "Threading/OgreUniformScalableTask.h"
 
 #include "Animation/OgreSkeletonDef.h"
 #include "Animation/OgreSkeletonManager.h"
@@ -57,6 +61,91 @@ THE SOFTWARE.
 
 namespace Ogre {
 namespace v1 {
+    namespace
+    {
+        /// Below this amount of vertices per thread, splitting the skinning
+        /// across worker threads costs more than what it saves.
+        static const size_t c_minVerticesPerSkinningThread = 2048u;
+
+        /// Splits OptimisedUtil::softwareVertexSkinning in ranges of vertices,
+        /// processed by SceneManager's worker threads
+        class SoftwareSkinningTask : public UniformScalableTask
+        {
+        public:
+            const float *srcPos;
+            float *destPos;
+            const float *srcNorm;
+            float *destNorm;
+            const float *blendWeight;
+            const unsigned char *blendIdx;
+            const Matrix4* const* blendMatrices;
+            size_t srcPosStride;
+            size_t destPosStride;
+            size_t srcNormStride;
+            size_t destNormStride;
+            size_t blendWeightStride;
+            size_t blendIdxStride;
+            size_t numWeightsPerVertex;
+            size_t numVertices;
+
+            static const float* advance( const float *ptr, size_t stride, size_t numVertices )
+            {
+                return ptr ? reinterpret_cast<const float*>(
+                                 reinterpret_cast<const char*>( ptr ) + stride * numVertices ) : 0;
+            }
+            static float* advance( float *ptr, size_t stride, size_t numVertices )
+            {
+                return ptr ? reinterpret_cast<float*>(
+                                 reinterpret_cast<char*>( ptr ) + stride * numVertices ) : 0;
+            }
+            static const unsigned char* advance( const unsigned char *ptr, size_t stride,
+                                                 size_t numVertices )
+            {
+                return ptr + stride * numVertices;
+            }
+
+            virtual void execute( size_t threadId, size_t numThreads )
+            {
+                //Keep every range a multiple of 4 vertices so the SSE
+                //path sees the same alignment as a single call would
+                const size_t verticesPerThread =
+                        ( ( numVertices + numThreads - 1u ) / numThreads + 3u ) & ~size_t( 3u );
+                const size_t start = std::min( threadId * verticesPerThread, numVertices );
+                const size_t count = std::min( verticesPerThread, numVertices - start );
+
+                if( !count )
+                    return;
+
+                OptimisedUtil::getImplementation()->softwareVertexSkinning(
+                    advance( srcPos, srcPosStride, start ),
+                    advance( destPos, destPosStride, start ),
+                    advance( srcNorm, srcNormStride, start ),
+                    advance( destNorm, destNormStride, start ),
+                    advance( blendWeight, blendWeightStride, start ),
+                    advance( blendIdx, blendIdxStride, start ),
+                    blendMatrices,
+                    srcPosStride, destPosStride,
+                    srcNormStride, destNormStride,
+                    blendWeightStride, blendIdxStride,
+                    numWeightsPerVertex, count );
+            }
+        };
+
+        void applyPoseOffsets( float *pBase, size_t elemsPerVertex,
+                               const map<size_t, Vector3>::type &offsets, Real weight )
+        {
+            map<size_t, Vector3>::type::const_iterator itor = offsets.begin();
+            map<size_t, Vector3>::type::const_iterator end  = offsets.end();
+            while( itor != end )
+            {
+                float *pdst = pBase + itor->first * elemsPerVertex;
+                pdst[0] += itor->second.x * weight;
+                pdst[1] += itor->second.y * weight;
+                pdst[2] += itor->second.z * weight;
+                ++itor;
+            }
+        }
+    }
     bool Mesh::msOptimizeForShadowMapping = false;
 
     //-----------------------------------------------------------------------
@@ -249,6 +338,8 @@ namespace v1 {
             mLodValues[0] = lodStrategy->getBaseValue();
             mMeshLodUsageList[0].value = lodStrategy->getBaseValue();
         }
+
+        LodStrategy::_notifyLodValuesChanged();
 #endif
     }
     //-----------------------------------------------------------------------
@@ -264,8 +355,13 @@ namespace v1 {
             ResourceGroupManager::getSingleton().openResource(
                 mName, mGroup, true, this);
  
-        // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        // fully prebuffer into host RAM, unless it's already there (e.g. memory mapped)
+        if( !mFreshFromDisk->getDataView() )
+        {
+            LoadProfiler::Scope loadScope( LoadEvent::ArchiveRead, mName );
+            mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+            loadScope.setBytes( mFreshFromDisk->size() );
+        }
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
@@ -290,6 +386,8 @@ namespace v1 {
                         "Mesh::loadImpl()");
         }
 
+        LoadProfiler::Scope loadScope( LoadEvent::MeshLoad, mName );
+        loadScope.setBytes( data->size() );
         serializer.importMesh(data, this);
 
         /* check all submeshes to see if their materials should be
@@ -386,6 +484,7 @@ namespace v1 {
         mSubMeshNameMap = mesh->getSubMeshNameMap();
 
         mLodValues = *mesh->_getLodValueArray();
+        LodStrategy::_notifyLodValuesChanged();
 
         mIsManual = true;
 
@@ -1250,6 +1349,7 @@ namespace v1 {
         mNumLods = numLevels;
         mMeshLodUsageList.resize(numLevels);
         mLodValues.resize(numLevels);
+        LodStrategy::_notifyLodValuesChanged();
         // Resize submesh face data lists too
         for (SubMeshList::iterator i = mSubMeshList.begin(); i != mSubMeshList.end(); ++i)
         {
@@ -1269,6 +1369,7 @@ namespace v1 {
 
         mMeshLodUsageList[level] = usage;
         mLodValues[level] = usage.userValue;
+        LodStrategy::_notifyLodValuesChanged();
 
         if( !mMeshLodUsageList[level].manualName.empty() )
 		{
@@ -1334,6 +1435,7 @@ namespace v1 {
         mMeshLodUsageList[0].edgeData = NULL;
         // TODO: Shouldn't we rebuild edge lists after freeing them?
         mLodValues.push_back( lodStrategy->getBaseValue() );
+        LodStrategy::_notifyLodValuesChanged();
 #endif
     }
 
@@ -2157,7 +2259,7 @@ namespace v1 {
     void Mesh::softwareVertexBlend(const VertexData* sourceVertexData,
         const VertexData* targetVertexData,
         const Matrix4* const* blendMatrices, size_t numMatrices,
-        bool blendNormals)
+        bool blendNormals, SceneManager *sceneManager)
     {
         float *pSrcPos = 0;
         float *pSrcNorm = 0;
@@ -2248,6 +2350,7 @@ namespace v1 {
         srcElemBlendWeights->baseVertexPointerToElement(srcWeightBuf != srcIdxBuf ? srcWeightLock.pData : srcIdxLock.pData, &pBlendWeight);
         unsigned short numWeightsPerVertex =
             VertexElement::getTypeCount(srcElemBlendWeights->getType());
+        const size_t numVertices = targetVertexData->vertexCount;
 
 
         // Lock destination buffers for writing
@@ -2268,16 +2371,41 @@ namespace v1 {
             destElemNorm->baseVertexPointerToElement(destNormBuf != destPosBuf ? destNormLock.pData : destPosLock.pData, &pDestNorm);
         }
 
-        OptimisedUtil::getImplementation()->softwareVertexSkinning(
-            pSrcPos, pDestPos,
-            pSrcNorm, pDestNorm,
-            pBlendWeight, pBlendIdx,
-            blendMatrices,
-            srcPosStride, destPosStride,
-            srcNormStride, destNormStride,
-            blendWeightStride, blendIdxStride,
-            numWeightsPerVertex,
-            targetVertexData->vertexCount);
+        // Buffers were locked above from this thread. Worker threads only touch memory
+        if (sceneManager && sceneManager->getNumWorkerThreads() > 1u &&
+            numVertices >= c_minVerticesPerSkinningThread * 2u)
+        {
+            SoftwareSkinningTask task;
+            task.srcPos             = pSrcPos;
+            task.destPos            = pDestPos;
+            task.srcNorm            = pSrcNorm;
+            task.destNorm           = pDestNorm;
+            task.blendWeight        = pBlendWeight;
+            task.blendIdx           = pBlendIdx;
+            task.blendMatrices      = blendMatrices;
+            task.srcPosStride       = srcPosStride;
+            task.destPosStride      = destPosStride;
+            task.srcNormStride      = srcNormStride;
+            task.destNormStride     = destNormStride;
+            task.blendWeightStride  = blendWeightStride;
+            task.blendIdxStride     = blendIdxStride;
+            task.numWeightsPerVertex= numWeightsPerVertex;
+            task.numVertices        = numVertices;
+            sceneManager->executeUserScalableTask( &task, true );
+        }
+        else
+        {
+            OptimisedUtil::getImplementation()->softwareVertexSkinning(
+                pSrcPos, pDestPos,
+                pSrcNorm, pDestNorm,
+                pBlendWeight, pBlendIdx,
+                blendMatrices,
+                srcPosStride, destPosStride,
+                srcNormStride, destNormStride,
+                blendWeightStride, blendIdxStride,
+                numWeightsPerVertex,
+                numVertices);
+        }
     }
     //---------------------------------------------------------------------
     void Mesh::softwareVertexMorph(Real t,
@@ -2356,39 +2484,59 @@ namespace v1 {
         float* pBase = static_cast<float*>(destLock.pData);
                 
         // Iterate over affected vertices
-        for (map<size_t, Vector3>::type::const_iterator i = vertexOffsetMap.begin();
-            i != vertexOffsetMap.end(); ++i)
-        {
-            // Adjust pointer
-            float *pdst = pBase + i->first*elemsPerVertex;
+        applyPoseOffsets(pBase, elemsPerVertex, vertexOffsetMap, weight);
 
-            *pdst = *pdst + (i->second.x * weight);
-            ++pdst;
-            *pdst = *pdst + (i->second.y * weight);
-            ++pdst;
-            *pdst = *pdst + (i->second.z * weight);
-            ++pdst;
-            
-        }
-        
         if (normals)
         {
             float* pNormBase;
             normElem->baseVertexPointerToElement((void*)pBase, &pNormBase);
-            for (map<size_t, Vector3>::type::const_iterator i = normalsMap.begin();
-                i != normalsMap.end(); ++i)
-            {
-                // Adjust pointer
-                float *pdst = pNormBase + i->first*elemsPerVertex;
-
-                *pdst = *pdst + (i->second.x * weight);
-                ++pdst;
-                *pdst = *pdst + (i->second.y * weight);
-                ++pdst;
-                *pdst = *pdst + (i->second.z * weight);
-                ++pdst;             
-                
-            }
+            applyPoseOffsets(pNormBase, elemsPerVertex, normalsMap, weight);
+        }
+    }
+    //---------------------------------------------------------------------
+    void Mesh::softwareVertexPoseBlend(const Pose* const* poses, const Real *weights,
+        size_t numPoses, VertexData* targetVertexData)
+    {
+        bool anyWeight = false;
+        bool anyNormals = false;
+        for (size_t i = 0; i < numPoses; ++i)
+        {
+            anyWeight |= weights[i] != 0.0f;
+            anyNormals |= weights[i] != 0.0f && !poses[i]->getNormals().empty();
+        }
+
+        // Do nothing if no weight
+        if (!anyWeight)
+            return;
+
+        const VertexElement* posElem =
+            targetVertexData->vertexDeclaration->findElementBySemantic(VES_POSITION);
+        const VertexElement* normElem =
+            targetVertexData->vertexDeclaration->findElementBySemantic(VES_NORMAL);
+        assert(posElem);
+        // Support normals if they're in the same buffer as positions and poses include them
+        bool normals = normElem && anyNormals && posElem->getSource() == normElem->getSource();
+        HardwareVertexBufferSharedPtr destBuf =
+            targetVertexData->vertexBufferBinding->getBuffer(
+            posElem->getSource());
+
+        size_t elemsPerVertex = destBuf->getVertexSize()/sizeof(float);
+
+        // Have to lock in normal mode since this is incremental. But only once for all poses
+        HardwareBufferLockGuard destLock(destBuf, HardwareBuffer::HBL_NORMAL);
+        float* pBase = static_cast<float*>(destLock.pData);
+        float* pNormBase = 0;
+        if (normals)
+            normElem->baseVertexPointerToElement((void*)pBase, &pNormBase);
+
+        for (size_t i = 0; i < numPoses; ++i)
+        {
+            if (weights[i] == 0.0f)
+                continue;
+
+            applyPoseOffsets(pBase, elemsPerVertex, poses[i]->getVertexOffsets(), weights[i]);
+            if (normals)
+                applyPoseOffsets(pNormBase, elemsPerVertex, poses[i]->getNormals(), weights[i]);
         }
     }
     //---------------------------------------------------------------------
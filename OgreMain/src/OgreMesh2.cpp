@@ -51,6 +51,7 @@ THE SOFTWARE.
 #include "OgreOldSkeletonManager.h"
 
 #include "OgreProfiler.h"
+#include "OgreLoadProfiler.h"
 
 namespace Ogre {
     bool Mesh::msOptimizeForShadowMapping = false;
@@ -154,12 +155,21 @@ namespace Ogre {
         if (getCreator()->getVerbose())
             LogManager::getSingleton().logMessage("Mesh: Loading "+mName+".");
 
-        mFreshFromDisk =
-            ResourceGroupManager::getSingleton().openResource(
-                mName, mGroup, true, this);
+        // May have been read already (i.e. by MeshManager::loadAsync)
+        if( mFreshFromDisk.isNull() )
+        {
+            mFreshFromDisk =
+                ResourceGroupManager::getSingleton().openResource(
+                    mName, mGroup, true, this);
+        }
  
-        // fully prebuffer into host RAM
-        mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+        // fully prebuffer into host RAM, unless it's already there (e.g. memory mapped)
+        if( !mFreshFromDisk->getDataView() )
+        {
+            LoadProfiler::Scope loadScope( LoadEvent::ArchiveRead, mName );
+            mFreshFromDisk = DataStreamPtr(OGRE_NEW MemoryDataStream(mName,mFreshFromDisk));
+            loadScope.setBytes( mFreshFromDisk->size() );
+        }
     }
     //-----------------------------------------------------------------------
     void Mesh::unprepareImpl()
@@ -185,6 +195,8 @@ namespace Ogre {
                         "Mesh::loadImpl()");
         }
 
+        LoadProfiler::Scope loadScope( LoadEvent::MeshLoad, mName );
+        loadScope.setBytes( data->size() );
         serializer.importMesh(data, this);
     }
     //-----------------------------------------------------------------------
@@ -499,12 +511,11 @@ namespace Ogre {
         return retVal;
     }
     //---------------------------------------------------------------------
-    void Mesh::importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents, bool halfPose )
+    void Mesh::importV1( v1::Mesh *mesh, bool halfPos, bool halfTexCoords, bool qTangents,
+                         bool halfPose, SubMesh::ArrangedVertexData *arranged )
     {
         OgreProfileExhaustive( "Mesh2::importV1" );
 
-        mesh->load();
-
         if( mLoadingState.get() != LOADSTATE_UNLOADED && mLoadingState.get() != LOADSTATE_LOADING )
         {
             OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
@@ -512,38 +523,16 @@ namespace Ogre {
                          "Mesh::importV1" );
         }
 
-        if( mesh->sharedVertexData[VpNormal] )
-        {
-            LogManager::getSingleton().logMessage( "WARNING: Mesh '" + mesh->getName() +
-                                                   "' has shared vertices. They're being "
-                                                   "'unshared' for importing to v2" );
-            v1::MeshManager::unshareVertices( mesh );
-        }
+        _prepareV1ForImport( mesh, qTangents );
 
         mAabb.setExtents( mesh->getBounds().getMinimum(), mesh->getBounds().getMaximum() );
         mBoundRadius = mesh->getBoundingSphereRadius();
 
-        try
-        {
-            if( qTangents )
-            {
-                unsigned short sourceCoordSet;
-                unsigned short index;
-                bool alreadyHasTangents = mesh->suggestTangentVectorBuildParams( VES_TANGENT,
-                                                                                 sourceCoordSet,
-                                                                                 index );
-                if( !alreadyHasTangents )
-                    mesh->buildTangentVectors( VES_TANGENT, sourceCoordSet, index, false, false, true );
-            }
-        }
-        catch( Exception & )
-        {
-        }
-
         for( size_t i=0; i<mesh->getNumSubMeshes(); ++i )
         {
             SubMesh *subMesh = createSubMesh();
-            subMesh->importFromV1( mesh->getSubMesh( i ), halfPos, halfTexCoords, qTangents, halfPose );
+            subMesh->importFromV1( mesh->getSubMesh( i ), halfPos, halfTexCoords, qTangents, halfPose,
+                                   arranged ? &arranged[i * NumVertexPass] : 0 );
         }
 
         mSubMeshNameMap = mesh->getSubMeshNameMap();
@@ -562,19 +551,51 @@ namespace Ogre {
             mLodValues = *mesh->_getLodValueArray();
         else
             mLodValues = MovableObject::c_DefaultLodMesh;
+        LodStrategy::_notifyLodValuesChanged();
 
         mIsManual = true;
         setToLoaded();
     }
     //---------------------------------------------------------------------
-    void Mesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
+    void Mesh::_prepareV1ForImport( v1::Mesh *mesh, bool qTangents )
+    {
+        mesh->load();
+
+        if( mesh->sharedVertexData[VpNormal] )
+        {
+            LogManager::getSingleton().logMessage( "WARNING: Mesh '" + mesh->getName() +
+                                                   "' has shared vertices. They're being "
+                                                   "'unshared' for importing to v2" );
+            v1::MeshManager::unshareVertices( mesh );
+        }
+
+        try
+        {
+            if( qTangents )
+            {
+                unsigned short sourceCoordSet;
+                unsigned short index;
+                bool alreadyHasTangents = mesh->suggestTangentVectorBuildParams( VES_TANGENT,
+                                                                                 sourceCoordSet,
+                                                                                 index );
+                if( !alreadyHasTangents )
+                    mesh->buildTangentVectors( VES_TANGENT, sourceCoordSet, index, false, false, true );
+            }
+        }
+        catch( Exception & )
+        {
+        }
+    }
+    //---------------------------------------------------------------------
+    void Mesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                 bool unormTexCoords )
     {
         SubMeshVec::const_iterator itor = mSubMeshes.begin();
         SubMeshVec::const_iterator end  = mSubMeshes.end();
 
         while( itor != end )
         {
-            (*itor)->arrangeEfficient( halfPos, halfTexCoords, qTangents );
+            (*itor)->arrangeEfficient( halfPos, halfTexCoords, qTangents, unormTexCoords );
             ++itor;
         }
     }
@@ -591,6 +612,53 @@ namespace Ogre {
         }
     }
     //---------------------------------------------------------------------
+    void Mesh::optimise( bool vertexCache, bool overdraw, bool vertexFetch )
+    {
+        SubMeshVec::const_iterator itor = mSubMeshes.begin();
+        SubMeshVec::const_iterator end  = mSubMeshes.end();
+
+        while( itor != end )
+        {
+            (*itor)->optimise( vertexCache, overdraw, vertexFetch );
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void Mesh::buildMeshlets( uint32 maxVertices, uint32 maxTriangles )
+    {
+        SubMeshVec::const_iterator itor = mSubMeshes.begin();
+        SubMeshVec::const_iterator end  = mSubMeshes.end();
+
+        while( itor != end )
+        {
+            (*itor)->buildMeshlets( maxVertices, maxTriangles );
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void Mesh::computeSubMeshAabbs(void)
+    {
+        SubMeshVec::const_iterator itor = mSubMeshes.begin();
+        SubMeshVec::const_iterator end  = mSubMeshes.end();
+
+        while( itor != end )
+        {
+            (*itor)->computeAabb();
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    bool Mesh::hasSubMeshAabbs(void) const
+    {
+        SubMeshVec::const_iterator itor = mSubMeshes.begin();
+        SubMeshVec::const_iterator end  = mSubMeshes.end();
+
+        while( itor != end && (*itor)->hasAabb() )
+            ++itor;
+
+        return !mSubMeshes.empty() && itor == end;
+    }
+    //---------------------------------------------------------------------
     void Mesh::prepareForShadowMapping( bool forceSameBuffers )
     {
         OgreProfileExhaustive( "Mesh2::prepareForShadowMapping" );
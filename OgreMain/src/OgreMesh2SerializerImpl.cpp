@@ -57,12 +57,18 @@ THE SOFTWARE.
 namespace Ogre {
     /// stream overhead = ID + size
     const long MSTREAM_OVERHEAD_SIZE = sizeof(uint16) + sizeof(uint32);
+    /// Alignment of vertex & index buffer contents in R3+ files.
+    /// Every buffer is surrounded by this many bytes (including the uint8 with the padding)
+    const size_t MSTREAM_BUFFER_ALIGNMENT = 16u;
     //---------------------------------------------------------------------
     MeshSerializerImpl::MeshSerializerImpl( VaoManager *vaoManager ) :
-        mVaoManager( vaoManager )
+        mVaoManager( vaoManager ),
+        mAlignedBuffers( true ),
+        mVertexDataView( 0 ),
+        mIndexDataView( 0 )
     {
         // Version number
-        mVersion = "[MeshSerializer_v2.1 R2]";
+        mVersion = "[MeshSerializer_v2.1 R3]";
     }
     //---------------------------------------------------------------------
     MeshSerializerImpl::~MeshSerializerImpl()
@@ -125,6 +131,17 @@ namespace Ogre {
 #if OGRE_SERIALIZER_VALIDATE_CHUNKSIZE
         enableValidation();
 #endif
+        mVertexDataView = 0;
+        mIndexDataView = 0;
+        if( mAlignedBuffers && !mFlipEndian )
+        {
+            const uint8 *dataView = stream->getDataView();
+            if( !pMesh->isVertexBufferShadowed() )
+                mVertexDataView = dataView;
+            if( !pMesh->isIndexBufferShadowed() )
+                mIndexDataView = dataView;
+        }
+
         // Check header
         readFileHeader(stream);
         pushInnerChunk(stream);
@@ -141,6 +158,9 @@ namespace Ogre {
         }
         popInnerChunk(stream);
 
+        mVertexDataView = 0;
+        mIndexDataView = 0;
+
         if( !pMesh->hasValidShadowMappingVaos() )
             pMesh->prepareForShadowMapping( false );
     }
@@ -215,6 +235,20 @@ namespace Ogre {
         writeSubMeshNameTable(pMesh);
         LogManager::getSingleton().logMessage("Submesh name table exported.");
 
+        // Write meshlets
+        for (uint16 i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            if( pMesh->getSubMesh(i)->hasMeshlets() )
+                writeSubMeshMeshlets( pMesh->getSubMesh(i), i );
+        }
+
+        // Write submesh bounds
+        for (uint16 i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            if( pMesh->getSubMesh(i)->hasAabb() )
+                writeSubMeshBounds( pMesh->getSubMesh(i), i );
+        }
+
         // Write edge lists
         /*if (pMesh->isEdgeListBuilt())
         {
@@ -362,6 +396,7 @@ namespace Ogre {
             // uint16* faceVertexIndices ((indexCount)
             AsyncTicketPtr asyncTicket = indexBuffer->readRequest( 0, indexCount );
             const void* pIdx = asyncTicket->map();
+            const uint8 paddingStart = writeBufferPaddingStart();
             if (idx32bit)
             {
                 const uint32* pIdx32 = static_cast<const uint32*>(pIdx);
@@ -372,6 +407,7 @@ namespace Ogre {
                 const uint16* pIdx16 = static_cast<const uint16*>(pIdx);
                 writeShorts(pIdx16, indexCount);
             }
+            writeBufferPaddingEnd( paddingStart );
             asyncTicket->unmap();
         }
     }
@@ -431,6 +467,8 @@ namespace Ogre {
             {
                 size_t size = MSTREAM_OVERHEAD_SIZE + (sizeof(uint8)* 2) +
                                 vertexData[i]->getTotalSizeBytes();
+                if( mAlignedBuffers )
+                    size += MSTREAM_BUFFER_ALIGNMENT;
 
                 pushInnerChunk(mStream);
                 writeChunkHeader(M_SUBMESH_M_GEOMETRY_VERTEX_BUFFER, size);
@@ -447,6 +485,8 @@ namespace Ogre {
 
                 const void* data = asyncTicket->map();
 
+                const uint8 paddingStart = writeBufferPaddingStart();
+
                 if (mFlipEndian)
                 {
                     // endian conversion
@@ -468,6 +508,8 @@ namespace Ogre {
                                vertexData[i]->getNumElements() );
                 }
 
+                writeBufferPaddingEnd( paddingStart );
+
                 asyncTicket->unmap();
 
                 popInnerChunk(mStream);
@@ -524,6 +566,20 @@ namespace Ogre {
         // Submesh name table
         size += calcSubMeshNameTableSize(pMesh);
 
+        // Meshlets
+        for (uint16 i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            if( pMesh->getSubMesh(i)->hasMeshlets() )
+                size += calcSubMeshMeshletsSize( pMesh->getSubMesh(i) );
+        }
+
+        // Submesh bounds
+        for (uint16 i = 0; i < pMesh->getNumSubMeshes(); ++i)
+        {
+            if( pMesh->getSubMesh(i)->hasAabb() )
+                size += calcSubMeshBoundsSize();
+        }
+
         // Edge list
         /*if (pMesh->isEdgeListBuilt())
         {
@@ -576,7 +632,11 @@ namespace Ogre {
 
         const IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
         if( indexBuffer )
+        {
             size += indexBuffer->getTotalSizeBytes();
+            if( mAlignedBuffers )
+                size += MSTREAM_BUFFER_ALIGNMENT;
+        }
 
         if( !skipVertexBuffer )
         {
@@ -621,6 +681,8 @@ namespace Ogre {
             while( itor != end )
             {
                 size += (*itor)->getTotalSizeBytes();
+                if( mAlignedBuffers )
+                    size += MSTREAM_BUFFER_ALIGNMENT;
                 ++itor;
             }
         }
@@ -715,7 +777,9 @@ namespace Ogre {
                 (streamID == M_SUBMESH ||
                  streamID == M_MESH_SKELETON_LINK ||
                  streamID == M_MESH_BOUNDS ||
-                 streamID == M_SUBMESH_NAME_TABLE /*||
+                 streamID == M_SUBMESH_NAME_TABLE ||
+                 streamID == M_SUBMESH_MESHLETS ||
+                 streamID == M_SUBMESH_BOUNDS /*||
                  streamID == M_EDGE_LISTS ||
                  streamID == M_POSES ||
                  streamID == M_ANIMATIONS*/))
@@ -737,6 +801,12 @@ namespace Ogre {
                 case M_SUBMESH_NAME_TABLE:
                     readSubMeshNameTable(stream, pMesh);
                     break;
+                case M_SUBMESH_MESHLETS:
+                    readSubMeshMeshlets(stream, pMesh);
+                    break;
+                case M_SUBMESH_BOUNDS:
+                    readSubMeshBounds(stream, pMesh);
+                    break;
                 /*case M_EDGE_LISTS:
                     readEdgeList(stream, pMesh);
                     break;
@@ -836,12 +906,12 @@ namespace Ogre {
                 Uint8Vec::iterator it = itor->vertexBuffers.begin();
                 Uint8Vec::iterator en = itor->vertexBuffers.end();
 
-                while( it != en )
+                while( it != en && !itor->vertexDataInView )
                     OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
 
                 itor->vertexBuffers.clear();
 
-                if( itor->indexData )
+                if( itor->indexData && !itor->indexDataInView )
                 {
                     OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
                     itor->indexData = 0;
@@ -883,7 +953,8 @@ namespace Ogre {
 
                     if( !sm->mParent->isVertexBufferShadowed() )
                     {
-                        OGRE_FREE_SIMD( submeshLods[i].vertexBuffers[0], MEMCATEGORY_GEOMETRY );
+                        if( !subMeshLod.vertexDataInView )
+                            OGRE_FREE_SIMD( submeshLods[i].vertexBuffers[0], MEMCATEGORY_GEOMETRY );
                         submeshLods[i].vertexBuffers.erase( submeshLods[i].vertexBuffers.begin() );
                     }
 
@@ -927,7 +998,8 @@ namespace Ogre {
 
                 if( !sm->mParent->isIndexBufferShadowed() )
                 {
-                    OGRE_FREE_SIMD( subMeshLod.indexData, MEMCATEGORY_GEOMETRY );
+                    if( !subMeshLod.indexDataInView )
+                        OGRE_FREE_SIMD( subMeshLod.indexData, MEMCATEGORY_GEOMETRY );
                     submeshLods[ i ].indexData = 0;
                 }
             }
@@ -1014,7 +1086,14 @@ namespace Ogre {
         {
             readBools( stream, &subLod->index32Bit, 1 );
 
-            if( subLod->index32Bit )
+            const uint8 paddingStart = readBufferPaddingStart( stream );
+
+            const size_t bytesPerIndex = subLod->index32Bit ? sizeof(uint32) : sizeof(uint16);
+            subLod->indexData = getBufferFromView( stream, mIndexDataView,
+                                                   bytesPerIndex * subLod->numIndices );
+            if( subLod->indexData )
+                subLod->indexDataInView = true;
+            else if( subLod->index32Bit )
             {
                 subLod->indexData = OGRE_MALLOC_SIMD( sizeof(uint32) * subLod->numIndices,
                                                       MEMCATEGORY_GEOMETRY );
@@ -1026,6 +1105,8 @@ namespace Ogre {
                                                       MEMCATEGORY_GEOMETRY );
                 readShorts(stream, reinterpret_cast<uint16*>(subLod->indexData), subLod->numIndices);
             }
+
+            readBufferPaddingEnd( stream, paddingStart );
         }
     }
     //---------------------------------------------------------------------
@@ -1121,16 +1202,98 @@ namespace Ogre {
                         "MeshSerializerImpl::readVertexBuffer");
         }
 
-        uint8 *vertexData = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD(
-                                sizeof(uint8) * bytesPerVertex * subLod->numVertices,
-                                MEMCATEGORY_GEOMETRY ) );
-        subLod->vertexBuffers[source] = vertexData;
+        const uint8 paddingStart = readBufferPaddingStart( stream );
+
+        const size_t sizeBytes = bytesPerVertex * subLod->numVertices;
+        uint8 *vertexData = getBufferFromView( stream, mVertexDataView, sizeBytes );
+
+        if( vertexData )
+        {
+            //All sources of a LOD come from the same place
+            subLod->vertexDataInView = true;
+            subLod->vertexBuffers[source] = vertexData;
+        }
+        else
+        {
+            vertexData = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD( sizeof(uint8) * sizeBytes,
+                                                                     MEMCATEGORY_GEOMETRY ) );
+            subLod->vertexBuffers[source] = vertexData;
+
+            stream->read( vertexData, sizeBytes );
+
+            // Endian conversion
+            flipLittleEndian( vertexData, subLod->numVertices, bytesPerVertex,
+                              vertexElements );
+        }
+
+        readBufferPaddingEnd( stream, paddingStart );
+    }
+    //---------------------------------------------------------------------
+    uint8 MeshSerializerImpl::writeBufferPaddingStart(void)
+    {
+        if( !mAlignedBuffers )
+            return 0;
+
+        const size_t dataStart = mStream->tell() + 1u;
+        const uint8 paddingStart = static_cast<uint8>(
+                    (MSTREAM_BUFFER_ALIGNMENT - (dataStart % MSTREAM_BUFFER_ALIGNMENT)) %
+                    MSTREAM_BUFFER_ALIGNMENT );
+        const uint8 zeroes[MSTREAM_BUFFER_ALIGNMENT] = { 0 };
+
+        writeData( &paddingStart, 1, 1 );
+        writeData( zeroes, 1, paddingStart );
+        return paddingStart;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeBufferPaddingEnd( uint8 paddingStart )
+    {
+        if( !mAlignedBuffers )
+            return;
 
-        stream->read( vertexData, bytesPerVertex * subLod->numVertices );
+        const uint8 zeroes[MSTREAM_BUFFER_ALIGNMENT] = { 0 };
+        writeData( zeroes, 1, MSTREAM_BUFFER_ALIGNMENT - 1u - paddingStart );
+    }
+    //---------------------------------------------------------------------
+    uint8 MeshSerializerImpl::readBufferPaddingStart( DataStreamPtr &stream )
+    {
+        if( !mAlignedBuffers )
+            return 0;
 
-        // Endian conversion
-        flipLittleEndian( vertexData, subLod->numVertices, bytesPerVertex,
-                          vertexElements );
+        uint8 paddingStart;
+        readChar( stream, &paddingStart );
+        if( paddingStart >= MSTREAM_BUFFER_ALIGNMENT )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Invalid buffer padding. The mesh is corrupt: " + stream->getName(),
+                         "MeshSerializerImpl::readBufferPaddingStart" );
+        }
+        stream->skip( paddingStart );
+        return paddingStart;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readBufferPaddingEnd( DataStreamPtr &stream, uint8 paddingStart )
+    {
+        if( mAlignedBuffers )
+            stream->skip( static_cast<long>( MSTREAM_BUFFER_ALIGNMENT - 1u - paddingStart ) );
+    }
+    //---------------------------------------------------------------------
+    uint8* MeshSerializerImpl::getBufferFromView( DataStreamPtr &stream, const uint8 *dataView,
+                                                  size_t sizeBytes )
+    {
+        if( !dataView )
+            return 0;
+
+        const size_t offset = stream->tell();
+        if( offset + sizeBytes > stream->size() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Buffer goes past the end of file. The mesh is corrupt: " +
+                         stream->getName(), "MeshSerializerImpl::getBufferFromView" );
+        }
+
+        stream->skip( static_cast<long>( sizeBytes ) );
+        //VaoManager only reads from initialData unless it's kept as shadow
+        return const_cast<uint8*>( dataView + offset );
     }
     //---------------------------------------------------------------------
     void MeshSerializerImpl::readSubMeshLodOperation( DataStreamPtr& stream,
@@ -1221,6 +1384,107 @@ namespace Ogre {
         return size;
     }
     //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeSubMeshMeshlets( const SubMesh *s, uint16 subMeshIdx )
+    {
+        writeChunkHeader( M_SUBMESH_MESHLETS, calcSubMeshMeshletsSize( s ) );
+
+        const SubMesh::MeshletVec &meshlets = s->getMeshlets();
+
+        writeShorts( &subMeshIdx, 1 );
+        const uint32 numMeshlets = static_cast<uint32>( meshlets.size() );
+        writeInts( &numMeshlets, 1 );
+
+        SubMesh::MeshletVec::const_iterator itor = meshlets.begin();
+        SubMesh::MeshletVec::const_iterator end  = meshlets.end();
+
+        while( itor != end )
+        {
+            writeInts( &itor->indexStart, 1 );
+            writeInts( &itor->indexCount, 1 );
+            writeFloats( itor->center.ptr(), 3 );
+            writeFloats( &itor->radius, 1 );
+            writeFloats( itor->coneAxis.ptr(), 3 );
+            writeFloats( &itor->coneCutoff, 1 );
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readSubMeshMeshlets( DataStreamPtr& stream, Mesh* pMesh )
+    {
+        uint16 subMeshIdx = 0;
+        readShorts( stream, &subMeshIdx, 1 );
+        uint32 numMeshlets = 0;
+        readInts( stream, &numMeshlets, 1 );
+
+        if( subMeshIdx >= pMesh->getNumSubMeshes() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Meshlets reference a submesh that doesn't exist in " + pMesh->getName(),
+                         "MeshSerializerImpl::readSubMeshMeshlets" );
+        }
+
+        SubMesh::MeshletVec &meshlets = pMesh->getSubMesh( subMeshIdx )->mMeshlets;
+        meshlets.resize( numMeshlets );
+
+        SubMesh::MeshletVec::iterator itor = meshlets.begin();
+        SubMesh::MeshletVec::iterator end  = meshlets.end();
+
+        while( itor != end )
+        {
+            readInts( stream, &itor->indexStart, 1 );
+            readInts( stream, &itor->indexCount, 1 );
+            readFloats( stream, itor->center.ptr(), 3 );
+            readFloats( stream, &itor->radius, 1 );
+            readFloats( stream, itor->coneAxis.ptr(), 3 );
+            readFloats( stream, &itor->coneCutoff, 1 );
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcSubMeshMeshletsSize( const SubMesh *s )
+    {
+        size_t size = MSTREAM_OVERHEAD_SIZE;
+        size += sizeof(uint16) + sizeof(uint32);
+        size += s->getMeshlets().size() * (sizeof(uint32) * 2u + sizeof(float) * 8u);
+        return size;
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::writeSubMeshBounds( const SubMesh *s, uint16 subMeshIdx )
+    {
+        writeChunkHeader( M_SUBMESH_BOUNDS, calcSubMeshBoundsSize() );
+
+        const Aabb &aabb = s->getAabb();
+        writeShorts( &subMeshIdx, 1 );
+        writeFloats( aabb.mCenter.ptr(), 3 );
+        writeFloats( aabb.mHalfSize.ptr(), 3 );
+    }
+    //---------------------------------------------------------------------
+    void MeshSerializerImpl::readSubMeshBounds( DataStreamPtr& stream, Mesh* pMesh )
+    {
+        uint16 subMeshIdx = 0;
+        readShorts( stream, &subMeshIdx, 1 );
+
+        Vector3 center, halfSize;
+        readFloats( stream, center.ptr(), 3 );
+        readFloats( stream, halfSize.ptr(), 3 );
+
+        if( subMeshIdx >= pMesh->getNumSubMeshes() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "SubMesh bounds reference a submesh that doesn't exist in " +
+                         pMesh->getName(), "MeshSerializerImpl::readSubMeshBounds" );
+        }
+
+        pMesh->getSubMesh( subMeshIdx )->_setAabb( Aabb( center, halfSize ) );
+    }
+    //---------------------------------------------------------------------
+    size_t MeshSerializerImpl::calcSubMeshBoundsSize(void)
+    {
+        size_t size = MSTREAM_OVERHEAD_SIZE;
+        size += sizeof(uint16) + sizeof(float) * 6u;
+        return size;
+    }
+    //---------------------------------------------------------------------
     void MeshSerializerImpl::flipLittleEndian( void* pData, VertexBufferPacked *vertexBuffer )
     {
         flipLittleEndian( pData, vertexBuffer->getNumElements(), vertexBuffer->getBytesPerElement(),
@@ -2181,7 +2445,9 @@ namespace Ogre {
         lodSource( 0 ),
         index32Bit( false ),
         numIndices( 0 ),
-        indexData( 0 )
+        indexData( 0 ),
+        vertexDataInView( false ),
+        indexDataInView( false )
     {
     }
 
@@ -2189,11 +2455,25 @@ namespace Ogre {
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
     //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R2::MeshSerializerImpl_v2_1_R2( VaoManager *vaoManager ) :
+        MeshSerializerImpl( vaoManager )
+    {
+        // Version number
+        // R2 is identical to R3 minus the padding around buffers and the optional chunks.
+        mVersion = "[MeshSerializer_v2.1 R2]";
+        mAlignedBuffers = false;
+    }
+    //---------------------------------------------------------------------
+    MeshSerializerImpl_v2_1_R2::~MeshSerializerImpl_v2_1_R2()
+    {
+    }
+    //---------------------------------------------------------------------
     MeshSerializerImpl_v2_1_R1::MeshSerializerImpl_v2_1_R1( VaoManager *vaoManager ) :
         MeshSerializerImpl( vaoManager )
     {
         // Version number
         mVersion = "[MeshSerializer_v2.1 R1]";
+        mAlignedBuffers = false;
     }
     //---------------------------------------------------------------------
     MeshSerializerImpl_v2_1_R1::~MeshSerializerImpl_v2_1_R1()
@@ -2252,12 +2532,12 @@ namespace Ogre {
                 Uint8Vec::iterator it = itor->vertexBuffers.begin();
                 Uint8Vec::iterator en = itor->vertexBuffers.end();
 
-                while( it != en )
+                while( it != en && !itor->vertexDataInView )
                     OGRE_FREE_SIMD( *it++, MEMCATEGORY_GEOMETRY );
 
                 itor->vertexBuffers.clear();
 
-                if( itor->indexData )
+                if( itor->indexData && !itor->indexDataInView )
                 {
                     OGRE_FREE_SIMD( itor->indexData, MEMCATEGORY_GEOMETRY );
                     itor->indexData = 0;
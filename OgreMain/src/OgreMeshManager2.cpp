@@ -37,6 +37,9 @@ THE SOFTWARE.
 #include "OgreException.h"
 
 #include "OgrePrefabFactory.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreLogManager.h"
+#include "OgreTimer.h"
 
 namespace Ogre
 {
@@ -52,6 +55,9 @@ namespace Ogre
     }
     //-----------------------------------------------------------------------
     MeshManager::MeshManager() :
+        mAsyncArchiveReader( 0 ),
+        mNumAsyncLoadThreads( 2u ),
+        mAsyncLoadTimeBudget( 4000u ),
         mVaoManager( 0 ),
         mBoundsPaddingFactor( 0.01 )/*,
         mListener( 0 )*/
@@ -64,6 +70,20 @@ namespace Ogre
     //-----------------------------------------------------------------------
     MeshManager::~MeshManager()
     {
+        //Finishes pending reads, which still reference mAsyncLoads
+        OGRE_DELETE mAsyncArchiveReader;
+        mAsyncArchiveReader = 0;
+
+        AsyncLoadVec::const_iterator itor = mAsyncLoads.begin();
+        AsyncLoadVec::const_iterator end  = mAsyncLoads.end();
+        while( itor != end )
+        {
+            (*itor)->mesh->setBackgroundLoaded( false );
+            OGRE_DELETE_T( *itor, AsyncLoad, MEMCATEGORY_RESOURCE );
+            ++itor;
+        }
+        mAsyncLoads.clear();
+
         ResourceGroupManager::getSingleton()._unregisterResourceManager(mResourceType);
     }
     //-----------------------------------------------------------------------
@@ -128,6 +148,185 @@ namespace Ogre
         return pMesh;
     }
     //-----------------------------------------------------------------------
+    MeshPtr MeshManager::loadAsync( const String& filename, const String& groupName,
+                                    AsyncLoadListener *listener,
+                                    BufferType vertexBufferType,
+                                    BufferType indexBufferType,
+                                    bool vertexBufferShadowed, bool indexBufferShadowed )
+    {
+        MeshPtr pMesh = createOrRetrieve( filename, groupName, false, 0, 0,
+                                          vertexBufferType, indexBufferType,
+                                          vertexBufferShadowed, indexBufferShadowed ).
+                        first.staticCast<Mesh>();
+
+        if( pMesh->isLoaded() )
+        {
+            if( listener )
+                listener->meshLoaded( pMesh );
+            return pMesh;
+        }
+
+        AsyncLoadVec::const_iterator itor = mAsyncLoads.begin();
+        AsyncLoadVec::const_iterator end  = mAsyncLoads.end();
+        while( itor != end && (*itor)->mesh != pMesh )
+            ++itor;
+
+        if( itor != end )
+        {
+            //Already being loaded
+            if( listener )
+                (*itor)->listeners.push_back( listener );
+            return pMesh;
+        }
+
+        AsyncLoad *asyncLoad = OGRE_NEW_T( AsyncLoad, MEMCATEGORY_RESOURCE )();
+        asyncLoad->manager = this;
+        asyncLoad->mesh = pMesh;
+        if( listener )
+            asyncLoad->listeners.push_back( listener );
+        asyncLoad->readFinished = false;
+        mAsyncLoads.push_back( asyncLoad );
+
+        pMesh->setBackgroundLoaded( true );
+
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+
+        //Only read in the background what openResource would read from an Archive.
+        //Anything else (i.e. a ResourceLoadingListener) is dealt with by Mesh::prepareImpl.
+        Archive *archive = 0;
+        if( !resourceGroupManager.getLoadingListener() )
+        {
+            try
+            {
+                String group = pMesh->getGroup();
+                if( group == ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME )
+                    group = resourceGroupManager.findGroupContainingResource( filename );
+                archive = resourceGroupManager._getArchiveToResource( filename, group );
+            }
+            catch( Exception & )
+            {
+                //Mesh::prepareImpl will raise it again, when finishing the load
+            }
+        }
+
+        if( archive )
+        {
+            if( !mAsyncArchiveReader )
+            {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+                mAsyncArchiveReader = OGRE_NEW AsyncArchiveReader( mNumAsyncLoadThreads );
+#else
+                mAsyncArchiveReader = OGRE_NEW AsyncArchiveReader( 0u );
+#endif
+            }
+            mAsyncArchiveReader->queueRead( archive, filename, asyncLoad );
+        }
+        else
+        {
+            asyncLoad->readFinished = true;
+        }
+
+        return pMesh;
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::AsyncLoad::readCompleted( AsyncArchiveReader::ReadRequest &request )
+    {
+        manager->mAsyncLoadsMutex.lock();
+        data = request.data;
+        readFinished = true;
+        manager->mAsyncLoadsMutex.unlock();
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::finishAsyncLoad( AsyncLoad *asyncLoad )
+    {
+        MeshPtr pMesh = asyncLoad->mesh;
+
+        //If the read failed, prepareImpl tries again, and raises the error
+        if( asyncLoad->data )
+            pMesh->_setFreshFromDisk( asyncLoad->data );
+        asyncLoad->data.setNull();
+
+        try
+        {
+            pMesh->load( true );
+        }
+        catch( Exception &e )
+        {
+            LogManager::getSingleton().logMessage( "Failed to load mesh '" + pMesh->getName() +
+                                                   "' asynchronously: " + e.getFullDescription(),
+                                                   LML_CRITICAL );
+        }
+
+        pMesh->setBackgroundLoaded( false );
+        mAsyncLoads.erase( std::find( mAsyncLoads.begin(), mAsyncLoads.end(), asyncLoad ) );
+
+        AsyncLoadListenerVec listeners;
+        listeners.swap( asyncLoad->listeners );
+        OGRE_DELETE_T( asyncLoad, AsyncLoad, MEMCATEGORY_RESOURCE );
+
+        //Let Items waiting for this mesh build themselves
+        if( pMesh->isLoaded() )
+            pMesh->_fireLoadingComplete( true );
+
+        AsyncLoadListenerVec::const_iterator itor = listeners.begin();
+        AsyncLoadListenerVec::const_iterator end  = listeners.end();
+        while( itor != end )
+        {
+            (*itor)->meshLoaded( pMesh );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::_updateAsyncLoads( bool waitForAll )
+    {
+        if( mAsyncLoads.empty() )
+            return;
+
+        Timer timer;
+        bool budgetExhausted = false;
+
+        while( !mAsyncLoads.empty() && !budgetExhausted )
+        {
+            AsyncLoad *nextLoad = 0;
+
+            mAsyncLoadsMutex.lock();
+            AsyncLoadVec::const_iterator itor = mAsyncLoads.begin();
+            AsyncLoadVec::const_iterator end  = mAsyncLoads.end();
+            while( itor != end && !nextLoad )
+            {
+                if( (*itor)->readFinished )
+                    nextLoad = *itor;
+                ++itor;
+            }
+            mAsyncLoadsMutex.unlock();
+
+            if( nextLoad )
+            {
+                //Listeners may start more loads; that's fine, we'll get to them
+                finishAsyncLoad( nextLoad );
+                budgetExhausted = !waitForAll && timer.getMicroseconds() >= mAsyncLoadTimeBudget;
+            }
+            else if( waitForAll )
+            {
+                //Everything left is still being read
+                Threads::Sleep( 1u );
+            }
+            else
+            {
+                budgetExhausted = true;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void MeshManager::setNumAsyncLoadThreads( uint32 numThreads )
+    {
+        mNumAsyncLoadThreads = numThreads;
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( mAsyncArchiveReader )
+            mAsyncArchiveReader->setNumThreads( numThreads );
+#endif
+    }
+    //-----------------------------------------------------------------------
     MeshPtr MeshManager::create( const String& name, const String& group,
                                     bool isManual, ManualResourceLoader* loader,
                                     const NameValuePairList* createParams)
@@ -0,0 +1,356 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreMeshOptimiser.h"
+
+#include "ogrestd/vector.h"
+
+namespace Ogre
+{
+    namespace
+    {
+        struct ClusterSortKey
+        {
+            Real    key;
+            uint32  clusterIdx;
+
+            bool operator < ( const ClusterSortKey &other ) const
+            {
+                //Descending: outward facing clusters go first.
+                return key > other.key;
+            }
+        };
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimiser::optimiseVertexCache( uint32 *indices, size_t numIndices, size_t numVertices,
+                                             uint32 cacheSize )
+    {
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles < 2u || numVertices == 0u )
+            return;
+
+        //Build the vertex -> triangle adjacency, and the number of live (not yet
+        //emitted) triangles each vertex belongs to.
+        vector<uint32>::type liveTriangles( numVertices, 0u );
+        vector<uint32>::type adjacencyOffsets( numVertices + 1u, 0u );
+        for( size_t i=0; i<numTriangles * 3u; ++i )
+        {
+            assert( indices[i] < numVertices && "Index out of bounds" );
+            ++liveTriangles[indices[i]];
+        }
+
+        for( size_t i=0; i<numVertices; ++i )
+            adjacencyOffsets[i + 1u] = adjacencyOffsets[i] + liveTriangles[i];
+
+        vector<uint32>::type adjacency( numTriangles * 3u );
+        {
+            vector<uint32>::type writePos( adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 );
+            for( size_t i=0; i<numTriangles * 3u; ++i )
+                adjacency[writePos[indices[i]]++] = static_cast<uint32>( i / 3u );
+        }
+
+        //Timestamps start far enough in the past for every vertex to be a miss.
+        vector<uint32>::type cacheTimestamps( numVertices, 0u );
+        uint32 timestamp = cacheSize + 1u;
+
+        vector<bool>::type emitted( numTriangles, false );
+        vector<uint32>::type deadEndStack;
+        deadEndStack.reserve( numTriangles * 3u );
+        vector<uint32>::type candidates;
+        candidates.reserve( 64u );
+
+        vector<uint32>::type outIndices;
+        outIndices.reserve( numTriangles * 3u );
+
+        size_t scanCursor = 0;
+        size_t fanningVertex = 0;
+
+        while( fanningVertex != numVertices )
+        {
+            candidates.clear();
+
+            //Emit all the remaining triangles around the fanning vertex
+            for( uint32 j=adjacencyOffsets[fanningVertex]; j<adjacencyOffsets[fanningVertex + 1u]; ++j )
+            {
+                const uint32 triIdx = adjacency[j];
+                if( !emitted[triIdx] )
+                {
+                    for( size_t k=0; k<3u; ++k )
+                    {
+                        const uint32 vertexIdx = indices[triIdx * 3u + k];
+                        outIndices.push_back( vertexIdx );
+                        deadEndStack.push_back( vertexIdx );
+                        candidates.push_back( vertexIdx );
+                        --liveTriangles[vertexIdx];
+
+                        if( timestamp - cacheTimestamps[vertexIdx] > cacheSize )
+                            cacheTimestamps[vertexIdx] = timestamp++;
+                    }
+
+                    emitted[triIdx] = true;
+                }
+            }
+
+            //Pick the next fanning vertex: the oldest candidate that will still be
+            //in the cache after emitting all its triangles.
+            size_t bestVertex = numVertices;
+            int32 bestPriority = -1;
+
+            vector<uint32>::type::const_iterator itor = candidates.begin();
+            vector<uint32>::type::const_iterator end  = candidates.end();
+
+            while( itor != end )
+            {
+                const uint32 vertexIdx = *itor;
+                if( liveTriangles[vertexIdx] > 0u )
+                {
+                    int32 priority = 0;
+                    const uint32 age = timestamp - cacheTimestamps[vertexIdx];
+                    if( age + 2u * liveTriangles[vertexIdx] <= cacheSize )
+                        priority = static_cast<int32>( age );
+
+                    if( priority > bestPriority )
+                    {
+                        bestPriority = priority;
+                        bestVertex = vertexIdx;
+                    }
+                }
+
+                ++itor;
+            }
+
+            if( bestVertex == numVertices )
+            {
+                //Dead end. Try recently used vertices first, then whatever is left.
+                while( !deadEndStack.empty() && bestVertex == numVertices )
+                {
+                    const uint32 vertexIdx = deadEndStack.back();
+                    deadEndStack.pop_back();
+                    if( liveTriangles[vertexIdx] > 0u )
+                        bestVertex = vertexIdx;
+                }
+
+                while( scanCursor < numVertices && bestVertex == numVertices )
+                {
+                    if( liveTriangles[scanCursor] > 0u )
+                        bestVertex = scanCursor;
+                    ++scanCursor;
+                }
+            }
+
+            fanningVertex = bestVertex;
+        }
+
+        assert( outIndices.size() == numTriangles * 3u );
+        memcpy( indices, &outIndices[0], outIndices.size() * sizeof(uint32) );
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimiser::optimiseOverdraw( uint32 *indices, size_t numIndices,
+                                          const Vector3 *positions, size_t numVertices,
+                                          Real threshold, uint32 cacheSize )
+    {
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles < 2u || numVertices == 0u )
+            return;
+
+        const Real acmrThreshold = calculateAcmr( indices, numIndices, numVertices, cacheSize ) *
+                                   threshold;
+
+        //Split the list into clusters. Hard boundaries are where the cache gets flushed
+        //anyway (all 3 vertices miss). Soft boundaries are where the cluster, drawn on its
+        //own with an empty cache, stays within the ACMR threshold.
+        vector<uint32>::type clusterStarts;
+        clusterStarts.push_back( 0u );
+
+        vector<uint32>::type cacheTimestamps( numVertices, 0u );
+        vector<uint32>::type clusterCacheTimestamps( numVertices, 0u );
+        uint32 timestamp        = cacheSize + 1u;
+        uint32 clusterTimestamp = cacheSize + 1u;
+        size_t clusterMisses    = 0;
+        size_t clusterTriangles = 0;
+
+        for( size_t i=0; i<numTriangles; ++i )
+        {
+            size_t misses = 0;
+            for( size_t k=0; k<3u; ++k )
+            {
+                const uint32 vertexIdx = indices[i * 3u + k];
+                if( timestamp - cacheTimestamps[vertexIdx] > cacheSize )
+                {
+                    cacheTimestamps[vertexIdx] = timestamp++;
+                    ++misses;
+                }
+            }
+
+            if( misses == 3u && clusterTriangles > 0u )
+            {
+                clusterStarts.push_back( static_cast<uint32>( i ) );
+                clusterTimestamp += cacheSize + 1u; //Flush
+                clusterMisses = 0;
+                clusterTriangles = 0;
+            }
+
+            for( size_t k=0; k<3u; ++k )
+            {
+                const uint32 vertexIdx = indices[i * 3u + k];
+                if( clusterTimestamp - clusterCacheTimestamps[vertexIdx] > cacheSize )
+                {
+                    clusterCacheTimestamps[vertexIdx] = clusterTimestamp++;
+                    ++clusterMisses;
+                }
+            }
+            ++clusterTriangles;
+
+            if( i + 1u < numTriangles &&
+                Real( clusterMisses ) <= acmrThreshold * Real( clusterTriangles ) )
+            {
+                clusterStarts.push_back( static_cast<uint32>( i + 1u ) );
+                clusterTimestamp += cacheSize + 1u; //Flush
+                clusterMisses = 0;
+                clusterTriangles = 0;
+            }
+        }
+
+        const size_t numClusters = clusterStarts.size();
+        if( numClusters < 2u )
+            return;
+
+        clusterStarts.push_back( static_cast<uint32>( numTriangles ) );
+
+        Vector3 meshCentroid( Vector3::ZERO );
+        for( size_t i=0; i<numTriangles * 3u; ++i )
+            meshCentroid += positions[indices[i]];
+        meshCentroid /= Real( numTriangles * 3u );
+
+        //Sort the clusters by how much they face away from the mesh center.
+        vector<ClusterSortKey>::type sortKeys;
+        sortKeys.reserve( numClusters );
+
+        for( size_t i=0; i<numClusters; ++i )
+        {
+            Vector3 centroid( Vector3::ZERO );
+            Vector3 normal( Vector3::ZERO );
+            Real totalArea = 0;
+
+            for( size_t j=clusterStarts[i]; j<clusterStarts[i + 1u]; ++j )
+            {
+                const Vector3 &p0 = positions[indices[j * 3u + 0u]];
+                const Vector3 &p1 = positions[indices[j * 3u + 1u]];
+                const Vector3 &p2 = positions[indices[j * 3u + 2u]];
+
+                const Vector3 triNormal = (p1 - p0).crossProduct( p2 - p0 );
+                const Real area = triNormal.length();
+
+                centroid    += (p0 + p1 + p2) * (area / 3.0f);
+                normal      += triNormal;
+                totalArea   += area;
+            }
+
+            if( totalArea > 0 )
+                centroid /= totalArea;
+            else
+                centroid = positions[indices[clusterStarts[i] * 3u]];
+            normal.normalise();
+
+            ClusterSortKey sortKey;
+            sortKey.key         = (centroid - meshCentroid).dotProduct( normal );
+            sortKey.clusterIdx  = static_cast<uint32>( i );
+            sortKeys.push_back( sortKey );
+        }
+
+        std::stable_sort( sortKeys.begin(), sortKeys.end() );
+
+        vector<uint32>::type outIndices;
+        outIndices.reserve( numTriangles * 3u );
+
+        vector<ClusterSortKey>::type::const_iterator itor = sortKeys.begin();
+        vector<ClusterSortKey>::type::const_iterator end  = sortKeys.end();
+
+        while( itor != end )
+        {
+            outIndices.insert( outIndices.end(),
+                               indices + clusterStarts[itor->clusterIdx] * 3u,
+                               indices + clusterStarts[itor->clusterIdx + 1u] * 3u );
+            ++itor;
+        }
+
+        memcpy( indices, &outIndices[0], outIndices.size() * sizeof(uint32) );
+    }
+    //-----------------------------------------------------------------------------------
+    void MeshOptimiser::optimiseVertexFetch( uint32 *indices, size_t numIndices, size_t numVertices,
+                                             FastArray<uint32> &outOldToNew )
+    {
+        const uint32 unassigned = std::numeric_limits<uint32>::max();
+
+        outOldToNew.clear();
+        outOldToNew.resizePOD( numVertices, unassigned );
+
+        uint32 nextVertexIdx = 0;
+        for( size_t i=0; i<numIndices; ++i )
+        {
+            assert( indices[i] < numVertices && "Index out of bounds" );
+            uint32 &newIdx = outOldToNew[indices[i]];
+            if( newIdx == unassigned )
+                newIdx = nextVertexIdx++;
+            indices[i] = newIdx;
+        }
+
+        //Unreferenced vertices go last, in their original order.
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            if( outOldToNew[i] == unassigned )
+                outOldToNew[i] = nextVertexIdx++;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    Real MeshOptimiser::calculateAcmr( const uint32 *indices, size_t numIndices, size_t numVertices,
+                                       uint32 cacheSize )
+    {
+        const size_t numTriangles = numIndices / 3u;
+        if( numTriangles == 0u )
+            return 0;
+
+        vector<uint32>::type cacheTimestamps( numVertices, 0u );
+        uint32 timestamp = cacheSize + 1u;
+        size_t misses = 0;
+
+        for( size_t i=0; i<numTriangles * 3u; ++i )
+        {
+            const uint32 vertexIdx = indices[i];
+            if( timestamp - cacheTimestamps[vertexIdx] > cacheSize )
+            {
+                cacheTimestamps[vertexIdx] = timestamp++;
+                ++misses;
+            }
+        }
+
+        return Real( misses ) / Real( numTriangles );
+    }
+}
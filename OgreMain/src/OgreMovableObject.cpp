@@ -54,6 +54,9 @@ namespace Ogre {
     uint32 MovableObject::msDefaultQueryFlags = 0xFFFFFFFF;
     uint32 MovableObject::msDefaultVisibilityFlags = 0xFFFFFFFF & (~LAYER_VISIBILITY);
     uint32 MovableObject::msDefaultLightMask = 0xFFFFFFFF;
+#if OGRE_COMPACT_OBJECT_HANDLES
+    CompactObjectHandleTable MovableObject::msCompactHandles;
+#endif
     //-----------------------------------------------------------------------
     MovableObject::MovableObject( IdType id, ObjectMemoryManager *objectMemoryManager,
                                   SceneManager *manager, uint8 renderQueueId )
@@ -63,15 +66,22 @@ namespace Ogre {
         , mManager( manager )
         , mLodMesh( &c_DefaultLodMesh )
         , mCurrentMeshLod( 0 )
+        , mRenderableAabbs( 0 )
+        , mPortalZone( 0xFFFF )
         , mMinPixelSize(0)
-        , mListener(0)
         , mSkeletonInstance( 0 )
         , mObjectMemoryManager( objectMemoryManager )
+        , mListener(0)
+        , mPrevFrameTransform( 0 )
         , mGlobalIndex( -1 )
         , mParentIndex( -1 )
     {
         assert( renderQueueId <= 254 );
 
+#if OGRE_COMPACT_OBJECT_HANDLES
+        mCompactHandle = msCompactHandles.add( this );
+#endif
+
         if (Root::getSingletonPtr())
             mMinPixelSize = Root::getSingleton().getDefaultMinPixelSize();
 
@@ -87,13 +97,19 @@ namespace Ogre {
         , mManager(0)
         , mLodMesh( &c_DefaultLodMesh )
         , mCurrentMeshLod( 0 )
+        , mRenderableAabbs( 0 )
+        , mPortalZone( 0xFFFF )
         , mMinPixelSize(0)
-        , mListener(0)
         , mSkeletonInstance( 0 )
         , mObjectMemoryManager( 0 )
+        , mListener(0)
+        , mPrevFrameTransform( 0 )
         , mGlobalIndex( -1 )
         , mParentIndex( -1 )
     {
+#if OGRE_COMPACT_OBJECT_HANDLES
+        mCompactHandle = msCompactHandles.add( this );
+#endif
         if (Root::getSingletonPtr())
             mMinPixelSize = Root::getSingleton().getDefaultMinPixelSize();
     }
@@ -116,8 +132,18 @@ namespace Ogre {
         if( mObjectMemoryManager )
             mObjectMemoryManager->objectDestroyed( mObjectData, mRenderQueueID );
 
+        if( mPrevFrameTransform )
+        {
+            OGRE_DELETE_T( mPrevFrameTransform, PrevFrameTransform, MEMCATEGORY_SCENE_OBJECTS );
+            mPrevFrameTransform = 0;
+        }
+
         //If derived class may have created it, it should've destroyed it by now.
         assert( !mSkeletonInstance );
+
+#if OGRE_COMPACT_OBJECT_HANDLES
+        msCompactHandles.remove( mCompactHandle );
+#endif
     }
     //-----------------------------------------------------------------------
     void MovableObject::_notifyAttached( Node* parent )
@@ -133,6 +159,7 @@ namespace Ogre {
                 mObjectData.mParents[mObjectData.mIndex] = parent;
             else
                 mObjectData.mParents[mObjectData.mIndex] = mObjectMemoryManager->_getDummyNode();
+            mObjectData.invalidateBounds();
 
             setVisible( parent != 0 );
 
@@ -288,10 +315,36 @@ namespace Ogre {
         return mParentNode->_getFullTransform();
     }
     //-----------------------------------------------------------------------
+    const Matrix4& MovableObject::_getPrevFrameParentNodeFullTransform( uint32 frameCount ) const
+    {
+        const Matrix4 &currentTransform = mParentNode->_getFullTransform();
+
+        if( !mPrevFrameTransform )
+        {
+            mPrevFrameTransform = OGRE_NEW_T( PrevFrameTransform, MEMCATEGORY_SCENE_OBJECTS );
+            mPrevFrameTransform->prevFrame      = currentTransform;
+            mPrevFrameTransform->currentFrame   = currentTransform;
+            mPrevFrameTransform->lastFrame      = frameCount;
+        }
+        else if( mPrevFrameTransform->lastFrame != frameCount )
+        {
+            //If we weren't queried last frame, our history is too old to be useful
+            if( mPrevFrameTransform->lastFrame + 1u == frameCount )
+                mPrevFrameTransform->prevFrame = mPrevFrameTransform->currentFrame;
+            else
+                mPrevFrameTransform->prevFrame = currentTransform;
+            mPrevFrameTransform->currentFrame   = currentTransform;
+            mPrevFrameTransform->lastFrame      = frameCount;
+        }
+
+        return mPrevFrameTransform->prevFrame;
+    }
+    //-----------------------------------------------------------------------
     void MovableObject::setLocalAabb(const Aabb box)
     {
         mObjectData.mLocalAabb->setFromAabb( box, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = box.getRadius();
+        mObjectData.invalidateBounds();
     }
     //-----------------------------------------------------------------------
     Aabb MovableObject::getLocalAabb() const
@@ -383,7 +436,8 @@ namespace Ogre {
             //achieve even greater speed ups. This function is terribly bounded by memory latency
             //Last tested on:
             //  * Intel Quad Core Extreme QX9650 3Ghz
-            OGRE_PREFETCH_NTA( (const char*)(objData.mParents[OGRE_PREFETCH_SLOT_DISTANCE]) );
+            OGRE_PREFETCH_NTA( (const char*)static_cast<Node*>(
+                                   objData.mParents[OGRE_PREFETCH_SLOT_DISTANCE] ) );
 
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
             {
@@ -424,6 +478,42 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void MovableObject::updateDirtyBounds( const size_t numNodes, ObjectData objData )
+    {
+        ObjectData runStart;
+        size_t runLength = 0;
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            uint8 dirty = 0;
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                const Transform &parentTransform = objData.mParents[j]->_getTransform();
+                dirty |= objData.mBoundsDirty[j];
+                dirty |= parentTransform.mDirtyFlags[parentTransform.mIndex] &
+                         Transform::DerivedChanged;
+                objData.mBoundsDirty[j] = 0;
+            }
+
+            if( dirty )
+            {
+                if( !runLength )
+                    runStart = objData;
+                ++runLength;
+            }
+            else if( runLength )
+            {
+                updateAllBounds( runLength * ARRAY_PACKED_REALS, runStart );
+                runLength = 0;
+            }
+
+            objData.advanceBoundsPack();
+        }
+
+        if( runLength )
+            updateAllBounds( runLength * ARRAY_PACKED_REALS, runStart );
+    }
+    //-----------------------------------------------------------------------
     void MovableObject::cullFrustum( const size_t numNodes, ObjectData objData, const Camera *frustum,
                                      uint32 sceneVisibilityFlags, MovableObjectArray &outCulledObjects,
                                      const Camera *lodCamera )
@@ -575,6 +665,141 @@ namespace Ogre {
         culledObjects.swap( outCulledObjects );
     }
     //-----------------------------------------------------------------------
+    void MovableObject::cullFrustumBatch( const size_t numNodes, ObjectData objData,
+                                          const CullFrustumBatchFrustum *frustums,
+                                          size_t numFrustums,
+                                          bool casterPass, const Camera *lodCamera,
+                                          uint8 renderQueueId,
+                                          CullResultEntryArray *outCulledObjects )
+    {
+        assert( numFrustums <= c_maxCullFrustumBatch );
+
+        //Same plane test as in cullFrustum
+        struct ArrayPlane
+        {
+            ArrayVector3    planeNormal;
+            ArrayVector3    signFlip;
+            ArrayReal       planeNegD;
+        };
+        struct ArrayFrustum
+        {
+            ArrayPlane      planes[6];
+            ArrayVector3    cameraPos;
+            ArrayVector3    cameraDir;
+        };
+
+        ArrayFrustum arrayFrustums[c_maxCullFrustumBatch];
+
+        for( size_t i=0; i<numFrustums; ++i )
+        {
+            const Plane *frustumPlanes = frustums[i].planes;
+            for( size_t j=0; j<6; ++j )
+            {
+                ArrayPlane &plane = arrayFrustums[i].planes[j];
+                plane.planeNormal.setAll( frustumPlanes[j].normal );
+                plane.signFlip.setAll( frustumPlanes[j].normal );
+                plane.signFlip.setToSign();
+                plane.planeNegD = Mathlib::SetAll( -frustumPlanes[j].d );
+            }
+
+            arrayFrustums[i].cameraPos.setAll( frustums[i].cameraPos );
+            arrayFrustums[i].cameraDir.setAll( frustums[i].cameraDir );
+        }
+
+        ArrayVector3 lodCameraPos;
+        lodCameraPos.setAll( lodCamera->_getCachedDerivedPosition() );
+
+        ArrayInt includeNonCasters = Mathlib::SetAll( casterPass ? 0 : LAYER_SHADOW_CASTER );
+
+        const ArrayMaskR ignoreRenderingDistance = CastIntToReal(
+                    Mathlib::SetAll( lodCamera->getUseRenderingDistance() ? 0 : 0xffffffff ) );
+
+        OGRE_ALIGNED_DECL( RealAsUint, distances[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                        (objData.mVisibilityFlags);
+            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mWorldRadius);
+            ArrayReal * RESTRICT_ALIAS upperDistance = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mUpperDistance[casterPass]);
+
+            //Tests that don't depend on the frustum
+            ArrayMaskR isInfinite = Mathlib::Or(
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[0] ),
+                            Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[1] ) );
+            isInfinite = Mathlib::Or( Mathlib::isInfinity( objData.mWorldAabb->mHalfSize.mChunkBase[2] ),
+                                      isInfinite );
+
+            ArrayReal distance = lodCameraPos.distance( objData.mWorldAabb->mCenter );
+            ArrayMaskR isCloseEnough = Mathlib::CompareLessEqual( distance, *worldRadius + *upperDistance );
+            isCloseEnough = Mathlib::Or( ignoreRenderingDistance, isCloseEnough );
+
+            //isVisible = isVisible() && (isCaster || includeNonCasters)
+            ArrayMaskI isVisible = Mathlib::And(
+                                Mathlib::TestFlags4( *visibilityFlags,
+                                                        Mathlib::SetAll( LAYER_VISIBILITY ) ),
+                                Mathlib::TestFlags4( Mathlib::Or( *visibilityFlags, includeNonCasters ),
+                                                        Mathlib::SetAll( LAYER_SHADOW_CASTER ) ) );
+            isVisible = Mathlib::And( isVisible, CastRealToInt( isCloseEnough ) );
+
+            const uint32 sharedMask = BooleanMask4::getScalarMask( isVisible );
+
+            if( sharedMask )
+            {
+                for( size_t k=0; k<numFrustums; ++k )
+                {
+                    const ArrayFrustum &frustum = arrayFrustums[k];
+
+                    ArrayReal dotResult;
+                    ArrayMaskR mask;
+                    ArrayVector3 centerPlusFlippedHS;
+                    centerPlusFlippedHS = objData.mWorldAabb->mCenter +
+                                          objData.mWorldAabb->mHalfSize * frustum.planes[0].signFlip;
+                    dotResult = frustum.planes[0].planeNormal.dotProduct( centerPlusFlippedHS );
+                    mask = Mathlib::CompareGreater( dotResult, frustum.planes[0].planeNegD );
+
+                    for( size_t j=1; j<6; ++j )
+                    {
+                        centerPlusFlippedHS = objData.mWorldAabb->mCenter +
+                                              objData.mWorldAabb->mHalfSize * frustum.planes[j].signFlip;
+                        dotResult = frustum.planes[j].planeNormal.dotProduct( centerPlusFlippedHS );
+                        mask = Mathlib::And( mask, Mathlib::CompareGreater(
+                                                 dotResult, frustum.planes[j].planeNegD ) );
+                    }
+
+                    mask = Mathlib::Or( mask, isInfinite );
+
+                    const uint32 scalarMask = BooleanMask4::getScalarMask( mask ) & sharedMask;
+
+                    if( scalarMask )
+                    {
+                        //Project the vector to the object into the camera's plane.
+                        //@see cullFrustum
+                        *reinterpret_cast<ArrayReal*>( distances ) =
+                                frustum.cameraDir.dotProduct( objData.mWorldAabb->mCenter -
+                                                              frustum.cameraPos ) - *worldRadius;
+
+                        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                        {
+                            if( IS_BIT_SET( j, scalarMask ) )
+                            {
+                                CullResultEntry entry;
+                                entry.movableObject     = objData.mOwner[j];
+                                entry.distanceToCamera  = distances[j];
+                                entry.renderQueueId     = renderQueueId;
+                                outCulledObjects[k].push_back( entry );
+                            }
+                        }
+                    }
+                }
+            }
+
+            objData.advanceFrustumPack();
+        }
+    }
+    //-----------------------------------------------------------------------
     void MovableObject::cullLights( const size_t numNodes, ObjectData objData, uint32 sceneLightMask,
                                     LightListInfo &outGlobalLightList, const FrustumVec &frustums,
                                     const FrustumVec &cubemapFrustums )
@@ -736,8 +961,9 @@ namespace Ogre {
                     outGlobalLightList.boundingSphere[idx] = Sphere(
                                                         objData.mWorldAabb->mCenter.getAsVector3( j ),
                                                         objData.mWorldRadius[j] );
-                    assert( dynamic_cast<Light*>( objData.mOwner[j] ) );
-                    outGlobalLightList.lights.push_back( static_cast<Light*>( objData.mOwner[j] ) );
+                    MovableObject *owner = objData.mOwner[j];
+                    assert( dynamic_cast<Light*>( owner ) );
+                    outGlobalLightList.lights.push_back( static_cast<Light*>( owner ) );
                 }
             }
 
@@ -749,7 +975,8 @@ namespace Ogre {
     }
     //-----------------------------------------------------------------------
     void MovableObject::buildLightList( const size_t numNodes, ObjectData objData,
-                                        const LightListInfo &globalLightList )
+                                        const LightListInfo &globalLightList,
+                                        const FastArray<Sphere> *dirtyLightSpheres )
     {
         const size_t numGlobalLights = globalLightList.lights.size();
         ArraySphere lightSphere;
@@ -760,13 +987,41 @@ namespace Ogre {
                                                                         (objData.mWorldRadius);
             ArraySphere objSphere( *arrayRadius, objData.mWorldAabb->mCenter );
 
+            if( dirtyLightSpheres )
+            {
+                //Keep the cached lists unless a light that changed touches these objects
+                ArrayMaskR touched = ARRAY_MASK_ZERO;
+                FastArray<Sphere>::const_iterator itor = dirtyLightSpheres->begin();
+                FastArray<Sphere>::const_iterator end  = dirtyLightSpheres->end();
+                while( itor != end && !BooleanMask4::getScalarMask( touched ) )
+                {
+                    lightSphere.setAll( *itor );
+                    touched = Mathlib::Or( touched, lightSphere.intersects( objSphere ) );
+                    ++itor;
+                }
+
+                if( !BooleanMask4::getScalarMask( touched ) )
+                {
+                    objData.advanceLightPack();
+                    continue;
+                }
+            }
+
             const ArrayInt * RESTRICT_ALIAS objVisibilityMask = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
                                                                             (objData.mVisibilityFlags);
             const ArrayInt * RESTRICT_ALIAS objLightMask = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
                                                                                 (objData.mLightMask);
 
+            //Slots without a light mask are either empty (their owner is a dummy shared by
+            //all threads) or can't receive lights. Don't chase their owner pointers at all.
+            const uint32 usedSlots = BooleanMask4::getScalarMask(
+                        Mathlib::TestFlags4( *objLightMask, Mathlib::SetAll( 0xFFFFFFFF ) ) );
+
             for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
-                objData.mOwner[j]->mLightList.clear();
+            {
+                if( IS_BIT_SET( j, usedSlots ) )
+                    objData.mOwner[j]->mLightList.clear();
+            }
 
             ArrayMaskI isVisible = Mathlib::TestFlags4( *objVisibilityMask,
                                                         Mathlib::SetAll( LAYER_VISIBILITY ) );
@@ -821,7 +1076,7 @@ namespace Ogre {
                 //    implementations.
                 //  * False cache sharing when trying to recalculate the hash.
                 //    of the dummy NullEntity pointer
-                if( !objData.mOwner[j]->mLightList.empty() )
+                if( IS_BIT_SET( j, usedSlots ) && !objData.mOwner[j]->mLightList.empty() )
                 {
                     std::stable_sort( objData.mOwner[j]->mLightList.begin(),
                                       objData.mOwner[j]->mLightList.end() );
@@ -37,12 +37,17 @@ THE SOFTWARE.
 #include "Math/Array/OgreBooleanMask.h"
 
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_MEDIUM
-    #define CACHED_TRANSFORM_OUT_OF_DATE() this->_setCachedTransformOutOfDate()
+    #define CACHED_TRANSFORM_OUT_OF_DATE() ( this->_setCachedTransformOutOfDate(), \
+        mTransform.mDirtyFlags[mTransform.mIndex] |= Transform::DirtyLocal )
 #else
-    #define CACHED_TRANSFORM_OUT_OF_DATE() ((void)0)
+    #define CACHED_TRANSFORM_OUT_OF_DATE() \
+        mTransform.mDirtyFlags[mTransform.mIndex] |= Transform::DirtyLocal
 #endif
 
 namespace Ogre {
+#if OGRE_COMPACT_OBJECT_HANDLES
+    CompactObjectHandleTable Node::msCompactHandles;
+#endif
     //-----------------------------------------------------------------------
     Node::Node( IdType id, NodeMemoryManager *nodeMemoryManager, Node *parent ) :
         IdObject( id ),
@@ -58,6 +63,10 @@ namespace Ogre {
         mGlobalIndex( -1 ),
         mParentIndex( -1 )
     {
+#if OGRE_COMPACT_OBJECT_HANDLES
+        mCompactHandle = msCompactHandles.add( this );
+#endif
+
         if( mParent )
             mDepthLevel = mParent->mDepthLevel + 1;
 
@@ -81,6 +90,9 @@ namespace Ogre {
         mGlobalIndex( -1 ),
         mParentIndex( -1 )
     {
+#if OGRE_COMPACT_OBJECT_HANDLES
+        mCompactHandle = msCompactHandles.add( this );
+#endif
         mTransform = transformPtrs;
     }
     //-----------------------------------------------------------------------
@@ -107,6 +119,10 @@ namespace Ogre {
             mParent = 0; //We've already called mNodeMemoryManager->nodeDestroyed.
             parent->removeChild( this );
         }
+
+#if OGRE_COMPACT_OBJECT_HANDLES
+        msCompactHandles.remove( mCompactHandle );
+#endif
     }
     //-----------------------------------------------------------------------
     Node* Node::getParent(void) const
@@ -508,6 +524,46 @@ namespace Ogre {
         }
     }
     //-----------------------------------------------------------------------
+    void Node::updateDirtyTransforms( const size_t numNodes, Transform t )
+    {
+        Transform runStart;
+        size_t runLength = 0;
+
+        for( size_t i=0; i<numNodes; i += ARRAY_PACKED_REALS )
+        {
+            uint8 dirty = 0;
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+            {
+                const Transform &parentTransform = t.mParents[j]->mTransform;
+                dirty |= t.mDirtyFlags[j] & Transform::DirtyLocal;
+                dirty |= parentTransform.mDirtyFlags[parentTransform.mIndex] &
+                         Transform::DerivedChanged;
+            }
+
+            //The whole pack gets recomputed, thus all of its children must follow.
+            const uint8 newFlags = dirty ? Transform::DerivedChanged : 0;
+            for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                t.mDirtyFlags[j] = newFlags;
+
+            if( dirty )
+            {
+                if( !runLength )
+                    runStart = t;
+                ++runLength;
+            }
+            else if( runLength )
+            {
+                updateAllTransforms( runLength * ARRAY_PACKED_REALS, runStart );
+                runLength = 0;
+            }
+
+            t.advancePack();
+        }
+
+        if( runLength )
+            updateAllTransforms( runLength * ARRAY_PACKED_REALS, runStart );
+    }
+    //-----------------------------------------------------------------------
     Node* Node::createChild( SceneMemoryMgrTypes sceneType,
                              const Vector3& inTranslate, const Quaternion& inRotate )
     {
@@ -598,6 +654,7 @@ namespace Ogre {
     void Node::resetOrientation(void)
     {
         mTransform.mOrientation->setFromQuaternion( Quaternion::IDENTITY, mTransform.mIndex );
+        CACHED_TRANSFORM_OUT_OF_DATE();
     }
 
     //-----------------------------------------------------------------------
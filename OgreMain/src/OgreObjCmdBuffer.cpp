@@ -44,6 +44,8 @@ THE SOFTWARE.
 
 #include "OgreException.h"
 #include "OgreProfiler.h"
+#include "OgreRoot.h"
+#include "OgreFrameMetrics.h"
 
 namespace Ogre
 {
@@ -211,5 +213,7 @@ namespace Ogre
         filters.destroy(); //Destroy manually as ~NotifyDataIsReady won't be called.
 
         texture->notifyDataIsReady();
+
+        Root::getSingleton().getFrameMetrics()->add( FrameMetric::TexturesStreamed, 1u );
     }
 }
@@ -15,13 +15,17 @@ namespace Ogre
     OfflineProfiler::OfflineProfiler() :
         mPaused( false ),
         mTlsHandle( OGRE_TLS_INVALID_HANDLE ),
-        mBytesPerPool( sizeof( ProfileSample ) * 10000 )
+        mBytesPerPool( sizeof( ProfileSample ) * 10000 ),
+        mTimer( OGRE_NEW Ogre::Timer() )
     {
         Threads::CreateTls( &mTlsHandle );
     }
     //-----------------------------------------------------------------------------------
     OfflineProfiler::~OfflineProfiler()
     {
+        if( !mThreadData.empty() && !mOnShutdownTracePath.empty() )
+            dumpTraceEvents( mOnShutdownTracePath );
+
         if( !mThreadData.empty() &&
             (!mOnShutdownPerFramePath.empty() || !mOnShutdownAccumPath.empty()) )
         {
@@ -39,15 +43,21 @@ namespace Ogre
 
         Threads::DestroyTls( mTlsHandle );
         mTlsHandle = OGRE_TLS_INVALID_HANDLE;
+
+        OGRE_DELETE mTimer;
+        mTimer = 0;
     }
     //-----------------------------------------------------------------------------------
-    OfflineProfiler::PerThreadData::PerThreadData( bool startPaused, size_t bytesPerPool ) :
+    OfflineProfiler::PerThreadData::PerThreadData( bool startPaused, size_t bytesPerPool,
+                                                   uint64 timeOffset, uint32 threadIdx ) :
         mPaused( startPaused ),
         mPauseRequest( startPaused ),
         mResetRequest( false ),
         mRoot( 0 ),
         mCurrentSample( 0 ),
         mTimer( OGRE_NEW Ogre::Timer() ),
+        mTimeOffset( timeOffset ),
+        mThreadIdx( threadIdx ),
         mTotalAccumTime( 0 ),
         mCurrMemoryPoolOffset( 0 ),
         mBytesPerPool( bytesPerPool )
@@ -60,6 +70,9 @@ namespace Ogre
         strcpy( (char*)mCurrentSample->nameStr, rootName );
         mCurrentSample->nameStr[OGRE_OFFLINE_PROFILER_NAME_STR_LENGTH-1u] = '\0';
         mCurrentSample->nameHash = IdString( rootName );
+
+        LwString threadName( LwString::FromEmptyPointer( mThreadName, sizeof( mThreadName ) ) );
+        threadName.a( "Thread ", threadIdx );
     }
     //-----------------------------------------------------------------------------------
     OfflineProfiler::PerThreadData::~PerThreadData()
@@ -130,6 +143,14 @@ namespace Ogre
         return newSample;
     }
     //-----------------------------------------------------------------------------------
+    void OfflineProfiler::PerThreadData::setThreadName( const char *name )
+    {
+        mMutex.lock();
+        strncpy( mThreadName, name, sizeof( mThreadName ) - 1u );
+        mThreadName[sizeof( mThreadName ) - 1u] = '\0';
+        mMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
     void OfflineProfiler::PerThreadData::setPauseRequest( bool bPause )
     {
         mPauseRequest = bPause;
@@ -212,9 +233,11 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     OfflineProfiler::PerThreadData* OfflineProfiler::allocatePerThreadData(void)
     {
-        PerThreadData *perThreadData = new PerThreadData( mPaused, mBytesPerPool );
-
         mMutex.lock();
+        //The new thread's timer starts (roughly) now
+        PerThreadData *perThreadData = new PerThreadData( mPaused, mBytesPerPool,
+                                                          mTimer->getMicroseconds(),
+                                                          static_cast<uint32>( mThreadData.size() ) );
         mThreadData.push_back( perThreadData );
         mMutex.unlock();
 
@@ -223,6 +246,16 @@ namespace Ogre
         return perThreadData;
     }
     //-----------------------------------------------------------------------------------
+    OfflineProfiler::PerThreadData* OfflineProfiler::getPerThreadData(void)
+    {
+        PerThreadData *perThreadData = reinterpret_cast<PerThreadData*>( Threads::GetTls( mTlsHandle ) );
+
+        if( !perThreadData )
+            perThreadData = allocatePerThreadData();
+
+        return perThreadData;
+    }
+    //-----------------------------------------------------------------------------------
     void OfflineProfiler::
     PerThreadData::dumpSample( ProfileSample *sample, LwString &tmpStr, String &outCsvString,
                                StdMap<IdString, ProfileSample> &accumStats, uint32 stackDepth )
@@ -311,6 +344,71 @@ namespace Ogre
         mMutex.unlock();
     }
     //-----------------------------------------------------------------------------------
+    void OfflineProfiler::PerThreadData::dumpTraceSample( const ProfileSample *sample,
+                                                          LwString &tmpStr, String &outJson,
+                                                          uint64 usNow ) const
+    {
+        //Samples that haven't ended yet are dumped with their duration so far
+        bool isOpen = false;
+        for( const ProfileSample *openSample = mCurrentSample; openSample && !isOpen;
+             openSample = openSample->parent )
+        {
+            isOpen = openSample == sample;
+        }
+        const uint64 usTaken = isOpen ? (usNow - sample->usStart) : sample->usTaken;
+
+        tmpStr.clear();
+        tmpStr.a( ",\n{\"name\":\"" );
+        for( const char *c = (const char*)sample->nameStr; *c; ++c )
+        {
+            //Replace whatever would break the JSON. Names are meant to be identifiers anyway
+            const char ch[2] = { (*c == '"' || *c == '\\' || (*c >= 0 && *c < ' ')) ? '_' : *c,
+                                 '\0' };
+            tmpStr.a( ch );
+        }
+        tmpStr.a( "\",\"ph\":\"X\",\"pid\":0,\"tid\":", mThreadIdx );
+        tmpStr.a( ",\"ts\":", mTimeOffset + sample->usStart, ",\"dur\":", usTaken, "}" );
+        outJson += tmpStr.c_str();
+
+        FastArray<ProfileSample*>::const_iterator itor = sample->children.begin();
+        FastArray<ProfileSample*>::const_iterator end  = sample->children.end();
+
+        while( itor != end )
+        {
+            dumpTraceSample( *itor, tmpStr, outJson, usNow );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void OfflineProfiler::PerThreadData::dumpTraceEvents( String &outJson )
+    {
+        char tmpBuffer[256];
+        LwString tmpStr( LwString::FromEmptyPointer( tmpBuffer, sizeof( tmpBuffer ) ) );
+
+        mMutex.lock();
+
+        tmpStr.a( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":", mThreadIdx,
+                  ",\"args\":{\"name\":\"", mThreadName, "\"}}" );
+        outJson += tmpStr.c_str();
+        tmpStr.clear();
+        tmpStr.a( ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":0,\"tid\":",
+                  mThreadIdx, ",\"args\":{\"sort_index\":", mThreadIdx, "}}" );
+        outJson += tmpStr.c_str();
+
+        const uint64 usNow = mTimer->getMicroseconds();
+
+        FastArray<ProfileSample*>::const_iterator itor = mRoot->children.begin();
+        FastArray<ProfileSample*>::const_iterator end  = mRoot->children.end();
+
+        while( itor != end )
+        {
+            dumpTraceSample( *itor, tmpStr, outJson, usNow );
+            ++itor;
+        }
+
+        mMutex.unlock();
+    }
+    //-----------------------------------------------------------------------------------
     void OfflineProfiler::PerThreadData::dumpProfileResults( const String &fullPathPerFrame,
                                                              const String &fullPathAccum )
     {
@@ -377,12 +475,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void OfflineProfiler::profileBegin( const char *name, ProfileSampleFlags::ProfileSampleFlags flags )
     {
-        PerThreadData *perThreadData = reinterpret_cast<PerThreadData*>( Threads::GetTls( mTlsHandle ) );
-
-        if( !perThreadData )
-            perThreadData = allocatePerThreadData();
-
-        perThreadData->profileBegin( name, flags );
+        getPerThreadData()->profileBegin( name, flags );
     }
     //-----------------------------------------------------------------------------------
     void OfflineProfiler::profileEnd(void)
@@ -425,6 +518,54 @@ namespace Ogre
         mMutex.unlock();
     }
     //-----------------------------------------------------------------------------------
+    void OfflineProfiler::setCurrentThreadName( const char *name )
+    {
+        getPerThreadData()->setThreadName( name );
+    }
+    //-----------------------------------------------------------------------------------
+    void OfflineProfiler::dumpTraceEvents( String &outJson )
+    {
+        outJson = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                  "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+                  "\"args\":{\"name\":\"Ogre\"}}";
+
+        mMutex.lock();
+
+        PerThreadDataArray::const_iterator itor = mThreadData.begin();
+        PerThreadDataArray::const_iterator end  = mThreadData.end();
+
+        while( itor != end )
+        {
+            (*itor)->dumpTraceEvents( outJson );
+            ++itor;
+        }
+
+        mMutex.unlock();
+
+        outJson += "\n]}\n";
+    }
+    //-----------------------------------------------------------------------------------
+    void OfflineProfiler::dumpTraceEvents( const String &fullPath )
+    {
+        String json;
+        dumpTraceEvents( json );
+
+        std::ofstream outFile( fullPath.c_str(), std::ios::binary | std::ios::out );
+        outFile.write( json.c_str(), static_cast<std::streamsize>( json.size() ) );
+        outFile.close();
+    }
+    //-----------------------------------------------------------------------------------
+    void OfflineProfiler::setTraceDumpPathOnShutdown( const String &fullPath )
+    {
+        mOnShutdownTracePath = fullPath;
+
+        if( !fullPath.empty() )
+        {
+            LogManager::getSingleton().logMessage( "[INFO] Will dump profiling trace on shutdown to " +
+                                                   fullPath );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void OfflineProfiler::setDumpPathsOnShutdown( const String &fullPathPerFrame,
                                                   const String &fullPathAccum )
     {
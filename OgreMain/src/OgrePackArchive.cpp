@@ -0,0 +1,779 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgrePackArchive.h"
+
+#include "OgreException.h"
+#include "OgreLogManager.h"
+#include "OgreString.h"
+#include "OgreStringConverter.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
+#include "Hash/MurmurHash3.h"
+#include "ogrestd/set.h"
+
+#include <algorithm>
+#include <limits>
+#include <sys/stat.h>
+
+#if OGRE_NO_ZIP_ARCHIVE == 0
+    #include <zlib.h>
+#endif
+
+namespace Ogre
+{
+    const uint32 PackArchive::c_magic   = 0x4B41504F; // 'OPAK'
+    const uint32 PackArchive::c_version = 1u;
+    uint32 PackArchive::msNumDecompressionThreads = 0u;
+
+    static const uint32 c_packHashSeed = 0x3A8EFA67;
+
+    namespace
+    {
+        /// View of an entry inside the mapped pack. Keeps the mapping alive.
+        class PackViewDataStream : public MemoryDataStream
+        {
+            DataStreamPtr mMappedFile;
+        public:
+            PackViewDataStream( const String &name, const uchar *data, size_t size,
+                                const DataStreamPtr &mappedFile ) :
+                MemoryDataStream( name, const_cast<uchar*>( data ), size, false, true ),
+                mMappedFile( mappedFile )
+            {
+            }
+        };
+
+        struct PackEntryHashCompare
+        {
+            bool operator()( const PackArchive::PackEntry &a, const PackArchive::PackEntry &b ) const
+            {
+                return a.nameHash < b.nameHash;
+            }
+        };
+
+        /// Lookups are case insensitive and accept either slash
+        String normaliseFilename( const String &filename )
+        {
+            String retVal = filename;
+            StringUtil::toLowerCase( retVal );
+            std::replace( retVal.begin(), retVal.end(), '\\', '/' );
+            return retVal;
+        }
+
+        struct DecompressJob
+        {
+            const uchar     *compressedData;
+            /// numBlocks + 1 offsets into compressedData
+            const uint64    *blockOffsets;
+            uchar           *dst;
+            uint64          uncompressedSize;
+            uint32          blockSize;
+            uint32          numBlocks;
+            size_t          numThreads;
+            /// One per thread
+            bool            *errors;
+        };
+
+        bool decompressBlock( const DecompressJob &job, uint32 blockIdx )
+        {
+#if OGRE_NO_ZIP_ARCHIVE == 0
+            const uint64 dstOffset = static_cast<uint64>( blockIdx ) * job.blockSize;
+            const uint64 expectedSize = std::min<uint64>( job.blockSize,
+                                                          job.uncompressedSize - dstOffset );
+            uLongf dstSize = static_cast<uLongf>( expectedSize );
+            const int result = uncompress(
+                                   job.dst + dstOffset, &dstSize,
+                                   job.compressedData + job.blockOffsets[blockIdx],
+                                   static_cast<uLong>( job.blockOffsets[blockIdx + 1u] -
+                                                       job.blockOffsets[blockIdx] ) );
+            return result == Z_OK && dstSize == expectedSize;
+#else
+            return false;
+#endif
+        }
+    }
+
+    unsigned long decompressPackBlocksThread( ThreadHandle *threadHandle )
+    {
+        const DecompressJob *job = reinterpret_cast<const DecompressJob*>(
+                                       threadHandle->getUserParam() );
+        const size_t threadIdx = threadHandle->getThreadIdx();
+        for( size_t i=threadIdx; i<job->numBlocks; i += job->numThreads )
+        {
+            if( !decompressBlock( *job, static_cast<uint32>( i ) ) )
+                job->errors[threadIdx] = true;
+        }
+        return 0;
+    }
+    THREAD_DECLARE( decompressPackBlocksThread );
+
+    //-----------------------------------------------------------------------
+    PackArchive::PackArchive( const String &name, const String &archType ) :
+        Archive( name, archType ),
+        mMappedData( 0 ),
+        mPackModifiedTime( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------
+    PackArchive::~PackArchive()
+    {
+        unload();
+    }
+    //-----------------------------------------------------------------------
+    uint32 PackArchive::hashFilename( const String &filename )
+    {
+        const String lowercase = normaliseFilename( filename );
+
+        uint32 hash = 0;
+        MurmurHash3_x86_32( lowercase.c_str(), static_cast<int>( lowercase.size() ),
+                            c_packHashSeed, &hash );
+        return hash;
+    }
+    //-----------------------------------------------------------------------
+    bool PackArchive::isCompressionSupported( Compression compression )
+    {
+#if OGRE_NO_ZIP_ARCHIVE == 0
+        return compression < PackCompressionCount;
+#else
+        return compression == PackCompressionNone;
+#endif
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::setNumDecompressionThreads( uint32 numThreads )
+    {
+        msNumDecompressionThreads = numThreads;
+    }
+    //-----------------------------------------------------------------------
+    uint32 PackArchive::getNumDecompressionThreads(void)
+    {
+        return msNumDecompressionThreads;
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::readData( uint64 offset, uint64 size, uchar *outData ) const
+    {
+        if( mMappedData )
+        {
+            memcpy( outData, mMappedData + offset, static_cast<size_t>( size ) );
+            return;
+        }
+
+        // A stream per call, so that open() can be called from multiple threads
+        std::ifstream file( mName.c_str(), std::ios::in | std::ios::binary );
+        file.seekg( static_cast<std::streamoff>( offset ), std::ios::beg );
+        file.read( reinterpret_cast<char*>( outData ), static_cast<std::streamsize>( size ) );
+        if( file.fail() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR,
+                         "Error reading " + StringConverter::toString( static_cast<size_t>( size ) ) +
+                         " bytes from pack " + mName,
+                         "PackArchive::readData" );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::load()
+    {
+        if( !mEntries.empty() )
+            return;
+
+        struct stat tagStat;
+        if( stat( mName.c_str(), &tagStat ) != 0 )
+        {
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Cannot open pack " + mName,
+                         "PackArchive::load" );
+        }
+        mPackModifiedTime = tagStat.st_mtime;
+        const uint64 fileSize = static_cast<uint64>( tagStat.st_size );
+
+        // Mapping can fail, e.g. when a 32-bit process runs out of address space
+        if( fileSize <= std::numeric_limits<size_t>::max() )
+        {
+            MappedFileDataStream *mappedFile = MappedFileDataStream::open( mName, mName );
+            if( mappedFile )
+            {
+                mMappedFile.bind( mappedFile );
+                mMappedData = mappedFile->getDataView();
+            }
+        }
+
+        PackHeader header;
+        if( fileSize < sizeof(PackHeader) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, mName + " is not a pack file",
+                         "PackArchive::load" );
+        }
+        readData( 0, sizeof(PackHeader), reinterpret_cast<uchar*>( &header ) );
+
+        if( header.magic != c_magic || header.version != c_version )
+        {
+            unload();
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         mName + " is not a pack file or was built for a different version",
+                         "PackArchive::load" );
+        }
+
+        const uint64 indexSize = static_cast<uint64>( header.numEntries ) * sizeof(PackEntry);
+        if( header.indexOffset > fileSize || indexSize > fileSize - header.indexOffset ||
+            header.stringTableOffset > fileSize ||
+            header.stringTableSize > fileSize - header.stringTableOffset )
+        {
+            unload();
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Corrupt index in pack " + mName,
+                         "PackArchive::load" );
+        }
+
+        mEntries.resize( header.numEntries );
+        mStringTable.resize( static_cast<size_t>( header.stringTableSize ) );
+        if( header.numEntries )
+            readData( header.indexOffset, indexSize, reinterpret_cast<uchar*>( &mEntries[0] ) );
+        if( header.stringTableSize )
+        {
+            readData( header.stringTableOffset, header.stringTableSize,
+                      reinterpret_cast<uchar*>( &mStringTable[0] ) );
+        }
+
+        set<String>::type folders;
+
+        mFileList.reserve( mEntries.size() );
+        PackEntryVec::const_iterator itor = mEntries.begin();
+        PackEntryVec::const_iterator end  = mEntries.end();
+        while( itor != end )
+        {
+            if( itor->nameOffset > mStringTable.size() ||
+                itor->nameLength > mStringTable.size() - itor->nameOffset ||
+                itor->dataOffset > fileSize || itor->dataSize > fileSize - itor->dataOffset ||
+                itor->compression >= PackCompressionCount ||
+                (itor->compression == PackCompressionNone &&
+                 itor->dataSize != itor->uncompressedSize) )
+            {
+                unload();
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Corrupt entry in pack " + mName,
+                             "PackArchive::load" );
+            }
+
+            FileInfo info;
+            info.archive = this;
+            info.filename = mStringTable.substr( itor->nameOffset, itor->nameLength );
+            StringUtil::splitFilename( info.filename, info.basename, info.path );
+            info.compressedSize = static_cast<size_t>( itor->dataSize );
+            info.uncompressedSize = static_cast<size_t>( itor->uncompressedSize );
+            mFileList.push_back( info );
+
+            // Packs only store files. Folders are derived from their paths
+            String path = info.path;
+            while( !path.empty() && folders.insert( path ).second )
+            {
+                String parentPath, folderName;
+                StringUtil::splitFilename( path.substr( 0, path.size() - 1u ),
+                                           folderName, parentPath );
+                path = parentPath;
+            }
+
+            ++itor;
+        }
+
+        set<String>::type::const_iterator itFolder = folders.begin();
+        set<String>::type::const_iterator enFolder = folders.end();
+        while( itFolder != enFolder )
+        {
+            FileInfo info;
+            info.archive = this;
+            info.filename = itFolder->substr( 0, itFolder->size() - 1u );
+            StringUtil::splitFilename( info.filename, info.basename, info.path );
+            // Same as ZipArchive, folders have a compressed size of -1
+            info.compressedSize = size_t( -1 );
+            info.uncompressedSize = 0;
+            mFileList.push_back( info );
+            ++itFolder;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::unload()
+    {
+        mEntries.clear();
+        mStringTable.clear();
+        mFileList.clear();
+        mMappedData = 0;
+        mMappedFile.setNull();
+    }
+    //-----------------------------------------------------------------------
+    const PackArchive::PackEntry* PackArchive::findEntry( const String &filename ) const
+    {
+        const uint32 hash = hashFilename( filename );
+
+        PackEntry key;
+        key.nameHash = hash;
+        PackEntryVec::const_iterator itor = std::lower_bound( mEntries.begin(), mEntries.end(),
+                                                              key, PackEntryHashCompare() );
+
+        // Resolve collisions
+        const String normalisedName = normaliseFilename( filename );
+        while( itor != mEntries.end() && itor->nameHash == hash )
+        {
+            if( normaliseFilename( mStringTable.substr( itor->nameOffset,
+                                                        itor->nameLength ) ) == normalisedName )
+            {
+                return &(*itor);
+            }
+            ++itor;
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr PackArchive::decompressEntry( const String &filename, const PackEntry &entry,
+                                                const uchar *compressedData ) const
+    {
+        const uint64 tableSize = static_cast<uint64>( entry.numBlocks ) * sizeof(uint32);
+        const uint64 expectedBlocks = entry.blockSize ?
+                    (entry.uncompressedSize + entry.blockSize - 1u) / entry.blockSize : 0u;
+        if( !isCompressionSupported( static_cast<Compression>( entry.compression ) ) ||
+            expectedBlocks != entry.numBlocks || tableSize > entry.dataSize )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Entry " + filename + " in pack " + mName +
+                         " is corrupt or uses a compression not available in this build",
+                         "PackArchive::decompressEntry" );
+        }
+
+        vector<uint64>::type blockOffsets;
+        blockOffsets.reserve( entry.numBlocks + 1u );
+        blockOffsets.push_back( tableSize );
+        for( uint32 i=0; i<entry.numBlocks; ++i )
+        {
+            uint32 compressedSize;
+            memcpy( &compressedSize, compressedData + i * sizeof(uint32), sizeof(uint32) );
+            blockOffsets.push_back( blockOffsets.back() + compressedSize );
+        }
+
+        if( blockOffsets.back() != entry.dataSize )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Entry " + filename + " in pack " + mName + " is corrupt",
+                         "PackArchive::decompressEntry" );
+        }
+
+        MemoryDataStream *stream = OGRE_NEW MemoryDataStream(
+                                       filename, static_cast<size_t>( entry.uncompressedSize ),
+                                       true, true );
+        DataStreamPtr retVal( stream );
+
+        size_t numThreads = msNumDecompressionThreads;
+        if( numThreads == 0 )
+        {
+            //getNumLogicalCores() may return 0 if couldn't detect
+            numThreads = std::max<size_t>( 1u, PlatformInformation::getNumLogicalCores() );
+        }
+        // WaitForMultipleObjects can't wait on more than 64 handles
+        numThreads = std::min<size_t>( std::min<size_t>( numThreads, 65u ), entry.numBlocks );
+        numThreads = std::max<size_t>( numThreads, 1u );
+
+        bool errors[65];
+        memset( errors, 0, sizeof(errors) );
+
+        DecompressJob job;
+        job.compressedData      = compressedData;
+        job.blockOffsets        = &blockOffsets[0];
+        job.dst                 = stream->getPtr();
+        job.uncompressedSize    = entry.uncompressedSize;
+        job.blockSize           = entry.blockSize;
+        job.numBlocks           = entry.numBlocks;
+        job.numThreads          = numThreads;
+        job.errors              = errors;
+
+        if( numThreads > 1u )
+        {
+            ThreadHandleVec threadHandles;
+            threadHandles.reserve( numThreads );
+            for( size_t i=0; i<numThreads; ++i )
+            {
+                threadHandles.push_back( Threads::CreateThread(
+                                             THREAD_GET( decompressPackBlocksThread ), i, &job ) );
+            }
+            Threads::WaitForThreads( threadHandles );
+        }
+        else
+        {
+            for( uint32 i=0; i<entry.numBlocks; ++i )
+                errors[0] |= !decompressBlock( job, i );
+        }
+
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            if( errors[i] )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Failed to decompress " + filename + " from pack " + mName,
+                             "PackArchive::decompressEntry" );
+            }
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr PackArchive::open( const String &filename, bool readOnly )
+    {
+        const PackEntry *entry = findEntry( filename );
+        if( !entry )
+        {
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND,
+                         "Cannot open file " + filename + " in pack " + mName,
+                         "PackArchive::open" );
+        }
+
+        if( entry->compression == PackCompressionNone )
+        {
+            if( mMappedData )
+            {
+                return DataStreamPtr( OGRE_NEW PackViewDataStream(
+                                          filename, mMappedData + entry->dataOffset,
+                                          static_cast<size_t>( entry->dataSize ), mMappedFile ) );
+            }
+
+            MemoryDataStream *stream = OGRE_NEW MemoryDataStream(
+                                           filename, static_cast<size_t>( entry->dataSize ),
+                                           true, false );
+            DataStreamPtr retVal( stream );
+            readData( entry->dataOffset, entry->dataSize, stream->getPtr() );
+            return retVal;
+        }
+
+        if( mMappedData )
+            return decompressEntry( filename, *entry, mMappedData + entry->dataOffset );
+
+        vector<uchar>::type compressedData( static_cast<size_t>( entry->dataSize ) );
+        if( !compressedData.empty() )
+            readData( entry->dataOffset, entry->dataSize, &compressedData[0] );
+        return decompressEntry( filename, *entry,
+                                compressedData.empty() ? 0 : &compressedData[0] );
+    }
+    //-----------------------------------------------------------------------
+    DataStreamPtr PackArchive::create( const String &filename )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "Modification of packs is not supported. Use PackArchiveWriter",
+                     "PackArchive::create" );
+    }
+    //-----------------------------------------------------------------------
+    void PackArchive::remove( const String &filename )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "Modification of packs is not supported. Use PackArchiveWriter",
+                     "PackArchive::remove" );
+    }
+    //-----------------------------------------------------------------------
+    StringVectorPtr PackArchive::list( bool recursive, bool dirs )
+    {
+        StringVectorPtr ret = StringVectorPtr( OGRE_NEW_T( StringVector, MEMCATEGORY_GENERAL )(),
+                                               SPFM_DELETE_T );
+
+        FileInfoList::const_iterator itor = mFileList.begin();
+        FileInfoList::const_iterator end  = mFileList.end();
+        while( itor != end )
+        {
+            if( (dirs == (itor->compressedSize == size_t( -1 ))) &&
+                (recursive || itor->path.empty()) )
+            {
+                ret->push_back( itor->filename );
+            }
+            ++itor;
+        }
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr PackArchive::listFileInfo( bool recursive, bool dirs )
+    {
+        FileInfoList *fil = OGRE_NEW_T( FileInfoList, MEMCATEGORY_GENERAL )();
+
+        FileInfoList::const_iterator itor = mFileList.begin();
+        FileInfoList::const_iterator end  = mFileList.end();
+        while( itor != end )
+        {
+            if( (dirs == (itor->compressedSize == size_t( -1 ))) &&
+                (recursive || itor->path.empty()) )
+            {
+                fil->push_back( *itor );
+            }
+            ++itor;
+        }
+
+        return FileInfoListPtr( fil, SPFM_DELETE_T );
+    }
+    //-----------------------------------------------------------------------
+    StringVectorPtr PackArchive::find( const String &pattern, bool recursive, bool dirs )
+    {
+        StringVectorPtr ret = StringVectorPtr( OGRE_NEW_T( StringVector, MEMCATEGORY_GENERAL )(),
+                                               SPFM_DELETE_T );
+
+        FileInfoListPtr fileInfo = findFileInfo( pattern, recursive, dirs );
+        FileInfoList::const_iterator itor = fileInfo->begin();
+        FileInfoList::const_iterator end  = fileInfo->end();
+        while( itor != end )
+        {
+            ret->push_back( itor->filename );
+            ++itor;
+        }
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    FileInfoListPtr PackArchive::findFileInfo( const String &pattern, bool recursive, bool dirs )
+    {
+        FileInfoListPtr ret = FileInfoListPtr( OGRE_NEW_T( FileInfoList, MEMCATEGORY_GENERAL )(),
+                                               SPFM_DELETE_T );
+        // If pattern contains a directory name, do a full match
+        const bool fullMatch = (pattern.find( '/' ) != String::npos) ||
+                               (pattern.find( '\\' ) != String::npos);
+        const bool wildCard = pattern.find( "*" ) != String::npos;
+
+        if( !fullMatch && !wildCard && !dirs && recursive == false )
+        {
+            // Fast path: a file in the root folder
+            const PackEntry *entry = findEntry( pattern );
+            if( entry )
+            {
+                const size_t idx = static_cast<size_t>( entry - &mEntries[0] );
+                ret->push_back( mFileList[idx] );
+            }
+            return ret;
+        }
+
+        FileInfoList::const_iterator itor = mFileList.begin();
+        FileInfoList::const_iterator end  = mFileList.end();
+        while( itor != end )
+        {
+            if( (dirs == (itor->compressedSize == size_t( -1 ))) &&
+                (recursive || fullMatch || wildCard) )
+            {
+                // Check name matches pattern (packs are case insensitive)
+                if( StringUtil::match( fullMatch ? itor->filename : itor->basename,
+                                       pattern, false ) )
+                {
+                    ret->push_back( *itor );
+                }
+            }
+            ++itor;
+        }
+
+        return ret;
+    }
+    //-----------------------------------------------------------------------
+    bool PackArchive::exists( const String &filename )
+    {
+        return findEntry( filename ) != 0;
+    }
+    //-----------------------------------------------------------------------
+    time_t PackArchive::getModifiedTime( const String &filename )
+    {
+        const PackEntry *entry = findEntry( filename );
+        if( entry && entry->modifiedTime != 0 )
+            return static_cast<time_t>( entry->modifiedTime );
+        return mPackModifiedTime;
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    PackArchiveWriter::PackArchiveWriter( const String &filename, uint32 alignment,
+                                          uint32 blockSize ) :
+        mFilename( filename ),
+        mAlignment( std::max( alignment, 1u ) ),
+        mBlockSize( std::max( blockSize, 1024u ) ),
+        mCurrentOffset( 0 )
+    {
+        if( (mAlignment & (mAlignment - 1u)) != 0 )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Alignment must be a power of 2",
+                         "PackArchiveWriter::PackArchiveWriter" );
+        }
+
+        mFile.open( filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc );
+        if( !mFile.is_open() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE, "Cannot create " + filename,
+                         "PackArchiveWriter::PackArchiveWriter" );
+        }
+
+        // Placeholder header. finish() writes the real one
+        PackArchive::PackHeader header;
+        memset( &header, 0, sizeof(header) );
+        writeAligned( &header, sizeof(header) );
+    }
+    //-----------------------------------------------------------------------
+    PackArchiveWriter::~PackArchiveWriter()
+    {
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::writeAligned( const void *data, size_t size )
+    {
+        const uint64 alignedOffset = ( (mCurrentOffset + mAlignment - 1u) / mAlignment ) *
+                                     mAlignment;
+        const char zeroes[64] = { 0 };
+        while( mCurrentOffset < alignedOffset )
+        {
+            const size_t padding = static_cast<size_t>(
+                                       std::min<uint64>( alignedOffset - mCurrentOffset,
+                                                         sizeof(zeroes) ) );
+            mFile.write( zeroes, static_cast<std::streamsize>( padding ) );
+            mCurrentOffset += padding;
+        }
+
+        if( size )
+            mFile.write( reinterpret_cast<const char*>( data ), static_cast<std::streamsize>( size ) );
+        mCurrentOffset += size;
+
+        if( mFile.fail() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE, "Error writing to " + mFilename,
+                         "PackArchiveWriter::writeAligned" );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::addFile( const String &name, DataStreamPtr &stream,
+                                     PackArchive::Compression compression, time_t modifiedTime )
+    {
+        if( !PackArchive::isCompressionSupported( compression ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "The requested compression is not available in this build",
+                         "PackArchiveWriter::addFile" );
+        }
+
+        String normalisedName = name;
+        std::replace( normalisedName.begin(), normalisedName.end(), '\\', '/' );
+
+        MemoryDataStream fileData( stream, true, true );
+        const size_t fileSize = fileData.size();
+
+        PackArchive::PackEntry entry;
+        memset( &entry, 0, sizeof(entry) );
+        entry.nameHash          = PackArchive::hashFilename( normalisedName );
+        entry.nameOffset        = static_cast<uint32>( mStringTable.size() );
+        entry.nameLength        = static_cast<uint32>( normalisedName.size() );
+        entry.compression       = PackArchive::PackCompressionNone;
+        entry.uncompressedSize  = fileSize;
+        entry.dataSize          = fileSize;
+        entry.modifiedTime      = static_cast<int64>( modifiedTime );
+
+        vector<uchar>::type compressedData;
+#if OGRE_NO_ZIP_ARCHIVE == 0
+        if( compression == PackArchive::PackCompressionDeflate && fileSize > 0 )
+        {
+            const uint32 numBlocks = static_cast<uint32>( (fileSize + mBlockSize - 1u) /
+                                                          mBlockSize );
+            compressedData.resize( numBlocks * sizeof(uint32) );
+            for( uint32 i=0; i<numBlocks; ++i )
+            {
+                const size_t srcOffset = static_cast<size_t>( i ) * mBlockSize;
+                const size_t srcSize = std::min<size_t>( mBlockSize, fileSize - srcOffset );
+
+                uLongf dstSize = compressBound( static_cast<uLong>( srcSize ) );
+                const size_t dstOffset = compressedData.size();
+                compressedData.resize( dstOffset + dstSize );
+                const int result = compress2( &compressedData[dstOffset], &dstSize,
+                                              fileData.getPtr() + srcOffset,
+                                              static_cast<uLong>( srcSize ), Z_BEST_COMPRESSION );
+                if( result != Z_OK )
+                {
+                    OGRE_EXCEPT( Exception::ERR_INTERNAL_ERROR, "Failed to compress " + name,
+                                 "PackArchiveWriter::addFile" );
+                }
+                compressedData.resize( dstOffset + dstSize );
+
+                const uint32 blockCompressedSize = static_cast<uint32>( dstSize );
+                memcpy( &compressedData[i * sizeof(uint32)], &blockCompressedSize,
+                        sizeof(uint32) );
+            }
+
+            // Not worth it. Store it as is, so it can be mapped
+            if( compressedData.size() > fileSize - fileSize / 8u )
+            {
+                compressedData.clear();
+            }
+            else
+            {
+                entry.compression   = PackArchive::PackCompressionDeflate;
+                entry.dataSize      = compressedData.size();
+                entry.blockSize     = mBlockSize;
+                entry.numBlocks     = numBlocks;
+            }
+        }
+#endif
+
+        // Alignment is applied before writing, thus the data starts at the aligned offset
+        entry.dataOffset = ( (mCurrentOffset + mAlignment - 1u) / mAlignment ) * mAlignment;
+        if( entry.compression == PackArchive::PackCompressionNone )
+            writeAligned( fileData.getPtr(), fileSize );
+        else
+            writeAligned( &compressedData[0], compressedData.size() );
+
+        mStringTable += normalisedName;
+        mEntries.push_back( entry );
+    }
+    //-----------------------------------------------------------------------
+    void PackArchiveWriter::finish(void)
+    {
+        std::stable_sort( mEntries.begin(), mEntries.end(), PackEntryHashCompare() );
+
+        PackArchive::PackHeader header;
+        memset( &header, 0, sizeof(header) );
+        header.magic        = PackArchive::c_magic;
+        header.version      = PackArchive::c_version;
+        header.numEntries   = static_cast<uint32>( mEntries.size() );
+        header.alignment    = mAlignment;
+
+        const uint32 alignment = mAlignment;
+        // The index doesn't need the full alignment
+        mAlignment = 8u;
+        header.indexOffset = ( (mCurrentOffset + mAlignment - 1u) / mAlignment ) * mAlignment;
+        writeAligned( mEntries.empty() ? 0 : &mEntries[0],
+                      mEntries.size() * sizeof(PackArchive::PackEntry) );
+        mAlignment = 1u;
+        header.stringTableOffset = mCurrentOffset;
+        header.stringTableSize = mStringTable.size();
+        writeAligned( mStringTable.c_str(), mStringTable.size() );
+        mAlignment = alignment;
+
+        mFile.seekp( 0, std::ios::beg );
+        mFile.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+        mFile.close();
+
+        if( mFile.fail() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE, "Error writing to " + mFilename,
+                         "PackArchiveWriter::finish" );
+        }
+    }
+    //-----------------------------------------------------------------------
+    //-----------------------------------------------------------------------
+    const String& PackArchiveFactory::getType(void) const
+    {
+        static String name = "Pack";
+        return name;
+    }
+}
@@ -41,6 +41,7 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "OgreControllerManager.h"
 #include "OgreHlmsManager.h"
+#include "OgreGpuParticleSimulator.h"
 #include "OgreRoot.h"
 
 namespace Ogre {
@@ -56,6 +57,7 @@ namespace Ogre {
     ParticleSystem::CmdLocalSpace ParticleSystem::msLocalSpaceCmd;
     ParticleSystem::CmdIterationInterval ParticleSystem::msIterationIntervalCmd;
     ParticleSystem::CmdNonvisibleTimeout ParticleSystem::msNonvisibleTimeoutCmd;
+    ParticleSystem::CmdGpuSimulation ParticleSystem::msGpuSimulationCmd;
 
     RadixSort<ParticleSystem::ActiveParticleList, Particle*, float> ParticleSystem::mRadixSorter;
 
@@ -73,7 +75,7 @@ namespace Ogre {
 
         Real getValue(void) const { return 0; } // N/A
 
-        void setValue(Real value) { mTarget->_update(value); }
+        void setValue(Real value) { mTarget->_notifyFrameTime(value); }
 
     };
     //-----------------------------------------------------------------------
@@ -97,6 +99,12 @@ namespace Ogre {
         mTimeController(0),
         mEmittedEmitterPoolInitialised(false),
         mIsEmitting(true),
+        mGpuSimulation(false),
+        mGpuSimulationRejected(false),
+        mGpuSimulator(0),
+        mPendingUpdateTime(0),
+        mQueuedForParallelUpdate(false),
+        mUpdatingInParallel(false),
         mRenderer(0), 
         mCullIndividual(false),
         mPoolSize(0),
@@ -120,6 +128,12 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     ParticleSystem::~ParticleSystem()
     {
+        if (mGpuSimulator)
+            mGpuSimulator->_removeParticleSystem(this);
+
+        if (mQueuedForParallelUpdate)
+            mManager->_removeParticleSystemUpdate(this);
+
         if (mTimeController)
         {
             // Destroy controller
@@ -136,9 +150,9 @@ namespace Ogre {
         destroyVisualParticles(0, mParticlePool.size());
         // Free pool items
         ParticlePool::iterator i;
-        for (i = mParticlePool.begin(); i != mParticlePool.end(); ++i)
+        for (i = mParticleBlocks.begin(); i != mParticleBlocks.end(); ++i)
         {
-            OGRE_DELETE *i;
+            OGRE_DELETE [] *i;
         }
 
         if (mRenderer)
@@ -269,6 +283,7 @@ namespace Ogre {
         mNonvisibleTimeout = rhs.mNonvisibleTimeout;
         mNonvisibleTimeoutSet = rhs.mNonvisibleTimeoutSet;
         // last frame visible and time since last visible should be left default
+        setGpuSimulation(rhs.mGpuSimulation);
 
         setRenderer(rhs.getRendererName());
         // Copy settings
@@ -283,6 +298,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     size_t ParticleSystem::getNumParticles(void) const
     {
+        if (mGpuSimulator)
+            return 0;
         return mActiveParticles.size();
     }
     //-----------------------------------------------------------------------
@@ -300,7 +317,15 @@ namespace Ogre {
         {
             // Will allocate particles on demand
             mPoolSize = size;
-            
+
+            // GPU buffers must be recreated with the new size
+            if (mGpuSimulator)
+            {
+                GpuParticleSimulator *simulator = mGpuSimulator;
+                simulator->_removeParticleSystem(this);
+                if (!simulator->_addParticleSystem(this))
+                    mGpuSimulationRejected = true;
+            }
         }
     }
     //-----------------------------------------------------------------------
@@ -344,6 +369,32 @@ namespace Ogre {
         if (!mParentNode)
             return;
 
+        if (mGpuSimulation && !mGpuSimulator && !mGpuSimulationRejected)
+        {
+            GpuParticleSimulator *simulator =
+                ParticleSystemManager::getSingleton().getGpuParticleSimulator();
+            if (simulator)
+            {
+                // Particles simulated so far on the CPU can't be carried over
+                clear();
+                if (!simulator->_addParticleSystem(this))
+                    mGpuSimulationRejected = true;
+            }
+        }
+
+        if (mGpuSimulator)
+        {
+            // The GPU does all the work. We only tell it how much time passed
+            // and how many particles the emitters want
+            timeElapsed *= mSpeedFactor;
+            mGpuSimulator->_notifyUpdate(this, timeElapsed);
+
+            if (!mBoundsAutoUpdate && mBoundsUpdateTime > 0.0f)
+                mBoundsUpdateTime -= timeElapsed; // count down
+            _updateBounds();
+            return;
+        }
+
         Real nonvisibleTimeout = mNonvisibleTimeoutSet ?
             mNonvisibleTimeout : msDefaultNonvisibleTimeout;
 
@@ -414,6 +465,53 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void ParticleSystem::_notifyFrameTime(Real timeElapsed)
+    {
+        // Systems on the GPU (or trying to get there) talk to the simulator,
+        // which must happen from the main thread
+        if (mManager->getParallelParticleSystemUpdates() && mParentNode && !mGpuSimulation)
+        {
+            mPendingUpdateTime += timeElapsed;
+            if (!mQueuedForParallelUpdate)
+            {
+                mQueuedForParallelUpdate = true;
+                mManager->_queueParticleSystemUpdate(this);
+            }
+        }
+        else
+        {
+            _update(timeElapsed);
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_prepareParallelUpdate(void)
+    {
+        if (!mParentNode)
+            return;
+
+        // Creates the renderer's visual data & emitted emitters
+        configureRenderer();
+        initialiseEmittedEmitters();
+
+        // Walks up (and writes to) the parent nodes, which other systems may share
+        mParentNode->_getFullTransformUpdated();
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_executeParallelUpdate(void)
+    {
+        mUpdatingInParallel = true;
+        _update(mPendingUpdateTime);
+        mUpdatingInParallel = false;
+        mPendingUpdateTime = 0;
+        mQueuedForParallelUpdate = false;
+    }
+    //-----------------------------------------------------------------------
+    const Matrix4& ParticleSystem::getParentFullTransform(void) const
+    {
+        return mUpdatingInParallel ? mParentNode->_getFullTransform() :
+                                     mParentNode->_getFullTransformUpdated();
+    }
+    //-----------------------------------------------------------------------
     void ParticleSystem::_expire(Real timeElapsed)
     {
         ActiveParticleList::iterator i, itEnd;
@@ -547,7 +645,7 @@ namespace Ogre {
 
         //TODO: (dark_sylinc) Refactor this. ControllerManager gets executed before us
         //(because it doesn't know if we'll update a SceneNode)
-        const Matrix4 fullTransform = mParentNode->_getFullTransformUpdated();
+        const Matrix4 fullTransform = getParentFullTransform();
 
         for (unsigned int j = 0; j < requested; ++j)
         {
@@ -644,10 +742,13 @@ namespace Ogre {
         mParticlePool.reserve(size);
         mParticlePool.resize(size);
 
-        // Create new particles
-        for( size_t i = oldSize; i < size; i++ )
+        // Create new particles, all in one block
+        if( size > oldSize )
         {
-            mParticlePool[i] = OGRE_NEW Particle();
+            Particle *block = OGRE_NEW Particle[size - oldSize];
+            mParticleBlocks.push_back( block );
+            for( size_t i = oldSize; i < size; i++ )
+                mParticlePool[i] = block + (i - oldSize);
         }
 
         if (mIsRendererConfigured)
@@ -715,6 +816,10 @@ namespace Ogre {
         mLastVisibleFrame = Root::getSingleton().getNextFrameNumber();
         mTimeSinceLastVisible = 0.0f;
 
+        // Our renderable was put in a FAST render queue; there's nothing to do
+        if (mGpuSimulator)
+            return;
+
         if (mSorted)
             _sortParticles(camera);
 
@@ -791,6 +896,12 @@ namespace Ogre {
                 PT_REAL),
                 &msNonvisibleTimeoutCmd);
 
+            dict->addParameter(ParameterDef("gpu_simulation",
+                "Sets whether the system should be simulated with compute shaders by the "
+                "GpuParticleSimulator, if there is one and it supports this system.",
+                PT_BOOL),
+                &msGpuSimulationCmd);
+
         }
     }
     //-----------------------------------------------------------------------
@@ -798,6 +909,16 @@ namespace Ogre {
     {
         if (mParentNode && (mBoundsAutoUpdate || mBoundsUpdateTime > 0.0f))
         {
+            if (mGpuSimulator)
+            {
+                // Already in local space
+                Aabb aabb = mGpuSimulator->_calculateBounds(this);
+                mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
+                mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+                mObjectData.invalidateBounds();
+                return;
+            }
+
             Aabb aabb;
             if (mActiveParticles.empty())
             {
@@ -841,11 +962,12 @@ namespace Ogre {
                 // node transform, so reverse transform back since we're expected to 
                 // provide a local AABB
                 //TODO: (dark_sylinc) refactor the "Updated" part
-                aabb.transformAffine( mParentNode->_getFullTransformUpdated().inverseAffine() );
+                aabb.transformAffine( getParentFullTransform().inverseAffine() );
             }
 
             mObjectData.mLocalAabb->setFromAabb( aabb, mObjectData.mIndex );
             mObjectData.mLocalRadius[mObjectData.mIndex] = aabb.getRadius();
+            mObjectData.invalidateBounds();
         }
     }
     //-----------------------------------------------------------------------
@@ -869,6 +991,26 @@ namespace Ogre {
         return mIsEmitting;
     }
     //-----------------------------------------------------------------------
+    void ParticleSystem::setGpuSimulation( bool gpuSimulation )
+    {
+        mGpuSimulation = gpuSimulation;
+        mGpuSimulationRejected = false;
+
+        if (!gpuSimulation && mGpuSimulator)
+            mGpuSimulator->_removeParticleSystem(this);
+    }
+    //-----------------------------------------------------------------------
+    void ParticleSystem::_notifyGpuSimulator( GpuParticleSimulator *simulator,
+                                              Renderable *renderable )
+    {
+        mGpuSimulator = simulator;
+
+        // When going back to the CPU, the renderer fills it on the next _updateRenderQueue
+        mRenderables.clear();
+        if (renderable)
+            mRenderables.push_back(renderable);
+    }
+    //-----------------------------------------------------------------------
     const String& ParticleSystem::getMovableType(void) const
     {
         return ParticleSystemFactory::FACTORY_TYPE_NAME;
@@ -961,6 +1103,8 @@ namespace Ogre {
     void ParticleSystem::setMaterialName( const String& name, const String& groupName /* = ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME */)
     {
         mMaterialName = name;
+        if (mGpuSimulator)
+            mGpuSimulator->_notifyMaterialChanged(this);
         if (mIsRendererConfigured)
         {
             HlmsManager *hlmsManager = Root::getSingleton().getHlmsManager();
@@ -984,6 +1128,9 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void ParticleSystem::clear()
     {
+        if (mGpuSimulator)
+            mGpuSimulator->_notifyCleared(this);
+
         // Notify renderer if exists
         if (mRenderer)
         {
@@ -1146,6 +1293,9 @@ namespace Ogre {
     void ParticleSystem::setKeepParticlesInLocalSpace(bool keepLocal)
     {
         mLocalSpace = keepLocal;
+        // Existing particles would be interpreted in the wrong space
+        if (mGpuSimulator)
+            mGpuSimulator->_notifyCleared(this);
         if (mRenderer)
         {
             mRenderer->setKeepParticlesInLocalSpace(keepLocal);
@@ -1547,6 +1697,17 @@ namespace Ogre {
         static_cast<ParticleSystem*>(target)->setNonVisibleUpdateTimeout(
             StringConverter::parseReal(val));
     }
+    //-----------------------------------------------------------------------
+    String ParticleSystem::CmdGpuSimulation::doGet(const void* target) const
+    {
+        return StringConverter::toString(
+            static_cast<const ParticleSystem*>(target)->getGpuSimulation());
+    }
+    void ParticleSystem::CmdGpuSimulation::doSet(void* target, const String& val)
+    {
+        static_cast<ParticleSystem*>(target)->setGpuSimulation(
+            StringConverter::parseBool(val));
+    }
    //-----------------------------------------------------------------------
     ParticleAffector::~ParticleAffector() 
     {
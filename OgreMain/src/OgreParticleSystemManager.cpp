@@ -53,7 +53,8 @@ namespace Ogre {
         assert( msSingleton );  return ( *msSingleton );  
     }
     //-----------------------------------------------------------------------
-    ParticleSystemManager::ParticleSystemManager()
+    ParticleSystemManager::ParticleSystemManager() :
+        mGpuParticleSimulator( 0 )
     {
         OGRE_LOCK_AUTO_MUTEX;
         mFactory = OGRE_NEW ParticleSystemFactory();
@@ -369,6 +370,17 @@ namespace Ogre {
         pFact->second->destroyInstance(renderer);
     }
     //-----------------------------------------------------------------------
+    void ParticleSystemManager::_setGpuParticleSimulator( GpuParticleSimulator *simulator )
+    {
+        if( simulator && mGpuParticleSimulator && simulator != mGpuParticleSimulator )
+        {
+            OGRE_EXCEPT( Exception::ERR_DUPLICATE_ITEM,
+                         "Only one GpuParticleSimulator can exist at a time",
+                         "ParticleSystemManager::_setGpuParticleSimulator" );
+        }
+        mGpuParticleSimulator = simulator;
+    }
+    //-----------------------------------------------------------------------
     void ParticleSystemManager::_initialise(void)
     {
         OGRE_LOCK_AUTO_MUTEX;
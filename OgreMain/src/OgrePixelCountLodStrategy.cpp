@@ -135,7 +135,6 @@ namespace Ogre {
         cameraPos.setAll( camera->_getCachedDerivedPosition() );
 
         const Matrix4 &projMat = camera->getProjectionMatrix();
-        OGRE_ALIGNED_DECL( Real, lodValues[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
 
         if( camera->getProjectionType() == PT_PERSPECTIVE )
         {
@@ -159,9 +158,7 @@ namespace Ogre {
                 ArrayReal sqRadius = (*worldRadius * *worldRadius);
                 ArrayReal arrayLodValue = (sqRadius * constTerm) / sqDistance;
 
-                CastArrayToReal( lodValues, arrayLodValue );
-
-                lodSet( objData, lodValues );
+                lodSet( objData, arrayLodValue );
 
                 objData.advanceLodPack();
             }
@@ -186,9 +183,8 @@ namespace Ogre {
                                                                             (objData.mWorldRadius);
                 ArrayReal arrayLodValue = (*worldRadius * *worldRadius) *
                                             PiDotVpAreaDivOrhtoArea * lodBias;
-                CastArrayToReal( lodValues, arrayLodValue );
 
-                lodSet( objData, lodValues );
+                lodSet( objData, arrayLodValue );
 
                 objData.advanceLodPack();
             }
@@ -238,7 +234,6 @@ namespace Ogre {
         cameraPos.setAll( camera->_getCachedDerivedPosition() );
 
         const Matrix4 &projMat = camera->getProjectionMatrix();
-        OGRE_ALIGNED_DECL( Real, lodValues[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
 
         if( camera->getProjectionType() == PT_PERSPECTIVE )
         {
@@ -294,9 +289,7 @@ namespace Ogre {
                 ArrayReal sqRadius = (*worldRadius * *worldRadius);
                 ArrayReal arrayLodValue = (sqRadius * constTerm) / sqDistance;
 
-                CastArrayToReal( lodValues, arrayLodValue );
-
-                lodSet( objData, lodValues );
+                lodSet( objData, arrayLodValue );
 
                 objData.advanceLodPack();
             }
@@ -320,9 +313,8 @@ namespace Ogre {
                                                                             (objData.mWorldRadius);
                 ArrayReal arrayLodValue = (*worldRadius * *worldRadius) *
                                             PiDotVpAreaDivOrhtoArea * lodBias;
-                CastArrayToReal( lodValues, arrayLodValue );
 
-                lodSet( objData, lodValues );
+                lodSet( objData, arrayLodValue );
 
                 objData.advanceLodPack();
             }
@@ -35,8 +35,10 @@ THE SOFTWARE.
 #include "OgreCommon.h"
 #include "OgreColourValue.h"
 #include "OgreException.h"
+#include "OgrePlatformInformation.h"
 
 #include "OgreProfiler.h"
+#include "Threading/OgreThreads.h"
 
 namespace Ogre
 {
@@ -1398,7 +1400,304 @@ namespace Ogre
         void convRGtoR(uint8* src, uint8* dst, size_t width) {
             while (width--) { dst[0] = src[0]; src += 2; dst += 1; }
         }
+        void convRGtoRGBA(uint8* src, uint8* dst, size_t width) {
+            while (width--)
+            { dst[0] = src[0]; dst[1] = src[1]; dst[2] = 0u; dst[3] = 0xFF; src += 2; dst += 4; }
+        }
+        void convRtoRGBA(uint8* src, uint8* dst, size_t width) {
+            while (width--)
+            { dst[0] = src[0]; dst[1] = 0u; dst[2] = 0u; dst[3] = 0xFF; src += 1; dst += 4; }
+        }
+        void convRtoRGB(uint8* src, uint8* dst, size_t width) {
+            while (width--) { dst[0] = src[0]; dst[1] = 0u; dst[2] = 0u; src += 1; dst += 3; }
+        }
         // clang-format on
+
+        /// Lookup tables for conversions between 8-bit and float formats. They produce
+        /// the exact same results as going through unpackColour & packColour.
+        struct ConversionTables
+        {
+            /// 8-bit UNORM to float, linear & sRGB
+            float   unormToFloat[2][256];
+            /// Same as unormToFloat, but as half
+            uint16  unormToHalf[2][256];
+            /// srgbThreshold[bgra][i] is the smallest linear value that encodes to sRGB i + 1.
+            /// packColour rounds RGBA8 & BGRA8 differently, hence one table for each.
+            float   srgbThreshold[2][255];
+
+            /// Same as packColour for PFG_RGBA8_UNORM & PFG_BGRA8_UNORM respectively
+            template <bool bgra>
+            static inline uint8 encodeUnorm( float val )
+            {
+                if( bgra )
+                    return static_cast<uint8>( Math::saturate( val ) * 255.0f + 0.5f );
+                return static_cast<uint8>( roundf( Math::saturate( val ) * 255.0f ) );
+            }
+
+            /// Same as packColour for PFG_RGBA8_UNORM_SRGB & PFG_BGRA8_UNORM_SRGB respectively
+            static uint8 encodeSrgbReference( float linear, bool bgra )
+            {
+                if( bgra )
+                {
+                    return static_cast<uint8>(
+                        Math::saturate( PixelFormatGpuUtils::toSRGB( linear ) ) * 255.0f + 0.5f );
+                }
+                return static_cast<uint8>(
+                    roundf( PixelFormatGpuUtils::toSRGB( Math::saturate( linear ) ) * 255.0f ) );
+            }
+
+            ConversionTables()
+            {
+                for( size_t i=0; i<256u; ++i )
+                {
+                    const float val = static_cast<float>( i ) / 255.0f;
+                    unormToFloat[0][i] = val;
+                    unormToFloat[1][i] = PixelFormatGpuUtils::fromSRGB( val );
+                    for( size_t j=0; j<2u; ++j )
+                        unormToHalf[j][i] = Bitwise::floatToHalf( unormToFloat[j][i] );
+                }
+
+                //Start from the analytical midpoint, then walk to the exact
+                //boundary of the reference encoder
+                for( size_t j=0; j<2u; ++j )
+                {
+                    const bool bgra = j != 0u;
+                    for( size_t i=0; i<255u; ++i )
+                    {
+                        const uint8 target = static_cast<uint8>( i + 1u );
+                        float threshold = PixelFormatGpuUtils::fromSRGB(
+                                              ( static_cast<float>( i ) + 0.5f ) / 255.0f );
+                        while( encodeSrgbReference( threshold, bgra ) >= target &&
+                               threshold > 0.0f )
+                        {
+                            threshold = nextafterf( threshold, -1.0f );
+                        }
+                        while( encodeSrgbReference( threshold, bgra ) < target )
+                            threshold = nextafterf( threshold, 2.0f );
+                        srgbThreshold[j][i] = threshold;
+                    }
+                }
+            }
+
+            template <bool bgra>
+            inline uint8 encodeSrgb( float linear ) const
+            {
+                //Binary search over the thresholds. NaN ends up as 0, like saturate
+                const float *thresholds = srgbThreshold[bgra ? 1 : 0];
+                uint32 idx = 0u;
+                for( uint32 step = 128u; step; step >>= 1u )
+                {
+                    if( idx + step <= 255u && linear >= thresholds[idx + step - 1u] )
+                        idx += step;
+                }
+                return static_cast<uint8>( idx );
+            }
+        };
+        static const ConversionTables c_conversionTables;
+
+        /// 8-bit RGBA or BGRA (linear or sRGB) to RGBA32_FLOAT
+        template <bool bgra, bool srgb>
+        void conv8toRGBA32F( uint8 *src, uint8 *dst, size_t width )
+        {
+            const float *lut = c_conversionTables.unormToFloat[srgb ? 1 : 0];
+            const float *alphaLut = c_conversionTables.unormToFloat[0];
+            float *dstF = reinterpret_cast<float*>( dst );
+            while( width-- )
+            {
+                dstF[0] = lut[src[bgra ? 2 : 0]];
+                dstF[1] = lut[src[1]];
+                dstF[2] = lut[src[bgra ? 0 : 2]];
+                dstF[3] = alphaLut[src[3]];
+                src += 4;
+                dstF += 4;
+            }
+        }
+        /// 8-bit RGBA or BGRA (linear or sRGB) to RGBA16_FLOAT
+        template <bool bgra, bool srgb>
+        void conv8toRGBA16F( uint8 *src, uint8 *dst, size_t width )
+        {
+            const uint16 *lut = c_conversionTables.unormToHalf[srgb ? 1 : 0];
+            const uint16 *alphaLut = c_conversionTables.unormToHalf[0];
+            uint16 *dstH = reinterpret_cast<uint16*>( dst );
+            while( width-- )
+            {
+                dstH[0] = lut[src[bgra ? 2 : 0]];
+                dstH[1] = lut[src[1]];
+                dstH[2] = lut[src[bgra ? 0 : 2]];
+                dstH[3] = alphaLut[src[3]];
+                src += 4;
+                dstH += 4;
+            }
+        }
+        /// RGBA32_FLOAT to 8-bit RGBA or BGRA (linear or sRGB)
+        template <bool bgra, bool srgb>
+        void convRGBA32Fto8( uint8 *src, uint8 *dst, size_t width )
+        {
+            const float *srcF = reinterpret_cast<const float*>( src );
+            while( width-- )
+            {
+                for( size_t i=0; i<3u; ++i )
+                {
+                    const size_t dstIdx = bgra ? 2u - i : i;
+                    dst[dstIdx] = srgb ? c_conversionTables.encodeSrgb<bgra>( srcF[i] ) :
+                                         ConversionTables::encodeUnorm<bgra>( srcF[i] );
+                }
+                dst[3] = ConversionTables::encodeUnorm<bgra>( srcF[3] );
+                srcF += 4;
+                dst += 4;
+            }
+        }
+        /// RGBA16_FLOAT to 8-bit RGBA or BGRA (linear or sRGB)
+        template <bool bgra, bool srgb>
+        void convRGBA16Fto8( uint8 *src, uint8 *dst, size_t width )
+        {
+            const uint16 *srcH = reinterpret_cast<const uint16*>( src );
+            while( width-- )
+            {
+                for( size_t i=0; i<3u; ++i )
+                {
+                    const size_t dstIdx = bgra ? 2u - i : i;
+                    const float val = Bitwise::halfToFloat( srcH[i] );
+                    dst[dstIdx] = srgb ? c_conversionTables.encodeSrgb<bgra>( val ) :
+                                         ConversionTables::encodeUnorm<bgra>( val );
+                }
+                dst[3] = ConversionTables::encodeUnorm<bgra>( Bitwise::halfToFloat( srcH[3] ) );
+                srcH += 4;
+                dst += 4;
+            }
+        }
+        void convRGBA16FtoRGBA32F( uint8 *src, uint8 *dst, size_t width )
+        {
+            const uint16 *srcH = reinterpret_cast<const uint16*>( src );
+            float *dstF = reinterpret_cast<float*>( dst );
+            width *= 4u;
+            while( width-- )
+                *dstF++ = Bitwise::halfToFloat( *srcH++ );
+        }
+        void convRGBA32FtoRGBA16F( uint8 *src, uint8 *dst, size_t width )
+        {
+            const float *srcF = reinterpret_cast<const float*>( src );
+            uint16 *dstH = reinterpret_cast<uint16*>( dst );
+            width *= 4u;
+            while( width-- )
+                *dstH++ = Bitwise::floatToHalf( *srcF++ );
+        }
+
+        /// Returns the optimized row conversion between two formats with different
+        /// semantics (i.e. which is not a mere copy or swizzle), if there's one.
+        row_conversion_func_t getTypedRowConversion( PixelFormatGpu srcFormat,
+                                                     PixelFormatGpu dstFormat )
+        {
+            //0 = RGBA8, 1 = RGBA8 sRGB, 2 = BGRA8, 3 = BGRA8 sRGB, 4 = RGBA16F, 5 = RGBA32F
+            const PixelFormatGpu formats[6] =
+            {
+                PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB,
+                PFG_BGRA8_UNORM, PFG_BGRA8_UNORM_SRGB,
+                PFG_RGBA16_FLOAT, PFG_RGBA32_FLOAT
+            };
+
+            size_t srcIdx = 6u, dstIdx = 6u;
+            for( size_t i=0; i<6u; ++i )
+            {
+                if( formats[i] == srcFormat )
+                    srcIdx = i;
+                if( formats[i] == dstFormat )
+                    dstIdx = i;
+            }
+
+            if( srcIdx == 6u || dstIdx == 6u )
+                return 0;
+
+            const row_conversion_func_t table[6][6] =
+            {
+                // clang-format off
+                { 0, 0, 0, 0, conv8toRGBA16F<false, false>, conv8toRGBA32F<false, false> },
+                { 0, 0, 0, 0, conv8toRGBA16F<false, true>,  conv8toRGBA32F<false, true> },
+                { 0, 0, 0, 0, conv8toRGBA16F<true, false>,  conv8toRGBA32F<true, false> },
+                { 0, 0, 0, 0, conv8toRGBA16F<true, true>,   conv8toRGBA32F<true, true> },
+                { convRGBA16Fto8<false, false>, convRGBA16Fto8<false, true>,
+                  convRGBA16Fto8<true, false>, convRGBA16Fto8<true, true>,
+                  0, convRGBA16FtoRGBA32F },
+                { convRGBA32Fto8<false, false>, convRGBA32Fto8<false, true>,
+                  convRGBA32Fto8<true, false>, convRGBA32Fto8<true, true>,
+                  convRGBA32FtoRGBA16F, 0 }
+                // clang-format on
+            };
+
+            return table[srcIdx][dstIdx];
+        }
+
+        /// A range of rows to convert by bulkPixelConversion
+        struct BulkConversionJob
+        {
+            uint8 const *srcData;
+            uint8       *dstData;
+            size_t      srcBytesPerRow;
+            size_t      srcBytesPerImage;
+            size_t      dstBytesPerRow;
+            size_t      dstBytesPerImage;
+            size_t      width;
+            size_t      height;
+            bool        verticalFlip;
+
+            /// When null, the slow path through unpackColour & packColour is used
+            row_conversion_func_t rowConversionFunc;
+            PixelFormatGpu  srcFormat;
+            PixelFormatGpu  dstFormat;
+            float           rangeM;
+            float           rangeA;
+
+            /// Rows in range [rowStart; rowEnd) where row = z * height + y
+            size_t      rowStart;
+            size_t      rowEnd;
+
+            void execute(void) const
+            {
+                const size_t srcBytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel( srcFormat );
+                const size_t dstBytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel( dstFormat );
+
+                float rgba[4];
+                for( size_t row=rowStart; row<rowEnd; ++row )
+                {
+                    const size_t z = row / height;
+                    const size_t y = row % height;
+                    const size_t dest_y = verticalFlip ? height - 1 - y : y;
+                    uint8 *srcPtr = const_cast<uint8*>( srcData ) + srcBytesPerImage * z +
+                                    srcBytesPerRow * y;
+                    uint8 *dstPtr = dstData + dstBytesPerImage * z + dstBytesPerRow * dest_y;
+
+                    if( rowConversionFunc )
+                    {
+                        rowConversionFunc( srcPtr, dstPtr, width );
+                    }
+                    else
+                    {
+                        for( size_t x=0; x<width; ++x )
+                        {
+                            PixelFormatGpuUtils::unpackColour( rgba, srcFormat, srcPtr );
+                            for( int i = 0; i < 4; ++i )
+                                rgba[i] = rgba[i] * rangeM + rangeA;
+                            PixelFormatGpuUtils::packColour( rgba, dstFormat, dstPtr );
+                            srcPtr += srcBytesPerPixel;
+                            dstPtr += dstBytesPerPixel;
+                        }
+                    }
+                }
+            }
+        };
+
+        unsigned long bulkPixelConversionThread( ThreadHandle *threadHandle )
+        {
+            const BulkConversionJob *job =
+                    reinterpret_cast<const BulkConversionJob*>( threadHandle->getUserParam() );
+            job->execute();
+            return 0;
+        }
+        THREAD_DECLARE( bulkPixelConversionThread );
+
+        /// Images with fewer pixels than this are converted on the calling thread
+        static const size_t c_minPixelsForThreadedConversion = 1024u * 1024u;
+        static const size_t c_maxConversionThreads = 8u;
     }  // namespace
     //-----------------------------------------------------------------------------------
     void PixelFormatGpuUtils::bulkPixelConversion( const TextureBox &src, PixelFormatGpu srcFormat,
@@ -1423,7 +1722,6 @@ namespace Ogre
         assert( getBytesPerPixel(dstFormat) == dst.bytesPerPixel );
 
         const size_t srcBytesPerPixel = src.bytesPerPixel;
-        const size_t dstBytesPerPixel = dst.bytesPerPixel;
 
         uint8 *srcData = reinterpret_cast<uint8*>( src.at( src.x, src.y, src.getZOrSlice() ) );
         uint8 *dstData = reinterpret_cast<uint8*>( dst.at( dst.x, dst.y, dst.getZOrSlice() ) );
@@ -1508,67 +1806,89 @@ namespace Ogre
             case PFL_PAIR( PFL_RG8, PFL_RGB8 ): rowConversionFunc = convRGtoRGB; break;
             case PFL_PAIR( PFL_RG8, PFL_BGR8 ): rowConversionFunc = convRGtoBGR; break;
             case PFL_PAIR( PFL_RG8, PFL_R8 ): rowConversionFunc = convRGtoR; break;
+            case PFL_PAIR( PFL_RG8, PFL_RGBA8 ): rowConversionFunc = convRGtoRGBA; break;
+
+            case PFL_PAIR( PFL_R8, PFL_RGBA8 ): rowConversionFunc = convRtoRGBA; break;
+            case PFL_PAIR( PFL_R8, PFL_RGB8 ): rowConversionFunc = convRtoRGB; break;
                 // clang-format on
             }
 #undef PFL_PAIR
         }
 
-        if (rowConversionFunc)
-        {
-            for( size_t z=0; z<depthOrSlices; ++z )
-            {
-                for( size_t y=0; y<height; ++y )
-                {
-                    size_t dest_y = verticalFlip ? height - 1 - y : y;
-                    uint8* srcPtr = srcData + src.bytesPerImage * z + src.bytesPerRow * y;
-                    uint8* dstPtr = dstData + dst.bytesPerImage * z + dst.bytesPerRow * dest_y;
-                    rowConversionFunc( srcPtr, dstPtr, width );
-                }
-            }
-            return;
-        }
+        if( !rowConversionFunc )
+            rowConversionFunc = getTypedRowConversion( srcFormat, dstFormat );
+
+        BulkConversionJob job;
+        job.srcData             = srcData;
+        job.dstData             = dstData;
+        job.srcBytesPerRow      = src.bytesPerRow;
+        job.srcBytesPerImage    = src.bytesPerImage;
+        job.dstBytesPerRow      = dst.bytesPerRow;
+        job.dstBytesPerImage    = dst.bytesPerImage;
+        job.width               = width;
+        job.height              = height;
+        job.verticalFlip        = verticalFlip;
+        job.rowConversionFunc   = rowConversionFunc;
+        job.srcFormat           = srcFormat;
+        job.dstFormat           = dstFormat;
+        job.rowStart            = 0;
+        job.rowEnd              = height * depthOrSlices;
 
         // The brute force fallback
-        float rangeM = 1.0f;
-        float rangeA = 0.0f;
+        job.rangeM = 1.0f;
+        job.rangeA = 0.0f;
 
         const bool bSrcSigned = isSigned( srcFormat );
-        if( bSrcSigned != isSigned( dstFormat ) && isNormalized( srcFormat ) )
+        if( !rowConversionFunc && bSrcSigned != isSigned( dstFormat ) && isNormalized( srcFormat ) )
         {
             if( !bSrcSigned )
             {
                 // unormToSnorm
-                rangeM = 2.0f;
-                rangeA = -1.0f;
+                job.rangeM = 2.0f;
+                job.rangeA = -1.0f;
             }
             else
             {
                 // snormToUnorm
-                rangeM = 0.5f;
-                rangeA = 0.5f;
+                job.rangeM = 0.5f;
+                job.rangeA = 0.5f;
             }
         }
 
-        float rgba[4];
-        for( size_t z=0; z<depthOrSlices; ++z )
+        size_t numThreads = 1u;
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( width * job.rowEnd >= c_minPixelsForThreadedConversion )
         {
-            for( size_t y=0; y<height; ++y )
-            {
-                size_t dest_y = verticalFlip ? height - 1 - y : y;
-                uint8 *srcPtr = srcData + src.bytesPerImage * z + src.bytesPerRow * y;
-                uint8 *dstPtr = dstData + dst.bytesPerImage * z + dst.bytesPerRow * dest_y;
+            //getNumLogicalCores() may return 0 if couldn't detect
+            numThreads = std::max<size_t>( 1u, PlatformInformation::getNumLogicalCores() );
+            numThreads = std::min( std::min( numThreads, c_maxConversionThreads ), job.rowEnd );
+        }
+#endif
 
-                for( size_t x=0; x<width; ++x )
-                {
-                    unpackColour( rgba, srcFormat, srcPtr );
-                    for( int i = 0; i < 4; ++i )
-                        rgba[i] = rgba[i] * rangeM + rangeA;
-                    packColour( rgba, dstFormat, dstPtr );
-                    srcPtr += srcBytesPerPixel;
-                    dstPtr += dstBytesPerPixel;
-                }
+        if( numThreads <= 1u )
+        {
+            job.execute();
+            return;
+        }
+
+        //The calling thread takes the first range
+        BulkConversionJob jobs[c_maxConversionThreads];
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve( numThreads - 1u );
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            jobs[i] = job;
+            jobs[i].rowStart = ( job.rowEnd * i ) / numThreads;
+            jobs[i].rowEnd = ( job.rowEnd * ( i + 1u ) ) / numThreads;
+            if( i != 0u )
+            {
+                threadHandles.push_back(
+                    Threads::CreateThread( THREAD_GET( bulkPixelConversionThread ), i, &jobs[i] ) );
             }
         }
+
+        jobs[0].execute();
+        Threads::WaitForThreads( threadHandles );
     }
     //-----------------------------------------------------------------------------------
     uint32 PixelFormatGpuUtils::getFlags( PixelFormatGpu format )
@@ -0,0 +1,276 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgrePortalZoneManager.h"
+#include "OgreCamera.h"
+#include "OgreException.h"
+
+namespace Ogre
+{
+    const uint16 PortalZoneManager::NoZone;
+
+    //-----------------------------------------------------------------------------------
+    PortalZoneManager::PortalZoneManager() :
+        mAllVisible( true ),
+        mCameraZone( NoZone ),
+        mLastCamera( 0 ),
+        mMaxPortalDepth( 16u )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    PortalZoneManager::~PortalZoneManager()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    uint16 PortalZoneManager::createZone( const Aabb &aabb )
+    {
+        if( mZones.size() >= NoZone )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Too many zones",
+                         "PortalZoneManager::createZone" );
+        }
+
+        Zone zone;
+        zone.aabb = aabb;
+        mZones.push_back( zone );
+        mVisibleZones.push_back( 1u );
+
+        return static_cast<uint16>( mZones.size() - 1u );
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::setZoneAabb( uint16 zoneId, const Aabb &aabb )
+    {
+        assert( zoneId < mZones.size() );
+        mZones[zoneId].aabb = aabb;
+    }
+    //-----------------------------------------------------------------------------------
+    const Aabb& PortalZoneManager::getZoneAabb( uint16 zoneId ) const
+    {
+        assert( zoneId < mZones.size() );
+        return mZones[zoneId].aabb;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 PortalZoneManager::createPortal( uint16 zoneA, uint16 zoneB, const Vector3 corners[4] )
+    {
+        if( zoneA >= mZones.size() || zoneB >= mZones.size() || zoneA == zoneB )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "Invalid zones",
+                         "PortalZoneManager::createPortal" );
+        }
+
+        const uint32 portalId = static_cast<uint32>( mPortals.size() );
+
+        Portal portal;
+        portal.zones[0]     = zoneA;
+        portal.zones[1]     = zoneB;
+        portal.enabled      = true;
+        portal.inTraversal  = false;
+        mPortals.push_back( portal );
+        setPortalCorners( portalId, corners );
+
+        mZones[zoneA].portals.push_back( portalId );
+        mZones[zoneB].portals.push_back( portalId );
+
+        return portalId;
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::setPortalCorners( uint32 portalId, const Vector3 corners[4] )
+    {
+        assert( portalId < mPortals.size() );
+        Portal &portal = mPortals[portalId];
+        for( size_t i=0; i<4u; ++i )
+            portal.corners[i] = corners[i];
+        portal.centre = (corners[0] + corners[1] + corners[2] + corners[3]) * 0.25f;
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::setPortalEnabled( uint32 portalId, bool bEnabled )
+    {
+        assert( portalId < mPortals.size() );
+        mPortals[portalId].enabled = bEnabled;
+    }
+    //-----------------------------------------------------------------------------------
+    bool PortalZoneManager::getPortalEnabled( uint32 portalId ) const
+    {
+        assert( portalId < mPortals.size() );
+        return mPortals[portalId].enabled;
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::destroyAll(void)
+    {
+        mZones.clear();
+        mPortals.clear();
+        mVisibleZones.clear();
+        mAllVisible = true;
+        mCameraZone = NoZone;
+    }
+    //-----------------------------------------------------------------------------------
+    uint16 PortalZoneManager::findZone( const Vector3 &point ) const
+    {
+        uint16 retVal = NoZone;
+        Real smallestVolume = std::numeric_limits<Real>::max();
+
+        for( size_t i=0; i<mZones.size(); ++i )
+        {
+            const Aabb &aabb = mZones[i].aabb;
+            if( aabb.contains( point ) )
+            {
+                const Vector3 size = aabb.getSize();
+                const Real volume = size.x * size.y * size.z;
+                if( volume < smallestVolume )
+                {
+                    smallestVolume = volume;
+                    retVal = static_cast<uint16>( i );
+                }
+            }
+        }
+
+        return retVal;
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::assignZone( MovableObject *movableObject ) const
+    {
+        movableObject->setPortalZone( findZone( movableObject->getWorldAabb().mCenter ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::addTrackedObject( MovableObject *movableObject )
+    {
+        mTrackedObjects.push_back( movableObject );
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::removeTrackedObject( MovableObject *movableObject )
+    {
+        MovableObject::MovableObjectArray::iterator itor = std::find( mTrackedObjects.begin(),
+                                                                      mTrackedObjects.end(),
+                                                                      movableObject );
+        if( itor != mTrackedObjects.end() )
+            efficientVectorRemove( mTrackedObjects, itor );
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::_updateTrackedObjects(void)
+    {
+        MovableObject::MovableObjectArray::const_iterator itor = mTrackedObjects.begin();
+        MovableObject::MovableObjectArray::const_iterator end  = mTrackedObjects.end();
+
+        while( itor != end )
+            assignZone( *itor++ );
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::traverse( uint16 zoneId, const Vector3 &eyePos, Real nearDist,
+                                      size_t depth )
+    {
+        mVisibleZones[zoneId] = 1u;
+
+        if( depth >= mMaxPortalDepth )
+            return;
+
+        const Zone &zone = mZones[zoneId];
+
+        FastArray<uint32>::const_iterator itor = zone.portals.begin();
+        FastArray<uint32>::const_iterator end  = zone.portals.end();
+
+        while( itor != end )
+        {
+            Portal &portal = mPortals[*itor];
+            ++itor;
+
+            if( !portal.enabled || portal.inTraversal )
+                continue;
+
+            const uint16 nextZone = portal.zones[0] == zoneId ? portal.zones[1] : portal.zones[0];
+
+            //The portal is outside if all of its corners are behind the same plane
+            bool isOutside = false;
+            FastArray<Plane>::const_iterator itPlane = mPlaneStack.begin();
+            FastArray<Plane>::const_iterator enPlane = mPlaneStack.end();
+            while( itPlane != enPlane && !isOutside )
+            {
+                isOutside = itPlane->getDistance( portal.corners[0] ) < 0 &&
+                            itPlane->getDistance( portal.corners[1] ) < 0 &&
+                            itPlane->getDistance( portal.corners[2] ) < 0 &&
+                            itPlane->getDistance( portal.corners[3] ) < 0;
+                ++itPlane;
+            }
+
+            if( isOutside )
+                continue;
+
+            //Narrow the frustum to the edges of the portal, unless the camera is standing
+            //on it (the planes would degenerate and there's nothing to narrow anyway).
+            const Plane portalPlane( portal.corners[0], portal.corners[1], portal.corners[2] );
+            const bool narrow = Math::Abs( portalPlane.getDistance( eyePos ) ) > nearDist;
+
+            const size_t prevNumPlanes = mPlaneStack.size();
+            if( narrow )
+            {
+                for( size_t i=0; i<4u; ++i )
+                {
+                    Plane edgePlane( eyePos, portal.corners[i], portal.corners[(i + 1u) & 0x03] );
+                    if( edgePlane.getDistance( portal.centre ) < 0 )
+                        edgePlane = -edgePlane;
+                    mPlaneStack.push_back( edgePlane );
+                }
+            }
+
+            portal.inTraversal = true;
+            traverse( nextZone, eyePos, nearDist, depth + 1u );
+            portal.inTraversal = false;
+
+            mPlaneStack.resizePOD( prevNumPlanes );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void PortalZoneManager::_updateVisibleZones( const Camera *camera )
+    {
+        mLastCamera = camera;
+
+        const Vector3 eyePos = camera->getDerivedPosition();
+        mCameraZone = findZone( eyePos );
+        mAllVisible = mCameraZone == NoZone;
+
+        if( mAllVisible )
+            return;
+
+        memset( mVisibleZones.begin(), 0, mVisibleZones.size() );
+
+        const Frustum *frustum = camera->getCullingFrustum() ? camera->getCullingFrustum() : camera;
+        const Plane *frustumPlanes = frustum->getFrustumPlanes();
+
+        mPlaneStack.clear();
+        for( size_t i=0; i<6u; ++i )
+        {
+            //Infinite far plane
+            if( i == FRUSTUM_PLANE_FAR && frustum->getFarClipDistance() == 0 )
+                continue;
+            mPlaneStack.push_back( frustumPlanes[i] );
+        }
+
+        traverse( mCameraZone, eyePos, frustum->getNearClipDistance(), 0 );
+    }
+}
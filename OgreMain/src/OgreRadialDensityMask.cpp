@@ -57,6 +57,7 @@ namespace Ogre
     RadialDensityMask::RadialDensityMask( SceneManager *sceneManager, const float radius[3],
                                           HlmsManager *hlmsManager ) :
         mRectangle( 0 ),
+        mQuality( RdmHigh ),
         mLeftEyeCenter( Vector2::ZERO ),
         mRightEyeCenter( Vector2::ZERO ),
         mDirty( true ),
@@ -207,6 +208,7 @@ namespace Ogre
         for( int32 i = 0; i < 3; ++i )
             mReconstructJob->setProperty( qualityProp[i], i + 1 );
         mReconstructJob->setProperty( "quality", static_cast<int32>( quality ) + 1 );
+        mQuality = static_cast<uint8>( quality );
     }
     //-------------------------------------------------------------------------
     void RadialDensityMask::setEyesCenter( const Vector2 &leftEyeCenter, const Vector2 &rightEyeCenter )
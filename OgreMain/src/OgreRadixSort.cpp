@@ -0,0 +1,172 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+
+#include "OgreStableHeaders.h"
+
+#include "OgreRadixSort.h"
+#include "OgreSceneManager.h"
+
+namespace Ogre
+{
+    RadixSort64::RadixSort64() :
+        mSrc( 0 ),
+        mShift( 0 ),
+        mScatterPass( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void RadixSort64::sort( size_t numThreads, SceneManager *sceneManager )
+    {
+        assert( numThreads > 0u );
+        assert( (!sceneManager || numThreads == sceneManager->getNumWorkerThreads()) &&
+                "numThreads must match the SceneManager's worker threads" );
+
+        const size_t numKeys = mKeys[0].size();
+        if( numKeys < 2u )
+            return;
+
+        //Bytes that are equal in all keys don't need a pass. This is very common
+        //(i.e. SubRqId & transparency bits, few macroblocks, few shaders).
+        const uint64 firstHash = mKeys[0][0].hash;
+        uint64 diffBits = 0;
+        for( size_t i=1; i<numKeys; ++i )
+            diffBits |= mKeys[0][i].hash ^ firstHash;
+
+        mKeys[1].resizePOD( numKeys );
+        mHistograms.resizePOD( numThreads * 256u );
+        mSrc = 0;
+
+        for( uint32 shift=0; shift<64u; shift += 8u )
+        {
+            if( !((diffBits >> shift) & 0xFF) )
+                continue;
+
+            mShift = shift;
+
+            mScatterPass = false;
+            if( sceneManager )
+                sceneManager->executeUserScalableTask( this, true );
+            else
+            {
+                for( size_t i=0; i<numThreads; ++i )
+                    histogram( i, numThreads );
+            }
+
+            //Turn the counters into offsets. Thread N writes its keys
+            //after thread N-1's for the same digit, keeping the sort stable.
+            uint32 offset = 0;
+            for( size_t digit=0; digit<256u; ++digit )
+            {
+                for( size_t i=0; i<numThreads; ++i )
+                {
+                    const uint32 count = mHistograms[i * 256u + digit];
+                    mHistograms[i * 256u + digit] = offset;
+                    offset += count;
+                }
+            }
+
+            mScatterPass = true;
+            if( sceneManager )
+                sceneManager->executeUserScalableTask( this, true );
+            else
+            {
+                for( size_t i=0; i<numThreads; ++i )
+                    scatter( i, numThreads );
+            }
+
+            mSrc = 1u - mSrc;
+        }
+
+        if( mSrc != 0 )
+            mKeys[0].swap( mKeys[1] );
+    }
+    //-----------------------------------------------------------------------------------
+    bool RadixSort64::insertionSort( size_t maxShifts )
+    {
+        KeyArray &keys = mKeys[0];
+        const size_t numKeys = keys.size();
+
+        size_t numShifts = 0;
+        for( size_t i=1; i<numKeys; ++i )
+        {
+            const Key key = keys[i];
+            size_t j = i;
+            while( j > 0 && key.hash < keys[j-1].hash )
+            {
+                keys[j] = keys[j-1];
+                --j;
+            }
+            keys[j] = key;
+
+            numShifts += i - j;
+            if( numShifts > maxShifts )
+                return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void RadixSort64::histogram( size_t threadIdx, size_t numThreads )
+    {
+        const KeyArray &src = mKeys[mSrc];
+        const size_t numKeys = src.size();
+        const size_t start  = (numKeys * threadIdx) / numThreads;
+        const size_t end    = (numKeys * (threadIdx + 1u)) / numThreads;
+        const uint32 shift  = mShift;
+
+        uint32 * RESTRICT_ALIAS counters = mHistograms.begin() + threadIdx * 256u;
+        memset( counters, 0, 256u * sizeof(uint32) );
+
+        for( size_t i=start; i<end; ++i )
+            ++counters[(src[i].hash >> shift) & 0xFF];
+    }
+    //-----------------------------------------------------------------------------------
+    void RadixSort64::scatter( size_t threadIdx, size_t numThreads )
+    {
+        const KeyArray &src = mKeys[mSrc];
+        KeyArray &dst = mKeys[1u - mSrc];
+        const size_t numKeys = src.size();
+        const size_t start  = (numKeys * threadIdx) / numThreads;
+        const size_t end    = (numKeys * (threadIdx + 1u)) / numThreads;
+        const uint32 shift  = mShift;
+
+        uint32 * RESTRICT_ALIAS offsets = mHistograms.begin() + threadIdx * 256u;
+
+        for( size_t i=start; i<end; ++i )
+            dst[offsets[(src[i].hash >> shift) & 0xFF]++] = src[i];
+    }
+    //-----------------------------------------------------------------------------------
+    void RadixSort64::execute( size_t threadId, size_t numThreads )
+    {
+        if( !mScatterPass )
+            histogram( threadId, numThreads );
+        else
+            scatter( threadId, numThreads );
+    }
+}
@@ -44,7 +44,8 @@ namespace v1
             mPosition( Vector3::ZERO ),
             mOrientation( Quaternion::IDENTITY ),
             mScale( Vector3::UNIT_SCALE ),
-            mQuad( bQuad )
+            mQuad( bQuad ),
+            mUvScale( Vector2::UNIT_SCALE )
     {
         initRectangle2D();
 
@@ -80,11 +81,47 @@ namespace v1
         HardwareVertexBufferSharedPtr vbuf = 
             HardwareBufferManager::getSingleton().createVertexBuffer(
             decl->getVertexSize( 0 ), mRenderOp.vertexData->vertexCount,
-            HardwareBuffer::HBU_STATIC_WRITE_ONLY );
+            HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
 
         // Bind buffer
         bind->setBinding( 0, vbuf );
 
+        fillPositionsAndUvs();
+
+        //Add the normals.
+        decl->addElement( 1, 0, VET_FLOAT3, VES_NORMAL );
+
+        vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+                decl->getVertexSize( 1 ), mRenderOp.vertexData->vertexCount,
+                HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
+
+        bind->setBinding( 1, vbuf );
+
+        HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
+        float *pNorm = static_cast<float*>(vbufLock.pData);
+        *pNorm++ = 0.0f;
+        *pNorm++ = 0.0f;
+        *pNorm++ = 1.0f;
+
+        *pNorm++ = 0.0f;
+        *pNorm++ = 0.0f;
+        *pNorm++ = 1.0f;
+
+        *pNorm++ = 0.0f;
+        *pNorm++ = 0.0f;
+        *pNorm++ = 1.0f;
+
+        if( mQuad )
+        {
+            *pNorm++ = 0.0f;
+            *pNorm++ = 0.0f;
+            *pNorm++ = 1.0f;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void Rectangle2D::fillPositionsAndUvs(void)
+    {
+        HardwareVertexBufferSharedPtr vbuf = mRenderOp.vertexData->vertexBufferBinding->getBuffer( 0 );
         HardwareBufferLockGuard vbufLock(vbuf, HardwareBuffer::HBL_DISCARD);
         float *pVerts = static_cast<float*>(vbufLock.pData);
         if( mQuad )
@@ -103,14 +140,14 @@ namespace v1
             *pVerts++ = -1.0f;
 
             *pVerts++ =  0.0f;
-            *pVerts++ =  1.0f;
+            *pVerts++ =  mUvScale.y;
 
             //3rd Top-right
             *pVerts++ =  1.0f;
             *pVerts++ =  1.0f;
             *pVerts++ = -1.0f;
 
-            *pVerts++ =  1.0f;
+            *pVerts++ =  mUvScale.x;
             *pVerts++ =  0.0f;
 
             //4th Bottom-right
@@ -118,8 +155,8 @@ namespace v1
             *pVerts++ = -1.0f;
             *pVerts++ = -1.0f;
 
-            *pVerts++ =  1.0f;
-            *pVerts++ =  1.0f;
+            *pVerts++ =  mUvScale.x;
+            *pVerts++ =  mUvScale.y;
         }
         else
         {
@@ -137,48 +174,18 @@ namespace v1
             *pVerts++ = -1.0f;
 
             *pVerts++ =  0.0f;
-            *pVerts++ =  2.0f;
+            *pVerts++ =  2.0f * mUvScale.y;
 
             //3rd Top-right
             *pVerts++ =  3.0f;
             *pVerts++ =  1.0f;
             *pVerts++ = -1.0f;
 
-            *pVerts++ =  2.0f;
+            *pVerts++ =  2.0f * mUvScale.x;
             *pVerts++ =  0.0f;
         }
 
         vbufLock.unlock();
-
-        //Add the normals.
-        decl->addElement( 1, 0, VET_FLOAT3, VES_NORMAL );
-
-        vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
-                decl->getVertexSize( 1 ), mRenderOp.vertexData->vertexCount,
-                HardwareBuffer::HBU_DYNAMIC_WRITE_ONLY_DISCARDABLE );
-
-        bind->setBinding( 1, vbuf );
-
-        vbufLock.lock(vbuf, HardwareBuffer::HBL_DISCARD);
-        float *pNorm = static_cast<float*>(vbufLock.pData);
-        *pNorm++ = 0.0f;
-        *pNorm++ = 0.0f;
-        *pNorm++ = 1.0f;
-
-        *pNorm++ = 0.0f;
-        *pNorm++ = 0.0f;
-        *pNorm++ = 1.0f;
-
-        *pNorm++ = 0.0f;
-        *pNorm++ = 0.0f;
-        *pNorm++ = 1.0f;
-
-        if( mQuad )
-        {
-            *pNorm++ = 0.0f;
-            *pNorm++ = 0.0f;
-            *pNorm++ = 1.0f;
-        }
     }
     //-----------------------------------------------------------------------------------
     Rectangle2D::~Rectangle2D()
@@ -192,6 +199,15 @@ namespace v1
         mScale      = Vector3( width, height, 0.0f );
     }
     //-----------------------------------------------------------------------------------
+    void Rectangle2D::setUvScale( const Vector2 &uvScale )
+    {
+        if( mUvScale != uvScale )
+        {
+            mUvScale = uvScale;
+            fillPositionsAndUvs();
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void Rectangle2D::setNormals( const Ogre::Vector3 &topLeft, const Ogre::Vector3 &bottomLeft,
                                     const Ogre::Vector3 &topRight, const Ogre::Vector3 &bottomRight)
     {
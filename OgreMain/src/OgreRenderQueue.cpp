@@ -41,6 +41,12 @@ THE SOFTWARE.
 #include "OgreHlmsManager.h"
 #include "OgreHlms.h"
 #include "OgreRoot.h"
+#include "OgreFrameMetrics.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorFrameCapture.h"
+#include "OgreCamera.h"
+#include "OgreViewport.h"
+#include "OgreTextureGpuManager.h"
 
 #include "Vao/OgreVaoManager.h"
 #include "Vao/OgreVertexArrayObject.h"
@@ -54,6 +60,8 @@ THE SOFTWARE.
 
 #include "OgreProfiler.h"
 
+#include "Threading/OgreWorkStealingScheduler.h"
+
 
 namespace Ogre
 {
@@ -95,9 +103,16 @@ namespace Ogre
         mLastIndexData( 0 ),
         mLastTextureHash( 0 ),
         mCommandBuffer( 0 ),
-        mRenderingStarted( 0u )
+        mRenderingStarted( 0u ),
+        mParallelCommandPreparation( false ),
+        mPreparingCasterPass( false ),
+        mPreparedDrawScheduler( 0 ),
+        mParallelTask( ParallelTaskPrepareDraws ),
+        mOccludersSwapped( false ),
+        mEstimatedOverdraw( 0 )
     {
         mCommandBuffer = new CommandBuffer();
+        mPreparedDrawScheduler = new WorkStealingScheduler( sceneManager->getNumWorkerThreads() );
 
         for( size_t i=0; i<256; ++i )
             mRenderQueues[i].mQueuedRenderablesPerThread.resize( sceneManager->getNumWorkerThreads() );
@@ -114,6 +129,7 @@ namespace Ogre
     RenderQueue::~RenderQueue()
     {
         delete mCommandBuffer;
+        delete mPreparedDrawScheduler;
 
         assert( mUsedIndirectBuffers.empty() );
 
@@ -269,9 +285,10 @@ namespace Ogre
         #define OGRE_RQ_HASH( x, bits, shift ) ( uint64( (x) & OGRE_RQ_MAKE_MASK( (bits) ) ) << (shift) )
 
         uint64 hash;
-        if( !transparent )
+        if( !transparent || mRenderQueues[rqId].mOrderIndependentTransparency )
         {
             //Opaque objects are first sorted by material, then by mesh, then by depth front to back.
+            //Same for transparent ones when their blending doesn't depend on the order.
             hash =
             OGRE_RQ_HASH( subId,            RqBits::SubRqIdBits,        RqBits::SubRqIdShift )      |
             OGRE_RQ_HASH( transparent,      RqBits::TransparencyBits,   RqBits::TransparencyShift ) |
@@ -318,6 +335,153 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------
+    void RenderQueue::notifyProjectedSizes( uint8 firstRq, uint8 lastRq )
+    {
+        OgreProfileExhaustive( "RenderQueue::notifyProjectedSizes" );
+
+        const Camera *camera = mSceneManager->getCamerasInProgress().renderingCamera;
+        const Viewport *viewport = mSceneManager->getCurrentViewport0();
+
+        if( !camera || !viewport )
+            return;
+
+        const bool isOrtho = camera->getProjectionType() == PT_ORTHOGRAPHIC;
+        //Diameter in pixels = 2 * radius * (viewportHeight / 2) * proj[1][1] / distance
+        const Real scale = camera->getProjectionMatrix()[1][1] *
+                           static_cast<Real>( viewport->getActualHeight() );
+        const Vector3 &cameraPos = camera->getDerivedPosition();
+        const Real nearClip = camera->getNearClipDistance();
+
+        for( size_t i=firstRq; i<lastRq; ++i )
+        {
+            QueuedRenderableArray::const_iterator itor = mRenderQueues[i].mQueuedRenderables.begin();
+            QueuedRenderableArray::const_iterator end  = mRenderQueues[i].mQueuedRenderables.end();
+
+            while( itor != end )
+            {
+                const MovableObject *movableObject = itor->movableObject;
+                const Real radius = movableObject->getWorldRadius();
+
+                Real distance = 1.0f;
+                if( !isOrtho )
+                {
+                    distance = cameraPos.distance( movableObject->getWorldAabb().mCenter ) - radius;
+                    distance = std::max( distance, nearClip );
+                }
+
+                const Real pixels = radius * scale / distance;
+                itor->renderable->getDatablock()->_notifyProjectedSize(
+                            static_cast<uint32>( std::min<Real>( pixels, 65536.0f ) ) );
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::setOccluderSelection( const OccluderSelection &selection )
+    {
+        mOccluderSelection = selection;
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::selectOccluders( uint8 firstRq, uint8 lastRq )
+    {
+        OgreProfileExhaustive( "RenderQueue::selectOccluders" );
+
+        const Camera *camera = mSceneManager->getCamerasInProgress().renderingCamera;
+        const Viewport *viewport = mSceneManager->getCurrentViewport0();
+
+        if( !camera || !viewport )
+            return;
+
+        const bool occludersOnly = mOccluderSelection.mOccludersOnly;
+        const bool estimateOverdraw = mOccluderSelection.mEstimateOverdraw;
+
+        //Same as notifyProjectedSizes
+        const bool isOrtho = camera->getProjectionType() == PT_ORTHOGRAPHIC;
+        const Real vpWidth  = static_cast<Real>( viewport->getActualWidth() );
+        const Real vpHeight = static_cast<Real>( viewport->getActualHeight() );
+        const Real scale = camera->getProjectionMatrix()[1][1] * vpHeight;
+        const Vector3 &cameraPos = camera->getDerivedPosition();
+        const Real nearClip = camera->getNearClipDistance();
+
+        const Real minPixels = mOccluderSelection.mMinScreenSize * vpHeight;
+        const uint32 maxVertices = mOccluderSelection.mMaxVertices;
+        const Real areaScale = Math::PI * 0.25f / std::max( vpWidth * vpHeight, Real( 1.0f ) );
+
+        Real overdraw = 0;
+
+        for( size_t i=firstRq; i<lastRq; ++i )
+        {
+            RenderQueueGroup &renderQueueGroup = mRenderQueues[i];
+            QueuedRenderableArray &occluders = renderQueueGroup.mOccluders;
+            occluders.clear();
+
+            const bool isV2 = renderQueueGroup.mMode == FAST;
+
+            const QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
+            QueuedRenderableArray::const_iterator itor = queuedRenderables.begin();
+            QueuedRenderableArray::const_iterator end  = queuedRenderables.end();
+
+            while( itor != end )
+            {
+                const HlmsDatablock *datablock = itor->renderable->getDatablock();
+                const HlmsMacroblock *macroblock = datablock->getMacroblock( false );
+
+                if( !datablock->getBlendblock( false )->mIsTransparent &&
+                    macroblock->mDepthCheck && macroblock->mDepthWrite )
+                {
+                    const MovableObject *movableObject = itor->movableObject;
+                    const Real radius = movableObject->getWorldRadius();
+
+                    Real distance = 1.0f;
+                    if( !isOrtho )
+                    {
+                        distance = cameraPos.distance( movableObject->getWorldAabb().mCenter ) -
+                                   radius;
+                        distance = std::max( distance, nearClip );
+                    }
+
+                    //Diameter in pixels
+                    const Real pixels = radius * scale / distance;
+
+                    if( estimateOverdraw )
+                        overdraw += std::min( pixels * pixels * areaScale, Real( 1.0f ) );
+
+                    if( occludersOnly && isV2 && pixels >= minPixels &&
+                        datablock->getAlphaTest() == CMPF_ALWAYS_PASS )
+                    {
+                        const VertexArrayObjectArray &vaos = itor->renderable->getVaos( VpNormal );
+                        const uint8 meshLod = movableObject->getCurrentMeshLod();
+                        if( meshLod < vaos.size() &&
+                            vaos[meshLod]->getBaseVertexBuffer()->getNumElements() <= maxVertices )
+                        {
+                            occluders.push_back( *itor );
+                        }
+                    }
+                }
+
+                ++itor;
+            }
+
+            if( occludersOnly )
+                renderQueueGroup.mQueuedRenderables.swap( occluders );
+        }
+
+        mOccludersSwapped = occludersOnly;
+        if( estimateOverdraw )
+            mEstimatedOverdraw = overdraw;
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::restoreOccluders( uint8 firstRq, uint8 lastRq )
+    {
+        if( !mOccludersSwapped )
+            return;
+
+        for( size_t i=firstRq; i<lastRq; ++i )
+            mRenderQueues[i].mQueuedRenderables.swap( mRenderQueues[i].mOccluders );
+
+        mOccludersSwapped = false;
+    }
+    //-----------------------------------------------------------------------
     void RenderQueue::render( RenderSystem *rs, uint8 firstRq, uint8 lastRq,
                               bool casterPass, bool dualParaboloid )
     {
@@ -351,11 +515,16 @@ namespace Ogre
 
         mCommandBuffer->setCurrentRenderSystem( rs );
 
+        CompositorFrameCapture *frameCapture = mRoot->getCompositorManager2()->getFrameCapture();
+        if( !frameCapture->isCapturing() )
+            frameCapture = 0;
+
         bool supportsIndirectBuffers = mVaoManager->supportsIndirectBuffers();
 
         IndirectBufferPacked *indirectBuffer = 0;
         unsigned char *indirectDraw = 0;
         unsigned char *startIndirectDraw = 0;
+        unsigned char *mappedIndirectDraw = 0;
 
         if( numNeededDraws > 0 )
         {
@@ -363,8 +532,15 @@ namespace Ogre
 
             if( supportsIndirectBuffers )
             {
-                indirectDraw = static_cast<unsigned char*>(
+                mappedIndirectDraw = static_cast<unsigned char*>(
                             indirectBuffer->map( 0, indirectBuffer->getNumElements() ) );
+                indirectDraw = mappedIndirectDraw;
+
+                if( frameCapture )
+                {
+                    mCapturedIndirectDraws.resizePOD( indirectBuffer->getNumElements() );
+                    indirectDraw = mCapturedIndirectDraws.begin();
+                }
             }
             else
             {
@@ -374,56 +550,42 @@ namespace Ogre
             startIndirectDraw = indirectDraw;
         }
 
+        const uint64 sortStartTime = mSceneManager->_getCpuTime();
         for( size_t i=firstRq; i<lastRq; ++i )
+            sortRenderQueueGroup( mRenderQueues[i], casterPass );
+        mSceneManager->_getCpuTimings().renderQueueSort +=
+                mSceneManager->_getCpuTime() - sortStartTime;
+
+        if( !casterPass &&
+            (mOccluderSelection.mOccludersOnly || mOccluderSelection.mEstimateOverdraw) )
         {
-            QueuedRenderableArray &queuedRenderables = mRenderQueues[i].mQueuedRenderables;
-            QueuedRenderableArrayPerThread &perThreadQueue = mRenderQueues[i].mQueuedRenderablesPerThread;
+            selectOccluders( firstRq, lastRq );
+        }
 
-            if( !mRenderQueues[i].mSorted )
+        if( frameCapture )
+        {
+            for( size_t i=firstRq; i<lastRq; ++i )
             {
-                OgreProfileGroupAggregate( "Sorting", OGREPROF_RENDERING );
-
-                size_t numRenderables = 0;
-                QueuedRenderableArrayPerThread::const_iterator itor = perThreadQueue.begin();
-                QueuedRenderableArrayPerThread::const_iterator end  = perThreadQueue.end();
-
-                while( itor != end )
-                {
-                    numRenderables += itor->q.size();
-                    ++itor;
-                }
-
-                queuedRenderables.reserve( numRenderables );
+                const QueuedRenderableArray &queuedRenderables = mRenderQueues[i].mQueuedRenderables;
+                frameCapture->_addRenderQueueEntries( static_cast<uint8>( i ),
+                                                      queuedRenderables.begin(),
+                                                      queuedRenderables.end(), casterPass );
+            }
+        }
 
-                itor = perThreadQueue.begin();
-                while( itor != end )
-                {
-                    queuedRenderables.appendPOD( itor->q.begin(), itor->q.end() );
-                    ++itor;
-                }
+        if( !casterPass && rs->getTextureGpuManager()->_isTrackingTextureUsage() )
+            notifyProjectedSizes( firstRq, lastRq );
 
-                //TODO: Exploit temporal coherence across frames then use insertion sorts.
-                //As explained by L. Spiro in
-                //http://www.gamedev.net/topic/661114-temporal-coherence-and-render-queue-sorting/?view=findpost&p=5181408
-                //Keep a list of sorted indices from the previous frame (one per camera).
-                //If we have the sorted list "5, 1, 4, 3, 2, 0":
-                //  * If it grew from last frame, append: 5, 1, 4, 3, 2, 0, 6, 7 and use insertion sort.
-                //  * If it's the same, leave it as is, and use insertion sort just in case.
-                //  * If it's shorter, reset the indices 0, 1, 2, 3, 4; probably use quicksort or other generic sort
-                //
-                //TODO2: Explore sorting first on multiple threads, then merge sort into one.
-                if( mRenderQueues[i].mSortMode == NormalSort )
-                {
-                    std::sort( queuedRenderables.begin(), queuedRenderables.end() );
-                    mRenderQueues[i].mSorted = true;
-                }
-                else if( mRenderQueues[i].mSortMode == StableSort )
-                {
-                    std::stable_sort( queuedRenderables.begin(), queuedRenderables.end() );
-                    mRenderQueues[i].mSorted = true;
-                }
-            }
+        const PreparedDraw *preparedDraws = 0;
+        if( mParallelCommandPreparation && numNeededDraws > 0 &&
+            mSceneManager->getNumWorkerThreads() > 1u )
+        {
+            prepareDrawsParallel( firstRq, lastRq, casterPass );
+            preparedDraws = mPreparedDraws.begin();
+        }
 
+        for( size_t i=firstRq; i<lastRq; ++i )
+        {
             if( mRenderQueues[i].mMode == V1_LEGACY )
             {
                 if( mLastVaoName )
@@ -446,10 +608,23 @@ namespace Ogre
             else if( numNeededDraws > 0 /*&& mRenderQueues[i].mMode == FAST*/ )
             {
                 indirectDraw = renderGL3( rs, casterPass, dualParaboloid, mPassCache, mRenderQueues[i],
-                                          indirectBuffer, indirectDraw, startIndirectDraw );
+                                          indirectBuffer, indirectDraw, startIndirectDraw,
+                                          preparedDraws );
+                if( preparedDraws )
+                    preparedDraws += mRenderQueues[i].mQueuedRenderables.size();
             }
         }
 
+        restoreOccluders( firstRq, lastRq );
+
+        if( frameCapture && indirectBuffer )
+        {
+            const size_t indirectBytes = static_cast<size_t>( indirectDraw - startIndirectDraw );
+            frameCapture->_addIndirectData( indirectBuffer, startIndirectDraw, indirectBytes );
+            if( mappedIndirectDraw && mappedIndirectDraw != startIndirectDraw )
+                memcpy( mappedIndirectDraw, startIndirectDraw, indirectBytes );
+        }
+
         if( supportsIndirectBuffers && indirectBuffer )
             indirectBuffer->unmap( UO_KEEP_PERSISTENT );
 
@@ -465,6 +640,16 @@ namespace Ogre
                 hlms->preCommandBufferExecution( mCommandBuffer );
         }
 
+        if( frameCapture )
+            frameCapture->_addCommands( mCommandBuffer );
+
+        if( mCommandBuffer->_prepareParallelRemoveRedundantCommands(
+                mSceneManager->getNumWorkerThreads() ) )
+        {
+            mParallelTask = ParallelTaskRemoveRedundantCommands;
+            mSceneManager->executeUserScalableTask( this, true );
+        }
+
         mCommandBuffer->execute();
 
         for( size_t i=0; i<HLMS_MAX; ++i )
@@ -480,6 +665,275 @@ namespace Ogre
         OgreProfileEndGroup( "Command Execution", OGREPROF_RENDERING );
     }
     //-----------------------------------------------------------------------
+    void RenderQueue::sortRenderQueueGroup( RenderQueueGroup &renderQueueGroup, bool casterPass )
+    {
+        if( renderQueueGroup.mSorted )
+            return;
+
+        OgreProfileGroupAggregate( "Sorting", OGREPROF_RENDERING );
+
+        QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
+        QueuedRenderableArrayPerThread &perThreadQueue = renderQueueGroup.mQueuedRenderablesPerThread;
+
+        size_t numRenderables = 0;
+        QueuedRenderableArrayPerThread::const_iterator itor = perThreadQueue.begin();
+        QueuedRenderableArrayPerThread::const_iterator end  = perThreadQueue.end();
+
+        while( itor != end )
+        {
+            numRenderables += itor->q.size();
+            ++itor;
+        }
+
+        queuedRenderables.reserve( numRenderables );
+
+        itor = perThreadQueue.begin();
+        while( itor != end )
+        {
+            queuedRenderables.appendPOD( itor->q.begin(), itor->q.end() );
+            ++itor;
+        }
+
+        if( renderQueueGroup.mSortMode == NormalSort )
+        {
+            std::sort( queuedRenderables.begin(), queuedRenderables.end() );
+        }
+        else if( renderQueueGroup.mSortMode == StableSort )
+        {
+            std::stable_sort( queuedRenderables.begin(), queuedRenderables.end() );
+        }
+        else if( renderQueueGroup.mSortMode == RadixSort ||
+                 renderQueueGroup.mSortMode == TemporalCoherenceSort )
+        {
+            const size_t numQueued = queuedRenderables.size();
+            FastArray<uint32> &lastSortOrder = renderQueueGroup.mLastSortOrder;
+            RadixSort64::KeyArray &sortKeys = mKeySort.getKeys();
+            sortKeys.resizePOD( numQueued );
+
+            bool sorted = false;
+
+            if( renderQueueGroup.mSortMode == TemporalCoherenceSort &&
+                lastSortOrder.size() == numQueued )
+            {
+                //Based on the idea explained by L. Spiro in
+                //http://www.gamedev.net/topic/661114-temporal-coherence-and-render-queue-sorting/?view=findpost&p=5181408
+                //If the scene didn't change much, last frame's order is almost sorted.
+                for( size_t i=0; i<numQueued; ++i )
+                {
+                    sortKeys[i].hash = queuedRenderables[lastSortOrder[i]].hash;
+                    sortKeys[i].idx  = lastSortOrder[i];
+                }
+                sorted = mKeySort.insertionSort( numQueued );
+            }
+            else
+            {
+                for( size_t i=0; i<numQueued; ++i )
+                {
+                    sortKeys[i].hash = queuedRenderables[i].hash;
+                    sortKeys[i].idx  = static_cast<uint32>( i );
+                }
+            }
+
+            if( !sorted )
+            {
+                //Below this amount, waking up the worker threads costs more than it saves
+                const size_t c_minKeysForParallelSort = 8192u;
+                const size_t numThreads = mSceneManager->getNumWorkerThreads();
+                if( numQueued >= c_minKeysForParallelSort && numThreads > 1u )
+                    mKeySort.sort( numThreads, mSceneManager );
+                else
+                    mKeySort.sort( 1u, 0 );
+            }
+
+            if( renderQueueGroup.mSortMode == TemporalCoherenceSort )
+            {
+                lastSortOrder.resizePOD( numQueued );
+                for( size_t i=0; i<numQueued; ++i )
+                    lastSortOrder[i] = sortKeys[i].idx;
+            }
+
+            mTmpQueuedRenderables.resizePOD( numQueued );
+            for( size_t i=0; i<numQueued; ++i )
+                mTmpQueuedRenderables[i] = queuedRenderables[sortKeys[i].idx];
+            queuedRenderables.swap( mTmpQueuedRenderables );
+        }
+
+        if( renderQueueGroup.mInstancingGrouping && renderQueueGroup.mMode == FAST &&
+            renderQueueGroup.mSortMode != DisableSort )
+        {
+            groupForInstancing( renderQueueGroup, casterPass );
+        }
+
+        //Even if unsorted, the per-thread queues have been merged. Merging them
+        //again on a second render would duplicate the renderables.
+        renderQueueGroup.mSorted = true;
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::groupForInstancing( RenderQueueGroup &renderQueueGroup, bool casterPass )
+    {
+        OgreProfileGroupAggregate( "Instancing grouping", OGREPROF_RENDERING );
+
+        QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
+        const size_t numQueued = queuedRenderables.size();
+
+        const uint64 transparentMask = uint64( OGRE_RQ_MAKE_MASK( RqBits::TransparencyBits ) ) <<
+                                       RqBits::TransparencyShift;
+        //Opaque keys have the depth in the lowest bits. Entries whose keys only
+        //differ in those bits can be freely reordered.
+        const int runShift = RqBits::DepthShift + RqBits::DepthBits;
+
+        size_t runStart = 0;
+        while( runStart < numQueued )
+        {
+            const uint64 runKey = queuedRenderables[runStart].hash >> runShift;
+            size_t runEnd = runStart + 1u;
+            while( runEnd < numQueued && (queuedRenderables[runEnd].hash >> runShift) == runKey )
+                ++runEnd;
+
+            if( !(queuedRenderables[runStart].hash & transparentMask) ||
+                renderQueueGroup.mOrderIndependentTransparency )
+            {
+                const size_t runSize = runEnd - runStart;
+                mInstancingKeys.resizePOD( runSize );
+
+                for( size_t i=0; i<runSize; ++i )
+                {
+                    const QueuedRenderable &queuedRenderable = queuedRenderables[runStart + i];
+                    const VertexArrayObjectArray &vaos = queuedRenderable.renderable->getVaos(
+                                static_cast<VertexPass>( casterPass ) );
+
+                    InstancingKey &key = mInstancingKeys[i];
+                    key.vao         = vaos[queuedRenderable.movableObject->getCurrentMeshLod()];
+                    key.datablock   = queuedRenderable.renderable->getDatablock();
+                    key.hlmsHash    = casterPass ? queuedRenderable.renderable->getHlmsCasterHash() :
+                                                   queuedRenderable.renderable->getHlmsHash();
+                    key.idx         = static_cast<uint32>( i );
+
+                    if( i == 0 || key.vao != mInstancingKeys[i - 1u].vao )
+                        ++mInstancingStats.mNumDrawsBeforeGrouping;
+                }
+
+                if( runSize > 2u )
+                {
+                    //Find the groups, then sort them by their first (closest) entry
+                    std::sort( mInstancingKeys.begin(), mInstancingKeys.end(),
+                               InstancingKey::OrderByKey );
+                    for( size_t i=0; i<runSize; ++i )
+                    {
+                        InstancingKey &key = mInstancingKeys[i];
+                        if( i == 0 )
+                            key.firstIdx = key.idx;
+                        else
+                        {
+                            const InstancingKey &prevKey = mInstancingKeys[i - 1u];
+                            const bool sameGroup = key.vao == prevKey.vao &&
+                                                   key.datablock == prevKey.datablock &&
+                                                   key.hlmsHash == prevKey.hlmsHash;
+                            key.firstIdx = sameGroup ? prevKey.firstIdx : key.idx;
+                        }
+                    }
+                    std::sort( mInstancingKeys.begin(), mInstancingKeys.end(),
+                               InstancingKey::OrderByGroup );
+
+                    mTmpQueuedRenderables.resizePOD( runSize );
+                    for( size_t i=0; i<runSize; ++i )
+                        mTmpQueuedRenderables[i] = queuedRenderables[runStart + mInstancingKeys[i].idx];
+                    std::copy( mTmpQueuedRenderables.begin(), mTmpQueuedRenderables.end(),
+                               queuedRenderables.begin() + runStart );
+                }
+
+                for( size_t i=0; i<runSize; ++i )
+                {
+                    if( i == 0 || mInstancingKeys[i].vao != mInstancingKeys[i - 1u].vao )
+                        ++mInstancingStats.mNumDrawsAfterGrouping;
+                }
+
+                mInstancingStats.mNumRenderables += runSize;
+            }
+
+            runStart = runEnd;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::prepareDrawsParallel( uint8 firstRq, uint8 lastRq, bool casterPass )
+    {
+        OgreProfileGroupAggregate( "Parallel Draw Preparation", OGREPROF_RENDERING );
+
+        const size_t numObjsPerChunk = mSceneManager->getNumObjsPerChunk();
+
+        mPreparedDrawSegments.clear();
+
+        size_t numDraws = 0;
+        size_t numChunks = 0;
+        for( size_t i=firstRq; i<lastRq; ++i )
+        {
+            const size_t numRenderables = mRenderQueues[i].mQueuedRenderables.size();
+            if( mRenderQueues[i].mMode == FAST && numRenderables > 0 )
+            {
+                PreparedDrawSegment segment;
+                segment.renderQueueId   = i;
+                segment.firstChunk      = numChunks;
+                segment.firstDraw       = numDraws;
+                mPreparedDrawSegments.push_back( segment );
+
+                numDraws += numRenderables;
+                numChunks += (numRenderables + numObjsPerChunk - 1u) / numObjsPerChunk;
+            }
+        }
+
+        mPreparedDraws.resizePOD( numDraws );
+        mPreparingCasterPass = casterPass;
+
+        mPreparedDrawScheduler->reset( numChunks );
+        mParallelTask = ParallelTaskPrepareDraws;
+        mSceneManager->executeUserScalableTask( this, true );
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::execute( size_t threadId, size_t numThreads )
+    {
+        if( mParallelTask == ParallelTaskRemoveRedundantCommands )
+        {
+            mCommandBuffer->_removeRedundantCommands( threadId, numThreads );
+            return;
+        }
+
+        const size_t numObjsPerChunk = mSceneManager->getNumObjsPerChunk();
+        const VertexPass vertexPass = static_cast<VertexPass>( mPreparingCasterPass );
+
+        size_t chunkIdx;
+        while( mPreparedDrawScheduler->grabChunk( threadId, chunkIdx ) )
+        {
+            PreparedDrawSegmentArray::const_iterator itSegment =
+                    std::upper_bound( mPreparedDrawSegments.begin(), mPreparedDrawSegments.end(),
+                                      chunkIdx, PreparedDrawSegment::OrderByFirstChunk ) - 1u;
+
+            const QueuedRenderableArray &queuedRenderables =
+                    mRenderQueues[itSegment->renderQueueId].mQueuedRenderables;
+
+            const size_t startIdx   = (chunkIdx - itSegment->firstChunk) * numObjsPerChunk;
+            const size_t endIdx     = std::min( startIdx + numObjsPerChunk, queuedRenderables.size() );
+
+            PreparedDraw *preparedDraw = mPreparedDraws.begin() + itSegment->firstDraw + startIdx;
+
+            for( size_t i=startIdx; i<endIdx; ++i )
+            {
+                const QueuedRenderable &queuedRenderable = queuedRenderables[i];
+                const uint8 meshLod = queuedRenderable.movableObject->getCurrentMeshLod();
+                const VertexArrayObjectArray &vaos = queuedRenderable.renderable->getVaos( vertexPass );
+                const HlmsDatablock *datablock = queuedRenderable.renderable->getDatablock();
+
+                Hlms *hlms = mHlmsManager->getHlms( static_cast<HlmsTypes>( datablock->mType ) );
+
+                preparedDraw->vao       = vaos[meshLod];
+                preparedDraw->hlms      = hlms;
+                preparedDraw->hlmsCache = hlms->getExistingMaterial( mPassCache[hlms->getType()],
+                                                                     queuedRenderable,
+                                                                     mPreparingCasterPass );
+                ++preparedDraw;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     void RenderQueue::renderES2( RenderSystem *rs, bool casterPass, bool dualParaboloid,
                                  HlmsCache passCache[HLMS_MAX],
                                  const RenderQueueGroup &renderQueueGroup )
@@ -490,6 +944,9 @@ namespace Ogre
         uint32 lastHlmsCacheHash = 0;
         uint32 lastTextureHash = mLastTextureHash;
         //uint32 lastVertexDataId = ~0;
+        uint64 numDraws = 0;
+        uint64 numInstances = 0;
+        uint64 numPsoSwitches = 0;
 
         const QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
 
@@ -520,11 +977,19 @@ namespace Ogre
             lastHlmsCacheHash = lastHlmsCache->hash;
             const HlmsCache *hlmsCache = hlms->getMaterial( lastHlmsCache,
                                                             passCache[datablock->mType],
-                                                            queuedRenderable, casterPass );
+                                                            queuedRenderable, casterPass, true );
+            if( !hlmsCache )
+            {
+                //Shader generation deferred to a later frame. Skip it.
+                ++itor;
+                continue;
+            }
+
             if( lastHlmsCacheHash != hlmsCache->hash )
             {
                 rs->_setPipelineStateObject( &hlmsCache->pso );
                 lastHlmsCache = hlmsCache;
+                ++numPsoSwitches;
             }
 
             lastTextureHash = hlms->fillBuffersFor( hlmsCache, queuedRenderable, casterPass,
@@ -534,10 +999,17 @@ namespace Ogre
             rs->_setRenderOperation( &cmd );
 
             rs->_render( op );
+            ++numDraws;
+            numInstances += op.numberOfInstances;
 
             ++itor;
         }
 
+        FrameMetrics *frameMetrics = mRoot->getFrameMetrics();
+        frameMetrics->add( FrameMetric::DrawCalls, numDraws );
+        frameMetrics->add( FrameMetric::Instances, numInstances );
+        frameMetrics->add( FrameMetric::PsoSwitches, numPsoSwitches );
+
         mLastVertexData     = lastVertexData;
         mLastIndexData      = lastIndexData;
         mLastTextureHash    = lastTextureHash;
@@ -548,7 +1020,8 @@ namespace Ogre
                                            const RenderQueueGroup &renderQueueGroup,
                                            IndirectBufferPacked *indirectBuffer,
                                            unsigned char *indirectDraw,
-                                           unsigned char *startIndirectDraw )
+                                           unsigned char *startIndirectDraw,
+                                           const PreparedDraw *preparedDraws )
     {
         VertexArrayObject *lastVao = 0;
         uint32 lastVaoName = mLastVaoName;
@@ -570,6 +1043,7 @@ namespace Ogre
         CbSharedDraw *drawCountPtr = 0;
 
         RenderSystem::Metrics stats;
+        uint64 numPsoSwitches = 0;
 
         const QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
 
@@ -579,25 +1053,50 @@ namespace Ogre
         while( itor != end )
         {
             const QueuedRenderable &queuedRenderable = *itor;
-            uint8 meshLod = queuedRenderable.movableObject->getCurrentMeshLod();
-            const VertexArrayObjectArray &vaos = queuedRenderable.renderable->getVaos(
-                        static_cast<VertexPass>(casterPass) );
 
-            VertexArrayObject *vao = vaos[meshLod];
-            const HlmsDatablock *datablock = queuedRenderable.renderable->getDatablock();
+            VertexArrayObject *vao;
+            Hlms *hlms;
+            HlmsCache const *cachedHlmsCache = lastHlmsCache;
 
-            Hlms *hlms = mHlmsManager->getHlms( static_cast<HlmsTypes>( datablock->mType ) );
+            if( preparedDraws )
+            {
+                vao  = preparedDraws->vao;
+                hlms = preparedDraws->hlms;
+                //When found, getMaterial only needs to update its usage stats
+                if( preparedDraws->hlmsCache )
+                    cachedHlmsCache = preparedDraws->hlmsCache;
+                ++preparedDraws;
+            }
+            else
+            {
+                uint8 meshLod = queuedRenderable.movableObject->getCurrentMeshLod();
+                const VertexArrayObjectArray &vaos = queuedRenderable.renderable->getVaos(
+                            static_cast<VertexPass>(casterPass) );
+
+                vao = vaos[meshLod];
+                const HlmsDatablock *datablock = queuedRenderable.renderable->getDatablock();
+
+                hlms = mHlmsManager->getHlms( static_cast<HlmsTypes>( datablock->mType ) );
+            }
 
             lastHlmsCacheHash = lastHlmsCache->hash;
-            const HlmsCache *hlmsCache = hlms->getMaterial( lastHlmsCache,
-                                                            passCache[datablock->mType],
+            const HlmsCache *hlmsCache = hlms->getMaterial( cachedHlmsCache,
+                                                            passCache[hlms->getType()],
                                                             queuedRenderable,
-                                                            casterPass );
+                                                            casterPass, true );
+            if( !hlmsCache )
+            {
+                //Shader generation deferred to a later frame. Skip it.
+                ++itor;
+                continue;
+            }
+
             if( lastHlmsCacheHash != hlmsCache->hash )
             {
                 CbPipelineStateObject *psoCmd = mCommandBuffer->addCommand<CbPipelineStateObject>();
                 *psoCmd = CbPipelineStateObject( &hlmsCache->pso );
                 lastHlmsCache = hlmsCache;
+                ++numPsoSwitches;
 
                 //Flush the Vao when changing shaders. Needed by D3D11/12 & possibly Vulkan
                 lastVaoName = 0;
@@ -698,6 +1197,11 @@ namespace Ogre
 
         rs->_addMetrics( stats );
 
+        FrameMetrics *frameMetrics = mRoot->getFrameMetrics();
+        frameMetrics->add( FrameMetric::DrawCalls, stats.mDrawCount );
+        frameMetrics->add( FrameMetric::Instances, stats.mInstanceCount );
+        frameMetrics->add( FrameMetric::PsoSwitches, numPsoSwitches );
+
         mLastVaoName        = lastVaoName;
         mLastVertexData     = 0;
         mLastIndexData      = 0;
@@ -724,6 +1228,7 @@ namespace Ogre
         v1::CbDrawCall *drawCmd = 0;
 
         RenderSystem::Metrics stats;
+        uint64 numPsoSwitches = 0;
 
         const QueuedRenderableArray &queuedRenderables = renderQueueGroup.mQueuedRenderables;
 
@@ -745,12 +1250,20 @@ namespace Ogre
             lastHlmsCacheHash = lastHlmsCache->hash;
             const HlmsCache *hlmsCache = hlms->getMaterial( lastHlmsCache,
                                                             passCache[datablock->mType],
-                                                            queuedRenderable, casterPass );
+                                                            queuedRenderable, casterPass, true );
+            if( !hlmsCache )
+            {
+                //Shader generation deferred to a later frame. Skip it.
+                ++itor;
+                continue;
+            }
+
             if( lastHlmsCache != hlmsCache )
             {
                 CbPipelineStateObject *psoCmd = mCommandBuffer->addCommand<CbPipelineStateObject>();
                 *psoCmd = CbPipelineStateObject( &hlmsCache->pso );
                 lastHlmsCache = hlmsCache;
+                ++numPsoSwitches;
 
                 //Flush the RenderOp when changing shaders. Needed by D3D11/12 & possibly Vulkan
                 lastRenderOp.vertexData = 0;
@@ -838,6 +1351,11 @@ namespace Ogre
 
         rs->_addMetrics( stats );
 
+        FrameMetrics *frameMetrics = mRoot->getFrameMetrics();
+        frameMetrics->add( FrameMetric::DrawCalls, stats.mDrawCount );
+        frameMetrics->add( FrameMetric::Instances, stats.mInstanceCount );
+        frameMetrics->add( FrameMetric::PsoSwitches, numPsoSwitches );
+
         mLastVaoName        = 0;
         mLastVertexData     = 0;
         mLastIndexData      = 0;
@@ -896,6 +1414,11 @@ namespace Ogre
 
         rs->_render( op );
 
+        FrameMetrics *frameMetrics = mRoot->getFrameMetrics();
+        frameMetrics->add( FrameMetric::DrawCalls, 1u );
+        frameMetrics->add( FrameMetric::Instances, op.numberOfInstances );
+        frameMetrics->add( FrameMetric::PsoSwitches, 1u );
+
         mLastVaoName        = 0;
         --mRenderingStarted;
     }
@@ -915,6 +1438,9 @@ namespace Ogre
                                      mUsedIndirectBuffers.begin(),
                                      mUsedIndirectBuffers.end() );
         mUsedIndirectBuffers.clear();
+
+        mLastFrameInstancingStats = mInstancingStats;
+        mInstancingStats = InstancingStats();
     }
     //-----------------------------------------------------------------------
     void RenderQueue::setRenderQueueMode( uint8 rqId, Modes newMode )
@@ -932,9 +1458,34 @@ namespace Ogre
         mRenderQueues[rqId].mSortMode = sortMode;
     }
     //-----------------------------------------------------------------------
+    void RenderQueue::setParallelCommandPreparation( bool bEnable )
+    {
+        mParallelCommandPreparation = bEnable;
+    }
+    //-----------------------------------------------------------------------
     RenderQueue::RqSortMode RenderQueue::getSortRenderQueue( uint8 rqId ) const
     {
         return mRenderQueues[rqId].mSortMode;
     }
+    //-----------------------------------------------------------------------
+    void RenderQueue::setInstancingGrouping( uint8 rqId, bool bEnable )
+    {
+        mRenderQueues[rqId].mInstancingGrouping = bEnable;
+    }
+    //-----------------------------------------------------------------------
+    bool RenderQueue::getInstancingGrouping( uint8 rqId ) const
+    {
+        return mRenderQueues[rqId].mInstancingGrouping;
+    }
+    //-----------------------------------------------------------------------
+    void RenderQueue::setOrderIndependentTransparency( uint8 rqId, bool bEnable )
+    {
+        mRenderQueues[rqId].mOrderIndependentTransparency = bEnable;
+    }
+    //-----------------------------------------------------------------------
+    bool RenderQueue::getOrderIndependentTransparency( uint8 rqId ) const
+    {
+        return mRenderQueues[rqId].mOrderIndependentTransparency;
+    }
 }
 
@@ -49,6 +49,7 @@ THE SOFTWARE.
 #include "Vao/OgreVaoManager.h"
 #include "Vao/OgreVertexArrayObject.h"
 #include "OgreProfiler.h"
+#include "OgreGpuProfiler.h"
 
 #include "OgreLwString.h"
 
@@ -61,6 +62,7 @@ namespace Ogre {
         , mMaxBoundViewports(16u)
         , mVaoManager(0)
         , mTextureGpuManager(0)
+        , mGpuProfiler(0)
 #if OGRE_DEBUG_MODE >= OGRE_DEBUG_HIGH
         , mDebugShaders(true)
 #else
@@ -691,6 +693,8 @@ namespace Ogre {
     void RenderSystem::_beginFrameOnce(void)
     {
         mVaoManager->_beginFrame();
+        if( mGpuProfiler )
+            mGpuProfiler->_beginFrame();
     }
     //-----------------------------------------------------------------------
     void RenderSystem::_endFrameOnce(void)
@@ -725,6 +729,9 @@ namespace Ogre {
         }
         mHwOcclusionQueries.clear();
 
+        OGRE_DELETE mGpuProfiler;
+        mGpuProfiler = 0;
+
         destroyAllRenderPassDescriptors();
         _cleanupDepthBuffers();
         OGRE_ASSERT_LOW( mSharedDepthBufferRefs.empty() &&
@@ -1242,10 +1249,19 @@ namespace Ogre {
     void RenderSystem::_update(void)
     {
         OgreProfile( "RenderSystem::_update" );
+        if( mGpuProfiler )
+            mGpuProfiler->_endFrame();
         mTextureGpuManager->_update( false );
         mVaoManager->_update();
     }
     //---------------------------------------------------------------------
+    GpuProfiler* RenderSystem::getGpuProfiler(void)
+    {
+        if( !mGpuProfiler )
+            mGpuProfiler = OGRE_NEW GpuProfiler( this );
+        return mGpuProfiler;
+    }
+    //---------------------------------------------------------------------
     void RenderSystem::updateCompositorManager( CompositorManager2 *compositorManager )
     {
         compositorManager->_updateImplementation();
@@ -40,14 +40,16 @@ THE SOFTWARE.
 namespace Ogre
 {
     Renderable::Renderable() :
+        mHlmsDatablock( 0 ),
         mHlmsHash( 0 ),
         mHlmsCasterHash( 0 ),
-        mHlmsDatablock( 0 ),
+        mLodMaterial( &MovableObject::c_DefaultLodMesh ),
         mCustomParameter( 0 ),
         mRenderQueueSubGroup( 0 ),
         mHasSkeletonAnimation( false ),
+        mHasGpuSkeletonAnimation( false ),
+        mHasBakedSkeletonAnimation( false ),
         mCurrentMaterialLod( 0 ),
-        mLodMaterial( &MovableObject::c_DefaultLodMesh ),
         mHlmsGlobalIndex( ~0 ),
         mPolygonModeOverrideable( true ),
         mUseIdentityProjection( false ),
@@ -209,6 +211,7 @@ namespace Ogre
         mMaterial = material;
         setDatablock( material->getTechnique(0)->getPass(0)->_getDatablock() );
         mLodMaterial = material->_getLodValues();
+        LodStrategy::_notifyLodValuesChanged();
     }
     //-----------------------------------------------------------------------------------
     MaterialPtr Renderable::getMaterial(void) const
@@ -267,6 +270,16 @@ namespace Ogre
         return mPoseData ? mPoseData->buffer : 0;
     }
     //-----------------------------------------------------------------------------------
+    TexBufferPacked* Renderable::getPoseIndexTexBuffer(void) const
+    {
+        return mPoseData ? mPoseData->indexBuffer : 0;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 Renderable::getNumPoseVertices(void) const
+    {
+        return mPoseData ? mPoseData->numPoseVertices : 0;
+    }
+    //-----------------------------------------------------------------------------------
     RenderableAnimated::RenderableAnimated() :
         Renderable(),
         mBlendIndexToBoneIndexMap( 0 )
@@ -276,6 +289,8 @@ namespace Ogre
     Renderable::PoseData::PoseData():
     numPoses( 0 ),
     buffer( 0 ),
+    indexBuffer( 0 ),
+    numPoseVertices( 0 ),
     halfPrecision( false ),
     hasNormals( false )
     {
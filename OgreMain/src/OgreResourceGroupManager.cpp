@@ -35,6 +35,8 @@ THE SOFTWARE.
 #include "OgreSceneManager.h"
 #include "OgreResourceManager.h"
 #include "OgreString.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
 
 #include <sstream>
 
@@ -59,7 +61,7 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     //-----------------------------------------------------------------------
     ResourceGroupManager::ResourceGroupManager()
-        : mLoadingListener(0), mCurrentGroup(0)
+        : mLoadingListener(0), mNumScriptParsingThreads(1u), mCurrentGroup(0)
     {
         // Create the 'General' group
         createResourceGroup(DEFAULT_RESOURCE_GROUP_NAME);
@@ -1137,53 +1139,136 @@ namespace Ogre {
         return 0; // No loader was found
     }
     //-----------------------------------------------------------------------
+    namespace
+    {
+        /// Work shared by the threads of ResourceGroupManager::findScriptFiles
+        struct ScriptListingJob
+        {
+            const vector<ResourceGroupManager::ResourceLocation*>::type *locations;
+            const StringVector  *patterns;
+            /// locations * patterns lists, location major
+            FileInfoListPtr     *results;
+            size_t              numThreads;
+        };
+
+        /// A script to parse by ResourceGroupManager::parseResourceGroupScriptsThreaded
+        struct ScriptParsingEntry
+        {
+            ScriptLoader                    *loader;
+            const FileInfo                  *fileInfo;
+            DataStreamPtr                   stream;
+            ScriptLoader::PreparedScript    *preparedScript;
+        };
+        typedef vector<ScriptParsingEntry>::type ScriptParsingEntryVec;
+
+        struct ScriptParsingJob
+        {
+            ScriptParsingEntryVec   *entries;
+            const String            *groupName;
+            size_t                  numThreads;
+        };
+    }
+
+    unsigned long findScriptFilesThread( ThreadHandle *threadHandle )
+    {
+        const ScriptListingJob *job = reinterpret_cast<const ScriptListingJob*>(
+                                          threadHandle->getUserParam() );
+        const size_t numLocations = job->locations->size();
+        const size_t numPatterns = job->patterns->size();
+        for( size_t i=threadHandle->getThreadIdx(); i<numLocations; i += job->numThreads )
+        {
+            const ResourceGroupManager::ResourceLocation *location = (*job->locations)[i];
+            for( size_t j=0; j<numPatterns; ++j )
+            {
+                job->results[i * numPatterns + j] =
+                        location->archive->findFileInfo( (*job->patterns)[j], location->recursive,
+                                                         false );
+            }
+        }
+        return 0;
+    }
+    THREAD_DECLARE( findScriptFilesThread );
+
+    unsigned long prepareScriptsThread( ThreadHandle *threadHandle )
+    {
+        const ScriptParsingJob *job = reinterpret_cast<const ScriptParsingJob*>(
+                                          threadHandle->getUserParam() );
+        const size_t numEntries = job->entries->size();
+        for( size_t i=threadHandle->getThreadIdx(); i<numEntries; i += job->numThreads )
+        {
+            ScriptParsingEntry &entry = (*job->entries)[i];
+            if( !entry.stream.isNull() )
+            {
+                try
+                {
+                    entry.preparedScript = entry.loader->prepareScript( entry.stream,
+                                                                        *job->groupName );
+                }
+                catch( ... )
+                {
+                    //parseScript will run on the main thread instead
+                    entry.preparedScript = 0;
+                }
+            }
+        }
+        return 0;
+    }
+    THREAD_DECLARE( prepareScriptsThread );
+    //-----------------------------------------------------------------------
     void ResourceGroupManager::parseResourceGroupScripts(ResourceGroup* grp)
     {
 
         LogManager::getSingleton().logMessage(
             "Parsing scripts for resource group " + grp->name);
 
-        // Count up the number of scripts we have to parse
-        typedef list<FileInfoListPtr>::type FileListList;
-        typedef SharedPtr<FileListList> FileListListPtr;
-        typedef std::pair<ScriptLoader*, FileListListPtr> LoaderFileListPair;
-        typedef list<LoaderFileListPair>::type ScriptLoaderFileList;
-        ScriptLoaderFileList scriptLoaderFileList;
-        size_t scriptCount = 0;
-        // Iterate over script users in loading order and get streams
+        size_t numThreads = mNumScriptParsingThreads;
+        if( numThreads == 0 )
+        {
+            //getNumLogicalCores() may return 0 if couldn't detect
+            numThreads = std::max<size_t>( 1u, PlatformInformation::getNumLogicalCores() );
+        }
+        // WaitForMultipleObjects can't wait on more than 64 handles
+        numThreads = std::min<size_t>( numThreads, 65u );
+
+        // Gather the patterns of every script loader, in loading order
+        vector<ScriptLoader*>::type scriptLoaders;
+        StringVector patterns;
         ScriptLoaderOrderMap::iterator oi;
         for (oi = mScriptLoaderOrderMap.begin();
             oi != mScriptLoaderOrderMap.end(); ++oi)
         {
             ScriptLoader* su = oi->second;
-            // MEMCATEGORY_GENERAL is the only category supported for SharedPtr
-            FileListListPtr fileListList(OGRE_NEW_T(FileListList, MEMCATEGORY_GENERAL)(), SPFM_DELETE_T);
-
-            // Get all the patterns and search them
-            const StringVector& patterns = su->getScriptPatterns();
-            for (StringVector::const_iterator p = patterns.begin(); p != patterns.end(); ++p)
+            const StringVector& loaderPatterns = su->getScriptPatterns();
+            for (StringVector::const_iterator p = loaderPatterns.begin(); p != loaderPatterns.end(); ++p)
             {
-                FileInfoListPtr fileList = findResourceFileInfo(grp->name, *p);
-                scriptCount += fileList->size();
-                fileListList->push_back(fileList);
+                scriptLoaders.push_back(su);
+                patterns.push_back(*p);
             }
-            scriptLoaderFileList.push_back(
-                LoaderFileListPair(su, fileListList));
         }
+
+        // Count up the number of scripts we have to parse
+        vector<FileInfoListPtr>::type fileLists;
+        findScriptFiles(grp, patterns, numThreads, fileLists);
+        size_t scriptCount = 0;
+        for (size_t i = 0; i < fileLists.size(); ++i)
+            scriptCount += fileLists[i]->size();
+
         // Fire scripting event
         fireResourceGroupScriptingStarted(grp->name, scriptCount);
 
-        // Iterate over scripts and parse
-        // Note we respect original ordering
-        for (ScriptLoaderFileList::iterator slfli = scriptLoaderFileList.begin();
-            slfli != scriptLoaderFileList.end(); ++slfli)
+        if (numThreads > 1u)
         {
-            ScriptLoader* su = slfli->first;
-            // Iterate over each list
-            for (FileListList::iterator flli = slfli->second->begin(); flli != slfli->second->end(); ++flli)
+            parseResourceGroupScriptsThreaded(grp, scriptLoaders, fileLists, numThreads);
+        }
+        else
+        {
+            // Iterate over scripts and parse
+            // Note we respect original ordering
+            for (size_t i = 0; i < fileLists.size(); ++i)
             {
+                ScriptLoader* su = scriptLoaders[i];
                 // Iterate over each item in the list
-                for (FileInfoList::iterator fii = (*flli)->begin(); fii != (*flli)->end(); ++fii)
+                for (FileInfoList::iterator fii = fileLists[i]->begin(); fii != fileLists[i]->end(); ++fii)
                 {
                     bool skipScript = false;
                     fireScriptStarted(fii->filename, skipScript);
@@ -1202,7 +1287,8 @@ namespace Ogre {
                             if (mLoadingListener)
                                 mLoadingListener->resourceStreamOpened(fii->filename, grp->name, 0, stream);
 
-                            if(fii->archive->getType() == "FileSystem" && stream->size() <= 1024 * 1024)
+                            if(fii->archive->getType() == "FileSystem" && stream->size() <= 1024 * 1024 &&
+                               !stream->getDataView())
                             {
                                 DataStreamPtr cachedCopy;
                                 cachedCopy.bind(OGRE_NEW MemoryDataStream(stream->getName(), stream));
@@ -1222,6 +1308,159 @@ namespace Ogre {
             "Finished parsing scripts for resource group " + grp->name);
     }
     //-----------------------------------------------------------------------
+    void ResourceGroupManager::findScriptFiles( ResourceGroup* grp, const StringVector &patterns,
+                                                size_t numThreads,
+                                                vector<FileInfoListPtr>::type &outFileLists )
+    {
+        outFileLists.clear();
+        outFileLists.reserve( patterns.size() );
+
+        const vector<ResourceLocation*>::type locations( grp->locationList.begin(),
+                                                         grp->locationList.end() );
+        numThreads = std::min( numThreads, locations.size() );
+
+        if( numThreads <= 1u )
+        {
+            for( size_t i=0; i<patterns.size(); ++i )
+                outFileLists.push_back( findResourceFileInfo( grp->name, patterns[i] ) );
+            return;
+        }
+
+        vector<FileInfoListPtr>::type results( locations.size() * patterns.size() );
+
+        ScriptListingJob job;
+        job.locations   = &locations;
+        job.patterns    = &patterns;
+        job.results     = &results[0];
+        job.numThreads  = numThreads;
+
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            threadHandles.push_back( Threads::CreateThread( THREAD_GET( findScriptFilesThread ),
+                                                            i, &job ) );
+        }
+        Threads::WaitForThreads( threadHandles );
+
+        // Merge in the same order findResourceFileInfo would've returned them
+        for( size_t i=0; i<patterns.size(); ++i )
+        {
+            // MEMCATEGORY_GENERAL is the only category supported for SharedPtr
+            FileInfoListPtr fileList( OGRE_NEW_T( FileInfoList, MEMCATEGORY_GENERAL )(),
+                                      SPFM_DELETE_T );
+            for( size_t j=0; j<locations.size(); ++j )
+            {
+                const FileInfoListPtr &lst = results[j * patterns.size() + i];
+                if( !lst.isNull() )
+                    fileList->insert( fileList->end(), lst->begin(), lst->end() );
+            }
+            outFileLists.push_back( fileList );
+        }
+    }
+    //-----------------------------------------------------------------------
+    void ResourceGroupManager::parseResourceGroupScriptsThreaded(
+            ResourceGroup* grp, const vector<ScriptLoader*>::type &scriptLoaders,
+            const vector<FileInfoListPtr>::type &fileLists, size_t numThreads )
+    {
+        // Open every script and load it into memory
+        ScriptParsingEntryVec entries;
+        for( size_t i=0; i<fileLists.size(); ++i )
+        {
+            for( FileInfoList::const_iterator fii = fileLists[i]->begin();
+                 fii != fileLists[i]->end(); ++fii )
+            {
+                ScriptParsingEntry entry;
+                entry.loader = scriptLoaders[i];
+                entry.fileInfo = &(*fii);
+                entry.preparedScript = 0;
+
+                DataStreamPtr stream = fii->archive->open( fii->filename );
+                if( !stream.isNull() )
+                {
+                    if( mLoadingListener )
+                        mLoadingListener->resourceStreamOpened( fii->filename, grp->name, 0, stream );
+                    if( stream->getDataView() )
+                        entry.stream = stream;
+                    else
+                        entry.stream.bind( OGRE_NEW MemoryDataStream( stream->getName(), stream ) );
+                }
+
+                entries.push_back( entry );
+            }
+        }
+
+        // Prepare them in parallel
+        if( !entries.empty() )
+        {
+            ScriptParsingJob job;
+            job.entries     = &entries;
+            job.groupName   = &grp->name;
+            job.numThreads  = std::min( numThreads, entries.size() );
+
+            ThreadHandleVec threadHandles;
+            threadHandles.reserve( job.numThreads );
+            for( size_t i=0; i<job.numThreads; ++i )
+            {
+                threadHandles.push_back( Threads::CreateThread( THREAD_GET( prepareScriptsThread ),
+                                                                i, &job ) );
+            }
+            Threads::WaitForThreads( threadHandles );
+        }
+
+        // Finish them in the original order
+        ScriptParsingEntryVec::iterator itor = entries.begin();
+        ScriptParsingEntryVec::iterator end  = entries.end();
+
+        try
+        {
+            while( itor != end )
+            {
+                const String &filename = itor->fileInfo->filename;
+
+                bool skipScript = false;
+                fireScriptStarted( filename, skipScript );
+                if( skipScript )
+                {
+                    LogManager::getSingleton().logMessage( "Skipping script " + filename );
+                }
+                else
+                {
+                    LogManager::getSingleton().logMessage( "Parsing script " + filename );
+                    if( !itor->stream.isNull() )
+                    {
+                        itor->stream->seek( 0 );
+                        if( itor->preparedScript )
+                        {
+                            itor->loader->parsePreparedScript( itor->preparedScript, itor->stream,
+                                                               grp->name );
+                        }
+                        else
+                        {
+                            itor->loader->parseScript( itor->stream, grp->name );
+                        }
+                    }
+                }
+
+                OGRE_DELETE itor->preparedScript;
+                itor->preparedScript = 0;
+                itor->stream.setNull();
+
+                fireScriptEnded( filename, skipScript );
+                ++itor;
+            }
+        }
+        catch( ... )
+        {
+            while( itor != end )
+            {
+                OGRE_DELETE itor->preparedScript;
+                ++itor;
+            }
+            throw;
+        }
+    }
+    //-----------------------------------------------------------------------
     void ResourceGroupManager::createDeclaredResources(ResourceGroup* grp)
     {
 
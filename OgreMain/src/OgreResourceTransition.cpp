@@ -46,4 +46,26 @@ namespace Ogre
             return resourceAccessTable[value];
         }
     }
+
+    namespace ResourceLayout
+    {
+        const char* resourceLayoutTable[NumResourceLayouts+1u] =
+        {
+            "Undefined",
+            "Texture",
+            "TextureDepth",
+            "RenderTarget",
+            "RenderDepth",
+            "Clear",
+            "Uav",
+            "CopySrc",
+            "CopyDst",
+            "NumResourceLayouts"
+        };
+
+        const char* toString( Layout value )
+        {
+            return resourceLayoutTable[value];
+        }
+    }
 }
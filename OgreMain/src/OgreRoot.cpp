@@ -48,6 +48,7 @@ THE SOFTWARE.
 #include "OgreArchiveManager.h"
 #include "OgrePlugin.h"
 #include "OgreFileSystem.h"
+#include "OgrePackArchive.h"
 #include "OgreResourceBackgroundQueue.h"
 #include "OgreTextureGpuManager.h"
 #include "OgreDecal.h"
@@ -59,14 +60,22 @@ THE SOFTWARE.
 #include "OgreRibbonTrail.h"
 #include "OgreLight.h"
 #include "OgreRectangle2D2.h"
+#include "OgreBillboardChain2.h"
+#include "OgreRibbonTrail2.h"
 #include "OgreManualObject.h"
 #include "OgreManualObject2.h"
 #include "OgrePlatformInformation.h"
 #include "OgreConvexBody.h"
 #include "OgreFrameStats.h"
+#include "OgreFrameMetrics.h"
+#include "OgreFramePacer.h"
+#include "OgreLoadProfiler.h"
+#include "OgreGpuMemoryTracker.h"
+#include "OgreFrameArena.h"
 #include "OgreTimer.h"
 #include "OgreLodStrategyManager.h"
 #include "Threading/OgreDefaultWorkQueue.h"
+#include "Threading/OgreBarrier.h"
 #include "OgreFrameListener.h"
 #include "OgreWireAabb.h"
 #include "OgreNameGenerator.h"
@@ -112,6 +121,9 @@ THE SOFTWARE.
 #if OGRE_NO_ASTC_CODEC == 0
 #  include "OgreASTCCodec.h"
 #endif
+#if OGRE_NO_KTX2_CODEC == 0
+#  include "OgreKTX2Codec.h"
+#endif
 
 #include <fstream>
 #include <sstream>
@@ -140,12 +152,19 @@ namespace Ogre {
       , mLogManager(0)
       , mRenderSystemCapabilitiesManager(0)
       , mFrameStats(0)
+      , mFrameMetrics(0)
+      , mFramePacer(0)
+      , mLoadProfiler(0)
+      , mGpuMemoryTracker(0)
+      , mFrameArenaManager(0)
       , mCompositorManager2(0)
       , mNextFrame(0)
       , mFrameSmoothingTime(0.0f)
       , mRemoveQueueStructuresOnClear(false)
       , mDefaultMinPixelSize(0)
       , mLightProfilesInvHeight(1.0f)
+      , mSceneGraphUpdateBarrier(0)
+      , mSceneGraphUpdateStop(false)
       , mNextMovableObjectTypeFlag(1)
       , mIsInitialised(false)
       , mFrameStarted( false )
@@ -203,6 +222,8 @@ namespace Ogre {
 #endif
         mWorkQueue = defaultQ;
 
+        mFrameArenaManager = OGRE_NEW FrameArenaManager();
+
         // ResourceBackgroundQueue
         mResourceBackgroundQueue = OGRE_NEW ResourceBackgroundQueue();
 
@@ -227,8 +248,12 @@ namespace Ogre {
         mParticleManager = OGRE_NEW ParticleSystemManager();
 
         mFrameStats = OGRE_NEW FrameStats();
+        mFrameMetrics = OGRE_NEW FrameMetrics();
+        mLoadProfiler = OGRE_NEW LoadProfiler();
+        mGpuMemoryTracker = OGRE_NEW GpuMemoryTracker();
 
         mTimer = OGRE_NEW Timer();
+        mFramePacer = OGRE_NEW FramePacer( mTimer, mFrameMetrics );
 
         // LOD strategy manager
         mLodStrategyManager = OGRE_NEW LodStrategyManager();
@@ -242,6 +267,8 @@ namespace Ogre {
 
         mFileSystemArchiveFactory = OGRE_NEW FileSystemArchiveFactory();
         ArchiveManager::getSingleton().addArchiveFactory( mFileSystemArchiveFactory );
+        mPackArchiveFactory = OGRE_NEW PackArchiveFactory();
+        ArchiveManager::getSingleton().addArchiveFactory( mPackArchiveFactory );
 #   if OGRE_NO_ZIP_ARCHIVE == 0
         mZipArchiveFactory = OGRE_NEW ZipArchiveFactory();
         ArchiveManager::getSingleton().addArchiveFactory( mZipArchiveFactory );
@@ -270,6 +297,9 @@ namespace Ogre {
 #endif
 #if OGRE_NO_ASTC_CODEC == 0
         ASTCCodec::startup();
+#endif
+#if OGRE_NO_KTX2_CODEC == 0
+        KTX2Codec::startup();
 #endif
         OITDCodec::startup();
 
@@ -299,6 +329,10 @@ namespace Ogre {
         addMovableObjectFactory(mLightFactory);
         mRectangle2DFactory = OGRE_NEW Rectangle2DFactory();
         addMovableObjectFactory(mRectangle2DFactory);
+        mBillboardChain2Factory = OGRE_NEW BillboardChainFactory();
+        addMovableObjectFactory(mBillboardChain2Factory);
+        mRibbonTrail2Factory = OGRE_NEW RibbonTrailFactory();
+        addMovableObjectFactory(mRibbonTrail2Factory);
         mBillboardSetFactory = OGRE_NEW v1::BillboardSetFactory();
         addMovableObjectFactory(mBillboardSetFactory);
         mManualObjectFactory = OGRE_NEW ManualObjectFactory();
@@ -366,6 +400,9 @@ namespace Ogre {
 #if OGRE_NO_ASTC_CODEC == 0
         ASTCCodec::shutdown();
 #endif
+#if OGRE_NO_KTX2_CODEC == 0
+        KTX2Codec::shutdown();
+#endif
 
         OGRE_DELETE mLodStrategyManager;
 
@@ -375,6 +412,7 @@ namespace Ogre {
         OGRE_DELETE mZipArchiveFactory;
         OGRE_DELETE mEmbeddedZipArchiveFactory;
 #   endif
+        OGRE_DELETE mPackArchiveFactory;
         OGRE_DELETE mFileSystemArchiveFactory;
 
         OGRE_DELETE mOldSkeletonManager;
@@ -406,6 +444,8 @@ namespace Ogre {
         OGRE_DELETE mItemFactory;
         OGRE_DELETE mLightFactory;
         OGRE_DELETE mRectangle2DFactory;
+        OGRE_DELETE mBillboardChain2Factory;
+        OGRE_DELETE mRibbonTrail2Factory;
         OGRE_DELETE mBillboardSetFactory;
         OGRE_DELETE mManualObjectFactory;
         OGRE_DELETE mBillboardChainFactory;
@@ -414,8 +454,19 @@ namespace Ogre {
 
         OGRE_DELETE mWorkQueue;
 
-        OGRE_DELETE mFrameStats;
+        OGRE_DELETE mFrameArenaManager;
+        mFrameArenaManager = 0;
 
+        OGRE_DELETE mFrameStats;
+        OGRE_DELETE mFrameMetrics;
+        mFrameMetrics = 0;
+        OGRE_DELETE mLoadProfiler;
+        mLoadProfiler = 0;
+        OGRE_DELETE mGpuMemoryTracker;
+        mGpuMemoryTracker = 0;
+
+        OGRE_DELETE mFramePacer;
+        mFramePacer = 0;
         OGRE_DELETE mTimer;
 
         OGRE_DELETE mDynLibManager;
@@ -799,6 +850,7 @@ namespace Ogre {
         // Initialise timer
         mTimer->reset();
         mFrameStats->reset( mTimer->getMicroseconds() );
+        mFrameMetrics->reset( mTimer->getMicroseconds() );
 
         // Init pools
         ConvexBody::_initialisePool();
@@ -988,6 +1040,12 @@ namespace Ogre {
         // Tell the queue to process responses
         mWorkQueue->processResponses();
 
+        // Finish the meshes whose files were read in the background
+        mMeshManager->_updateAsyncLoads();
+
+        // Memory from the frame arenas is no longer needed
+        mFrameArenaManager->_notifyFrameEnded();
+
 #if OGRE_PROFILING
         if( OgreProfilerUseStableMarkers )
         {
@@ -1103,33 +1161,39 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     bool Root::renderOneFrame(void)
     {
+        VaoManager *vaoManager = mActiveRenderer ? mActiveRenderer->getVaoManager() : 0;
+        mFramePacer->_beginFrame( vaoManager );
+
         if(!_fireFrameStarted())
             return false;
 
-        SceneManagerEnumerator::SceneManagerIterator itor = mSceneManagerEnum->getSceneManagerIterator();
-        while( itor.hasMoreElements() )
-        {
-            SceneManager *sceneManager = itor.getNext();
-            sceneManager->updateSceneGraph();
-        }
+        updateAllSceneGraphs();
 
         if (!_updateAllRenderTargets())
             return false;
 
-        itor = mSceneManagerEnum->getSceneManagerIterator();
+        SceneManagerEnumerator::SceneManagerIterator itor =
+                mSceneManagerEnum->getSceneManagerIterator();
         while( itor.hasMoreElements() )
         {
             SceneManager *sceneManager = itor.getNext();
             sceneManager->clearFrameData();
         }
 
-        mFrameStats->addSample( mTimer->getMicroseconds() );
+        mFramePacer->_endFrame( vaoManager );
+
+        const uint64 now = mTimer->getMicroseconds();
+        mFrameStats->addSample( now );
+        mFrameMetrics->_endFrame( now, mNextFrame );
 
         return _fireFrameEnded();
     }
     //---------------------------------------------------------------------
     bool Root::renderOneFrame(Real timeSinceLastFrame)
     {
+        VaoManager *vaoManager = mActiveRenderer ? mActiveRenderer->getVaoManager() : 0;
+        mFramePacer->_beginFrame( vaoManager );
+
         FrameEvent evt;
         evt.timeSinceLastFrame = timeSinceLastFrame;
 
@@ -1139,25 +1203,24 @@ namespace Ogre {
         if(!_fireFrameStarted(evt))
             return false;
 
-        SceneManagerEnumerator::SceneManagerIterator itor = mSceneManagerEnum->getSceneManagerIterator();
-        while( itor.hasMoreElements() )
-        {
-            SceneManager *sceneManager = itor.getNext();
-            sceneManager->updateSceneGraph();
-        }
+        updateAllSceneGraphs();
 
         if (!_updateAllRenderTargets(evt))
             return false;
 
-        itor = mSceneManagerEnum->getSceneManagerIterator();
+        SceneManagerEnumerator::SceneManagerIterator itor =
+                mSceneManagerEnum->getSceneManagerIterator();
         while( itor.hasMoreElements() )
         {
             SceneManager *sceneManager = itor.getNext();
             sceneManager->clearFrameData();
         }
 
+        mFramePacer->_endFrame( vaoManager );
+
         now = mTimer->getMicroseconds();
         mFrameStats->addSample( now );
+        mFrameMetrics->_endFrame( now, mNextFrame );
         now /= 1000; // Convert to milliseconds.
         evt.timeSinceLastEvent = calculateEventTime(now, FETT_ANY);
 
@@ -1166,6 +1229,8 @@ namespace Ogre {
     //-----------------------------------------------------------------------
     void Root::shutdown(void)
     {
+        setSceneGraphUpdateThreads( 0 );
+
         // Since background thread might be access resources,
         // ensure shutdown before destroying resource manager.
         mResourceBackgroundQueue->shutdown();
@@ -1223,6 +1288,108 @@ namespace Ogre {
 
     }
     //-----------------------------------------------------------------------
+    void Root::updateAllSceneGraphs(void)
+    {
+        mSceneGraphUpdateList.clear();
+        SceneManagerEnumerator::SceneManagerIterator itor =
+                mSceneManagerEnum->getSceneManagerIterator();
+        while( itor.hasMoreElements() )
+            mSceneGraphUpdateList.push_back( itor.getNext() );
+
+        FastArray<SceneManager*>::const_iterator itSm = mSceneGraphUpdateList.begin();
+        FastArray<SceneManager*>::const_iterator enSm = mSceneGraphUpdateList.end();
+
+        if( mSceneGraphUpdateThreads.empty() || mSceneGraphUpdateList.size() <= 1u )
+        {
+            while( itSm != enSm )
+            {
+                (*itSm)->updateSceneGraph();
+                ++itSm;
+            }
+            return;
+        }
+
+        while( itSm != enSm )
+        {
+            (*itSm)->_updateSceneGraphBegin();
+            ++itSm;
+        }
+
+        mSceneGraphUpdateBarrier->sync(); //Fire threads
+        updateSceneGraphsConcurrent( 0 );
+        mSceneGraphUpdateBarrier->sync(); //Wait them to complete
+
+        itSm = mSceneGraphUpdateList.begin();
+        while( itSm != enSm )
+        {
+            (*itSm)->_updateSceneGraphEnd();
+            ++itSm;
+        }
+    }
+    //-----------------------------------------------------------------------
+    void Root::updateSceneGraphsConcurrent( size_t threadIdx )
+    {
+        //The main thread is threadIdx = 0
+        const size_t numThreads = mSceneGraphUpdateThreads.size() + 1u;
+        const size_t numSceneManagers = mSceneGraphUpdateList.size();
+        for( size_t i=threadIdx; i<numSceneManagers; i += numThreads )
+            mSceneGraphUpdateList[i]->_updateSceneGraphConcurrent();
+    }
+    //-----------------------------------------------------------------------
+    unsigned long updateSceneGraphThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::FrameCritical );
+        Root *root = reinterpret_cast<Root*>( threadHandle->getUserParam() );
+        return root->_updateSceneGraphThread( threadHandle );
+    }
+    THREAD_DECLARE( updateSceneGraphThread );
+    //-----------------------------------------------------------------------
+    unsigned long Root::_updateSceneGraphThread( ThreadHandle *threadHandle )
+    {
+        const size_t threadIdx = threadHandle->getThreadIdx();
+
+        while( true )
+        {
+            mSceneGraphUpdateBarrier->sync();
+            if( mSceneGraphUpdateStop )
+                break;
+            updateSceneGraphsConcurrent( threadIdx + 1u );
+            mSceneGraphUpdateBarrier->sync();
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------
+    void Root::setSceneGraphUpdateThreads( size_t numThreads )
+    {
+        if( numThreads == mSceneGraphUpdateThreads.size() )
+            return;
+
+        if( !mSceneGraphUpdateThreads.empty() )
+        {
+            mSceneGraphUpdateStop = true;
+            mSceneGraphUpdateBarrier->sync();
+            Threads::WaitForThreads( mSceneGraphUpdateThreads );
+            mSceneGraphUpdateThreads.clear();
+
+            delete mSceneGraphUpdateBarrier;
+            mSceneGraphUpdateBarrier = 0;
+            mSceneGraphUpdateStop = false;
+        }
+
+        if( numThreads )
+        {
+            mSceneGraphUpdateBarrier = new Barrier( numThreads + 1u );
+            mSceneGraphUpdateThreads.reserve( numThreads );
+            for( size_t i=0; i<numThreads; ++i )
+            {
+                ThreadHandlePtr th = Threads::CreateThread( THREAD_GET( updateSceneGraphThread ),
+                                                            i, this );
+                mSceneGraphUpdateThreads.push_back( th );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------
     void Root::shutdownPlugins(void)
     {
         // NB Shutdown plugins in reverse order to enforce dependencies
@@ -1602,6 +1769,11 @@ namespace Ogre {
                 hlms->frameEnded();
         }
 
+        hlmsManager->_evictStalePsos();
+
+        if( mActiveRenderer )
+            mActiveRenderer->getTextureGpuManager()->_notifyFrameEnded();
+
         mFrameStarted = false;
     }
     //-----------------------------------------------------------------------
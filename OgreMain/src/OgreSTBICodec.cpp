@@ -108,12 +108,25 @@ namespace Ogre {
     //---------------------------------------------------------------------
     Codec::DecodeResult STBIImageCodec::decode(DataStreamPtr& input) const
     {
-        // Buffer stream into memory (TODO: override IO functions instead?)
-        MemoryDataStream memStream(input, true);
+        // Parse in place if the data is addressable, otherwise buffer stream into memory
+        // (TODO: override IO functions instead?)
+        MemoryDataStreamPtr memStream;
+        const uchar *srcData = input->getDataView();
+        size_t srcSize = input->size() - input->tell();
+        if( srcData )
+        {
+            srcData += input->tell();
+        }
+        else
+        {
+            memStream.bind( OGRE_NEW MemoryDataStream( input, true ) );
+            srcData = memStream->getPtr();
+            srcSize = memStream->size();
+        }
 
         int width, height, components;
         stbi_uc *pixelData = stbi_load_from_memory(
-            memStream.getPtr(), static_cast<int>( memStream.size() ), &width, &height, &components, 0 );
+            srcData, static_cast<int>( srcSize ), &width, &height, &components, 0 );
 
         if (!pixelData)
         {
@@ -0,0 +1,355 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreSceneCommandQueue.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreItem.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    SceneCommandQueue::Command::Command( CommandType _type ) :
+        type( _type ),
+        sceneType( SCENE_DYNAMIC ),
+        id( 0 ),
+        pendingNodeId( 0 ),
+        usePendingNode( false ),
+        sceneNode( 0 ),
+        item( 0 ),
+        position( Vector3::ZERO ),
+        orientation( Quaternion::IDENTITY ),
+        scale( Vector3::UNIT_SCALE )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    SceneCommandQueue::SceneCommandQueue( SceneManager *sceneManager, IdType numReservedIds ) :
+        mSceneManager( sceneManager ),
+        mNextNodeId( 0 ),
+        mNodeIdEnd( 0 ),
+        mNextObjectId( 0 ),
+        mObjectIdEnd( 0 ),
+        mNumReservedIds( std::max<IdType>( numReservedIds, 1u ) )
+    {
+        _reserveIds();
+    }
+    //-----------------------------------------------------------------------------------
+    SceneCommandQueue::~SceneCommandQueue()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    IdType SceneCommandQueue::reserveNodeId(void)
+    {
+        if( mNextNodeId == mNodeIdEnd )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Ran out of reserved SceneNode Ids. Increase numReservedIds in "
+                         "SceneManager::createSceneCommandQueue or record fewer commands per frame",
+                         "SceneCommandQueue::reserveNodeId" );
+        }
+
+        return mNextNodeId++;
+    }
+    //-----------------------------------------------------------------------------------
+    IdType SceneCommandQueue::reserveObjectId(void)
+    {
+        if( mNextObjectId == mObjectIdEnd )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Ran out of reserved MovableObject Ids. Increase numReservedIds in "
+                         "SceneManager::createSceneCommandQueue or record fewer commands per frame",
+                         "SceneCommandQueue::reserveObjectId" );
+        }
+
+        return mNextObjectId++;
+    }
+    //-----------------------------------------------------------------------------------
+    SceneNode* SceneCommandQueue::findPendingNode( IdType id )
+    {
+        //It may have been created by this or a previous execution
+        IdToSceneNodeMap::const_iterator itor = mExecutedNodes.find( id );
+        if( itor == mExecutedNodes.end() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "SceneNode with ID " + StringConverter::toString( id ) +
+                         " was never recorded in this queue or was already destroyed",
+                         "SceneCommandQueue::findPendingNode" );
+        }
+
+        return itor->second;
+    }
+    //-----------------------------------------------------------------------------------
+    IdType SceneCommandQueue::createSceneNode( SceneNode *parent, SceneMemoryMgrTypes sceneType,
+                                               const Vector3 &position,
+                                               const Quaternion &orientation,
+                                               const Vector3 &scale )
+    {
+        Command cmd( CmdCreateSceneNode );
+        cmd.sceneType   = sceneType;
+        cmd.sceneNode   = parent;
+        cmd.position    = position;
+        cmd.orientation = orientation;
+        cmd.scale       = scale;
+
+        ScopedLock lock( mMutex );
+        cmd.id = reserveNodeId();
+        mCommands.push_back( cmd );
+        return cmd.id;
+    }
+    //-----------------------------------------------------------------------------------
+    IdType SceneCommandQueue::createSceneNodeInPending( IdType pendingParentId,
+                                                        SceneMemoryMgrTypes sceneType,
+                                                        const Vector3 &position,
+                                                        const Quaternion &orientation,
+                                                        const Vector3 &scale )
+    {
+        Command cmd( CmdCreateSceneNode );
+        cmd.sceneType       = sceneType;
+        cmd.pendingNodeId   = pendingParentId;
+        cmd.usePendingNode  = true;
+        cmd.position        = position;
+        cmd.orientation     = orientation;
+        cmd.scale           = scale;
+
+        ScopedLock lock( mMutex );
+        cmd.id = reserveNodeId();
+        mCommands.push_back( cmd );
+        return cmd.id;
+    }
+    //-----------------------------------------------------------------------------------
+    IdType SceneCommandQueue::createItem( SceneNode *attachTo, const String &meshName,
+                                          const String &groupName, SceneMemoryMgrTypes sceneType )
+    {
+        Command cmd( CmdCreateItem );
+        cmd.sceneType   = sceneType;
+        cmd.sceneNode   = attachTo;
+        cmd.meshName    = meshName;
+        cmd.groupName   = groupName;
+
+        ScopedLock lock( mMutex );
+        cmd.id = reserveObjectId();
+        mCommands.push_back( cmd );
+        return cmd.id;
+    }
+    //-----------------------------------------------------------------------------------
+    IdType SceneCommandQueue::createItemInPending( IdType pendingNodeId, const String &meshName,
+                                                   const String &groupName,
+                                                   SceneMemoryMgrTypes sceneType )
+    {
+        Command cmd( CmdCreateItem );
+        cmd.sceneType       = sceneType;
+        cmd.pendingNodeId   = pendingNodeId;
+        cmd.usePendingNode  = true;
+        cmd.meshName        = meshName;
+        cmd.groupName       = groupName;
+
+        ScopedLock lock( mMutex );
+        cmd.id = reserveObjectId();
+        mCommands.push_back( cmd );
+        return cmd.id;
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::destroySceneNode( SceneNode *sceneNode )
+    {
+        Command cmd( CmdDestroySceneNode );
+        cmd.sceneNode = sceneNode;
+
+        ScopedLock lock( mMutex );
+        mCommands.push_back( cmd );
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::destroySceneNodeInPending( IdType pendingNodeId )
+    {
+        Command cmd( CmdDestroySceneNode );
+        cmd.pendingNodeId   = pendingNodeId;
+        cmd.usePendingNode  = true;
+
+        ScopedLock lock( mMutex );
+        mCommands.push_back( cmd );
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::destroyItem( Item *item )
+    {
+        Command cmd( CmdDestroyItem );
+        cmd.item = item;
+
+        ScopedLock lock( mMutex );
+        mCommands.push_back( cmd );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t SceneCommandQueue::getNumPendingCommands(void)
+    {
+        ScopedLock lock( mMutex );
+        return mCommands.size();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::_reserveIds(void)
+    {
+        ScopedLock lock( mMutex );
+
+        //Leftovers from the previous range are discarded; Ids don't need to be contiguous.
+        if( mNodeIdEnd - mNextNodeId < mNumReservedIds / 2u + 1u )
+        {
+            mNextNodeId = Id::reserveIds<Node>( mNumReservedIds );
+            mNodeIdEnd  = mNextNodeId + mNumReservedIds;
+        }
+
+        if( mObjectIdEnd - mNextObjectId < mNumReservedIds / 2u + 1u )
+        {
+            mNextObjectId = Id::reserveIds<MovableObject>( mNumReservedIds );
+            mObjectIdEnd  = mNextObjectId + mNumReservedIds;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::executeCommand( const Command &cmd )
+    {
+        switch( cmd.type )
+        {
+        case CmdCreateSceneNode:
+        {
+            SceneNode *parent = cmd.usePendingNode ? findPendingNode( cmd.pendingNodeId ) :
+                                                     cmd.sceneNode;
+            SceneNode *sceneNode = mSceneManager->_createSceneNodeWithId( cmd.id, parent,
+                                                                          cmd.sceneType );
+            sceneNode->setPosition( cmd.position );
+            sceneNode->setOrientation( cmd.orientation );
+            sceneNode->setScale( cmd.scale );
+            mExecutedNodes[cmd.id] = sceneNode;
+            mCreatedSceneNodes.push_back( sceneNode );
+            break;
+        }
+        case CmdCreateItem:
+        {
+            SceneNode *sceneNode = cmd.usePendingNode ? findPendingNode( cmd.pendingNodeId ) :
+                                                        cmd.sceneNode;
+            Item *item = mSceneManager->_createItemWithId( cmd.id, cmd.meshName,
+                                                           cmd.groupName, cmd.sceneType );
+            if( sceneNode )
+                sceneNode->attachObject( item );
+            mCreatedItems.push_back( item );
+            break;
+        }
+        case CmdDestroySceneNode:
+        {
+            //_notifySceneNodeDestroyed removes it from mExecutedNodes
+            SceneNode *sceneNode = cmd.usePendingNode ? findPendingNode( cmd.pendingNodeId ) :
+                                                        cmd.sceneNode;
+            mSceneManager->destroySceneNode( sceneNode );
+            break;
+        }
+        case CmdDestroyItem:
+            mSceneManager->destroyItem( cmd.item );
+            break;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::requeueAfterFailure( CommandVec::const_iterator failedCmd )
+    {
+        //Commands referring to a SceneNode whose creation failed (directly, or through
+        //a pending parent that was dropped too) can only fail. Drop them; keep the rest
+        //in recording order, ahead of whatever got recorded during the execution.
+        set<IdType>::type droppedNodes;
+        if( failedCmd->type == CmdCreateSceneNode )
+            droppedNodes.insert( failedCmd->id );
+
+        ScopedLock lock( mMutex );
+
+        const CommandVec &executingCommands = mExecutingCommands;
+        CommandVec candidates( failedCmd + 1, executingCommands.end() );
+        candidates.insert( candidates.end(), mCommands.begin(), mCommands.end() );
+
+        CommandVec remaining;
+        remaining.reserve( candidates.size() );
+
+        CommandVec::const_iterator itor = candidates.begin();
+        CommandVec::const_iterator end  = candidates.end();
+
+        while( itor != end )
+        {
+            if( itor->usePendingNode &&
+                droppedNodes.find( itor->pendingNodeId ) != droppedNodes.end() )
+            {
+                if( itor->type == CmdCreateSceneNode )
+                    droppedNodes.insert( itor->id );
+            }
+            else
+            {
+                remaining.push_back( *itor );
+            }
+            ++itor;
+        }
+
+        mCommands.swap( remaining );
+        mExecutingCommands.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::_execute(void)
+    {
+        mCreatedSceneNodes.clear();
+        mCreatedItems.clear();
+
+        {
+            ScopedLock lock( mMutex );
+            mExecutingCommands.swap( mCommands );
+        }
+
+        CommandVec::const_iterator itor = mExecutingCommands.begin();
+        CommandVec::const_iterator end  = mExecutingCommands.end();
+
+        try
+        {
+            while( itor != end )
+            {
+                executeCommand( *itor );
+                ++itor;
+            }
+        }
+        catch( ... )
+        {
+            requeueAfterFailure( itor );
+            throw;
+        }
+
+        mExecutingCommands.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::_notifySceneNodeDestroyed( SceneNode *sceneNode )
+    {
+        IdToSceneNodeMap::iterator itor = mExecutedNodes.find( sceneNode->getId() );
+        if( itor != mExecutedNodes.end() && itor->second == sceneNode )
+            mExecutedNodes.erase( itor );
+    }
+    //-----------------------------------------------------------------------------------
+    void SceneCommandQueue::_notifySceneCleared(void)
+    {
+        mExecutedNodes.clear();
+    }
+}
@@ -37,6 +37,7 @@ THE SOFTWARE.
 #include "OgreSubEntity.h"
 #include "OgreItem.h"
 #include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
 #include "OgreLight.h"
 #include "OgreControllerManager.h"
 #include "OgreMaterialManager.h"
@@ -46,6 +47,8 @@ THE SOFTWARE.
 #include "OgreTechnique.h"
 #include "OgreLogManager.h"
 #include "OgreRoot.h"
+#include "OgreFrameMetrics.h"
+#include "OgreTimer.h"
 #include "OgreGpuProgramManager.h"
 #include "OgreGpuProgram.h"
 #include "OgreDataStream.h"
@@ -59,8 +62,13 @@ THE SOFTWARE.
 #include "OgreProfiler.h"
 #include "OgreTextureGpuManager.h"
 #include "OgreSceneNode.h"
+#include "OgreSceneCommandQueue.h"
+#include "OgreItemPool.h"
 #include "OgreRadialDensityMask.h"
 #include "OgreRectangle2D2.h"
+#include "OgreBillboardChain2.h"
+#include "Vao/OgreStagingBuffer.h"
+#include "Vao/OgreVaoManager.h"
 #include "OgreLodListener.h"
 #include "OgreOldNode.h"
 #include "OgreLodStrategyManager.h"
@@ -77,6 +85,14 @@ THE SOFTWARE.
 #include "Compositor/Pass/PassScene/OgreCompositorPassSceneDef.h"
 #include "Threading/OgreBarrier.h"
 #include "Threading/OgreUniformScalableTask.h"
+#include "Threading/OgreWorkStealingScheduler.h"
+#include "Threading/OgreFrameTaskGraph.h"
+#include "OgreHiZBuffer.h"
+#include "OgrePortalZoneManager.h"
+#include "Math/Array/OgreObjectDataBvh.h"
+#include "Math/Array/OgreArrayRay.h"
+#include "Math/Array/OgreArraySphere.h"
+#include "Math/Array/OgreBooleanMask.h"
 
 // This class implements the most basic scene manager
 
@@ -91,12 +107,156 @@ uint32 SceneManager::QUERY_STATICGEOMETRY_DEFAULT_MASK = 0x20000000;
 uint32 SceneManager::QUERY_LIGHT_DEFAULT_MASK          = 0x10000000;
 uint32 SceneManager::QUERY_FRUSTUM_DEFAULT_MASK        = 0x08000000;
 //-----------------------------------------------------------------------
+class SceneManager::FrameStageTask : public FrameTask
+{
+    SceneManager    *mSceneManager;
+    FrameStage      mStage;
+
+    /// FrameStageTransforms: memory manager & depth of the current pass
+    size_t          mCurrentManager;
+    size_t          mCurrentDepth;
+    Transform       mTransform;
+    size_t          mNumNodes;
+    bool            mDirtyTracking;
+
+    ObjectDataSegmentArray  mObjectDataSegments;
+    SkeletonSegmentArray    mSkeletonSegments;
+    TagPointSegmentArray    mTagPointSegments;
+
+    bool beginNodePass( const NodeMemoryManagerVec &nodeMemoryManagers, size_t passIdx,
+                        size_t &outNumChunks )
+    {
+        if( passIdx == 0 )
+        {
+            mCurrentManager = 0;
+            mCurrentDepth   = getStartDepth( nodeMemoryManagers, 0 );
+        }
+        else
+        {
+            ++mCurrentDepth;
+        }
+
+        //We need to go depth by depth because
+        //we may depend on parents which could be processed by different threads.
+        while( mCurrentManager < nodeMemoryManagers.size() &&
+               mCurrentDepth >= nodeMemoryManagers[mCurrentManager]->getNumDepths() )
+        {
+            ++mCurrentManager;
+            mCurrentDepth = getStartDepth( nodeMemoryManagers, mCurrentManager );
+        }
+
+        if( mCurrentManager >= nodeMemoryManagers.size() )
+            return false;
+
+        mNumNodes = nodeMemoryManagers[mCurrentManager]->getFirstNode( mTransform, mCurrentDepth );
+        mDirtyTracking = mStage == FrameStageTransforms &&
+                         nodeMemoryManagers[mCurrentManager]->getDirtyTracking();
+        outNumChunks = (mNumNodes + mSceneManager->mNumObjsPerChunk - 1u) /
+                       mSceneManager->mNumObjsPerChunk;
+        return true;
+    }
+
+    size_t getStartDepth( const NodeMemoryManagerVec &nodeMemoryManagers, size_t idx ) const
+    {
+        //Start from the zeroth level (root) unless static (start from first dirty)
+        if( mStage == FrameStageTransforms && idx < nodeMemoryManagers.size() &&
+            nodeMemoryManagers[idx]->getMemoryManagerType() == SCENE_STATIC )
+        {
+            return mSceneManager->mStaticMinDepthLevelDirty;
+        }
+        return 0;
+    }
+
+public:
+    FrameStageTask( SceneManager *sceneManager, FrameStage stage ) :
+        mSceneManager( sceneManager ),
+        mStage( stage ),
+        mCurrentManager( 0 ),
+        mCurrentDepth( 0 ),
+        mNumNodes( 0 ),
+        mDirtyTracking( false )
+    {
+    }
+
+    virtual bool beginPass( size_t passIdx, size_t &outNumChunks )
+    {
+        switch( mStage )
+        {
+        case FrameStageTransforms:
+            return beginNodePass( mSceneManager->mNodeMemoryManagerUpdateList, passIdx, outNumChunks );
+        case FrameStageTagPoints:
+            if( passIdx > 0 )
+                return false;
+            outNumChunks = buildTagPointSegments(
+                               mSceneManager->mTagPointNodeMemoryManagerUpdateList,
+                               mSceneManager->mNumObjsPerChunk, mTagPointSegments );
+            return true;
+        case FrameStageSkeletalAnimations:
+            if( passIdx > 0 )
+                return false;
+            outNumChunks = buildSkeletonSegments( mSceneManager->mSkeletonAnimManagerCulledList,
+                                                  mSkeletonSegments );
+            return true;
+        case FrameStageObjectBounds:
+        case FrameStageLightBounds:
+            if( passIdx > 0 )
+                return false;
+            outNumChunks = buildObjectDataSegments(
+                               mStage == FrameStageObjectBounds ?
+                                   mSceneManager->mEntitiesMemoryManagerUpdateList :
+                                   mSceneManager->mLightsMemoryManagerCulledList,
+                               0, std::numeric_limits<size_t>::max(),
+                               mSceneManager->mNumObjsPerChunk, mObjectDataSegments );
+            return true;
+        case NumFrameStages:
+            break;
+        }
+
+        return false;
+    }
+
+    virtual void execute( size_t passIdx, size_t chunkIdx, size_t threadIdx )
+    {
+        const size_t numObjsPerChunk = mSceneManager->mNumObjsPerChunk;
+
+        switch( mStage )
+        {
+        case FrameStageTransforms:
+        {
+            Transform t( mTransform );
+            const size_t toAdvance = chunkIdx * numObjsPerChunk;
+            const size_t numNodes = std::min( numObjsPerChunk, mNumNodes - toAdvance );
+            t.advancePack( toAdvance / ARRAY_PACKED_REALS );
+
+            if( mDirtyTracking )
+                Node::updateDirtyTransforms( numNodes, t );
+            else
+                Node::updateAllTransforms( numNodes, t );
+            break;
+        }
+        case FrameStageTagPoints:
+            updateTagPointChunk( mTagPointSegments, chunkIdx, numObjsPerChunk );
+            break;
+        case FrameStageSkeletalAnimations:
+            mSceneManager->updateSkeletonChunk( mSkeletonSegments, chunkIdx );
+            break;
+        case FrameStageObjectBounds:
+        case FrameStageLightBounds:
+            mSceneManager->updateBoundsChunk( mObjectDataSegments, chunkIdx );
+            break;
+        case NumFrameStages:
+            break;
+        }
+    }
+};
+//-----------------------------------------------------------------------
 SceneManager::SceneManager( const String& name, size_t numWorkerThreads ) :
 IdObject( Id::generateNewId<SceneManager>() ),
 mNumDecals( 0 ),
 mNumCubemapProbes( 0 ),
 mStaticMinDepthLevelDirty( 0 ),
 mStaticEntitiesDirty( true ),
+mStaticSceneVersion( 0 ),
 mPrePassMode( PrePassNone ),
 mSsrTexture( 0 ),
 mRefractionsTexture( 0 ),
@@ -105,6 +265,11 @@ mRenderQueue( 0 ),
 mForwardPlusSystem( 0 ),
 mForwardPlusImpl( 0 ),
 mBuildLegacyLightList( false ),
+mPortalZoneManager( 0 ),
+mIncrementalLegacyLightList( false ),
+mLegacyLightListCacheValid( false ),
+mLegacyLightListStaticGeneration( 0 ),
+mLegacyLightListRequestDirtySpheres( 0 ),
 mDecalsDiffuseTex( 0 ),
 mDecalsNormalsTex( 0 ),
 mDecalsEmissiveTex( 0 ),
@@ -149,6 +314,25 @@ mUpdateBoundsRequest( 0 ),
 mUserTask( 0 ),
 mRequestType( NUM_REQUESTS ),
 mWorkerThreadsBarrier( 0 ),
+mWorkStealingScheduler( 0 ),
+mNumObjsPerChunk( 256u ),
+mFrameTaskGraph( 0 ),
+mFrameTaskGraphEnabled( false ),
+mIncrementalBoundsUpdate( false ),
+mCpuTimer( 0 ),
+mParallelParticleSystemUpdates( false ),
+mStaticCullCacheEnabled( false ),
+mStaticObjectsGeneration( 0 ),
+mCurrentStaticCullCache( 0 ),
+mReusingStaticCullCache( false ),
+mBatchedShadowCulling( false ),
+mBatchedCubemapCulling( false ),
+mCurrentBatchedCullResult( 0 ),
+mStaticCullBvhEnabled( false ),
+mDefragmentMaxSlotsPerFrame( 0 ),
+mDefragmentMaxMicrosecondsPerFrame( 0 ),
+mDefragmentNextPool( 0 ),
+mLodValuesGeneration( LodStrategy::_getLodValuesGeneration() ),
 mSuppressRenderStateChanges(false),
 mLastLightHash(0),
 mLastLightLimit(0),
@@ -160,6 +344,7 @@ mGpuParamsDirty((uint16)GPV_ALL)
     mSceneDummy = 0;
 
     memset( mAmbientSphericalHarmonics, 0, sizeof( mAmbientSphericalHarmonics ) );
+    memset( &mCpuTimings, 0, sizeof( mCpuTimings ) );
 
     setAmbientLight( ColourValue::Black, ColourValue::Black, Vector3::UNIT_Y, 1.0f );
 
@@ -184,6 +369,28 @@ mGpuParamsDirty((uint16)GPV_ALL)
     mBuildLightListRequestPerThread.resize( mNumWorkerThreads );
     mVisibleObjects.resize( mNumWorkerThreads );
     mTmpVisibleObjects.resize( mNumWorkerThreads );
+    mStaticCullCacheCapture.resize( mNumWorkerThreads );
+    mCullFrustumBatchCapture.resize( mNumWorkerThreads * MovableObject::c_maxCullFrustumBatch );
+    mCullBvhVisiblePacks.resize( mNumWorkerThreads );
+
+    mWorkStealingScheduler = new WorkStealingScheduler( mNumWorkerThreads );
+
+    mNodeAnimationEvaluator = OGRE_NEW v1::NodeAnimationEvaluator();
+
+    mFrameTaskGraph = OGRE_NEW FrameTaskGraph();
+    for( size_t i=0; i<NumFrameStages; ++i )
+    {
+        mFrameStageTasks[i] = new FrameStageTask( this, static_cast<FrameStage>( i ) );
+        mFrameTaskGraph->addTask( mFrameStageTasks[i] );
+    }
+    mFrameTaskGraph->addDependency( mFrameStageTasks[FrameStageSkeletalAnimations],
+                                    mFrameStageTasks[FrameStageTransforms] );
+    mFrameTaskGraph->addDependency( mFrameStageTasks[FrameStageTagPoints],
+                                    mFrameStageTasks[FrameStageSkeletalAnimations] );
+    mFrameTaskGraph->addDependency( mFrameStageTasks[FrameStageObjectBounds],
+                                    mFrameStageTasks[FrameStageTagPoints] );
+    mFrameTaskGraph->addDependency( mFrameStageTasks[FrameStageLightBounds],
+                                    mFrameStageTasks[FrameStageTransforms] );
 
     startWorkerThreads();
 
@@ -232,10 +439,18 @@ mGpuParamsDirty((uint16)GPV_ALL)
 //-----------------------------------------------------------------------
 SceneManager::~SceneManager()
 {
+    destroyAllItemPools();
+
+    while( !mSceneCommandQueues.empty() )
+        destroySceneCommandQueue( mSceneCommandQueues.back() );
+
     OGRE_DELETE mForwardPlusSystem;
     mForwardPlusSystem  = 0;
     mForwardPlusImpl    = 0;
 
+    OGRE_DELETE mPortalZoneManager;
+    mPortalZoneManager = 0;
+
     OGRE_DELETE mSky;
     mSky = 0;
 
@@ -272,6 +487,22 @@ SceneManager::~SceneManager()
     mAutoParamDataSource    = 0;
 
     stopWorkerThreads();
+
+    delete mWorkStealingScheduler;
+    mWorkStealingScheduler = 0;
+
+    OGRE_DELETE mNodeAnimationEvaluator;
+    mNodeAnimationEvaluator = 0;
+
+    destroyStaticCullBvhs();
+
+    OGRE_DELETE mFrameTaskGraph;
+    mFrameTaskGraph = 0;
+    for( size_t i=0; i<NumFrameStages; ++i )
+    {
+        delete mFrameStageTasks[i];
+        mFrameStageTasks[i] = 0;
+    }
 }
 //-----------------------------------------------------------------------
 SceneManager::MovableObjectVec SceneManager::findMovableObjects( const String& type, const String& name )
@@ -357,6 +588,9 @@ void SceneManager::destroyCamera(Camera *cam)
             efficientVectorRemove( mCubeMapCameras, it );
     }
 
+    mStaticCullCaches.erase( cam );
+    mBatchedCullResults.erase( cam );
+
     IdString camName( cam->getName() );
 
     // Find in list
@@ -487,6 +721,57 @@ void SceneManager::shrinkToFitMemoryPools(void)
     mTagPointNodeMemoryManager.shrinkToFit();
 }
 //-----------------------------------------------------------------------
+void SceneManager::setIncrementalDefragmentation( size_t maxSlotsPerFrame,
+                                                  uint64 maxMicrosecondsPerFrame )
+{
+    mDefragmentMaxSlotsPerFrame         = maxSlotsPerFrame;
+    mDefragmentMaxMicrosecondsPerFrame  = maxMicrosecondsPerFrame;
+}
+//-----------------------------------------------------------------------
+void SceneManager::defragmentMemoryPoolsIncremental(void)
+{
+    //Nodes, Entities & Forward+ for each type, plus lights & tag points.
+    //Skeletons are excluded for the same reasons as in defragmentMemoryPools
+    const size_t numPools = NUM_SCENE_MEMORY_MANAGER_TYPES * 3u + 2u;
+
+    Timer *timer = 0;
+    uint64 deadline = 0;
+    if( mDefragmentMaxMicrosecondsPerFrame )
+    {
+        timer = Root::getSingleton().getTimer();
+        deadline = timer->getMicroseconds() + mDefragmentMaxMicrosecondsPerFrame;
+    }
+
+    ArrayMemoryManager::DefragmentBudget budget( mDefragmentMaxSlotsPerFrame, timer, deadline );
+
+    for( size_t i=0; i<numPools && !budget.isExhausted(); ++i )
+    {
+        const size_t poolIdx = (mDefragmentNextPool + i) % numPools;
+        const size_t sceneType = poolIdx % NUM_SCENE_MEMORY_MANAGER_TYPES;
+
+        switch( poolIdx / NUM_SCENE_MEMORY_MANAGER_TYPES )
+        {
+        case 0:
+            mNodeMemoryManager[sceneType].defragmentIncremental( budget );
+            break;
+        case 1:
+            mEntityMemoryManager[sceneType].defragmentIncremental( budget );
+            break;
+        case 2:
+            mForwardPlusMemoryManager[sceneType].defragmentIncremental( budget );
+            break;
+        default:
+            if( poolIdx == NUM_SCENE_MEMORY_MANAGER_TYPES * 3u )
+                mLightMemoryManager.defragmentIncremental( budget );
+            else
+                mTagPointNodeMemoryManager.defragmentIncremental( budget );
+            break;
+        }
+    }
+
+    mDefragmentNextPool = (mDefragmentNextPool + 1u) % numPools;
+}
+//-----------------------------------------------------------------------
 Item* SceneManager::createItem( const String& meshName,
                                 const String& groupName, /* = ResourceGroupManager::AUTODETECT_RESOURCE_GROUP_NAME */
                                 SceneMemoryMgrTypes sceneType /*= SCENE_DYNAMIC */ )
@@ -512,9 +797,61 @@ void SceneManager::destroyItem( Item *i )
 //-----------------------------------------------------------------------
 void SceneManager::destroyAllItems(void)
 {
+    //Pooled Items go first, so their nodes get destroyed too
+    ItemPoolArray::const_iterator itor = mItemPools.begin();
+    ItemPoolArray::const_iterator end  = mItemPools.end();
+    while( itor != end )
+    {
+        (*itor)->_destroyAllInstances();
+        ++itor;
+    }
+
     destroyAllMovableObjectsByType(ItemFactory::FACTORY_TYPE_NAME);
 }
 //-----------------------------------------------------------------------
+ItemPool* SceneManager::createItemPool( const MeshPtr &mesh, size_t numPreallocated,
+                                        SceneMemoryMgrTypes sceneType )
+{
+    ItemPool *itemPool = OGRE_NEW ItemPool( this, mesh, sceneType );
+    mItemPools.push_back( itemPool );
+    itemPool->reserve( numPreallocated );
+    return itemPool;
+}
+//-----------------------------------------------------------------------
+ItemPool* SceneManager::createItemPool( const String &meshName, const String &groupName,
+                                        size_t numPreallocated, SceneMemoryMgrTypes sceneType )
+{
+    MeshPtr mesh = MeshManager::getSingleton().load( meshName, groupName );
+    return createItemPool( mesh, numPreallocated, sceneType );
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroyItemPool( ItemPool *itemPool )
+{
+    ItemPoolArray::iterator itor = std::find( mItemPools.begin(), mItemPools.end(), itemPool );
+    if( itor == mItemPools.end() )
+    {
+        OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                     "ItemPool was not created by this SceneManager or was already destroyed",
+                     "SceneManager::destroyItemPool" );
+    }
+
+    efficientVectorRemove( mItemPools, itor );
+    OGRE_DELETE itemPool;
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroyAllItemPools(void)
+{
+    ItemPoolArray::const_iterator itor = mItemPools.begin();
+    ItemPoolArray::const_iterator end  = mItemPools.end();
+    while( itor != end )
+    {
+        OGRE_DELETE *itor;
+        ++itor;
+    }
+
+    mItemPools.clear();
+}
+//-----------------------------------------------------------------------
 WireAabb* SceneManager::createWireAabb(void)
 {
     return static_cast<WireAabb*>( createMovableObject( WireAabbFactory::FACTORY_TYPE_NAME,
@@ -759,6 +1096,18 @@ void SceneManager::destroyAllParticleSystems(void)
 void SceneManager::clearScene( bool deleteIndestructibleToo, bool reattachCameras )
 {
     destroyAllStaticGeometry();
+
+    {
+        //The pools survive, but their Items & nodes are gone
+        ItemPoolArray::const_iterator itor = mItemPools.begin();
+        ItemPoolArray::const_iterator end  = mItemPools.end();
+        while( itor != end )
+        {
+            (*itor)->_destroyAllInstances();
+            ++itor;
+        }
+    }
+
     destroyAllMovableObjects();
 
     // Clear root node of all children
@@ -769,6 +1118,16 @@ void SceneManager::clearScene( bool deleteIndestructibleToo, bool reattachCamera
         getRootSceneNode(currentMgrType)->detachAllObjects();
     }
 
+    {
+        SceneCommandQueueArray::const_iterator itor = mSceneCommandQueues.begin();
+        SceneCommandQueueArray::const_iterator end  = mSceneCommandQueues.end();
+        while( itor != end )
+        {
+            (*itor)->_notifySceneCleared();
+            ++itor;
+        }
+    }
+
     SceneNodeList newSceneNodeList;
 
     // Delete all SceneNodes, except root that is
@@ -883,6 +1242,17 @@ void SceneManager::destroySceneNode( SceneNode* sn )
             "created with this SceneManager)", "SceneManager::destroySceneNode");
     }
 
+    {
+        //Queues may still refer to it by Id
+        SceneCommandQueueArray::const_iterator itor = mSceneCommandQueues.begin();
+        SceneCommandQueueArray::const_iterator end  = mSceneCommandQueues.end();
+        while( itor != end )
+        {
+            (*itor)->_notifySceneNodeDestroyed( sn );
+            ++itor;
+        }
+    }
+
 	{
 		// For any scene nodes which are tracking this node
 		// (or if this node is a tracker), remove its entry.
@@ -921,6 +1291,69 @@ void SceneManager::destroySceneNode( SceneNode* sn )
         (*itor)->mGlobalIndex = itor - mSceneNodes.begin();
 }
 //-----------------------------------------------------------------------
+SceneNode* SceneManager::_createSceneNodeWithId( IdType id, SceneNode *parent,
+                                                 SceneMemoryMgrTypes sceneType )
+{
+    SceneNode *sn = OGRE_NEW SceneNode( id, this, &mNodeMemoryManager[sceneType], 0 );
+    if( sceneType == SCENE_STATIC )
+        notifyStaticDirty( sn );
+    mSceneNodes.push_back( sn );
+    sn->mGlobalIndex = mSceneNodes.size() - 1;
+
+    if( !parent )
+        parent = mSceneRoot[sceneType];
+    parent->addChild( sn );
+
+    return sn;
+}
+//-----------------------------------------------------------------------
+Item* SceneManager::_createItemWithId( IdType id, const String &meshName,
+                                       const String &groupName, SceneMemoryMgrTypes sceneType )
+{
+    NameValuePairList params;
+    params["mesh"] = meshName;
+    params["resourceGroup"] = groupName;
+    return static_cast<Item*>( createMovableObjectWithId( id, ItemFactory::FACTORY_TYPE_NAME,
+                                                          &mEntityMemoryManager[sceneType],
+                                                          &params ) );
+}
+//-----------------------------------------------------------------------
+SceneCommandQueue* SceneManager::createSceneCommandQueue( IdType numReservedIds )
+{
+    SceneCommandQueue *queue = OGRE_NEW SceneCommandQueue( this, numReservedIds );
+    mSceneCommandQueues.push_back( queue );
+    return queue;
+}
+//-----------------------------------------------------------------------
+void SceneManager::destroySceneCommandQueue( SceneCommandQueue *queue )
+{
+    SceneCommandQueueArray::iterator itor = std::find( mSceneCommandQueues.begin(),
+                                                       mSceneCommandQueues.end(), queue );
+    if( itor == mSceneCommandQueues.end() )
+    {
+        OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                     "SceneCommandQueue was not created by this SceneManager or was "
+                     "already destroyed", "SceneManager::destroySceneCommandQueue" );
+    }
+
+    //Keep the execution order of the remaining queues
+    mSceneCommandQueues.erase( itor );
+    OGRE_DELETE queue;
+}
+//-----------------------------------------------------------------------
+void SceneManager::executeSceneCommandQueues(void)
+{
+    SceneCommandQueueArray::const_iterator itor = mSceneCommandQueues.begin();
+    SceneCommandQueueArray::const_iterator end  = mSceneCommandQueues.end();
+
+    while( itor != end )
+    {
+        (*itor)->_execute();
+        (*itor)->_reserveIds();
+        ++itor;
+    }
+}
+//-----------------------------------------------------------------------
 SceneNode* SceneManager::getRootSceneNode( SceneMemoryMgrTypes sceneType )
 {
     return mSceneRoot[sceneType];
@@ -1160,6 +1593,30 @@ void SceneManager::setForwardClustered( bool bEnable, uint32 width, uint32 heigh
     }
 }
 //-----------------------------------------------------------------------
+void SceneManager::setCpuTiming( bool bEnable )
+{
+    mCpuTimer = bEnable ? Root::getSingleton().getTimer() : 0;
+    memset( &mCpuTimings, 0, sizeof( mCpuTimings ) );
+}
+//-----------------------------------------------------------------------
+uint64 SceneManager::_getCpuTime(void) const
+{
+    return mCpuTimer ? mCpuTimer->getMicroseconds() : 0;
+}
+//-----------------------------------------------------------------------
+void SceneManager::setPortalZonesEnabled( bool bEnable )
+{
+    if( bEnable && !mPortalZoneManager )
+    {
+        mPortalZoneManager = OGRE_NEW PortalZoneManager();
+    }
+    else if( !bEnable )
+    {
+        OGRE_DELETE mPortalZoneManager;
+        mPortalZoneManager = 0;
+    }
+}
+//-----------------------------------------------------------------------
 void SceneManager::_setForwardPlusEnabledInPass( bool bEnable )
 {
     if( bEnable )
@@ -1171,6 +1628,14 @@ void SceneManager::_setForwardPlusEnabledInPass( bool bEnable )
 void SceneManager::setBuildLegacyLightList( bool bEnable )
 {
     mBuildLegacyLightList = bEnable;
+    mLegacyLightListCacheValid = false;
+}
+//-----------------------------------------------------------------------
+void SceneManager::setIncrementalLegacyLightList( bool bEnable )
+{
+    mIncrementalLegacyLightList = bEnable;
+    mLegacyLightListCacheValid = false;
+    mLegacyLightStatePrev.clear();
 }
 //-----------------------------------------------------------------------
 void SceneManager::_setPrePassMode( PrePassMode mode, const TextureGpuVec &prepassTextures,
@@ -1295,8 +1760,9 @@ void SceneManager::_cullPhase01( Camera *cullCamera, Camera *renderCamera, const
             uint8 realFirstRq= firstRq;
             uint8 realLastRq = 0;
             {
-                ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
-                ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
+                const ObjectMemoryManagerVec &culledList = mEntitiesMemoryManagerCulledList;
+                ObjectMemoryManagerVec::const_iterator itor = culledList.begin();
+                ObjectMemoryManagerVec::const_iterator end  = culledList.end();
                 while( itor != end )
                 {
                     realFirstRq = std::min<uint8>( realFirstRq, (*itor)->_getTotalRenderQueues() );
@@ -1314,7 +1780,64 @@ void SceneManager::_cullPhase01( Camera *cullCamera, Camera *renderCamera, const
             CullFrustumRequest cullRequest( realFirstRq, realLastRq,
                                             mIlluminationStage == IRS_RENDER_TO_TEXTURE, true, false,
                                             &mEntitiesMemoryManagerCulledList, cullCamera, lodCamera );
-            fireCullFrustumThreads( cullRequest );
+
+            if( mPortalZoneManager && !cullRequest.casterPass )
+                mPortalZoneManager->_updateVisibleZones( cullCamera );
+
+            mCurrentBatchedCullResult = 0;
+            BatchedCullResultMap::iterator itBatched = mBatchedCullResults.find( cullCamera );
+            BatchedCullResultVec::iterator itResult, enResult;
+            if( itBatched != mBatchedCullResults.end() )
+            {
+                //Find the one culled with the current view (i.e. the right cubemap face)
+                itResult = itBatched->second.begin();
+                enResult = itBatched->second.end();
+                const Matrix4 &viewMatrix = cullCamera->getViewMatrix( true );
+                while( itResult != enResult &&
+                       (!itResult->valid || itResult->viewMatrix != viewMatrix) )
+                {
+                    ++itResult;
+                }
+            }
+
+            if( itBatched != mBatchedCullResults.end() && itResult != enResult )
+            {
+                //Results are one-shot
+                BatchedCullResult &batched = *itResult;
+                batched.valid = false;
+                if( batched.projectionMatrix == cullCamera->getProjectionMatrix() &&
+                    batched.lodCamera == lodCamera &&
+                    batched.casterPass == cullRequest.casterPass &&
+                    batched.casterPass == ((cullCamera->getLastViewport()->getVisibilityMask() &
+                                            VisibilityFlags::LAYER_SHADOW_CASTER) != 0) &&
+                    !cullCamera->getCullingFrustum() &&
+                    (cullRequest.casterPass || !cullCamera->getHiZBuffer() ||
+                     !cullCamera->getHiZBuffer()->isValid()) )
+                {
+                    mCurrentBatchedCullResult = &batched;
+                }
+            }
+
+            const uint64 cullStartTime = _getCpuTime();
+            if( mCurrentBatchedCullResult )
+            {
+                //Already culled by cullFrustumBatch. Only replay the results.
+                mCurrentCullFrustumRequest = cullRequest;
+                mRequestType = CULL_FRUSTUM;
+                mObjectDataSegments.clear();
+                mWorkStealingScheduler->reset( 0 );
+                fireWorkerThreadsAndWait();
+                mCurrentBatchedCullResult = 0;
+            }
+            else
+            {
+                prepareStaticCullCache( cullRequest );
+                fireCullFrustumThreads( cullRequest );
+                finishStaticCullCache();
+            }
+            mCpuTimings.cullFrustum += _getCpuTime() - cullStartTime;
+
+            collectCullMetrics( realFirstRq, realLastRq );
         }
     } // end lock on scene graph mutex
     else
@@ -1336,6 +1859,46 @@ void SceneManager::_cullPhase01( Camera *cullCamera, Camera *renderCamera, const
     Root::getSingleton()._popCurrentSceneManager(this);
 }
 //-----------------------------------------------------------------------
+void SceneManager::collectCullMetrics( uint8 firstRq, uint8 lastRq )
+{
+    FrameMetrics *frameMetrics = Root::getSingleton().getFrameMetrics();
+
+    for( uint8 rqId=firstRq; rqId<lastRq; ++rqId )
+    {
+        size_t numVisible = 0;
+        VisibleObjectsPerThreadArray::const_iterator itThread = mVisibleObjects.begin();
+        VisibleObjectsPerThreadArray::const_iterator enThread = mVisibleObjects.end();
+        while( itThread != enThread )
+        {
+            //Threads that didn't do culling may not have been resized
+            if( rqId < itThread->size() )
+                numVisible += (*itThread)[rqId].size();
+            ++itThread;
+        }
+
+        //This may count a few empty (fragmented) slots as culled objects
+        size_t numObjs = 0;
+        ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
+        ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
+        while( itor != end )
+        {
+            if( rqId < (*itor)->_getTotalRenderQueues() )
+            {
+                ObjectData objData;
+                numObjs += (*itor)->getFirstObjectData( objData, rqId );
+            }
+            ++itor;
+        }
+
+        if( numObjs || numVisible )
+        {
+            frameMetrics->_addCullResults( rqId, static_cast<uint32>( numVisible ),
+                                           static_cast<uint32>( numObjs - std::min( numObjs,
+                                                                                    numVisible ) ) );
+        }
+    }
+}
+//-----------------------------------------------------------------------
 void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera,
                                   uint8 firstRq, uint8 lastRq, bool includeOverlays)
 {
@@ -1461,8 +2024,10 @@ void SceneManager::_renderPhase02(Camera* camera, const Camera *lodCamera,
         //_renderVisibleObjects();
         OgreProfileGroup( "RenderQueue", OGREPROF_RENDERING );
         //TODO: RENDER QUEUE Add Dual Paraboloid mapping
+        const uint64 startTime = _getCpuTime();
         mRenderQueue->render( mDestRenderSystem, firstRq, lastRq,
                               mIlluminationStage == IRS_RENDER_TO_TEXTURE, false );
+        mCpuTimings.renderQueueRender += _getCpuTime() - startTime;
     }
 
     //Restore vertex winding
@@ -1594,6 +2159,7 @@ void SceneManager::setWorldGeometry(DataStreamPtr& stream,
 void SceneManager::notifyStaticAabbDirty( MovableObject *movableObject )
 {
     mStaticEntitiesDirty = true;
+    ++mStaticSceneVersion;
     movableObject->_notifyStaticDirty();
 }
 //-----------------------------------------------------------------------
@@ -1602,13 +2168,62 @@ void SceneManager::notifyStaticDirty( Node *node )
     assert( node->isStatic() );
 
     mStaticMinDepthLevelDirty = std::min<uint16>( mStaticMinDepthLevelDirty, node->getDepthLevel() );
+    ++mStaticSceneVersion;
     node->_notifyStaticDirty();
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllAnimationsThread( size_t threadIdx )
 {
-    SkeletonAnimManagerVec::const_iterator it = mSkeletonAnimManagerCulledList.begin();
-    SkeletonAnimManagerVec::const_iterator en = mSkeletonAnimManagerCulledList.end();
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+        updateSkeletonChunk( mSkeletonSegments, chunkIdx );
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateSkeletonChunk( const SkeletonSegmentArray &segments, size_t chunkIdx )
+{
+    SkeletonSegmentArray::const_iterator itSegment =
+            std::upper_bound( segments.begin(), segments.end(),
+                              chunkIdx, SkeletonSegment::OrderByFirstChunk ) - 1u;
+
+    BySkeletonDef &bySkeletonDef = *itSegment->bySkeletonDef;
+    const size_t localChunk = chunkIdx - itSegment->firstChunk;
+
+    const size_t firstSkeleton  = bySkeletonDef.chunkStarts[localChunk];
+    const size_t lastSkeleton   = bySkeletonDef.chunkStarts[localChunk+1u];
+
+    //Instances evaluated by a GpuSkeletonEvaluator are skipped. They split
+    //the chunk into ranges (which are still contiguous in memory)
+    //Instances with identical animation state share their sampled pose within the chunk
+    SkeletonPoseCache poseCache;
+    size_t cpuRangeStart = firstSkeleton;
+    for( size_t i=firstSkeleton; i<lastSkeleton; ++i )
+    {
+        SkeletonInstance *skeleton = bySkeletonDef.skeletons[i];
+        if( skeleton->_isEvaluatedOnCpu() )
+        {
+            skeleton->update( &poseCache );
+        }
+        else
+        {
+            if( cpuRangeStart != i )
+                updateAnimationTransforms( bySkeletonDef, cpuRangeStart, i );
+            cpuRangeStart = i + 1u;
+        }
+    }
+
+    if( cpuRangeStart != lastSkeleton )
+        updateAnimationTransforms( bySkeletonDef, cpuRangeStart, lastSkeleton );
+}
+//-----------------------------------------------------------------------
+size_t SceneManager::buildSkeletonSegments( const SkeletonAnimManagerVec &skeletonAnimManagers,
+                                            SkeletonSegmentArray &outSegments )
+{
+    outSegments.clear();
+
+    size_t numChunks = 0;
+
+    SkeletonAnimManagerVec::const_iterator it = skeletonAnimManagers.begin();
+    SkeletonAnimManagerVec::const_iterator en = skeletonAnimManagers.end();
 
     while( it != en )
     {
@@ -1617,27 +2232,26 @@ void SceneManager::updateAllAnimationsThread( size_t threadIdx )
 
         while( itByDef != enByDef )
         {
-            FastArray<SkeletonInstance*>::iterator itor = itByDef->skeletons.begin() +
-                                                                    itByDef->threadStarts[threadIdx];
-            FastArray<SkeletonInstance*>::iterator end  = itByDef->skeletons.begin() +
-                                                                    itByDef->threadStarts[threadIdx+1];
-            while( itor != end )
+            if( !itByDef->skeletons.empty() )
             {
-                (*itor)->update();
-                ++itor;
+                SkeletonSegment segment;
+                segment.bySkeletonDef   = &(*itByDef);
+                segment.firstChunk      = numChunks;
+                outSegments.push_back( segment );
+                numChunks += itByDef->chunkStarts.size() - 1u;
             }
 
-            if( !itByDef->skeletons.empty() )
-                updateAnimationTransforms( *itByDef, threadIdx );
-
             ++itByDef;
         }
 
         ++it;
     }
+
+    return numChunks;
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size_t threadIdx )
+void SceneManager::updateAnimationTransforms( BySkeletonDef &bySkeletonDef,
+                                              size_t firstSkeleton, size_t lastSkeleton )
 {
     assert( !bySkeletonDef.skeletons.empty() );
 
@@ -1655,8 +2269,8 @@ void SceneManager::updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size
     const SkeletonDef *skeletonDef                          = bySkeletonDef.skeletonDef;
     const SkeletonDef::DepthLevelInfoVec &depthLevelInfo    = skeletonDef->getDepthLevelInfo();
 
-    size_t firstIdx = bySkeletonDef.threadStarts[threadIdx];
-    size_t lastIdx  = std::min( firstIdx + magicDistance, bySkeletonDef.threadStarts[threadIdx+1] );
+    size_t firstIdx = firstSkeleton;
+    size_t lastIdx  = std::min( firstIdx + magicDistance, lastSkeleton );
     while( firstIdx != lastIdx )
     {
         SkeletonInstance *first = *(bySkeletonDef.skeletons.begin() + firstIdx);
@@ -1682,28 +2296,158 @@ void SceneManager::updateAnimationTransforms( BySkeletonDef &bySkeletonDef, size
 
         firstIdx = lastIdx;
         lastIdx += magicDistance;
-        lastIdx = std::min( lastIdx, bySkeletonDef.threadStarts[threadIdx+1] );
+        lastIdx = std::min( lastIdx, lastSkeleton );
     }
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllAnimations()
 {
-    mRequestType = UPDATE_ALL_ANIMATIONS;
-    fireWorkerThreadsAndWait();
+    const size_t numChunks = buildSkeletonSegments( mSkeletonAnimManagerCulledList,
+                                                    mSkeletonSegments );
+    if( numChunks )
+    {
+        mWorkStealingScheduler->reset( numChunks );
+        mRequestType = UPDATE_ALL_ANIMATIONS;
+        fireWorkerThreadsAndWait();
+    }
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx )
+void SceneManager::_queueParticleSystemUpdate( ParticleSystem *system )
 {
-    Transform t( request.t );
-    const size_t toAdvance = std::min( threadIdx * request.numNodesPerThread,
-                                        request.numTotalNodes );
-
-    //Prevent going out of bounds (usually in the last threadIdx, or
-    //when there are less nodes than ARRAY_PACKED_REALS
-    const size_t numNodes = std::min( request.numNodesPerThread, request.numTotalNodes - toAdvance );
-    t.advancePack( toAdvance / ARRAY_PACKED_REALS );
+    mParticleSystemsToUpdate.push_back( system );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_removeParticleSystemUpdate( ParticleSystem *system )
+{
+    FastArray<ParticleSystem*>::iterator itor = std::find( mParticleSystemsToUpdate.begin(),
+                                                           mParticleSystemsToUpdate.end(), system );
+    if( itor != mParticleSystemsToUpdate.end() )
+        efficientVectorRemove( mParticleSystemsToUpdate, itor );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_queueBillboardChainUpdate( BillboardChain *billboardChain )
+{
+    mBillboardChainsToUpdate.push_back( billboardChain );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_removeBillboardChainUpdate( BillboardChain *billboardChain )
+{
+    FastArray<BillboardChain*>::iterator itor = std::find( mBillboardChainsToUpdate.begin(),
+                                                           mBillboardChainsToUpdate.end(),
+                                                           billboardChain );
+    if( itor != mBillboardChainsToUpdate.end() )
+        efficientVectorRemove( mBillboardChainsToUpdate, itor );
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateAllParticleSystemsThread( size_t threadIdx )
+{
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+        mParticleSystemsToUpdate[chunkIdx]->_executeParallelUpdate();
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateAllParticleSystems(void)
+{
+    if( mParticleSystemsToUpdate.empty() )
+        return;
+
+    OgreProfile( "updateAllParticleSystems" );
+
+    FastArray<ParticleSystem*>::const_iterator itor = mParticleSystemsToUpdate.begin();
+    FastArray<ParticleSystem*>::const_iterator end  = mParticleSystemsToUpdate.end();
+    while( itor != end )
+    {
+        (*itor)->_prepareParallelUpdate();
+        ++itor;
+    }
+
+    mWorkStealingScheduler->reset( mParticleSystemsToUpdate.size() );
+    mRequestType = UPDATE_ALL_PARTICLE_SYSTEMS;
+    fireWorkerThreadsAndWait();
+
+    mParticleSystemsToUpdate.clear();
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateAllBillboardChains(void)
+{
+    if( mBillboardChainsToUpdate.empty() )
+        return;
+
+    OgreProfile( "updateAllBillboardChains" );
+
+    //Chains may queue themselves again (to be updated next frame) from _updateGpuData
+    FastArray<BillboardChain*> billboardChains;
+    billboardChains.swap( mBillboardChainsToUpdate );
+
+    size_t totalBytes = 0;
+    FastArray<BillboardChain*>::const_iterator itor = billboardChains.begin();
+    FastArray<BillboardChain*>::const_iterator end  = billboardChains.end();
+    while( itor != end )
+    {
+        totalBytes += (*itor)->_getDirtyElementsSize();
+        ++itor;
+    }
+
+    if( totalBytes )
+    {
+        VaoManager *vaoManager = mDestRenderSystem->getVaoManager();
+        StagingBuffer *stagingBuffer = vaoManager->getStagingBuffer( totalBytes, true );
+        uint8 *stagingData = reinterpret_cast<uint8*>( stagingBuffer->map( totalBytes ) );
+
+        StagingBuffer::DestinationVec destinations;
+        size_t offset = 0;
+        itor = billboardChains.begin();
+        while( itor != end )
+        {
+            const size_t bytes = (*itor)->_getDirtyElementsSize();
+            (*itor)->_writeDirtyElements( stagingData + offset, offset, destinations );
+            offset += bytes;
+            ++itor;
+        }
+
+        stagingBuffer->unmap( destinations );
+        stagingBuffer->removeReferenceCount();
+    }
+
+    itor = billboardChains.begin();
+    while( itor != end )
+    {
+        (*itor)->_updateGpuData();
+        ++itor;
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateAllTransformsThread( const UpdateTransformRequest &request, size_t threadIdx )
+{
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+    {
+        Transform t( request.t );
+        const size_t toAdvance = chunkIdx * request.numNodesPerChunk;
+
+        //Prevent going out of bounds (usually in the last chunk, or
+        //when there are less nodes than ARRAY_PACKED_REALS
+        const size_t numNodes = std::min( request.numNodesPerChunk,
+                                          request.numTotalNodes - toAdvance );
+        t.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
-    Node::updateAllTransforms( numNodes, t );
+        if( request.dirtyTracking )
+            Node::updateDirtyTransforms( numNodes, t );
+        else
+            Node::updateAllTransforms( numNodes, t );
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::fireUpdateTransformThreads( const Transform &t, size_t numNodes,
+                                               bool dirtyTracking )
+{
+    const size_t numChunks = (numNodes + mNumObjsPerChunk - 1u) / mNumObjsPerChunk;
+    mWorkStealingScheduler->reset( numChunks );
+
+    //Send them to worker threads. We need to go depth by depth because
+    //we may depend on parents which could be processed by different threads.
+    mUpdateTransformRequest = UpdateTransformRequest( t, mNumObjsPerChunk, numNodes, dirtyTracking );
+    fireWorkerThreadsAndWait();
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllTransforms()
@@ -1726,25 +2470,18 @@ void SceneManager::updateAllTransforms()
             Transform t;
             const size_t numNodes = nodeMemoryManager->getFirstNode( t, i );
 
-            //nodesPerThread must be multiple of ARRAY_PACKED_REALS
-            size_t nodesPerThread = ( numNodes + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            nodesPerThread        = ( (nodesPerThread + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                    ARRAY_PACKED_REALS;
-
             if( numNodes )
-            {
-                //Send them to worker threads. We need to go depth by depth because
-                //we may depend on parents which could be processed by different threads.
-                mUpdateTransformRequest = UpdateTransformRequest( t, nodesPerThread, numNodes );
-                fireWorkerThreadsAndWait();
-                //Node::updateAllTransforms( numNodes, t );
-            }
+                fireUpdateTransformThreads( t, numNodes, nodeMemoryManager->getDirtyTracking() );
         }
 
         ++it;
     }
 
-    //Call all listeners
+    fireNodeUpdatedListeners();
+}
+//-----------------------------------------------------------------------
+void SceneManager::fireNodeUpdatedListeners(void)
+{
     SceneNodeList::const_iterator itor = mSceneNodesWithListeners.begin();
     SceneNodeList::const_iterator end  = mSceneNodesWithListeners.end();
 
@@ -1757,73 +2494,87 @@ void SceneManager::updateAllTransforms()
 //-----------------------------------------------------------------------
 void SceneManager::updateAllTagPoints()
 {
-    NodeMemoryManagerVec::const_iterator it = mTagPointNodeMemoryManagerUpdateList.begin();
-    NodeMemoryManagerVec::const_iterator en = mTagPointNodeMemoryManagerUpdateList.end();
+    //Every depth level goes in the same pass; deeper TagPoints don't
+    //wait for their parents. @see TagPoint::updateAllTransformsFromBone
+    const size_t numChunks = buildTagPointSegments( mTagPointNodeMemoryManagerUpdateList,
+                                                    mNumObjsPerChunk, mTagPointSegments );
+    if( numChunks )
+    {
+        mWorkStealingScheduler->reset( numChunks );
+        mRequestType = UPDATE_ALL_TAG_POINTS;
+        fireWorkerThreadsAndWait();
+    }
+}
+//-----------------------------------------------------------------------
+size_t SceneManager::buildTagPointSegments( const NodeMemoryManagerVec &nodeMemoryManagers,
+                                            size_t numNodesPerChunk,
+                                            TagPointSegmentArray &outSegments )
+{
+    outSegments.clear();
+    size_t numChunks = 0;
+
+    NodeMemoryManagerVec::const_iterator it = nodeMemoryManagers.begin();
+    NodeMemoryManagerVec::const_iterator en = nodeMemoryManagers.end();
 
     while( it != en )
     {
         NodeMemoryManager *nodeMemoryManager = *it;
         const size_t numDepths = nodeMemoryManager->getNumDepths();
 
-        //Start from the first level (not root) unless static (start from first dirty)
         for( size_t i=0; i<numDepths; ++i )
         {
-            mRequestType = i == 0 ? UPDATE_ALL_BONE_TO_TAG_TRANSFORMS :
-                                    UPDATE_ALL_TAG_ON_TAG_TRANSFORMS;
-
-            Transform t;
-            const size_t numNodes = nodeMemoryManager->getFirstNode( t, i );
-
-            //nodesPerThread must be multiple of ARRAY_PACKED_REALS
-            size_t nodesPerThread = ( numNodes + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            nodesPerThread        = ( (nodesPerThread + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                    ARRAY_PACKED_REALS;
+            TagPointSegment segment;
+            segment.numNodes    = nodeMemoryManager->getFirstNode( segment.t, i );
+            segment.depth       = i;
+            segment.firstChunk  = numChunks;
 
-            if( numNodes )
+            if( segment.numNodes )
             {
-                //Send them to worker threads. We need to go depth by depth because
-                //we may depend on parents which could be processed by different threads.
-                mUpdateTransformRequest = UpdateTransformRequest( t, nodesPerThread, numNodes );
-                fireWorkerThreadsAndWait();
+                outSegments.push_back( segment );
+                numChunks += (segment.numNodes + numNodesPerChunk - 1u) / numNodesPerChunk;
             }
         }
 
         ++it;
     }
+
+    return numChunks;
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAllTransformsBoneToTagThread( const UpdateTransformRequest &request,
-                                                       size_t threadIdx )
+void SceneManager::updateTagPointChunk( const TagPointSegmentArray &segments, size_t chunkIdx,
+                                        size_t numNodesPerChunk )
 {
-    Transform t( request.t );
-    const size_t toAdvance = std::min( threadIdx * request.numNodesPerThread,
-                                        request.numTotalNodes );
+    TagPointSegmentArray::const_iterator itSegment =
+            std::upper_bound( segments.begin(), segments.end(),
+                              chunkIdx, TagPointSegment::OrderByFirstChunk ) - 1u;
 
-    //Prevent going out of bounds (usually in the last threadIdx, or
+    Transform t( itSegment->t );
+    const size_t toAdvance = (chunkIdx - itSegment->firstChunk) * numNodesPerChunk;
+
+    //Prevent going out of bounds (usually in the last chunk, or
     //when there are less nodes than ARRAY_PACKED_REALS
-    const size_t numNodes = std::min( request.numNodesPerThread, request.numTotalNodes - toAdvance );
+    const size_t numNodes = std::min( numNodesPerChunk, itSegment->numNodes - toAdvance );
     t.advancePack( toAdvance / ARRAY_PACKED_REALS );
 
-    TagPoint::updateAllTransformsBoneToTag( numNodes, t );
+    TagPoint::updateAllTransformsFromBone( numNodes, t, itSegment->depth );
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAllTransformsTagOnTagThread( const UpdateTransformRequest &request,
-                                                      size_t threadIdx )
+void SceneManager::updateAllTagPointsThread( size_t threadIdx )
 {
-    Transform t( request.t );
-    const size_t toAdvance = std::min( threadIdx * request.numNodesPerThread,
-                                        request.numTotalNodes );
-
-    //Prevent going out of bounds (usually in the last threadIdx, or
-    //when there are less nodes than ARRAY_PACKED_REALS
-    const size_t numNodes = std::min( request.numNodesPerThread, request.numTotalNodes - toAdvance );
-    t.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-    TagPoint::updateAllTransformsTagOnTag( numNodes, t );
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+        updateTagPointChunk( mTagPointSegments, chunkIdx, mNumObjsPerChunk );
 }
 //-----------------------------------------------------------------------
-void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx )
+size_t SceneManager::buildObjectDataSegments( const ObjectMemoryManagerVec &objectMemManager,
+                                              size_t firstRq, size_t lastRq,
+                                              size_t numObjsPerChunk,
+                                              ObjectDataSegmentArray &outSegments )
 {
+    outSegments.clear();
+
+    size_t numChunks = 0;
+
     ObjectMemoryManagerVec::const_iterator it = objectMemManager.begin();
     ObjectMemoryManagerVec::const_iterator en = objectMemManager.end();
 
@@ -1832,33 +2583,113 @@ void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMe
         ObjectMemoryManager *memoryManager = *it;
         const size_t numRenderQueues = memoryManager->getNumRenderQueues();
 
-        for( size_t i=0; i<numRenderQueues; ++i )
+        const size_t realFirstRq = std::min( firstRq, numRenderQueues );
+        const size_t realLastRq  = std::min( lastRq,  numRenderQueues );
+
+        for( size_t i=realFirstRq; i<realLastRq; ++i )
         {
             ObjectData objData;
             const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
 
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
+            if( totalObjs )
+            {
+                ObjectDataSegment segment;
+                segment.memoryManager   = memoryManager;
+                segment.renderQueueId   = i;
+                segment.totalObjs       = totalObjs;
+                segment.firstChunk      = numChunks;
+                segment.bvh             = 0;
+                outSegments.push_back( segment );
+
+                numChunks += (totalObjs + numObjsPerChunk - 1u) / numObjsPerChunk;
+            }
+        }
 
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
+        ++it;
+    }
 
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
+    return numChunks;
+}
+//-----------------------------------------------------------------------
+void SceneManager::getObjectDataChunk( const ObjectDataSegmentArray &segments, size_t chunkIdx,
+                                       size_t numObjsPerChunk, ObjectData &outObjData,
+                                       size_t &outNumObjs, size_t &outRenderQueueId,
+                                       ObjectMemoryManager **outMemoryManager )
+{
+    ObjectDataSegmentArray::const_iterator itSegment =
+            std::upper_bound( segments.begin(), segments.end(),
+                              chunkIdx, ObjectDataSegment::OrderByFirstChunk ) - 1u;
 
-            MovableObject::updateAllBounds( numObjs, objData );
-        }
+    const size_t toAdvance = (chunkIdx - itSegment->firstChunk) * numObjsPerChunk;
 
-        ++it;
+    itSegment->memoryManager->getFirstObjectData( outObjData, itSegment->renderQueueId );
+    //Prevent going out of bounds (usually in the last chunk, or
+    //when there are less entities than ARRAY_PACKED_REALS
+    outNumObjs = std::min( numObjsPerChunk, itSegment->totalObjs - toAdvance );
+    outObjData.advancePack( toAdvance / ARRAY_PACKED_REALS );
+    outRenderQueueId = itSegment->renderQueueId;
+    if( outMemoryManager )
+        *outMemoryManager = itSegment->memoryManager;
+}
+//-----------------------------------------------------------------------
+void SceneManager::prepareObjectDataChunks( const ObjectMemoryManagerVec &objectMemManager,
+                                            size_t firstRq, size_t lastRq )
+{
+    const size_t numChunks = buildObjectDataSegments( objectMemManager, firstRq, lastRq,
+                                                      mNumObjsPerChunk, mObjectDataSegments );
+    mWorkStealingScheduler->reset( numChunks );
+}
+//-----------------------------------------------------------------------
+bool SceneManager::grabObjectDataChunk( size_t threadIdx, ObjectData &outObjData,
+                                        size_t &outNumObjs, size_t &outRenderQueueId )
+{
+    size_t chunkIdx;
+    if( !mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+        return false;
+
+    getObjectDataChunk( mObjectDataSegments, chunkIdx, mNumObjsPerChunk,
+                        outObjData, outNumObjs, outRenderQueueId );
+    return true;
+}
+//-----------------------------------------------------------------------
+void SceneManager::setNumObjsPerChunk( size_t numObjsPerChunk )
+{
+    mNumObjsPerChunk = std::max<size_t>( numObjsPerChunk, 1u );
+    mNumObjsPerChunk = ( (mNumObjsPerChunk + ARRAY_PACKED_REALS - 1u) / ARRAY_PACKED_REALS ) *
+                       ARRAY_PACKED_REALS;
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateAllBoundsThread( const ObjectMemoryManagerVec &objectMemManager, size_t threadIdx )
+{
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+        updateBoundsChunk( mObjectDataSegments, chunkIdx );
+}
+//-----------------------------------------------------------------------
+void SceneManager::updateBoundsChunk( const ObjectDataSegmentArray &segments, size_t chunkIdx )
+{
+    ObjectData objData;
+    size_t numObjs;
+    size_t renderQueueId;
+    ObjectMemoryManager *memoryManager;
+    getObjectDataChunk( segments, chunkIdx, mNumObjsPerChunk, objData, numObjs,
+                        renderQueueId, &memoryManager );
+
+    //Only dynamic nodes report whether they moved, and only when they track it.
+    if( mIncrementalBoundsUpdate && memoryManager->getMemoryManagerType() == SCENE_DYNAMIC &&
+        mNodeMemoryManager[SCENE_DYNAMIC].getDirtyTracking() )
+    {
+        MovableObject::updateDirtyBounds( numObjs, objData );
+    }
+    else
+    {
+        MovableObject::updateAllBounds( numObjs, objData );
     }
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllBounds( const ObjectMemoryManagerVec &objectMemManager )
 {
+    prepareObjectDataChunks( objectMemManager, 0, std::numeric_limits<size_t>::max() );
     mUpdateBoundsRequest    = &objectMemManager;
     mRequestType            = UPDATE_ALL_BOUNDS;
     fireWorkerThreadsAndWait();
@@ -1869,44 +2700,46 @@ void SceneManager::updateAllLodsThread( const UpdateLodRequest &request, size_t
     LodStrategy *lodStrategy = LodStrategyManager::getSingleton().getDefaultStrategy();
 
     const Camera *lodCamera = request.lodCamera;
-    ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
-    ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
-
-    while( it != en )
-    {
-        ObjectMemoryManager *memoryManager = *it;
-        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
 
-        size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
-        size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
+    ObjectData objData;
+    size_t numObjs;
+    size_t renderQueueId;
+    while( grabObjectDataChunk( threadIdx, objData, numObjs, renderQueueId ) )
+        lodStrategy->lodUpdateImpl( numObjs, objData, lodCamera, request.lodBias );
+}
+//-----------------------------------------------------------------------
+void SceneManager::invalidateLodRanges(void)
+{
+    ObjectMemoryManagerVec::const_iterator itor = mEntitiesMemoryManagerCulledList.begin();
+    ObjectMemoryManagerVec::const_iterator end  = mEntitiesMemoryManagerCulledList.end();
 
-        for( size_t i=firstRq; i<lastRq; ++i )
+    while( itor != end )
+    {
+        const size_t numRenderQueues = (*itor)->_getTotalRenderQueues();
+        for( size_t i=0; i<numRenderQueues; ++i )
         {
             ObjectData objData;
-            const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
-
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
-
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
+            const size_t numObjs = (*itor)->getFirstObjectData( objData, i );
 
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-            lodStrategy->lodUpdateImpl( numObjs, objData, lodCamera, request.lodBias );
+            for( size_t j=0; j<numObjs; ++j )
+            {
+                objData.mLodRangeMin[j] = std::numeric_limits<Real>::max();
+                objData.mLodRangeMax[j] = -std::numeric_limits<Real>::max();
+            }
         }
-
-        ++it;
+        ++itor;
     }
 }
 //-----------------------------------------------------------------------
 void SceneManager::updateAllLods( const Camera *lodCamera, Real lodBias, uint8 firstRq, uint8 lastRq )
 {
+    if( mLodValuesGeneration != LodStrategy::_getLodValuesGeneration() )
+    {
+        //Mesh or material LOD values changed. The ranges cached by lodSet are no longer valid
+        mLodValuesGeneration = LodStrategy::_getLodValuesGeneration();
+        invalidateLodRanges();
+    }
+
     mRequestType        = UPDATE_ALL_LODS;
     mUpdateLodRequest   = UpdateLodRequest( firstRq, lastRq, &mEntitiesMemoryManagerCulledList,
                                              lodCamera, lodCamera, lodBias );
@@ -1914,6 +2747,7 @@ void SceneManager::updateAllLods( const Camera *lodCamera, Real lodBias, uint8 f
     mUpdateLodRequest.camera->getFrustumPlanes();
     mUpdateLodRequest.lodCamera->getFrustumPlanes();
 
+    prepareObjectDataChunks( mEntitiesMemoryManagerCulledList, firstRq, lastRq );
     fireWorkerThreadsAndWait();
 }
 //-----------------------------------------------------------------------
@@ -1941,84 +2775,285 @@ void SceneManager::cullFrustum( const CullFrustumRequest &request, size_t thread
                  (camera->getLastViewport()->getVisibilityMask() &
                                     ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS));
 
-    ObjectMemoryManagerVec::const_iterator it = request.objectMemManager->begin();
-    ObjectMemoryManagerVec::const_iterator en = request.objectMemManager->end();
+    StaticCullCacheEntryArray *staticCullCacheCapture = 0;
+    if( mCurrentStaticCullCache && !mReusingStaticCullCache && !request.cullingLights )
+    {
+        staticCullCacheCapture = mStaticCullCacheCapture.begin() + threadIdx;
+        staticCullCacheCapture->clear();
+    }
 
-    while( it != en )
+    const HiZBuffer *hiZBuffer = 0;
+    if( !request.casterPass && !request.cullingLights &&
+        camera->getHiZBuffer() && camera->getHiZBuffer()->isValid() )
     {
-        ObjectMemoryManager *memoryManager = *it;
-        const size_t numRenderQueues = memoryManager->getNumRenderQueues();
+        hiZBuffer = camera->getHiZBuffer();
+    }
 
-        size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
-        size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
+    const PortalZoneManager *portalZones = getPortalZonesForRequest( request );
 
-        for( size_t i=firstRq; i<lastRq; ++i )
-        {
-            MovableObject::MovableObjectArray &outVisibleObjects = *(visibleObjectsPerRq.begin() + i);
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+    {
+        ObjectDataSegmentArray::const_iterator itSegment =
+                std::upper_bound( mObjectDataSegments.begin(), mObjectDataSegments.end(),
+                                  chunkIdx, ObjectDataSegment::OrderByFirstChunk ) - 1u;
 
+        const size_t rqId = itSegment->renderQueueId;
+        MovableObject::MovableObjectArray &outVisibleObjects = *(visibleObjectsPerRq.begin() + rqId);
+
+        const size_t firstNewObj = outVisibleObjects.size();
+        if( itSegment->bvh )
+        {
+            cullFrustumBvh( *itSegment, chunkIdx - itSegment->firstChunk, camera,
+                            visibilityMask, outVisibleObjects, lodCamera, threadIdx );
+        }
+        else
+        {
             ObjectData objData;
-            const size_t totalObjs = memoryManager->getFirstObjectData( objData, i );
+            size_t numObjs;
+            size_t dummyRqId;
+            getObjectDataChunk( mObjectDataSegments, chunkIdx, mNumObjsPerChunk,
+                                objData, numObjs, dummyRqId );
+            MovableObject::cullFrustum( numObjs, objData, camera, visibilityMask,
+                                        outVisibleObjects, lodCamera );
+        }
 
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
+        if( hiZBuffer )
+        {
+            //Remove the objects that are occluded. Keep the relative order.
+            MovableObject::MovableObjectArray::iterator itor = outVisibleObjects.begin() + firstNewObj;
+            MovableObject::MovableObjectArray::iterator end  = outVisibleObjects.end();
+            MovableObject::MovableObjectArray::iterator dst  = itor;
 
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
+            while( itor != end )
+            {
+                if( hiZBuffer->isVisible( (*itor)->getWorldAabb() ) )
+                    *dst++ = *itor;
+                ++itor;
+            }
 
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
+            outVisibleObjects.resize( static_cast<size_t>( dst - outVisibleObjects.begin() ) );
+        }
 
-            MovableObject::cullFrustum( numObjs, objData, camera, visibilityMask,
-                                        outVisibleObjects, lodCamera );
+        if( staticCullCacheCapture )
+        {
+            //Remember the static objects that passed, for the next frames.
+            MovableObject::MovableObjectArray::const_iterator itor =
+                    outVisibleObjects.begin() + firstNewObj;
+            MovableObject::MovableObjectArray::const_iterator end  = outVisibleObjects.end();
 
-            if( mRenderQueue->getRenderQueueMode(i) == RenderQueue::FAST && request.addToRenderQueue )
+            while( itor != end )
             {
-                //V2 meshes can be added to the render queue in parallel
-                bool casterPass = request.casterPass;
-                MovableObject::MovableObjectArray::const_iterator itor = outVisibleObjects.begin();
-                MovableObject::MovableObjectArray::const_iterator end  = outVisibleObjects.end();
-
-                while( itor != end )
+                if( (*itor)->isStatic() )
                 {
-                    RenderableArray::const_iterator itRend = (*itor)->mRenderables.begin();
-                    RenderableArray::const_iterator enRend = (*itor)->mRenderables.end();
-
-                    while( itRend != enRend )
-                    {
-                        mRenderQueue->addRenderableV2( threadIdx, i, casterPass, *itRend, *itor );
-                        ++itRend;
-                    }
-                    ++itor;
+                    StaticCullCacheEntry entry;
+                    entry.movableObject     = *itor;
+                    entry.distanceToCamera  = (*itor)->getCachedDistanceToCamera();
+                    entry.renderQueueId     = static_cast<uint8>( rqId );
+                    staticCullCacheCapture->push_back( entry );
                 }
+                ++itor;
+            }
+        }
+
+        if( portalZones )
+        {
+            //Remove the objects in zones not visible from the camera. Done after filling
+            //the static cull cache, since zone visibility changes don't invalidate it.
+            MovableObject::MovableObjectArray::iterator itor = outVisibleObjects.begin() + firstNewObj;
+            MovableObject::MovableObjectArray::iterator end  = outVisibleObjects.end();
+            MovableObject::MovableObjectArray::iterator dst  = itor;
+
+            while( itor != end )
+            {
+                if( portalZones->isObjectVisible( *itor ) )
+                    *dst++ = *itor;
+                ++itor;
+            }
+
+            outVisibleObjects.resize( static_cast<size_t>( dst - outVisibleObjects.begin() ) );
+        }
+
+        if( mRenderQueue->getRenderQueueMode( rqId ) == RenderQueue::FAST &&
+            request.addToRenderQueue )
+        {
+            //V2 meshes can be added to the render queue in parallel
+            bool casterPass = request.casterPass;
+            MovableObject::MovableObjectArray::const_iterator itor = outVisibleObjects.begin();
+            MovableObject::MovableObjectArray::const_iterator end  = outVisibleObjects.end();
+
+            while( itor != end )
+            {
+                SkeletonInstance *skeletonInstance = (*itor)->getSkeletonInstance();
+                if( skeletonInstance )
+                    skeletonInstance->_notifyVisible( (*itor)->getCurrentMeshLod() );
 
-                outVisibleObjects.clear();
+                addRenderablesV2( threadIdx, rqId, casterPass, *itor, request.camera );
+                ++itor;
             }
+
+            outVisibleObjects.clear();
         }
+    }
 
-        ++it;
+    if( mCurrentStaticCullCache && mReusingStaticCullCache && !request.cullingLights )
+    {
+        //Static objects weren't culled. Use the results from a previous frame.
+        addCullResultEntries( mCurrentStaticCullCache->entries, request, visibilityMask, threadIdx );
+    }
+
+    if( mCurrentBatchedCullResult && !request.cullingLights )
+    {
+        //Everything was culled by cullFrustumBatch.
+        addCullResultEntries( mCurrentBatchedCullResult->entries, request, visibilityMask,
+                              threadIdx );
     }
 }
 //-----------------------------------------------------------------------
-inline bool OrderLightByShadowCastThenId( const Light *_l, const Light *_r )
+void SceneManager::addCullResultEntries( const MovableObject::CullResultEntryArray &entries,
+                                         const CullFrustumRequest &request,
+                                         uint32 visibilityMask, size_t threadIdx )
 {
-    if( _l->getCastShadows() && !_r->getCastShadows() )
-        return true;
-    if( !_l->getCastShadows() && _r->getCastShadows() )
-        return false;
+    VisibleObjectsPerRq &visibleObjectsPerRq = *(mVisibleObjects.begin() + threadIdx);
 
-    return _l->getId() < _r->getId();
-}
+    const size_t numEntries = entries.size();
+    const size_t startIdx   = (numEntries * threadIdx) / mNumWorkerThreads;
+    const size_t endIdx     = (numEntries * (threadIdx + 1u)) / mNumWorkerThreads;
+    const bool casterPass   = request.casterPass;
+    const PortalZoneManager *portalZones = getPortalZonesForRequest( request );
 
-void quickSortDirectionalLights( LightListInfo &_globalLightList, const size_t startIdx, const size_t n )
-{
-    if( n < 2 )
-        return;
+    for( size_t i=startIdx; i<endIdx; ++i )
+    {
+        const MovableObject::CullResultEntry &entry = entries[i];
+        MovableObject *movableObject = entry.movableObject;
 
-    LightListInfo lightList;
+        //The object may have been hidden since it was culled
+        if( entry.renderQueueId < request.firstRq || entry.renderQueueId >= request.lastRq ||
+            !movableObject->getVisible() ||
+            !(movableObject->getVisibilityFlags() & visibilityMask) ||
+            (portalZones && !portalZones->isObjectVisible( movableObject )) )
+        {
+            continue;
+        }
+
+        //Other cameras may have overwritten it since
+        movableObject->_setCachedDistanceToCamera( entry.distanceToCamera );
+
+        if( mRenderQueue->getRenderQueueMode( entry.renderQueueId ) == RenderQueue::FAST &&
+            request.addToRenderQueue )
+        {
+            SkeletonInstance *skeletonInstance = movableObject->getSkeletonInstance();
+            if( skeletonInstance )
+                skeletonInstance->_notifyVisible( movableObject->getCurrentMeshLod() );
+
+            addRenderablesV2( threadIdx, entry.renderQueueId, casterPass, movableObject,
+                              request.camera );
+        }
+        else
+        {
+            visibleObjectsPerRq[entry.renderQueueId].push_back( movableObject );
+        }
+    }
+}
+//-----------------------------------------------------------------------
+void SceneManager::addRenderablesV2( size_t threadIdx, uint8 rqId, bool casterPass,
+                                     MovableObject *movableObject, const Camera *camera )
+{
+    const FastArray<Aabb> *renderableAabbs = movableObject->_getRenderableAabbs();
+    const RenderableArray &renderables = movableObject->mRenderables;
+
+    if( !renderableAabbs || casterPass || !camera || !movableObject->getParentNode() )
+    {
+        RenderableArray::const_iterator itRend = renderables.begin();
+        RenderableArray::const_iterator enRend = renderables.end();
+
+        while( itRend != enRend )
+        {
+            mRenderQueue->addRenderableV2( threadIdx, rqId, casterPass, *itRend, movableObject );
+            ++itRend;
+        }
+        return;
+    }
+
+    assert( renderableAabbs->size() == renderables.size() );
+
+    const Matrix4 &worldMat = movableObject->getParentNode()->_getFullTransform();
+    const Plane *frustumPlanes = camera->_getCachedFrustumPlanes();
+
+    const size_t numRenderables = renderables.size();
+    for( size_t i=0; i<numRenderables; ++i )
+    {
+        Aabb aabb( (*renderableAabbs)[i] );
+        aabb.transformAffine( worldMat );
+
+        bool visible = true;
+        for( size_t j=0; j<6u && visible; ++j )
+        {
+            const Plane &plane = frustumPlanes[j];
+            //Fully on the negative side of any plane means it's outside.
+            visible = plane.normal.dotProduct( aabb.mCenter ) + plane.d +
+                      plane.normal.absDotProduct( aabb.mHalfSize ) >= 0;
+        }
+
+        if( visible )
+            mRenderQueue->addRenderableV2( threadIdx, rqId, casterPass, renderables[i],
+                                           movableObject );
+    }
+}
+//-----------------------------------------------------------------------
+const PortalZoneManager* SceneManager::getPortalZonesForRequest(
+        const CullFrustumRequest &request ) const
+{
+    if( !mPortalZoneManager || request.casterPass || request.cullingLights ||
+        mPortalZoneManager->_getLastCamera() != request.camera ||
+        !mPortalZoneManager->isRejectingObjects() )
+    {
+        return 0;
+    }
+
+    return mPortalZoneManager;
+}
+//-----------------------------------------------------------------------
+void SceneManager::cullFrustumBatchThread( size_t threadIdx )
+{
+    const CullFrustumBatchRequest &request = mCullFrustumBatchRequest;
+
+    MovableObject::CullResultEntryArray *outCulledObjects =
+            mCullFrustumBatchCapture.begin() + threadIdx * MovableObject::c_maxCullFrustumBatch;
+
+    for( size_t i=0; i<request.numFrustums; ++i )
+        outCulledObjects[i].clear();
+
+    size_t chunkIdx;
+    while( mWorkStealingScheduler->grabChunk( threadIdx, chunkIdx ) )
+    {
+        ObjectData objData;
+        size_t numObjs;
+        size_t rqId;
+        getObjectDataChunk( mObjectDataSegments, chunkIdx, mNumObjsPerChunk,
+                            objData, numObjs, rqId );
+        MovableObject::cullFrustumBatch( numObjs, objData, request.frustums, request.numFrustums,
+                                         request.casterPass, request.lodCamera,
+                                         static_cast<uint8>( rqId ), outCulledObjects );
+    }
+}
+//-----------------------------------------------------------------------
+inline bool OrderLightByShadowCastThenId( const Light *_l, const Light *_r )
+{
+    if( _l->getCastShadows() && !_r->getCastShadows() )
+        return true;
+    if( !_l->getCastShadows() && _r->getCastShadows() )
+        return false;
+
+    return _l->getId() < _r->getId();
+}
+
+void quickSortDirectionalLights( LightListInfo &_globalLightList, const size_t startIdx, const size_t n )
+{
+    if( n < 2 )
+        return;
+
+    LightListInfo lightList;
     lightList.lights.swap( _globalLightList.lights );
     lightList.visibilityMask = _globalLightList.visibilityMask;
     lightList.boundingSphere = _globalLightList.boundingSphere;
@@ -2090,9 +3125,9 @@ void SceneManager::buildLightList()
                             mGlobalLightList.boundingSphere[idx] = Sphere(
                                         objData.mWorldAabb->mCenter.getAsVector3( j ),
                                         objData.mWorldRadius[j] );
-                            assert( dynamic_cast<Light*>( objData.mOwner[j] ) );
-                            mGlobalLightList.lights.push_back( static_cast<Light*>(
-                                                                   objData.mOwner[j] ) );
+                            MovableObject *owner = objData.mOwner[j];
+                            assert( dynamic_cast<Light*>( owner ) );
+                            mGlobalLightList.lights.push_back( static_cast<Light*>( owner ) );
 
                             ++idx;
                         }
@@ -2217,17 +3252,122 @@ void SceneManager::buildLightList()
     if( mBuildLegacyLightList )
     {
         //Now fire the threads again, to build the per-MovableObject lists
-        mRequestType = BUILD_LIGHT_LIST02;
-        if( mForceMainThread )
-            updateWorkerThreadImpl( 0 );
+        if( !mIncrementalLegacyLightList )
+        {
+            fireBuildLegacyLightList( mEntitiesMemoryManagerCulledList, 0 );
+        }
         else
         {
-            mWorkerThreadsBarrier->sync(); //Fire threads
-            mWorkerThreadsBarrier->sync(); //Wait them to complete
+            const bool lightsChanged = collectDirtyLegacyLights();
+
+            if( !mLegacyLightListCacheValid ||
+                mLegacyLightListStaticGeneration != mStaticObjectsGeneration )
+            {
+                //Static objects changed. Everything needs to be updated.
+                fireBuildLegacyLightList( mEntitiesMemoryManagerCulledList, 0 );
+                mLegacyLightListCacheValid = true;
+                mLegacyLightListStaticGeneration = mStaticObjectsGeneration;
+            }
+            else
+            {
+                ObjectMemoryManager *staticMemoryManager = &mEntityMemoryManager[SCENE_STATIC];
+
+                mLegacyLightListDynamicList.clear();
+                const ObjectMemoryManagerVec &culledList = mEntitiesMemoryManagerCulledList;
+                ObjectMemoryManagerVec::const_iterator itor = culledList.begin();
+                ObjectMemoryManagerVec::const_iterator end  = culledList.end();
+                while( itor != end )
+                {
+                    if( *itor != staticMemoryManager )
+                        mLegacyLightListDynamicList.push_back( *itor );
+                    ++itor;
+                }
+
+                fireBuildLegacyLightList( mLegacyLightListDynamicList, 0 );
+
+                if( lightsChanged )
+                {
+                    //Only the static objects touched by the lights that changed
+                    mLegacyLightListDynamicList.clear();
+                    mLegacyLightListDynamicList.push_back( staticMemoryManager );
+                    fireBuildLegacyLightList( mLegacyLightListDynamicList,
+                                              &mLegacyDirtyLightSpheres );
+                }
+            }
         }
     }
 }
 //-----------------------------------------------------------------------
+bool SceneManager::collectDirtyLegacyLights(void)
+{
+    const size_t numLights = mGlobalLightList.lights.size();
+
+    mLegacyLightStateCurr.resizePOD( numLights );
+    for( size_t i=0; i<numLights; ++i )
+    {
+        LegacyLightState &state = mLegacyLightStateCurr[i];
+        state.light             = mGlobalLightList.lights[i];
+        state.visibilityMask    = mGlobalLightList.visibilityMask[i];
+        state.boundingSphere    = mGlobalLightList.boundingSphere[i];
+    }
+    std::sort( mLegacyLightStateCurr.begin(), mLegacyLightStateCurr.end() );
+
+    //Both lists are sorted by pointer. Walk them together.
+    mLegacyDirtyLightSpheres.clear();
+    LegacyLightStateArray::const_iterator itPrev = mLegacyLightStatePrev.begin();
+    LegacyLightStateArray::const_iterator enPrev = mLegacyLightStatePrev.end();
+    LegacyLightStateArray::const_iterator itCurr = mLegacyLightStateCurr.begin();
+    LegacyLightStateArray::const_iterator enCurr = mLegacyLightStateCurr.end();
+
+    while( itPrev != enPrev || itCurr != enCurr )
+    {
+        if( itCurr == enCurr || (itPrev != enPrev && itPrev->light < itCurr->light) )
+        {
+            //Light no longer in the list
+            mLegacyDirtyLightSpheres.push_back( itPrev->boundingSphere );
+            ++itPrev;
+        }
+        else if( itPrev == enPrev || itCurr->light < itPrev->light )
+        {
+            //New light
+            mLegacyDirtyLightSpheres.push_back( itCurr->boundingSphere );
+            ++itCurr;
+        }
+        else
+        {
+            if( itPrev->visibilityMask != itCurr->visibilityMask ||
+                itPrev->boundingSphere.getCenter() != itCurr->boundingSphere.getCenter() ||
+                itPrev->boundingSphere.getRadius() != itCurr->boundingSphere.getRadius() )
+            {
+                mLegacyDirtyLightSpheres.push_back( itPrev->boundingSphere );
+                mLegacyDirtyLightSpheres.push_back( itCurr->boundingSphere );
+            }
+            ++itPrev;
+            ++itCurr;
+        }
+    }
+
+    mLegacyLightStatePrev.swap( mLegacyLightStateCurr );
+
+    return !mLegacyDirtyLightSpheres.empty();
+}
+//-----------------------------------------------------------------------
+void SceneManager::fireBuildLegacyLightList( const ObjectMemoryManagerVec &memoryManagers,
+                                             const FastArray<Sphere> *dirtyLightSpheres )
+{
+    prepareObjectDataChunks( memoryManagers, 0, std::numeric_limits<size_t>::max() );
+    mLegacyLightListRequestDirtySpheres = dirtyLightSpheres;
+    mRequestType = BUILD_LIGHT_LIST02;
+    if( mForceMainThread )
+        updateWorkerThreadImpl( 0 );
+    else
+    {
+        mWorkerThreadsBarrier->sync(); //Fire threads
+        mWorkerThreadsBarrier->sync(); //Wait them to complete
+    }
+    mLegacyLightListRequestDirtySpheres = 0;
+}
+//-----------------------------------------------------------------------
 void SceneManager::buildLightListThread01( const BuildLightListRequest &buildLightListRequest,
                                            size_t threadIdx )
 {
@@ -2284,35 +3424,13 @@ void SceneManager::buildLightListThread01( const BuildLightListRequest &buildLig
 void SceneManager::buildLightListThread02( size_t threadIdx )
 {
     //Global light list built. Now build a per-movable object light list
-    ObjectMemoryManagerVec::const_iterator it = mEntitiesMemoryManagerCulledList.begin();
-    ObjectMemoryManagerVec::const_iterator en = mEntitiesMemoryManagerCulledList.end();
-    while( it != en )
+    ObjectData objData;
+    size_t numObjs;
+    size_t renderQueueId;
+    while( grabObjectDataChunk( threadIdx, objData, numObjs, renderQueueId ) )
     {
-        ObjectMemoryManager *objMemoryManager = *it;
-        const size_t numRenderQueues = objMemoryManager->getNumRenderQueues();
-
-        for( size_t i=0; i<numRenderQueues; ++i )
-        {
-            ObjectData objData;
-            const size_t totalObjs = objMemoryManager->getFirstObjectData( objData, i );
-
-            //Distribute the work evenly across all threads (not perfect), taking into
-            //account we need to distribute in multiples of ARRAY_PACKED_REALS
-            size_t numObjs  = ( totalObjs + (mNumWorkerThreads-1) ) / mNumWorkerThreads;
-            numObjs         = ( (numObjs + ARRAY_PACKED_REALS - 1) / ARRAY_PACKED_REALS ) *
-                                ARRAY_PACKED_REALS;
-
-            const size_t toAdvance = std::min( threadIdx * numObjs, totalObjs );
-
-            //Prevent going out of bounds (usually in the last threadIdx, or
-            //when there are less entities than ARRAY_PACKED_REALS
-            numObjs = std::min( numObjs, totalObjs - toAdvance );
-            objData.advancePack( toAdvance / ARRAY_PACKED_REALS );
-
-            MovableObject::buildLightList( numObjs, objData, mGlobalLightList );
-        }
-
-        ++it;
+        MovableObject::buildLightList( numObjs, objData, mGlobalLightList,
+                                       mLegacyLightListRequestDirtySpheres );
     }
 }
 //-----------------------------------------------------------------------
@@ -2337,6 +3455,13 @@ void SceneManager::highLevelCull()
     mSkeletonAnimManagerCulledList.push_back( &mSkeletonAnimationManager );
     mTagPointNodeMemoryManagerUpdateList.push_back( &mTagPointNodeMemoryManager );
 
+    if( mStaticEntitiesDirty ||
+        mStaticMinDepthLevelDirty < mNodeMemoryManager[SCENE_STATIC].getNumDepths() )
+    {
+        //Cached culling results of static objects are no longer valid
+        ++mStaticObjectsGeneration;
+    }
+
     if( mStaticEntitiesDirty )
     {
         //Entities have changed
@@ -2351,7 +3476,25 @@ void SceneManager::highLevelCull()
     }
 }
 //-----------------------------------------------------------------------
+void SceneManager::setFrameTaskGraphEnabled( bool bEnabled )
+{
+    mFrameTaskGraphEnabled = bEnabled;
+}
+//-----------------------------------------------------------------------
+FrameTask* SceneManager::getFrameStageTask( FrameStage stage ) const
+{
+    assert( stage < NumFrameStages );
+    return mFrameStageTasks[stage];
+}
+//-----------------------------------------------------------------------
 void SceneManager::updateSceneGraph()
+{
+    _updateSceneGraphBegin();
+    _updateSceneGraphConcurrent();
+    _updateSceneGraphEnd();
+}
+//-----------------------------------------------------------------------
+void SceneManager::_updateSceneGraphBegin(void)
 {
     //TODO: Enable auto tracking again, first manually update the tracked scene nodes for correct math. (dark_sylinc)
     // Update scene graph for this camera (can happen multiple times per frame)
@@ -2371,14 +3514,68 @@ void SceneManager::updateSceneGraph()
 
     // Update controllers 
     ControllerManager::getSingleton().updateAllControllers();
+    updateAllParticleSystems();
+
+    executeSceneCommandQueues();
+
+    if( mDefragmentMaxSlotsPerFrame )
+        defragmentMemoryPoolsIncremental();
+
+    {
+        //Objects may move or be destroyed from now on
+        BatchedCullResultMap::iterator itor = mBatchedCullResults.begin();
+        BatchedCullResultMap::iterator end  = mBatchedCullResults.end();
+        while( itor != end )
+        {
+            BatchedCullResultVec::iterator itResult = itor->second.begin();
+            BatchedCullResultVec::iterator enResult = itor->second.end();
+            while( itResult != enResult )
+            {
+                itResult->valid = false;
+                ++itResult;
+            }
+            ++itor;
+        }
+    }
 
     highLevelCull();
     _applySceneAnimations();
-    updateAllTransforms();
-    updateAllAnimations();
-    updateAllTagPoints();
-    updateAllBounds( mEntitiesMemoryManagerUpdateList );
-    updateAllBounds( mLightsMemoryManagerCulledList );
+}
+//-----------------------------------------------------------------------
+void SceneManager::_updateSceneGraphConcurrent(void)
+{
+    if( mCpuTimer )
+        memset( &mCpuTimings, 0, sizeof( mCpuTimings ) );
+    uint64 startTime = _getCpuTime();
+
+    if( mFrameTaskGraphEnabled )
+    {
+        mFrameTaskGraph->_prepareExecution( mNumWorkerThreads );
+        mRequestType = EXECUTE_FRAME_TASK_GRAPH;
+        fireWorkerThreadsAndWait();
+        fireNodeUpdatedListeners();
+        mCpuTimings.updateAllTransforms = _getCpuTime() - startTime;
+    }
+    else
+    {
+        updateAllTransforms();
+        uint64 endTime = _getCpuTime();
+        mCpuTimings.updateAllTransforms = endTime - startTime;
+        startTime = endTime;
+
+        updateAllAnimations();
+        endTime = _getCpuTime();
+        mCpuTimings.updateAllAnimations = endTime - startTime;
+        startTime = endTime;
+
+        updateAllTagPoints();
+        updateAllBounds( mEntitiesMemoryManagerUpdateList );
+        updateAllBounds( mLightsMemoryManagerCulledList );
+        mCpuTimings.updateAllBounds = _getCpuTime() - startTime;
+    }
+
+    if( mPortalZoneManager )
+        mPortalZoneManager->_updateTrackedObjects();
 
     {
         // Auto-track nodes
@@ -2418,7 +3615,14 @@ void SceneManager::updateSceneGraph()
         }
     }
 
+    startTime = _getCpuTime();
     buildLightList();
+    mCpuTimings.buildLightList = _getCpuTime() - startTime;
+}
+//-----------------------------------------------------------------------
+void SceneManager::_updateSceneGraphEnd(void)
+{
+    updateAllBillboardChains();
 
     //Reset the list of render RQs for all cameras that are in a PASS_SCENE (except shadow passes)
     uint8 numRqs = 0;
@@ -3060,12 +4264,7 @@ void SceneManager::_applySceneAnimations(void)
         const v1::AnimationState* state = stateIt.getNext();
         v1::Animation* anim = getAnimation(state->getAnimationName());
 
-        // Reset any nodes involved
-        v1::Animation::NodeTrackIterator nodeTrackIt = anim->getNodeTrackIterator();
-        while(nodeTrackIt.hasMoreElements())
-        {
-			nodeTrackIt.getNext()->resetNodeToInitialState();
-        }
+        //Nodes are reset by mNodeAnimationEvaluator
 
         v1::Animation::OldNodeTrackIterator OldNodeTrackIt = anim->getOldNodeTrackIterator();
 		while(OldNodeTrackIt.hasMoreElements())
@@ -3085,14 +4284,16 @@ void SceneManager::_applySceneAnimations(void)
     }
 
     // this should allow blended animations
+    mNodeAnimationEvaluator->clear();
     stateIt = mAnimationStates.getEnabledAnimationStateIterator();
     while (stateIt.hasMoreElements())
     {
         const v1::AnimationState* state = stateIt.getNext();
         v1::Animation* anim = getAnimation(state->getAnimationName());
-        // Apply the animation
-        anim->apply(state->getTimePosition(), state->getWeight());
+        // Apply the animation. Node tracks are gathered and applied all at once below
+        anim->apply(*mNodeAnimationEvaluator, state->getTimePosition(), state->getWeight());
     }
+    mNodeAnimationEvaluator->evaluate( this );
 }
 //---------------------------------------------------------------------
 void SceneManager::useRenderableViewProjMode(const Renderable* pRend, bool fixedFunction)
@@ -4203,6 +5404,14 @@ MovableObject* SceneManager::createMovableObject( const String& typeName,
     {
         return createCamera( "", true );
     }
+    return createMovableObjectWithId( Id::generateNewId<MovableObject>(), typeName,
+                                      objectMemMgr, params );
+}
+//---------------------------------------------------------------------
+MovableObject* SceneManager::createMovableObjectWithId( IdType id, const String &typeName,
+                                                        ObjectMemoryManager *objectMemMgr,
+                                                        const NameValuePairList *params )
+{
     MovableObjectFactory* factory = 
         Root::getSingleton().getMovableObjectFactory(typeName);
     // Check for duplicate names
@@ -4211,8 +5420,7 @@ MovableObject* SceneManager::createMovableObject( const String& typeName,
     {
         OGRE_LOCK_MUTEX(objectMap->mutex);
 
-        MovableObject* newObj = factory->createInstance( Id::generateNewId<MovableObject>(),
-                                                         objectMemMgr, this, params );
+        MovableObject* newObj = factory->createInstance( id, objectMemMgr, this, params );
         objectMap->movableObjects.push_back( newObj );
         newObj->mGlobalIndex = objectMap->movableObjects.size() - 1;
         return newObj;
@@ -4615,14 +5823,23 @@ void SceneManager::fireWorkerThreadsAndWait(void)
         updateWorkerThreadImpl( 0 );
     else
     {
-        mWorkerThreadsBarrier->sync(); //Fire threads
-        mWorkerThreadsBarrier->sync(); //Wait them to complete
+        {
+            OgreProfile( "Fire Worker Threads" );
+            mWorkerThreadsBarrier->sync(); //Fire threads
+        }
+        {
+            OgreProfile( "Wait Worker Threads" );
+            mWorkerThreadsBarrier->sync(); //Wait them to complete
+        }
     }
 }
 //---------------------------------------------------------------------
 //---------------------------------------------------------------------
 void SceneManager::fireCullFrustumThreads( const CullFrustumRequest &request )
 {
+    prepareObjectDataChunks( *request.objectMemManager, request.firstRq, request.lastRq );
+    if( mStaticCullBvhEnabled && !request.cullingLights )
+        assignStaticCullBvhs();
     mCurrentCullFrustumRequest = request;
     mRequestType = CULL_FRUSTUM;
     //This is where I figuratively kill whoever made mutable variables inside a
@@ -4633,6 +5850,616 @@ void SceneManager::fireCullFrustumThreads( const CullFrustumRequest &request )
     fireWorkerThreadsAndWait();
 }
 //---------------------------------------------------------------------
+void SceneManager::prepareStaticCullCache( CullFrustumRequest &inOutRequest )
+{
+    mCurrentStaticCullCache = 0;
+
+    const Camera *camera = inOutRequest.camera;
+
+    if( !mStaticCullCacheEnabled || inOutRequest.cullingLights || camera->getCullingFrustum() ||
+        (camera->getHiZBuffer() && camera->getHiZBuffer()->isValid()) )
+    {
+        return;
+    }
+
+    //Combine the generation of all static memory managers with ours.
+    bool hasStaticManagers = false;
+    uint32 generation = mStaticObjectsGeneration;
+    mStaticCullCacheDynamicList.clear();
+    {
+        ObjectMemoryManagerVec::const_iterator itor = inOutRequest.objectMemManager->begin();
+        ObjectMemoryManagerVec::const_iterator end  = inOutRequest.objectMemManager->end();
+
+        while( itor != end )
+        {
+            if( (*itor)->getMemoryManagerType() == SCENE_STATIC )
+            {
+                hasStaticManagers = true;
+                generation += (*itor)->getGeneration();
+            }
+            else
+            {
+                mStaticCullCacheDynamicList.push_back( *itor );
+            }
+            ++itor;
+        }
+    }
+
+    if( !hasStaticManagers )
+        return;
+
+    const Viewport *viewport = camera->getLastViewport();
+    const uint32 visibilityMask = (viewport->getVisibilityMask() & this->getVisibilityMask()) |
+                                  (viewport->getVisibilityMask() &
+                                   ~VisibilityFlags::RESERVED_VISIBILITY_FLAGS);
+
+    StaticCullCache &cache = mStaticCullCaches[camera];
+
+    const bool canReuse = cache.valid &&
+                          cache.generation == generation &&
+                          cache.viewMatrix == camera->getViewMatrix( true ) &&
+                          cache.projectionMatrix == camera->getProjectionMatrix() &&
+                          cache.lodCamera == inOutRequest.lodCamera &&
+                          cache.lodCameraPos == inOutRequest.lodCamera->getDerivedPosition() &&
+                          cache.visibilityMask == visibilityMask &&
+                          cache.firstRq == inOutRequest.firstRq &&
+                          cache.lastRq == inOutRequest.lastRq &&
+                          cache.casterPass == inOutRequest.casterPass;
+
+    if( canReuse )
+    {
+        inOutRequest.objectMemManager = &mStaticCullCacheDynamicList;
+    }
+    else
+    {
+        cache.valid             = false;
+        cache.generation        = generation;
+        cache.viewMatrix        = camera->getViewMatrix( true );
+        cache.projectionMatrix  = camera->getProjectionMatrix();
+        cache.lodCamera         = inOutRequest.lodCamera;
+        cache.lodCameraPos      = inOutRequest.lodCamera->getDerivedPosition();
+        cache.visibilityMask    = visibilityMask;
+        cache.firstRq           = inOutRequest.firstRq;
+        cache.lastRq            = inOutRequest.lastRq;
+        cache.casterPass        = inOutRequest.casterPass;
+        cache.entries.clear();
+    }
+
+    mCurrentStaticCullCache = &cache;
+    mReusingStaticCullCache = canReuse;
+}
+//---------------------------------------------------------------------
+void SceneManager::finishStaticCullCache(void)
+{
+    if( mCurrentStaticCullCache && !mReusingStaticCullCache )
+    {
+        StaticCullCacheEntryArrayPerThread::const_iterator itor = mStaticCullCacheCapture.begin();
+        StaticCullCacheEntryArrayPerThread::const_iterator end  = mStaticCullCacheCapture.end();
+
+        while( itor != end )
+        {
+            mCurrentStaticCullCache->entries.appendPOD( itor->begin(), itor->end() );
+            ++itor;
+        }
+
+        mCurrentStaticCullCache->valid = true;
+    }
+
+    mCurrentStaticCullCache = 0;
+    mReusingStaticCullCache = false;
+}
+//---------------------------------------------------------------------
+void SceneManager::setStaticCullCacheEnabled( bool bEnabled )
+{
+    mStaticCullCacheEnabled = bEnabled;
+    if( !bEnabled )
+        mStaticCullCaches.clear();
+}
+//---------------------------------------------------------------------
+void SceneManager::assignStaticCullBvhs(void)
+{
+    //Each leaf of the BVH is a pack, so subtrees of this many packs
+    //amount roughly to the same work as a regular chunk
+    const size_t maxPacksPerSubtree = std::max<size_t>( mNumObjsPerChunk / ARRAY_PACKED_REALS, 1u );
+
+    size_t numChunks = 0;
+
+    ObjectDataSegmentArray::iterator itor = mObjectDataSegments.begin();
+    ObjectDataSegmentArray::iterator end  = mObjectDataSegments.end();
+
+    while( itor != end )
+    {
+        itor->firstChunk = numChunks;
+
+        if( itor->memoryManager->getMemoryManagerType() == SCENE_STATIC )
+        {
+            const uint32 generation = itor->memoryManager->getGeneration() +
+                                      mStaticObjectsGeneration;
+
+            ObjectDataBvh *&bvh = mStaticCullBvhs[std::make_pair( itor->memoryManager,
+                                                                  itor->renderQueueId )];
+            bool needsBuild = false;
+            if( !bvh )
+            {
+                bvh = OGRE_NEW ObjectDataBvh();
+                needsBuild = true;
+            }
+
+            if( needsBuild || bvh->getBuildGeneration() != generation )
+            {
+                bvh->build( itor->memoryManager, itor->renderQueueId,
+                            maxPacksPerSubtree, generation );
+            }
+
+            itor->bvh = bvh;
+            numChunks += bvh->getNumSubtrees();
+        }
+        else
+        {
+            numChunks += (itor->totalObjs + mNumObjsPerChunk - 1u) / mNumObjsPerChunk;
+        }
+
+        ++itor;
+    }
+
+    mWorkStealingScheduler->reset( numChunks );
+}
+//---------------------------------------------------------------------
+void SceneManager::cullFrustumBvh( const ObjectDataSegment &segment, size_t subtreeIdx,
+                                   const Camera *camera, uint32 visibilityMask,
+                                   MovableObject::MovableObjectArray &outVisibleObjects,
+                                   const Camera *lodCamera, size_t threadIdx )
+{
+    FastArray<uint32> &visiblePacks = *(mCullBvhVisiblePacks.begin() + threadIdx);
+    visiblePacks.clear();
+    segment.bvh->cullSubtree( subtreeIdx, camera, visiblePacks );
+
+    ObjectData firstObjData;
+    segment.memoryManager->getFirstObjectData( firstObjData, segment.renderQueueId );
+
+    const size_t numPacks = visiblePacks.size();
+    size_t i = 0;
+
+    while( i < numPacks )
+    {
+        //Packs come sorted. Cull contiguous packs in one go.
+        const size_t runStart = visiblePacks[i];
+        size_t runEnd = runStart + 1u;
+        ++i;
+        while( i < numPacks && visiblePacks[i] == runEnd )
+        {
+            ++runEnd;
+            ++i;
+        }
+
+        ObjectData objData = firstObjData;
+        objData.advancePack( runStart );
+
+        const size_t firstObj = runStart * ARRAY_PACKED_REALS;
+        const size_t numObjs = std::min( (runEnd - runStart) * ARRAY_PACKED_REALS,
+                                         segment.totalObjs - firstObj );
+        MovableObject::cullFrustum( numObjs, objData, camera, visibilityMask,
+                                    outVisibleObjects, lodCamera );
+    }
+}
+//---------------------------------------------------------------------
+ObjectDataBvh const* SceneManager::getValidStaticCullBvh( ObjectMemoryManager *memoryManager,
+                                                         size_t renderQueue ) const
+{
+    if( memoryManager->getMemoryManagerType() != SCENE_STATIC )
+        return 0;
+
+    ObjectDataBvhMap::const_iterator itor =
+            mStaticCullBvhs.find( std::make_pair( memoryManager, renderQueue ) );
+    if( itor == mStaticCullBvhs.end() )
+        return 0;
+
+    const uint32 generation = memoryManager->getGeneration() + mStaticObjectsGeneration;
+    return itor->second->getBuildGeneration() == generation ? itor->second : 0;
+}
+//---------------------------------------------------------------------
+void SceneManager::executeBatchedRayQuery( const Ray *rays, size_t numRays,
+                                           BatchedRayQueryResult *outResults,
+                                           uint32 queryMask, uint8 firstRq, uint8 lastRq )
+{
+    BatchedSceneQueryRequest &request = mBatchedSceneQueryRequest;
+    request = BatchedSceneQueryRequest();
+    request.type            = BatchedSceneQueryRequest::QueryRays;
+    request.numQueries      = numRays;
+    request.rays            = rays;
+    request.outRayResults   = outResults;
+    request.queryMask       = queryMask;
+    request.firstRq         = firstRq;
+    request.lastRq          = lastRq;
+    fireBatchedSceneQuery();
+}
+//---------------------------------------------------------------------
+void SceneManager::executeBatchedSphereQuery( const Sphere *spheres, size_t numSpheres,
+                                              MovableObject **outObjects,
+                                              size_t maxResultsPerQuery, uint32 *outNumResults,
+                                              uint32 queryMask, uint8 firstRq, uint8 lastRq )
+{
+    BatchedSceneQueryRequest &request = mBatchedSceneQueryRequest;
+    request = BatchedSceneQueryRequest();
+    request.type                = BatchedSceneQueryRequest::QuerySpheres;
+    request.numQueries          = numSpheres;
+    request.spheres             = spheres;
+    request.outObjects          = outObjects;
+    request.maxResultsPerQuery  = maxResultsPerQuery;
+    request.outNumResults       = outNumResults;
+    request.queryMask           = queryMask;
+    request.firstRq             = firstRq;
+    request.lastRq              = lastRq;
+    fireBatchedSceneQuery();
+}
+//---------------------------------------------------------------------
+void SceneManager::executeBatchedAabbQuery( const Aabb *aabbs, size_t numAabbs,
+                                            MovableObject **outObjects,
+                                            size_t maxResultsPerQuery, uint32 *outNumResults,
+                                            uint32 queryMask, uint8 firstRq, uint8 lastRq )
+{
+    BatchedSceneQueryRequest &request = mBatchedSceneQueryRequest;
+    request = BatchedSceneQueryRequest();
+    request.type                = BatchedSceneQueryRequest::QueryAabbs;
+    request.numQueries          = numAabbs;
+    request.aabbs               = aabbs;
+    request.outObjects          = outObjects;
+    request.maxResultsPerQuery  = maxResultsPerQuery;
+    request.outNumResults       = outNumResults;
+    request.queryMask           = queryMask;
+    request.firstRq             = firstRq;
+    request.lastRq              = lastRq;
+    fireBatchedSceneQuery();
+}
+//---------------------------------------------------------------------
+void SceneManager::fireBatchedSceneQuery(void)
+{
+    assert( mBatchedSceneQueryRequest.firstRq < mBatchedSceneQueryRequest.lastRq &&
+            "This query will never hit any result!" );
+
+    if( !mBatchedSceneQueryRequest.numQueries )
+        return;
+
+    OgreProfileGroup( "Batched Scene Query", OGREPROF_CULLING );
+
+    mRequestType = BATCHED_SCENE_QUERY;
+    fireWorkerThreadsAndWait();
+}
+//---------------------------------------------------------------------
+void SceneManager::batchedSceneQueryThread( size_t threadIdx )
+{
+    const BatchedSceneQueryRequest &request = mBatchedSceneQueryRequest;
+
+    const size_t firstQuery = (request.numQueries * threadIdx) / mNumWorkerThreads;
+    const size_t lastQuery  = (request.numQueries * (threadIdx + 1u)) / mNumWorkerThreads;
+
+    if( firstQuery == lastQuery )
+        return;
+
+    for( size_t i=firstQuery; i<lastQuery; ++i )
+    {
+        if( request.type == BatchedSceneQueryRequest::QueryRays )
+        {
+            request.outRayResults[i].movableObject  = 0;
+            request.outRayResults[i].distance       = std::numeric_limits<Real>::max();
+        }
+        else
+        {
+            request.outNumResults[i] = 0;
+        }
+    }
+
+    FastArray<uint32> &packs = *(mCullBvhVisiblePacks.begin() + threadIdx);
+
+    for( size_t i=0; i<NUM_SCENE_MEMORY_MANAGER_TYPES; ++i )
+    {
+        ObjectMemoryManager &memoryManager = mEntityMemoryManager[i];
+
+        const size_t numRenderQueues = memoryManager.getNumRenderQueues();
+        const size_t firstRq = std::min<size_t>( request.firstRq, numRenderQueues );
+        const size_t lastRq  = std::min<size_t>( request.lastRq,  numRenderQueues );
+
+        for( size_t j=firstRq; j<lastRq; ++j )
+        {
+            ObjectData firstObjData;
+            const size_t totalObjs = memoryManager.getFirstObjectData( firstObjData, j );
+
+            if( !totalObjs )
+                continue;
+
+            const ObjectDataBvh *bvh = getValidStaticCullBvh( &memoryManager, j );
+
+            for( size_t queryIdx=firstQuery; queryIdx<lastQuery; ++queryIdx )
+            {
+                if( !bvh )
+                {
+                    batchedSceneQuery( firstObjData, totalObjs, queryIdx );
+                    continue;
+                }
+
+                packs.clear();
+                if( request.type == BatchedSceneQueryRequest::QueryRays )
+                {
+                    bvh->findPacks( request.rays[queryIdx], packs );
+                }
+                else if( request.type == BatchedSceneQueryRequest::QuerySpheres )
+                {
+                    const Sphere &sphere = request.spheres[queryIdx];
+                    bvh->findPacks( Aabb( sphere.getCenter(), Vector3( sphere.getRadius() ) ),
+                                    packs );
+                }
+                else
+                {
+                    bvh->findPacks( request.aabbs[queryIdx], packs );
+                }
+
+                FastArray<uint32>::const_iterator itPack = packs.begin();
+                FastArray<uint32>::const_iterator enPack = packs.end();
+                while( itPack != enPack )
+                {
+                    ObjectData objData = firstObjData;
+                    objData.advancePack( *itPack );
+                    batchedSceneQuery( objData, ARRAY_PACKED_REALS, queryIdx );
+                    ++itPack;
+                }
+            }
+        }
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::batchedSceneQuery( ObjectData objData, size_t numObjs, size_t queryIdx )
+{
+    const BatchedSceneQueryRequest &request = mBatchedSceneQueryRequest;
+
+    ArrayInt ourQueryMask = Mathlib::SetAll( request.queryMask );
+
+    ArrayRay ray;
+    ArraySphere sphere;
+    ArrayAabb aabb( ArrayVector3::ZERO, ArrayVector3::ZERO );
+
+    switch( request.type )
+    {
+    case BatchedSceneQueryRequest::QueryRays:
+        ray.mOrigin.setAll( request.rays[queryIdx].getOrigin() );
+        ray.mDirection.setAll( request.rays[queryIdx].getDirection() );
+        break;
+    case BatchedSceneQueryRequest::QuerySpheres:
+        sphere.setAll( request.spheres[queryIdx] );
+        break;
+    case BatchedSceneQueryRequest::QueryAabbs:
+        aabb.setAll( request.aabbs[queryIdx] );
+        break;
+    }
+
+    for( size_t i=0; i<numObjs; i += ARRAY_PACKED_REALS )
+    {
+        ArrayInt * RESTRICT_ALIAS visibilityFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                    (objData.mVisibilityFlags);
+        ArrayInt * RESTRICT_ALIAS queryFlags = reinterpret_cast<ArrayInt*RESTRICT_ALIAS>
+                                                                    (objData.mQueryFlags);
+
+        ArrayReal distance = ARRAY_REAL_ZERO;
+        ArrayMaskR hitMaskR;
+
+        if( request.type == BatchedSceneQueryRequest::QueryRays )
+        {
+            hitMaskR = ray.intersects( *objData.mWorldAabb, distance );
+        }
+        else if( request.type == BatchedSceneQueryRequest::QuerySpheres )
+        {
+            ArrayReal * RESTRICT_ALIAS worldRadius = reinterpret_cast<ArrayReal*RESTRICT_ALIAS>
+                                                                        (objData.mWorldRadius);
+            ArraySphere testSphere( *worldRadius, objData.mWorldAabb->mCenter );
+            hitMaskR = sphere.intersects( testSphere );
+        }
+        else
+        {
+            hitMaskR = aabb.intersects( *objData.mWorldAabb );
+        }
+
+        //hitMask = hitMask && ( (*queryFlags & ourQueryMask) != 0 ) && isVisble;
+        ArrayMaskI hitMask = CastRealToInt( hitMaskR );
+        hitMask = Mathlib::And( hitMask, Mathlib::TestFlags4( *queryFlags, ourQueryMask ) );
+        hitMask = Mathlib::And( hitMask,
+                                Mathlib::TestFlags4( *visibilityFlags,
+                                    Mathlib::SetAll( VisibilityFlags::LAYER_VISIBILITY ) ) );
+
+        const uint32 scalarMask = BooleanMask4::getScalarMask( hitMask );
+
+        if( scalarMask )
+        {
+            if( request.type == BatchedSceneQueryRequest::QueryRays )
+            {
+                OGRE_ALIGNED_DECL( Real, scalarDistance[ARRAY_PACKED_REALS], OGRE_SIMD_ALIGNMENT );
+                CastArrayToReal( scalarDistance, distance );
+
+                BatchedRayQueryResult &result = request.outRayResults[queryIdx];
+                for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                {
+                    //There's no need to check objData.mOwner[j] is null because
+                    //we set mVisibilityFlags to 0 on slot removals
+                    if( IS_BIT_SET( j, scalarMask ) && scalarDistance[j] < result.distance )
+                    {
+                        result.movableObject = objData.mOwner[j];
+                        result.distance = scalarDistance[j];
+                    }
+                }
+            }
+            else
+            {
+                MovableObject **outObjects = request.outObjects +
+                                             queryIdx * request.maxResultsPerQuery;
+                uint32 &numResults = request.outNumResults[queryIdx];
+                for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+                {
+                    if( IS_BIT_SET( j, scalarMask ) )
+                    {
+                        if( numResults < request.maxResultsPerQuery )
+                            outObjects[numResults] = objData.mOwner[j];
+                        ++numResults;
+                    }
+                }
+            }
+        }
+
+        objData.advancePack();
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::destroyStaticCullBvhs(void)
+{
+    ObjectDataBvhMap::const_iterator itor = mStaticCullBvhs.begin();
+    ObjectDataBvhMap::const_iterator end  = mStaticCullBvhs.end();
+
+    while( itor != end )
+    {
+        OGRE_DELETE itor->second;
+        ++itor;
+    }
+
+    mStaticCullBvhs.clear();
+}
+//---------------------------------------------------------------------
+void SceneManager::cullFrustumBatch( Camera const * const *cameras, size_t numCameras,
+                                     const Camera *lodCamera, bool casterPass )
+{
+    OgreProfileGroup( "cullFrustumBatch", OGREPROF_CULLING );
+
+    //Same race condition as in fireCullFrustumThreads
+    lodCamera->getFrustumPlanes();
+    for( size_t i=0; i<numCameras; ++i )
+        cameras[i]->getFrustumPlanes();
+
+    while( numCameras )
+    {
+        const size_t numBatched = numCameras < MovableObject::c_maxCullFrustumBatch ?
+                    numCameras : MovableObject::c_maxCullFrustumBatch;
+
+        BatchedCullResult *outResults[MovableObject::c_maxCullFrustumBatch];
+        for( size_t i=0; i<numBatched; ++i )
+        {
+            BatchedCullResultVec &results = mBatchedCullResults[cameras[i]];
+            results.resize( 1u );
+            outResults[i] = &results[0];
+            prepareBatchedCullFrustum( cameras[i], i, lodCamera, casterPass, outResults[i] );
+        }
+
+        fireCullFrustumBatch( numBatched, lodCamera, casterPass, outResults );
+
+        cameras     += numBatched;
+        numCameras  -= numBatched;
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::cullFrustumBatch( Camera *camera, const Quaternion *orientations,
+                                     size_t numOrientations, const Camera *lodCamera,
+                                     bool casterPass )
+{
+    OgreProfileGroup( "cullFrustumBatch", OGREPROF_CULLING );
+
+    //Same race condition as in fireCullFrustumThreads
+    lodCamera->getFrustumPlanes();
+
+    const Quaternion oldOrientation = camera->getOrientation();
+
+    BatchedCullResultVec &results = mBatchedCullResults[camera];
+    results.resize( numOrientations );
+
+    size_t startIdx = 0;
+    while( startIdx < numOrientations )
+    {
+        const size_t numBatched = std::min( numOrientations - startIdx,
+                                            MovableObject::c_maxCullFrustumBatch );
+
+        BatchedCullResult *outResults[MovableObject::c_maxCullFrustumBatch];
+        for( size_t i=0; i<numBatched; ++i )
+        {
+            camera->setOrientation( orientations[startIdx + i] );
+            camera->getFrustumPlanes();
+            outResults[i] = &results[startIdx + i];
+            prepareBatchedCullFrustum( camera, i, lodCamera, casterPass, outResults[i] );
+        }
+
+        fireCullFrustumBatch( numBatched, lodCamera, casterPass, outResults );
+
+        startIdx += numBatched;
+    }
+
+    camera->setOrientation( oldOrientation );
+}
+//---------------------------------------------------------------------
+bool SceneManager::_hasBatchedCullResults( const Camera *camera ) const
+{
+    BatchedCullResultMap::const_iterator itor = mBatchedCullResults.find( camera );
+    if( itor != mBatchedCullResults.end() )
+    {
+        BatchedCullResultVec::const_iterator itResult = itor->second.begin();
+        BatchedCullResultVec::const_iterator enResult = itor->second.end();
+        while( itResult != enResult )
+        {
+            if( itResult->valid )
+                return true;
+            ++itResult;
+        }
+    }
+
+    return false;
+}
+//---------------------------------------------------------------------
+void SceneManager::prepareBatchedCullFrustum( const Camera *camera, size_t frustumIdx,
+                                              const Camera *lodCamera, bool casterPass,
+                                              BatchedCullResult *outResult )
+{
+    MovableObject::CullFrustumBatchFrustum &frustum =
+            mCullFrustumBatchRequest.frustums[frustumIdx];
+
+    const Plane *frustumPlanes = camera->_getCachedFrustumPlanes();
+    for( size_t i=0; i<6u; ++i )
+        frustum.planes[i] = frustumPlanes[i];
+    frustum.cameraPos = camera->_getCachedDerivedPosition();
+    frustum.cameraDir = -camera->_getCachedDerivedOrientation().zAxis();
+
+    outResult->valid            = true;
+    outResult->viewMatrix       = camera->getViewMatrix( true );
+    outResult->projectionMatrix = camera->getProjectionMatrix();
+    outResult->lodCamera        = lodCamera;
+    outResult->casterPass       = casterPass;
+}
+//---------------------------------------------------------------------
+void SceneManager::fireCullFrustumBatch( size_t numFrustums, const Camera *lodCamera,
+                                         bool casterPass, BatchedCullResult * const *outResults )
+{
+    //Sweep all render queues, the passes will filter what they render.
+    prepareObjectDataChunks( mEntitiesMemoryManagerCulledList, 0,
+                             std::numeric_limits<size_t>::max() );
+
+    mCullFrustumBatchRequest.numFrustums    = numFrustums;
+    mCullFrustumBatchRequest.lodCamera      = lodCamera;
+    mCullFrustumBatchRequest.casterPass     = casterPass;
+    mRequestType = CULL_FRUSTUM_BATCH;
+    fireWorkerThreadsAndWait();
+
+    for( size_t i=0; i<numFrustums; ++i )
+    {
+        BatchedCullResult *result = outResults[i];
+        result->entries.clear();
+
+        for( size_t j=0; j<mNumWorkerThreads; ++j )
+        {
+            const MovableObject::CullResultEntryArray &captured =
+                    mCullFrustumBatchCapture[j * MovableObject::c_maxCullFrustumBatch + i];
+            result->entries.appendPOD( captured.begin(), captured.end() );
+        }
+    }
+}
+//---------------------------------------------------------------------
+void SceneManager::setStaticCullBvhEnabled( bool bEnabled )
+{
+    mStaticCullBvhEnabled = bEnabled;
+    if( !bEnabled )
+        destroyStaticCullBvhs();
+}
+//---------------------------------------------------------------------
 void SceneManager::executeUserScalableTask( UniformScalableTask *task, bool bBlock )
 {
     mRequestType = USER_UNIFORM_SCALABLE_TASK;
@@ -4659,6 +6486,7 @@ void SceneManager::waitForPendingUserScalableTask()
 //---------------------------------------------------------------------
 unsigned long updateWorkerThread( ThreadHandle *threadHandle )
 {
+    Threads::ApplyThreadClass( ThreadClass::FrameCritical );
     SceneManager *sceneManager = reinterpret_cast<SceneManager*>( threadHandle->getUserParam() );
     return sceneManager->_updateWorkerThread( threadHandle );
 }
@@ -4696,11 +6524,25 @@ unsigned long SceneManager::_updateWorkerThread( ThreadHandle *threadHandle )
 {
     bool exitThread = false;
     size_t threadIdx = threadHandle->getThreadIdx();
+
+#if OGRE_PROFILING
+    char threadName[64];
+    snprintf( threadName, sizeof( threadName ), "SceneManager Worker %u",
+              static_cast<unsigned>( threadIdx ) );
+    OgreProfileThreadName( threadName );
+#endif
+
     while( !exitThread )
     {
         mWorkerThreadsBarrier->sync();
-        exitThread = updateWorkerThreadImpl( threadIdx );
-        mWorkerThreadsBarrier->sync();
+        {
+            OgreProfileWorker( "Worker Task" );
+            exitThread = updateWorkerThreadImpl( threadIdx );
+        }
+        {
+            OgreProfileWorker( "Worker Barrier" );
+            mWorkerThreadsBarrier->sync();
+        }
     }
 
     return 0;
@@ -4715,17 +6557,20 @@ inline bool SceneManager::updateWorkerThreadImpl( size_t threadIdx )
     case CULL_FRUSTUM:
         cullFrustum( mCurrentCullFrustumRequest, threadIdx );
         break;
+    case CULL_FRUSTUM_BATCH:
+        cullFrustumBatchThread( threadIdx );
+        break;
+    case BATCHED_SCENE_QUERY:
+        batchedSceneQueryThread( threadIdx );
+        break;
     case UPDATE_ALL_ANIMATIONS:
         updateAllAnimationsThread( threadIdx );
         break;
     case UPDATE_ALL_TRANSFORMS:
         updateAllTransformsThread( mUpdateTransformRequest, threadIdx );
         break;
-    case UPDATE_ALL_BONE_TO_TAG_TRANSFORMS:
-        updateAllTransformsBoneToTagThread( mUpdateTransformRequest, threadIdx );
-        break;
-    case UPDATE_ALL_TAG_ON_TAG_TRANSFORMS:
-        updateAllTransformsTagOnTagThread( mUpdateTransformRequest, threadIdx );
+    case UPDATE_ALL_TAG_POINTS:
+        updateAllTagPointsThread( threadIdx );
         break;
     case UPDATE_ALL_BOUNDS:
         updateAllBoundsThread( *mUpdateBoundsRequest, threadIdx );
@@ -4733,6 +6578,9 @@ inline bool SceneManager::updateWorkerThreadImpl( size_t threadIdx )
     case UPDATE_ALL_LODS:
         updateAllLodsThread( mUpdateLodRequest, threadIdx );
         break;
+    case UPDATE_ALL_PARTICLE_SYSTEMS:
+        updateAllParticleSystemsThread( threadIdx );
+        break;
     case BUILD_LIGHT_LIST01:
         buildLightListThread01( mBuildLightListRequestPerThread[threadIdx], threadIdx );
         break;
@@ -4742,6 +6590,9 @@ inline bool SceneManager::updateWorkerThreadImpl( size_t threadIdx )
     case USER_UNIFORM_SCALABLE_TASK:
         mUserTask->execute( threadIdx, mNumWorkerThreads );
         break;
+    case EXECUTE_FRAME_TASK_GRAPH:
+        mFrameTaskGraph->_executeWorker( threadIdx );
+        break;
     case STOP_THREADS:
         exitThread = true;
         break;
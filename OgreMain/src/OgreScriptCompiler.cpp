@@ -34,6 +34,9 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreStringConverter.h"
 #include "OgreString.h"
+#include "Hash/MurmurHash3.h"
+
+#include <fstream>
 
 namespace Ogre
 {
@@ -277,19 +280,68 @@ namespace Ogre
     }
 
     ScriptCompiler::ScriptCompiler()
-        :mListener(0)
+        :mListener(0), mAstCacheSourceHash(0)
     {
         initWordMap();
     }
 
     bool ScriptCompiler::compile(const String &str, const String &source, const String &group)
     {
+        if(isAstCacheEnabled())
+        {
+            const uint32 sourceHash = _hashScriptSource(str);
+
+            // Imports are looked up in this group when validating the cache
+            mGroup = group;
+
+            AbstractNodeListPtr ast;
+            if(loadAstCache(source, sourceHash, ast))
+            {
+                mErrors.clear();
+                mEnv.clear();
+                translate(ast);
+                return mErrors.empty();
+            }
+
+            ScriptLexer lexer;
+            ScriptParser parser;
+            ConcreteNodeListPtr nodes = parser.parse(lexer.tokenize(str), source);
+            return compile(nodes, source, sourceHash, group);
+        }
+
         ScriptLexer lexer;
         ScriptParser parser;
         ConcreteNodeListPtr nodes = parser.parse(lexer.tokenize(str), source);
         return compile(nodes, group);
     }
 
+    bool ScriptCompiler::compile(const ConcreteNodeListPtr &nodes, const String &source,
+                                 uint32 sourceHash, const String &group)
+    {
+        if(!isAstCacheEnabled())
+            return compile(nodes, group);
+
+        mAstCacheSource = source;
+        mAstCacheSourceHash = sourceHash;
+        mAstCacheDependencies.clear();
+
+        bool retVal = false;
+        try
+        {
+            retVal = compile(nodes, group);
+        }
+        catch(...)
+        {
+            mAstCacheSource.clear();
+            mAstCacheDependencies.clear();
+            throw;
+        }
+
+        mAstCacheSource.clear();
+        mAstCacheDependencies.clear();
+        return retVal;
+    }
+
 //  static void logAST(int tabs, const AbstractNodePtr &node)
 //  {
 //      String msg = "";
@@ -368,7 +420,22 @@ namespace Ogre
         // Allows early bail-out through the listener
         if(mListener && !mListener->postConversion(this, ast))
             return mErrors.empty();
-        
+
+        // Scripts with errors aren't cached, so they get reported every time
+        if(!mAstCacheSource.empty() && mErrors.empty())
+            saveAstCache(ast);
+
+        translate(ast);
+
+        mImports.clear();
+        mImportRequests.clear();
+        mImportTable.clear();
+
+        return mErrors.empty();
+    }
+
+    void ScriptCompiler::translate(const AbstractNodeListPtr &ast)
+    {
         // Translate the nodes
         for(AbstractNodeList::iterator i = ast->begin(); i != ast->end(); ++i)
         {
@@ -380,12 +447,6 @@ namespace Ogre
             if(translator)
                 translator->translate(this, *i);
         }
-
-        mImports.clear();
-        mImportRequests.clear();
-        mImportTable.clear();
-
-        return mErrors.empty();
     }
 
     AbstractNodeListPtr ScriptCompiler::_generateAST(const String &str, const String &source, bool doImports, bool doObjects, bool doVariables)
@@ -489,6 +550,429 @@ namespace Ogre
         return mGroup;
     }
 
+    void ScriptCompiler::setAstCacheFolder(const String &folder)
+    {
+        mAstCacheFolder = folder;
+    }
+
+    const String& ScriptCompiler::getAstCacheFolder() const
+    {
+        return mAstCacheFolder;
+    }
+
+    // AST cache
+    static const uint32 c_astCacheMagic     = 0x5453414F;  // 'OAST'
+    static const uint32 c_astCacheVersion   = 1u;
+
+    namespace
+    {
+        /// Serializes an AbstractNodeList into memory
+        class AstCacheWriter
+        {
+            String mBuffer;
+            /// Every node stores its file as an index into this table
+            typedef map<String, uint32>::type FileTable;
+            FileTable mFiles;
+            vector<const String*>::type mFileList;
+
+        public:
+            void writeUInt32( uint32 value )
+            {
+                mBuffer.append( reinterpret_cast<const char*>( &value ), sizeof(uint32) );
+            }
+            void writeString( const String &str )
+            {
+                writeUInt32( static_cast<uint32>( str.size() ) );
+                mBuffer.append( str );
+            }
+
+            /// Returns false if the list contains nodes that can't be cached
+            bool writeList( const AbstractNodeList &nodes, String &outNodeData )
+            {
+                String prevBuffer;
+                prevBuffer.swap( mBuffer );
+                const bool retVal = writeNodes( nodes );
+                outNodeData.swap( mBuffer );
+                mBuffer.swap( prevBuffer );
+                return retVal;
+            }
+
+            void writeFileTable(void)
+            {
+                writeUInt32( static_cast<uint32>( mFileList.size() ) );
+                for( size_t i=0; i<mFileList.size(); ++i )
+                    writeString( *mFileList[i] );
+            }
+
+            void append( const String &data )   { mBuffer.append( data ); }
+            const String& getBuffer(void) const { return mBuffer; }
+
+        private:
+            uint32 getFileIdx( const String &file )
+            {
+                FileTable::const_iterator itor = mFiles.find( file );
+                if( itor != mFiles.end() )
+                    return itor->second;
+
+                const uint32 idx = static_cast<uint32>( mFileList.size() );
+                itor = mFiles.insert( FileTable::value_type( file, idx ) ).first;
+                mFileList.push_back( &itor->first );
+                return idx;
+            }
+
+            bool writeNodes( const AbstractNodeList &nodes )
+            {
+                writeUInt32( static_cast<uint32>( nodes.size() ) );
+                AbstractNodeList::const_iterator itor = nodes.begin();
+                AbstractNodeList::const_iterator end  = nodes.end();
+                bool retVal = true;
+                while( itor != end && retVal )
+                {
+                    retVal = writeNode( itor->get() );
+                    ++itor;
+                }
+                return retVal;
+            }
+
+            bool writeNode( const AbstractNode *node )
+            {
+                writeUInt32( static_cast<uint32>( node->type ) );
+                writeUInt32( getFileIdx( node->file ) );
+                writeUInt32( node->line );
+
+                switch( node->type )
+                {
+                case ANT_ATOM:
+                    writeString( static_cast<const AtomAbstractNode*>( node )->value );
+                    return true;
+                case ANT_PROPERTY:
+                {
+                    const PropertyAbstractNode *prop = static_cast<const PropertyAbstractNode*>( node );
+                    writeString( prop->name );
+                    return writeNodes( prop->values );
+                }
+                case ANT_OBJECT:
+                {
+                    const ObjectAbstractNode *obj = static_cast<const ObjectAbstractNode*>( node );
+                    writeString( obj->name );
+                    writeString( obj->cls );
+                    writeUInt32( obj->abstract ? 1u : 0u );
+                    writeUInt32( static_cast<uint32>( obj->bases.size() ) );
+                    for( size_t i=0; i<obj->bases.size(); ++i )
+                        writeString( obj->bases[i] );
+
+                    const map<String,String>::type &variables = obj->getVariables();
+                    writeUInt32( static_cast<uint32>( variables.size() ) );
+                    map<String,String>::type::const_iterator itVar = variables.begin();
+                    map<String,String>::type::const_iterator enVar = variables.end();
+                    while( itVar != enVar )
+                    {
+                        writeString( itVar->first );
+                        writeString( itVar->second );
+                        ++itVar;
+                    }
+
+                    return writeNodes( obj->children ) && writeNodes( obj->values ) &&
+                           writeNodes( obj->overrides );
+                }
+                default:
+                    // Imports and variable accesses should be resolved by now.
+                    // If not, there was an error and the script isn't worth caching.
+                    return false;
+                }
+            }
+        };
+
+        /// Reads what AstCacheWriter wrote. Every read fails gracefully past the end.
+        class AstCacheReader
+        {
+            const char  *mData;
+            const char  *mDataEnd;
+            bool        mError;
+            vector<String>::type mFiles;
+            const ScriptCompiler::IdMap &mIds;
+
+        public:
+            AstCacheReader( const char *data, size_t size, const ScriptCompiler::IdMap &ids ) :
+                mData( data ), mDataEnd( data + size ), mError( false ), mIds( ids ) {}
+
+            bool hasError(void) const   { return mError; }
+
+            uint32 readUInt32(void)
+            {
+                uint32 value = 0;
+                if( mDataEnd - mData < static_cast<ptrdiff_t>( sizeof(uint32) ) )
+                {
+                    mError = true;
+                    return value;
+                }
+                memcpy( &value, mData, sizeof(uint32) );
+                mData += sizeof(uint32);
+                return value;
+            }
+            String readString(void)
+            {
+                const uint32 length = readUInt32();
+                if( mError || static_cast<size_t>( mDataEnd - mData ) < length )
+                {
+                    mError = true;
+                    return BLANKSTRING;
+                }
+                String retVal( mData, length );
+                mData += length;
+                return retVal;
+            }
+
+            void readFileTable(void)
+            {
+                const uint32 numFiles = readUInt32();
+                for( uint32 i=0; i<numFiles && !mError; ++i )
+                    mFiles.push_back( readString() );
+            }
+
+            void readNodes( AbstractNode *parent, AbstractNodeList &outNodes )
+            {
+                const uint32 numNodes = readUInt32();
+                for( uint32 i=0; i<numNodes && !mError; ++i )
+                {
+                    AbstractNode *node = readNode( parent );
+                    if( node )
+                        outNodes.push_back( AbstractNodePtr( node ) );
+                }
+            }
+
+        private:
+            uint32 getId( const String &word ) const
+            {
+                ScriptCompiler::IdMap::const_iterator itor = mIds.find( word );
+                return itor != mIds.end() ? itor->second : 0u;
+            }
+
+            AbstractNode* readNode( AbstractNode *parent )
+            {
+                const uint32 type = readUInt32();
+                const uint32 fileIdx = readUInt32();
+                const uint32 line = readUInt32();
+
+                if( mError || fileIdx >= mFiles.size() )
+                {
+                    mError = true;
+                    return 0;
+                }
+
+                AbstractNode *retVal = 0;
+                switch( type )
+                {
+                case ANT_ATOM:
+                {
+                    AtomAbstractNode *atom = OGRE_NEW AtomAbstractNode( parent );
+                    atom->value = readString();
+                    atom->id = getId( atom->value );
+                    retVal = atom;
+                    break;
+                }
+                case ANT_PROPERTY:
+                {
+                    PropertyAbstractNode *prop = OGRE_NEW PropertyAbstractNode( parent );
+                    prop->name = readString();
+                    prop->id = getId( prop->name );
+                    readNodes( prop, prop->values );
+                    retVal = prop;
+                    break;
+                }
+                case ANT_OBJECT:
+                {
+                    ObjectAbstractNode *obj = OGRE_NEW ObjectAbstractNode( parent );
+                    obj->name = readString();
+                    obj->cls = readString();
+                    obj->id = getId( obj->cls );
+                    obj->abstract = readUInt32() != 0u;
+                    const uint32 numBases = readUInt32();
+                    for( uint32 i=0; i<numBases && !mError; ++i )
+                        obj->bases.push_back( readString() );
+                    const uint32 numVariables = readUInt32();
+                    for( uint32 i=0; i<numVariables && !mError; ++i )
+                    {
+                        const String name = readString();
+                        obj->setVariable( name, readString() );
+                    }
+                    readNodes( obj, obj->children );
+                    readNodes( obj, obj->values );
+                    readNodes( obj, obj->overrides );
+                    retVal = obj;
+                    break;
+                }
+                default:
+                    mError = true;
+                    return 0;
+                }
+
+                retVal->file = mFiles[fileIdx];
+                retVal->line = line;
+                return retVal;
+            }
+        };
+
+        bool readFileContents( const String &filename, vector<char>::type &outData )
+        {
+            std::ifstream file( filename.c_str(), std::ios::in | std::ios::binary );
+            if( !file.is_open() )
+                return false;
+
+            file.seekg( 0, std::ios::end );
+            const std::streamoff fileSize = file.tellg();
+            file.seekg( 0, std::ios::beg );
+            if( fileSize <= 0 )
+                return false;
+
+            outData.resize( static_cast<size_t>( fileSize ) );
+            file.read( &outData[0], fileSize );
+            return !file.fail();
+        }
+
+        /// Reads and validates the header that precedes the dependencies
+        bool readAstCacheHeader( AstCacheReader &reader, const String &source, uint32 sourceHash )
+        {
+            const uint32 magic = reader.readUInt32();
+            const uint32 version = reader.readUInt32();
+            const uint32 ogreVersion = reader.readUInt32();
+            const uint32 cachedHash = reader.readUInt32();
+            if( reader.hasError() || magic != c_astCacheMagic || version != c_astCacheVersion ||
+                ogreVersion != OGRE_VERSION || cachedHash != sourceHash )
+            {
+                return false;
+            }
+            // The filename is a hash of the source name, which might collide
+            return reader.readString() == source && !reader.hasError();
+        }
+    }
+
+    uint32 ScriptCompiler::_hashScriptSource(const String &str)
+    {
+        uint32 hash = 0;
+        MurmurHash3_x86_32( str.c_str(), static_cast<int>( str.size() ), IdString::Seed, &hash );
+        return hash;
+    }
+
+    bool ScriptCompiler::_hasAstCache(const String &folder, const String &source, uint32 sourceHash)
+    {
+        vector<char>::type data;
+        if( !readFileContents( getAstCacheFilename( folder, source ), data ) )
+            return false;
+
+        const ScriptCompiler::IdMap noIds;
+        AstCacheReader reader( &data[0], data.size(), noIds );
+        return readAstCacheHeader( reader, source, sourceHash );
+    }
+
+    bool ScriptCompiler::isAstCacheEnabled() const
+    {
+        return !mAstCacheFolder.empty() && !mListener;
+    }
+
+    String ScriptCompiler::getAstCacheFilename(const String &folder, const String &source)
+    {
+        uint32 hash = 0;
+        MurmurHash3_x86_32( source.c_str(), static_cast<int>( source.size() ), IdString::Seed, &hash );
+
+        char filename[16];
+        snprintf( filename, sizeof(filename), "%08x.ast", hash );
+
+        if( folder[folder.size() - 1u] == '/' || folder[folder.size() - 1u] == '\\' )
+            return folder + filename;
+        return folder + "/" + filename;
+    }
+
+    bool ScriptCompiler::loadAstCache(const String &source, uint32 sourceHash,
+                                      AbstractNodeListPtr &outNodes)
+    {
+        vector<char>::type data;
+        if( !readFileContents( getAstCacheFilename( mAstCacheFolder, source ), data ) )
+            return false;
+
+        AstCacheReader reader( &data[0], data.size(), mIds );
+        if( !readAstCacheHeader( reader, source, sourceHash ) )
+            return false;
+
+        // Imported scripts must not have changed either
+        const uint32 numDependencies = reader.readUInt32();
+        for( uint32 i=0; i<numDependencies && !reader.hasError(); ++i )
+        {
+            const String name = reader.readString();
+            const uint32 hash = reader.readUInt32();
+            if( reader.hasError() || !ResourceGroupManager::getSingletonPtr() )
+                return false;
+
+            DataStreamPtr stream;
+            try
+            {
+                stream = ResourceGroupManager::getSingleton().openResource( name, mGroup );
+            }
+            catch( Exception& )
+            {
+                return false;
+            }
+
+            if( stream.isNull() || _hashScriptSource( stream->getAsString() ) != hash )
+                return false;
+        }
+
+        reader.readFileTable();
+        AbstractNodeListPtr nodes( OGRE_NEW AbstractNodeList() );
+        reader.readNodes( 0, *nodes );
+
+        if( reader.hasError() )
+        {
+            LogManager::getSingleton().logMessage( "AST cache for " + source + " is corrupt. "
+                                                   "Compiling the script instead." );
+            return false;
+        }
+
+        outNodes = nodes;
+        return true;
+    }
+
+    void ScriptCompiler::saveAstCache(const AbstractNodeListPtr &nodes)
+    {
+        AstCacheWriter writer;
+
+        String nodeData;
+        if( !writer.writeList( *nodes, nodeData ) )
+            return;
+
+        writer.writeUInt32( c_astCacheMagic );
+        writer.writeUInt32( c_astCacheVersion );
+        writer.writeUInt32( OGRE_VERSION );
+        writer.writeUInt32( mAstCacheSourceHash );
+        writer.writeString( mAstCacheSource );
+
+        writer.writeUInt32( static_cast<uint32>( mAstCacheDependencies.size() ) );
+        AstCacheDependencyVec::const_iterator itor = mAstCacheDependencies.begin();
+        AstCacheDependencyVec::const_iterator end  = mAstCacheDependencies.end();
+        while( itor != end )
+        {
+            writer.writeString( itor->first );
+            writer.writeUInt32( itor->second );
+            ++itor;
+        }
+
+        writer.writeFileTable();
+        writer.append( nodeData );
+
+        const String filename = getAstCacheFilename( mAstCacheFolder, mAstCacheSource );
+        std::ofstream file( filename.c_str(), std::ios::out | std::ios::binary );
+        if( file.is_open() )
+        {
+            file.write( writer.getBuffer().c_str(),
+                        static_cast<std::streamsize>( writer.getBuffer().size() ) );
+        }
+        else
+        {
+            LogManager::getSingleton().logMessage( "Could not write AST cache " + filename +
+                                                   " for " + mAstCacheSource );
+        }
+    }
+
     bool ScriptCompiler::_fireEvent(ScriptCompilerEvent *evt, void *retval)
     {
         if(mListener)
@@ -596,9 +1080,13 @@ namespace Ogre
             DataStreamPtr stream = ResourceGroupManager::getSingleton().openResource(name, mGroup);
             if(!stream.isNull())
             {
+                const String str = stream->getAsString();
+                if(!mAstCacheSource.empty())
+                    mAstCacheDependencies.push_back(std::make_pair(name, _hashScriptSource(str)));
+
                 ScriptLexer lexer;
                 ScriptParser parser;
-                nodes = parser.parse(lexer.tokenize(stream->getAsString()), name);
+                nodes = parser.parse(lexer.tokenize(str), name);
             }
         }
 
@@ -1219,6 +1707,7 @@ namespace Ogre
         mIds["connect_output"]  = ID_CONNECT_OUTPUT;
         mIds["connect_external"]= ID_CONNECT_EXTERNAL;
         mIds["connect_buffer_external"] = ID_CONNECT_BUFFER_EXTERNAL;
+        mIds["alias_transient_textures"] = ID_ALIAS_TRANSIENT_TEXTURES;
 
         mIds["compositor_node"] = ID_COMPOSITOR_NODE;
         mIds["in"]              = ID_IN;
@@ -1249,6 +1738,7 @@ namespace Ogre
         mIds["msaa_auto"]           = ID_MSAA_AUTO;
         mIds["explicit_resolve"]    = ID_EXPLICIT_RESOLVE;
         mIds["reinterpretable"]     = ID_REINTERPRETABLE;
+        mIds["keep_content"]        = ID_KEEP_CONTENT;
         mIds["depth_pool"]          = ID_DEPTH_POOL;
         mIds["depth_texture"]       = ID_DEPTH_TEXTURE;
         mIds["depth_format"]        = ID_DEPTH_FORMAT;
@@ -1291,7 +1781,10 @@ namespace Ogre
         mIds["allow_write_after_write"] = ID_ALLOW_WRITE_AFTER_WRITE;
         mIds["expose"]          = ID_EXPOSE;
         mIds["shadow_map_full_viewport"]= ID_SHADOW_MAP_FULL_VIEWPORT;
+        mIds["shadow_map_cache"]= ID_SHADOW_MAP_CACHE;
         mIds["profiling_id"]    = ID_PROFILING_ID;
+        mIds["async"]           = ID_ASYNC;
+        mIds["cache_result"]    = ID_CACHE_RESULT;
         mIds["lod_bias"]        = ID_LOD_BIAS;
         mIds["lod_update_list"] = ID_LOD_UPDATE_LIST;
         mIds["lod_camera"]      = ID_LOD_CAMERA;
@@ -1310,11 +1803,17 @@ namespace Ogre
         mIds["is_prepass"]      = ID_IS_PREPASS;
         mIds["use_prepass"]     = ID_USE_PREPASS;
         mIds["gen_normals_gbuffer"]= ID_GEN_NORMALS_GBUFFER;
+        mIds["gen_gbuffer"]     = ID_GEN_GBUFFER;
+        mIds["gen_motion_vectors"]= ID_GEN_MOTION_VECTORS;
+        mIds["temporal_jitter"] = ID_TEMPORAL_JITTER;
         mIds["use_refractions"] = ID_USE_REFRACTIONS;
         mIds["uv_baking"]       = ID_UV_BAKING;
         mIds["uv_baking_offset"]= ID_UV_BAKING_OFFSET;
         mIds["bake_lighting_only"] = ID_BAKE_LIGHTING_ONLY;
         mIds["instanced_stereo"]= ID_INSTANCED_STEREO;
+        mIds["radial_density_mask"]= ID_RADIAL_DENSITY_MASK;
+        mIds["auto_depth_prepass"]= ID_AUTO_DEPTH_PREPASS;
+        mIds["oit"]             = ID_OIT;
 
         mIds["use_quad"]        = ID_USE_QUAD;
         mIds["quad_normals"]    = ID_QUAD_NORMALS;
@@ -1326,6 +1825,7 @@ namespace Ogre
         mIds["camera_far_corners_world_space"]  = ID_CAMERA_FAR_CORNERS_WORLD_SPACE;
         mIds["camera_far_corners_world_space_centered"] = ID_CAMERA_FAR_CORNERS_WORLD_SPACE_CENTERED;
         mIds["camera_direction"]                = ID_CAMERA_DIRECTION;
+        mIds["reproject"]                       = ID_REPROJECT;
         mIds["input"]           = ID_INPUT;
         mIds["output"]          = ID_OUTPUT;
 
@@ -1363,13 +1863,17 @@ namespace Ogre
         mIds["keep_previous_uavs"]= ID_KEEP_PREVIOUS_UAV;
 
         mIds["job"]             = ID_JOB;
+        mIds["forward_plus_lights"] = ID_FORWARD_PLUS_LIGHTS;
 
         mIds["mipmap_method"]   = ID_MIPMAP_METHOD;
         mIds["api_default"]     = ID_API_DEFAULT;
         //mIds["compute"]       = ID_COMPUTE;
         mIds["compute_hq"]      = ID_COMPUTE_HQ;
+        mIds["compute_single_pass"] = ID_COMPUTE_SINGLE_PASS;
         mIds["kernel_radius"]   = ID_KERNEL_RADIUS;
         mIds["gauss_deviation"] = ID_GAUSS_DEVIATION;
+        mIds["mipmap_reduction"]= ID_MIPMAP_REDUCTION;
+        mIds["average"]         = ID_AVERAGE;
 
         mIds["samples_per_iteration"] = ID_SAMPLES_PER_ITERATION;
         mIds["samples_single_iteration_fallback"] = ID_SAMPLES_SINGLE_ITERATION_FALLBACK;
@@ -1736,6 +2240,17 @@ namespace Ogre
         return mListener;
     }
     //-----------------------------------------------------------------------
+    void ScriptCompilerManager::setAstCacheFolder(const String &folder)
+    {
+            OGRE_LOCK_AUTO_MUTEX;
+        mAstCacheFolder = folder;
+    }
+    //-----------------------------------------------------------------------
+    const String& ScriptCompilerManager::getAstCacheFolder() const
+    {
+        return mAstCacheFolder;
+    }
+    //-----------------------------------------------------------------------
     void ScriptCompilerManager::addTranslatorManager(Ogre::ScriptTranslatorManager *man)
     {
             OGRE_LOCK_AUTO_MUTEX;
@@ -1814,9 +2329,79 @@ namespace Ogre
         {
                     OGRE_LOCK_AUTO_MUTEX;
             OGRE_THREAD_POINTER_GET(mScriptCompiler)->setListener(mListener);
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setAstCacheFolder(mAstCacheFolder);
         }
         OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile(stream->getAsString(), stream->getName(), groupName);
     }
+    //-------------------------------------------------------------------------
+    namespace
+    {
+        class PreparedScriptNodes : public ScriptLoader::PreparedScript
+        {
+        public:
+            ConcreteNodeListPtr nodes;
+            uint32              sourceHash;
+        };
+    }
+    //-------------------------------------------------------------------------
+    ScriptLoader::PreparedScript* ScriptCompilerManager::prepareScript( DataStreamPtr& stream,
+                                                                        const String& groupName )
+    {
+        // Lexing and parsing don't touch anything but the script. Syntax errors are
+        // left to parseScript, so they get reported on the main thread as usual.
+        const String str = stream->getAsString();
+        const uint32 sourceHash = ScriptCompiler::_hashScriptSource( str );
+
+        // Nothing to prepare if the AST cache is up to date; parseScript will use it
+        String astCacheFolder;
+        bool hasListener;
+        {
+                    OGRE_LOCK_AUTO_MUTEX;
+            astCacheFolder = mAstCacheFolder;
+            hasListener = mListener != 0;
+        }
+        if( !astCacheFolder.empty() && !hasListener &&
+            ScriptCompiler::_hasAstCache( astCacheFolder, stream->getName(), sourceHash ) )
+        {
+            return 0;
+        }
+
+        ConcreteNodeListPtr nodes;
+        try
+        {
+            ScriptLexer lexer;
+            ScriptParser parser;
+            nodes = parser.parse(lexer.tokenize(str), stream->getName());
+        }
+        catch( Exception& )
+        {
+            return 0;
+        }
+
+        PreparedScriptNodes *preparedScript = OGRE_NEW PreparedScriptNodes();
+        preparedScript->nodes = nodes;
+        preparedScript->sourceHash = sourceHash;
+        return preparedScript;
+    }
+    //-------------------------------------------------------------------------
+    void ScriptCompilerManager::parsePreparedScript( PreparedScript *preparedScript,
+                                                     DataStreamPtr& stream,
+                                                     const String& groupName )
+    {
+#if OGRE_THREAD_SUPPORT
+        if (!OGRE_THREAD_POINTER_GET(mScriptCompiler))
+            OGRE_THREAD_POINTER_SET(mScriptCompiler, OGRE_NEW ScriptCompiler());
+#endif
+        {
+                    OGRE_LOCK_AUTO_MUTEX;
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setListener(mListener);
+            OGRE_THREAD_POINTER_GET(mScriptCompiler)->setAstCacheFolder(mAstCacheFolder);
+        }
+        const PreparedScriptNodes *preparedNodes =
+                static_cast<const PreparedScriptNodes*>( preparedScript );
+        OGRE_THREAD_POINTER_GET(mScriptCompiler)->compile(preparedNodes->nodes, stream->getName(),
+                                                          preparedNodes->sourceHash, groupName);
+    }
 
     //-------------------------------------------------------------------------
     String PreApplyTextureAliasesScriptCompilerEvent::eventType = "preApplyTextureAliases";
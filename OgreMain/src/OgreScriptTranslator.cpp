@@ -6262,6 +6262,7 @@ namespace Ogre{
         uint16 depthBufferId = DepthBuffer::POOL_INVALID;
         PixelFormatGpu depthBufferFormat = PFG_UNKNOWN;
         bool preferDepthTexture = false;
+        bool preserveContent = false;
         uint8 numMipmaps = 1u;
         bool noAutomipmaps = false;
         PixelFormatGpu format;
@@ -6357,6 +6358,9 @@ namespace Ogre{
             case ID_REINTERPRETABLE:
                 textureFlags |= TextureFlags::Reinterpretable;
                 break;
+            case ID_KEEP_CONTENT:
+                preserveContent = true;
+                break;
             case ID_DEPTH_POOL:
                 {
                     // advance to next to get the ID
@@ -6506,6 +6510,7 @@ namespace Ogre{
         td->depthBufferId       = depthBufferId;
         td->preferDepthTexture  = preferDepthTexture;
         td->depthBufferFormat   = depthBufferFormat;
+        td->preserveContent     = preserveContent;
 
         RenderTargetViewDef *rtv = defBase->addRenderTextureView( atom0->value );
         if( format == PFG_UNKNOWN || !PixelFormatGpuUtils::isDepth( format ) )
@@ -6938,6 +6943,22 @@ namespace Ogre{
                             compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line);
                     }
                     break;
+                case ID_ALIAS_TRANSIENT_TEXTURES:
+                    if(prop->values.size() != 1)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                            "alias_transient_textures only supports 1 argument");
+                    }
+                    else
+                    {
+                        bool val = false;
+                        if( getBoolean( prop->values.front(), &val ) )
+                            mWorkspaceDef->setAliasTransientTextures( val );
+                        else
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line,
+                                "alias_transient_textures argument must be \"true\", \"false\", \"yes\", \"no\", \"on\", or \"off\"");
+                    }
+                    break;
                 default:
                     compiler->addError(ScriptCompiler::CE_UNEXPECTEDTOKEN, prop->file, prop->line, 
                         "token \"" + prop->name + "\" is not recognized");
@@ -9056,7 +9077,9 @@ namespace Ogre{
                 case ID_USES_UAV:
                 case ID_COLOUR_WRITE:
                 case ID_SHADOW_MAP_FULL_VIEWPORT:
+                case ID_SHADOW_MAP_CACHE:
                 case ID_PROFILING_ID:
+                case ID_CACHE_RESULT:
                     break;
                 default:
                     compiler->addError(ScriptCompiler::CE_UNEXPECTEDTOKEN, prop->file, prop->line, 
@@ -9200,6 +9223,30 @@ namespace Ogre{
                         }
                     }
                     break;
+                case ID_REPROJECT:
+                    {
+                        if(prop->values.size() != 1)
+                        {
+                            compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                                               "reproject requires one parameter: off, always or when_late");
+                            return;
+                        }
+
+                        String mode;
+                        getString( prop->values.front(), &mode );
+                        if( mode == "off" )
+                            passQuad->mReprojection = CompositorPassQuadDef::ReprojectionOff;
+                        else if( mode == "always" )
+                            passQuad->mReprojection = CompositorPassQuadDef::ReprojectionAlways;
+                        else if( mode == "when_late" )
+                            passQuad->mReprojection = CompositorPassQuadDef::ReprojectionWhenLate;
+                        else
+                        {
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line,
+                                               "reproject must be off, always or when_late");
+                        }
+                    }
+                    break;
                 case ID_CAMERA:
                     {
                         if(prop->values.empty())
@@ -9293,7 +9340,9 @@ namespace Ogre{
                 case ID_EXPOSE:
                 case ID_COLOUR_WRITE:
                 case ID_SHADOW_MAP_FULL_VIEWPORT:
+                case ID_SHADOW_MAP_CACHE:
                 case ID_PROFILING_ID:
+                case ID_CACHE_RESULT:
                     break;
                 default:
                     compiler->addError(ScriptCompiler::CE_UNEXPECTEDTOKEN, prop->file, prop->line, 
@@ -9681,6 +9730,60 @@ namespace Ogre{
                         }
                     }
                     break;
+                case ID_GEN_GBUFFER:
+                    if( prop->values.size() != 1 )
+                    {
+                        compiler->addError(
+                            ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                            "gen_gbuffer requires exactly one parameter (boolean)" );
+                    }
+                    else
+                    {
+                        AbstractNodeList::const_iterator it0 = prop->values.begin();
+
+                        if( !getBoolean( *it0, &passScene->mGenGBuffer ) )
+                        {
+                            compiler->addError( ScriptCompiler::CE_INVALIDPARAMETERS, prop->file,
+                                                prop->line, "gen_gbuffer must be a boolean" );
+                        }
+                    }
+                    break;
+                case ID_GEN_MOTION_VECTORS:
+                    if( prop->values.size() != 1 )
+                    {
+                        compiler->addError(
+                            ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                            "gen_motion_vectors requires exactly one parameter (boolean)" );
+                    }
+                    else
+                    {
+                        AbstractNodeList::const_iterator it0 = prop->values.begin();
+
+                        if( !getBoolean( *it0, &passScene->mGenMotionVectors ) )
+                        {
+                            compiler->addError( ScriptCompiler::CE_INVALIDPARAMETERS, prop->file,
+                                                prop->line, "gen_motion_vectors must be a boolean" );
+                        }
+                    }
+                    break;
+                case ID_TEMPORAL_JITTER:
+                    if( prop->values.size() != 1 )
+                    {
+                        compiler->addError(
+                            ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                            "temporal_jitter requires exactly one parameter (boolean)" );
+                    }
+                    else
+                    {
+                        AbstractNodeList::const_iterator it0 = prop->values.begin();
+
+                        if( !getBoolean( *it0, &passScene->mTemporalJitter ) )
+                        {
+                            compiler->addError( ScriptCompiler::CE_INVALIDPARAMETERS, prop->file,
+                                                prop->line, "temporal_jitter must be a boolean" );
+                        }
+                    }
+                    break;
                 case ID_USE_REFRACTIONS:
                     if( prop->values.size() != 2u )
                     {
@@ -9784,6 +9887,136 @@ namespace Ogre{
                         }
                     }
                     break;
+                case ID_RADIAL_DENSITY_MASK:
+                    if(prop->values.size() != 3 && prop->values.size() != 4)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                                           "radial_density_mask requires 3 radiuses and "
+                                           "optionally a quality [low|medium|high]");
+                    }
+                    else
+                    {
+                        AbstractNodeList::const_iterator it0 = prop->values.begin();
+
+                        passScene->mRadialDensityMask = true;
+                        for( size_t radiusIdx=0; radiusIdx<3u; ++radiusIdx )
+                        {
+                            if( !getFloat( *it0, &passScene->mRdmRadius[radiusIdx] ) )
+                            {
+                                compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS,
+                                                   prop->file, prop->line,
+                                                   "radial_density_mask radiuses must be numbers");
+                            }
+                            ++it0;
+                        }
+
+                        if( it0 != prop->values.end() )
+                        {
+                            String quality;
+                            getString( *it0, &quality );
+                            if( quality == "low" )
+                                passScene->mRdmQuality = 0u;
+                            else if( quality == "medium" )
+                                passScene->mRdmQuality = 1u;
+                            else if( quality == "high" )
+                                passScene->mRdmQuality = 2u;
+                            else
+                            {
+                                compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS,
+                                                   prop->file, prop->line,
+                                                   "radial_density_mask quality must be "
+                                                   "low, medium or high");
+                            }
+                        }
+                    }
+                    break;
+                case ID_OIT:
+                    if( prop->values.size() != 1 )
+                    {
+                        compiler->addError(
+                            ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                            "oit requires exactly one parameter (off or weighted_blended)" );
+                    }
+                    else
+                    {
+                        AbstractNodeList::const_iterator it0 = prop->values.begin();
+
+                        String mode;
+                        getString( *it0, &mode );
+                        if( mode == "off" || mode == "false" )
+                            passScene->mOitMode = OitMode::Off;
+                        else if( mode == "weighted_blended" )
+                            passScene->mOitMode = OitMode::WeightedBlended;
+                        else
+                        {
+                            compiler->addError( ScriptCompiler::CE_INVALIDPARAMETERS,
+                                                prop->file, prop->line,
+                                                "oit must be off or weighted_blended" );
+                        }
+                    }
+                    break;
+                case ID_AUTO_DEPTH_PREPASS:
+                    if(prop->values.empty() || prop->values.size() > 4)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                                           "auto_depth_prepass requires off, on or auto and "
+                                           "optionally [overdraw_threshold [min_occluder_size "
+                                           "[max_occluder_vertices]]]");
+                    }
+                    else
+                    {
+                        AbstractNodeList::const_iterator it0 = prop->values.begin();
+
+                        String mode;
+                        getString( *it0, &mode );
+                        if( mode == "off" || mode == "false" )
+                            passScene->mAutoDepthPrePass = AutoDepthPrePass::Off;
+                        else if( mode == "on" || mode == "true" )
+                            passScene->mAutoDepthPrePass = AutoDepthPrePass::Always;
+                        else if( mode == "auto" )
+                            passScene->mAutoDepthPrePass = AutoDepthPrePass::Auto;
+                        else
+                        {
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS,
+                                               prop->file, prop->line,
+                                               "auto_depth_prepass must be off, on or auto");
+                        }
+                        ++it0;
+
+                        if( it0 != prop->values.end() )
+                        {
+                            if( !getReal( *it0, &passScene->mAutoPrePassOverdrawThreshold ) )
+                            {
+                                compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS,
+                                                   prop->file, prop->line,
+                                                   "auto_depth_prepass overdraw_threshold "
+                                                   "must be a number");
+                            }
+                            ++it0;
+                        }
+                        if( it0 != prop->values.end() )
+                        {
+                            if( !getReal( *it0, &passScene->mAutoPrePassMinOccluderSize ) )
+                            {
+                                compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS,
+                                                   prop->file, prop->line,
+                                                   "auto_depth_prepass min_occluder_size "
+                                                   "must be a number");
+                            }
+                            ++it0;
+                        }
+                        if( it0 != prop->values.end() )
+                        {
+                            if( !getUInt( *it0, &passScene->mAutoPrePassMaxOccluderVertices ) )
+                            {
+                                compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS,
+                                                   prop->file, prop->line,
+                                                   "auto_depth_prepass max_occluder_vertices "
+                                                   "must be an unsigned number");
+                            }
+                        }
+                    }
+                    break;
                 case ID_MATERIAL_SCHEME:
                     {
                         if (prop->values.empty())
@@ -9810,7 +10043,9 @@ namespace Ogre{
                 case ID_EXPOSE:
                 case ID_COLOUR_WRITE:
                 case ID_SHADOW_MAP_FULL_VIEWPORT:
+                case ID_SHADOW_MAP_CACHE:
                 case ID_PROFILING_ID:
+                case ID_CACHE_RESULT:
                     break;
                 default:
                     compiler->addError(ScriptCompiler::CE_UNEXPECTEDTOKEN, prop->file, prop->line, 
@@ -9818,6 +10053,13 @@ namespace Ogre{
                 }
             }
         }
+
+        if( passScene->mRadialDensityMask && !passScene->mInstancedStereo )
+        {
+            compiler->addError( ScriptCompiler::CE_INVALIDPARAMETERS, obj->file, obj->line,
+                                "radial_density_mask requires instanced_stereo to be enabled "
+                                "in the same pass" );
+        }
     }
 
     void CompositorPassTranslator::translateStencil(ScriptCompiler *compiler, const AbstractNodePtr &node,
@@ -10245,6 +10487,22 @@ namespace Ogre{
                     passCompute->mJobName = jobName;
                 }
                     break;
+                case ID_FORWARD_PLUS_LIGHTS:
+                {
+                    uint32 slot = 0;
+                    if( prop->values.size() != 1 || !getUInt( prop->values.front(), &slot ) ||
+                        slot >= 0xFF )
+                    {
+                        compiler->addError( ScriptCompiler::CE_INVALIDPARAMETERS, prop->file,
+                                            prop->line,
+                                            "forward_plus_lights expects the texture slot "
+                                            "to bind the light list to" );
+                        return;
+                    }
+
+                    passCompute->mForwardPlusLightsSlot = static_cast<uint8>( slot );
+                }
+                    break;
                 case ID_CAMERA:
                 {
                     if(prop->values.empty())
@@ -10493,6 +10751,7 @@ namespace Ogre{
                 //case ID_COLOUR_WRITE:
                 case ID_SHADOW_MAP_FULL_VIEWPORT:
                 case ID_PROFILING_ID:
+                case ID_ASYNC:
                     break;
                 default:
                     compiler->addError(ScriptCompiler::CE_UNEXPECTEDTOKEN, prop->file, prop->line,
@@ -10548,17 +10807,55 @@ namespace Ogre{
                             case ID_COMPUTE_HQ:
                                 passMipmap->mMipmapGenerationMethod = CompositorPassMipmapDef::ComputeHQ;
                                 break;
+                            case ID_COMPUTE_SINGLE_PASS:
+                                passMipmap->mMipmapGenerationMethod =
+                                        CompositorPassMipmapDef::ComputeSinglePass;
+                                break;
                             default:
                                 compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line,
                                                    prop->values.front()->getValue() +
-                                                   " is not a valid miprmap_method (api_default, compute, or compute_hq)");
+                                                   " is not a valid miprmap_method (api_default, compute, "
+                                                   "compute_hq or compute_single_pass)");
                             }
                         }
                         else
                         {
                             compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line,
                                                prop->values.front()->getValue() +
-                                               " is not a valid miprmap_method (api_default, compute, or compute_hq)");
+                                               " is not a valid miprmap_method (api_default, compute, "
+                                               "compute_hq or compute_single_pass)");
+                        }
+                    }
+                break;
+                case ID_MIPMAP_REDUCTION:
+                    if(prop->values.empty())
+                    {
+                        compiler->addError(ScriptCompiler::CE_STRINGEXPECTED, prop->file, prop->line);
+                    }
+                    else if(prop->values.size() > 1)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                                           "mipmap_reduction must have at most 1 argument");
+                    }
+                    else
+                    {
+                        const uint32 atomId = prop->values.front()->type == ANT_ATOM ?
+                                    ((AtomAbstractNode*)prop->values.front().get())->id : 0u;
+                        switch(atomId)
+                        {
+                        case ID_AVERAGE:
+                            passMipmap->mReduction = DownsampleReduction::Average;
+                            break;
+                        case ID_MIN:
+                            passMipmap->mReduction = DownsampleReduction::Min;
+                            break;
+                        case ID_MAX:
+                            passMipmap->mReduction = DownsampleReduction::Max;
+                            break;
+                        default:
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line,
+                                               prop->values.front()->getValue() +
+                                               " is not a valid mipmap_reduction (average, min or max)");
                         }
                     }
                 break;
@@ -11198,6 +11495,31 @@ namespace Ogre{
                         }
                     }
                     break;
+                case ID_SHADOW_MAP_CACHE:
+                    if(prop->values.empty())
+                    {
+                        compiler->addError(ScriptCompiler::CE_NUMBEREXPECTED, prop->file, prop->line);
+                    }
+                    else if(prop->values.size() > 1)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line,
+                            "shadow_map_cache only supports 1 argument");
+                    }
+                    else
+                    {
+                        uint32 shadowMapIdx = 0;
+                        if( !getUInt( prop->values.front(), &shadowMapIdx ) )
+                        {
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line,
+                                "shadow_map_cache argument must be the index of a shadow map");
+                        }
+                        else
+                        {
+                            mPassDef->mShadowMapIdx     = shadowMapIdx;
+                            mPassDef->mShadowMapCache   = true;
+                        }
+                    }
+                    break;
                 case ID_PROFILING_ID:
                     if(prop->values.empty())
                     {
@@ -11217,6 +11539,44 @@ namespace Ogre{
                         }
                     }
                     break;
+                case ID_ASYNC:
+                    if(prop->values.empty())
+                    {
+                        compiler->addError(ScriptCompiler::CE_STRINGEXPECTED, prop->file, prop->line);
+                        return;
+                    }
+                    else if (prop->values.size() > 1)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line);
+                        return;
+                    }
+                    else
+                    {
+                        if( !getBoolean(prop->values.front(), &mPassDef->mAsyncCompute) )
+                        {
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line);
+                        }
+                    }
+                    break;
+                case ID_CACHE_RESULT:
+                    if(prop->values.empty())
+                    {
+                        compiler->addError(ScriptCompiler::CE_STRINGEXPECTED, prop->file, prop->line);
+                        return;
+                    }
+                    else if (prop->values.size() > 1)
+                    {
+                        compiler->addError(ScriptCompiler::CE_FEWERPARAMETERSEXPECTED, prop->file, prop->line);
+                        return;
+                    }
+                    else
+                    {
+                        if( !getBoolean(prop->values.front(), &mPassDef->mCacheResult) )
+                        {
+                            compiler->addError(ScriptCompiler::CE_INVALIDPARAMETERS, prop->file, prop->line);
+                        }
+                    }
+                    break;
                 }
             }
         }
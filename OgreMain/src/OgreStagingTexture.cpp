@@ -184,6 +184,8 @@ namespace Ogre
             dstSysRamBox.copyFrom( *cpuSrcBox );
         }
 
+        dstTexture->_notifyContentChanged();
+
         mLastFrameUsed = mVaoManager->getFrameCount();
     }
 }
@@ -735,6 +735,7 @@ namespace v1 {
             const MeshLodUsage& meshLod = qmesh->submesh->parent->getLodLevel(lod);
             mLodValues[lod] = Ogre::max(mLodValues[lod], meshLod.value);
         }
+        mObjectData.invalidateLodRange();
 
         // update bounds
         // Transform world bounds relative to our centre
@@ -744,6 +745,7 @@ namespace v1 {
         regionAabb.merge( localAabb );
         mObjectData.mLocalAabb->setFromAabb( regionAabb, mObjectData.mIndex );
         mObjectData.mLocalRadius[mObjectData.mIndex] = regionAabb.getRadius();
+        mObjectData.invalidateBounds();
     }
     //--------------------------------------------------------------------------
     void StaticGeometry::Region::build( bool parentVisible )
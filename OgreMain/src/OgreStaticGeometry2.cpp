@@ -0,0 +1,1084 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreStaticGeometry2.h"
+
+#include "OgreItem.h"
+#include "OgreSubItem.h"
+#include "OgreSubMesh2.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreRenderSystem.h"
+#include "OgreBitwise.h"
+#include "OgreException.h"
+#include "OgreId.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreIndexBufferPacked.h"
+#include "Vao/OgreAsyncTicket.h"
+
+namespace Ogre
+{
+    #define REGION_HALF_RANGE 512
+    #define REGION_MAX_INDEX 511
+    #define REGION_MIN_INDEX -512
+
+    unsigned long staticGeometryMergeThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::Background );
+        StaticGeometry *staticGeometry = reinterpret_cast<StaticGeometry*>(
+                                             threadHandle->getUserParam() );
+        staticGeometry->_mergeThread();
+        return 0;
+    }
+    THREAD_DECLARE( staticGeometryMergeThread );
+
+    namespace
+    {
+        /// Copies [elementStart; elementStart + elementCount) of the buffer to outData,
+        /// from the shadow copy if there's one, otherwise from the GPU.
+        void downloadBuffer( BufferPacked *buffer, size_t elementStart, size_t elementCount,
+                             void *outData )
+        {
+            const size_t bytesPerElement = buffer->getBytesPerElement();
+            if( buffer->getShadowCopy() )
+            {
+                const uint8 *shadowCopy = reinterpret_cast<const uint8*>( buffer->getShadowCopy() );
+                memcpy( outData, shadowCopy + elementStart * bytesPerElement,
+                        elementCount * bytesPerElement );
+            }
+            else
+            {
+                AsyncTicketPtr asyncTicket = buffer->readRequest( elementStart, elementCount );
+                const void *srcData = asyncTicket->map();
+                memcpy( outData, srcData, elementCount * bytesPerElement );
+                asyncTicket->unmap();
+            }
+        }
+
+        inline Vector3 readVector3( const uint8 *src, VertexElementType type )
+        {
+            if( type == VET_HALF4 )
+            {
+                const uint16 *src16 = reinterpret_cast<const uint16*>( src );
+                return Vector3( Bitwise::halfToFloat( src16[0] ),
+                                Bitwise::halfToFloat( src16[1] ),
+                                Bitwise::halfToFloat( src16[2] ) );
+            }
+
+            const float *srcF = reinterpret_cast<const float*>( src );
+            return Vector3( srcF[0], srcF[1], srcF[2] );
+        }
+
+        inline void writeVector3( uint8 *dst, VertexElementType type, const Vector3 &value )
+        {
+            if( type == VET_HALF4 )
+            {
+                uint16 *dst16 = reinterpret_cast<uint16*>( dst );
+                dst16[0] = Bitwise::floatToHalf( static_cast<float>( value.x ) );
+                dst16[1] = Bitwise::floatToHalf( static_cast<float>( value.y ) );
+                dst16[2] = Bitwise::floatToHalf( static_cast<float>( value.z ) );
+            }
+            else
+            {
+                float *dstF = reinterpret_cast<float*>( dst );
+                dstF[0] = static_cast<float>( value.x );
+                dstF[1] = static_cast<float>( value.y );
+                dstF[2] = static_cast<float>( value.z );
+            }
+        }
+
+        /// Flips the sign of the 4th component (the handedness of a tangent)
+        inline void flipW( uint8 *dst, VertexElementType type )
+        {
+            if( type == VET_HALF4 )
+            {
+                uint16 *dst16 = reinterpret_cast<uint16*>( dst );
+                dst16[3] = Bitwise::floatToHalf( -Bitwise::halfToFloat( dst16[3] ) );
+            }
+            else if( type == VET_FLOAT4 )
+            {
+                float *dstF = reinterpret_cast<float*>( dst );
+                dstF[3] = -dstF[3];
+            }
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::Batch::Batch( Region *parent, const VertexArrayObjectArray &vaos ) :
+        mParent( parent )
+    {
+        mVaoPerLod[VpNormal] = vaos;
+        mVaoPerLod[VpShadow] = vaos;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::Batch::_destroyVaos( VaoManager *vaoManager )
+    {
+        VertexArrayObjectArray &vaos = mVaoPerLod[VpNormal];
+        if( !vaos.empty() )
+        {
+            //All LODs share the same vertex buffers
+            const VertexBufferPackedVec vertexBuffers = vaos.front()->getVertexBuffers();
+
+            VertexArrayObjectArray::const_iterator itor = vaos.begin();
+            VertexArrayObjectArray::const_iterator end  = vaos.end();
+            while( itor != end )
+            {
+                IndexBufferPacked *indexBuffer = (*itor)->getIndexBuffer();
+                vaoManager->destroyVertexArrayObject( *itor );
+                if( indexBuffer )
+                    vaoManager->destroyIndexBuffer( indexBuffer );
+                ++itor;
+            }
+
+            VertexBufferPackedVec::const_iterator itBuffers = vertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator enBuffers = vertexBuffers.end();
+            while( itBuffers != enBuffers )
+                vaoManager->destroyVertexBuffer( *itBuffers++ );
+        }
+
+        mVaoPerLod[VpNormal].clear();
+        mVaoPerLod[VpShadow].clear();
+    }
+    //-----------------------------------------------------------------------------------
+    const LightList& StaticGeometry::Batch::getLights(void) const
+    {
+        return mParent->queryLights();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::Batch::getRenderOperation( v1::RenderOperation &op, bool casterPass )
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "StaticGeometry::Batch does not implement getRenderOperation."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "StaticGeometry::Batch::getRenderOperation" );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::Batch::getWorldTransforms( Matrix4 *xform ) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "StaticGeometry::Batch does not implement getWorldTransforms."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "StaticGeometry::Batch::getWorldTransforms" );
+    }
+    //-----------------------------------------------------------------------------------
+    bool StaticGeometry::Batch::getCastsShadows(void) const
+    {
+        OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                     "StaticGeometry::Batch does not implement getCastsShadows."
+                     " You've put a v2 object in "
+                     "the wrong RenderQueue ID (which is set to be compatible with "
+                     "v1::Entity). Do not mix v2 and v1 objects",
+                     "StaticGeometry::Batch::getCastsShadows" );
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::Region::Region( IdType id, ObjectMemoryManager *objectMemoryManager,
+                                    SceneManager *manager, uint32 regionId,
+                                    const Vector3 &centre ) :
+        MovableObject( id, objectMemoryManager, manager, 10u ),
+        mRegionId( regionId ),
+        mCentre( centre ),
+        mNode( 0 )
+    {
+        mObjectData.mQueryFlags[mObjectData.mIndex] = SceneManager::QUERY_STATICGEOMETRY_DEFAULT_MASK;
+        mLodMesh = &mLodValues;
+    }
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::Region::~Region()
+    {
+        VaoManager *vaoManager = mManager->getDestinationRenderSystem()->getVaoManager();
+
+        BatchArray::const_iterator itor = mBatches.begin();
+        BatchArray::const_iterator end  = mBatches.end();
+        while( itor != end )
+        {
+            (*itor)->_destroyVaos( vaoManager );
+            OGRE_DELETE *itor;
+            ++itor;
+        }
+
+        mBatches.clear();
+        mRenderables.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    const String& StaticGeometry::Region::getMovableType(void) const
+    {
+        static const String movType = "StaticGeometryv2";
+        return movType;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::StaticGeometry( const String &name, SceneManager *sceneManager ) :
+        mName( name ),
+        mSceneManager( sceneManager ),
+        mRegionDimensions( Vector3( 1000 ) ),
+        mHalfRegionDimensions( Vector3( 500 ) ),
+        mOrigin( Vector3::ZERO ),
+        mUpperDistance( 0.0f ),
+        mCastShadows( false ),
+        mVisible( true ),
+        mRenderQueueId( 10u ),
+        mVisibilityFlags( MovableObject::getDefaultVisibilityFlags() ),
+        mMergeFinished( false ),
+        mBuilding( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::~StaticGeometry()
+    {
+        reset();
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 StaticGeometry::getRegionId( const Vector3 &point ) const
+    {
+        //Scale the point into multiples of region and adjust for origin
+        const Vector3 scaledPoint = (point - mOrigin) / mRegionDimensions;
+
+        //Round down to 'bottom left' point which represents the cell index
+        const int ix = Math::IFloor( scaledPoint.x );
+        const int iy = Math::IFloor( scaledPoint.y );
+        const int iz = Math::IFloor( scaledPoint.z );
+
+        if( ix < REGION_MIN_INDEX || ix > REGION_MAX_INDEX ||
+            iy < REGION_MIN_INDEX || iy > REGION_MAX_INDEX ||
+            iz < REGION_MIN_INDEX || iz > REGION_MAX_INDEX )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Point out of bounds. Increase the region dimensions or "
+                         "move the origin.", "StaticGeometry::getRegionId" );
+        }
+
+        //10 bits per axis, unsigned so we don't have to deal with negatives
+        const uint32 x = static_cast<uint32>( ix + REGION_HALF_RANGE );
+        const uint32 y = static_cast<uint32>( iy + REGION_HALF_RANGE );
+        const uint32 z = static_cast<uint32>( iz + REGION_HALF_RANGE );
+        return x | (y << 10u) | (z << 20u);
+    }
+    //-----------------------------------------------------------------------------------
+    Vector3 StaticGeometry::getRegionCentre( uint32 regionId ) const
+    {
+        const Real x = static_cast<Real>( regionId & 0x3FF );
+        const Real y = static_cast<Real>( (regionId >> 10u) & 0x3FF );
+        const Real z = static_cast<Real>( (regionId >> 20u) & 0x3FF );
+
+        return (Vector3( x, y, z ) - Real( REGION_HALF_RANGE )) * mRegionDimensions +
+                mOrigin + mHalfRegionDimensions;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::checkVertexFormat( const VertexElement2VecVec &vertexElements,
+                                            const String &meshName )
+    {
+        VertexElement2VecVec::const_iterator itor = vertexElements.begin();
+        VertexElement2VecVec::const_iterator end  = vertexElements.end();
+
+        while( itor != end )
+        {
+            VertexElement2Vec::const_iterator itElement = itor->begin();
+            VertexElement2Vec::const_iterator enElement = itor->end();
+
+            while( itElement != enElement )
+            {
+                bool supported = itElement->mInstancingStepRate == 0;
+
+                switch( itElement->mSemantic )
+                {
+                case VES_POSITION:
+                    supported &= itElement->mType == VET_FLOAT3 || itElement->mType == VET_FLOAT4 ||
+                                 itElement->mType == VET_HALF4;
+                    break;
+                case VES_NORMAL:
+                    supported &= itElement->mType == VET_FLOAT3 || itElement->mType == VET_HALF4 ||
+                                 itElement->mType == VET_SHORT4_SNORM;
+                    break;
+                case VES_TANGENT:
+                    supported &= itElement->mType == VET_FLOAT3 || itElement->mType == VET_FLOAT4 ||
+                                 itElement->mType == VET_HALF4;
+                    break;
+                case VES_BINORMAL:
+                    supported &= itElement->mType == VET_FLOAT3;
+                    break;
+                case VES_BLEND_WEIGHTS:
+                case VES_BLEND_INDICES:
+                    supported = false;
+                    break;
+                default:
+                    break;
+                }
+
+                if( !supported )
+                {
+                    OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                                 "Mesh '" + meshName + "' has a vertex element of semantic " +
+                                 StringConverter::toString( itElement->mSemantic ) + " and type " +
+                                 StringConverter::toString( itElement->mType ) +
+                                 " which can't be transformed",
+                                 "StaticGeometry::checkVertexFormat" );
+                }
+
+                ++itElement;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::downloadSubMesh( const SubMesh *subMesh, SubMeshGeometry &outGeometry )
+    {
+        const VertexArrayObjectArray &vaos = subMesh->mVao[VpNormal];
+
+        if( vaos.empty() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "SubMesh from '" + subMesh->mParent->getName() + "' has no VAOs",
+                         "StaticGeometry::downloadSubMesh" );
+        }
+
+        outGeometry.vertexElements = vaos.front()->getVertexDeclaration();
+        outGeometry.operationType = vaos.front()->getOperationType();
+        checkVertexFormat( outGeometry.vertexElements, subMesh->mParent->getName() );
+
+        VertexArrayObjectArray::const_iterator itor = vaos.begin();
+        VertexArrayObjectArray::const_iterator end  = vaos.end();
+
+        while( itor != end )
+        {
+            VertexArrayObject *vao = *itor;
+
+            if( vao->getOperationType() != OT_TRIANGLE_LIST )
+            {
+                OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                             "Mesh '" + subMesh->mParent->getName() + "': only triangle lists "
+                             "are supported", "StaticGeometry::downloadSubMesh" );
+            }
+
+            if( vao->getVertexDeclaration() != outGeometry.vertexElements )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Mesh '" + subMesh->mParent->getName() + "': all LODs must have "
+                             "the same vertex format", "StaticGeometry::downloadSubMesh" );
+            }
+
+            const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+
+            //LODs usually share the vertex buffers, only download them once
+            uint32 vertexSetIdx = 0;
+            while( vertexSetIdx < outGeometry.vertexSets.size() &&
+                   outGeometry.vertexSets[vertexSetIdx].source != vertexBuffers.front() )
+            {
+                ++vertexSetIdx;
+            }
+
+            if( vertexSetIdx == outGeometry.vertexSets.size() )
+            {
+                outGeometry.vertexSets.push_back( SubMeshGeometry::VertexSet() );
+                SubMeshGeometry::VertexSet &vertexSet = outGeometry.vertexSets.back();
+                vertexSet.source = vertexBuffers.front();
+                vertexSet.numVertices = static_cast<uint32>( vertexBuffers.front()->getNumElements() );
+                vertexSet.data.resize( vertexBuffers.size() );
+
+                for( size_t i=0; i<vertexBuffers.size(); ++i )
+                {
+                    FastArray<uint8> &data = vertexSet.data[i];
+                    data.resizePOD( vertexSet.numVertices * vertexBuffers[i]->getBytesPerElement() );
+                    if( vertexSet.numVertices )
+                        downloadBuffer( vertexBuffers[i], 0, vertexSet.numVertices, data.begin() );
+                }
+            }
+
+            outGeometry.lods.push_back( SubMeshGeometry::Lod() );
+            SubMeshGeometry::Lod &lod = outGeometry.lods.back();
+            lod.vertexSet = vertexSetIdx;
+
+            const uint32 primStart = vao->getPrimitiveStart();
+            const uint32 primCount = vao->getPrimitiveCount();
+            lod.indices.resizePOD( primCount );
+
+            IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+            if( indexBuffer )
+            {
+                if( primCount )
+                {
+                    if( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+                    {
+                        FastArray<uint16> indices16;
+                        indices16.resizePOD( primCount );
+                        downloadBuffer( indexBuffer, primStart, primCount, indices16.begin() );
+                        for( uint32 i=0; i<primCount; ++i )
+                            lod.indices[i] = indices16[i];
+                    }
+                    else
+                    {
+                        downloadBuffer( indexBuffer, primStart, primCount, lod.indices.begin() );
+                    }
+                }
+            }
+            else
+            {
+                for( uint32 i=0; i<primCount; ++i )
+                    lod.indices[i] = primStart + i;
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 StaticGeometry::getGeometry( const SubMesh *subMesh )
+    {
+        map<const SubMesh*, uint32>::type::const_iterator itor = mGeometryLookup.find( subMesh );
+        if( itor != mGeometryLookup.end() )
+            return itor->second;
+
+        const uint32 geometryIdx = static_cast<uint32>( mGeometries.size() );
+        mGeometries.push_back( SubMeshGeometry() );
+        downloadSubMesh( subMesh, mGeometries.back() );
+        mGeometryLookup[subMesh] = geometryIdx;
+
+        return geometryIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::prepareRegionData(void)
+    {
+        mRegionData.clear();
+
+        map<uint32, size_t>::type regionLookup;
+
+        for( size_t i=0; i<mQueuedItems.size(); ++i )
+        {
+            const QueuedItem &queuedItem = mQueuedItems[i];
+
+            const uint32 regionId = getRegionId( queuedItem.worldCentre );
+            map<uint32, size_t>::type::const_iterator itRegion = regionLookup.find( regionId );
+            if( itRegion == regionLookup.end() )
+            {
+                itRegion = regionLookup.insert( std::pair<uint32, size_t>(
+                                                    regionId, mRegionData.size() ) ).first;
+                mRegionData.push_back( RegionData() );
+                mRegionData.back().regionId = regionId;
+                mRegionData.back().centre = getRegionCentre( regionId );
+            }
+
+            RegionData &regionData = mRegionData[itRegion->second];
+
+            //Like v1::StaticGeometry, each LOD level uses the highest distance of all meshes
+            const FastArray<Real> &meshLodValues = *queuedItem.mesh->_getLodValueArray();
+            if( regionData.lodValues.size() < meshLodValues.size() )
+                regionData.lodValues.resize( meshLodValues.size(), Real( 0 ) );
+            for( size_t j=0; j<meshLodValues.size(); ++j )
+                regionData.lodValues[j] = std::max( regionData.lodValues[j], meshLodValues[j] );
+
+            const uint16 numSubMeshes = queuedItem.mesh->getNumSubMeshes();
+            for( uint16 j=0; j<numSubMeshes; ++j )
+            {
+                const uint32 geometryIdx = getGeometry( queuedItem.mesh->getSubMesh( j ) );
+                const VertexElement2VecVec &vertexElements =
+                        mGeometries[geometryIdx].vertexElements;
+
+                vector<BatchData>::type::iterator itBatch = regionData.batches.begin();
+                vector<BatchData>::type::iterator enBatch = regionData.batches.end();
+                while( itBatch != enBatch &&
+                       (itBatch->datablock != queuedItem.datablocks[j] ||
+                        mGeometries[itBatch->firstGeometry].vertexElements != vertexElements) )
+                {
+                    ++itBatch;
+                }
+
+                if( itBatch == enBatch )
+                {
+                    regionData.batches.push_back( BatchData() );
+                    itBatch = regionData.batches.end() - 1u;
+                    itBatch->datablock = queuedItem.datablocks[j];
+                    itBatch->firstGeometry = geometryIdx;
+                    itBatch->numVertices = 0;
+                }
+
+                itBatch->entries.push_back( static_cast<uint32>( i ) );
+                itBatch->entries.push_back( geometryIdx );
+            }
+
+            if( regionData.lodValues.empty() )
+                regionData.lodValues.push_back( Real( 0 ) );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::transformVertices( uint8 * RESTRICT_ALIAS vertexData, size_t numVertices,
+                                            const VertexElement2Vec &vertexElements,
+                                            const Matrix4 &transform,
+                                            const Matrix3 &normalTransform,
+                                            const Quaternion &orientation, bool flipReflection,
+                                            Vector3 &inOutMin, Vector3 &inOutMax )
+    {
+        const size_t vertexSize = VaoManager::calculateVertexSize( vertexElements );
+
+        Matrix3 linearTransform;
+        transform.extract3x3Matrix( linearTransform );
+
+        //Bias = 1 / [2^(bits-1) - 1]. See SubMesh::_arrangeEfficient
+        const Real bias = 1.0f / 32767.0f;
+
+        size_t offset = 0;
+        VertexElement2Vec::const_iterator itor = vertexElements.begin();
+        VertexElement2Vec::const_iterator end  = vertexElements.end();
+
+        while( itor != end )
+        {
+            const VertexElementType type = itor->mType;
+            uint8 *data = vertexData + offset;
+
+            switch( itor->mSemantic )
+            {
+            case VES_POSITION:
+                for( size_t i=0; i<numVertices; ++i )
+                {
+                    const Vector3 pos = transform * readVector3( data, type );
+                    writeVector3( data, type, pos );
+                    inOutMin.makeFloor( pos );
+                    inOutMax.makeCeil( pos );
+                    data += vertexSize;
+                }
+                break;
+            case VES_NORMAL:
+                if( type == VET_SHORT4_SNORM )
+                {
+                    //QTangent. The orientation rotates it, the scale is ignored.
+                    for( size_t i=0; i<numVertices; ++i )
+                    {
+                        int16 *data16 = reinterpret_cast<int16*>( data );
+                        Quaternion qTangent( Bitwise::snorm16ToFloat( data16[3] ),
+                                             Bitwise::snorm16ToFloat( data16[0] ),
+                                             Bitwise::snorm16ToFloat( data16[1] ),
+                                             Bitwise::snorm16ToFloat( data16[2] ) );
+                        const bool reflected = (qTangent.w < 0) != flipReflection;
+
+                        qTangent = orientation * qTangent;
+                        qTangent.normalise();
+
+                        if( qTangent.w < 0 )
+                            qTangent = -qTangent;
+                        if( qTangent.w < bias )
+                        {
+                            const Real normFactor = Math::Sqrt( 1 - bias * bias );
+                            qTangent.w = bias;
+                            qTangent.x *= normFactor;
+                            qTangent.y *= normFactor;
+                            qTangent.z *= normFactor;
+                        }
+                        if( reflected )
+                            qTangent = -qTangent;
+
+                        data16[0] = Bitwise::floatToSnorm16( qTangent.x );
+                        data16[1] = Bitwise::floatToSnorm16( qTangent.y );
+                        data16[2] = Bitwise::floatToSnorm16( qTangent.z );
+                        data16[3] = Bitwise::floatToSnorm16( qTangent.w );
+                        data += vertexSize;
+                    }
+                }
+                else
+                {
+                    for( size_t i=0; i<numVertices; ++i )
+                    {
+                        Vector3 normal = normalTransform * readVector3( data, type );
+                        normal.normalise();
+                        writeVector3( data, type, normal );
+                        data += vertexSize;
+                    }
+                }
+                break;
+            case VES_TANGENT:
+            case VES_BINORMAL:
+                for( size_t i=0; i<numVertices; ++i )
+                {
+                    Vector3 tangent = linearTransform * readVector3( data, type );
+                    tangent.normalise();
+                    writeVector3( data, type, tangent );
+                    if( flipReflection )
+                        flipW( data, type );
+                    data += vertexSize;
+                }
+                break;
+            default:
+                break;
+            }
+
+            offset += v1::VertexElement::getTypeSize( type );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::mergeBatch( const RegionData &region, BatchData &batch )
+    {
+        const VertexElement2VecVec &vertexElements = mGeometries[batch.firstGeometry].vertexElements;
+        const size_t numBuffers = vertexElements.size();
+
+        FastArray<size_t> vertexSizes;
+        vertexSizes.resizePOD( numBuffers );
+        for( size_t i=0; i<numBuffers; ++i )
+            vertexSizes[i] = VaoManager::calculateVertexSize( vertexElements[i] );
+
+        uint32 numVertices = 0;
+        for( size_t i=0; i<batch.entries.size(); i += 2u )
+        {
+            const SubMeshGeometry &geometry = mGeometries[batch.entries[i + 1u]];
+            for( size_t j=0; j<geometry.vertexSets.size(); ++j )
+                numVertices += geometry.vertexSets[j].numVertices;
+        }
+
+        batch.numVertices = numVertices;
+        batch.vertexData.resize( numBuffers );
+        for( size_t i=0; i<numBuffers; ++i )
+            batch.vertexData[i].resizePOD( numVertices * vertexSizes[i] );
+        batch.lodIndices.resize( region.lodValues.size() );
+        batch.aabbMin = Vector3( std::numeric_limits<Real>::max() );
+        batch.aabbMax = Vector3( -std::numeric_limits<Real>::max() );
+
+        uint32 vertexStart = 0;
+        FastArray<uint32> vertexSetStarts;
+
+        for( size_t i=0; i<batch.entries.size(); i += 2u )
+        {
+            const QueuedItem &queuedItem = mQueuedItems[batch.entries[i]];
+            const SubMeshGeometry &geometry = mGeometries[batch.entries[i + 1u]];
+
+            //Vertices are relative to the region's node
+            Matrix4 transform;
+            transform.makeTransform( queuedItem.position - region.centre, queuedItem.scale,
+                                     queuedItem.orientation );
+            Matrix3 normalTransform;
+            queuedItem.orientation.ToRotationMatrix( normalTransform );
+            normalTransform = normalTransform * Matrix3( 1.0f / queuedItem.scale.x, 0, 0,
+                                                         0, 1.0f / queuedItem.scale.y, 0,
+                                                         0, 0, 1.0f / queuedItem.scale.z );
+            const bool flipWinding = queuedItem.scale.x * queuedItem.scale.y *
+                                     queuedItem.scale.z < 0;
+
+            vertexSetStarts.clear();
+            for( size_t j=0; j<geometry.vertexSets.size(); ++j )
+            {
+                const SubMeshGeometry::VertexSet &vertexSet = geometry.vertexSets[j];
+                vertexSetStarts.push_back( vertexStart );
+
+                for( size_t k=0; k<numBuffers; ++k )
+                {
+                    uint8 *dstData = batch.vertexData[k].begin() + vertexStart * vertexSizes[k];
+                    memcpy( dstData, vertexSet.data[k].begin(),
+                            vertexSet.numVertices * vertexSizes[k] );
+                    transformVertices( dstData, vertexSet.numVertices, vertexElements[k],
+                                       transform, normalTransform, queuedItem.orientation,
+                                       flipWinding, batch.aabbMin, batch.aabbMax );
+                }
+
+                vertexStart += vertexSet.numVertices;
+            }
+
+            for( size_t j=0; j<batch.lodIndices.size(); ++j )
+            {
+                //Meshes with fewer LODs than the region keep using their last one
+                const SubMeshGeometry::Lod &lod =
+                        geometry.lods[std::min( j, geometry.lods.size() - 1u )];
+                const uint32 baseVertex = vertexSetStarts[lod.vertexSet];
+                FastArray<uint32> &dstIndices = batch.lodIndices[j];
+
+                const size_t numIndices = lod.indices.size() - (lod.indices.size() % 3u);
+                for( size_t k=0; k<numIndices; k += 3u )
+                {
+                    dstIndices.push_back( baseVertex + lod.indices[k] );
+                    dstIndices.push_back( baseVertex + lod.indices[k + (flipWinding ? 2u : 1u)] );
+                    dstIndices.push_back( baseVertex + lod.indices[k + (flipWinding ? 1u : 2u)] );
+                }
+            }
+        }
+
+        for( size_t j=0; j<batch.lodIndices.size(); ++j )
+        {
+            //Avoid a VAO without index buffer, which would render every vertex
+            if( batch.lodIndices[j].empty() )
+                batch.lodIndices[j].resize( 3u, 0u );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::mergeAll(void)
+    {
+        RegionDataVec::iterator itor = mRegionData.begin();
+        RegionDataVec::iterator end  = mRegionData.end();
+
+        while( itor != end )
+        {
+            vector<BatchData>::type::iterator itBatch = itor->batches.begin();
+            vector<BatchData>::type::iterator enBatch = itor->batches.end();
+            while( itBatch != enBatch )
+                mergeBatch( *itor, *itBatch++ );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::_mergeThread(void)
+    {
+        mergeAll();
+
+        ScopedLock lock( mMergeMutex );
+        mMergeFinished = true;
+    }
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::Batch* StaticGeometry::createBatch( Region *region, const BatchData &batchData )
+    {
+        VaoManager *vaoManager = mSceneManager->getDestinationRenderSystem()->getVaoManager();
+
+        const VertexElement2VecVec &vertexElements =
+                mGeometries[batchData.firstGeometry].vertexElements;
+
+        //BT_IMMUTABLE buffers go into the static mega buffer when it's enabled,
+        //letting batches with the same vertex format be drawn in one indirect call.
+        VertexBufferPackedVec vertexBuffers;
+        for( size_t i=0; i<vertexElements.size(); ++i )
+        {
+            void *data = const_cast<uint8*>( batchData.vertexData[i].begin() );
+            vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements[i],
+                                                                     batchData.numVertices,
+                                                                     BT_IMMUTABLE, data, false ) );
+        }
+
+        const bool use16Bit = batchData.numVertices <= 0xFFFF;
+
+        VertexArrayObjectArray vaos;
+        vaos.reserve( batchData.lodIndices.size() );
+
+        FastArray<uint16> indices16;
+        for( size_t i=0; i<batchData.lodIndices.size(); ++i )
+        {
+            const FastArray<uint32> &indices = batchData.lodIndices[i];
+
+            IndexBufferPacked *indexBuffer = 0;
+            if( use16Bit )
+            {
+                indices16.resizePOD( indices.size() );
+                for( size_t j=0; j<indices.size(); ++j )
+                    indices16[j] = static_cast<uint16>( indices[j] );
+                indexBuffer = vaoManager->createIndexBuffer( IndexBufferPacked::IT_16BIT,
+                                                             indices16.size(), BT_IMMUTABLE,
+                                                             indices16.begin(), false );
+            }
+            else
+            {
+                indexBuffer = vaoManager->createIndexBuffer( IndexBufferPacked::IT_32BIT,
+                                                             indices.size(), BT_IMMUTABLE,
+                                                             const_cast<uint32*>( indices.begin() ),
+                                                             false );
+            }
+
+            vaos.push_back( vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                 OT_TRIANGLE_LIST ) );
+        }
+
+        Batch *batch = OGRE_NEW Batch( region, vaos );
+        batch->setDatablock( batchData.datablock );
+        return batch;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::createRegions(void)
+    {
+        RegionDataVec::iterator itor = mRegionData.begin();
+        RegionDataVec::iterator end  = mRegionData.end();
+
+        while( itor != end )
+        {
+            Region *region = OGRE_NEW Region( Id::generateNewId<MovableObject>(),
+                                              &mSceneManager->_getEntityMemoryManager( SCENE_STATIC ),
+                                              mSceneManager, itor->regionId, itor->centre );
+            region->mLodValues = itor->lodValues;
+            region->mObjectData.invalidateLodRange();
+
+            Vector3 aabbMin( std::numeric_limits<Real>::max() );
+            Vector3 aabbMax( -std::numeric_limits<Real>::max() );
+
+            vector<BatchData>::type::iterator itBatch = itor->batches.begin();
+            vector<BatchData>::type::iterator enBatch = itor->batches.end();
+            while( itBatch != enBatch )
+            {
+                Batch *batch = createBatch( region, *itBatch );
+                region->mBatches.push_back( batch );
+                region->mRenderables.push_back( batch );
+
+                aabbMin.makeFloor( itBatch->aabbMin );
+                aabbMax.makeCeil( itBatch->aabbMax );
+
+                //Free the CPU copy as soon as possible
+                itBatch->vertexData.clear();
+                itBatch->lodIndices.clear();
+                ++itBatch;
+            }
+
+            if( aabbMin.x > aabbMax.x )
+                aabbMin = aabbMax = Vector3::ZERO;
+
+            const Aabb aabb = Aabb::newFromExtents( aabbMin, aabbMax );
+            ObjectData &objData = region->mObjectData;
+            objData.mLocalAabb->setFromAabb( aabb, objData.mIndex );
+            objData.mWorldAabb->setFromAabb( aabb, objData.mIndex );
+            objData.mLocalRadius[objData.mIndex] = aabb.getRadius();
+            objData.mWorldRadius[objData.mIndex] = aabb.getRadius();
+            objData.invalidateBounds();
+
+            region->setCastShadows( mCastShadows );
+            region->setVisible( mVisible );
+            region->setRenderingDistance( mUpperDistance );
+            region->setVisibilityFlags( mVisibilityFlags );
+            region->setRenderQueueGroup( mRenderQueueId );
+
+            region->mNode = mSceneManager->getRootSceneNode()->createChildSceneNode(
+                                SCENE_STATIC, itor->centre );
+            region->mNode->attachObject( region );
+            mSceneManager->injectMovableObject( region );
+            mSceneManager->notifyStaticDirty( region->mNode );
+
+            mRegions[itor->regionId] = region;
+            ++itor;
+        }
+
+        mRegionData.clear();
+        mGeometries.clear();
+        mGeometryLookup.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::addItem( Item *item, const Vector3 &position,
+                                  const Quaternion &orientation, const Vector3 &scale )
+    {
+        if( mBuilding )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Can't add Items while building", "StaticGeometry::addItem" );
+        }
+
+        const MeshPtr &mesh = item->getMesh();
+        if( mesh->hasSkeleton() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Item '" + item->getName() + "' with mesh '" + mesh->getName() +
+                         "' has a skeleton. Animated meshes can't be static",
+                         "StaticGeometry::addItem" );
+        }
+
+        mQueuedItems.push_back( QueuedItem() );
+        QueuedItem &queuedItem = mQueuedItems.back();
+        queuedItem.mesh         = mesh;
+        queuedItem.position     = position;
+        queuedItem.orientation  = orientation;
+        queuedItem.scale        = scale;
+
+        const size_t numSubItems = item->getNumSubItems();
+        queuedItem.datablocks.reserve( numSubItems );
+        for( size_t i=0; i<numSubItems; ++i )
+            queuedItem.datablocks.push_back( item->getSubItem( i )->getDatablock() );
+
+        Matrix4 transform;
+        transform.makeTransform( position, scale, orientation );
+        Aabb aabb = mesh->getAabb();
+        aabb.transformAffine( transform );
+        queuedItem.worldCentre = aabb.mCenter;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::addSceneNode( SceneNode *node )
+    {
+        SceneNode::ObjectIterator itObjects = node->getAttachedObjectIterator();
+        while( itObjects.hasMoreElements() )
+        {
+            MovableObject *movableObject = itObjects.getNext();
+            if( movableObject->getMovableType() == ItemFactory::FACTORY_TYPE_NAME )
+            {
+                addItem( static_cast<Item*>( movableObject ), node->_getDerivedPositionUpdated(),
+                         node->_getDerivedOrientationUpdated(), node->_getDerivedScaleUpdated() );
+            }
+        }
+
+        Node::NodeVecIterator itChildren = node->getChildIterator();
+        while( itChildren.hasMoreElements() )
+            addSceneNode( static_cast<SceneNode*>( itChildren.getNext() ) );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::build(void)
+    {
+        if( mBuilding )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "An asynchronous build is in progress", "StaticGeometry::build" );
+        }
+
+        destroy();
+        prepareRegionData();
+        mergeAll();
+        createRegions();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::buildAsync(void)
+    {
+        if( mBuilding )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "An asynchronous build is in progress", "StaticGeometry::buildAsync" );
+        }
+
+        destroy();
+        //Downloading needs the GPU, thus it can't be done in the background
+        prepareRegionData();
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+        mergeAll();
+        createRegions();
+#else
+        mMergeFinished = false;
+        mBuilding = true;
+        mMergeThread = Threads::CreateThread( THREAD_GET( staticGeometryMergeThread ), 0, this );
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    bool StaticGeometry::updateAsyncBuild(void)
+    {
+        if( !mBuilding )
+            return true;
+
+        bool finished;
+        {
+            ScopedLock lock( mMergeMutex );
+            finished = mMergeFinished;
+        }
+
+        if( finished )
+            waitForAsyncBuild();
+
+        return finished;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::waitForAsyncBuild(void)
+    {
+        if( !mBuilding )
+            return;
+
+        Threads::WaitForThreads( 1u, &mMergeThread );
+        mMergeThread.reset();
+        mBuilding = false;
+
+        createRegions();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::destroy(void)
+    {
+        waitForAsyncBuild();
+
+        RegionMap::const_iterator itor = mRegions.begin();
+        RegionMap::const_iterator end  = mRegions.end();
+
+        while( itor != end )
+        {
+            Region *region = itor->second;
+            SceneNode *node = region->mNode;
+            node->detachObject( region );
+            mSceneManager->extractMovableObject( region );
+            mSceneManager->destroySceneNode( node );
+            OGRE_DELETE region;
+            ++itor;
+        }
+
+        mRegions.clear();
+        mRegionData.clear();
+        mGeometries.clear();
+        mGeometryLookup.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::reset(void)
+    {
+        destroy();
+        mQueuedItems.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setRegionDimensions( const Vector3 &size )
+    {
+        mRegionDimensions = size;
+        mHalfRegionDimensions = size * 0.5f;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setOrigin( const Vector3 &origin )
+    {
+        mOrigin = origin;
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setRenderingDistance( Real dist )
+    {
+        mUpperDistance = dist;
+        RegionMap::const_iterator itor = mRegions.begin();
+        RegionMap::const_iterator end  = mRegions.end();
+        while( itor != end )
+            (itor++)->second->setRenderingDistance( dist );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setCastShadows( bool castShadows )
+    {
+        mCastShadows = castShadows;
+        RegionMap::const_iterator itor = mRegions.begin();
+        RegionMap::const_iterator end  = mRegions.end();
+        while( itor != end )
+            (itor++)->second->setCastShadows( castShadows );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setVisible( bool visible )
+    {
+        mVisible = visible;
+        RegionMap::const_iterator itor = mRegions.begin();
+        RegionMap::const_iterator end  = mRegions.end();
+        while( itor != end )
+            (itor++)->second->setVisible( visible );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setRenderQueueGroup( uint8 queueId )
+    {
+        mRenderQueueId = queueId;
+        RegionMap::const_iterator itor = mRegions.begin();
+        RegionMap::const_iterator end  = mRegions.end();
+        while( itor != end )
+            (itor++)->second->setRenderQueueGroup( queueId );
+    }
+    //-----------------------------------------------------------------------------------
+    void StaticGeometry::setVisibilityFlags( uint32 flags )
+    {
+        mVisibilityFlags = flags;
+        RegionMap::const_iterator itor = mRegions.begin();
+        RegionMap::const_iterator end  = mRegions.end();
+        while( itor != end )
+            (itor++)->second->setVisibilityFlags( flags );
+    }
+    //-----------------------------------------------------------------------------------
+    StaticGeometry::RegionIterator StaticGeometry::getRegionIterator(void)
+    {
+        return RegionIterator( mRegions.begin(), mRegions.end() );
+    }
+}
@@ -58,6 +58,8 @@ namespace Ogre {
             mPoseData.reset(new PoseData);
             mPoseData->numPoses = subMeshBasis->getNumPoses();
             mPoseData->buffer = subMeshBasis->getPoseTexBuffer();
+            mPoseData->indexBuffer = subMeshBasis->getPoseIndexTexBuffer();
+            mPoseData->numPoseVertices = subMeshBasis->getNumPoseVertices();
             mPoseData->halfPrecision = subMeshBasis->getPoseHalfPrecision();
             mPoseData->hasNormals = subMeshBasis->getPoseNormals();
         }
@@ -42,9 +42,47 @@ THE SOFTWARE.
 #include "OgreMesh.h"
 
 #include "OgreVertexShadowMapHelper.h"
+#include "OgreMeshOptimiser.h"
 #include "OgreStringConverter.h"
 
+#include "Math/Array/OgreArrayConfig.h"
+
 namespace Ogre {
+    namespace
+    {
+        /// Converts 4 floats to half. Same results as Bitwise::floatToHalf
+        inline void floatToHalf4( const float * RESTRICT_ALIAS src, uint16 * RESTRICT_ALIAS dst )
+        {
+#if OGRE_CPU == OGRE_CPU_X86 && OGRE_USE_SIMD == 1
+            const __m128i i = _mm_castps_si128( _mm_loadu_ps( src ) );
+            const __m128i s = _mm_and_si128( _mm_srli_epi32( i, 16 ), _mm_set1_epi32( 0x00008000 ) );
+            const __m128i e = _mm_sub_epi32( _mm_and_si128( _mm_srli_epi32( i, 23 ),
+                                                            _mm_set1_epi32( 0x000000ff ) ),
+                                             _mm_set1_epi32( 127 - 15 ) );
+            const __m128i m = _mm_srli_epi32( _mm_and_si128( i, _mm_set1_epi32( 0x007fffff ) ), 13 );
+
+            //Too small values become 0. Denormals, overflows, Inf & NaN take the slow path,
+            //which is rare in vertex data.
+            const __m128i tooSmall = _mm_cmplt_epi32( e, _mm_set1_epi32( -10 ) );
+            const __m128i slowPath = _mm_or_si128(
+                        _mm_andnot_si128( tooSmall, _mm_cmplt_epi32( e, _mm_set1_epi32( 1 ) ) ),
+                        _mm_cmpgt_epi32( e, _mm_set1_epi32( 30 ) ) );
+
+            if( !_mm_movemask_epi8( slowPath ) )
+            {
+                __m128i h = _mm_or_si128( _mm_or_si128( s, _mm_slli_epi32( e, 10 ) ), m );
+                h = _mm_andnot_si128( tooSmall, h );
+                //Sign extend so that the signed saturation of packs doesn't clamp the sign bit
+                h = _mm_srai_epi32( _mm_slli_epi32( h, 16 ), 16 );
+                h = _mm_packs_epi32( h, h );
+                _mm_storel_epi64( reinterpret_cast<__m128i*>( dst ), h );
+                return;
+            }
+#endif
+            for( size_t j=0; j<4u; ++j )
+                dst[j] = Bitwise::floatToHalf( src[j] );
+        }
+    }
     //-----------------------------------------------------------------------
     SubMesh::SubMesh() :
         mParent( 0 ),
@@ -52,7 +90,10 @@ namespace Ogre {
         mNumPoses( 0 ),
         mPoseHalfPrecision( false ),
         mPoseNormals( false ),
-        mPoseTexBuffer( 0 )
+        mPoseTexBuffer( 0 ),
+        mPoseIndexTexBuffer( 0 ),
+        mNumPoseVertices( 0 ),
+        mAabb( Aabb::BOX_NULL )
     {
     }
     //-----------------------------------------------------------------------
@@ -63,6 +104,8 @@ namespace Ogre {
         
         if( mPoseTexBuffer )
             mParent->mVaoManager->destroyTexBuffer( mPoseTexBuffer );
+        if( mPoseIndexTexBuffer )
+            mParent->mVaoManager->destroyTexBuffer( mPoseIndexTexBuffer );
     }
     //-----------------------------------------------------------------------
     void SubMesh::addBoneAssignment(const VertexBoneAssignment& vertBoneAssign)
@@ -474,6 +517,8 @@ namespace Ogre {
 
         newSub->mBoneAssignments            = mBoneAssignments;
         newSub->mBoneAssignmentsOutOfDate   = mBoneAssignmentsOutOfDate;
+        newSub->mMeshlets                   = mMeshlets;
+        newSub->mAabb                       = mAabb;
 
         const uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
         for( uint8 i=0; i<numVaoPasses; ++i )
@@ -500,7 +545,7 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     void SubMesh::importFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
-                                bool qTangents, bool halfPose )
+                                bool qTangents, bool halfPose, ArrangedVertexData *arranged )
     {
         mMaterialName = subMesh->getMaterialName();
 
@@ -525,7 +570,8 @@ namespace Ogre {
         mBlendIndexToBoneIndexMap = subMesh->blendIndexToBoneIndexMap;
         mBoneAssignmentsOutOfDate = false;
 
-        importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 0 );
+        importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 0,
+                             arranged ? &arranged[VpNormal] : 0 );
 
         assert( subMesh->parent->hasValidShadowMappingBuffers() );
 
@@ -534,7 +580,8 @@ namespace Ogre {
             subMesh->indexData[VpNormal] != subMesh->indexData[VpShadow] )
         {
             //Use the special version already built for v1
-            importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 1 );
+            importBuffersFromV1( subMesh, halfPos, halfTexCoords, qTangents, halfPose, 1,
+                                 arranged ? &arranged[VpShadow] : 0 );
         }
         else
         {
@@ -544,11 +591,22 @@ namespace Ogre {
     }
     //---------------------------------------------------------------------
     void SubMesh::importBuffersFromV1( v1::SubMesh *subMesh, bool halfPos, bool halfTexCoords,
-                                       bool qTangents, bool halfPose, size_t vaoPassIdx )
+                                       bool qTangents, bool halfPose, size_t vaoPassIdx,
+                                       ArrangedVertexData *arranged )
     {
         VertexElement2Vec vertexElements;
-        char *data = _arrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, &vertexElements,
-                                        vaoPassIdx );
+        char *data;
+        if( arranged && arranged->data )
+        {
+            data = arranged->data;
+            vertexElements.swap( arranged->vertexElements );
+            arranged->data = 0;
+        }
+        else
+        {
+            data = _arrangeEfficient( subMesh, halfPos, halfTexCoords, qTangents, &vertexElements,
+                                      vaoPassIdx );
+        }
 
         //Wrap the ptrs around these, because the VaoManager's call
         //can throw thus causing a leak if we don't free them.
@@ -591,7 +649,9 @@ namespace Ogre {
             ++itor;
         }
         
-        importPosesFromV1( subMesh, vertexBuffer, halfPose );
+        //Poses are indexed by the vertices of the normal pass
+        if( vaoPassIdx == 0 )
+            importPosesFromV1( subMesh, vertexBuffer, halfPose );
     }
     //---------------------------------------------------------------------
     IndexBufferPacked* SubMesh::importFromV1( v1::IndexData *indexData )
@@ -660,77 +720,52 @@ namespace Ogre {
         if( mNumPoses > 0 ) 
         {
             mPoseNormals = poseList[0]->getIncludesNormals();
-            size_t numVertices = vertexBuffer->getNumElements();
-            size_t elementSize = halfPrecision ? sizeof( uint16 ) : sizeof( float );
-            size_t elementsPerVertex = mPoseNormals ? 8 : 4;
-            size_t singlePoseBufferSize = numVertices * elementSize * elementsPerVertex;
-            size_t bufferSize = mNumPoses * singlePoseBufferSize;
-            char *buffer = static_cast<char*>( OGRE_MALLOC_SIMD( bufferSize,
-                                                                 MEMCATEGORY_GEOMETRY ) );                                
-            FreeOnDestructor bufferPtrContainer( buffer );
-            memset( buffer, 0, bufferSize );
-            
-            v1::Mesh::PoseIterator poseIt = subMesh->parent->getPoseIterator();
-            
+            const size_t numVertices = vertexBuffer->getNumElements();
+
+            vector<float>::type positions( mNumPoses * numVertices * 3u, 0.0f );
+            vector<float>::type normals( mPoseNormals ? positions.size() : 0u, 0.0f );
+
             size_t index = 0u;
-            
-            while( poseIt.hasMoreElements() )
+
+            v1::PoseList::const_iterator itor = poseList.begin();
+            v1::PoseList::const_iterator end  = poseList.end();
+
+            while( itor != end )
             {
-                v1::Pose* pose = poseIt.getNext();
+                const v1::Pose *pose = *itor;
+                const size_t poseStart = index * numVertices * 3u;
+
                 v1::Pose::VertexOffsetMap::const_iterator v = pose->getVertexOffsets().begin();
-                v1::Pose::NormalsIterator::const_iterator n = pose->getNormalsIterator().begin();
-                
-                if( halfPrecision )
+                v1::Pose::VertexOffsetMap::const_iterator enV = pose->getVertexOffsets().end();
+                while( v != enV )
                 {
-                    uint16* pHalf = reinterpret_cast<uint16*>( buffer +  index * singlePoseBufferSize );
-                    while( v != pose->getVertexOffsets().end() )
-                    {
-                        size_t idx = v->first * elementsPerVertex;
-                        pHalf[idx+0] = Bitwise::floatToHalf( v->second.x );
-                        pHalf[idx+1] = Bitwise::floatToHalf( v->second.y );
-                        pHalf[idx+2] = Bitwise::floatToHalf( v->second.z );
-                        pHalf[idx+3] = Bitwise::floatToHalf( 0.f );
-                        ++v;
-
-                        if( mPoseNormals )
-                        {
-                            pHalf[idx+4] = Bitwise::floatToHalf( n->second.x );
-                            pHalf[idx+5] = Bitwise::floatToHalf( n->second.y );
-                            pHalf[idx+6] = Bitwise::floatToHalf( n->second.z );
-                            pHalf[idx+7] = Bitwise::floatToHalf( 0.f );
-                            ++n;
-                        }
-                    }
+                    const size_t idx = poseStart + v->first * 3u;
+                    positions[idx+0] = v->second.x;
+                    positions[idx+1] = v->second.y;
+                    positions[idx+2] = v->second.z;
+                    ++v;
                 }
-                else
+
+                if( mPoseNormals )
                 {
-                    float* pFloat = reinterpret_cast<float*>( buffer + index * singlePoseBufferSize );
-                    while( v != pose->getVertexOffsets().end() )
+                    v1::Pose::NormalsMap::const_iterator n = pose->getNormals().begin();
+                    v1::Pose::NormalsMap::const_iterator enN = pose->getNormals().end();
+                    while( n != enN )
                     {
-                        size_t idx = v->first * elementsPerVertex;
-                        pFloat[idx+0] = v->second.x;
-                        pFloat[idx+1] = v->second.y;
-                        pFloat[idx+2] = v->second.z;
-                        pFloat[idx+3] = 0.f;
-                        ++v;
-
-                        if( mPoseNormals )
-                        {
-                            pFloat[idx+4] = n->second.x;
-                            pFloat[idx+5] = n->second.y;
-                            pFloat[idx+6] = n->second.z;
-                            pFloat[idx+7] = 0.f;
-                            ++n;
-                        }
+                        const size_t idx = poseStart + n->first * 3u;
+                        normals[idx+0] = n->second.x;
+                        normals[idx+1] = n->second.y;
+                        normals[idx+2] = n->second.z;
+                        ++n;
                     }
                 }
-                
+
                 mPoseIndexMap[pose->getName()] = index++;
+                ++itor;
             }
-            
-            PixelFormatGpu pixelFormat = halfPrecision ? PFG_RGBA16_FLOAT : PFG_RGBA32_FLOAT;
-            mPoseTexBuffer = mParent->mVaoManager->createTexBuffer( pixelFormat, bufferSize,
-                                                                    BT_IMMUTABLE, buffer, false );
+
+            createPoseTexBuffers( &positions[0], mPoseNormals ? &normals[0] : 0,
+                                  numVertices, halfPrecision );
         }
     }
     //---------------------------------------------------------------------
@@ -740,73 +775,134 @@ namespace Ogre {
         mNumPoses = static_cast<uint16>( numPoses );
         mPoseHalfPrecision = halfPrecision;
         mPoseNormals = normalData != 0;
-        size_t elementSize = halfPrecision ? sizeof( uint16 ) : sizeof( float );
-        size_t elementsPerVertex = mPoseNormals ? 8 : 4;
-        size_t singlePoseBufferSize = numVertices * elementSize * elementsPerVertex;
-        size_t bufferSize = numPoses * singlePoseBufferSize;
+
+        vector<float>::type positions( numPoses * numVertices * 3u );
+        vector<float>::type normals( mPoseNormals ? positions.size() : 0u );
+
+        for( size_t poseIndex = 0; poseIndex < numPoses; ++poseIndex )
+        {
+            memcpy( &positions[poseIndex * numVertices * 3u], positionData[poseIndex],
+                    numVertices * 3u * sizeof(float) );
+            if( mPoseNormals )
+            {
+                memcpy( &normals[poseIndex * numVertices * 3u], normalData[poseIndex],
+                        numVertices * 3u * sizeof(float) );
+            }
+
+            if( names )
+            {
+                mPoseIndexMap[names[poseIndex]] = poseIndex;
+            }
+        }
+
+        if( numPoses > 0 )
+        {
+            createPoseTexBuffers( &positions[0], mPoseNormals ? &normals[0] : 0,
+                                  numVertices, halfPrecision );
+        }
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::createPoseTexBuffers( const float *positions, const float *normals,
+                                        size_t numVertices, bool halfPrecision )
+    {
+        const size_t numPoses = mNumPoses;
+        const size_t elementSize = halfPrecision ? sizeof( uint16 ) : sizeof( float );
+        const size_t elementsPerVertex = mPoseNormals ? 8u : 4u;
+        const size_t bytesPerVertex = elementSize * elementsPerVertex;
+
+        //Find which vertices are moved by at least one pose. Entry 0 is reserved
+        //for the ones that aren't, so they all can share the same zeroes.
+        FastArray<uint32> vertexToEntry;
+        vertexToEntry.resize( numVertices, 0u );
+        uint32 numEntries = 1u;
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            bool bMoved = false;
+            for( size_t poseIdx=0; poseIdx<numPoses && !bMoved; ++poseIdx )
+            {
+                const size_t idx = (poseIdx * numVertices + i) * 3u;
+                for( size_t j=0; j<3u; ++j )
+                {
+                    bMoved |= positions[idx+j] != 0.0f;
+                    if( mPoseNormals )
+                        bMoved |= normals[idx+j] != 0.0f;
+                }
+            }
+
+            if( bMoved )
+                vertexToEntry[i] = numEntries++;
+        }
+
+        const size_t denseSize = numPoses * numVertices * bytesPerVertex;
+        const size_t sparseSize = numPoses * numEntries * bytesPerVertex +
+                                  numVertices * sizeof(uint32);
+        const bool bSparse = sparseSize * 4u <= denseSize * 3u;
+
+        mNumPoseVertices = static_cast<uint32>( bSparse ? numEntries : numVertices );
+
+        const size_t singlePoseBufferSize = mNumPoseVertices * bytesPerVertex;
+        const size_t bufferSize = numPoses * singlePoseBufferSize;
         char *buffer = static_cast<char*>( OGRE_MALLOC_SIMD( bufferSize,
-                                                             MEMCATEGORY_GEOMETRY ) );                                
+                                                             MEMCATEGORY_GEOMETRY ) );
         FreeOnDestructor bufferPtrContainer( buffer );
         memset( buffer, 0, bufferSize );
-        
-        for( size_t poseIndex = 0; poseIndex < numPoses; ++poseIndex )
-        {
-            const float* pPosition = positionData[poseIndex];
-            const float* pNormal = normalData ? normalData[poseIndex] : 0;
 
-            if( halfPrecision )
+        for( size_t poseIdx=0; poseIdx<numPoses; ++poseIdx )
+        {
+            for( size_t i=0; i<numVertices; ++i )
             {
-                uint16* pHalf = reinterpret_cast<uint16*>( buffer +  poseIndex * singlePoseBufferSize );
-                for( size_t i = 0; i < numVertices; ++i )
+                const size_t entry = bSparse ? vertexToEntry[i] : i;
+                if( bSparse && entry == 0u )
+                    continue;
+
+                const float *pPosition = positions + (poseIdx * numVertices + i) * 3u;
+                const float *pNormal = mPoseNormals ?
+                                           (normals + (poseIdx * numVertices + i) * 3u) : 0;
+                const size_t idx = (poseIdx * mNumPoseVertices + entry) * elementsPerVertex;
+
+                if( halfPrecision )
                 {
-                    size_t idx = i * elementsPerVertex;
-                    pHalf[idx+0] = Bitwise::floatToHalf( *pPosition++ );
-                    pHalf[idx+1] = Bitwise::floatToHalf( *pPosition++ );
-                    pHalf[idx+2] = Bitwise::floatToHalf( *pPosition++ );
-                    pHalf[idx+3] = Bitwise::floatToHalf( 0.f );
+                    uint16 *pHalf = reinterpret_cast<uint16*>( buffer ) + idx;
+                    for( size_t j=0; j<3u; ++j )
+                        pHalf[j] = Bitwise::floatToHalf( pPosition[j] );
+                    pHalf[3] = Bitwise::floatToHalf( 0.f );
 
                     if( pNormal )
                     {
-                        pHalf[idx+4] = Bitwise::floatToHalf( *pNormal++ );
-                        pHalf[idx+5] = Bitwise::floatToHalf( *pNormal++ );
-                        pHalf[idx+6] = Bitwise::floatToHalf( *pNormal++ );
-                        pHalf[idx+7] = Bitwise::floatToHalf( 0.f );
+                        for( size_t j=0; j<3u; ++j )
+                            pHalf[4u+j] = Bitwise::floatToHalf( pNormal[j] );
+                        pHalf[7] = Bitwise::floatToHalf( 0.f );
                     }
                 }
-            }
-            else
-            {
-                float* pFloat = reinterpret_cast<float*>( buffer + poseIndex * singlePoseBufferSize );
-                for( size_t i = 0; i < numVertices; ++i )
+                else
                 {
-                    size_t idx = i * elementsPerVertex;
-                    pFloat[idx+0] = *pPosition++;
-                    pFloat[idx+1] = *pPosition++;
-                    pFloat[idx+2] = *pPosition++;
-                    pFloat[idx+3] = 0.f;
+                    float *pFloat = reinterpret_cast<float*>( buffer ) + idx;
+                    for( size_t j=0; j<3u; ++j )
+                        pFloat[j] = pPosition[j];
 
                     if( pNormal )
                     {
-                        pFloat[idx+4] = *pNormal++;
-                        pFloat[idx+5] = *pNormal++;
-                        pFloat[idx+6] = *pNormal++;
-                        pFloat[idx+7] = 0.f;
+                        for( size_t j=0; j<3u; ++j )
+                            pFloat[4u+j] = pNormal[j];
                     }
                 }
             }
-
-            if( names )
-            {
-                mPoseIndexMap[names[poseIndex]] = poseIndex;
-            }
         }
         
         PixelFormatGpu pixelFormat = halfPrecision ? PFG_RGBA16_FLOAT : PFG_RGBA32_FLOAT;
         mPoseTexBuffer = mParent->mVaoManager->createTexBuffer( pixelFormat, bufferSize,
                                                                 BT_IMMUTABLE, buffer, false );
+
+        if( bSparse )
+        {
+            mPoseIndexTexBuffer = mParent->mVaoManager->createTexBuffer(
+                                      PFG_R32_UINT, numVertices * sizeof(uint32), BT_IMMUTABLE,
+                                      vertexToEntry.begin(), false );
+        }
     }
     //---------------------------------------------------------------------
-    void SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents )
+    void SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
+                                    bool unormTexCoords )
     {
         uint8 numVaoPasses = mParent->hasIndependentShadowMappingVaos() + 1;
 
@@ -820,7 +916,8 @@ namespace Ogre {
 
             while( itor != end )
             {
-                newVaos.push_back( arrangeEfficient( halfPos, halfTexCoords, qTangents, *itor,
+                newVaos.push_back( arrangeEfficient( halfPos, halfTexCoords, qTangents,
+                                                     unormTexCoords, *itor,
                                                      sharedBuffers, mParent->mVaoManager ) );
                 ++itor;
             }
@@ -836,8 +933,32 @@ namespace Ogre {
             mVao[VpShadow] = mVao[VpNormal];
     }
     //---------------------------------------------------------------------
+    /// Returns true if all components of the given float or half element are in range [0; 1]
+    static bool isElementInUnitRange( const SubMesh::SourceData &srcData, size_t numVertices )
+    {
+        const VertexElementType baseType = v1::VertexElement::getBaseType( srcData.element.mType );
+        const size_t typeCount = v1::VertexElement::getTypeCount( srcData.element.mType );
+
+        const char *data = srcData.data;
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            for( size_t j=0; j<typeCount; ++j )
+            {
+                const float value = baseType == VET_HALF2 ?
+                            Bitwise::halfToFloat( reinterpret_cast<const uint16*>( data )[j] ) :
+                            reinterpret_cast<const float*>( data )[j];
+                if( !(value >= 0.0f && value <= 1.0f) )
+                    return false;
+            }
+
+            data += srcData.bytesPerVertex;
+        }
+
+        return true;
+    }
+    //---------------------------------------------------------------------
     VertexArrayObject* SubMesh::arrangeEfficient( bool halfPos, bool halfTexCoords, bool qTangents,
-                                                  VertexArrayObject *vao,
+                                                  bool unormTexCoords, VertexArrayObject *vao,
                                                   SharedVertexBufferMap &sharedBuffers,
                                                   VaoManager *vaoManager )
     {
@@ -896,10 +1017,24 @@ namespace Ogre {
 
                     accumOffset += v1::VertexElement::getTypeSize( itor->mType );
 
+                    const VertexElementType baseType =
+                            v1::VertexElement::getBaseType( origElement.mType );
+                    const size_t typeCount = v1::VertexElement::getTypeCount( origElement.mType );
+
+                    //UVs that are all in range [0; 1] get more precision as unorm16 than
+                    //as half, for the same size. There's no 1 or 3 component variant.
+                    if( unormTexCoords && origElement.mSemantic == VES_TEXTURE_COORDINATES &&
+                        (baseType == VET_FLOAT1 || baseType == VET_HALF2) &&
+                        (typeCount == 2u || typeCount == 4u) &&
+                        isElementInUnitRange( sourceData, vertexBuffers[i]->getNumElements() ) )
+                    {
+                        VertexElement2 &lastInserted = *(vertexElements.end() -
+                                                         reorderedElements - 1);
+                        lastInserted.mType = typeCount == 2u ? VET_USHORT2_NORM : VET_USHORT4_NORM;
+                    }
                     //We can't convert to half if it wasn't in floating point
                     //Also avoid converting 1 Float ==> 2 Half.
-                    if( v1::VertexElement::getBaseType( origElement.mType ) == VET_FLOAT1 &&
-                        v1::VertexElement::getTypeCount( origElement.mType ) != 1 )
+                    else if( baseType == VET_FLOAT1 && typeCount != 1 )
                     {
                         if( (origElement.mSemantic == VES_POSITION && halfPos) ||
                             (origElement.mSemantic == VES_TEXTURE_COORDINATES && halfTexCoords) )
@@ -1276,6 +1411,25 @@ namespace Ogre {
                     dstData16[2] = Bitwise::floatToSnorm16( qTangent.z );
                     dstData16[3] = Bitwise::floatToSnorm16( qTangent.w );
                 }
+                else if( v1::VertexElement::getBaseType( vElement.mType ) == VET_USHORT2_NORM &&
+                         vElement.mSemantic == VES_TEXTURE_COORDINATES &&
+                         itSrc->element.mType != vElement.mType )
+                {
+                    //Convert float or half to unorm16.
+                    const VertexElementType srcBaseType =
+                            v1::VertexElement::getBaseType( itSrc->element.mType );
+                    const size_t typeCount = v1::VertexElement::getTypeCount( vElement.mType );
+                    uint16 *dstData16 = reinterpret_cast<uint16*>(dstData + acumOffset);
+
+                    for( size_t j=0; j<typeCount; ++j )
+                    {
+                        const float value = srcBaseType == VET_HALF2 ?
+                                    Bitwise::halfToFloat(
+                                        reinterpret_cast<const uint16*>( itSrc->data )[j] ) :
+                                    reinterpret_cast<const float*>( itSrc->data )[j];
+                        dstData16[j] = Bitwise::floatToUnorm16( value );
+                    }
+                }
                 else if( v1::VertexElement::getBaseType( vElement.mType ) == VET_HALF2 &&
                          v1::VertexElement::getBaseType( itSrc->element.mType ) == VET_FLOAT1 )
                 {
@@ -1287,10 +1441,9 @@ namespace Ogre {
                     fpData[3] = 1.0f;
                     memcpy( fpData, itSrc->data, readSize );
 
-                    uint16 *dstData16 = reinterpret_cast<uint16*>(dstData + acumOffset);
-
-                    for( size_t j=0; j<v1::VertexElement::getTypeCount( vElement.mType ); ++j )
-                        dstData16[j] = Bitwise::floatToHalf( fpData[j] );
+                    uint16 halfData[4];
+                    floatToHalf4( fpData, halfData );
+                    memcpy( dstData + acumOffset, halfData, writeSize );
                 }
                 else
                 {
@@ -1420,6 +1573,15 @@ namespace Ogre {
 
                 newVertexElements.push_back( element );
             }
+            else if( baseType == VET_USHORT2_NORM && element.mSemantic == VES_TEXTURE_COORDINATES )
+            {
+                //Convert from unorm16 to float
+                element.mType = v1::VertexElement::multiplyTypeCount( VET_FLOAT1,
+                                                                      v1::VertexElement::
+                                                                      getTypeCount( element.mType ) );
+
+                newVertexElements.push_back( element );
+            }
             else if( element.mSemantic == VES_NORMAL && element.mType == VET_SHORT4_SNORM )
             {
                 //Dealing with QTangents.
@@ -1463,6 +1625,19 @@ namespace Ogre {
 
                     dstData += typeCount * sizeof(uint32);
                 }
+                else if( baseType == VET_USHORT2_NORM &&
+                         itElements->mSemantic == VES_TEXTURE_COORDINATES )
+                {
+                    //Convert unorm16 to float.
+                    const uint16 *srcData16 = reinterpret_cast<const uint16*>( srcData );
+                    float *dstDataF32 = reinterpret_cast<float*>(dstData);
+                    const size_t typeCount = v1::VertexElement::getTypeCount( itElements->mType );
+
+                    for( size_t j=0; j<typeCount; ++j )
+                        dstDataF32[j] = Bitwise::unorm16ToFloat( srcData16[j] );
+
+                    dstData += typeCount * sizeof(float);
+                }
                 else if( itElements->mSemantic == VES_NORMAL && itElements->mType == VET_SHORT4_SNORM )
                 {
                     //Dealing with QTangents.
@@ -1569,4 +1744,536 @@ namespace Ogre {
             VertexShadowMapHelper::useSameVaos( mParent->mVaoManager, mVao[VpNormal], mVao[VpShadow] );
         }
     }
+    //---------------------------------------------------------------------
+    /// Reads back VES_POSITION from the vao, decompressed to Vector3
+    static void readVertexPositions( VertexArrayObject *vao, vector<Vector3>::type &outPositions )
+    {
+        VertexArrayObject::ReadRequestsArray readRequests;
+        readRequests.push_back( VertexArrayObject::ReadRequests( VES_POSITION ) );
+        vao->readRequests( readRequests );
+
+        if( readRequests[0].type != VET_FLOAT3 && readRequests[0].type != VET_FLOAT4 &&
+            readRequests[0].type != VET_HALF4 )
+        {
+            OGRE_EXCEPT( Exception::ERR_NOT_IMPLEMENTED,
+                         "Position must be VET_FLOAT3, VET_FLOAT4 or VET_HALF4",
+                         "SubMesh::readVertexPositions" );
+        }
+
+        vao->mapAsyncTickets( readRequests );
+
+        const size_t numVertices    = readRequests[0].vertexBuffer->getNumElements();
+        const size_t bytesPerVertex = readRequests[0].vertexBuffer->getBytesPerElement();
+        const bool halfPos          = readRequests[0].type == VET_HALF4;
+
+        outPositions.clear();
+        outPositions.reserve( numVertices );
+        for( size_t i=0; i<numVertices; ++i )
+        {
+            const char *vertexData = readRequests[0].data + i * bytesPerVertex;
+            if( halfPos )
+            {
+                const uint16 *posData = reinterpret_cast<const uint16*>( vertexData );
+                outPositions.push_back( Vector3( Bitwise::halfToFloat( posData[0] ),
+                                                 Bitwise::halfToFloat( posData[1] ),
+                                                 Bitwise::halfToFloat( posData[2] ) ) );
+            }
+            else
+            {
+                const float *posData = reinterpret_cast<const float*>( vertexData );
+                outPositions.push_back( Vector3( posData[0], posData[1], posData[2] ) );
+            }
+        }
+
+        vao->unmapAsyncTickets( readRequests );
+    }
+    //---------------------------------------------------------------------
+    /// Reads back the whole index buffer, expanded to 32-bit
+    static void readIndices( IndexBufferPacked *indexBuffer, vector<uint32>::type &outIndices )
+    {
+        const size_t numIndices = indexBuffer->getNumElements();
+        outIndices.resize( numIndices );
+        if( !numIndices )
+            return;
+
+        AsyncTicketPtr asyncTicket = indexBuffer->readRequest( 0, numIndices );
+        const void *indexData = asyncTicket->map();
+
+        if( indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT )
+        {
+            const uint16 *indexData16 = static_cast<const uint16*>( indexData );
+            for( size_t i=0; i<numIndices; ++i )
+                outIndices[i] = indexData16[i];
+        }
+        else
+        {
+            memcpy( &outIndices[0], indexData, numIndices * sizeof(uint32) );
+        }
+
+        asyncTicket->unmap();
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::buildMeshlets( uint32 maxVertices, uint32 maxTriangles )
+    {
+        mMeshlets.clear();
+
+        if( mVao[VpNormal].empty() )
+            return;
+
+        if( maxVertices < 3u || maxTriangles < 1u )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "maxVertices must be >= 3 and maxTriangles >= 1",
+                         "SubMesh::buildMeshlets" );
+        }
+
+        VertexArrayObject *vao = mVao[VpNormal][0];
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+        if( !indexBuffer || vao->getOperationType() != OT_TRIANGLE_LIST )
+        {
+            LogManager::getSingleton().logMessage( "SubMesh::buildMeshlets: Only indexed triangle "
+                                                   "lists are supported. Skipping submesh with "
+                                                   "material " + mMaterialName );
+            return;
+        }
+
+        vector<Vector3>::type positions;
+        readVertexPositions( vao, positions );
+        vector<uint32>::type indices;
+        readIndices( indexBuffer, indices );
+
+        const size_t numVertices = positions.size();
+        const uint32 indexStart = vao->getPrimitiveStart();
+        const uint32 indexEnd   = indexStart + (vao->getPrimitiveCount() / 3u) * 3u;
+
+        //Marks the last meshlet that referenced each vertex, to count unique vertices.
+        vector<uint32>::type vertexMeshletIdx( numVertices, std::numeric_limits<uint32>::max() );
+
+        Meshlet meshlet;
+        meshlet.indexStart = indexStart;
+        meshlet.indexCount = 0;
+        uint32 meshletVertices = 0;
+
+        for( uint32 idx=indexStart; idx<indexEnd; idx += 3u )
+        {
+            uint32 triIndices[3];
+            for( size_t i=0; i<3u; ++i )
+            {
+                triIndices[i] = indices[idx + i];
+                assert( triIndices[i] < numVertices && "Index out of bounds" );
+            }
+
+            const uint32 currentMeshletIdx = static_cast<uint32>( mMeshlets.size() );
+
+            uint32 newVertices = 0;
+            for( size_t i=0; i<3u; ++i )
+            {
+                if( vertexMeshletIdx[triIndices[i]] != currentMeshletIdx &&
+                    (i < 1u || triIndices[i] != triIndices[0]) &&
+                    (i < 2u || triIndices[i] != triIndices[1]) )
+                {
+                    ++newVertices;
+                }
+            }
+
+            if( meshlet.indexCount > 0u &&
+                (meshletVertices + newVertices > maxVertices ||
+                 meshlet.indexCount / 3u >= maxTriangles) )
+            {
+                mMeshlets.push_back( meshlet );
+                meshlet.indexStart  = idx;
+                meshlet.indexCount  = 0;
+                meshletVertices     = 0;
+            }
+
+            const uint32 meshletIdx = static_cast<uint32>( mMeshlets.size() );
+            for( size_t i=0; i<3u; ++i )
+            {
+                if( vertexMeshletIdx[triIndices[i]] != meshletIdx )
+                {
+                    vertexMeshletIdx[triIndices[i]] = meshletIdx;
+                    ++meshletVertices;
+                }
+            }
+
+            meshlet.indexCount += 3u;
+        }
+
+        if( meshlet.indexCount > 0u )
+            mMeshlets.push_back( meshlet );
+
+        //Now calculate the bounds of each meshlet
+        MeshletVec::iterator itor = mMeshlets.begin();
+        MeshletVec::iterator end  = mMeshlets.end();
+
+        while( itor != end )
+        {
+            Meshlet &m = *itor;
+            const uint32 mIndexEnd = m.indexStart + m.indexCount;
+
+            Vector3 vMin( Vector3::UNIT_SCALE * std::numeric_limits<Real>::max() );
+            Vector3 vMax( -Vector3::UNIT_SCALE * std::numeric_limits<Real>::max() );
+            Vector3 normalSum( Vector3::ZERO );
+
+            vector<Vector3>::type triNormals;
+            triNormals.reserve( m.indexCount / 3u );
+
+            for( uint32 idx=m.indexStart; idx<mIndexEnd; idx += 3u )
+            {
+                Vector3 triPos[3];
+                for( size_t i=0; i<3u; ++i )
+                {
+                    triPos[i] = positions[indices[idx + i]];
+                    vMin.makeFloor( triPos[i] );
+                    vMax.makeCeil( triPos[i] );
+                }
+
+                Vector3 normal = (triPos[1] - triPos[0]).crossProduct( triPos[2] - triPos[0] );
+                const Real normalLength = normal.length();
+                //Degenerate triangles can't be seen, they don't affect the cone
+                if( normalLength > std::numeric_limits<Real>::epsilon() )
+                {
+                    normal /= normalLength;
+                    normalSum += normal;
+                    triNormals.push_back( normal );
+                }
+            }
+
+            m.center = (vMin + vMax) * 0.5f;
+            Real radiusSq = 0;
+            for( uint32 idx=m.indexStart; idx<mIndexEnd; ++idx )
+            {
+                radiusSq = std::max( radiusSq, m.center.squaredDistance( positions[indices[idx]] ) );
+            }
+            m.radius = Math::Sqrt( radiusSq );
+
+            //Default to a cone that never gets culled.
+            m.coneAxis = Vector3::ZERO;
+            m.coneCutoff = 1.0f;
+
+            const Real axisLength = normalSum.length();
+            if( axisLength > std::numeric_limits<Real>::epsilon() )
+            {
+                const Vector3 axis = normalSum / axisLength;
+
+                Real minDot = 1.0f;
+                vector<Vector3>::type::const_iterator itNormal = triNormals.begin();
+                vector<Vector3>::type::const_iterator enNormal = triNormals.end();
+                while( itNormal != enNormal )
+                {
+                    minDot = std::min( minDot, axis.dotProduct( *itNormal ) );
+                    ++itNormal;
+                }
+
+                //Cones wider than ~85° almost never pass the test. Don't waste time on them.
+                if( minDot > 0.1f )
+                {
+                    m.coneAxis = axis;
+                    m.coneCutoff = Math::Sqrt( 1.0f - minDot * minDot );
+                }
+            }
+
+            ++itor;
+        }
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::computeAabb(void)
+    {
+        mAabb = Aabb::BOX_NULL;
+
+        if( mVao[VpNormal].empty() )
+            return;
+
+        VertexArrayObject *vao = mVao[VpNormal][0];
+
+        vector<Vector3>::type positions;
+        readVertexPositions( vao, positions );
+
+        const uint32 primStart = vao->getPrimitiveStart();
+        const uint32 primEnd   = primStart + vao->getPrimitiveCount();
+
+        Vector3 vMin( Vector3::UNIT_SCALE * std::numeric_limits<Real>::max() );
+        Vector3 vMax( -Vector3::UNIT_SCALE * std::numeric_limits<Real>::max() );
+        bool anyVertex = false;
+
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+        if( indexBuffer )
+        {
+            vector<uint32>::type indices;
+            readIndices( indexBuffer, indices );
+
+            const uint32 idxEnd = std::min<uint32>( primEnd, static_cast<uint32>( indices.size() ) );
+            for( uint32 idx=primStart; idx<idxEnd; ++idx )
+            {
+                assert( indices[idx] < positions.size() && "Index out of bounds" );
+                vMin.makeFloor( positions[indices[idx]] );
+                vMax.makeCeil( positions[indices[idx]] );
+                anyVertex = true;
+            }
+        }
+        else
+        {
+            const uint32 vertEnd = std::min<uint32>( primEnd,
+                                                     static_cast<uint32>( positions.size() ) );
+            for( uint32 i=primStart; i<vertEnd; ++i )
+            {
+                vMin.makeFloor( positions[i] );
+                vMax.makeCeil( positions[i] );
+                anyVertex = true;
+            }
+        }
+
+        if( anyVertex )
+            mAabb = Aabb::newFromExtents( vMin, vMax );
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::readTriangleList( vector<Vector3>::type &outPositions,
+                                    vector<uint32>::type &outIndices ) const
+    {
+        outPositions.clear();
+        outIndices.clear();
+
+        if( mVao[VpNormal].empty() ||
+            mVao[VpNormal][0]->getOperationType() != OT_TRIANGLE_LIST )
+        {
+            return;
+        }
+
+        VertexArrayObject *vao = mVao[VpNormal][0];
+        readVertexPositions( vao, outPositions );
+
+        const uint32 primStart = vao->getPrimitiveStart();
+        uint32 primEnd = primStart + vao->getPrimitiveCount();
+
+        IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+        if( indexBuffer )
+        {
+            vector<uint32>::type indices;
+            readIndices( indexBuffer, indices );
+            primEnd = std::min<uint32>( primEnd, static_cast<uint32>( indices.size() ) );
+            primEnd -= (primEnd - std::min( primStart, primEnd )) % 3u;
+            if( primStart < primEnd )
+                outIndices.assign( indices.begin() + primStart, indices.begin() + primEnd );
+        }
+        else
+        {
+            primEnd = std::min<uint32>( primEnd, static_cast<uint32>( outPositions.size() ) );
+            primEnd -= (primEnd - std::min( primStart, primEnd )) % 3u;
+            outIndices.reserve( primEnd > primStart ? primEnd - primStart : 0u );
+            for( uint32 i=primStart; i<primEnd; ++i )
+                outIndices.push_back( i );
+        }
+    }
+    //---------------------------------------------------------------------
+    void SubMesh::optimise( bool vertexCache, bool overdraw, bool vertexFetch )
+    {
+        if( mVao[VpNormal].empty() || (!vertexCache && !overdraw && !vertexFetch) )
+            return;
+
+        VaoManager *vaoManager = mParent->mVaoManager;
+
+        const size_t numLods = mVao[VpNormal].size();
+        //Copy, LOD 0's Vao gets destroyed before we're done with it.
+        const VertexBufferPackedVec origVertexBuffers = mVao[VpNormal][0]->getVertexBuffers();
+
+        //Gather the indices of every LOD we can work with.
+        vector< vector<uint32>::type >::type lodIndices( numLods );
+        FastArray<bool> lodOptimisable;
+        lodOptimisable.resize( numLods, false );
+        bool canRemapVertices = vertexFetch && mNumPoses == 0u;
+        bool anyOptimisable = false;
+
+        for( size_t lodIdx=0; lodIdx<numLods; ++lodIdx )
+        {
+            VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+
+            //Vertices can only be reordered if all LODs share them, and they all have indices.
+            if( !(vao->getVertexBuffers() == origVertexBuffers) || !vao->getIndexBuffer() ||
+                vao->getOperationType() != OT_TRIANGLE_LIST )
+            {
+                canRemapVertices = false;
+            }
+
+            if( vao->getIndexBuffer() && vao->getOperationType() == OT_TRIANGLE_LIST )
+            {
+                readIndices( vao->getIndexBuffer(), lodIndices[lodIdx] );
+                lodOptimisable[lodIdx] = true;
+                anyOptimisable = true;
+            }
+        }
+
+        if( !anyOptimisable )
+        {
+            LogManager::getSingleton().logMessage( "SubMesh::optimise: Only indexed triangle "
+                                                   "lists can be optimised. Skipping submesh with "
+                                                   "material " + mMaterialName );
+            return;
+        }
+
+        //Reorder the triangles.
+        vector<Vector3>::type positions;
+        const VertexBufferPacked *positionsSource = 0;
+
+        for( size_t lodIdx=0; lodIdx<numLods; ++lodIdx )
+        {
+            if( !lodOptimisable[lodIdx] || lodIndices[lodIdx].empty() )
+                continue;
+
+            VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+            const size_t numVertices = vao->getVertexBuffers()[0]->getNumElements();
+            uint32 *indices = &lodIndices[lodIdx][vao->getPrimitiveStart()];
+            const size_t numIndices = (vao->getPrimitiveCount() / 3u) * 3u;
+
+            if( vertexCache )
+                MeshOptimiser::optimiseVertexCache( indices, numIndices, numVertices );
+
+            if( overdraw )
+            {
+                if( positionsSource != vao->getVertexBuffers()[0] )
+                {
+                    readVertexPositions( vao, positions );
+                    positionsSource = vao->getVertexBuffers()[0];
+                }
+
+                MeshOptimiser::optimiseOverdraw( indices, numIndices, &positions[0], numVertices );
+            }
+        }
+
+        //Reorder the vertices based on how LOD 0 fetches them.
+        VertexBufferPackedVec newVertexBuffers;
+        if( canRemapVertices && !lodIndices[0].empty() )
+        {
+            FastArray<uint32> oldToNew;
+            MeshOptimiser::optimiseVertexFetch( &lodIndices[0][0], lodIndices[0].size(),
+                                                origVertexBuffers[0]->getNumElements(), oldToNew );
+
+            for( size_t lodIdx=1; lodIdx<numLods; ++lodIdx )
+            {
+                vector<uint32>::type::iterator itor = lodIndices[lodIdx].begin();
+                vector<uint32>::type::iterator end  = lodIndices[lodIdx].end();
+                while( itor != end )
+                {
+                    *itor = oldToNew[*itor];
+                    ++itor;
+                }
+            }
+
+            VertexBufferPackedVec::const_iterator itBuffer = origVertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator enBuffer = origVertexBuffers.end();
+
+            while( itBuffer != enBuffer )
+            {
+                VertexBufferPacked *vertexBuffer = *itBuffer;
+                const size_t numVertices    = vertexBuffer->getNumElements();
+                const size_t bytesPerVertex = vertexBuffer->getBytesPerElement();
+
+                char *newData = static_cast<char*>( OGRE_MALLOC_SIMD( numVertices * bytesPerVertex,
+                                                                      MEMCATEGORY_GEOMETRY ) );
+                FreeOnDestructor dataPtrContainer( newData );
+
+                AsyncTicketPtr asyncTicket = vertexBuffer->readRequest( 0, numVertices );
+                const char *srcData = static_cast<const char*>( asyncTicket->map() );
+                for( size_t i=0; i<numVertices; ++i )
+                {
+                    memcpy( newData + oldToNew[i] * bytesPerVertex, srcData + i * bytesPerVertex,
+                            bytesPerVertex );
+                }
+                asyncTicket->unmap();
+
+                const bool keepAsShadow = vertexBuffer->getShadowCopy() != 0;
+                newVertexBuffers.push_back( vaoManager->createVertexBuffer(
+                                                vertexBuffer->getVertexElements(), numVertices,
+                                                vertexBuffer->getBufferType(), newData,
+                                                keepAsShadow ) );
+                if( keepAsShadow )
+                    dataPtrContainer.ptr = 0;
+
+                ++itBuffer;
+            }
+
+            VertexBoneAssignmentVec::iterator itBone = mBoneAssignments.begin();
+            VertexBoneAssignmentVec::iterator enBone = mBoneAssignments.end();
+            while( itBone != enBone )
+            {
+                itBone->vertexIndex = oldToNew[itBone->vertexIndex];
+                ++itBone;
+            }
+            std::sort( mBoneAssignments.begin(), mBoneAssignments.end() );
+        }
+
+        //Shadow mapping Vaos may share the buffers we're about to replace.
+        const bool hadIndependentVaos = !mVao[VpShadow].empty() &&
+                                        mVao[VpNormal][0] != mVao[VpShadow][0];
+        destroyShadowMappingVaos();
+
+        //Replace the index buffers and Vaos.
+        for( size_t lodIdx=0; lodIdx<numLods; ++lodIdx )
+        {
+            VertexArrayObject *vao = mVao[VpNormal][lodIdx];
+            IndexBufferPacked *indexBuffer = vao->getIndexBuffer();
+
+            if( !lodOptimisable[lodIdx] && newVertexBuffers.empty() )
+                continue;
+
+            IndexBufferPacked *newIndexBuffer = indexBuffer;
+            if( lodOptimisable[lodIdx] )
+            {
+                const vector<uint32>::type &indices = lodIndices[lodIdx];
+                const bool index16 = indexBuffer->getIndexType() == IndexBufferPacked::IT_16BIT;
+                const size_t bytesPerIndex = index16 ? sizeof(uint16) : sizeof(uint32);
+
+                void *indexData = OGRE_MALLOC_SIMD( indices.size() * bytesPerIndex,
+                                                    MEMCATEGORY_GEOMETRY );
+                FreeOnDestructor dataPtrContainer( indexData );
+
+                if( index16 )
+                {
+                    uint16 *indexData16 = static_cast<uint16*>( indexData );
+                    for( size_t i=0; i<indices.size(); ++i )
+                        indexData16[i] = static_cast<uint16>( indices[i] );
+                }
+                else if( !indices.empty() )
+                {
+                    memcpy( indexData, &indices[0], indices.size() * sizeof(uint32) );
+                }
+
+                const bool keepAsShadow = indexBuffer->getShadowCopy() != 0;
+                newIndexBuffer = vaoManager->createIndexBuffer( indexBuffer->getIndexType(),
+                                                                indices.size(),
+                                                                indexBuffer->getBufferType(),
+                                                                indexData, keepAsShadow );
+                if( keepAsShadow )
+                    dataPtrContainer.ptr = 0;
+            }
+
+            VertexArrayObject *newVao = vaoManager->createVertexArrayObject(
+                                            newVertexBuffers.empty() ? vao->getVertexBuffers() :
+                                                                       newVertexBuffers,
+                                            newIndexBuffer, vao->getOperationType() );
+            newVao->setPrimitiveRange( vao->getPrimitiveStart(), vao->getPrimitiveCount() );
+
+            if( newIndexBuffer != indexBuffer )
+                vaoManager->destroyIndexBuffer( indexBuffer );
+            vaoManager->destroyVertexArrayObject( vao );
+
+            mVao[VpNormal][lodIdx] = newVao;
+        }
+
+        if( !newVertexBuffers.empty() )
+        {
+            VertexBufferPackedVec::const_iterator itBuffer = origVertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator enBuffer = origVertexBuffers.end();
+            while( itBuffer != enBuffer )
+                vaoManager->destroyVertexBuffer( *itBuffer++ );
+        }
+
+        //Triangle order changed, meshlets are no longer valid.
+        mMeshlets.clear();
+
+        const bool oldValue = Mesh::msOptimizeForShadowMapping;
+        Mesh::msOptimizeForShadowMapping = hadIndependentVaos;
+        _prepareForShadowMapping( false );
+        Mesh::msOptimizeForShadowMapping = oldValue;
+    }
 }
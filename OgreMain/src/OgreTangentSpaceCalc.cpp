@@ -30,6 +30,8 @@ THE SOFTWARE.
 #include "OgreHardwareBufferManager.h"
 #include "OgreLogManager.h"
 #include "OgreException.h"
+#include "OgrePlatformInformation.h"
+#include "Threading/OgreThreads.h"
 
 #include <sstream>
 
@@ -268,9 +270,10 @@ namespace v1
 
             // current triangle
             size_t vertInd[3] = { 0, 0, 0 };
-            // loop through all faces to calculate the tangents and normals
+            // loop through all faces to gather their indices
             size_t faceCount = opType == OT_TRIANGLE_LIST ?
                 i_in->indexCount / 3 : i_in->indexCount - 2;
+            mFaceArray.resize(faceCount);
             for (size_t f = 0; f < faceCount; ++f)
             {
                 bool invertOrdering = false;
@@ -305,7 +308,7 @@ namespace v1
                 }
 
                 // deal with strip inversion of winding
-                size_t localVertInd[3];
+                size_t *localVertInd = mFaceArray[f].vertInd;
                 localVertInd[0] = vertInd[0];
                 if (invertOrdering)
                 {
@@ -317,29 +320,110 @@ namespace v1
                     localVertInd[1] = vertInd[1];
                     localVertInd[2] = vertInd[2];
                 }
+            }
 
+            // For each triangle
+            //   Calculate tangent & binormal per triangle
+            //   Note these are not normalised, are weighted by UV area
+            calculateFaceInfos();
 
-                // For each triangle
-                //   Calculate tangent & binormal per triangle
-                //   Note these are not normalised, are weighted by UV area
-                Vector3 faceTsU, faceTsV, faceNorm;
-                calculateFaceTangentSpace(localVertInd, faceTsU, faceTsV, faceNorm);
+            // Accumulating into vertices may split them, so it must follow face order
+            for (size_t f = 0; f < faceCount; ++f)
+            {
+                FaceInfo &face = mFaceArray[f];
 
                 // Skip invalid UV space triangles
-                if (faceTsU.isZeroLength() || faceTsV.isZeroLength())
+                if (face.tsU.isZeroLength() || face.tsV.isZeroLength())
                     continue;
 
-                addFaceTangentSpaceToVertices(i, f, localVertInd, faceTsU, faceTsV, faceNorm, result);
+                addFaceTangentSpaceToVertices(i, f, face.vertInd, face.tsU, face.tsV, face.tsN,
+                                              face.angleWeight, result);
+            }
+        }
+
+        mFaceArray.clear();
+    }
+    //---------------------------------------------------------------------
+    namespace
+    {
+        struct FaceInfoJob
+        {
+            TangentSpaceCalc *tangentSpaceCalc;
+            size_t faceStart;
+            size_t faceEnd;
+        };
+
+        unsigned long calculateFaceInfosThread( ThreadHandle *threadHandle )
+        {
+            const FaceInfoJob *job = reinterpret_cast<const FaceInfoJob*>(
+                                         threadHandle->getUserParam() );
+            job->tangentSpaceCalc->_calculateFaceInfos( job->faceStart, job->faceEnd );
+            return 0;
+        }
+        THREAD_DECLARE( calculateFaceInfosThread );
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::calculateFaceInfos(void)
+    {
+        const size_t faceCount = mFaceArray.size();
+
+        size_t numThreads = 1u;
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        // Threads only pay off with big meshes
+        if (faceCount >= 65536u)
+        {
+            //getNumLogicalCores() may return 0 if couldn't detect
+            numThreads = std::max<size_t>( 1u, PlatformInformation::getNumLogicalCores() );
+            numThreads = std::min<size_t>( numThreads, 16u );
+        }
+#endif
+
+        if (numThreads <= 1u)
+        {
+            _calculateFaceInfos(0, faceCount);
+            return;
+        }
 
+        FaceInfoJob jobs[16];
+        ThreadHandleVec threadHandles;
+        threadHandles.reserve(numThreads - 1u);
+        for (size_t i = 0; i < numThreads; ++i)
+        {
+            jobs[i].tangentSpaceCalc = this;
+            jobs[i].faceStart = (faceCount * i) / numThreads;
+            jobs[i].faceEnd = (faceCount * (i + 1u)) / numThreads;
+            if (i != 0u)
+            {
+                threadHandles.push_back( Threads::CreateThread(
+                    THREAD_GET( calculateFaceInfosThread ), i, &jobs[i] ) );
             }
         }
 
+        _calculateFaceInfos(jobs[0].faceStart, jobs[0].faceEnd);
+        Threads::WaitForThreads(threadHandles);
+    }
+    //---------------------------------------------------------------------
+    void TangentSpaceCalc::_calculateFaceInfos(size_t faceStart, size_t faceEnd)
+    {
+        for (size_t f = faceStart; f < faceEnd; ++f)
+        {
+            FaceInfo &face = mFaceArray[f];
+            calculateFaceTangentSpace(face.vertInd, face.tsU, face.tsV, face.tsN);
+
+            // We want to re-weight these by the angle the face makes with the vertex
+            // in order to obtain tessellation-independent results
+            for (int v = 0; v < 3; ++v)
+            {
+                face.angleWeight[v] = calculateAngleWeight(face.vertInd[v],
+                    face.vertInd[(v+1)%3], face.vertInd[(v+2)%3]);
+            }
+        }
     }
     //---------------------------------------------------------------------
     void TangentSpaceCalc::addFaceTangentSpaceToVertices(
         size_t indexSet, size_t faceIndex, size_t *localVertInd, 
         const Vector3& faceTsU, const Vector3& faceTsV, const Vector3& faceNorm, 
-        Result& result)
+        const Real *angleWeights, Result& result)
     {
         // Calculate parity for this triangle
         int faceParity = calculateParity(faceTsU, faceTsV, faceNorm);
@@ -347,12 +431,7 @@ namespace v1
         for (int v = 0; v < 3; ++v)
         {
             // index 0 is vertex we're calculating, 1 and 2 are the others
-
-            // We want to re-weight these by the angle the face makes with the vertex
-            // in order to obtain tessellation-independent results
-            Real angleWeight = calculateAngleWeight(localVertInd[v], 
-                localVertInd[(v+1)%3], localVertInd[(v+2)%3]);
-
+            const Real angleWeight = angleWeights[v];
 
             VertexInfo* vertex = &(mVertexArray[localVertInd[v]]);
 
@@ -173,6 +173,30 @@ namespace TextureFilter
             texture->setNumMipmaps( image.getNumMipmaps() );
     }
     //-----------------------------------------------------------------------------------
+    bool GenerateSwMipmaps::_generateAhead( uint32 filters, Image2 &image, bool isSRgb,
+                                            const TextureGpuManager *textureManager )
+    {
+        if( image.getNumMipmaps() > 1u ||
+            (filters & (TextureFilter::TypePrepareForNormalMapping |
+                        TextureFilter::TypeLeaveChannelR)) ||
+            (image.getTextureType() != TextureTypes::Type2D &&
+             image.getTextureType() != TextureTypes::TypeCube) ||
+            selectMipmapGen( filters, image, textureManager ) != DefaultMipmapGen::SwMode )
+        {
+            return false;
+        }
+
+        const Image2::Filter filter = static_cast<Image2::Filter>( getFilter( image ) );
+        if( !Image2::supportsSwMipmaps( image.getPixelFormat(), image.getDepthOrSlices(),
+                                        image.getTextureType(), filter ) )
+        {
+            return false;
+        }
+
+        isSRgb |= PixelFormatGpuUtils::isSRgb( image.getPixelFormat() );
+        return image.generateMipmaps( isSRgb, filter );
+    }
+    //-----------------------------------------------------------------------------------
     void GenerateHwMipmaps::_executeStreaming( Image2 &image, TextureGpu *texture )
     {
         //Cubemaps may be loaded as 6 separate images.
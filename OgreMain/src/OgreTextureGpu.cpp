@@ -42,6 +42,7 @@ THE SOFTWARE.
 #include "OgreException.h"
 
 #include "OgreLogManager.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -59,6 +60,11 @@ namespace Ogre
         mNumMipmaps( 1 ),
         mInternalSliceStart( 0 ),
         mSourceType( TextureSourceType::Standard ),
+        mMemoryTag( GpuMemoryTracker::getTagForNewResource() ),
+        mNumMipmapsToSkip( 0 ),
+        mRequiredResolution( 0 ),
+        mLastUsedFrame( 0 ),
+        mEvictedByBudget( false ),
         mTextureType( initialType ),
         mPixelFormat( PFG_UNKNOWN ),
         mTextureFlags( textureFlags ),
@@ -224,6 +230,19 @@ namespace Ogre
         return mNumMipmaps;
     }
     //-----------------------------------------------------------------------------------
+    void TextureGpu::_notifyRequiredResolution( uint32 pixels )
+    {
+        mRequiredResolution = std::max( mRequiredResolution, pixels );
+        mLastUsedFrame = mTextureManager->getFrameCount();
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpu::setNumMipmapsToSkip( uint8 numMipmaps )
+    {
+        //Read by the worker thread while loading
+        assert( mResidencyStatus == GpuResidency::OnStorage || isDataReady() );
+        mNumMipmapsToSkip = numMipmaps;
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpu::setTextureType( TextureTypes::TextureTypes textureType )
     {
         assert( mResidencyStatus == GpuResidency::OnStorage );
@@ -266,6 +285,10 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     uint8 TextureGpu::getSourceType( void ) const { return mSourceType; }
     //-----------------------------------------------------------------------------------
+    void TextureGpu::_setMemoryTag( uint8 tag ) { mMemoryTag = tag; }
+    //-----------------------------------------------------------------------------------
+    uint8 TextureGpu::getMemoryTag( void ) const { return mMemoryTag; }
+    //-----------------------------------------------------------------------------------
     void TextureGpu::setSampleDescription( SampleDescription desc )
     {
         assert( mResidencyStatus == GpuResidency::OnStorage );
@@ -614,9 +637,15 @@ namespace Ogre
     void TextureGpu::copyTo( TextureGpu *dst, const TextureBox &dstBox, uint8 dstMipLevel,
                              const TextureBox &srcBox, uint8 srcMipLevel, bool keepResolvedTexSynced )
     {
-        assert( srcBox.equalSize( dstBox ) );
+        //Copies between uncompressed & compressed formats of the same block size
+        //(e.g. PFG_RG32_UINT -> PFG_BC1_UNORM) map one texel to one block
+        assert( srcBox.equalSize( dstBox ) ||
+                PixelFormatGpuUtils::isCompressed( this->getPixelFormat() ) !=
+                PixelFormatGpuUtils::isCompressed( dst->getPixelFormat() ) );
         assert( this != dst || !srcBox.overlaps( dstBox ) );
         assert( srcMipLevel < this->getNumMipmaps() && dstMipLevel < dst->getNumMipmaps() );
+
+        dst->_notifyContentChanged();
     }
     //-----------------------------------------------------------------------------------
     void TextureGpu::_setDepthBufferDefaults( uint16 depthBufferPoolId, bool preferDepthTexture,
@@ -817,6 +846,8 @@ namespace Ogre
     {
         TextureGpuListener::Reason reason = static_cast<TextureGpuListener::Reason>( _reason );
 
+        _notifyContentChanged();
+
         //Iterate through a copy in case one of the listeners decides to remove itself.
         vector<TextureGpuListener*>::type listenersVec = mListeners;
         vector<TextureGpuListener*>::type::iterator itor = listenersVec.begin();
@@ -41,14 +41,17 @@ THE SOFTWARE.
 #include "OgreCommon.h"
 #include "OgreBitwise.h"
 
+#include "Vao/OgreUploadScheduler.h"
 #include "Vao/OgreVaoManager.h"
 #include "OgreResourceGroupManager.h"
 #include "OgreImage2.h"
 #include "OgreTextureFilters.h"
 
 #include "OgreHlmsDatablock.h"
+#include "OgreAsyncArchiveReader.h"
 
 #include "Threading/OgreThreads.h"
+#include "Threading/OgreBarrier.h"
 
 #include "OgreRenderSystem.h"
 #include "OgreException.h"
@@ -56,6 +59,9 @@ THE SOFTWARE.
 #include "OgreString.h"
 
 #include "OgreProfiler.h"
+#include "OgreRoot.h"
+#include "OgreFrameMetrics.h"
+#include "OgreLoadProfiler.h"
 
 #include <fstream>
 
@@ -79,6 +85,8 @@ namespace Ogre
 
     unsigned long updateStreamingWorkerThread( ThreadHandle *threadHandle );
     THREAD_DECLARE( updateStreamingWorkerThread );
+    unsigned long updateDecoderThread( ThreadHandle *threadHandle );
+    THREAD_DECLARE( updateDecoderThread );
 
     TextureGpuManager::TextureGpuManager( VaoManager *vaoManager, RenderSystem *renderSystem ) :
         mDefaultMipmapGen( DefaultMipmapGen::HwMode ),
@@ -87,7 +95,20 @@ namespace Ogre
         mTryLockMutexFailureCount( 0u ),
         mTryLockMutexFailureLimit( 1200u ),
         mAddedNewLoadRequests( false ),
+        mDecoderThreadsBarrier( 0 ),
+        mStopDecoderThreads( false ),
+        mAsyncArchiveReader( 0 ),
         mEntriesToProcessPerIteration( 3u ),
+        mMipStreaming( false ),
+        mMipStreamingMaxSkip( 4u ),
+        mMipStreamingInterval( 60u ),
+        mMipStreamingFrameCount( 0u ),
+        mMipStreamingBudget( 0u ),
+        mPoolDefragSlicesPerFrame( 0u ),
+        mResidencyBudget( 0u ),
+        mResidencyMinUnusedFrames( 300u ),
+        mResidencyEvictTo( GpuResidency::OnStorage ),
+        mFrameCount( 1u ),
         mMaxPreloadBytes( 256u * 1024u * 1024u ), //A value of 512MB begins to shake driver bugs.
         mTextureGpuManagerListener( &sDefaultTextureGpuManagerListener ),
     #if OGRE_PLATFORM != OGRE_PLATFORM_APPLE_IOS && \
@@ -155,6 +176,12 @@ namespace Ogre
         for( int i=0; i<2; ++i )
             mThreadData[i].objCmdBuffer = new ObjCmdBuffer();
 
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        mAsyncArchiveReader = OGRE_NEW AsyncArchiveReader( 4u );
+#else
+        mAsyncArchiveReader = OGRE_NEW AsyncArchiveReader( 0u );
+#endif
+
 #if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN && !OGRE_FORCE_TEXTURE_STREAMING_ON_MAIN_THREAD
         mWorkerThread = Threads::CreateThread( THREAD_GET( updateStreamingWorkerThread ), 0, this );
 #endif
@@ -175,6 +202,9 @@ namespace Ogre
             mThreadData[i].objCmdBuffer = 0;
         }
 
+        OGRE_DELETE mAsyncArchiveReader;
+        mAsyncArchiveReader = 0;
+
         mTextureGpuManagerListener = 0;
     }
     //-----------------------------------------------------------------------------------
@@ -186,6 +216,9 @@ namespace Ogre
 #if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN && !OGRE_FORCE_TEXTURE_STREAMING_ON_MAIN_THREAD
             mWorkerWaitableEvent.wake();
             Threads::WaitForThreads( 1u, &mWorkerThread );
+#endif
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+            stopDecoderThreads();
 #endif
         }
     }
@@ -206,6 +239,17 @@ namespace Ogre
         ThreadData &workerData = mThreadData[c_workerThread];
         ThreadData &mainData = mThreadData[c_mainThread];
         mLoadRequestsMutex.lock();
+        {
+            //workerData may own images created by preDecodeLoadRequests
+            LoadRequestVec::const_iterator itor = workerData.loadRequests.begin();
+            LoadRequestVec::const_iterator end  = workerData.loadRequests.end();
+            while( itor != end )
+            {
+                if( itor->autoDeleteImage )
+                    delete itor->image;
+                ++itor;
+            }
+        }
         mainData.loadRequests.clear();  // TODO: if( loadRequest.autoDeleteImage ) delete loadRequest.image;
         mainData.objCmdBuffer->clear();
         mainData.usedStagingTex.clear();
@@ -1931,6 +1975,7 @@ namespace Ogre
                                                        TextureTypes::Type2DArray );
             const uint16 numSlices = mTextureGpuManagerListener->getNumSlicesFor( texture, this );
             newPool.masterTexture->_setSourceType( TextureSourceType::PoolOwner );
+            newPool.masterTexture->_setMemoryTag( texture->getMemoryTag() );
 
             newPool.manuallyReserved = false;
             newPool.usedMemory = 0;
@@ -1968,6 +2013,12 @@ namespace Ogre
         //const_cast? Yes. We own it. We could do a linear search to mTexturePool;
         //but it's O(N) vs O(1); and O(N) can quickly turn into O(N!).
         TexturePool *texturePool = const_cast<TexturePool*>( texture->getTexturePool() );
+        releaseSlot( texturePool, texture );
+        texture->_notifyTextureSlotChanged( 0, 0 );
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::releaseSlot( TexturePool *texturePool, TextureGpu *texture )
+    {
         TextureGpuVec::iterator itor = std::find( texturePool->usedSlots.begin(),
                                                   texturePool->usedSlots.end(), texture );
         assert( itor != texturePool->usedSlots.end() );
@@ -1989,8 +2040,311 @@ namespace Ogre
                 ++itPool;
             mTexturePool.erase( itPool );
         }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::migrateToPool( TextureGpu *texture, TexturePool &dstPool )
+    {
+        TexturePool *srcPool = const_cast<TexturePool*>( texture->getTexturePool() );
 
-        texture->_notifyTextureSlotChanged( 0, 0 );
+        OGRE_ASSERT_LOW( srcPool != &dstPool && dstPool.hasFreeSlot() );
+
+        uint16 dstSlice = 0;
+        if( !dstPool.availableSlots.empty() )
+        {
+            dstSlice = dstPool.availableSlots.back();
+            dstPool.availableSlots.pop_back();
+        }
+        else
+        {
+            dstSlice = dstPool.usedMemory++;
+        }
+
+        TextureGpu *srcMaster = srcPool->masterTexture;
+        const uint16 srcSlice = texture->getInternalSliceStart();
+        const uint8 numMipmaps = srcMaster->getNumMipmaps();
+        for( uint8 mip=0; mip<numMipmaps; ++mip )
+        {
+            TextureBox srcBox = srcMaster->getEmptyBox( mip );
+            srcBox.sliceStart = srcSlice;
+            srcBox.numSlices = 1u;
+            TextureBox dstBox = srcBox;
+            dstBox.sliceStart = dstSlice;
+            srcMaster->copyTo( dstPool.masterTexture, dstBox, mip, srcBox, mip );
+        }
+
+        //May destroy srcPool (and srcMaster). Copies already issued are not affected
+        releaseSlot( srcPool, texture );
+
+        dstPool.usedSlots.push_back( texture );
+        texture->_notifyTextureSlotChanged( &dstPool, dstSlice );
+        //The contents are already there
+        texture->notifyDataIsReady();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TextureGpuManager::getNumTexturePoolsFor( const TextureGpu *texture ) const
+    {
+        size_t numPools = 0;
+
+        TexturePoolList::const_iterator itor = mTexturePool.begin();
+        TexturePoolList::const_iterator end  = mTexturePool.end();
+
+        while( itor != end )
+        {
+            const TextureGpu *master = itor->masterTexture;
+            if( master->getWidth() == texture->getWidth() &&
+                master->getHeight() == texture->getHeight() &&
+                master->getPixelFormat() == texture->getPixelFormat() &&
+                master->getNumMipmaps() == texture->getNumMipmaps() &&
+                master->getTexturePoolId() == texture->getTexturePoolId() )
+            {
+                ++numPools;
+            }
+            ++itor;
+        }
+
+        return numPools;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::getTexturePoolStats( TexturePoolStats &outStats ) const
+    {
+        memset( &outStats, 0, sizeof( outStats ) );
+
+        TexturePoolList::const_iterator itor = mTexturePool.begin();
+        TexturePoolList::const_iterator end  = mTexturePool.end();
+
+        while( itor != end )
+        {
+            const TexturePool &pool = *itor;
+            ++outStats.numPools;
+            outStats.numSlices += pool.masterTexture->getNumSlices();
+            outStats.usedSlices += static_cast<uint32>( pool.usedSlots.size() );
+            outStats.totalBytes += pool.masterTexture->getSizeBytes();
+            outStats.wastedBytes += pool.getWastedBytes();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::_collectMemoryTagStats( GpuMemoryTagStatsVec &outStats ) const
+    {
+        {
+            ResourceEntryMap::const_iterator itor = mEntries.begin();
+            ResourceEntryMap::const_iterator end  = mEntries.end();
+
+            while( itor != end )
+            {
+                const TextureGpu *texture = itor->second.texture;
+                assert( texture->getMemoryTag() < outStats.size() );
+                GpuMemoryTagStats &stats = outStats[texture->getMemoryTag()];
+                if( texture->getResidencyStatus() == GpuResidency::Resident )
+                    stats.textureBytes += texture->getSizeBytes();
+                ++stats.numTextures;
+                ++itor;
+            }
+        }
+
+        {
+            TexturePoolList::const_iterator itor = mTexturePool.begin();
+            TexturePoolList::const_iterator end  = mTexturePool.end();
+
+            while( itor != end )
+            {
+                const TexturePool &pool = *itor;
+                assert( pool.masterTexture->getMemoryTag() < outStats.size() );
+                GpuMemoryTagStats &stats = outStats[pool.masterTexture->getMemoryTag()];
+                const size_t wastedBytes = pool.getWastedBytes();
+                stats.textureBytes += wastedBytes;
+                stats.wastedBytes += wastedBytes;
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::_getTexturesWithMemoryTag( uint8 tag, TextureGpuVec &outTextures ) const
+    {
+        ResourceEntryMap::const_iterator itor = mEntries.begin();
+        ResourceEntryMap::const_iterator end  = mEntries.end();
+
+        while( itor != end )
+        {
+            if( itor->second.texture->getMemoryTag() == tag )
+                outTextures.push_back( itor->second.texture );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    static bool canMoveTextureSlot( TextureGpu *texture )
+    {
+        return texture->getResidencyStatus() == GpuResidency::Resident &&
+               texture->getNextResidencyStatus() == GpuResidency::Resident &&
+               texture->getPendingResidencyChanges() == 0u &&
+               texture->isDataReady();
+    }
+    //-----------------------------------------------------------------------------------
+    bool TextureGpuManager::defragmentTexturePools( uint32 maxSlicesToMove )
+    {
+        OgreProfileExhaustive( "TextureGpuManager::defragmentTexturePools" );
+
+        bool workLeft = false;
+        bool renderPassEnded = false;
+
+        TexturePoolList::iterator itor = mTexturePool.begin();
+        TexturePoolList::iterator end  = mTexturePool.end();
+
+        while( itor != end && maxSlicesToMove )
+        {
+            TexturePool *srcPool = &(*itor);
+            //Advance now. srcPool gets erased from the list once it's been drained
+            ++itor;
+
+            if( srcPool->manuallyReserved || srcPool->usedSlots.empty() )
+                continue;
+
+            const TextureGpu *srcMaster = srcPool->masterTexture;
+            const size_t numUsed = srcPool->usedSlots.size();
+
+            //Only drain into pools that are more occupied than us (ties are broken by
+            //list order) so two half-empty pools don't keep trading textures
+            FastArray<TexturePool*> dstPools;
+            size_t freeSlicesElsewhere = 0;
+            bool isBeforeSrc = true;
+
+            TexturePoolList::iterator itDst = mTexturePool.begin();
+            while( itDst != end )
+            {
+                TexturePool *dstPool = &(*itDst);
+                ++itDst;
+
+                if( dstPool == srcPool )
+                {
+                    isBeforeSrc = false;
+                    continue;
+                }
+
+                const TextureGpu *dstMaster = dstPool->masterTexture;
+                if( dstMaster->getWidth() == srcMaster->getWidth() &&
+                    dstMaster->getHeight() == srcMaster->getHeight() &&
+                    dstMaster->getPixelFormat() == srcMaster->getPixelFormat() &&
+                    dstMaster->getNumMipmaps() == srcMaster->getNumMipmaps() &&
+                    dstMaster->getTexturePoolId() == srcMaster->getTexturePoolId() &&
+                    dstPool->hasFreeSlot() &&
+                    ( dstPool->usedSlots.size() > numUsed ||
+                      ( dstPool->usedSlots.size() == numUsed && isBeforeSrc ) ) )
+                {
+                    dstPools.push_back( dstPool );
+                    freeSlicesElsewhere += dstPool->getNumFreeSlots();
+                }
+            }
+
+            //Moving only some of the textures wouldn't free any memory
+            if( freeSlicesElsewhere < numUsed )
+                continue;
+
+            if( !renderPassEnded )
+            {
+                mRenderSystem->endRenderPassDescriptor();
+                renderPassEnded = true;
+            }
+
+            bool srcPoolDestroyed = false;
+            while( !srcPoolDestroyed && maxSlicesToMove )
+            {
+                TextureGpu *texture = srcPool->usedSlots.back();
+                if( !canMoveTextureSlot( texture ) )
+                {
+                    workLeft = true;
+                    break;
+                }
+
+                //Fill the most occupied pools first
+                FastArray<TexturePool*>::const_iterator itCandidate = dstPools.begin();
+                FastArray<TexturePool*>::const_iterator enCandidate = dstPools.end();
+                TexturePool *dstPool = 0;
+                while( itCandidate != enCandidate )
+                {
+                    if( (*itCandidate)->hasFreeSlot() &&
+                        ( !dstPool || (*itCandidate)->usedSlots.size() > dstPool->usedSlots.size() ) )
+                    {
+                        dstPool = *itCandidate;
+                    }
+                    ++itCandidate;
+                }
+
+                OGRE_ASSERT_LOW( dstPool );
+
+                srcPoolDestroyed = srcPool->usedSlots.size() == 1u && !srcPool->manuallyReserved;
+                migrateToPool( texture, *dstPool );
+                --maxSlicesToMove;
+            }
+
+            if( !srcPoolDestroyed )
+                workLeft = true;
+        }
+
+        if( itor != end )
+            workLeft = true;
+
+        return workLeft;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* TextureGpuManager::resizeReservedPool( TextureGpu *masterTexture, uint32 numSlices )
+    {
+        TexturePoolList::iterator itor = mTexturePool.begin();
+        TexturePoolList::iterator end  = mTexturePool.end();
+
+        while( itor != end && itor->masterTexture != masterTexture )
+            ++itor;
+
+        if( itor == end || !itor->manuallyReserved )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Texture '" + masterTexture->getNameStr() +
+                         "' is not the owner of a pool created via reservePoolId",
+                         "TextureGpuManager::resizeReservedPool" );
+        }
+
+        if( numSlices < itor->usedSlots.size() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "numSlices can't be lower than the number of slices in use",
+                         "TextureGpuManager::resizeReservedPool" );
+        }
+
+        TextureGpuVec textures( itor->usedSlots );
+
+        bool allMovable = true;
+        TextureGpuVec::const_iterator itTex = textures.begin();
+        TextureGpuVec::const_iterator enTex = textures.end();
+        while( itTex != enTex && allMovable )
+            allMovable = canMoveTextureSlot( *itTex++ );
+
+        //We can't move textures whose contents are still on their way to the old pool
+        if( !allMovable )
+            waitForStreamingCompletion();
+
+        TextureGpu *newMaster = reservePoolId( masterTexture->getTexturePoolId(),
+                                               masterTexture->getWidth(),
+                                               masterTexture->getHeight(),
+                                               numSlices, masterTexture->getNumMipmaps(),
+                                               masterTexture->getPixelFormat() );
+        TexturePool &dstPool = mTexturePool.back();
+
+        if( !textures.empty() )
+        {
+            mRenderSystem->endRenderPassDescriptor();
+
+            itTex = textures.begin();
+            while( itTex != enTex )
+                migrateToPool( *itTex++, dstPool );
+        }
+
+        destroyTexture( masterTexture );
+
+        return newMaster;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setTexturePoolDefragmentation( uint32 maxSlicesPerFrame )
+    {
+        mPoolDefragSlicesPerFrame = maxSlicesPerFrame;
     }
     //-----------------------------------------------------------------------------------
     void TextureGpuManager::fulfillUsageStats(void)
@@ -2461,6 +2815,7 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     unsigned long updateStreamingWorkerThread( ThreadHandle *threadHandle )
     {
+        Threads::ApplyThreadClass( ThreadClass::Streaming );
         TextureGpuManager *textureManager =
                 reinterpret_cast<TextureGpuManager*>( threadHandle->getUserParam() );
         return textureManager->_updateStreamingWorkerThread( threadHandle );
@@ -2468,15 +2823,481 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     unsigned long TextureGpuManager::_updateStreamingWorkerThread( ThreadHandle *threadHandle )
     {
+        OgreProfileThreadName( "TextureGpuManager Streaming" );
+
         while( !mShuttingDown )
         {
             mWorkerWaitableEvent.wait();
+            OgreProfileWorker( "TextureGpuManager::_updateStreaming" );
             _updateStreaming();
         }
 
         return 0;
     }
     //-----------------------------------------------------------------------------------
+    unsigned long updateDecoderThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::Streaming );
+        TextureGpuManager *textureManager =
+                reinterpret_cast<TextureGpuManager*>( threadHandle->getUserParam() );
+        return textureManager->_updateDecoderThread( threadHandle );
+    }
+    //-----------------------------------------------------------------------------------
+    unsigned long TextureGpuManager::_updateDecoderThread( ThreadHandle *threadHandle )
+    {
+        const size_t threadIdx = threadHandle->getThreadIdx();
+
+#if OGRE_PROFILING
+        char threadName[64];
+        snprintf( threadName, sizeof( threadName ), "TextureGpuManager Decoder %u",
+                  static_cast<unsigned>( threadIdx ) );
+        OgreProfileThreadName( threadName );
+#endif
+
+        bool exitThread = false;
+        while( !exitThread )
+        {
+            mDecoderThreadsBarrier->sync();
+            exitThread = mStopDecoderThreads;
+            if( !exitThread )
+            {
+                OgreProfileWorker( "TextureGpuManager::decodeImages" );
+                decodeImages( threadIdx );
+            }
+            mDecoderThreadsBarrier->sync();
+        }
+
+        return 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::startDecoderThreads( uint32 numThreads )
+    {
+        OGRE_ASSERT_LOW( mDecoderThreads.empty() );
+
+        if( !numThreads )
+            return;
+
+        mStopDecoderThreads = false;
+        mDecoderThreadsBarrier = new Barrier( numThreads + 1u );
+        mDecoderThreads.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+        {
+            ThreadHandlePtr th = Threads::CreateThread( THREAD_GET( updateDecoderThread ),
+                                                        i + 1u, this );
+            mDecoderThreads.push_back( th );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::stopDecoderThreads(void)
+    {
+        if( mDecoderThreads.empty() )
+            return;
+
+        mStopDecoderThreads = true;
+        mDecoderThreadsBarrier->sync(); //Fire threads
+        mDecoderThreadsBarrier->sync(); //Wait them to complete
+
+        Threads::WaitForThreads( mDecoderThreads );
+        mDecoderThreads.clear();
+
+        delete mDecoderThreadsBarrier;
+        mDecoderThreadsBarrier = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setNumDecoderThreads( uint32 numThreads )
+    {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( numThreads == mDecoderThreads.size() || mShuttingDown )
+            return;
+
+        //Holding mMutex guarantees the worker thread isn't using the decoder threads
+        mMutex.lock();
+        stopDecoderThreads();
+        startDecoderThreads( numThreads );
+        mMutex.unlock();
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TextureGpuManager::getNumDecoderThreads(void) const
+    {
+        return static_cast<uint32>( mDecoderThreads.size() );
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setNumIoThreads( uint32 numThreads )
+    {
+#if OGRE_PLATFORM != OGRE_PLATFORM_EMSCRIPTEN
+        if( mShuttingDown )
+            return;
+
+        //Holding mMutex guarantees the worker thread isn't reading
+        mMutex.lock();
+        mAsyncArchiveReader->setNumThreads( numThreads );
+        mMutex.unlock();
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 TextureGpuManager::getNumIoThreads(void) const
+    {
+        return mAsyncArchiveReader ? mAsyncArchiveReader->getNumThreads() : 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setMipStreaming( bool enabled, size_t budgetBytes,
+                                             uint32 evaluationInterval, uint8 maxNumMipmapsToSkip )
+    {
+        mMipStreaming           = enabled;
+        mMipStreamingBudget     = budgetBytes;
+        mMipStreamingInterval   = std::max( evaluationInterval, 1u );
+        mMipStreamingMaxSkip    = maxNumMipmapsToSkip;
+        mMipStreamingFrameCount = 0u;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::_notifyFrameEnded(void)
+    {
+        updateMipStreaming();
+        updateResidencyBudget();
+        if( mPoolDefragSlicesPerFrame )
+            defragmentTexturePools( mPoolDefragSlicesPerFrame );
+        ++mFrameCount;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::updateMipStreaming(void)
+    {
+        if( !mMipStreaming || ++mMipStreamingFrameCount < mMipStreamingInterval )
+            return;
+
+        OgreProfileExhaustive( "TextureGpuManager::updateMipStreaming" );
+
+        mMipStreamingFrameCount = 0u;
+
+        struct Candidate
+        {
+            TextureGpu  *texture;
+            /// Size in bytes without skipping mips
+            size_t      fullSizeBytes;
+            uint8       numMipmapsToSkip;
+        };
+        FastArray<Candidate> candidates;
+
+        size_t totalSizeBytes = 0u;
+
+        mEntriesMutex.lock();
+        ResourceEntryMap::const_iterator itor = mEntries.begin();
+        ResourceEntryMap::const_iterator end  = mEntries.end();
+
+        while( itor != end )
+        {
+            TextureGpu *texture = itor->second.texture;
+
+            const uint32 requiredResolution = texture->_getRequiredResolution();
+            texture->_resetRequiredResolution();
+
+            if( requiredResolution && !itor->second.destroyRequested &&
+                !texture->isManualTexture() && !texture->isRenderToTexture() &&
+                !texture->isUav() && texture->getTextureType() == TextureTypes::Type2D &&
+                texture->getResidencyStatus() == GpuResidency::Resident &&
+                texture->isDataReady() )
+            {
+                const uint8 currentSkip = texture->getNumMipmapsToSkip();
+                const uint32 fullResolution =
+                        std::max( texture->getWidth(), texture->getHeight() ) << currentSkip;
+
+                uint8 numMipmapsToSkip = 0u;
+                while( numMipmapsToSkip < mMipStreamingMaxSkip &&
+                       (fullResolution >> (numMipmapsToSkip + 1u)) >= requiredResolution )
+                {
+                    ++numMipmapsToSkip;
+                }
+
+                Candidate candidate;
+                candidate.texture           = texture;
+                candidate.fullSizeBytes     = texture->getSizeBytes() << (currentSkip * 2u);
+                candidate.numMipmapsToSkip  = numMipmapsToSkip;
+                candidates.push_back( candidate );
+
+                totalSizeBytes += candidate.fullSizeBytes >> (numMipmapsToSkip * 2u);
+            }
+
+            ++itor;
+        }
+        mEntriesMutex.unlock();
+
+        //Over budget? Make everyone drop more mips
+        uint8 extraSkip = 0u;
+        while( mMipStreamingBudget && totalSizeBytes > mMipStreamingBudget &&
+               extraSkip < mMipStreamingMaxSkip )
+        {
+            ++extraSkip;
+            totalSizeBytes = 0u;
+            FastArray<Candidate>::const_iterator itCand = candidates.begin();
+            FastArray<Candidate>::const_iterator enCand = candidates.end();
+            while( itCand != enCand )
+            {
+                const uint8 numMipmapsToSkip =
+                        std::min<uint8>( itCand->numMipmapsToSkip + extraSkip, mMipStreamingMaxSkip );
+                totalSizeBytes += itCand->fullSizeBytes >> (numMipmapsToSkip * 2u);
+                ++itCand;
+            }
+        }
+
+        FastArray<Candidate>::const_iterator itCand = candidates.begin();
+        FastArray<Candidate>::const_iterator enCand = candidates.end();
+
+        while( itCand != enCand )
+        {
+            const uint8 numMipmapsToSkip =
+                    std::min<uint8>( itCand->numMipmapsToSkip + extraSkip, mMipStreamingMaxSkip );
+            TextureGpu *texture = itCand->texture;
+            if( texture->getNumMipmapsToSkip() != numMipmapsToSkip )
+            {
+                //The cached metadata is for the old resolution
+                _removeMetadataCacheEntry( texture );
+                texture->setNumMipmapsToSkip( numMipmapsToSkip );
+                texture->scheduleTransitionTo( GpuResidency::OnStorage );
+                texture->scheduleTransitionTo( GpuResidency::Resident );
+            }
+            ++itCand;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::setResidencyBudget( size_t budgetBytes, uint32 minUnusedFrames,
+                                                GpuResidency::GpuResidency evictTo )
+    {
+        OGRE_ASSERT_LOW( evictTo != GpuResidency::Resident );
+        mResidencyBudget            = budgetBytes;
+        mResidencyMinUnusedFrames   = minUnusedFrames;
+        mResidencyEvictTo           = evictTo;
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::updateResidencyBudget(void)
+    {
+        if( !mResidencyBudget )
+            return;
+
+        OgreProfileExhaustive( "TextureGpuManager::updateResidencyBudget" );
+
+        struct Candidate
+        {
+            TextureGpu  *texture;
+            uint32      lastUsedFrame;
+            bool operator < ( const Candidate &other ) const
+            {
+                return this->lastUsedFrame < other.lastUsedFrame;
+            }
+        };
+        FastArray<Candidate> candidates;
+        TextureGpuVec texturesToRestore;
+
+        size_t totalSizeBytes = 0u;
+
+        mEntriesMutex.lock();
+        ResourceEntryMap::const_iterator itor = mEntries.begin();
+        ResourceEntryMap::const_iterator end  = mEntries.end();
+
+        while( itor != end )
+        {
+            TextureGpu *texture = itor->second.texture;
+
+            if( texture->_isEvictedByBudget() )
+            {
+                //Rendered again since we evicted it. Bring it back
+                if( texture->getLastUsedFrame() == mFrameCount )
+                    texturesToRestore.push_back( texture );
+            }
+            else if( texture->getResidencyStatus() == GpuResidency::Resident )
+            {
+                totalSizeBytes += texture->getSizeBytes();
+
+                if( texture->getLastUsedFrame() && !itor->second.destroyRequested &&
+                    !texture->isManualTexture() && texture->isDataReady() &&
+                    mFrameCount - texture->getLastUsedFrame() > mResidencyMinUnusedFrames )
+                {
+                    Candidate candidate;
+                    candidate.texture       = texture;
+                    candidate.lastUsedFrame = texture->getLastUsedFrame();
+                    candidates.push_back( candidate );
+                }
+            }
+
+            ++itor;
+        }
+        mEntriesMutex.unlock();
+
+        TextureGpuVec::const_iterator itRestore = texturesToRestore.begin();
+        TextureGpuVec::const_iterator enRestore = texturesToRestore.end();
+
+        while( itRestore != enRestore )
+        {
+            TextureGpu *texture = *itRestore;
+            texture->_setEvictedByBudget( false );
+            texture->scheduleTransitionTo( GpuResidency::Resident );
+            totalSizeBytes += texture->getSizeBytes();
+            ++itRestore;
+        }
+
+        if( totalSizeBytes <= mResidencyBudget )
+            return;
+
+        //Least recently used first
+        std::sort( candidates.begin(), candidates.end() );
+
+        FastArray<Candidate>::const_iterator itCand = candidates.begin();
+        FastArray<Candidate>::const_iterator enCand = candidates.end();
+
+        while( itCand != enCand && totalSizeBytes > mResidencyBudget )
+        {
+            TextureGpu *texture = itCand->texture;
+            if( mTextureGpuManagerListener->canEvict( texture, this ) )
+            {
+                totalSizeBytes -= texture->getSizeBytes();
+                texture->_setEvictedByBudget( true );
+                texture->scheduleTransitionTo( mResidencyEvictTo );
+            }
+            ++itCand;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::decodeImages( size_t threadIdx )
+    {
+        const size_t numThreads = mDecoderThreads.size() + 1u;
+        const size_t numJobs = mDecodeJobs.size();
+
+        for( size_t i=threadIdx; i<numJobs; i += numThreads )
+        {
+            DecodeJob &job = mDecodeJobs[i];
+            job.image = new Image2();
+            LoadProfiler::Scope loadScope( LoadEvent::TextureDecode, job.data->getName() );
+            loadScope.setBytes( job.data->size() );
+            try
+            {
+                job.image->load( job.data );
+                job.data.setNull();
+                //Mipmap generation is often more expensive than decoding itself
+                TextureFilter::GenerateSwMipmaps::_generateAhead( job.filters, *job.image,
+                                                                  job.prefersSRgb, this );
+            }
+            catch( Exception & )
+            {
+                //processLoadRequest will try again & report it
+                delete job.image;
+                job.image = 0;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool TextureGpuManager::isGpuNativeFormat( const String &filename )
+    {
+        String baseName, ext;
+        StringUtil::splitBaseFilename( filename, baseName, ext );
+        StringUtil::toLowerCase( ext );
+        return ext == "dds" || ext == "ktx" || ext == "pvr" || ext == "astc" || ext == "oitd";
+    }
+    //-----------------------------------------------------------------------------------
+    void TextureGpuManager::preDecodeLoadRequests( LoadRequestVec &loadRequests, size_t numRequests )
+    {
+        OgreProfileExhaustive( "TextureGpuManager::preDecodeLoadRequests" );
+
+        mDecodeJobs.clear();
+
+        AsyncArchiveReader::ReadRequestVec readRequests;
+        vector<size_t>::type readRequestIdx;
+
+        for( size_t i=0; i<numRequests; ++i )
+        {
+            const LoadRequest &loadRequest = loadRequests[i];
+
+            //Leave anything out of the ordinary to processLoadRequest
+            if( loadRequest.image || (!loadRequest.archive && !loadRequest.loadingListener) ||
+                mStreamingData.rescheduledTextures.find( loadRequest.texture ) !=
+                mStreamingData.rescheduledTextures.end() ||
+                isGpuNativeFormat( loadRequest.name ) )
+            {
+                continue;
+            }
+
+            if( loadRequest.archive && !loadRequest.loadingListener )
+            {
+                //Read below, all at once
+                readRequests.push_back( AsyncArchiveReader::ReadRequest( loadRequest.archive,
+                                                                           loadRequest.name ) );
+                readRequestIdx.push_back( i );
+                continue;
+            }
+
+            DataStreamPtr data;
+            if( !loadRequest.archive )
+                data = loadRequest.loadingListener->grouplessResourceLoading( loadRequest.name );
+            else
+            {
+                data = loadRequest.archive->open( loadRequest.name );
+                if( loadRequest.loadingListener )
+                {
+                    loadRequest.loadingListener->grouplessResourceOpened( loadRequest.name,
+                                                                          loadRequest.archive,
+                                                                          data );
+                }
+            }
+
+            if( data )
+            {
+                DecodeJob job;
+                job.loadRequestIdx = i;
+                //Read it all now. The decoders must not touch the Archive
+                LoadProfiler::Scope loadScope( LoadEvent::ArchiveRead, loadRequest.name );
+                job.data = DataStreamPtr( OGRE_NEW MemoryDataStream( data ) );
+                loadScope.setBytes( job.data->size() );
+                job.image = 0;
+                job.filters = loadRequest.filters;
+                job.prefersSRgb = loadRequest.texture->prefersLoadingFromFileAsSRGB();
+                mDecodeJobs.push_back( job );
+            }
+        }
+
+        mAsyncArchiveReader->readBatch( readRequests );
+
+        for( size_t i=0; i<readRequests.size(); ++i )
+        {
+            //Failed reads are left to processLoadRequest, which reports the error
+            if( readRequests[i].data )
+            {
+                const LoadRequest &loadRequest = loadRequests[readRequestIdx[i]];
+                DecodeJob job;
+                job.loadRequestIdx = readRequestIdx[i];
+                job.data = readRequests[i].data;
+                job.image = 0;
+                job.filters = loadRequest.filters;
+                job.prefersSRgb = loadRequest.texture->prefersLoadingFromFileAsSRGB();
+                mDecodeJobs.push_back( job );
+            }
+        }
+
+        if( mDecodeJobs.size() > 1u )
+        {
+            mDecoderThreadsBarrier->sync(); //Fire threads
+            decodeImages( 0 );
+            mDecoderThreadsBarrier->sync(); //Wait them to complete
+        }
+        else
+        {
+            decodeImages( 0 );
+        }
+
+        DecodeJobVec::const_iterator itor = mDecodeJobs.begin();
+        DecodeJobVec::const_iterator end  = mDecodeJobs.end();
+
+        while( itor != end )
+        {
+            if( itor->image )
+            {
+                LoadRequest &loadRequest = loadRequests[itor->loadRequestIdx];
+                loadRequest.image = itor->image;
+                loadRequest.autoDeleteImage = true;
+            }
+            ++itor;
+        }
+
+        mDecodeJobs.clear();
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::processLoadRequest( ObjCmdBuffer *commandBuffer, ThreadData &workerData,
                                                 const LoadRequest &loadRequest )
     {
@@ -2540,6 +3361,9 @@ namespace Ogre
             {
                 try
                 {
+                    LoadProfiler::Scope loadScope( LoadEvent::TextureDecode, loadRequest.name );
+                    if( data )
+                        loadScope.setBytes( data->size() );
                     img->load( data );
                 }
                 catch( Exception &e )
@@ -2558,6 +3382,14 @@ namespace Ogre
             }
         }
 
+        const uint8 numMipmapsToSkip = loadRequest.texture->getNumMipmapsToSkip();
+        if( numMipmapsToSkip && !wasRescheduled &&
+            (!loadRequest.image || loadRequest.autoDeleteImage) )
+        {
+            //Only touch images we own
+            skipMipmaps( *img, numMipmapsToSkip );
+        }
+
         if( (loadRequest.sliceOrDepth == std::numeric_limits<uint32>::max() ||
              loadRequest.sliceOrDepth == 0) &&
             loadRequest.texture->getResidencyStatus() != GpuResidency::OnStorage )
@@ -2793,6 +3625,48 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    void TextureGpuManager::skipMipmaps( Image2 &image, uint8 numMipmapsToSkip )
+    {
+        const uint8 numMipmaps = image.getNumMipmaps();
+        if( numMipmaps > numMipmapsToSkip )
+        {
+            const uint32 depthOrSlices =
+                    image.getTextureType() == TextureTypes::Type3D ?
+                        std::max( image.getDepthOrSlices() >> numMipmapsToSkip, 1u ) :
+                        image.getDepthOrSlices();
+
+            Image2 skipped;
+            skipped.createEmptyImage( std::max( image.getWidth() >> numMipmapsToSkip, 1u ),
+                                      std::max( image.getHeight() >> numMipmapsToSkip, 1u ),
+                                      depthOrSlices, image.getTextureType(),
+                                      image.getPixelFormat(),
+                                      static_cast<uint8>( numMipmaps - numMipmapsToSkip ) );
+
+            for( uint8 mip=numMipmapsToSkip; mip<numMipmaps; ++mip )
+            {
+                TextureBox dstBox = skipped.getData( mip - numMipmapsToSkip );
+                dstBox.copyFrom( image.getData( mip ) );
+            }
+
+            //Transfer ownership of the buffer to image
+            skipped._setAutoDelete( false );
+            image.loadDynamicImage( skipped.getData( 0 ).data, skipped.getWidth(),
+                                    skipped.getHeight(), skipped.getDepthOrSlices(),
+                                    skipped.getTextureType(), skipped.getPixelFormat(), true,
+                                    skipped.getNumMipmaps() );
+        }
+        else if( image.getTextureType() == TextureTypes::Type2D &&
+                 !PixelFormatGpuUtils::isCompressed( image.getPixelFormat() ) &&
+                 image.getAutoDelete() )
+        {
+            //Not enough mips (e.g. PNG). Downscale; mipmap filters will regenerate the rest
+            const uint32 width  = std::max( image.getWidth() >> numMipmapsToSkip, 1u );
+            const uint32 height = std::max( image.getHeight() >> numMipmapsToSkip, 1u );
+            if( width != image.getWidth() || height != image.getHeight() )
+                image.resize( width, height );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void TextureGpuManager::_updateStreaming(void)
     {
         OgreProfileExhaustive( "TextureGpuManager::_updateStreaming" );
@@ -2866,6 +3740,17 @@ namespace Ogre
 
         const size_t entriesToProcessPerIteration = mEntriesToProcessPerIteration;
         size_t entriesProcessed = 0;
+
+        if( !mDecoderThreads.empty() && mStreamingData.bytesPreloaded < mMaxPreloadBytes )
+        {
+            //Decode enough to keep all decoder threads busy. Whatever we don't get to process
+            //this iteration stays decoded in workerData.loadRequests for the next ones.
+            const size_t numToDecode = std::min( workerData.loadRequests.size(),
+                                                 std::max( entriesToProcessPerIteration,
+                                                           mDecoderThreads.size() + 1u ) );
+            preDecodeLoadRequests( workerData.loadRequests, numToDecode );
+        }
+
         //Now process new requests from main thread
         LoadRequestVec::const_iterator itor = workerData.loadRequests.begin();
         LoadRequestVec::const_iterator end  = workerData.loadRequests.end();
@@ -3179,15 +4064,30 @@ namespace Ogre
         }
 
         {
+            UploadScheduler *uploadScheduler = mVaoManager->getUploadScheduler();
+            const bool reportUploads = uploadScheduler->getMaxBytesPerFrame() != 0u;
+            uint64 bytesStreamed = 0;
+
             StagingTextureVec::const_iterator itor = mainData.usedStagingTex.begin();
             StagingTextureVec::const_iterator end  = mainData.usedStagingTex.end();
 
             while( itor != end )
             {
+                //Texture streaming & buffer uploads share the same per-frame budget.
+                //This is an upper bound; we don't track how much of the staging texture was used.
+                if( reportUploads )
+                    uploadScheduler->_notifyExternalUpload( (*itor)->_getSizeBytes() );
+                bytesStreamed += (*itor)->_getSizeBytes();
                 removeStagingTexture( *itor );
                 ++itor;
             }
 
+            if( bytesStreamed )
+            {
+                Root::getSingleton().getFrameMetrics()->add( FrameMetric::TextureBytesStreamed,
+                                                             bytesStreamed );
+            }
+
             mainData.usedStagingTex.clear();
         }
 
@@ -3213,6 +4113,7 @@ namespace Ogre
     void TextureGpuManager::waitForStreamingCompletion(void)
     {
         OgreProfileExhaustive( "TextureGpuManager::waitForStreamingCompletion" );
+        LoadProfiler::Scope loadScope( LoadEvent::StreamingWait, "waitForStreamingCompletion" );
 
         bool bDone = false;
         while( !bDone )
@@ -3241,6 +4142,10 @@ namespace Ogre
     //-----------------------------------------------------------------------------------
     void TextureGpuManager::_waitFor( TextureGpu *texture, bool metadataOnly )
     {
+        LoadProfiler::Scope loadScope( LoadEvent::StreamingWait, BLANKSTRING );
+        if( loadScope.isRecording() )
+            loadScope.setName( "_waitFor " + texture->getNameStr() );
+
         bool bDone = false;
         while( !bDone )
         {
@@ -3306,6 +4211,17 @@ namespace Ogre
         return (availableSlots.size() + (numSlices - usedMemory)) == numSlices;
     }
     //-----------------------------------------------------------------------------------
+    uint16 TexturePool::getNumFreeSlots(void) const
+    {
+        return static_cast<uint16>( availableSlots.size() +
+                                    (masterTexture->getNumSlices() - usedMemory) );
+    }
+    //-----------------------------------------------------------------------------------
+    size_t TexturePool::getWastedBytes(void) const
+    {
+        return ( masterTexture->getSizeBytes() / masterTexture->getNumSlices() ) * getNumFreeSlots();
+    }
+    //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
     //-----------------------------------------------------------------------------------
     TextureGpuManager::UsageStats::UsageStats( uint32 _width, uint32 _height, uint32 _depthOrSlices,
@@ -32,12 +32,16 @@ THE SOFTWARE.
 
 #include "OgreBitwise.h"
 #include "OgreTextureGpu.h"
+#include "OgreTextureGpuManager.h"
 
 namespace Ogre
 {
     TextureGpuManagerListener::~TextureGpuManagerListener() {}
     //-----------------------------------------------------------------------------------
-    DefaultTextureGpuManagerListener::DefaultTextureGpuManagerListener() : mPackNonPow2( false )
+    DefaultTextureGpuManagerListener::DefaultTextureGpuManagerListener() :
+        mPoolGrowthFactor( 1.0f ),
+        mMaxSlicesPerPool( 64u ),
+        mPackNonPow2( false )
     {
         mMinSlicesPerPool[0] = 16;
         mMinSlicesPerPool[1] = 8;
@@ -70,6 +74,16 @@ namespace Ogre
                 minSlicesPerPool = 1u;
         }
 
+        if( mPoolGrowthFactor > 1.0f && minSlicesPerPool > 1u )
+        {
+            const size_t numPools = textureManager->getNumTexturePoolsFor( texture );
+            const float numSlices = minSlicesPerPool *
+                                    powf( mPoolGrowthFactor, static_cast<float>( numPools ) );
+            const uint16 maxSlices = std::max( mMaxSlicesPerPool, minSlicesPerPool );
+            minSlicesPerPool = static_cast<uint16>( std::min( numSlices,
+                                                              static_cast<float>( maxSlices ) ) );
+        }
+
         return minSlicesPerPool;
     }
     //-----------------------------------------------------------------------------------
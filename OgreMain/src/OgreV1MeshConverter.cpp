@@ -0,0 +1,478 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2018 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreV1MeshConverter.h"
+#include "OgreMeshManager.h"
+#include "OgreMeshManager2.h"
+#include "OgreMesh2Serializer.h"
+#include "OgreSubMesh.h"
+#include "OgreSubMesh2.h"
+#include "OgreLogManager.h"
+#include "OgreString.h"
+
+#include <fstream>
+
+namespace Ogre
+{
+    unsigned long v1MeshConverterThread( ThreadHandle *threadHandle )
+    {
+        Threads::ApplyThreadClass( ThreadClass::Background );
+        V1MeshConverter *converter = reinterpret_cast<V1MeshConverter*>(
+                                         threadHandle->getUserParam() );
+        converter->_workerThread( threadHandle->getThreadIdx() );
+        return 0;
+    }
+    THREAD_DECLARE( v1MeshConverterThread );
+
+    namespace
+    {
+        /// Locking buffers without a shadow copy talks to the API, which
+        /// can't be done outside the main thread.
+        bool hasShadowBuffers( const v1::VertexData *vertexData )
+        {
+            const v1::VertexBufferBinding::VertexBufferBindingMap &bindings =
+                    vertexData->vertexBufferBinding->getBindings();
+            v1::VertexBufferBinding::VertexBufferBindingMap::const_iterator itor = bindings.begin();
+            v1::VertexBufferBinding::VertexBufferBindingMap::const_iterator end  = bindings.end();
+
+            while( itor != end )
+            {
+                if( !itor->second->hasShadowBuffer() )
+                    return false;
+                ++itor;
+            }
+
+            return true;
+        }
+    }
+
+    //-----------------------------------------------------------------------------------
+    V1MeshConverter::V1MeshConverter( size_t numThreads, size_t maxMeshesPerBatch ) :
+        mScheduler( numThreads ),
+        mNumThreadsFinished( 0 ),
+        mBatchInFlight( false ),
+        mMaxMeshesPerBatch( std::max<size_t>( maxMeshesPerBatch, 1u ) ),
+        mListener( 0 )
+    {
+        assert( numThreads > 0 );
+        memset( &mStats, 0, sizeof( mStats ) );
+    }
+    //-----------------------------------------------------------------------------------
+    V1MeshConverter::~V1MeshConverter()
+    {
+        waitForWorkers();
+
+        JobVec::iterator itor = mJobs.begin();
+        JobVec::iterator end  = mJobs.end();
+
+        while( itor != end )
+        {
+            freeArrangedData( *itor );
+            if( itor->unloadV1 )
+                itor->v1Mesh->unload();
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    String V1MeshConverter::getCachePath( const String &v2Name ) const
+    {
+        String fileName = v2Name;
+        for( size_t i=0; i<fileName.size(); ++i )
+        {
+            if( fileName[i] == '/' || fileName[i] == '\\' || fileName[i] == ':' )
+                fileName[i] = '_';
+        }
+
+        if( !StringUtil::endsWith( fileName, ".mesh" ) )
+            fileName += ".mesh";
+
+        String folder = mCacheFolder;
+        if( !folder.empty() && folder[folder.size() - 1u] != '/' &&
+            folder[folder.size() - 1u] != '\\' )
+        {
+            folder += "/";
+        }
+
+        return folder + fileName;
+    }
+    //-----------------------------------------------------------------------------------
+    bool V1MeshConverter::loadFromCache( const Request &request )
+    {
+        const String path = getCachePath( request.v2Name );
+
+        std::ifstream *ifs = OGRE_NEW_T( std::ifstream, MEMCATEGORY_GENERAL )(
+                                 path.c_str(), std::ios::in | std::ios::binary );
+        if( ifs->fail() )
+        {
+            OGRE_DELETE_T( ifs, basic_ifstream, MEMCATEGORY_GENERAL );
+            return false;
+        }
+
+        DataStreamPtr fileStream( OGRE_NEW FileStreamDataStream( path, ifs, true ) );
+        DataStreamPtr stream( OGRE_NEW MemoryDataStream( path, fileStream ) );
+        fileStream.setNull();
+
+        MeshPtr mesh = MeshManager::getSingleton().createManual( request.v2Name, request.v2Group );
+
+        try
+        {
+            MeshSerializer serializer( mesh->_getVaoManager() );
+            serializer.importMesh( stream, mesh.get() );
+        }
+        catch( Exception &e )
+        {
+            LogManager::getSingleton().logMessage(
+                        "WARNING: V1MeshConverter could not load '" + path + "' from the cache. "
+                        "Converting it again. Reason: " + e.getDescription() );
+            MeshManager::getSingleton().remove( mesh->getHandle() );
+            return false;
+        }
+
+        mesh->setToLoaded();
+
+        ++mStats.numFromCache;
+        --mStats.numPending;
+
+        if( mListener )
+            mListener->meshConverted( this, mesh, true );
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    bool V1MeshConverter::prepareJob( Job &job )
+    {
+        const Request &request = job.request;
+
+        try
+        {
+            v1::MeshManager &v1MeshManager = v1::MeshManager::getSingleton();
+            job.v1Mesh = v1MeshManager.getByName( request.v1Name, request.v1Group );
+
+            if( job.v1Mesh.isNull() )
+            {
+                //Shadow buffers let the worker threads read the vertices
+                job.v1Mesh = v1MeshManager.load( request.v1Name, request.v1Group,
+                                                 v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY,
+                                                 v1::HardwareBuffer::HBU_STATIC_WRITE_ONLY,
+                                                 true, true );
+                job.unloadV1 = true;
+            }
+            else
+            {
+                job.unloadV1 = job.v1Mesh->isReloadable() && !job.v1Mesh->isLoaded();
+            }
+
+            Mesh::_prepareV1ForImport( job.v1Mesh.get(), request.qTangents );
+        }
+        catch( Exception &e )
+        {
+            if( !job.v1Mesh.isNull() && job.unloadV1 )
+                job.v1Mesh->unload();
+            notifyFailure( request, e.getDescription() );
+            return false;
+        }
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::startBatch(void)
+    {
+        assert( !mBatchInFlight && mJobs.empty() && mTasks.empty() );
+
+        size_t numProcessed = 0;
+        while( !mPendingRequests.empty() && numProcessed < mMaxMeshesPerBatch )
+        {
+            const Request request = mPendingRequests.front();
+            mPendingRequests.pop_front();
+            ++numProcessed;
+
+            if( !mCacheFolder.empty() && loadFromCache( request ) )
+                continue;
+
+            mJobs.push_back( Job() );
+            Job &job = mJobs.back();
+            job.request = request;
+            job.unloadV1 = false;
+
+            if( !prepareJob( job ) )
+            {
+                mJobs.pop_back();
+                continue;
+            }
+
+            const size_t jobIdx = mJobs.size() - 1u;
+            const size_t numSubMeshes = job.v1Mesh->getNumSubMeshes();
+            job.arranged.resize( numSubMeshes * NumVertexPass );
+
+            for( size_t i=0; i<numSubMeshes; ++i )
+            {
+                const v1::SubMesh *subMesh = job.v1Mesh->getSubMesh( i );
+
+                //Same condition SubMesh::importFromV1 uses to import the shadow pass
+                const size_t numPasses =
+                        ( subMesh->vertexData[VpNormal] != subMesh->vertexData[VpShadow] ||
+                          subMesh->indexData[VpNormal] != subMesh->indexData[VpShadow] ) ? 2u : 1u;
+
+                for( size_t passIdx=0; passIdx<numPasses; ++passIdx )
+                {
+                    //Otherwise importFromV1 will arrange it from the main thread
+                    if( hasShadowBuffers( subMesh->vertexData[passIdx] ) )
+                    {
+                        ArrangeTask task;
+                        task.jobIdx     = jobIdx;
+                        task.subMeshIdx = i;
+                        task.vaoPassIdx = passIdx;
+                        mTasks.push_back( task );
+                    }
+                }
+            }
+        }
+
+        if( mJobs.empty() )
+            return;
+
+        mBatchInFlight = true;
+        mNumThreadsFinished = 0;
+
+        if( mTasks.empty() )
+            return;
+
+        mScheduler.reset( mTasks.size() );
+
+        const size_t numThreads = mScheduler.getNumThreads();
+#if OGRE_PLATFORM == OGRE_PLATFORM_EMSCRIPTEN
+        for( size_t i=0; i<numThreads; ++i )
+            _workerThread( i );
+#else
+        mThreads.reserve( numThreads );
+        for( size_t i=0; i<numThreads; ++i )
+            mThreads.push_back( Threads::CreateThread( THREAD_GET( v1MeshConverterThread ), i, this ) );
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::waitForWorkers(void)
+    {
+        if( !mThreads.empty() )
+        {
+            Threads::WaitForThreads( mThreads );
+            mThreads.clear();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::finishBatch(void)
+    {
+        waitForWorkers();
+
+        //Tasks were pushed in job order
+        size_t taskIdx = 0;
+        for( size_t i=0; i<mJobs.size(); ++i )
+        {
+            const size_t firstTask = taskIdx;
+            while( taskIdx < mTasks.size() && mTasks[taskIdx].jobIdx == i )
+                ++taskIdx;
+            finishJob( mJobs[i], firstTask, taskIdx );
+        }
+
+        mJobs.clear();
+        mTasks.clear();
+        mBatchInFlight = false;
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::finishJob( Job &job, size_t firstTask, size_t lastTask )
+    {
+        const Request &request = job.request;
+
+        String error;
+        for( size_t i=firstTask; i<lastTask && error.empty(); ++i )
+            error = mTasks[i].error;
+
+        MeshPtr mesh;
+
+        if( error.empty() )
+        {
+            MeshManager &meshManager = MeshManager::getSingleton();
+
+            try
+            {
+                mesh = meshManager.createManual( request.v2Name, request.v2Group );
+                mesh->importV1( job.v1Mesh.get(), request.halfPos, request.halfTexCoords,
+                                request.qTangents, request.halfPose,
+                                job.arranged.empty() ? 0 : &job.arranged[0] );
+            }
+            catch( Exception &e )
+            {
+                if( !mesh.isNull() )
+                {
+                    meshManager.remove( mesh->getHandle() );
+                    mesh.setNull();
+                }
+                error = e.getDescription();
+            }
+        }
+
+        freeArrangedData( job );
+        if( job.unloadV1 )
+            job.v1Mesh->unload();
+        job.v1Mesh.setNull();
+
+        if( mesh.isNull() )
+        {
+            notifyFailure( request, error );
+            return;
+        }
+
+        if( !mCacheFolder.empty() )
+        {
+            const String path = getCachePath( request.v2Name );
+            try
+            {
+                MeshSerializer serializer( mesh->_getVaoManager() );
+                serializer.exportMesh( mesh.get(), path );
+            }
+            catch( Exception &e )
+            {
+                LogManager::getSingleton().logMessage(
+                            "WARNING: V1MeshConverter could not save '" + path +
+                            "' to the cache. Reason: " + e.getDescription() );
+            }
+        }
+
+        ++mStats.numConverted;
+        --mStats.numPending;
+
+        if( mListener )
+            mListener->meshConverted( this, mesh, false );
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::freeArrangedData( Job &job )
+    {
+        vector<SubMesh::ArrangedVertexData>::type::iterator itor = job.arranged.begin();
+        vector<SubMesh::ArrangedVertexData>::type::iterator end  = job.arranged.end();
+
+        while( itor != end )
+        {
+            if( itor->data )
+            {
+                OGRE_FREE_SIMD( itor->data, MEMCATEGORY_GEOMETRY );
+                itor->data = 0;
+            }
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::notifyFailure( const Request &request, const String &description )
+    {
+        LogManager::getSingleton().logMessage( "ERROR: V1MeshConverter could not convert '" +
+                                               request.v1Name + "'. Reason: " + description );
+        ++mStats.numFailed;
+        --mStats.numPending;
+
+        if( mListener )
+            mListener->meshConversionFailed( this, request.v1Name, description );
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::queue( const String &v1Name, const String &v1Group,
+                                 const String &v2Name, const String &v2Group,
+                                 bool halfPos, bool halfTexCoords, bool qTangents, bool halfPose )
+    {
+        Request request;
+        request.v1Name          = v1Name;
+        request.v1Group         = v1Group;
+        request.v2Name          = v2Name;
+        request.v2Group         = v2Group;
+        request.halfPos         = halfPos;
+        request.halfTexCoords   = halfTexCoords;
+        request.qTangents       = qTangents;
+        request.halfPose        = halfPose;
+        mPendingRequests.push_back( request );
+
+        ++mStats.numPending;
+    }
+    //-----------------------------------------------------------------------------------
+    bool V1MeshConverter::update(void)
+    {
+        if( mBatchInFlight )
+        {
+            {
+                ScopedLock lock( mMutex );
+                if( mNumThreadsFinished < mThreads.size() )
+                    return false;
+            }
+
+            finishBatch();
+        }
+
+        if( !mPendingRequests.empty() )
+            startBatch();
+
+        return !mBatchInFlight && mPendingRequests.empty();
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::waitForAll(void)
+    {
+        while( mBatchInFlight || !mPendingRequests.empty() )
+        {
+            if( mBatchInFlight )
+                finishBatch();
+            if( !mPendingRequests.empty() )
+                startBatch();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void V1MeshConverter::_workerThread( size_t threadIdx )
+    {
+        size_t taskIdx;
+        while( mScheduler.grabChunk( threadIdx, taskIdx ) )
+        {
+            ArrangeTask &task = mTasks[taskIdx];
+            Job &job = mJobs[task.jobIdx];
+            const Request &request = job.request;
+
+            SubMesh::ArrangedVertexData &arranged =
+                    job.arranged[task.subMeshIdx * NumVertexPass + task.vaoPassIdx];
+
+            try
+            {
+                arranged.data = SubMesh::_arrangeEfficient( job.v1Mesh->getSubMesh( task.subMeshIdx ),
+                                                            request.halfPos, request.halfTexCoords,
+                                                            request.qTangents,
+                                                            &arranged.vertexElements,
+                                                            task.vaoPassIdx );
+            }
+            catch( Exception &e )
+            {
+                task.error = e.getDescription();
+            }
+        }
+
+        ScopedLock lock( mMutex );
+        ++mNumThreadsFinished;
+    }
+}
@@ -0,0 +1,353 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2013 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "OgreVideoFrameCapture.h"
+
+#include "OgreHlmsManager.h"
+#include "OgreHlmsCompute.h"
+#include "OgreHlmsComputeJob.h"
+#include "OgreRenderSystem.h"
+#include "OgreTextureGpuManager.h"
+#include "OgreTextureBox.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "OgreWindow.h"
+#include "OgreStringConverter.h"
+#include "OgreId.h"
+#include "Vao/OgreVaoManager.h"
+
+namespace Ogre
+{
+    static const char *c_jobName = "VideoFrameCapture/RgbToNv12";
+
+    const uint8 VideoFrameCapture::InvalidSlot = 0xFF;
+    //-----------------------------------------------------------------------------------
+    VideoFrameCapture::VideoFrameCapture( HlmsManager *hlmsManager,
+                                          TextureGpuManager *textureManager,
+                                          uint32 width, uint32 height, uint8 numSlots ) :
+        mWidth( width ),
+        mHeight( height ),
+        mNextCaptureIdx( 0 ),
+        mDroppedFrames( 0 ),
+        mColourSpace( Bt709 ),
+        mFullRange( false ),
+        mStagingTexture( 0 ),
+        mHlmsCompute( hlmsManager->getComputeHlms() ),
+        mTextureManager( textureManager ),
+        mVaoManager( textureManager->getVaoManager() ),
+        mRenderSystem( hlmsManager->getRenderSystem() )
+    {
+        if( numSlots < 2u || numSlots == InvalidSlot )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "numSlots must be in range [2; 254]",
+                         "VideoFrameCapture::VideoFrameCapture" );
+        }
+
+        memset( mJobs, 0, sizeof( mJobs ) );
+
+        mSlots.reserve( numSlots );
+        for( uint8 i=0; i<numSlots; ++i )
+        {
+            Slot slot;
+            slot.luma       = createPlane( width, height, PFG_R8_UNORM );
+            slot.chroma     = createPlane( ( width + 1u ) >> 1u, ( height + 1u ) >> 1u,
+                                           PFG_RG8_UNORM );
+            slot.state      = SlotFree;
+            slot.frameCount = 0;
+            slot.captureIdx = 0;
+            mSlots.push_back( slot );
+        }
+
+        //TODO: The system does not support bits like Vulkan & D3D12 do.
+        //We need generic read layouts.
+        mResourceTransition.oldLayout = ResourceLayout::Undefined;
+        mResourceTransition.newLayout = ResourceLayout::Undefined;
+        //UAV writes must be visible to whoever reads the planes (encoder, copies, shaders)
+        mResourceTransition.writeBarrierBits = 0;
+        mResourceTransition.readBarrierBits = ReadBarrier::Texture | ReadBarrier::CpuRead;
+        mRenderSystem->_resourceTransitionCreated( &mResourceTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    VideoFrameCapture::~VideoFrameCapture()
+    {
+        destroyJobs();
+
+        SlotVec::const_iterator itor = mSlots.begin();
+        SlotVec::const_iterator end  = mSlots.end();
+
+        while( itor != end )
+        {
+            mTextureManager->destroyTexture( itor->luma );
+            mTextureManager->destroyTexture( itor->chroma );
+            ++itor;
+        }
+        mSlots.clear();
+
+        if( mStagingTexture )
+        {
+            mTextureManager->destroyTexture( mStagingTexture );
+            mStagingTexture = 0;
+        }
+
+        mRenderSystem->_resourceTransitionDestroyed( &mResourceTransition );
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* VideoFrameCapture::createPlane( uint32 width, uint32 height,
+                                                PixelFormatGpu pixelFormat )
+    {
+        const String newId = StringConverter::toString( Id::generateNewId<VideoFrameCapture>() );
+        TextureGpu *texture = mTextureManager->createTexture( "VideoFrameCapture Plane " + newId,
+                                                               GpuPageOutStrategy::Discard,
+                                                               TextureFlags::Uav,
+                                                               TextureTypes::Type2D );
+        texture->setResolution( width, height );
+        texture->setPixelFormat( pixelFormat );
+        texture->setNumMipmaps( 1u );
+        texture->_transitionTo( GpuResidency::Resident, (uint8*)0 );
+        texture->_setNextResidencyStatus( GpuResidency::Resident );
+        return texture;
+    }
+    //-----------------------------------------------------------------------------------
+    void VideoFrameCapture::destroyJobs(void)
+    {
+        for( size_t i=0; i<2u; ++i )
+        {
+            if( mJobs[i] )
+            {
+                mHlmsCompute->destroyComputeJob( mJobs[i]->getName() );
+                mJobs[i] = 0;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    HlmsComputeJob* VideoFrameCapture::getJob( bool srgb )
+    {
+        HlmsComputeJob *job = mJobs[srgb];
+        if( !job )
+        {
+    #if OGRE_NO_JSON
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "VideoFrameCapture requires Ogre to be built with JSON support "
+                         "and you must include the resources bundled at "
+                         "Samples/Media/2.0/scripts/materials/Common",
+                         "VideoFrameCapture::getJob" );
+    #endif
+            HlmsComputeJob *baseJob = mHlmsCompute->findComputeJobNoThrow( c_jobName );
+
+            if( !baseJob )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "To use VideoFrameCapture, you must include the resources "
+                             "bundled at Samples/Media/2.0/scripts/materials/Common\n"
+                             "Could not find " + String( c_jobName ),
+                             "VideoFrameCapture::getJob" );
+            }
+
+            const String newId = StringConverter::toString( Id::generateNewId<VideoFrameCapture>() );
+            job = baseJob->clone( String( c_jobName ) + " " + newId );
+            if( srgb )
+                job->setProperty( "srgb", 1 );
+            if( mColourSpace == Bt601 )
+                job->setProperty( "bt601", 1 );
+            if( mFullRange )
+                job->setProperty( "full_range", 1 );
+            mJobs[srgb] = job;
+        }
+
+        return job;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* VideoFrameCapture::getSampleableSource( TextureGpu *source )
+    {
+        if( source->isTexture() )
+            return source;
+
+        if( mStagingTexture && mStagingTexture->getPixelFormat() != source->getPixelFormat() )
+        {
+            mTextureManager->destroyTexture( mStagingTexture );
+            mStagingTexture = 0;
+        }
+
+        if( !mStagingTexture )
+        {
+            const String newId =
+                    StringConverter::toString( Id::generateNewId<VideoFrameCapture>() );
+            mStagingTexture = mTextureManager->createTexture( "VideoFrameCapture Staging " + newId,
+                                                              GpuPageOutStrategy::Discard,
+                                                              TextureFlags::ManualTexture,
+                                                              TextureTypes::Type2D );
+            mStagingTexture->setResolution( mWidth, mHeight );
+            mStagingTexture->setPixelFormat( source->getPixelFormat() );
+            mStagingTexture->setNumMipmaps( 1u );
+            mStagingTexture->_transitionTo( GpuResidency::Resident, (uint8*)0 );
+            mStagingTexture->_setNextResidencyStatus( GpuResidency::Resident );
+        }
+
+        //GPU to GPU; MSAA sources get resolved by copyTo
+        source->copyTo( mStagingTexture, mStagingTexture->getEmptyBox( 0 ), 0,
+                        source->getEmptyBox( 0 ), 0 );
+        return mStagingTexture;
+    }
+    //-----------------------------------------------------------------------------------
+    bool VideoFrameCapture::isSupported(void) const
+    {
+        const RenderSystemCapabilities *caps = mRenderSystem->getCapabilities();
+        return caps->hasCapability( RSC_COMPUTE_PROGRAM );
+    }
+    //-----------------------------------------------------------------------------------
+    void VideoFrameCapture::setColourSpace( ColourSpace colourSpace, bool fullRange )
+    {
+        if( mColourSpace != colourSpace || mFullRange != fullRange )
+        {
+            mColourSpace = colourSpace;
+            mFullRange = fullRange;
+            //Recreated with the new properties on the next capture
+            destroyJobs();
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint8 VideoFrameCapture::capture( TextureGpu *source )
+    {
+        if( source->getTextureType() != TextureTypes::Type2D ||
+            source->getWidth() != mWidth || source->getHeight() != mHeight )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Texture '" + source->getNameStr() + "' must be Type2D and " +
+                         StringConverter::toString( mWidth ) + "x" +
+                         StringConverter::toString( mHeight ),
+                         "VideoFrameCapture::capture" );
+        }
+
+        uint8 slotIdx = InvalidSlot;
+        for( uint8 i=0; i<(uint8)mSlots.size() && slotIdx == InvalidSlot; ++i )
+        {
+            if( mSlots[i].state == SlotFree )
+                slotIdx = i;
+        }
+
+        if( slotIdx == InvalidSlot )
+        {
+            //The encoder is falling behind. Dropping is better than stalling the GPU
+            ++mDroppedFrames;
+            return InvalidSlot;
+        }
+
+        Slot &slot = mSlots[slotIdx];
+
+        mRenderSystem->endRenderPassDescriptor();
+
+        TextureGpu *sampleable = getSampleableSource( source );
+        HlmsComputeJob *job = getJob( PixelFormatGpuUtils::isSRgb( source->getPixelFormat() ) );
+
+        DescriptorSetTexture2::TextureSlot texSlot( DescriptorSetTexture2::TextureSlot::makeEmpty() );
+        texSlot.texture = sampleable;
+        job->setTexture( 0, texSlot );
+
+        //Chroma goes in slot 0 so that thread_groups_based_on_uav gives one thread per 2x2 block
+        DescriptorSetUav::TextureSlot uavSlot( DescriptorSetUav::TextureSlot::makeEmpty() );
+        uavSlot.texture             = slot.chroma;
+        uavSlot.access              = ResourceAccess::Write;
+        uavSlot.mipmapLevel         = 0;
+        uavSlot.textureArrayIndex   = 0;
+        uavSlot.pixelFormat         = PFG_RG8_UNORM;
+        job->_setUavTexture( 0, uavSlot );
+
+        uavSlot.texture             = slot.luma;
+        uavSlot.pixelFormat         = PFG_R8_UNORM;
+        job->_setUavTexture( 1, uavSlot );
+
+        mHlmsCompute->dispatch( job, 0, 0 );
+        mRenderSystem->_executeResourceTransition( &mResourceTransition );
+
+        slot.state      = SlotCaptured;
+        slot.frameCount = mVaoManager->getFrameCount();
+        slot.captureIdx = mNextCaptureIdx++;
+
+        return slotIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    uint8 VideoFrameCapture::capture( Window *window )
+    {
+        return capture( window->getTexture() );
+    }
+    //-----------------------------------------------------------------------------------
+    uint8 VideoFrameCapture::acquireFrame( bool bWaitForGpu )
+    {
+        uint8 oldestIdx = InvalidSlot;
+        for( uint8 i=0; i<(uint8)mSlots.size(); ++i )
+        {
+            if( mSlots[i].state == SlotCaptured &&
+                ( oldestIdx == InvalidSlot ||
+                  mSlots[i].captureIdx < mSlots[oldestIdx].captureIdx ) )
+            {
+                oldestIdx = i;
+            }
+        }
+
+        if( oldestIdx == InvalidSlot )
+            return InvalidSlot;
+
+        Slot &slot = mSlots[oldestIdx];
+        if( !mVaoManager->isFrameFinished( slot.frameCount ) )
+        {
+            if( !bWaitForGpu )
+                return InvalidSlot;
+            mVaoManager->waitForSpecificFrameToFinish( slot.frameCount );
+        }
+
+        slot.state = SlotAcquired;
+        return oldestIdx;
+    }
+    //-----------------------------------------------------------------------------------
+    void VideoFrameCapture::releaseFrame( uint8 slot )
+    {
+        if( slot >= mSlots.size() || mSlots[slot].state != SlotAcquired )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Slot " + StringConverter::toString( slot ) +
+                         " was not returned by acquireFrame",
+                         "VideoFrameCapture::releaseFrame" );
+        }
+
+        mSlots[slot].state = SlotFree;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* VideoFrameCapture::getLumaTexture( uint8 slot ) const
+    {
+        assert( slot < mSlots.size() );
+        return mSlots[slot].luma;
+    }
+    //-----------------------------------------------------------------------------------
+    TextureGpu* VideoFrameCapture::getChromaTexture( uint8 slot ) const
+    {
+        assert( slot < mSlots.size() );
+        return mSlots[slot].chroma;
+    }
+}
@@ -31,6 +31,7 @@ THE SOFTWARE.
 #include "OgreLogManager.h"
 #include "OgreRoot.h"
 #include "OgreRenderSystem.h"
+#include "Threading/OgreThreads.h"
 
 #include <sstream>
 
@@ -171,6 +172,8 @@ namespace Ogre
     {
         // default worker thread
 #if OGRE_THREAD_SUPPORT
+        Threads::ApplyThreadClass( ThreadClass::Background );
+
         LogManager::getSingleton().stream() <<
             "DefaultWorkQueue('" << getName() << "')::WorkerFunc - thread " 
             << OGRE_THREAD_CURRENT_ID << " starting.";
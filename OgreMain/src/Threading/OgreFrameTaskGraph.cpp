@@ -0,0 +1,421 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Threading/OgreFrameTaskGraph.h"
+
+#include "OgreException.h"
+
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+    #include <intrin.h>
+#endif
+
+namespace Ogre
+{
+    static inline bool atomicCas( volatile uint64 *dst, uint64 oldValue, uint64 newValue )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        return _InterlockedCompareExchange64( reinterpret_cast<volatile __int64*>( dst ),
+                                              static_cast<__int64>( newValue ),
+                                              static_cast<__int64>( oldValue ) ) ==
+                static_cast<__int64>( oldValue );
+#else
+        return __sync_bool_compare_and_swap( dst, oldValue, newValue );
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    /// Returns the decremented value
+    static inline uint32 atomicDecrement( volatile uint32 *dst )
+    {
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+        return static_cast<uint32>(
+                    _InterlockedDecrement( reinterpret_cast<volatile long*>( dst ) ) );
+#else
+        return __sync_sub_and_fetch( dst, 1u );
+#endif
+    }
+    //-----------------------------------------------------------------------------------
+    FrameTask::~FrameTask()
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    FrameTaskGraph::FrameTaskGraph() :
+        mNumTasksDone( 0 ),
+        mGraphValidated( true )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    FrameTaskGraph::~FrameTaskGraph()
+    {
+        FastArray<WaitableEvent*>::const_iterator itor = mWakeUpEvents.begin();
+        FastArray<WaitableEvent*>::const_iterator end  = mWakeUpEvents.end();
+
+        while( itor != end )
+        {
+            OGRE_DELETE_T( *itor, WaitableEvent, MEMCATEGORY_GENERAL );
+            ++itor;
+        }
+
+        mWakeUpEvents.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    size_t FrameTaskGraph::findTask( FrameTask *task ) const
+    {
+        const size_t numTasks = mTasks.size();
+        for( size_t i=0; i<numTasks; ++i )
+        {
+            if( mTasks[i].task == task )
+                return i;
+        }
+
+        return numTasks;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::addTask( FrameTask *task )
+    {
+        if( findTask( task ) != mTasks.size() )
+            return;
+
+        TaskNode taskNode;
+        taskNode.task                   = task;
+        taskNode.numDependencies        = 0;
+        taskNode.pendingDependencies    = 0;
+        taskNode.passIdx                = 0;
+        taskNode.chunkState             = 0;
+        taskNode.chunksLeft             = 0;
+        mTasks.push_back( taskNode );
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::removeTask( FrameTask *task )
+    {
+        const size_t taskIdx = findTask( task );
+        if( taskIdx == mTasks.size() )
+            return;
+
+        //Those who depended on us have one dependency less now
+        FastArray<size_t>::const_iterator itDep = mTasks[taskIdx].dependents.begin();
+        FastArray<size_t>::const_iterator enDep = mTasks[taskIdx].dependents.end();
+        while( itDep != enDep )
+        {
+            --mTasks[*itDep].numDependencies;
+            ++itDep;
+        }
+
+        mTasks.erase( mTasks.begin() + taskIdx );
+
+        //Remove the dependencies pointing to us and fix the indices of those after us.
+        TaskNodeArray::iterator itor = mTasks.begin();
+        TaskNodeArray::iterator end  = mTasks.end();
+
+        while( itor != end )
+        {
+            FastArray<size_t>::iterator itDependent = itor->dependents.begin();
+            while( itDependent != itor->dependents.end() )
+            {
+                if( *itDependent == taskIdx )
+                {
+                    itDependent = itor->dependents.erase( itDependent );
+                }
+                else
+                {
+                    if( *itDependent > taskIdx )
+                        --(*itDependent);
+                    ++itDependent;
+                }
+            }
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::addDependency( FrameTask *task, FrameTask *dependsOn )
+    {
+        const size_t taskIdx        = findTask( task );
+        const size_t dependsOnIdx   = findTask( dependsOn );
+
+        if( taskIdx == mTasks.size() || dependsOnIdx == mTasks.size() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Both tasks must be added to the graph before adding a dependency",
+                         "FrameTaskGraph::addDependency" );
+        }
+
+        if( taskIdx == dependsOnIdx )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "A task can't depend on itself",
+                         "FrameTaskGraph::addDependency" );
+        }
+
+        FastArray<size_t> &dependents = mTasks[dependsOnIdx].dependents;
+        if( std::find( dependents.begin(), dependents.end(), taskIdx ) == dependents.end() )
+        {
+            dependents.push_back( taskIdx );
+            ++mTasks[taskIdx].numDependencies;
+            mGraphValidated = false;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::removeDependency( FrameTask *task, FrameTask *dependsOn )
+    {
+        const size_t taskIdx        = findTask( task );
+        const size_t dependsOnIdx   = findTask( dependsOn );
+
+        if( taskIdx == mTasks.size() || dependsOnIdx == mTasks.size() )
+            return;
+
+        FastArray<size_t> &dependents = mTasks[dependsOnIdx].dependents;
+        FastArray<size_t>::iterator itor = std::find( dependents.begin(), dependents.end(), taskIdx );
+        if( itor != dependents.end() )
+        {
+            dependents.erase( itor );
+            --mTasks[taskIdx].numDependencies;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::validateGraph(void)
+    {
+        //Kahn's algorithm. If we can't visit all nodes, there's a cycle.
+        FastArray<size_t> pending;
+        FastArray<size_t> readyToVisit;
+        pending.reserve( mTasks.size() );
+
+        const size_t numTasks = mTasks.size();
+        for( size_t i=0; i<numTasks; ++i )
+        {
+            pending.push_back( mTasks[i].numDependencies );
+            if( !mTasks[i].numDependencies )
+                readyToVisit.push_back( i );
+        }
+
+        size_t numVisited = 0;
+        while( !readyToVisit.empty() )
+        {
+            const size_t taskIdx = readyToVisit.back();
+            readyToVisit.pop_back();
+            ++numVisited;
+
+            FastArray<size_t>::const_iterator itor = mTasks[taskIdx].dependents.begin();
+            FastArray<size_t>::const_iterator end  = mTasks[taskIdx].dependents.end();
+            while( itor != end )
+            {
+                if( --pending[*itor] == 0u )
+                    readyToVisit.push_back( *itor );
+                ++itor;
+            }
+        }
+
+        if( numVisited != numTasks )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "FrameTaskGraph contains cyclic dependencies",
+                         "FrameTaskGraph::validateGraph" );
+        }
+
+        mGraphValidated = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::activateTask( size_t taskIdx )
+    {
+        TaskNode &taskNode = mTasks[taskIdx];
+
+        size_t numChunks = 0;
+        while( taskNode.task->beginPass( taskNode.passIdx, numChunks ) )
+        {
+            if( numChunks )
+            {
+                assert( numChunks <= 0xFFFFFFFFu && "A pass can't have more than 2^32-1 chunks" );
+
+                //Nobody touches these until the new state below is published. CAS is a full
+                //barrier, so whoever grabs a chunk afterwards sees passIdx & chunksLeft.
+                taskNode.chunksLeft = static_cast<uint32>( numChunks );
+                const uint64 newState = static_cast<uint64>( numChunks ) << 32u;
+                uint64 oldState;
+                do
+                {
+                    oldState = taskNode.chunkState;
+                }
+                while( !atomicCas( &taskNode.chunkState, oldState, newState ) );
+                return;
+            }
+
+            //Empty pass. Go straight to the next one.
+            ++taskNode.passIdx;
+        }
+
+        //Task is done.
+        ++mNumTasksDone;
+
+        FastArray<size_t>::const_iterator itor = taskNode.dependents.begin();
+        FastArray<size_t>::const_iterator end  = taskNode.dependents.end();
+        while( itor != end )
+        {
+            if( --mTasks[*itor].pendingDependencies == 0u )
+                activateTask( *itor );
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool FrameTaskGraph::grabChunk( size_t &outTaskIdx, size_t &outChunkIdx )
+    {
+        //Prefer the tasks added first, since they're probably the ones others wait on.
+        const size_t numTasks = mTasks.size();
+        for( size_t i=0; i<numTasks; ++i )
+        {
+            TaskNode &taskNode = mTasks[i];
+
+            //A torn read (32-bit targets) is harmless: the CAS compares the whole value.
+            uint64 state = taskNode.chunkState;
+            while( (state & 0xFFFFFFFFu) < (state >> 32u) )
+            {
+                if( atomicCas( &taskNode.chunkState, state, state + 1u ) )
+                {
+                    outTaskIdx  = i;
+                    outChunkIdx = static_cast<size_t>( state & 0xFFFFFFFFu );
+                    return true;
+                }
+
+                state = taskNode.chunkState;
+            }
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    bool FrameTaskGraph::hasChunksLeft(void) const
+    {
+        TaskNodeArray::const_iterator itor = mTasks.begin();
+        TaskNodeArray::const_iterator end  = mTasks.end();
+
+        while( itor != end )
+        {
+            const uint64 state = itor->chunkState;
+            if( (state & 0xFFFFFFFFu) < (state >> 32u) )
+                return true;
+            ++itor;
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::wakeUpSleepingThreads(void)
+    {
+        FastArray<size_t>::const_iterator itor = mSleepingThreads.begin();
+        FastArray<size_t>::const_iterator end  = mSleepingThreads.end();
+
+        while( itor != end )
+        {
+            mWakeUpEvents[*itor]->wake();
+            ++itor;
+        }
+
+        mSleepingThreads.clear();
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::_prepareExecution( size_t numThreads )
+    {
+        if( !mGraphValidated )
+            validateGraph();
+
+        mNumTasksDone = 0;
+
+        mWakeUpEvents.reserve( numThreads );
+        while( mWakeUpEvents.size() < numThreads )
+            mWakeUpEvents.push_back( OGRE_NEW_T( WaitableEvent, MEMCATEGORY_GENERAL )() );
+        mSleepingThreads.clear();
+        mSleepingThreads.reserve( numThreads );
+
+        TaskNodeArray::iterator itor = mTasks.begin();
+        TaskNodeArray::iterator end  = mTasks.end();
+
+        while( itor != end )
+        {
+            itor->pendingDependencies   = itor->numDependencies;
+            itor->passIdx               = 0;
+            itor->chunkState            = 0;
+            itor->chunksLeft            = 0;
+            ++itor;
+        }
+
+        const size_t numTasks = mTasks.size();
+        for( size_t i=0; i<numTasks; ++i )
+        {
+            if( !mTasks[i].numDependencies )
+                activateTask( i );
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void FrameTaskGraph::_executeWorker( size_t threadIdx )
+    {
+        bool allDone = false;
+
+        while( !allDone )
+        {
+            size_t taskIdx, chunkIdx;
+            if( grabChunk( taskIdx, chunkIdx ) )
+            {
+                //passIdx can't change until the chunk we grabbed is done
+                TaskNode &taskNode = mTasks[taskIdx];
+                taskNode.task->execute( taskNode.passIdx, chunkIdx, threadIdx );
+
+                if( atomicDecrement( &taskNode.chunksLeft ) == 0u )
+                {
+                    //Pass is over. Start the next one (or finish the task)
+                    ScopedLock lock( mMutex );
+                    ++taskNode.passIdx;
+                    activateTask( taskIdx );
+
+                    //There may be new chunks to grab, or we may be done
+                    wakeUpSleepingThreads();
+                }
+            }
+            else
+            {
+                //Everything that can run is already being processed by other threads,
+                //and the rest is waiting for them to finish. Passes only start with
+                //mMutex held, so if there's still nothing to grab once we hold it, sleep
+                //until someone finishes a pass. If it wakes us before we start waiting,
+                //the event remembers it and wait returns immediately.
+                bool mustSleep = false;
+                {
+                    ScopedLock lock( mMutex );
+                    allDone = mNumTasksDone == mTasks.size();
+                    if( !allDone && !hasChunksLeft() )
+                    {
+                        mSleepingThreads.push_back( threadIdx );
+                        mustSleep = true;
+                    }
+                }
+
+                if( mustSleep )
+                    mWakeUpEvents[threadIdx]->wait();
+            }
+        }
+    }
+}
@@ -32,8 +32,27 @@ THE SOFTWARE.
 
 #include "ogrestd/vector.h"
 
+#if OGRE_PLATFORM == OGRE_PLATFORM_LINUX || OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
+#   include <sched.h>
+#   include <sys/resource.h>
+#elif OGRE_PLATFORM == OGRE_PLATFORM_APPLE || OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS
+#   include <pthread/qos.h>
+#endif
+
 namespace Ogre
 {
+    struct ThreadClassSettings
+    {
+        ThreadPriority::ThreadPriority  priority;
+        uint64                          affinityMask;
+    };
+    static ThreadClassSettings sThreadClassSettings[ThreadClass::NumThreadClasses] =
+    {
+        { ThreadPriority::Normal, 0 },
+        { ThreadPriority::Normal, 0 },
+        { ThreadPriority::Normal, 0 }
+    };
+
     ThreadHandle::ThreadHandle( size_t threadIdx, void *userParam ) :
         mThreadIdx( threadIdx ),
         mUserParam( userParam )
@@ -78,6 +97,56 @@ namespace Ogre
         nanosleep( &timeToSleep, 0 );
     }
     //-----------------------------------------------------------------------------------
+    void Threads::SetThreadClassSettings( ThreadClass::ThreadClass threadClass,
+                                          ThreadPriority::ThreadPriority priority,
+                                          uint64 affinityMask )
+    {
+        sThreadClassSettings[threadClass].priority      = priority;
+        sThreadClassSettings[threadClass].affinityMask  = affinityMask;
+    }
+    //-----------------------------------------------------------------------------------
+    ThreadPriority::ThreadPriority Threads::GetThreadClassPriority(
+            ThreadClass::ThreadClass threadClass )
+    {
+        return sThreadClassSettings[threadClass].priority;
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 Threads::GetThreadClassAffinity( ThreadClass::ThreadClass threadClass )
+    {
+        return sThreadClassSettings[threadClass].affinityMask;
+    }
+    //-----------------------------------------------------------------------------------
+    void Threads::ApplyThreadClass( ThreadClass::ThreadClass threadClass )
+    {
+        const ThreadClassSettings &settings = sThreadClassSettings[threadClass];
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_LINUX || OGRE_PLATFORM == OGRE_PLATFORM_ANDROID
+        if( settings.affinityMask )
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO( &cpuSet );
+            for( int i=0; i<64 && i<CPU_SETSIZE; ++i )
+            {
+                if( settings.affinityMask & ( ((uint64)1u) << i ) )
+                    CPU_SET( i, &cpuSet );
+            }
+            //0 is the calling thread
+            sched_setaffinity( 0, sizeof( cpuSet ), &cpuSet );
+        }
+
+        //On Linux the nice value is per thread, and 0 refers to the calling thread
+        if( settings.priority != ThreadPriority::Normal )
+            setpriority( PRIO_PROCESS, 0, settings.priority == ThreadPriority::Low ? 10 : -5 );
+#elif OGRE_PLATFORM == OGRE_PLATFORM_APPLE || OGRE_PLATFORM == OGRE_PLATFORM_APPLE_IOS
+        if( settings.priority != ThreadPriority::Normal )
+        {
+            pthread_set_qos_class_self_np( settings.priority == ThreadPriority::Low ?
+                                               QOS_CLASS_UTILITY : QOS_CLASS_USER_INTERACTIVE,
+                                           0 );
+        }
+#endif
+    }
+    //-----------------------------------------------------------------------------------
     bool Threads::CreateTls( TlsHandle *outTls )
     {
         int result = pthread_key_create( outTls, NULL );
@@ -36,6 +36,18 @@ THE SOFTWARE.
 
 namespace Ogre
 {
+    struct ThreadClassSettings
+    {
+        ThreadPriority::ThreadPriority  priority;
+        uint64                          affinityMask;
+    };
+    static ThreadClassSettings sThreadClassSettings[ThreadClass::NumThreadClasses] =
+    {
+        { ThreadPriority::Normal, 0 },
+        { ThreadPriority::Normal, 0 },
+        { ThreadPriority::Normal, 0 }
+    };
+
     ThreadHandle::ThreadHandle( size_t threadIdx, void *userParam ) :
         mThread( 0 ),
         mThreadIdx( threadIdx ),
@@ -82,6 +94,41 @@ namespace Ogre
         ::Sleep( milliseconds );
     }
     //-----------------------------------------------------------------------------------
+    void Threads::SetThreadClassSettings( ThreadClass::ThreadClass threadClass,
+                                          ThreadPriority::ThreadPriority priority,
+                                          uint64 affinityMask )
+    {
+        sThreadClassSettings[threadClass].priority      = priority;
+        sThreadClassSettings[threadClass].affinityMask  = affinityMask;
+    }
+    //-----------------------------------------------------------------------------------
+    ThreadPriority::ThreadPriority Threads::GetThreadClassPriority(
+            ThreadClass::ThreadClass threadClass )
+    {
+        return sThreadClassSettings[threadClass].priority;
+    }
+    //-----------------------------------------------------------------------------------
+    uint64 Threads::GetThreadClassAffinity( ThreadClass::ThreadClass threadClass )
+    {
+        return sThreadClassSettings[threadClass].affinityMask;
+    }
+    //-----------------------------------------------------------------------------------
+    void Threads::ApplyThreadClass( ThreadClass::ThreadClass threadClass )
+    {
+        const ThreadClassSettings &settings = sThreadClassSettings[threadClass];
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        if( settings.affinityMask )
+            SetThreadAffinityMask( GetCurrentThread(), (DWORD_PTR)settings.affinityMask );
+#endif
+
+        if( settings.priority != ThreadPriority::Normal )
+        {
+            SetThreadPriority( GetCurrentThread(), settings.priority == ThreadPriority::Low ?
+                                   THREAD_PRIORITY_BELOW_NORMAL : THREAD_PRIORITY_ABOVE_NORMAL );
+        }
+    }
+    //-----------------------------------------------------------------------------------
     bool Threads::CreateTls( TlsHandle *outTls )
     {
         *outTls = TlsAlloc();
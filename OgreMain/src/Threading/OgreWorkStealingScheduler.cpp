@@ -0,0 +1,119 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Threading/OgreWorkStealingScheduler.h"
+
+namespace Ogre
+{
+    WorkStealingScheduler::WorkStealingScheduler( size_t numThreads ) :
+        mRanges( 0 ),
+        mNumThreads( std::max<size_t>( numThreads, 1u ) )
+    {
+        mRanges = new ThreadRange[mNumThreads];
+    }
+    //-----------------------------------------------------------------------------------
+    WorkStealingScheduler::~WorkStealingScheduler()
+    {
+        delete [] mRanges;
+        mRanges = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void WorkStealingScheduler::reset( size_t numChunks )
+    {
+        const size_t chunksPerThread = numChunks / mNumThreads;
+        const size_t remainder = numChunks % mNumThreads;
+
+        size_t start = 0;
+        for( size_t i=0; i<mNumThreads; ++i )
+        {
+            const size_t numChunksInThread = chunksPerThread + (i < remainder ? 1u : 0u);
+            mRanges[i].nextChunk = start;
+            mRanges[i].endChunk  = start + numChunksInThread;
+            start += numChunksInThread;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkStealingScheduler::steal( size_t threadIdx )
+    {
+        ThreadRange &ownRange = mRanges[threadIdx];
+
+        for( size_t i=1; i<mNumThreads; ++i )
+        {
+            ThreadRange &victim = mRanges[(threadIdx + i) % mNumThreads];
+
+            size_t stolenStart = 0;
+            size_t stolenEnd = 0;
+
+            {
+                ScopedLock lock( victim.mutex );
+                const size_t numRemaining = victim.endChunk - victim.nextChunk;
+                if( numRemaining > 0u )
+                {
+                    //Take the back half (rounding up, so we can steal the last chunk too).
+                    //The victim keeps working on the front which is still hot in its cache.
+                    const size_t numToSteal = (numRemaining + 1u) >> 1u;
+                    stolenEnd   = victim.endChunk;
+                    stolenStart = stolenEnd - numToSteal;
+                    victim.endChunk = stolenStart;
+                }
+            }
+
+            if( stolenStart != stolenEnd )
+            {
+                ScopedLock lock( ownRange.mutex );
+                ownRange.nextChunk  = stolenStart;
+                ownRange.endChunk   = stolenEnd;
+                return true;
+            }
+        }
+
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    bool WorkStealingScheduler::grabChunk( size_t threadIdx, size_t &outChunkIdx )
+    {
+        assert( threadIdx < mNumThreads );
+
+        ThreadRange &ownRange = mRanges[threadIdx];
+
+        do
+        {
+            ScopedLock lock( ownRange.mutex );
+            if( ownRange.nextChunk != ownRange.endChunk )
+            {
+                outChunkIdx = ownRange.nextChunk++;
+                return true;
+            }
+        }
+        while( steal( threadIdx ) );
+
+        return false;
+    }
+}
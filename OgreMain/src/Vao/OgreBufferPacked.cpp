@@ -32,6 +32,9 @@ THE SOFTWARE.
 #include "Vao/OgreVaoManager.h"
 #include "OgreException.h"
 #include "OgreLogManager.h"
+#include "OgreRoot.h"
+#include "OgreFrameMetrics.h"
+#include "OgreGpuMemoryTracker.h"
 
 namespace Ogre
 {
@@ -51,7 +54,8 @@ namespace Ogre
         mBufferInterface( bufferInterface ),
         mLastMappingStart( 0 ),
         mLastMappingCount( 0 ),
-        mShadowCopy( 0 )
+        mShadowCopy( 0 ),
+        mMemoryTag( GpuMemoryTracker::getTagForNewResource() )
 #if OGRE_DEBUG_MODE
     ,   mLastFrameMapped( ~0 ),
         mLastFrameMappedAndAdvanced( ~0 )
@@ -142,6 +146,11 @@ namespace Ogre
         }
 
         mBufferInterface->upload( data, elementStart, elementCount );
+
+        Root::getSingleton().getFrameMetrics()->add( FrameMetric::BufferBytesUploaded,
+                                                     elementCount * mBytesPerElement );
+
+        _notifyContentChanged();
     }
     //-----------------------------------------------------------------------------------
     void* RESTRICT_ALIAS_RETURN BufferPacked::map( size_t elementStart, size_t elementCount,
@@ -200,6 +209,10 @@ namespace Ogre
         MappingState prevMappingState = mMappingState;
         mMappingState = MS_MAPPED;
 
+        //Assume everything that gets mapped will be written to
+        Root::getSingleton().getFrameMetrics()->add( FrameMetric::BufferBytesUploaded,
+                                                     elementCount * mBytesPerElement );
+
         return mBufferInterface->map( elementStart, elementCount, prevMappingState, bAdvanceFrame );
     }
     //-----------------------------------------------------------------------------------
@@ -214,6 +227,8 @@ namespace Ogre
 
         mBufferInterface->unmap( unmapOption, flushStartElem, flushSizeElem );
 
+        _notifyContentChanged();
+
         if( unmapOption == UO_UNMAP_ALL || mBufferType == BT_DYNAMIC_DEFAULT ||
             !mVaoManager->supportsPersistentMapping() )
         {
@@ -310,6 +325,8 @@ namespace Ogre
                                   (this->mFinalBufferStart + srcElemStart) *
                                   this->mBytesPerElement,
                                   srcNumElems * this->getBytesPerElement() );
+
+        dstBuffer->_notifyContentChanged();
     }
     //-----------------------------------------------------------------------------------
     bool BufferPacked::isCurrentlyMapped(void) const
@@ -0,0 +1,284 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Vao/OgreDynamicMesh.h"
+#include "Vao/OgreVaoManager.h"
+
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+
+namespace Ogre
+{
+    const size_t DynamicMesh::ElementsPerBlock = 64u;
+
+    DynamicMesh::BufferTracker::BufferTracker() :
+        buffer( 0 ),
+        cpuData( 0 ),
+        bytesPerElement( 0 ),
+        numElements( 0 ),
+        numBlocks( 0 ),
+        dirtyBlocks( 0 ),
+        nextRegion( 0 ),
+        pendingChanges( false )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::BufferTracker::create( BufferPacked *_buffer, size_t numRegions )
+    {
+        buffer          = _buffer;
+        bytesPerElement = buffer->getBytesPerElement();
+        numElements     = buffer->getNumElements();
+        numBlocks       = ( numElements + ElementsPerBlock - 1u ) / ElementsPerBlock;
+
+        const size_t sizeBytes = bytesPerElement * numElements;
+        cpuData = reinterpret_cast<uint8*>( OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY ) );
+        memset( cpuData, 0, sizeBytes );
+
+        dirtyBlocks = reinterpret_cast<uint8*>( OGRE_MALLOC( numBlocks * numRegions,
+                                                             MEMCATEGORY_GEOMETRY ) );
+        //Every region starts with garbage, upload everything on the first frame
+        memset( dirtyBlocks, 1, numBlocks * numRegions );
+        pendingChanges = true;
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::BufferTracker::destroy(void)
+    {
+        if( cpuData )
+        {
+            OGRE_FREE_SIMD( cpuData, MEMCATEGORY_GEOMETRY );
+            cpuData = 0;
+        }
+        if( dirtyBlocks )
+        {
+            OGRE_FREE( dirtyBlocks, MEMCATEGORY_GEOMETRY );
+            dirtyBlocks = 0;
+        }
+        buffer = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::BufferTracker::markDirty( size_t elementStart, size_t elementCount,
+                                                size_t numRegions )
+    {
+        if( elementStart + elementCount > numElements )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Range [" + StringConverter::toString( elementStart ) + "; " +
+                         StringConverter::toString( elementStart + elementCount ) +
+                         ") is out of bounds. The buffer has " +
+                         StringConverter::toString( numElements ) + " elements.",
+                         "DynamicMesh::BufferTracker::markDirty" );
+        }
+
+        if( !elementCount )
+            return;
+
+        const size_t firstBlock = elementStart / ElementsPerBlock;
+        const size_t lastBlock  = ( elementStart + elementCount - 1u ) / ElementsPerBlock;
+
+        for( size_t i=0; i<numRegions; ++i )
+        {
+            uint8 *regionBlocks = dirtyBlocks + i * numBlocks;
+            for( size_t j=firstBlock; j<=lastBlock; ++j )
+                regionBlocks[j] = 1u;
+        }
+
+        pendingChanges = true;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t DynamicMesh::BufferTracker::upload( size_t numRegions )
+    {
+        if( !buffer || !pendingChanges )
+            return 0;
+
+        uint8 *regionBlocks = dirtyBlocks + nextRegion * numBlocks;
+
+        size_t firstBlock = 0;
+        while( firstBlock < numBlocks && !regionBlocks[firstBlock] )
+            ++firstBlock;
+
+        size_t bytesUploaded = 0;
+
+        if( firstBlock < numBlocks )
+        {
+            size_t lastBlock = numBlocks - 1u;
+            while( !regionBlocks[lastBlock] )
+                --lastBlock;
+
+            //Map only the range spanning the dirty blocks
+            const size_t mapStart = firstBlock * ElementsPerBlock;
+            const size_t mapEnd = std::min( ( lastBlock + 1u ) * ElementsPerBlock, numElements );
+            uint8 *dstData = reinterpret_cast<uint8*>( buffer->map( mapStart, mapEnd - mapStart ) );
+
+            //Copy the runs of contiguous dirty blocks
+            size_t block = firstBlock;
+            while( block <= lastBlock )
+            {
+                if( !regionBlocks[block] )
+                {
+                    ++block;
+                    continue;
+                }
+
+                const size_t runStart = block;
+                while( block <= lastBlock && regionBlocks[block] )
+                    regionBlocks[block++] = 0u;
+
+                const size_t elemStart = runStart * ElementsPerBlock;
+                const size_t elemEnd = std::min( block * ElementsPerBlock, numElements );
+                const size_t sizeBytes = ( elemEnd - elemStart ) * bytesPerElement;
+                memcpy( dstData + ( elemStart - mapStart ) * bytesPerElement,
+                        cpuData + elemStart * bytesPerElement, sizeBytes );
+                bytesUploaded += sizeBytes;
+            }
+
+            buffer->unmap( UO_KEEP_PERSISTENT );
+
+            //The buffer advanced to the next region when we mapped it
+            nextRegion = ( nextRegion + 1u ) % numRegions;
+        }
+
+        //The other regions may still be stale, but the one the GPU
+        //will use is up to date. They'll get fixed the next time we map.
+        pendingChanges = false;
+
+        return bytesUploaded;
+    }
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    //-----------------------------------------------------------------------------------
+    DynamicMesh::DynamicMesh( VaoManager *vaoManager, const VertexElement2Vec &vertexElements,
+                              uint32 numVertices, IndexBufferPacked::IndexType indexType,
+                              uint32 numIndices, OperationType opType ) :
+        mVaoManager( vaoManager ),
+        mVao( 0 ),
+        mNumRegions( vaoManager->getDynamicBufferMultiplier() ),
+        mLastUploadBytes( 0 )
+    {
+        if( !numVertices )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "numVertices can't be 0",
+                         "DynamicMesh::DynamicMesh" );
+        }
+
+        VertexBufferPacked *vertexBuffer = 0;
+        IndexBufferPacked *indexBuffer = 0;
+
+        try
+        {
+            vertexBuffer = mVaoManager->createVertexBuffer( vertexElements, numVertices,
+                                                            BT_DYNAMIC_PERSISTENT, 0, false );
+            if( numIndices )
+            {
+                indexBuffer = mVaoManager->createIndexBuffer( indexType, numIndices,
+                                                              BT_DYNAMIC_PERSISTENT, 0, false );
+            }
+
+            VertexBufferPackedVec vertexBuffers;
+            vertexBuffers.push_back( vertexBuffer );
+            mVao = mVaoManager->createVertexArrayObject( vertexBuffers, indexBuffer, opType );
+        }
+        catch( Exception & )
+        {
+            if( indexBuffer )
+                mVaoManager->destroyIndexBuffer( indexBuffer );
+            if( vertexBuffer )
+                mVaoManager->destroyVertexBuffer( vertexBuffer );
+            throw;
+        }
+
+        mVertices.create( vertexBuffer, mNumRegions );
+        if( indexBuffer )
+            mIndices.create( indexBuffer, mNumRegions );
+    }
+    //-----------------------------------------------------------------------------------
+    DynamicMesh::~DynamicMesh()
+    {
+        VertexBufferPacked *vertexBuffer = getVertexBuffer();
+        IndexBufferPacked *indexBuffer = getIndexBuffer();
+
+        mVaoManager->destroyVertexArrayObject( mVao );
+        mVao = 0;
+
+        if( vertexBuffer->getMappingState() != MS_UNMAPPED )
+            vertexBuffer->unmap( UO_UNMAP_ALL );
+        mVaoManager->destroyVertexBuffer( vertexBuffer );
+
+        if( indexBuffer )
+        {
+            if( indexBuffer->getMappingState() != MS_UNMAPPED )
+                indexBuffer->unmap( UO_UNMAP_ALL );
+            mVaoManager->destroyIndexBuffer( indexBuffer );
+        }
+
+        mVertices.destroy();
+        mIndices.destroy();
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::markVerticesDirty( uint32 vertexStart, uint32 vertexCount )
+    {
+        mVertices.markDirty( vertexStart, vertexCount, mNumRegions );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::markIndicesDirty( uint32 indexStart, uint32 indexCount )
+    {
+        if( !mIndices.buffer )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "This DynamicMesh has no indices",
+                         "DynamicMesh::markIndicesDirty" );
+        }
+
+        mIndices.markDirty( indexStart, indexCount, mNumRegions );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::writeVertices( const void *data, uint32 vertexStart, uint32 vertexCount )
+    {
+        mVertices.markDirty( vertexStart, vertexCount, mNumRegions );
+        memcpy( mVertices.cpuData + vertexStart * mVertices.bytesPerElement, data,
+                vertexCount * mVertices.bytesPerElement );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::writeIndices( const void *data, uint32 indexStart, uint32 indexCount )
+    {
+        markIndicesDirty( indexStart, indexCount );
+        memcpy( mIndices.cpuData + indexStart * mIndices.bytesPerElement, data,
+                indexCount * mIndices.bytesPerElement );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::upload(void)
+    {
+        mLastUploadBytes  = mVertices.upload( mNumRegions );
+        mLastUploadBytes += mIndices.upload( mNumRegions );
+    }
+    //-----------------------------------------------------------------------------------
+    void DynamicMesh::setDrawRange( uint32 primStart, uint32 primCount )
+    {
+        mVao->setPrimitiveRange( primStart, primCount );
+    }
+}
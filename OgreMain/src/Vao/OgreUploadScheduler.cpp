@@ -0,0 +1,323 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "OgreStableHeaders.h"
+
+#include "Vao/OgreUploadScheduler.h"
+#include "Vao/OgreVaoManager.h"
+#include "Vao/OgreStagingBuffer.h"
+#include "Vao/OgreBufferPacked.h"
+#include "Vao/OgreBufferInterface.h"
+
+#include "OgreException.h"
+
+#include <limits>
+
+namespace Ogre
+{
+    struct UploadScheduler::ExecutionOrder
+    {
+        uint32 currentFrame;
+
+        ExecutionOrder( uint32 _currentFrame ) : currentFrame( _currentFrame ) {}
+
+        bool operator () ( const Request &_l, const Request &_r ) const
+        {
+            //Wrap-around safe "deadline reached" test
+            const bool lOverdue = (int32)(_l.deadlineFrame - currentFrame) <= 0;
+            const bool rOverdue = (int32)(_r.deadlineFrame - currentFrame) <= 0;
+
+            if( lOverdue != rOverdue )
+                return lOverdue;
+            if( _l.priority != _r.priority )
+                return _l.priority > _r.priority;
+            return _l.sequence < _r.sequence;
+        }
+    };
+    struct UploadScheduler::DestinationOrder
+    {
+        bool operator () ( const Request &_l, const Request &_r ) const
+        {
+            if( _l.buffer != _r.buffer )
+                return _l.buffer < _r.buffer;
+            return _l.dstOffset < _r.dstOffset;
+        }
+    };
+    //-----------------------------------------------------------------------------------
+    UploadScheduler::UploadScheduler( VaoManager *vaoManager ) :
+        mVaoManager( vaoManager ),
+        mQueuedBytes( 0 ),
+        mNextSequence( 0 ),
+        mMaxBytesPerFrame( 0 ),
+        mExternalBytesThisFrame( 0 ),
+        mLastFrameBytesUploaded( 0 ),
+        mLastFrameRequests( 0 ),
+        mLastFrameCopies( 0 )
+    {
+    }
+    //-----------------------------------------------------------------------------------
+    UploadScheduler::~UploadScheduler()
+    {
+        //Don't touch the buffers. They may have already been destroyed by the VaoManager
+        RequestVec::iterator itor = mRequests.begin();
+        RequestVec::iterator end  = mRequests.end();
+
+        while( itor != end )
+        {
+            freeRequest( *itor );
+            ++itor;
+        }
+
+        mRequests.clear();
+        mQueuedBytes = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::freeRequest( Request &request )
+    {
+        OGRE_FREE_SIMD( request.data, MEMCATEGORY_GEOMETRY );
+        request.data = 0;
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::queueUpload( BufferPacked *buffer, const void *data,
+                                       size_t elementStart, size_t elementCount,
+                                       uint8 priority, uint32 maxFramesToWait )
+    {
+        if( buffer->getBufferType() != BT_DEFAULT )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALID_STATE,
+                         "Only BT_DEFAULT buffers can be scheduled for upload!",
+                         "UploadScheduler::queueUpload" );
+        }
+
+        if( elementCount + elementStart > buffer->getNumElements() )
+        {
+            OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                         "Size of the provided data goes out of bounds!",
+                         "UploadScheduler::queueUpload" );
+        }
+
+        if( !elementCount )
+            return;
+
+        const size_t bytesPerElement = buffer->getBytesPerElement();
+        const size_t dstOffset = elementStart * bytesPerElement;
+        const size_t sizeBytes = elementCount * bytesPerElement;
+
+        if( buffer->mShadowCopy )
+        {
+            memcpy( static_cast<uint8*>( buffer->mShadowCopy ) + dstOffset, data, sizeBytes );
+        }
+
+        //Deal with pending requests that overlap with this one.
+        RequestVec::iterator itor = mRequests.begin();
+        RequestVec::iterator end  = mRequests.end();
+
+        while( itor != end )
+        {
+            if( itor->buffer == buffer &&
+                itor->dstOffset < dstOffset + sizeBytes &&
+                dstOffset < itor->dstOffset + itor->sizeBytes )
+            {
+                if( dstOffset > itor->dstOffset ||
+                    dstOffset + sizeBytes < itor->dstOffset + itor->sizeBytes )
+                {
+                    //Partial overlap. The old data must reach the GPU before ours does.
+                    buffer->mBufferInterface->upload( itor->data,
+                                                      itor->dstOffset / bytesPerElement,
+                                                      itor->sizeBytes / bytesPerElement );
+                }
+
+                mQueuedBytes -= itor->sizeBytes;
+                freeRequest( *itor );
+                itor = efficientVectorRemove( mRequests, itor );
+                end  = mRequests.end();
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+        maxFramesToWait = std::min( maxFramesToWait,
+                                    (uint32)std::numeric_limits<int32>::max() - 1u );
+
+        Request request;
+        request.buffer          = buffer;
+        request.dstOffset       = dstOffset;
+        request.sizeBytes       = sizeBytes;
+        request.data            = reinterpret_cast<uint8*>(
+                                      OGRE_MALLOC_SIMD( sizeBytes, MEMCATEGORY_GEOMETRY ) );
+        request.priority        = priority;
+        request.deadlineFrame   = currentFrame + maxFramesToWait;
+        request.sequence        = mNextSequence++;
+        memcpy( request.data, data, sizeBytes );
+
+        mRequests.push_back( request );
+        mQueuedBytes += sizeBytes;
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::cancelUploads( BufferPacked *buffer )
+    {
+        RequestVec::iterator itor = mRequests.begin();
+        RequestVec::iterator end  = mRequests.end();
+
+        while( itor != end )
+        {
+            if( itor->buffer == buffer )
+            {
+                mQueuedBytes -= itor->sizeBytes;
+                freeRequest( *itor );
+                itor = efficientVectorRemove( mRequests, itor );
+                end  = mRequests.end();
+            }
+            else
+            {
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::_notifyBufferDestroyed( BufferPacked *buffer )
+    {
+        if( !mRequests.empty() )
+            cancelUploads( buffer );
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::executeRequests( size_t numRequests )
+    {
+        mLastFrameBytesUploaded = 0;
+        mLastFrameRequests      = numRequests;
+        mLastFrameCopies        = 0;
+
+        if( !numRequests )
+            return;
+
+        //Group by destination so contiguous regions can be merged into one copy.
+        //Overlapping requests can't exist (see queueUpload), so order doesn't matter.
+        std::sort( mRequests.begin(), mRequests.begin() + numRequests, DestinationOrder() );
+
+        size_t totalBytes = 0;
+        for( size_t i=0; i<numRequests; ++i )
+            totalBytes += mRequests[i].sizeBytes;
+
+        StagingBuffer::DestinationVec destinations;
+        destinations.reserve( numRequests );
+
+        StagingBuffer *stagingBuffer = mVaoManager->getStagingBuffer( totalBytes, true );
+        uint8 *dstData = reinterpret_cast<uint8*>( stagingBuffer->map( totalBytes ) );
+
+        size_t srcOffset = 0;
+        for( size_t i=0; i<numRequests; ++i )
+        {
+            Request &request = mRequests[i];
+            memcpy( dstData + srcOffset, request.data, request.sizeBytes );
+
+            if( !destinations.empty() &&
+                destinations.back().destination == request.buffer &&
+                destinations.back().dstOffset + destinations.back().length == request.dstOffset )
+            {
+                destinations.back().length += request.sizeBytes;
+            }
+            else
+            {
+                destinations.push_back( StagingBuffer::Destination( request.buffer,
+                                                                    request.dstOffset,
+                                                                    srcOffset,
+                                                                    request.sizeBytes ) );
+            }
+
+            srcOffset += request.sizeBytes;
+            freeRequest( request );
+        }
+
+        stagingBuffer->unmap( destinations );
+        stagingBuffer->removeReferenceCount();
+
+        mRequests.erase( mRequests.begin(), mRequests.begin() + numRequests );
+        mQueuedBytes -= totalBytes;
+
+        mLastFrameBytesUploaded = totalBytes;
+        mLastFrameCopies        = destinations.size();
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::flush(void)
+    {
+        executeRequests( mRequests.size() );
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::setMaxBytesPerFrame( size_t maxBytesPerFrame )
+    {
+        mMaxBytesPerFrame = maxBytesPerFrame;
+    }
+    //-----------------------------------------------------------------------------------
+    void UploadScheduler::_update(void)
+    {
+        const size_t externalBytes = mExternalBytesThisFrame;
+        mExternalBytesThisFrame = 0;
+
+        if( mRequests.empty() )
+        {
+            mLastFrameBytesUploaded = 0;
+            mLastFrameRequests      = 0;
+            mLastFrameCopies        = 0;
+            return;
+        }
+
+        if( !mMaxBytesPerFrame )
+        {
+            flush();
+            return;
+        }
+
+        const uint32 currentFrame = mVaoManager->getFrameCount();
+        std::sort( mRequests.begin(), mRequests.end(), ExecutionOrder( currentFrame ) );
+
+        const size_t budget = mMaxBytesPerFrame > externalBytes ?
+                                  mMaxBytesPerFrame - externalBytes : 0u;
+
+        size_t numRequests = 0;
+        size_t bytesSelected = 0;
+
+        RequestVec::const_iterator itor = mRequests.begin();
+        RequestVec::const_iterator end  = mRequests.end();
+
+        while( itor != end )
+        {
+            const bool bOverdue = (int32)(itor->deadlineFrame - currentFrame) <= 0;
+            if( !bOverdue && numRequests > 0u && bytesSelected + itor->sizeBytes > budget )
+                break;
+
+            bytesSelected += itor->sizeBytes;
+            ++numRequests;
+            ++itor;
+        }
+
+        executeRequests( numRequests );
+    }
+}
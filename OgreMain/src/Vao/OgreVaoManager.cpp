@@ -34,6 +34,7 @@ THE SOFTWARE.
 #include "Vao/OgreTexBufferPacked.h"
 #include "Vao/OgreUavBufferPacked.h"
 #include "Vao/OgreIndirectBufferPacked.h"
+#include "Vao/OgreUploadScheduler.h"
 #include "OgreTimer.h"
 #include "OgreCommon.h"
 #include "OgreStringConverter.h"
@@ -44,6 +45,7 @@ namespace Ogre
 {
     VaoManager::VaoManager( const NameValuePairList *params ) :
         mTimer( 0 ),
+        mUploadScheduler( 0 ),
         mDefaultStagingBufferUnfencedTime( 300000 - 1000 ), //4 minutes, 59 seconds
         mDefaultStagingBufferLifetime( 300000 ), //5 minutes
         mSupportsPersistentMapping( false ),
@@ -54,6 +56,7 @@ namespace Ogre
         mNextStagingBufferTimestampCheckpoint( ~0 ),
         mFrameCount( 0 ),
         mNumGeneratedVaos( 0 ),
+        mPoolDefragBytesPerFrame( 0 ),
         mConstBufferAlignment( 256 ),
         mTexBufferAlignment( 256 ),
         mUavBufferAlignment( 256 ),
@@ -62,6 +65,7 @@ namespace Ogre
         mUavBufferMaxSize( 16 * 1024 * 1024 )    //Minimum guaranteed by GL.
     {
         mTimer = OGRE_NEW Timer();
+        mUploadScheduler = OGRE_NEW UploadScheduler( this );
 
         if( params )
         {
@@ -100,6 +104,9 @@ namespace Ogre
             }
         }
 
+        OGRE_DELETE mUploadScheduler;
+        mUploadScheduler = 0;
+
         OGRE_DELETE mTimer;
         mTimer = 0;
     }
@@ -161,6 +168,7 @@ namespace Ogre
         }
         else
         {
+            mUploadScheduler->_notifyBufferDestroyed( vertexBuffer );
             destroyVertexBufferImpl( vertexBuffer );
             OGRE_DELETE vertexBuffer;
         }
@@ -200,6 +208,7 @@ namespace Ogre
         }
         else
         {
+            mUploadScheduler->_notifyBufferDestroyed( indexBuffer );
             destroyIndexBufferImpl( indexBuffer );
             OGRE_DELETE *itor;
         }
@@ -237,6 +246,7 @@ namespace Ogre
         }
         else
         {
+            mUploadScheduler->_notifyBufferDestroyed( constBuffer );
             destroyConstBufferImpl( constBuffer );
             OGRE_DELETE *itor;
         }
@@ -275,6 +285,7 @@ namespace Ogre
         }
         else
         {
+            mUploadScheduler->_notifyBufferDestroyed( texBuffer );
             destroyTexBufferImpl( texBuffer );
             OGRE_DELETE *itor;
         }
@@ -307,6 +318,7 @@ namespace Ogre
 
         assert( uavBuffer->getBufferType() == BT_DEFAULT );
 
+        mUploadScheduler->_notifyBufferDestroyed( uavBuffer );
         destroyUavBufferImpl( uavBuffer );
         OGRE_DELETE *itor;
 
@@ -343,6 +355,7 @@ namespace Ogre
         }
         else
         {
+            mUploadScheduler->_notifyBufferDestroyed( indirectBuffer );
             destroyIndirectBufferImpl( indirectBuffer );
             OGRE_DELETE *itor;
         }
@@ -606,8 +619,62 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
+    bool VaoManager::defragmentPools( size_t maxBytesToMove )
+    {
+        return false;
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::setPoolDefragmentation( size_t bytesPerFrame )
+    {
+        mPoolDefragBytesPerFrame = bytesPerFrame;
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::_collectMemoryTagStats( GpuMemoryTagStatsVec &outStats ) const
+    {
+        for( size_t i=0; i<NUM_BUFFER_PACKED_TYPES; ++i )
+        {
+            BufferPackedSet::const_iterator itor = mBuffers[i].begin();
+            BufferPackedSet::const_iterator end  = mBuffers[i].end();
+
+            while( itor != end )
+            {
+                const BufferPacked *buffer = *itor;
+                const size_t numCopies = buffer->getBufferType() >= BT_DYNAMIC_DEFAULT ?
+                                             mDynamicBufferMultiplier : 1u;
+                assert( buffer->getMemoryTag() < outStats.size() );
+                GpuMemoryTagStats &stats = outStats[buffer->getMemoryTag()];
+                stats.bufferBytes += buffer->_getInternalTotalSizeBytes() * numCopies;
+                stats.wastedBytes += buffer->_getNumElementsPadding() *
+                                     buffer->getBytesPerElement() * numCopies;
+                ++stats.numBuffers;
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void VaoManager::_getBuffersWithMemoryTag( uint8 tag, BufferPackedVec &outBuffers ) const
+    {
+        for( size_t i=0; i<NUM_BUFFER_PACKED_TYPES; ++i )
+        {
+            BufferPackedSet::const_iterator itor = mBuffers[i].begin();
+            BufferPackedSet::const_iterator end  = mBuffers[i].end();
+
+            while( itor != end )
+            {
+                if( (*itor)->getMemoryTag() == tag )
+                    outBuffers.push_back( *itor );
+                ++itor;
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
     void VaoManager::_update(void)
     {
+        mUploadScheduler->_update();
+
+        if( mPoolDefragBytesPerFrame )
+            defragmentPools( mPoolDefragBytesPerFrame );
+
         Root::getSingleton()._renderingFrameEnded();
         ++mFrameCount;
     }
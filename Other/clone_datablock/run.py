@@ -23,10 +23,10 @@ call( ["python2", \
         ] )
 call( ["python2", \
         "clone_datablock.py", \
-        "../../Samples/2.0/Tutorials/Tutorial_Terrain/include/Terra/Hlms/OgreHlmsTerraDatablock.h", \
+        "../../Components/Terra/include/Terra/Hlms/OgreHlmsTerraDatablock.h", \
         "-I", "../../Components/Hlms/Common/include", \
-        "-I", "../../Samples/2.0/Tutorials/Tutorial_Terrain/include", \
-        "-I", "../../Samples/2.0/Tutorials/Tutorial_Terrain/include/Terra/Hlms", \
+        "-I", "../../Components/Terra/include", \
+        "-I", "../../Components/Terra/include/Terra/Hlms", \
         "-I", "../../OgreMain/include/", \
         "-I", "../../build/include", \
         "-I", "../../build/Debug/include", \
@@ -49,6 +49,11 @@ namespace Ogre {
     class _OgreGL3PlusExport GLSLMonolithicProgram : public GLSLProgram
     {
     protected:
+        /// True if linkAsync submitted the link and activate hasn't checked the result yet.
+        bool mLinkPending;
+
+        /// Binds the fixed attributes and calls glLinkProgram, without checking the result.
+        void submitLink(void);
         /// Compiles and links the vertex and fragment programs
         void compileAndLink(void);
         /// Put a program in use
@@ -71,6 +76,15 @@ namespace Ogre {
         */
         void activate(void);
 
+        /** Submits the compilation of the shaders and the link of the program without
+            waiting for any result, so that the driver can do them in its own threads
+            (GL_ARB_parallel_shader_compile). activate waits for them and reports
+            the errors, as usual.
+        @remarks
+            Does nothing if it was already linked or the program is in the microcode cache.
+        */
+        void linkAsync(void);
+
         /** Updates program object uniforms using data from
             GpuProgramParameters.  normally called by
             GLSLShader::bindParameters() just before rendering
@@ -66,6 +66,11 @@ namespace Ogre {
         /// active objects defining the active rendering gpu state
         GLSLMonolithicProgram* mActiveMonolithicProgram;
 
+        /// Key into mMonolithicPrograms. Returns 0 if all shaders are null.
+        static uint32 getProgramKey( GLSLShader *vertexShader, GLSLShader *hullShader,
+                                     GLSLShader *domainShader, GLSLShader *geometryShader,
+                                     GLSLShader *fragmentShader, GLSLShader *computeShader );
+
     public:
 
         GLSLMonolithicProgramManager(const GL3PlusSupport& support);
@@ -78,6 +83,14 @@ namespace Ogre {
         */
         GLSLMonolithicProgram* getActiveMonolithicProgram(void);
 
+        /** Creates the program object for the given shaders if it doesn't exist yet, and
+            submits its compilation & link without waiting for the result.
+            See GLSLMonolithicProgram::linkAsync.
+        */
+        void linkAsync( GLSLShader *vertexShader, GLSLShader *hullShader,
+                        GLSLShader *domainShader, GLSLShader *geometryShader,
+                        GLSLShader *fragmentShader );
+
         /** Set the active vertex shader for the next rendering state.
             The active program object will be cleared.  Normally
             called from the GLSLShader::bindProgram and
@@ -178,6 +178,11 @@ namespace Ogre {
 
         /// Compile source into shader object
         bool compile( const bool checkErrors = false);
+        /** Submits the source for compilation but doesn't wait for the result.
+            With GL_ARB_parallel_shader_compile the driver compiles it in its own
+            threads. The next call to compile() waits for it and checks for errors.
+        */
+        void compileAsync(void);
 
 
         /// Bind the shader in OpenGL.
@@ -248,6 +253,9 @@ namespace Ogre {
         */
         void checkAndFixInvalidDefaultPrecisionError( String &message );
 
+        /// Creates the shader object & calls glCompileShader, without checking the result.
+        void submitCompile(void);
+
         virtual void setUniformBlockBinding( const char *blockName, uint32 bindingSlot );
 
 
@@ -267,6 +275,8 @@ namespace Ogre {
 
         /// Flag indicating if shader object successfully compiled.
         GLint mCompiled;
+        /// True if compileAsync submitted it and compile() hasn't checked the result yet.
+        bool mCompilePending;
         /// The input operation type for this (geometry) program.
         OperationType mInputOperationType;
         /// The output operation type for this (geometry) program.
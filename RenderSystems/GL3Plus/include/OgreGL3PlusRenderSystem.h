@@ -138,12 +138,19 @@ namespace Ogre {
         bool mHasGL43;
 
         bool mHasArbInvalidateSubdata;
+        /// GL_ARB_parallel_shader_compile. When true, shaders get compiled & linked by
+        /// the driver's threads as soon as their PSO is created, instead of on first use.
+        bool mHasParallelShaderCompile;
 
         // local data members of _render that were moved here to improve performance
         // (save allocations)
         vector<GLuint>::type mRenderAttribsBound;
         vector<GLuint>::type mRenderInstanceAttribsBound;
 
+        /// Timestamp queries for the GpuProfiler. mGpuTimestampQueries[frameIdx * num + queryIdx]
+        vector<GLuint>::type mGpuTimestampQueries;
+        uint32 mGpuTimestampQueriesPerFrame;
+
         GLint getCombinedMinMipFilter(void) const;
 #if OGRE_NO_QUAD_BUFFER_STEREO == 0
 		/// @copydoc RenderSystem::setDrawBuffer
@@ -511,6 +518,12 @@ namespace Ogre {
         virtual void deinitGPUProfiling(void);
         virtual void beginGPUSampleProfile( const String &name, uint32 *hashCache );
         virtual void endGPUSampleProfile( const String &name );
+
+        virtual bool _supportsGpuTimestamps(void) const;
+        virtual void _createGpuTimestampQueries( uint32 numFrames, uint32 queriesPerFrame );
+        virtual void _destroyGpuTimestampQueries(void);
+        virtual void _writeGpuTimestamp( uint32 frameIdx, uint32 queryIdx );
+        virtual bool _getGpuTimestamps( uint32 frameIdx, uint32 numQueries, uint64 *outNanoseconds );
     };
 }
 
@@ -69,6 +69,12 @@ namespace Ogre
 
         void _setVboPoolIndex( size_t newVboPool )  { mVboPoolIdx = newVboPool; }
 
+        /** The VaoManager moved the contents of this (static) buffer to a different VBO.
+        @param internalBufferStart
+            New start of the buffer inside the VBO, in elements.
+        */
+        void _relocate( size_t vboPoolIdx, GLuint vboName, size_t internalBufferStart );
+
         /// Only use this function for the first upload
         void _firstUpload( void *data, size_t elementStart, size_t elementCount );
 
@@ -48,6 +48,13 @@ namespace Ogre
             Caller is responsible for flushing regions before unmapping.
             Caller is responsible for proper synchronization.
             No check is performed to see if two map calls overlap.
+    @par
+        Persistent buffers (BT_DYNAMIC_PERSISTENT & BT_DYNAMIC_PERSISTENT_COHERENT) are
+        mapped once, the first time any of its subregions is requested, and stay mapped
+        until the buffer is destroyed. Every dynamic buffer type sharing the same pool
+        (const, tex, uav, vertex, index, staging textures, etc) then only does pointer
+        arithmetic + flushes; there are no glMapBufferRange/glUnmapBuffer round trips
+        every frame even when all of them get unmapped with UO_UNMAP_ALL.
     */
     class _OgreGL3PlusExport GL3PlusDynamicBuffer
     {
@@ -89,6 +96,8 @@ namespace Ogre
         /// Unmaps given ticket (got from @see map).
         /// Assumes mVboName is already bound to GL_COPY_WRITE_BUFFER!!!
         /// The ticket becomes invalid after this.
+        /// Persistent buffers keep the GL mapping alive even after the last ticket is
+        /// released (destroying the GL buffer implicitly unmaps it).
         void unmap( size_t ticket );
     };
 }
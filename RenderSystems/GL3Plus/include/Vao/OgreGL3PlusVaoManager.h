@@ -143,6 +143,13 @@ namespace Ogre
         /// True if ARB_buffer_storage is supported (Persistent Mapping and immutable buffers)
         bool    mArbBufferStorage;
         bool    mEmulateTexBuffers;
+        /** When true ("VaoManager::StaticMegaBufferSize" was passed), all static
+            (CPU_INACCESSIBLE) vertex & index buffers are packed into as few VBOs
+            as possible, preferring the earliest one. Meshes sharing vertex format,
+            index type and VBO share the same GL VAO, thus the RenderQueue can merge
+            them into a single indirect draw with only baseVertex/firstIndex changing.
+        */
+        bool    mStaticMegaBuffer;
 
         GLint   mMaxVertexAttribs;
 
@@ -169,6 +176,24 @@ namespace Ogre
         void allocateVbo( size_t sizeBytes, size_t alignment, BufferType bufferType,
                           size_t &outVboIdx, size_t &outBufferOffset );
 
+        /** Looks for a free block in the existing VBOs that can hold the requested size.
+            Does not create new VBOs.
+        @param excludeVboIdx
+            This VBO won't be considered. Use ~0 to consider them all.
+        @param outMatchingStride [out]
+            True if the block's offset is already aligned (no padding needed)
+        @return
+            False if no existing VBO can hold the request.
+        */
+        bool findFreeBlock( VboFlag vboFlag, size_t sizeBytes, size_t alignment,
+                            size_t excludeVboIdx, size_t &outVboIdx, size_t &outBlockIdx,
+                            bool &outMatchingStride ) const;
+
+        /// Takes sizeBytes from vbo.freeBlocks[blockIdx], returned by findFreeBlock.
+        /// Returns the offset in bytes where the data should be placed.
+        size_t allocateFromFreeBlock( Vbo &vbo, size_t blockIdx, size_t sizeBytes,
+                                      size_t alignment, bool matchingStride );
+
         /** Deallocates a buffer allocated with @allocateVbo.
         @remarks
             All four parameters *must* match with the ones provided to or
@@ -231,6 +256,22 @@ namespace Ogre
 
         GLuint createVao( const Vao &vaoRef );
 
+        /// Finds the Vao. Calls createVao automatically if not found.
+        /// Increases refCount before returning the iterator.
+        VaoVec::iterator findVao( const VertexBufferPackedVec &vertexBuffers,
+                                  IndexBufferPacked *indexBuffer,
+                                  OperationType opType );
+        /// Decreases the refCount of the Vao used by the given VertexArrayObject,
+        /// destroying it when it reaches zero.
+        void releaseVao( VertexArrayObject *vao );
+
+        static uint32 generateRenderQueueId( uint32 vaoName, uint32 uniqueVaoId );
+        static uint32 extractUniqueVaoIdFromRenderQueueId( uint32 rqId );
+
+        /// Updates all VertexArrayObjects referencing any of the given buffers after
+        /// they've been moved to a different VBO. movedBuffers must be sorted.
+        void updateVaosReferencing( const FastArray<BufferPacked*> &movedBuffers );
+
         virtual VertexArrayObject* createVertexArrayObjectImpl(
                                                         const VertexBufferPackedVec &vertexBuffers,
                                                         IndexBufferPacked *indexBuffer,
@@ -259,6 +300,12 @@ namespace Ogre
 
         virtual void cleanupEmptyPools(void);
 
+        /// See VaoManager::defragmentPools. Only static (CPU_INACCESSIBLE) pools holding
+        /// vertex, index, const & tex buffers are compacted. Pools that also contain UAV
+        /// or indirect buffers (which may be written by the GPU), MultiSourceVertexBufferPools
+        /// or the internal Draw ID buffer are never drained.
+        virtual bool defragmentPools( size_t maxBytesToMove );
+
         /// Binds the Draw ID to the currently bound vertex array object.
         void bindDrawId(void);
 
@@ -74,6 +74,14 @@ namespace Ogre
                 break;
             }
         }
+
+        /// The VaoManager moved one of our buffers to a different VBO (see
+        /// GL3PlusVaoManager::defragmentPools) and our GL vao had to change.
+        void _updateVaoName( GLuint vaoName, uint32 renderQueueId )
+        {
+            mVaoName        = vaoName;
+            mRenderQueueId  = renderQueueId;
+        }
     };
 }
 
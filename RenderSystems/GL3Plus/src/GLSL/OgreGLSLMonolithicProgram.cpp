@@ -92,6 +92,7 @@ namespace Ogre {
                       geometryProgram,
                       fragmentProgram,
                       computeProgram)
+        , mLinkPending( false )
     {
     }
 
@@ -118,16 +119,25 @@ namespace Ogre {
 
         if (!mLinked && !mTriedToLinkAndFailed)
         {
-            OGRE_CHECK_GL_ERROR(mGLProgramHandle = glCreateProgram());
-
-            if ( GpuProgramManager::getSingleton().canGetCompiledShaderBuffer() &&
-                 GpuProgramManager::getSingleton().isMicrocodeAvailableInCache(getCombinedSource()) )
+            if( mLinkPending )
             {
-                getMicrocodeFromCache();
+                //linkAsync already created the program and submitted the link
+                compileAndLink();
             }
             else
             {
-                compileAndLink();
+                OGRE_CHECK_GL_ERROR(mGLProgramHandle = glCreateProgram());
+
+                if ( GpuProgramManager::getSingleton().canGetCompiledShaderBuffer() &&
+                     GpuProgramManager::getSingleton().isMicrocodeAvailableInCache(
+                         getCombinedSource() ) )
+                {
+                    getMicrocodeFromCache();
+                }
+                else
+                {
+                    compileAndLink();
+                }
             }
 
             extractLayoutQualifiers();
@@ -138,10 +148,69 @@ namespace Ogre {
     }
 
 
+    void GLSLMonolithicProgram::linkAsync(void)
+    {
+        if( mLinked || mTriedToLinkAndFailed || mLinkPending )
+            return;
+
+        GLSLShader *shaders[6] = { mVertexShader, mHullShader, mDomainShader,
+                                   mGeometryShader, mFragmentShader, mComputeShader };
+
+        for( size_t i=0; i<6u; ++i )
+        {
+            //Let activate report the errors
+            if( shaders[i] && shaders[i]->hasCompileError() )
+                return;
+        }
+
+        //Loading from the cache is cheap; leave it to activate
+        if( GpuProgramManager::getSingleton().canGetCompiledShaderBuffer() &&
+            GpuProgramManager::getSingleton().isMicrocodeAvailableInCache( getCombinedSource() ) )
+        {
+            return;
+        }
+
+        OgreProfileExhaustive( "GLSLMonolithicProgram::linkAsync" );
+
+        OGRE_CHECK_GL_ERROR(mGLProgramHandle = glCreateProgram());
+
+        for( size_t i=0; i<6u; ++i )
+        {
+            if( shaders[i] )
+            {
+                shaders[i]->compileAsync();
+                shaders[i]->attachToProgramObject( mGLProgramHandle );
+            }
+        }
+
+        submitLink();
+        mLinkPending = true;
+    }
+
+
+    void GLSLMonolithicProgram::submitLink(void)
+    {
+        bindFixedAttributes( mGLProgramHandle );
+
+        if( GpuProgramManager::getSingleton().getSaveMicrocodesToCache() )
+        {
+            OGRE_CHECK_GL_ERROR( glProgramParameteri( mGLProgramHandle,
+                                                      GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE ) );
+        }
+
+        // the link
+        OGRE_CHECK_GL_ERROR(glLinkProgram( mGLProgramHandle ));
+    }
+
+
     void GLSLMonolithicProgram::compileAndLink()
     {
         OgreProfileExhaustive( "GLSLMonolithicProgram::compileAndLink" );
 
+        //If linkAsync got here first, the shaders are already attached & linking
+        const bool linkSubmitted = mLinkPending;
+        mLinkPending = false;
+
         mVertexArrayObject = new GL3PlusOldVertexArrayObject();
         mVertexArrayObject->bind();
 
@@ -153,7 +222,8 @@ namespace Ogre {
                 mTriedToLinkAndFailed = true;
                 return;
             }
-            mVertexShader->attachToProgramObject(mGLProgramHandle);
+            if( !linkSubmitted )
+                mVertexShader->attachToProgramObject(mGLProgramHandle);
             setSkeletalAnimationIncluded(mVertexShader->isSkeletalAnimationIncluded());
         }
 
@@ -165,7 +235,8 @@ namespace Ogre {
                 mTriedToLinkAndFailed = true;
                 return;
             }
-            mFragmentShader->attachToProgramObject(mGLProgramHandle);
+            if( !linkSubmitted )
+                mFragmentShader->attachToProgramObject(mGLProgramHandle);
         }
 
         // Compile and attach Geometry Program
@@ -176,7 +247,9 @@ namespace Ogre {
                 return;
             }
 
-            mGeometryShader->attachToProgramObject(mGLProgramHandle);
+            if( !linkSubmitted )
+
+                mGeometryShader->attachToProgramObject(mGLProgramHandle);
         }
 
         // Compile and attach Tessellation Control Program
@@ -187,7 +260,9 @@ namespace Ogre {
                 return;
             }
 
-            mHullShader->attachToProgramObject(mGLProgramHandle);
+            if( !linkSubmitted )
+
+                mHullShader->attachToProgramObject(mGLProgramHandle);
         }
 
         // Compile and attach Tessellation Evaluation Program
@@ -198,7 +273,9 @@ namespace Ogre {
                 return;
             }
 
-            mDomainShader->attachToProgramObject(mGLProgramHandle);
+            if( !linkSubmitted )
+
+                mDomainShader->attachToProgramObject(mGLProgramHandle);
         }
 
         // Compile and attach Compute Program
@@ -209,13 +286,13 @@ namespace Ogre {
                 return;
             }
 
-            mComputeShader->attachToProgramObject(mGLProgramHandle);
-        }
+            if( !linkSubmitted )
 
-        bindFixedAttributes( mGLProgramHandle );
+                mComputeShader->attachToProgramObject(mGLProgramHandle);
+        }
 
-        // the link
-        OGRE_CHECK_GL_ERROR(glLinkProgram( mGLProgramHandle ));
+        if( !linkSubmitted )
+            submitLink();
         OGRE_CHECK_GL_ERROR(glGetProgramiv( mGLProgramHandle, GL_LINK_STATUS, &mLinked ));
 
         mTriedToLinkAndFailed = !mLinked;
@@ -231,16 +308,20 @@ namespace Ogre {
         if(mLinked)
         {
             setupBaseInstance( mGLProgramHandle );
+            GLint binaryLength = 0;
             if ( GpuProgramManager::getSingleton().getSaveMicrocodesToCache() )
+            {
+                // get buffer size
+                OGRE_CHECK_GL_ERROR(glGetProgramiv(mGLProgramHandle, GL_PROGRAM_BINARY_LENGTH, &binaryLength));
+            }
+
+            // Some drivers refuse to give binaries (length 0); nothing to cache then.
+            if ( binaryLength > 0 )
             {
                 // add to the microcode to the cache
                 String source;
                 source = getCombinedSource();
 
-                // get buffer size
-                GLint binaryLength = 0;
-                OGRE_CHECK_GL_ERROR(glGetProgramiv(mGLProgramHandle, GL_PROGRAM_BINARY_LENGTH, &binaryLength));
-
                 // create microcode
                 GpuProgramManager::Microcode newMicrocode =
                     GpuProgramManager::getSingleton().createMicrocode(binaryLength + sizeof(GLenum));
@@ -73,6 +73,56 @@ namespace Ogre {
     }
 
 
+    uint32 GLSLMonolithicProgramManager::getProgramKey( GLSLShader *vertexShader,
+                                                        GLSLShader *hullShader,
+                                                        GLSLShader *domainShader,
+                                                        GLSLShader *geometryShader,
+                                                        GLSLShader *fragmentShader,
+                                                        GLSLShader *computeShader )
+    {
+        GLSLShader *shaders[6] = { vertexShader, fragmentShader, geometryShader,
+                                   domainShader, hullShader, computeShader };
+        uint32 key = 0;
+        for( size_t i=0; i<6u; ++i )
+        {
+            if( shaders[i] )
+            {
+                const GLuint shaderID = shaders[i]->getShaderID();
+                key = FastHash( (const char *)(&shaderID), sizeof(GLuint), key );
+            }
+        }
+        return key;
+    }
+
+
+    void GLSLMonolithicProgramManager::linkAsync( GLSLShader *vertexShader,
+                                                  GLSLShader *hullShader,
+                                                  GLSLShader *domainShader,
+                                                  GLSLShader *geometryShader,
+                                                  GLSLShader *fragmentShader )
+    {
+        const uint32 key = getProgramKey( vertexShader, hullShader, domainShader,
+                                          geometryShader, fragmentShader, 0 );
+        if( key == 0 )
+            return;
+
+        GLSLMonolithicProgram *program = 0;
+        MonolithicProgramIterator programFound = mMonolithicPrograms.find( key );
+        if( programFound == mMonolithicPrograms.end() )
+        {
+            program = new GLSLMonolithicProgram( vertexShader, hullShader, domainShader,
+                                                 geometryShader, fragmentShader, 0 );
+            mMonolithicPrograms[key] = program;
+        }
+        else
+        {
+            program = programFound->second;
+        }
+
+        program->linkAsync();
+    }
+
+
     GLSLMonolithicProgram* GLSLMonolithicProgramManager::getActiveMonolithicProgram(void)
     {
         // If there is an active link program then return it.
@@ -81,39 +131,9 @@ namespace Ogre {
 
         // No active link program so find one or make a new one.
         // Is there an active key?
-        uint32 activeKey = 0;
-        GLuint shaderID = 0;
-
-        if (mActiveVertexShader)
-        {
-            shaderID = mActiveVertexShader->getShaderID();
-            activeKey = FastHash((const char *)(&shaderID), sizeof(GLuint), activeKey);
-        }
-        if (mActiveFragmentShader)
-        {
-            shaderID = mActiveFragmentShader->getShaderID();
-            activeKey = FastHash((const char *)(&shaderID), sizeof(GLuint), activeKey);
-        }
-        if (mActiveGeometryShader)
-        {
-            shaderID = mActiveGeometryShader->getShaderID();
-            activeKey = FastHash((const char *)(&shaderID), sizeof(GLuint), activeKey);
-        }
-        if (mActiveDomainShader)
-        {
-            shaderID = mActiveDomainShader->getShaderID();
-            activeKey = FastHash((const char *)(&shaderID), sizeof(GLuint), activeKey);
-        }
-        if (mActiveHullShader)
-        {
-            shaderID = mActiveHullShader->getShaderID();
-            activeKey = FastHash((const char *)(&shaderID), sizeof(GLuint), activeKey);
-        }
-        if (mActiveComputeShader)
-        {
-            shaderID = mActiveComputeShader->getShaderID();
-            activeKey = FastHash((const char *)(&shaderID), sizeof(GLuint), activeKey);
-        }
+        const uint32 activeKey = getProgramKey( mActiveVertexShader, mActiveHullShader,
+                                                mActiveDomainShader, mActiveGeometryShader,
+                                                mActiveFragmentShader, mActiveComputeShader );
 
         // Only return a link program object if a program exists.
         if (activeKey > 0)
@@ -65,6 +65,7 @@ namespace Ogre {
         , mGLShaderHandle(0)
         , mGLProgramHandle(0)
         , mCompiled(0)
+        , mCompilePending(false)
         , mColumnMajorMatrices(true)
     {
         if (createParamDictionary("GLSLShader"))
@@ -211,13 +212,8 @@ namespace Ogre {
     }
 
 
-    bool GLSLShader::compile(const bool checkErrors)
+    void GLSLShader::submitCompile(void)
     {
-        if (mCompiled == 1)
-        {
-            return true;
-        }
-
         // Create shader object.
         GLenum GLShaderType = getGLShaderType(mType);
         OGRE_CHECK_GL_ERROR(mGLShaderHandle = glCreateShader(GLShaderType));
@@ -289,6 +285,27 @@ namespace Ogre {
         }
 
         OGRE_CHECK_GL_ERROR(glCompileShader(mGLShaderHandle));
+    }
+
+    void GLSLShader::compileAsync(void)
+    {
+        if( mCompiled == 1 || mCompilePending || mCompileError )
+            return;
+
+        submitCompile();
+        mCompilePending = true;
+    }
+
+    bool GLSLShader::compile(const bool checkErrors)
+    {
+        if (mCompiled == 1)
+        {
+            return true;
+        }
+
+        if( !mCompilePending )
+            submitCompile();
+        mCompilePending = false;
 
         // Check for compile errors
         OGRE_CHECK_GL_ERROR(glGetShaderiv(mGLShaderHandle, GL_COMPILE_STATUS, &mCompiled));
@@ -351,6 +368,7 @@ namespace Ogre {
         mGLShaderHandle = 0;
         mGLProgramHandle = 0;
         mCompiled = 0;
+        mCompilePending = false;
     }
 
 
@@ -181,6 +181,8 @@ namespace Ogre {
           mHardwareBufferManager(0),
           mActiveTextureUnit(0),
           mHasArbInvalidateSubdata( false ),
+          mHasParallelShaderCompile( false ),
+          mGpuTimestampQueriesPerFrame( 0 ),
           mNullColourFramebuffer( 0 )
     {
         size_t i;
@@ -623,6 +625,17 @@ namespace Ogre {
 
         mShaderManager = OGRE_NEW GLSLShaderManager();
 
+        {
+            // Program binaries are only valid for the exact same driver.
+            const char *vendor   = (const char*)glGetString( GL_VENDOR );
+            const char *renderer = (const char*)glGetString( GL_RENDERER );
+            const char *version  = (const char*)glGetString( GL_VERSION );
+            mShaderManager->setMicrocodeCacheSignature( getName() + "|" +
+                                                        String( vendor ? vendor : "" ) + "|" +
+                                                        String( renderer ? renderer : "" ) + "|" +
+                                                        String( version ? version : "" ) );
+        }
+
         // Create GLSL shader factory
         mGLSLShaderFactory = new GLSLShaderFactory(*mGLSupport);
         HighLevelGpuProgramManager::getSingleton().addFactory(mGLSLShaderFactory);
@@ -822,6 +835,15 @@ namespace Ogre {
             mHasArbInvalidateSubdata = mHasGL43 ||
                                         mGLSupport->checkExtension( "GL_ARB_invalidate_subdata" );
 
+            mHasParallelShaderCompile =
+                    mGLSupport->checkExtension( "GL_ARB_parallel_shader_compile" ) &&
+                    glMaxShaderCompilerThreadsARB != 0;
+            if( mHasParallelShaderCompile )
+            {
+                //Let the driver decide how many compiler threads to use
+                OCGE( glMaxShaderCompilerThreadsARB( 0xFFFFFFFF ) );
+            }
+
             // use real capabilities if custom capabilities are not available
             if (!mUseCustomCapabilities)
                 mCurrentCapabilities = mRealCapabilities;
@@ -1723,6 +1745,29 @@ namespace Ogre {
                                                          _getBindingDelegate() );
         }
 
+        if( mHasParallelShaderCompile )
+        {
+            //Submit the compilation (and the link, if we can) now so that the driver's
+            //threads work on it while we keep going. We'll wait for them on first use.
+            if( mCurrentCapabilities->hasCapability( RSC_SEPARATE_SHADER_OBJECTS ) )
+            {
+                GLSLShader *shaders[5] = { pso->vertexShader, pso->hullShader,
+                                           pso->domainShader, pso->geometryShader,
+                                           pso->pixelShader };
+                for( size_t i=0; i<5u; ++i )
+                {
+                    if( shaders[i] )
+                        shaders[i]->compileAsync();
+                }
+            }
+            else
+            {
+                GLSLMonolithicProgramManager::getSingleton().linkAsync(
+                            pso->vertexShader, pso->hullShader, pso->domainShader,
+                            pso->geometryShader, pso->pixelShader );
+            }
+        }
+
         newBlock->rsData = pso;
     }
 
@@ -2348,6 +2393,12 @@ namespace Ogre {
     {
         newPso->rsData = reinterpret_cast<void*>( static_cast<GLSLShader*>(
                                                       newPso->computeShader->_getBindingDelegate() ) );
+
+        if( mHasParallelShaderCompile )
+        {
+            static_cast<GLSLShader*>( newPso->computeShader->_getBindingDelegate() )->
+                    compileAsync();
+        }
     }
 
     void GL3PlusRenderSystem::_hlmsComputePipelineStateObjectDestroyed( HlmsComputePso *newPso )
@@ -3640,6 +3691,63 @@ namespace Ogre {
 #endif
     }
 
+    bool GL3PlusRenderSystem::_supportsGpuTimestamps(void) const
+    {
+        //ARB_timer_query is core since GL 3.3
+        return true;
+    }
+
+    void GL3PlusRenderSystem::_createGpuTimestampQueries( uint32 numFrames, uint32 queriesPerFrame )
+    {
+        _destroyGpuTimestampQueries();
+
+        mGpuTimestampQueries.resize( numFrames * queriesPerFrame );
+        mGpuTimestampQueriesPerFrame = queriesPerFrame;
+        OCGE( glGenQueries( static_cast<GLsizei>( mGpuTimestampQueries.size() ),
+                            &mGpuTimestampQueries[0] ) );
+    }
+
+    void GL3PlusRenderSystem::_destroyGpuTimestampQueries(void)
+    {
+        if( !mGpuTimestampQueries.empty() )
+        {
+            OCGE( glDeleteQueries( static_cast<GLsizei>( mGpuTimestampQueries.size() ),
+                                   &mGpuTimestampQueries[0] ) );
+            mGpuTimestampQueries.clear();
+        }
+        mGpuTimestampQueriesPerFrame = 0;
+    }
+
+    void GL3PlusRenderSystem::_writeGpuTimestamp( uint32 frameIdx, uint32 queryIdx )
+    {
+        const GLuint queryName =
+            mGpuTimestampQueries[frameIdx * mGpuTimestampQueriesPerFrame + queryIdx];
+        OCGE( glQueryCounter( queryName, GL_TIMESTAMP ) );
+    }
+
+    bool GL3PlusRenderSystem::_getGpuTimestamps( uint32 frameIdx, uint32 numQueries,
+                                                 uint64 *outNanoseconds )
+    {
+        const GLuint *queryNames = &mGpuTimestampQueries[frameIdx * mGpuTimestampQueriesPerFrame];
+
+        //Queries finish in order. If the last one is done, all of them are.
+        GLint available = 0;
+        OCGE( glGetQueryObjectiv( queryNames[numQueries - 1u], GL_QUERY_RESULT_AVAILABLE,
+                                  &available ) );
+        if( !available )
+            return false;
+
+        //GL_TIMESTAMP is already in nanoseconds
+        for( uint32 i=0; i<numQueries; ++i )
+        {
+            GLuint64 timestamp = 0;
+            OCGE( glGetQueryObjectui64v( queryNames[i], GL_QUERY_RESULT, &timestamp ) );
+            outNanoseconds[i] = timestamp;
+        }
+
+        return true;
+    }
+
     bool GL3PlusRenderSystem::activateGLTextureUnit(size_t unit)
     {
         if (mActiveTextureUnit != unit)
@@ -47,6 +47,18 @@ namespace Ogre
     {
     }
     //-----------------------------------------------------------------------------------
+    void GL3PlusBufferInterface::_relocate( size_t vboPoolIdx, GLuint vboName,
+                                            size_t internalBufferStart )
+    {
+        assert( mBuffer->mBufferType < BT_DYNAMIC_DEFAULT && !mDynamicBuffer &&
+                "Relocating dynamic buffers is not supported" );
+
+        mVboPoolIdx = vboPoolIdx;
+        mVboName    = vboName;
+        mBuffer->mInternalBufferStart   = internalBufferStart;
+        mBuffer->mFinalBufferStart      = internalBufferStart;
+    }
+    //-----------------------------------------------------------------------------------
     void GL3PlusBufferInterface::_firstUpload( void *data, size_t elementStart, size_t elementCount )
     {
         //In OpenGL; immutable buffers are a charade. They're mostly there to satisfy D3D11's needs.
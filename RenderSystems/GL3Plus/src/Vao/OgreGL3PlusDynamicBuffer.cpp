@@ -72,7 +72,7 @@ namespace Ogre
     {
         assert( start <= mVboSize && start + count <= mVboSize );
 
-        if( mMappedRanges.size() == mFreeRanges.size() )
+        if( !mMappedPtr )
         {
             GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
 
@@ -113,7 +113,8 @@ namespace Ogre
 
         mFreeRanges.push_back( ticket );
 
-        if( mMappedRanges.size() == mFreeRanges.size() )
+        if( mMappedRanges.size() == mFreeRanges.size() &&
+            mPersistentMethod < BT_DYNAMIC_PERSISTENT )
         {
             OCGE( glUnmapBuffer( GL_COPY_WRITE_BUFFER ) );
             mMappedPtr = 0;
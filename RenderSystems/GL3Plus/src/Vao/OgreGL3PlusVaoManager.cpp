@@ -94,6 +94,7 @@ namespace Ogre
         VaoManager( params ),
         mArbBufferStorage( _supportsArbBufferStorage ),
         mEmulateTexBuffers( emulateTexBuffers ),
+        mStaticMegaBuffer( false ),
         mMaxVertexAttribs( 30 ),
         mDrawId( 0 )
     {
@@ -117,6 +118,18 @@ namespace Ogre
                                                                              mDefaultPoolSize[i] );
                 }
             }
+
+            NameValuePairList::const_iterator itor = params->find( "VaoManager::StaticMegaBufferSize" );
+            if( itor != params->end() )
+            {
+                const size_t megaBufferSize =
+                        StringConverter::parseUnsignedInt( itor->second, 0 );
+                if( megaBufferSize )
+                {
+                    mStaticMegaBuffer = true;
+                    mDefaultPoolSize[CPU_INACCESSIBLE] = megaBufferSize;
+                }
+            }
         }
 
         mFrameSyncVec.resize( mDynamicBufferMultiplier, 0 );
@@ -414,54 +427,224 @@ namespace Ogre
         }
     }
     //-----------------------------------------------------------------------------------
-    void GL3PlusVaoManager::allocateVbo( size_t sizeBytes, size_t alignment, BufferType bufferType,
-                                         size_t &outVboIdx, size_t &outBufferOffset )
+    bool GL3PlusVaoManager::defragmentPools( size_t maxBytesToMove )
     {
-        assert( alignment > 0 );
+        VboVec &vbos = mVbos[CPU_INACCESSIBLE];
 
-        VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+        if( vbos.size() < 2u )
+            return false;
 
-        if( bufferType >= BT_DYNAMIC_DEFAULT )
-            sizeBytes   *= mDynamicBufferMultiplier;
+        //Pick the least occupied pool. It's the cheapest to drain, and moving
+        //only into more occupied pools guarantees we never ping-pong buffers.
+        size_t srcVboIdx    = ~0;
+        size_t srcUsedBytes = ~0;
+        size_t totalFreeBytes = 0;
 
-        VboVec::const_iterator itor = mVbos[vboFlag].begin();
-        VboVec::const_iterator end  = mVbos[vboFlag].end();
-
-        //Find a suitable VBO that can hold the requested size. We prefer those free
-        //blocks that have a matching stride (the current offset is a multiple of
-        //bytesPerElement) in order to minimize the amount of memory padding.
-        size_t bestVboIdx   = ~0;
-        size_t bestBlockIdx = ~0;
-        bool foundMatchingStride = false;
-
-        while( itor != end && !foundMatchingStride )
+        for( size_t i=0; i<vbos.size(); ++i )
         {
-            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
-            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
+            size_t freeBytes = 0;
+            BlockVec::const_iterator itBlock = vbos[i].freeBlocks.begin();
+            BlockVec::const_iterator enBlock = vbos[i].freeBlocks.end();
+            while( itBlock != enBlock )
+            {
+                freeBytes += itBlock->size;
+                ++itBlock;
+            }
 
-            while( blockIt != blockEn && !foundMatchingStride )
+            const size_t usedBytes = vbos[i].sizeBytes - freeBytes;
+            if( !usedBytes )
             {
-                const Block &block = *blockIt;
+                //Already empty, nothing to move.
+                cleanupEmptyPools();
+                return true;
+            }
 
-                //Round to next multiple of alignment
-                size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
-                size_t padding = newOffset - block.offset;
+            totalFreeBytes += freeBytes;
+            if( usedBytes < srcUsedBytes )
+            {
+                srcVboIdx       = i;
+                srcUsedBytes    = usedBytes;
+            }
+        }
 
-                if( sizeBytes + padding <= block.size )
+        const GLuint srcVboName = vbos[srcVboIdx].vboName;
+
+        //The other pools must be able to hold everything, otherwise we'd move data around
+        //without ever being able to release anything.
+        if( totalFreeBytes - (vbos[srcVboIdx].sizeBytes - srcUsedBytes) < srcUsedBytes )
+            return false;
+
+        //Gather the live buffers in the source pool. All of them must be movable.
+        FastArray<BufferPacked*> buffersToMove;
+        size_t bytesToMove = 0;
+
+        for( size_t i=0; i<NUM_BUFFER_PACKED_TYPES; ++i )
+        {
+            if( i == BP_TYPE_INDIRECT && !mSupportsIndirectBuffers )
+                continue;
+
+            BufferPackedSet::const_iterator itor = mBuffers[i].begin();
+            BufferPackedSet::const_iterator end  = mBuffers[i].end();
+
+            while( itor != end )
+            {
+                BufferPacked *buffer = *itor;
+                GL3PlusBufferInterface *bufferInterface = static_cast<GL3PlusBufferInterface*>(
+                                                              buffer->getBufferInterface() );
+                if( buffer->getBufferType() < BT_DYNAMIC_DEFAULT &&
+                    bufferInterface->getVboPoolIndex() == srcVboIdx )
                 {
-                    bestVboIdx      = itor - mVbos[vboFlag].begin();
-                    bestBlockIdx    = blockIt - itor->freeBlocks.begin();
+                    if( i == BP_TYPE_UAV || i == BP_TYPE_INDIRECT || buffer == mDrawId )
+                        return false;
 
-                    if( newOffset == block.offset )
-                        foundMatchingStride = true;
+                    buffersToMove.push_back( buffer );
+                    bytesToMove += buffer->_getInternalTotalSizeBytes();
                 }
 
-                ++blockIt;
+                ++itor;
+            }
+        }
+
+        {
+            size_t paddedBytes = 0;
+            StrideChangerVec::const_iterator itor = vbos[srcVboIdx].strideChangers.begin();
+            StrideChangerVec::const_iterator end  = vbos[srcVboIdx].strideChangers.end();
+            while( itor != end )
+            {
+                paddedBytes += itor->paddedBytes;
+                ++itor;
+            }
+
+            //Something we don't track lives here (i.e. a MultiSourceVertexBufferPool)
+            if( bytesToMove + paddedBytes != srcUsedBytes )
+                return false;
+        }
+
+        FastArray<BufferPacked*> movedBuffers;
+        movedBuffers.reserve( buffersToMove.size() );
+        size_t bytesMoved = 0;
+
+        FastArray<BufferPacked*>::const_iterator itor = buffersToMove.begin();
+        FastArray<BufferPacked*>::const_iterator end  = buffersToMove.end();
+
+        while( itor != end && (bytesMoved == 0 || bytesMoved < maxBytesToMove) )
+        {
+            BufferPacked *buffer = *itor;
+
+            const size_t sizeBytes = buffer->_getInternalTotalSizeBytes();
+            const size_t srcOffset = buffer->_getInternalBufferStart() * buffer->getBytesPerElement();
+
+            //Must match the alignment used by the create*Impl functions
+            size_t alignment = buffer->getBytesPerElement();
+            if( buffer->getBufferPackedType() == BP_TYPE_CONST )
+                alignment = mConstBufferAlignment;
+            else if( buffer->getBufferPackedType() == BP_TYPE_TEX )
+                alignment = mTexBufferAlignment;
+
+            size_t dstVboIdx, dstBlockIdx;
+            bool matchingStride;
+            if( findFreeBlock( CPU_INACCESSIBLE, sizeBytes, alignment, srcVboIdx,
+                               dstVboIdx, dstBlockIdx, matchingStride ) )
+            {
+                Vbo &dstVbo = vbos[dstVboIdx];
+                const size_t dstOffset = allocateFromFreeBlock( dstVbo, dstBlockIdx, sizeBytes,
+                                                                alignment, matchingStride );
+
+                OCGE( glBindBuffer( GL_COPY_READ_BUFFER, srcVboName ) );
+                OCGE( glBindBuffer( GL_COPY_WRITE_BUFFER, dstVbo.vboName ) );
+                OCGE( glCopyBufferSubData( GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER,
+                                           srcOffset, dstOffset, sizeBytes ) );
+
+                //GL takes care of the hazards: previously issued draws still see the old
+                //data, and upcoming ones only run after the copy finished.
+                deallocateVbo( srcVboIdx, srcOffset, sizeBytes, buffer->getBufferType() );
+
+                GL3PlusBufferInterface *bufferInterface = static_cast<GL3PlusBufferInterface*>(
+                                                              buffer->getBufferInterface() );
+                bufferInterface->_relocate( dstVboIdx, dstVbo.vboName,
+                                            dstOffset / buffer->getBytesPerElement() );
+
+                movedBuffers.push_back( buffer );
+                bytesMoved += sizeBytes;
             }
 
             ++itor;
         }
 
+        if( movedBuffers.empty() )
+            return false; //Too fragmented to make progress
+
+        std::sort( movedBuffers.begin(), movedBuffers.end() );
+        updateVaosReferencing( movedBuffers );
+
+        cleanupEmptyPools();
+
+        return true;
+    }
+    //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::updateVaosReferencing( const FastArray<BufferPacked*> &movedBuffers )
+    {
+        VertexArrayObjectSet::const_iterator itor = mVertexArrayObjects.begin();
+        VertexArrayObjectSet::const_iterator end  = mVertexArrayObjects.end();
+
+        while( itor != end )
+        {
+            VertexArrayObject *vao = *itor;
+
+            bool needsUpdate = vao->getIndexBuffer() &&
+                               std::binary_search( movedBuffers.begin(), movedBuffers.end(),
+                                                   static_cast<BufferPacked*>(
+                                                       vao->getIndexBuffer() ) );
+
+            const VertexBufferPackedVec &vertexBuffers = vao->getVertexBuffers();
+            VertexBufferPackedVec::const_iterator itBuf = vertexBuffers.begin();
+            VertexBufferPackedVec::const_iterator enBuf = vertexBuffers.end();
+
+            while( itBuf != enBuf && !needsUpdate )
+            {
+                needsUpdate = std::binary_search( movedBuffers.begin(), movedBuffers.end(),
+                                                  static_cast<BufferPacked*>( *itBuf ) );
+                ++itBuf;
+            }
+
+            if( needsUpdate )
+            {
+                GL3PlusVertexArrayObject *glVao = static_cast<GL3PlusVertexArrayObject*>( vao );
+
+                releaseVao( glVao );
+
+                VaoVec::iterator itVao = findVao( vertexBuffers, vao->getIndexBuffer(),
+                                                  vao->getOperationType() );
+
+                const uint32 uniqueVaoId =
+                        extractUniqueVaoIdFromRenderQueueId( glVao->getRenderQueueId() );
+                glVao->_updateVaoName( itVao->vaoName,
+                                       generateRenderQueueId( itVao->vaoName, uniqueVaoId ) );
+            }
+
+            ++itor;
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::allocateVbo( size_t sizeBytes, size_t alignment, BufferType bufferType,
+                                         size_t &outVboIdx, size_t &outBufferOffset )
+    {
+        assert( alignment > 0 );
+
+        VboFlag vboFlag = bufferTypeToVboFlag( bufferType );
+
+        if( bufferType >= BT_DYNAMIC_DEFAULT )
+            sizeBytes   *= mDynamicBufferMultiplier;
+
+        size_t bestVboIdx   = ~0;
+        size_t bestBlockIdx = ~0;
+        bool foundMatchingStride = false;
+
+        const bool packIntoFirstVbo = mStaticMegaBuffer && vboFlag == CPU_INACCESSIBLE;
+
+        findFreeBlock( vboFlag, sizeBytes, alignment, ~0, bestVboIdx, bestBlockIdx,
+                       foundMatchingStride );
+
         if( bestBlockIdx == (size_t)~0 )
         {
             bestVboIdx      = mVbos[vboFlag].size();
@@ -472,6 +655,15 @@ namespace Ogre
 
             size_t poolSize = std::max( mDefaultPoolSize[vboFlag], sizeBytes );
 
+            if( packIntoFirstVbo && !mVbos[vboFlag].empty() )
+            {
+                LogManager::getSingleton().logMessage(
+                            "WARNING: Static mega buffer is full. Allocating another one of " +
+                            StringConverter::toString( poolSize ) + " bytes. Meshes in different"
+                            " mega buffers can't be batched together. Consider raising"
+                            " VaoManager::StaticMegaBufferSize", LML_CRITICAL );
+            }
+
             //No luck, allocate a new buffer.
             OCGE( glGenBuffers( 1, &newVbo.vboName ) );
             OCGE( glBindBuffer( GL_ARRAY_BUFFER, newVbo.vboName ) );
@@ -537,29 +729,96 @@ namespace Ogre
             mVbos[vboFlag].push_back( newVbo );
         }
 
-        Vbo &bestVbo        = mVbos[vboFlag][bestVboIdx];
-        Block &bestBlock    = bestVbo.freeBlocks[bestBlockIdx];
+        outVboIdx       = bestVboIdx;
+        outBufferOffset = allocateFromFreeBlock( mVbos[vboFlag][bestVboIdx], bestBlockIdx,
+                                                 sizeBytes, alignment, foundMatchingStride );
+    }
+    //-----------------------------------------------------------------------------------
+    bool GL3PlusVaoManager::findFreeBlock( VboFlag vboFlag, size_t sizeBytes, size_t alignment,
+                                           size_t excludeVboIdx,
+                                           size_t &outVboIdx, size_t &outBlockIdx,
+                                           bool &outMatchingStride ) const
+    {
+        VboVec::const_iterator itor = mVbos[vboFlag].begin();
+        VboVec::const_iterator end  = mVbos[vboFlag].end();
 
-        size_t newOffset = ( (bestBlock.offset + alignment - 1) / alignment ) * alignment;
-        size_t padding = newOffset - bestBlock.offset;
+        //Find a suitable VBO that can hold the requested size. We prefer those free
+        //blocks that have a matching stride (the current offset is a multiple of
+        //bytesPerElement) in order to minimize the amount of memory padding.
+        size_t bestVboIdx   = ~0;
+        size_t bestBlockIdx = ~0;
+        bool foundMatchingStride = false;
+
+        //In mega buffer mode, don't look at later VBOs once one can hold the request.
+        //Draws from different VBOs can't be merged, so packing tightly wins over padding.
+        const bool packIntoFirstVbo = mStaticMegaBuffer && vboFlag == CPU_INACCESSIBLE;
+
+        while( itor != end && !foundMatchingStride &&
+               !(packIntoFirstVbo && bestVboIdx != (size_t)~0) )
+        {
+            if( (size_t)(itor - mVbos[vboFlag].begin()) == excludeVboIdx )
+            {
+                ++itor;
+                continue;
+            }
+
+            BlockVec::const_iterator blockIt = itor->freeBlocks.begin();
+            BlockVec::const_iterator blockEn = itor->freeBlocks.end();
+
+            while( blockIt != blockEn && !foundMatchingStride )
+            {
+                const Block &block = *blockIt;
+
+                //Round to next multiple of alignment
+                size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
+                size_t padding = newOffset - block.offset;
+
+                if( sizeBytes + padding <= block.size )
+                {
+                    bestVboIdx      = itor - mVbos[vboFlag].begin();
+                    bestBlockIdx    = blockIt - itor->freeBlocks.begin();
+
+                    if( newOffset == block.offset )
+                        foundMatchingStride = true;
+                }
+
+                ++blockIt;
+            }
+
+            ++itor;
+        }
+
+        outVboIdx           = bestVboIdx;
+        outBlockIdx         = bestBlockIdx;
+        outMatchingStride   = foundMatchingStride;
+
+        return bestBlockIdx != (size_t)~0;
+    }
+    //-----------------------------------------------------------------------------------
+    size_t GL3PlusVaoManager::allocateFromFreeBlock( Vbo &vbo, size_t blockIdx, size_t sizeBytes,
+                                                     size_t alignment, bool matchingStride )
+    {
+        Block &block = vbo.freeBlocks[blockIdx];
+
+        size_t newOffset = ( (block.offset + alignment - 1) / alignment ) * alignment;
+        size_t padding = newOffset - block.offset;
         //Shrink our records about available data.
-        bestBlock.size   -= sizeBytes + padding;
-        bestBlock.offset = newOffset + sizeBytes;
+        block.size   -= sizeBytes + padding;
+        block.offset = newOffset + sizeBytes;
 
-        if( !foundMatchingStride )
+        if( !matchingStride )
         {
             //This is a stride changer, record as such.
-            StrideChangerVec::iterator itStride = std::lower_bound( bestVbo.strideChangers.begin(),
-                                                                    bestVbo.strideChangers.end(),
+            StrideChangerVec::iterator itStride = std::lower_bound( vbo.strideChangers.begin(),
+                                                                    vbo.strideChangers.end(),
                                                                     newOffset, StrideChanger() );
-            bestVbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
+            vbo.strideChangers.insert( itStride, StrideChanger( newOffset, padding ) );
         }
 
-        if( bestBlock.size == 0 )
-            bestVbo.freeBlocks.erase( bestVbo.freeBlocks.begin() + bestBlockIdx );
+        if( block.size == 0 )
+            vbo.freeBlocks.erase( vbo.freeBlocks.begin() + blockIdx );
 
-        outVboIdx       = bestVboIdx;
-        outBufferOffset = newOffset;
+        return newOffset;
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::deallocateVbo( size_t vboIdx, size_t bufferOffset, size_t sizeBytes,
@@ -1088,10 +1347,10 @@ namespace Ogre
         OCGE( glBindBuffer( GL_ARRAY_BUFFER, 0 ) );
     }
     //-----------------------------------------------------------------------------------
-    VertexArrayObject* GL3PlusVaoManager::createVertexArrayObjectImpl(
-                                                            const VertexBufferPackedVec &vertexBuffers,
-                                                            IndexBufferPacked *indexBuffer,
-                                                            OperationType opType )
+    GL3PlusVaoManager::VaoVec::iterator GL3PlusVaoManager::findVao(
+                                                        const VertexBufferPackedVec &vertexBuffers,
+                                                        IndexBufferPacked *indexBuffer,
+                                                        OperationType opType )
     {
         Vao vao;
 
@@ -1165,6 +1424,37 @@ namespace Ogre
             itor = mVaos.begin() + mVaos.size() - 1;
         }
 
+        ++itor->refCount;
+
+        return itor;
+    }
+    //-----------------------------------------------------------------------------------
+    void GL3PlusVaoManager::releaseVao( VertexArrayObject *vao )
+    {
+        GL3PlusVertexArrayObject *glVao = static_cast<GL3PlusVertexArrayObject*>( vao );
+
+        VaoVec::iterator itor = mVaos.begin();
+        VaoVec::iterator end  = mVaos.end();
+
+        while( itor != end && itor->vaoName != glVao->getVaoName() )
+            ++itor;
+
+        if( itor != end )
+        {
+            --itor->refCount;
+
+            if( !itor->refCount )
+            {
+                GLuint vaoName = glVao->getVaoName();
+                OCGE( glDeleteVertexArrays( 1, &vaoName ) );
+
+                efficientVectorRemove( mVaos, itor );
+            }
+        }
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 GL3PlusVaoManager::generateRenderQueueId( uint32 vaoName, uint32 uniqueVaoId )
+    {
         //Mix mNumGeneratedVaos with the GL Vao for better sorting purposes:
         //  If we only use the GL's vao, the RQ will sort Meshes with
         //  multiple submeshes mixed with other meshes.
@@ -1189,8 +1479,27 @@ namespace Ogre
         const uint32 shiftVaoGl     = RqBits::MeshBits - bitsVaoGl;
 
         uint32 renderQueueId =
-                ( (itor->vaoName & maskVaoGl) << shiftVaoGl ) |
-                (mNumGeneratedVaos & maskVao);
+                ( (vaoName & maskVaoGl) << shiftVaoGl ) |
+                (uniqueVaoId & maskVao);
+
+        return renderQueueId;
+    }
+    //-----------------------------------------------------------------------------------
+    uint32 GL3PlusVaoManager::extractUniqueVaoIdFromRenderQueueId( uint32 rqId )
+    {
+        const int bitsVaoGl  = 5;
+        const uint32 maskVao = OGRE_RQ_MAKE_MASK( RqBits::MeshBits - bitsVaoGl );
+        return rqId & maskVao;
+    }
+    //-----------------------------------------------------------------------------------
+    VertexArrayObject* GL3PlusVaoManager::createVertexArrayObjectImpl(
+                                                            const VertexBufferPackedVec &vertexBuffers,
+                                                            IndexBufferPacked *indexBuffer,
+                                                            OperationType opType )
+    {
+        VaoVec::iterator itor = findVao( vertexBuffers, indexBuffer, opType );
+
+        const uint32 renderQueueId = generateRenderQueueId( itor->vaoName, mNumGeneratedVaos );
 
         GL3PlusVertexArrayObject *retVal = OGRE_NEW GL3PlusVertexArrayObject( itor->vaoName,
                                                                               renderQueueId,
@@ -1198,35 +1507,15 @@ namespace Ogre
                                                                               indexBuffer,
                                                                               opType );
 
-        ++itor->refCount;
-
         return retVal;
     }
     //-----------------------------------------------------------------------------------
     void GL3PlusVaoManager::destroyVertexArrayObjectImpl( VertexArrayObject *vao )
     {
-        GL3PlusVertexArrayObject *glVao = static_cast<GL3PlusVertexArrayObject*>( vao );
-
-        VaoVec::iterator itor = mVaos.begin();
-        VaoVec::iterator end  = mVaos.end();
-
-        while( itor != end && itor->vaoName != glVao->getVaoName() )
-            ++itor;
-
-        if( itor != end )
-        {
-            --itor->refCount;
-
-            if( !itor->refCount )
-            {
-                GLuint vaoName = glVao->getVaoName();
-                OCGE( glDeleteVertexArrays( 1, &vaoName ) );
-
-                efficientVectorRemove( mVaos, itor );
-            }
-        }
+        releaseVao( vao );
 
         //We delete it here because this class has no virtual destructor on purpose
+        GL3PlusVertexArrayObject *glVao = static_cast<GL3PlusVertexArrayObject*>( vao );
         OGRE_DELETE glVao;
     }
     //-----------------------------------------------------------------------------------
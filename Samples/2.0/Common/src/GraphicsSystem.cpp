@@ -625,13 +625,34 @@ namespace Demo
                     Ogre::Hlms *hlms = hlmsManager->getHlms( static_cast<Ogre::HlmsTypes>( i ) );
                     if( hlms )
                     {
-                        diskCache.copyFrom( hlms );
+                        Ogre::String filename = "hlmsDiskCache" +
+                                                Ogre::StringConverter::toString( i ) + ".bin";
 
-                        Ogre::DataStreamPtr diskCacheFile =
-                                rwAccessFolderArchive->create( "hlmsDiskCache" +
-                                                               Ogre::StringConverter::toString( i ) +
-                                                               ".bin" );
-                        diskCache.saveTo( diskCacheFile );
+                        //Merge with what's on disk, in case another run (or another
+                        //process sharing the folder) saved permutations we haven't seen.
+                        diskCache.clearCache();
+                        try
+                        {
+                            if( rwAccessFolderArchive->exists( filename ) )
+                            {
+                                Ogre::DataStreamPtr oldCacheFile =
+                                        rwAccessFolderArchive->open( filename );
+                                diskCache.loadFrom( oldCacheFile );
+                            }
+                        }
+                        catch( Ogre::Exception& )
+                        {
+                            diskCache.clearCache();
+                        }
+
+                        diskCache.mergeFrom( hlms );
+
+                        if( diskCache.isDirty() )
+                        {
+                            Ogre::DataStreamPtr diskCacheFile =
+                                    rwAccessFolderArchive->create( filename );
+                            diskCache.saveTo( diskCacheFile );
+                        }
                     }
                 }
             }
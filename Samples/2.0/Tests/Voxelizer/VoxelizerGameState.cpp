@@ -507,7 +507,10 @@ namespace Demo
         //        }
 
         if( getGiMode() == IfdVct || getGiMode() == IfdOnly )
+        {
+            mIrradianceField->setUpdateFocus( mGraphicsSystem->getCamera()->getDerivedPosition() );
             mIrradianceField->update( mUseRasterIrradianceField ? 4u : 200u );
+        }
         TutorialGameState::update( timeSinceLast );
     }
     //-----------------------------------------------------------------------------------
@@ -86,6 +86,11 @@ namespace Demo
                     Ogre::StringConverter::toString( 8u * 1024u * 1024u );
             params["VaoManager::CPU_ACCESSIBLE_PERSISTENT_COHERENT"] =
                     Ogre::StringConverter::toString( 4u * 1024u * 1024u );
+            //Used by GL3+: Pack all static meshes into one big buffer of this size
+            //(overrides CPU_INACCESSIBLE) so that different meshes sharing the same
+            //vertex format can be rendered in the same multi-draw indirect call.
+            //params["VaoManager::StaticMegaBufferSize"] =
+            //        Ogre::StringConverter::toString( 256u * 1024u * 1024u );
 
             //Used by D3D11
             params["VaoManager::VERTEX_IMMUTABLE"] =
@@ -44,7 +44,8 @@ namespace Demo
         mAnimateObjects( true ),
         mNumSpheres( 0 ),
         mKernelRadius( 1.0f ),
-        mPowerScale( 1.5f )
+        mPowerScale( 1.5f ),
+        mFrameIdx( 0u )
 	{
         memset( mSceneNode, 0, sizeof(mSceneNode) );
 	}
@@ -338,6 +339,17 @@ namespace Demo
         Ogre::GpuProgramParametersSharedPtr psParamsBlurV = passBlurV->getFragmentProgramParameters();
         psParamsBlurV->setNamedConstant( "projectionParams", projectionAB );
 
+		//Set temporal accumulation shader uniforms
+		Ogre::MaterialPtr materialTemporal = Ogre::MaterialManager::getSingleton().load(
+			"SSAO/Temporal",
+			Ogre::ResourceGroupManager::
+			AUTODETECT_RESOURCE_GROUP_NAME).staticCast<Ogre::Material>();
+
+		Ogre::Pass *passTemporal = materialTemporal->getTechnique(0)->getPass(0);
+        Ogre::GpuProgramParametersSharedPtr psParamsTemporal =
+                passTemporal->getFragmentProgramParameters();
+        psParamsTemporal->setNamedConstant( "projectionParams", projectionAB );
+
 		//Set apply shader uniforms
 		Ogre::MaterialPtr materialApply = Ogre::MaterialManager::getSingleton().load(
 			"SSAO/Apply",
@@ -359,6 +371,14 @@ namespace Demo
 		psParams->setNamedConstant("projection", mGraphicsSystem->getCamera()->getProjectionMatrix());
 		psParams->setNamedConstant("kernelRadius", mKernelRadius);
 
+        //Rotate the noise by the golden angle every frame so that
+        //SSAO/Temporal accumulates a different set of samples each time
+        const Ogre::Radian noiseAngle( Ogre::Real( mFrameIdx % 64u ) * 2.39996323f );
+        psParams->setNamedConstant( "noiseRotation",
+                                    Ogre::Vector2( Ogre::Math::Cos( noiseAngle ),
+                                                   Ogre::Math::Sin( noiseAngle ) ) );
+        ++mFrameIdx;
+
 		Ogre::GpuProgramParametersSharedPtr psParamsApply = mApplyPass->getFragmentProgramParameters();
 		psParamsApply->setNamedConstant("powerScale", mPowerScale);
 
@@ -25,6 +25,8 @@ namespace Demo
 		float mKernelRadius;
 		float mPowerScale;
 
+		Ogre::uint32 mFrameIdx;
+
 		virtual void generateDebugText(float timeSinceLast, Ogre::String &outText);
 
     public:
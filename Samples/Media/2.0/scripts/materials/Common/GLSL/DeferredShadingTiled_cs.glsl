@@ -0,0 +1,185 @@
+#version 430
+
+//Tiled deferred shading of Forward+ lights (point & spot). Each threadgroup is one
+//screen tile: it finds the tile's depth range, culls the Forward+ global light list
+//against the tile's view space bounds, and then shades every pixel of the tile with
+//the surviving lights, adding the result on top of the forward colour written by the
+//render_scene pass with gen_gbuffer.
+//The light list layout follows ForwardPlusBase::fillGlobalLightListBuffer
+//(6 float4 per light, in view space) and is bound by the compute pass via
+//forward_plus_lights.
+
+uniform sampler2D depthTexture;
+uniform sampler2D gBufNormals;
+uniform sampler2D gBufAlbedo;
+uniform sampler2D gBufF0Roughness;
+uniform sampler2D forwardColour;
+uniform samplerBuffer lightList;
+
+layout (rgba16f) uniform restrict writeonly image2D dstTex;
+
+uniform uint numLights;
+uniform vec2 projectionParams;
+uniform vec4 frustumExtents;
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+#define MAX_LIGHTS_PER_TILE @value( max_lights_per_tile )
+
+//Linear depth is always positive, thus its bits can be compared as uints
+shared uint g_minDepth;
+shared uint g_maxDepth;
+shared uint g_numTileLights;
+shared uint g_tileLights[MAX_LIGHTS_PER_TILE];
+
+/// Same as the Default BRDF from HlmsPbs (without GGX_height_correlated nor
+/// fresnel_separate_diffuse) since that's what the lights would've used in forward.
+vec3 BRDF( vec3 lightDir, vec3 viewDir, float NdotV, vec3 lightDiffuse, vec3 lightSpecular,
+		   vec3 normal, vec3 diffuse, vec3 F0, float roughness )
+{
+	vec3 halfWay = normalize( lightDir + viewDir );
+	float NdotL = clamp( dot( normal, lightDir ), 0.0, 1.0 );
+	float NdotH = clamp( dot( normal, halfWay ), 0.0, 1.0 );
+	float VdotH = clamp( dot( viewDir, halfWay ), 0.0, 1.0 );
+
+	float sqR = roughness * roughness;
+
+	float f = ( NdotH * sqR - NdotH ) * NdotH + 1.0;
+	float R = sqR / (f * f + 1e-6f);
+
+	float gL = NdotL * (1.0 - sqR) + sqR;
+	float gV = NdotV * (1.0 - sqR) + sqR;
+	float G = 1.0 / (( gL * gV + 1e-4f ) * 4.0 * 3.141592654);
+
+	vec3 fresnelS = F0 + pow( 1.0 - VdotH, 5.0 ) * (1.0 - F0);
+
+	vec3 Rs = ( fresnelS * (R * G) ) * lightSpecular;
+
+	float energyBias	= roughness * 0.5;
+	float energyFactor	= mix( 1.0, 1.0 / 1.51, roughness );
+	float fd90			= energyBias + 2.0 * VdotH * VdotH * roughness;
+	float lightScatter	= 1.0 + (fd90 - 1.0) * pow( 1.0 - NdotL, 5.0 );
+	float viewScatter	= 1.0 + (fd90 - 1.0) * pow( 1.0 - NdotV, 5.0 );
+
+	float fresnelD = 1.0 - max( fresnelS.x, max( fresnelS.y, fresnelS.z ) );
+
+	vec3 Rd = (lightScatter * viewScatter * energyFactor * fresnelD) * diffuse * lightDiffuse;
+
+	return NdotL * (Rs + Rd);
+}
+
+void main()
+{
+	ivec2 pixel = ivec2( gl_GlobalInvocationID.xy );
+	ivec2 dstSize = imageSize( dstTex );
+	bool inBounds = pixel.x < dstSize.x && pixel.y < dstSize.y;
+
+	if( gl_LocalInvocationIndex == 0u )
+	{
+		g_minDepth = 0x7F7FFFFFu;
+		g_maxDepth = 0u;
+		g_numTileLights = 0u;
+	}
+	barrier();
+
+	ivec2 loadPos = min( pixel, dstSize - 1 );
+	float fDepth = texelFetch( depthTexture, loadPos, 0 ).x;
+	float linearDepth = projectionParams.y / (fDepth - projectionParams.x);
+
+	atomicMin( g_minDepth, floatBitsToUint( linearDepth ) );
+	atomicMax( g_maxDepth, floatBitsToUint( linearDepth ) );
+	barrier();
+
+	//Tile bounds in view space. Row 0 is the top of the screen.
+	vec2 invDstSize = 1.0 / vec2( dstSize );
+	vec2 tileStart = vec2( gl_WorkGroupID.xy * gl_WorkGroupSize.xy ) * invDstSize;
+	vec2 tileEnd = vec2( (gl_WorkGroupID.xy + 1u) * gl_WorkGroupSize.xy ) * invDstSize;
+
+	vec2 tanStart = vec2( mix( frustumExtents.x, frustumExtents.y, tileStart.x ),
+						  mix( frustumExtents.z, frustumExtents.w, tileStart.y ) );
+	vec2 tanEnd = vec2( mix( frustumExtents.x, frustumExtents.y, tileEnd.x ),
+						mix( frustumExtents.z, frustumExtents.w, tileEnd.y ) );
+	vec2 tanMin = min( tanStart, tanEnd );
+	vec2 tanMax = max( tanStart, tanEnd );
+
+	float tileMinDepth = uintBitsToFloat( g_minDepth );
+	float tileMaxDepth = uintBitsToFloat( g_maxDepth );
+
+	vec3 aabbMin = vec3( min( tanMin * tileMinDepth, tanMin * tileMaxDepth ), -tileMaxDepth );
+	vec3 aabbMax = vec3( max( tanMax * tileMinDepth, tanMax * tileMaxDepth ), -tileMinDepth );
+
+	for( uint i=gl_LocalInvocationIndex; i<numLights; i += uint( NUM_THREADS ) )
+	{
+		vec4 posAndType = texelFetch( lightList, int( i * 6u ) );
+		float range = texelFetch( lightList, int( i * 6u + 3u ) ).x;
+
+		vec3 closest = clamp( posAndType.xyz, aabbMin, aabbMax ) - posAndType.xyz;
+		if( dot( closest, closest ) <= range * range )
+		{
+			uint idx = atomicAdd( g_numTileLights, 1u );
+			if( idx < uint( MAX_LIGHTS_PER_TILE ) )
+				g_tileLights[idx] = i;
+		}
+	}
+	barrier();
+
+	if( !inBounds )
+		return;
+
+	vec4 finalColour = texelFetch( forwardColour, pixel, 0 );
+	vec4 f0Roughness = texelFetch( gBufF0Roughness, pixel, 0 );
+	vec3 diffuse = texelFetch( gBufAlbedo, pixel, 0 ).xyz;
+	vec3 normal = normalize( texelFetch( gBufNormals, pixel, 0 ).xyz * 2.0 - 1.0 );
+
+	vec2 uv = (vec2( pixel ) + 0.5) * invDstSize;
+	vec3 pos = vec3( mix( frustumExtents.x, frustumExtents.y, uv.x ) * linearDepth,
+					 mix( frustumExtents.z, frustumExtents.w, uv.y ) * linearDepth,
+					 -linearDepth );
+	vec3 viewDir = normalize( -pos );
+	float NdotV = clamp( dot( normal, viewDir ), 0.0, 1.0 );
+	float roughness = max( f0Roughness.w, 0.02 );
+
+	uint numTileLights = min( g_numTileLights, uint( MAX_LIGHTS_PER_TILE ) );
+	for( uint i=0u; i<numTileLights; ++i )
+	{
+		int idx = int( g_tileLights[i] * 6u );
+
+		vec4 posAndType		= texelFetch( lightList, idx );
+		vec3 lightDiffuse	= texelFetch( lightList, idx + 1 ).xyz;
+		vec3 lightSpecular	= texelFetch( lightList, idx + 2 ).xyz;
+		vec4 attenuation	= texelFetch( lightList, idx + 3 );
+
+		vec3 lightDir	= posAndType.xyz - pos;
+		float fDistance	= length( lightDir );
+
+		if( fDistance <= attenuation.x )
+		{
+			lightDir *= 1.0 / fDistance;
+			float atten = 1.0 / (0.5 + (attenuation.y + attenuation.z * fDistance) * fDistance );
+			@property( fade_attenuation_range )
+				atten *= max( (attenuation.x - fDistance) * attenuation.w, 0.0f );
+			@end
+
+			if( posAndType.w == 2.0 )
+			{
+				//Spot light
+				vec3 spotDirection	= texelFetch( lightList, idx + 4 ).xyz;
+				vec3 spotParams		= texelFetch( lightList, idx + 5 ).xyz;
+
+				float spotCosAngle = dot( -lightDir, spotDirection );
+				float spotAtten = clamp( (spotCosAngle - spotParams.y) * spotParams.x, 0.0, 1.0 );
+				atten *= pow( spotAtten, spotParams.z );
+				if( spotCosAngle < spotParams.y )
+					atten = 0.0;
+			}
+
+			finalColour.xyz += BRDF( lightDir, viewDir, NdotV, lightDiffuse, lightSpecular,
+									 normal, diffuse, f0Roughness.xyz, roughness ) * atten;
+		}
+	}
+
+	imageStore( dstTex, pixel, finalColour );
+}
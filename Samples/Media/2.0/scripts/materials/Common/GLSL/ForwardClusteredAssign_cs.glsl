@@ -0,0 +1,245 @@
+#version 430
+
+//Bins the Forward+ lights, decals & cubemap probes into the ForwardClustered grid.
+//Each threadgroup is one grid tile (x, y); every thread walks one or more depth slices of
+//that tile and tests the whole global light list against the cell's view space bounds.
+//The tests are conservative (sphere / cone / box vs. cell AABB): a false positive only
+//costs some extra work in the pixel shader, which performs the real per pixel tests.
+//The light list layout follows ForwardPlusBase::fillGlobalLightListBuffer and the grid
+//layout is the same one ForwardClustered::collectLightForSlice writes on the CPU.
+
+uniform samplerBuffer lightList;
+@property( depth_bounds )
+uniform sampler2D depthTexture;
+@end
+
+//The grid is made of uint16 entries; we access them in pairs. Each cell has an even number
+//of entries, so no two cells share a word.
+layout(std430, binding = 0) restrict buffer gridLayout
+{
+	uint gridWords[];
+};
+
+uniform uint numLights;
+uniform uint numDecals;
+uniform uint numCubemapProbes;
+uniform uint decalFloat4Offset;
+uniform uint cubemapProbeFloat4Offset;
+//x = minDistance, y = exponentK, z = camera near, w = far depth of the last slice
+uniform vec4 sliceParams;
+uniform vec4 frustumExtents;
+uniform vec2 projectionParams;
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+
+#define GRID_WIDTH			@value( grid_width )u
+#define GRID_HEIGHT			@value( grid_height )u
+#define NUM_SLICES			@value( num_slices )u
+#define OBJS_PER_CELL		@value( objs_per_cell )u
+#define LIGHTS_PER_CELL		@value( lights_per_cell )u
+#define DECALS_PER_CELL		@value( decals_per_cell )u
+#define DECALS_OFFSET		@value( decals_offset )u
+#define PROBES_PER_CELL		@value( cubemap_probes_per_cell )u
+#define PROBES_OFFSET		@value( cubemap_probes_offset )u
+
+@property( depth_bounds )
+//Linear depth is always positive, thus its bits can be compared as uints
+shared uint g_maxDepth;
+@end
+
+void storeEntry( uint cellStart, uint entryIdx, uint value )
+{
+	uint idx = cellStart + entryIdx;
+	uint shift = (idx & 1u) * 16u;
+	uint word = gridWords[idx >> 1u];
+	gridWords[idx >> 1u] = (word & ~(0xFFFFu << shift)) | (value << shift);
+}
+
+/// Returns false if the 8 corners, once transformed by the 3 given rows, are all outside
+/// the box [-halfSize; halfSize] on the same side of an axis.
+bool cornersIntersectBox( vec3 corners[8], vec4 r0, vec4 r1, vec4 r2, vec3 offset, vec3 halfSize )
+{
+	vec3 localMin = vec3( 3.402823466e+38 );
+	vec3 localMax = vec3( -3.402823466e+38 );
+	for( int i=0; i<8; ++i )
+	{
+		vec3 c = corners[i] + offset;
+		vec3 local = vec3( dot( r0.xyz, c ), dot( r1.xyz, c ), dot( r2.xyz, c ) ) +
+					 vec3( r0.w, r1.w, r2.w );
+		localMin = min( localMin, local );
+		localMax = max( localMax, local );
+	}
+
+	return all( lessThanEqual( localMin, halfSize ) ) &&
+		   all( greaterThanEqual( localMax, -halfSize ) );
+}
+
+void main()
+{
+	uvec2 tile = gl_WorkGroupID.xy;
+
+	float tileMaxDepth = 3.402823466e+38;
+@property( depth_bounds )
+	//Only the farthest depth is used: transparent objects can be in front of the
+	//depth prepass but never behind it, so cells behind the farthest opaque surface
+	//can't be lit by anything.
+	if( gl_LocalInvocationIndex == 0u )
+		g_maxDepth = 0u;
+	barrier();
+
+	//The grid's row 0 is at the bottom of the screen; the texture's is at the top
+	ivec2 depthSize = textureSize( depthTexture, 0 );
+	ivec2 pixelStart = ivec2( (tile.x * uint( depthSize.x )) / GRID_WIDTH,
+							  ((GRID_HEIGHT - 1u - tile.y) * uint( depthSize.y )) / GRID_HEIGHT );
+	ivec2 pixelEnd = ivec2( ((tile.x + 1u) * uint( depthSize.x )) / GRID_WIDTH,
+							((GRID_HEIGHT - tile.y) * uint( depthSize.y )) / GRID_HEIGHT );
+	ivec2 tileSize = max( pixelEnd - pixelStart, ivec2( 1 ) );
+	uint numPixels = uint( tileSize.x * tileSize.y );
+
+	float localMaxDepth = 0.0;
+	for( uint i=gl_LocalInvocationIndex; i<numPixels; i += uint( NUM_THREADS ) )
+	{
+		ivec2 pixel = pixelStart + ivec2( int( i ) % tileSize.x, int( i ) / tileSize.x );
+		pixel = min( pixel, depthSize - 1 );
+		float fDepth = texelFetch( depthTexture, pixel, 0 ).x;
+		localMaxDepth = max( localMaxDepth, projectionParams.y / (fDepth - projectionParams.x) );
+	}
+	atomicMax( g_maxDepth, floatBitsToUint( localMaxDepth ) );
+	barrier();
+
+	tileMaxDepth = uintBitsToFloat( g_maxDepth );
+@end
+
+	//Tangents of the tile's edges. Dividing by the grid size is the same
+	//as ForwardClustered::collectLightForSlice subdividing the frustum.
+	vec2 tanStart = vec2( mix( frustumExtents.x, frustumExtents.y, float( tile.x ) / float( GRID_WIDTH ) ),
+						  mix( frustumExtents.w, frustumExtents.z, float( tile.y ) / float( GRID_HEIGHT ) ) );
+	vec2 tanEnd = vec2( mix( frustumExtents.x, frustumExtents.y, float( tile.x + 1u ) / float( GRID_WIDTH ) ),
+						mix( frustumExtents.w, frustumExtents.z, float( tile.y + 1u ) / float( GRID_HEIGHT ) ) );
+	vec2 tanMin = min( tanStart, tanEnd );
+	vec2 tanMax = max( tanStart, tanEnd );
+
+	for( uint slice=gl_LocalInvocationIndex; slice<NUM_SLICES; slice += uint( NUM_THREADS ) )
+	{
+		float cellNear = slice == 0u ? sliceParams.z :
+										 exp2( sliceParams.y * float( slice ) ) + sliceParams.x;
+		float cellFar = slice == NUM_SLICES - 1u ? sliceParams.w :
+							exp2( sliceParams.y * float( slice + 1u ) ) + sliceParams.x;
+		cellFar = min( cellFar, tileMaxDepth );
+
+		uint cellIdx = (slice * GRID_HEIGHT + tile.y) * GRID_WIDTH + tile.x;
+		uint cellStart = cellIdx * OBJS_PER_CELL;
+
+		uint numPoint = 0u;
+		uint numSpot = 0u;
+		uint numVpl = 0u;
+		uint numCellDecals = 0u;
+		uint numCellProbes = 0u;
+
+		if( cellNear <= cellFar )
+		{
+			vec3 aabbMin = vec3( min( tanMin * cellNear, tanMin * cellFar ), -cellFar );
+			vec3 aabbMax = vec3( max( tanMax * cellNear, tanMax * cellFar ), -cellNear );
+
+			vec3 sphereCenter = (aabbMin + aabbMax) * 0.5;
+			float sphereRadius = length( aabbMax - sphereCenter );
+
+			uint numCellLights = 0u;
+			for( uint i=0u; i<numLights && numCellLights < LIGHTS_PER_CELL; ++i )
+			{
+				vec4 posAndType = texelFetch( lightList, int( i * 6u ) );
+				float range = texelFetch( lightList, int( i * 6u + 3u ) ).x;
+
+				vec3 closest = clamp( posAndType.xyz, aabbMin, aabbMax ) - posAndType.xyz;
+				bool bIntersects = dot( closest, closest ) <= range * range;
+
+				if( bIntersects && posAndType.w == 2.0 )
+				{
+					//Spot light. Cone vs the cell's bounding sphere
+					vec3 spotDirection = texelFetch( lightList, int( i * 6u + 4u ) ).xyz;
+					float cosAngle = texelFetch( lightList, int( i * 6u + 5u ) ).y;
+					float sinAngle = sqrt( max( 1.0 - cosAngle * cosAngle, 0.0 ) );
+
+					vec3 v = sphereCenter - posAndType.xyz;
+					float vLenSq = dot( v, v );
+					float v1Len = dot( v, spotDirection );
+					float distClosest = cosAngle * sqrt( max( vLenSq - v1Len * v1Len, 0.0 ) ) -
+										v1Len * sinAngle;
+					bIntersects = distClosest <= sphereRadius &&
+								  v1Len <= sphereRadius + range && v1Len >= -sphereRadius;
+				}
+
+				if( bIntersects )
+				{
+					storeEntry( cellStart, 3u + numCellLights, i * 6u );
+					++numCellLights;
+					if( posAndType.w == 1.0 )
+						++numPoint;
+					else if( posAndType.w == 2.0 )
+						++numSpot;
+					else
+						++numVpl;
+				}
+			}
+
+			vec3 corners[8];
+			corners[0] = vec3( tanStart.x * cellNear, tanStart.y * cellNear, -cellNear );
+			corners[1] = vec3( tanEnd.x * cellNear, tanStart.y * cellNear, -cellNear );
+			corners[2] = vec3( tanEnd.x * cellNear, tanEnd.y * cellNear, -cellNear );
+			corners[3] = vec3( tanStart.x * cellNear, tanEnd.y * cellNear, -cellNear );
+			corners[4] = vec3( tanStart.x * cellFar, tanStart.y * cellFar, -cellFar );
+			corners[5] = vec3( tanEnd.x * cellFar, tanStart.y * cellFar, -cellFar );
+			corners[6] = vec3( tanEnd.x * cellFar, tanEnd.y * cellFar, -cellFar );
+			corners[7] = vec3( tanStart.x * cellFar, tanEnd.y * cellFar, -cellFar );
+
+		@property( decals_per_cell )
+			//Decals: invWorldView takes view space to the decal's unit cube
+			for( uint i=0u; i<numDecals && numCellDecals < DECALS_PER_CELL; ++i )
+			{
+				uint offset = decalFloat4Offset + i * 4u;
+				if( cornersIntersectBox( corners, texelFetch( lightList, int( offset ) ),
+										 texelFetch( lightList, int( offset + 1u ) ),
+										 texelFetch( lightList, int( offset + 2u ) ),
+										 vec3( 0.0 ), vec3( 0.5 ) ) )
+				{
+					storeEntry( cellStart, DECALS_OFFSET + 1u + numCellDecals, offset );
+					++numCellDecals;
+				}
+			}
+		@end
+
+		@property( cubemap_probes_per_cell )
+			//Probes: rotation to probe space in xyz, probe shape's center (view space) in w
+			for( uint i=0u; i<numCubemapProbes && numCellProbes < PROBES_PER_CELL; ++i )
+			{
+				uint offset = cubemapProbeFloat4Offset + i * 8u;
+				vec4 r0 = texelFetch( lightList, int( offset ) );
+				vec4 r1 = texelFetch( lightList, int( offset + 1u ) );
+				vec4 r2 = texelFetch( lightList, int( offset + 2u ) );
+				vec3 halfSize = texelFetch( lightList, int( offset + 3u ) ).xyz;
+				if( cornersIntersectBox( corners, vec4( r0.xyz, 0.0 ), vec4( r1.xyz, 0.0 ),
+										 vec4( r2.xyz, 0.0 ), -vec3( r0.w, r1.w, r2.w ),
+										 halfSize ) )
+				{
+					storeEntry( cellStart, PROBES_OFFSET + 1u + numCellProbes, offset );
+					++numCellProbes;
+				}
+			}
+		@end
+		}
+
+		storeEntry( cellStart, 0u, numPoint );
+		storeEntry( cellStart, 1u, numPoint + numSpot );
+		storeEntry( cellStart, 2u, numPoint + numSpot + numVpl );
+	@property( decals_per_cell )
+		storeEntry( cellStart, DECALS_OFFSET, numCellDecals );
+	@end
+	@property( cubemap_probes_per_cell )
+		storeEntry( cellStart, PROBES_OFFSET, numCellProbes );
+	@end
+	}
+}
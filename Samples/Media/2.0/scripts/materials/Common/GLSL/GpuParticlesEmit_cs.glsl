@@ -0,0 +1,227 @@
+#version 430
+
+//Emits the particles requested this frame by the emitters of a ParticleSystem simulated by
+//GpuParticleSimulator. Each thread is one new particle: it takes a slot from the dead list
+//and initialises the particle with the same math as the emitters' _initParticle (plus
+//RotationAffector::_initParticle) and ParticleSystem::_executeTriggerEmitters.
+//The layout of the params & particles is documented in GpuParticleSimulator.cpp
+
+uniform samplerBuffer paramsBuffer;
+
+layout(std430, binding = 0) restrict buffer particlesLayout
+{
+	vec4 particles[];
+};
+
+layout(std430, binding = 1) restrict buffer deadListLayout
+{
+	uint deadList[];
+};
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+#define HEADER_FLOAT4	10u
+#define EMITTER_FLOAT4	10u
+#define AFFECTOR_FLOAT4	3u
+#define MAX_EMITTERS	16u
+
+#define EMITTER_BOX					1u
+#define EMITTER_ELLIPSOID			2u
+#define EMITTER_CYLINDER			3u
+#define EMITTER_RING				4u
+#define EMITTER_HOLLOW_ELLIPSOID	5u
+
+#define AFFECTOR_ROTATOR	3u
+
+#define fetchParams( idx ) texelFetch( paramsBuffer, int( idx ) )
+
+uint pcgHash( uint v )
+{
+	uint state = v * 747796405u + 2891336453u;
+	uint word = ((state >> ((state >> 28u) + 4u)) ^ state) * 277803737u;
+	return (word >> 22u) ^ word;
+}
+
+/// [0; 1)
+float unitRandom( inout uint seed )
+{
+	seed = pcgHash( seed );
+	return float( seed >> 8u ) * (1.0 / 16777216.0);
+}
+
+/// [-1; 1)
+float symmetricRandom( inout uint seed )
+{
+	return unitRandom( seed ) * 2.0 - 1.0;
+}
+
+/// Rotates v around the (normalised) axis. Same as Quaternion::FromAngleAxis * v
+vec3 rotateAround( vec3 v, vec3 axis, float angle )
+{
+	float c = cos( angle );
+	float s = sin( angle );
+	return v * c + cross( axis, v ) * s + axis * (dot( axis, v ) * (1.0 - c));
+}
+
+/// Same as Vector3::perpendicular
+vec3 perpendicular( vec3 v )
+{
+	vec3 perp = cross( v, vec3( 1.0, 0.0, 0.0 ) );
+	if( dot( perp, perp ) < 1e-12 )
+		perp = cross( v, vec3( 0.0, 1.0, 0.0 ) );
+	return normalize( perp );
+}
+
+/// Same as Vector3::randomDeviant
+vec3 randomDeviant( vec3 dir, vec3 up, float angle, inout uint seed )
+{
+	up = rotateAround( up, dir, unitRandom( seed ) * 6.283185307 );
+	return rotateAround( dir, up, angle );
+}
+
+void main()
+{
+	vec4 header0 = fetchParams( 0u );
+	vec4 header1 = fetchParams( 1u );
+	uint numEmitters	= floatBitsToUint( header0.x );
+	uint numAffectors	= floatBitsToUint( header0.y );
+	uint quota			= floatBitsToUint( header0.z );
+	uint seed			= floatBitsToUint( header0.w );
+	float timeElapsed	= header1.x;
+	uint totalEmit		= floatBitsToUint( header1.y );
+
+	uint emitIdx = gl_GlobalInvocationID.x;
+	if( emitIdx >= totalEmit )
+		return;
+
+	//Take a dead particle. If there are none (or other threads took the last ones
+	//and made the counter wrap around) the quota has been reached
+	uint numDead = atomicAdd( deadList[0], 0xFFFFFFFFu );
+	if( numDead == 0u || numDead > quota )
+	{
+		atomicAdd( deadList[0], 1u );
+		return;
+	}
+	uint slot = deadList[numDead];
+
+	//Find the emitter this thread emits for
+	uint emitterStart = HEADER_FLOAT4;
+	uint emitStart = 0u;
+	uint emitCount = 1u;
+	for( uint i=0u; i<numEmitters; ++i )
+	{
+		vec4 e0 = fetchParams( HEADER_FLOAT4 + i * EMITTER_FLOAT4 );
+		emitStart = floatBitsToUint( e0.z );
+		emitCount = floatBitsToUint( e0.y );
+		emitterStart = HEADER_FLOAT4 + i * EMITTER_FLOAT4;
+		if( emitIdx < emitStart + emitCount )
+			break;
+	}
+
+	vec4 e0 = fetchParams( emitterStart );
+	vec4 e1 = fetchParams( emitterStart + 1u );
+	vec4 e2 = fetchParams( emitterStart + 2u );
+	vec4 e3 = fetchParams( emitterStart + 3u );
+	vec4 e4 = fetchParams( emitterStart + 4u );
+	vec4 e5 = fetchParams( emitterStart + 5u );
+	vec4 e6 = fetchParams( emitterStart + 6u );
+	vec4 e7 = fetchParams( emitterStart + 7u );
+
+	uint typeAndFlags = floatBitsToUint( e0.x );
+	uint type = typeAndFlags & 0xFFu;
+	float angle = e0.w;
+
+	uint rng = pcgHash( emitIdx + pcgHash( seed ) );
+
+	//Position within the emitter's area, in units of its x, y & z ranges
+	vec3 areaPos = vec3( 0.0 );
+	if( type == EMITTER_BOX )
+	{
+		areaPos = vec3( symmetricRandom( rng ), symmetricRandom( rng ), symmetricRandom( rng ) );
+	}
+	else if( type == EMITTER_ELLIPSOID || type == EMITTER_CYLINDER )
+	{
+		//Random point inside the bounding sphere / cylinder of radius 1
+		for( int i=0; i<16; ++i )
+		{
+			areaPos = vec3( symmetricRandom( rng ), symmetricRandom( rng ), symmetricRandom( rng ) );
+			float distSq = type == EMITTER_ELLIPSOID ? dot( areaPos, areaPos ) :
+													   dot( areaPos.xy, areaPos.xy );
+			if( distSq <= 1.0 )
+				break;
+		}
+	}
+	else if( type == EMITTER_RING )
+	{
+		float alpha = unitRandom( rng ) * 6.283185307;
+		float a = mix( e5.w, 1.0, unitRandom( rng ) );
+		float b = mix( e6.w, 1.0, unitRandom( rng ) );
+		areaPos = vec3( a * sin( alpha ), b * cos( alpha ), symmetricRandom( rng ) );
+	}
+	else if( type == EMITTER_HOLLOW_ELLIPSOID )
+	{
+		float alpha = unitRandom( rng ) * 6.283185307;
+		float beta = unitRandom( rng ) * 3.141592654;
+		vec3 radius = mix( vec3( e5.w, e6.w, e7.w ), vec3( 1.0 ),
+						   vec3( unitRandom( rng ), unitRandom( rng ), unitRandom( rng ) ) );
+		float sinBeta = sin( beta );
+		areaPos = radius * vec3( cos( alpha ) * sinBeta, sin( alpha ) * sinBeta, cos( beta ) );
+	}
+
+	vec3 pos = e1.xyz + areaPos.x * e4.xyz + areaPos.y * e5.xyz + areaPos.z * e6.xyz;
+
+	vec4 colour = mix( fetchParams( emitterStart + 8u ), fetchParams( emitterStart + 9u ),
+					   vec4( unitRandom( rng ), unitRandom( rng ), unitRandom( rng ), unitRandom( rng ) ) );
+
+	vec3 dir;
+	if( (typeAndFlags & 256u) != 0u )
+	{
+		//Away from the dir position reference
+		dir = pos - e7.xyz;
+		float len = length( dir );
+		dir = len > 0.0 ? dir / len : dir;
+		if( angle != 0.0 && len > 0.0 )
+			dir = randomDeviant( dir, perpendicular( dir ), unitRandom( rng ) * angle, rng );
+	}
+	else
+	{
+		dir = e2.xyz;
+		if( angle != 0.0 )
+			dir = randomDeviant( dir, e3.xyz, unitRandom( rng ) * angle, rng );
+	}
+
+	dir *= mix( e1.w, e2.w, unitRandom( rng ) );
+	float ttl = mix( e3.w, e4.w, unitRandom( rng ) );
+
+	//To simulation space
+	vec4 r0 = fetchParams( 2u );
+	vec4 r1 = fetchParams( 3u );
+	vec4 r2 = fetchParams( 4u );
+	pos = vec3( dot( r0.xyz, pos ), dot( r1.xyz, pos ), dot( r2.xyz, pos ) ) + vec3( r0.w, r1.w, r2.w );
+	dir = vec3( dot( r0.xyz, dir ), dot( r1.xyz, dir ), dot( r2.xyz, dir ) );
+
+	//Spread the emissions over the frame
+	pos += dir * (timeElapsed * float( emitIdx - emitStart ) / float( emitCount ));
+
+	float rotation = 0.0;
+	float rotationSpeed = 0.0;
+	for( uint i=0u; i<numAffectors; ++i )
+	{
+		uint affectorStart = HEADER_FLOAT4 + MAX_EMITTERS * EMITTER_FLOAT4 + i * AFFECTOR_FLOAT4;
+		if( floatBitsToUint( fetchParams( affectorStart ).x ) == AFFECTOR_ROTATOR )
+		{
+			vec4 a1 = fetchParams( affectorStart + 1u );
+			rotation = mix( a1.z, a1.w, unitRandom( rng ) );
+			rotationSpeed = mix( a1.x, a1.y, unitRandom( rng ) );
+		}
+	}
+
+	uint dst = slot * 4u;
+	particles[dst + 0u] = vec4( pos, ttl );
+	//Flag it as born this frame, so the update job doesn't simulate it yet
+	particles[dst + 1u] = vec4( dir, -ttl - 1.0 );
+	particles[dst + 2u] = colour;
+	particles[dst + 3u] = vec4( fetchParams( 8u ).w, fetchParams( 9u ).w, rotation, rotationSpeed );
+}
@@ -0,0 +1,218 @@
+#version 430
+
+//Evaluates the skeletal animations of the SkeletonInstances sharing the same SkeletonDef.
+//Each threadgroup is one instance: it samples & blends the active animations of every bone,
+//walks the hierarchy one depth level at a time (keeping the derived transforms in shared
+//memory) and writes the final bone matrices (3 float4 per bone) where HlmsPbs expects them.
+//Same math as SkeletonTrack::applyKeyFrameRigAt & Bone::updateAllTransforms.
+//The layout of skeletonData & instanceData is documented in GpuSkeletonEvaluator::createSkeletonData
+
+uniform samplerBuffer skeletonData;
+uniform samplerBuffer instanceData;
+
+layout(std430, binding = 0) restrict writeonly buffer boneMatricesLayout
+{
+	vec4 boneMatrices[];
+};
+
+uniform uint numInstances;
+uniform uint groupsPerRow;
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+#define MAX_BONES @value( max_bones )
+
+struct Mat3x4
+{
+	vec4 r0;
+	vec4 r1;
+	vec4 r2;
+};
+
+shared vec4 g_derived[MAX_BONES * 3];
+
+#define fetchSkeleton( idx ) texelFetch( skeletonData, int( idx ) )
+#define fetchInstance( idx ) texelFetch( instanceData, int( idx ) )
+
+vec4 qmul( vec4 a, vec4 b )
+{
+	return vec4( a.w * b.xyz + b.w * a.xyz + cross( a.xyz, b.xyz ),
+				 a.w * b.w - dot( a.xyz, b.xyz ) );
+}
+
+vec4 nlerpShortest( float t, vec4 a, vec4 b )
+{
+	if( dot( a, b ) < 0.0 )
+		b = -b;
+	return normalize( mix( a, b, t ) );
+}
+
+Mat3x4 makeTransform( vec3 pos, vec3 scale, vec4 q )
+{
+	vec3 t2 = q.xyz + q.xyz;
+	vec3 tw = t2 * q.w;
+	float txx = t2.x * q.x;
+	float txy = t2.y * q.x;
+	float txz = t2.z * q.x;
+	float tyy = t2.y * q.y;
+	float tyz = t2.z * q.y;
+	float tzz = t2.z * q.z;
+
+	Mat3x4 m;
+	m.r0 = vec4( vec3( 1.0 - (tyy + tzz), txy - tw.z, txz + tw.y ) * scale, pos.x );
+	m.r1 = vec4( vec3( txy + tw.z, 1.0 - (txx + tzz), tyz - tw.x ) * scale, pos.y );
+	m.r2 = vec4( vec3( txz - tw.y, tyz + tw.x, 1.0 - (txx + tyy) ) * scale, pos.z );
+	return m;
+}
+
+Mat3x4 mulMat( Mat3x4 a, Mat3x4 b )
+{
+	Mat3x4 r;
+	r.r0 = a.r0.x * b.r0 + a.r0.y * b.r1 + a.r0.z * b.r2 + vec4( 0.0, 0.0, 0.0, a.r0.w );
+	r.r1 = a.r1.x * b.r0 + a.r1.y * b.r1 + a.r1.z * b.r2 + vec4( 0.0, 0.0, 0.0, a.r1.w );
+	r.r2 = a.r2.x * b.r0 + a.r2.y * b.r1 + a.r2.z * b.r2 + vec4( 0.0, 0.0, 0.0, a.r2.w );
+	return r;
+}
+
+/// See ArrayMatrixAf4x3::retain
+Mat3x4 retain( Mat3x4 m, uint flags )
+{
+	vec3 scale = vec3( length( m.r0.xyz ), length( m.r1.xyz ), length( m.r2.xyz ) );
+	vec3 invScale = vec3( scale.x != 0.0 ? 1.0 / scale.x : 0.0,
+						  scale.y != 0.0 ? 1.0 / scale.y : 0.0,
+						  scale.z != 0.0 ? 1.0 / scale.z : 0.0 );
+	if( (flags & 2u) == 0u )
+		scale = vec3( 1.0 );
+
+	vec3 row0 = (flags & 1u) != 0u ? m.r0.xyz * invScale.x : vec3( 1.0, 0.0, 0.0 );
+	vec3 row1 = (flags & 1u) != 0u ? m.r1.xyz * invScale.y : vec3( 0.0, 1.0, 0.0 );
+	vec3 row2 = (flags & 1u) != 0u ? m.r2.xyz * invScale.z : vec3( 0.0, 0.0, 1.0 );
+
+	m.r0.xyz = row0 * scale.x;
+	m.r1.xyz = row1 * scale.y;
+	m.r2.xyz = row2 * scale.z;
+	return m;
+}
+
+void main()
+{
+	uint instanceIdx = gl_WorkGroupID.y * groupsPerRow + gl_WorkGroupID.x;
+	if( instanceIdx >= numInstances )
+		return;
+
+	vec4 header = fetchSkeleton( 0u );
+	uint numBones		= floatBitsToUint( header.x );
+	uint numLevels		= floatBitsToUint( header.y );
+	uint trackDescStart	= floatBitsToUint( header.w );
+	uint boneDataStart	= 1u + ((numLevels + 4u) >> 2u);
+
+	uint instanceStart = instanceIdx * 8u;
+	vec4 instanceHeader = fetchInstance( instanceStart );
+	uint outputStart = floatBitsToUint( instanceHeader.x );
+	uint numActiveAnims = floatBitsToUint( instanceHeader.y );
+
+	Mat3x4 nodeMat;
+	nodeMat.r0 = fetchInstance( instanceStart + 1u );
+	nodeMat.r1 = fetchInstance( instanceStart + 2u );
+	nodeMat.r2 = fetchInstance( instanceStart + 3u );
+
+	for( uint level=0u; level<numLevels; ++level )
+	{
+		uint levelStart	= floatBitsToUint( fetchSkeleton( 1u + (level >> 2u) )[level & 3u] );
+		uint levelEnd	= floatBitsToUint( fetchSkeleton( 1u + ((level + 1u) >> 2u) )[(level + 1u) & 3u] );
+
+		for( uint bone=levelStart + gl_LocalInvocationIndex; bone<levelEnd; bone += uint( NUM_THREADS ) )
+		{
+			uint boneData = boneDataStart + bone * 6u;
+			vec4 posAndParent	= fetchSkeleton( boneData );
+			vec4 rot			= fetchSkeleton( boneData + 1u );
+			vec4 scaleAndFlags	= fetchSkeleton( boneData + 2u );
+
+			vec3 pos	= posAndParent.xyz;
+			vec3 scale	= scaleAndFlags.xyz;
+
+			for( uint i=0u; i<numActiveAnims; ++i )
+			{
+				vec4 anim = fetchInstance( instanceStart + 4u + i );
+				uint animIdx = floatBitsToUint( anim.x );
+				float frame = anim.y;
+				float weight = anim.z;
+
+				vec4 trackDesc = fetchSkeleton( trackDescStart + animIdx * numBones + bone );
+				uint firstKeyFrame = floatBitsToUint( trackDesc.x );
+				uint numKeyFrames = floatBitsToUint( trackDesc.y );
+
+				if( numKeyFrames == 0u )
+					continue;
+
+				//Find the last keyframe at or before frame
+				uint lo = 0u;
+				uint hi = numKeyFrames - 1u;
+				while( lo < hi )
+				{
+					uint mid = (lo + hi + 1u) >> 1u;
+					if( fetchSkeleton( firstKeyFrame + mid * 3u ).w <= frame )
+						lo = mid;
+					else
+						hi = mid - 1u;
+				}
+				uint prevKf = firstKeyFrame + lo * 3u;
+				uint nextKf = firstKeyFrame + min( lo + 1u, numKeyFrames - 1u ) * 3u;
+
+				vec4 prevPosFrame = fetchSkeleton( prevKf );
+				vec4 nextPosFrame = fetchSkeleton( nextKf );
+				float fTimeW = nextPosFrame.w > prevPosFrame.w ?
+								   clamp( (frame - prevPosFrame.w) / (nextPosFrame.w - prevPosFrame.w), 0.0, 1.0 ) :
+								   0.0;
+
+				vec3 interpPos = mix( prevPosFrame.xyz, nextPosFrame.xyz, fTimeW );
+				vec4 interpRot = nlerpShortest( fTimeW, fetchSkeleton( prevKf + 1u ),
+												fetchSkeleton( nextKf + 1u ) );
+				vec3 interpScale = mix( fetchSkeleton( prevKf + 2u ).xyz,
+										fetchSkeleton( nextKf + 2u ).xyz, fTimeW );
+
+				pos += interpPos * weight;
+				scale *= mix( vec3( 1.0 ), interpScale, weight );
+				rot = qmul( rot, nlerpShortest( weight, vec4( 0.0, 0.0, 0.0, 1.0 ), interpRot ) );
+			}
+
+			uint parentIdx = floatBitsToUint( posAndParent.w );
+			uint flags = floatBitsToUint( scaleAndFlags.w );
+
+			Mat3x4 derived = makeTransform( pos, scale, rot );
+			if( parentIdx != 0xFFFFFFFFu )
+			{
+				Mat3x4 parentMat;
+				parentMat.r0 = g_derived[parentIdx * 3u + 0u];
+				parentMat.r1 = g_derived[parentIdx * 3u + 1u];
+				parentMat.r2 = g_derived[parentIdx * 3u + 2u];
+				if( (flags & 3u) != 3u )
+					parentMat = retain( parentMat, flags );
+				derived = mulMat( parentMat, derived );
+			}
+
+			g_derived[bone * 3u + 0u] = derived.r0;
+			g_derived[bone * 3u + 1u] = derived.r1;
+			g_derived[bone * 3u + 2u] = derived.r2;
+
+			Mat3x4 reverseBind;
+			reverseBind.r0 = fetchSkeleton( boneData + 3u );
+			reverseBind.r1 = fetchSkeleton( boneData + 4u );
+			reverseBind.r2 = fetchSkeleton( boneData + 5u );
+
+			Mat3x4 finalMat = mulMat( nodeMat, mulMat( derived, reverseBind ) );
+
+			uint dst = outputStart + (flags >> 2u) * 3u;
+			boneMatrices[dst + 0u] = finalMat.r0;
+			boneMatrices[dst + 1u] = finalMat.r1;
+			boneMatrices[dst + 2u] = finalMat.r2;
+		}
+
+		//The next level reads its parents' derived transforms
+		memoryBarrierShared();
+		barrier();
+	}
+}
@@ -0,0 +1,76 @@
+#version 330
+
+//Reconstructs the object space normals of an impostor atlas from the depth buffer the
+//frames were rendered with, and packs them with the linear depth. See ImpostorManager.
+//packParams.x = frames per side (N); y = resolution of a frame; zw = linear depth = d * z + w
+//Frames are placed in an N x N grid indexed by their octahedral coordinates (Y up)
+
+uniform sampler2D depthTexture;
+uniform vec4 packParams;
+
+in block
+{
+	vec2 uv0;
+} inPs;
+
+out vec4 fragColour;
+
+float loadLinearDepth( ivec2 iUv )
+{
+	return texelFetch( depthTexture, iUv, 0 ).x * packParams.z + packParams.w;
+}
+
+//Returns the depth difference with the neighbour on the side with the smaller gradient,
+//so that the normals don't bleed across silhouettes
+float depthGradient( ivec2 iUv, ivec2 dir, ivec2 tileMin, ivec2 tileMax, float depth )
+{
+	ivec2 prevUv = clamp( iUv - dir, tileMin, tileMax );
+	ivec2 nextUv = clamp( iUv + dir, tileMin, tileMax );
+	float prevDepth = depth - loadLinearDepth( prevUv );
+	float nextDepth = loadLinearDepth( nextUv ) - depth;
+	if( prevUv == iUv )
+		return nextDepth;
+	if( nextUv == iUv )
+		return prevDepth;
+	return abs( prevDepth ) < abs( nextDepth ) ? prevDepth : nextDepth;
+}
+
+void main()
+{
+	int framesPerSide	= int( packParams.x );
+	int frameRes		= int( packParams.y );
+
+	ivec2 texSize = textureSize( depthTexture, 0 );
+	ivec2 iUv = min( ivec2( inPs.uv0 * vec2( texSize ) ), texSize - 1 );
+
+	float depth = loadLinearDepth( iUv );
+	if( depth >= 1.0 )
+	{
+		fragColour = vec4( 0.5, 0.5, 0.5, 1.0 );
+		return;
+	}
+
+	ivec2 frame = min( iUv / frameRes, framesPerSide - 1 );
+	ivec2 tileMin = frame * frameRes;
+	ivec2 tileMax = tileMin + frameRes - 1;
+
+	//Depth spans 2 * radius and a frame 2 * radius, thus the slope is the
+	//depth difference in texels times the resolution. Rows go downwards
+	float dzdx = depthGradient( iUv, ivec2( 1, 0 ), tileMin, tileMax, depth ) * float( frameRes );
+	float dzdy = -depthGradient( iUv, ivec2( 0, 1 ), tileMin, tileMax, depth ) * float( frameRes );
+	vec3 viewNormal = normalize( vec3( dzdx, dzdy, 1.0 ) );
+
+	//Basis of the camera the frame was captured with
+	vec2 f = vec2( frame ) * (2.0 / (packParams.x - 1.0)) - 1.0;
+	vec3 dir = vec3( f.x, 1.0 - abs( f.x ) - abs( f.y ), f.y );
+	float t = clamp( -dir.y, 0.0, 1.0 );
+	dir.x += dir.x >= 0.0 ? -t : t;
+	dir.z += dir.z >= 0.0 ? -t : t;
+	dir = normalize( dir );
+	vec3 up = abs( dir.y ) > 0.999 ? vec3( 0, 0, 1 ) : vec3( 0, 1, 0 );
+	vec3 right = normalize( cross( up, dir ) );
+	up = cross( dir, right );
+
+	vec3 normal = right * viewNormal.x + up * viewNormal.y + dir * viewNormal.z;
+	fragColour = vec4( normal * 0.5 + 0.5, depth );
+}
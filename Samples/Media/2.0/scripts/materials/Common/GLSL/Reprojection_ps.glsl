@@ -0,0 +1,27 @@
+#version 330
+
+//Warps the last rendered frame to the camera's latest orientation (rotational reprojection).
+//reprojectionMatrix goes from the current NDC to the NDC the frame was rendered with
+//(see CompositorPassQuadDef::mReprojection). Areas that weren't rendered get reprojected
+//from the closest edge.
+
+uniform sampler2D lastFrame;
+
+uniform mat4 reprojectionMatrix;
+
+in block
+{
+	vec2 uv0;
+} inPs;
+
+out vec4 fragColour;
+
+void main()
+{
+	vec4 ndc = vec4( inPs.uv0.x * 2.0 - 1.0, 1.0 - inPs.uv0.y * 2.0, 1.0, 1.0 );
+	vec4 srcNdc = reprojectionMatrix * ndc;
+	srcNdc.xy /= srcNdc.w;
+
+	vec2 srcUv = vec2( srcNdc.x * 0.5 + 0.5, 0.5 - srcNdc.y * 0.5 );
+	fragColour = texture( lastFrame, srcUv );
+}
@@ -0,0 +1,82 @@
+#version 430
+
+//Converts an RGB texture into the two planes of NV12: full resolution luma (R8) and
+//half resolution interleaved CbCr (RG8). Each thread handles a 2x2 block, writing
+//4 luma texels and their averaged chroma (see VideoFrameCapture).
+
+uniform sampler2D srcTex;
+
+layout (rg8) uniform restrict writeonly image2D dstChroma;
+layout (r8) uniform restrict writeonly image2D dstLuma;
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+@property( srgb )
+vec3 toSRgb( vec3 lin )
+{
+	lin = clamp( lin, 0.0, 1.0 );
+	vec3 lo = lin * 12.92;
+	vec3 hi = 1.055 * pow( lin, vec3( 1.0 / 2.4 ) ) - 0.055;
+	return mix( hi, lo, lessThanEqual( lin, vec3( 0.0031308 ) ) );
+}
+@end
+
+@property( bt601 )
+	const vec3 c_lumaWeights	= vec3( 0.299, 0.587, 0.114 );
+	const vec3 c_cbWeights		= vec3( -0.168736, -0.331264, 0.5 );
+	const vec3 c_crWeights		= vec3( 0.5, -0.418688, -0.081312 );
+@else
+	const vec3 c_lumaWeights	= vec3( 0.2126, 0.7152, 0.0722 );
+	const vec3 c_cbWeights		= vec3( -0.114572, -0.385428, 0.5 );
+	const vec3 c_crWeights		= vec3( 0.5, -0.454153, -0.045847 );
+@end
+
+@property( full_range )
+	const float c_lumaScale		= 1.0;
+	const float c_lumaOffset	= 0.0;
+	const float c_chromaScale	= 1.0;
+@else
+	const float c_lumaScale		= 219.0 / 255.0;
+	const float c_lumaOffset	= 16.0 / 255.0;
+	const float c_chromaScale	= 224.0 / 255.0;
+@end
+
+void main()
+{
+	ivec2 blockPos = ivec2( gl_GlobalInvocationID.xy );
+	ivec2 chromaSize = imageSize( dstChroma );
+	if( blockPos.x >= chromaSize.x || blockPos.y >= chromaSize.y )
+		return;
+
+	ivec2 lumaSize = imageSize( dstLuma );
+	ivec2 srcSize = textureSize( srcTex, 0 );
+
+	vec3 rgbSum = vec3( 0.0, 0.0, 0.0 );
+	for( int y=0; y<2; ++y )
+	{
+		for( int x=0; x<2; ++x )
+		{
+			ivec2 dstPos = blockPos * 2 + ivec2( x, y );
+			//Replicate the edges for odd resolutions
+			vec3 rgb = texelFetch( srcTex, min( dstPos, srcSize - 1 ), 0 ).xyz;
+			@property( srgb )
+				rgb = toSRgb( rgb );
+			@end
+			rgb = clamp( rgb, 0.0, 1.0 );
+			rgbSum += rgb;
+
+			if( dstPos.x < lumaSize.x && dstPos.y < lumaSize.y )
+			{
+				float luma = dot( rgb, c_lumaWeights ) * c_lumaScale + c_lumaOffset;
+				imageStore( dstLuma, dstPos, vec4( luma, 0.0, 0.0, 0.0 ) );
+			}
+		}
+	}
+
+	vec3 rgb = rgbSum * 0.25;
+	vec2 chroma = vec2( dot( rgb, c_cbWeights ), dot( rgb, c_crWeights ) ) * c_chromaScale +
+				  128.0 / 255.0;
+	imageStore( dstChroma, blockPos, vec4( chroma, 0.0, 0.0 ) );
+}
@@ -0,0 +1,108 @@
+#version 430
+
+//Single pass downsampler (same idea as AMD's FidelityFX SPD): each threadgroup reduces a
+//64x64 tile of the source mip into up to 6 mips using shared memory, so that a whole mip
+//chain needs one dispatch every 6 mips rather than one (or two) per mip.
+//See ComputeDownsampler.
+
+@property( texture_is_array )
+	uniform sampler2DArray srcTex;
+	@property( uav_is_cube )
+		//Cubemaps are sampled as 2D arrays, but GL wants layered cubemap images to be imageCube
+		@foreach( num_dst_mips, n )
+		layout (@insertpiece(uav@n_pf_type)) uniform restrict writeonly imageCube dstMip@n;@end
+	@else
+		@foreach( num_dst_mips, n )
+		layout (@insertpiece(uav@n_pf_type)) uniform restrict writeonly image2DArray dstMip@n;@end
+	@end
+	#define TEX_COORD( uv ) ivec3( uv, int( gl_WorkGroupID.z ) )
+@else
+	uniform sampler2D srcTex;
+	@foreach( num_dst_mips, n )
+	layout (@insertpiece(uav@n_pf_type)) uniform restrict writeonly image2D dstMip@n;@end
+	#define TEX_COORD( uv ) uv
+@end
+
+layout( local_size_x = @value( threads_per_group_x ),
+		local_size_y = @value( threads_per_group_y ),
+		local_size_z = @value( threads_per_group_z ) ) in;
+
+//The 32x32 tile of the first mip. Deeper mips are stored in place with the same stride
+shared vec4 g_lds[1024];
+
+vec4 reduce4( vec4 a, vec4 b, vec4 c, vec4 d )
+{
+@property( downsample_min )
+	return min( min( a, b ), min( c, d ) );
+@else @property( downsample_max )
+	return max( max( a, b ), max( c, d ) );
+@else
+	return ( a + b + c + d ) * 0.25;
+@end @end
+}
+
+vec4 encodeOutput( vec4 value )
+{
+@property( srgb )
+	//UAVs can't be sRGB, they're bound with the linear equivalent format
+	vec3 lin = clamp( value.xyz, 0.0, 1.0 );
+	vec3 lo = lin * 12.92;
+	vec3 hi = 1.055 * pow( lin, vec3( 1.0 / 2.4 ) ) - 0.055;
+	return vec4( mix( hi, lo, lessThanEqual( lin, vec3( 0.0031308 ) ) ), value.w );
+@else
+	return value;
+@end
+}
+
+void main()
+{
+	int localIdx = int( gl_LocalInvocationIndex );
+	ivec2 srcMaxCoord = textureSize( srcTex, 0 ).xy - 1;
+
+	//First mip: each thread outputs 4 of the 32x32 texels of the tile
+	ivec2 dstSize = imageSize( dstMip0 ).xy;
+	for( int i=0; i<4; ++i )
+	{
+		int ldsIdx = localIdx + i * 256;
+		ivec2 dstPos = ivec2( gl_WorkGroupID.xy ) * 32 + ivec2( ldsIdx & 31, ldsIdx >> 5 );
+		//Clamping replicates the edges for odd resolutions
+		ivec2 srcPos = dstPos * 2;
+		vec4 value = reduce4(
+			texelFetch( srcTex, TEX_COORD( min( srcPos, srcMaxCoord ) ), 0 ),
+			texelFetch( srcTex, TEX_COORD( min( srcPos + ivec2( 1, 0 ), srcMaxCoord ) ), 0 ),
+			texelFetch( srcTex, TEX_COORD( min( srcPos + ivec2( 0, 1 ), srcMaxCoord ) ), 0 ),
+			texelFetch( srcTex, TEX_COORD( min( srcPos + ivec2( 1, 1 ), srcMaxCoord ) ), 0 ) );
+		g_lds[ldsIdx] = value;
+		if( dstPos.x < dstSize.x && dstPos.y < dstSize.y )
+			imageStore( dstMip0, TEX_COORD( dstPos ), encodeOutput( value ) );
+	}
+@foreach( num_dst_mips, n, 1 )
+	{
+		const int mipSize = 32 >> @n;
+		bool isActive = localIdx < mipSize * mipSize;
+		ivec2 localPos = ivec2( localIdx % mipSize, localIdx / mipSize );
+
+		memoryBarrierShared();
+		barrier();
+
+		vec4 value = vec4( 0.0, 0.0, 0.0, 0.0 );
+		if( isActive )
+		{
+			int base = localPos.y * 64 + localPos.x * 2;
+			value = reduce4( g_lds[base], g_lds[base + 1], g_lds[base + 32], g_lds[base + 33] );
+		}
+
+		memoryBarrierShared();
+		barrier();
+
+		if( isActive )
+		{
+			g_lds[localPos.y * 32 + localPos.x] = value;
+			ivec2 dstPos = ivec2( gl_WorkGroupID.xy ) * mipSize + localPos;
+			dstSize = imageSize( dstMip@n ).xy;
+			if( dstPos.x < dstSize.x && dstPos.y < dstSize.y )
+				imageStore( dstMip@n, TEX_COORD( dstPos ), encodeOutput( value ) );
+		}
+	}
+@end
+}
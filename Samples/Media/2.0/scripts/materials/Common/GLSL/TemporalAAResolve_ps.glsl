@@ -0,0 +1,58 @@
+#version 330
+
+//Temporal antialiasing resolve. Blends the current frame with the reprojected history
+//(see CompositorPassSceneDef::mGenMotionVectors), clipping the history to the colour
+//distribution of the current pixel's neighbourhood to reject stale data.
+//currFrame & motionVectors may be smaller than the output (temporal upscaling);
+//history must be the same resolution as the output.
+
+uniform sampler2D currFrame;
+uniform sampler2D motionVectors;
+uniform sampler2D history;
+
+uniform float blendFactor;
+
+in block
+{
+	vec2 uv0;
+} inPs;
+
+out vec4 fragColour;
+
+void main()
+{
+	ivec2 currSize = textureSize( currFrame, 0 );
+	ivec2 currPixel = min( ivec2( inPs.uv0 * vec2( currSize ) ), currSize - 1 );
+
+	vec3 currColour = texture( currFrame, inPs.uv0 ).xyz;
+
+	//Variance clipping box of the 3x3 neighbourhood
+	vec3 m1 = vec3( 0.0 );
+	vec3 m2 = vec3( 0.0 );
+	for( int y=-1; y<=1; ++y )
+	{
+		for( int x=-1; x<=1; ++x )
+		{
+			ivec2 pos = clamp( currPixel + ivec2( x, y ), ivec2( 0 ), currSize - 1 );
+			vec3 neighbour = texelFetch( currFrame, pos, 0 ).xyz;
+			m1 += neighbour;
+			m2 += neighbour * neighbour;
+		}
+	}
+	vec3 mean = m1 / 9.0;
+	vec3 sigma = sqrt( abs( m2 / 9.0 - mean * mean ) );
+	vec3 minColour = min( mean - sigma, currColour );
+	vec3 maxColour = max( mean + sigma, currColour );
+
+	vec2 historyUv = inPs.uv0 + texelFetch( motionVectors, currPixel, 0 ).xy;
+	vec4 historyColour = texture( history, historyUv );
+
+	//History is cleared to 0 (including alpha) before the first frame
+	bool validHistory = historyColour.w > 0.0 &&
+						all( greaterThanEqual( historyUv, vec2( 0.0 ) ) ) &&
+						all( lessThanEqual( historyUv, vec2( 1.0 ) ) );
+
+	vec3 clippedHistory = clamp( historyColour.xyz, minColour, maxColour );
+	fragColour.xyz = validHistory ? mix( clippedHistory, currColour, blendFactor ) : currColour;
+	fragColour.w = 1.0;
+}
@@ -0,0 +1,31 @@
+#version 330
+
+//Weighted blended order independent transparency resolve (McGuire & Bavoil 2013).
+//accumTex.rgb holds the sum of the weighted premultiplied colours, accumTex.a the
+//product of (1 - alpha), i.e. how much of the background is left. See OitMode::WeightedBlended
+
+uniform sampler2D accumTex;
+uniform sampler2D weightTex;
+
+in block
+{
+	vec2 uv0;
+} inPs;
+
+out vec4 fragColour;
+
+void main()
+{
+	ivec2 texSize = textureSize( accumTex, 0 );
+	ivec2 iUv = min( ivec2( inPs.uv0 * vec2( texSize ) ), texSize - 1 );
+
+	vec4 accum = texelFetch( accumTex, iUv, 0 );
+	float revealage = accum.w;
+	if( revealage >= 1.0 )
+		discard;
+
+	float weight = texelFetch( weightTex, iUv, 0 ).x;
+
+	fragColour.xyz = accum.xyz / max( weight, 1e-5 );
+	fragColour.w = 1.0 - revealage;
+}
@@ -0,0 +1,232 @@
+
+//Range-fit BC1 / BC3 / BC4 / BC5 encoder. Each thread encodes one 4x4 block.
+//The result is written to an integer UAV the size of the block grid (RG32_UINT for
+//BC1 & BC4, RGBA32_UINT for BC3 & BC5) which the C++ side then copies into the
+//compressed texture (see GpuBlockCompressor).
+//Quality is lower than offline encoders; the goal is being fast enough to run every
+//time a dynamically generated texture changes.
+
+Texture2D<float4> srcTex : register(t0);
+
+@property( compress_bc1 || compress_bc4 )
+	RWTexture2D<uint2> dstTex : register(u0);
+@else
+	RWTexture2D<uint4> dstTex : register(u0);
+@end
+
+uniform int srcLodIdx;
+
+@property( srgb )
+float3 toSRgb( float3 lin )
+{
+	lin = clamp( lin, 0.0, 1.0 );
+	float3 lo = lin * 12.92;
+	float3 hi = 1.055 * pow( lin, 1.0 / 2.4 ) - 0.055;
+	return lerp( hi, lo, step( lin, 0.0031308 ) );
+}
+@end
+
+uint packRgb565( float3 c )
+{
+	uint3 q = uint3( round( clamp( c, 0.0, 1.0 ) * float3( 31.0, 63.0, 31.0 ) ) );
+	return (q.x << 11u) | (q.y << 5u) | q.z;
+}
+
+float3 unpackRgb565( uint c )
+{
+	return float3( float( (c >> 11u) & 0x1Fu ) / 31.0,
+				 float( (c >> 5u) & 0x3Fu ) / 63.0,
+				 float( c & 0x1Fu ) / 31.0 );
+}
+
+/// Encodes an opaque BC1 colour block (always in 4-colour mode).
+uint2 encodeColourBlock( float3 block[16] )
+{
+	float3 minC = block[0];
+	float3 maxC = block[0];
+	float3 mean = block[0];
+	for( int i=1; i<16; ++i )
+	{
+		minC = min( minC, block[i] );
+		maxC = max( maxC, block[i] );
+		mean += block[i];
+	}
+	mean /= 16.0;
+
+	//Find the principal axis with a few power iterations of the covariance matrix.
+	//Just using the bounding box diagonal breaks when channels are anti-correlated.
+	float3 covDiag = 0;
+	float3 covOff = 0;
+	for( int i=0; i<16; ++i )
+	{
+		float3 d = block[i] - mean;
+		covDiag += d * d;
+		covOff += d.xxy * d.yzz;
+	}
+
+	float3 axis = maxC - minC;
+	for( int i=0; i<4; ++i )
+	{
+		axis = float3( dot( float3( covDiag.x, covOff.x, covOff.y ), axis ),
+					 dot( float3( covOff.x, covDiag.y, covOff.z ), axis ),
+					 dot( float3( covOff.y, covOff.z, covDiag.z ), axis ) );
+		float maxComp = max( abs( axis.x ), max( abs( axis.y ), abs( axis.z ) ) );
+		if( maxComp > 0.0 )
+			axis /= maxComp;
+	}
+
+	if( dot( axis, axis ) > 0.0 )
+	{
+		axis = normalize( axis );
+		float tMin = dot( block[0] - mean, axis );
+		float tMax = tMin;
+		for( int i=1; i<16; ++i )
+		{
+			float t = dot( block[i] - mean, axis );
+			tMin = min( tMin, t );
+			tMax = max( tMax, t );
+		}
+
+		//Inset the endpoints so outliers don't waste the interpolated colours
+		float inset = (tMax - tMin) / 16.0;
+		minC = clamp( mean + axis * (tMin + inset), 0.0, 1.0 );
+		maxC = clamp( mean + axis * (tMax - inset), 0.0, 1.0 );
+	}
+
+	uint c0 = packRgb565( maxC );
+	uint c1 = packRgb565( minC );
+	if( c0 < c1 )
+	{
+		uint tmp = c0;
+		c0 = c1;
+		c1 = tmp;
+	}
+
+	if( c0 == c1 )
+		return uint2( c0 | (c1 << 16u), 0u );
+
+	float3 ep0 = unpackRgb565( c0 );
+	float3 ep1 = unpackRgb565( c1 );
+	float3 dir = ep0 - ep1;
+	float invLenSq = 1.0 / dot( dir, dir );
+
+	uint indices = 0u;
+	for( int i=0; i<16; ++i )
+	{
+		float t = clamp( dot( block[i] - ep1, dir ) * invLenSq, 0.0, 1.0 );
+		uint j = uint( round( t * 3.0 ) );
+		//j goes from c1 to c0. Palette order is c0, c1, 2/3 c0 + 1/3 c1, 1/3 c0 + 2/3 c1
+		uint idx = j == 3u ? 0u : (j == 0u ? 1u : 4u - j);
+		indices |= idx << uint( i * 2 );
+	}
+
+	return uint2( c0 | (c1 << 16u), indices );
+}
+
+/// Encodes a BC4 block (also used for BC3 alpha and each of the BC5 channels).
+/// Always uses the 8 value mode.
+uint2 encodeChannelBlock( float block[16] )
+{
+	float minA = block[0];
+	float maxA = block[0];
+	for( int i=1; i<16; ++i )
+	{
+		minA = min( minA, block[i] );
+		maxA = max( maxA, block[i] );
+	}
+
+	uint a0 = uint( round( clamp( maxA, 0.0, 1.0 ) * 255.0 ) );
+	uint a1 = uint( round( clamp( minA, 0.0, 1.0 ) * 255.0 ) );
+
+	if( a0 == a1 )
+		return uint2( a0 | (a1 << 8u), 0u );
+
+	float fa1 = float( a1 ) / 255.0;
+	float invRange = 255.0 / float( a0 - a1 );
+
+	uint idxLo = 0u;
+	uint idxHi = 0u;
+	for( int i=0; i<16; ++i )
+	{
+		float t = clamp( (block[i] - fa1) * invRange, 0.0, 1.0 );
+		uint j = uint( round( t * 7.0 ) );
+		//j goes from a1 to a0. Palette order is a0, a1, then 6/7 a0 + 1/7 a1 ... 1/7 a0 + 6/7 a1
+		uint idx = j == 7u ? 0u : (j == 0u ? 1u : 8u - j);
+		if( i < 8 )
+			idxLo |= idx << uint( i * 3 );
+		else
+			idxHi |= idx << uint( (i - 8) * 3 );
+	}
+
+	return uint2( a0 | (a1 << 8u) | ((idxLo & 0xFFFFu) << 16u),
+				  (idxLo >> 16u) | (idxHi << 8u) );
+}
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	int2 blockPos = int2( gl_GlobalInvocationID.xy );
+
+	uint dstWidth, dstHeight;
+	dstTex.GetDimensions( dstWidth, dstHeight );
+	if( blockPos.x >= int( dstWidth ) || blockPos.y >= int( dstHeight ) )
+		return;
+
+	uint srcWidth, srcHeight, numMips;
+	srcTex.GetDimensions( srcLodIdx, srcWidth, srcHeight, numMips );
+	int2 srcSize = int2( srcWidth, srcHeight );
+	int2 texelStart = blockPos * 4;
+
+	float4 texels[16];
+	for( int y=0; y<4; ++y )
+	{
+		for( int x=0; x<4; ++x )
+		{
+			//Replicate the edges for textures that aren't a multiple of 4
+			int2 pos = min( texelStart + int2( x, y ), srcSize - 1 );
+			texels[y * 4 + x] = srcTex.Load( int3( pos, srcLodIdx ) );
+			@property( srgb )
+				texels[y * 4 + x].xyz = toSRgb( texels[y * 4 + x].xyz );
+			@end
+		}
+	}
+
+@property( compress_bc1 || compress_bc3 )
+	float3 colours[16];
+	for( int i=0; i<16; ++i )
+		colours[i] = texels[i].xyz;
+	uint2 colourBlock = encodeColourBlock( colours );
+@end
+@property( compress_bc3 || compress_bc4 || compress_bc5 )
+	float channel[16];
+	@property( compress_bc3 )
+		for( int i=0; i<16; ++i )
+			channel[i] = texels[i].w;
+	@else
+		for( int i=0; i<16; ++i )
+			channel[i] = texels[i].x;
+	@end
+	uint2 channelBlock0 = encodeChannelBlock( channel );
+@end
+@property( compress_bc5 )
+	for( int i=0; i<16; ++i )
+		channel[i] = texels[i].y;
+	uint2 channelBlock1 = encodeChannelBlock( channel );
+@end
+
+@property( compress_bc1 )
+	dstTex[blockPos] = colourBlock;
+@end
+@property( compress_bc3 )
+	dstTex[blockPos] = uint4( channelBlock0, colourBlock );
+@end
+@property( compress_bc4 )
+	dstTex[blockPos] = channelBlock0;
+@end
+@property( compress_bc5 )
+	dstTex[blockPos] = uint4( channelBlock0, channelBlock1 );
+@end
+}
@@ -0,0 +1,190 @@
+
+//Tiled deferred shading of Forward+ lights (point & spot). Each threadgroup is one
+//screen tile: it finds the tile's depth range, culls the Forward+ global light list
+//against the tile's view space bounds, and then shades every pixel of the tile with
+//the surviving lights, adding the result on top of the forward colour written by the
+//render_scene pass with gen_gbuffer.
+//The light list layout follows ForwardPlusBase::fillGlobalLightListBuffer
+//(6 float4 per light, in view space) and is bound by the compute pass via
+//forward_plus_lights.
+
+Texture2D<float> depthTexture		: register(t0);
+Texture2D<float4> gBufNormals		: register(t1);
+Texture2D<float4> gBufAlbedo		: register(t2);
+Texture2D<float4> gBufF0Roughness	: register(t3);
+Texture2D<float4> forwardColour		: register(t4);
+Buffer<float4> lightList			: register(t5);
+
+RWTexture2D<float4> dstTex : register(u0);
+
+uniform uint numLights;
+uniform float2 projectionParams;
+uniform float4 frustumExtents;
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+#define MAX_LIGHTS_PER_TILE @value( max_lights_per_tile )
+
+//Linear depth is always positive, thus its bits can be compared as uints
+groupshared uint g_minDepth;
+groupshared uint g_maxDepth;
+groupshared uint g_numTileLights;
+groupshared uint g_tileLights[MAX_LIGHTS_PER_TILE];
+
+/// Same as the Default BRDF from HlmsPbs (without GGX_height_correlated nor
+/// fresnel_separate_diffuse) since that's what the lights would've used in forward.
+float3 BRDF( float3 lightDir, float3 viewDir, float NdotV, float3 lightDiffuse,
+			 float3 lightSpecular, float3 normal, float3 diffuse, float3 F0, float roughness )
+{
+	float3 halfWay = normalize( lightDir + viewDir );
+	float NdotL = saturate( dot( normal, lightDir ) );
+	float NdotH = saturate( dot( normal, halfWay ) );
+	float VdotH = saturate( dot( viewDir, halfWay ) );
+
+	float sqR = roughness * roughness;
+
+	float f = ( NdotH * sqR - NdotH ) * NdotH + 1.0;
+	float R = sqR / (f * f + 1e-6f);
+
+	float gL = NdotL * (1.0 - sqR) + sqR;
+	float gV = NdotV * (1.0 - sqR) + sqR;
+	float G = 1.0 / (( gL * gV + 1e-4f ) * 4.0 * 3.141592654);
+
+	float3 fresnelS = F0 + pow( 1.0 - VdotH, 5.0 ) * (1.0 - F0);
+
+	float3 Rs = ( fresnelS * (R * G) ) * lightSpecular;
+
+	float energyBias	= roughness * 0.5;
+	float energyFactor	= lerp( 1.0, 1.0 / 1.51, roughness );
+	float fd90			= energyBias + 2.0 * VdotH * VdotH * roughness;
+	float lightScatter	= 1.0 + (fd90 - 1.0) * pow( 1.0 - NdotL, 5.0 );
+	float viewScatter	= 1.0 + (fd90 - 1.0) * pow( 1.0 - NdotV, 5.0 );
+
+	float fresnelD = 1.0 - max( fresnelS.x, max( fresnelS.y, fresnelS.z ) );
+
+	float3 Rd = (lightScatter * viewScatter * energyFactor * fresnelD) * diffuse * lightDiffuse;
+
+	return NdotL * (Rs + Rd);
+}
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID		: SV_DispatchThreadId,
+	uint3 gl_WorkGroupID			: SV_GroupID,
+	uint gl_LocalInvocationIndex	: SV_GroupIndex
+)
+{
+	int2 pixel = int2( gl_GlobalInvocationID.xy );
+	uint2 uDstSize;
+	dstTex.GetDimensions( uDstSize.x, uDstSize.y );
+	int2 dstSize = int2( uDstSize );
+	bool inBounds = pixel.x < dstSize.x && pixel.y < dstSize.y;
+
+	if( gl_LocalInvocationIndex == 0u )
+	{
+		g_minDepth = 0x7F7FFFFFu;
+		g_maxDepth = 0u;
+		g_numTileLights = 0u;
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	int2 loadPos = min( pixel, dstSize - 1 );
+	float fDepth = depthTexture.Load( int3( loadPos, 0 ) ).x;
+	float linearDepth = projectionParams.y / (fDepth - projectionParams.x);
+
+	InterlockedMin( g_minDepth, asuint( linearDepth ) );
+	InterlockedMax( g_maxDepth, asuint( linearDepth ) );
+	GroupMemoryBarrierWithGroupSync();
+
+	//Tile bounds in view space. Row 0 is the top of the screen.
+	const uint2 groupSize = uint2( @value( threads_per_group_x ), @value( threads_per_group_y ) );
+	float2 invDstSize = 1.0 / float2( dstSize );
+	float2 tileStart = float2( gl_WorkGroupID.xy * groupSize ) * invDstSize;
+	float2 tileEnd = float2( (gl_WorkGroupID.xy + 1u) * groupSize ) * invDstSize;
+
+	float2 tanStart = float2( lerp( frustumExtents.x, frustumExtents.y, tileStart.x ),
+							  lerp( frustumExtents.z, frustumExtents.w, tileStart.y ) );
+	float2 tanEnd = float2( lerp( frustumExtents.x, frustumExtents.y, tileEnd.x ),
+							lerp( frustumExtents.z, frustumExtents.w, tileEnd.y ) );
+	float2 tanMin = min( tanStart, tanEnd );
+	float2 tanMax = max( tanStart, tanEnd );
+
+	float tileMinDepth = asfloat( g_minDepth );
+	float tileMaxDepth = asfloat( g_maxDepth );
+
+	float3 aabbMin = float3( min( tanMin * tileMinDepth, tanMin * tileMaxDepth ), -tileMaxDepth );
+	float3 aabbMax = float3( max( tanMax * tileMinDepth, tanMax * tileMaxDepth ), -tileMinDepth );
+
+	for( uint i=gl_LocalInvocationIndex; i<numLights; i += uint( NUM_THREADS ) )
+	{
+		float4 posAndType = lightList.Load( int( i * 6u ) );
+		float range = lightList.Load( int( i * 6u + 3u ) ).x;
+
+		float3 closest = clamp( posAndType.xyz, aabbMin, aabbMax ) - posAndType.xyz;
+		if( dot( closest, closest ) <= range * range )
+		{
+			uint idx;
+			InterlockedAdd( g_numTileLights, 1u, idx );
+			if( idx < uint( MAX_LIGHTS_PER_TILE ) )
+				g_tileLights[idx] = i;
+		}
+	}
+	GroupMemoryBarrierWithGroupSync();
+
+	if( !inBounds )
+		return;
+
+	float4 finalColour = forwardColour.Load( int3( pixel, 0 ) );
+	float4 f0Roughness = gBufF0Roughness.Load( int3( pixel, 0 ) );
+	float3 diffuse = gBufAlbedo.Load( int3( pixel, 0 ) ).xyz;
+	float3 normal = normalize( gBufNormals.Load( int3( pixel, 0 ) ).xyz * 2.0 - 1.0 );
+
+	float2 uv = (float2( pixel ) + 0.5) * invDstSize;
+	float3 pos = float3( lerp( frustumExtents.x, frustumExtents.y, uv.x ) * linearDepth,
+						 lerp( frustumExtents.z, frustumExtents.w, uv.y ) * linearDepth,
+						 -linearDepth );
+	float3 viewDir = normalize( -pos );
+	float NdotV = saturate( dot( normal, viewDir ) );
+	float roughness = max( f0Roughness.w, 0.02 );
+
+	uint numTileLights = min( g_numTileLights, uint( MAX_LIGHTS_PER_TILE ) );
+	for( uint j=0u; j<numTileLights; ++j )
+	{
+		int idx = int( g_tileLights[j] * 6u );
+
+		float4 posAndType		= lightList.Load( idx );
+		float3 lightDiffuse		= lightList.Load( idx + 1 ).xyz;
+		float3 lightSpecular	= lightList.Load( idx + 2 ).xyz;
+		float4 attenuation		= lightList.Load( idx + 3 );
+
+		float3 lightDir	= posAndType.xyz - pos;
+		float fDistance	= length( lightDir );
+
+		if( fDistance <= attenuation.x )
+		{
+			lightDir *= 1.0 / fDistance;
+			float atten = 1.0 / (0.5 + (attenuation.y + attenuation.z * fDistance) * fDistance );
+			@property( fade_attenuation_range )
+				atten *= max( (attenuation.x - fDistance) * attenuation.w, 0.0f );
+			@end
+
+			if( posAndType.w == 2.0 )
+			{
+				//Spot light
+				float3 spotDirection	= lightList.Load( idx + 4 ).xyz;
+				float3 spotParams		= lightList.Load( idx + 5 ).xyz;
+
+				float spotCosAngle = dot( -lightDir, spotDirection );
+				float spotAtten = saturate( (spotCosAngle - spotParams.y) * spotParams.x );
+				atten *= pow( spotAtten, spotParams.z );
+				if( spotCosAngle < spotParams.y )
+					atten = 0.0;
+			}
+
+			finalColour.xyz += BRDF( lightDir, viewDir, NdotV, lightDiffuse, lightSpecular,
+									 normal, diffuse, f0Roughness.xyz, roughness ) * atten;
+		}
+	}
+
+	dstTex[uint2( pixel )] = finalColour;
+}
@@ -0,0 +1,243 @@
+//Bins the Forward+ lights, decals & cubemap probes into the ForwardClustered grid.
+//Each threadgroup is one grid tile (x, y); every thread walks one or more depth slices of
+//that tile and tests the whole global light list against the cell's view space bounds.
+//The tests are conservative (sphere / cone / box vs. cell AABB): a false positive only
+//costs some extra work in the pixel shader, which performs the real per pixel tests.
+//The light list layout follows ForwardPlusBase::fillGlobalLightListBuffer and the grid
+//layout is the same one ForwardClustered::collectLightForSlice writes on the CPU.
+
+Buffer<float4> lightList		: register(t0);
+@property( depth_bounds )
+Texture2D<float> depthTexture	: register(t1);
+@end
+
+//The grid is made of uint16 entries; we access them in pairs. Each cell has an even number
+//of entries, so no two cells share a word.
+RWStructuredBuffer<uint> gridWords : register(u0);
+
+uniform uint numLights;
+uniform uint numDecals;
+uniform uint numCubemapProbes;
+uniform uint decalFloat4Offset;
+uniform uint cubemapProbeFloat4Offset;
+//x = minDistance, y = exponentK, z = camera near, w = far depth of the last slice
+uniform float4 sliceParams;
+uniform float4 frustumExtents;
+uniform float2 projectionParams;
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+
+#define GRID_WIDTH			@value( grid_width )u
+#define GRID_HEIGHT			@value( grid_height )u
+#define NUM_SLICES			@value( num_slices )u
+#define OBJS_PER_CELL		@value( objs_per_cell )u
+#define LIGHTS_PER_CELL		@value( lights_per_cell )u
+#define DECALS_PER_CELL		@value( decals_per_cell )u
+#define DECALS_OFFSET		@value( decals_offset )u
+#define PROBES_PER_CELL		@value( cubemap_probes_per_cell )u
+#define PROBES_OFFSET		@value( cubemap_probes_offset )u
+
+@property( depth_bounds )
+//Linear depth is always positive, thus its bits can be compared as uints
+groupshared uint g_maxDepth;
+@end
+
+void storeEntry( uint cellStart, uint entryIdx, uint value )
+{
+	uint idx = cellStart + entryIdx;
+	uint shift = (idx & 1u) * 16u;
+	uint word = gridWords[idx >> 1u];
+	gridWords[idx >> 1u] = (word & ~(0xFFFFu << shift)) | (value << shift);
+}
+
+/// Returns false if the 8 corners, once transformed by the 3 given rows, are all outside
+/// the box [-halfSize; halfSize] on the same side of an axis.
+bool cornersIntersectBox( float3 corners[8], float4 r0, float4 r1, float4 r2, float3 offset,
+						  float3 halfSize )
+{
+	float3 localMin = float3( 3.402823466e+38, 3.402823466e+38, 3.402823466e+38 );
+	float3 localMax = -localMin;
+	for( int i=0; i<8; ++i )
+	{
+		float3 c = corners[i] + offset;
+		float3 local = float3( dot( r0.xyz, c ), dot( r1.xyz, c ), dot( r2.xyz, c ) ) +
+					   float3( r0.w, r1.w, r2.w );
+		localMin = min( localMin, local );
+		localMax = max( localMax, local );
+	}
+
+	return all( localMin <= halfSize ) && all( localMax >= -halfSize );
+}
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_WorkGroupID			: SV_GroupID,
+	uint gl_LocalInvocationIndex	: SV_GroupIndex
+)
+{
+	uint2 tile = gl_WorkGroupID.xy;
+
+	float tileMaxDepth = 3.402823466e+38;
+@property( depth_bounds )
+	//Only the farthest depth is used: transparent objects can be in front of the
+	//depth prepass but never behind it, so cells behind the farthest opaque surface
+	//can't be lit by anything.
+	if( gl_LocalInvocationIndex == 0u )
+		g_maxDepth = 0u;
+	GroupMemoryBarrierWithGroupSync();
+
+	//The grid's row 0 is at the bottom of the screen; the texture's is at the top
+	uint2 uDepthSize;
+	depthTexture.GetDimensions( uDepthSize.x, uDepthSize.y );
+	int2 depthSize = int2( uDepthSize );
+	int2 pixelStart = int2( (tile.x * uDepthSize.x) / GRID_WIDTH,
+							((GRID_HEIGHT - 1u - tile.y) * uDepthSize.y) / GRID_HEIGHT );
+	int2 pixelEnd = int2( ((tile.x + 1u) * uDepthSize.x) / GRID_WIDTH,
+						  ((GRID_HEIGHT - tile.y) * uDepthSize.y) / GRID_HEIGHT );
+	int2 tileSize = max( pixelEnd - pixelStart, int2( 1, 1 ) );
+	uint numPixels = uint( tileSize.x * tileSize.y );
+
+	float localMaxDepth = 0.0;
+	for( uint i=gl_LocalInvocationIndex; i<numPixels; i += uint( NUM_THREADS ) )
+	{
+		int2 pixel = pixelStart + int2( int( i ) % tileSize.x, int( i ) / tileSize.x );
+		pixel = min( pixel, depthSize - 1 );
+		float fDepth = depthTexture.Load( int3( pixel, 0 ) ).x;
+		localMaxDepth = max( localMaxDepth, projectionParams.y / (fDepth - projectionParams.x) );
+	}
+	InterlockedMax( g_maxDepth, asuint( localMaxDepth ) );
+	GroupMemoryBarrierWithGroupSync();
+
+	tileMaxDepth = asfloat( g_maxDepth );
+@end
+
+	//Tangents of the tile's edges. Dividing by the grid size is the same
+	//as ForwardClustered::collectLightForSlice subdividing the frustum.
+	float2 tanStart = float2( lerp( frustumExtents.x, frustumExtents.y, float( tile.x ) / float( GRID_WIDTH ) ),
+							  lerp( frustumExtents.w, frustumExtents.z, float( tile.y ) / float( GRID_HEIGHT ) ) );
+	float2 tanEnd = float2( lerp( frustumExtents.x, frustumExtents.y, float( tile.x + 1u ) / float( GRID_WIDTH ) ),
+							lerp( frustumExtents.w, frustumExtents.z, float( tile.y + 1u ) / float( GRID_HEIGHT ) ) );
+	float2 tanMin = min( tanStart, tanEnd );
+	float2 tanMax = max( tanStart, tanEnd );
+
+	for( uint slice=gl_LocalInvocationIndex; slice<NUM_SLICES; slice += uint( NUM_THREADS ) )
+	{
+		float cellNear = slice == 0u ? sliceParams.z :
+										 exp2( sliceParams.y * float( slice ) ) + sliceParams.x;
+		float cellFar = slice == NUM_SLICES - 1u ? sliceParams.w :
+							exp2( sliceParams.y * float( slice + 1u ) ) + sliceParams.x;
+		cellFar = min( cellFar, tileMaxDepth );
+
+		uint cellIdx = (slice * GRID_HEIGHT + tile.y) * GRID_WIDTH + tile.x;
+		uint cellStart = cellIdx * OBJS_PER_CELL;
+
+		uint numPoint = 0u;
+		uint numSpot = 0u;
+		uint numVpl = 0u;
+		uint numCellDecals = 0u;
+		uint numCellProbes = 0u;
+
+		if( cellNear <= cellFar )
+		{
+			float3 aabbMin = float3( min( tanMin * cellNear, tanMin * cellFar ), -cellFar );
+			float3 aabbMax = float3( max( tanMax * cellNear, tanMax * cellFar ), -cellNear );
+
+			float3 sphereCenter = (aabbMin + aabbMax) * 0.5;
+			float sphereRadius = length( aabbMax - sphereCenter );
+
+			uint numCellLights = 0u;
+			for( uint i=0u; i<numLights && numCellLights < LIGHTS_PER_CELL; ++i )
+			{
+				float4 posAndType = lightList.Load( int( i * 6u ) );
+				float range = lightList.Load( int( i * 6u + 3u ) ).x;
+
+				float3 closest = clamp( posAndType.xyz, aabbMin, aabbMax ) - posAndType.xyz;
+				bool bIntersects = dot( closest, closest ) <= range * range;
+
+				if( bIntersects && posAndType.w == 2.0 )
+				{
+					//Spot light. Cone vs the cell's bounding sphere
+					float3 spotDirection = lightList.Load( int( i * 6u + 4u ) ).xyz;
+					float cosAngle = lightList.Load( int( i * 6u + 5u ) ).y;
+					float sinAngle = sqrt( max( 1.0 - cosAngle * cosAngle, 0.0 ) );
+
+					float3 v = sphereCenter - posAndType.xyz;
+					float vLenSq = dot( v, v );
+					float v1Len = dot( v, spotDirection );
+					float distClosest = cosAngle * sqrt( max( vLenSq - v1Len * v1Len, 0.0 ) ) -
+										v1Len * sinAngle;
+					bIntersects = distClosest <= sphereRadius &&
+								  v1Len <= sphereRadius + range && v1Len >= -sphereRadius;
+				}
+
+				if( bIntersects )
+				{
+					storeEntry( cellStart, 3u + numCellLights, i * 6u );
+					++numCellLights;
+					if( posAndType.w == 1.0 )
+						++numPoint;
+					else if( posAndType.w == 2.0 )
+						++numSpot;
+					else
+						++numVpl;
+				}
+			}
+
+			float3 corners[8];
+			corners[0] = float3( tanStart.x * cellNear, tanStart.y * cellNear, -cellNear );
+			corners[1] = float3( tanEnd.x * cellNear, tanStart.y * cellNear, -cellNear );
+			corners[2] = float3( tanEnd.x * cellNear, tanEnd.y * cellNear, -cellNear );
+			corners[3] = float3( tanStart.x * cellNear, tanEnd.y * cellNear, -cellNear );
+			corners[4] = float3( tanStart.x * cellFar, tanStart.y * cellFar, -cellFar );
+			corners[5] = float3( tanEnd.x * cellFar, tanStart.y * cellFar, -cellFar );
+			corners[6] = float3( tanEnd.x * cellFar, tanEnd.y * cellFar, -cellFar );
+			corners[7] = float3( tanStart.x * cellFar, tanEnd.y * cellFar, -cellFar );
+
+		@property( decals_per_cell )
+			//Decals: invWorldView takes view space to the decal's unit cube
+			for( uint i=0u; i<numDecals && numCellDecals < DECALS_PER_CELL; ++i )
+			{
+				uint offset = decalFloat4Offset + i * 4u;
+				if( cornersIntersectBox( corners, lightList.Load( int( offset ) ),
+										 lightList.Load( int( offset + 1u ) ),
+										 lightList.Load( int( offset + 2u ) ),
+										 float3( 0.0, 0.0, 0.0 ), float3( 0.5, 0.5, 0.5 ) ) )
+				{
+					storeEntry( cellStart, DECALS_OFFSET + 1u + numCellDecals, offset );
+					++numCellDecals;
+				}
+			}
+		@end
+
+		@property( cubemap_probes_per_cell )
+			//Probes: rotation to probe space in xyz, probe shape's center (view space) in w
+			for( uint i=0u; i<numCubemapProbes && numCellProbes < PROBES_PER_CELL; ++i )
+			{
+				uint offset = cubemapProbeFloat4Offset + i * 8u;
+				float4 r0 = lightList.Load( int( offset ) );
+				float4 r1 = lightList.Load( int( offset + 1u ) );
+				float4 r2 = lightList.Load( int( offset + 2u ) );
+				float3 halfSize = lightList.Load( int( offset + 3u ) ).xyz;
+				if( cornersIntersectBox( corners, float4( r0.xyz, 0.0 ), float4( r1.xyz, 0.0 ),
+										 float4( r2.xyz, 0.0 ), -float3( r0.w, r1.w, r2.w ),
+										 halfSize ) )
+				{
+					storeEntry( cellStart, PROBES_OFFSET + 1u + numCellProbes, offset );
+					++numCellProbes;
+				}
+			}
+		@end
+		}
+
+		storeEntry( cellStart, 0u, numPoint );
+		storeEntry( cellStart, 1u, numPoint + numSpot );
+		storeEntry( cellStart, 2u, numPoint + numSpot + numVpl );
+	@property( decals_per_cell )
+		storeEntry( cellStart, DECALS_OFFSET, numCellDecals );
+	@end
+	@property( cubemap_probes_per_cell )
+		storeEntry( cellStart, PROBES_OFFSET, numCellProbes );
+	@end
+	}
+}
@@ -0,0 +1,210 @@
+//Evaluates the skeletal animations of the SkeletonInstances sharing the same SkeletonDef.
+//Each threadgroup is one instance: it samples & blends the active animations of every bone,
+//walks the hierarchy one depth level at a time (keeping the derived transforms in shared
+//memory) and writes the final bone matrices (3 float4 per bone) where HlmsPbs expects them.
+//Same math as SkeletonTrack::applyKeyFrameRigAt & Bone::updateAllTransforms.
+//The layout of skeletonData & instanceData is documented in GpuSkeletonEvaluator::createSkeletonData
+
+Buffer<float4> skeletonData	: register(t0);
+Buffer<float4> instanceData	: register(t1);
+
+RWStructuredBuffer<float4> boneMatrices : register(u0);
+
+uniform uint numInstances;
+uniform uint groupsPerRow;
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+#define MAX_BONES @value( max_bones )
+
+struct Mat3x4
+{
+	float4 r0;
+	float4 r1;
+	float4 r2;
+};
+
+groupshared float4 g_derived[MAX_BONES * 3];
+
+float4 qmul( float4 a, float4 b )
+{
+	return float4( a.w * b.xyz + b.w * a.xyz + cross( a.xyz, b.xyz ),
+				   a.w * b.w - dot( a.xyz, b.xyz ) );
+}
+
+float4 nlerpShortest( float t, float4 a, float4 b )
+{
+	if( dot( a, b ) < 0.0 )
+		b = -b;
+	return normalize( lerp( a, b, t ) );
+}
+
+Mat3x4 makeTransform( float3 pos, float3 scale, float4 q )
+{
+	float3 t2 = q.xyz + q.xyz;
+	float3 tw = t2 * q.w;
+	float txx = t2.x * q.x;
+	float txy = t2.y * q.x;
+	float txz = t2.z * q.x;
+	float tyy = t2.y * q.y;
+	float tyz = t2.z * q.y;
+	float tzz = t2.z * q.z;
+
+	Mat3x4 m;
+	m.r0 = float4( float3( 1.0 - (tyy + tzz), txy - tw.z, txz + tw.y ) * scale, pos.x );
+	m.r1 = float4( float3( txy + tw.z, 1.0 - (txx + tzz), tyz - tw.x ) * scale, pos.y );
+	m.r2 = float4( float3( txz - tw.y, tyz + tw.x, 1.0 - (txx + tyy) ) * scale, pos.z );
+	return m;
+}
+
+Mat3x4 mulMat( Mat3x4 a, Mat3x4 b )
+{
+	Mat3x4 r;
+	r.r0 = a.r0.x * b.r0 + a.r0.y * b.r1 + a.r0.z * b.r2 + float4( 0.0, 0.0, 0.0, a.r0.w );
+	r.r1 = a.r1.x * b.r0 + a.r1.y * b.r1 + a.r1.z * b.r2 + float4( 0.0, 0.0, 0.0, a.r1.w );
+	r.r2 = a.r2.x * b.r0 + a.r2.y * b.r1 + a.r2.z * b.r2 + float4( 0.0, 0.0, 0.0, a.r2.w );
+	return r;
+}
+
+/// See ArrayMatrixAf4x3::retain
+Mat3x4 retain( Mat3x4 m, uint flags )
+{
+	float3 scale = float3( length( m.r0.xyz ), length( m.r1.xyz ), length( m.r2.xyz ) );
+	float3 invScale = float3( scale.x != 0.0 ? 1.0 / scale.x : 0.0,
+						  scale.y != 0.0 ? 1.0 / scale.y : 0.0,
+						  scale.z != 0.0 ? 1.0 / scale.z : 0.0 );
+	if( (flags & 2u) == 0u )
+		scale = (float3)1.0;
+
+	float3 row0 = (flags & 1u) != 0u ? m.r0.xyz * invScale.x : float3( 1.0, 0.0, 0.0 );
+	float3 row1 = (flags & 1u) != 0u ? m.r1.xyz * invScale.y : float3( 0.0, 1.0, 0.0 );
+	float3 row2 = (flags & 1u) != 0u ? m.r2.xyz * invScale.z : float3( 0.0, 0.0, 1.0 );
+
+	m.r0.xyz = row0 * scale.x;
+	m.r1.xyz = row1 * scale.y;
+	m.r2.xyz = row2 * scale.z;
+	return m;
+}
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_WorkGroupID			: SV_GroupID,
+	uint gl_LocalInvocationIndex	: SV_GroupIndex
+)
+{
+	uint instanceIdx = gl_WorkGroupID.y * groupsPerRow + gl_WorkGroupID.x;
+	if( instanceIdx >= numInstances )
+		return;
+
+	float4 header = skeletonData.Load( 0u );
+	uint numBones		= asuint( header.x );
+	uint numLevels		= asuint( header.y );
+	uint trackDescStart	= asuint( header.w );
+	uint boneDataStart	= 1u + ((numLevels + 4u) >> 2u);
+
+	uint instanceStart = instanceIdx * 8u;
+	float4 instanceHeader = instanceData.Load( instanceStart );
+	uint outputStart = asuint( instanceHeader.x );
+	uint numActiveAnims = asuint( instanceHeader.y );
+
+	Mat3x4 nodeMat;
+	nodeMat.r0 = instanceData.Load( instanceStart + 1u );
+	nodeMat.r1 = instanceData.Load( instanceStart + 2u );
+	nodeMat.r2 = instanceData.Load( instanceStart + 3u );
+
+	for( uint level=0u; level<numLevels; ++level )
+	{
+		uint levelStart	= asuint( skeletonData.Load( 1u + (level >> 2u) )[level & 3u] );
+		uint levelEnd	= asuint( skeletonData.Load( 1u + ((level + 1u) >> 2u) )[(level + 1u) & 3u] );
+
+		for( uint bone=levelStart + gl_LocalInvocationIndex; bone<levelEnd; bone += uint( NUM_THREADS ) )
+		{
+			uint boneData = boneDataStart + bone * 6u;
+			float4 posAndParent	= skeletonData.Load( boneData );
+			float4 rot			= skeletonData.Load( boneData + 1u );
+			float4 scaleAndFlags	= skeletonData.Load( boneData + 2u );
+
+			float3 pos	= posAndParent.xyz;
+			float3 scale	= scaleAndFlags.xyz;
+
+			for( uint i=0u; i<numActiveAnims; ++i )
+			{
+				float4 anim = instanceData.Load( instanceStart + 4u + i );
+				uint animIdx = asuint( anim.x );
+				float frame = anim.y;
+				float weight = anim.z;
+
+				float4 trackDesc = skeletonData.Load( trackDescStart + animIdx * numBones + bone );
+				uint firstKeyFrame = asuint( trackDesc.x );
+				uint numKeyFrames = asuint( trackDesc.y );
+
+				if( numKeyFrames == 0u )
+					continue;
+
+				//Find the last keyframe at or before frame
+				uint lo = 0u;
+				uint hi = numKeyFrames - 1u;
+				while( lo < hi )
+				{
+					uint mid = (lo + hi + 1u) >> 1u;
+					if( skeletonData.Load( firstKeyFrame + mid * 3u ).w <= frame )
+						lo = mid;
+					else
+						hi = mid - 1u;
+				}
+				uint prevKf = firstKeyFrame + lo * 3u;
+				uint nextKf = firstKeyFrame + min( lo + 1u, numKeyFrames - 1u ) * 3u;
+
+				float4 prevPosFrame = skeletonData.Load( prevKf );
+				float4 nextPosFrame = skeletonData.Load( nextKf );
+				float fTimeW = nextPosFrame.w > prevPosFrame.w ?
+								   clamp( (frame - prevPosFrame.w) / (nextPosFrame.w - prevPosFrame.w), 0.0, 1.0 ) :
+								   0.0;
+
+				float3 interpPos = lerp( prevPosFrame.xyz, nextPosFrame.xyz, fTimeW );
+				float4 interpRot = nlerpShortest( fTimeW, skeletonData.Load( prevKf + 1u ),
+												skeletonData.Load( nextKf + 1u ) );
+				float3 interpScale = lerp( skeletonData.Load( prevKf + 2u ).xyz,
+										skeletonData.Load( nextKf + 2u ).xyz, fTimeW );
+
+				pos += interpPos * weight;
+				scale *= lerp( (float3)1.0, interpScale, weight );
+				rot = qmul( rot, nlerpShortest( weight, float4( 0.0, 0.0, 0.0, 1.0 ), interpRot ) );
+			}
+
+			uint parentIdx = asuint( posAndParent.w );
+			uint flags = asuint( scaleAndFlags.w );
+
+			Mat3x4 derived = makeTransform( pos, scale, rot );
+			if( parentIdx != 0xFFFFFFFFu )
+			{
+				Mat3x4 parentMat;
+				parentMat.r0 = g_derived[parentIdx * 3u + 0u];
+				parentMat.r1 = g_derived[parentIdx * 3u + 1u];
+				parentMat.r2 = g_derived[parentIdx * 3u + 2u];
+				if( (flags & 3u) != 3u )
+					parentMat = retain( parentMat, flags );
+				derived = mulMat( parentMat, derived );
+			}
+
+			g_derived[bone * 3u + 0u] = derived.r0;
+			g_derived[bone * 3u + 1u] = derived.r1;
+			g_derived[bone * 3u + 2u] = derived.r2;
+
+			Mat3x4 reverseBind;
+			reverseBind.r0 = skeletonData.Load( boneData + 3u );
+			reverseBind.r1 = skeletonData.Load( boneData + 4u );
+			reverseBind.r2 = skeletonData.Load( boneData + 5u );
+
+			Mat3x4 finalMat = mulMat( nodeMat, mulMat( derived, reverseBind ) );
+
+			uint dst = outputStart + (flags >> 2u) * 3u;
+			boneMatrices[dst + 0u] = finalMat.r0;
+			boneMatrices[dst + 1u] = finalMat.r1;
+			boneMatrices[dst + 2u] = finalMat.r2;
+		}
+
+		//The next level reads its parents' derived transforms
+		GroupMemoryBarrierWithGroupSync();
+	}
+}
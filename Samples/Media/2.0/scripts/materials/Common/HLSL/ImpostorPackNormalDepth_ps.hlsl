@@ -0,0 +1,71 @@
+//Reconstructs the object space normals of an impostor atlas from the depth buffer the
+//frames were rendered with, and packs them with the linear depth. See ImpostorManager.
+//packParams.x = frames per side (N); y = resolution of a frame; zw = linear depth = d * z + w
+//Frames are placed in an N x N grid indexed by their octahedral coordinates (Y up)
+
+Texture2D<float> depthTexture : register(t0);
+
+float loadLinearDepth( int2 iUv, float4 packParams )
+{
+	return depthTexture.Load( int3( iUv, 0 ) ).x * packParams.z + packParams.w;
+}
+
+//Returns the depth difference with the neighbour on the side with the smaller gradient,
+//so that the normals don't bleed across silhouettes
+float depthGradient( int2 iUv, int2 dir, int2 tileMin, int2 tileMax, float depth,
+					 float4 packParams )
+{
+	int2 prevUv = clamp( iUv - dir, tileMin, tileMax );
+	int2 nextUv = clamp( iUv + dir, tileMin, tileMax );
+	float prevDepth = depth - loadLinearDepth( prevUv, packParams );
+	float nextDepth = loadLinearDepth( nextUv, packParams ) - depth;
+	if( all( prevUv == iUv ) )
+		return nextDepth;
+	if( all( nextUv == iUv ) )
+		return prevDepth;
+	return abs( prevDepth ) < abs( nextDepth ) ? prevDepth : nextDepth;
+}
+
+float4 main
+(
+	float2 uv0 : TEXCOORD0,
+	uniform float4 packParams
+) : SV_Target
+{
+	int framesPerSide	= int( packParams.x );
+	int frameRes		= int( packParams.y );
+
+	int2 texSize;
+	depthTexture.GetDimensions( texSize.x, texSize.y );
+	int2 iUv = min( int2( uv0 * float2( texSize ) ), texSize - 1 );
+
+	float depth = loadLinearDepth( iUv, packParams );
+	if( depth >= 1.0 )
+		return float4( 0.5, 0.5, 0.5, 1.0 );
+
+	int2 frame = min( iUv / frameRes, framesPerSide - 1 );
+	int2 tileMin = frame * frameRes;
+	int2 tileMax = tileMin + frameRes - 1;
+
+	//Depth spans 2 * radius and a frame 2 * radius, thus the slope is the
+	//depth difference in texels times the resolution. Rows go downwards
+	float dzdx = depthGradient( iUv, int2( 1, 0 ), tileMin, tileMax, depth, packParams ) *
+				 float( frameRes );
+	float dzdy = -depthGradient( iUv, int2( 0, 1 ), tileMin, tileMax, depth, packParams ) *
+				 float( frameRes );
+	float3 viewNormal = normalize( float3( dzdx, dzdy, 1.0 ) );
+
+	//Basis of the camera the frame was captured with
+	float2 f = float2( frame ) * (2.0 / (packParams.x - 1.0)) - 1.0;
+	float3 dir = float3( f.x, 1.0 - abs( f.x ) - abs( f.y ), f.y );
+	float t = saturate( -dir.y );
+	dir.x += dir.x >= 0.0 ? -t : t;
+	dir.z += dir.z >= 0.0 ? -t : t;
+	dir = normalize( dir );
+	float3 up = abs( dir.y ) > 0.999 ? float3( 0, 0, 1 ) : float3( 0, 1, 0 );
+	float3 right = normalize( cross( up, dir ) );
+	up = cross( dir, right );
+
+	float3 normal = right * viewNormal.x + up * viewNormal.y + dir * viewNormal.z;
+	return float4( normal * 0.5 + 0.5, depth );
+}
@@ -0,0 +1,23 @@
+
+//Warps the last rendered frame to the camera's latest orientation (rotational reprojection).
+//reprojectionMatrix goes from the current NDC to the NDC the frame was rendered with
+//(see CompositorPassQuadDef::mReprojection). Areas that weren't rendered get reprojected
+//from the closest edge.
+
+Texture2D<float4> lastFrame		: register(t0);
+SamplerState lastFrameSampler	: register(s0);
+
+float4 main
+(
+	float2 uv0 : TEXCOORD0,
+
+	uniform float4x4 reprojectionMatrix
+) : SV_Target
+{
+	float4 ndc = float4( uv0.x * 2.0 - 1.0, 1.0 - uv0.y * 2.0, 1.0, 1.0 );
+	float4 srcNdc = mul( reprojectionMatrix, ndc );
+	srcNdc.xy /= srcNdc.w;
+
+	float2 srcUv = float2( srcNdc.x * 0.5 + 0.5, 0.5 - srcNdc.y * 0.5 );
+	return lastFrame.Sample( lastFrameSampler, srcUv );
+}
@@ -0,0 +1,82 @@
+
+//Converts an RGB texture into the two planes of NV12: full resolution luma (R8) and
+//half resolution interleaved CbCr (RG8). Each thread handles a 2x2 block, writing
+//4 luma texels and their averaged chroma (see VideoFrameCapture).
+
+Texture2D<float4> srcTex : register(t0);
+
+RWTexture2D<float2> dstChroma : register(u0);
+RWTexture2D<float> dstLuma : register(u1);
+
+@property( srgb )
+float3 toSRgb( float3 lin )
+{
+	lin = clamp( lin, 0.0, 1.0 );
+	float3 lo = lin * 12.92;
+	float3 hi = 1.055 * pow( lin, 1.0 / 2.4 ) - 0.055;
+	return lerp( hi, lo, step( lin, 0.0031308 ) );
+}
+@end
+
+@property( bt601 )
+	static const float3 c_lumaWeights	= float3( 0.299, 0.587, 0.114 );
+	static const float3 c_cbWeights		= float3( -0.168736, -0.331264, 0.5 );
+	static const float3 c_crWeights		= float3( 0.5, -0.418688, -0.081312 );
+@else
+	static const float3 c_lumaWeights	= float3( 0.2126, 0.7152, 0.0722 );
+	static const float3 c_cbWeights		= float3( -0.114572, -0.385428, 0.5 );
+	static const float3 c_crWeights		= float3( 0.5, -0.454153, -0.045847 );
+@end
+
+@property( full_range )
+	static const float c_lumaScale		= 1.0;
+	static const float c_lumaOffset		= 0.0;
+	static const float c_chromaScale	= 1.0;
+@else
+	static const float c_lumaScale		= 219.0 / 255.0;
+	static const float c_lumaOffset		= 16.0 / 255.0;
+	static const float c_chromaScale	= 224.0 / 255.0;
+@end
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_GlobalInvocationID : SV_DispatchThreadId
+)
+{
+	int2 blockPos = int2( gl_GlobalInvocationID.xy );
+
+	uint chromaWidth, chromaHeight;
+	dstChroma.GetDimensions( chromaWidth, chromaHeight );
+	if( blockPos.x >= int( chromaWidth ) || blockPos.y >= int( chromaHeight ) )
+		return;
+
+	uint lumaWidth, lumaHeight;
+	dstLuma.GetDimensions( lumaWidth, lumaHeight );
+	uint srcWidth, srcHeight;
+	srcTex.GetDimensions( srcWidth, srcHeight );
+	int2 srcSize = int2( srcWidth, srcHeight );
+
+	float3 rgbSum = float3( 0.0, 0.0, 0.0 );
+	for( int y=0; y<2; ++y )
+	{
+		for( int x=0; x<2; ++x )
+		{
+			int2 dstPos = blockPos * 2 + int2( x, y );
+			//Replicate the edges for odd resolutions
+			float3 rgb = srcTex.Load( int3( min( dstPos, srcSize - 1 ), 0 ) ).xyz;
+			@property( srgb )
+				rgb = toSRgb( rgb );
+			@end
+			rgb = saturate( rgb );
+			rgbSum += rgb;
+
+			if( dstPos.x < int( lumaWidth ) && dstPos.y < int( lumaHeight ) )
+				dstLuma[dstPos] = dot( rgb, c_lumaWeights ) * c_lumaScale + c_lumaOffset;
+		}
+	}
+
+	float3 rgb = rgbSum * 0.25;
+	dstChroma[blockPos] = float2( dot( rgb, c_cbWeights ), dot( rgb, c_crWeights ) ) *
+						  c_chromaScale + 128.0 / 255.0;
+}
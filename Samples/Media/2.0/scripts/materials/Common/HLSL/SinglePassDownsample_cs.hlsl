@@ -0,0 +1,115 @@
+
+//Single pass downsampler (same idea as AMD's FidelityFX SPD): each threadgroup reduces a
+//64x64 tile of the source mip into up to 6 mips using shared memory, so that a whole mip
+//chain needs one dispatch every 6 mips rather than one (or two) per mip.
+//See ComputeDownsampler.
+
+@property( texture_is_array )
+	Texture2DArray<float4> srcTex : register(t0);
+	@foreach( num_dst_mips, n )
+	RWTexture2DArray<@insertpiece(uav@n_pf_type)> dstMip@n : register(u@n);@end
+	#define TEX_COORD( uv ) int3( uv, int( gl_WorkGroupID.z ) )
+	#define LOAD_COORD( uv ) int4( uv, int( gl_WorkGroupID.z ), 0 )
+@else
+	Texture2D<float4> srcTex : register(t0);
+	@foreach( num_dst_mips, n )
+	RWTexture2D<@insertpiece(uav@n_pf_type)> dstMip@n : register(u@n);@end
+	#define TEX_COORD( uv ) uv
+	#define LOAD_COORD( uv ) int3( uv, 0 )
+@end
+
+//The 32x32 tile of the first mip. Deeper mips are stored in place with the same stride
+groupshared float4 g_lds[1024];
+
+float4 reduce4( float4 a, float4 b, float4 c, float4 d )
+{
+@property( downsample_min )
+	return min( min( a, b ), min( c, d ) );
+@else @property( downsample_max )
+	return max( max( a, b ), max( c, d ) );
+@else
+	return ( a + b + c + d ) * 0.25;
+@end @end
+}
+
+float4 encodeOutput( float4 value )
+{
+@property( srgb )
+	//UAVs can't be sRGB, they're bound with the linear equivalent format
+	float3 lin = saturate( value.xyz );
+	float3 lo = lin * 12.92;
+	float3 hi = 1.055 * pow( lin, 1.0 / 2.4 ) - 0.055;
+	return float4( lerp( hi, lo, step( lin, 0.0031308 ) ), value.w );
+@else
+	return value;
+@end
+}
+
+[numthreads(@value( threads_per_group_x ), @value( threads_per_group_y ), @value( threads_per_group_z ))]
+void main
+(
+	uint3 gl_WorkGroupID : SV_GroupID,
+	uint gl_LocalInvocationIndex : SV_GroupIndex
+)
+{
+	int localIdx = int( gl_LocalInvocationIndex );
+
+	uint srcWidth, srcHeight, dstWidth, dstHeight;
+@property( texture_is_array )
+	uint numSlices, numLevels;
+	srcTex.GetDimensions( 0, srcWidth, srcHeight, numSlices, numLevels );
+	dstMip0.GetDimensions( dstWidth, dstHeight, numSlices );
+@else
+	srcTex.GetDimensions( srcWidth, srcHeight );
+	dstMip0.GetDimensions( dstWidth, dstHeight );
+@end
+	int2 srcMaxCoord = int2( srcWidth, srcHeight ) - 1;
+
+	//First mip: each thread outputs 4 of the 32x32 texels of the tile
+	for( int i=0; i<4; ++i )
+	{
+		int ldsIdx = localIdx + i * 256;
+		int2 dstPos = int2( gl_WorkGroupID.xy ) * 32 + int2( ldsIdx & 31, ldsIdx >> 5 );
+		//Clamping replicates the edges for odd resolutions
+		int2 srcPos = dstPos * 2;
+		float4 value = reduce4(
+			srcTex.Load( LOAD_COORD( min( srcPos, srcMaxCoord ) ) ),
+			srcTex.Load( LOAD_COORD( min( srcPos + int2( 1, 0 ), srcMaxCoord ) ) ),
+			srcTex.Load( LOAD_COORD( min( srcPos + int2( 0, 1 ), srcMaxCoord ) ) ),
+			srcTex.Load( LOAD_COORD( min( srcPos + int2( 1, 1 ), srcMaxCoord ) ) ) );
+		g_lds[ldsIdx] = value;
+		if( dstPos.x < int( dstWidth ) && dstPos.y < int( dstHeight ) )
+			dstMip0[TEX_COORD( dstPos )] = encodeOutput( value );
+	}
+@foreach( num_dst_mips, n, 1 )
+	{
+		const int mipSize = 32 >> @n;
+		bool isActive = localIdx < mipSize * mipSize;
+		int2 localPos = int2( localIdx % mipSize, localIdx / mipSize );
+
+		GroupMemoryBarrierWithGroupSync();
+
+		float4 value = float4( 0.0, 0.0, 0.0, 0.0 );
+		if( isActive )
+		{
+			int base = localPos.y * 64 + localPos.x * 2;
+			value = reduce4( g_lds[base], g_lds[base + 1], g_lds[base + 32], g_lds[base + 33] );
+		}
+
+		GroupMemoryBarrierWithGroupSync();
+
+		if( isActive )
+		{
+			g_lds[localPos.y * 32 + localPos.x] = value;
+			int2 dstPos = int2( gl_WorkGroupID.xy ) * mipSize + localPos;
+		@property( texture_is_array )
+			dstMip@n.GetDimensions( dstWidth, dstHeight, numSlices );
+		@else
+			dstMip@n.GetDimensions( dstWidth, dstHeight );
+		@end
+			if( dstPos.x < int( dstWidth ) && dstPos.y < int( dstHeight ) )
+				dstMip@n[TEX_COORD( dstPos )] = encodeOutput( value );
+		}
+	}
+@end
+}
@@ -0,0 +1,59 @@
+
+//Temporal antialiasing resolve. Blends the current frame with the reprojected history
+//(see CompositorPassSceneDef::mGenMotionVectors), clipping the history to the colour
+//distribution of the current pixel's neighbourhood to reject stale data.
+//currFrame & motionVectors may be smaller than the output (temporal upscaling);
+//history must be the same resolution as the output.
+
+Texture2D<float4> currFrame		: register(t0);
+Texture2D<float2> motionVectors	: register(t1);
+Texture2D<float4> history		: register(t2);
+
+SamplerState currFrameSampler	: register(s0);
+SamplerState historySampler		: register(s2);
+
+float4 main
+(
+	float2 uv0 : TEXCOORD0,
+
+	uniform float blendFactor
+) : SV_Target
+{
+	int2 currSize;
+	currFrame.GetDimensions( currSize.x, currSize.y );
+	int2 currPixel = min( int2( uv0 * float2( currSize ) ), currSize - 1 );
+
+	float3 currColour = currFrame.Sample( currFrameSampler, uv0 ).xyz;
+
+	//Variance clipping box of the 3x3 neighbourhood
+	float3 m1 = float3( 0, 0, 0 );
+	float3 m2 = float3( 0, 0, 0 );
+	for( int y=-1; y<=1; ++y )
+	{
+		for( int x=-1; x<=1; ++x )
+		{
+			int2 pos = clamp( currPixel + int2( x, y ), int2( 0, 0 ), currSize - 1 );
+			float3 neighbour = currFrame.Load( int3( pos, 0 ) ).xyz;
+			m1 += neighbour;
+			m2 += neighbour * neighbour;
+		}
+	}
+	float3 mean = m1 / 9.0;
+	float3 sigma = sqrt( abs( m2 / 9.0 - mean * mean ) );
+	float3 minColour = min( mean - sigma, currColour );
+	float3 maxColour = max( mean + sigma, currColour );
+
+	float2 historyUv = uv0 + motionVectors.Load( int3( currPixel, 0 ) ).xy;
+	float4 historyColour = history.Sample( historySampler, historyUv );
+
+	//History is cleared to 0 (including alpha) before the first frame
+	bool validHistory = historyColour.w > 0.0 &&
+						all( historyUv >= float2( 0, 0 ) ) &&
+						all( historyUv <= float2( 1, 1 ) );
+
+	float3 clippedHistory = clamp( historyColour.xyz, minColour, maxColour );
+	float4 retVal;
+	retVal.xyz = validHistory ? lerp( clippedHistory, currColour, blendFactor ) : currColour;
+	retVal.w = 1.0;
+	return retVal;
+}
@@ -0,0 +1,26 @@
+
+//Weighted blended order independent transparency resolve (McGuire & Bavoil 2013).
+//accumTex.rgb holds the sum of the weighted premultiplied colours, accumTex.a the
+//product of (1 - alpha), i.e. how much of the background is left. See OitMode::WeightedBlended
+
+Texture2D<float4> accumTex	: register(t0);
+Texture2D<float> weightTex	: register(t1);
+
+float4 main
+(
+	float2 uv0 : TEXCOORD0
+) : SV_Target
+{
+	int2 texSize;
+	accumTex.GetDimensions( texSize.x, texSize.y );
+	int2 iUv = min( int2( uv0 * float2( texSize ) ), texSize - 1 );
+
+	float4 accum = accumTex.Load( int3( iUv, 0 ) );
+	float revealage = accum.w;
+	if( revealage >= 1.0 )
+		discard;
+
+	float weight = weightTex.Load( int3( iUv, 0 ) ).x;
+
+	return float4( accum.xyz / max( weight, 1e-5 ), 1.0 - revealage );
+}
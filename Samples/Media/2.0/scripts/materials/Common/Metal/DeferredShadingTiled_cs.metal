@@ -0,0 +1,197 @@
+
+//Tiled deferred shading of Forward+ lights (point & spot). Each threadgroup is one
+//screen tile: it finds the tile's depth range, culls the Forward+ global light list
+//against the tile's view space bounds, and then shades every pixel of the tile with
+//the surviving lights, adding the result on top of the forward colour written by the
+//render_scene pass with gen_gbuffer.
+//The light list layout follows ForwardPlusBase::fillGlobalLightListBuffer
+//(6 float4 per light, in view space) and is bound by the compute pass via
+//forward_plus_lights.
+
+#include <metal_stdlib>
+using namespace metal;
+
+struct Params
+{
+	float4 frustumExtents;
+	float2 projectionParams;
+	uint numLights;
+};
+
+#define NUM_THREADS (@value( threads_per_group_x ) * @value( threads_per_group_y ))
+#define MAX_LIGHTS_PER_TILE @value( max_lights_per_tile )
+
+/// Same as the Default BRDF from HlmsPbs (without GGX_height_correlated nor
+/// fresnel_separate_diffuse) since that's what the lights would've used in forward.
+inline float3 BRDF( float3 lightDir, float3 viewDir, float NdotV, float3 lightDiffuse,
+					float3 lightSpecular, float3 normal, float3 diffuse, float3 F0,
+					float roughness )
+{
+	float3 halfWay = normalize( lightDir + viewDir );
+	float NdotL = saturate( dot( normal, lightDir ) );
+	float NdotH = saturate( dot( normal, halfWay ) );
+	float VdotH = saturate( dot( viewDir, halfWay ) );
+
+	float sqR = roughness * roughness;
+
+	float f = ( NdotH * sqR - NdotH ) * NdotH + 1.0;
+	float R = sqR / (f * f + 1e-6f);
+
+	float gL = NdotL * (1.0 - sqR) + sqR;
+	float gV = NdotV * (1.0 - sqR) + sqR;
+	float G = 1.0 / (( gL * gV + 1e-4f ) * 4.0 * 3.141592654);
+
+	float3 fresnelS = F0 + pow( 1.0 - VdotH, 5.0 ) * (1.0 - F0);
+
+	float3 Rs = ( fresnelS * (R * G) ) * lightSpecular;
+
+	float energyBias	= roughness * 0.5;
+	float energyFactor	= mix( 1.0, 1.0 / 1.51, roughness );
+	float fd90			= energyBias + 2.0 * VdotH * VdotH * roughness;
+	float lightScatter	= 1.0 + (fd90 - 1.0) * pow( 1.0 - NdotL, 5.0 );
+	float viewScatter	= 1.0 + (fd90 - 1.0) * pow( 1.0 - NdotV, 5.0 );
+
+	float fresnelD = 1.0 - max( fresnelS.x, max( fresnelS.y, fresnelS.z ) );
+
+	float3 Rd = (lightScatter * viewScatter * energyFactor * fresnelD) * diffuse * lightDiffuse;
+
+	return NdotL * (Rs + Rd);
+}
+
+kernel void main_metal
+(
+	depth2d<float> depthTexture				[[texture(0)]],
+	texture2d<float> gBufNormals			[[texture(1)]],
+	texture2d<float> gBufAlbedo				[[texture(2)]],
+	texture2d<float> gBufF0Roughness		[[texture(3)]],
+	texture2d<float> forwardColour			[[texture(4)]],
+	device const float4 *lightList			[[buffer(TEX_SLOT_START+5)]],
+
+	texture2d<float, access::write> dstTex	[[texture(UAV_SLOT_START)]],
+
+	constant Params &p [[buffer(PARAMETER_SLOT)]],
+
+	uint3 gl_GlobalInvocationID		[[thread_position_in_grid]],
+	uint3 gl_WorkGroupID			[[threadgroup_position_in_grid]],
+	uint gl_LocalInvocationIndex	[[thread_index_in_threadgroup]]
+)
+{
+	//Linear depth is always positive, thus its bits can be compared as uints
+	threadgroup atomic_uint g_minDepth;
+	threadgroup atomic_uint g_maxDepth;
+	threadgroup atomic_uint g_numTileLights;
+	threadgroup uint g_tileLights[MAX_LIGHTS_PER_TILE];
+
+	int2 pixel = int2( gl_GlobalInvocationID.xy );
+	int2 dstSize = int2( dstTex.get_width(), dstTex.get_height() );
+	bool inBounds = pixel.x < dstSize.x && pixel.y < dstSize.y;
+
+	if( gl_LocalInvocationIndex == 0u )
+	{
+		atomic_store_explicit( &g_minDepth, 0x7F7FFFFFu, memory_order_relaxed );
+		atomic_store_explicit( &g_maxDepth, 0u, memory_order_relaxed );
+		atomic_store_explicit( &g_numTileLights, 0u, memory_order_relaxed );
+	}
+	threadgroup_barrier( mem_flags::mem_threadgroup );
+
+	uint2 loadPos = uint2( min( pixel, dstSize - 1 ) );
+	float fDepth = depthTexture.read( loadPos, 0 );
+	float linearDepth = p.projectionParams.y / (fDepth - p.projectionParams.x);
+
+	atomic_fetch_min_explicit( &g_minDepth, as_type<uint>( linearDepth ), memory_order_relaxed );
+	atomic_fetch_max_explicit( &g_maxDepth, as_type<uint>( linearDepth ), memory_order_relaxed );
+	threadgroup_barrier( mem_flags::mem_threadgroup );
+
+	//Tile bounds in view space. Row 0 is the top of the screen.
+	const uint2 groupSize = uint2( @value( threads_per_group_x ), @value( threads_per_group_y ) );
+	float2 invDstSize = 1.0 / float2( dstSize );
+	float2 tileStart = float2( gl_WorkGroupID.xy * groupSize ) * invDstSize;
+	float2 tileEnd = float2( (gl_WorkGroupID.xy + 1u) * groupSize ) * invDstSize;
+
+	float2 tanStart = float2( mix( p.frustumExtents.x, p.frustumExtents.y, tileStart.x ),
+							  mix( p.frustumExtents.z, p.frustumExtents.w, tileStart.y ) );
+	float2 tanEnd = float2( mix( p.frustumExtents.x, p.frustumExtents.y, tileEnd.x ),
+							mix( p.frustumExtents.z, p.frustumExtents.w, tileEnd.y ) );
+	float2 tanMin = min( tanStart, tanEnd );
+	float2 tanMax = max( tanStart, tanEnd );
+
+	float tileMinDepth = as_type<float>( atomic_load_explicit( &g_minDepth, memory_order_relaxed ) );
+	float tileMaxDepth = as_type<float>( atomic_load_explicit( &g_maxDepth, memory_order_relaxed ) );
+
+	float3 aabbMin = float3( min( tanMin * tileMinDepth, tanMin * tileMaxDepth ), -tileMaxDepth );
+	float3 aabbMax = float3( max( tanMax * tileMinDepth, tanMax * tileMaxDepth ), -tileMinDepth );
+
+	for( uint i=gl_LocalInvocationIndex; i<p.numLights; i += uint( NUM_THREADS ) )
+	{
+		float4 posAndType = lightList[i * 6u];
+		float range = lightList[i * 6u + 3u].x;
+
+		float3 closest = clamp( posAndType.xyz, aabbMin, aabbMax ) - posAndType.xyz;
+		if( dot( closest, closest ) <= range * range )
+		{
+			uint idx = atomic_fetch_add_explicit( &g_numTileLights, 1u, memory_order_relaxed );
+			if( idx < uint( MAX_LIGHTS_PER_TILE ) )
+				g_tileLights[idx] = i;
+		}
+	}
+	threadgroup_barrier( mem_flags::mem_threadgroup );
+
+	if( !inBounds )
+		return;
+
+	uint2 uPixel = uint2( pixel );
+	float4 finalColour = forwardColour.read( uPixel, 0 );
+	float4 f0Roughness = gBufF0Roughness.read( uPixel, 0 );
+	float3 diffuse = gBufAlbedo.read( uPixel, 0 ).xyz;
+	float3 normal = normalize( gBufNormals.read( uPixel, 0 ).xyz * 2.0 - 1.0 );
+
+	float2 uv = (float2( pixel ) + 0.5) * invDstSize;
+	float3 pos = float3( mix( p.frustumExtents.x, p.frustumExtents.y, uv.x ) * linearDepth,
+						 mix( p.frustumExtents.z, p.frustumExtents.w, uv.y ) * linearDepth,
+						 -linearDepth );
+	float3 viewDir = normalize( -pos );
+	float NdotV = saturate( dot( normal, viewDir ) );
+	float roughness = max( f0Roughness.w, 0.02 );
+
+	uint numTileLights = min( atomic_load_explicit( &g_numTileLights, memory_order_relaxed ),
+							  uint( MAX_LIGHTS_PER_TILE ) );
+	for( uint j=0u; j<numTileLights; ++j )
+	{
+		uint idx = g_tileLights[j] * 6u;
+
+		float4 posAndType		= lightList[idx];
+		float3 lightDiffuse		= lightList[idx + 1u].xyz;
+		float3 lightSpecular	= lightList[idx + 2u].xyz;
+		float4 attenuation		= lightList[idx + 3u];
+
+		float3 lightDir	= posAndType.xyz - pos;
+		float fDistance	= length( lightDir );
+
+		if( fDistance <= attenuation.x )
+		{
+			lightDir *= 1.0 / fDistance;
+			float atten = 1.0 / (0.5 + (attenuation.y + attenuation.z * fDistance) * fDistance );
+			@property( fade_attenuation_range )
+				atten *= max( (attenuation.x - fDistance) * attenuation.w, 0.0f );
+			@end
+
+			if( posAndType.w == 2.0 )
+			{
+				//Spot light
+				float3 spotDirection	= lightList[idx + 4u].xyz;
+				float3 spotParams		= lightList[idx + 5u].xyz;
+
+				float spotCosAngle = dot( -lightDir, spotDirection );
+				float spotAtten = saturate( (spotCosAngle - spotParams.y) * spotParams.x );
+				atten *= pow( spotAtten, spotParams.z );
+				if( spotCosAngle < spotParams.y )
+					atten = 0.0;
+			}
+
+			finalColour.xyz += BRDF( lightDir, viewDir, NdotV, lightDiffuse, lightSpecular,
+									 normal, diffuse, f0Roughness.xyz, roughness ) * atten;
+		}
+	}
+
+	dstTex.write( finalColour, uPixel );
+}
@@ -0,0 +1,172 @@
+//Simulates the particles of a ParticleSystem simulated by GpuParticleSimulator and writes
+//the camera facing quads (like BBT_POINT billboards) the system is rendered with.
+//Each thread is one particle slot. Particles that die are pushed back into the dead list,
+//and dead slots output degenerate quads. Affectors use the same math as their CPU versions.
+//The layout of the params & particles is documented in GpuParticleSimulator.cpp
+
+#include <metal_stdlib>
+using namespace metal;
+
+#define HEADER_FLOAT4	10u
+#define EMITTER_FLOAT4	10u
+#define AFFECTOR_FLOAT4	3u
+#define MAX_EMITTERS	16u
+
+#define AFFECTOR_LINEAR_FORCE		0u
+#define AFFECTOR_COLOUR_FADER		1u
+#define AFFECTOR_SCALER				2u
+#define AFFECTOR_ROTATOR			3u
+#define AFFECTOR_DEFLECTOR_PLANE	4u
+
+#define fetchParams( idx ) paramsBuffer[idx]
+
+kernel void main_metal
+(
+	device const float4 *paramsBuffer	[[buffer(TEX_SLOT_START+0)]],
+
+	device float4 *particles			[[buffer(UAV_SLOT_START+0)]],
+	device atomic_uint *deadListCounter	[[buffer(UAV_SLOT_START+1)]],
+	//pos3, colour4, uv2 per vertex
+	device float *vertices				[[buffer(UAV_SLOT_START+2)]],
+
+	uint3 gl_GlobalInvocationID	[[thread_position_in_grid]]
+)
+{
+	//The counter (deadList[0]) is accessed atomically, the indices that follow it are not
+	device uint *deadList = reinterpret_cast<device uint*>( deadListCounter );
+
+	float4 header0 = fetchParams( 0u );
+	float4 header1 = fetchParams( 1u );
+	uint numAffectors	= as_type<uint>( header0.y );
+	uint quota			= as_type<uint>( header0.z );
+	float timeElapsed	= header1.x;
+	bool rotateVertices	= as_type<uint>( header1.z ) != 0u;
+
+	uint slot = gl_GlobalInvocationID.x;
+	if( slot >= quota )
+		return;
+
+	uint src = slot * 4u;
+	float4 p0 = particles[src + 0u];
+	float4 p1 = particles[src + 1u];
+	float4 p2 = particles[src + 2u];
+	float4 p3 = particles[src + 3u];
+
+	bool isAlive = p0.w >= 0.0;
+
+	if( isAlive )
+	{
+		if( p1.w < 0.0 )
+		{
+			//Born this frame. The emit job already applied the time elapsed since emission
+			p1.w = -p1.w - 1.0;
+		}
+		else if( p0.w < timeElapsed )
+		{
+			//Died. Until it's taken again, nothing reads the slot
+			isAlive = false;
+			p0.w = -1.0;
+			uint idx = atomic_fetch_add_explicit( deadListCounter, 1u, memory_order_relaxed );
+			deadList[idx + 1u] = slot;
+		}
+		else
+		{
+			p0.w -= timeElapsed;
+
+			for( uint i=0u; i<numAffectors; ++i )
+			{
+				uint affectorStart = HEADER_FLOAT4 + MAX_EMITTERS * EMITTER_FLOAT4 + i * AFFECTOR_FLOAT4;
+				float4 a0 = fetchParams( affectorStart );
+				float4 a1 = fetchParams( affectorStart + 1u );
+				uint type = as_type<uint>( a0.x );
+
+				if( type == AFFECTOR_LINEAR_FORCE )
+				{
+					if( as_type<uint>( a0.y ) != 0u )
+						p1.xyz = (p1.xyz + a1.xyz) * 0.5;
+					else
+						p1.xyz += a1.xyz * timeElapsed;
+				}
+				else if( type == AFFECTOR_COLOUR_FADER )
+				{
+					p2 = saturate( p2 + a1 * timeElapsed );
+				}
+				else if( type == AFFECTOR_SCALER )
+				{
+					p3.xy += a1.x * timeElapsed;
+				}
+				else if( type == AFFECTOR_ROTATOR )
+				{
+					p3.z += p3.w * timeElapsed;
+				}
+				else if( type == AFFECTOR_DEFLECTOR_PLANE )
+				{
+					float3 direction = p1.xyz * timeElapsed;
+					if( dot( a1.xyz, p0.xyz + direction ) + a1.w <= 0.0 )
+					{
+						float a = dot( a1.xyz, p0.xyz ) + a1.w;
+						if( a > 0.0 )
+						{
+							float bounce = fetchParams( affectorStart + 2u ).x;
+							float3 directionPart = direction * (-a / dot( direction, a1.xyz ));
+							p0.xyz = (p0.xyz + directionPart) + (directionPart - direction) * bounce;
+							p1.xyz = (p1.xyz - (2.0 * dot( p1.xyz, a1.xyz ) * a1.xyz)) * bounce;
+						}
+					}
+				}
+			}
+
+			p0.xyz += p1.xyz * timeElapsed;
+		}
+
+		particles[src + 0u] = p0;
+		particles[src + 1u] = p1;
+		particles[src + 2u] = p2;
+		particles[src + 3u] = p3;
+	}
+
+	float3 cameraRight = fetchParams( 8u ).xyz;
+	float3 cameraUp = fetchParams( 9u ).xyz;
+	float4 r0 = fetchParams( 5u );
+	float4 r1 = fetchParams( 6u );
+	float4 r2 = fetchParams( 7u );
+
+	float2 halfSize = isAlive ? max( p3.xy, float2( 0.0 ) ) * 0.5 : float2( 0.0 );
+	float cosRot = cos( p3.z );
+	float sinRot = sin( p3.z );
+
+	uint dst = slot * 4u * 9u;
+	for( uint c=0u; c<4u; ++c )
+	{
+		float2 offset = float2( (c & 1u) != 0u ? 1.0 : -1.0, (c & 2u) != 0u ? -1.0 : 1.0 );
+		float2 uv = float2( float( c & 1u ), float( c >> 1u ) );
+
+		if( rotateVertices )
+		{
+			offset = float2( offset.x * cosRot - offset.y * sinRot,
+						   offset.x * sinRot + offset.y * cosRot );
+		}
+		else
+		{
+			float2 centered = uv - 0.5;
+			uv = float2( centered.x * cosRot - centered.y * sinRot,
+					   centered.x * sinRot + centered.y * cosRot ) + 0.5;
+		}
+
+		float3 pos = p0.xyz + cameraRight * (offset.x * halfSize.x) + cameraUp * (offset.y * halfSize.y);
+		//Back to the node's space, which is what the renderable's world matrix expects
+		pos = float3( dot( r0.xyz, pos ), dot( r1.xyz, pos ), dot( r2.xyz, pos ) ) +
+			  float3( r0.w, r1.w, r2.w );
+
+		vertices[dst + 0u] = pos.x;
+		vertices[dst + 1u] = pos.y;
+		vertices[dst + 2u] = pos.z;
+		vertices[dst + 3u] = p2.x;
+		vertices[dst + 4u] = p2.y;
+		vertices[dst + 5u] = p2.z;
+		vertices[dst + 6u] = p2.w;
+		vertices[dst + 7u] = uv.x;
+		vertices[dst + 8u] = uv.y;
+		dst += 9u;
+	}
+}
@@ -0,0 +1,79 @@
+#include <metal_stdlib>
+using namespace metal;
+
+//Reconstructs the object space normals of an impostor atlas from the depth buffer the
+//frames were rendered with, and packs them with the linear depth. See ImpostorManager.
+//packParams.x = frames per side (N); y = resolution of a frame; zw = linear depth = d * z + w
+//Frames are placed in an N x N grid indexed by their octahedral coordinates (Y up)
+
+struct PS_INPUT
+{
+	float2 uv0;
+};
+
+inline float loadLinearDepth( depth2d<float> depthTexture, int2 iUv, float4 packParams )
+{
+	return depthTexture.read( uint2( iUv ) ) * packParams.z + packParams.w;
+}
+
+//Returns the depth difference with the neighbour on the side with the smaller gradient,
+//so that the normals don't bleed across silhouettes
+inline float depthGradient( depth2d<float> depthTexture, int2 iUv, int2 dir,
+							int2 tileMin, int2 tileMax, float depth, float4 packParams )
+{
+	int2 prevUv = clamp( iUv - dir, tileMin, tileMax );
+	int2 nextUv = clamp( iUv + dir, tileMin, tileMax );
+	float prevDepth = depth - loadLinearDepth( depthTexture, prevUv, packParams );
+	float nextDepth = loadLinearDepth( depthTexture, nextUv, packParams ) - depth;
+	if( all( prevUv == iUv ) )
+		return nextDepth;
+	if( all( nextUv == iUv ) )
+		return prevDepth;
+	return abs( prevDepth ) < abs( nextDepth ) ? prevDepth : nextDepth;
+}
+
+fragment float4 main_metal
+(
+	PS_INPUT inPs [[stage_in]],
+
+	depth2d<float>	depthTexture	[[texture(0)]],
+
+	constant float4 &packParams		[[buffer(PARAMETER_SLOT)]]
+)
+{
+	int framesPerSide	= int( packParams.x );
+	int frameRes		= int( packParams.y );
+
+	int2 texSize = int2( depthTexture.get_width(), depthTexture.get_height() );
+	int2 iUv = min( int2( inPs.uv0 * float2( texSize ) ), texSize - 1 );
+
+	float depth = loadLinearDepth( depthTexture, iUv, packParams );
+	if( depth >= 1.0 )
+		return float4( 0.5, 0.5, 0.5, 1.0 );
+
+	int2 frame = min( iUv / frameRes, int2( framesPerSide - 1 ) );
+	int2 tileMin = frame * frameRes;
+	int2 tileMax = tileMin + frameRes - 1;
+
+	//Depth spans 2 * radius and a frame 2 * radius, thus the slope is the
+	//depth difference in texels times the resolution. Rows go downwards
+	float dzdx = depthGradient( depthTexture, iUv, int2( 1, 0 ), tileMin, tileMax, depth,
+								packParams ) * float( frameRes );
+	float dzdy = -depthGradient( depthTexture, iUv, int2( 0, 1 ), tileMin, tileMax, depth,
+								 packParams ) * float( frameRes );
+	float3 viewNormal = normalize( float3( dzdx, dzdy, 1.0 ) );
+
+	//Basis of the camera the frame was captured with
+	float2 f = float2( frame ) * (2.0 / (packParams.x - 1.0)) - 1.0;
+	float3 dir = float3( f.x, 1.0 - abs( f.x ) - abs( f.y ), f.y );
+	float t = saturate( -dir.y );
+	dir.x += dir.x >= 0.0 ? -t : t;
+	dir.z += dir.z >= 0.0 ? -t : t;
+	dir = normalize( dir );
+	float3 up = abs( dir.y ) > 0.999 ? float3( 0, 0, 1 ) : float3( 0, 1, 0 );
+	float3 right = normalize( cross( up, dir ) );
+	up = cross( dir, right );
+
+	float3 normal = right * viewNormal.x + up * viewNormal.y + dir * viewNormal.z;
+	return float4( normal * 0.5 + 0.5, depth );
+}
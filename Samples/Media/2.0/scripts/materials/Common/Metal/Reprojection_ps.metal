@@ -0,0 +1,35 @@
+#include <metal_stdlib>
+using namespace metal;
+
+//Warps the last rendered frame to the camera's latest orientation (rotational reprojection).
+//reprojectionMatrix goes from the current NDC to the NDC the frame was rendered with
+//(see CompositorPassQuadDef::mReprojection). Areas that weren't rendered get reprojected
+//from the closest edge.
+
+struct PS_INPUT
+{
+	float2 uv0;
+};
+
+struct Params
+{
+	float4x4 reprojectionMatrix;
+};
+
+fragment float4 main_metal
+(
+	PS_INPUT inPs [[stage_in]],
+
+	texture2d<float>	lastFrame			[[texture(0)]],
+	sampler				lastFrameSampler	[[sampler(0)]],
+
+	constant Params &p [[buffer(PARAMETER_SLOT)]]
+)
+{
+	float4 ndc = float4( inPs.uv0.x * 2.0 - 1.0, 1.0 - inPs.uv0.y * 2.0, 1.0, 1.0 );
+	float4 srcNdc = p.reprojectionMatrix * ndc;
+	srcNdc.xy /= srcNdc.w;
+
+	float2 srcUv = float2( srcNdc.x * 0.5 + 0.5, 0.5 - srcNdc.y * 0.5 );
+	return lastFrame.sample( lastFrameSampler, srcUv );
+}
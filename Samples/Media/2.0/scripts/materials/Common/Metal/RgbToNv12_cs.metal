@@ -0,0 +1,79 @@
+//Converts an RGB texture into the two planes of NV12: full resolution luma (R8) and
+//half resolution interleaved CbCr (RG8). Each thread handles a 2x2 block, writing
+//4 luma texels and their averaged chroma (see VideoFrameCapture).
+
+#include <metal_stdlib>
+using namespace metal;
+
+@property( srgb )
+inline float3 toSRgb( float3 lin )
+{
+	lin = clamp( lin, 0.0, 1.0 );
+	float3 lo = lin * 12.92;
+	float3 hi = 1.055 * pow( lin, float3( 1.0 / 2.4 ) ) - 0.055;
+	return select( hi, lo, lin <= float3( 0.0031308 ) );
+}
+@end
+
+@property( bt601 )
+	constant float3 c_lumaWeights	= float3( 0.299, 0.587, 0.114 );
+	constant float3 c_cbWeights		= float3( -0.168736, -0.331264, 0.5 );
+	constant float3 c_crWeights		= float3( 0.5, -0.418688, -0.081312 );
+@else
+	constant float3 c_lumaWeights	= float3( 0.2126, 0.7152, 0.0722 );
+	constant float3 c_cbWeights		= float3( -0.114572, -0.385428, 0.5 );
+	constant float3 c_crWeights		= float3( 0.5, -0.454153, -0.045847 );
+@end
+
+@property( full_range )
+	constant float c_lumaScale		= 1.0;
+	constant float c_lumaOffset		= 0.0;
+	constant float c_chromaScale	= 1.0;
+@else
+	constant float c_lumaScale		= 219.0 / 255.0;
+	constant float c_lumaOffset		= 16.0 / 255.0;
+	constant float c_chromaScale	= 224.0 / 255.0;
+@end
+
+kernel void main_metal
+(
+	texture2d<float> srcTex								[[texture(0)]],
+	texture2d<float, access::write> dstChroma			[[texture(UAV_SLOT_START)]],
+	texture2d<float, access::write> dstLuma				[[texture(UAV_SLOT_START+1)]],
+
+	uint3 gl_GlobalInvocationID		[[thread_position_in_grid]]
+)
+{
+	uint2 blockPos = gl_GlobalInvocationID.xy;
+	if( blockPos.x >= dstChroma.get_width() || blockPos.y >= dstChroma.get_height() )
+		return;
+
+	int2 srcSize = int2( srcTex.get_width(), srcTex.get_height() );
+
+	float3 rgbSum = float3( 0.0, 0.0, 0.0 );
+	for( uint y=0; y<2u; ++y )
+	{
+		for( uint x=0; x<2u; ++x )
+		{
+			uint2 dstPos = blockPos * 2u + uint2( x, y );
+			//Replicate the edges for odd resolutions
+			float3 rgb = srcTex.read( uint2( min( int2( dstPos ), srcSize - 1 ) ) ).xyz;
+			@property( srgb )
+				rgb = toSRgb( rgb );
+			@end
+			rgb = saturate( rgb );
+			rgbSum += rgb;
+
+			if( dstPos.x < dstLuma.get_width() && dstPos.y < dstLuma.get_height() )
+			{
+				float luma = dot( rgb, c_lumaWeights ) * c_lumaScale + c_lumaOffset;
+				dstLuma.write( float4( luma, 0.0, 0.0, 0.0 ), dstPos );
+			}
+		}
+	}
+
+	float3 rgb = rgbSum * 0.25;
+	float2 chroma = float2( dot( rgb, c_cbWeights ), dot( rgb, c_crWeights ) ) * c_chromaScale +
+					128.0 / 255.0;
+	dstChroma.write( float4( chroma, 0.0, 0.0 ), blockPos );
+}
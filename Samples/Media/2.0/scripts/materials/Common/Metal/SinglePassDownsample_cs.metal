@@ -0,0 +1,111 @@
+//Single pass downsampler (same idea as AMD's FidelityFX SPD): each threadgroup reduces a
+//64x64 tile of the source mip into up to 6 mips using shared memory, so that a whole mip
+//chain needs one dispatch every 6 mips rather than one (or two) per mip.
+//See ComputeDownsampler.
+
+#include <metal_stdlib>
+using namespace metal;
+
+@property( texture_is_array )
+	#define READ_TEX( uv ) srcTex.read( uv, gl_WorkGroupID.z )
+	#define WRITE_UAV( tex, value, uv ) tex.write( value, uv, gl_WorkGroupID.z )
+@else
+	#define READ_TEX( uv ) srcTex.read( uv )
+	#define WRITE_UAV( tex, value, uv ) tex.write( value, uv )
+@end
+
+inline float4 reduce4( float4 a, float4 b, float4 c, float4 d )
+{
+@property( downsample_min )
+	return min( min( a, b ), min( c, d ) );
+@else @property( downsample_max )
+	return max( max( a, b ), max( c, d ) );
+@else
+	return ( a + b + c + d ) * 0.25;
+@end @end
+}
+
+inline float4 encodeOutput( float4 value )
+{
+@property( srgb )
+	//UAVs can't be sRGB, they're bound with the linear equivalent format
+	float3 lin = saturate( value.xyz );
+	float3 lo = lin * 12.92;
+	float3 hi = 1.055 * pow( lin, float3( 1.0 / 2.4 ) ) - 0.055;
+	return float4( select( hi, lo, lin <= float3( 0.0031308 ) ), value.w );
+@else
+	return value;
+@end
+}
+
+kernel void main_metal
+(
+@property( texture_is_array )
+	texture2d_array<float> srcTex		[[texture(0)]]
+	@foreach( num_dst_mips, n )
+	, texture2d_array<@insertpiece(uav@n_pf_type), access::write> dstMip@n	[[texture(UAV_SLOT_START+@n)]]@end
+@else
+	texture2d<float> srcTex				[[texture(0)]]
+	@foreach( num_dst_mips, n )
+	, texture2d<@insertpiece(uav@n_pf_type), access::write> dstMip@n	[[texture(UAV_SLOT_START+@n)]]@end
+@end
+
+	, uint3 gl_WorkGroupID				[[threadgroup_position_in_grid]]
+	, uint gl_LocalInvocationIndex		[[thread_index_in_threadgroup]]
+)
+{
+	//The 32x32 tile of the first mip. Deeper mips are stored in place with the same stride
+	threadgroup float4 g_lds[1024];
+
+	int localIdx = int( gl_LocalInvocationIndex );
+	int2 srcMaxCoord = int2( srcTex.get_width(), srcTex.get_height() ) - 1;
+
+	//First mip: each thread outputs 4 of the 32x32 texels of the tile
+	for( int i=0; i<4; ++i )
+	{
+		int ldsIdx = localIdx + i * 256;
+		int2 dstPos = int2( gl_WorkGroupID.xy ) * 32 + int2( ldsIdx & 31, ldsIdx >> 5 );
+		//Clamping replicates the edges for odd resolutions
+		int2 srcPos = dstPos * 2;
+		float4 value = reduce4(
+			READ_TEX( uint2( min( srcPos, srcMaxCoord ) ) ),
+			READ_TEX( uint2( min( srcPos + int2( 1, 0 ), srcMaxCoord ) ) ),
+			READ_TEX( uint2( min( srcPos + int2( 0, 1 ), srcMaxCoord ) ) ),
+			READ_TEX( uint2( min( srcPos + int2( 1, 1 ), srcMaxCoord ) ) ) );
+		g_lds[ldsIdx] = value;
+		if( dstPos.x < int( dstMip0.get_width() ) && dstPos.y < int( dstMip0.get_height() ) )
+		{
+			WRITE_UAV( dstMip0, vec<@insertpiece(uav0_pf_type),4>( encodeOutput( value ) ),
+					   uint2( dstPos ) );
+		}
+	}
+@foreach( num_dst_mips, n, 1 )
+	{
+		const int mipSize = 32 >> @n;
+		bool isActive = localIdx < mipSize * mipSize;
+		int2 localPos = int2( localIdx % mipSize, localIdx / mipSize );
+
+		threadgroup_barrier( mem_flags::mem_threadgroup );
+
+		float4 value = float4( 0.0, 0.0, 0.0, 0.0 );
+		if( isActive )
+		{
+			int base = localPos.y * 64 + localPos.x * 2;
+			value = reduce4( g_lds[base], g_lds[base + 1], g_lds[base + 32], g_lds[base + 33] );
+		}
+
+		threadgroup_barrier( mem_flags::mem_threadgroup );
+
+		if( isActive )
+		{
+			g_lds[localPos.y * 32 + localPos.x] = value;
+			int2 dstPos = int2( gl_WorkGroupID.xy ) * mipSize + localPos;
+			if( dstPos.x < int( dstMip@n.get_width() ) && dstPos.y < int( dstMip@n.get_height() ) )
+			{
+				WRITE_UAV( dstMip@n, vec<@insertpiece(uav@n_pf_type),4>( encodeOutput( value ) ),
+						   uint2( dstPos ) );
+			}
+		}
+	}
+@end
+}
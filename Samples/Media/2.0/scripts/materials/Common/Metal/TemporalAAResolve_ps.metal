@@ -0,0 +1,70 @@
+#include <metal_stdlib>
+using namespace metal;
+
+//Temporal antialiasing resolve. Blends the current frame with the reprojected history
+//(see CompositorPassSceneDef::mGenMotionVectors), clipping the history to the colour
+//distribution of the current pixel's neighbourhood to reject stale data.
+//currFrame & motionVectors may be smaller than the output (temporal upscaling);
+//history must be the same resolution as the output.
+
+struct PS_INPUT
+{
+	float2 uv0;
+};
+
+struct Params
+{
+	float blendFactor;
+};
+
+fragment float4 main_metal
+(
+	PS_INPUT inPs [[stage_in]],
+
+	texture2d<float>	currFrame		[[texture(0)]],
+	texture2d<float>	motionVectors	[[texture(1)]],
+	texture2d<float>	history			[[texture(2)]],
+
+	sampler				currFrameSampler	[[sampler(0)]],
+	sampler				historySampler		[[sampler(2)]],
+
+	constant Params &p [[buffer(PARAMETER_SLOT)]]
+)
+{
+	int2 currSize = int2( currFrame.get_width(), currFrame.get_height() );
+	int2 currPixel = min( int2( inPs.uv0 * float2( currSize ) ), currSize - 1 );
+
+	float3 currColour = currFrame.sample( currFrameSampler, inPs.uv0 ).xyz;
+
+	//Variance clipping box of the 3x3 neighbourhood
+	float3 m1 = float3( 0, 0, 0 );
+	float3 m2 = float3( 0, 0, 0 );
+	for( int y=-1; y<=1; ++y )
+	{
+		for( int x=-1; x<=1; ++x )
+		{
+			int2 pos = clamp( currPixel + int2( x, y ), int2( 0, 0 ), currSize - 1 );
+			float3 neighbour = currFrame.read( uint2( pos ), 0 ).xyz;
+			m1 += neighbour;
+			m2 += neighbour * neighbour;
+		}
+	}
+	float3 mean = m1 / 9.0;
+	float3 sigma = sqrt( abs( m2 / 9.0 - mean * mean ) );
+	float3 minColour = min( mean - sigma, currColour );
+	float3 maxColour = max( mean + sigma, currColour );
+
+	float2 historyUv = inPs.uv0 + motionVectors.read( uint2( currPixel ), 0 ).xy;
+	float4 historyColour = history.sample( historySampler, historyUv );
+
+	//History is cleared to 0 (including alpha) before the first frame
+	bool validHistory = historyColour.w > 0.0 &&
+						all( historyUv >= float2( 0, 0 ) ) &&
+						all( historyUv <= float2( 1, 1 ) );
+
+	float3 clippedHistory = clamp( historyColour.xyz, minColour, maxColour );
+	float4 retVal;
+	retVal.xyz = validHistory ? mix( clippedHistory, currColour, p.blendFactor ) : currColour;
+	retVal.w = 1.0;
+	return retVal;
+}
@@ -0,0 +1,32 @@
+#include <metal_stdlib>
+using namespace metal;
+
+//Weighted blended order independent transparency resolve (McGuire & Bavoil 2013).
+//accumTex.rgb holds the sum of the weighted premultiplied colours, accumTex.a the
+//product of (1 - alpha), i.e. how much of the background is left. See OitMode::WeightedBlended
+
+struct PS_INPUT
+{
+	float2 uv0;
+};
+
+fragment float4 main_metal
+(
+	PS_INPUT inPs [[stage_in]],
+
+	texture2d<float>	accumTex	[[texture(0)]],
+	texture2d<float>	weightTex	[[texture(1)]]
+)
+{
+	uint2 texSize = uint2( accumTex.get_width(), accumTex.get_height() );
+	uint2 iUv = min( uint2( inPs.uv0 * float2( texSize ) ), texSize - 1u );
+
+	float4 accum = accumTex.read( iUv );
+	float revealage = accum.w;
+	if( revealage >= 1.0 )
+		discard_fragment();
+
+	float weight = weightTex.read( iUv ).x;
+
+	return float4( accum.xyz / max( weight, 1e-5 ), 1.0 - revealage );
+}
@@ -15,6 +15,7 @@ uniform vec2 projectionParams;
 uniform float invKernelSize;
 uniform float kernelRadius;
 uniform vec2 noiseScale;
+uniform vec2 noiseRotation;
 uniform mat4 projection;
 
 uniform vec4 sampleDirs[64];
@@ -37,6 +38,9 @@ vec3 reconstructNormal(vec3 posInView)
 vec3 getRandomVec(vec2 uv)
 {
 	vec3 randomVec = texture(noiseTexture, uv * noiseScale).xyz;
+	//Rotated (cos, sin) every frame so that SSAO/Temporal accumulates different samples
+	randomVec.xy = vec2(randomVec.x * noiseRotation.x - randomVec.y * noiseRotation.y,
+						randomVec.x * noiseRotation.y + randomVec.y * noiseRotation.x);
 	return randomVec;
 }
 
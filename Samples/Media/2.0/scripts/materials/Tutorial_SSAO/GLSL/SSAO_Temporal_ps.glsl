@@ -0,0 +1,58 @@
+#version 330
+
+//Temporal accumulation of the SSAO. The noise is rotated every frame (see noiseRotation in
+//SSAO_HS_ps) and the result is blended with last frame's, reprojected through the motion
+//vectors. History holds the AO in x and the linear depth it belongs to in y, so that
+//disoccluded pixels (where the depth doesn't match) discard their history.
+
+uniform sampler2D ssaoTexture;
+uniform sampler2D motionVectors;
+uniform sampler2D ssaoHistory;
+uniform sampler2D depthTexture;
+
+uniform vec2 projectionParams;
+uniform float blendFactor;
+
+in block
+{
+	vec2 uv0;
+} inPs;
+
+out vec2 fragColour;
+
+void main()
+{
+	ivec2 currSize = textureSize( ssaoTexture, 0 );
+	ivec2 currPixel = min( ivec2( inPs.uv0 * vec2( currSize ) ), currSize - 1 );
+
+	float currAo = texelFetch( ssaoTexture, currPixel, 0 ).x;
+	float fDepth = texelFetch( depthTexture, currPixel, 0 ).x;
+	float linearDepth = projectionParams.y / (fDepth - projectionParams.x);
+
+	//The 3x3 neighbourhood covers the whole noise pattern; its range bounds the history
+	float minAo = currAo;
+	float maxAo = currAo;
+	for( int y=-1; y<=1; ++y )
+	{
+		for( int x=-1; x<=1; ++x )
+		{
+			ivec2 pos = clamp( currPixel + ivec2( x, y ), ivec2( 0 ), currSize - 1 );
+			float neighbour = texelFetch( ssaoTexture, pos, 0 ).x;
+			minAo = min( minAo, neighbour );
+			maxAo = max( maxAo, neighbour );
+		}
+	}
+
+	vec2 historyUv = inPs.uv0 + texture( motionVectors, inPs.uv0 ).xy;
+	vec2 history = texture( ssaoHistory, historyUv ).xy;
+
+	//History is cleared to 0 before the first frame (a depth no real pixel has)
+	bool validHistory = history.y > 0.0 &&
+						abs( history.y - linearDepth ) < 0.05 * linearDepth &&
+						all( greaterThanEqual( historyUv, vec2( 0.0 ) ) ) &&
+						all( lessThanEqual( historyUv, vec2( 1.0 ) ) );
+
+	float clippedHistory = clamp( history.x, minAo, maxAo );
+	fragColour.x = validHistory ? mix( clippedHistory, currAo, blendFactor ) : currAo;
+	fragColour.y = linearDepth;
+}
@@ -15,6 +15,7 @@ uniform float2 projectionParams;
 uniform float invKernelSize;
 uniform float kernelRadius;
 uniform float2 noiseScale;
+uniform float2 noiseRotation;
 uniform matrix projection;
 
 uniform float4 sampleDirs[64];
@@ -36,6 +37,9 @@ float3 reconstructNormal(float3 posInView)
 float3 getNoiseVec(float2 uv)
 {
 	float3 randomVec = noiseTexture.Sample(samplerState1, uv*noiseScale).xyz;
+	//Rotated (cos, sin) every frame so that SSAO/Temporal accumulates different samples
+	randomVec.xy = float2(randomVec.x * noiseRotation.x - randomVec.y * noiseRotation.y,
+						  randomVec.x * noiseRotation.y + randomVec.y * noiseRotation.x);
 	return randomVec;
 }
 
@@ -0,0 +1,63 @@
+//Temporal accumulation of the SSAO. The noise is rotated every frame (see noiseRotation in
+//SSAO_HS_ps) and the result is blended with last frame's, reprojected through the motion
+//vectors. History holds the AO in x and the linear depth it belongs to in y, so that
+//disoccluded pixels (where the depth doesn't match) discard their history.
+
+struct PS_INPUT
+{
+	float2 uv0			: TEXCOORD0;
+};
+
+Texture2D<float> ssaoTexture	: register(t0);
+Texture2D<float2> motionVectors	: register(t1);
+Texture2D<float2> ssaoHistory	: register(t2);
+Texture2D<float> depthTexture	: register(t3);
+
+SamplerState motionVectorsSampler	: register(s1);
+SamplerState historySampler			: register(s2);
+
+uniform float2 projectionParams;
+uniform float blendFactor;
+
+float2 main
+(
+	PS_INPUT inPs
+) : SV_Target
+{
+	int2 currSize;
+	ssaoTexture.GetDimensions( currSize.x, currSize.y );
+	int2 currPixel = min( int2( inPs.uv0 * float2( currSize ) ), currSize - 1 );
+
+	float currAo = ssaoTexture.Load( int3( currPixel, 0 ) ).x;
+	float fDepth = depthTexture.Load( int3( currPixel, 0 ) ).x;
+	float linearDepth = projectionParams.y / (fDepth - projectionParams.x);
+
+	//The 3x3 neighbourhood covers the whole noise pattern; its range bounds the history
+	float minAo = currAo;
+	float maxAo = currAo;
+	for( int y=-1; y<=1; ++y )
+	{
+		for( int x=-1; x<=1; ++x )
+		{
+			int2 pos = clamp( currPixel + int2( x, y ), int2( 0, 0 ), currSize - 1 );
+			float neighbour = ssaoTexture.Load( int3( pos, 0 ) ).x;
+			minAo = min( minAo, neighbour );
+			maxAo = max( maxAo, neighbour );
+		}
+	}
+
+	float2 historyUv = inPs.uv0 + motionVectors.Sample( motionVectorsSampler, inPs.uv0 ).xy;
+	float2 history = ssaoHistory.Sample( historySampler, historyUv ).xy;
+
+	//History is cleared to 0 before the first frame (a depth no real pixel has)
+	bool validHistory = history.y > 0.0 &&
+						abs( history.y - linearDepth ) < 0.05 * linearDepth &&
+						all( historyUv >= float2( 0, 0 ) ) &&
+						all( historyUv <= float2( 1, 1 ) );
+
+	float clippedHistory = clamp( history.x, minAo, maxAo );
+	float2 retVal;
+	retVal.x = validHistory ? lerp( clippedHistory, currAo, blendFactor ) : currAo;
+	retVal.y = linearDepth;
+	return retVal;
+}
@@ -13,6 +13,7 @@ struct Params
 	float invKernelSize;
 	float kernelRadius;
 	float2 noiseScale;
+	float2 noiseRotation;
 	float4x4 projection;
 
 	float4 sampleDirs[64];
@@ -36,6 +37,9 @@ inline float3 getNoiseVec( float2 uv, constant const Params &p,
 						   texture2d<float> noiseTexture, sampler samplerState1 )
 {
 	float3 randomVec = noiseTexture.sample( samplerState1, uv * p.noiseScale ).xyz;
+	//Rotated (cos, sin) every frame so that SSAO/Temporal accumulates different samples
+	randomVec.xy = float2( randomVec.x * p.noiseRotation.x - randomVec.y * p.noiseRotation.y,
+						   randomVec.x * p.noiseRotation.y + randomVec.y * p.noiseRotation.x );
 	return randomVec;
 }
 
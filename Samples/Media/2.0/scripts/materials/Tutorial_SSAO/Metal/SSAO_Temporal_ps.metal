@@ -0,0 +1,70 @@
+#include <metal_stdlib>
+using namespace metal;
+
+//Temporal accumulation of the SSAO. The noise is rotated every frame (see noiseRotation in
+//SSAO_HS_ps) and the result is blended with last frame's, reprojected through the motion
+//vectors. History holds the AO in x and the linear depth it belongs to in y, so that
+//disoccluded pixels (where the depth doesn't match) discard their history.
+
+struct PS_INPUT
+{
+	float2 uv0;
+};
+
+struct Params
+{
+	float2 projectionParams;
+	float blendFactor;
+};
+
+fragment float2 main_metal
+(
+	PS_INPUT inPs [[stage_in]],
+
+	texture2d<float>	ssaoTexture		[[texture(0)]],
+	texture2d<float>	motionVectors	[[texture(1)]],
+	texture2d<float>	ssaoHistory		[[texture(2)]],
+	texture2d<float>	depthTexture	[[texture(3)]],
+
+	sampler				motionVectorsSampler	[[sampler(1)]],
+	sampler				historySampler			[[sampler(2)]],
+
+	constant Params &p [[buffer(PARAMETER_SLOT)]]
+)
+{
+	int2 currSize = int2( ssaoTexture.get_width(), ssaoTexture.get_height() );
+	int2 currPixel = min( int2( inPs.uv0 * float2( currSize ) ), currSize - 1 );
+
+	float currAo = ssaoTexture.read( uint2( currPixel ), 0 ).x;
+	float fDepth = depthTexture.read( uint2( currPixel ), 0 ).x;
+	float linearDepth = p.projectionParams.y / (fDepth - p.projectionParams.x);
+
+	//The 3x3 neighbourhood covers the whole noise pattern; its range bounds the history
+	float minAo = currAo;
+	float maxAo = currAo;
+	for( int y=-1; y<=1; ++y )
+	{
+		for( int x=-1; x<=1; ++x )
+		{
+			int2 pos = clamp( currPixel + int2( x, y ), int2( 0, 0 ), currSize - 1 );
+			float neighbour = ssaoTexture.read( uint2( pos ), 0 ).x;
+			minAo = min( minAo, neighbour );
+			maxAo = max( maxAo, neighbour );
+		}
+	}
+
+	float2 historyUv = inPs.uv0 + motionVectors.sample( motionVectorsSampler, inPs.uv0 ).xy;
+	float2 history = ssaoHistory.sample( historySampler, historyUv ).xy;
+
+	//History is cleared to 0 before the first frame (a depth no real pixel has)
+	bool validHistory = history.y > 0.0 &&
+						abs( history.y - linearDepth ) < 0.05 * linearDepth &&
+						all( historyUv >= float2( 0, 0 ) ) &&
+						all( historyUv <= float2( 1, 1 ) );
+
+	float clippedHistory = clamp( history.x, minAo, maxAo );
+	float2 retVal;
+	retVal.x = validHistory ? mix( clippedHistory, currAo, p.blendFactor ) : currAo;
+	retVal.y = linearDepth;
+	return retVal;
+}
@@ -42,6 +42,9 @@ layout(binding = 1) uniform PerGroupDataBuffer
 //Rendering uniforms
 uniform float heightDelta;
 
+//Incremental updates only dispatch a band of threadgroups per frame
+uniform uint groupOffset;
+
 vec2 calcShadow( ivec2 xyPos, vec2 prevHeight )
 {
 	prevHeight.x -= heightDelta;
@@ -72,13 +75,15 @@ vec2 calcShadow( ivec2 xyPos, vec2 prevHeight )
 void main()
 {
 	vec2 prevHeight = vec2( 0.0, 0.0 );
-	float error = delta.x * 0.5 + perGroupData[gl_WorkGroupID.x].deltaErrorStart;
+	uint groupIdx = gl_WorkGroupID.x + groupOffset;
+	uint threadIdx = gl_GlobalInvocationID.x + groupOffset * @value( threads_per_group_x )u;
+	float error = delta.x * 0.5 + perGroupData[groupIdx].deltaErrorStart;
 
 	int x, y;
-	if( gl_GlobalInvocationID.x < 4096u )
+	if( threadIdx < 4096u )
 	{
-		x = startXY[gl_GlobalInvocationID.x].x;
-		y = startXY[gl_GlobalInvocationID.x].y;
+		x = startXY[threadIdx].x;
+		y = startXY[threadIdx].y;
 	}
 	else
 	{
@@ -86,11 +91,11 @@ void main()
 		//we perform startXY[4096] and store the values in .zw instead of .xy
 		//It only gets used if the picture is very big. This branch is coherent as
 		//long as 4096 is multiple of threads_per_group_x.
-		x = startXY[gl_GlobalInvocationID.x - 4096u].z;
-		y = startXY[gl_GlobalInvocationID.x - 4096u].w;
+		x = startXY[threadIdx - 4096u].z;
+		y = startXY[threadIdx - 4096u].w;
 	}
 
-	int numIterations = perGroupData[gl_WorkGroupID.x].iterations;
+	int numIterations = perGroupData[groupIdx].iterations;
 	for( int i=0; i<numIterations; ++i )
 	{
 		if( isSteep != 0 )
@@ -17,6 +17,9 @@ struct Params
 
 	//Rendering uniforms
 	float heightDelta;
+
+	//Incremental updates only dispatch a band of threadgroups per frame
+	uint groupOffset;
 };
 
 struct PerGroupData
@@ -75,13 +78,15 @@ kernel void main_metal
 )
 {
 	float2 prevHeight = float2( 0.0, 0.0 );
-	float error = p.delta.x * 0.5 + perGroupData[gl_WorkGroupID.x].deltaErrorStart;
+	uint groupIdx = gl_WorkGroupID.x + p.groupOffset;
+	uint threadIdx = gl_GlobalInvocationID.x + p.groupOffset * @value( threads_per_group_x )u;
+	float error = p.delta.x * 0.5 + perGroupData[groupIdx].deltaErrorStart;
 
 	int x, y;
-	if( gl_GlobalInvocationID.x < 4096u )
+	if( threadIdx < 4096u )
 	{
-		x = startXY[gl_GlobalInvocationID.x].x;
-		y = startXY[gl_GlobalInvocationID.x].y;
+		x = startXY[threadIdx].x;
+		y = startXY[threadIdx].y;
 	}
 	else
 	{
@@ -89,11 +94,11 @@ kernel void main_metal
 		//we perform startXY[4096] and store the values in .zw instead of .xy
 		//It only gets used if the picture is very big. This branch is coherent as
 		//long as 4096 is multiple of threads_per_group_x.
-		x = startXY[gl_GlobalInvocationID.x - 4096u].z;
-		y = startXY[gl_GlobalInvocationID.x - 4096u].w;
+		x = startXY[threadIdx - 4096u].z;
+		y = startXY[threadIdx - 4096u].w;
 	}
 	
-	int numIterations = perGroupData[gl_WorkGroupID.x].iterations;
+	int numIterations = perGroupData[groupIdx].iterations;
 	for( int i=0; i<numIterations; ++i )
 	{
 		if( p.isSteep )
@@ -27,5 +27,12 @@
 		@end
 
 		@insertpiece( ExtraOutputTypes )
+
+		@property( hlms_oit_weighted && hlms_alphablend && !hlms_shadowcaster )
+			float oitWeight : SV_Target@counter(rtv_target);
+		@end
 	};
+	@property( hlms_oit_weighted && hlms_alphablend && !hlms_shadowcaster )
+		#define outPs_oitWeight outPs.oitWeight
+	@end
 @end
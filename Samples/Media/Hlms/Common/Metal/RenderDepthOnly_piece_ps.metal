@@ -13,7 +13,9 @@
 	struct PS_OUTPUT
 	{
 		@property( !hlms_shadowcaster )
-			float4 colour0	[[ color(0) ]];
+			@property( hlms_render_depth_only || !hlms_prepass )
+				float4 colour0	[[ color(@counter(rtv_target)) ]];
+			@end
 		@else
 			@property( !hlms_render_depth_only )
 				float colour0	[[ color(0) ]];
@@ -22,5 +24,14 @@
 				float colour0	[[ depth(any) ]];
 			@end
 		@end
+
+		@insertpiece( ExtraOutputTypes )
+
+		@property( hlms_oit_weighted && hlms_alphablend && !hlms_shadowcaster )
+			float oitWeight	[[ color(@counter(rtv_target)) ]];
+		@end
 	};
+	@property( hlms_oit_weighted && hlms_alphablend && !hlms_shadowcaster )
+		#define outPs_oitWeight outPs.oitWeight
+	@end
 @end
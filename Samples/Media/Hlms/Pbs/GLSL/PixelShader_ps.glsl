@@ -16,10 +16,24 @@ layout(std140) uniform;
 			#define outPs_normals outNormals
 			layout(location = @counter(rtv_target)) out vec4 outNormals;
 		@end
+		@property( hlms_gen_gbuffer )
+			#define outPs_albedo outAlbedo
+			#define outPs_f0Roughness outF0Roughness
+			layout(location = @counter(rtv_target)) out vec4 outAlbedo;
+			layout(location = @counter(rtv_target)) out vec4 outF0Roughness;
+		@end
 		@property( hlms_prepass )
 			#define outPs_shadowRoughness outShadowRoughness
 			layout(location = @counter(rtv_target)) out vec2 outShadowRoughness;
 		@end
+		@property( hlms_gen_motion_vectors )
+			#define outPs_motionVectors outMotionVectors
+			layout(location = @counter(rtv_target)) out vec2 outMotionVectors;
+		@end
+		@property( hlms_oit_weighted && hlms_alphablend )
+			#define outPs_oitWeight outOitWeight
+			layout(location = @counter(rtv_target)) out float outOitWeight;
+		@end
 	@else
 		layout(location = @counter(rtv_target), index = 0) out float outColour;
 	@end
@@ -50,6 +50,12 @@ in vec4 vertex;
 @property( !GL_ARB_base_instance )uniform uint baseInstance;@end
 @property( hlms_pose )
 	uniform samplerBuffer poseBuf;
+	@property( hlms_pose_sparse )
+		uniform usamplerBuffer poseIndexBuf;
+	@end
+@end
+@property( hlms_skeleton_gpu )
+	uniform samplerBuffer gpuBoneMatBuf;
 @end
 // END UNIFORM GL DECLARATION
 
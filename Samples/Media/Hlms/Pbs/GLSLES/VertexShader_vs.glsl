@@ -33,7 +33,7 @@ in vec4 blendWeights;@end
 @foreach( hlms_uv_count, n )
 in vec@value( hlms_uv_count@n ) uv@n;@end
 
-@property( GL_ARB_base_instance )
+@property( GL_EXT_base_instance )
 	in uint drawId;
 @end
 
@@ -51,9 +51,12 @@ out block
 @property( hlms_skeleton || hlms_shadowcaster || hlms_pose )@insertpiece( InstanceDecl )@end
 /*layout(binding = 0) */uniform samplerBuffer worldMatBuf;
 @insertpiece( custom_vs_uniformDeclaration )
-@property( !GL_ARB_base_instance )uniform uint baseInstance;@end
+@property( !GL_EXT_base_instance )uniform uint baseInstance;@end
 @property( hlms_pose )
 	uniform samplerBuffer poseBuf;
+	@property( hlms_pose_sparse )
+		uniform highp usamplerBuffer poseIndexBuf;
+	@end
 @end
 // END UNIFORM DECLARATION
 
@@ -147,6 +150,9 @@ out block
 	vec4 poseData = bufferFetch( worldMatBuf, poseDataStart );
 	int baseVertexID = int(floatBitsToUint( poseData.x ));
 	int vertexID = gl_VertexID - baseVertexID;
+	@property( hlms_pose_sparse )
+		vertexID = int( texelFetch( poseIndexBuf, vertexID ).x );
+	@end
 
 	@psub( MoreThanOnePose, hlms_pose, 1 )
 	@property( !MoreThanOnePose )
@@ -243,7 +249,7 @@ out block
 
 void main()
 {
-@property( !GL_ARB_base_instance )
+@property( !GL_EXT_base_instance )
     uint drawId = baseInstance + uint( gl_InstanceID );
 @end
 
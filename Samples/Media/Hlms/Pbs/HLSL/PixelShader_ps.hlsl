@@ -31,9 +31,16 @@ struct PS_INPUT
 	@property( hlms_gen_normals_gbuffer )
 		#define outPs_normals outPs.normals
 	@end
+	@property( hlms_gen_gbuffer )
+		#define outPs_albedo outPs.albedo
+		#define outPs_f0Roughness outPs.f0Roughness
+	@end
 	@property( hlms_prepass )
 		#define outPs_shadowRoughness outPs.shadowRoughness
 	@end
+	@property( hlms_gen_motion_vectors )
+		#define outPs_motionVectors outPs.motionVectors
+	@end
 @end
 
 @property( hlms_use_prepass )
@@ -4,8 +4,15 @@
 		@property( hlms_gen_normals_gbuffer )
 			float4 normals			: SV_Target@counter(rtv_target);
 		@end
+		@property( hlms_gen_gbuffer )
+			float4 albedo			: SV_Target@counter(rtv_target);
+			float4 f0Roughness		: SV_Target@counter(rtv_target);
+		@end
 		@property( hlms_prepass )
 			float2 shadowRoughness	: SV_Target@counter(rtv_target);
 		@end
+		@property( hlms_gen_motion_vectors )
+			float2 motionVectors	: SV_Target@counter(rtv_target);
+		@end
 	@end
 @end
@@ -55,6 +55,12 @@ struct PS_INPUT
 Buffer<float4> worldMatBuf : register(t0);
 @property( hlms_pose )
 	Buffer<float4> poseBuf : register(t4);
+	@property( hlms_pose_sparse )
+		Buffer<uint> poseIndexBuf : register(t6);
+	@end
+@end
+@property( hlms_skeleton_gpu )
+	StructuredBuffer<float4> gpuBoneMatBuf : register(t5);
 @end
 // END UNIFORM D3D DECLARATION
 
@@ -59,6 +59,12 @@ vertex PS_INPUT main_metal
 		@else
 			, device const half4 *poseBuf	[[buffer(TEX_SLOT_START+4)]]
 		@end
+		@property( hlms_pose_sparse )
+			, device const uint *poseIndexBuf	[[buffer(TEX_SLOT_START+6)]]
+		@end
+	@end
+	@property( hlms_skeleton_gpu )
+		, device const float4 *gpuBoneMatBuf [[buffer(TEX_SLOT_START+5)]]
 	@end
 	@property( hlms_vertex_id )
 		, uint vertexId [[vertex_id]]
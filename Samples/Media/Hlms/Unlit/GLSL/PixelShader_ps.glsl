@@ -10,6 +10,10 @@ in vec4 gl_FragCoord;
 
 @property( !hlms_shadowcaster )
 layout(location = FRAG_COLOR, index = 0) out vec4 outColour;
+	@property( hlms_oit_weighted && hlms_alphablend )
+		#define outPs_oitWeight outOitWeight
+		layout(location = 1) out float outOitWeight;
+	@end
 @end @property( hlms_shadowcaster )
 layout(location = FRAG_COLOR, index = 0) out float outColour;
 @end
@@ -37,6 +37,7 @@ in vec4 vertex;
 // START UNIFORM GL DECLARATION
 /*layout(binding = 0) */uniform samplerBuffer worldMatBuf;
 @property( texture_matrix )/*layout(binding = 1) */uniform samplerBuffer animationMatrixBuf;@end
+@property( billboard_instanced || billboard_chain || impostor_instanced )/*layout(binding = 1) */uniform samplerBuffer billboardBuf;@end
 @property( !GL_ARB_base_instance )uniform uint baseInstance;@end
 // END UNIFORM GL DECLARATION
 
@@ -21,7 +21,7 @@ in vec4 vertex;
 @foreach( hlms_uv_count, n )
 in vec@value( hlms_uv_count@n ) uv@n;@end
 
-@property( GL_ARB_base_instance )
+@property( GL_EXT_base_instance )
 	in uint drawId;
 @end
 
@@ -44,7 +44,7 @@ out block
 /*layout(binding = 0) */uniform samplerBuffer worldMatBuf;
 @property( texture_matrix )/*layout(binding = 1) */uniform samplerBuffer animationMatrixBuf;@end
 @insertpiece( custom_vs_uniformDeclaration )
-@property( !GL_ARB_base_instance )uniform uint baseInstance;@end
+@property( !GL_EXT_base_instance )uniform uint baseInstance;@end
 // END UNIFORM DECLARATION
 
 @property( !hlms_identity_world )
@@ -59,7 +59,7 @@ out block
 
 void main()
 {
-@property( !GL_ARB_base_instance )
+@property( !GL_EXT_base_instance )
     uint drawId = baseInstance + uint( gl_InstanceID );
 @end
     
@@ -9,6 +9,7 @@
 // START UNIFORM D3D DECLARATION
 Buffer<float4> worldMatBuf : register(t0);
 @property( texture_matrix )Buffer<float4> animationMatrixBuf : register(t1);@end
+@property( billboard_instanced || billboard_chain || impostor_instanced )Buffer<float4> billboardBuf : register(t1);@end
 // END UNIFORM D3D DECLARATION
 
 struct VS_INPUT
@@ -42,6 +42,7 @@ vertex PS_INPUT main_metal
 	@insertpiece( InstanceDecl )
 	, device const float4 *worldMatBuf [[buffer(TEX_SLOT_START+0)]]
 	@property( texture_matrix ), device const float4 *animationMatrixBuf [[buffer(TEX_SLOT_START+1)]]@end
+	@property( billboard_instanced || billboard_chain || impostor_instanced ), device const float4 *billboardBuf [[buffer(TEX_SLOT_START+1)]]@end
 	@insertpiece( custom_vs_uniformDeclaration )
 	// END UNIFORM DECLARATION
 )
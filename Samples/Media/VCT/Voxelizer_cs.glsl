@@ -59,11 +59,15 @@ uniform samplerBuffer instanceBuffer;
 uniform uint2 instanceStart_instanceEnd;
 uniform float3 voxelOrigin;
 uniform float3 voxelCellSize;
+uniform uint3 voxelPixelOrigin;
+uniform uint clearVoxels;
 
 #define p_instanceStart instanceStart_instanceEnd.x
 #define p_instanceEnd instanceStart_instanceEnd.y
 #define p_voxelOrigin voxelOrigin
 #define p_voxelCellSize voxelCellSize
+#define p_voxelPixelOrigin voxelPixelOrigin
+#define p_clearVoxels clearVoxels
 
 //in uvec3 gl_NumWorkGroups;
 //in uvec3 gl_WorkGroupID;
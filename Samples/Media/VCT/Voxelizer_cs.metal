@@ -23,6 +23,8 @@ struct Params
 	uint2 instanceStart_instanceEnd;
 	float3 voxelOrigin;
 	float3 voxelCellSize;
+	uint3 voxelPixelOrigin;
+	uint clearVoxels;
 };
 
 #if defined(__HAVE_SIMDGROUP_BALLOT__)
@@ -85,6 +87,8 @@ inline uint packUnormRGB10A2( float4 v )
 #define p_numInstances p.numInstances
 #define p_voxelOrigin p.voxelOrigin
 #define p_voxelCellSize p.voxelCellSize
+#define p_voxelPixelOrigin p.voxelPixelOrigin
+#define p_clearVoxels p.clearVoxels
 
 kernel void main_metal
 (
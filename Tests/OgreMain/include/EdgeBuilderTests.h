@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "OgreHardwareBufferManager.h"
 
 using namespace Ogre;
+using namespace Ogre::v1;
 
 class EdgeBuilderTests : public CppUnit::TestFixture
 {
@@ -43,6 +44,9 @@ class EdgeBuilderTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testSingleIndexBufSingleVertexBuf);
     CPPUNIT_TEST(testMultiIndexBufSingleVertexBuf);
     CPPUNIT_TEST(testMultiIndexBufMultiVertexBuf);
+    CPPUNIT_TEST(testWeldDuplicatePositions);
+    CPPUNIT_TEST(testWeldSharedEdgeOrder);
+    CPPUNIT_TEST(testWeldGrid);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -55,6 +59,9 @@ public:
     void testSingleIndexBufSingleVertexBuf();
     void testMultiIndexBufSingleVertexBuf();
     void testMultiIndexBufMultiVertexBuf();
+    void testWeldDuplicatePositions();
+    void testWeldSharedEdgeOrder();
+    void testWeldGrid();
 };
 
 #endif
@@ -51,6 +51,10 @@ class MeshSerializerTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testMesh_Version_1_4);
     CPPUNIT_TEST(testMesh_Version_1_3);
     CPPUNIT_TEST(testMesh_Version_1_2);
+    CPPUNIT_TEST(testMesh2_Version_2_1);
+    CPPUNIT_TEST(testMesh2_Version_2_1_Shadowed);
+    CPPUNIT_TEST(testMesh2_Version_2_1_FlipEndian);
+    CPPUNIT_TEST(testMesh2_Version_2_1_NoOptionalChunks);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -75,6 +79,15 @@ public:
     void testMesh_Version_1_3();
     void testMesh_Version_1_2();
     void testMesh_XML();
+    void testMesh2_Version_2_1();
+    void testMesh2_Version_2_1_Shadowed();
+    void testMesh2_Version_2_1_FlipEndian();
+    void testMesh2_Version_2_1_NoOptionalChunks();
+    void testMesh2( bool shadowed, Serializer::Endian endianMode, bool optionalChunks );
+    Ogre::Mesh* createMesh2Grid( VaoManager *vaoManager, const String &name,
+                                 bool shadowed, bool optionalChunks );
+    void assertMesh2Clone( Ogre::Mesh *a, Ogre::Mesh *b );
+    void assertBufferClone( BufferPacked *a, BufferPacked *b );
     void testMesh(MeshVersion version);
     void assertMeshClone(Mesh* a, Mesh* b, MeshVersion version = MESH_VERSION_LATEST);
     void assertVertexDataClone(VertexData* a, VertexData* b, MeshVersion version = MESH_VERSION_LATEST);
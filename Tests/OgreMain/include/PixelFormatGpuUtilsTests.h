@@ -0,0 +1,74 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#ifndef __PixelFormatGpuUtilsTests_H__
+#define __PixelFormatGpuUtilsTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePixelFormatGpuUtils.h"
+
+#include <vector>
+
+using namespace Ogre;
+
+/// Checks the typed fast paths of PixelFormatGpuUtils::bulkPixelConversion against the
+/// per-pixel unpackColour/packColour fallback. Results must be bit-exact.
+class PixelFormatGpuUtilsTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(PixelFormatGpuUtilsTests);
+    CPPUNIT_TEST(testUnormToFloat);
+    CPPUNIT_TEST(testFloat32ToUnorm);
+    CPPUNIT_TEST(testFloat16ToUnorm);
+    CPPUNIT_TEST(testFloat16ToFloat32);
+    CPPUNIT_TEST(testExpandR8RG8);
+    CPPUNIT_TEST(testVerticalFlip);
+    CPPUNIT_TEST(testThreadedConversion);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testUnormToFloat();
+    void testFloat32ToUnorm();
+    void testFloat16ToUnorm();
+    void testFloat16ToFloat32();
+    void testExpandR8RG8();
+    void testVerticalFlip();
+    void testThreadedConversion();
+
+    // Utils
+    /// Converts srcData (numPixels of srcFormat, in 'height' rows) with bulkPixelConversion
+    /// and through the fallback, and asserts both results are identical.
+    void testCase(const std::vector<uint8>& srcData, uint32 height, PixelFormatGpu srcFormat,
+                  PixelFormatGpu dstFormat, bool verticalFlip = false);
+};
+
+#endif
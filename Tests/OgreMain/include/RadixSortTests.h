@@ -42,6 +42,9 @@ class RadixSortTests : public CppUnit::TestFixture
     CPPUNIT_TEST(testIntList);
     CPPUNIT_TEST(testUnsignedIntVector);
     CPPUNIT_TEST(testIntVector);
+    CPPUNIT_TEST(testRadixSort64);
+    CPPUNIT_TEST(testRadixSort64Slices);
+    CPPUNIT_TEST(testRadixSort64InsertionSort);
     CPPUNIT_TEST_SUITE_END();
 
 protected:
@@ -56,6 +59,9 @@ public:
     void testIntList();
     void testUnsignedIntVector();
     void testIntVector();
+    void testRadixSort64();
+    void testRadixSort64Slices();
+    void testRadixSort64InsertionSort();
 };
 
 #endif
\ No newline at end of file
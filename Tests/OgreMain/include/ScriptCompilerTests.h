@@ -0,0 +1,68 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#ifndef __ScriptCompilerTests_H__
+#define __ScriptCompilerTests_H__
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "OgrePrerequisites.h"
+
+using namespace Ogre;
+
+class AstCacheTestTranslatorManager;
+
+class ScriptCompilerTests : public CppUnit::TestFixture
+{
+    // CppUnit macros for setting up the test suite
+    CPPUNIT_TEST_SUITE(ScriptCompilerTests);
+    CPPUNIT_TEST(testAstCacheHit);
+    CPPUNIT_TEST(testAstCacheScriptChanged);
+    CPPUNIT_TEST(testAstCacheImportChanged);
+    CPPUNIT_TEST_SUITE_END();
+
+protected:
+    ArchiveManager* mArchiveMgr;
+    ScriptCompilerManager* mScriptCompilerMgr;
+    AstCacheTestTranslatorManager* mTranslatorMgr;
+
+    /// Compiles the script with the AST cache enabled. Returns the values the
+    /// translator got, i.e. "a b" for "cache_test obj { value a b }"
+    String compile(const String &source);
+    /// The cache file that was written for the script
+    String findAstCacheFile(const String &source);
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testAstCacheHit();
+    void testAstCacheScriptChanged();
+    void testAstCacheImportChanged();
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "CommandBufferTests.h"
+#include "CommandBuffer/OgreCommandBuffer.h"
+#include "CommandBuffer/OgreCbShaderBuffer.h"
+#include "Vao/OgreConstBufferPacked.h"
+#include "Vao/OgreTexBufferPacked.h"
+
+#include "UnitTestSuite.h"
+
+#include <cstring>
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(CommandBufferTests);
+
+namespace
+{
+    /// What is bound on each slot, shared by all stages like GL3+ does
+    BufferPacked *gBoundSlots[16];
+
+    class SharedSlotConstBuffer : public ConstBufferPacked
+    {
+    public:
+        SharedSlotConstBuffer() :
+            ConstBufferPacked( 0, 1u, 256u, 0u, BT_DEFAULT, 0, false, 0, 0 ) {}
+
+        virtual void bindBufferVS( uint16 slot )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferPS( uint16 slot )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferGS( uint16 slot )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferHS( uint16 slot )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferDS( uint16 slot )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferCS( uint16 slot )    { gBoundSlots[slot] = this; }
+    };
+
+    class SharedSlotTexBuffer : public TexBufferPacked
+    {
+    public:
+        SharedSlotTexBuffer() :
+            TexBufferPacked( 0, 1u, 256u, 0u, BT_DEFAULT, 0, false, 0, 0, PFG_RGBA32_FLOAT ) {}
+
+        virtual void bindBufferVS( uint16 slot, size_t, size_t )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferPS( uint16 slot, size_t, size_t )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferGS( uint16 slot, size_t, size_t )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferDS( uint16 slot, size_t, size_t )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferHS( uint16 slot, size_t, size_t )    { gBoundSlots[slot] = this; }
+        virtual void bindBufferCS( uint16 slot, size_t, size_t )    { gBoundSlots[slot] = this; }
+    };
+
+    template <typename T>
+    void addBind( CommandBuffer &commandBuffer, ShaderType shaderType, uint16 slot, T *buffer )
+    {
+        *commandBuffer.addCommand<CbShaderBuffer>() = CbShaderBuffer( shaderType, slot, buffer,
+                                                                      0, 256u );
+    }
+}
+
+//--------------------------------------------------------------------------
+void CommandBufferTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    memset( gBoundSlots, 0, sizeof( gBoundSlots ) );
+}
+//--------------------------------------------------------------------------
+void CommandBufferTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void CommandBufferTests::testRedundantConstBuffer()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SharedSlotConstBuffer bufferA, bufferB;
+
+    CommandBuffer commandBuffer;
+    commandBuffer.setRemoveRedundantCommands( true );
+    addBind( commandBuffer, VertexShader, 2u, &bufferA );
+    addBind( commandBuffer, VertexShader, 2u, &bufferA );
+    // Another slot doesn't make the next bind necessary
+    addBind( commandBuffer, PixelShader, 3u, &bufferB );
+    addBind( commandBuffer, VertexShader, 2u, &bufferA );
+    commandBuffer.execute();
+
+    const CommandBufferStats &stats = commandBuffer.getStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, stats.numShaderBufferBinds );
+    CPPUNIT_ASSERT_EQUAL( (size_t)2u, stats.numRemovedCommands );
+    CPPUNIT_ASSERT( gBoundSlots[2] == &bufferA );
+    CPPUNIT_ASSERT( gBoundSlots[3] == &bufferB );
+}
+//--------------------------------------------------------------------------
+void CommandBufferTests::testInterleavedStagesConstBuffer()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SharedSlotConstBuffer bufferA, bufferB;
+
+    CommandBuffer commandBuffer;
+    commandBuffer.setRemoveRedundantCommands( true );
+    addBind( commandBuffer, VertexShader, 2u, &bufferA );
+    addBind( commandBuffer, PixelShader, 2u, &bufferB );
+    // Not redundant where the binding points are shared by all stages
+    addBind( commandBuffer, VertexShader, 2u, &bufferA );
+    commandBuffer.execute();
+
+    const CommandBufferStats &stats = commandBuffer.getStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)3u, stats.numShaderBufferBinds );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, stats.numRemovedCommands );
+    CPPUNIT_ASSERT( gBoundSlots[2] == &bufferA );
+}
+//--------------------------------------------------------------------------
+void CommandBufferTests::testInterleavedStagesTexBuffer()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SharedSlotTexBuffer bufferA, bufferB;
+
+    CommandBuffer commandBuffer;
+    commandBuffer.setRemoveRedundantCommands( true );
+    addBind( commandBuffer, VertexShader, 5u, &bufferA );
+    addBind( commandBuffer, PixelShader, 5u, &bufferB );
+    addBind( commandBuffer, VertexShader, 5u, &bufferA );
+    // Same bind as the last one on that slot
+    addBind( commandBuffer, VertexShader, 5u, &bufferA );
+    commandBuffer.execute();
+
+    const CommandBufferStats &stats = commandBuffer.getStats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)3u, stats.numShaderBufferBinds );
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, stats.numRemovedCommands );
+    CPPUNIT_ASSERT( gBoundSlots[5] == &bufferA );
+}
+//--------------------------------------------------------------------------
+void CommandBufferTests::testInterleavedStagesParallel()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    SharedSlotConstBuffer bufferA, bufferB;
+
+    // Enough commands to split the elimination across 2 threads
+    const size_t numIterations = 4096u;
+
+    CommandBuffer commandBuffer;
+    commandBuffer.setRemoveRedundantCommands( true );
+    for( size_t i=0; i<numIterations; ++i )
+    {
+        addBind( commandBuffer, VertexShader, 2u, &bufferA );
+        addBind( commandBuffer, PixelShader, 2u, &bufferB );
+    }
+    addBind( commandBuffer, VertexShader, 2u, &bufferA );
+
+    CPPUNIT_ASSERT( commandBuffer._prepareParallelRemoveRedundantCommands( 2u ) );
+    commandBuffer._removeRedundantCommands( 1u, 2u );
+    commandBuffer._removeRedundantCommands( 0u, 2u );
+    commandBuffer.execute();
+
+    const CommandBufferStats &stats = commandBuffer.getStats();
+    CPPUNIT_ASSERT_EQUAL( numIterations * 2u + 1u, stats.numShaderBufferBinds );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0u, stats.numRemovedCommands );
+    CPPUNIT_ASSERT( gBoundSlots[2] == &bufferA );
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,154 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "CompactObjectHandleTests.h"
+#include "Math/Array/OgreCompactObjectHandle.h"
+
+#include "UnitTestSuite.h"
+
+#include <cstring>
+
+using namespace Ogre;
+
+#if OGRE_COMPACT_OBJECT_HANDLES
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(CompactObjectHandleTests);
+
+namespace
+{
+    /// Minimal type meeting CompactObjectHandle's requirements
+    struct HandledObject
+    {
+        static CompactObjectHandleTable msCompactHandles;
+
+        uint32 mCompactHandle;
+        int mValue;
+
+        explicit HandledObject( int value ) : mValue( value )
+        {
+            mCompactHandle = msCompactHandles.add( this );
+        }
+        ~HandledObject()
+        {
+            msCompactHandles.remove( mCompactHandle );
+        }
+
+        uint32 _getCompactHandle(void) const    { return mCompactHandle; }
+    };
+
+    CompactObjectHandleTable HandledObject::msCompactHandles;
+}
+
+//--------------------------------------------------------------------------
+void CompactObjectHandleTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void CompactObjectHandleTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void CompactObjectHandleTests::testAddRemove()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    //The table is too big for the stack
+    CompactObjectHandleTable *table = new CompactObjectHandleTable();
+
+    int a = 0, b = 0, c = 0;
+    CPPUNIT_ASSERT( !table->get( 0 ) );
+
+    const uint32 handleA = table->add( &a );
+    const uint32 handleB = table->add( &b );
+    CPPUNIT_ASSERT( handleA != 0 && handleB != 0 && handleA != handleB );
+    CPPUNIT_ASSERT( table->get( handleA ) == &a );
+    CPPUNIT_ASSERT( table->get( handleB ) == &b );
+
+    //Released handles are reused
+    table->remove( handleA );
+    CPPUNIT_ASSERT( !table->get( handleA ) );
+    const uint32 handleC = table->add( &c );
+    CPPUNIT_ASSERT_EQUAL( handleA, handleC );
+    CPPUNIT_ASSERT( table->get( handleC ) == &c );
+    CPPUNIT_ASSERT( table->get( handleB ) == &b );
+
+    delete table;
+}
+//--------------------------------------------------------------------------
+void CompactObjectHandleTests::testManyBlocks()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CompactObjectHandleTable *table = new CompactObjectHandleTable();
+
+    //Enough objects to span several blocks
+    const size_t numObjects = 200000u;
+    vector<uint32>::type handles;
+    handles.reserve( numObjects );
+    for( size_t i=0; i<numObjects; ++i )
+        handles.push_back( table->add( reinterpret_cast<void*>( (i + 1u) * 16u ) ) );
+
+    for( size_t i=0; i<numObjects; ++i )
+    {
+        CPPUNIT_ASSERT( handles[i] != 0 );
+        CPPUNIT_ASSERT( table->get( handles[i] ) == reinterpret_cast<void*>( (i + 1u) * 16u ) );
+    }
+
+    delete table;
+}
+//--------------------------------------------------------------------------
+void CompactObjectHandleTests::testHandleConversion()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    HandledObject *objA = new HandledObject( 1 );
+    HandledObject *objB = new HandledObject( 2 );
+
+    CompactObjectHandle<HandledObject> handles[2];
+    CPPUNIT_ASSERT_EQUAL( sizeof( uint32 ) * 2u, sizeof( handles ) );
+
+    handles[0] = objA;
+    handles[1] = 0;
+    CPPUNIT_ASSERT( handles[0] == objA );
+    CPPUNIT_ASSERT( !handles[1] );
+    CPPUNIT_ASSERT_EQUAL( 1, handles[0]->mValue );
+
+    //Copying the raw memory (as ArrayMemoryManager does) keeps the reference
+    memcpy( &handles[1], &handles[0], sizeof( handles[0] ) );
+    handles[0] = objB;
+    CPPUNIT_ASSERT( handles[1] == objA );
+    CPPUNIT_ASSERT_EQUAL( 2, handles[0]->mValue );
+
+    HandledObject *ptr = handles[1];
+    CPPUNIT_ASSERT( ptr == objA );
+
+    delete objA;
+    delete objB;
+}
+#endif
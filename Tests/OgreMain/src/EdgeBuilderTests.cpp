@@ -30,11 +30,34 @@ THE SOFTWARE.
 #include "OgreVertexIndexData.h"
 #include "OgreEdgeListBuilder.h"
 
+#include <vector>
+
 #include "UnitTestSuite.h"
 
 // Register the test suite
 CPPUNIT_TEST_SUITE_REGISTRATION(EdgeBuilderTests);
 
+//--------------------------------------------------------------------------
+static void createTriangleList(VertexData &vd, IndexData &id, const float *positions,
+                               size_t numVertices, const unsigned short *indices,
+                               size_t numIndices)
+{
+    vd.vertexCount = numVertices;
+    vd.vertexStart = 0;
+    vd.vertexDeclaration = HardwareBufferManager::getSingleton().createVertexDeclaration();
+    vd.vertexDeclaration->addElement(0, 0, VET_FLOAT3, VES_POSITION);
+    HardwareVertexBufferSharedPtr vbuf = HardwareBufferManager::getSingleton().createVertexBuffer(
+        sizeof(float)*3, numVertices, HardwareBuffer::HBU_STATIC, true);
+    vd.vertexBufferBinding->setBinding(0, vbuf);
+    vbuf->writeData(0, vbuf->getSizeInBytes(), positions, true);
+
+    id.indexBuffer = HardwareBufferManager::getSingleton().createIndexBuffer(
+        HardwareIndexBuffer::IT_16BIT, numIndices, HardwareBuffer::HBU_STATIC, true);
+    id.indexCount = numIndices;
+    id.indexStart = 0;
+    id.indexBuffer->writeData(0, id.indexBuffer->getSizeInBytes(), indices, true);
+}
+
 //--------------------------------------------------------------------------
 void EdgeBuilderTests::setUp()
 {
@@ -293,3 +316,153 @@ void EdgeBuilderTests::testMultiIndexBufMultiVertexBuf()
     delete edgeData;
 }
 //--------------------------------------------------------------------------
+void EdgeBuilderTests::testWeldDuplicatePositions()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    /* Quad made of 2 triangles which don't share any vertex. Vertices at the
+    same position must be welded, including -0 against +0.
+    */
+    const float positions[] =
+    {
+        0.0f,  0.0f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f,  1.0f, 0.0f,
+        -0.0f, 0.0f, 0.0f,   1.0f, 1.0f, -0.0f,  0.0f,  1.0f, 0.0f
+    };
+    const unsigned short indices[] = { 0, 1, 2,  3, 4, 5 };
+
+    VertexData vd;
+    IndexData id;
+    createTriangleList(vd, id, positions, 6, indices, 6);
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    CPPUNIT_ASSERT(edgeData->edgeGroups.size() == 1);
+    CPPUNIT_ASSERT(edgeData->triangles.size() == 2);
+    // 4 borders + the shared diagonal
+    EdgeData::EdgeGroup& eg = edgeData->edgeGroups[0];
+    CPPUNIT_ASSERT(eg.edges.size() == 5);
+
+    size_t numConnected = 0;
+    for (size_t i = 0; i < eg.edges.size(); ++i)
+    {
+        const EdgeData::Edge& e = eg.edges[i];
+        if (!e.degenerate)
+        {
+            ++numConnected;
+            CPPUNIT_ASSERT(e.triIndex[0] == 0);
+            CPPUNIT_ASSERT(e.triIndex[1] == 1);
+            // Original indices are those of the first triangle
+            CPPUNIT_ASSERT(e.vertIndex[0] == 2);
+            CPPUNIT_ASSERT(e.vertIndex[1] == 0);
+        }
+    }
+    CPPUNIT_ASSERT(numConnected == 1);
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
+void EdgeBuilderTests::testWeldSharedEdgeOrder()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    /* Non-manifold edge shared by 4 triangles: 2 running one way, then 2
+    running the other way. They must be paired oldest first.
+    */
+    const float positions[] =
+    {
+        0, 0, 0,   1, 0, 0,   0, 1, 0,   0, -1, 0,   0, 0, 1,   0, 0, -1
+    };
+    const unsigned short indices[] =
+    {
+        0, 1, 2,
+        0, 1, 4,
+        1, 0, 3,
+        1, 0, 5
+    };
+
+    VertexData vd;
+    IndexData id;
+    createTriangleList(vd, id, positions, 6, indices, 12);
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    CPPUNIT_ASSERT(edgeData->triangles.size() == 4);
+    EdgeData::EdgeGroup& eg = edgeData->edgeGroups[0];
+    // 2 edges for 0-1, plus 2 open edges per triangle
+    CPPUNIT_ASSERT(eg.edges.size() == 10);
+
+    size_t numConnected = 0;
+    for (size_t i = 0; i < eg.edges.size(); ++i)
+    {
+        const EdgeData::Edge& e = eg.edges[i];
+        if (!e.degenerate)
+        {
+            ++numConnected;
+            CPPUNIT_ASSERT(e.vertIndex[0] == 0 && e.vertIndex[1] == 1);
+            CPPUNIT_ASSERT(e.triIndex[1] == e.triIndex[0] + 2);
+        }
+    }
+    CPPUNIT_ASSERT(numConnected == 2);
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
+void EdgeBuilderTests::testWeldGrid()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    /* Grid of quads, each one with its own 4 vertices. Once welded, only the
+    borders of the grid must remain open.
+    */
+    const size_t gridSize = 8;
+    std::vector<float> positions;
+    std::vector<unsigned short> indices;
+    for (size_t y = 0; y < gridSize; ++y)
+    {
+        for (size_t x = 0; x < gridSize; ++x)
+        {
+            const unsigned short base = static_cast<unsigned short>(positions.size() / 3u);
+            for (size_t i = 0; i < 4; ++i)
+            {
+                positions.push_back(static_cast<float>(x + (i == 1 || i == 2)) * 0.1f);
+                positions.push_back(static_cast<float>(y + (i >= 2)) * 0.1f);
+                positions.push_back(0.0f);
+            }
+            const unsigned short quad[6] = { 0, 1, 2,  0, 2, 3 };
+            for (size_t i = 0; i < 6; ++i)
+                indices.push_back(base + quad[i]);
+        }
+    }
+
+    VertexData vd;
+    IndexData id;
+    createTriangleList(vd, id, &positions[0], positions.size() / 3u,
+                       &indices[0], indices.size());
+
+    EdgeListBuilder edgeBuilder;
+    edgeBuilder.addVertexData(&vd);
+    edgeBuilder.addIndexData(&id);
+    EdgeData* edgeData = edgeBuilder.build();
+
+    CPPUNIT_ASSERT(edgeData->triangles.size() == gridSize * gridSize * 2);
+    EdgeData::EdgeGroup& eg = edgeData->edgeGroups[0];
+    // Horizontal, vertical & diagonal edges
+    CPPUNIT_ASSERT(eg.edges.size() == 2 * gridSize * (gridSize + 1) + gridSize * gridSize);
+
+    size_t numOpen = 0;
+    for (size_t i = 0; i < eg.edges.size(); ++i)
+    {
+        if (eg.edges[i].degenerate)
+            ++numOpen;
+    }
+    CPPUNIT_ASSERT(numOpen == 4 * gridSize);
+
+    delete edgeData;
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,239 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "JsonBinaryTests.h"
+#include "OgreJsonBinary.h"
+#include "OgreException.h"
+
+#include "UnitTestSuite.h"
+
+#if !OGRE_NO_JSON
+    #include "rapidjson/document.h"
+#endif
+
+#include <cstring>
+
+using namespace Ogre;
+
+#if !OGRE_NO_JSON
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(JsonBinaryTests);
+
+namespace
+{
+    const char *c_testJson =
+            "{"
+            "   \"name\" : \"Material \\\"quoted\\\"\","
+            "   \"enabled\" : true,"
+            "   \"disabled\" : false,"
+            "   \"nothing\" : null,"
+            "   \"count\" : 4294967296,"
+            "   \"offset\" : -12,"
+            "   \"scale\" : 0.25,"
+            "   \"values\" : [ 1, 2.5, \"three\", [], {} ],"
+            "   \"nested\" : { \"values\" : { \"name\" : \"inner\" } }"
+            "}";
+
+    /// Compares two trees, including member order and the number representation
+    bool isSameValue( const rapidjson::Value &a, const rapidjson::Value &b )
+    {
+        if( a.GetType() != b.GetType() )
+            return false;
+
+        if( a.IsNumber() )
+        {
+            if( a.IsUint64() != b.IsUint64() || a.IsInt64() != b.IsInt64() ||
+                a.IsDouble() != b.IsDouble() )
+            {
+                return false;
+            }
+            if( a.IsUint64() )
+                return a.GetUint64() == b.GetUint64();
+            if( a.IsInt64() )
+                return a.GetInt64() == b.GetInt64();
+            return a.GetDouble() == b.GetDouble();
+        }
+
+        if( a.IsString() )
+        {
+            return a.GetStringLength() == b.GetStringLength() &&
+                   memcmp( a.GetString(), b.GetString(), a.GetStringLength() ) == 0;
+        }
+
+        if( a.IsArray() )
+        {
+            if( a.Size() != b.Size() )
+                return false;
+            for( rapidjson::SizeType i=0; i<a.Size(); ++i )
+            {
+                if( !isSameValue( a[i], b[i] ) )
+                    return false;
+            }
+        }
+
+        if( a.IsObject() )
+        {
+            if( a.MemberCount() != b.MemberCount() )
+                return false;
+            rapidjson::Value::ConstMemberIterator itA = a.MemberBegin();
+            rapidjson::Value::ConstMemberIterator itB = b.MemberBegin();
+            for( ; itA != a.MemberEnd(); ++itA, ++itB )
+            {
+                if( !isSameValue( itA->name, itB->name ) || !isSameValue( itA->value, itB->value ) )
+                    return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+//--------------------------------------------------------------------------
+void JsonBinaryTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void JsonBinaryTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void JsonBinaryTests::testRoundTrip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    rapidjson::Document textDoc;
+    textDoc.Parse( c_testJson );
+    CPPUNIT_ASSERT( !textDoc.HasParseError() );
+
+    vector<uint8>::type binaryData;
+    JsonBinary::encode( textDoc, binaryData );
+    CPPUNIT_ASSERT( JsonBinary::isBinaryJson( &binaryData[0], binaryData.size() ) );
+    CPPUNIT_ASSERT( !JsonBinary::isBinaryJson( c_testJson, strlen( c_testJson ) ) );
+
+    rapidjson::Document binaryDoc;
+    JsonBinary::decode( "test.material.bin", &binaryData[0], binaryData.size(), binaryDoc );
+    CPPUNIT_ASSERT( isSameValue( textDoc, binaryDoc ) );
+
+    //Strings must reference the encoded data, not a copy of it.
+    const char *name = binaryDoc["name"].GetString();
+    CPPUNIT_ASSERT( name >= reinterpret_cast<const char*>( &binaryData[0] ) &&
+                    name < reinterpret_cast<const char*>( &binaryData[0] + binaryData.size() ) );
+}
+//--------------------------------------------------------------------------
+void JsonBinaryTests::testStringTableDeduplication()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    rapidjson::Document textDoc;
+    textDoc.Parse( c_testJson );
+    CPPUNIT_ASSERT( !textDoc.HasParseError() );
+
+    vector<uint8>::type binaryData;
+    JsonBinary::encode( textDoc, binaryData );
+
+    //"values" and "name" appear twice as keys but must be stored once.
+    const uint8 *begin = &binaryData[0];
+    const uint8 *end = begin + binaryData.size();
+    const char *needle = "values";
+    const size_t needleLen = strlen( needle ) + 1u;
+    size_t numFound = 0;
+    for( const uint8 *it = begin; it + needleLen <= end; ++it )
+    {
+        if( memcmp( it, needle, needleLen ) == 0 )
+            ++numFound;
+    }
+    CPPUNIT_ASSERT_EQUAL( (size_t)1u, numFound );
+
+    rapidjson::Document binaryDoc;
+    JsonBinary::decode( "test.material.bin", begin, binaryData.size(), binaryDoc );
+    CPPUNIT_ASSERT( binaryDoc["values"].IsArray() );
+    CPPUNIT_ASSERT( binaryDoc["nested"]["values"]["name"].IsString() );
+}
+//--------------------------------------------------------------------------
+void JsonBinaryTests::testCorruptData()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    rapidjson::Document textDoc;
+    textDoc.Parse( c_testJson );
+    CPPUNIT_ASSERT( !textDoc.HasParseError() );
+
+    vector<uint8>::type binaryData;
+    JsonBinary::encode( textDoc, binaryData );
+
+    //Every truncation must be rejected rather than read out of bounds.
+    for( size_t i=0; i<binaryData.size(); ++i )
+    {
+        vector<uint8>::type truncated( binaryData.begin(), binaryData.begin() + i );
+        rapidjson::Document doc;
+        CPPUNIT_ASSERT_THROW( JsonBinary::decode( "truncated.material.bin",
+                                                  truncated.empty() ? 0 : &truncated[0],
+                                                  truncated.size(), doc ),
+                              Ogre::Exception );
+    }
+
+    {
+        vector<uint8>::type trailing( binaryData );
+        trailing.push_back( 0 );
+        rapidjson::Document doc;
+        CPPUNIT_ASSERT_THROW( JsonBinary::decode( "trailing.material.bin", &trailing[0],
+                                                  trailing.size(), doc ),
+                              Ogre::Exception );
+    }
+
+    {
+        vector<uint8>::type badVersion( binaryData );
+        const uint32 version = JsonBinary::FORMAT_VERSION + 1u;
+        memcpy( &badVersion[4], &version, sizeof( version ) );
+        rapidjson::Document doc;
+        CPPUNIT_ASSERT_THROW( JsonBinary::decode( "version.material.bin", &badVersion[0],
+                                                  badVersion.size(), doc ),
+                              Ogre::Exception );
+    }
+
+    {
+        //Arrays nested far deeper than any material. Must not overflow the stack.
+        vector<uint8>::type deep( binaryData.begin(), binaryData.begin() + 8u );
+        const uint32 numStrings = 0;
+        deep.insert( deep.end(), reinterpret_cast<const uint8*>( &numStrings ),
+                     reinterpret_cast<const uint8*>( &numStrings ) + sizeof( numStrings ) );
+        const uint32 count = 1u;
+        for( size_t i=0; i<1000000u; ++i )
+        {
+            deep.push_back( JsonBinary::TagArray );
+            deep.insert( deep.end(), reinterpret_cast<const uint8*>( &count ),
+                         reinterpret_cast<const uint8*>( &count ) + sizeof( count ) );
+        }
+        deep.push_back( JsonBinary::TagNull );
+        rapidjson::Document doc;
+        CPPUNIT_ASSERT_THROW( JsonBinary::decode( "deep.material.bin", &deep[0], deep.size(), doc ),
+                              Ogre::Exception );
+    }
+}
+#endif
@@ -45,6 +45,12 @@ THE SOFTWARE.
 #include "OgreMaterialManager.h"
 #include "OgreLodStrategyManager.h"
 #include "OgreSkeleton.h"
+#include "OgreMesh2.h"
+#include "OgreSubMesh2.h"
+#include "OgreMesh2Serializer.h"
+#include "Vao/OgreNULLVaoManager.h"
+#include "Vao/OgreVertexArrayObject.h"
+#include "Vao/OgreAsyncTicket.h"
 
 #include "UnitTestSuite.h"
 
@@ -320,6 +326,224 @@ void MeshSerializerTests::testMesh_XML()
 #endif
 }
 //--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh2_Version_2_1()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Buffers get created straight from the stream's memory
+    testMesh2(false, Serializer::ENDIAN_NATIVE, true);
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh2_Version_2_1_Shadowed()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Shadow copies can't point to the stream's memory, buffers get copied
+    testMesh2(true, Serializer::ENDIAN_NATIVE, true);
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh2_Version_2_1_FlipEndian()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+#if OGRE_ENDIAN == OGRE_ENDIAN_BIG
+    testMesh2(false, Serializer::ENDIAN_LITTLE, true);
+#else
+    testMesh2(false, Serializer::ENDIAN_BIG, true);
+#endif
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh2_Version_2_1_NoOptionalChunks()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Meshes without meshlets nor SubMesh bounds must not get them after loading
+    testMesh2(false, Serializer::ENDIAN_NATIVE, false);
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::testMesh2(bool shadowed, Serializer::Endian endianMode,
+                                    bool optionalChunks)
+{
+    NULLVaoManager *vaoManager = OGRE_NEW NULLVaoManager();
+
+    Ogre::Mesh *origMesh = createMesh2Grid(vaoManager, "Grid.mesh", shadowed, optionalChunks);
+    Ogre::Mesh *mesh = OGRE_NEW Ogre::Mesh(0, "Grid.mesh.test", 0, origMesh->getGroup(),
+                                           vaoManager, true);
+    mesh->setVertexBufferPolicy(BT_IMMUTABLE, shadowed);
+    mesh->setIndexBufferPolicy(BT_IMMUTABLE, shadowed);
+
+    // Allocate more than enough, then keep only what was written
+    DataStreamPtr stream(OGRE_NEW MemoryDataStream(1024 * 1024));
+    Ogre::MeshSerializer serializer(vaoManager);
+    serializer.exportMesh(origMesh, stream, MESH_VERSION_LATEST, endianMode);
+
+    const size_t fileSize = stream->tell();
+    DataStreamPtr fileStream(OGRE_NEW MemoryDataStream(fileSize));
+    memcpy(static_cast<MemoryDataStream*>(fileStream.get())->getPtr(),
+           static_cast<MemoryDataStream*>(stream.get())->getPtr(), fileSize);
+    stream.setNull();
+
+    serializer.importMesh(fileStream, mesh);
+    assertMesh2Clone(origMesh, mesh);
+
+    if (!optionalChunks) {
+        CPPUNIT_ASSERT(!mesh->getSubMesh(0)->hasMeshlets());
+        CPPUNIT_ASSERT(!mesh->getSubMesh(0)->hasAabb());
+    }
+
+    OGRE_DELETE mesh;
+    OGRE_DELETE origMesh;
+    fileStream.setNull();
+    OGRE_DELETE vaoManager;
+}
+//--------------------------------------------------------------------------
+Ogre::Mesh* MeshSerializerTests::createMesh2Grid(VaoManager *vaoManager, const String &name,
+                                                 bool shadowed, bool optionalChunks)
+{
+    // A 16x16 quad grid, big enough to span several meshlets
+    const uint16 numQuads = 16;
+    const uint16 numSide = numQuads + 1;
+    const size_t numVertices = numSide * numSide;
+    const size_t numIndices = numQuads * numQuads * 6u;
+
+    float *vertices = reinterpret_cast<float*>(OGRE_MALLOC_SIMD(numVertices * 6u * sizeof(float),
+                                                                MEMCATEGORY_GEOMETRY));
+    uint16 *indices = reinterpret_cast<uint16*>(OGRE_MALLOC_SIMD(numIndices * sizeof(uint16),
+                                                                 MEMCATEGORY_GEOMETRY));
+    for (uint16 y = 0; y < numSide; ++y) {
+        for (uint16 x = 0; x < numSide; ++x) {
+            float *vertex = vertices + (y * numSide + x) * 6u;
+            vertex[0] = x * 0.5f - 4.0f;
+            vertex[1] = Math::Sin(x * 0.25f) * Math::Cos(y * 0.25f);
+            vertex[2] = y * 0.5f - 4.0f;
+            vertex[3] = 0.0f;
+            vertex[4] = 1.0f;
+            vertex[5] = 0.0f;
+        }
+    }
+    uint16 *index = indices;
+    for (uint16 y = 0; y < numQuads; ++y) {
+        for (uint16 x = 0; x < numQuads; ++x) {
+            const uint16 corner = y * numSide + x;
+            *index++ = corner;
+            *index++ = corner + numSide;
+            *index++ = corner + 1;
+            *index++ = corner + 1;
+            *index++ = corner + numSide;
+            *index++ = corner + numSide + 1;
+        }
+    }
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_POSITION));
+    vertexElements.push_back(VertexElement2(VET_FLOAT3, VES_NORMAL));
+
+    // When kept as shadow, the buffers take ownership of the pointers
+    VertexBufferPacked *vertexBuffer = vaoManager->createVertexBuffer(
+                vertexElements, numVertices, BT_IMMUTABLE, vertices, shadowed);
+    IndexBufferPacked *indexBuffer = vaoManager->createIndexBuffer(
+                IndexBufferPacked::IT_16BIT, numIndices, BT_IMMUTABLE, indices, shadowed);
+    if (!shadowed) {
+        OGRE_FREE_SIMD(vertices, MEMCATEGORY_GEOMETRY);
+        OGRE_FREE_SIMD(indices, MEMCATEGORY_GEOMETRY);
+    }
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back(vertexBuffer);
+    VertexArrayObject *vao = vaoManager->createVertexArrayObject(vertexBuffers, indexBuffer,
+                                                                 OT_TRIANGLE_LIST);
+
+    Ogre::Mesh *mesh = OGRE_NEW Ogre::Mesh(0, name, 0,
+                                           ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME,
+                                           vaoManager, true);
+    mesh->setVertexBufferPolicy(BT_IMMUTABLE, shadowed);
+    mesh->setIndexBufferPolicy(BT_IMMUTABLE, shadowed);
+
+    Ogre::SubMesh *subMesh = mesh->createSubMesh();
+    subMesh->mMaterialName = "BaseWhite";
+    subMesh->mVao[VpNormal].push_back(vao);
+    subMesh->mVao[VpShadow].push_back(vao);
+
+    if (optionalChunks) {
+        subMesh->buildMeshlets(64u, 124u);
+        subMesh->computeAabb();
+        CPPUNIT_ASSERT(subMesh->getMeshlets().size() > 1u);
+        CPPUNIT_ASSERT(subMesh->hasAabb());
+    }
+
+    mesh->_setBounds(Aabb(Vector3::ZERO, Vector3(4.0f, 1.0f, 4.0f)), false);
+    mesh->_setBoundingSphereRadius(Vector3(4.0f, 1.0f, 4.0f).length());
+
+    return mesh;
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::assertMesh2Clone(Ogre::Mesh *a, Ogre::Mesh *b)
+{
+    CPPUNIT_ASSERT(a->getAabb() == b->getAabb());
+    CPPUNIT_ASSERT(a->getBoundingSphereRadius() == b->getBoundingSphereRadius());
+    CPPUNIT_ASSERT(a->getNumSubMeshes() == b->getNumSubMeshes());
+
+    for (unsigned short i = 0; i < a->getNumSubMeshes(); i++) {
+        Ogre::SubMesh *aSubMesh = a->getSubMesh(i);
+        Ogre::SubMesh *bSubMesh = b->getSubMesh(i);
+
+        CPPUNIT_ASSERT(aSubMesh->mMaterialName == bSubMesh->mMaterialName);
+        CPPUNIT_ASSERT(aSubMesh->mVao[VpNormal].size() == bSubMesh->mVao[VpNormal].size());
+
+        for (size_t j = 0; j < aSubMesh->mVao[VpNormal].size(); j++) {
+            VertexArrayObject *aVao = aSubMesh->mVao[VpNormal][j];
+            VertexArrayObject *bVao = bSubMesh->mVao[VpNormal][j];
+
+            CPPUNIT_ASSERT(aVao->getOperationType() == bVao->getOperationType());
+            CPPUNIT_ASSERT(aVao->getPrimitiveStart() == bVao->getPrimitiveStart());
+            CPPUNIT_ASSERT(aVao->getPrimitiveCount() == bVao->getPrimitiveCount());
+
+            const VertexBufferPackedVec &aVertexBuffers = aVao->getVertexBuffers();
+            const VertexBufferPackedVec &bVertexBuffers = bVao->getVertexBuffers();
+            CPPUNIT_ASSERT(aVertexBuffers.size() == bVertexBuffers.size());
+            for (size_t k = 0; k < aVertexBuffers.size(); k++) {
+                CPPUNIT_ASSERT(aVertexBuffers[k]->getVertexElements() ==
+                               bVertexBuffers[k]->getVertexElements());
+                assertBufferClone(aVertexBuffers[k], bVertexBuffers[k]);
+            }
+
+            CPPUNIT_ASSERT(!aVao->getIndexBuffer() == !bVao->getIndexBuffer());
+            if (aVao->getIndexBuffer()) {
+                CPPUNIT_ASSERT(aVao->getIndexBuffer()->getIndexType() ==
+                               bVao->getIndexBuffer()->getIndexType());
+                assertBufferClone(aVao->getIndexBuffer(), bVao->getIndexBuffer());
+            }
+        }
+
+        // Stored bit by bit, hence exact comparisons
+        CPPUNIT_ASSERT(aSubMesh->getAabb() == bSubMesh->getAabb());
+
+        const Ogre::SubMesh::MeshletVec &aMeshlets = aSubMesh->getMeshlets();
+        const Ogre::SubMesh::MeshletVec &bMeshlets = bSubMesh->getMeshlets();
+        CPPUNIT_ASSERT(aMeshlets.size() == bMeshlets.size());
+        for (size_t j = 0; j < aMeshlets.size(); j++) {
+            CPPUNIT_ASSERT(aMeshlets[j].indexStart == bMeshlets[j].indexStart);
+            CPPUNIT_ASSERT(aMeshlets[j].indexCount == bMeshlets[j].indexCount);
+            CPPUNIT_ASSERT(aMeshlets[j].center == bMeshlets[j].center);
+            CPPUNIT_ASSERT(aMeshlets[j].radius == bMeshlets[j].radius);
+            CPPUNIT_ASSERT(aMeshlets[j].coneAxis == bMeshlets[j].coneAxis);
+            CPPUNIT_ASSERT(aMeshlets[j].coneCutoff == bMeshlets[j].coneCutoff);
+        }
+    }
+}
+//--------------------------------------------------------------------------
+void MeshSerializerTests::assertBufferClone(BufferPacked *a, BufferPacked *b)
+{
+    CPPUNIT_ASSERT(a->getNumElements() == b->getNumElements());
+    CPPUNIT_ASSERT(a->getBytesPerElement() == b->getBytesPerElement());
+
+    AsyncTicketPtr aTicket = a->readRequest(0, a->getNumElements());
+    AsyncTicketPtr bTicket = b->readRequest(0, b->getNumElements());
+    CPPUNIT_ASSERT(memcmp(aTicket->map(), bTicket->map(), a->getTotalSizeBytes()) == 0);
+    aTicket->unmap();
+    bTicket->unmap();
+}
+//--------------------------------------------------------------------------
 void MeshSerializerTests::assertMeshClone(Mesh* a, Mesh* b, MeshVersion version /*= MESH_VERSION_LATEST*/)
 {
     // TODO: Compare skeleton
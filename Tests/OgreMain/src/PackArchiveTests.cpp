@@ -0,0 +1,269 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "PackArchiveTests.h"
+#include "OgrePackArchive.h"
+#include "OgreDataStream.h"
+#include "OgreException.h"
+#include "OgreStringConverter.h"
+
+#include "UnitTestSuite.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(PackArchiveTests);
+
+//--------------------------------------------------------------------------
+static void addPackFile(PackArchiveWriter& writer, const String& name, const String& contents,
+                        PackArchive::Compression compression)
+{
+    DataStreamPtr stream(OGRE_NEW MemoryDataStream(const_cast<char*>(contents.c_str()),
+                                                   contents.size()));
+    writer.addFile(name, stream, compression);
+}
+//--------------------------------------------------------------------------
+static StringVector sorted(const StringVectorPtr& vec)
+{
+    // The index is sorted by hash, not by name
+    StringVector retVal(vec->begin(), vec->end());
+    std::sort(retVal.begin(), retVal.end());
+    return retVal;
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    mTestPath = "PackArchiveTests.pack";
+
+    mTextFile = "This is the first file in the root of the pack.\n";
+
+    // Several blocks, so that decompression can be threaded
+    for (int i = 0; i < 1000; ++i)
+        mCompressibleFile += "material file" + StringConverter::toString(i) + "\n{\n}\n";
+
+    // Doesn't compress, gets stored as is
+    srand(0);
+    for (int i = 0; i < 5000; ++i)
+        mRandomFile.push_back(static_cast<char>(rand() & 0xFF));
+
+    // Without Zip support the writer can't compress
+    const PackArchive::Compression compression =
+            PackArchive::isCompressionSupported(PackArchive::PackCompressionDeflate) ?
+                PackArchive::PackCompressionDeflate : PackArchive::PackCompressionNone;
+
+    PackArchiveWriter writer(mTestPath, 4096u, 1024u);
+    addPackFile(writer, "rootfile.txt", mTextFile, PackArchive::PackCompressionNone);
+    addPackFile(writer, "level1/materials/scripts/file.material", mCompressibleFile, compression);
+    addPackFile(writer, "level2/random.bin", mRandomFile, compression);
+    addPackFile(writer, "level2/Mixed Case.TXT", mTextFile, PackArchive::PackCompressionNone);
+    writer.finish();
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::tearDown()
+{
+    remove(mTestPath.c_str());
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::testList()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    PackArchive arch(mTestPath, "Pack");
+    arch.load();
+
+    StringVector vec = sorted(arch.list(false));
+    CPPUNIT_ASSERT_EQUAL((size_t)1, vec.size());
+    CPPUNIT_ASSERT_EQUAL(String("rootfile.txt"), vec[0]);
+
+    vec = sorted(arch.list(true));
+    CPPUNIT_ASSERT_EQUAL((size_t)4, vec.size());
+    CPPUNIT_ASSERT_EQUAL(String("level1/materials/scripts/file.material"), vec[0]);
+    CPPUNIT_ASSERT_EQUAL(String("level2/Mixed Case.TXT"), vec[1]);
+    CPPUNIT_ASSERT_EQUAL(String("level2/random.bin"), vec[2]);
+    CPPUNIT_ASSERT_EQUAL(String("rootfile.txt"), vec[3]);
+
+    // Folders are derived from the paths of the files
+    vec = sorted(arch.list(true, true));
+    CPPUNIT_ASSERT_EQUAL((size_t)4, vec.size());
+    CPPUNIT_ASSERT_EQUAL(String("level1"), vec[0]);
+    CPPUNIT_ASSERT_EQUAL(String("level1/materials"), vec[1]);
+    CPPUNIT_ASSERT_EQUAL(String("level1/materials/scripts"), vec[2]);
+    CPPUNIT_ASSERT_EQUAL(String("level2"), vec[3]);
+
+    FileInfoListPtr fil = arch.listFileInfo(false);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, fil->size());
+    CPPUNIT_ASSERT_EQUAL(String("rootfile.txt"), fil->at(0).basename);
+    CPPUNIT_ASSERT_EQUAL(BLANKSTRING, fil->at(0).path);
+    CPPUNIT_ASSERT_EQUAL(mTextFile.size(), fil->at(0).compressedSize);
+    CPPUNIT_ASSERT_EQUAL(mTextFile.size(), fil->at(0).uncompressedSize);
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::testFind()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    PackArchive arch(mTestPath, "Pack");
+    arch.load();
+
+    StringVectorPtr vec = arch.find("*.material", true);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, vec->size());
+    CPPUNIT_ASSERT_EQUAL(String("level1/materials/scripts/file.material"), vec->at(0));
+
+    FileInfoListPtr fil = arch.findFileInfo("level2/*", true);
+    CPPUNIT_ASSERT_EQUAL((size_t)2, fil->size());
+    CPPUNIT_ASSERT_EQUAL(String("level2/"), fil->at(0).path);
+    CPPUNIT_ASSERT_EQUAL(String("level2/"), fil->at(1).path);
+
+    // Lookups ignore the case, and accept '\\' as separator
+    CPPUNIT_ASSERT(arch.exists("rootfile.txt"));
+    CPPUNIT_ASSERT(arch.exists("ROOTFILE.TXT"));
+    CPPUNIT_ASSERT(arch.exists("level2/mixed case.txt"));
+    CPPUNIT_ASSERT(arch.exists("LEVEL2\\Mixed Case.TXT"));
+    CPPUNIT_ASSERT(!arch.exists("level2"));
+    CPPUNIT_ASSERT(!arch.exists("missing.txt"));
+    CPPUNIT_ASSERT(!arch.exists("level1/rootfile.txt"));
+
+    CPPUNIT_ASSERT_THROW(arch.open("missing.txt"), Exception);
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::testStoredRead()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    PackArchive arch(mTestPath, "Pack");
+    arch.load();
+
+    DataStreamPtr stream = arch.open("rootfile.txt");
+    CPPUNIT_ASSERT_EQUAL(mTextFile.size(), stream->size());
+    // Stored entries are views of the mapped pack
+    CPPUNIT_ASSERT(stream->getDataView() != 0);
+    CPPUNIT_ASSERT_EQUAL(mTextFile, stream->getAsString());
+
+    // Interleaved reads of two streams of the same pack
+    DataStreamPtr stream1 = arch.open("rootfile.txt");
+    DataStreamPtr stream2 = arch.open("level2/mixed case.txt");
+    char buf1[8], buf2[8];
+    stream1->read(buf1, 4);
+    stream2->read(buf2, 4);
+    stream1->read(buf1 + 4, 4);
+    stream2->read(buf2 + 4, 4);
+    CPPUNIT_ASSERT(mTextFile.compare(0, 8, buf1, 8) == 0);
+    CPPUNIT_ASSERT(mTextFile.compare(0, 8, buf2, 8) == 0);
+
+    // The streams keep the mapping alive
+    arch.unload();
+    CPPUNIT_ASSERT_EQUAL(mTextFile, stream->getAsString());
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::testCompressedRead()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    PackArchive arch(mTestPath, "Pack");
+    arch.load();
+
+    FileInfoListPtr fil = arch.findFileInfo("level2/random.bin", true);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, fil->size());
+    // Compression didn't pay off, so it was stored instead
+    CPPUNIT_ASSERT_EQUAL(mRandomFile.size(), fil->at(0).compressedSize);
+    CPPUNIT_ASSERT_EQUAL(mRandomFile, arch.open("level2/random.bin")->getAsString());
+
+    fil = arch.findFileInfo("level1/materials/scripts/file.material", true);
+    CPPUNIT_ASSERT_EQUAL((size_t)1, fil->size());
+    CPPUNIT_ASSERT_EQUAL(mCompressibleFile.size(), fil->at(0).uncompressedSize);
+
+    if (!PackArchive::isCompressionSupported(PackArchive::PackCompressionDeflate))
+    {
+        // Built without Zip support, thus stored as is
+        CPPUNIT_ASSERT_EQUAL(mCompressibleFile.size(), fil->at(0).compressedSize);
+        CPPUNIT_ASSERT_EQUAL(mCompressibleFile,
+                             arch.open("level1/materials/scripts/file.material")->getAsString());
+        return;
+    }
+
+    CPPUNIT_ASSERT(fil->at(0).compressedSize < mCompressibleFile.size());
+
+    const uint32 oldNumThreads = PackArchive::getNumDecompressionThreads();
+    const uint32 numThreads[] = { 1u, 4u, 0u };
+    for (size_t i = 0; i < sizeof(numThreads) / sizeof(numThreads[0]); ++i)
+    {
+        PackArchive::setNumDecompressionThreads(numThreads[i]);
+        DataStreamPtr stream = arch.open("level1/materials/scripts/file.material");
+        CPPUNIT_ASSERT_EQUAL(mCompressibleFile.size(), stream->size());
+        CPPUNIT_ASSERT_EQUAL(mCompressibleFile, stream->getAsString());
+    }
+    PackArchive::setNumDecompressionThreads(oldNumThreads);
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::testAlignment()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    std::ifstream file(mTestPath.c_str(), std::ios::in | std::ios::binary);
+    PackArchive::PackHeader header;
+    file.read(reinterpret_cast<char*>(&header), sizeof(header));
+    CPPUNIT_ASSERT(!file.fail());
+    CPPUNIT_ASSERT_EQUAL(PackArchive::c_magic, header.magic);
+    CPPUNIT_ASSERT_EQUAL(PackArchive::c_version, header.version);
+    CPPUNIT_ASSERT_EQUAL((uint32)4, header.numEntries);
+    CPPUNIT_ASSERT_EQUAL((uint32)4096, header.alignment);
+
+    file.seekg(static_cast<std::streamoff>(header.indexOffset));
+    uint32 prevHash = 0;
+    for (uint32 i = 0; i < header.numEntries; ++i)
+    {
+        PackArchive::PackEntry entry;
+        file.read(reinterpret_cast<char*>(&entry), sizeof(entry));
+        CPPUNIT_ASSERT(!file.fail());
+        CPPUNIT_ASSERT_EQUAL((uint64)0, entry.dataOffset % header.alignment);
+        CPPUNIT_ASSERT(entry.nameHash >= prevHash);
+        prevHash = entry.nameHash;
+    }
+}
+//--------------------------------------------------------------------------
+void PackArchiveTests::testInvalidPack()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const String notAPack = "PackArchiveTests.txt";
+    {
+        std::ofstream file(notAPack.c_str(), std::ios::out | std::ios::binary);
+        file << "This is not a pack, but it is long enough to hold a pack header.";
+    }
+
+    PackArchive arch(notAPack, "Pack");
+    CPPUNIT_ASSERT_THROW(arch.load(), Exception);
+    remove(notAPack.c_str());
+
+    PackArchive missing("PackArchiveTestsMissing.pack", "Pack");
+    CPPUNIT_ASSERT_THROW(missing.load(), Exception);
+}
+//--------------------------------------------------------------------------
@@ -0,0 +1,258 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+
+#include "PixelFormatGpuUtilsTests.h"
+#include "OgreTextureBox.h"
+
+#include "UnitTestSuite.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(PixelFormatGpuUtilsTests);
+
+//--------------------------------------------------------------------------
+/// Every 8-bit value in every channel, with the channels out of step
+static std::vector<uint8> makeUnormData(size_t numChannels)
+{
+    std::vector<uint8> data(256u * numChannels);
+    for (size_t i = 0; i < 256u; ++i)
+    {
+        for (size_t c = 0; c < numChannels; ++c)
+            data[i * numChannels + c] = static_cast<uint8>(i * (2u * c + 1u) + c * 64u);
+    }
+    return data;
+}
+//--------------------------------------------------------------------------
+/// Special values, a sweep slightly wider than [0; 1], and the values around each
+/// boundary between two sRGB encoded values
+static std::vector<float> makeFloatValues()
+{
+    std::vector<float> values;
+    values.push_back(std::numeric_limits<float>::quiet_NaN());
+    values.push_back(-std::numeric_limits<float>::quiet_NaN());
+    values.push_back(std::numeric_limits<float>::infinity());
+    values.push_back(-std::numeric_limits<float>::infinity());
+    values.push_back(std::numeric_limits<float>::max());
+    values.push_back(std::numeric_limits<float>::denorm_min());
+    values.push_back(0.0f);
+    values.push_back(-0.0f);
+    values.push_back(-1.0f);
+    values.push_back(1.0f);
+    values.push_back(nextafterf(1.0f, 2.0f));
+    values.push_back(2.0f);
+    values.push_back(65504.0f);
+    values.push_back(1e10f);
+    values.push_back(0.0031308f);
+
+    for (int i = -256; i <= 4096 + 256; ++i)
+        values.push_back(static_cast<float>(i) / 4096.0f);
+
+    for (size_t i = 0; i < 256u; ++i)
+    {
+        float val = PixelFormatGpuUtils::fromSRGB((static_cast<float>(i) + 0.5f) / 255.0f);
+        for (size_t j = 0; j < 4u; ++j)
+            val = nextafterf(val, -1.0f);
+        for (size_t j = 0; j < 9u; ++j)
+        {
+            values.push_back(val);
+            val = nextafterf(val, 2.0f);
+        }
+    }
+
+    return values;
+}
+//--------------------------------------------------------------------------
+/// RGBA32_FLOAT pixels, so that every value ends up in every channel
+static std::vector<uint8> makeFloat32Data(const std::vector<float>& values, size_t numPixels)
+{
+    std::vector<uint8> data(numPixels * 4u * sizeof(float));
+    float* dataF = reinterpret_cast<float*>(&data[0]);
+    for (size_t i = 0; i < numPixels; ++i)
+    {
+        for (size_t c = 0; c < 4u; ++c)
+            dataF[i * 4u + c] = values[(i + c) % values.size()];
+    }
+    return data;
+}
+//--------------------------------------------------------------------------
+/// RGBA16_FLOAT pixels with every half bit pattern (NaNs, infinities and
+/// denormals included) in every channel
+static std::vector<uint8> makeFloat16Data()
+{
+    std::vector<uint8> data(65536u * 4u * sizeof(uint16));
+    uint16* dataH = reinterpret_cast<uint16*>(&data[0]);
+    for (size_t i = 0; i < 65536u; ++i)
+    {
+        for (size_t c = 0; c < 4u; ++c)
+            dataH[i * 4u + c] = static_cast<uint16>(i + c * 16384u);
+    }
+    return data;
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testCase(const std::vector<uint8>& srcData, uint32 height,
+                                        PixelFormatGpu srcFormat, PixelFormatGpu dstFormat,
+                                        bool verticalFlip)
+{
+    const uint32 srcBytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel(srcFormat);
+    const uint32 dstBytesPerPixel = PixelFormatGpuUtils::getBytesPerPixel(dstFormat);
+    const size_t numPixels = srcData.size() / srcBytesPerPixel;
+    const uint32 width = static_cast<uint32>(numPixels / height);
+    CPPUNIT_ASSERT(width * height * srcBytesPerPixel == srcData.size());
+
+    std::vector<uint8> dstData(numPixels * dstBytesPerPixel, 0xCD);
+    std::vector<uint8> refData(numPixels * dstBytesPerPixel, 0xCD);
+
+    TextureBox srcBox(width, height, 1u, 1u, srcBytesPerPixel, width * srcBytesPerPixel,
+                      width * height * srcBytesPerPixel);
+    srcBox.data = const_cast<uint8*>(&srcData[0]);
+    TextureBox dstBox(width, height, 1u, 1u, dstBytesPerPixel, width * dstBytesPerPixel,
+                      width * height * dstBytesPerPixel);
+    dstBox.data = &dstData[0];
+
+    PixelFormatGpuUtils::bulkPixelConversion(srcBox, srcFormat, dstBox, dstFormat,
+                                             verticalFlip);
+
+    float rgba[4];
+    for (size_t y = 0; y < height; ++y)
+    {
+        const size_t dstY = verticalFlip ? height - 1u - y : y;
+        for (size_t x = 0; x < width; ++x)
+        {
+            PixelFormatGpuUtils::unpackColour(
+                rgba, srcFormat, &srcData[(y * width + x) * srcBytesPerPixel]);
+            PixelFormatGpuUtils::packColour(
+                rgba, dstFormat, &refData[(dstY * width + x) * dstBytesPerPixel]);
+        }
+    }
+
+    CPPUNIT_ASSERT_MESSAGE(String(PixelFormatGpuUtils::toString(srcFormat)) + " to " +
+                           PixelFormatGpuUtils::toString(dstFormat) + " differs from fallback",
+                           memcmp(&dstData[0], &refData[0], dstData.size()) == 0);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testUnormToFloat()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const PixelFormatGpu srcFormats[4] =
+    {
+        PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB, PFG_BGRA8_UNORM, PFG_BGRA8_UNORM_SRGB
+    };
+    const std::vector<uint8> srcData = makeUnormData(4u);
+
+    for (size_t i = 0; i < 4u; ++i)
+    {
+        testCase(srcData, 1u, srcFormats[i], PFG_RGBA16_FLOAT);
+        testCase(srcData, 1u, srcFormats[i], PFG_RGBA32_FLOAT);
+    }
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testFloat32ToUnorm()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const PixelFormatGpu dstFormats[4] =
+    {
+        PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB, PFG_BGRA8_UNORM, PFG_BGRA8_UNORM_SRGB
+    };
+    const std::vector<float> values = makeFloatValues();
+    const std::vector<uint8> srcData = makeFloat32Data(values, values.size());
+
+    for (size_t i = 0; i < 4u; ++i)
+        testCase(srcData, 1u, PFG_RGBA32_FLOAT, dstFormats[i]);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testFloat16ToUnorm()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const PixelFormatGpu dstFormats[4] =
+    {
+        PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB, PFG_BGRA8_UNORM, PFG_BGRA8_UNORM_SRGB
+    };
+    const std::vector<uint8> srcData = makeFloat16Data();
+
+    for (size_t i = 0; i < 4u; ++i)
+        testCase(srcData, 1u, PFG_RGBA16_FLOAT, dstFormats[i]);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testFloat16ToFloat32()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    testCase(makeFloat16Data(), 1u, PFG_RGBA16_FLOAT, PFG_RGBA32_FLOAT);
+
+    const std::vector<float> values = makeFloatValues();
+    testCase(makeFloat32Data(values, values.size()), 1u, PFG_RGBA32_FLOAT, PFG_RGBA16_FLOAT);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testExpandR8RG8()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    testCase(makeUnormData(1u), 1u, PFG_R8_UNORM, PFG_RGBA8_UNORM);
+    testCase(makeUnormData(2u), 1u, PFG_RG8_UNORM, PFG_RGBA8_UNORM);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testVerticalFlip()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // 16x16 pixels
+    const std::vector<uint8> srcData = makeUnormData(4u);
+    testCase(srcData, 16u, PFG_RGBA8_UNORM_SRGB, PFG_RGBA32_FLOAT, true);
+    testCase(srcData, 16u, PFG_RGBA8_UNORM, PFG_RGBA8_UNORM_SRGB, true);
+}
+//--------------------------------------------------------------------------
+void PixelFormatGpuUtilsTests::testThreadedConversion()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Large enough to be split across threads, with rows that don't divide evenly
+    const std::vector<float> values = makeFloatValues();
+    const std::vector<uint8> srcData = makeFloat32Data(values, 1021u * 1031u);
+
+    // Fast path
+    testCase(srcData, 1031u, PFG_RGBA32_FLOAT, PFG_BGRA8_UNORM_SRGB);
+    testCase(srcData, 1031u, PFG_RGBA32_FLOAT, PFG_RGBA8_UNORM, true);
+    // Fallback
+    testCase(srcData, 1031u, PFG_RGBA32_FLOAT, PFG_RGBA16_UNORM);
+}
+//--------------------------------------------------------------------------
@@ -29,6 +29,9 @@ THE SOFTWARE.
 #include "OgreRadixSort.h"
 #include "OgreMath.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "UnitTestSuite.h"
 
 using namespace Ogre;
@@ -221,3 +224,119 @@ void RadixSortTests::testIntVector()
 //--------------------------------------------------------------------------
 
 
+static bool RadixSort64KeyLess(const RadixSort64::Key& a, const RadixSort64::Key& b)
+{
+    return a.hash < b.hash;
+}
+//--------------------------------------------------------------------------
+static void fillRadixSort64Keys(RadixSort64::KeyArray& keys, size_t numKeys)
+{
+    keys.resizePOD(numKeys);
+    for (size_t i = 0; i < numKeys; ++i)
+    {
+        // Few distinct values in the high bytes (with many duplicates to check
+        // stability) and an untouched byte in the middle which must be skipped
+        keys[i].hash = (uint64(rand() % 7) << 56u) | (uint64(rand() % 3) << 40u) |
+                       uint64(rand() % 50000);
+        keys[i].idx = static_cast<uint32>(i);
+    }
+}
+//--------------------------------------------------------------------------
+static void checkRadixSort64Result(const RadixSort64::KeyArray& keys,
+                                   const RadixSort64::KeyArray& original)
+{
+    std::vector<RadixSort64::Key> expected(original.begin(), original.end());
+    std::stable_sort(expected.begin(), expected.end(), RadixSort64KeyLess);
+
+    CPPUNIT_ASSERT(keys.size() == expected.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        CPPUNIT_ASSERT(keys[i].hash == expected[i].hash);
+        CPPUNIT_ASSERT(keys[i].idx == expected[i].idx);
+    }
+}
+//--------------------------------------------------------------------------
+void RadixSortTests::testRadixSort64()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    RadixSort64 sorter;
+    RadixSort64::KeyArray& keys = sorter.getKeys();
+
+    fillRadixSort64Keys(keys, 10000);
+    RadixSort64::KeyArray original = keys;
+    sorter.sort(1, 0);
+    checkRadixSort64Result(keys, original);
+
+    // Sorting again must not change anything
+    sorter.sort(1, 0);
+    checkRadixSort64Result(keys, original);
+
+    // All keys equal: no pass runs at all
+    for (size_t i = 0; i < keys.size(); ++i)
+        keys[i].hash = 0x1234567890ABCDEFull;
+    original = keys;
+    sorter.sort(1, 0);
+    checkRadixSort64Result(keys, original);
+
+    keys.clear();
+    sorter.sort(1, 0);
+    CPPUNIT_ASSERT(keys.empty());
+}
+//--------------------------------------------------------------------------
+void RadixSortTests::testRadixSort64Slices()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // Without a SceneManager the slices the worker threads would
+    // process are sorted one after another; the result must be the same
+    RadixSort64 sorter;
+    RadixSort64::KeyArray& keys = sorter.getKeys();
+
+    const size_t numThreads[] = { 2, 3, 4, 7 };
+    for (size_t i = 0; i < sizeof(numThreads) / sizeof(numThreads[0]); ++i)
+    {
+        // Odd count so the slices don't have the same size
+        fillRadixSort64Keys(keys, 12345);
+        const RadixSort64::KeyArray original = keys;
+        sorter.sort(numThreads[i], 0);
+        checkRadixSort64Result(keys, original);
+    }
+
+    // More slices than keys
+    fillRadixSort64Keys(keys, 3);
+    const RadixSort64::KeyArray original = keys;
+    sorter.sort(8, 0);
+    checkRadixSort64Result(keys, original);
+}
+//--------------------------------------------------------------------------
+void RadixSortTests::testRadixSort64InsertionSort()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // TemporalCoherenceSort: last frame's order is used as starting point
+    RadixSort64 sorter;
+    RadixSort64::KeyArray& keys = sorter.getKeys();
+
+    fillRadixSort64Keys(keys, 2000);
+    sorter.sort(1, 0);
+
+    // Swap a few neighbours, as if a few objects moved a bit
+    for (size_t i = 0; i < 20; ++i)
+    {
+        const size_t idx = static_cast<size_t>(rand()) % (keys.size() - 1u);
+        std::swap(keys[idx], keys[idx + 1u]);
+    }
+    RadixSort64::KeyArray original = keys;
+    CPPUNIT_ASSERT(sorter.insertionSort(keys.size()));
+    checkRadixSort64Result(keys, original);
+
+    // Reversed order needs too many shifts. It must bail out, and the
+    // radix sort fallback must still produce the right order
+    std::reverse(keys.begin(), keys.end());
+    original = keys;
+    CPPUNIT_ASSERT(!sorter.insertionSort(keys.size()));
+    sorter.sort(1, 0);
+    checkRadixSort64Result(keys, original);
+}
+//--------------------------------------------------------------------------
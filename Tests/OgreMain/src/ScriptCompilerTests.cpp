@@ -0,0 +1,244 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+(Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ScriptCompilerTests.h"
+#include "OgreScriptCompiler.h"
+#include "OgreScriptTranslator.h"
+#include "OgreResourceGroupManager.h"
+#include "OgreArchiveManager.h"
+#include "OgreFileSystem.h"
+
+#include "UnitTestSuite.h"
+
+#include <cstdio>
+#include <fstream>
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ScriptCompilerTests);
+
+static const char* c_scriptA = "ScriptCompilerTestsA.os";
+static const char* c_scriptB = "ScriptCompilerTestsB.os";
+static const char* c_scriptC = "ScriptCompilerTestsC.os";
+
+//--------------------------------------------------------------------------
+/// Records the values of the "cache_test" objects it translates
+class AstCacheTestTranslator : public ScriptTranslator
+{
+public:
+    String mValues;
+
+    void translate(ScriptCompiler *compiler, const AbstractNodePtr &node)
+    {
+        const ObjectAbstractNode *obj = static_cast<const ObjectAbstractNode*>(node.get());
+        for (AbstractNodeList::const_iterator i = obj->children.begin(); i != obj->children.end(); ++i)
+        {
+            if ((*i)->type != ANT_PROPERTY)
+                continue;
+
+            const PropertyAbstractNode *prop = static_cast<const PropertyAbstractNode*>(i->get());
+            for (AbstractNodeList::const_iterator j = prop->values.begin(); j != prop->values.end(); ++j)
+            {
+                if (!mValues.empty())
+                    mValues += " ";
+                mValues += (*j)->getValue();
+            }
+        }
+    }
+};
+//--------------------------------------------------------------------------
+class AstCacheTestTranslatorManager : public ScriptTranslatorManager
+{
+public:
+    AstCacheTestTranslator mTranslator;
+
+    size_t getNumTranslators() const
+    {
+        return 1;
+    }
+    ScriptTranslator *getTranslator(const AbstractNodePtr &node)
+    {
+        if (node->type == ANT_OBJECT &&
+            static_cast<const ObjectAbstractNode*>(node.get())->cls == "cache_test")
+        {
+            return &mTranslator;
+        }
+        return 0;
+    }
+};
+//--------------------------------------------------------------------------
+static void writeFile(const String &filename, const String &contents)
+{
+    std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary);
+    file.write(contents.c_str(), static_cast<std::streamsize>(contents.size()));
+}
+//--------------------------------------------------------------------------
+static String readFile(const String &filename)
+{
+    std::ifstream file(filename.c_str(), std::ios::in | std::ios::binary);
+    return String(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+
+    writeFile(c_scriptA, "cache_test alpha\n{\n    value original\n}\n");
+    writeFile(c_scriptB, "abstract cache_test base\n{\n    value fromImport\n}\n");
+    writeFile(c_scriptC, "import * from \"ScriptCompilerTestsB.os\"\n\n"
+                         "cache_test gamma : base\n{\n}\n");
+
+    OGRE_NEW ResourceGroupManager();
+    mArchiveMgr = OGRE_NEW ArchiveManager();
+    mArchiveMgr->addArchiveFactory(OGRE_NEW FileSystemArchiveFactory());
+    // Imports are opened through the ResourceGroupManager
+    ResourceGroupManager::getSingleton().addResourceLocation(".", "FileSystem");
+
+    mScriptCompilerMgr = OGRE_NEW ScriptCompilerManager();
+    mTranslatorMgr = OGRE_NEW AstCacheTestTranslatorManager();
+    mScriptCompilerMgr->addTranslatorManager(mTranslatorMgr);
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::tearDown()
+{
+    const char* scripts[] = { c_scriptA, c_scriptB, c_scriptC };
+    for (size_t i = 0; i < sizeof(scripts) / sizeof(scripts[0]); ++i)
+    {
+        String cacheFile = findAstCacheFile(scripts[i]);
+        while (!cacheFile.empty())
+        {
+            remove(cacheFile.c_str());
+            cacheFile = findAstCacheFile(scripts[i]);
+        }
+        remove(scripts[i]);
+    }
+
+    mScriptCompilerMgr->removeTranslatorManager(mTranslatorMgr);
+    OGRE_DELETE mTranslatorMgr;
+    OGRE_DELETE mScriptCompilerMgr;
+    OGRE_DELETE ResourceGroupManager::getSingletonPtr();
+    OGRE_DELETE mArchiveMgr;
+}
+//--------------------------------------------------------------------------
+String ScriptCompilerTests::compile(const String &source)
+{
+    mTranslatorMgr->mTranslator.mValues.clear();
+
+    ScriptCompiler compiler;
+    compiler.registerCustomWordId("cache_test");
+    compiler.setAstCacheFolder(".");
+    CPPUNIT_ASSERT(compiler.compile(readFile(source), source,
+                                    ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME));
+
+    return mTranslatorMgr->mTranslator.mValues;
+}
+//--------------------------------------------------------------------------
+String ScriptCompilerTests::findAstCacheFile(const String &source)
+{
+    // Cache files are named after a hash; the script's name is in their header
+    String retVal;
+    Archive *archive = mArchiveMgr->load(".", "FileSystem", true);
+    StringVectorPtr files = archive->find("*.ast", false);
+    for (StringVector::const_iterator i = files->begin(); i != files->end() && retVal.empty(); ++i)
+    {
+        if (readFile(*i).find(source) != String::npos)
+            retVal = *i;
+    }
+    mArchiveMgr->unload(archive);
+    return retVal;
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheHit()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    const String script = readFile(c_scriptA);
+    const uint32 hash = ScriptCompiler::_hashScriptSource(script);
+    CPPUNIT_ASSERT(!ScriptCompiler::_hasAstCache(".", c_scriptA, hash));
+
+    // First compilation writes the cache
+    CPPUNIT_ASSERT(compile(c_scriptA) == "original");
+    CPPUNIT_ASSERT(ScriptCompiler::_hasAstCache(".", c_scriptA, hash));
+
+    // Alter the cached tree. If the second compilation uses the cache
+    // (instead of parsing the script again) the translator gets the new value
+    const String cacheFile = findAstCacheFile(c_scriptA);
+    CPPUNIT_ASSERT(!cacheFile.empty());
+    String cache = readFile(cacheFile);
+    const size_t pos = cache.find("original");
+    CPPUNIT_ASSERT(pos != String::npos);
+    cache.replace(pos, 8u, "tampered");
+    writeFile(cacheFile, cache);
+
+    CPPUNIT_ASSERT(compile(c_scriptA) == "tampered");
+
+    // The listener may alter the tree, the cache isn't used then
+    ScriptCompilerListener listener;
+    mTranslatorMgr->mTranslator.mValues.clear();
+    ScriptCompiler compiler;
+    compiler.registerCustomWordId("cache_test");
+    compiler.setAstCacheFolder(".");
+    compiler.setListener(&listener);
+    CPPUNIT_ASSERT(compiler.compile(script, c_scriptA,
+                                    ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME));
+    CPPUNIT_ASSERT(mTranslatorMgr->mTranslator.mValues == "original");
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheScriptChanged()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    CPPUNIT_ASSERT(compile(c_scriptA) == "original");
+    const uint32 oldHash = ScriptCompiler::_hashScriptSource(readFile(c_scriptA));
+
+    writeFile(c_scriptA, "cache_test alpha\n{\n    value changed\n}\n");
+    const uint32 newHash = ScriptCompiler::_hashScriptSource(readFile(c_scriptA));
+    CPPUNIT_ASSERT(oldHash != newHash);
+    CPPUNIT_ASSERT(!ScriptCompiler::_hasAstCache(".", c_scriptA, newHash));
+
+    // Stale cache must be ignored, and replaced
+    CPPUNIT_ASSERT(compile(c_scriptA) == "changed");
+    CPPUNIT_ASSERT(ScriptCompiler::_hasAstCache(".", c_scriptA, newHash));
+    CPPUNIT_ASSERT(!ScriptCompiler::_hasAstCache(".", c_scriptA, oldHash));
+    CPPUNIT_ASSERT(compile(c_scriptA) == "changed");
+}
+//--------------------------------------------------------------------------
+void ScriptCompilerTests::testAstCacheImportChanged()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    // The values come from the imported script through inheritance
+    CPPUNIT_ASSERT(compile(c_scriptC) == "fromImport");
+    CPPUNIT_ASSERT(compile(c_scriptC) == "fromImport");
+
+    // The importing script didn't change, but its cache is stale
+    writeFile(c_scriptB, "abstract cache_test base\n{\n    value importChanged\n}\n");
+    CPPUNIT_ASSERT(ScriptCompiler::_hasAstCache(".", c_scriptC,
+                                                ScriptCompiler::_hashScriptSource(readFile(c_scriptC))));
+    CPPUNIT_ASSERT(compile(c_scriptC) == "importChanged");
+    CPPUNIT_ASSERT(compile(c_scriptC) == "importChanged");
+}
+//--------------------------------------------------------------------------
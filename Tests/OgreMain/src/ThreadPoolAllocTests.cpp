@@ -0,0 +1,159 @@
+/*
+-----------------------------------------------------------------------------
+This source file is part of OGRE
+    (Object-oriented Graphics Rendering Engine)
+For the latest info, see http://www.ogre3d.org/
+
+Copyright (c) 2000-2014 Torus Knot Software Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+-----------------------------------------------------------------------------
+*/
+#include "ThreadPoolAllocTests.h"
+#include "UnitTestSuite.h"
+
+#include "OgrePrerequisites.h"
+
+#if OGRE_MEMORY_ALLOCATOR == OGRE_MEMORY_ALLOCATOR_THREADPOOL
+
+#include "OgreMemoryThreadPool.h"
+#include "Threading/OgreThreads.h"
+
+using namespace Ogre;
+
+// Register the test suite
+CPPUNIT_TEST_SUITE_REGISTRATION(ThreadPoolAllocTests);
+
+namespace
+{
+    const size_t c_numCrossThreadBlocks = 1000;
+    void *sCrossThreadBlocks[c_numCrossThreadBlocks];
+
+    unsigned long allocFromThread( ThreadHandle *threadHandle )
+    {
+        for( size_t i=0; i<c_numCrossThreadBlocks; ++i )
+        {
+            sCrossThreadBlocks[i] = ThreadPoolAllocImpl::allocBytes( 16u + (i % 200u),
+                                                                     MEMCATEGORY_GENERAL );
+        }
+        return 0;
+    }
+    THREAD_DECLARE( allocFromThread );
+
+    unsigned long allocAndFree( ThreadHandle *threadHandle )
+    {
+        void *ptr = ThreadPoolAllocImpl::allocBytes( 64u, MEMCATEGORY_GENERAL );
+        ThreadPoolAllocImpl::deallocBytes( ptr );
+        return 0;
+    }
+    THREAD_DECLARE( allocAndFree );
+}
+
+//--------------------------------------------------------------------------
+void ThreadPoolAllocTests::setUp()
+{
+    UnitTestSuite::getSingletonPtr()->startTestSetup(__FUNCTION__);
+}
+//--------------------------------------------------------------------------
+void ThreadPoolAllocTests::tearDown()
+{
+}
+//--------------------------------------------------------------------------
+void ThreadPoolAllocTests::testAlignedAllocations()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ThreadPoolAllocStats statsBefore;
+    ThreadPoolAllocImpl::getStats( MEMCATEGORY_GENERAL, statsBefore );
+
+    //Alignments of 256 and above don't fit the offset in a byte
+    for( size_t align=1u; align<=4096u; align <<= 1u )
+    {
+        for( size_t bytes=1u; bytes<3000u; bytes += 97u )
+        {
+            uint8 *ptr = reinterpret_cast<uint8*>(
+                             ThreadPoolAllocImpl::allocBytesAligned( align, bytes,
+                                                                     MEMCATEGORY_GENERAL ) );
+            CPPUNIT_ASSERT( ptr != 0 );
+            CPPUNIT_ASSERT_EQUAL( (uintptr_t)0,
+                                  reinterpret_cast<uintptr_t>( ptr ) & (align - 1u) );
+            //Must not overlap the header
+            memset( ptr, 0xAB, bytes );
+            ThreadPoolAllocImpl::deallocBytesAligned( align, ptr );
+        }
+    }
+
+    ThreadPoolAllocStats statsAfter;
+    ThreadPoolAllocImpl::getStats( MEMCATEGORY_GENERAL, statsAfter );
+    CPPUNIT_ASSERT_EQUAL( statsBefore.liveBytes, statsAfter.liveBytes );
+    CPPUNIT_ASSERT_EQUAL( statsAfter.numAllocations - statsBefore.numAllocations,
+                          statsAfter.numDeallocations - statsBefore.numDeallocations );
+}
+//--------------------------------------------------------------------------
+void ThreadPoolAllocTests::testCrossThreadFree()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ThreadPoolAllocStats statsBefore;
+    ThreadPoolAllocImpl::getStats( MEMCATEGORY_GENERAL, statsBefore );
+
+    size_t reservedBefore = 0;
+    for( size_t i=0; i<4u; ++i )
+    {
+        {
+            //Scoped, since the handle is allocated from the pools too
+            ThreadHandlePtr threadHandle = Threads::CreateThread( THREAD_GET( allocFromThread ),
+                                                                  0, 0 );
+            Threads::WaitForThreads( 1u, &threadHandle );
+        }
+
+        //The blocks belong to a thread that already exited
+        for( size_t j=0; j<c_numCrossThreadBlocks; ++j )
+            ThreadPoolAllocImpl::deallocBytes( sCrossThreadBlocks[j] );
+
+        ThreadPoolAllocStats statsAfter;
+        ThreadPoolAllocImpl::getStats( MEMCATEGORY_GENERAL, statsAfter );
+        CPPUNIT_ASSERT_EQUAL( statsBefore.liveBytes, statsAfter.liveBytes );
+
+        //From then on, the next thread takes over the cache and claims the blocks back
+        if( i == 0 )
+            reservedBefore = ThreadPoolAllocImpl::getReservedBytes();
+        else
+            CPPUNIT_ASSERT_EQUAL( reservedBefore, ThreadPoolAllocImpl::getReservedBytes() );
+    }
+}
+//--------------------------------------------------------------------------
+void ThreadPoolAllocTests::testThreadCacheReuse()
+{
+    UnitTestSuite::getSingletonPtr()->startTestMethod(__FUNCTION__);
+
+    ThreadHandlePtr threadHandle = Threads::CreateThread( THREAD_GET( allocAndFree ), 0, 0 );
+    Threads::WaitForThreads( 1u, &threadHandle );
+
+    //Threads that exited give their cache to the next one, so nothing new gets reserved
+    const size_t reservedBefore = ThreadPoolAllocImpl::getReservedBytes();
+    for( size_t i=0; i<100u; ++i )
+    {
+        threadHandle = Threads::CreateThread( THREAD_GET( allocAndFree ), 0, 0 );
+        Threads::WaitForThreads( 1u, &threadHandle );
+    }
+    CPPUNIT_ASSERT_EQUAL( reservedBefore, ThreadPoolAllocImpl::getReservedBytes() );
+}
+
+#endif
@@ -0,0 +1,958 @@
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreSceneNode.h"
+#include "OgreMovableObject.h"
+#include "OgreTimer.h"
+#include "OgreString.h"
+#include "OgreStringConverter.h"
+#include "OgreMatrix4.h"
+#include "Math/Array/OgreArrayVector3.h"
+#include "Math/Array/OgreArrayQuaternion.h"
+#include "Math/Array/OgreArrayMatrixAf4x3.h"
+#include "Math/Array/OgreArrayAabb.h"
+#include "Math/Array/OgreBooleanMask.h"
+#include "Math/Array/OgreNodeMemoryManager.h"
+#include "Math/Array/OgreObjectMemoryManager.h"
+#include "Math/Array/OgreObjectData.h"
+#include "Math/Array/OgreTransform.h"
+
+#ifdef OGRE_STATIC_LIB
+#    include "OgreNULLRenderSystem.h"
+#endif
+
+#include <algorithm>
+
+/*
+    Micro-benchmarks of the ArrayMath SIMD primitives and of the scene kernels built on
+    top of them (Node::updateAllTransforms & MovableObject::cullFrustum).
+
+    Every test reports ns per element (an element is one lane, i.e. a pack contains
+    ARRAY_PACKED_REALS elements) and cross-checks each lane against the same operation
+    done with the scalar math classes (Vector3, Quaternion, Matrix4, Aabb), which is what
+    the C backend computes. A build with a different backend or ARRAY_PACKED_REALS is
+    thus validated against the same reference, and the CSVs of each build can be
+    compared side by side.
+
+    The array tests don't need a RenderSystem. The scene kernels are run on a
+    SceneManager created with the NULL RenderSystem.
+*/
+
+/// Prevents the compiler from collapsing the iterations of a benchmark loop into one
+#if OGRE_COMPILER == OGRE_COMPILER_MSVC
+#    include <intrin.h>
+#    define BENCHMARK_CLOBBER_MEMORY() _ReadWriteBarrier()
+#else
+#    define BENCHMARK_CLOBBER_MEMORY() asm volatile( "" : : : "memory" )
+#endif
+
+using namespace Ogre;
+
+static void printHelp()
+{
+    printf(
+        "Benchmarks the ArrayMath SIMD primitives and the scene kernels that use them,\n"
+        "validates them against the scalar math and prints the results as CSV.\n"
+        "\n"
+        "USAGE:\n"
+        "   OgreArrayMathBenchmark [options]\n"
+        "\n"
+        "OPTIONS:\n"
+        "   -e <elements>   Elements per primitive test. Default: 65536\n"
+        "   -i <iterations> Times each test is repeated. Default: 200\n"
+        "   -n <nodes>      SceneNodes (and objects) for the scene kernels. Default: 100000\n"
+        "   -d <depth>      Depth of the node hierarchy. Default: 4\n"
+        "   -t <a,b,c...>   Tests to run. Default: all of them\n"
+        "                   vec3_add vec3_dot vec3_cross vec3_normalise\n"
+        "                   quat_mul quat_rotate mat_concat mat_transform\n"
+        "                   aabb_intersects cmov4 updateAllTransforms cullFrustum\n"
+        "   -x <tolerance>  Max relative error against the scalar math. Default: 1e-4\n"
+        "   -o <file>       Also writes the CSV to file\n"
+        "\n"
+        "Returns non-zero if any lane didn't match the scalar math.\n" );
+}
+
+struct BenchmarkSettings
+{
+    uint32 numElements;
+    uint32 numIterations;
+    uint32 numNodes;
+    uint32 depth;
+    Real tolerance;
+    StringVector tests;
+};
+
+struct TestResult
+{
+    String  name;
+    size_t  numElements;
+    uint32  numIterations;
+    uint64  microseconds;
+    Real    tolerance;
+    Real    maxError;
+    size_t  numMismatches;
+
+    TestResult( const String &_name, size_t _numElements, uint32 _numIterations,
+                uint64 _microseconds, Real _tolerance ) :
+        name( _name ),
+        numElements( _numElements ),
+        numIterations( _numIterations ),
+        microseconds( _microseconds ),
+        tolerance( _tolerance ),
+        maxError( 0 ),
+        numMismatches( 0 )
+    {
+    }
+
+    void addError( Real error )
+    {
+        //Written this way so that NaNs count as mismatches
+        if( !(error <= tolerance) )
+            ++numMismatches;
+        maxError = std::max( maxError, error );
+    }
+
+    String toCsv( const char *backend ) const
+    {
+        const double nsPerElement = double( microseconds ) * 1000.0 /
+                                    ( double( numElements ) * double( numIterations ) );
+        char tmpBuffer[512];
+        snprintf( tmpBuffer, sizeof( tmpBuffer ), "%s,%u,%s,%u,%u,%.3f,%g,%u\n",
+                  backend, static_cast<uint32>( ARRAY_PACKED_REALS ), name.c_str(),
+                  static_cast<uint32>( numElements ), numIterations, nsPerElement,
+                  double( maxError ), static_cast<uint32>( numMismatches ) );
+        return tmpBuffer;
+    }
+};
+
+typedef vector<TestResult>::type TestResultVec;
+
+/// SoA inputs & outputs shared by all the primitive tests
+struct ArrayData
+{
+    size_t              numPacks;
+    Real                tolerance;
+    ArrayVector3        *vecA;
+    ArrayVector3        *vecB;
+    ArrayVector3        *vecOut;
+    ArrayReal           *realA;
+    ArrayReal           *realB;
+    ArrayReal           *realOut;
+    ArrayQuaternion     *quatA;
+    ArrayQuaternion     *quatB;
+    ArrayQuaternion     *quatOut;
+    ArrayMatrixAf4x3    *matA;
+    ArrayMatrixAf4x3    *matB;
+    ArrayMatrixAf4x3    *matOut;
+    ArrayAabb           *aabbA;
+    ArrayAabb           *aabbB;
+    uint32              *maskOut;
+    /// ARRAY_PACKED_REALS matrices, for SoA <-> AoS conversions
+    Matrix4             *tmpMatrices;
+
+    size_t getNumElements() const   { return numPacks * ARRAY_PACKED_REALS; }
+};
+
+typedef TestResult (*ArrayTestFunc)( ArrayData &data, uint32 numIterations, Timer &timer );
+
+static const char* getBackendName()
+{
+#if OGRE_USE_SIMD == 0
+    return "C";
+#elif OGRE_CPU == OGRE_CPU_X86
+    #if OGRE_USE_AVX2
+        return "SSE2_AVX2";
+    #else
+        return "SSE2";
+    #endif
+#elif OGRE_CPU == OGRE_CPU_ARM
+    return "NEON";
+#else
+    return "Unknown";
+#endif
+}
+
+/// Deterministic, so that every run and backend benchmarks the exact same data
+static Real randomReal( uint32 &seed, Real minVal, Real maxVal )
+{
+    seed = seed * 1664525u + 1013904223u;
+    const Real t = Real( seed >> 8u ) / Real( 1u << 24u );
+    return minVal + ( maxVal - minVal ) * t;
+}
+//-----------------------------------------------------------------------------------
+static Vector3 randomVector3( uint32 &seed, Real minVal, Real maxVal )
+{
+    return Vector3( randomReal( seed, minVal, maxVal ),
+                    randomReal( seed, minVal, maxVal ),
+                    randomReal( seed, minVal, maxVal ) );
+}
+//-----------------------------------------------------------------------------------
+static Quaternion randomQuaternion( uint32 &seed )
+{
+    Vector3 axis = randomVector3( seed, -1.0f, 1.0f );
+    axis.normalise();
+    if( axis.isZeroLength() )
+        axis = Vector3::UNIT_Y;
+    return Quaternion( Radian( randomReal( seed, -Math::PI, Math::PI ) ), axis );
+}
+//-----------------------------------------------------------------------------------
+static Real getLane( const ArrayReal &value, size_t lane )
+{
+    return reinterpret_cast<const Real*>( &value )[lane];
+}
+//-----------------------------------------------------------------------------------
+static Real relativeError( Real value, Real reference )
+{
+    return Math::Abs( value - reference ) / std::max( Math::Abs( reference ), Real( 1.0f ) );
+}
+//-----------------------------------------------------------------------------------
+static Real relativeError( const Vector3 &value, const Vector3 &reference )
+{
+    return ( value - reference ).length() / std::max( reference.length(), Real( 1.0f ) );
+}
+//-----------------------------------------------------------------------------------
+static Real relativeError( const Quaternion &value, const Quaternion &reference )
+{
+    const Quaternion diff = value - reference;
+    return Math::Sqrt( diff.Norm() ) / std::max( Math::Sqrt( reference.Norm() ), Real( 1.0f ) );
+}
+//-----------------------------------------------------------------------------------
+static Real relativeError( const Matrix4 &value, const Matrix4 &reference )
+{
+    Real retVal = 0;
+    for( size_t i=0; i<3u; ++i )
+    {
+        for( size_t j=0; j<4u; ++j )
+            retVal = std::max( retVal, relativeError( value[i][j], reference[i][j] ) );
+    }
+    return retVal;
+}
+//-----------------------------------------------------------------------------------
+static void createArrayData( ArrayData &data, size_t numElements, Real tolerance )
+{
+    const size_t numPacks = ( numElements + ARRAY_PACKED_REALS - 1u ) / ARRAY_PACKED_REALS;
+
+    data.numPacks   = numPacks;
+    data.tolerance  = tolerance;
+    data.vecA       = OGRE_ALLOC_T_SIMD( ArrayVector3, numPacks, MEMCATEGORY_GENERAL );
+    data.vecB       = OGRE_ALLOC_T_SIMD( ArrayVector3, numPacks, MEMCATEGORY_GENERAL );
+    data.vecOut     = OGRE_ALLOC_T_SIMD( ArrayVector3, numPacks, MEMCATEGORY_GENERAL );
+    data.realA      = OGRE_ALLOC_T_SIMD( ArrayReal, numPacks, MEMCATEGORY_GENERAL );
+    data.realB      = OGRE_ALLOC_T_SIMD( ArrayReal, numPacks, MEMCATEGORY_GENERAL );
+    data.realOut    = OGRE_ALLOC_T_SIMD( ArrayReal, numPacks, MEMCATEGORY_GENERAL );
+    data.quatA      = OGRE_ALLOC_T_SIMD( ArrayQuaternion, numPacks, MEMCATEGORY_GENERAL );
+    data.quatB      = OGRE_ALLOC_T_SIMD( ArrayQuaternion, numPacks, MEMCATEGORY_GENERAL );
+    data.quatOut    = OGRE_ALLOC_T_SIMD( ArrayQuaternion, numPacks, MEMCATEGORY_GENERAL );
+    data.matA       = OGRE_ALLOC_T_SIMD( ArrayMatrixAf4x3, numPacks, MEMCATEGORY_GENERAL );
+    data.matB       = OGRE_ALLOC_T_SIMD( ArrayMatrixAf4x3, numPacks, MEMCATEGORY_GENERAL );
+    data.matOut     = OGRE_ALLOC_T_SIMD( ArrayMatrixAf4x3, numPacks, MEMCATEGORY_GENERAL );
+    data.aabbA      = OGRE_ALLOC_T_SIMD( ArrayAabb, numPacks, MEMCATEGORY_GENERAL );
+    data.aabbB      = OGRE_ALLOC_T_SIMD( ArrayAabb, numPacks, MEMCATEGORY_GENERAL );
+    data.maskOut    = OGRE_ALLOC_T_SIMD( uint32, numPacks, MEMCATEGORY_GENERAL );
+    data.tmpMatrices= OGRE_ALLOC_T_SIMD( Matrix4, ARRAY_PACKED_REALS, MEMCATEGORY_GENERAL );
+
+    uint32 seed = 0x5eed5eedu;
+
+    for( size_t i=0; i<numPacks; ++i )
+    {
+        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+        {
+            data.vecA[i].setFromVector3( randomVector3( seed, -100.0f, 100.0f ), j );
+            data.vecB[i].setFromVector3( randomVector3( seed, -100.0f, 100.0f ), j );
+            data.quatA[i].setFromQuaternion( randomQuaternion( seed ), j );
+            data.quatB[i].setFromQuaternion( randomQuaternion( seed ), j );
+
+            reinterpret_cast<Real*>( &data.realA[i] )[j] = randomReal( seed, -100.0f, 100.0f );
+            reinterpret_cast<Real*>( &data.realB[i] )[j] = randomReal( seed, -100.0f, 100.0f );
+
+            //Boxes are placed so that roughly half of them intersect
+            data.aabbA[i].setFromAabb( Aabb( randomVector3( seed, -10.0f, 10.0f ),
+                                             randomVector3( seed, 0.5f, 5.0f ) ), j );
+            data.aabbB[i].setFromAabb( Aabb( randomVector3( seed, -10.0f, 10.0f ),
+                                             randomVector3( seed, 0.5f, 5.0f ) ), j );
+        }
+
+        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+        {
+            data.tmpMatrices[j].makeTransform( randomVector3( seed, -100.0f, 100.0f ),
+                                               randomVector3( seed, 0.5f, 2.0f ),
+                                               randomQuaternion( seed ) );
+        }
+        data.matA[i].loadFromAoS( data.tmpMatrices );
+
+        for( size_t j=0; j<ARRAY_PACKED_REALS; ++j )
+        {
+            data.tmpMatrices[j].makeTransform( randomVector3( seed, -100.0f, 100.0f ),
+                                               randomVector3( seed, 0.5f, 2.0f ),
+                                               randomQuaternion( seed ) );
+        }
+        data.matB[i].loadFromAoS( data.tmpMatrices );
+    }
+}
+//-----------------------------------------------------------------------------------
+static void destroyArrayData( ArrayData &data )
+{
+    OGRE_FREE_SIMD( data.vecA, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.vecB, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.vecOut, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.realA, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.realB, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.realOut, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.quatA, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.quatB, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.quatOut, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.matA, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.matB, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.matOut, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.aabbA, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.aabbB, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.maskOut, MEMCATEGORY_GENERAL );
+    OGRE_FREE_SIMD( data.tmpMatrices, MEMCATEGORY_GENERAL );
+    memset( &data, 0, sizeof( data ) );
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkVec3Add( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.vecOut[j] = data.vecA[j] + data.vecB[j];
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "vec3_add", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Vector3 reference = data.vecA[j].getAsVector3( k ) +
+                                      data.vecB[j].getAsVector3( k );
+            result.addError( relativeError( data.vecOut[j].getAsVector3( k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkVec3Dot( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.realOut[j] = data.vecA[j].dotProduct( data.vecB[j] );
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "vec3_dot", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Real reference = data.vecA[j].getAsVector3( k ).dotProduct(
+                                       data.vecB[j].getAsVector3( k ) );
+            result.addError( relativeError( getLane( data.realOut[j], k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkVec3Cross( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.vecOut[j] = data.vecA[j].crossProduct( data.vecB[j] );
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "vec3_cross", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Vector3 reference = data.vecA[j].getAsVector3( k ).crossProduct(
+                                          data.vecB[j].getAsVector3( k ) );
+            result.addError( relativeError( data.vecOut[j].getAsVector3( k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkVec3Normalise( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.vecOut[j] = data.vecA[j].normalisedCopy();
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "vec3_normalise", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Vector3 reference = data.vecA[j].getAsVector3( k ).normalisedCopy();
+            result.addError( relativeError( data.vecOut[j].getAsVector3( k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkQuatMul( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.quatOut[j] = data.quatA[j] * data.quatB[j];
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "quat_mul", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Quaternion reference = data.quatA[j].getAsQuaternion( k ) *
+                                         data.quatB[j].getAsQuaternion( k );
+            result.addError( relativeError( data.quatOut[j].getAsQuaternion( k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkQuatRotate( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.vecOut[j] = data.quatA[j] * data.vecA[j];
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "quat_rotate", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Vector3 reference = data.quatA[j].getAsQuaternion( k ) *
+                                      data.vecA[j].getAsVector3( k );
+            result.addError( relativeError( data.vecOut[j].getAsVector3( k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkMatConcat( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.matOut[j] = data.matA[j] * data.matB[j];
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "mat_concat", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    Matrix4 lhs[ARRAY_PACKED_REALS];
+    Matrix4 rhs[ARRAY_PACKED_REALS];
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        data.matA[j].streamToAoS( data.tmpMatrices );
+        std::copy( data.tmpMatrices, data.tmpMatrices + ARRAY_PACKED_REALS, lhs );
+        data.matB[j].streamToAoS( data.tmpMatrices );
+        std::copy( data.tmpMatrices, data.tmpMatrices + ARRAY_PACKED_REALS, rhs );
+        data.matOut[j].streamToAoS( data.tmpMatrices );
+
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Matrix4 reference = lhs[k].concatenateAffine( rhs[k] );
+            result.addError( relativeError( data.tmpMatrices[k], reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkMatTransform( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+            data.vecOut[j] = data.matA[j] * data.vecA[j];
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "mat_transform", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        data.matA[j].streamToAoS( data.tmpMatrices );
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Vector3 reference =
+                    data.tmpMatrices[k].transformAffine( data.vecA[j].getAsVector3( k ) );
+            result.addError( relativeError( data.vecOut[j].getAsVector3( k ), reference ) );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkAabbIntersects( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+        {
+            data.maskOut[j] = BooleanMask4::getScalarMask(
+                                  data.aabbA[j].intersects( data.aabbB[j] ) );
+        }
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "aabb_intersects", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const bool reference = data.aabbA[j].getAsAabb( k ).intersects(
+                                       data.aabbB[j].getAsAabb( k ) );
+            const bool value = IS_BIT_SET( k, data.maskOut[j] );
+            result.addError( value == reference ? 0.0f : 1.0f );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+static TestResult benchmarkCmov4( ArrayData &data, uint32 numIterations, Timer &timer )
+{
+    const uint64 startTime = timer.getMicroseconds();
+    for( uint32 i=0; i<numIterations; ++i )
+    {
+        for( size_t j=0; j<data.numPacks; ++j )
+        {
+            data.realOut[j] = Mathlib::Cmov4( data.realA[j], data.realB[j],
+                                              Mathlib::CompareGreater( data.realA[j],
+                                                                       data.realB[j] ) );
+        }
+        BENCHMARK_CLOBBER_MEMORY();
+    }
+    const uint64 endTime = timer.getMicroseconds();
+
+    TestResult result( "cmov4", data.getNumElements(), numIterations,
+                       endTime - startTime, data.tolerance );
+    for( size_t j=0; j<data.numPacks; ++j )
+    {
+        for( size_t k=0; k<ARRAY_PACKED_REALS; ++k )
+        {
+            const Real a = getLane( data.realA[j], k );
+            const Real b = getLane( data.realB[j], k );
+            const Real reference = a > b ? a : b;
+            result.addError( getLane( data.realOut[j], k ) == reference ? 0.0f : 1.0f );
+        }
+    }
+    return result;
+}
+//-----------------------------------------------------------------------------------
+struct ArrayTest
+{
+    const char      *name;
+    ArrayTestFunc   func;
+};
+
+static const ArrayTest c_arrayTests[] =
+{
+    { "vec3_add",           benchmarkVec3Add },
+    { "vec3_dot",           benchmarkVec3Dot },
+    { "vec3_cross",         benchmarkVec3Cross },
+    { "vec3_normalise",     benchmarkVec3Normalise },
+    { "quat_mul",           benchmarkQuatMul },
+    { "quat_rotate",        benchmarkQuatRotate },
+    { "mat_concat",         benchmarkMatConcat },
+    { "mat_transform",      benchmarkMatTransform },
+    { "aabb_intersects",    benchmarkAabbIntersects },
+    { "cmov4",              benchmarkCmov4 }
+};
+
+static const size_t c_numArrayTests = sizeof( c_arrayTests ) / sizeof( c_arrayTests[0] );
+
+//-----------------------------------------------------------------------------------
+static bool isTestEnabled( const BenchmarkSettings &settings, const String &name )
+{
+    return settings.tests.empty() ||
+           std::find( settings.tests.begin(), settings.tests.end(), name ) != settings.tests.end();
+}
+//-----------------------------------------------------------------------------------
+static const String c_benchmarkObjectType = "ArrayMathBenchmarkObject";
+
+/// Bare MovableObject, only needed to have something in the ObjectData to cull
+class BenchmarkObject : public MovableObject
+{
+public:
+    size_t mBenchmarkIdx;
+
+    BenchmarkObject( size_t benchmarkIdx, ObjectMemoryManager *objectMemoryManager,
+                     SceneManager *sceneManager ) :
+        MovableObject( Id::generateNewId<MovableObject>(), objectMemoryManager,
+                       sceneManager, 10u ),
+        mBenchmarkIdx( benchmarkIdx )
+    {
+    }
+
+    virtual const String& getMovableType(void) const { return c_benchmarkObjectType; }
+};
+//-----------------------------------------------------------------------------------
+static void updateAllTransforms( NodeMemoryManager &nodeMemoryManager )
+{
+    const size_t numDepths = nodeMemoryManager.getNumDepths();
+    for( size_t i=0; i<numDepths; ++i )
+    {
+        Transform t;
+        const size_t numNodes = nodeMemoryManager.getFirstNode( t, i );
+        if( numNodes )
+            Node::updateAllTransforms( numNodes, t );
+    }
+}
+//-----------------------------------------------------------------------------------
+static void updateAllBounds( ObjectMemoryManager &objectMemoryManager )
+{
+    const size_t numRenderQueues = objectMemoryManager.getNumRenderQueues();
+    for( size_t i=0; i<numRenderQueues; ++i )
+    {
+        ObjectData objData;
+        const size_t numObjs = objectMemoryManager.getFirstObjectData( objData, i );
+        if( numObjs )
+            MovableObject::updateAllBounds( numObjs, objData );
+    }
+}
+//-----------------------------------------------------------------------------------
+static void cullFrustum( ObjectMemoryManager &objectMemoryManager, const Camera *camera,
+                         uint32 visibilityMask,
+                         MovableObject::MovableObjectArray &outCulledObjects )
+{
+    const size_t numRenderQueues = objectMemoryManager.getNumRenderQueues();
+    for( size_t i=0; i<numRenderQueues; ++i )
+    {
+        ObjectData objData;
+        const size_t numObjs = objectMemoryManager.getFirstObjectData( objData, i );
+        if( numObjs )
+        {
+            MovableObject::cullFrustum( numObjs, objData, camera, visibilityMask,
+                                        outCulledObjects, camera );
+        }
+    }
+}
+//-----------------------------------------------------------------------------------
+/// Same test as MovableObject::cullFrustum, one box at a time
+static bool isVisibleScalar( const Aabb &aabb, const Plane *planes )
+{
+    bool retVal = true;
+    for( size_t i=0; i<6u; ++i )
+    {
+        const Vector3 signFlip( planes[i].normal.x < 0 ? -1.0f : 1.0f,
+                                planes[i].normal.y < 0 ? -1.0f : 1.0f,
+                                planes[i].normal.z < 0 ? -1.0f : 1.0f );
+        const Vector3 centerPlusFlippedHS = aabb.mCenter + aabb.mHalfSize * signFlip;
+        retVal &= planes[i].normal.dotProduct( centerPlusFlippedHS ) > -planes[i].d;
+    }
+    return retVal;
+}
+//-----------------------------------------------------------------------------------
+static void runSceneBenchmarks( Root *root, const BenchmarkSettings &settings,
+                                TestResultVec &outResults )
+{
+    SceneManager *sceneManager = root->createSceneManager( ST_GENERIC, 1u,
+                                                           "OgreArrayMathBenchmark" );
+    Camera *camera = sceneManager->createCamera( "Main Camera" );
+    camera->setPosition( Vector3( 0, 0, 120.0f ) );
+    camera->lookAt( Vector3::ZERO );
+    camera->setNearClipDistance( 0.5f );
+    camera->setFarClipDistance( 1000.0f );
+    camera->setAspectRatio( 16.0f / 9.0f );
+
+    //Scene extends beyond the camera's frustum, so that culling has work to do
+    const Real sceneExtent = 200.0f;
+    uint32 seed = 0x5eed5eedu;
+
+    ObjectMemoryManager &objectMemoryManager =
+            sceneManager->_getEntityMemoryManager( SCENE_DYNAMIC );
+    NodeMemoryManager &nodeMemoryManager = sceneManager->_getNodeMemoryManager( SCENE_DYNAMIC );
+
+    //Node hierarchy: chains of 'depth' nodes hanging from the root, one object each
+    vector<SceneNode*>::type sceneNodes;
+    vector<BenchmarkObject*>::type objects;
+    sceneNodes.reserve( settings.numNodes );
+    objects.reserve( settings.numNodes );
+    {
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+        SceneNode *parentNode = rootNode;
+        for( uint32 i=0; i<settings.numNodes; ++i )
+        {
+            if( i % settings.depth == 0u )
+                parentNode = rootNode;
+
+            const Real half = parentNode == rootNode ? sceneExtent * 0.5f : 2.0f;
+            SceneNode *sceneNode = parentNode->createChildSceneNode(
+                                       SCENE_DYNAMIC, randomVector3( seed, -half, half ),
+                                       randomQuaternion( seed ) );
+            sceneNode->setScale( randomVector3( seed, 0.9f, 1.1f ) );
+
+            BenchmarkObject *object = OGRE_NEW BenchmarkObject( i, &objectMemoryManager,
+                                                                sceneManager );
+            object->setLocalAabb( Aabb( Vector3::ZERO, randomVector3( seed, 0.5f, 2.0f ) ) );
+            sceneNode->attachObject( object );
+
+            sceneNodes.push_back( sceneNode );
+            objects.push_back( object );
+            parentNode = sceneNode;
+        }
+    }
+
+    //Warm up, and make sure the camera & every parent have valid derived transforms
+    updateAllTransforms( nodeMemoryManager );
+
+    Timer timer;
+
+    if( isTestEnabled( settings, "updateAllTransforms" ) )
+    {
+        const uint64 startTime = timer.getMicroseconds();
+        for( uint32 i=0; i<settings.numIterations; ++i )
+            updateAllTransforms( nodeMemoryManager );
+        const uint64 endTime = timer.getMicroseconds();
+
+        TestResult result( "updateAllTransforms", settings.numNodes, settings.numIterations,
+                           endTime - startTime, settings.tolerance );
+        vector<SceneNode*>::type::const_iterator itor = sceneNodes.begin();
+        vector<SceneNode*>::type::const_iterator end  = sceneNodes.end();
+        while( itor != end )
+        {
+            const SceneNode *sceneNode = *itor;
+            const Node *parent = sceneNode->getParent();
+
+            const Vector3 reference = parent->_getDerivedPosition() +
+                                      parent->_getDerivedOrientation() *
+                                      ( parent->_getDerivedScale() * sceneNode->getPosition() );
+            result.addError( relativeError( sceneNode->_getDerivedPosition(), reference ) );
+            ++itor;
+        }
+        outResults.push_back( result );
+    }
+
+    if( isTestEnabled( settings, "cullFrustum" ) )
+    {
+        updateAllBounds( objectMemoryManager );
+        camera->getFrustumPlanes();
+
+        const uint32 visibilityMask = sceneManager->getVisibilityMask();
+        MovableObject::MovableObjectArray culledObjects;
+        culledObjects.reserve( settings.numNodes );
+
+        const uint64 startTime = timer.getMicroseconds();
+        for( uint32 i=0; i<settings.numIterations; ++i )
+        {
+            culledObjects.clear();
+            cullFrustum( objectMemoryManager, camera, visibilityMask, culledObjects );
+        }
+        const uint64 endTime = timer.getMicroseconds();
+
+        TestResult result( "cullFrustum", settings.numNodes, settings.numIterations,
+                           endTime - startTime, settings.tolerance );
+
+        vector<uint8>::type isCulledVisible( objects.size(), 0u );
+        MovableObject::MovableObjectArray::const_iterator itCulled = culledObjects.begin();
+        MovableObject::MovableObjectArray::const_iterator enCulled = culledObjects.end();
+        while( itCulled != enCulled )
+        {
+            isCulledVisible[static_cast<BenchmarkObject*>( *itCulled )->mBenchmarkIdx] = 1u;
+            ++itCulled;
+        }
+
+        const Plane *frustumPlanes = camera->getFrustumPlanes();
+        for( size_t i=0; i<objects.size(); ++i )
+        {
+            const bool reference = isVisibleScalar( objects[i]->getWorldAabb(), frustumPlanes );
+            result.addError( (isCulledVisible[i] != 0u) == reference ? 0.0f : 1.0f );
+        }
+        outResults.push_back( result );
+    }
+
+    vector<BenchmarkObject*>::type::const_iterator itor = objects.begin();
+    vector<BenchmarkObject*>::type::const_iterator end  = objects.end();
+    while( itor != end )
+        OGRE_DELETE *itor++;
+
+    root->destroySceneManager( sceneManager );
+}
+//-----------------------------------------------------------------------------------
+int main( int argc, const char *argv[] )
+{
+    String csvPath;
+
+    BenchmarkSettings settings;
+    settings.numElements = 65536u;
+    settings.numIterations = 200u;
+    settings.numNodes = 100000u;
+    settings.depth = 4u;
+    settings.tolerance = 1e-4f;
+
+    for( int i=1; i<argc; ++i )
+    {
+        const String option = argv[i];
+        if( option == "-e" && i + 1 < argc )
+            settings.numElements = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-i" && i + 1 < argc )
+            settings.numIterations = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-n" && i + 1 < argc )
+            settings.numNodes = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-d" && i + 1 < argc )
+            settings.depth = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-t" && i + 1 < argc )
+            settings.tests = StringUtil::split( argv[++i], "," );
+        else if( option == "-x" && i + 1 < argc )
+            settings.tolerance = StringConverter::parseReal( argv[++i] );
+        else if( option == "-o" && i + 1 < argc )
+            csvPath = argv[++i];
+        else
+        {
+            printHelp();
+            return -1;
+        }
+    }
+
+    const char *backend = getBackendName();
+
+    int retCode = 0;
+    LogManager *logManager = 0;
+    Root *root = 0;
+
+    try
+    {
+        String csv = "backend,packedReals,test,elements,iterations,nsPerElement,"
+                     "maxError,mismatches\n";
+        printf( "%s", csv.c_str() );
+
+        TestResultVec results;
+
+        {
+            ArrayData data;
+            createArrayData( data, settings.numElements, settings.tolerance );
+
+            Timer timer;
+            for( size_t i=0; i<c_numArrayTests; ++i )
+            {
+                if( isTestEnabled( settings, c_arrayTests[i].name ) )
+                {
+                    results.push_back( c_arrayTests[i].func( data, settings.numIterations,
+                                                             timer ) );
+                    const String row = results.back().toCsv( backend );
+                    printf( "%s", row.c_str() );
+                    fflush( stdout );
+                    csv += row;
+                }
+            }
+
+            destroyArrayData( data );
+        }
+
+        if( isTestEnabled( settings, "updateAllTransforms" ) ||
+            isTestEnabled( settings, "cullFrustum" ) )
+        {
+            String pluginsPath;
+            // only use plugins.cfg if not static
+#ifndef OGRE_STATIC_LIB
+#if OGRE_DEBUG_MODE
+            pluginsPath = "plugins_tools_d.cfg";
+#else
+            pluginsPath = "plugins_tools.cfg";
+#endif
+#endif
+            logManager = OGRE_NEW LogManager();
+            logManager->createLog( "OgreArrayMathBenchmark.log", true, false );
+            root = OGRE_NEW Root( pluginsPath, "", "OgreArrayMathBenchmark.log" );
+
+#ifdef OGRE_STATIC_LIB
+            root->addRenderSystem( new NULLRenderSystem() );
+#endif
+            RenderSystem *renderSystem = root->getRenderSystemByName( "NULL Rendering Subsystem" );
+            if( !renderSystem )
+            {
+                OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                             "NULL RenderSystem not found. Check " + pluginsPath,
+                             "OgreArrayMathBenchmark" );
+            }
+
+            root->setRenderSystem( renderSystem );
+            root->initialise( false );
+
+            const size_t firstSceneResult = results.size();
+            runSceneBenchmarks( root, settings, results );
+            for( size_t i=firstSceneResult; i<results.size(); ++i )
+            {
+                const String row = results[i].toCsv( backend );
+                printf( "%s", row.c_str() );
+                csv += row;
+            }
+        }
+
+        TestResultVec::const_iterator itor = results.begin();
+        TestResultVec::const_iterator end  = results.end();
+        while( itor != end )
+        {
+            if( itor->numMismatches )
+            {
+                fprintf( stderr, "%s: %u elements don't match the scalar math "
+                         "(max error %g)\n", itor->name.c_str(),
+                         static_cast<uint32>( itor->numMismatches ), double( itor->maxError ) );
+                retCode = -1;
+            }
+            ++itor;
+        }
+
+        if( !csvPath.empty() )
+        {
+            FILE *outFile = fopen( csvPath.c_str(), "wb" );
+            if( !outFile )
+            {
+                OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                             "Could not open " + csvPath + " for writing",
+                             "OgreArrayMathBenchmark" );
+            }
+            fwrite( csv.c_str(), 1u, csv.size(), outFile );
+            fclose( outFile );
+        }
+    }
+    catch( Exception &e )
+    {
+        fprintf( stderr, "%s\n", e.getFullDescription().c_str() );
+        retCode = -1;
+    }
+
+    OGRE_DELETE root;
+    OGRE_DELETE logManager;
+
+    return retCode;
+}
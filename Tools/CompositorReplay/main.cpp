@@ -0,0 +1,202 @@
+
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreWindow.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreResourceGroupManager.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+
+#ifdef OGRE_STATIC_LIB
+#    include "OgreNULLRenderSystem.h"
+#endif
+
+#include <fstream>
+#include <algorithm>
+#include <limits>
+
+/*
+    Headless replay of a compositor workspace on the NULL RenderSystem.
+    No GPU work is done, thus the measured time is the CPU overhead of the
+    compositor itself (barrier placement, render pass setup, culling & render
+    queue of an empty scene, listeners, etc). Meant to be run by CI benchmarks
+    to catch compositor regressions.
+*/
+
+static void printHelp()
+{
+    printf(
+        "Replays a compositor workspace on the NULL RenderSystem\n"
+        "and reports the CPU time the compositor takes per frame.\n"
+        "\n"
+        "USAGE:\n"
+        "   OgreCompositorReplay /path/to/scripts WorkspaceName [options]\n"
+        "\n"
+        "    /path/to/scripts is searched recursively for the .compositor\n"
+        "    (and .material, .program) scripts.\n"
+        "\n"
+        "OPTIONS:\n"
+        "   -f <frames>    Number of frames to measure. Default: 1000\n"
+        "   -w <frames>    Warm up frames that aren't measured. Default: 16\n"
+        "   -r <w> <h>     Resolution of the final target. Default: 1920 1080\n"
+        "   -o <file>      Writes the frame graph of the last frame as JSON to file\n" );
+}
+
+int main( int argc, const char *argv[] )
+{
+    using namespace Ogre;
+
+    if( argc < 3 )
+    {
+        printHelp();
+        return -1;
+    }
+
+    const String scriptsPath = argv[1];
+    const String workspaceName = argv[2];
+    uint32 numFrames = 1000u;
+    uint32 numWarmUpFrames = 16u;
+    uint32 width = 1920u;
+    uint32 height = 1080u;
+    String jsonPath;
+
+    for( int i=3; i<argc; ++i )
+    {
+        const String option = argv[i];
+        if( option == "-f" && i + 1 < argc )
+            numFrames = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-w" && i + 1 < argc )
+            numWarmUpFrames = static_cast<uint32>( atoi( argv[++i] ) );
+        else if( option == "-r" && i + 2 < argc )
+        {
+            width = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+            height = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        }
+        else if( option == "-o" && i + 1 < argc )
+            jsonPath = argv[++i];
+        else
+        {
+            printHelp();
+            return -1;
+        }
+    }
+
+    //Most Ogre scripts assume floating point to use radix point, not comma.
+    setlocale( LC_NUMERIC, "C" );
+
+    int retCode = 0;
+    LogManager *logManager = 0;
+    Root *root = 0;
+
+    try
+    {
+        String pluginsPath;
+        // only use plugins.cfg if not static
+#ifndef OGRE_STATIC_LIB
+#if OGRE_DEBUG_MODE
+        pluginsPath = "plugins_tools_d.cfg";
+#else
+        pluginsPath = "plugins_tools.cfg";
+#endif
+#endif
+        logManager = OGRE_NEW LogManager();
+        logManager->createLog( "OgreCompositorReplay.log", true, false );
+        root = OGRE_NEW Root( pluginsPath, "", "OgreCompositorReplay.log" );
+
+#ifdef OGRE_STATIC_LIB
+        root->addRenderSystem( new NULLRenderSystem() );
+#endif
+        RenderSystem *renderSystem = root->getRenderSystemByName( "NULL Rendering Subsystem" );
+        if( !renderSystem )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "NULL RenderSystem not found. Check " + pluginsPath,
+                         "OgreCompositorReplay" );
+        }
+
+        root->setRenderSystem( renderSystem );
+        root->initialise( false );
+
+        Window *window = root->createRenderWindow( "OgreCompositorReplay", width, height, false );
+
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+        resourceGroupManager.addResourceLocation( scriptsPath, "FileSystem", "General", true );
+        resourceGroupManager.initialiseAllResourceGroups( true );
+
+        SceneManager *sceneManager = root->createSceneManager( ST_GENERIC, 1u,
+                                                               "OgreCompositorReplay" );
+        Camera *camera = sceneManager->createCamera( "Main Camera" );
+        camera->setAspectRatio( Real( width ) / Real( height ) );
+
+        CompositorManager2 *compositorManager = root->getCompositorManager2();
+        if( !compositorManager->hasWorkspaceDefinition( workspaceName ) )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "Workspace definition '" + workspaceName + "' not found in " +
+                         scriptsPath, "OgreCompositorReplay" );
+        }
+
+        CompositorWorkspace *workspace =
+                compositorManager->addWorkspace( sceneManager, window->getTexture(), camera,
+                                                 workspaceName, true );
+        workspace->setCpuTiming( true );
+
+        for( uint32 i=0; i<numWarmUpFrames; ++i )
+            root->renderOneFrame();
+
+        uint64 minTime = std::numeric_limits<uint64>::max();
+        uint64 maxTime = 0;
+        uint64 totalTime = 0;
+        vector<uint64>::type frameTimes;
+        frameTimes.reserve( numFrames );
+
+        for( uint32 i=0; i<numFrames; ++i )
+        {
+            root->renderOneFrame();
+            const uint64 frameTime = workspace->getLastUpdateCpuTime();
+            minTime = std::min( minTime, frameTime );
+            maxTime = std::max( maxTime, frameTime );
+            totalTime += frameTime;
+            frameTimes.push_back( frameTime );
+        }
+
+        std::sort( frameTimes.begin(), frameTimes.end() );
+        const uint64 medianTime = frameTimes[frameTimes.size() / 2u];
+
+        printf( "Workspace: %s\n", workspaceName.c_str() );
+        printf( "Frames: %u (%u warm up)\n", numFrames, numWarmUpFrames );
+        printf( "CPU time per frame (us): avg %.2f median %lu min %lu max %lu\n",
+                double( totalTime ) / double( numFrames ),
+                static_cast<unsigned long>( medianTime ), static_cast<unsigned long>( minTime ),
+                static_cast<unsigned long>( maxTime ) );
+
+        if( !jsonPath.empty() )
+        {
+            String json;
+            workspace->dumpFrameGraph( json );
+
+            std::ofstream outFile( jsonPath.c_str(), std::ios::binary | std::ios::out );
+            if( !outFile.is_open() )
+            {
+                OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                             "Could not open " + jsonPath + " for writing",
+                             "OgreCompositorReplay" );
+            }
+            outFile.write( json.c_str(), static_cast<std::streamsize>( json.size() ) );
+            printf( "Frame graph written to %s\n", jsonPath.c_str() );
+        }
+
+        compositorManager->removeWorkspace( workspace );
+    }
+    catch( Exception &e )
+    {
+        fprintf( stderr, "%s\n", e.getFullDescription().c_str() );
+        retCode = -1;
+    }
+
+    OGRE_DELETE root;
+    OGRE_DELETE logManager;
+
+    return retCode;
+}
@@ -0,0 +1,485 @@
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreWindow.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreTimer.h"
+#include "OgreString.h"
+#include "OgreStringConverter.h"
+#include "OgreArchiveManager.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsPbs.h"
+#include "OgreHlmsUnlit.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "Compositor/OgreCompositorShadowNode.h"
+#include "Vao/OgreVaoManager.h"
+
+#ifdef OGRE_STATIC_LIB
+#    include "OgreNULLRenderSystem.h"
+#endif
+
+/*
+    Measures the cost of generating Hlms shader permutations.
+    Every datablock found in the given HlmsJson materials is applied to a mesh of each of
+    the given vertex formats, then rendered under each pass configuration, which forces
+    the Hlms to go through createShaderCacheEntry for every permutation.
+
+    The time is split between the template parser stages and the API compilation
+    (on the NULL RenderSystem the latter only measures the program creation overhead;
+    use -r to benchmark a real API). Results are printed as CSV, one row per pass
+    configuration.
+*/
+
+using namespace Ogre;
+
+static void printHelp()
+{
+    printf(
+        "Benchmarks Hlms template expansion & shader compilation\n"
+        "and prints the results as CSV.\n"
+        "\n"
+        "USAGE:\n"
+        "   OgreHlmsBenchmark /path/to/Samples/Media /path/to/materials [options]\n"
+        "\n"
+        "    /path/to/Samples/Media is where the Hlms/ templates are.\n"
+        "    /path/to/materials is searched recursively for .material.json files.\n"
+        "\n"
+        "OPTIONS:\n"
+        "   -v <a,b,c...>   Vertex formats. Each letter adds an element:\n"
+        "                   p position, n normal, t tangent, q QTangent, u uv, c colour.\n"
+        "                   Default: pn,pnu,pntu,pntuu\n"
+        "   -p <a,b,c...>   Pass configurations. One or more of:\n"
+        "                   unlit   No lights\n"
+        "                   lit     1 directional & 4 point lights\n"
+        "                   shadows 1 directional light with PSSM shadows\n"
+        "                   Default: unlit,lit,shadows\n"
+        "   -r <name>       RenderSystem to use. Default: NULL Rendering Subsystem\n"
+        "   -c <file>       plugins.cfg to load the RenderSystem from\n"
+        "   -o <file>       Also writes the CSV to file\n" );
+}
+
+//-----------------------------------------------------------------------------------
+/// Returns an empty vector if the format is invalid
+static VertexElement2Vec parseVertexFormat( const String &format )
+{
+    VertexElement2Vec vertexElements;
+    bool hasPosition = false;
+    for( size_t i=0; i<format.size(); ++i )
+    {
+        switch( format[i] )
+        {
+        case 'p':
+            vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+            hasPosition = true;
+            break;
+        case 'n':
+            vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+            break;
+        case 't':
+            vertexElements.push_back( VertexElement2( VET_FLOAT4, VES_TANGENT ) );
+            break;
+        case 'q':
+            vertexElements.push_back( VertexElement2( VET_SHORT4_SNORM, VES_NORMAL ) );
+            break;
+        case 'u':
+            vertexElements.push_back( VertexElement2( VET_FLOAT2, VES_TEXTURE_COORDINATES ) );
+            break;
+        case 'c':
+            vertexElements.push_back( VertexElement2( VET_COLOUR, VES_DIFFUSE ) );
+            break;
+        default:
+            vertexElements.clear();
+            return vertexElements;
+        }
+    }
+
+    if( !hasPosition )
+        vertexElements.clear();
+
+    return vertexElements;
+}
+//-----------------------------------------------------------------------------------
+/// A single triangle is enough; only the vertex format matters to the Hlms
+static MeshPtr createMesh( VaoManager *vaoManager, const String &format,
+                           const VertexElement2Vec &vertexElements )
+{
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+                       "HlmsBenchmark " + format, ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    SubMesh *subMesh = mesh->createSubMesh();
+
+    const uint32 vertexSize = VaoManager::calculateVertexSize( vertexElements );
+    vector<uint8>::type vertexData( vertexSize * 3u, 0u );
+    const uint16 c_indices[3] = { 0, 1, 2 };
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back( vaoManager->createVertexBuffer( vertexElements, 3u, BT_IMMUTABLE,
+                                                             &vertexData[0], false ) );
+    IndexBufferPacked *indexBuffer =
+            vaoManager->createIndexBuffer( IndexBufferPacked::IT_16BIT, 3u, BT_IMMUTABLE,
+                                           const_cast<uint16*>( c_indices ), false );
+    VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                  OT_TRIANGLE_LIST );
+    subMesh->mVao[VpNormal].push_back( vao );
+    subMesh->mVao[VpShadow].push_back( vao );
+
+    mesh->_setBounds( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ), false );
+    mesh->_setBoundingSphereRadius( 1.732f );
+
+    return mesh;
+}
+//-----------------------------------------------------------------------------------
+static Hlms* registerHlms( const String &mediaPath, HlmsTypes type )
+{
+    String dataFolderPath;
+    StringVector libraryFoldersPaths;
+    if( type == HLMS_PBS )
+        HlmsPbs::getDefaultPaths( dataFolderPath, libraryFoldersPaths );
+    else
+        HlmsUnlit::getDefaultPaths( dataFolderPath, libraryFoldersPaths );
+
+    ArchiveManager &archiveManager = ArchiveManager::getSingleton();
+    Archive *dataFolder = archiveManager.load( mediaPath + "/" + dataFolderPath,
+                                               "FileSystem", true );
+    ArchiveVec libraryFolders;
+    StringVector::const_iterator itor = libraryFoldersPaths.begin();
+    StringVector::const_iterator end  = libraryFoldersPaths.end();
+    while( itor != end )
+    {
+        libraryFolders.push_back( archiveManager.load( mediaPath + "/" + *itor,
+                                                       "FileSystem", true ) );
+        ++itor;
+    }
+
+    Hlms *hlms = 0;
+    if( type == HLMS_PBS )
+        hlms = OGRE_NEW HlmsPbs( dataFolder, &libraryFolders );
+    else
+        hlms = OGRE_NEW HlmsUnlit( dataFolder, &libraryFolders );
+    Root::getSingleton().getHlmsManager()->registerHlms( hlms );
+    return hlms;
+}
+//-----------------------------------------------------------------------------------
+static void createWorkspaceDefs( Root *root )
+{
+    CompositorManager2 *compositorManager = root->getCompositorManager2();
+
+    ShadowNodeHelper::ShadowParamVec shadowParams;
+    ShadowNodeHelper::ShadowParam shadowParam;
+    shadowParam.supportedLightTypes = 0;
+    shadowParam.technique = SHADOWMAP_PSSM;
+    shadowParam.numPssmSplits = 3u;
+    shadowParam.atlasId = 0;
+    shadowParam.atlasStart[0] = ShadowNodeHelper::Resolution( 0, 0 );
+    shadowParam.atlasStart[1] = ShadowNodeHelper::Resolution( 0, 2048u );
+    shadowParam.atlasStart[2] = ShadowNodeHelper::Resolution( 1024u, 2048u );
+    shadowParam.resolution[0] = ShadowNodeHelper::Resolution( 2048u, 2048u );
+    shadowParam.resolution[1] = ShadowNodeHelper::Resolution( 1024u, 1024u );
+    shadowParam.resolution[2] = ShadowNodeHelper::Resolution( 1024u, 1024u );
+    shadowParam.addLightType( Light::LT_DIRECTIONAL );
+    shadowParams.push_back( shadowParam );
+
+    ShadowNodeHelper::createShadowNodeWithSettings(
+                compositorManager, root->getRenderSystem()->getCapabilities(),
+                "HlmsBenchmark ShadowNode", shadowParams, false );
+
+    compositorManager->createBasicWorkspaceDef( "HlmsBenchmark Workspace", ColourValue::Black );
+    compositorManager->createBasicWorkspaceDef( "HlmsBenchmark ShadowWorkspace",
+                                                ColourValue::Black, "HlmsBenchmark ShadowNode" );
+}
+//-----------------------------------------------------------------------------------
+static String runPassConfig( Root *root, Window *window, const String &passConfig,
+                             const vector<MeshPtr>::type &meshes,
+                             const vector<HlmsDatablock*>::type &datablocks,
+                             Hlms * const *hlmsArray, size_t numHlms )
+{
+    SceneManager *sceneManager = root->createSceneManager( ST_GENERIC, 1u, "OgreHlmsBenchmark" );
+    Camera *camera = sceneManager->createCamera( "Main Camera" );
+    camera->setPosition( Vector3( 0, 0, 10.0f ) );
+    camera->lookAt( Vector3::ZERO );
+    camera->setNearClipDistance( 0.5f );
+    camera->setAspectRatio( Real( window->getWidth() ) / Real( window->getHeight() ) );
+    sceneManager->setShadowDirectionalLightExtrusionDistance( 100.0f );
+
+    SceneNode *rootNode = sceneManager->getRootSceneNode();
+
+    if( passConfig == "lit" || passConfig == "shadows" )
+    {
+        Light *light = sceneManager->createLight();
+        light->setType( Light::LT_DIRECTIONAL );
+        light->setDirection( Vector3( -1, -1, -1 ).normalisedCopy() );
+        light->setCastShadows( passConfig == "shadows" );
+        rootNode->createChildSceneNode()->attachObject( light );
+
+        if( passConfig == "lit" )
+        {
+            for( int i=0; i<4; ++i )
+            {
+                light = sceneManager->createLight();
+                light->setType( Light::LT_POINT );
+                light->setCastShadows( false );
+                light->setAttenuationBasedOnRadius( 10.0f, 0.01f );
+                rootNode->createChildSceneNode(
+                            SCENE_DYNAMIC, Vector3( Real( i ) - 1.5f, 1.0f, 1.0f ) )->
+                        attachObject( light );
+            }
+        }
+    }
+
+    for( size_t i=0; i<numHlms; ++i )
+        hlmsArray[i]->setShaderGenerationTiming( true );
+
+    size_t numPsosBefore = 0;
+    for( size_t i=0; i<numHlms; ++i )
+        numPsosBefore += hlmsArray[i]->getPsoStatistics().numPsosCreated;
+
+    //Every (datablock, vertex format) pair becomes one Item
+    vector<MeshPtr>::type::const_iterator itMesh = meshes.begin();
+    vector<MeshPtr>::type::const_iterator enMesh = meshes.end();
+    while( itMesh != enMesh )
+    {
+        vector<HlmsDatablock*>::type::const_iterator itor = datablocks.begin();
+        vector<HlmsDatablock*>::type::const_iterator end  = datablocks.end();
+        while( itor != end )
+        {
+            Item *item = sceneManager->createItem( *itMesh, SCENE_DYNAMIC );
+            item->setDatablock( *itor );
+            rootNode->createChildSceneNode()->attachObject( item );
+            ++itor;
+        }
+        ++itMesh;
+    }
+
+    CompositorManager2 *compositorManager = root->getCompositorManager2();
+    CompositorWorkspace *workspace = compositorManager->addWorkspace(
+                                         sceneManager, window->getTexture(), camera,
+                                         passConfig == "shadows" ?
+                                             "HlmsBenchmark ShadowWorkspace" :
+                                             "HlmsBenchmark Workspace", true );
+
+    Timer *timer = root->getTimer();
+    const uint64 startTime = timer->getMicroseconds();
+    root->renderOneFrame();
+    const uint64 frameTime = timer->getMicroseconds() - startTime;
+
+    Hlms::ShaderGenerationTimings total;
+    memset( &total, 0, sizeof( total ) );
+    size_t numPsos = 0;
+    for( size_t i=0; i<numHlms; ++i )
+    {
+        const Hlms::ShaderGenerationTimings &timings = hlmsArray[i]->getShaderGenerationTimings();
+        total.parseMath         += timings.parseMath;
+        total.parseForEach      += timings.parseForEach;
+        total.parseProperties   += timings.parseProperties;
+        total.parseUndefPieces  += timings.parseUndefPieces;
+        total.collectPieces     += timings.collectPieces;
+        total.insertPieces      += timings.insertPieces;
+        total.parseCounter      += timings.parseCounter;
+        total.compile           += timings.compile;
+        total.numShaders        += timings.numShaders;
+        numPsos += hlmsArray[i]->getPsoStatistics().numPsosCreated;
+        hlmsArray[i]->setShaderGenerationTiming( false );
+    }
+    numPsos -= numPsosBefore;
+
+    compositorManager->removeWorkspace( workspace );
+    root->destroySceneManager( sceneManager );
+
+    //Pass configurations must not benefit from each other's shaders
+    for( size_t i=0; i<numHlms; ++i )
+        hlmsArray[i]->_clearShaderCache();
+
+    char tmpBuffer[512];
+    snprintf( tmpBuffer, sizeof( tmpBuffer ),
+              "%s,%lu,%lu,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+              passConfig.c_str(), static_cast<unsigned long>( datablocks.size() ),
+              static_cast<unsigned long>( meshes.size() ), total.numShaders,
+              static_cast<unsigned long>( numPsos ),
+              static_cast<unsigned long>( total.parseMath ),
+              static_cast<unsigned long>( total.parseForEach ),
+              static_cast<unsigned long>( total.parseProperties ),
+              static_cast<unsigned long>( total.parseUndefPieces ),
+              static_cast<unsigned long>( total.collectPieces ),
+              static_cast<unsigned long>( total.insertPieces ),
+              static_cast<unsigned long>( total.parseCounter ),
+              static_cast<unsigned long>( total.compile ),
+              static_cast<unsigned long>( frameTime ) );
+    return tmpBuffer;
+}
+//-----------------------------------------------------------------------------------
+int main( int argc, const char *argv[] )
+{
+    if( argc < 3 )
+    {
+        printHelp();
+        return -1;
+    }
+
+    const String mediaPath = argv[1];
+    const String materialsPath = argv[2];
+    StringVector vertexFormats;
+    StringVector passConfigs;
+    String renderSystemName = "NULL Rendering Subsystem";
+    String pluginsPath;
+    String csvPath;
+
+    // only use plugins.cfg if not static
+#ifndef OGRE_STATIC_LIB
+#if OGRE_DEBUG_MODE
+    pluginsPath = "plugins_tools_d.cfg";
+#else
+    pluginsPath = "plugins_tools.cfg";
+#endif
+#endif
+
+    for( int i=3; i<argc; ++i )
+    {
+        const String option = argv[i];
+        if( option == "-v" && i + 1 < argc )
+            vertexFormats = StringUtil::split( argv[++i], "," );
+        else if( option == "-p" && i + 1 < argc )
+            passConfigs = StringUtil::split( argv[++i], "," );
+        else if( option == "-r" && i + 1 < argc )
+            renderSystemName = argv[++i];
+        else if( option == "-c" && i + 1 < argc )
+            pluginsPath = argv[++i];
+        else if( option == "-o" && i + 1 < argc )
+            csvPath = argv[++i];
+        else
+        {
+            printHelp();
+            return -1;
+        }
+    }
+
+    if( vertexFormats.empty() )
+        vertexFormats = StringUtil::split( "pn,pnu,pntu,pntuu", "," );
+    if( passConfigs.empty() )
+        passConfigs = StringUtil::split( "unlit,lit,shadows", "," );
+
+    for( size_t i=0; i<passConfigs.size(); ++i )
+    {
+        if( passConfigs[i] != "unlit" && passConfigs[i] != "lit" && passConfigs[i] != "shadows" )
+        {
+            fprintf( stderr, "Unknown pass configuration '%s'\n", passConfigs[i].c_str() );
+            return -1;
+        }
+    }
+
+    //Most Ogre scripts assume floating point to use radix point, not comma.
+    setlocale( LC_NUMERIC, "C" );
+
+    int retCode = 0;
+    LogManager *logManager = 0;
+    Root *root = 0;
+
+    try
+    {
+        logManager = OGRE_NEW LogManager();
+        logManager->createLog( "OgreHlmsBenchmark.log", true, false );
+        root = OGRE_NEW Root( pluginsPath, "", "OgreHlmsBenchmark.log" );
+
+#ifdef OGRE_STATIC_LIB
+        root->addRenderSystem( new NULLRenderSystem() );
+#endif
+        RenderSystem *renderSystem = root->getRenderSystemByName( renderSystemName );
+        if( !renderSystem )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         renderSystemName + " not found. Check " + pluginsPath,
+                         "OgreHlmsBenchmark" );
+        }
+
+        root->setRenderSystem( renderSystem );
+        root->initialise( false );
+
+        Window *window = root->createRenderWindow( "OgreHlmsBenchmark", 1280u, 720u, false );
+
+        Hlms *hlmsArray[2];
+        hlmsArray[0] = registerHlms( mediaPath, HLMS_PBS );
+        hlmsArray[1] = registerHlms( mediaPath, HLMS_UNLIT );
+
+        ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+        resourceGroupManager.addResourceLocation( materialsPath, "FileSystem", "General", true );
+        resourceGroupManager.initialiseAllResourceGroups( true );
+
+        createWorkspaceDefs( root );
+
+        //Only the datablocks defined in the materials; not the defaults
+        vector<HlmsDatablock*>::type datablocks;
+        for( size_t i=0; i<2u; ++i )
+        {
+            const Hlms::HlmsDatablockMap &datablockMap = hlmsArray[i]->getDatablockMap();
+            Hlms::HlmsDatablockMap::const_iterator itor = datablockMap.begin();
+            Hlms::HlmsDatablockMap::const_iterator end  = datablockMap.end();
+            while( itor != end )
+            {
+                if( !itor->second.srcFile.empty() )
+                    datablocks.push_back( itor->second.datablock );
+                ++itor;
+            }
+        }
+
+        if( datablocks.empty() )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "No HlmsJson materials found in " + materialsPath,
+                         "OgreHlmsBenchmark" );
+        }
+
+        vector<MeshPtr>::type meshes;
+        for( size_t i=0; i<vertexFormats.size(); ++i )
+        {
+            const VertexElement2Vec vertexElements = parseVertexFormat( vertexFormats[i] );
+            if( vertexElements.empty() )
+            {
+                OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS,
+                             "Invalid vertex format '" + vertexFormats[i] + "'",
+                             "OgreHlmsBenchmark" );
+            }
+            meshes.push_back( createMesh( renderSystem->getVaoManager(), vertexFormats[i],
+                                          vertexElements ) );
+        }
+
+        String csv = "pass,datablocks,vertexFormats,shaders,psos,parseMath,parseForEach,"
+                     "parseProperties,parseUndefPieces,collectPieces,insertPieces,parseCounter,"
+                     "compile,frame\n";
+        printf( "%s", csv.c_str() );
+
+        for( size_t i=0; i<passConfigs.size(); ++i )
+        {
+            const String row = runPassConfig( root, window, passConfigs[i], meshes, datablocks,
+                                              hlmsArray, 2u );
+            printf( "%s", row.c_str() );
+            fflush( stdout );
+            csv += row;
+        }
+
+        if( !csvPath.empty() )
+        {
+            FILE *outFile = fopen( csvPath.c_str(), "wb" );
+            if( !outFile )
+            {
+                OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                             "Could not open " + csvPath + " for writing",
+                             "OgreHlmsBenchmark" );
+            }
+            fwrite( csv.c_str(), 1u, csv.size(), outFile );
+            fclose( outFile );
+        }
+    }
+    catch( Exception &e )
+    {
+        fprintf( stderr, "%s\n", e.getFullDescription().c_str() );
+        retCode = -1;
+    }
+
+    OGRE_DELETE root;
+    OGRE_DELETE logManager;
+
+    return retCode;
+}
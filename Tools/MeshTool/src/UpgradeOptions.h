@@ -41,8 +41,15 @@ struct UpgradeOptions
     bool halfPos;
     bool halfTexCoords;
     bool qTangents;
+    bool unormTexCoords;
     bool optimizeForShadowMapping;
     bool stripShadowMapping;
+
+    bool optimiseOrder;
+    bool buildMeshlets;
+    Ogre::uint32 meshletMaxVertices;
+    Ogre::uint32 meshletMaxTriangles;
+    bool subMeshBounds;
 };
 
 extern UpgradeOptions opts;
@@ -40,6 +40,9 @@ THE SOFTWARE.
 #include "OgreMeshManager2.h"
 #include "OgreMesh2.h"
 
+#include "Threading/OgreThreads.h"
+#include "Threading/OgreLightweightMutex.h"
+
 #include "UpgradeOptions.h"
 
 #ifdef OGRE_STATIC_LIB
@@ -51,6 +54,7 @@ THE SOFTWARE.
 #include "XML/OgreXMLSkeletonSerializer.h"
 
 #include <iostream>
+#include <fstream>
 #include <sstream>
 #include <sys/stat.h>
 
@@ -71,6 +75,7 @@ void help(void)
     cout << "* Upgrades or downgrades .mesh file versions from either v2 and v1 mesh formats" << endl;
     cout << "Provided for OGRE by Steve Streeting 2004-2017" << endl << endl;
     cout << "Usage: OgreMeshTool [opts] sourcefile [destfile] " << endl;
+    cout << "       OgreMeshTool [opts] -batch folder|manifest.txt" << endl;
     cout << "-i             = Interactive mode, prompt for options. Implies -U" << endl;
     cout << "-autogen       = Generate autoconfigured LOD. No more LOD options needed!. Implies -U" << endl;
     cout << "-l lodlevels   = number of LOD levels" << endl;
@@ -102,12 +107,33 @@ void help(void)
     cout << "             p converts POSITION to 16-bit floats" << endl;
     cout << "             q converts normal tangent and bitangent (28-36 bytes) to QTangents (8 bytes)." << endl;
     cout << "             u converts UVs to 16-bit floats." << endl;
+    cout << "             n converts UVs in range [0; 1] to 16-bit unorm (more precise than u; v2 only)." << endl;
+    cout << "               UVs outside that range are left alone, or converted to half if u is present." << endl;
     cout << "             s make shadow mapping passes have their own optimized buffers. Overrides existing ones if any." << endl;
     cout << "             S strips the buffers for shadow mapping (consumes less space and memory)." << endl;
+    cout << "-opt       = Reorder triangles & vertices of all LODs for vertex cache, overdraw" << endl;
+    cout << "             and vertex fetch efficiency. Implies -v2" << endl;
+    cout << "-meshlets  = Split v2 submeshes into clusters (meshlets) with bounding" << endl;
+    cout << "             spheres and normal cones for cluster culling. Implies -v2" << endl;
+    cout << "-mv maxverts = Max vertices per meshlet (default 64). Implies -meshlets" << endl;
+    cout << "-mt maxtris  = Max triangles per meshlet (default 124). Implies -meshlets" << endl;
+    cout << "-submeshbounds = Store a local AABB per v2 submesh so Items can cull" << endl;
+    cout << "             SubItems individually. Implies -v2" << endl;
     cout << "-U         = Performs the opposite of -O puq: Converts 16-bit half to to float and " << endl;
     cout << "             converts QTangents to Normal + Tangent + Reflection. Needed by many" << endl;
     cout << "             other options that have to read from position, normals or UVs." << endl;
     cout << "             '-o puq' can be used to optimize the buffers again right before saving to disk." << endl;
+    cout << "-batch path  = Process every .mesh under the folder 'path' (recursive), or every" << endl;
+    cout << "             file listed in the manifest 'path' (one per line, '#' comments)." << endl;
+    cout << "             Files are overwritten (.xml files are saved without the .xml)." << endl;
+    cout << "             Inputs whose contents & options didn't change since the last run" << endl;
+    cout << "             are skipped. Not compatible with -i" << endl;
+    cout << "-j threads   = Number of threads used to hash the batch inputs, and of OgreMeshTool" << endl;
+    cout << "             processes converting them at the same time (default: all cores)." << endl;
+    cout << "             -j 1 converts everything inside this process" << endl;
+    cout << "-cache file  = Batch cache location (default: folder/OgreMeshTool.cache" << endl;
+    cout << "             or manifest.txt.cache)" << endl;
+    cout << "-force     = Ignore the batch cache and process every input" << endl;
     cout << "sourcefile = name of file to convert" << endl;
     cout << "destfile   = optional name of file to write to. If you don't" << endl;
     cout << "             specify this OGRE overwrites the existing file." << endl;
@@ -161,8 +187,14 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
     opts.halfPos        = false;
     opts.halfTexCoords  = false;
     opts.qTangents      = false;
+    opts.unormTexCoords = false;
     opts.optimizeForShadowMapping = false;
     opts.stripShadowMapping = false;
+    opts.optimiseOrder = false;
+    opts.buildMeshlets = false;
+    opts.subMeshBounds = false;
+    opts.meshletMaxVertices = 64u;
+    opts.meshletMaxTriangles = 124u;
 
 
     UnaryOptionList::iterator ui = unOpts.find("-e");
@@ -352,6 +384,8 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
             opts.halfTexCoords = true;
         if( bi->second.find( 'q' ) != String::npos )
             opts.qTangents = true;
+        if( bi->second.find( 'n' ) != String::npos )
+            opts.unormTexCoords = true;
         if( bi->second.find( 's' ) != String::npos )
             opts.optimizeForShadowMapping = true;
         if( bi->second.find( 'S' ) != String::npos )
@@ -361,6 +395,35 @@ void parseOpts(UnaryOptionList& unOpts, BinaryOptionList& binOpts)
         }
     }
 
+    ui = unOpts.find("-opt");
+    opts.optimiseOrder = ui->second;
+
+    ui = unOpts.find("-meshlets");
+    opts.buildMeshlets = ui->second;
+
+    bi = binOpts.find("-mv");
+    if( !bi->second.empty() )
+    {
+        opts.buildMeshlets = true;
+        opts.meshletMaxVertices = StringConverter::parseUnsignedInt( bi->second, 64u );
+    }
+
+    bi = binOpts.find("-mt");
+    if( !bi->second.empty() )
+    {
+        opts.buildMeshlets = true;
+        opts.meshletMaxTriangles = StringConverter::parseUnsignedInt( bi->second, 124u );
+    }
+
+    ui = unOpts.find("-submeshbounds");
+    opts.subMeshBounds = ui->second;
+
+    if( opts.buildMeshlets || opts.optimiseOrder || opts.subMeshBounds )
+    {
+        opts.exportAsV1 = false;
+        opts.exportAsV2 = true;
+    }
+
     if( opts.interactive || opts.numLods || opts.lodAutoconfigure || opts.generateTangents )
         opts.unoptimizeBuffer = true;
 }
@@ -1065,8 +1128,32 @@ void saveMesh( const String &destination, v1::MeshPtr &v1Mesh, MeshPtr &v2Mesh,
             }
 
             if( !v1Mesh.isNull() )
+            {
                 v2Mesh->importV1( v1Mesh.get(), false, false, false );
 
+                //v1 meshes can't hold unorm16 UVs, so it has to be done after importing.
+                if( opts.optimizeBuffer && opts.unormTexCoords )
+                    v2Mesh->arrangeEfficient( false, false, false, true );
+            }
+
+            if( opts.optimiseOrder )
+            {
+                cout << "Optimising triangle & vertex order..." << endl;
+                v2Mesh->optimise();
+            }
+
+            if( opts.buildMeshlets )
+            {
+                cout << "Building meshlets..." << endl;
+                v2Mesh->buildMeshlets( opts.meshletMaxVertices, opts.meshletMaxTriangles );
+            }
+
+            if( opts.subMeshBounds )
+            {
+                cout << "Computing submesh bounds..." << endl;
+                v2Mesh->computeSubMeshAabbs();
+            }
+
             cout << "Saving as a v2 mesh..." << endl;
             meshSerializer2.exportMesh( v2Mesh.get(), destination, opts.targetVersionV2, opts.endian );
         }
@@ -1149,6 +1236,604 @@ void restoreWorkingDir()
 #endif
 }
 
+/// Returns where the file gets saved when the user didn't specify a destination
+String getDefaultDestination( const String &source )
+{
+    const String::size_type extPos = source.find_last_of( '.' );
+    const String sourceExt( source.substr( extPos + 1, source.size() ) );
+
+    // dest is source minus .xml
+    if( sourceExt == "xml" )
+        return source.substr( 0, source.size() - 4 );
+
+    return source;
+}
+
+/// Loads source, applies all the requested operations and saves the result to dest.
+/// Throws on failure.
+void convertFile( const String &source, const String &dest,
+                  Ogre::MeshSerializer &meshSerializer2, v1::XMLMeshSerializer &xmlMeshSerializer,
+                  v1::XMLSkeletonSerializer &xmlSkeletonSerializer )
+{
+    // Load the mesh
+    v1::MeshPtr v1Mesh;
+    v1::SkeletonPtr v1Skeleton;
+    MeshPtr v2Mesh;
+
+    if( !loadMesh( source, v1Mesh, v2Mesh, v1Skeleton, meshSerializer2,
+                   xmlMeshSerializer, xmlSkeletonSerializer ) )
+    {
+        // The contents of the XML may also be invalid
+        OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Could not open '" + source + "'", "main" );
+    }
+
+    if( opts.unoptimizeBuffer )
+    {
+        if( !v1Mesh.isNull() )
+        {
+            if( v1Mesh->sharedVertexData[VpNormal] )
+            {
+                cout << "v1 Mesh has shared geometry. 'Unsharing' them..." << endl;
+                v1::MeshManager::unshareVertices( v1Mesh.get() );
+                cout << "Unshare operation successful" << endl;
+            }
+            v1Mesh->dearrangeToInefficient();
+        }
+
+        if( !v2Mesh.isNull() )
+            v2Mesh->dearrangeToInefficient();
+    }
+
+    v1::Mesh* mesh = v1Mesh.get();
+
+    {
+        const String::size_type extPos = dest.find_last_of( '.' );
+        const String dstExt( dest.substr( extPos + 1, dest.size() ) );
+        if( dstExt == "xml" )
+        {
+            if( opts.optimizeBuffer )
+            {
+                cout << "-O is ignored when exporting to XML" << endl;
+            }
+            opts.optimizeBuffer = false;
+        }
+    }
+
+    if( !v1Mesh.isNull() )
+    {
+        vertexBufferReorg(*mesh);
+
+        // Deal with VET_COLOUR ambiguities
+        resolveColourAmbiguities(mesh);
+    }
+
+    buildLod( v1Mesh );
+    buildEdgeLists( v1Mesh );
+    generateTangents( v1Mesh );
+
+    if( opts.optimizeBuffer )
+    {
+        if( !v1Mesh.isNull() )
+            mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
+        if( !v2Mesh.isNull() )
+            v2Mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents,
+                                      opts.unormTexCoords );
+    }
+
+    if (opts.recalcBounds)
+    {
+        recalcBounds( v1Mesh, v2Mesh );
+    }
+
+    if( opts.optimizeForShadowMapping )
+    {
+        if( !v1Mesh.isNull() )
+        {
+            mesh->_updateCompiledBoneAssignments();
+            v1::Mesh::msOptimizeForShadowMapping = !opts.stripShadowMapping;
+            mesh->prepareForShadowMapping( false );
+            v1::Mesh::msOptimizeForShadowMapping = false;
+        }
+
+        if( !v2Mesh.isNull() )
+        {
+            Mesh::msOptimizeForShadowMapping = !opts.stripShadowMapping;
+            v2Mesh->prepareForShadowMapping( false );
+            Mesh::msOptimizeForShadowMapping = false;
+        }
+    }
+
+    if( !opts.dontOptimiseAnimations && !v1Skeleton.isNull() )
+    {
+        v1Skeleton->optimiseAllAnimations();
+    }
+
+    saveMesh( dest, v1Mesh, v2Mesh, v1Skeleton, meshSerializer2,
+              xmlMeshSerializer, xmlSkeletonSerializer );
+}
+
+/// Frees everything convertFile created, so the next file of a batch
+/// can reuse the same resource names.
+void releaseConversionResources()
+{
+    v1::MeshManager::getSingleton().removeAll();
+    MeshManager::getSingleton().removeAll();
+    v1::OldSkeletonManager::getSingleton().removeAll();
+}
+
+struct BatchJob
+{
+    String  source;
+    /// Hash of the file contents, seeded with the hash of the options
+    uint32  hash;
+    bool    hashValid;
+
+    BatchJob( const String &_source ) : source( _source ), hash( 0 ), hashValid( false ) {}
+};
+
+struct BatchJobSourceCmp
+{
+    bool operator () ( const BatchJob &a, const BatchJob &b ) const
+    {
+        return a.source < b.source;
+    }
+};
+
+typedef Ogre::vector<BatchJob>::type BatchJobVec;
+typedef Ogre::map<String, uint32>::type BatchCacheMap;
+
+/** Hashes the contents of the file. Only uses the C runtime so it is safe to call
+    from multiple threads at the same time (Ogre's managers are not)
+@return
+    False if the file couldn't be read.
+*/
+bool hashFile( const String &filename, uint32 seed, uint32 &outHash )
+{
+    FILE *pFile = fopen( filename.c_str(), "rb" );
+    if( !pFile )
+        return false;
+
+    uint32 hash = seed;
+    char buffer[64 * 1024];
+    size_t bytesRead = fread( buffer, 1u, sizeof(buffer), pFile );
+    while( bytesRead > 0 )
+    {
+        hash = FastHash( buffer, static_cast<int>( bytesRead ), hash );
+        bytesRead = fread( buffer, 1u, sizeof(buffer), pFile );
+    }
+
+    const bool bSuccess = !ferror( pFile );
+    fclose( pFile );
+
+    outHash = hash;
+    return bSuccess;
+}
+
+struct BatchHashRequest
+{
+    BatchJobVec         *jobs;
+    uint32              optionsHash;
+    size_t              nextJob;
+    LightweightMutex    mutex;
+};
+
+unsigned long hashBatchJobsThread( ThreadHandle *threadHandle )
+{
+    BatchHashRequest *request =
+            reinterpret_cast<BatchHashRequest*>( threadHandle->getUserParam() );
+
+    bool bDone = false;
+    while( !bDone )
+    {
+        size_t jobIdx;
+        {
+            ScopedLock lock( request->mutex );
+            jobIdx = request->nextJob++;
+        }
+
+        if( jobIdx < request->jobs->size() )
+        {
+            BatchJob &job = (*request->jobs)[jobIdx];
+            job.hashValid = hashFile( job.source, request->optionsHash, job.hash );
+        }
+        else
+        {
+            bDone = true;
+        }
+    }
+
+    return 0;
+}
+THREAD_DECLARE( hashBatchJobsThread );
+
+/// Hashes all jobs spreading the file IO across numThreads threads
+void hashBatchJobs( BatchJobVec &jobs, uint32 optionsHash, size_t numThreads )
+{
+    BatchHashRequest request;
+    request.jobs        = &jobs;
+    request.optionsHash = optionsHash;
+    request.nextJob     = 0;
+
+    //WaitForThreads doesn't support more than 128 handles per call
+    numThreads = std::max<size_t>( std::min<size_t>( numThreads, jobs.size() ), 1u );
+    numThreads = std::min<size_t>( numThreads, 128u );
+
+    ThreadHandleVec threadHandles;
+    threadHandles.reserve( numThreads );
+    for( size_t i=0; i<numThreads; ++i )
+    {
+        threadHandles.push_back( Threads::CreateThread( THREAD_GET( hashBatchJobsThread ),
+                                                        i, &request ) );
+    }
+    Threads::WaitForThreads( threadHandles );
+}
+
+struct BatchWorkerRequest
+{
+    const StringVector  *commands;
+    size_t              nextCommand;
+    LightweightMutex    mutex;
+};
+
+unsigned long runBatchWorkersThread( ThreadHandle *threadHandle )
+{
+    BatchWorkerRequest *request =
+            reinterpret_cast<BatchWorkerRequest*>( threadHandle->getUserParam() );
+
+    bool bDone = false;
+    while( !bDone )
+    {
+        size_t commandIdx;
+        {
+            ScopedLock lock( request->mutex );
+            commandIdx = request->nextCommand++;
+        }
+
+        if( commandIdx < request->commands->size() )
+        {
+            //Failures are found out from the worker's cache, not its exit code
+            const int exitCode = system( (*request->commands)[commandIdx].c_str() );
+            (void)exitCode;
+        }
+        else
+        {
+            bDone = true;
+        }
+    }
+
+    return 0;
+}
+THREAD_DECLARE( runBatchWorkersThread );
+
+/// Runs all commands, up to numThreads at the same time
+void runBatchWorkers( const StringVector &commands, size_t numThreads )
+{
+    BatchWorkerRequest request;
+    request.commands    = &commands;
+    request.nextCommand = 0;
+
+    //WaitForThreads doesn't support more than 128 handles per call
+    numThreads = std::max<size_t>( std::min<size_t>( numThreads, commands.size() ), 1u );
+    numThreads = std::min<size_t>( numThreads, 128u );
+
+    ThreadHandleVec threadHandles;
+    threadHandles.reserve( numThreads );
+    for( size_t i=0; i<numThreads; ++i )
+    {
+        threadHandles.push_back( Threads::CreateThread( THREAD_GET( runBatchWorkersThread ),
+                                                        i, &request ) );
+    }
+    Threads::WaitForThreads( threadHandles );
+}
+
+/// Quotes a command line argument so that paths with spaces survive the shell
+String quoteArgument( const String &arg )
+{
+    return "\"" + arg + "\"";
+}
+
+bool isDirectory( const String &path )
+{
+    struct stat tagStat;
+    if( stat( path.c_str(), &tagStat ) != 0 )
+        return false;
+    return (tagStat.st_mode & S_IFMT) == S_IFDIR;
+}
+
+bool fileExists( const String &path )
+{
+    struct stat tagStat;
+    return stat( path.c_str(), &tagStat ) == 0;
+}
+
+/// Fills outJobs with every .mesh inside the folder (recursive),
+/// or with every file listed in the manifest
+void collectBatchJobs( const String &batchPath, BatchJobVec &outJobs )
+{
+    if( isDirectory( batchPath ) )
+    {
+        String folder = batchPath;
+        if( !folder.empty() && folder[folder.size() - 1u] != '/' &&
+            folder[folder.size() - 1u] != '\\' )
+        {
+            folder += "/";
+        }
+
+        ArchiveManager &archiveManager = ArchiveManager::getSingleton();
+        Archive *archive = archiveManager.load( batchPath, "FileSystem", true );
+        StringVectorPtr files = archive->find( "*.mesh", true, false );
+
+        StringVector::const_iterator itor = files->begin();
+        StringVector::const_iterator end  = files->end();
+        while( itor != end )
+        {
+            outJobs.push_back( BatchJob( folder + *itor ) );
+            ++itor;
+        }
+
+        archiveManager.unload( archive );
+    }
+    else
+    {
+        std::ifstream manifest( batchPath.c_str() );
+        if( !manifest.is_open() )
+        {
+            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND,
+                         "Batch folder or manifest '" + batchPath + "' not found.",
+                         "collectBatchJobs" );
+        }
+
+        String line;
+        while( std::getline( manifest, line ) )
+        {
+            StringUtil::trim( line );
+            if( !line.empty() && line[0] != '#' )
+                outJobs.push_back( BatchJob( line ) );
+        }
+    }
+
+    //Sort for a deterministic processing order & cache file
+    std::sort( outJobs.begin(), outJobs.end(), BatchJobSourceCmp() );
+}
+
+void loadBatchCache( const String &cacheFilename, BatchCacheMap &outCache )
+{
+    std::ifstream cacheFile( cacheFilename.c_str() );
+    if( !cacheFile.is_open() )
+        return;
+
+    //Format is one "hash path" pair per line, hash is 8 hex digits
+    String line;
+    while( std::getline( cacheFile, line ) )
+    {
+        unsigned int hash;
+        if( line.size() > 9u && line[8] == ' ' && sscanf( line.c_str(), "%08x", &hash ) == 1 )
+            outCache[line.substr( 9u )] = static_cast<uint32>( hash );
+    }
+}
+
+void saveBatchCache( const String &cacheFilename, const BatchCacheMap &cache )
+{
+    std::ofstream cacheFile( cacheFilename.c_str(), std::ios::out | std::ios::trunc );
+    if( !cacheFile.is_open() )
+    {
+        cout << "Warning: could not write batch cache '" << cacheFilename << "'" << endl;
+        return;
+    }
+
+    char hashStr[16];
+    BatchCacheMap::const_iterator itor = cache.begin();
+    BatchCacheMap::const_iterator end  = cache.end();
+    while( itor != end )
+    {
+        snprintf( hashStr, sizeof(hashStr), "%08x", static_cast<unsigned int>( itor->second ) );
+        cacheFile << hashStr << ' ' << itor->first << '\n';
+        ++itor;
+    }
+}
+
+/** Converts the jobs with child OgreMeshTool processes, up to numThreads at the same
+    time. The jobs are split in chunks, each processed by one child which shares its Root
+    & NULL RenderSystem setup among the files of its chunk.
+@remarks
+    The children write a cache file of their own, which tells which files were
+    converted successfully (and their new hash) so it can be merged into inOutCache.
+@param workerCmdLine
+    Command line to run the tool with the same options, excluding -batch & -cache.
+*/
+void processBatchInWorkers( const BatchJobVec &jobs, const String &cacheFilename,
+                            const String &workerCmdLine, size_t numThreads,
+                            BatchCacheMap &inOutCache, size_t &outNumConverted,
+                            size_t &outNumFailed )
+{
+    //A few chunks per thread keep all threads busy when some files take much
+    //longer than others, while still sharing each process' setup among many files.
+    const size_t maxChunks = std::min<size_t>( jobs.size(), numThreads * 4u );
+    const size_t chunkSize = (jobs.size() + maxChunks - 1u) / maxChunks;
+    const size_t numChunks = (jobs.size() + chunkSize - 1u) / chunkSize;
+
+    StringVector manifests;
+    StringVector commands;
+    manifests.reserve( numChunks );
+    commands.reserve( numChunks );
+
+    for( size_t i=0; i<numChunks; ++i )
+    {
+        const String manifestFilename = cacheFilename + ".job" + StringConverter::toString( i );
+        std::ofstream manifest( manifestFilename.c_str(), std::ios::out | std::ios::trunc );
+        if( !manifest.is_open() )
+        {
+            OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                         "Could not write batch manifest '" + manifestFilename + "'",
+                         "processBatchInWorkers" );
+        }
+
+        const size_t jobEnd = std::min( (i + 1u) * chunkSize, jobs.size() );
+        for( size_t j=i * chunkSize; j<jobEnd; ++j )
+            manifest << jobs[j].source << '\n';
+        manifest.close();
+
+        String command = workerCmdLine + " -cache " + quoteArgument( manifestFilename + ".cache" ) +
+                         " -batch " + quoteArgument( manifestFilename );
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+        //cmd.exe strips the first & last quotes when the command starts with one
+        command = "\"" + command + "\"";
+#endif
+        manifests.push_back( manifestFilename );
+        commands.push_back( command );
+    }
+
+    cout << "Converting " << jobs.size() << " files in " << numChunks << " processes, "
+         << std::min( numThreads, numChunks ) << " at a time..." << endl;
+    runBatchWorkers( commands, numThreads );
+
+    for( size_t i=0; i<numChunks; ++i )
+    {
+        BatchCacheMap chunkCache;
+        loadBatchCache( manifests[i] + ".cache", chunkCache );
+
+        const size_t jobEnd = std::min( (i + 1u) * chunkSize, jobs.size() );
+        for( size_t j=i * chunkSize; j<jobEnd; ++j )
+        {
+            BatchCacheMap::const_iterator itCache = chunkCache.find( jobs[j].source );
+            if( itCache != chunkCache.end() )
+            {
+                inOutCache[jobs[j].source] = itCache->second;
+                ++outNumConverted;
+            }
+            else
+            {
+                inOutCache.erase( jobs[j].source );
+                ++outNumFailed;
+            }
+        }
+
+        remove( (manifests[i] + ".cache").c_str() );
+        remove( manifests[i].c_str() );
+    }
+}
+
+/** Processes every file of the batch, skipping the ones that didn't change since the
+    last run.
+@remarks
+    Ogre's resource managers and VaoManager are not thread safe, thus conversions can't
+    run on threads of the same process. When numThreads > 1 they're spread across child
+    processes instead (@see processBatchInWorkers). Otherwise they're done one after
+    another in this process, sharing the Root & NULL RenderSystem setup.
+@return
+    Number of files that failed.
+*/
+size_t processBatch( const String &batchPath, const String &cacheFilename,
+                     uint32 optionsHash, size_t numThreads, bool force,
+                     const String &workerCmdLine,
+                     Ogre::MeshSerializer &meshSerializer2,
+                     v1::XMLMeshSerializer &xmlMeshSerializer,
+                     v1::XMLSkeletonSerializer &xmlSkeletonSerializer )
+{
+    if( opts.interactive )
+    {
+        OGRE_EXCEPT( Exception::ERR_INVALIDPARAMS, "-i can't be used together with -batch",
+                     "processBatch" );
+    }
+
+    BatchJobVec jobs;
+    collectBatchJobs( batchPath, jobs );
+
+    cout << "Hashing " << jobs.size() << " files using " << numThreads << " threads..." << endl;
+    hashBatchJobs( jobs, optionsHash, numThreads );
+
+    BatchCacheMap cache;
+    if( !force )
+        loadBatchCache( cacheFilename, cache );
+
+    //Conversions may modify the options (e.g. -O is disabled for XML)
+    const UpgradeOptions batchOpts = opts;
+
+    size_t numConverted = 0;
+    size_t numSkipped   = 0;
+    size_t numFailed    = 0;
+
+    BatchJobVec pendingJobs;
+    pendingJobs.reserve( jobs.size() );
+
+    BatchJobVec::const_iterator itor = jobs.begin();
+    BatchJobVec::const_iterator end  = jobs.end();
+    while( itor != end )
+    {
+        const BatchJob &job = *itor;
+        BatchCacheMap::const_iterator itCache = cache.find( job.source );
+
+        if( !job.hashValid )
+        {
+            cout << "Could not read '" << job.source << "'" << endl;
+            ++numFailed;
+        }
+        else if( itCache != cache.end() && itCache->second == job.hash &&
+                 fileExists( getDefaultDestination( job.source ) ) )
+        {
+            ++numSkipped;
+        }
+        else
+        {
+            pendingJobs.push_back( job );
+        }
+
+        ++itor;
+    }
+
+    if( numThreads > 1u && pendingJobs.size() > 1u )
+    {
+        processBatchInWorkers( pendingJobs, cacheFilename, workerCmdLine, numThreads,
+                               cache, numConverted, numFailed );
+    }
+    else
+    {
+        itor = pendingJobs.begin();
+        end  = pendingJobs.end();
+        while( itor != end )
+        {
+            const BatchJob &job = *itor;
+            const String dest = getDefaultDestination( job.source );
+
+            cout << "Processing " << job.source << endl;
+            opts = batchOpts;
+            try
+            {
+                convertFile( job.source, dest, meshSerializer2,
+                             xmlMeshSerializer, xmlSkeletonSerializer );
+
+                //When converting in place, store the hash of what we wrote,
+                //otherwise the next run would see it as modified.
+                uint32 newHash = job.hash;
+                if( dest == job.source && !hashFile( job.source, optionsHash, newHash ) )
+                    cache.erase( job.source );
+                else
+                    cache[job.source] = newHash;
+                ++numConverted;
+            }
+            catch( Exception &e )
+            {
+                cout << "Exception caught: " << e.getDescription() << std::endl;
+                cache.erase( job.source );
+                ++numFailed;
+            }
+
+            releaseConversionResources();
+
+            ++itor;
+        }
+    }
+
+    opts = batchOpts;
+
+    saveBatchCache( cacheFilename, cache );
+
+    cout << "Batch finished. Processed: " << numConverted << ". Unchanged (skipped): "
+         << numSkipped << ". Failed: " << numFailed << endl;
+
+    return numFailed;
+}
+
 int main(int numargs, char** args)
 {
     Root *root = 0;
@@ -1218,6 +1903,9 @@ int main(int numargs, char** args)
         unOptList["-U"] = false;
         unOptList["-v1"]= false;
         unOptList["-v2"]= false;
+        unOptList["-opt"]= false;
+        unOptList["-meshlets"]= false;
+        unOptList["-submeshbounds"]= false;
         binOptList["-l"] = "";
         binOptList["-d"] = "";
         binOptList["-p"] = "";
@@ -1227,128 +1915,80 @@ int main(int numargs, char** args)
         binOptList["-ts"] = "";
         binOptList["-V"] = "";
         binOptList["-O"] = "";
+        binOptList["-mv"] = "";
+        binOptList["-mt"] = "";
+
+        unOptList["-force"]= false;
+        binOptList["-batch"] = "";
+        binOptList["-j"] = "";
+        binOptList["-cache"] = "";
 
         int startIdx = findCommandLineOpts(numargs, args, unOptList, binOptList);
         parseOpts(unOptList, binOptList);
 
-        String source(args[startIdx]);
-
-        // Load the mesh
-        v1::MeshPtr v1Mesh;
-        v1::SkeletonPtr v1Skeleton;
-        MeshPtr v2Mesh;
-
-        if( !loadMesh( source, v1Mesh, v2Mesh, v1Skeleton, meshSerializer2,
-                       xmlMeshSerializer, xmlSkeletonSerializer ) )
-        {
-            // The contents of the XML may also be invalid
-            OGRE_EXCEPT( Exception::ERR_FILE_NOT_FOUND, "Could not open '" + source + "'", "main" );
-        }
+        const String batchPath = binOptList["-batch"];
 
-        if( opts.unoptimizeBuffer )
+        if( !batchPath.empty() )
         {
-            if( !v1Mesh.isNull() )
+            String cacheFilename = binOptList["-cache"];
+            if( cacheFilename.empty() )
             {
-                if( v1Mesh->sharedVertexData[VpNormal] )
-                {
-                    cout << "v1 Mesh has shared geometry. 'Unsharing' them..." << endl;
-                    v1::MeshManager::unshareVertices( v1Mesh.get() );
-                    cout << "Unshare operation successful" << endl;
-                }
-                v1Mesh->dearrangeToInefficient();
-            }
-
-            if( !v2Mesh.isNull() )
-                v2Mesh->dearrangeToInefficient();
-        }
-
-        v1::Mesh* mesh = v1Mesh.get();
-
-        // Write out the converted mesh
-        String dest;
-        if (numargs == startIdx + 2)
-        {
-            dest = args[startIdx + 1];
-        }
-        else
-        {
-            const String::size_type extPos = source.find_last_of( '.' );
-            const String sourceExt( source.substr( extPos + 1, source.size() ) );
-
-            if( sourceExt == "xml" )
-            {
-                // dest is source minus .xml
-                dest = source.substr( 0, source.size() - 4 );
-            }
-            else
-            {
-                dest = source;
+                if( isDirectory( batchPath ) )
+                    cacheFilename = batchPath + "/OgreMeshTool.cache";
+                else
+                    cacheFilename = batchPath + ".cache";
             }
-        }
 
-        {
-            const String::size_type extPos = dest.find_last_of( '.' );
-            const String dstExt( dest.substr( extPos + 1, dest.size() ) );
-            if( dstExt == "xml" )
+            size_t numThreads = PlatformInformation::getNumLogicalCores();
+            if( !binOptList["-j"].empty() )
+                numThreads = StringConverter::parseUnsignedInt( binOptList["-j"], 1u );
+            numThreads = std::max<size_t>( numThreads, 1u );
+
+            //Changing any option (or the tool's version) must invalidate the cache.
+            //Options are always before startIdx.
+            //Worker processes get the same options, so they compute the same hashes.
+            String optionsStr;
+            String workerCmdLine = quoteArgument( args[0] ) + " -j 1 -force";
+            for( int i=1; i<startIdx; ++i )
             {
-                if( opts.optimizeBuffer )
+                const String arg( args[i] );
+                if( arg == "-batch" || arg == "-j" || arg == "-cache" )
+                    ++i;
+                else if( arg != "-force" )
                 {
-                    cout << "-O is ignored when exporting to XML" << endl;
+                    optionsStr += arg + " ";
+                    workerCmdLine += " " + quoteArgument( arg );
                 }
-                opts.optimizeBuffer = false;
             }
+            const uint32 optionsHash = FastHash( optionsStr.c_str(),
+                                                 static_cast<int>( optionsStr.size() ),
+                                                 OGRE_VERSION );
+
+            const size_t numFailed = processBatch( batchPath, cacheFilename, optionsHash,
+                                                   numThreads, unOptList["-force"],
+                                                   workerCmdLine, meshSerializer2,
+                                                   xmlMeshSerializer, xmlSkeletonSerializer );
+            if( numFailed )
+                retCode = 1;
         }
-
-        if( !v1Mesh.isNull() )
+        else if( startIdx >= numargs )
         {
-            vertexBufferReorg(*mesh);
-
-            // Deal with VET_COLOUR ambiguities
-            resolveColourAmbiguities(mesh);
+            help();
+            retCode = -1;
         }
-
-        buildLod( v1Mesh );
-        buildEdgeLists( v1Mesh );
-        generateTangents( v1Mesh );
-
-        if( opts.optimizeBuffer )
-        {
-            if( !v1Mesh.isNull() )
-                mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
-            if( !v2Mesh.isNull() )
-                v2Mesh->arrangeEfficient( opts.halfPos, opts.halfTexCoords, opts.qTangents );
-        }
-
-        if (opts.recalcBounds)
+        else
         {
-            recalcBounds( v1Mesh, v2Mesh );
-        }
+            String source(args[startIdx]);
 
-        if( opts.optimizeForShadowMapping )
-        {
-            if( !v1Mesh.isNull() )
-            {
-                mesh->_updateCompiledBoneAssignments();
-                v1::Mesh::msOptimizeForShadowMapping = !opts.stripShadowMapping;
-                mesh->prepareForShadowMapping( false );
-                v1::Mesh::msOptimizeForShadowMapping = false;
-            }
-
-            if( !v2Mesh.isNull() )
-            {
-                Mesh::msOptimizeForShadowMapping = !opts.stripShadowMapping;
-                v2Mesh->prepareForShadowMapping( false );
-                Mesh::msOptimizeForShadowMapping = false;
-            }
-        }
+            // Write out the converted mesh
+            String dest;
+            if (numargs == startIdx + 2)
+                dest = args[startIdx + 1];
+            else
+                dest = getDefaultDestination( source );
 
-        if( !opts.dontOptimiseAnimations && !v1Skeleton.isNull() )
-        {
-            v1Skeleton->optimiseAllAnimations();
+            convertFile( source, dest, meshSerializer2, xmlMeshSerializer, xmlSkeletonSerializer );
         }
-
-        saveMesh( dest, v1Mesh, v2Mesh, v1Skeleton, meshSerializer2,
-                  xmlMeshSerializer, xmlSkeletonSerializer );
     }
     catch (Exception& e)
     {
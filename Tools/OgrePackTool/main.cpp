@@ -0,0 +1,132 @@
+
+#include "OgrePackArchive.h"
+#include "OgreFileSystem.h"
+#include "OgreString.h"
+#include "OgreStringConverter.h"
+
+#include <stdio.h>
+
+/*
+    Builds a PackArchive out of a folder, recursively.
+    Files that are already compressed, or that should be uploaded straight from the
+    mapped pack (e.g. DDS textures), are stored as is; the rest are deflated unless
+    it doesn't pay off.
+*/
+
+static void printHelp()
+{
+    printf(
+        "Builds an Ogre pack archive (see PackArchive) out of a folder.\n"
+        "\n"
+        "USAGE:\n"
+        "   OgrePackTool /path/to/folder output.pack [options]\n"
+        "\n"
+        "OPTIONS:\n"
+        "   -c <none|deflate>  Compression to use. Default: deflate if available\n"
+        "   -a <bytes>         Alignment of each entry (power of 2). Default: 4096\n"
+        "   -b <KiB>           Size of the independently compressed blocks. Default: 256\n"
+        "   -s <ext,ext,...>   Extensions that are never compressed.\n"
+        "                      Default: dds,ktx,ktx2,pvr,oitd,png,jpg,jpeg,ogg,zip,pack\n" );
+}
+
+int main( int argc, const char *argv[] )
+{
+    using namespace Ogre;
+
+    if( argc < 3 )
+    {
+        printHelp();
+        return -1;
+    }
+
+    const String inputFolder = argv[1];
+    const String outputFile = argv[2];
+    PackArchive::Compression compression =
+            PackArchive::isCompressionSupported( PackArchive::PackCompressionDeflate ) ?
+                PackArchive::PackCompressionDeflate : PackArchive::PackCompressionNone;
+    uint32 alignment = 4096u;
+    uint32 blockSize = 256u * 1024u;
+    StringVector storedExtensions = StringUtil::split(
+                                        "dds,ktx,ktx2,pvr,oitd,png,jpg,jpeg,ogg,zip,pack", "," );
+
+    for( int i=3; i<argc; ++i )
+    {
+        const String option = argv[i];
+        if( option == "-c" && i + 1 < argc )
+        {
+            const String value = argv[++i];
+            if( value == "none" )
+                compression = PackArchive::PackCompressionNone;
+            else if( value == "deflate" )
+                compression = PackArchive::PackCompressionDeflate;
+            else
+            {
+                printHelp();
+                return -1;
+            }
+        }
+        else if( option == "-a" && i + 1 < argc )
+            alignment = StringConverter::parseUnsignedInt( argv[++i], 4096u );
+        else if( option == "-b" && i + 1 < argc )
+            blockSize = StringConverter::parseUnsignedInt( argv[++i], 256u ) * 1024u;
+        else if( option == "-s" && i + 1 < argc )
+            storedExtensions = StringUtil::split( argv[++i], "," );
+        else
+        {
+            printHelp();
+            return -1;
+        }
+    }
+
+    if( !PackArchive::isCompressionSupported( compression ) )
+    {
+        fprintf( stderr, "This build of Ogre doesn't support the requested compression\n" );
+        return -1;
+    }
+
+    for( size_t i=0; i<storedExtensions.size(); ++i )
+        StringUtil::toLowerCase( storedExtensions[i] );
+
+    int retCode = 0;
+
+    try
+    {
+        FileSystemArchive inputArchive( inputFolder, "FileSystem", true );
+        inputArchive.load();
+        FileInfoListPtr files = inputArchive.listFileInfo( true, false );
+
+        PackArchiveWriter writer( outputFile, alignment, blockSize );
+
+        size_t totalSize = 0;
+        FileInfoList::const_iterator itor = files->begin();
+        FileInfoList::const_iterator end  = files->end();
+        while( itor != end )
+        {
+            String baseName, extension;
+            StringUtil::splitBaseFilename( itor->basename, baseName, extension );
+            StringUtil::toLowerCase( extension );
+
+            const bool storeAsIs = std::find( storedExtensions.begin(), storedExtensions.end(),
+                                              extension ) != storedExtensions.end();
+
+            DataStreamPtr stream = inputArchive.open( itor->filename );
+            writer.addFile( itor->filename, stream,
+                            storeAsIs ? PackArchive::PackCompressionNone : compression,
+                            inputArchive.getModifiedTime( itor->filename ) );
+            totalSize += itor->uncompressedSize;
+            ++itor;
+        }
+
+        writer.finish();
+
+        printf( "Packed %u files (%s bytes) into %s\n", static_cast<unsigned>( files->size() ),
+                StringConverter::toString( totalSize ).c_str(), outputFile.c_str() );
+    }
+    catch( Exception &e )
+    {
+        fprintf( stderr, "%s\n", e.getFullDescription().c_str() );
+        retCode = -1;
+    }
+
+    return retCode;
+}
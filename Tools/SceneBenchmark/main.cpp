@@ -0,0 +1,568 @@
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreWindow.h"
+#include "OgreCamera.h"
+#include "OgreSceneManager.h"
+#include "OgreItem.h"
+#include "OgreMesh2.h"
+#include "OgreMeshManager2.h"
+#include "OgreSubMesh2.h"
+#include "OgreTimer.h"
+#include "OgreString.h"
+#include "OgreStringConverter.h"
+#include "OgreArchiveManager.h"
+#include "OgreHlmsManager.h"
+#include "OgreHlmsPbs.h"
+#include "OgreSkeleton.h"
+#include "OgreOldBone.h"
+#include "OgreOldSkeletonManager.h"
+#include "OgreAnimation.h"
+#include "OgreAnimationTrack.h"
+#include "OgreKeyFrame.h"
+#include "Animation/OgreSkeletonManager.h"
+#include "Animation/OgreSkeletonInstance.h"
+#include "Animation/OgreSkeletonAnimation.h"
+#include "Compositor/OgreCompositorManager2.h"
+#include "Compositor/OgreCompositorWorkspace.h"
+#include "Compositor/OgreCompositorFrameCapture.h"
+#include "Vao/OgreVaoManager.h"
+#include "OgreAtomicScalar.h"
+
+#ifdef OGRE_STATIC_LIB
+#    include "OgreNULLRenderSystem.h"
+#endif
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+/*
+    Headless CPU benchmark of the SceneManager hot paths on the NULL RenderSystem.
+    A synthetic scene (node hierarchy, Items, lights & animated skeletons) is built
+    for each requested number of worker threads and rendered for a number of frames.
+    No GPU work is done, the reported times are the CPU cost of each stage as measured
+    by SceneManager::setCpuTiming.
+
+    Results are printed as CSV (one row per thread count) so CI can track them.
+
+    With -a, every allocation done through the global operator new is counted, to
+    audit the hot paths (e.g. String temporaries) that still allocate every frame.
+*/
+
+using namespace Ogre;
+
+/// Whether allocations are being counted. Set by -a
+static bool g_countAllocations = false;
+static AtomicScalar<uint32> g_numAllocations( 0u );
+
+void* operator new( size_t size )
+{
+    if( g_countAllocations )
+        ++g_numAllocations;
+    void *retVal = malloc( size ? size : 1u );
+    if( !retVal )
+        throw std::bad_alloc();
+    return retVal;
+}
+void* operator new[]( size_t size )
+{
+    return operator new( size );
+}
+void operator delete( void *ptr ) throw()
+{
+    free( ptr );
+}
+void operator delete[]( void *ptr ) throw()
+{
+    free( ptr );
+}
+//C++14 sized deallocation would otherwise call the default delete on malloc'ed memory
+void operator delete( void *ptr, size_t ) throw()
+{
+    free( ptr );
+}
+void operator delete[]( void *ptr, size_t ) throw()
+{
+    free( ptr );
+}
+
+static void printHelp()
+{
+    printf(
+        "Benchmarks the CPU side of the SceneManager on the NULL RenderSystem\n"
+        "using synthetic scenes, and prints the results as CSV.\n"
+        "\n"
+        "USAGE:\n"
+        "   OgreSceneBenchmark /path/to/Samples/Media [options]\n"
+        "\n"
+        "    /path/to/Samples/Media is where the Hlms/ templates are.\n"
+        "\n"
+        "OPTIONS:\n"
+        "   -n <nodes>      Number of SceneNodes. Default: 10000\n"
+        "   -d <depth>      Depth of the node hierarchy. Default: 4\n"
+        "   -i <items>      Number of Items. Default: 10000\n"
+        "   -l <lights>     Number of point lights. Default: 64\n"
+        "   -s <skeletons>  Number of animated skeletons. Default: 256\n"
+        "   -b <bones>      Bones per skeleton. Default: 32\n"
+        "   -t <a,b,c...>   Worker thread counts to benchmark. Default: 1,2,4\n"
+        "   -f <frames>     Number of frames to measure. Default: 500\n"
+        "   -w <frames>     Warm up frames that aren't measured. Default: 16\n"
+        "   -r <frames>     Captures a frame and replays it this many times, to measure\n"
+        "                   the cost of submitting its commands alone. Default: 0\n"
+        "   -a              Counts allocations done through operator new per frame.\n"
+        "                   On Windows, only the ones made by this executable's CRT.\n"
+        "                   Default: off\n"
+        "   -o <file>       Also writes the CSV to file\n" );
+}
+
+struct BenchmarkSettings
+{
+    uint32 numNodes;
+    uint32 depth;
+    uint32 numItems;
+    uint32 numLights;
+    uint32 numSkeletons;
+    uint32 numBones;
+    uint32 numFrames;
+    uint32 numWarmUpFrames;
+    uint32 numReplayFrames;
+    vector<uint32>::type threadCounts;
+};
+
+/// Deterministic, so that every run benchmarks the exact same scene
+static Real randomReal( uint32 &seed, Real minVal, Real maxVal )
+{
+    seed = seed * 1664525u + 1013904223u;
+    const Real t = Real( seed >> 8u ) / Real( 1u << 24u );
+    return minVal + ( maxVal - minVal ) * t;
+}
+//-----------------------------------------------------------------------------------
+static MeshPtr createCubeMesh( VaoManager *vaoManager )
+{
+    const float c_vertices[8 * 6] =
+    {
+        -1, -1,  1,  -0.57737f, -0.57737f,  0.57737f,
+         1, -1,  1,   0.57737f, -0.57737f,  0.57737f,
+         1,  1,  1,   0.57737f,  0.57737f,  0.57737f,
+        -1,  1,  1,  -0.57737f,  0.57737f,  0.57737f,
+        -1, -1, -1,  -0.57737f, -0.57737f, -0.57737f,
+         1, -1, -1,   0.57737f, -0.57737f, -0.57737f,
+         1,  1, -1,   0.57737f,  0.57737f, -0.57737f,
+        -1,  1, -1,  -0.57737f,  0.57737f, -0.57737f
+    };
+    const uint16 c_indices[3 * 2 * 6] =
+    {
+        0, 1, 2, 2, 3, 0,
+        6, 5, 4, 4, 7, 6,
+        3, 2, 6, 6, 7, 3,
+        5, 1, 0, 0, 4, 5,
+        4, 0, 3, 3, 7, 4,
+        6, 2, 1, 1, 5, 6
+    };
+
+    MeshPtr mesh = MeshManager::getSingleton().createManual(
+                       "SceneBenchmark Cube", ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
+    SubMesh *subMesh = mesh->createSubMesh();
+
+    VertexElement2Vec vertexElements;
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_POSITION ) );
+    vertexElements.push_back( VertexElement2( VET_FLOAT3, VES_NORMAL ) );
+
+    VertexBufferPackedVec vertexBuffers;
+    vertexBuffers.push_back( vaoManager->createVertexBuffer(
+                                 vertexElements, 8u, BT_IMMUTABLE,
+                                 const_cast<float*>( c_vertices ), false ) );
+    IndexBufferPacked *indexBuffer =
+            vaoManager->createIndexBuffer( IndexBufferPacked::IT_16BIT, 3u * 2u * 6u,
+                                           BT_IMMUTABLE, const_cast<uint16*>( c_indices ),
+                                           false );
+    VertexArrayObject *vao = vaoManager->createVertexArrayObject( vertexBuffers, indexBuffer,
+                                                                  OT_TRIANGLE_LIST );
+    subMesh->mVao[VpNormal].push_back( vao );
+    subMesh->mVao[VpShadow].push_back( vao );
+
+    mesh->_setBounds( Aabb( Vector3::ZERO, Vector3::UNIT_SCALE ), false );
+    mesh->_setBoundingSphereRadius( 1.732f );
+
+    return mesh;
+}
+//-----------------------------------------------------------------------------------
+/// Creates a tree of bones with one looping animation that moves all of them
+static SkeletonDefPtr createSkeleton( uint32 numBones )
+{
+    v1::SkeletonPtr skeleton = v1::OldSkeletonManager::getSingleton().create(
+                                   "SceneBenchmark Skeleton",
+                                   ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME, true );
+
+    v1::OldBone *rootBone = skeleton->createBone( 0 );
+    for( uint32 i=1u; i<numBones; ++i )
+    {
+        //Binary tree, so that there's more than one bone per depth level
+        v1::OldBone *parent = skeleton->getBone( static_cast<unsigned short>( (i - 1u) >> 1u ) );
+        parent->createChild( static_cast<unsigned short>( i ), Vector3( 0, 0.5f, 0 ) );
+    }
+    rootBone->setPosition( Vector3::ZERO );
+    skeleton->setBindingPose();
+
+    v1::Animation *animation = skeleton->createAnimation( "Benchmark", 1.0f );
+    for( uint32 i=0; i<numBones; ++i )
+    {
+        v1::OldBone *bone = skeleton->getBone( static_cast<unsigned short>( i ) );
+        v1::OldNodeAnimationTrack *track =
+                animation->createOldNodeTrack( static_cast<unsigned short>( i ), bone );
+        for( uint32 j=0; j<=4u; ++j )
+        {
+            v1::TransformKeyFrame *keyFrame = track->createNodeKeyFrame( Real( j ) * 0.25f );
+            keyFrame->setRotation( Quaternion( Radian( Real( j & 0x01u ) * 0.5f ),
+                                               Vector3::UNIT_Z ) );
+        }
+    }
+
+    return SkeletonManager::getSingleton().getSkeletonDef( skeleton.get() );
+}
+//-----------------------------------------------------------------------------------
+static void registerHlms( const String &mediaPath )
+{
+    String dataFolderPath;
+    StringVector libraryFoldersPaths;
+    HlmsPbs::getDefaultPaths( dataFolderPath, libraryFoldersPaths );
+
+    ArchiveManager &archiveManager = ArchiveManager::getSingleton();
+    Archive *archivePbs = archiveManager.load( mediaPath + "/" + dataFolderPath,
+                                               "FileSystem", true );
+    ArchiveVec archivePbsLibraryFolders;
+    StringVector::const_iterator itor = libraryFoldersPaths.begin();
+    StringVector::const_iterator end  = libraryFoldersPaths.end();
+    while( itor != end )
+    {
+        archivePbsLibraryFolders.push_back( archiveManager.load( mediaPath + "/" + *itor,
+                                                                 "FileSystem", true ) );
+        ++itor;
+    }
+
+    HlmsPbs *hlmsPbs = OGRE_NEW HlmsPbs( archivePbs, &archivePbsLibraryFolders );
+    Root::getSingleton().getHlmsManager()->registerHlms( hlmsPbs );
+}
+//-----------------------------------------------------------------------------------
+static String runBenchmark( Root *root, Window *window, const MeshPtr &mesh,
+                            const SkeletonDefPtr &skeletonDef,
+                            const BenchmarkSettings &settings, uint32 numThreads )
+{
+    SceneManager *sceneManager = root->createSceneManager( ST_GENERIC, numThreads,
+                                                           "OgreSceneBenchmark" );
+    Camera *camera = sceneManager->createCamera( "Main Camera" );
+    camera->setPosition( Vector3( 0, 0, 120.0f ) );
+    camera->lookAt( Vector3::ZERO );
+    camera->setNearClipDistance( 0.5f );
+    camera->setFarClipDistance( 1000.0f );
+    camera->setAspectRatio( Real( window->getWidth() ) / Real( window->getHeight() ) );
+
+    //Scene extends beyond the camera's frustum, so that culling has work to do
+    const Real sceneExtent = 200.0f;
+    uint32 seed = 0x5eed5eedu;
+
+    //Node hierarchy: chains of 'depth' nodes hanging from the root
+    vector<SceneNode*>::type sceneNodes;
+    sceneNodes.reserve( settings.numNodes );
+    {
+        SceneNode *rootNode = sceneManager->getRootSceneNode();
+        SceneNode *parentNode = rootNode;
+        for( uint32 i=0; i<settings.numNodes; ++i )
+        {
+            if( i % settings.depth == 0u )
+            {
+                parentNode = rootNode;
+            }
+
+            const Real half = parentNode == rootNode ? sceneExtent * 0.5f : 2.0f;
+            SceneNode *sceneNode = parentNode->createChildSceneNode(
+                                       SCENE_DYNAMIC,
+                                       Vector3( randomReal( seed, -half, half ),
+                                                randomReal( seed, -half, half ),
+                                                randomReal( seed, -half, half ) ) );
+            sceneNodes.push_back( sceneNode );
+            parentNode = sceneNode;
+        }
+    }
+
+    for( uint32 i=0; i<settings.numItems; ++i )
+    {
+        Item *item = sceneManager->createItem( mesh, SCENE_DYNAMIC );
+        sceneNodes[i % settings.numNodes]->attachObject( item );
+    }
+
+    for( uint32 i=0; i<settings.numLights; ++i )
+    {
+        Light *light = sceneManager->createLight();
+        light->setType( Light::LT_POINT );
+        light->setAttenuationBasedOnRadius( 10.0f, 0.01f );
+        sceneNodes[(i * 7u) % settings.numNodes]->attachObject( light );
+    }
+
+    vector<SkeletonInstance*>::type skeletons;
+    vector<SkeletonAnimation*>::type animations;
+    skeletons.reserve( settings.numSkeletons );
+    animations.reserve( settings.numSkeletons );
+    for( uint32 i=0; i<settings.numSkeletons; ++i )
+    {
+        SkeletonInstance *skeleton = sceneManager->createSkeletonInstance( skeletonDef.get() );
+        skeleton->setParentNode( sceneNodes[(i * 3u) % settings.numNodes] );
+        SkeletonAnimation *animation = skeleton->getAnimation( "Benchmark" );
+        animation->setEnabled( true );
+        animation->addTime( randomReal( seed, 0.0f, 1.0f ) );
+        skeletons.push_back( skeleton );
+        animations.push_back( animation );
+    }
+
+    CompositorManager2 *compositorManager = root->getCompositorManager2();
+    CompositorWorkspace *workspace =
+            compositorManager->addWorkspace( sceneManager, window->getTexture(), camera,
+                                             "OgreSceneBenchmark Workspace", true );
+
+    sceneManager->setCpuTiming( true );
+
+    Timer *timer = root->getTimer();
+    const Real frameTime = 1.0f / 60.0f;
+
+    SceneManager::CpuTimings total;
+    memset( &total, 0, sizeof( total ) );
+    uint64 totalFrameTime = 0;
+    uint64 totalAllocations = 0;
+
+    for( uint32 i=0; i<settings.numWarmUpFrames + settings.numFrames; ++i )
+    {
+        vector<SkeletonAnimation*>::type::const_iterator itor = animations.begin();
+        vector<SkeletonAnimation*>::type::const_iterator end  = animations.end();
+        while( itor != end )
+        {
+            (*itor)->addTime( frameTime );
+            ++itor;
+        }
+
+        const uint32 startAllocations = g_numAllocations.get();
+        const uint64 startTime = timer->getMicroseconds();
+        root->renderOneFrame();
+        const uint64 endTime = timer->getMicroseconds();
+        const uint32 endAllocations = g_numAllocations.get();
+
+        if( i >= settings.numWarmUpFrames )
+        {
+            const SceneManager::CpuTimings &timings = sceneManager->getCpuTimings();
+            total.updateAllTransforms   += timings.updateAllTransforms;
+            total.updateAllAnimations   += timings.updateAllAnimations;
+            total.updateAllBounds       += timings.updateAllBounds;
+            total.buildLightList        += timings.buildLightList;
+            total.cullFrustum           += timings.cullFrustum;
+            total.renderQueueSort       += timings.renderQueueSort;
+            total.renderQueueRender     += timings.renderQueueRender;
+            totalFrameTime += endTime - startTime;
+            totalAllocations += endAllocations - startAllocations;
+        }
+    }
+
+    uint64 totalReplayTime = 0;
+    if( settings.numReplayFrames )
+    {
+        CompositorFrameCapture *frameCapture = compositorManager->getFrameCapture();
+        frameCapture->requestCapture();
+        root->renderOneFrame();
+
+        frameCapture->setReplayEnabled( true );
+        for( uint32 i=0; i<settings.numReplayFrames; ++i )
+        {
+            root->renderOneFrame();
+            totalReplayTime += frameCapture->getLastReplayTime();
+        }
+        frameCapture->setReplayEnabled( false );
+        frameCapture->clear();
+    }
+
+    compositorManager->removeWorkspace( workspace );
+
+    vector<SkeletonInstance*>::type::const_iterator itor = skeletons.begin();
+    vector<SkeletonInstance*>::type::const_iterator end  = skeletons.end();
+    while( itor != end )
+        sceneManager->destroySkeletonInstance( *itor++ );
+
+    root->destroySceneManager( sceneManager );
+
+    const double numFrames = double( settings.numFrames );
+    char tmpBuffer[512];
+    snprintf( tmpBuffer, sizeof( tmpBuffer ),
+              "%u,%u,%u,%u,%u,%u,%u,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f,%.2f\n",
+              numThreads, settings.numNodes, settings.depth, settings.numItems,
+              settings.numLights, settings.numSkeletons, settings.numFrames,
+              double( total.updateAllTransforms ) / numFrames,
+              double( total.updateAllAnimations ) / numFrames,
+              double( total.updateAllBounds ) / numFrames,
+              double( total.buildLightList ) / numFrames,
+              double( total.cullFrustum ) / numFrames,
+              double( total.renderQueueSort ) / numFrames,
+              double( total.renderQueueRender ) / numFrames,
+              double( totalFrameTime ) / numFrames,
+              settings.numReplayFrames ?
+                  double( totalReplayTime ) / double( settings.numReplayFrames ) : 0.0,
+              double( totalAllocations ) / numFrames );
+    return tmpBuffer;
+}
+//-----------------------------------------------------------------------------------
+int main( int argc, const char *argv[] )
+{
+    if( argc < 2 )
+    {
+        printHelp();
+        return -1;
+    }
+
+    const String mediaPath = argv[1];
+    String csvPath;
+
+    BenchmarkSettings settings;
+    settings.numNodes = 10000u;
+    settings.depth = 4u;
+    settings.numItems = 10000u;
+    settings.numLights = 64u;
+    settings.numSkeletons = 256u;
+    settings.numBones = 32u;
+    settings.numFrames = 500u;
+    settings.numWarmUpFrames = 16u;
+    settings.numReplayFrames = 0u;
+
+    for( int i=2; i<argc; ++i )
+    {
+        const String option = argv[i];
+        if( option == "-n" && i + 1 < argc )
+            settings.numNodes = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-d" && i + 1 < argc )
+            settings.depth = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-i" && i + 1 < argc )
+            settings.numItems = static_cast<uint32>( atoi( argv[++i] ) );
+        else if( option == "-l" && i + 1 < argc )
+            settings.numLights = static_cast<uint32>( atoi( argv[++i] ) );
+        else if( option == "-s" && i + 1 < argc )
+            settings.numSkeletons = static_cast<uint32>( atoi( argv[++i] ) );
+        else if( option == "-b" && i + 1 < argc )
+            settings.numBones = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-t" && i + 1 < argc )
+        {
+            const StringVector counts = StringUtil::split( argv[++i], "," );
+            StringVector::const_iterator itor = counts.begin();
+            StringVector::const_iterator end  = counts.end();
+            while( itor != end )
+            {
+                settings.threadCounts.push_back(
+                            std::max( StringConverter::parseUnsignedInt( *itor ), 1u ) );
+                ++itor;
+            }
+        }
+        else if( option == "-f" && i + 1 < argc )
+            settings.numFrames = std::max( static_cast<uint32>( atoi( argv[++i] ) ), 1u );
+        else if( option == "-w" && i + 1 < argc )
+            settings.numWarmUpFrames = static_cast<uint32>( atoi( argv[++i] ) );
+        else if( option == "-r" && i + 1 < argc )
+            settings.numReplayFrames = static_cast<uint32>( atoi( argv[++i] ) );
+        else if( option == "-a" )
+            g_countAllocations = true;
+        else if( option == "-o" && i + 1 < argc )
+            csvPath = argv[++i];
+        else
+        {
+            printHelp();
+            return -1;
+        }
+    }
+
+    if( settings.threadCounts.empty() )
+    {
+        settings.threadCounts.push_back( 1u );
+        settings.threadCounts.push_back( 2u );
+        settings.threadCounts.push_back( 4u );
+    }
+
+    //Most Ogre scripts assume floating point to use radix point, not comma.
+    setlocale( LC_NUMERIC, "C" );
+
+    int retCode = 0;
+    LogManager *logManager = 0;
+    Root *root = 0;
+
+    try
+    {
+        String pluginsPath;
+        // only use plugins.cfg if not static
+#ifndef OGRE_STATIC_LIB
+#if OGRE_DEBUG_MODE
+        pluginsPath = "plugins_tools_d.cfg";
+#else
+        pluginsPath = "plugins_tools.cfg";
+#endif
+#endif
+        logManager = OGRE_NEW LogManager();
+        logManager->createLog( "OgreSceneBenchmark.log", true, false );
+        root = OGRE_NEW Root( pluginsPath, "", "OgreSceneBenchmark.log" );
+
+#ifdef OGRE_STATIC_LIB
+        root->addRenderSystem( new NULLRenderSystem() );
+#endif
+        RenderSystem *renderSystem = root->getRenderSystemByName( "NULL Rendering Subsystem" );
+        if( !renderSystem )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         "NULL RenderSystem not found. Check " + pluginsPath,
+                         "OgreSceneBenchmark" );
+        }
+
+        root->setRenderSystem( renderSystem );
+        root->initialise( false );
+
+        Window *window = root->createRenderWindow( "OgreSceneBenchmark", 1920u, 1080u, false );
+
+        registerHlms( mediaPath );
+        ResourceGroupManager::getSingleton().initialiseAllResourceGroups( true );
+
+        root->getCompositorManager2()->createBasicWorkspaceDef( "OgreSceneBenchmark Workspace",
+                                                                ColourValue::Black );
+
+        const MeshPtr mesh = createCubeMesh( renderSystem->getVaoManager() );
+        const SkeletonDefPtr skeletonDef = createSkeleton( settings.numBones );
+
+        String csv = "threads,nodes,depth,items,lights,skeletons,frames,"
+                     "updateAllTransforms,updateAllAnimations,updateAllBounds,buildLightList,"
+                     "cullFrustum,renderQueueSort,renderQueueRender,frame,replay,allocations\n";
+        printf( "%s", csv.c_str() );
+
+        vector<uint32>::type::const_iterator itor = settings.threadCounts.begin();
+        vector<uint32>::type::const_iterator end  = settings.threadCounts.end();
+        while( itor != end )
+        {
+            const String row = runBenchmark( root, window, mesh, skeletonDef, settings, *itor );
+            printf( "%s", row.c_str() );
+            fflush( stdout );
+            csv += row;
+            ++itor;
+        }
+
+        if( !csvPath.empty() )
+        {
+            FILE *outFile = fopen( csvPath.c_str(), "wb" );
+            if( !outFile )
+            {
+                OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                             "Could not open " + csvPath + " for writing",
+                             "OgreSceneBenchmark" );
+            }
+            fwrite( csv.c_str(), 1u, csv.size(), outFile );
+            fclose( outFile );
+        }
+    }
+    catch( Exception &e )
+    {
+        fprintf( stderr, "%s\n", e.getFullDescription().c_str() );
+        retCode = -1;
+    }
+
+    OGRE_DELETE root;
+    OGRE_DELETE logManager;
+
+    return retCode;
+}
@@ -0,0 +1,622 @@
+#include "OgreRoot.h"
+#include "OgreLogManager.h"
+#include "OgreWindow.h"
+#include "OgreTimer.h"
+#include "OgreString.h"
+#include "OgreStringConverter.h"
+#include "OgreCodec.h"
+#include "OgreLoadProfiler.h"
+#include "OgreTextureGpuManager.h"
+#include "OgreTextureGpuListener.h"
+#include "OgreTextureFilters.h"
+#include "OgrePixelFormatGpuUtils.h"
+#include "Threading/OgreThreads.h"
+
+#ifdef OGRE_STATIC_LIB
+#    include "OgreNULLRenderSystem.h"
+#endif
+
+#include <algorithm>
+
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+#    define WIN32_LEAN_AND_MEAN
+#    ifndef NOMINMAX
+#        define NOMINMAX
+#    endif
+#    include <windows.h>
+#    include <psapi.h>
+#elif OGRE_PLATFORM == OGRE_PLATFORM_LINUX
+#    include <unistd.h>
+#endif
+
+/*
+    Measures how fast TextureGpuManager streams textures from file to residency under
+    different streaming budgets, so they can be tuned per hardware tier.
+
+    Every image found in the given folder (PNG, JPG, DDS, KTX, ASTC, etc;
+    whatever the registered codecs support) is loaded through TextureGpuManager
+    while the main thread keeps rendering empty frames, the same way a game would stream
+    a level. Each run is repeated for every combination of minimum budget
+    (setWorkerThreadMinimumBudget), preload limit (setWorkerThreadMaxPreloadBytes) and
+    number of decoder threads (setNumDecoderThreads).
+
+    The files are loaded once before the first run so that they're in the OS file cache
+    and so that we know which format families need a budget. Runs are done in the order
+    given; StagingTextures kept by a big budget take a few frames to be released.
+
+    On the NULL RenderSystem the upload is only a memcpy; use -r to benchmark a real API.
+    Results are printed as CSV, one row per texture set and configuration:
+        sourceMB        Size of the files that were decoded.
+        residentMB      Size of the textures once resident (including mipmaps).
+        decodeMBps      residentMB / time spent decoding (summed across threads).
+        uploadMBps      residentMB / time until the last texture was ready.
+        firstMs         Time until the first texture was ready.
+        avgMs, maxMs    Average & worst time to residency of the textures.
+        frames          Frames rendered until all textures were ready.
+        peakStreamingMB Peak of the textures in system RAM plus StagingTextures.
+        peakProcessMB   Peak process working set (0 where unsupported).
+        workerUsage     % of time the streaming & decoder threads were busy reading
+                        or decoding files.
+    Peaks are sampled once per frame.
+*/
+
+using namespace Ogre;
+
+static void printHelp()
+{
+    printf(
+        "Benchmarks texture streaming throughput & time to residency\n"
+        "and prints the results as CSV.\n"
+        "\n"
+        "USAGE:\n"
+        "   OgreTextureStreamingBenchmark /path/to/textures [options]\n"
+        "\n"
+        "    /path/to/textures is searched recursively for images.\n"
+        "\n"
+        "OPTIONS:\n"
+        "   -b <a,b,c...>   Minimum budget. For every format family found, keep a\n"
+        "                   StagingTexture of NxN around. 0 means no budget.\n"
+        "                   Default: 0,2048,4096\n"
+        "   -p <a,b,c...>   Max preload bytes, in MB. Default: 32,128,256\n"
+        "   -t <a,b,c...>   Number of decoder threads. Default: 0\n"
+        "   -f <ms>         Sleep time per frame, to simulate the rest of the frame.\n"
+        "                   Default: 0\n"
+        "   -g              Generate mipmaps\n"
+        "   -s              Also run each file extension as a set of its own\n"
+        "   -r <name>       RenderSystem to use. Default: NULL Rendering Subsystem\n"
+        "   -c <file>       plugins.cfg to load the RenderSystem from\n"
+        "   -o <file>       Also writes the CSV to file\n" );
+}
+
+static const char *c_resourceGroup = "TextureStreamingBenchmark";
+
+struct BenchmarkSettings
+{
+    vector<uint32>::type    budgetResolutions;
+    vector<size_t>::type    maxPreloadBytes;
+    vector<uint32>::type    numDecoderThreads;
+    uint32                  frameSleepMs;
+    uint32                  filters;
+};
+
+struct TextureSet
+{
+    String          name;
+    StringVector    files;
+};
+
+struct RunConfig
+{
+    uint32  budgetResolution;
+    size_t  maxPreloadBytes;
+    uint32  numDecoderThreads;
+};
+
+//-----------------------------------------------------------------------------------
+/// Returns 0 where unsupported
+static size_t getProcessMemory(void)
+{
+#if OGRE_PLATFORM == OGRE_PLATFORM_WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if( GetProcessMemoryInfo( GetCurrentProcess(), &counters, sizeof( counters ) ) )
+        return counters.WorkingSetSize;
+    return 0;
+#elif OGRE_PLATFORM == OGRE_PLATFORM_LINUX
+    FILE *statm = fopen( "/proc/self/statm", "rb" );
+    if( !statm )
+        return 0;
+    unsigned long totalPages = 0, residentPages = 0;
+    if( fscanf( statm, "%lu %lu", &totalPages, &residentPages ) != 2 )
+        residentPages = 0;
+    fclose( statm );
+    return static_cast<size_t>( residentPages ) * static_cast<size_t>( sysconf( _SC_PAGESIZE ) );
+#else
+    return 0;
+#endif
+}
+//-----------------------------------------------------------------------------------
+static size_t getStreamingMemory( TextureGpuManager *textureGpuManager )
+{
+    size_t textureBytesCpu, textureBytesGpu, usedStagingTextureBytes;
+    size_t availableStagingTextureBytes;
+    textureGpuManager->getMemoryStats( textureBytesCpu, textureBytesGpu,
+                                       usedStagingTextureBytes, availableStagingTextureBytes );
+    return textureBytesCpu + usedStagingTextureBytes + availableStagingTextureBytes;
+}
+//-----------------------------------------------------------------------------------
+/// Records when each texture becomes ready for rendering
+class ResidencyListener : public TextureGpuListener
+{
+    typedef map<TextureGpu*, size_t>::type TextureIndexMap;
+
+    Timer               *mTimer;
+    uint64              mStartTime;
+    TextureIndexMap     mTextureIndices;
+    vector<uint64>::type mTimesToResidency;
+    size_t              mNumPending;
+    size_t              mNumFailed;
+
+public:
+    ResidencyListener( Timer *timer ) :
+        mTimer( timer ), mStartTime( 0 ), mNumPending( 0 ), mNumFailed( 0 ) {}
+
+    void addTexture( TextureGpu *texture )
+    {
+        mTextureIndices[texture] = mTimesToResidency.size();
+        mTimesToResidency.push_back( 0 );
+        ++mNumPending;
+        texture->addListener( this );
+    }
+
+    void start(void)                                    { mStartTime = mTimer->getMicroseconds(); }
+
+    virtual void notifyTextureChanged( TextureGpu *texture, TextureGpuListener::Reason reason,
+                                       void *extraData )
+    {
+        if( reason == TextureGpuListener::ExceptionThrown )
+        {
+            //It will continue loading a fallback, and get ReadyForRendering
+            ++mNumFailed;
+        }
+        else if( reason == TextureGpuListener::ReadyForRendering )
+        {
+            TextureIndexMap::const_iterator itor = mTextureIndices.find( texture );
+            if( itor != mTextureIndices.end() && !mTimesToResidency[itor->second] )
+            {
+                mTimesToResidency[itor->second] =
+                        std::max<uint64>( mTimer->getMicroseconds() - mStartTime, 1u );
+                --mNumPending;
+            }
+        }
+    }
+
+    bool isDone(void) const                             { return mNumPending == 0u; }
+    size_t getNumFailed(void) const                     { return mNumFailed; }
+    const vector<uint64>::type& getTimesToResidency(void) const { return mTimesToResidency; }
+
+    void removeFromAll(void)
+    {
+        TextureIndexMap::const_iterator itor = mTextureIndices.begin();
+        TextureIndexMap::const_iterator end  = mTextureIndices.end();
+        while( itor != end )
+        {
+            itor->first->removeListener( this );
+            ++itor;
+        }
+    }
+};
+//-----------------------------------------------------------------------------------
+/// Renders (empty) frames so texture streaming progresses and unused
+/// StagingTextures get released.
+static void renderIdleFrames( Root *root, uint32 numFrames )
+{
+    for( uint32 i=0; i<numFrames; ++i )
+        root->renderOneFrame();
+}
+//-----------------------------------------------------------------------------------
+static vector<TextureGpu*>::type createTextures( TextureGpuManager *textureGpuManager,
+                                                  const StringVector &files, uint32 filters )
+{
+    vector<TextureGpu*>::type textures;
+    textures.reserve( files.size() );
+
+    StringVector::const_iterator itor = files.begin();
+    StringVector::const_iterator end  = files.end();
+    while( itor != end )
+    {
+        textures.push_back( textureGpuManager->createOrRetrieveTexture(
+                                *itor, GpuPageOutStrategy::Discard, 0u, TextureTypes::Type2D,
+                                c_resourceGroup, filters ) );
+        ++itor;
+    }
+
+    return textures;
+}
+//-----------------------------------------------------------------------------------
+static void destroyTextures( TextureGpuManager *textureGpuManager,
+                             const vector<TextureGpu*>::type &textures )
+{
+    vector<TextureGpu*>::type::const_iterator itor = textures.begin();
+    vector<TextureGpu*>::type::const_iterator end  = textures.end();
+    while( itor != end )
+        textureGpuManager->destroyTexture( *itor++ );
+}
+//-----------------------------------------------------------------------------------
+/// Loads every file once, so that they're in the OS cache. Returns the format
+/// families found, which need a budget entry each.
+static vector<PixelFormatGpu>::type warmUp( Root *root, const StringVector &files,
+                                            uint32 filters )
+{
+    TextureGpuManager *textureGpuManager = root->getRenderSystem()->getTextureGpuManager();
+
+    vector<TextureGpu*>::type textures = createTextures( textureGpuManager, files, filters );
+    vector<TextureGpu*>::type::const_iterator itor = textures.begin();
+    vector<TextureGpu*>::type::const_iterator end  = textures.end();
+    while( itor != end )
+        (*itor++)->scheduleTransitionTo( GpuResidency::Resident );
+
+    textureGpuManager->waitForStreamingCompletion();
+
+    vector<PixelFormatGpu>::type families;
+    itor = textures.begin();
+    while( itor != end )
+    {
+        const PixelFormatGpu family = PixelFormatGpuUtils::getFamily( (*itor)->getPixelFormat() );
+        if( std::find( families.begin(), families.end(), family ) == families.end() )
+            families.push_back( family );
+        ++itor;
+    }
+
+    destroyTextures( textureGpuManager, textures );
+    renderIdleFrames( root, 16u );
+
+    return families;
+}
+//-----------------------------------------------------------------------------------
+static String runConfig( Root *root, const BenchmarkSettings &settings, const TextureSet &set,
+                         const vector<PixelFormatGpu>::type &families, const RunConfig &config )
+{
+    TextureGpuManager *textureGpuManager = root->getRenderSystem()->getTextureGpuManager();
+    LoadProfiler *loadProfiler = root->getLoadProfiler();
+    Timer *timer = root->getTimer();
+
+    TextureGpuManager::BudgetEntryVec budget;
+    if( config.budgetResolution > 0u )
+    {
+        vector<PixelFormatGpu>::type::const_iterator itor = families.begin();
+        vector<PixelFormatGpu>::type::const_iterator end  = families.end();
+        while( itor != end )
+        {
+            budget.push_back( TextureGpuManager::BudgetEntry( *itor, config.budgetResolution,
+                                                              1u ) );
+            ++itor;
+        }
+    }
+
+    textureGpuManager->setNumDecoderThreads( config.numDecoderThreads );
+    textureGpuManager->setWorkerThreadMinimumBudget( budget );
+    textureGpuManager->setWorkerThreadMaxPreloadBytes( config.maxPreloadBytes );
+
+    //Let the budget be reserved & the previous run's StagingTextures be released
+    renderIdleFrames( root, 16u );
+
+    ResidencyListener listener( timer );
+    vector<TextureGpu*>::type textures = createTextures( textureGpuManager, set.files,
+                                                         settings.filters );
+    vector<TextureGpu*>::type::const_iterator itor = textures.begin();
+    vector<TextureGpu*>::type::const_iterator end  = textures.end();
+    while( itor != end )
+        listener.addTexture( *itor++ );
+
+    loadProfiler->reset();
+    loadProfiler->setEnabled( true );
+
+    size_t peakStreamingMemory = getStreamingMemory( textureGpuManager );
+    size_t peakProcessMemory = getProcessMemory();
+
+    listener.start();
+    const uint64 startTime = timer->getMicroseconds();
+
+    itor = textures.begin();
+    while( itor != end )
+        (*itor++)->scheduleTransitionTo( GpuResidency::Resident );
+
+    uint32 numFrames = 0;
+    while( !listener.isDone() )
+    {
+        root->renderOneFrame();
+        ++numFrames;
+        peakStreamingMemory = std::max( peakStreamingMemory,
+                                        getStreamingMemory( textureGpuManager ) );
+        peakProcessMemory = std::max( peakProcessMemory, getProcessMemory() );
+        if( settings.frameSleepMs )
+            Threads::Sleep( settings.frameSleepMs );
+    }
+
+    const uint64 totalTime = std::max<uint64>( timer->getMicroseconds() - startTime, 1u );
+
+    loadProfiler->setEnabled( false );
+
+    LoadProfiler::EventVec events;
+    loadProfiler->getEvents( events );
+
+    uint64 sourceBytes = 0;
+    uint64 decodeTime = 0;
+    uint64 workerBusyTime = 0;
+    LoadProfiler::EventVec::const_iterator itEvent = events.begin();
+    LoadProfiler::EventVec::const_iterator enEvent = events.end();
+    while( itEvent != enEvent )
+    {
+        if( itEvent->type == LoadEvent::TextureDecode )
+        {
+            sourceBytes += itEvent->bytes;
+            decodeTime += itEvent->usTaken;
+        }
+        if( !itEvent->mainThread && ( itEvent->type == LoadEvent::TextureDecode ||
+                                      itEvent->type == LoadEvent::ArchiveRead ) )
+        {
+            workerBusyTime += itEvent->usTaken;
+        }
+        ++itEvent;
+    }
+
+    uint64 residentBytes = 0;
+    itor = textures.begin();
+    while( itor != end )
+        residentBytes += (*itor++)->getSizeBytes();
+
+    const vector<uint64>::type &timesToResidency = listener.getTimesToResidency();
+    uint64 firstTime = timesToResidency.empty() ? 0u : timesToResidency.front();
+    uint64 maxTime = 0;
+    uint64 sumTimes = 0;
+    for( size_t i=0; i<timesToResidency.size(); ++i )
+    {
+        firstTime = std::min( firstTime, timesToResidency[i] );
+        maxTime = std::max( maxTime, timesToResidency[i] );
+        sumTimes += timesToResidency[i];
+    }
+
+    const size_t numFailed = listener.getNumFailed();
+    listener.removeFromAll();
+    destroyTextures( textureGpuManager, textures );
+
+    const double c_toMB = 1.0 / ( 1024.0 * 1024.0 );
+    const double residentMB = static_cast<double>( residentBytes ) * c_toMB;
+    const uint32 numWorkerThreads = config.numDecoderThreads + 1u;
+
+    char tmpBuffer[1024];
+    snprintf( tmpBuffer, sizeof( tmpBuffer ),
+              "%s,%lu,%lu,%u,%lu,%u,%.2f,%.2f,%.2f,%.2f,%.3f,%.3f,%.3f,%u,%.2f,%.2f,%.1f\n",
+              set.name.c_str(), static_cast<unsigned long>( textures.size() ),
+              static_cast<unsigned long>( numFailed ), config.budgetResolution,
+              static_cast<unsigned long>( config.maxPreloadBytes / ( 1024u * 1024u ) ),
+              config.numDecoderThreads,
+              static_cast<double>( sourceBytes ) * c_toMB, residentMB,
+              decodeTime ? residentMB / ( static_cast<double>( decodeTime ) * 1.0e-6 ) : 0.0,
+              residentMB / ( static_cast<double>( totalTime ) * 1.0e-6 ),
+              static_cast<double>( firstTime ) * 1.0e-3,
+              timesToResidency.empty() ? 0.0 : static_cast<double>( sumTimes ) * 1.0e-3 /
+                                               static_cast<double>( timesToResidency.size() ),
+              static_cast<double>( maxTime ) * 1.0e-3, numFrames,
+              static_cast<double>( peakStreamingMemory ) * c_toMB,
+              static_cast<double>( peakProcessMemory ) * c_toMB,
+              100.0 * static_cast<double>( workerBusyTime ) /
+              ( static_cast<double>( totalTime ) * numWorkerThreads ) );
+    return tmpBuffer;
+}
+//-----------------------------------------------------------------------------------
+static vector<TextureSet>::type findTextureSets( const String &texturesPath, bool perExtension )
+{
+    ResourceGroupManager &resourceGroupManager = ResourceGroupManager::getSingleton();
+    resourceGroupManager.addResourceLocation( texturesPath, "FileSystem", c_resourceGroup, true );
+    resourceGroupManager.initialiseResourceGroup( c_resourceGroup, true );
+
+    const StringVector supportedExtensions = Codec::getExtensions();
+
+    vector<TextureSet>::type sets;
+    sets.push_back( TextureSet() );
+    sets.back().name = "all";
+
+    StringVectorPtr files = resourceGroupManager.listResourceNames( c_resourceGroup );
+    StringVector::const_iterator itor = files->begin();
+    StringVector::const_iterator end  = files->end();
+    while( itor != end )
+    {
+        String baseName, extension;
+        StringUtil::splitBaseFilename( *itor, baseName, extension );
+        StringUtil::toLowerCase( extension );
+
+        if( std::find( supportedExtensions.begin(), supportedExtensions.end(),
+                       extension ) != supportedExtensions.end() )
+        {
+            sets.front().files.push_back( *itor );
+
+            if( perExtension )
+            {
+                vector<TextureSet>::type::iterator itSet = sets.begin() + 1u;
+                while( itSet != sets.end() && itSet->name != extension )
+                    ++itSet;
+                if( itSet == sets.end() )
+                {
+                    sets.push_back( TextureSet() );
+                    sets.back().name = extension;
+                    itSet = sets.end() - 1u;
+                }
+                itSet->files.push_back( *itor );
+            }
+        }
+        ++itor;
+    }
+
+    if( sets.front().files.empty() )
+    {
+        OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                     "No supported images found in " + texturesPath,
+                     "OgreTextureStreamingBenchmark" );
+    }
+
+    return sets;
+}
+//-----------------------------------------------------------------------------------
+template <typename T>
+static bool parseList( const String &list, typename vector<T>::type &outValues, T multiplier )
+{
+    StringVector values = StringUtil::split( list, "," );
+    outValues.clear();
+    for( size_t i=0; i<values.size(); ++i )
+    {
+        if( !StringConverter::isNumber( values[i] ) )
+            return false;
+        outValues.push_back( static_cast<T>( StringConverter::parseUnsignedLong( values[i] ) ) *
+                             multiplier );
+    }
+    return !outValues.empty();
+}
+//-----------------------------------------------------------------------------------
+int main( int argc, const char *argv[] )
+{
+    if( argc < 2 )
+    {
+        printHelp();
+        return -1;
+    }
+
+    const String texturesPath = argv[1];
+
+    BenchmarkSettings settings;
+    settings.frameSleepMs = 0;
+    settings.filters = 0;
+    bool perExtension = false;
+    String renderSystemName = "NULL Rendering Subsystem";
+    String pluginsPath;
+    String csvPath;
+
+    parseList<uint32>( "0,2048,4096", settings.budgetResolutions, 1u );
+    parseList<size_t>( "32,128,256", settings.maxPreloadBytes, 1024u * 1024u );
+    parseList<uint32>( "0", settings.numDecoderThreads, 1u );
+
+    // only use plugins.cfg if not static
+#ifndef OGRE_STATIC_LIB
+#if OGRE_DEBUG_MODE
+    pluginsPath = "plugins_tools_d.cfg";
+#else
+    pluginsPath = "plugins_tools.cfg";
+#endif
+#endif
+
+    for( int i=2; i<argc; ++i )
+    {
+        const String option = argv[i];
+        bool isValid = true;
+        if( option == "-b" && i + 1 < argc )
+            isValid = parseList<uint32>( argv[++i], settings.budgetResolutions, 1u );
+        else if( option == "-p" && i + 1 < argc )
+            isValid = parseList<size_t>( argv[++i], settings.maxPreloadBytes, 1024u * 1024u );
+        else if( option == "-t" && i + 1 < argc )
+            isValid = parseList<uint32>( argv[++i], settings.numDecoderThreads, 1u );
+        else if( option == "-f" && i + 1 < argc )
+            settings.frameSleepMs = StringConverter::parseUnsignedInt( argv[++i] );
+        else if( option == "-g" )
+            settings.filters = TextureFilter::TypeGenerateDefaultMipmaps;
+        else if( option == "-s" )
+            perExtension = true;
+        else if( option == "-r" && i + 1 < argc )
+            renderSystemName = argv[++i];
+        else if( option == "-c" && i + 1 < argc )
+            pluginsPath = argv[++i];
+        else if( option == "-o" && i + 1 < argc )
+            csvPath = argv[++i];
+        else
+            isValid = false;
+
+        if( !isValid )
+        {
+            printHelp();
+            return -1;
+        }
+    }
+
+    //Most Ogre scripts assume floating point to use radix point, not comma.
+    setlocale( LC_NUMERIC, "C" );
+
+    int retCode = 0;
+    LogManager *logManager = 0;
+    Root *root = 0;
+
+    try
+    {
+        logManager = OGRE_NEW LogManager();
+        logManager->createLog( "OgreTextureStreamingBenchmark.log", true, false );
+        root = OGRE_NEW Root( pluginsPath, "", "OgreTextureStreamingBenchmark.log" );
+
+#ifdef OGRE_STATIC_LIB
+        root->addRenderSystem( new NULLRenderSystem() );
+#endif
+        RenderSystem *renderSystem = root->getRenderSystemByName( renderSystemName );
+        if( !renderSystem )
+        {
+            OGRE_EXCEPT( Exception::ERR_ITEM_NOT_FOUND,
+                         renderSystemName + " not found. Check " + pluginsPath,
+                         "OgreTextureStreamingBenchmark" );
+        }
+
+        root->setRenderSystem( renderSystem );
+        root->initialise( false );
+
+        root->createRenderWindow( "OgreTextureStreamingBenchmark", 1280u, 720u, false );
+
+        const vector<TextureSet>::type sets = findTextureSets( texturesPath, perExtension );
+        const vector<PixelFormatGpu>::type families = warmUp( root, sets.front().files,
+                                                              settings.filters );
+
+        String csv = "set,textures,failed,minBudget,maxPreloadMB,decoderThreads,sourceMB,"
+                     "residentMB,decodeMBps,uploadMBps,firstMs,avgMs,maxMs,frames,"
+                     "peakStreamingMB,peakProcessMB,workerUsage\n";
+        printf( "%s", csv.c_str() );
+
+        for( size_t i=0; i<sets.size(); ++i )
+        {
+            for( size_t j=0; j<settings.budgetResolutions.size(); ++j )
+            {
+                for( size_t k=0; k<settings.maxPreloadBytes.size(); ++k )
+                {
+                    for( size_t l=0; l<settings.numDecoderThreads.size(); ++l )
+                    {
+                        RunConfig config;
+                        config.budgetResolution = settings.budgetResolutions[j];
+                        config.maxPreloadBytes  = settings.maxPreloadBytes[k];
+                        config.numDecoderThreads= settings.numDecoderThreads[l];
+
+                        const String row = runConfig( root, settings, sets[i], families, config );
+                        printf( "%s", row.c_str() );
+                        fflush( stdout );
+                        csv += row;
+                    }
+                }
+            }
+        }
+
+        if( !csvPath.empty() )
+        {
+            FILE *outFile = fopen( csvPath.c_str(), "wb" );
+            if( !outFile )
+            {
+                OGRE_EXCEPT( Exception::ERR_CANNOT_WRITE_TO_FILE,
+                             "Could not open " + csvPath + " for writing",
+                             "OgreTextureStreamingBenchmark" );
+            }
+            fwrite( csv.c_str(), 1u, csv.size(), outFile );
+            fclose( outFile );
+        }
+    }
+    catch( Exception &e )
+    {
+        fprintf( stderr, "%s\n", e.getFullDescription().c_str() );
+        retCode = -1;
+    }
+
+    OGRE_DELETE root;
+    OGRE_DELETE logManager;
+
+    return retCode;
+}